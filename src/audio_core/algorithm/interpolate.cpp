@@ -22,8 +22,16 @@ static double Lanczos(std::size_t a, double x) {
 }
 
 std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input, double ratio) {
-    if (input.size() < 2)
-        return {};
+    std::vector<s16> output;
+    output.reserve(static_cast<std::size_t>(input.size() / std::max(ratio, 0.01) + 4));
+    Interpolate(state, input.data(), input.size(), ratio, output);
+    return output;
+}
+
+void Interpolate(InterpolationState& state, const s16* input, std::size_t sample_count,
+                 double ratio, std::vector<s16>& output) {
+    if (sample_count < 2)
+        return;
 
     if (ratio <= 0) {
         LOG_CRITICAL(Audio, "Nonsensical interpolation ratio {}", ratio);
@@ -35,20 +43,19 @@ std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input,
         state.nyquist = CascadingFilter::LowPass(std::clamp(cutoff_frequency, 0.0, 0.4), 3);
         state.current_ratio = ratio;
     }
-    state.nyquist.Process(input);
+    auto& filtered = state.filtered;
+    filtered.assign(input, input + sample_count);
+    state.nyquist.Process(filtered);
 
     constexpr std::size_t taps = InterpolationState::lanczos_taps;
-    const std::size_t num_frames = input.size() / 2;
-
-    std::vector<s16> output;
-    output.reserve(static_cast<std::size_t>(input.size() / ratio + 4));
+    const std::size_t num_frames = sample_count / 2;
 
     double& pos = state.position;
     auto& h = state.history;
     for (std::size_t i = 0; i < num_frames; ++i) {
         std::rotate(h.begin(), h.end() - 1, h.end());
-        h[0][0] = input[i * 2 + 0];
-        h[0][1] = input[i * 2 + 1];
+        h[0][0] = filtered[i * 2 + 0];
+        h[0][1] = filtered[i * 2 + 1];
 
         while (pos <= 1.0) {
             double l = 0.0;
@@ -65,8 +72,6 @@ std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input,
         }
         pos -= 1.0;
     }
-
-    return output;
 }
 
 } // namespace AudioCore
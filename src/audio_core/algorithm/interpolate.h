@@ -19,8 +19,19 @@ struct InterpolationState {
     CascadingFilter nyquist;
     std::array<std::array<s16, 2>, history_size> history = {};
     double position = 0;
+    /// Storage for the low-passed input, reused between calls
+    std::vector<s16> filtered;
 };
 
+/// Interpolates input signal, appending the output signal to output.
+/// Neither the input nor the output are allocated anew, output only grows when it's too small.
+/// @param input The signal to interpolate, interleaved stereo.
+/// @param sample_count Number of samples in input.
+/// @param ratio Interpolation ratio.
+/// @param output The signal the output is appended to.
+void Interpolate(InterpolationState& state, const s16* input, std::size_t sample_count,
+                 double ratio, std::vector<s16>& output);
+
 /// Interpolates input signal to produce output signal.
 /// @param input The signal to interpolate.
 /// @param ratio Interpolation ratio.
@@ -0,0 +1,205 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#define _USE_MATH_DEFINES
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "audio_core/algorithm/resampler.h"
+#include "common/logging/log.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <xmmintrin.h>
+#endif
+
+namespace AudioCore {
+
+namespace {
+
+constexpr std::size_t NumChannels = 2;
+/// Frames after the position read by the polyphase kernel
+constexpr std::size_t PolyphaseLookahead = Resampler::PolyphaseTaps / 2;
+/// Frames before the position read by the polyphase kernel
+constexpr std::size_t PolyphaseLookbehind = Resampler::PolyphaseTaps / 2 - 1;
+constexpr std::size_t PhaseSize = Resampler::PolyphaseTaps * NumChannels;
+
+double Sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    const double px = M_PI * x;
+    return std::sin(px) / px;
+}
+
+/// Builds a Lanczos windowed sinc, its cutoff is lowered when downsampling to avoid aliasing
+std::vector<float> BuildPolyphaseKernel(double ratio) {
+    constexpr double window = static_cast<double>(PolyphaseLookahead);
+    const double cutoff = std::min(1.0, 1.0 / ratio);
+
+    // One extra phase for fractions that round up to the next frame
+    std::vector<float> kernel((Resampler::PolyphasePhases + 1) * PhaseSize);
+    for (std::size_t phase = 0; phase <= Resampler::PolyphasePhases; ++phase) {
+        const double fraction =
+            static_cast<double>(phase) / static_cast<double>(Resampler::PolyphasePhases);
+
+        std::array<double, Resampler::PolyphaseTaps> weights;
+        double sum = 0.0;
+        for (std::size_t tap = 0; tap < weights.size(); ++tap) {
+            const double x = fraction + static_cast<double>(PolyphaseLookbehind) -
+                             static_cast<double>(tap);
+            weights[tap] = std::abs(x) < window ? cutoff * Sinc(cutoff * x) * Sinc(x / window)
+                                                : 0.0;
+            sum += weights[tap];
+        }
+
+        // Normalized so that every phase passes a constant signal through unchanged
+        float* const out = kernel.data() + phase * PhaseSize;
+        for (std::size_t tap = 0; tap < weights.size(); ++tap) {
+            out[tap * NumChannels + 0] = static_cast<float>(weights[tap] / sum);
+            out[tap * NumChannels + 1] = static_cast<float>(weights[tap] / sum);
+        }
+    }
+    return kernel;
+}
+
+std::shared_ptr<const std::vector<float>> GetDefaultPolyphaseKernel() {
+    static const auto kernel =
+        std::make_shared<const std::vector<float>>(BuildPolyphaseKernel(1.0));
+    return kernel;
+}
+
+} // Anonymous namespace
+
+Resampler::Resampler() : kernel{GetDefaultPolyphaseKernel()} {}
+
+Resampler::~Resampler() = default;
+
+void Resampler::SetRatio(double new_ratio) {
+    if (new_ratio <= 0.0) {
+        LOG_CRITICAL(Audio, "Nonsensical resampling ratio {}", new_ratio);
+        new_ratio = 1.0;
+    }
+    if (new_ratio == ratio) {
+        return;
+    }
+
+    // Upsampling keeps the full band, only downsampling needs a kernel of its own
+    const bool had_own_kernel = ratio > 1.0;
+    ratio = new_ratio;
+    if (ratio > 1.0) {
+        kernel = std::make_shared<const std::vector<float>>(BuildPolyphaseKernel(ratio));
+    } else if (had_own_kernel) {
+        kernel = GetDefaultPolyphaseKernel();
+    }
+}
+
+void Resampler::SetQuality(ResamplingQuality new_quality) {
+    quality = new_quality;
+}
+
+std::size_t Resampler::Process(const float* input, std::size_t input_frames, float* mix,
+                               std::size_t mix_frames, float volume) {
+    if (ratio == 1.0 && position == std::floor(position)) {
+        // Same rate as the output, the frames are mixed as they are
+        const auto index = static_cast<std::size_t>(position);
+        const std::size_t frames =
+            std::min(mix_frames, input_frames - std::min(index, input_frames));
+        const float* const source = input + index * NumChannels;
+        for (std::size_t i = 0; i < frames * NumChannels; ++i) {
+            mix[i] += source[i] * volume;
+        }
+        position += static_cast<double>(frames);
+        return frames;
+    }
+
+    if (quality == ResamplingQuality::Linear) {
+        return ProcessLinear(input, input_frames, mix, mix_frames, volume);
+    }
+    return ProcessPolyphase(input, input_frames, mix, mix_frames, volume);
+}
+
+void Resampler::Shift(std::size_t frames) {
+    position -= static_cast<double>(frames);
+}
+
+void Resampler::Reset() {
+    position = HistoryFrames;
+}
+
+std::size_t Resampler::ProcessLinear(const float* input, std::size_t input_frames, float* mix,
+                                     std::size_t mix_frames, float volume) {
+    std::size_t produced = 0;
+    for (; produced < mix_frames; ++produced) {
+        const auto index = static_cast<std::size_t>(position);
+        if (index + 1 >= input_frames) {
+            break;
+        }
+        const auto fraction = static_cast<float>(position - static_cast<double>(index));
+        const float* const frames = input + index * NumChannels;
+        float* const out = mix + produced * NumChannels;
+
+#ifdef ARCHITECTURE_x86_64
+        // Both frames are next to each other, they're weighted in a single vector
+        const __m128 weights = _mm_setr_ps(1.0f - fraction, 1.0f - fraction, fraction, fraction);
+        __m128 sum = _mm_mul_ps(_mm_loadu_ps(frames), weights);
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        __m128 mixed = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(out));
+        mixed = _mm_add_ps(mixed, _mm_mul_ps(sum, _mm_set1_ps(volume)));
+        _mm_storel_pi(reinterpret_cast<__m64*>(out), mixed);
+#else
+        for (std::size_t channel = 0; channel < NumChannels; ++channel) {
+            const float a = frames[channel];
+            const float b = frames[NumChannels + channel];
+            out[channel] += (a + (b - a) * fraction) * volume;
+        }
+#endif
+
+        position += ratio;
+    }
+    return produced;
+}
+
+std::size_t Resampler::ProcessPolyphase(const float* input, std::size_t input_frames, float* mix,
+                                        std::size_t mix_frames, float volume) {
+    const float* const coefficients = kernel->data();
+
+    std::size_t produced = 0;
+    for (; produced < mix_frames; ++produced) {
+        const auto index = static_cast<std::size_t>(position);
+        if (index + PolyphaseLookahead >= input_frames) {
+            break;
+        }
+        const std::size_t phase = static_cast<std::size_t>(
+            (position - static_cast<double>(index)) * PolyphasePhases + 0.5);
+        const float* const frames = input + (index - PolyphaseLookbehind) * NumChannels;
+        const float* const weights = coefficients + phase * PhaseSize;
+        float* const out = mix + produced * NumChannels;
+
+#ifdef ARCHITECTURE_x86_64
+        // Two frames per vector, the halves are folded into one frame at the end
+        __m128 sum = _mm_mul_ps(_mm_loadu_ps(frames), _mm_loadu_ps(weights));
+        for (std::size_t i = 4; i < PhaseSize; i += 4) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(frames + i), _mm_loadu_ps(weights + i)));
+        }
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        __m128 mixed = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(out));
+        mixed = _mm_add_ps(mixed, _mm_mul_ps(sum, _mm_set1_ps(volume)));
+        _mm_storel_pi(reinterpret_cast<__m64*>(out), mixed);
+#else
+        std::array<float, NumChannels> sum{};
+        for (std::size_t i = 0; i < PhaseSize; ++i) {
+            sum[i % NumChannels] += frames[i] * weights[i];
+        }
+        for (std::size_t channel = 0; channel < NumChannels; ++channel) {
+            out[channel] += sum[channel] * volume;
+        }
+#endif
+
+        position += ratio;
+    }
+    return produced;
+}
+
+} // namespace AudioCore
@@ -0,0 +1,73 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+enum class ResamplingQuality {
+    Linear,    ///< Interpolates between the two nearest frames
+    Polyphase, ///< Windowed sinc over the eight nearest frames
+};
+
+/// Streams a stereo signal of one sample rate into mix buffers of another.
+/// The input is interleaved float frames, of which the first HistoryFrames are the last frames of
+/// the previous input. The resampled signal is added in place to the mix buffer.
+class Resampler {
+public:
+    static constexpr std::size_t PolyphaseTaps = 8;
+    static constexpr std::size_t PolyphasePhases = 128;
+    /// Frames of the previous input that have to be kept in front of the next one
+    static constexpr std::size_t HistoryFrames = PolyphaseTaps - 1;
+
+    Resampler();
+    ~Resampler();
+
+    /// Sets the ratio of the input rate to the output rate.
+    void SetRatio(double ratio);
+
+    void SetQuality(ResamplingQuality quality);
+
+    /**
+     * Resamples input frames into the mix buffer, adding them scaled by volume.
+     * @param input Interleaved stereo frames, led by HistoryFrames frames of the previous input.
+     * @param input_frames Number of frames in input, the history included.
+     * @param mix Interleaved stereo mix buffer.
+     * @param mix_frames Number of frames to produce.
+     * @param volume Scale of the resampled frames.
+     * @returns The number of frames produced. Less than mix_frames when the input has run out.
+     */
+    std::size_t Process(const float* input, std::size_t input_frames, float* mix,
+                        std::size_t mix_frames, float volume);
+
+    /// Moves the position back by the frames dropped from the front of the input.
+    void Shift(std::size_t frames);
+
+    /// Starts over at the first frame after the history.
+    void Reset();
+
+    /// Returns the position in the input of the next frame to produce.
+    double GetPosition() const {
+        return position;
+    }
+
+private:
+    std::size_t ProcessLinear(const float* input, std::size_t input_frames, float* mix,
+                              std::size_t mix_frames, float volume);
+    std::size_t ProcessPolyphase(const float* input, std::size_t input_frames, float* mix,
+                                 std::size_t mix_frames, float volume);
+
+    double position = HistoryFrames;
+    double ratio = 1.0;
+    ResamplingQuality quality = ResamplingQuality::Polyphase;
+
+    /// Coefficients of every phase, each duplicated for both channels
+    std::shared_ptr<const std::vector<float>> kernel;
+};
+
+} // namespace AudioCore
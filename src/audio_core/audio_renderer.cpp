@@ -2,20 +2,32 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include "audio_core/algorithm/interpolate.h"
+#include <algorithm>
+#include <cmath>
+#include "audio_core/algorithm/resampler.h"
 #include "audio_core/audio_out.h"
 #include "audio_core/audio_renderer.h"
 #include "audio_core/codec.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/hle/kernel/writable_event.h"
 #include "core/memory.h"
+#include "core/settings.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 
 namespace AudioCore {
 
 constexpr u32 STREAM_SAMPLE_RATE{48000};
 constexpr u32 STREAM_NUM_CHANNELS{2};
+constexpr std::size_t BUFFER_SIZE{512};
+/// Buffers the audio thread keeps rendered ahead of the stream
+constexpr std::size_t RENDER_AHEAD_BUFFERS{2};
+constexpr std::size_t FINAL_MIX_INDEX{0};
 
 class AudioRenderer::VoiceState {
 public:
@@ -36,28 +48,30 @@ public:
     }
 
     void SetWaveIndex(std::size_t index);
-    std::vector<s16> DequeueSamples(std::size_t sample_count);
+    /// Adds the next frame_count stereo frames of the voice to the mix buffer.
+    void Mix(float* mix, std::size_t frame_count, ResamplingQuality quality);
     void UpdateState();
     void RefreshBuffer();
 
 private:
+    /// Moves on from a wave buffer that has been played to the end.
+    void FinishWaveBuffer();
+
     bool is_in_use{};
     bool is_refresh_pending{};
     std::size_t wave_index{};
-    std::size_t offset{};
     Codec::ADPCMState adpcm_state{};
-    InterpolationState interp_state{};
-    std::vector<s16> samples;
+    Resampler resampler;
+    std::vector<u8> wave_data;      ///< Contents of the current wave buffer
+    std::vector<s16> adpcm_samples; ///< Decoded samples of ADPCM wave buffers
+    /// Stereo frames of the current wave buffer, led by the history the resampler looks back at
+    std::vector<float> frames;
     VoiceOutStatus out_status{};
     VoiceInfo info{};
 };
 
 class AudioRenderer::EffectState {
 public:
-    const EffectOutStatus& GetOutStatus() const {
-        return out_status;
-    }
-
     const EffectInStatus& GetInfo() const {
         return info;
     }
@@ -66,17 +80,63 @@ public:
         return info;
     }
 
-    void UpdateState();
+    /// Runs the effect over the frames of a mix buffer.
+    void Apply(float* mix, std::size_t frame_count);
 
 private:
-    EffectOutStatus out_status{};
+    /// Sends the mix to the guest and replaces it with what the guest has returned.
+    void ApplyAux(float* mix, std::size_t frame_count);
+
     EffectInStatus info{};
+    std::vector<s32> samples;
 };
+
+class AudioRenderer::MixState {
+public:
+    bool IsInUse() const {
+        return info.is_in_use != 0;
+    }
+
+    const MixInfo& GetInfo() const {
+        return info;
+    }
+
+    MixInfo& GetInfo() {
+        return info;
+    }
+
+    float* GetBuffer() {
+        return buffer.data();
+    }
+
+    /// Clears the mix buffer to frame_count silent frames.
+    void Clear(std::size_t frame_count) {
+        buffer.assign(frame_count * STREAM_NUM_CHANNELS, 0.0f);
+    }
+
+    /// Index of the mix this one is output to
+    std::size_t destination{FINAL_MIX_INDEX};
+    /// Indices of the effects applied to the mix, in order
+    std::vector<std::size_t> effects;
+
+private:
+    MixInfo info{};
+    std::vector<float> buffer;
+};
+
 AudioRenderer::AudioRenderer(Core::Timing::CoreTiming& core_timing, AudioRendererParameter params,
                              Kernel::SharedPtr<Kernel::WritableEvent> buffer_event,
                              std::size_t instance_number)
     : worker_params{params}, buffer_event{buffer_event}, voices(params.voice_count),
-      effects(params.effect_count) {
+      effects(params.effect_count), mixes(params.submix_count + 1),
+      voice_mixes(params.voice_count, FINAL_MIX_INDEX), effect_statuses(params.effect_count),
+      voice_statuses(params.voice_count) {
+
+    for (auto* parameters : {&active_parameters, &pending_parameters}) {
+        parameters->voices.resize(params.voice_count);
+        parameters->effects.resize(params.effect_count);
+        parameters->mixes.resize(params.submix_count + 1);
+    }
 
     audio_out = std::make_unique<AudioCore::AudioOut>();
     stream = audio_out->OpenStream(core_timing, STREAM_SAMPLE_RATE, STREAM_NUM_CHANNELS,
@@ -84,12 +144,21 @@ AudioRenderer::AudioRenderer(Core::Timing::CoreTiming& core_timing, AudioRendere
                                    [=]() { buffer_event->Signal(); });
     audio_out->StartStream(stream);
 
+    audio_thread = std::thread(&AudioRenderer::AudioThread, this);
+
     QueueMixedBuffer(0);
     QueueMixedBuffer(1);
     QueueMixedBuffer(2);
 }
 
-AudioRenderer::~AudioRenderer() = default;
+AudioRenderer::~AudioRenderer() {
+    {
+        std::scoped_lock lock{mutex};
+        quit = true;
+    }
+    work_cv.notify_all();
+    audio_thread.join();
+}
 
 u32 AudioRenderer::GetSampleRate() const {
     return worker_params.sample_rate;
@@ -112,33 +181,58 @@ static constexpr u32 VersionFromRevision(u32_le rev) {
     return ((rev >> 24) & 0xff) - 0x30;
 }
 
-std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_params) {
+std::vector<u8> AudioRenderer::UpdateAudioRenderer(const u8* input_params) {
     // Copy UpdateDataHeader struct
     UpdateDataHeader config{};
-    std::memcpy(&config, input_params.data(), sizeof(UpdateDataHeader));
+    std::memcpy(&config, input_params, sizeof(UpdateDataHeader));
     u32 memory_pool_count = worker_params.effect_count + (worker_params.voice_count * 4);
 
     // Copy MemoryPoolInfo structs
     std::vector<MemoryPoolInfo> mem_pool_info(memory_pool_count);
     std::memcpy(mem_pool_info.data(),
-                input_params.data() + sizeof(UpdateDataHeader) + config.behavior_size,
+                input_params + sizeof(UpdateDataHeader) + config.behavior_size,
                 memory_pool_count * sizeof(MemoryPoolInfo));
 
-    // Copy VoiceInfo structs
-    std::size_t voice_offset{sizeof(UpdateDataHeader) + config.behavior_size +
-                             config.memory_pools_size + config.voice_resource_size};
-    for (auto& voice : voices) {
-        std::memcpy(&voice.GetInfo(), input_params.data() + voice_offset, sizeof(VoiceInfo));
-        voice_offset += sizeof(VoiceInfo);
-    }
+    {
+        // The parameters are only copied here, the audio thread picks them up before its next
+        // buffer. An update it hasn't picked up yet is replaced, keeping what was new in it.
+        std::scoped_lock lock{mutex};
+        auto& parameters = pending_parameters;
+
+        // Copy VoiceInfo structs
+        const std::size_t voice_offset{sizeof(UpdateDataHeader) + config.behavior_size +
+                                       config.memory_pools_size + config.voice_resource_size};
+        for (std::size_t index = 0; index < parameters.voices.size(); ++index) {
+            auto& voice = parameters.voices[index];
+            const bool was_new = has_pending_parameters && voice.is_new;
+            std::memcpy(&voice, input_params + voice_offset + index * sizeof(VoiceInfo),
+                        sizeof(VoiceInfo));
+            voice.is_new |= static_cast<u8>(was_new);
+        }
 
-    std::size_t effect_offset{sizeof(UpdateDataHeader) + config.behavior_size +
-                              config.memory_pools_size + config.voice_resource_size +
-                              config.voices_size};
-    for (auto& effect : effects) {
-        std::memcpy(&effect.GetInfo(), input_params.data() + effect_offset, sizeof(EffectInStatus));
-        effect_offset += sizeof(EffectInStatus);
+        // Copy EffectInStatus structs
+        const std::size_t effect_offset{voice_offset + config.voices_size};
+        for (std::size_t index = 0; index < parameters.effects.size(); ++index) {
+            std::memcpy(&parameters.effects[index],
+                        input_params + effect_offset + index * sizeof(EffectInStatus),
+                        sizeof(EffectInStatus));
+            if (parameters.effects[index].is_new) {
+                effect_statuses[index].state = EffectStatus::New;
+            }
+        }
+
+        // Copy MixInfo structs, without them everything is mixed straight into the final mix
+        const std::size_t mix_offset{effect_offset + config.effects_size};
+        if (config.mixes_size >= parameters.mixes.size() * sizeof(MixInfo)) {
+            std::memcpy(parameters.mixes.data(), input_params + mix_offset,
+                        parameters.mixes.size() * sizeof(MixInfo));
+        } else {
+            std::fill(parameters.mixes.begin(), parameters.mixes.end(), MixInfo{});
+        }
+
+        has_pending_parameters = true;
     }
+    work_cv.notify_one();
 
     // Update memory pool state
     std::vector<MemoryPoolEntry> memory_pool(memory_pool_count);
@@ -150,21 +244,6 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
         }
     }
 
-    // Update voices
-    for (auto& voice : voices) {
-        voice.UpdateState();
-        if (!voice.GetInfo().is_in_use) {
-            continue;
-        }
-        if (voice.GetInfo().is_new) {
-            voice.SetWaveIndex(voice.GetInfo().wave_buffer_head);
-        }
-    }
-
-    for (auto& effect : effects) {
-        effect.UpdateState();
-    }
-
     // Release previous buffers and queue next ones for playback
     ReleaseAndQueueBuffers();
 
@@ -182,22 +261,20 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
     std::memcpy(output_params.data() + sizeof(UpdateDataHeader), memory_pool.data(),
                 response_data.memory_pools_size);
 
-    // Copy output voice status
-    std::size_t voice_out_status_offset{sizeof(UpdateDataHeader) + response_data.memory_pools_size};
-    for (const auto& voice : voices) {
-        std::memcpy(output_params.data() + voice_out_status_offset, &voice.GetOutStatus(),
-                    sizeof(VoiceOutStatus));
-        voice_out_status_offset += sizeof(VoiceOutStatus);
+    // Copy output voice status, as of the last buffer rendered
+    const std::size_t voice_out_status_offset{sizeof(UpdateDataHeader) +
+                                              response_data.memory_pools_size};
+    {
+        std::scoped_lock lock{mutex};
+        std::memcpy(output_params.data() + voice_out_status_offset, voice_statuses.data(),
+                    voice_statuses.size() * sizeof(VoiceOutStatus));
     }
 
-    std::size_t effect_out_status_offset{
+    const std::size_t effect_out_status_offset{
         sizeof(UpdateDataHeader) + response_data.memory_pools_size + response_data.voices_size +
         response_data.voice_resource_size};
-    for (const auto& effect : effects) {
-        std::memcpy(output_params.data() + effect_out_status_offset, &effect.GetOutStatus(),
-                    sizeof(EffectOutStatus));
-        effect_out_status_offset += sizeof(EffectOutStatus);
-    }
+    std::memcpy(output_params.data() + effect_out_status_offset, effect_statuses.data(),
+                effect_statuses.size() * sizeof(EffectOutStatus));
     return output_params;
 }
 
@@ -206,43 +283,51 @@ void AudioRenderer::VoiceState::SetWaveIndex(std::size_t index) {
     is_refresh_pending = true;
 }
 
-std::vector<s16> AudioRenderer::VoiceState::DequeueSamples(std::size_t sample_count) {
-    if (!IsPlaying()) {
-        return {};
-    }
-
-    if (is_refresh_pending) {
-        RefreshBuffer();
-    }
-
-    const std::size_t max_size{samples.size() - offset};
-    const std::size_t dequeue_offset{offset};
-    std::size_t size{sample_count * STREAM_NUM_CHANNELS};
-    if (size > max_size) {
-        size = max_size;
-    }
-
-    out_status.played_sample_count += size / STREAM_NUM_CHANNELS;
-    offset += size;
+void AudioRenderer::VoiceState::Mix(float* mix, std::size_t frame_count,
+                                     ResamplingQuality quality) {
+    resampler.SetQuality(quality);
 
-    const auto& wave_buffer{info.wave_buffer[wave_index]};
-    if (offset == samples.size()) {
-        offset = 0;
-
-        if (!wave_buffer.is_looping && wave_buffer.buffer_sz) {
-            SetWaveIndex(wave_index + 1);
+    std::size_t mixed = 0;
+    std::size_t empty_buffers = 0;
+    while (mixed < frame_count && IsPlaying()) {
+        if (is_refresh_pending) {
+            RefreshBuffer();
         }
 
-        if (wave_buffer.buffer_sz) {
-            out_status.wave_buffer_consumed++;
+        const auto start = static_cast<u64>(resampler.GetPosition());
+        const std::size_t produced =
+            resampler.Process(frames.data(), frames.size() / STREAM_NUM_CHANNELS,
+                              mix + mixed * STREAM_NUM_CHANNELS, frame_count - mixed, info.volume);
+        out_status.played_sample_count += static_cast<u64>(resampler.GetPosition()) - start;
+        mixed += produced;
+        if (mixed == frame_count) {
+            break;
         }
 
-        if (wave_buffer.end_of_stream || wave_buffer.buffer_sz == 0) {
-            info.play_state = PlayState::Paused;
+        // Wave buffers too short to produce a frame are still consumed, but only a few per mix so
+        // that looping ones can't stall the renderer
+        if (produced == 0 && ++empty_buffers > 4) {
+            break;
         }
+        FinishWaveBuffer();
+    }
+}
+
+void AudioRenderer::VoiceState::FinishWaveBuffer() {
+    const auto& wave_buffer{info.wave_buffer[wave_index]};
+    if (wave_buffer.is_looping) {
+        is_refresh_pending = true;
+    } else if (wave_buffer.buffer_sz) {
+        SetWaveIndex(wave_index + 1);
+    }
+
+    if (wave_buffer.buffer_sz) {
+        out_status.wave_buffer_consumed++;
     }
 
-    return {samples.begin() + dequeue_offset, samples.begin() + dequeue_offset + size};
+    if (wave_buffer.end_of_stream || wave_buffer.buffer_sz == 0) {
+        info.play_state = PlayState::Paused;
+    }
 }
 
 void AudioRenderer::VoiceState::UpdateState() {
@@ -250,28 +335,34 @@ void AudioRenderer::VoiceState::UpdateState() {
         // No longer in use, reset state
         is_refresh_pending = true;
         wave_index = 0;
-        offset = 0;
+        frames.clear();
         out_status = {};
     }
     is_in_use = info.is_in_use;
 }
 
 void AudioRenderer::VoiceState::RefreshBuffer() {
-    std::vector<s16> new_samples(info.wave_buffer[wave_index].buffer_sz / sizeof(s16));
-    Memory::ReadBlock(info.wave_buffer[wave_index].buffer_addr, new_samples.data(),
-                      info.wave_buffer[wave_index].buffer_sz);
+    const auto& wave_buffer{info.wave_buffer[wave_index]};
+    wave_data.resize(wave_buffer.buffer_sz);
+    Memory::ReadBlock(wave_buffer.buffer_addr, wave_data.data(), wave_data.size());
 
+    const s16* samples{};
+    std::size_t sample_count{};
     switch (static_cast<Codec::PcmFormat>(info.sample_format)) {
     case Codec::PcmFormat::Int16: {
         // PCM16 is played as-is
+        samples = reinterpret_cast<const s16*>(wave_data.data());
+        sample_count = wave_data.size() / sizeof(s16);
         break;
     }
     case Codec::PcmFormat::Adpcm: {
         // Decode ADPCM to PCM16
         Codec::ADPCM_Coeff coeffs;
         Memory::ReadBlock(info.additional_params_addr, coeffs.data(), sizeof(Codec::ADPCM_Coeff));
-        new_samples = Codec::DecodeADPCM(reinterpret_cast<u8*>(new_samples.data()),
-                                         new_samples.size() * sizeof(s16), coeffs, adpcm_state);
+        Codec::DecodeADPCM(wave_data.data(), wave_data.size(), coeffs, adpcm_state,
+                           adpcm_samples);
+        samples = adpcm_samples.data();
+        sample_count = adpcm_samples.size();
         break;
     }
     default:
@@ -279,82 +370,312 @@ void AudioRenderer::VoiceState::RefreshBuffer() {
         break;
     }
 
+    std::size_t new_frames{};
     switch (info.channel_count) {
     case 1:
-        // 1 channel is upsampled to 2 channel
-        samples.resize(new_samples.size() * 2);
-        for (std::size_t index = 0; index < new_samples.size(); ++index) {
-            samples[index * 2] = new_samples[index];
-            samples[index * 2 + 1] = new_samples[index];
-        }
+    case 2:
+        new_frames = sample_count / info.channel_count;
         break;
-    case 2: {
-        // 2 channel is played as is
-        samples = std::move(new_samples);
-        break;
-    }
     default:
         UNIMPLEMENTED_MSG("Unimplemented channel_count={}", info.channel_count);
         break;
     }
 
-    // Only interpolate when necessary, expensive.
-    if (GetInfo().sample_rate != STREAM_SAMPLE_RATE) {
-        samples = Interpolate(interp_state, std::move(samples), GetInfo().sample_rate,
-                              STREAM_SAMPLE_RATE);
+    // The frames at the end of the previous buffer stay in front, the resampler looks back at them
+    constexpr std::size_t history_size = Resampler::HistoryFrames * STREAM_NUM_CHANNELS;
+    if (frames.empty()) {
+        frames.assign(history_size, 0.0f);
+        resampler.Reset();
+    } else {
+        const std::size_t old_frames = frames.size() / STREAM_NUM_CHANNELS;
+        std::copy(frames.end() - history_size, frames.end(), frames.begin());
+        resampler.Shift(old_frames - Resampler::HistoryFrames);
     }
+    frames.resize(history_size + new_frames * STREAM_NUM_CHANNELS);
+
+    // 1 channel is upsampled to 2 channel, 2 channel is played as is
+    Codec::ConvertPCM16ToStereoFloat(samples, new_frames, info.channel_count,
+                                     frames.data() + history_size);
+
+    resampler.SetRatio(static_cast<double>(GetInfo().sample_rate) / STREAM_SAMPLE_RATE);
 
     is_refresh_pending = false;
 }
 
-void AudioRenderer::EffectState::UpdateState() {
-    if (info.is_new) {
-        out_status.state = EffectStatus::New;
-    } else {
-        if (info.type == Effect::Aux) {
-            ASSERT_MSG(Memory::Read32(info.aux_info.return_buffer_info) == 0,
-                       "Aux buffers tried to update");
-            ASSERT_MSG(Memory::Read32(info.aux_info.send_buffer_info) == 0,
-                       "Aux buffers tried to update");
-            ASSERT_MSG(Memory::Read32(info.aux_info.return_buffer_base) == 0,
-                       "Aux buffers tried to update");
-            ASSERT_MSG(Memory::Read32(info.aux_info.send_buffer_base) == 0,
-                       "Aux buffers tried to update");
+void AudioRenderer::EffectState::Apply(float* mix, std::size_t frame_count) {
+    if (!info.is_enabled) {
+        return;
+    }
+    switch (info.type) {
+    case Effect::None:
+        break;
+    case Effect::Aux:
+        ApplyAux(mix, frame_count);
+        break;
+    default:
+        LOG_DEBUG(Audio, "Unimplemented effect type={}", static_cast<u32>(info.type));
+        break;
+    }
+}
+
+/// Writes samples to a ring buffer of capacity samples in guest memory
+static void WriteAuxRing(VAddr base, u32 capacity, u32 offset, const s32* data,
+                         std::size_t count) {
+    while (count > 0) {
+        offset %= capacity;
+        const std::size_t chunk = std::min<std::size_t>(capacity - offset, count);
+        Memory::WriteBlock(base + offset * sizeof(s32), data, chunk * sizeof(s32));
+        offset += static_cast<u32>(chunk);
+        data += chunk;
+        count -= chunk;
+    }
+}
+
+/// Reads samples from a ring buffer of capacity samples in guest memory
+static void ReadAuxRing(VAddr base, u32 capacity, u32 offset, s32* data, std::size_t count) {
+    while (count > 0) {
+        offset %= capacity;
+        const std::size_t chunk = std::min<std::size_t>(capacity - offset, count);
+        Memory::ReadBlock(base + offset * sizeof(s32), data, chunk * sizeof(s32));
+        offset += static_cast<u32>(chunk);
+        data += chunk;
+        count -= chunk;
+    }
+}
+
+void AudioRenderer::EffectState::ApplyAux(float* mix, std::size_t frame_count) {
+    const auto& aux{info.aux_info};
+    if (aux.send_buffer_info == 0 || aux.send_buffer_base == 0 || aux.return_buffer_info == 0 ||
+        aux.return_buffer_base == 0 || aux.sample_count == 0) {
+        return;
+    }
+
+    // Each channel of the mix goes to the ring in a block of its own. The first word of the info
+    // is the read offset, advanced by the reader, the second the write offset.
+    const std::size_t channel_count =
+        std::min<std::size_t>(aux.mix_buffer_count, STREAM_NUM_CHANNELS);
+    samples.resize(frame_count);
+
+    const u32 write_offset = Memory::Read32(aux.send_buffer_info + sizeof(u32));
+    for (std::size_t channel = 0; channel < channel_count; ++channel) {
+        for (std::size_t i = 0; i < frame_count; ++i) {
+            samples[i] = static_cast<s32>(mix[i * STREAM_NUM_CHANNELS + channel]);
+        }
+        WriteAuxRing(aux.send_buffer_base, aux.sample_count,
+                     write_offset + static_cast<u32>(channel * frame_count), samples.data(),
+                     frame_count);
+    }
+    Memory::Write32(aux.send_buffer_info + sizeof(u32),
+                    static_cast<u32>((write_offset + channel_count * frame_count) %
+                                     aux.sample_count));
+
+    const u32 read_offset = Memory::Read32(aux.return_buffer_info);
+    for (std::size_t channel = 0; channel < channel_count; ++channel) {
+        ReadAuxRing(aux.return_buffer_base, aux.sample_count,
+                    read_offset + static_cast<u32>(channel * frame_count), samples.data(),
+                    frame_count);
+        for (std::size_t i = 0; i < frame_count; ++i) {
+            mix[i * STREAM_NUM_CHANNELS + channel] = static_cast<float>(samples[i]);
         }
     }
+    Memory::Write32(aux.return_buffer_info,
+                    static_cast<u32>((read_offset + channel_count * frame_count) %
+                                     aux.sample_count));
 }
 
-static constexpr s16 ClampToS16(s32 value) {
-    return static_cast<s16>(std::clamp(value, -32768, 32767));
+/// Converts the mixed signal to PCM16, saturating samples out of its range
+static void ConvertMixToS16(const float* mix, s16* out, std::size_t count) {
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    const __m128 min = _mm_set1_ps(-32768.0f);
+    const __m128 max = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        const __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(mix + i), min), max);
+        const __m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(mix + i + 4), min), max);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = static_cast<s16>(std::clamp(std::nearbyint(mix[i]), -32768.0f, 32767.0f));
+    }
 }
 
-void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
-    constexpr std::size_t BUFFER_SIZE{512};
-    std::vector<s16> buffer(BUFFER_SIZE * stream->GetNumChannels());
+std::size_t AudioRenderer::FindMix(u32 mix_id) const {
+    for (std::size_t index = 0; index < mixes.size(); ++index) {
+        if (mixes[index].IsInUse() && mixes[index].GetInfo().mix_id == mix_id) {
+            return index;
+        }
+    }
+    return FINAL_MIX_INDEX;
+}
 
-    for (auto& voice : voices) {
-        if (!voice.IsPlaying()) {
+void AudioRenderer::ApplyParameters(const UpdateParameters& parameters) {
+    // Update voices
+    for (std::size_t index = 0; index < voices.size(); ++index) {
+        auto& voice = voices[index];
+        voice.GetInfo() = parameters.voices[index];
+        voice.UpdateState();
+        if (!voice.GetInfo().is_in_use) {
             continue;
         }
+        if (voice.GetInfo().is_new) {
+            voice.SetWaveIndex(voice.GetInfo().wave_buffer_head);
+        }
+    }
 
-        std::size_t offset{};
-        s64 samples_remaining{BUFFER_SIZE};
-        while (samples_remaining > 0) {
-            const std::vector<s16> samples{voice.DequeueSamples(samples_remaining)};
+    for (std::size_t index = 0; index < effects.size(); ++index) {
+        effects[index].GetInfo() = parameters.effects[index];
+    }
 
-            if (samples.empty()) {
+    for (std::size_t index = 0; index < mixes.size(); ++index) {
+        mixes[index].GetInfo() = parameters.mixes[index];
+        mixes[index].effects.clear();
+    }
+
+    // Rebuild the graph: voices and effects hang off mixes, submixes off the mix they output to
+    for (std::size_t index = 0; index < voices.size(); ++index) {
+        voice_mixes[index] = FindMix(voices[index].GetInfo().mix_id);
+    }
+    for (std::size_t index = 0; index < effects.size(); ++index) {
+        const auto& info = effects[index].GetInfo();
+        if (info.type != Effect::None) {
+            mixes[FindMix(info.mix_id)].effects.push_back(index);
+        }
+    }
+
+    std::vector<std::size_t> depths(mixes.size());
+    mix_order.clear();
+    for (std::size_t index = 0; index < mixes.size(); ++index) {
+        auto& mix = mixes[index];
+        if (index == FINAL_MIX_INDEX || !mix.IsInUse()) {
+            continue;
+        }
+        mix.destination = FindMix(mix.GetInfo().dest_mix_id);
+
+        // Loops are cut by outputting the mix straight to the final mix
+        std::size_t depth = 1;
+        for (std::size_t next = mix.destination; next != FINAL_MIX_INDEX; ++depth) {
+            if (depth > mixes.size() || next == index) {
+                mix.destination = FINAL_MIX_INDEX;
+                depth = 1;
                 break;
             }
+            next = FindMix(mixes[next].GetInfo().dest_mix_id);
+        }
+        depths[index] = depth;
+        mix_order.push_back(index);
+    }
+    std::stable_sort(mix_order.begin(), mix_order.end(),
+                     [&depths](std::size_t lhs, std::size_t rhs) {
+                         return depths[lhs] > depths[rhs];
+                     });
+}
 
-            samples_remaining -= samples.size() / stream->GetNumChannels();
+std::vector<s16> AudioRenderer::RenderBuffer() {
+    const auto quality = Settings::values.use_linear_audio_resampling
+                             ? ResamplingQuality::Linear
+                             : ResamplingQuality::Polyphase;
 
-            for (const auto& sample : samples) {
-                const s32 buffer_sample{buffer[offset]};
-                buffer[offset++] =
-                    ClampToS16(buffer_sample + static_cast<s32>(sample * voice.GetInfo().volume));
-            }
+    mixes[FINAL_MIX_INDEX].Clear(BUFFER_SIZE);
+    for (const std::size_t index : mix_order) {
+        mixes[index].Clear(BUFFER_SIZE);
+    }
+
+    for (std::size_t index = 0; index < voices.size(); ++index) {
+        if (voices[index].IsPlaying()) {
+            voices[index].Mix(mixes[voice_mixes[index]].GetBuffer(), BUFFER_SIZE, quality);
+        }
+    }
+
+    // Submixes are ordered ahead of their destinations, so each is complete when it's output
+    const auto apply_effects = [this](MixState& mix) {
+        for (const std::size_t effect : mix.effects) {
+            effects[effect].Apply(mix.GetBuffer(), BUFFER_SIZE);
+        }
+    };
+    for (const std::size_t index : mix_order) {
+        auto& mix = mixes[index];
+        apply_effects(mix);
+
+        const float volume = mix.GetInfo().volume;
+        const float* const source = mix.GetBuffer();
+        float* const destination = mixes[mix.destination].GetBuffer();
+        for (std::size_t i = 0; i < BUFFER_SIZE * STREAM_NUM_CHANNELS; ++i) {
+            destination[i] += source[i] * volume;
+        }
+    }
+
+    auto& final_mix = mixes[FINAL_MIX_INDEX];
+    apply_effects(final_mix);
+    float* const mix_buffer = final_mix.GetBuffer();
+    if (final_mix.IsInUse()) {
+        const float volume = final_mix.GetInfo().volume;
+        for (std::size_t i = 0; i < BUFFER_SIZE * STREAM_NUM_CHANNELS; ++i) {
+            mix_buffer[i] *= volume;
+        }
+    }
+
+    std::vector<s16> buffer(BUFFER_SIZE * STREAM_NUM_CHANNELS);
+    ConvertMixToS16(mix_buffer, buffer.data(), buffer.size());
+    return buffer;
+}
+
+void AudioRenderer::AudioThread() {
+    Common::SetCurrentThreadName("yuzu:AudioRenderer");
+    if (!Common::SetCurrentThreadAffinity(Settings::values.audio_thread_affinity)) {
+        LOG_WARNING(Audio, "Failed to pin the audio thread to the host cores {:016X}",
+                    Settings::values.audio_thread_affinity);
+    }
+    // Rendering is short and periodic, it's the thread that benefits the most from real-time
+    // scheduling
+    if (Settings::values.use_high_thread_priority &&
+        !Common::SetCurrentThreadPriority(Common::ThreadPriority::Critical)) {
+        LOG_WARNING(Audio, "Failed to raise the priority of the audio thread");
+    }
+
+    std::unique_lock lock{mutex};
+    while (true) {
+        work_cv.wait(lock,
+                     [this] { return quit || rendered_buffers.size() < RENDER_AHEAD_BUFFERS; });
+        if (quit) {
+            return;
+        }
+
+        // The service only writes the pending parameters, the active ones are swapped out of its
+        // way and can be used unlocked
+        const bool has_new_parameters = has_pending_parameters;
+        if (has_new_parameters) {
+            std::swap(active_parameters, pending_parameters);
+            has_pending_parameters = false;
         }
+
+        lock.unlock();
+        if (has_new_parameters) {
+            ApplyParameters(active_parameters);
+        }
+        std::vector<s16> buffer = RenderBuffer();
+        lock.lock();
+
+        rendered_buffers.push_back(std::move(buffer));
+        for (std::size_t index = 0; index < voices.size(); ++index) {
+            voice_statuses[index] = voices[index].GetOutStatus();
+        }
+        ready_cv.notify_all();
     }
+}
+
+void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
+    std::vector<s16> buffer;
+    {
+        // Only waits when the audio thread has fallen behind the stream
+        std::unique_lock lock{mutex};
+        ready_cv.wait(lock, [this] { return !rendered_buffers.empty(); });
+        buffer = std::move(rendered_buffers.front());
+        rendered_buffers.pop_front();
+    }
+    work_cv.notify_one();
+
     audio_out->QueueBuffer(stream, tag, std::move(buffer));
 }
 
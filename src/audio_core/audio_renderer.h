@@ -5,7 +5,11 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "audio_core/stream.h"
@@ -181,6 +185,23 @@ struct EffectOutStatus {
 };
 static_assert(sizeof(EffectOutStatus) == 0x10, "EffectOutStatus is an invalid size");
 
+struct MixInfo {
+    float_le volume;
+    u32_le sample_rate;
+    u32_le buffer_count;
+    u8 is_in_use;
+    INSERT_PADDING_BYTES(3);
+    u32_le mix_id;
+    u32_le effect_count;
+    u32_le node_id;
+    INSERT_PADDING_WORDS(2);
+    std::array<std::array<float_le, 24>, 24> mix_volume;
+    u32_le dest_mix_id;
+    u32_le splitter_id;
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(sizeof(MixInfo) == 0x930, "MixInfo is an invalid size");
+
 struct UpdateDataHeader {
     UpdateDataHeader() {}
 
@@ -222,7 +243,7 @@ public:
                   std::size_t instance_number);
     ~AudioRenderer();
 
-    std::vector<u8> UpdateAudioRenderer(const std::vector<u8>& input_params);
+    std::vector<u8> UpdateAudioRenderer(const u8* input_params);
     void QueueMixedBuffer(Buffer::Tag tag);
     void ReleaseAndQueueBuffers();
     u32 GetSampleRate() const;
@@ -232,14 +253,55 @@ public:
 
 private:
     class EffectState;
+    class MixState;
     class VoiceState;
 
+    /// Guest parameters of an update, handed over from the service to the audio thread
+    struct UpdateParameters {
+        std::vector<VoiceInfo> voices;
+        std::vector<EffectInStatus> effects;
+        std::vector<MixInfo> mixes;
+    };
+
+    /// Renders buffers ahead of the stream on the audio thread
+    void AudioThread();
+
+    /// Applies the parameters of the latest update to the mix graph, on the audio thread
+    void ApplyParameters(const UpdateParameters& parameters);
+
+    /// Runs the mix graph once, producing a buffer for the stream
+    std::vector<s16> RenderBuffer();
+
+    /// Returns the index of the mix in use with the given id, or the final mix when there's none
+    std::size_t FindMix(u32 mix_id) const;
+
     AudioRendererParameter worker_params;
     Kernel::SharedPtr<Kernel::WritableEvent> buffer_event;
-    std::vector<VoiceState> voices;
-    std::vector<EffectState> effects;
     std::unique_ptr<AudioOut> audio_out;
     AudioCore::StreamPtr stream;
+
+    // Owned by the audio thread
+    std::vector<VoiceState> voices;
+    std::vector<EffectState> effects;
+    std::vector<MixState> mixes;             ///< The first one is the final mix
+    std::vector<std::size_t> mix_order;      ///< Submixes, each ahead of the mix it outputs to
+    std::vector<std::size_t> voice_mixes;    ///< Mix each voice is mixed into
+    UpdateParameters active_parameters;
+
+    // Owned by the service
+    std::vector<EffectOutStatus> effect_statuses;
+
+    // Shared with the audio thread, guarded by the mutex
+    std::mutex mutex;
+    std::condition_variable work_cv;  ///< Signals the audio thread of new work
+    std::condition_variable ready_cv; ///< Signals the service of a rendered buffer
+    UpdateParameters pending_parameters;
+    bool has_pending_parameters = false;
+    std::deque<std::vector<s16>> rendered_buffers;
+    std::vector<VoiceOutStatus> voice_statuses;
+    bool quit = false;
+
+    std::thread audio_thread;
 };
 
 } // namespace AudioCore
@@ -6,72 +6,111 @@
 
 #include "audio_core/codec.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::Codec {
 
+// GC-ADPCM with scale factor and variable coefficients.
+// Frames are 8 bytes long containing 14 samples each.
+// Samples are 4 bits (one nibble) long.
+constexpr std::size_t FRAME_LEN = 8;
+constexpr std::size_t SAMPLES_PER_FRAME = 14;
+
 std::vector<s16> DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
                              ADPCMState& state) {
-    // GC-ADPCM with scale factor and variable coefficients.
-    // Frames are 8 bytes long containing 14 samples each.
-    // Samples are 4 bits (one nibble) long.
+    std::vector<s16> ret;
+    DecodeADPCM(data, size, coeff, state, ret);
+    return ret;
+}
 
-    constexpr std::size_t FRAME_LEN = 8;
-    constexpr std::size_t SAMPLES_PER_FRAME = 14;
-    constexpr std::array<int, 16> SIGNED_NIBBLES = {
-        {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
+void DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
+                 ADPCMState& state, std::vector<s16>& ret) {
+    // Every sample is written, there's no need to clear the storage first
+    ret.resize(GetADPCMSampleCount(size));
+    DecodeADPCM(data, size, coeff, state, ret.data());
+}
 
-    const std::size_t sample_count = (size / FRAME_LEN) * SAMPLES_PER_FRAME;
-    const std::size_t ret_size =
-        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    std::vector<s16> ret(ret_size);
+std::size_t GetADPCMSampleCount(std::size_t size) {
+    // Only whole frames are decoded, which always makes for a multiple of two
+    return (size / FRAME_LEN) * SAMPLES_PER_FRAME;
+}
 
-    int yn1 = state.yn1, yn2 = state.yn2;
+std::size_t DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
+                        ADPCMState& state, s16* out) {
+    s32 yn1 = state.yn1, yn2 = state.yn2;
 
-    const std::size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (std::size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
-        const int scale = 1 << (frame_header & 0xF);
-        const int idx = (frame_header >> 4) & 0x7;
+    const std::size_t num_frames = size / FRAME_LEN;
+    for (std::size_t framei = 0; framei < num_frames; framei++) {
+        const u8* const frame = data + framei * FRAME_LEN;
+        // The scale is applied straight in 11 bit fixed point
+        const s32 scale = 1 << ((frame[0] & 0xF) + 11);
+        const std::size_t idx = (frame[0] >> 4) & 0x7;
 
         // Coefficients are fixed point with 11 bits fractional part.
-        const int coef1 = coeff[idx * 2 + 0];
-        const int coef2 = coeff[idx * 2 + 1];
+        const s32 coef1 = coeff[idx * 2 + 0];
+        const s32 coef2 = coeff[idx * 2 + 1];
 
         // Decodes an audio sample. One nibble produces one sample.
-        const auto decode_sample = [&](const int nibble) -> s16 {
-            const int xn = nibble * scale;
-            // We first transform everything into 11 bit fixed point, perform the second order
-            // digital filter, then transform back.
-            // 0x400 == 0.5 in 11 bit fixed point.
+        const auto decode_sample = [&](s32 nibble) {
             // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
-            int val = ((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
-            // Clamp to output range.
-            val = std::clamp<s32>(val, -32768, 32767);
-            // Advance output feedback.
+            // 0x400 == 0.5 in 11 bit fixed point.
+            const s32 val = (nibble * scale + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
+            // Advance output feedback, clamped to the output range.
             yn2 = yn1;
-            yn1 = val;
-            return static_cast<s16>(val);
+            yn1 = std::clamp<s32>(val, -32768, 32767);
+            return static_cast<s16>(yn1);
         };
 
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi] = sample1;
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi] = sample2;
-            outputi++;
-
-            datai++;
+        for (std::size_t i = 1; i < FRAME_LEN; ++i) {
+            // Nibbles are sign extended by moving them to the top of a signed byte
+            const auto byte = static_cast<s8>(frame[i]);
+            *out++ = decode_sample(byte >> 4);
+            *out++ = decode_sample(static_cast<s8>(byte << 4) >> 4);
         }
     }
 
     state.yn1 = static_cast<s16>(yn1);
     state.yn2 = static_cast<s16>(yn2);
+    return num_frames * SAMPLES_PER_FRAME;
+}
 
-    return ret;
+void ConvertPCM16ToStereoFloat(const s16* samples, std::size_t frame_count, u32 channel_count,
+                               float* out) {
+    std::size_t i = 0;
+    if (channel_count == 1) {
+#ifdef ARCHITECTURE_x86_64
+        // Four frames at a time, each sample is duplicated before widening to 32 bits
+        for (; i + 4 <= frame_count; i += 4) {
+            const __m128i mono = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + i));
+            const __m128i stereo = _mm_unpacklo_epi16(mono, mono);
+            const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(stereo, stereo), 16);
+            const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(stereo, stereo), 16);
+            _mm_storeu_ps(out + i * 2, _mm_cvtepi32_ps(low));
+            _mm_storeu_ps(out + i * 2 + 4, _mm_cvtepi32_ps(high));
+        }
+#endif
+        for (; i < frame_count; ++i) {
+            out[i * 2] = samples[i];
+            out[i * 2 + 1] = samples[i];
+        }
+        return;
+    }
+
+    const std::size_t sample_count = frame_count * 2;
+#ifdef ARCHITECTURE_x86_64
+    for (; i + 8 <= sample_count; i += 8) {
+        const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16);
+        _mm_storeu_ps(out + i, _mm_cvtepi32_ps(low));
+        _mm_storeu_ps(out + i + 4, _mm_cvtepi32_ps(high));
+    }
+#endif
+    for (; i < sample_count; ++i) {
+        out[i] = samples[i];
+    }
 }
 
 } // namespace AudioCore::Codec
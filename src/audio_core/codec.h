@@ -41,4 +41,29 @@ using ADPCM_Coeff = std::array<s16, 16>;
 std::vector<s16> DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
                              ADPCMState& state);
 
+/// Same as the above, but decodes into out so its storage can be reused between buffers.
+void DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
+                 ADPCMState& state, std::vector<s16>& out);
+
+/// Returns the number of samples decoded from size bytes of ADPCM data.
+std::size_t GetADPCMSampleCount(std::size_t size);
+
+/**
+ * Decodes ADPCM data into a buffer owned by the caller.
+ * @param out Buffer of at least GetADPCMSampleCount(size) samples
+ * @return The number of samples decoded
+ */
+std::size_t DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
+                        ADPCMState& state, s16* out);
+
+/**
+ * Converts signed PCM16 frames to interleaved stereo float frames.
+ * @param samples Interleaved frames of channel_count channels, either 1 or 2
+ * @param frame_count Number of frames to convert
+ * @param channel_count Number of channels in samples, mono is copied to both channels
+ * @param out Buffer of frame_count * 2 floats
+ */
+void ConvertPCM16ToStereoFloat(const s16* samples, std::size_t frame_count, u32 channel_count,
+                               float* out);
+
 }; // namespace AudioCore::Codec
@@ -6,81 +6,77 @@
 #include <atomic>
 #include <cstring>
 #include "audio_core/cubeb_sink.h"
+#include "audio_core/latency_controller.h"
 #include "audio_core/stream.h"
 #include "audio_core/time_stretch.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/ring_buffer.h"
 #include "core/settings.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 #ifdef _WIN32
 #include <objbase.h>
 #endif
 
 namespace AudioCore {
 
-class CubebSinkStream final : public SinkStream {
-public:
-    CubebSinkStream(cubeb* ctx, u32 sample_rate, u32 num_channels_, cubeb_devid output_device,
-                    const std::string& name)
-        : ctx{ctx}, num_channels{std::min(num_channels_, 2u)}, time_stretch{sample_rate,
-                                                                            num_channels} {
-
-        cubeb_stream_params params{};
-        params.rate = sample_rate;
-        params.channels = num_channels;
-        params.format = CUBEB_SAMPLE_S16NE;
-        params.layout = num_channels == 1 ? CUBEB_LAYOUT_MONO : CUBEB_LAYOUT_STEREO;
-
-        u32 minimum_latency{};
-        if (cubeb_get_min_latency(ctx, &params, &minimum_latency) != CUBEB_OK) {
-            LOG_CRITICAL(Audio_Sink, "Error getting minimum latency");
-        }
+namespace {
 
-        if (cubeb_stream_init(ctx, &stream_backend, name.c_str(), nullptr, nullptr, output_device,
-                              &params, std::max(512u, minimum_latency),
-                              &CubebSinkStream::DataCallback, &CubebSinkStream::StateCallback,
-                              this) != CUBEB_OK) {
-            LOG_CRITICAL(Audio_Sink, "Error initializing cubeb stream");
-            return;
-        }
+/// Rate and channel count of the host stream the sink streams are mixed into
+constexpr u32 MixSampleRate = 48000;
+constexpr u32 MixNumChannels = 2;
 
-        if (cubeb_stream_start(stream_backend) != CUBEB_OK) {
-            LOG_CRITICAL(Audio_Sink, "Error starting cubeb stream");
-            return;
-        }
+/// Adds samples to the mix, saturating sums out of the PCM16 range
+void MixSamples(s16* mix, const s16* samples, std::size_t count) {
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mix + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(mix + i), _mm_adds_epi16(a, b));
     }
+#endif
+    for (; i < count; ++i) {
+        mix[i] = static_cast<s16>(std::clamp(mix[i] + samples[i], -32768, 32767));
+    }
+}
 
-    ~CubebSinkStream() override {
-        if (!ctx) {
-            return;
-        }
-
-        if (cubeb_stream_stop(stream_backend) != CUBEB_OK) {
-            LOG_CRITICAL(Audio_Sink, "Error stopping cubeb stream");
-        }
+} // Anonymous namespace
 
-        cubeb_stream_destroy(stream_backend);
-    }
+class CubebSinkStream final : public SinkStream {
+public:
+    CubebSinkStream(u32 sample_rate, u32 num_channels_, bool has_output)
+        : has_output{has_output}, num_channels{std::min(num_channels_, 2u)},
+          rate_ratio{static_cast<double>(sample_rate) / MixSampleRate},
+          time_stretch{sample_rate, num_channels, MixSampleRate}, latency{sample_rate},
+          drift{num_channels}, scratch(queue.Capacity()) {}
 
     void EnqueueSamples(u32 source_num_channels, const std::vector<s16>& samples) override {
+        const std::vector<s16>* input = &samples;
         if (source_num_channels > num_channels) {
             // Downsample 6 channels to 2
-            std::vector<s16> buf;
-            buf.reserve(samples.size() * num_channels / source_num_channels);
+            downmix_buffer.clear();
             for (std::size_t i = 0; i < samples.size(); i += source_num_channels) {
                 for (std::size_t ch = 0; ch < num_channels; ch++) {
-                    buf.push_back(samples[i + ch]);
+                    downmix_buffer.push_back(samples[i + ch]);
                 }
             }
-            queue.Push(buf);
-            return;
+            input = &downmix_buffer;
         }
 
-        queue.Push(samples);
+        const std::size_t pushed = queue.Push(*input);
+        latency.ReportEnqueued(input->size() / num_channels);
+        if (pushed < input->size()) {
+            latency.ReportOverrun((input->size() - pushed) / num_channels);
+        }
     }
 
     std::size_t SamplesInQueue(u32 channel_count) const override {
-        if (!ctx)
+        if (!has_output)
             return 0;
 
         return queue.Size() / channel_count;
@@ -90,27 +86,97 @@ public:
         should_flush = true;
     }
 
-    u32 GetNumChannels() const {
-        return num_channels;
+    SinkLatencyStatistics GetLatencyStatistics() const override {
+        SinkLatencyStatistics statistics = latency.GetStatistics();
+        statistics.is_stretching = is_stretching;
+        return statistics;
     }
 
-private:
-    std::vector<std::string> device_list;
+    /// Resamples the next frames to the host rate and adds them to the stereo mix, called from the
+    /// host stream's callback.
+    void MixInto(s16* mix, std::size_t num_frames);
 
-    cubeb* ctx{};
-    cubeb_stream* stream_backend{};
+private:
+    bool has_output;
     u32 num_channels{};
+    double rate_ratio; ///< Frames consumed per host frame, before drift correction
 
     Common::RingBuffer<s16, 0x10000> queue;
+    Common::MemoryAccounting::TrackedAllocation queue_memory{
+        Common::MemoryAccounting::Tag::AudioBuffers, sizeof(queue)};
     std::array<s16, 2> last_frame{};
     std::atomic<bool> should_flush{};
     TimeStretcher time_stretch;
-
-    static long DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
-                             void* output_buffer, long num_frames);
-    static void StateCallback(cubeb_stream* stream, void* user_data, cubeb_state state);
+    LatencyController latency;
+    DriftCorrector drift;
+    std::atomic<bool> is_stretching{};
+    std::vector<s16> scratch;        ///< Samples popped by the callback
+    std::vector<s16> output;         ///< Samples resampled to the host rate, before mixing
+    std::vector<s16> downmix_buffer; ///< Samples downmixed before they're queued
 };
 
+void CubebSinkStream::MixInto(s16* mix, std::size_t num_frames) {
+    // Far more queued than aimed for, as after the output stalled: catch up at once
+    std::size_t queued_frames = queue.Size() / num_channels;
+    const std::size_t target_frames = latency.GetTargetFrames();
+    if (queued_frames > target_frames * 4) {
+        const std::size_t dropped = queued_frames - target_frames;
+        queue.Pop(scratch.data(), dropped * num_channels);
+        latency.ReportOverrun(dropped);
+        queued_frames = target_frames;
+    }
+
+    // Time stretching is only worth its cost when the emulation is clearly off full speed, small
+    // differences are absorbed by resampling slightly faster or slower
+    const bool use_stretching =
+        Settings::values.enable_audio_stretching && !latency.IsNearFullSpeed();
+    if (use_stretching != is_stretching) {
+        time_stretch.Clear();
+        drift.Clear();
+        is_stretching = use_stretching;
+    }
+
+    // Sized for stereo, mono frames are spread to both channels below
+    output.resize(num_frames * MixNumChannels);
+    std::size_t frames_written;
+    if (use_stretching) {
+        const std::size_t num_in{queue.Pop(scratch.data(), scratch.size()) / num_channels};
+        frames_written = time_stretch.Process(scratch.data(), num_in, output.data(), num_frames);
+
+        if (should_flush) {
+            time_stretch.Flush();
+            should_flush = false;
+        }
+    } else {
+        const auto pop = [this](s16* frames, std::size_t count) {
+            return queue.Pop(frames, count * num_channels) / num_channels;
+        };
+        frames_written = drift.Process(pop, output.data(), num_frames,
+                                       latency.GetDriftRatio(queued_frames) * rate_ratio);
+        should_flush = false;
+    }
+    latency.Update(queued_frames, num_frames, frames_written);
+
+    const std::size_t samples_written = frames_written * num_channels;
+    if (samples_written >= num_channels) {
+        std::memcpy(last_frame.data(), output.data() + samples_written - num_channels,
+                    num_channels * sizeof(s16));
+    }
+
+    // Fill the rest of the frames with last_frame
+    for (std::size_t i = samples_written; i < num_frames * num_channels; i += num_channels) {
+        std::memcpy(output.data() + i, last_frame.data(), num_channels * sizeof(s16));
+    }
+
+    if (num_channels == 1) {
+        for (std::size_t i = num_frames; i-- > 0;) {
+            output[i * 2] = output[i];
+            output[i * 2 + 1] = output[i];
+        }
+    }
+    MixSamples(mix, output.data(), num_frames * MixNumChannels);
+}
+
 CubebSink::CubebSink(std::string_view target_device_name) {
     // Cubeb requires COM to be initialized on the thread calling cubeb_init on Windows
 #ifdef _WIN32
@@ -139,6 +205,30 @@ CubebSink::CubebSink(std::string_view target_device_name) {
             cubeb_device_collection_destroy(ctx, &collection);
         }
     }
+
+    cubeb_stream_params params{};
+    params.rate = MixSampleRate;
+    params.channels = MixNumChannels;
+    params.format = CUBEB_SAMPLE_S16NE;
+    params.layout = CUBEB_LAYOUT_STEREO;
+
+    u32 minimum_latency{};
+    if (cubeb_get_min_latency(ctx, &params, &minimum_latency) != CUBEB_OK) {
+        LOG_CRITICAL(Audio_Sink, "Error getting minimum latency");
+    }
+
+    if (cubeb_stream_init(ctx, &stream_backend, "yuzu", nullptr, nullptr, output_device, &params,
+                          std::max(512u, minimum_latency), &CubebSink::DataCallback,
+                          &CubebSink::StateCallback, this) != CUBEB_OK) {
+        LOG_CRITICAL(Audio_Sink, "Error initializing cubeb stream");
+        stream_backend = nullptr;
+        return;
+    }
+
+    if (cubeb_stream_start(stream_backend) != CUBEB_OK) {
+        LOG_CRITICAL(Audio_Sink, "Error starting cubeb stream");
+        return;
+    }
 }
 
 CubebSink::~CubebSink() {
@@ -146,10 +236,15 @@ CubebSink::~CubebSink() {
         return;
     }
 
-    for (auto& sink_stream : sink_streams) {
-        sink_stream.reset();
+    if (stream_backend) {
+        if (cubeb_stream_stop(stream_backend) != CUBEB_OK) {
+            LOG_CRITICAL(Audio_Sink, "Error stopping cubeb stream");
+        }
+        cubeb_stream_destroy(stream_backend);
     }
 
+    sink_streams.clear();
+
     cubeb_destroy(ctx);
 
 #ifdef _WIN32
@@ -161,54 +256,34 @@ CubebSink::~CubebSink() {
 
 SinkStream& CubebSink::AcquireSinkStream(u32 sample_rate, u32 num_channels,
                                          const std::string& name) {
-    sink_streams.push_back(
-        std::make_unique<CubebSinkStream>(ctx, sample_rate, num_channels, output_device, name));
-    return *sink_streams.back();
-}
+    auto sink_stream =
+        std::make_unique<CubebSinkStream>(sample_rate, num_channels, stream_backend != nullptr);
+    CubebSinkStream& result = *sink_stream;
 
-long CubebSinkStream::DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
-                                   void* output_buffer, long num_frames) {
-    CubebSinkStream* impl = static_cast<CubebSinkStream*>(user_data);
-    u8* buffer = reinterpret_cast<u8*>(output_buffer);
+    std::lock_guard lock{streams_mutex};
+    sink_streams.push_back(std::move(sink_stream));
+    return result;
+}
 
-    if (!impl) {
+long CubebSink::DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
+                             void* output_buffer, long num_frames) {
+    CubebSink* sink = static_cast<CubebSink*>(user_data);
+    s16* const out{static_cast<s16*>(output_buffer)};
+    if (!sink) {
         return {};
     }
 
-    const std::size_t num_channels = impl->GetNumChannels();
-    const std::size_t samples_to_write = num_channels * num_frames;
-    std::size_t samples_written;
-
-    if (Settings::values.enable_audio_stretching) {
-        const std::vector<s16> in{impl->queue.Pop()};
-        const std::size_t num_in{in.size() / num_channels};
-        s16* const out{reinterpret_cast<s16*>(buffer)};
-        const std::size_t out_frames =
-            impl->time_stretch.Process(in.data(), num_in, out, num_frames);
-        samples_written = out_frames * num_channels;
+    const auto frames = static_cast<std::size_t>(num_frames);
+    std::fill_n(out, frames * MixNumChannels, s16{0});
 
-        if (impl->should_flush) {
-            impl->time_stretch.Flush();
-            impl->should_flush = false;
-        }
-    } else {
-        samples_written = impl->queue.Pop(buffer, samples_to_write);
+    std::lock_guard lock{sink->streams_mutex};
+    for (const auto& sink_stream : sink->sink_streams) {
+        sink_stream->MixInto(out, frames);
     }
-
-    if (samples_written >= num_channels) {
-        std::memcpy(&impl->last_frame[0], buffer + (samples_written - num_channels) * sizeof(s16),
-                    num_channels * sizeof(s16));
-    }
-
-    // Fill the rest of the frames with last_frame
-    for (std::size_t i = samples_written; i < samples_to_write; i += num_channels) {
-        std::memcpy(buffer + i * sizeof(s16), &impl->last_frame[0], num_channels * sizeof(s16));
-    }
-
     return num_frames;
 }
 
-void CubebSinkStream::StateCallback(cubeb_stream* stream, void* user_data, cubeb_state state) {}
+void CubebSink::StateCallback(cubeb_stream* stream, void* user_data, cubeb_state state) {}
 
 std::vector<std::string> ListCubebSinkDevices() {
     std::vector<std::string> device_list;
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -13,6 +15,13 @@
 
 namespace AudioCore {
 
+class CubebSinkStream;
+
+/**
+ * Plays every sink stream through a single host stream, mixing them in its callback. This keeps
+ * one host audio thread however many streams the emulated side opens, and one clock they all
+ * drain at.
+ */
 class CubebSink final : public Sink {
 public:
     explicit CubebSink(std::string_view device_id);
@@ -22,9 +31,16 @@ public:
                                   const std::string& name) override;
 
 private:
+    static long DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
+                             void* output_buffer, long num_frames);
+    static void StateCallback(cubeb_stream* stream, void* user_data, cubeb_state state);
+
     cubeb* ctx{};
     cubeb_devid output_device{};
-    std::vector<SinkStreamPtr> sink_streams;
+    cubeb_stream* stream_backend{};
+
+    std::mutex streams_mutex; ///< Guards sink_streams against the host stream's callback
+    std::vector<std::unique_ptr<CubebSinkStream>> sink_streams;
 
 #ifdef _WIN32
     u32 com_init_result = 0;
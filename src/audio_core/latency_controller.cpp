@@ -0,0 +1,174 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "audio_core/latency_controller.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+namespace {
+
+constexpr double InitialTargetMs = 50.0;
+constexpr double MinTargetMs = 20.0;
+constexpr double MaxTargetMs = 300.0;
+
+/// Growth of the target after a window with underruns
+constexpr double GrowFactor = 1.5;
+/// Shrinkage of the target after enough windows without underruns
+constexpr double ShrinkFactor = 0.9;
+constexpr std::size_t CleanWindowsToShrink = 4;
+
+/// Largest correction of the consumption rate, small enough not to be heard as a pitch change
+constexpr double MaxDriftCorrection = 0.005;
+
+/// Speed differences drift correction is used for. Switching back to time stretching takes a
+/// larger difference so that it doesn't flip back and forth around the limit.
+constexpr double NearFullSpeedEnter = 0.03;
+constexpr double NearFullSpeedLeave = 0.06;
+
+std::size_t MsToFrames(double ms, u32 sample_rate) {
+    return static_cast<std::size_t>(ms * sample_rate / 1000.0);
+}
+
+} // Anonymous namespace
+
+LatencyController::LatencyController(u32 sample_rate)
+    : sample_rate{sample_rate}, min_target_frames{MsToFrames(MinTargetMs, sample_rate)},
+      max_target_frames{MsToFrames(MaxTargetMs, sample_rate)},
+      target_frames{MsToFrames(InitialTargetMs, sample_rate)} {}
+
+void LatencyController::Update(std::size_t queued, std::size_t requested_frames,
+                               std::size_t written_frames) {
+    queued_frames = queued;
+    if (written_frames < requested_frames) {
+        ++window_underruns;
+        ++underrun_count;
+    }
+
+    // Windows are half a second of output
+    window_frames += requested_frames;
+    if (window_frames >= sample_rate / 2) {
+        EndWindow();
+    }
+}
+
+void LatencyController::EndWindow() {
+    const std::size_t target = target_frames;
+    if (window_underruns > 0) {
+        target_frames = std::min(static_cast<std::size_t>(target * GrowFactor), max_target_frames);
+        clean_windows = 0;
+    } else if (++clean_windows >= CleanWindowsToShrink) {
+        target_frames =
+            std::max(static_cast<std::size_t>(target * ShrinkFactor), min_target_frames);
+        clean_windows = 0;
+    }
+    if (target != target_frames) {
+        LOG_DEBUG(Audio_Sink, "Target latency {:.1f} ms, {} underruns",
+                  target_frames * 1000.0 / sample_rate, window_underruns);
+    }
+
+    // The emulated side queues whole buffers, a moving average smooths out where they fall
+    const double window_speed =
+        static_cast<double>(enqueued_frames.exchange(0)) / static_cast<double>(window_frames);
+    const double speed = emulation_speed + (window_speed - emulation_speed) * 0.2;
+    emulation_speed = speed;
+
+    const double difference = std::abs(speed - 1.0);
+    if (near_full_speed && difference > NearFullSpeedLeave) {
+        near_full_speed = false;
+    } else if (!near_full_speed && difference < NearFullSpeedEnter) {
+        near_full_speed = true;
+    }
+
+    window_frames = 0;
+    window_underruns = 0;
+}
+
+void LatencyController::ReportEnqueued(std::size_t frames) {
+    enqueued_frames += frames;
+}
+
+void LatencyController::ReportOverrun(std::size_t frames) {
+    ++overrun_count;
+    LOG_TRACE(Audio_Sink, "Dropped {} frames", frames);
+}
+
+std::size_t LatencyController::GetTargetFrames() const {
+    return target_frames;
+}
+
+double LatencyController::GetDriftRatio(std::size_t queued) const {
+    const auto target = static_cast<double>(target_frames);
+    const double error = (static_cast<double>(queued) - target) / target;
+    return 1.0 + std::clamp(error * 0.01, -MaxDriftCorrection, MaxDriftCorrection);
+}
+
+bool LatencyController::IsNearFullSpeed() const {
+    return near_full_speed;
+}
+
+SinkLatencyStatistics LatencyController::GetStatistics() const {
+    SinkLatencyStatistics statistics;
+    statistics.queued_ms = queued_frames * 1000.0 / sample_rate;
+    statistics.target_ms = target_frames * 1000.0 / sample_rate;
+    statistics.underrun_count = underrun_count;
+    statistics.overrun_count = overrun_count;
+    statistics.emulation_speed = emulation_speed;
+    return statistics;
+}
+
+DriftCorrector::DriftCorrector(u32 channel_count) : channel_count{channel_count} {}
+
+std::size_t DriftCorrector::Process(const PopFunction& pop, s16* out, std::size_t num_out,
+                                    double ratio) {
+    if (num_out == 0) {
+        return 0;
+    }
+
+    // Frames up to the one after the last output, which it's interpolated towards
+    const auto needed_frames =
+        static_cast<std::size_t>(position + static_cast<double>(num_out - 1) * ratio) + 2;
+    if (buffered_frames < needed_frames) {
+        input.resize(std::max(input.size(), needed_frames * channel_count));
+        buffered_frames += pop(input.data() + buffered_frames * channel_count,
+                               needed_frames - buffered_frames);
+    }
+
+    std::size_t produced = 0;
+    for (; produced < num_out; ++produced) {
+        const auto index = static_cast<std::size_t>(position);
+        if (index + 1 >= buffered_frames) {
+            break;
+        }
+        const double fraction = position - static_cast<double>(index);
+        const s16* const a = input.data() + index * channel_count;
+        const s16* const b = a + channel_count;
+        for (std::size_t channel = 0; channel < channel_count; ++channel) {
+            const double sample = a[channel] + (b[channel] - a[channel]) * fraction;
+            out[produced * channel_count + channel] = static_cast<s16>(std::lround(sample));
+        }
+        position += ratio;
+    }
+
+    // Keep the frame the position is in, the next output starts from it
+    const std::size_t last_frame = buffered_frames > 0 ? buffered_frames - 1 : 0;
+    const std::size_t consumed = std::min(static_cast<std::size_t>(position), last_frame);
+    if (consumed > 0) {
+        std::memmove(input.data(), input.data() + consumed * channel_count,
+                     (buffered_frames - consumed) * channel_count * sizeof(s16));
+        buffered_frames -= consumed;
+        position -= static_cast<double>(consumed);
+    }
+    return produced;
+}
+
+void DriftCorrector::Clear() {
+    buffered_frames = 0;
+    position = 0.0;
+}
+
+} // namespace AudioCore
@@ -0,0 +1,109 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "audio_core/sink_stream.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Decides how much audio a sink stream keeps queued. The target grows when the backend runs out of
+ * samples and slowly shrinks back once it hasn't for a while, trading latency for fewer dropouts
+ * only where the host needs it.
+ *
+ * Update is called from the backend's callback and ReportEnqueued, ReportOverrun from the thread
+ * feeding the stream. Statistics can be read from anywhere.
+ */
+class LatencyController {
+public:
+    explicit LatencyController(u32 sample_rate);
+
+    /**
+     * Accounts for a buffer handed to the backend.
+     * @param queued_frames Frames that were queued before filling the buffer
+     * @param requested_frames Frames the backend asked for
+     * @param written_frames Frames actually written, fewer than requested is an underrun
+     */
+    void Update(std::size_t queued_frames, std::size_t requested_frames,
+                std::size_t written_frames);
+
+    /// Accounts for frames queued by the emulated side.
+    void ReportEnqueued(std::size_t frames);
+
+    /// Accounts for frames that were dropped because too many were queued.
+    void ReportOverrun(std::size_t frames);
+
+    /// Returns the number of frames the stream aims to keep queued.
+    std::size_t GetTargetFrames() const;
+
+    /// Returns the rate to consume frames at, relative to the output rate, so that the queue
+    /// drifts towards the target without the pitch change being noticeable.
+    double GetDriftRatio(std::size_t queued_frames) const;
+
+    /// Returns true when the emulated side produces frames close enough to the rate they're
+    /// played at for drift correction to keep up, without time stretching.
+    bool IsNearFullSpeed() const;
+
+    SinkLatencyStatistics GetStatistics() const;
+
+private:
+    /// Adjusts the target to what happened over the last window.
+    void EndWindow();
+
+    u32 sample_rate;
+    std::size_t min_target_frames;
+    std::size_t max_target_frames;
+
+    // Only accessed by Update
+    std::size_t window_frames{};
+    std::size_t window_underruns{};
+    std::size_t clean_windows{};
+
+    std::atomic<std::size_t> target_frames;
+    std::atomic<std::size_t> queued_frames{};
+    std::atomic<std::size_t> enqueued_frames{};
+    std::atomic<u64> underrun_count{};
+    std::atomic<u64> overrun_count{};
+    std::atomic<double> emulation_speed{1.0};
+    std::atomic<bool> near_full_speed{true};
+};
+
+/**
+ * Cheap linear resampler for small rate corrections, used instead of time stretching when the
+ * emulated side keeps up. Carries the frames it still interpolates from between calls.
+ */
+class DriftCorrector {
+public:
+    /// Pops up to the given number of frames into the buffer, returning the frames popped
+    using PopFunction = std::function<std::size_t(s16*, std::size_t)>;
+
+    explicit DriftCorrector(u32 channel_count);
+
+    /**
+     * Resamples popped frames into out.
+     * @param pop Source of the input frames
+     * @param out Interleaved output buffer
+     * @param num_out Number of frames to produce
+     * @param ratio Input frames consumed per output frame
+     * @returns The number of frames produced, fewer than num_out when the input ran out
+     */
+    std::size_t Process(const PopFunction& pop, s16* out, std::size_t num_out, double ratio);
+
+    /// Drops the frames carried over.
+    void Clear();
+
+private:
+    u32 channel_count;
+    std::vector<s16> input;
+    std::size_t buffered_frames{};
+    double position{};
+};
+
+} // namespace AudioCore
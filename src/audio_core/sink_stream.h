@@ -11,6 +11,16 @@
 
 namespace AudioCore {
 
+/// Latency of the samples queued in a sink stream
+struct SinkLatencyStatistics {
+    double queued_ms = 0.0;       ///< Duration of the samples currently queued
+    double target_ms = 0.0;       ///< Duration the stream aims to keep queued
+    u64 underrun_count = 0;       ///< Output buffers the queue ran out before filling
+    u64 overrun_count = 0;        ///< Times queued samples were dropped to catch up
+    double emulation_speed = 1.0; ///< Rate samples are queued at, relative to the output rate
+    bool is_stretching = false;   ///< Time stretching is in use rather than drift correction
+};
+
 /**
  * Accepts samples in stereo signed PCM16 format to be output. Sinks *do not* handle resampling and
  * expect the correct sample rate. They are dumb outputs.
@@ -29,6 +39,11 @@ public:
     virtual std::size_t SamplesInQueue(u32 num_channels) const = 0;
 
     virtual void Flush() = 0;
+
+    /// Returns statistics about the latency of the stream, sinks that don't queue have none.
+    virtual SinkLatencyStatistics GetLatencyStatistics() const {
+        return {};
+    }
 };
 
 using SinkStreamPtr = std::unique_ptr<SinkStream>;
@@ -59,6 +59,10 @@ Stream::State Stream::GetState() const {
     return state;
 }
 
+SinkLatencyStatistics Stream::GetLatencyStatistics() const {
+    return sink_stream.GetLatencyStatistics();
+}
+
 s64 Stream::GetBufferReleaseCycles(const Buffer& buffer) const {
     const std::size_t num_samples{buffer.GetSamples().size() / GetNumChannels()};
     const auto us =
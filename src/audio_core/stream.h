@@ -11,6 +11,7 @@
 #include <queue>
 
 #include "audio_core/buffer.h"
+#include "audio_core/sink_stream.h"
 #include "common/common_types.h"
 
 namespace Core::Timing {
@@ -20,8 +21,6 @@ struct EventType;
 
 namespace AudioCore {
 
-class SinkStream;
-
 /**
  * Represents an audio stream, which is a sequence of queued buffers, to be outputed by AudioOut
  */
@@ -88,6 +87,9 @@ public:
     /// Get the state
     State GetState() const;
 
+    /// Gets statistics about the latency of the output sink
+    SinkLatencyStatistics GetLatencyStatistics() const;
+
 private:
     /// Plays the next queued buffer in the audio stream, starting playback if necessary
     void PlayNextBuffer();
@@ -10,10 +10,13 @@
 
 namespace AudioCore {
 
-TimeStretcher::TimeStretcher(u32 sample_rate, u32 channel_count) : m_sample_rate{sample_rate} {
+TimeStretcher::TimeStretcher(u32 sample_rate, u32 channel_count, u32 output_rate)
+    : m_output_rate{output_rate},
+      m_rate_ratio{static_cast<double>(sample_rate) / static_cast<double>(output_rate)} {
     m_sound_touch.setChannels(channel_count);
     m_sound_touch.setSampleRate(sample_rate);
     m_sound_touch.setPitch(1.0);
+    m_sound_touch.setRate(m_rate_ratio);
     m_sound_touch.setTempo(1.0);
 }
 
@@ -27,13 +30,15 @@ void TimeStretcher::Flush() {
 
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
                                    std::size_t num_out) {
-    const double time_delta = static_cast<double>(num_out) / m_sample_rate; // seconds
+    const double time_delta = static_cast<double>(num_out) / m_output_rate; // seconds
 
     // We were given actual_samples number of samples, and num_samples were requested from us.
-    double current_ratio = static_cast<double>(num_in) / static_cast<double>(num_out);
+    // The requested samples are converted to the input rate, resampling isn't stretching.
+    double current_ratio =
+        static_cast<double>(num_in) / (static_cast<double>(num_out) * m_rate_ratio);
 
     const double max_latency = 0.25; // seconds
-    const double max_backlog = m_sample_rate * max_latency;
+    const double max_backlog = m_output_rate * max_latency;
     const double backlog_fullness = m_sound_touch.numSamples() / max_backlog;
     if (backlog_fullness > 4.0) {
         // Too many samples in backlog: Don't push anymore on
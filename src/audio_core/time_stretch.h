@@ -12,7 +12,8 @@ namespace AudioCore {
 
 class TimeStretcher {
 public:
-    TimeStretcher(u32 sample_rate, u32 channel_count);
+    /// Frames go in at sample_rate and come out resampled to output_rate.
+    TimeStretcher(u32 sample_rate, u32 channel_count, u32 output_rate);
 
     /// @param in       Input sample buffer
     /// @param num_in   Number of input frames in `in`
@@ -26,7 +27,8 @@ public:
     void Flush();
 
 private:
-    u32 m_sample_rate;
+    u32 m_output_rate;
+    double m_rate_ratio;
     soundtouch::SoundTouch m_sound_touch;
     double m_stretch_ratio = 1.0;
 };
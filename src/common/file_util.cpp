@@ -3,8 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 #include "common/assert.h"
 #include "common/common_funcs.h"
@@ -343,6 +346,21 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+u64 GetModificationTime(const std::string& filename) {
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#else
+    if (stat(filename.c_str(), &buf) == 0)
+#endif
+    {
+        return static_cast<u64>(buf.st_mtime);
+    }
+
+    LOG_ERROR(Common_Filesystem, "Stat failed {}: {}", filename, GetLastErrorMsg());
+    return 0;
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
@@ -392,9 +410,10 @@ bool ForeachDirectoryEntry(u64* num_entries_out, const std::string& directory,
     // Find the first file in the directory.
     WIN32_FIND_DATAW ffd;
 
-    HANDLE handle_find = FindFirstFileW(Common::UTF8ToUTF16W(directory + "\\*").c_str(), &ffd);
+    HANDLE handle_find = FindFirstFileExW(Common::UTF8ToUTF16W(directory + "\\*").c_str(),
+                                          FindExInfoBasic, &ffd, FindExSearchNameMatch, nullptr,
+                                          FIND_FIRST_EX_LARGE_FETCH);
     if (handle_find == INVALID_HANDLE_VALUE) {
-        FindClose(handle_find);
         return false;
     }
     // windows loop
@@ -437,45 +456,170 @@ bool ForeachDirectoryEntry(u64* num_entries_out, const std::string& directory,
     return true;
 }
 
+#ifndef _WIN32
+/// Returns whether a listed entry is a directory, only calling stat when the listing doesn't say
+static bool IsDirectoryEntry(DIR* dirp, const struct dirent* entry) {
+#ifdef DT_DIR
+    if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK) {
+        return entry->d_type == DT_DIR;
+    }
+#endif
+    struct stat file_info;
+    return fstatat(dirfd(dirp), entry->d_name, &file_info, 0) == 0 && S_ISDIR(file_info.st_mode);
+}
+#endif
+
+bool ForeachDirectoryEntry(const std::string& directory,
+                           const DirectoryEntryTypeCallable& callback) {
+    LOG_TRACE(Common_Filesystem, "directory {}", directory);
+
+    bool callback_error = false;
+#ifdef _WIN32
+    // Large fetches list many entries per request, which matters most on network shares
+    WIN32_FIND_DATAW ffd;
+    HANDLE handle_find = FindFirstFileExW(Common::UTF8ToUTF16W(directory + "\\*").c_str(),
+                                          FindExInfoBasic, &ffd, FindExSearchNameMatch, nullptr,
+                                          FIND_FIRST_EX_LARGE_FETCH);
+    if (handle_find == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    do {
+        const std::string virtual_name(Common::UTF16ToUTF8(ffd.cFileName));
+#else
+    DIR* dirp = opendir(directory.c_str());
+    if (!dirp)
+        return false;
+
+    while (struct dirent* result = readdir(dirp)) {
+        const std::string virtual_name(result->d_name);
+#endif
+
+        if (virtual_name == "." || virtual_name == "..")
+            continue;
+
+#ifdef _WIN32
+        const bool is_directory = (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+        const bool is_directory = IsDirectoryEntry(dirp, result);
+#endif
+
+        if (!callback(directory, virtual_name, is_directory)) {
+            callback_error = true;
+            break;
+        }
+
+#ifdef _WIN32
+    } while (FindNextFileW(handle_find, &ffd) != 0);
+    FindClose(handle_find);
+#else
+    }
+    closedir(dirp);
+#endif
+
+    return !callback_error;
+}
+
+bool WalkDirectoryTree(const std::string& directory, unsigned int recursion,
+                       std::size_t num_threads, const DirectoryEntryTypeCallable& callback) {
+    struct PendingDirectory {
+        std::string path;
+        unsigned int recursion;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<PendingDirectory> pending{{directory, recursion}};
+    std::size_t num_busy = 0;
+    bool failed = false;
+
+    // Each thread lists one directory at a time and queues the subdirectories it finds
+    const auto worker = [&] {
+        std::unique_lock lock{mutex};
+        while (true) {
+            cv.wait(lock, [&] { return failed || !pending.empty() || num_busy == 0; });
+            if (failed || pending.empty()) {
+                break;
+            }
+            PendingDirectory current = std::move(pending.back());
+            pending.pop_back();
+            ++num_busy;
+            lock.unlock();
+
+            std::vector<PendingDirectory> subdirectories;
+            const bool success = ForeachDirectoryEntry(
+                current.path, [&](const std::string& parent, const std::string& virtual_name,
+                                  bool is_directory) {
+                    if (!callback(parent, virtual_name, is_directory)) {
+                        return false;
+                    }
+                    if (is_directory && current.recursion > 0) {
+                        subdirectories.push_back(
+                            {parent + DIR_SEP + virtual_name, current.recursion - 1});
+                    }
+                    return true;
+                });
+
+            lock.lock();
+            --num_busy;
+            if (!success) {
+                failed = true;
+            }
+            for (auto& subdirectory : subdirectories) {
+                pending.push_back(std::move(subdirectory));
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return !failed;
+}
+
 u64 ScanDirectoryTree(const std::string& directory, FSTEntry& parent_entry,
                       unsigned int recursion) {
-    const auto callback = [recursion, &parent_entry](u64* num_entries_out,
-                                                     const std::string& directory,
-                                                     const std::string& virtual_name) -> bool {
+    u64 num_entries = 0;
+    const auto callback = [recursion, &parent_entry, &num_entries](const std::string& directory,
+                                                                   const std::string& virtual_name,
+                                                                   bool is_directory) -> bool {
         FSTEntry entry;
         entry.virtualName = virtual_name;
         entry.physicalName = directory + DIR_SEP + virtual_name;
+        entry.isDirectory = is_directory;
 
-        if (IsDirectory(entry.physicalName)) {
-            entry.isDirectory = true;
+        if (is_directory) {
             // is a directory, lets go inside if we didn't recurse to often
             if (recursion > 0) {
                 entry.size = ScanDirectoryTree(entry.physicalName, entry, recursion - 1);
-                *num_entries_out += entry.size;
+                num_entries += entry.size;
             } else {
                 entry.size = 0;
             }
         } else { // is a file
-            entry.isDirectory = false;
             entry.size = GetSize(entry.physicalName);
         }
-        (*num_entries_out)++;
+        num_entries++;
 
         // Push into the tree
         parent_entry.children.push_back(std::move(entry));
         return true;
     };
 
-    u64 num_entries;
-    return ForeachDirectoryEntry(&num_entries, directory, callback) ? num_entries : 0;
+    return ForeachDirectoryEntry(directory, callback) ? num_entries : 0;
 }
 
 bool DeleteDirRecursively(const std::string& directory, unsigned int recursion) {
-    const auto callback = [recursion](u64* num_entries_out, const std::string& directory,
-                                      const std::string& virtual_name) -> bool {
+    const auto callback = [recursion](const std::string& directory,
+                                      const std::string& virtual_name, bool is_directory) -> bool {
         std::string new_path = directory + DIR_SEP_CHR + virtual_name;
 
-        if (IsDirectory(new_path)) {
+        if (is_directory) {
             if (recursion == 0)
                 return false;
             return DeleteDirRecursively(new_path, recursion - 1);
@@ -483,7 +627,7 @@ bool DeleteDirRecursively(const std::string& directory, unsigned int recursion)
         return Delete(new_path);
     };
 
-    if (!ForeachDirectoryEntry(nullptr, directory, callback))
+    if (!ForeachDirectoryEntry(directory, callback))
         return false;
 
     // Delete the outermost directory
@@ -959,6 +1103,40 @@ u64 IOFile::Tell() const {
     return -1;
 }
 
+std::size_t IOFile::ReadAt(void* data, std::size_t length, u64 offset) const {
+    if (!IsOpen()) {
+        return 0;
+    }
+    u8* const out = static_cast<u8*>(data);
+    std::size_t total = 0;
+    while (total < length) {
+#ifdef _WIN32
+        // Overlapped reads on synchronous handles take their offset from the structure
+        OVERLAPPED overlapped{};
+        const u64 position = offset + total;
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        const DWORD request = static_cast<DWORD>(std::min<std::size_t>(length - total, 1U << 30));
+        DWORD read = 0;
+        const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_file)));
+        if (!ReadFile(handle, out + total, request, &read, &overlapped) || read == 0) {
+            break;
+        }
+#else
+        const ssize_t read =
+            pread(fileno(m_file), out + total, length - total, static_cast<off_t>(offset + total));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            break;
+        }
+#endif
+        total += static_cast<std::size_t>(read);
+    }
+    return total;
+}
+
 bool IOFile::Flush() {
     return IsOpen() && 0 == std::fflush(m_file);
 }
@@ -56,6 +56,9 @@ bool IsDirectory(const std::string& filename);
 // Returns the size of filename (64bit)
 u64 GetSize(const std::string& filename);
 
+// Returns the time filename was last modified in seconds since the epoch, 0 on failure
+u64 GetModificationTime(const std::string& filename);
+
 // Overloaded GetSize, accepts file descriptor
 u64 GetSize(const int fd);
 
@@ -106,6 +109,39 @@ using DirectoryEntryCallable = std::function<bool(
 bool ForeachDirectoryEntry(u64* num_entries_out, const std::string& directory,
                            DirectoryEntryCallable callback);
 
+/**
+ * @param directory the path to the enclosing directory
+ * @param virtual_name the entry name, without any preceding directory info
+ * @param is_directory whether the entry is a directory, symbolic links are followed
+ * @return whether handling the entry succeeded
+ */
+using DirectoryEntryTypeCallable = std::function<bool(
+    const std::string& directory, const std::string& virtual_name, bool is_directory)>;
+
+/**
+ * Scans a directory like ForeachDirectoryEntry, also passing the type of each entry. The type is
+ * taken from the directory listing where the platform and file system provide it, which saves a
+ * stat call per entry.
+ * @param directory the directory to scan
+ * @param callback The callback which will be called for each entry
+ * @return whether scanning the directory succeeded
+ */
+bool ForeachDirectoryEntry(const std::string& directory,
+                           const DirectoryEntryTypeCallable& callback);
+
+/**
+ * Scans a directory tree, calling the callback for each file/directory contained within. With more
+ * than one thread, directories are listed concurrently and the callback is called from several
+ * threads at once, in no particular order. Walking stops when the callback returns failure.
+ * @param directory the directory to start scanning from
+ * @param recursion Number of children directory levels to enter
+ * @param num_threads Number of threads listing directories, the caller included
+ * @param callback The callback which will be called for each entry
+ * @return whether scanning every directory succeeded
+ */
+bool WalkDirectoryTree(const std::string& directory, unsigned int recursion,
+                       std::size_t num_threads, const DirectoryEntryTypeCallable& callback);
+
 /**
  * Scans the directory tree, storing the results.
  * @param directory the parent directory to start scanning from
@@ -263,6 +299,10 @@ public:
         return WriteArray(str.data(), str.length());
     }
 
+    /// Reads from an offset without moving the file position, calls on the same file don't have
+    /// to be serialized. Returns the number of bytes read.
+    std::size_t ReadAt(void* data, std::size_t length, u64 offset) const;
+
     bool IsOpen() const {
         return nullptr != m_file;
     }
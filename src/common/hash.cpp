@@ -0,0 +1,194 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/uint128.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+// The long input loop follows the structure of XXH3: 64 byte stripes are folded into eight 64-bit
+// lanes with 32x32->64 multiplies, which map well to SIMD, and the lanes are scrambled after each
+// block. The constants are yuzu's own, the values don't match XXH3.
+constexpr std::size_t StripeSize = 64;
+constexpr std::size_t NumLanes = StripeSize / sizeof(u64);
+constexpr std::size_t SecretSize = 192;
+constexpr std::size_t SecretStep = 8;
+constexpr std::size_t StripesPerBlock = (SecretSize - StripeSize) / SecretStep;
+constexpr std::size_t StripeBlockSize = StripeSize * StripesPerBlock;
+
+// CityHash is already fast on short inputs, the stripe loop only pays off past a few stripes
+constexpr std::size_t ShortInputLimit = 256;
+
+constexpr u64 Prime32_1 = 0x9E3779B1;
+constexpr u64 Prime32_2 = 0x85EBCA77;
+constexpr u64 Prime32_3 = 0xC2B2AE3D;
+constexpr u64 Prime64_1 = 0x9E3779B185EBCA87;
+constexpr u64 Prime64_2 = 0xC2B2AE3D27D4EB4F;
+constexpr u64 Prime64_3 = 0x165667B19E3779F9;
+constexpr u64 Prime64_4 = 0x85EBCA77C2B2AE63;
+constexpr u64 Prime64_5 = 0x27D4EB2F165667C5;
+
+/// Key material mixed into the input, generated with splitmix64.
+constexpr std::array<u8, SecretSize> secret = [] {
+    std::array<u8, SecretSize> result{};
+    u64 state = 0x79757A75;
+    for (std::size_t i = 0; i < SecretSize; i += sizeof(u64)) {
+        state += 0x9E3779B97F4A7C15;
+        u64 value = state;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        value ^= value >> 31;
+        for (std::size_t byte = 0; byte < sizeof(u64); ++byte) {
+            result[i + byte] = static_cast<u8>(value >> (byte * 8));
+        }
+    }
+    return result;
+}();
+
+u64 Read64(const u8* ptr) {
+    u64 value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+u64 Mul128Fold64(u64 lhs, u64 rhs) {
+    const u128 product = Multiply64Into128(lhs, rhs);
+    return product[0] ^ product[1];
+}
+
+u64 Avalanche(u64 hash) {
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9;
+    return hash ^ (hash >> 32);
+}
+
+using Accumulator = std::array<u64, NumLanes>;
+
+#ifdef ARCHITECTURE_x86_64
+
+void Accumulate(Accumulator& acc, const u8* input, const u8* key) {
+    for (std::size_t i = 0; i < NumLanes / 2; ++i) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+        const __m128i data_key =
+            _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i));
+        const __m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product = _mm_mul_epu32(data_key, data_key_hi);
+        const __m128i data_swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+        __m128i lanes = _mm_load_si128(reinterpret_cast<const __m128i*>(acc.data()) + i);
+        lanes = _mm_add_epi64(_mm_add_epi64(lanes, data_swap), product);
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc.data()) + i, lanes);
+    }
+}
+
+void Scramble(Accumulator& acc, const u8* key) {
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(Prime32_1));
+    for (std::size_t i = 0; i < NumLanes / 2; ++i) {
+        __m128i lanes = _mm_load_si128(reinterpret_cast<const __m128i*>(acc.data()) + i);
+        lanes = _mm_xor_si128(lanes, _mm_srli_epi64(lanes, 47));
+        lanes = _mm_xor_si128(lanes, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i));
+        const __m128i lanes_hi = _mm_shuffle_epi32(lanes, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product_lo = _mm_mul_epu32(lanes, prime);
+        const __m128i product_hi = _mm_mul_epu32(lanes_hi, prime);
+        lanes = _mm_add_epi64(product_lo, _mm_slli_epi64(product_hi, 32));
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc.data()) + i, lanes);
+    }
+}
+
+#else
+
+void Accumulate(Accumulator& acc, const u8* input, const u8* key) {
+    for (std::size_t i = 0; i < NumLanes; ++i) {
+        const u64 data = Read64(input + i * sizeof(u64));
+        const u64 data_key = data ^ Read64(key + i * sizeof(u64));
+        acc[i ^ 1] += data;
+        acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+    }
+}
+
+void Scramble(Accumulator& acc, const u8* key) {
+    for (std::size_t i = 0; i < NumLanes; ++i) {
+        u64 lane = acc[i];
+        lane ^= lane >> 47;
+        lane ^= Read64(key + i * sizeof(u64));
+        acc[i] = lane * Prime32_1;
+    }
+}
+
+#endif
+
+u64 HashLong(const u8* data, std::size_t len) {
+    alignas(16) Accumulator acc{Prime32_3, Prime64_1, Prime64_2, Prime64_3,
+                                Prime64_4, Prime32_2, Prime64_5, Prime32_1};
+
+    const std::size_t num_blocks = (len - 1) / StripeBlockSize;
+    for (std::size_t block = 0; block < num_blocks; ++block) {
+        const u8* const block_data = data + block * StripeBlockSize;
+        for (std::size_t stripe = 0; stripe < StripesPerBlock; ++stripe) {
+            Accumulate(acc, block_data + stripe * StripeSize, secret.data() + stripe * SecretStep);
+        }
+        Scramble(acc, secret.data() + SecretSize - StripeSize);
+    }
+
+    // The last stripe always ends at the end of the input, overlapping the previous one
+    const u8* const tail = data + num_blocks * StripeBlockSize;
+    const std::size_t num_stripes = ((len - 1) - num_blocks * StripeBlockSize) / StripeSize;
+    for (std::size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        Accumulate(acc, tail + stripe * StripeSize, secret.data() + stripe * SecretStep);
+    }
+    Accumulate(acc, data + len - StripeSize, secret.data() + SecretSize - StripeSize - 7);
+
+    u64 result = static_cast<u64>(len) * Prime64_1;
+    for (std::size_t i = 0; i < NumLanes / 2; ++i) {
+        const u8* const key = secret.data() + 11 + i * 16;
+        result += Mul128Fold64(acc[2 * i] ^ Read64(key), acc[2 * i + 1] ^ Read64(key + 8));
+    }
+    return Avalanche(result);
+}
+
+} // Anonymous namespace
+
+u64 ComputeFastHash64(const void* data, std::size_t len) {
+    if (len <= ShortInputLimit) {
+        return CityHash64(static_cast<const char*>(data), len);
+    }
+    return HashLong(static_cast<const u8*>(data), len);
+}
+
+void IncrementalHash::Reset(const void* data, std::size_t size_) {
+    size = size_;
+    block_hashes.resize((size + BlockSize - 1) / BlockSize);
+    Update(data, 0, size);
+}
+
+void IncrementalHash::Update(const void* data, std::size_t offset, std::size_t length) {
+    ASSERT(offset + length <= size);
+    if (length == 0 && size != 0) {
+        return;
+    }
+    const u8* const bytes = static_cast<const u8*>(data);
+    const std::size_t end_block = (offset + length + BlockSize - 1) / BlockSize;
+    for (std::size_t block = offset / BlockSize; block < end_block; ++block) {
+        const std::size_t block_offset = block * BlockSize;
+        const std::size_t block_size = std::min(BlockSize, size - block_offset);
+        block_hashes[block] = ComputeFastHash64(bytes + block_offset, block_size);
+    }
+    CombineBlocks();
+}
+
+void IncrementalHash::CombineBlocks() {
+    hash = ComputeFastHash64(block_hashes.data(), block_hashes.size() * sizeof(u64));
+}
+
+} // namespace Common
@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <cstring>
+#include <vector>
 #include "common/cityhash.h"
 #include "common/common_types.h"
 
@@ -21,6 +22,16 @@ static inline u64 ComputeHash64(const void* data, std::size_t len) {
     return CityHash64(static_cast<const char*>(data), len);
 }
 
+/**
+ * Computes a 64-bit hash over the specified block of data, several times faster than
+ * ComputeHash64 on large blocks. The values may change between versions, so this is only meant
+ * for keys of in-memory caches and never for anything stored on disk.
+ * @param data Block of data to compute hash over
+ * @param len Length of data (in bytes) to compute hash over
+ * @returns 64-bit hash value that was computed over the data block
+ */
+u64 ComputeFastHash64(const void* data, std::size_t len);
+
 /**
  * Computes a 64-bit hash of a struct. In addition to being trivially copyable, it is also critical
  * that either the struct includes no padding, or that any padding is initialized to a known value
@@ -68,4 +79,36 @@ struct HashableStruct {
     }
 };
 
+/**
+ * Fast hash of a buffer kept as the hashes of fixed size blocks, changing a few bytes of the
+ * buffer only rehashes the blocks holding them. The result differs from ComputeFastHash64 over
+ * the whole buffer, both only have to be consistent with themselves.
+ */
+class IncrementalHash {
+public:
+    static constexpr std::size_t BlockSize = 0x1000;
+
+    /// Hashes the whole buffer, replacing the previous one.
+    void Reset(const void* data, std::size_t size);
+
+    /**
+     * Rehashes the blocks overlapping the range after it has been modified
+     * @param data   Start of the whole buffer, with the size given on the last Reset
+     * @param offset Offset of the modified range in bytes
+     * @param length Length of the modified range in bytes
+     */
+    void Update(const void* data, std::size_t offset, std::size_t length);
+
+    u64 Get() const {
+        return hash;
+    }
+
+private:
+    void CombineBlocks();
+
+    std::vector<u64> block_hashes;
+    std::size_t size = 0;
+    u64 hash = 0;
+};
+
 } // namespace Common
@@ -0,0 +1,197 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "common/assert.h"
+#include "common/bit_util.h"
+#include "common/common_types.h"
+
+namespace Common {
+
+template <typename T, std::size_t Depth>
+class IntrusivePriorityQueue;
+
+/// Links of an element in an IntrusivePriorityQueue. Elements embed one of these and return it
+/// from their GetPriorityQueueLink() member.
+template <typename T, std::size_t Depth>
+struct PriorityQueueLink {
+    IntrusivePriorityQueue<T, Depth>* queue = nullptr; ///< Queue holding the element, if any.
+    T* prev = nullptr;
+    T* next = nullptr;
+    u32 priority = 0;
+};
+
+/**
+ * A priority queue of elements which carry their own links.
+ * - discrete priorities and a max of 64 priorities, lower values are served first
+ * - FIFO order within a priority
+ * - O(1) insertion at either end of a priority, removal of any element and lookup of the front
+ * Unlike MultiLevelQueue nothing is allocated, and elements are removed without searching for
+ * them. An element is part of at most one queue at a time, pushing an element which is already
+ * queued moves it.
+ */
+template <typename T, std::size_t Depth>
+class IntrusivePriorityQueue {
+    static_assert(Depth <= 64, "Priorities are tracked in a 64-bit mask");
+
+public:
+    IntrusivePriorityQueue() = default;
+    ~IntrusivePriorityQueue() = default;
+
+    IntrusivePriorityQueue(const IntrusivePriorityQueue&) = delete;
+    IntrusivePriorityQueue& operator=(const IntrusivePriorityQueue&) = delete;
+
+    /// Appends an element to the end of the given priority.
+    void PushBack(T* element, u32 priority) {
+        ASSERT(priority < Depth);
+        Unlink(element);
+        auto& link = Link(element);
+        Level& level = levels[priority];
+
+        link = {this, level.tail, nullptr, priority};
+        if (level.tail != nullptr) {
+            Link(level.tail).next = element;
+        } else {
+            level.head = element;
+            used_priorities |= 1ULL << priority;
+        }
+        level.tail = element;
+        ++size;
+    }
+
+    /// Inserts an element in front of every other element of the given priority.
+    void PushFront(T* element, u32 priority) {
+        ASSERT(priority < Depth);
+        Unlink(element);
+        auto& link = Link(element);
+        Level& level = levels[priority];
+
+        link = {this, nullptr, level.head, priority};
+        if (level.head != nullptr) {
+            Link(level.head).prev = element;
+        } else {
+            level.tail = element;
+            used_priorities |= 1ULL << priority;
+        }
+        level.head = element;
+        ++size;
+    }
+
+    /// Removes an element. Does nothing if the element is not part of this queue.
+    void Remove(T* element) {
+        auto& link = Link(element);
+        if (link.queue != this) {
+            return;
+        }
+        Level& level = levels[link.priority];
+
+        if (link.prev != nullptr) {
+            Link(link.prev).next = link.next;
+        } else {
+            level.head = link.next;
+        }
+        if (link.next != nullptr) {
+            Link(link.next).prev = link.prev;
+        } else {
+            level.tail = link.prev;
+        }
+        if (level.head == nullptr) {
+            used_priorities &= ~(1ULL << link.priority);
+        }
+
+        link = {};
+        --size;
+    }
+
+    /// Moves an element of this queue to the end of another priority.
+    void ChangePriority(T* element, u32 priority) {
+        if (Link(element).queue != this) {
+            return;
+        }
+        Remove(element);
+        PushBack(element, priority);
+    }
+
+    bool Contains(const T* element) const {
+        return Link(element).queue == this;
+    }
+
+    bool Empty() const {
+        return used_priorities == 0;
+    }
+
+    bool Empty(u32 priority) const {
+        return (used_priorities & (1ULL << priority)) == 0;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    /// Returns the highest priority that holds an element, or Depth if the queue is empty.
+    u32 HighestPriority() const {
+        return used_priorities == 0 ? static_cast<u32>(Depth)
+                                    : static_cast<u32>(CountTrailingZeroes64(used_priorities));
+    }
+
+    /// Returns the first element of the highest priority, or null if the queue is empty.
+    T* Front() const {
+        return used_priorities == 0 ? nullptr : levels[HighestPriority()].head;
+    }
+
+    /// Returns the first element of the given priority, or null if it holds none.
+    T* Front(u32 priority) const {
+        return levels[priority].head;
+    }
+
+    /**
+     * Returns the element served after the given one, continuing with the next used priority at
+     * the end of a priority. Returns null after the last element.
+     */
+    T* Next(const T* element) const {
+        const auto& link = Link(element);
+        if (link.next != nullptr) {
+            return link.next;
+        }
+
+        const u64 later_priorities = used_priorities & ~((2ULL << link.priority) - 1);
+        if (later_priorities == 0) {
+            return nullptr;
+        }
+        return levels[CountTrailingZeroes64(later_priorities)].head;
+    }
+
+private:
+    struct Level {
+        T* head = nullptr;
+        T* tail = nullptr;
+    };
+
+    using LinkType = PriorityQueueLink<T, Depth>;
+
+    static LinkType& Link(T* element) {
+        return element->GetPriorityQueueLink();
+    }
+
+    static const LinkType& Link(const T* element) {
+        return element->GetPriorityQueueLink();
+    }
+
+    /// Takes an element out of whichever queue currently holds it.
+    static void Unlink(T* element) {
+        if (auto* const queue = Link(element).queue) {
+            queue->Remove(element);
+        }
+    }
+
+    std::array<Level, Depth> levels{};
+    u64 used_priorities = 0;
+    std::size_t size = 0;
+};
+
+} // namespace Common
@@ -7,9 +7,12 @@
 #include <chrono>
 #include <climits>
 #include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 #ifdef _WIN32
 #include <share.h>   // For _SH_DENYWR
@@ -21,11 +24,53 @@
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
+#include "common/ring_buffer.h"
 #include "common/string_util.h"
-#include "common/threadsafe_queue.h"
 
 namespace Log {
 
+namespace {
+
+/// Records each thread can queue before it has to wait for the logging thread.
+constexpr std::size_t ThreadRingCapacity = 1024;
+
+/// Ring buffer of the records logged by one thread, owned by the thread and the logger.
+struct ThreadRing {
+    Common::RingBuffer<Detail::Record, ThreadRingCapacity> records;
+    std::atomic<bool> thread_exited{false};
+};
+
+/// Marks the ring of a thread as abandoned when the thread exits.
+class ThreadRingHandle {
+public:
+    ~ThreadRingHandle() {
+        if (ring) {
+            ring->thread_exited = true;
+        }
+    }
+
+    std::shared_ptr<ThreadRing> ring;
+};
+
+thread_local ThreadRingHandle thread_ring;
+thread_local bool is_logging_thread = false;
+
+std::string FormatInlineMessage(const char*, const u8* arguments) {
+    u32 length;
+    std::memcpy(&length, arguments, sizeof(length));
+    return std::string(reinterpret_cast<const char*>(arguments + sizeof(length)), length);
+}
+
+std::string TakeHeapMessage(const char*, const u8* arguments) {
+    std::string* message;
+    std::memcpy(&message, arguments, sizeof(message));
+    std::string result = std::move(*message);
+    delete message;
+    return result;
+}
+
+} // Anonymous namespace
+
 /**
  * Static state as a singleton.
  */
@@ -39,10 +84,26 @@ public:
     Impl(Impl const&) = delete;
     const Impl& operator=(Impl const&) = delete;
 
-    void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, std::string message) {
-        message_queue.Push(
-            CreateEntry(log_class, log_level, filename, line_num, function, std::move(message)));
+    void PushRecord(Detail::Record& record) {
+        using std::chrono::duration_cast;
+        using std::chrono::steady_clock;
+
+        record.timestamp =
+            duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin).count();
+
+        ThreadRing& ring = GetThreadRing();
+        while (ring.records.Push(&record, 1) == 0) {
+            if (is_logging_thread) {
+                // Nobody else is going to drain it, drop the message
+                if (record.formatter == &TakeHeapMessage) {
+                    delete TakeHeapPointer(record);
+                }
+                return;
+            }
+            WakeLoggingThread();
+            std::this_thread::yield();
+        }
+        WakeLoggingThread();
     }
 
     void AddBackend(std::unique_ptr<Backend> backend) {
@@ -64,6 +125,10 @@ public:
 
     void SetGlobalFilter(const Filter& f) {
         filter = f;
+        for (std::size_t i = 0; i < Detail::class_levels.size(); ++i) {
+            Detail::class_levels[i].store(filter.GetClassLevel(static_cast<Class>(i)),
+                                          std::memory_order_relaxed);
+        }
     }
 
     Backend* GetBackend(std::string_view backend_name) {
@@ -78,52 +143,130 @@ public:
 private:
     Impl() {
         backend_thread = std::thread([&] {
-            Entry entry;
-            auto write_logs = [&](Entry& e) {
+            is_logging_thread = true;
+
+            std::vector<std::shared_ptr<ThreadRing>> active_rings;
+            std::vector<Detail::Record> batch;
+            const auto write_logs = [&](std::size_t max_logs) {
+                // Threads log concurrently, interleave their records back in time order
+                std::stable_sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) {
+                    return a.timestamp < b.timestamp;
+                });
                 std::lock_guard lock{writing_mutex};
-                for (const auto& backend : backends) {
-                    backend->Write(e);
+                for (std::size_t i = 0; i < batch.size(); ++i) {
+                    if (i < max_logs) {
+                        const Entry entry = CreateEntry(batch[i]);
+                        for (const auto& backend : backends) {
+                            backend->Write(entry);
+                        }
+                    } else if (batch[i].formatter == &TakeHeapMessage) {
+                        delete TakeHeapPointer(batch[i]);
+                    }
                 }
+                batch.clear();
             };
-            while (true) {
-                entry = message_queue.PopWait();
-                if (entry.final_entry) {
-                    break;
+
+            while (!stop_requested) {
+                CollectRecords(active_rings, batch);
+                if (!batch.empty()) {
+                    write_logs(batch.size());
+                    continue;
+                }
+
+                std::unique_lock lock{wake_mutex};
+                logging_thread_sleeping = true;
+                if (!HasPendingRecords(active_rings) && !stop_requested) {
+                    wake_cv.wait_for(lock, std::chrono::milliseconds(100));
                 }
-                write_logs(entry);
+                logging_thread_sleeping = false;
             }
 
             // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a case
             // where a system is repeatedly spamming logs even on close.
-            const int MAX_LOGS_TO_WRITE = filter.IsDebug() ? INT_MAX : 100;
-            int logs_written = 0;
-            while (logs_written++ < MAX_LOGS_TO_WRITE && message_queue.Pop(entry)) {
-                write_logs(entry);
-            }
+            const std::size_t MAX_LOGS_TO_WRITE = filter.IsDebug() ? SIZE_MAX : 100;
+            CollectRecords(active_rings, batch);
+            write_logs(MAX_LOGS_TO_WRITE);
         });
     }
 
     ~Impl() {
-        Entry entry;
-        entry.final_entry = true;
-        message_queue.Push(entry);
+        {
+            std::lock_guard lock{wake_mutex};
+            stop_requested = true;
+        }
+        wake_cv.notify_one();
         backend_thread.join();
     }
 
-    Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
-                      const char* function, std::string message) const {
-        using std::chrono::duration_cast;
-        using std::chrono::steady_clock;
+    ThreadRing& GetThreadRing() {
+        if (!thread_ring.ring) {
+            thread_ring.ring = std::make_shared<ThreadRing>();
+            std::lock_guard lock{rings_mutex};
+            new_rings.push_back(thread_ring.ring);
+        }
+        return *thread_ring.ring;
+    }
+
+    void WakeLoggingThread() {
+        // Sequentially consistent with the ring's write index, either the logging thread sees
+        // the new record before sleeping or this sees it going to sleep.
+        if (logging_thread_sleeping && logging_thread_sleeping.exchange(false)) {
+            std::lock_guard lock{wake_mutex};
+            wake_cv.notify_one();
+        }
+    }
+
+    void CollectRecords(std::vector<std::shared_ptr<ThreadRing>>& active_rings,
+                        std::vector<Detail::Record>& batch) {
+        {
+            std::lock_guard lock{rings_mutex};
+            active_rings.insert(active_rings.end(), new_rings.begin(), new_rings.end());
+            new_rings.clear();
+        }
+        for (auto it = active_rings.begin(); it != active_rings.end();) {
+            ThreadRing& ring = **it;
+            // Check for exit first, so records pushed right before exiting are still collected
+            const bool exited = ring.thread_exited;
+            const std::size_t offset = batch.size();
+            batch.resize(offset + ring.records.Size());
+            batch.resize(offset + ring.records.Pop(batch.data() + offset, batch.size() - offset));
+            if (exited && ring.records.Size() == 0) {
+                it = active_rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    bool HasPendingRecords(const std::vector<std::shared_ptr<ThreadRing>>& active_rings) {
+        std::lock_guard lock{rings_mutex};
+        if (!new_rings.empty()) {
+            return true;
+        }
+        return std::any_of(active_rings.begin(), active_rings.end(),
+                           [](const auto& ring) { return ring->records.Size() != 0; });
+    }
 
+    static std::string* TakeHeapPointer(const Detail::Record& record) {
+        std::string* message;
+        std::memcpy(&message, record.arguments.data(), sizeof(message));
+        return message;
+    }
+
+    static Entry CreateEntry(const Detail::Record& record) {
         Entry entry;
-        entry.timestamp =
-            duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
-        entry.log_class = log_class;
-        entry.log_level = log_level;
-        entry.filename = Common::TrimSourcePath(filename);
-        entry.line_num = line_nr;
-        entry.function = function;
-        entry.message = std::move(message);
+        entry.timestamp = std::chrono::microseconds{record.timestamp};
+        entry.log_class = record.log_class;
+        entry.log_level = record.log_level;
+        entry.filename = Common::TrimSourcePath(record.filename);
+        entry.line_num = record.line_num;
+        entry.function = record.function;
+        try {
+            entry.message = record.formatter(record.format, record.arguments.data());
+        } catch (const fmt::format_error& error) {
+            entry.message = fmt::format("Invalid log format \"{}\": {}", record.format,
+                                        error.what());
+        }
 
         return entry;
     }
@@ -131,9 +274,17 @@ private:
     std::mutex writing_mutex;
     std::thread backend_thread;
     std::vector<std::unique_ptr<Backend>> backends;
-    Common::MPSCQueue<Log::Entry> message_queue;
     Filter filter;
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
+
+    /// Rings of threads that logged for the first time, picked up by the logging thread
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<ThreadRing>> new_rings;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::atomic<bool> logging_thread_sleeping{false};
+    std::atomic<bool> stop_requested{false};
 };
 
 void ConsoleBackend::Write(const Entry& entry) {
@@ -309,15 +460,38 @@ Backend* GetBackend(std::string_view backend_name) {
     return Impl::Instance().GetBackend(backend_name);
 }
 
-void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
-                       unsigned int line_num, const char* function, const char* format,
-                       const fmt::format_args& args) {
-    auto& instance = Impl::Instance();
-    const auto& filter = instance.GetGlobalFilter();
-    if (!filter.CheckMessage(log_class, log_level))
-        return;
+namespace Detail {
+
+namespace {
+template <std::size_t... indices>
+constexpr std::array<std::atomic<Level>, sizeof...(indices)> MakeClassLevels(
+    std::index_sequence<indices...>) {
+    return {{((void)indices, Level::Info)...}};
+}
+} // Anonymous namespace
+
+// Matches the default filter until one is set
+std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> class_levels =
+    MakeClassLevels(std::make_index_sequence<static_cast<std::size_t>(Class::Count)>{});
+
+void PushRecord(Record& record) {
+    Impl::Instance().PushRecord(record);
+}
 
-    instance.PushEntry(log_class, log_level, filename, line_num, function,
-                       fmt::vformat(format, args));
+void PushFormattedRecord(Record& record, std::string message) {
+    if (sizeof(u32) + message.size() <= RecordArgumentsSize) {
+        const auto length = static_cast<u32>(message.size());
+        std::memcpy(record.arguments.data(), &length, sizeof(length));
+        std::memcpy(record.arguments.data() + sizeof(length), message.data(), message.size());
+        record.formatter = &FormatInlineMessage;
+    } else {
+        // Too long for the record, hand the string itself over to the logging thread
+        auto* const heap_message = new std::string(std::move(message));
+        std::memcpy(record.arguments.data(), &heap_message, sizeof(heap_message));
+        record.formatter = &TakeHeapMessage;
+    }
+    Impl::Instance().PushRecord(record);
 }
+
+} // namespace Detail
 } // namespace Log
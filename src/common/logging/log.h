@@ -4,8 +4,13 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
 #include <fmt/format.h>
 #include "common/common_types.h"
+#include "common/logging/record.h"
 
 namespace Log {
 
@@ -125,40 +130,89 @@ enum class Class : ClassType {
     Count              ///< Total number of logging classes
 };
 
-/// Logs a message to the global logger, using fmt
-void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
-                       unsigned int line_num, const char* function, const char* format,
-                       const fmt::format_args& args);
+namespace Detail {
+
+/// Minimum level of every class, mirrors the global filter so that it can be checked inline.
+extern std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> class_levels;
+
+/// Returns true when messages of this class and level pass the global filter.
+inline bool IsLevelEnabled(Class log_class, Level log_level) {
+    return static_cast<u8>(log_level) >=
+           static_cast<u8>(class_levels[static_cast<std::size_t>(log_class)].load(
+               std::memory_order_relaxed));
+}
+
+} // namespace Detail
+
+/**
+ * Format string of a log message. Literals live for the whole program, so their formatting can be
+ * deferred to the logging thread, other strings are formatted right away.
+ */
+struct FormatString {
+    template <std::size_t N>
+    constexpr FormatString(const char (&literal)[N]) : string{literal}, is_literal{true} {}
 
+    template <typename T, typename = std::enable_if_t<std::is_same_v<T, const char*> ||
+                                                      std::is_same_v<T, char*>>>
+    constexpr FormatString(const T& pointer) : string{pointer}, is_literal{false} {}
+
+    const char* string;
+    bool is_literal;
+};
+
+/// Logs a message to the global logger, using fmt
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, const char* format, const Args&... args) {
-    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
-                      fmt::make_format_args(args...));
+                   const char* function, FormatString format, const Args&... args) {
+    if (!Detail::IsLevelEnabled(log_class, log_level)) {
+        return;
+    }
+
+    Detail::Record record;
+    record.filename = filename;
+    record.function = function;
+    record.format = format.string;
+    record.line_num = line_num;
+    record.log_class = log_class;
+    record.log_level = log_level;
+    if constexpr ((Detail::IsCapturableArgument<Detail::CapturedType<Args>> && ...)) {
+        if (format.is_literal &&
+            Detail::CaptureArguments<Detail::CapturedType<Args>...>(record, args...)) {
+            Detail::PushRecord(record);
+            return;
+        }
+    }
+    Detail::PushFormattedRecord(record,
+                                fmt::vformat(format.string, fmt::make_format_args(args...)));
 }
 
 } // namespace Log
 
-#ifdef _DEBUG
+// The filter is checked before the arguments are evaluated, filtered messages cost a table lookup
+#define LOG_GENERIC(log_class, log_level, ...)                                                     \
+    (::Log::Detail::IsLevelEnabled(log_class, log_level)                                           \
+         ? ::Log::FmtLogMessage(log_class, log_level, __FILE__, __LINE__, __func__, __VA_ARGS__)   \
+         : void(0))
+
+// YUZU_STRIP_DEBUG_LOGS compiles Trace and Debug messages out of release builds
+#if defined(_DEBUG) && !defined(YUZU_STRIP_DEBUG_LOGS)
 #define LOG_TRACE(log_class, ...)                                                                  \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Trace, __FILE__, __LINE__,         \
-                         __func__, __VA_ARGS__)
+    LOG_GENERIC(::Log::Class::log_class, ::Log::Level::Trace, __VA_ARGS__)
 #else
 #define LOG_TRACE(log_class, fmt, ...) (void(0))
 #endif
 
+#ifndef YUZU_STRIP_DEBUG_LOGS
 #define LOG_DEBUG(log_class, ...)                                                                  \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Debug, __FILE__, __LINE__,         \
-                         __func__, __VA_ARGS__)
+    LOG_GENERIC(::Log::Class::log_class, ::Log::Level::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(log_class, ...) (void(0))
+#endif
 #define LOG_INFO(log_class, ...)                                                                   \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Info, __FILE__, __LINE__,          \
-                         __func__, __VA_ARGS__)
+    LOG_GENERIC(::Log::Class::log_class, ::Log::Level::Info, __VA_ARGS__)
 #define LOG_WARNING(log_class, ...)                                                                \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Warning, __FILE__, __LINE__,       \
-                         __func__, __VA_ARGS__)
+    LOG_GENERIC(::Log::Class::log_class, ::Log::Level::Warning, __VA_ARGS__)
 #define LOG_ERROR(log_class, ...)                                                                  \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Error, __FILE__, __LINE__,         \
-                         __func__, __VA_ARGS__)
+    LOG_GENERIC(::Log::Class::log_class, ::Log::Level::Error, __VA_ARGS__)
 #define LOG_CRITICAL(log_class, ...)                                                               \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Critical, __FILE__, __LINE__,      \
-                         __func__, __VA_ARGS__)
+    LOG_GENERIC(::Log::Class::log_class, ::Log::Level::Critical, __VA_ARGS__)
@@ -0,0 +1,147 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <fmt/format.h>
+#include "common/common_types.h"
+
+namespace Log {
+
+enum class Class : u8;
+enum class Level : u8;
+
+namespace Detail {
+
+/// Formats the arguments captured in a record, runs on the backend thread.
+using RecordFormatter = std::string (*)(const char* format, const u8* arguments);
+
+constexpr std::size_t RecordSize = 256;
+constexpr std::size_t RecordHeaderSize = 48;
+constexpr std::size_t RecordArgumentsSize = RecordSize - RecordHeaderSize;
+
+/**
+ * Fixed-size binary log record, copied as is through the per-thread ring buffers. Format arguments
+ * are stored raw and only formatted by the backend thread.
+ */
+struct Record {
+    s64 timestamp; ///< Microseconds since the logger started
+    const char* filename;
+    const char* function;
+    const char* format;
+    RecordFormatter formatter;
+    u32 line_num;
+    Class log_class;
+    Level log_level;
+    std::array<u8, RecordArgumentsSize> arguments;
+};
+static_assert(sizeof(Record) == RecordSize, "Record has the wrong size");
+static_assert(std::is_trivial_v<Record>, "Record must be trivial to live in a ring buffer");
+
+/// Type an argument is captured as, string literals become pointers to const characters.
+template <typename T>
+using CapturedType = std::decay_t<const T>;
+
+/// Strings are copied into the record, they are usually gone by the time it gets formatted.
+template <typename T>
+constexpr bool IsStringArgument =
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+    std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+/// Values that are formatted the same from a byte copy. Anything else is formatted by the caller.
+template <typename T>
+constexpr bool IsCapturableArgument =
+    IsStringArgument<T> || std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>;
+
+template <typename T>
+using DecodedArgument = std::conditional_t<IsStringArgument<T>, std::string_view, T>;
+
+template <typename T>
+std::string_view AsStringView(const T& value) {
+    if constexpr (std::is_pointer_v<T>) {
+        return value != nullptr ? std::string_view{value} : std::string_view{};
+    } else {
+        return value;
+    }
+}
+
+template <typename T>
+std::size_t EncodedSize(const T& value) {
+    if constexpr (IsStringArgument<T>) {
+        return sizeof(u32) + AsStringView(value).size();
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <typename T>
+void EncodeArgument(u8*& cursor, const T& value) {
+    if constexpr (IsStringArgument<T>) {
+        const std::string_view string = AsStringView(value);
+        const auto length = static_cast<u32>(string.size());
+        std::memcpy(cursor, &length, sizeof(length));
+        std::memcpy(cursor + sizeof(length), string.data(), string.size());
+        cursor += sizeof(length) + string.size();
+    } else {
+        std::memcpy(cursor, &value, sizeof(T));
+        cursor += sizeof(T);
+    }
+}
+
+template <typename T>
+DecodedArgument<T> DecodeArgument(const u8*& cursor) {
+    if constexpr (IsStringArgument<T>) {
+        u32 length;
+        std::memcpy(&length, cursor, sizeof(length));
+        const std::string_view string{reinterpret_cast<const char*>(cursor + sizeof(length)),
+                                      length};
+        cursor += sizeof(length) + length;
+        return string;
+    } else {
+        T value;
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+}
+
+template <typename... Args>
+std::string FormatRecord(const char* format, const u8* arguments) {
+    [[maybe_unused]] const u8* cursor = arguments;
+    // Braced initialization decodes the arguments in order
+    const std::tuple<DecodedArgument<Args>...> values{DecodeArgument<Args>(cursor)...};
+    return std::apply(
+        [format](const auto&... decoded) {
+            return fmt::vformat(format, fmt::make_format_args(decoded...));
+        },
+        values);
+}
+
+/// Captures the arguments into the record, returns false when they don't fit.
+template <typename... Args>
+bool CaptureArguments(Record& record, const Args&... args) {
+    if ((EncodedSize(args) + ... + std::size_t{0}) > RecordArgumentsSize) {
+        return false;
+    }
+    [[maybe_unused]] u8* cursor = record.arguments.data();
+    (EncodeArgument(cursor, args), ...);
+    record.formatter = &FormatRecord<Args...>;
+    return true;
+}
+
+/// Timestamps a record with captured arguments and queues it on this thread's ring buffer.
+void PushRecord(Record& record);
+
+/// Queues a record with an already formatted message.
+void PushFormattedRecord(Record& record, std::string message);
+
+} // namespace Detail
+} // namespace Log
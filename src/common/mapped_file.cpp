@@ -0,0 +1,88 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef _WIN32
+#include <windows.h>
+#include "common/string_util.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/common_funcs.h"
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+
+namespace Common {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    const HANDLE file = CreateFileW(UTF8ToUTF16W(path).c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER file_size{};
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        // The mapping keeps the file open, its handle isn't needed anymore
+        mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (mapping_handle == nullptr) {
+        return;
+    }
+    data = static_cast<const u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Failed to map {}: {}", path, GetLastErrorMsg());
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+        return;
+    }
+    size = static_cast<std::size_t>(file_size.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping_handle != nullptr) {
+        CloseHandle(mapping_handle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    struct stat file_stat {};
+    // Empty files and special files can't be mapped
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        const auto file_size = static_cast<std::size_t>(file_stat.st_size);
+        void* const pointer = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (pointer != MAP_FAILED) {
+            data = static_cast<const u8*>(pointer);
+            size = file_size;
+        } else {
+            LOG_WARNING(Common_Filesystem, "Failed to map {}: {}", path, GetLastErrorMsg());
+        }
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(const_cast<u8*>(data), size);
+    }
+}
+
+#endif
+
+} // namespace Common
@@ -0,0 +1,46 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Maps a whole host file into memory for reading. The contents can be accessed in place, pages
+ * are only read from disk the first time they're touched.
+ */
+class MappedFile final {
+public:
+    /// Maps the file at path, IsOpen returns false when it can't be mapped.
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* Data() const {
+        return data;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+private:
+    const u8* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
+} // namespace Common
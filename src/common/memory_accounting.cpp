@@ -0,0 +1,94 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <utility>
+#include "common/memory_accounting.h"
+
+namespace Common::MemoryAccounting {
+
+namespace {
+
+constexpr std::size_t NumTags = static_cast<std::size_t>(Tag::NumTags);
+
+constexpr std::array<const char*, NumTags> TagNames{
+    "GuestMemory",  "JitCodeCache", "TextureStaging", "TextureSurfaces", "ShaderPrograms",
+    "VulkanMemory", "RomFS",        "FileSystemCache", "AudioBuffers",
+};
+
+struct Counters {
+    std::atomic<u64> current{};
+    std::atomic<u64> peak{};
+};
+
+// Constant initialized, allocations made by static objects are accounted too
+std::array<Counters, NumTags> counters;
+
+Counters& GetCounters(Tag tag) {
+    return counters[static_cast<std::size_t>(tag)];
+}
+
+} // Anonymous namespace
+
+void Allocate(Tag tag, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    Counters& tag_counters = GetCounters(tag);
+    const u64 current = tag_counters.current.fetch_add(size, std::memory_order_relaxed) + size;
+    u64 peak = tag_counters.peak.load(std::memory_order_relaxed);
+    while (peak < current &&
+           !tag_counters.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+}
+
+void Free(Tag tag, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    GetCounters(tag).current.fetch_sub(size, std::memory_order_relaxed);
+}
+
+std::vector<Statistics> GetStatistics() {
+    std::vector<Statistics> statistics;
+    statistics.reserve(NumTags);
+    for (std::size_t tag = 0; tag < NumTags; ++tag) {
+        statistics.push_back({TagNames[tag],
+                              counters[tag].current.load(std::memory_order_relaxed),
+                              counters[tag].peak.load(std::memory_order_relaxed)});
+    }
+    return statistics;
+}
+
+TrackedAllocation::TrackedAllocation(Tag tag, std::size_t size) : tag{tag}, size{size} {
+    Allocate(tag, size);
+}
+
+TrackedAllocation::~TrackedAllocation() {
+    Free(tag, size);
+}
+
+TrackedAllocation::TrackedAllocation(TrackedAllocation&& other) noexcept
+    : tag{other.tag}, size{std::exchange(other.size, 0)} {}
+
+TrackedAllocation& TrackedAllocation::operator=(TrackedAllocation&& other) noexcept {
+    if (this != &other) {
+        Free(tag, size);
+        tag = other.tag;
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+void TrackedAllocation::Resize(std::size_t new_size) {
+    if (new_size > size) {
+        Allocate(tag, new_size - size);
+    } else {
+        Free(tag, size - new_size);
+    }
+    size = new_size;
+}
+
+} // namespace Common::MemoryAccounting
@@ -0,0 +1,69 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common::MemoryAccounting {
+
+/// Subsystems whose host memory usage is accounted.
+enum class Tag : u32 {
+    GuestMemory,     ///< Host memory backing the guest physical memory
+    JitCodeCache,    ///< Code caches of the dynarmic JITs
+    TextureStaging,  ///< Staging buffers of the texture cache
+    TextureSurfaces, ///< Host size of the surfaces resident in the texture cache
+    ShaderPrograms,  ///< Host programs built by the OpenGL shader cache
+    VulkanMemory,    ///< Device memory allocated by the Vulkan memory manager
+    RomFS,           ///< RomFS metadata tables copied in memory
+    FileSystemCache, ///< Blocks cached by the VFS block cache and NCZ files
+    AudioBuffers,    ///< Sample ring buffers of the audio sinks
+    NumTags,
+};
+
+struct Statistics {
+    const char* name;
+    u64 current_bytes; ///< Bytes currently accounted under the tag.
+    u64 peak_bytes;    ///< Highest number of bytes that were accounted at once.
+};
+
+/// Records an allocation under a tag, can be called from any thread.
+void Allocate(Tag tag, std::size_t size);
+
+/// Records the release of memory recorded with Allocate.
+void Free(Tag tag, std::size_t size);
+
+/// Returns the usage of every tag, in the order of the tags.
+std::vector<Statistics> GetStatistics();
+
+/**
+ * Accounts a size under a tag for as long as it lives. Meant as a member of the objects owning the
+ * memory, so it's released with them.
+ */
+class TrackedAllocation {
+public:
+    explicit TrackedAllocation(Tag tag, std::size_t size = 0);
+    ~TrackedAllocation();
+
+    TrackedAllocation(TrackedAllocation&& other) noexcept;
+    TrackedAllocation& operator=(TrackedAllocation&& other) noexcept;
+
+    TrackedAllocation(const TrackedAllocation&) = delete;
+    TrackedAllocation& operator=(const TrackedAllocation&) = delete;
+
+    /// Changes the accounted size.
+    void Resize(std::size_t new_size);
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+private:
+    Tag tag;
+    std::size_t size;
+};
+
+} // namespace Common::MemoryAccounting
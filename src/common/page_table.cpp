@@ -14,18 +14,15 @@ void PageTable::Resize(std::size_t address_space_width_in_bits) {
     const std::size_t num_page_table_entries = 1ULL
                                                << (address_space_width_in_bits - page_size_in_bits);
 
+    if (pointers.size() == num_page_table_entries) {
+        return;
+    }
+
+    // The tables are backed by fresh pages from the OS, so a 39-bit address space does not cost
+    // an initial 1GB of zero filling, and only the parts of it that get mapped are committed.
     pointers.resize(num_page_table_entries);
     attributes.resize(num_page_table_entries);
     backing_addr.resize(num_page_table_entries);
-
-    // The default is a 39-bit address space, which causes an initial 1GB allocation size. If the
-    // vector size is subsequently decreased (via resize), the vector might not automatically
-    // actually reallocate/resize its underlying allocation, which wastes up to ~800 MB for
-    // 36-bit titles. Call shrink_to_fit to reduce capacity to what's actually in use.
-
-    pointers.shrink_to_fit();
-    attributes.shrink_to_fit();
-    backing_addr.shrink_to_fit();
 }
 
 } // namespace Common
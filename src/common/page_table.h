@@ -4,10 +4,10 @@
 
 #pragma once
 
-#include <vector>
 #include <boost/icl/interval_map.hpp>
 #include "common/common_types.h"
 #include "common/memory_hook.h"
+#include "common/virtual_buffer.h"
 
 namespace Common {
 
@@ -52,17 +52,18 @@ struct PageTable {
 
     /**
      * Resizes the page table to be able to accomodate enough pages within
-     * a given address space.
+     * a given address space. If the size changes, every entry is reset to unmapped.
      *
      * @param address_space_width_in_bits The address size width in bits.
      */
     void Resize(std::size_t address_space_width_in_bits);
 
     /**
-     * Vector of memory pointers backing each page. An entry can only be non-null if the
-     * corresponding entry in the `attributes` vector is of type `Memory`.
+     * Array of memory pointers backing each page. An entry can only be non-null if the
+     * corresponding entry in the `attributes` array is of type `Memory`. This is the array the
+     * JIT indexes directly, and a non-null entry is all the software fast path needs to check.
      */
-    std::vector<u8*> pointers;
+    VirtualBuffer<u8*> pointers;
 
     /**
      * Contains MMIO handlers that back memory regions whose entries in the `attribute` vector is
@@ -71,12 +72,12 @@ struct PageTable {
     boost::icl::interval_map<u64, std::set<SpecialRegion>> special_regions;
 
     /**
-     * Vector of fine grained page attributes. If it is set to any value other than `Memory`, then
+     * Array of fine grained page attributes. If it is set to any value other than `Memory`, then
      * the corresponding entry in `pointers` MUST be set to null.
      */
-    std::vector<PageType> attributes;
+    VirtualBuffer<PageType> attributes;
 
-    std::vector<u64> backing_addr;
+    VirtualBuffer<u64> backing_addr;
 
     const std::size_t page_size_in_bits{};
 };
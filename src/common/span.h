@@ -0,0 +1,75 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Common {
+
+/**
+ * Non-owning view of a contiguous sequence of objects, a subset of C++20's std::span. It can be
+ * made from any container with data() and size(), the viewed memory must outlive the span.
+ */
+template <typename T>
+class Span {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    constexpr Span() noexcept = default;
+
+    constexpr Span(T* pointer, std::size_t size) noexcept : pointer{pointer}, length{size} {}
+
+    template <typename Container,
+              typename = std::enable_if_t<
+                  !std::is_same_v<std::remove_cv_t<Container>, Span> &&
+                  std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+    constexpr Span(Container& container) noexcept
+        : pointer{container.data()}, length{container.size()} {}
+
+    constexpr T* data() const noexcept {
+        return pointer;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return length;
+    }
+
+    constexpr std::size_t size_bytes() const noexcept {
+        return length * sizeof(T);
+    }
+
+    constexpr bool empty() const noexcept {
+        return length == 0;
+    }
+
+    constexpr T& operator[](std::size_t index) const noexcept {
+        return pointer[index];
+    }
+
+    constexpr iterator begin() const noexcept {
+        return pointer;
+    }
+
+    constexpr iterator end() const noexcept {
+        return pointer + length;
+    }
+
+    constexpr Span subspan(std::size_t offset) const noexcept {
+        return {pointer + offset, length - offset};
+    }
+
+    constexpr Span subspan(std::size_t offset, std::size_t count) const noexcept {
+        return {pointer + offset, count};
+    }
+
+private:
+    T* pointer = nullptr;
+    std::size_t length = 0;
+};
+
+} // namespace Common
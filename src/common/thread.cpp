@@ -2,9 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
 #include "common/thread.h"
 #ifdef __APPLE__
 #include <mach/mach.h>
+#include <pthread.h>
 #elif defined(_WIN32)
 #include <windows.h>
 #else
@@ -18,6 +25,16 @@
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <climits>
+#include <ctime>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
 
 #ifdef __FreeBSD__
 #define cpu_set_t cpuset_t
@@ -75,4 +92,226 @@ void SetCurrentThreadName(const char* name) {
 
 #endif
 
+namespace {
+
+u64 GetAllCoresMask() {
+    const unsigned num_cores = std::thread::hardware_concurrency();
+    return num_cores == 0 || num_cores >= 64 ? ~u64{0} : (u64{1} << num_cores) - 1;
+}
+
+#ifdef __linux__
+/// Reads a number from a sysfs file of a core, returns zero if the file doesn't exist.
+u64 ReadCoreValue(unsigned core, const char* file) {
+    std::ifstream stream("/sys/devices/system/cpu/cpu" + std::to_string(core) + '/' + file);
+    u64 value = 0;
+    stream >> value;
+    return value;
+}
+#endif
+
+#ifndef __linux__
+/// Waiters parked on addresses hashing to the same slot share its condition variable.
+struct ParkingSlot {
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+std::array<ParkingSlot, 64> parking_slots;
+
+ParkingSlot& GetParkingSlot(const void* address) {
+    return parking_slots[(reinterpret_cast<std::uintptr_t>(address) >> 2) % parking_slots.size()];
+}
+#endif
+
+} // Anonymous namespace
+
+u32 GetSpinCount() {
+    // A pause takes between ten and a hundred and forty cycles depending on the host, this keeps
+    // the spin within a few microseconds on most of them
+    static const u32 spin_count = std::thread::hardware_concurrency() > 1 ? 512 : 0;
+    return spin_count;
+}
+
+#ifdef __linux__
+void ParkOnAddress(const std::atomic<u32>& address, u32 expected,
+                   const std::chrono::nanoseconds* timeout) {
+    static_assert(sizeof(std::atomic<u32>) == sizeof(u32));
+    timespec relative_time{};
+    if (timeout != nullptr) {
+        relative_time.tv_sec = static_cast<time_t>(timeout->count() / 1'000'000'000);
+        relative_time.tv_nsec = static_cast<long>(timeout->count() % 1'000'000'000);
+    }
+    syscall(SYS_futex, &address, FUTEX_WAIT_PRIVATE, expected,
+            timeout != nullptr ? &relative_time : nullptr, nullptr, 0);
+}
+
+void UnparkAddress(const std::atomic<u32>& address, bool wake_all) {
+    syscall(SYS_futex, &address, FUTEX_WAKE_PRIVATE, wake_all ? INT_MAX : 1, nullptr, nullptr, 0);
+}
+#else
+void ParkOnAddress(const std::atomic<u32>& address, u32 expected,
+                   const std::chrono::nanoseconds* timeout) {
+    ParkingSlot& slot = GetParkingSlot(&address);
+    std::unique_lock lock{slot.mutex};
+    if (address.load() != expected) {
+        return;
+    }
+    if (timeout != nullptr) {
+        slot.cv.wait_for(lock, *timeout);
+    } else {
+        slot.cv.wait(lock);
+    }
+}
+
+void UnparkAddress(const std::atomic<u32>& address, [[maybe_unused]] bool wake_all) {
+    // Other addresses may share the slot, so a single wakeup could go to the wrong thread
+    ParkingSlot& slot = GetParkingSlot(&address);
+    std::lock_guard lock{slot.mutex};
+    slot.cv.notify_all();
+}
+#endif
+
+#ifdef _WIN32
+bool SetCurrentThreadAffinity(u64 mask) {
+    if (mask == 0) {
+        return true;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask)) != 0;
+}
+#elif defined(__APPLE__) || defined(__OpenBSD__) || defined(__NetBSD__)
+bool SetCurrentThreadAffinity(u64 mask) {
+    // These don't expose per core affinity masks
+    return mask == 0;
+}
+#else
+bool SetCurrentThreadAffinity(u64 mask) {
+    if (mask == 0) {
+        return true;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int core = 0; core < 64; ++core) {
+        if ((mask >> core) & 1) {
+            CPU_SET(core, &cpu_set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+}
+#endif
+
+#ifdef _WIN32
+bool SetCurrentThreadPriority(ThreadPriority priority) {
+    int windows_priority = THREAD_PRIORITY_NORMAL;
+    switch (priority) {
+    case ThreadPriority::Low:
+        windows_priority = THREAD_PRIORITY_BELOW_NORMAL;
+        break;
+    case ThreadPriority::Normal:
+        windows_priority = THREAD_PRIORITY_NORMAL;
+        break;
+    case ThreadPriority::High:
+        windows_priority = THREAD_PRIORITY_HIGHEST;
+        break;
+    case ThreadPriority::Critical:
+        windows_priority = THREAD_PRIORITY_TIME_CRITICAL;
+        break;
+    }
+    return SetThreadPriority(GetCurrentThread(), windows_priority) != 0;
+}
+#else
+bool SetCurrentThreadPriority(ThreadPriority priority) {
+    if (priority == ThreadPriority::Critical) {
+        sched_param param{};
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) {
+            return true;
+        }
+        // Real-time scheduling needs privileges, settle for the highest regular priority
+        priority = ThreadPriority::High;
+    }
+#ifdef __linux__
+    // Linux threads have a nice value of their own, unlike what POSIX says
+    int nice_value = 0;
+    switch (priority) {
+    case ThreadPriority::Low:
+        nice_value = 5;
+        break;
+    case ThreadPriority::Normal:
+    case ThreadPriority::Critical:
+        nice_value = 0;
+        break;
+    case ThreadPriority::High:
+        nice_value = -10;
+        break;
+    }
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, tid, nice_value) == 0;
+#else
+    return priority == ThreadPriority::Normal;
+#endif
+}
+#endif
+
+u64 GetPerformanceCoreMask() {
+    const u64 all_cores = GetAllCoresMask();
+#if defined(_MSC_VER)
+    // CPU sets are only available since Windows 10, look the function up at runtime
+    using GetSystemCpuSetInformationFn =
+        BOOL(WINAPI*)(PSYSTEM_CPU_SET_INFORMATION, ULONG, PULONG, HANDLE, ULONG);
+    const auto get_cpu_set_information = reinterpret_cast<GetSystemCpuSetInformationFn>(
+        GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetSystemCpuSetInformation"));
+    if (get_cpu_set_information == nullptr) {
+        return all_cores;
+    }
+    ULONG length = 0;
+    get_cpu_set_information(nullptr, 0, &length, GetCurrentProcess(), 0);
+    std::vector<u8> buffer(length);
+    auto* const first = reinterpret_cast<SYSTEM_CPU_SET_INFORMATION*>(buffer.data());
+    if (length == 0 || !get_cpu_set_information(first, length, &length, GetCurrentProcess(), 0)) {
+        return all_cores;
+    }
+    // Higher efficiency classes are faster, E-cores of hybrid CPUs are class 0
+    u64 mask = 0;
+    BYTE best_class = 0;
+    for (ULONG offset = 0; offset < length;) {
+        const auto& info = *reinterpret_cast<SYSTEM_CPU_SET_INFORMATION*>(buffer.data() + offset);
+        offset += info.Size;
+        if (info.Type != CpuSetInformation || info.CpuSet.LogicalProcessorIndex >= 64) {
+            continue;
+        }
+        const u64 bit = u64{1} << info.CpuSet.LogicalProcessorIndex;
+        if (info.CpuSet.EfficiencyClass > best_class) {
+            best_class = info.CpuSet.EfficiencyClass;
+            mask = bit;
+        } else if (info.CpuSet.EfficiencyClass == best_class) {
+            mask |= bit;
+        }
+    }
+    return mask != 0 ? mask : all_cores;
+#elif defined(__linux__)
+    // ARM big.LITTLE exposes the relative capacity of the cores, hybrid x86 only their clocks
+    for (const char* file : {"cpu_capacity", "cpufreq/cpuinfo_max_freq"}) {
+        std::array<u64, 64> values{};
+        for (unsigned core = 0; core < 64 && ((all_cores >> core) & 1) != 0; ++core) {
+            values[core] = ReadCoreValue(core, file);
+        }
+        const u64 best_value = *std::max_element(values.begin(), values.end());
+        if (best_value == 0) {
+            continue;
+        }
+        // Favored cores boost a bit higher than the rest of the performance cores, don't let
+        // them form a class of their own
+        u64 mask = 0;
+        for (unsigned core = 0; core < 64; ++core) {
+            if (values[core] >= best_value - best_value / 10) {
+                mask |= u64{1} << core;
+            }
+        }
+        return mask;
+    }
+    return all_cores;
+#else
+    return all_cores;
+#endif
+}
+
 } // namespace Common
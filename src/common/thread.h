@@ -4,79 +4,192 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
 #include <cstddef>
-#include <mutex>
 #include <thread>
+#include "common/common_types.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
 
 namespace Common {
 
+/// Hints the host CPU that the caller is spinning on a memory location.
+inline void CpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * Returns how many times waiters poll before parking. It is zero on single core hosts, where
+ * spinning only delays the thread being waited on.
+ */
+u32 GetSpinCount();
+
+/**
+ * Blocks while the address holds the expected value, it may return spuriously. Backed by futexes
+ * on Linux and by a table of condition variables elsewhere.
+ * @param timeout Longest time to block for, null blocks until woken up
+ */
+void ParkOnAddress(const std::atomic<u32>& address, u32 expected,
+                   const std::chrono::nanoseconds* timeout = nullptr);
+
+/// Wakes threads parked on the address. The value has to be changed before calling this.
+void UnparkAddress(const std::atomic<u32>& address, bool wake_all);
+
+/**
+ * Auto-reset event. Waiters spin for a short while before parking, so quick handoffs between
+ * threads don't pay for a trip through the host scheduler.
+ */
 class Event {
 public:
     void Set() {
-        std::lock_guard lk{mutex};
-        if (!is_set) {
-            is_set = true;
-            condvar.notify_one();
+        if (state.exchange(1) == 0 && num_parked != 0) {
+            UnparkAddress(state, false);
         }
     }
 
     void Wait() {
-        std::unique_lock lk{mutex};
-        condvar.wait(lk, [&] { return is_set; });
-        is_set = false;
+        if (SpinUntilSet()) {
+            return;
+        }
+        ++num_parked;
+        while (!TryConsume()) {
+            ParkOnAddress(state, 0);
+        }
+        --num_parked;
     }
 
     template <class Clock, class Duration>
     bool WaitUntil(const std::chrono::time_point<Clock, Duration>& time) {
-        std::unique_lock lk{mutex};
-        if (!condvar.wait_until(lk, time, [this] { return is_set; }))
-            return false;
-        is_set = false;
-        return true;
+        if (SpinUntilSet()) {
+            return true;
+        }
+        ++num_parked;
+        bool is_set = TryConsume();
+        while (!is_set) {
+            const auto remaining = time - Clock::now();
+            if (remaining <= remaining.zero()) {
+                break;
+            }
+            const auto timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining);
+            ParkOnAddress(state, 0, &timeout);
+            is_set = TryConsume();
+        }
+        --num_parked;
+        return is_set;
     }
 
     void Reset() {
-        std::unique_lock lk{mutex};
-        // no other action required, since wait loops on the predicate and any lingering signal will
-        // get cleared on the first iteration
-        is_set = false;
+        state = 0;
     }
 
 private:
-    bool is_set = false;
-    std::condition_variable condvar;
-    std::mutex mutex;
+    bool TryConsume() {
+        u32 expected = 1;
+        return state.compare_exchange_strong(expected, 0);
+    }
+
+    bool SpinUntilSet() {
+        for (u32 spin = GetSpinCount(); spin > 0; --spin) {
+            if (state.load(std::memory_order_relaxed) != 0 && TryConsume()) {
+                return true;
+            }
+            CpuRelax();
+        }
+        return TryConsume();
+    }
+
+    std::atomic<u32> state{0};
+    std::atomic<u32> num_parked{0};
 };
 
+/// Reusable barrier, threads spin for a short while before parking like they do on Event.
 class Barrier {
 public:
     explicit Barrier(std::size_t count_) : count(count_) {}
 
-    /// Blocks until all "count" threads have called Sync()
-    void Sync() {
-        std::unique_lock lk{mutex};
-        const std::size_t current_generation = generation;
-
+    /**
+     * Blocks until all "count" threads have called Sync().
+     * @returns false if the barrier was cancelled, before or while waiting
+     */
+    bool Sync() {
+        const u32 current_generation = generation;
+        if (cancelled) {
+            return false;
+        }
         if (++waiting == count) {
-            generation++;
             waiting = 0;
-            condvar.notify_all();
-        } else {
-            condvar.wait(lk,
-                         [this, current_generation] { return current_generation != generation; });
+            ++generation;
+            if (num_parked != 0) {
+                UnparkAddress(generation, true);
+            }
+            return !cancelled;
+        }
+
+        for (u32 spin = GetSpinCount(); spin > 0; --spin) {
+            if (generation.load(std::memory_order_relaxed) != current_generation) {
+                return !cancelled;
+            }
+            CpuRelax();
+        }
+        ++num_parked;
+        while (generation == current_generation) {
+            ParkOnAddress(generation, current_generation);
         }
+        --num_parked;
+        return !cancelled;
+    }
+
+    /// Releases the threads waiting on the barrier and makes every later Sync() fail.
+    void Cancel() {
+        cancelled = true;
+        ++generation;
+        UnparkAddress(generation, true);
+    }
+
+    bool IsCancelled() const {
+        return cancelled;
     }
 
 private:
-    std::condition_variable condvar;
-    std::mutex mutex;
-    std::size_t count;
-    std::size_t waiting = 0;
-    std::size_t generation = 0; // Incremented once each time the barrier is used
+    const std::size_t count;
+    std::atomic<std::size_t> waiting{0};
+    std::atomic<u32> generation{0}; // Incremented once each time the barrier is used
+    std::atomic<u32> num_parked{0};
+    std::atomic<bool> cancelled{false};
 };
 
 void SetCurrentThreadName(const char* name);
 
+enum class ThreadPriority {
+    Low,
+    Normal,
+    High,
+    /// Real-time scheduling where the host permits it, the highest regular priority otherwise
+    Critical,
+};
+
+/**
+ * Restricts the current thread to the host cores set in the mask, a zero mask leaves the thread
+ * unrestricted. Returns false if the host refused the mask or doesn't support affinities.
+ */
+bool SetCurrentThreadAffinity(u64 mask);
+
+/// Sets the scheduling priority of the current thread. Returns false if the host refused it.
+bool SetCurrentThreadPriority(ThreadPriority priority);
+
+/**
+ * Returns the mask of the fastest host cores, the P-cores of hybrid CPUs and the big cores of
+ * big.LITTLE ones. Every core is set on hosts whose cores are all alike.
+ */
+u64 GetPerformanceCoreMask();
+
 } // namespace Common
@@ -0,0 +1,175 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <fmt/format.h>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+namespace {
+
+// Host threads the shared pool leaves free, one for the emulated CPU and one for the GPU
+constexpr std::size_t ReservedHostThreads = 2;
+
+// Worker of the calling thread, tasks submitted from a worker stay on its own queues
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+
+} // Anonymous namespace
+
+ThreadPool::ThreadPool(std::size_t num_workers, u64 affinity_mask) {
+    num_workers = std::max<std::size_t>(num_workers, 1);
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // Workers steal from each other, spawn them once every queue exists
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers[i]->thread = std::thread(&ThreadPool::WorkerLoop, this, i, affinity_mask);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{sleep_mutex};
+        stop = true;
+    }
+    sleep_cv.notify_all();
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task, TaskPriority priority) {
+    Push(Task{std::move(task), nullptr}, priority);
+}
+
+bool ThreadPool::RunPendingTask() {
+    const std::size_t home =
+        current_pool == this ? current_worker : next_worker++ % workers.size();
+    Task task;
+    if (!TryPop(home, task)) {
+        return false;
+    }
+    Run(task);
+    return true;
+}
+
+void ThreadPool::Push(Task task, TaskPriority priority) {
+    const std::size_t home =
+        current_pool == this ? current_worker : next_worker++ % workers.size();
+    {
+        Worker& worker = *workers[home];
+        std::lock_guard lock{worker.mutex};
+        worker.queues[static_cast<std::size_t>(priority)].push_back(std::move(task));
+    }
+    {
+        std::lock_guard lock{sleep_mutex};
+        ++num_queued;
+    }
+    sleep_cv.notify_one();
+}
+
+bool ThreadPool::TryPop(std::size_t home, Task& task) {
+    if (num_queued == 0) {
+        return false;
+    }
+    const std::size_t num_workers = workers.size();
+    for (std::size_t priority = 0; priority < NumPriorities; ++priority) {
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            Worker& worker = *workers[(home + i) % num_workers];
+            std::lock_guard lock{worker.mutex};
+            auto& queue = worker.queues[priority];
+            if (queue.empty()) {
+                continue;
+            }
+            // The owner takes its newest task while it is still hot in cache, thieves the oldest
+            if (i == 0) {
+                task = std::move(queue.back());
+                queue.pop_back();
+            } else {
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            --num_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Run(Task& task) {
+    if (task.group == nullptr) {
+        task.function();
+        return;
+    }
+    if (!task.group->IsCancelled()) {
+        task.function();
+    }
+    task.group->FinishTask();
+}
+
+void ThreadPool::WorkerLoop(std::size_t index, u64 affinity_mask) {
+    const std::string name = fmt::format("yuzu:Worker{}", index);
+    SetCurrentThreadName(name.c_str());
+    if (affinity_mask != 0) {
+        SetCurrentThreadAffinity(affinity_mask);
+    }
+    current_pool = this;
+    current_worker = index;
+
+    while (true) {
+        Task task;
+        if (TryPop(index, task)) {
+            Run(task);
+            continue;
+        }
+        std::unique_lock lock{sleep_mutex};
+        sleep_cv.wait(lock, [this] { return stop || num_queued != 0; });
+        // Tasks queued before the pool is destroyed still run, groups may be waiting on them
+        if (stop && num_queued == 0) {
+            return;
+        }
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool{pool} {}
+
+TaskGroup::~TaskGroup() {
+    Wait();
+}
+
+void TaskGroup::Submit(std::function<void()> task, TaskPriority priority) {
+    ++pending;
+    pool.Push(ThreadPool::Task{std::move(task), this}, priority);
+}
+
+void TaskGroup::Wait() {
+    while (pending != 0 && pool.RunPendingTask()) {
+    }
+    // The queues are empty, so the rest of the group is already running. The count is checked
+    // under the lock so the group outlives the FinishTask call of its last task.
+    std::unique_lock lock{mutex};
+    finished_cv.wait(lock, [this] { return pending == 0; });
+}
+
+void TaskGroup::FinishTask() {
+    std::lock_guard lock{mutex};
+    if (--pending == 0) {
+        finished_cv.notify_all();
+    }
+}
+
+ThreadPool& GetThreadPool() {
+    static ThreadPool pool{[] {
+        const std::size_t host_threads = std::thread::hardware_concurrency();
+        return host_threads > ReservedHostThreads ? host_threads - ReservedHostThreads : 1;
+    }()};
+    return pool;
+}
+
+} // namespace Common
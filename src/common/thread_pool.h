@@ -0,0 +1,139 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+class TaskGroup;
+
+enum class TaskPriority {
+    High,
+    Normal,
+    Low,
+};
+
+/**
+ * Pool of worker threads for short lived, CPU bound jobs. Each worker has its own queues, tasks
+ * submitted from a worker go to the queues of that worker and idle workers steal from the others.
+ * Tasks of a higher priority always run before those of a lower one.
+ *
+ * Tasks must not block on anything but other tasks of the pool, long running loops belong on
+ * dedicated threads.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_workers   Number of worker threads to spawn, at least one is always spawned
+     * @param affinity_mask Host cores the workers may run on, zero leaves them unrestricted
+     */
+    explicit ThreadPool(std::size_t num_workers, u64 affinity_mask = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Queues a task that nothing waits for.
+    void Submit(std::function<void()> task, TaskPriority priority = TaskPriority::Normal);
+
+    /// Pops and runs a single queued task on the calling thread, returns false if none was queued.
+    bool RunPendingTask();
+
+    std::size_t GetNumWorkers() const {
+        return workers.size();
+    }
+
+private:
+    friend class TaskGroup;
+
+    static constexpr std::size_t NumPriorities = 3;
+
+    struct Task {
+        std::function<void()> function;
+        TaskGroup* group = nullptr;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Task>, NumPriorities> queues;
+        std::thread thread;
+    };
+
+    void Push(Task task, TaskPriority priority);
+
+    /// Pops the most urgent task, looking at the home queues first and stealing from the others.
+    bool TryPop(std::size_t home, Task& task);
+
+    void Run(Task& task);
+
+    void WorkerLoop(std::size_t index, u64 affinity_mask);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<std::size_t> next_worker{0};
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    std::atomic<std::size_t> num_queued{0};
+    bool stop = false;
+};
+
+/**
+ * Set of tasks that can be waited on and cancelled together. Cancelling skips the tasks that
+ * haven't started yet, running tasks may poll IsCancelled() to stop early.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool);
+
+    /// Waits for the tasks that are still pending.
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void Submit(std::function<void()> task, TaskPriority priority = TaskPriority::Normal);
+
+    /// Blocks until every task of the group has finished, running queued tasks in the meantime.
+    void Wait();
+
+    void Cancel() {
+        cancelled = true;
+    }
+
+    bool IsCancelled() const {
+        return cancelled;
+    }
+
+private:
+    friend class ThreadPool;
+
+    void FinishTask();
+
+    ThreadPool& pool;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<bool> cancelled{false};
+
+    std::mutex mutex;
+    std::condition_variable finished_cv;
+};
+
+/**
+ * Returns the pool shared by the whole emulator. It leaves room for the emulated CPU and the GPU
+ * threads so that parallel jobs don't take cores away from them.
+ */
+ThreadPool& GetThreadPool();
+
+} // namespace Common
@@ -7,11 +7,15 @@
 // a simple lockless thread-safe,
 // single reader, single writer queue
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <mutex>
+#include <thread>
 #include <utility>
+#include "common/common_types.h"
+#include "common/thread.h"
 
 namespace Common {
 template <typename T>
@@ -46,9 +50,11 @@ public:
         ElementPtr* new_ptr = new ElementPtr();
         write_ptr->next.store(new_ptr, std::memory_order_release);
         write_ptr = new_ptr;
-        cv.notify_one();
-
         ++size;
+
+        // Take the lock so the notification can't land between the reader's check and its wait
+        std::lock_guard lock{cv_mutex};
+        cv.notify_one();
     }
 
     void Pop() {
@@ -76,11 +82,15 @@ public:
         return true;
     }
 
-    T PopWait() {
+    void Wait() {
         if (Empty()) {
             std::unique_lock lock{cv_mutex};
             cv.wait(lock, [this]() { return !Empty(); });
         }
+    }
+
+    T PopWait() {
+        Wait();
         T t;
         Pop(t);
         return t;
@@ -162,4 +172,244 @@ private:
     SPSCQueue<T> spsc_queue;
     std::mutex write_lock;
 };
+
+// a single reader, single writer queue over a fixed number of preallocated slots, pushing
+// doesn't allocate. The writer blocks while the queue is full, the reader spins for a while
+// before sleeping when it finds the queue empty. Sleeping threads are only notified when they
+// are actually sleeping, so a busy reader costs the writer no locking.
+
+template <typename T, std::size_t Capacity>
+class SPSCRingQueue {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    std::size_t Size() const {
+        return write_index.load() - read_index.load();
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    template <typename Arg>
+    void Push(Arg&& t) {
+        const std::size_t index = write_index.load(std::memory_order_relaxed);
+        if (index - read_index.load(std::memory_order_acquire) == Capacity) {
+            SleepUntil(writer_sleeping, not_full_cv,
+                       [this, index] { return index - read_index.load() != Capacity; });
+        }
+
+        slots[index % Capacity] = std::forward<Arg>(t);
+        write_index.store(index + 1);
+        WakeUp(reader_sleeping, not_empty_cv);
+    }
+
+    bool Pop(T& t) {
+        const std::size_t index = read_index.load(std::memory_order_relaxed);
+        if (index == write_index.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        t = std::move(slots[index % Capacity]);
+        read_index.store(index + 1);
+        WakeUp(writer_sleeping, not_full_cv);
+        return true;
+    }
+
+    void Wait() {
+        for (std::size_t spin = 0; spin < ReaderSpinIterations; ++spin) {
+            if (!Empty()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        SleepUntil(reader_sleeping, not_empty_cv, [this] { return !Empty(); });
+    }
+
+    T PopWait() {
+        Wait();
+        T t;
+        Pop(t);
+        return t;
+    }
+
+private:
+    static constexpr std::size_t ReaderSpinIterations = 64;
+
+    template <typename Predicate>
+    void SleepUntil(std::atomic_bool& sleeping, std::condition_variable& cv, Predicate&& pred) {
+        std::unique_lock lock{cv_mutex};
+        // Sequentially consistent with the index stores, either the other side sees the flag or
+        // the predicate sees its update
+        sleeping.store(true);
+        cv.wait(lock, pred);
+        sleeping.store(false);
+    }
+
+    void WakeUp(std::atomic_bool& sleeping, std::condition_variable& cv) {
+        if (!sleeping.load()) {
+            return;
+        }
+        // Take the lock so the notification can't land between the sleeper's check and its wait
+        std::lock_guard lock{cv_mutex};
+        cv.notify_one();
+    }
+
+    std::array<T, Capacity> slots{};
+    std::atomic_size_t write_index{0};
+    std::atomic_size_t read_index{0};
+    std::atomic_bool writer_sleeping{false};
+    std::atomic_bool reader_sleeping{false};
+    std::mutex cv_mutex;
+    std::condition_variable not_full_cv;
+    std::condition_variable not_empty_cv;
+};
+
+// a bounded multiple reader, multiple writer queue over a fixed number of preallocated slots,
+// after Dmitry Vyukov's design. Each slot carries a sequence number telling whether it is ready
+// to be written or read in the current lap, so writers only contend on the write index and
+// readers on the read index. Threads that find the queue full or empty spin for a while before
+// parking. Only the first update after a thread parked pays for waking the parked threads up.
+
+template <typename T, std::size_t Capacity>
+class MPMCQueue {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    MPMCQueue() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Number of elements in the queue, only a snapshot while other threads use it.
+    std::size_t Size() const {
+        const std::size_t read = read_index.load();
+        const std::size_t write = write_index.load();
+        return write > read ? write - read : 0;
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    /// Pushes an element unless the queue is full, the element is left untouched if it is.
+    template <typename Arg>
+    bool TryPush(Arg&& t) {
+        std::size_t index;
+        return TryPush(std::forward<Arg>(t), index);
+    }
+
+    /**
+     * Pushes an element, waiting while the queue is full.
+     * @returns the position of the element in the order elements go through the queue, counting
+     *          from zero
+     */
+    template <typename Arg>
+    std::size_t Push(Arg&& t) {
+        std::size_t index;
+        WaitFor(pop_epoch, writers_waiting,
+                [&] { return TryPush(std::forward<Arg>(t), index); });
+        return index;
+    }
+
+    bool Pop(T& t) {
+        std::size_t index = read_index.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[index % Capacity];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto lap = static_cast<std::ptrdiff_t>(sequence - (index + 1));
+            if (lap < 0) {
+                return false;
+            }
+            if (lap > 0) {
+                index = read_index.load(std::memory_order_relaxed);
+            } else if (read_index.compare_exchange_weak(index, index + 1,
+                                                        std::memory_order_relaxed)) {
+                t = std::move(slot.value);
+                slot.sequence.store(index + Capacity, std::memory_order_release);
+                Notify(pop_epoch, writers_waiting);
+                return true;
+            }
+        }
+    }
+
+    /// Waits until the queue holds an element, another reader may still take it first.
+    void Wait() {
+        WaitFor(push_epoch, readers_waiting, [this] { return !Empty(); });
+    }
+
+    T PopWait() {
+        T t;
+        WaitFor(push_epoch, readers_waiting, [&] { return Pop(t); });
+        return t;
+    }
+
+private:
+    struct Slot {
+        std::atomic_size_t sequence;
+        T value{};
+    };
+
+    template <typename Arg>
+    bool TryPush(Arg&& t, std::size_t& index) {
+        index = write_index.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[index % Capacity];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto lap = static_cast<std::ptrdiff_t>(sequence - index);
+            if (lap < 0) {
+                return false;
+            }
+            if (lap > 0) {
+                index = write_index.load(std::memory_order_relaxed);
+            } else if (write_index.compare_exchange_weak(index, index + 1,
+                                                         std::memory_order_relaxed)) {
+                slot.value = std::forward<Arg>(t);
+                slot.sequence.store(index + 1, std::memory_order_release);
+                Notify(push_epoch, readers_waiting);
+                return true;
+            }
+        }
+    }
+
+    template <typename Predicate>
+    static void WaitFor(std::atomic<u32>& epoch, std::atomic_bool& waiting, Predicate&& pred) {
+        for (u32 spin = GetSpinCount(); spin > 0; --spin) {
+            if (pred()) {
+                return;
+            }
+            CpuRelax();
+        }
+        while (true) {
+            // Sequentially consistent with Notify, either it sees the flag or this sees the new
+            // epoch. An update landing after the epoch is read makes the park return at once.
+            waiting.store(true);
+            const u32 current_epoch = epoch.load();
+            if (pred()) {
+                return;
+            }
+            ParkOnAddress(epoch, current_epoch);
+        }
+    }
+
+    static void Notify(std::atomic<u32>& epoch, std::atomic_bool& waiting) {
+        ++epoch;
+        // Everyone is woken up, those who still can't make progress set the flag again
+        if (waiting.load() && waiting.exchange(false)) {
+            UnparkAddress(epoch, true);
+        }
+    }
+
+    // Readers and writers each get their own cache lines
+    alignas(128) std::atomic_size_t write_index{0};
+    std::atomic<u32> push_epoch{0};
+    std::atomic_bool readers_waiting{false};
+    alignas(128) std::atomic_size_t read_index{0};
+    std::atomic<u32> pop_epoch{0};
+    std::atomic_bool writers_waiting{false};
+    alignas(128) std::array<Slot, Capacity> slots;
+};
 } // namespace Common
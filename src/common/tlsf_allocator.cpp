@@ -0,0 +1,243 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/bit_util.h"
+#include "common/tlsf_allocator.h"
+
+namespace Common {
+
+TLSFAllocator::TLSFAllocator(u64 size) : size{AlignDown(size, GRANULARITY)} {
+    for (auto& lists : free_lists) {
+        lists.fill(INVALID_INDEX);
+    }
+    if (this->size == 0) {
+        return;
+    }
+    const u32 index = AllocateBlock();
+    blocks[index] = {0, this->size, INVALID_INDEX, INVALID_INDEX,
+                     INVALID_INDEX, INVALID_INDEX, true};
+    InsertFree(index);
+}
+
+TLSFAllocator::~TLSFAllocator() = default;
+
+std::optional<TLSFAllocator::Allocation> TLSFAllocator::Allocate(u64 size, u64 alignment) {
+    ASSERT_MSG(alignment == 0 || (alignment & (alignment - 1)) == 0,
+               "Alignment must be a power of two");
+    size = AlignUp(std::max<u64>(size, 1), GRANULARITY);
+    alignment = std::max(alignment, GRANULARITY);
+    if (size > this->size) {
+        return std::nullopt;
+    }
+
+    // Any block this large fits the request wherever it starts.
+    const u64 search_size = size + alignment - GRANULARITY;
+    const auto fits = [&](u32 index) {
+        const Block& block = blocks[index];
+        return AlignUp(block.offset, alignment) + size <= block.offset + block.size;
+    };
+
+    u32 index = FindFreeBlock(search_size);
+    if (index == INVALID_INDEX) {
+        // The search skips bins where only some blocks are large enough once aligned. Look
+        // through those before giving up, this matters when the space is nearly full.
+        index = FindFittingBlock(MapSize(size), MapSize(search_size), fits);
+        if (index == INVALID_INDEX) {
+            return std::nullopt;
+        }
+    }
+    ASSERT(fits(index));
+    RemoveFree(index);
+
+    const u64 aligned_offset = AlignUp(blocks[index].offset, alignment);
+    if (aligned_offset != blocks[index].offset) {
+        // Leave the padding in front as a free block of its own.
+        const u32 next = Split(index, aligned_offset - blocks[index].offset);
+        blocks[index].is_free = true;
+        InsertFree(index);
+        index = next;
+    }
+    if (blocks[index].size > size) {
+        const u32 next = Split(index, size);
+        blocks[next].is_free = true;
+        InsertFree(next);
+    }
+
+    blocks[index].is_free = false;
+    used += size;
+    return Allocation{blocks[index].offset, index};
+}
+
+void TLSFAllocator::Free(u32 handle) {
+    ASSERT(handle < blocks.size() && blocks[handle].size != 0 && !blocks[handle].is_free);
+    u32 index = handle;
+    used -= blocks[index].size;
+    blocks[index].is_free = true;
+
+    const u32 next = blocks[index].next_physical;
+    if (next != INVALID_INDEX && blocks[next].is_free) {
+        RemoveFree(next);
+        MergeNext(index);
+    }
+    const u32 prev = blocks[index].prev_physical;
+    if (prev != INVALID_INDEX && blocks[prev].is_free) {
+        RemoveFree(prev);
+        MergeNext(prev);
+        index = prev;
+    }
+    InsertFree(index);
+}
+
+TLSFAllocator::Statistics TLSFAllocator::GetStatistics() const {
+    Statistics stats;
+    stats.size = size;
+    stats.used = used;
+    for (const Block& block : blocks) {
+        if (block.size == 0) {
+            continue;
+        }
+        if (block.is_free) {
+            stats.largest_free = std::max(stats.largest_free, block.size);
+            ++stats.free_blocks;
+        } else {
+            ++stats.used_blocks;
+        }
+    }
+    return stats;
+}
+
+TLSFAllocator::Mapping TLSFAllocator::MapSize(u64 size) {
+    if (size < SMALL_BLOCK_SIZE) {
+        return {0, static_cast<u32>(size >> GRANULARITY_BITS)};
+    }
+    const u32 msb = MostSignificantBit64(size);
+    const u32 sl = static_cast<u32>(size >> (msb - SL_BITS)) - SL_COUNT;
+    return {msb - FL_SHIFT + 1, sl};
+}
+
+template <typename Predicate>
+u32 TLSFAllocator::FindFittingBlock(Mapping first, Mapping last, Predicate&& fits) const {
+    for (u32 fl = first.fl; fl <= last.fl; ++fl) {
+        const u32 sl_begin = fl == first.fl ? first.sl : 0;
+        const u32 sl_end = fl == last.fl ? last.sl : SL_COUNT - 1;
+        for (u32 sl = sl_begin; sl <= sl_end; ++sl) {
+            for (u32 it = free_lists[fl][sl]; it != INVALID_INDEX; it = blocks[it].next_free) {
+                if (fits(it)) {
+                    return it;
+                }
+            }
+        }
+    }
+    return INVALID_INDEX;
+}
+
+u32 TLSFAllocator::FindFreeBlock(u64 size) const {
+    // Round the size up to the next bin, so that any block found is large enough.
+    if (size >= SMALL_BLOCK_SIZE) {
+        const u64 round = (u64{1} << (MostSignificantBit64(size) - SL_BITS)) - 1;
+        if (size > ~u64{0} - round) {
+            return INVALID_INDEX;
+        }
+        size += round;
+    }
+    auto [fl, sl] = MapSize(size);
+
+    u32 sl_map = sl_bitmaps[fl] & (~0U << sl);
+    if (sl_map == 0) {
+        const u64 fl_map = fl + 1 < 64 ? fl_bitmap & (~u64{0} << (fl + 1)) : 0;
+        if (fl_map == 0) {
+            return INVALID_INDEX;
+        }
+        fl = CountTrailingZeroes64(fl_map);
+        sl_map = sl_bitmaps[fl];
+    }
+    sl = CountTrailingZeroes32(sl_map);
+    return free_lists[fl][sl];
+}
+
+void TLSFAllocator::InsertFree(u32 index) {
+    const auto [fl, sl] = MapSize(blocks[index].size);
+    u32& head = free_lists[fl][sl];
+
+    blocks[index].prev_free = INVALID_INDEX;
+    blocks[index].next_free = head;
+    if (head != INVALID_INDEX) {
+        blocks[head].prev_free = index;
+    }
+    head = index;
+
+    fl_bitmap |= u64{1} << fl;
+    sl_bitmaps[fl] |= 1U << sl;
+}
+
+void TLSFAllocator::RemoveFree(u32 index) {
+    const auto [fl, sl] = MapSize(blocks[index].size);
+    const Block& block = blocks[index];
+
+    if (block.prev_free != INVALID_INDEX) {
+        blocks[block.prev_free].next_free = block.next_free;
+    } else {
+        free_lists[fl][sl] = block.next_free;
+    }
+    if (block.next_free != INVALID_INDEX) {
+        blocks[block.next_free].prev_free = block.prev_free;
+    }
+
+    if (free_lists[fl][sl] == INVALID_INDEX) {
+        sl_bitmaps[fl] &= ~(1U << sl);
+        if (sl_bitmaps[fl] == 0) {
+            fl_bitmap &= ~(u64{1} << fl);
+        }
+    }
+}
+
+u32 TLSFAllocator::Split(u32 index, u64 head_size) {
+    const u32 tail = AllocateBlock();
+    Block& block = blocks[index];
+    ASSERT(head_size < block.size);
+
+    blocks[tail] = {block.offset + head_size, block.size - head_size, index, block.next_physical,
+                    INVALID_INDEX, INVALID_INDEX, false};
+    if (block.next_physical != INVALID_INDEX) {
+        blocks[block.next_physical].prev_physical = tail;
+    }
+    block.next_physical = tail;
+    block.size = head_size;
+    return tail;
+}
+
+void TLSFAllocator::MergeNext(u32 index) {
+    Block& block = blocks[index];
+    const u32 next = block.next_physical;
+    ASSERT(next != INVALID_INDEX && blocks[next].is_free);
+
+    block.size += blocks[next].size;
+    block.next_physical = blocks[next].next_physical;
+    if (block.next_physical != INVALID_INDEX) {
+        blocks[block.next_physical].prev_physical = index;
+    }
+    FreeBlock(next);
+}
+
+u32 TLSFAllocator::AllocateBlock() {
+    if (unused_head != INVALID_INDEX) {
+        const u32 index = unused_head;
+        unused_head = blocks[index].next_free;
+        return index;
+    }
+    blocks.emplace_back();
+    return static_cast<u32>(blocks.size() - 1);
+}
+
+void TLSFAllocator::FreeBlock(u32 index) {
+    blocks[index] = {};
+    blocks[index].next_free = unused_head;
+    unused_head = index;
+}
+
+} // namespace Common
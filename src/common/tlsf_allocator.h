@@ -0,0 +1,133 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Two-level segregated fit allocator of ranges inside a fixed size space, such as a block of
+ * device memory. It only hands out offsets, the memory itself is never touched.
+ *
+ * Free blocks are binned by size, first by power of two and then linearly in 16 classes within
+ * each power of two, and a bitmap tracks which bins hold blocks. Allocation and release are O(1)
+ * and neighbouring free blocks are always merged, which keeps fragmentation low.
+ */
+class TLSFAllocator final {
+public:
+    /// Offsets and sizes are rounded up to this granularity.
+    static constexpr u64 GRANULARITY = 16;
+
+    struct Allocation {
+        u64 offset; ///< Offset of the allocated range from the start of the space.
+        u32 handle; ///< Identifies the allocation when freeing it.
+    };
+
+    struct Statistics {
+        u64 size = 0;         ///< Size of the managed space.
+        u64 used = 0;         ///< Bytes handed out, including the rounding to the granularity.
+        u64 largest_free = 0; ///< Size of the largest free block.
+        u32 used_blocks = 0;
+        u32 free_blocks = 0;
+
+        /// Share of the free space that is not part of the largest free block, between 0 and 1.
+        double Fragmentation() const {
+            const u64 free = size - used;
+            return free == 0 ? 0.0 : 1.0 - static_cast<double>(largest_free) / free;
+        }
+    };
+
+    explicit TLSFAllocator(u64 size);
+    ~TLSFAllocator();
+
+    /**
+     * Allocates a range. The alignment must be a power of two.
+     * @returns The allocation, or an empty optional if there is no free range large enough.
+     */
+    std::optional<Allocation> Allocate(u64 size, u64 alignment);
+
+    /// Releases an allocation, merging it with the free blocks around it.
+    void Free(u32 handle);
+
+    /// Returns true when nothing is allocated.
+    bool Empty() const {
+        return used == 0;
+    }
+
+    u64 GetSize() const {
+        return size;
+    }
+
+    u64 GetUsed() const {
+        return used;
+    }
+
+    Statistics GetStatistics() const;
+
+private:
+    static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+    static constexpr u32 SL_BITS = 4;
+    static constexpr u32 SL_COUNT = 1U << SL_BITS;
+    static constexpr u32 GRANULARITY_BITS = 4;
+    /// Blocks smaller than this are binned linearly in the first level.
+    static constexpr u64 SMALL_BLOCK_SIZE = GRANULARITY << SL_BITS;
+    static constexpr u32 FL_SHIFT = SL_BITS + GRANULARITY_BITS;
+    static constexpr u32 FL_COUNT = 64 - FL_SHIFT + 1;
+
+    static_assert(GRANULARITY == 1U << GRANULARITY_BITS);
+
+    struct Block {
+        u64 offset;
+        u64 size;
+        u32 prev_physical;
+        u32 next_physical;
+        u32 prev_free;
+        u32 next_free;
+        bool is_free;
+    };
+
+    struct Mapping {
+        u32 fl;
+        u32 sl;
+    };
+
+    static Mapping MapSize(u64 size);
+
+    /// Finds a free block of at least the given size, returns INVALID_INDEX if there is none.
+    u32 FindFreeBlock(u64 size) const;
+
+    /// Scans the bins between two mappings, both included, for a block matching the predicate.
+    template <typename Predicate>
+    u32 FindFittingBlock(Mapping first, Mapping last, Predicate&& fits) const;
+
+    void InsertFree(u32 index);
+    void RemoveFree(u32 index);
+
+    /// Cuts a block at the given size, returns the new block holding the rest of it.
+    u32 Split(u32 index, u64 head_size);
+
+    /// Absorbs the physical successor of a block into it, the successor must be free.
+    void MergeNext(u32 index);
+
+    u32 AllocateBlock();
+    void FreeBlock(u32 index);
+
+    u64 size;
+    u64 used = 0;
+
+    std::vector<Block> blocks;
+    u32 unused_head = INVALID_INDEX; ///< Chain of unused entries in blocks, through next_free.
+
+    u64 fl_bitmap = 0;
+    std::array<u32, FL_COUNT> sl_bitmaps{};
+    std::array<std::array<u32, SL_COUNT>, FL_COUNT> free_lists;
+};
+
+} // namespace Common
@@ -0,0 +1,91 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#include "common/logging/log.h"
+#include "common/virtual_buffer.h"
+
+namespace Common {
+
+void* TryAllocateMemoryPages(std::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+#ifdef _WIN32
+    void* base{VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE)};
+#else
+#ifdef MAP_NORESERVE
+    // Pages are only backed once touched, don't let the kernel refuse large sparse regions
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#else
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+    void* base{mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0)};
+    if (base == MAP_FAILED) {
+        base = nullptr;
+    }
+#endif
+
+    if (base == nullptr) {
+        return nullptr;
+    }
+
+#ifdef __linux__
+    // Tables covering a whole guest address space and guest memory itself are accessed at random;
+    // backing them with huge pages keeps each access from also costing a TLB miss. This is only
+    // advisory.
+    madvise(base, size, MADV_HUGEPAGE);
+#endif
+
+    return base;
+}
+
+void* AllocateMemoryPages(std::size_t size) {
+    void* const base{TryAllocateMemoryPages(size)};
+    if (base == nullptr && size != 0) {
+        LOG_CRITICAL(Common_Memory, "Failed to allocate 0x{:X} bytes: {}", size,
+                     GetLastErrorMsg());
+        UNREACHABLE();
+    }
+    return base;
+}
+
+void FreeMemoryPages(void* base, std::size_t size) {
+    if (base == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    const bool result{VirtualFree(base, 0, MEM_RELEASE) != 0};
+#else
+    const bool result{munmap(base, size) == 0};
+#endif
+    ASSERT_MSG(result, "Failed to free 0x{:X} bytes: {}", size, GetLastErrorMsg());
+}
+
+void DiscardMemoryPages(void* base, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+#ifdef _WIN32
+    // Decommitted pages fault on access, commit them again right away. Recommitted pages are
+    // zero-filled and only backed by memory once touched.
+    const bool result{VirtualFree(base, size, MEM_DECOMMIT) != 0 &&
+                      VirtualAlloc(base, size, MEM_COMMIT, PAGE_READWRITE) != nullptr};
+#else
+    const bool result{madvise(base, size, MADV_DONTNEED) == 0};
+#endif
+    ASSERT_MSG(result, "Failed to discard 0x{:X} bytes: {}", size, GetLastErrorMsg());
+}
+
+} // namespace Common
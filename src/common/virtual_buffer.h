@@ -0,0 +1,132 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace Common {
+
+/**
+ * Reserves zero-filled memory straight from the host OS. On Linux the region is additionally
+ * marked as eligible for transparent huge pages.
+ *
+ * @param size The size of the allocation in bytes.
+ * @returns A pointer to the allocation, or nullptr if it failed.
+ */
+void* AllocateMemoryPages(std::size_t size);
+
+/**
+ * Like AllocateMemoryPages, but a failed allocation is not fatal.
+ *
+ * @param size The size of the allocation in bytes.
+ * @returns A pointer to the allocation, or nullptr if it failed.
+ */
+void* TryAllocateMemoryPages(std::size_t size);
+
+/**
+ * Releases memory previously returned by AllocateMemoryPages.
+ *
+ * @param base The pointer returned by AllocateMemoryPages.
+ * @param size The size that was passed to AllocateMemoryPages.
+ */
+void FreeMemoryPages(void* base, std::size_t size);
+
+/**
+ * Hands the host pages backing part of an allocation back to the OS. The range stays usable and
+ * reads as zero afterwards, pages are only committed again once written to.
+ *
+ * @param base The start of the range, page aligned and within an AllocateMemoryPages allocation.
+ * @param size The size of the range in bytes, a multiple of the page size.
+ */
+void DiscardMemoryPages(void* base, std::size_t size);
+
+/**
+ * Fixed-size array of trivial elements backed by memory pages obtained from the host OS.
+ *
+ * Unlike std::vector, resizing neither copies old contents nor touches the new memory. Untouched
+ * pages read as zero and only get committed once written to, which makes this suitable for large,
+ * sparsely populated tables.
+ */
+template <typename T>
+class VirtualBuffer final {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                  "T must be trivial, as the buffer neither constructs nor destroys elements");
+
+public:
+    constexpr VirtualBuffer() = default;
+
+    explicit VirtualBuffer(std::size_t count) {
+        resize(count);
+    }
+
+    ~VirtualBuffer() {
+        FreeMemoryPages(base_ptr, alloc_size);
+    }
+
+    VirtualBuffer(const VirtualBuffer&) = delete;
+    VirtualBuffer& operator=(const VirtualBuffer&) = delete;
+
+    VirtualBuffer(VirtualBuffer&& other) noexcept
+        : alloc_size{std::exchange(other.alloc_size, 0)}, base_ptr{std::exchange(other.base_ptr,
+                                                                                 nullptr)} {}
+
+    VirtualBuffer& operator=(VirtualBuffer&& other) noexcept {
+        FreeMemoryPages(base_ptr, alloc_size);
+        alloc_size = std::exchange(other.alloc_size, 0);
+        base_ptr = std::exchange(other.base_ptr, nullptr);
+        return *this;
+    }
+
+    /// Replaces the contents with count zero-initialized elements.
+    void resize(std::size_t count) {
+        FreeMemoryPages(base_ptr, alloc_size);
+        alloc_size = count * sizeof(T);
+        base_ptr = static_cast<T*>(AllocateMemoryPages(alloc_size));
+    }
+
+    T& operator[](std::size_t index) {
+        return base_ptr[index];
+    }
+
+    const T& operator[](std::size_t index) const {
+        return base_ptr[index];
+    }
+
+    T* data() {
+        return base_ptr;
+    }
+
+    const T* data() const {
+        return base_ptr;
+    }
+
+    T* begin() {
+        return base_ptr;
+    }
+
+    const T* begin() const {
+        return base_ptr;
+    }
+
+    T* end() {
+        return base_ptr + size();
+    }
+
+    const T* end() const {
+        return base_ptr + size();
+    }
+
+    std::size_t size() const {
+        return alloc_size / sizeof(T);
+    }
+
+private:
+    std::size_t alloc_size{};
+    T* base_ptr{};
+};
+
+} // namespace Common
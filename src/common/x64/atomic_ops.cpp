@@ -0,0 +1,80 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "common/x64/atomic_ops.h"
+
+namespace Common {
+
+#ifdef _MSC_VER
+
+bool AtomicCompareAndSwap(volatile u8* pointer, u8 value, u8 expected) {
+    const u8 result = _InterlockedCompareExchange8(reinterpret_cast<volatile char*>(pointer),
+                                                   static_cast<char>(value),
+                                                   static_cast<char>(expected));
+    return result == expected;
+}
+
+bool AtomicCompareAndSwap(volatile u16* pointer, u16 value, u16 expected) {
+    const u16 result = _InterlockedCompareExchange16(reinterpret_cast<volatile short*>(pointer),
+                                                     static_cast<short>(value),
+                                                     static_cast<short>(expected));
+    return result == expected;
+}
+
+bool AtomicCompareAndSwap(volatile u32* pointer, u32 value, u32 expected) {
+    const u32 result = _InterlockedCompareExchange(reinterpret_cast<volatile long*>(pointer),
+                                                   static_cast<long>(value),
+                                                   static_cast<long>(expected));
+    return result == expected;
+}
+
+bool AtomicCompareAndSwap(volatile u64* pointer, u64 value, u64 expected) {
+    const u64 result = _InterlockedCompareExchange64(reinterpret_cast<volatile __int64*>(pointer),
+                                                     static_cast<__int64>(value),
+                                                     static_cast<__int64>(expected));
+    return result == expected;
+}
+
+bool AtomicCompareAndSwap(volatile u64* pointer, u128 value, u128 expected) {
+    return _InterlockedCompareExchange128(reinterpret_cast<volatile __int64*>(pointer),
+                                          static_cast<__int64>(value[1]),
+                                          static_cast<__int64>(value[0]),
+                                          reinterpret_cast<__int64*>(expected.data())) != 0;
+}
+
+#else
+
+bool AtomicCompareAndSwap(volatile u8* pointer, u8 value, u8 expected) {
+    return __sync_bool_compare_and_swap(pointer, expected, value);
+}
+
+bool AtomicCompareAndSwap(volatile u16* pointer, u16 value, u16 expected) {
+    return __sync_bool_compare_and_swap(pointer, expected, value);
+}
+
+bool AtomicCompareAndSwap(volatile u32* pointer, u32 value, u32 expected) {
+    return __sync_bool_compare_and_swap(pointer, expected, value);
+}
+
+bool AtomicCompareAndSwap(volatile u64* pointer, u64 value, u64 expected) {
+    return __sync_bool_compare_and_swap(pointer, expected, value);
+}
+
+bool AtomicCompareAndSwap(volatile u64* pointer, u128 value, u128 expected) {
+    // Spelled out instead of using the 16 byte builtin, which needs -mcx16 or libatomic
+    bool swapped;
+    __asm__ __volatile__("lock cmpxchg16b %1"
+                         : "=@ccz"(swapped), "+m"(*pointer), "+a"(expected[0]), "+d"(expected[1])
+                         : "b"(value[0]), "c"(value[1])
+                         : "memory");
+    return swapped;
+}
+
+#endif
+
+} // namespace Common
@@ -0,0 +1,27 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Atomically replaces the value at a host address with a new one if it still holds the expected
+ * value. These are locked instructions, so they also act as a full memory barrier.
+ * @param pointer  Address to operate on, it must be aligned to the size of the value
+ * @param value    Value to store
+ * @param expected Value the address has to hold for the store to happen
+ * @return Whether the value was stored
+ */
+bool AtomicCompareAndSwap(volatile u8* pointer, u8 value, u8 expected);
+bool AtomicCompareAndSwap(volatile u16* pointer, u16 value, u16 expected);
+bool AtomicCompareAndSwap(volatile u32* pointer, u32 value, u32 expected);
+bool AtomicCompareAndSwap(volatile u64* pointer, u64 value, u64 expected);
+
+/// 128-bit variant using cmpxchg16b, the pointer has to be aligned to 16 bytes.
+bool AtomicCompareAndSwap(volatile u64* pointer, u128 value, u128 expected);
+
+} // namespace Common
@@ -126,6 +126,8 @@ static CPUCaps Detect() {
                 caps.bmi1 = true;
             if ((cpu_id[1] >> 8) & 1)
                 caps.bmi2 = true;
+            if ((cpu_id[1] >> 29) & 1)
+                caps.sha = true;
         }
     }
 
@@ -154,6 +156,12 @@ static CPUCaps Detect() {
             caps.long_mode = true;
     }
 
+    if (max_ex_fn >= 0x80000007) {
+        __cpuid(cpu_id, 0x80000007);
+        if ((cpu_id[3] >> 8) & 1)
+            caps.invariant_tsc = true;
+    }
+
     return caps;
 }
 
@@ -198,6 +206,8 @@ std::string GetCPUCapsString() {
         sum += ", FMA";
     if (caps.aes)
         sum += ", AES";
+    if (caps.sha)
+        sum += ", SHA";
     if (caps.movbe)
         sum += ", MOVBE";
     if (caps.long_mode)
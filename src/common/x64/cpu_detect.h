@@ -35,6 +35,7 @@ struct CPUCaps {
     bool fma;
     bool fma4;
     bool aes;
+    bool sha;
 
     // Support for the FXSAVE and FXRSTOR instructions
     bool fxsave_fxrstor;
@@ -49,6 +50,9 @@ struct CPUCaps {
     bool lahf_sahf_64;
 
     bool long_mode;
+
+    // The time stamp counter runs at a constant rate regardless of power states
+    bool invariant_tsc;
 };
 
 /**
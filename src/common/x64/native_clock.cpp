@@ -0,0 +1,52 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "common/uint128.h"
+#include "common/x64/native_clock.h"
+
+namespace Common::X64 {
+
+u64 EstimateRDTSCFrequency() {
+    // Long enough for the scheduler's granularity to be negligible next to the measured span
+    constexpr std::chrono::milliseconds measure_time{200};
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const u64 tsc_start = __rdtsc();
+    std::this_thread::sleep_for(measure_time);
+    const auto end_time = std::chrono::steady_clock::now();
+    const u64 tsc_end = __rdtsc();
+
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+    return (tsc_end - tsc_start) * 1'000'000'000 / static_cast<u64>(elapsed);
+}
+
+NativeClock::NativeClock(u64 emulated_cpu_frequency, u64 emulated_clock_frequency,
+                         u64 rtsc_frequency)
+    : start_rdtsc{__rdtsc()}, cpu_factor{(emulated_cpu_frequency << 32) / rtsc_frequency},
+      clock_factor{(emulated_clock_frequency << 32) / rtsc_frequency} {}
+
+u64 NativeClock::GetCPUCycles() const {
+    return Scale(cpu_factor);
+}
+
+u64 NativeClock::GetClockCycles() const {
+    return Scale(clock_factor);
+}
+
+u64 NativeClock::Scale(u64 factor) const {
+    const u128 product = Multiply64Into128(__rdtsc() - start_rdtsc, factor);
+    return (product[1] << 32) | (product[0] >> 32);
+}
+
+} // namespace Common::X64
@@ -0,0 +1,40 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Common::X64 {
+
+/// Measures the frequency of the host time stamp counter against the steady clock.
+u64 EstimateRDTSCFrequency();
+
+/**
+ * Guest clock driven by the host time stamp counter. Reading it takes an rdtsc and a fixed point
+ * multiply, so it is cheap enough for games that poll the tick count in tight loops. The counter
+ * has to be invariant for the readings to be monotonic across host cores, see
+ * CPUCaps::invariant_tsc.
+ */
+class NativeClock final {
+public:
+    explicit NativeClock(u64 emulated_cpu_frequency, u64 emulated_clock_frequency,
+                         u64 rtsc_frequency);
+
+    /// Returns the ticks elapsed since the clock was created, at the emulated CPU frequency.
+    u64 GetCPUCycles() const;
+
+    /// Returns the ticks elapsed since the clock was created, at the emulated counter frequency.
+    u64 GetClockCycles() const;
+
+private:
+    /// Scales elapsed host ticks by a factor with 32 fractional bits.
+    u64 Scale(u64 factor) const;
+
+    u64 start_rdtsc;
+    u64 cpu_factor;
+    u64 clock_factor;
+};
+
+} // namespace Common::X64
@@ -48,4 +48,11 @@ std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed) {
     return decompressed;
 }
 
+bool DecompressDataZSTD(const u8* source, std::size_t source_size, u8* destination,
+                        std::size_t destination_size) {
+    const std::size_t result_size =
+        ZSTD_decompress(destination, destination_size, source, source_size);
+    return !ZSTD_isError(result_size) && result_size == destination_size;
+}
+
 } // namespace Common::Compression
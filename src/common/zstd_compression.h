@@ -41,4 +41,17 @@ std::vector<u8> CompressDataZSTDDefault(const u8* source, std::size_t source_siz
  */
 std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed);
 
+/**
+ * Decompresses a source memory region with Zstandard into a buffer of the known uncompressed size.
+ *
+ * @param source the compressed source memory region.
+ * @param source_size the size in bytes of the compressed source memory region.
+ * @param destination the buffer to write the uncompressed data to.
+ * @param destination_size the size in bytes of the uncompressed data.
+ *
+ * @return true if the data decompressed to exactly destination_size bytes.
+ */
+bool DecompressDataZSTD(const u8* source, std::size_t source_size, u8* destination,
+                        std::size_t destination_size);
+
 } // namespace Common::Compression
\ No newline at end of file
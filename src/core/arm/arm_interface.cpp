@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <optional>
 #include "common/bit_field.h"
@@ -118,22 +120,31 @@ Symbols GetSymbols(VAddr text_offset) {
         out.push_back({symbol, name});
     }
 
+    // Empty symbols (imports, labels) never contain an address, drop them so they can't shadow
+    // the function around them once sorted.
+    out.erase(std::remove_if(out.begin(), out.end(),
+                             [](const auto& pair) { return pair.first.size == 0; }),
+              out.end());
+    std::stable_sort(out.begin(), out.end(),
+                     [](const auto& a, const auto& b) { return a.first.value < b.first.value; });
     return out;
 }
 
 std::optional<std::string> GetSymbolName(const Symbols& symbols, VAddr func_address) {
-    const auto iter =
-        std::find_if(symbols.begin(), symbols.end(), [func_address](const auto& pair) {
-            const auto& [symbol, name] = pair;
-            const auto end_address = symbol.value + symbol.size;
-            return func_address >= symbol.value && func_address < end_address;
-        });
-
-    if (iter == symbols.end()) {
+    // Symbols are sorted by address, the only candidate is the last one starting at or before it.
+    const auto iter = std::upper_bound(
+        symbols.begin(), symbols.end(), func_address,
+        [](VAddr address, const auto& pair) { return address < pair.first.value; });
+    if (iter == symbols.begin()) {
         return std::nullopt;
     }
 
-    return iter->second;
+    const auto& [symbol, name] = *std::prev(iter);
+    if (func_address >= symbol.value + symbol.size) {
+        return std::nullopt;
+    }
+
+    return name;
 }
 
 } // Anonymous namespace
@@ -141,13 +152,13 @@ std::optional<std::string> GetSymbolName(const Symbols& symbols, VAddr func_addr
 constexpr u64 SEGMENT_BASE = 0x7100000000ull;
 
 std::vector<ARM_Interface::BacktraceEntry> ARM_Interface::GetBacktrace() const {
-    std::vector<BacktraceEntry> out;
+    std::vector<VAddr> addresses;
 
     auto fp = GetReg(29);
     auto lr = GetReg(30);
 
     while (true) {
-        out.push_back({"", 0, lr, 0});
+        addresses.push_back(lr);
         if (!fp) {
             break;
         }
@@ -155,6 +166,11 @@ std::vector<ARM_Interface::BacktraceEntry> ARM_Interface::GetBacktrace() const {
         fp = Memory::Read64(fp);
     }
 
+    return SymbolizeAddresses(addresses);
+}
+
+std::vector<ARM_Interface::BacktraceEntry> ARM_Interface::SymbolizeAddresses(
+    const std::vector<VAddr>& addresses) {
     std::map<VAddr, std::string> modules;
     auto& loader{System::GetInstance().GetAppLoader()};
     if (loader.ReadNSOModules(modules) != Loader::ResultStatus::Success) {
@@ -166,7 +182,10 @@ std::vector<ARM_Interface::BacktraceEntry> ARM_Interface::GetBacktrace() const {
         symbols.insert_or_assign(module.second, GetSymbols(module.first));
     }
 
-    for (auto& entry : out) {
+    std::vector<BacktraceEntry> out;
+    out.reserve(addresses.size());
+    for (const VAddr address : addresses) {
+        BacktraceEntry entry{"", 0, address, 0};
         VAddr base = 0;
         for (auto iter = modules.rbegin(); iter != modules.rend(); ++iter) {
             const auto& module{*iter};
@@ -191,6 +210,8 @@ std::vector<ARM_Interface::BacktraceEntry> ARM_Interface::GetBacktrace() const {
                 entry.name = *symbol;
             }
         }
+
+        out.push_back(std::move(entry));
     }
 
     return out;
@@ -47,6 +47,9 @@ public:
     /// Clear all instruction cache
     virtual void ClearInstructionCache() = 0;
 
+    /// Clear the instruction cache of the code in the range [addr, addr + size)
+    virtual void InvalidateCacheRange(VAddr addr, std::size_t size) = 0;
+
     /// Notifies CPU emulation that the current page table has changed.
     ///
     /// @param new_page_table                 The new page table.
@@ -156,6 +159,9 @@ public:
 
     std::vector<BacktraceEntry> GetBacktrace() const;
 
+    /// Resolves guest addresses to the loaded NSO module and symbol containing them.
+    static std::vector<BacktraceEntry> SymbolizeAddresses(const std::vector<VAddr>& addresses);
+
     /// fp (= r29) points to the last frame record.
     /// Note that this is the frame record for the *previous* frame, not the current one.
     /// Note we need to subtract 4 from our last read to get the proper address
@@ -2,12 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <cinttypes>
 #include <memory>
 #include <dynarmic/A64/a64.h>
 #include <dynarmic/A64/config.h>
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/microprofile.h"
+#include "common/x64/atomic_ops.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
@@ -23,9 +26,56 @@ namespace Core {
 
 using Vector = Dynarmic::A64::Vector;
 
+namespace {
+
+/// Code cache dynarmic allocates for each JIT, it doesn't report its usage
+constexpr std::size_t JitCodeCacheSize = 128 * 1024 * 1024;
+
+/// Gets the host memory backing a naturally aligned guest value, nullptr if its page isn't plain
+/// host memory (e.g. it is cached by the rasterizer) or the value is misaligned.
+u8* GetHostPointer(VAddr vaddr, std::size_t size) {
+    if (vaddr % size != 0) {
+        return nullptr;
+    }
+    u8* const page_pointer =
+        Core::CurrentProcess()->VMManager().page_table.pointers[vaddr >> Memory::PAGE_BITS];
+    return page_pointer ? page_pointer + (vaddr & Memory::PAGE_MASK) : nullptr;
+}
+
+/// Stores a value with a single locked host instruction, so it is never seen torn and is ordered
+/// like a release. Returns false if the store has to go through Memory::Write* instead.
+template <typename T>
+bool AtomicStore(VAddr vaddr, T value) {
+    u8* const host_pointer = GetHostPointer(vaddr, sizeof(T));
+    if (host_pointer == nullptr) {
+        return false;
+    }
+    auto* const pointer = reinterpret_cast<volatile T*>(host_pointer);
+    T expected = *pointer;
+    while (!Common::AtomicCompareAndSwap(pointer, value, expected)) {
+        expected = *pointer;
+    }
+    return true;
+}
+
+bool AtomicStore128(VAddr vaddr, u128 value) {
+    u8* const host_pointer = GetHostPointer(vaddr, sizeof(u128));
+    if (host_pointer == nullptr) {
+        return false;
+    }
+    auto* const pointer = reinterpret_cast<volatile u64*>(host_pointer);
+    u128 expected{pointer[0], pointer[1]};
+    while (!Common::AtomicCompareAndSwap(pointer, value, expected)) {
+        expected = {pointer[0], pointer[1]};
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
 class ARM_Dynarmic_Callbacks : public Dynarmic::A64::UserCallbacks {
 public:
-    explicit ARM_Dynarmic_Callbacks(ARM_Dynarmic& parent) : parent(parent) {}
+    explicit ARM_Dynarmic_Callbacks(ARM_Dynarmic* parent) : parent(parent) {}
 
     u8 MemoryRead8(u64 vaddr) override {
         return Memory::Read8(vaddr);
@@ -65,11 +115,11 @@ public:
                  num_instructions, MemoryReadCode(pc));
 
         ARM_Interface::ThreadContext ctx;
-        parent.SaveContext(ctx);
-        parent.inner_unicorn.LoadContext(ctx);
-        parent.inner_unicorn.ExecuteInstructions(static_cast<int>(num_instructions));
-        parent.inner_unicorn.SaveContext(ctx);
-        parent.LoadContext(ctx);
+        parent->SaveContext(ctx);
+        parent->inner_unicorn.LoadContext(ctx);
+        parent->inner_unicorn.ExecuteInstructions(static_cast<int>(num_instructions));
+        parent->inner_unicorn.SaveContext(ctx);
+        parent->LoadContext(ctx);
         num_interpreted_instructions += num_instructions;
     }
 
@@ -83,10 +133,10 @@ public:
             return;
         case Dynarmic::A64::Exception::Breakpoint:
             if (GDBStub::IsServerEnabled()) {
-                parent.jit->HaltExecution();
-                parent.SetPC(pc);
+                parent->PrepareReschedule();
+                parent->SetPC(pc);
                 Kernel::Thread* thread = Kernel::GetCurrentThread();
-                parent.SaveContext(thread->GetContext());
+                parent->SaveContext(thread->GetContext());
                 GDBStub::Break();
                 GDBStub::SendTrap(thread, 5);
                 return;
@@ -99,7 +149,7 @@ public:
     }
 
     void CallSVC(u32 swi) override {
-        Kernel::CallSVC(parent.system, swi);
+        Kernel::CallSVC(parent->system, swi);
     }
 
     void AddTicks(u64 ticks) override {
@@ -108,32 +158,48 @@ public:
         // if not all cores are doing a similar amount of work. Instead of doing this, we should
         // device a way so that timing is consistent across all cores without increasing the ticks 4
         // times.
-        u64 amortized_ticks = (ticks - num_interpreted_instructions) / Core::NUM_CPU_CORES;
+        // In parallel mode every core accounts for its own time slice, so nothing is shared.
+        u64 amortized_ticks = ticks - num_interpreted_instructions;
+        if (!Cpu::IsParallelModeEnabled()) {
+            amortized_ticks /= Core::NUM_CPU_CORES;
+        }
         // Always execute at least one tick.
         amortized_ticks = std::max<u64>(amortized_ticks, 1);
 
-        parent.system.CoreTiming().AddTicks(amortized_ticks);
+        parent->system.CpuCore(parent->core_index).AddTicks(amortized_ticks);
         num_interpreted_instructions = 0;
     }
     u64 GetTicksRemaining() override {
-        return std::max(parent.system.CoreTiming().GetDowncount(), 0);
+        return std::max<s64>(parent->system.CpuCore(parent->core_index).GetDowncount(), 0);
     }
     u64 GetCNTPCT() override {
-        return Timing::CpuCyclesToClockCycles(parent.system.CoreTiming().GetTicks());
+        return parent->system.CoreTiming().GetClockTicks();
     }
 
-    ARM_Dynarmic& parent;
+    /// Core currently running on the JIT
+    ARM_Dynarmic* parent;
     std::size_t num_interpreted_instructions = 0;
     u64 tpidrro_el0 = 0;
     u64 tpidr_el0 = 0;
 };
 
+struct ARM_Dynarmic::JitState {
+    explicit JitState(ARM_Dynarmic* creator) : cb{creator} {}
+
+    ARM_Dynarmic_Callbacks cb;
+    std::unique_ptr<Dynarmic::A64::Jit> jit;
+    Common::MemoryAccounting::TrackedAllocation code_cache{
+        Common::MemoryAccounting::Tag::JitCodeCache};
+    /// Core whose registers are loaded into the JIT, the others keep theirs parked
+    std::atomic<ARM_Dynarmic*> owner{};
+};
+
 std::unique_ptr<Dynarmic::A64::Jit> ARM_Dynarmic::MakeJit(Common::PageTable& page_table,
                                                           std::size_t address_space_bits) const {
     Dynarmic::A64::UserConfig config;
 
     // Callbacks
-    config.callbacks = cb.get();
+    config.callbacks = &state->cb;
 
     // Memory
     config.page_table = reinterpret_cast<void**>(page_table.pointers.data());
@@ -145,8 +211,8 @@ std::unique_ptr<Dynarmic::A64::Jit> ARM_Dynarmic::MakeJit(Common::PageTable& pag
     config.global_monitor = &exclusive_monitor.monitor;
 
     // System registers
-    config.tpidrro_el0 = &cb->tpidrro_el0;
-    config.tpidr_el0 = &cb->tpidr_el0;
+    config.tpidrro_el0 = &state->cb.tpidrro_el0;
+    config.tpidr_el0 = &state->cb.tpidr_el0;
     config.dczid_el0 = 4;
     config.ctr_el0 = 0x8444c004;
     config.cntfrq_el0 = Timing::CNTFREQ;
@@ -162,106 +228,200 @@ MICROPROFILE_DEFINE(ARM_Jit_Dynarmic, "ARM JIT", "Dynarmic", MP_RGB(255, 64, 64)
 void ARM_Dynarmic::Run() {
     MICROPROFILE_SCOPE(ARM_Jit_Dynarmic);
 
-    jit->Run();
+    AcquireJit();
+    state->jit->Run();
 }
 
 void ARM_Dynarmic::Step() {
-    cb->InterpreterFallback(jit->GetPC(), 1);
+    AcquireJit();
+    state->cb.InterpreterFallback(state->jit->GetPC(), 1);
 }
 
 ARM_Dynarmic::ARM_Dynarmic(System& system, ExclusiveMonitor& exclusive_monitor,
-                           std::size_t core_index)
-    : cb(std::make_unique<ARM_Dynarmic_Callbacks>(*this)), inner_unicorn{system},
-      core_index{core_index}, system{system},
+                           std::size_t core_index, ARM_Dynarmic* shared_jit_core)
+    : state{shared_jit_core ? shared_jit_core->state : std::make_shared<JitState>(this)},
+      inner_unicorn{system}, borrows_jit{shared_jit_core != nullptr}, core_index{core_index},
+      system{system},
       exclusive_monitor{dynamic_cast<DynarmicExclusiveMonitor&>(exclusive_monitor)} {}
 
 ARM_Dynarmic::~ARM_Dynarmic() = default;
 
 void ARM_Dynarmic::SetPC(u64 pc) {
-    jit->SetPC(pc);
+    if (!OwnsJit()) {
+        parked_context.pc = pc;
+        return;
+    }
+    state->jit->SetPC(pc);
 }
 
 u64 ARM_Dynarmic::GetPC() const {
-    return jit->GetPC();
+    if (!OwnsJit()) {
+        return parked_context.pc;
+    }
+    return state->jit->GetPC();
 }
 
 u64 ARM_Dynarmic::GetReg(int index) const {
-    return jit->GetRegister(index);
+    if (!OwnsJit()) {
+        return parked_context.cpu_registers[index];
+    }
+    return state->jit->GetRegister(index);
 }
 
 void ARM_Dynarmic::SetReg(int index, u64 value) {
-    jit->SetRegister(index, value);
+    if (!OwnsJit()) {
+        parked_context.cpu_registers[index] = value;
+        return;
+    }
+    state->jit->SetRegister(index, value);
 }
 
 u128 ARM_Dynarmic::GetVectorReg(int index) const {
-    return jit->GetVector(index);
+    if (!OwnsJit()) {
+        return parked_context.vector_registers[index];
+    }
+    return state->jit->GetVector(index);
 }
 
 void ARM_Dynarmic::SetVectorReg(int index, u128 value) {
-    jit->SetVector(index, value);
+    if (!OwnsJit()) {
+        parked_context.vector_registers[index] = value;
+        return;
+    }
+    state->jit->SetVector(index, value);
 }
 
 u32 ARM_Dynarmic::GetPSTATE() const {
-    return jit->GetPstate();
+    if (!OwnsJit()) {
+        return parked_context.pstate;
+    }
+    return state->jit->GetPstate();
 }
 
 void ARM_Dynarmic::SetPSTATE(u32 pstate) {
-    jit->SetPstate(pstate);
+    if (!OwnsJit()) {
+        parked_context.pstate = pstate;
+        return;
+    }
+    state->jit->SetPstate(pstate);
 }
 
 u64 ARM_Dynarmic::GetTlsAddress() const {
-    return cb->tpidrro_el0;
+    return OwnsJit() ? state->cb.tpidrro_el0 : parked_tpidrro_el0;
 }
 
 void ARM_Dynarmic::SetTlsAddress(VAddr address) {
-    cb->tpidrro_el0 = address;
+    (OwnsJit() ? state->cb.tpidrro_el0 : parked_tpidrro_el0) = address;
 }
 
 u64 ARM_Dynarmic::GetTPIDR_EL0() const {
-    return cb->tpidr_el0;
+    return OwnsJit() ? state->cb.tpidr_el0 : parked_context.tpidr;
 }
 
 void ARM_Dynarmic::SetTPIDR_EL0(u64 value) {
-    cb->tpidr_el0 = value;
+    (OwnsJit() ? state->cb.tpidr_el0 : parked_context.tpidr) = value;
 }
 
 void ARM_Dynarmic::SaveContext(ThreadContext& ctx) {
-    ctx.cpu_registers = jit->GetRegisters();
-    ctx.sp = jit->GetSP();
-    ctx.pc = jit->GetPC();
-    ctx.pstate = jit->GetPstate();
-    ctx.vector_registers = jit->GetVectors();
-    ctx.fpcr = jit->GetFpcr();
-    ctx.fpsr = jit->GetFpsr();
-    ctx.tpidr = cb->tpidr_el0;
+    if (!OwnsJit()) {
+        ctx = parked_context;
+        return;
+    }
+    SaveJitContext(ctx);
 }
 
 void ARM_Dynarmic::LoadContext(const ThreadContext& ctx) {
-    jit->SetRegisters(ctx.cpu_registers);
-    jit->SetSP(ctx.sp);
-    jit->SetPC(ctx.pc);
-    jit->SetPstate(ctx.pstate);
-    jit->SetVectors(ctx.vector_registers);
-    jit->SetFpcr(ctx.fpcr);
-    jit->SetFpsr(ctx.fpsr);
-    SetTPIDR_EL0(ctx.tpidr);
+    if (!OwnsJit()) {
+        parked_context = ctx;
+        return;
+    }
+    LoadJitContext(ctx);
 }
 
 void ARM_Dynarmic::PrepareReschedule() {
-    jit->HaltExecution();
+    // Cores that don't own the JIT aren't running
+    if (OwnsJit()) {
+        state->jit->HaltExecution();
+    }
 }
 
 void ARM_Dynarmic::ClearInstructionCache() {
-    jit->ClearCache();
+    state->jit->ClearCache();
+}
+
+void ARM_Dynarmic::InvalidateCacheRange(VAddr addr, std::size_t size) {
+    state->jit->InvalidateCacheRange(addr, size);
 }
 
 void ARM_Dynarmic::ClearExclusiveState() {
-    jit->ClearExclusiveState();
+    // The exclusive state is already cleared when parking
+    if (OwnsJit()) {
+        state->jit->ClearExclusiveState();
+    }
 }
 
 void ARM_Dynarmic::PageTableChanged(Common::PageTable& page_table,
                                     std::size_t new_address_space_size_in_bits) {
-    jit = MakeJit(page_table, new_address_space_size_in_bits);
+    if (borrows_jit) {
+        // The core owning the JIT is notified of the same change
+        return;
+    }
+
+    if (ARM_Dynarmic* const owner = state->owner) {
+        owner->ParkJit();
+    }
+    state->jit = MakeJit(page_table, new_address_space_size_in_bits);
+    state->code_cache.Resize(JitCodeCacheSize);
+}
+
+bool ARM_Dynarmic::OwnsJit() const {
+    return state->owner == this;
+}
+
+void ARM_Dynarmic::AcquireJit() {
+    if (OwnsJit()) {
+        return;
+    }
+
+    if (ARM_Dynarmic* const owner = state->owner) {
+        owner->ParkJit();
+    }
+    LoadJitContext(parked_context);
+    state->cb.tpidrro_el0 = parked_tpidrro_el0;
+    state->cb.parent = this;
+    state->owner = this;
+}
+
+void ARM_Dynarmic::ParkJit() {
+    SaveJitContext(parked_context);
+    parked_tpidrro_el0 = state->cb.tpidrro_el0;
+    // A reservation of one core must not let the store of another one through
+    state->jit->ClearExclusiveState();
+    state->owner = nullptr;
+}
+
+void ARM_Dynarmic::SaveJitContext(ThreadContext& ctx) const {
+    const auto& jit = *state->jit;
+    ctx.cpu_registers = jit.GetRegisters();
+    ctx.sp = jit.GetSP();
+    ctx.pc = jit.GetPC();
+    ctx.pstate = jit.GetPstate();
+    ctx.vector_registers = jit.GetVectors();
+    ctx.fpcr = jit.GetFpcr();
+    ctx.fpsr = jit.GetFpsr();
+    ctx.tpidr = state->cb.tpidr_el0;
+}
+
+void ARM_Dynarmic::LoadJitContext(const ThreadContext& ctx) {
+    auto& jit = *state->jit;
+    jit.SetRegisters(ctx.cpu_registers);
+    jit.SetSP(ctx.sp);
+    jit.SetPC(ctx.pc);
+    jit.SetPstate(ctx.pstate);
+    jit.SetVectors(ctx.vector_registers);
+    jit.SetFpcr(ctx.fpcr);
+    jit.SetFpsr(ctx.fpsr);
+    state->cb.tpidr_el0 = ctx.tpidr;
 }
 
 DynarmicExclusiveMonitor::DynarmicExclusiveMonitor(std::size_t core_count) : monitor(core_count) {}
@@ -277,29 +437,43 @@ void DynarmicExclusiveMonitor::ClearExclusive() {
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite8(std::size_t core_index, VAddr vaddr, u8 value) {
-    return monitor.DoExclusiveOperation(core_index, vaddr, 1,
-                                        [&] { Memory::Write8(vaddr, value); });
+    return monitor.DoExclusiveOperation(core_index, vaddr, 1, [&] {
+        if (!AtomicStore(vaddr, value)) {
+            Memory::Write8(vaddr, value);
+        }
+    });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite16(std::size_t core_index, VAddr vaddr, u16 value) {
-    return monitor.DoExclusiveOperation(core_index, vaddr, 2,
-                                        [&] { Memory::Write16(vaddr, value); });
+    return monitor.DoExclusiveOperation(core_index, vaddr, 2, [&] {
+        if (!AtomicStore(vaddr, value)) {
+            Memory::Write16(vaddr, value);
+        }
+    });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite32(std::size_t core_index, VAddr vaddr, u32 value) {
-    return monitor.DoExclusiveOperation(core_index, vaddr, 4,
-                                        [&] { Memory::Write32(vaddr, value); });
+    return monitor.DoExclusiveOperation(core_index, vaddr, 4, [&] {
+        if (!AtomicStore(vaddr, value)) {
+            Memory::Write32(vaddr, value);
+        }
+    });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite64(std::size_t core_index, VAddr vaddr, u64 value) {
-    return monitor.DoExclusiveOperation(core_index, vaddr, 8,
-                                        [&] { Memory::Write64(vaddr, value); });
+    return monitor.DoExclusiveOperation(core_index, vaddr, 8, [&] {
+        if (!AtomicStore(vaddr, value)) {
+            Memory::Write64(vaddr, value);
+        }
+    });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite128(std::size_t core_index, VAddr vaddr, u128 value) {
     return monitor.DoExclusiveOperation(core_index, vaddr, 16, [&] {
-        Memory::Write64(vaddr + 0, value[0]);
-        Memory::Write64(vaddr + 8, value[1]);
+        if (!AtomicStore128(vaddr, value)) {
+            Memory::Write64(vaddr + 0, value[0]);
+            Memory::Write64(vaddr + 8, value[1]);
+        }
     });
 }
 
@@ -20,7 +20,13 @@ class System;
 
 class ARM_Dynarmic final : public ARM_Interface {
 public:
-    ARM_Dynarmic(System& system, ExclusiveMonitor& exclusive_monitor, std::size_t core_index);
+    /**
+     * @param shared_jit_core Core whose JIT and translated code this core shares, or nullptr to
+     *                        create a JIT of its own. Cores sharing a JIT must all run on the
+     *                        same host thread.
+     */
+    ARM_Dynarmic(System& system, ExclusiveMonitor& exclusive_monitor, std::size_t core_index,
+                 ARM_Dynarmic* shared_jit_core = nullptr);
     ~ARM_Dynarmic() override;
 
     void SetPC(u64 pc) override;
@@ -45,18 +51,38 @@ public:
     void ClearExclusiveState() override;
 
     void ClearInstructionCache() override;
+    void InvalidateCacheRange(VAddr addr, std::size_t size) override;
     void PageTableChanged(Common::PageTable& new_page_table,
                           std::size_t new_address_space_size_in_bits) override;
 
 private:
+    struct JitState;
+
     std::unique_ptr<Dynarmic::A64::Jit> MakeJit(Common::PageTable& page_table,
                                                 std::size_t address_space_bits) const;
 
+    /// Whether the registers of this core are the ones loaded into the JIT.
+    bool OwnsJit() const;
+
+    /// Loads the registers of this core into the JIT, parking the core that used it before.
+    void AcquireJit();
+
+    /// Moves the registers of this core out of the JIT, into the parked context.
+    void ParkJit();
+
+    void SaveJitContext(ThreadContext& ctx) const;
+    void LoadJitContext(const ThreadContext& ctx);
+
     friend class ARM_Dynarmic_Callbacks;
-    std::unique_ptr<ARM_Dynarmic_Callbacks> cb;
-    std::unique_ptr<Dynarmic::A64::Jit> jit;
+    std::shared_ptr<JitState> state;
     ARM_Unicorn inner_unicorn;
 
+    /// Registers of this core while another core is using the JIT
+    ThreadContext parked_context{};
+    u64 parked_tpidrro_el0 = 0;
+    /// Whether this core uses the JIT of another one
+    bool borrows_jit;
+
     std::size_t core_index;
     System& system;
     DynarmicExclusiveMonitor& exclusive_monitor;
@@ -2,12 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/string_util.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
@@ -30,6 +35,8 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/scheduler.h"
+#include "core/hle/kernel/slab_heap.h"
+#include "core/hle/kernel/svc.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/service/am/applets/applets.h"
 #include "core/hle/service/apm/controller.h"
@@ -44,7 +51,9 @@
 #include "core/settings.h"
 #include "core/telemetry_session.h"
 #include "core/tools/freezer.h"
+#include "core/tools/guest_profiler.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -172,6 +181,9 @@ struct System::Impl {
 
     ResultStatus Load(System& system, Frontend::EmuWindow& emu_window,
                       const std::string& filepath) {
+        using BootClock = std::chrono::steady_clock;
+        const auto boot_start = BootClock::now();
+
         app_loader = Loader::GetLoader(GetGameFileFromPath(virtual_filesystem, filepath));
         if (!app_loader) {
             LOG_CRITICAL(Core, "Failed to obtain loader for {}!", filepath);
@@ -185,6 +197,14 @@ struct System::Impl {
             Shutdown();
             return init_result;
         }
+        const auto init_end = BootClock::now();
+
+        // Let the renderer read its disk caches while the executables are decompressed and
+        // patched. Loaders that only know the title ID after loading skip this.
+        u64 prefetch_title_id{};
+        if (app_loader->ReadProgramId(prefetch_title_id) == Loader::ResultStatus::Success) {
+            renderer->Rasterizer().PrefetchDiskResources(prefetch_title_id);
+        }
 
         telemetry_session->AddInitialInfo(*app_loader);
         auto main_process =
@@ -199,6 +219,7 @@ struct System::Impl {
         }
         AddGlueRegistrationForProcess(*app_loader, *main_process);
         kernel.MakeCurrentProcess(main_process.get());
+        const auto load_end = BootClock::now();
 
         // Main process has been loaded and been made current.
         // Begin GPU and CPU execution.
@@ -229,10 +250,20 @@ struct System::Impl {
                       static_cast<u32>(load_result));
         }
         perf_stats = std::make_unique<PerfStats>(title_id);
+        if (Settings::values.profile_guest_code) {
+            guest_profiler = std::make_unique<Tools::GuestProfiler>(system, title_id);
+        }
         // Reset counters and set time origin to current frame
         GetAndResetPerfStats();
         perf_stats->BeginSystemFrame();
 
+        const auto to_ms = [](BootClock::duration duration) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+        };
+        LOG_INFO(Core, "Booted in {} ms: initialization {} ms, loading {} ms, starting {} ms",
+                 to_ms(BootClock::now() - boot_start), to_ms(init_end - boot_start),
+                 to_ms(load_end - init_end), to_ms(BootClock::now() - load_end));
+
         status = ResultStatus::Success;
         return status;
     }
@@ -248,6 +279,27 @@ struct System::Impl {
                                     perf_results.frametime * 1000.0);
         telemetry_session->AddField(Telemetry::FieldType::Performance, "Mean_Frametime_MS",
                                     perf_stats->GetMeanFrametime());
+        telemetry_session->AddField(Telemetry::FieldType::Performance, "Shutdown_IdleLoopSkips",
+                                    kernel.GetIdleLoopSkipCount());
+        telemetry_session->AddField(Telemetry::FieldType::Performance,
+                                    "Shutdown_IdleLoopSkippedTicks",
+                                    kernel.GetIdleLoopSkippedTicks());
+        for (const auto& heap : Kernel::GetSlabHeapStatistics()) {
+            LOG_INFO(Core, "Kernel slab heap {}: {} live, {} peak, {} reserved", heap.name,
+                     heap.live_objects, heap.peak_objects, heap.capacity);
+            const auto field_name = fmt::format("Shutdown_KernelSlabPeak_{}", heap.name);
+            telemetry_session->AddField(Telemetry::FieldType::Performance, field_name.c_str(),
+                                        static_cast<u64>(heap.peak_objects));
+        }
+        for (const auto& usage : Common::MemoryAccounting::GetStatistics()) {
+            LOG_INFO(Core, "Host memory of {}: {} KiB, {} KiB peak", usage.name,
+                     usage.current_bytes >> 10, usage.peak_bytes >> 10);
+            const auto field_name = fmt::format("Shutdown_MemoryPeak_{}", usage.name);
+            telemetry_session->AddField(Telemetry::FieldType::Performance, field_name.c_str(),
+                                        usage.peak_bytes);
+        }
+        AddSessionPerformanceFields();
+        reporter.SaveSVCStatisticsReport();
 
         is_powered_on = false;
         exit_lock = false;
@@ -265,6 +317,9 @@ struct System::Impl {
         // Close all CPU/threading state
         cpu_core_manager.Shutdown();
 
+        // Symbolizing the profile reads the modules, do it before the process goes away
+        guest_profiler.reset();
+
         // Shutdown kernel and core timing
         kernel.Shutdown();
         core_timing.Shutdown();
@@ -316,6 +371,73 @@ struct System::Impl {
         }
     }
 
+    /// Adds the aggregated performance counters of the session, used to track regressions
+    void AddSessionPerformanceFields() {
+        if (!perf_stats) {
+            return;
+        }
+        const auto add_field = [this](const std::string& name, auto value) {
+            telemetry_session->AddField(Telemetry::FieldType::Performance, name.c_str(), value);
+        };
+
+        const auto speed = perf_stats->GetEmulationSpeedSummary();
+        add_field("Session_EmulationSpeed_Mean", speed.mean * 100.0);
+        add_field("Session_EmulationSpeed_Min", speed.min * 100.0);
+        add_field("Session_EmulationSpeed_Max", speed.max * 100.0);
+        add_field("Session_EmulationSpeed_Samples", speed.num_samples);
+
+        const auto frametimes = perf_stats->GetFrametimeHistogram();
+        add_field("Session_Frametime_P50_MS", frametimes.p50);
+        add_field("Session_Frametime_P95_MS", frametimes.p95);
+        add_field("Session_Frametime_P99_MS", frametimes.p99);
+        add_field("Session_Frametime_Max_MS", frametimes.max);
+        for (std::size_t i = 0; i < frametimes.buckets.size(); ++i) {
+            const auto& limits = FrametimeHistogram::BucketLimits;
+            const auto name = i < limits.size()
+                                  ? fmt::format("Session_Frametime_Under_{:.0f}_MS", limits[i])
+                                  : fmt::format("Session_Frametime_Over_{:.0f}_MS", limits.back());
+            add_field(name, frametimes.buckets[i]);
+        }
+
+        const auto pacing = perf_stats->GetFramePacingSummary();
+        add_field("Session_FramePacing_P50_MS", pacing.p50);
+        add_field("Session_FramePacing_P95_MS", pacing.p95);
+        add_field("Session_FramePacing_P99_MS", pacing.p99);
+        add_field("Session_FramePacing_Max_MS", pacing.max);
+        add_field("Session_FramePacing_Samples", pacing.num_samples);
+
+        const auto rasterizer = renderer->Rasterizer().GetStatistics();
+        add_field("Session_ShaderBuilds", rasterizer.shader_builds);
+        add_field("Session_ShaderBuildTime_MS",
+                  std::chrono::duration<double, std::milli>(rasterizer.shader_build_time).count());
+        add_field("Session_TextureCacheLookups", rasterizer.surface_lookups);
+        add_field("Session_TextureCacheMisses", rasterizer.surface_misses);
+
+        add_field("Session_JitInvalidations",
+                  cpu_core_manager.GetInstructionCacheInvalidationCount());
+
+        // The SVCs the session spent the most host time in
+        constexpr std::size_t NUM_TOP_SVCS = 5;
+        std::vector<u32> svcs;
+        for (u32 id = 0; id < Kernel::NUM_SVCS; ++id) {
+            if (kernel.GetSVCCallCount(id) != 0) {
+                svcs.push_back(id);
+            }
+        }
+        const auto num_top_svcs = std::min(svcs.size(), NUM_TOP_SVCS);
+        std::partial_sort(svcs.begin(), svcs.begin() + num_top_svcs, svcs.end(),
+                          [this](u32 lhs, u32 rhs) {
+                              return kernel.GetSVCHostTime(lhs) > kernel.GetSVCHostTime(rhs);
+                          });
+        for (std::size_t i = 0; i < num_top_svcs; ++i) {
+            const u32 id = svcs[i];
+            add_field(fmt::format("Session_TopSVC{}_Name", i), std::string{Kernel::GetSVCName(id)});
+            add_field(fmt::format("Session_TopSVC{}_Calls", i), kernel.GetSVCCallCount(id));
+            add_field(fmt::format("Session_TopSVC{}_HostTime_MS", i),
+                      static_cast<double>(kernel.GetSVCHostTime(id)) / 1'000'000.0);
+        }
+    }
+
     PerfStatsResults GetAndResetPerfStats() {
         return perf_stats->GetAndResetStats(core_timing.GetGlobalTimeUs());
     }
@@ -339,6 +461,7 @@ struct System::Impl {
 
     std::unique_ptr<Memory::CheatEngine> cheat_engine;
     std::unique_ptr<Tools::Freezer> memory_freezer;
+    std::unique_ptr<Tools::GuestProfiler> guest_profiler;
     std::array<u8, 0x20> build_id{};
 
     /// Frontend applets
@@ -388,6 +511,10 @@ void System::InvalidateCpuInstructionCaches() {
     impl->cpu_core_manager.InvalidateAllInstructionCaches();
 }
 
+void System::InvalidateCpuInstructionCacheRange(VAddr addr, std::size_t size) {
+    impl->cpu_core_manager.InvalidateInstructionCacheRange(addr, size);
+}
+
 System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::string& filepath) {
     return impl->Load(*this, emu_window, filepath);
 }
@@ -561,6 +688,10 @@ std::shared_ptr<FileSys::VfsFilesystem> System::GetFilesystem() const {
     return impl->virtual_filesystem;
 }
 
+Tools::GuestProfiler* System::GetGuestProfiler() const {
+    return impl->guest_profiler.get();
+}
+
 void System::RegisterCheatList(const std::vector<Memory::CheatEntry>& list,
                                const std::array<u8, 32>& build_id, VAddr main_region_begin,
                                u64 main_region_size) {
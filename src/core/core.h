@@ -69,6 +69,10 @@ class DebugContext;
 class GPU;
 } // namespace Tegra
 
+namespace Tools {
+class GuestProfiler;
+} // namespace Tools
+
 namespace VideoCore {
 class RendererBase;
 } // namespace VideoCore
@@ -151,6 +155,14 @@ public:
      */
     void InvalidateCpuInstructionCaches();
 
+    /**
+     * Invalidate the code translated from a guest memory range on all CPU cores, for when code is
+     * mapped, unmapped or modified there.
+     * @param addr Start address of the range
+     * @param size Size of the range in bytes
+     */
+    void InvalidateCpuInstructionCacheRange(VAddr addr, std::size_t size);
+
     /// Shutdown the emulated system.
     void Shutdown();
 
@@ -289,6 +301,9 @@ public:
 
     std::shared_ptr<FileSys::VfsFilesystem> GetFilesystem() const;
 
+    /// Returns the guest profiler of the session, or nullptr when guest profiling is disabled.
+    Tools::GuestProfiler* GetGuestProfiler() const;
+
     void RegisterCheatList(const std::vector<Memory::CheatEntry>& list,
                            const std::array<u8, 0x20>& build_id, VAddr main_region_begin,
                            u64 main_region_size);
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 
@@ -20,11 +22,13 @@
 #include "core/settings.h"
 
 namespace Core {
+namespace {
+/// Upper bound on how long an idle core sleeps before checking for work again.
+constexpr std::chrono::microseconds PARK_TIMEOUT{100};
+} // Anonymous namespace
 
 void CpuBarrier::NotifyEnd() {
-    std::unique_lock lock{mutex};
-    end = true;
-    condition.notify_all();
+    barrier.Cancel();
 }
 
 bool CpuBarrier::Rendezvous() {
@@ -33,34 +37,34 @@ bool CpuBarrier::Rendezvous() {
         return true;
     }
 
-    if (!end) {
-        std::unique_lock lock{mutex};
-
-        --cores_waiting;
-        if (!cores_waiting) {
-            cores_waiting = NUM_CPU_CORES;
-            condition.notify_all();
-            return true;
-        }
-
-        condition.wait(lock);
-        return true;
+    if (Cpu::IsParallelModeEnabled()) {
+        // Cores only synchronize at kernel scheduling points and CoreTiming events in this mode
+        return IsAlive();
     }
 
-    return false;
+    // Cores released by NotifyEnd fail too, the session is gone by then
+    return barrier.Sync();
 }
 
 Cpu::Cpu(System& system, ExclusiveMonitor& exclusive_monitor, CpuBarrier& cpu_barrier,
          std::size_t core_index)
-    : cpu_barrier{cpu_barrier}, core_timing{system.CoreTiming()}, core_index{core_index} {
+    : cpu_barrier{cpu_barrier}, system{system}, core_timing{system.CoreTiming()},
+      core_index{core_index} {
 #ifdef ARCHITECTURE_x86_64
-    arm_interface = std::make_unique<ARM_Dynarmic>(system, exclusive_monitor, core_index);
+    // The first core is always created first, the other ones may borrow its JIT
+    ARM_Dynarmic* const shared_jit_core =
+        core_index != 0 && IsJitCacheShared()
+            ? &static_cast<ARM_Dynarmic&>(system.CpuCore(0).ArmInterface())
+            : nullptr;
+    arm_interface =
+        std::make_unique<ARM_Dynarmic>(system, exclusive_monitor, core_index, shared_jit_core);
 #else
     arm_interface = std::make_unique<ARM_Unicorn>(system);
     LOG_WARNING(Core, "CPU JIT requested, but Dynarmic not available");
 #endif
 
-    scheduler = std::make_unique<Kernel::Scheduler>(system, *arm_interface);
+    scheduler =
+        std::make_unique<Kernel::Scheduler>(system, *arm_interface, static_cast<u32>(core_index));
 }
 
 Cpu::~Cpu() = default;
@@ -74,6 +78,18 @@ std::unique_ptr<ExclusiveMonitor> Cpu::MakeExclusiveMonitor(std::size_t num_core
 #endif
 }
 
+bool Cpu::IsParallelModeEnabled() {
+    return Settings::values.use_multi_core && Settings::values.use_parallel_cpu;
+}
+
+bool Cpu::IsJitCacheShared() {
+#ifdef ARCHITECTURE_x86_64
+    return !Settings::values.use_multi_core && Settings::values.use_shared_jit_cache;
+#else
+    return false;
+#endif
+}
+
 void Cpu::RunLoop(bool tight_loop) {
     // Wait for all other CPU cores to complete the previous slice, such that they run in lock-step
     if (!cpu_barrier.Rendezvous()) {
@@ -85,17 +101,37 @@ void Cpu::RunLoop(bool tight_loop) {
     // instead advance to the next event and try to yield to the next thread
     if (Kernel::GetCurrentThread() == nullptr) {
         LOG_TRACE(Core, "Core-{} idling", core_index);
+        is_idle = true;
 
-        if (IsMainCore()) {
-            // TODO(Subv): Only let CoreTiming idle if all 4 cores are idling.
-            core_timing.Idle();
-            core_timing.Advance();
-        }
+        if (!IsParallelModeEnabled()) {
+            if (IsMainCore()) {
+                // TODO(Subv): Only let CoreTiming idle if all 4 cores are idling.
+                core_timing.Idle();
+                core_timing.Advance();
+            }
 
-        PrepareReschedule();
+            PrepareReschedule();
+        } else {
+            if (IsMainCore()) {
+                IdleMainCore();
+            } else {
+                Park();
+            }
+
+            // Don't go through PrepareReschedule(), as that would wake this core up again
+            reschedule_pending = true;
+        }
     } else {
+        is_idle = false;
+
         if (IsMainCore()) {
             core_timing.Advance();
+            if (IsParallelModeEnabled()) {
+                WakeWaitingCores();
+            }
+        } else if (IsParallelModeEnabled() && !BeginSecondarySlice()) {
+            Reschedule();
+            return;
         }
 
         if (tight_loop) {
@@ -115,6 +151,87 @@ void Cpu::SingleStep() {
 void Cpu::PrepareReschedule() {
     arm_interface->PrepareReschedule();
     reschedule_pending = true;
+    wakeup_event.Set();
+}
+
+void Cpu::AddTicks(u64 ticks) {
+    if (IsMainCore() || !IsParallelModeEnabled()) {
+        core_timing.AddTicks(ticks);
+        return;
+    }
+
+    core_timing.AddCoreTicks(core_index, ticks);
+}
+
+s64 Cpu::GetDowncount() const {
+    if (IsMainCore() || !IsParallelModeEnabled()) {
+        return core_timing.GetDowncount();
+    }
+    return core_timing.GetCoreDowncount(core_index);
+}
+
+u64 Cpu::GetLocalTicks() const {
+    if (IsMainCore() || !IsParallelModeEnabled()) {
+        return core_timing.GetTicks();
+    }
+    return core_timing.GetCoreTicks(core_index);
+}
+
+void Cpu::IdleMainCore() {
+    // Skipping ahead to the next event is only safe when no core has any work left. While other
+    // cores are busy, guest time instead follows the one that got the furthest.
+    bool all_idle = true;
+    u64 target_ticks = 0;
+    for (std::size_t index = 1; index < NUM_CPU_CORES; ++index) {
+        const Cpu& cpu = system.CpuCore(index);
+        if (!cpu.IsIdle()) {
+            all_idle = false;
+            target_ticks = std::max(target_ticks, cpu.GetLocalTicks());
+        }
+    }
+
+    if (all_idle) {
+        core_timing.Idle();
+        core_timing.Advance();
+        WakeWaitingCores();
+        return;
+    }
+
+    const u64 current_ticks = core_timing.GetTicks();
+    if (target_ticks > current_ticks) {
+        const s64 downcount = std::max(core_timing.GetDowncount(), 0);
+        core_timing.AddTicks(std::min<u64>(target_ticks - current_ticks, downcount));
+        core_timing.Advance();
+        WakeWaitingCores();
+        return;
+    }
+
+    Park();
+}
+
+bool Cpu::BeginSecondarySlice() {
+    if (core_timing.AdvanceCore(core_index)) {
+        return true;
+    }
+
+    // An event is due on the timeline of this core, wait for the main core to process it
+    waiting_for_timeline = true;
+    Park();
+    waiting_for_timeline = false;
+    return false;
+}
+
+void Cpu::WakeWaitingCores() {
+    for (std::size_t index = 1; index < NUM_CPU_CORES; ++index) {
+        Cpu& cpu = system.CpuCore(index);
+        if (cpu.waiting_for_timeline) {
+            cpu.wakeup_event.Set();
+        }
+    }
+}
+
+void Cpu::Park() {
+    wakeup_event.WaitUntil(std::chrono::steady_clock::now() + PARK_TIMEOUT);
 }
 
 void Cpu::Reschedule() {
@@ -10,6 +10,7 @@
 #include <memory>
 #include <mutex>
 #include "common/common_types.h"
+#include "common/thread.h"
 
 namespace Kernel {
 class Scheduler;
@@ -33,7 +34,7 @@ constexpr unsigned NUM_CPU_CORES{4};
 class CpuBarrier {
 public:
     bool IsAlive() const {
-        return !end;
+        return !barrier.IsCancelled();
     }
 
     void NotifyEnd();
@@ -41,10 +42,7 @@ public:
     bool Rendezvous();
 
 private:
-    unsigned cores_waiting{NUM_CPU_CORES};
-    std::mutex mutex;
-    std::condition_variable condition;
-    std::atomic<bool> end{};
+    Common::Barrier barrier{NUM_CPU_CORES};
 };
 
 class Cpu {
@@ -59,6 +57,21 @@ public:
 
     void PrepareReschedule();
 
+    /// Accounts for guest cycles executed on this core.
+    void AddTicks(u64 ticks);
+
+    /// Returns the number of cycles left in the time slice of this core.
+    s64 GetDowncount() const;
+
+    /// Whether this core had no guest thread to run at the start of its last slice.
+    bool IsIdle() const {
+        return is_idle;
+    }
+
+    /// Returns how far along the guest timeline this core has run. Only secondary cores in
+    /// parallel mode keep a timeline of their own, every other core follows CoreTiming.
+    u64 GetLocalTicks() const;
+
     ARM_Interface& ArmInterface() {
         return *arm_interface;
     }
@@ -85,16 +98,41 @@ public:
 
     static std::unique_ptr<ExclusiveMonitor> MakeExclusiveMonitor(std::size_t num_cores);
 
+    /// Whether each core runs freely on its own host thread instead of in lock-step.
+    static bool IsParallelModeEnabled();
+
+    /// Whether all cores run guest code through the JIT of the first core, translating it once.
+    /// This requires every core to run on the same host thread.
+    static bool IsJitCacheShared();
+
 private:
     void Reschedule();
 
+    /// Lets the main core move guest time forward while it has nothing to run in parallel mode.
+    void IdleMainCore();
+
+    /// Starts a new time slice on a secondary core in parallel mode. Returns false if the core
+    /// has reached a pending event and has to wait until the main core processed it.
+    bool BeginSecondarySlice();
+
+    /// Wakes up the secondary cores waiting on the main core to process an event.
+    void WakeWaitingCores();
+
+    /// Parks the host thread until this core is asked to reschedule or a short timeout passes.
+    void Park();
+
     std::unique_ptr<ARM_Interface> arm_interface;
     CpuBarrier& cpu_barrier;
     std::unique_ptr<Kernel::Scheduler> scheduler;
+    System& system;
     Timing::CoreTiming& core_timing;
 
     std::atomic<bool> reschedule_pending = false;
+    std::atomic<bool> is_idle = false;
+    std::atomic<bool> waiting_for_timeline = false;
     std::size_t core_index;
+
+    Common::Event wakeup_event;
 };
 
 } // namespace Core
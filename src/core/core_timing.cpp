@@ -7,33 +7,21 @@
 #include <algorithm>
 #include <mutex>
 #include <string>
-#include <tuple>
 
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "common/thread.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+#include "common/x64/native_clock.h"
 #include "core/core_timing_util.h"
+#include "core/settings.h"
 
 namespace Core::Timing {
 
 constexpr int MAX_SLICE_LENGTH = 20000;
 
-struct CoreTiming::Event {
-    s64 time;
-    u64 fifo_order;
-    u64 userdata;
-    const EventType* type;
-
-    // Sort by time, unless the times are the same, in which case sort by
-    // the order added to the queue
-    friend bool operator>(const Event& left, const Event& right) {
-        return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-    }
-
-    friend bool operator<(const Event& left, const Event& right) {
-        return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
-    }
-};
-
 CoreTiming::CoreTiming() = default;
 CoreTiming::~CoreTiming() = default;
 
@@ -51,13 +39,36 @@ void CoreTiming::Initialize() {
 
     event_fifo_id = 0;
 
+    for (auto& timeline : core_timelines) {
+        timeline.ticks = 0;
+        timeline.downcount = 0;
+    }
+
     const auto empty_timed_callback = [](u64, s64) {};
     ev_lost = RegisterEvent("_lost_event", empty_timed_callback);
+
+    native_clock.reset();
+    if (Settings::values.use_host_clock) {
+#ifdef ARCHITECTURE_x86_64
+        if (Common::GetCPUCaps().invariant_tsc) {
+            const u64 rtsc_frequency = Common::X64::EstimateRDTSCFrequency();
+            LOG_INFO(Core_Timing, "Guest ticks follow the host TSC running at {} Hz",
+                     rtsc_frequency);
+            native_clock = std::make_unique<Common::X64::NativeClock>(BASE_CLOCK_RATE, CNTFREQ,
+                                                                      rtsc_frequency);
+        } else {
+            LOG_WARNING(Core_Timing, "Host TSC is not invariant, guest ticks follow the cycles");
+        }
+#else
+        LOG_WARNING(Core_Timing, "Host clock is unsupported, guest ticks follow the cycles");
+#endif
+    }
 }
 
 void CoreTiming::Shutdown() {
     ClearPendingEvents();
     UnregisterAllEvents();
+    native_clock.reset();
 }
 
 EventType* CoreTiming::RegisterEvent(const std::string& name, TimedCallback callback) {
@@ -76,7 +87,7 @@ EventType* CoreTiming::RegisterEvent(const std::string& name, TimedCallback call
 }
 
 void CoreTiming::UnregisterAllEvents() {
-    ASSERT_MSG(event_queue.empty(), "Cannot unregister events with events pending");
+    ASSERT_MSG(event_queue.Empty(), "Cannot unregister events with events pending");
     event_types.clear();
 }
 
@@ -90,21 +101,19 @@ void CoreTiming::ScheduleEvent(s64 cycles_into_future, const EventType* event_ty
         ForceExceptionCheck(cycles_into_future);
     }
 
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    event_queue.Push({timeout, event_fifo_id++, userdata, event_type});
+}
+
+void CoreTiming::ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type,
+                                         u64 userdata) {
+    ASSERT(event_type != nullptr);
+    ts_queue.Push(TimerWheel::Event{cycles_into_future, 0, userdata, event_type});
 }
 
 void CoreTiming::UnscheduleEvent(const EventType* event_type, u64 userdata) {
     std::lock_guard guard{inner_mutex};
-    const auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-    }
+    MoveEvents();
+    event_queue.Remove(event_type, userdata);
 }
 
 u64 CoreTiming::GetTicks() const {
@@ -119,24 +128,45 @@ u64 CoreTiming::GetIdleTicks() const {
     return static_cast<u64>(idled_cycles);
 }
 
+u64 CoreTiming::GetSystemTicks() const {
+#ifdef ARCHITECTURE_x86_64
+    if (native_clock) {
+        return native_clock->GetCPUCycles();
+    }
+#endif
+    return GetTicks();
+}
+
+u64 CoreTiming::GetClockTicks() const {
+#ifdef ARCHITECTURE_x86_64
+    if (native_clock) {
+        return native_clock->GetClockCycles();
+    }
+#endif
+    return CpuCyclesToClockCycles(GetTicks());
+}
+
 void CoreTiming::AddTicks(u64 ticks) {
     downcount -= static_cast<int>(ticks);
 }
 
 void CoreTiming::ClearPendingEvents() {
-    event_queue.clear();
+    event_queue.Clear();
+    ts_queue.Clear();
+}
+
+void CoreTiming::MoveEvents() {
+    for (TimerWheel::Event event; ts_queue.Pop(event);) {
+        event.time += static_cast<s64>(GetTicks());
+        event.fifo_order = event_fifo_id++;
+        event_queue.Push(event);
+    }
 }
 
 void CoreTiming::RemoveEvent(const EventType* event_type) {
     std::lock_guard guard{inner_mutex};
-    const auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
-                                    [&](const Event& e) { return e.type == event_type; });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-    }
+    MoveEvents();
+    event_queue.RemoveAll(event_type);
 }
 
 void CoreTiming::ForceExceptionCheck(s64 cycles) {
@@ -160,21 +190,23 @@ void CoreTiming::Advance() {
 
     is_global_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= global_timer) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    MoveEvents();
+
+    while (const auto evt = event_queue.PopDue(global_timer)) {
         inner_mutex.unlock();
-        evt.type->callback(evt.userdata, global_timer - evt.time);
+        evt->type->callback(evt->userdata, global_timer - evt->time);
         inner_mutex.lock();
     }
 
     is_global_timer_sane = false;
 
+    // Nothing is pending up to the current time anymore, so let the wheel catch up with it.
+    event_queue.AdvanceTo(global_timer);
+
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
-        slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - global_timer, MAX_SLICE_LENGTH));
+    if (const auto next_time = event_queue.NextTime()) {
+        slice_length =
+            static_cast<int>(std::min<s64>(*next_time - global_timer, MAX_SLICE_LENGTH));
     }
 
     downcount = slice_length;
@@ -193,4 +225,39 @@ int CoreTiming::GetDowncount() const {
     return downcount;
 }
 
+bool CoreTiming::AdvanceCore(std::size_t core_index) {
+    std::lock_guard guard{inner_mutex};
+    MoveEvents();
+
+    CoreTimeline& timeline = core_timelines[core_index];
+    const s64 ticks = std::max<s64>(timeline.ticks, static_cast<s64>(GetTicks()));
+    timeline.ticks = ticks;
+
+    s64 slice = MAX_SLICE_LENGTH;
+    if (const auto next_time = event_queue.NextTime()) {
+        if (*next_time <= ticks) {
+            timeline.downcount = 0;
+            return false;
+        }
+        slice = std::min<s64>(*next_time - ticks, slice);
+    }
+
+    timeline.downcount = slice;
+    return true;
+}
+
+void CoreTiming::AddCoreTicks(std::size_t core_index, u64 ticks) {
+    CoreTimeline& timeline = core_timelines[core_index];
+    timeline.downcount -= static_cast<s64>(ticks);
+    timeline.ticks += static_cast<s64>(ticks);
+}
+
+s64 CoreTiming::GetCoreDowncount(std::size_t core_index) const {
+    return core_timelines[core_index].downcount;
+}
+
+u64 CoreTiming::GetCoreTicks(std::size_t core_index) const {
+    return static_cast<u64>(core_timelines[core_index].ticks.load());
+}
+
 } // namespace Core::Timing
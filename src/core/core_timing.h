@@ -4,14 +4,23 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
 #include "common/threadsafe_queue.h"
+#include "core/core_cpu.h"
+#include "core/core_timing_wheel.h"
+
+namespace Common::X64 {
+class NativeClock;
+}
 
 namespace Core::Timing {
 
@@ -77,6 +86,12 @@ public:
     /// Scheduling from a callback will not update the downcount until the Advance() completes.
     void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata = 0);
 
+    /// Schedules an event from a thread that isn't emulating a CPU core (e.g. the GPU thread or
+    /// an audio sink). The event is posted to a queue without taking the timing lock and is only
+    /// moved into the event queue by the next Advance(), so the delay is measured from there.
+    void ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type,
+                                 u64 userdata = 0);
+
     void UnscheduleEvent(const EventType* event_type, u64 userdata);
 
     /// We only permit one event of each type in the queue at a time.
@@ -90,6 +105,13 @@ public:
 
     u64 GetIdleTicks() const;
 
+    /// Returns the tick count reported to the guest, at the CPU clock rate. It follows the host
+    /// clock when use_host_clock is enabled and the emulated cycle count otherwise.
+    u64 GetSystemTicks() const;
+
+    /// Returns the value the guest reads from CNTPCT_EL0, see GetSystemTicks.
+    u64 GetClockTicks() const;
+
     void AddTicks(u64 ticks);
 
     /// Advance must be called at the beginning of dispatcher loops, not the end. Advance() ends
@@ -106,12 +128,32 @@ public:
 
     int GetDowncount() const;
 
-private:
-    struct Event;
+    /// Starts a new time slice for a core that runs on a timeline of its own (the secondary
+    /// cores in parallel CPU mode). The core catches up with the global timeline if it fell
+    /// behind and its slice ends no later than the next pending event, which is where the
+    /// timelines are merged again.
+    ///
+    /// @returns false if an event is already due on the timeline of the core. The core must
+    ///          then wait for the main core to process it before running again.
+    bool AdvanceCore(std::size_t core_index);
+
+    /// Accounts for cycles executed by a core on its own timeline.
+    void AddCoreTicks(std::size_t core_index, u64 ticks);
 
+    /// Returns the number of cycles left in the current slice of a core on its own timeline.
+    s64 GetCoreDowncount(std::size_t core_index) const;
+
+    /// Returns how far along its own timeline a core has run.
+    u64 GetCoreTicks(std::size_t core_index) const;
+
+private:
     /// Clear all pending events. This should ONLY be done on exit.
     void ClearPendingEvents();
 
+    /// Moves events scheduled with ScheduleEventThreadsafe() into the event queue.
+    /// Must be called with inner_mutex held.
+    void MoveEvents();
+
     s64 global_timer = 0;
     s64 idled_cycles = 0;
     int slice_length = 0;
@@ -122,19 +164,32 @@ private:
     // don't change slice_length and downcount.
     bool is_global_timer_sane = false;
 
-    // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-    // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-    // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-    // accomodated by the standard adaptor class.
-    std::vector<Event> event_queue;
+    // Pending events, ordered by time and then by the order they were added. A timer wheel is
+    // used instead of a heap so that frequent short timers and cancellations (UnscheduleEvent()
+    // and RemoveEvent()) don't require rebuilding the whole queue.
+    TimerWheel event_queue;
     u64 event_fifo_id = 0;
 
+    // Events posted by ScheduleEventThreadsafe(). The time field holds the number of cycles into
+    // the future until the event is moved into event_queue.
+    Common::MPSCQueue<TimerWheel::Event> ts_queue;
+
     // Stores each element separately as a linked list node so pointers to elements
     // remain stable regardless of rehashes/resizing.
     std::unordered_map<std::string, EventType> event_types;
 
     EventType* ev_lost = nullptr;
 
+    /// Host time stamp counter the guest ticks are read from, null when they follow the cycles
+    std::unique_ptr<Common::X64::NativeClock> native_clock;
+
+    struct CoreTimeline {
+        // Read by the main core to follow the secondary cores while it idles.
+        std::atomic<s64> ticks{};
+        s64 downcount = 0;
+    };
+    std::array<CoreTimeline, Core::NUM_CPU_CORES> core_timelines;
+
     std::mutex inner_mutex;
 };
 
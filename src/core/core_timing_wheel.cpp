@@ -0,0 +1,294 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <tuple>
+
+#include "common/assert.h"
+#include "common/bit_util.h"
+#include "core/core_timing_wheel.h"
+
+namespace Core::Timing {
+
+TimerWheel::TimerWheel() = default;
+TimerWheel::~TimerWheel() = default;
+
+void TimerWheel::Push(const Event& event) {
+    const u32 index = AllocateNode(event);
+    Link(index);
+    LinkType(index);
+    ++size;
+
+    if (next_time_valid && (!cached_next_time || event.time < *cached_next_time)) {
+        cached_next_time = event.time;
+    }
+}
+
+void TimerWheel::Remove(const EventType* type, u64 userdata) {
+    const auto it = type_heads.find(type);
+    if (it == type_heads.end()) {
+        return;
+    }
+
+    u32 index = it->second;
+    while (index != INVALID_INDEX) {
+        const u32 next = nodes[index].type_next;
+        if (nodes[index].event.userdata == userdata) {
+            Erase(index);
+        }
+        index = next;
+    }
+}
+
+void TimerWheel::RemoveAll(const EventType* type) {
+    const auto it = type_heads.find(type);
+    if (it == type_heads.end()) {
+        return;
+    }
+
+    u32 index = it->second;
+    while (index != INVALID_INDEX) {
+        const u32 next = nodes[index].type_next;
+        Erase(index);
+        index = next;
+    }
+}
+
+void TimerWheel::Clear() {
+    nodes.clear();
+    free_head = INVALID_INDEX;
+    size = 0;
+    buckets.fill({});
+    occupied.fill(0);
+    late_events.clear();
+    type_heads.clear();
+    current_time = 0;
+    cached_next_time.reset();
+    next_time_valid = true;
+}
+
+std::optional<s64> TimerWheel::NextTime() const {
+    if (!next_time_valid) {
+        cached_next_time = ComputeNextTime();
+        next_time_valid = true;
+    }
+    return cached_next_time;
+}
+
+std::optional<TimerWheel::Event> TimerWheel::PopDue(s64 limit) {
+    const auto next_time = NextTime();
+    if (!next_time || *next_time > limit) {
+        return std::nullopt;
+    }
+
+    u32 index;
+    if (!late_events.empty()) {
+        index = late_events.front();
+    } else {
+        // Bring the due event down into the first level, where buckets hold a single deadline
+        // and each list is in insertion order.
+        AdvanceTo(*next_time);
+        index = buckets[static_cast<u32>(*next_time) & SLOT_MASK].head;
+    }
+
+    ASSERT(index != INVALID_INDEX && nodes[index].event.time == *next_time);
+    const Event event = nodes[index].event;
+    Erase(index);
+    return event;
+}
+
+void TimerWheel::AdvanceTo(s64 time) {
+    const u64 new_time = static_cast<u64>(std::max<s64>(time, 0));
+    if (new_time <= current_time) {
+        return;
+    }
+
+    const u64 diff = current_time ^ new_time;
+    current_time = new_time;
+
+    // Every level up to the highest one that changed now points at a new bucket. Its contents
+    // share more leading bits with the current time and move down, highest level first so that
+    // nodes can cascade more than one level in a single step.
+    const u32 highest_level = Common::MostSignificantBit64(diff) / LEVEL_BITS;
+    if (highest_level >= NUM_LEVELS) {
+        Cascade(OVERFLOW_BUCKET);
+    }
+    for (u32 level = std::min(highest_level, NUM_LEVELS - 1); level > 0; --level) {
+        const u32 slot = static_cast<u32>(new_time >> (level * LEVEL_BITS)) & SLOT_MASK;
+        Cascade(level * SLOTS_PER_LEVEL + slot);
+    }
+}
+
+u32 TimerWheel::AllocateNode(const Event& event) {
+    u32 index;
+    if (free_head != INVALID_INDEX) {
+        index = free_head;
+        free_head = nodes[index].next;
+    } else {
+        index = static_cast<u32>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    nodes[index] = {event, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX,
+                    INVALID_INDEX};
+    return index;
+}
+
+void TimerWheel::FreeNode(u32 index) {
+    nodes[index].next = free_head;
+    free_head = index;
+}
+
+void TimerWheel::Link(u32 index) {
+    Node& node = nodes[index];
+
+    if (node.event.time < 0 || static_cast<u64>(node.event.time) < current_time) {
+        node.bucket = LATE_BUCKET;
+        late_events.push_back(index);
+        std::push_heap(late_events.begin(), late_events.end(),
+                       [this](u32 lhs, u32 rhs) { return LateLess(rhs, lhs); });
+        return;
+    }
+
+    const u64 time = static_cast<u64>(node.event.time);
+    const u64 diff = time ^ current_time;
+    const u32 level = diff == 0 ? 0 : Common::MostSignificantBit64(diff) / LEVEL_BITS;
+    if (level >= NUM_LEVELS) {
+        node.bucket = OVERFLOW_BUCKET;
+    } else {
+        const u32 slot = static_cast<u32>(time >> (level * LEVEL_BITS)) & SLOT_MASK;
+        node.bucket = level * SLOTS_PER_LEVEL + slot;
+        occupied[level] |= u64{1} << slot;
+    }
+
+    List& list = buckets[node.bucket];
+    node.prev = list.tail;
+    node.next = INVALID_INDEX;
+    if (list.tail != INVALID_INDEX) {
+        nodes[list.tail].next = index;
+    } else {
+        list.head = index;
+    }
+    list.tail = index;
+}
+
+void TimerWheel::Unlink(u32 index) {
+    Node& node = nodes[index];
+
+    if (node.bucket == LATE_BUCKET) {
+        const auto it = std::find(late_events.begin(), late_events.end(), index);
+        ASSERT(it != late_events.end());
+        late_events.erase(it);
+        std::make_heap(late_events.begin(), late_events.end(),
+                       [this](u32 lhs, u32 rhs) { return LateLess(rhs, lhs); });
+        return;
+    }
+
+    List& list = buckets[node.bucket];
+    if (node.prev != INVALID_INDEX) {
+        nodes[node.prev].next = node.next;
+    } else {
+        list.head = node.next;
+    }
+    if (node.next != INVALID_INDEX) {
+        nodes[node.next].prev = node.prev;
+    } else {
+        list.tail = node.prev;
+    }
+
+    if (list.head == INVALID_INDEX && node.bucket != OVERFLOW_BUCKET) {
+        occupied[node.bucket / SLOTS_PER_LEVEL] &= ~(u64{1} << (node.bucket & SLOT_MASK));
+    }
+}
+
+void TimerWheel::LinkType(u32 index) {
+    Node& node = nodes[index];
+    u32& head = type_heads.try_emplace(node.event.type, INVALID_INDEX).first->second;
+
+    node.type_prev = INVALID_INDEX;
+    node.type_next = head;
+    if (head != INVALID_INDEX) {
+        nodes[head].type_prev = index;
+    }
+    head = index;
+}
+
+void TimerWheel::UnlinkType(u32 index) {
+    Node& node = nodes[index];
+
+    if (node.type_prev != INVALID_INDEX) {
+        nodes[node.type_prev].type_next = node.type_next;
+    } else {
+        type_heads[node.event.type] = node.type_next;
+    }
+    if (node.type_next != INVALID_INDEX) {
+        nodes[node.type_next].type_prev = node.type_prev;
+    }
+}
+
+void TimerWheel::Erase(u32 index) {
+    if (next_time_valid && cached_next_time == nodes[index].event.time) {
+        next_time_valid = false;
+    }
+
+    Unlink(index);
+    UnlinkType(index);
+    FreeNode(index);
+    --size;
+}
+
+void TimerWheel::Cascade(u32 bucket) {
+    u32 index = buckets[bucket].head;
+    buckets[bucket] = {};
+    if (bucket != OVERFLOW_BUCKET) {
+        occupied[bucket / SLOTS_PER_LEVEL] &= ~(u64{1} << (bucket & SLOT_MASK));
+    }
+
+    // Re-filing in list order keeps events sharing a deadline in insertion order.
+    while (index != INVALID_INDEX) {
+        const u32 next = nodes[index].next;
+        Link(index);
+        index = next;
+    }
+}
+
+bool TimerWheel::LateLess(u32 lhs, u32 rhs) const {
+    const Event& left = nodes[lhs].event;
+    const Event& right = nodes[rhs].event;
+    return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
+}
+
+std::optional<s64> TimerWheel::ComputeNextTime() const {
+    if (!late_events.empty()) {
+        return nodes[late_events.front()].event.time;
+    }
+
+    // Each bucket only holds deadlines later than those of the buckets below it, so the first
+    // occupied bucket of the lowest occupied level contains the earliest event.
+    const auto min_time_in = [this](u32 bucket) {
+        std::optional<s64> result;
+        for (u32 index = buckets[bucket].head; index != INVALID_INDEX; index = nodes[index].next) {
+            const s64 time = nodes[index].event.time;
+            if (!result || time < *result) {
+                result = time;
+            }
+        }
+        return result;
+    };
+
+    for (u32 level = 0; level < NUM_LEVELS; ++level) {
+        if (occupied[level] == 0) {
+            continue;
+        }
+        const u32 slot = Common::CountTrailingZeroes64(occupied[level]);
+        if (level == 0) {
+            return static_cast<s64>((current_time & ~u64{SLOT_MASK}) | slot);
+        }
+        return min_time_in(level * SLOTS_PER_LEVEL + slot);
+    }
+
+    return min_time_in(OVERFLOW_BUCKET);
+}
+
+} // namespace Core::Timing
@@ -0,0 +1,128 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core::Timing {
+
+struct EventType;
+
+/**
+ * Hierarchical timer wheel holding the pending events of CoreTiming.
+ *
+ * Each event is filed into a bucket chosen by the highest group of bits in which its deadline
+ * differs from the current time of the wheel. Scheduling and cancelling an event are O(1), and
+ * advancing the wheel only redistributes the buckets the current time moves into. Events that
+ * share a deadline are always handed out in the order they were pushed, like the min-heap this
+ * replaces.
+ */
+class TimerWheel {
+public:
+    struct Event {
+        s64 time;
+        u64 fifo_order;
+        u64 userdata;
+        const EventType* type;
+    };
+
+    TimerWheel();
+    ~TimerWheel();
+
+    bool Empty() const {
+        return size == 0;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    /// Inserts a new pending event.
+    void Push(const Event& event);
+
+    /// Removes all pending events of the given type which carry the given userdata.
+    void Remove(const EventType* type, u64 userdata);
+
+    /// Removes all pending events of the given type.
+    void RemoveAll(const EventType* type);
+
+    /// Drops every pending event and rewinds the wheel to time zero.
+    void Clear();
+
+    /// Returns the deadline of the earliest pending event, if there is one.
+    std::optional<s64> NextTime() const;
+
+    /// Removes and returns the earliest pending event if its deadline is not after the limit.
+    std::optional<Event> PopDue(s64 limit);
+
+    /// Moves the current time of the wheel forward. No event may be pending before the new time.
+    void AdvanceTo(s64 time);
+
+private:
+    static constexpr u32 LEVEL_BITS = 6;
+    static constexpr u32 SLOTS_PER_LEVEL = 1U << LEVEL_BITS;
+    static constexpr u32 SLOT_MASK = SLOTS_PER_LEVEL - 1;
+    static constexpr u32 NUM_LEVELS = 6;
+    static constexpr u32 OVERFLOW_BUCKET = NUM_LEVELS * SLOTS_PER_LEVEL;
+    static constexpr u32 LATE_BUCKET = OVERFLOW_BUCKET + 1;
+    static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+    struct Node {
+        Event event;
+        u32 bucket;
+        u32 prev;
+        u32 next;
+        u32 type_prev;
+        u32 type_next;
+    };
+
+    struct List {
+        u32 head = INVALID_INDEX;
+        u32 tail = INVALID_INDEX;
+    };
+
+    u32 AllocateNode(const Event& event);
+    void FreeNode(u32 index);
+
+    /// Files a node into the bucket matching its deadline relative to the current time.
+    void Link(u32 index);
+    void Unlink(u32 index);
+
+    void LinkType(u32 index);
+    void UnlinkType(u32 index);
+
+    /// Detaches a node from every structure it is part of and releases it.
+    void Erase(u32 index);
+
+    /// Re-files every node of a bucket after the current time moved into it.
+    void Cascade(u32 bucket);
+
+    bool LateLess(u32 lhs, u32 rhs) const;
+    std::optional<s64> ComputeNextTime() const;
+
+    std::vector<Node> nodes;
+    u32 free_head = INVALID_INDEX;
+    std::size_t size = 0;
+
+    std::array<List, OVERFLOW_BUCKET + 1> buckets{};
+    std::array<u64, NUM_LEVELS> occupied{};
+
+    /// Events whose deadline already lies before the current time, kept as a min-heap.
+    std::vector<u32> late_events;
+
+    /// Head of the chain of pending nodes for each event type, used for cancellation.
+    std::unordered_map<const EventType*, u32> type_heads;
+
+    u64 current_time = 0;
+
+    mutable std::optional<s64> cached_next_time;
+    mutable bool next_time_valid = true;
+};
+
+} // namespace Core::Timing
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
@@ -12,7 +14,20 @@
 
 namespace Core {
 namespace {
+/// Applies the host affinity and priority chosen for the threads running emulated cores.
+void ConfigureCpuThread() {
+    if (!Common::SetCurrentThreadAffinity(Settings::values.cpu_thread_affinity)) {
+        LOG_WARNING(Core, "Failed to pin a CPU thread to the host cores {:016X}",
+                    Settings::values.cpu_thread_affinity);
+    }
+    if (Settings::values.use_high_thread_priority &&
+        !Common::SetCurrentThreadPriority(Common::ThreadPriority::High)) {
+        LOG_WARNING(Core, "Failed to raise the priority of a CPU thread");
+    }
+}
+
 void RunCpuCore(const System& system, Cpu& cpu_state) {
+    ConfigureCpuThread();
     while (system.IsPoweredOn()) {
         cpu_state.RunLoop(true);
     }
@@ -35,6 +50,7 @@ void CpuCoreManager::StartThreads() {
     // Create threads for CPU cores 1-3, and build thread_to_cpu map
     // CPU core 0 is run on the main thread
     thread_to_cpu[std::this_thread::get_id()] = cores[0].get();
+    LOG_INFO(Core, "Host performance cores: {:016X}", Common::GetPerformanceCoreMask());
     if (!Settings::values.use_multi_core) {
         return;
     }
@@ -56,6 +72,7 @@ void CpuCoreManager::Shutdown() {
     }
 
     thread_to_cpu.clear();
+    main_core_thread = {};
     for (auto& cpu_core : cores) {
         cpu_core.reset();
     }
@@ -106,7 +123,12 @@ const Cpu& CpuCoreManager::GetCurrentCore() const {
 
 void CpuCoreManager::RunLoop(bool tight_loop) {
     // Update thread_to_cpu in case Core 0 is run from a different host thread
-    thread_to_cpu[std::this_thread::get_id()] = cores[0].get();
+    const auto thread_id = std::this_thread::get_id();
+    if (thread_id != main_core_thread) {
+        main_core_thread = thread_id;
+        thread_to_cpu[thread_id] = cores[0].get();
+        ConfigureCpuThread();
+    }
 
     if (GDBStub::IsServerEnabled()) {
         GDBStub::HandlePacket();
@@ -136,9 +158,27 @@ void CpuCoreManager::RunLoop(bool tight_loop) {
 }
 
 void CpuCoreManager::InvalidateAllInstructionCaches() {
+    instruction_cache_invalidations.fetch_add(1, std::memory_order_relaxed);
+    if (Cpu::IsJitCacheShared()) {
+        // Every core runs the code translated by the first one
+        cores[0]->ArmInterface().ClearInstructionCache();
+        return;
+    }
+
     for (auto& cpu : cores) {
         cpu->ArmInterface().ClearInstructionCache();
     }
 }
 
+void CpuCoreManager::InvalidateInstructionCacheRange(VAddr addr, std::size_t size) {
+    if (Cpu::IsJitCacheShared()) {
+        cores[0]->ArmInterface().InvalidateCacheRange(addr, size);
+        return;
+    }
+
+    for (auto& cpu : cores) {
+        cpu->ArmInterface().InvalidateCacheRange(addr, size);
+    }
+}
+
 } // namespace Core
@@ -5,9 +5,11 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <thread>
+#include "common/common_types.h"
 
 namespace Core {
 
@@ -44,6 +46,14 @@ public:
 
     void InvalidateAllInstructionCaches();
 
+    /// Invalidates the code translated from [addr, addr + size) on every core.
+    void InvalidateInstructionCacheRange(VAddr addr, std::size_t size);
+
+    /// Returns how many times the JIT caches of all cores were thrown away this session.
+    u64 GetInstructionCacheInvalidationCount() const {
+        return instruction_cache_invalidations.load(std::memory_order_relaxed);
+    }
+
 private:
     static constexpr std::size_t NUM_CPU_CORES = 4;
 
@@ -52,6 +62,8 @@ private:
     std::array<std::unique_ptr<Cpu>, NUM_CPU_CORES> cores;
     std::array<std::unique_ptr<std::thread>, NUM_CPU_CORES - 1> core_threads;
     std::size_t active_core{}; ///< Active core, only used in single thread mode
+    std::thread::id main_core_thread; ///< Host thread core 0 was last run on
+    std::atomic<u64> instruction_cache_invalidations{};
 
     /// Map of guest threads to CPU cores
     std::map<std::thread::id, Cpu*> thread_to_cpu;
@@ -0,0 +1,250 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include "common/assert.h"
+#include "core/crypto/aes_ni.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#include "common/swap.h"
+#include "common/x64/cpu_detect.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AESNI_TARGET __attribute__((target("aes")))
+#else
+#define AESNI_TARGET
+#endif
+#endif
+
+namespace Core::Crypto::AESNI {
+
+#ifdef ARCHITECTURE_x86_64
+
+namespace {
+
+constexpr std::size_t NumRounds = 10;
+constexpr std::size_t BlockSize = 16;
+/// Blocks transcoded together, the AES instructions are pipelined and independent blocks overlap
+constexpr std::size_t Interleave = 8;
+
+struct Schedule {
+    __m128i rounds[NumRounds + 1];
+};
+
+AESNI_TARGET Schedule LoadKeys(const RoundKeys& keys) {
+    Schedule schedule;
+    for (std::size_t i = 0; i <= NumRounds; ++i) {
+        schedule.rounds[i] =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(keys.keys.data() + i * BlockSize));
+    }
+    return schedule;
+}
+
+template <std::size_t N>
+AESNI_TARGET void EncryptBlocks(const Schedule& keys, __m128i* blocks) {
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], keys.rounds[0]);
+    }
+    for (std::size_t round = 1; round < NumRounds; ++round) {
+        for (std::size_t i = 0; i < N; ++i) {
+            blocks[i] = _mm_aesenc_si128(blocks[i], keys.rounds[round]);
+        }
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_aesenclast_si128(blocks[i], keys.rounds[NumRounds]);
+    }
+}
+
+template <std::size_t N>
+AESNI_TARGET void DecryptBlocks(const Schedule& keys, __m128i* blocks) {
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], keys.rounds[0]);
+    }
+    for (std::size_t round = 1; round < NumRounds; ++round) {
+        for (std::size_t i = 0; i < N; ++i) {
+            blocks[i] = _mm_aesdec_si128(blocks[i], keys.rounds[round]);
+        }
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_aesdeclast_si128(blocks[i], keys.rounds[NumRounds]);
+    }
+}
+
+AESNI_TARGET __m128i ExpandStep(__m128i key, __m128i assist) {
+    assist = _mm_shuffle_epi32(assist, _MM_SHUFFLE(3, 3, 3, 3));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+/// Derives the next round key, the round constant has to be an immediate
+template <int round_constant>
+AESNI_TARGET __m128i ExpandRound(__m128i key) {
+    return ExpandStep(key, _mm_aeskeygenassist_si128(key, round_constant));
+}
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128)
+AESNI_TARGET __m128i MultiplyTweak(__m128i tweak) {
+    // Each dword takes the top bit of the one below it, the top bit of the tweak is reduced
+    __m128i carry = _mm_and_si128(_mm_srai_epi32(tweak, 31), _mm_set_epi32(0x87, 1, 1, 1));
+    carry = _mm_shuffle_epi32(carry, _MM_SHUFFLE(2, 1, 0, 3));
+    return _mm_xor_si128(_mm_slli_epi32(tweak, 1), carry);
+}
+
+template <std::size_t N>
+AESNI_TARGET void XTSBlocks(const Schedule& keys, const u8* src, u8* dest, __m128i& tweak,
+                            bool encrypt) {
+    __m128i tweaks[N];
+    __m128i blocks[N];
+    for (std::size_t i = 0; i < N; ++i) {
+        tweaks[i] = tweak;
+        tweak = MultiplyTweak(tweak);
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * BlockSize));
+        blocks[i] = _mm_xor_si128(block, tweaks[i]);
+    }
+    if (encrypt) {
+        EncryptBlocks<N>(keys, blocks);
+    } else {
+        DecryptBlocks<N>(keys, blocks);
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * BlockSize),
+                         _mm_xor_si128(blocks[i], tweaks[i]));
+    }
+}
+
+} // Anonymous namespace
+
+bool IsSupported() {
+    static const bool is_supported = Common::GetCPUCaps().aes;
+    return is_supported;
+}
+
+AESNI_TARGET void ExpandKey(const u8* key, RoundKeys& encryption_keys,
+                            RoundKeys& decryption_keys) {
+    Schedule schedule;
+    schedule.rounds[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    schedule.rounds[1] = ExpandRound<0x01>(schedule.rounds[0]);
+    schedule.rounds[2] = ExpandRound<0x02>(schedule.rounds[1]);
+    schedule.rounds[3] = ExpandRound<0x04>(schedule.rounds[2]);
+    schedule.rounds[4] = ExpandRound<0x08>(schedule.rounds[3]);
+    schedule.rounds[5] = ExpandRound<0x10>(schedule.rounds[4]);
+    schedule.rounds[6] = ExpandRound<0x20>(schedule.rounds[5]);
+    schedule.rounds[7] = ExpandRound<0x40>(schedule.rounds[6]);
+    schedule.rounds[8] = ExpandRound<0x80>(schedule.rounds[7]);
+    schedule.rounds[9] = ExpandRound<0x1B>(schedule.rounds[8]);
+    schedule.rounds[10] = ExpandRound<0x36>(schedule.rounds[9]);
+
+    for (std::size_t i = 0; i <= NumRounds; ++i) {
+        // The equivalent inverse cipher runs the rounds backwards with mixed columns inverted
+        __m128i decryption_key = schedule.rounds[NumRounds - i];
+        if (i != 0 && i != NumRounds) {
+            decryption_key = _mm_aesimc_si128(decryption_key);
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(encryption_keys.keys.data() + i * BlockSize),
+                        schedule.rounds[i]);
+        _mm_store_si128(reinterpret_cast<__m128i*>(decryption_keys.keys.data() + i * BlockSize),
+                        decryption_key);
+    }
+}
+
+AESNI_TARGET void CTRTranscode(const RoundKeys& round_keys, const u8* src, std::size_t size,
+                               u8* dest, const std::array<u8, 16>& counter) {
+    const Schedule keys = LoadKeys(round_keys);
+    u64 high;
+    u64 low;
+    std::memcpy(&high, counter.data(), sizeof(high));
+    std::memcpy(&low, counter.data() + sizeof(high), sizeof(low));
+    high = Common::swap64(high);
+    low = Common::swap64(low);
+    const auto next_counter = [&high, &low] {
+        const __m128i block = _mm_set_epi64x(static_cast<s64>(Common::swap64(low)),
+                                             static_cast<s64>(Common::swap64(high)));
+        if (++low == 0) {
+            ++high;
+        }
+        return block;
+    };
+
+    std::size_t offset = 0;
+    for (; size - offset >= Interleave * BlockSize; offset += Interleave * BlockSize) {
+        __m128i blocks[Interleave];
+        for (auto& block : blocks) {
+            block = next_counter();
+        }
+        EncryptBlocks<Interleave>(keys, blocks);
+        for (std::size_t i = 0; i < Interleave; ++i) {
+            const std::size_t block_offset = offset + i * BlockSize;
+            const auto data =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + block_offset));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + block_offset),
+                             _mm_xor_si128(data, blocks[i]));
+        }
+    }
+    for (; size - offset >= BlockSize; offset += BlockSize) {
+        __m128i block = next_counter();
+        EncryptBlocks<1>(keys, &block);
+        const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset), _mm_xor_si128(data, block));
+    }
+    if (offset != size) {
+        __m128i block = next_counter();
+        EncryptBlocks<1>(keys, &block);
+        std::array<u8, BlockSize> stream;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(stream.data()), block);
+        for (std::size_t i = 0; offset + i < size; ++i) {
+            dest[offset + i] = src[offset + i] ^ stream[i];
+        }
+    }
+}
+
+AESNI_TARGET void XTSTranscode(const RoundKeys& data_keys, const RoundKeys& tweak_keys,
+                               const u8* src, std::size_t size, u8* dest, std::size_t sector_id,
+                               std::size_t sector_size, bool encrypt) {
+    ASSERT(sector_size % BlockSize == 0 && size % sector_size == 0);
+    const Schedule keys = LoadKeys(data_keys);
+    const Schedule tweak_schedule = LoadKeys(tweak_keys);
+
+    for (std::size_t sector = 0; sector < size; sector += sector_size) {
+        __m128i tweak = _mm_set_epi64x(static_cast<s64>(Common::swap64(u64{sector_id++})), 0);
+        EncryptBlocks<1>(tweak_schedule, &tweak);
+
+        std::size_t offset = sector;
+        const std::size_t sector_end = sector + sector_size;
+        for (; sector_end - offset >= Interleave * BlockSize; offset += Interleave * BlockSize) {
+            XTSBlocks<Interleave>(keys, src + offset, dest + offset, tweak, encrypt);
+        }
+        for (; offset < sector_end; offset += BlockSize) {
+            XTSBlocks<1>(keys, src + offset, dest + offset, tweak, encrypt);
+        }
+    }
+}
+
+#else
+
+bool IsSupported() {
+    return false;
+}
+
+void ExpandKey(const u8* key, RoundKeys& encryption_keys, RoundKeys& decryption_keys) {
+    UNREACHABLE();
+}
+
+void CTRTranscode(const RoundKeys& keys, const u8* src, std::size_t size, u8* dest,
+                  const std::array<u8, 16>& counter) {
+    UNREACHABLE();
+}
+
+void XTSTranscode(const RoundKeys& data_keys, const RoundKeys& tweak_keys, const u8* src,
+                  std::size_t size, u8* dest, std::size_t sector_id, std::size_t sector_size,
+                  bool encrypt) {
+    UNREACHABLE();
+}
+
+#endif
+
+} // namespace Core::Crypto::AESNI
@@ -0,0 +1,41 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Core::Crypto::AESNI {
+
+/// Expanded AES-128 key, one 16 byte round key per round.
+struct alignas(16) RoundKeys {
+    std::array<u8, 11 * 16> keys;
+};
+
+/// Returns true when the host CPU has the AES instructions the functions below use.
+bool IsSupported();
+
+/// Expands an AES-128 key for encryption and for decryption.
+void ExpandKey(const u8* key, RoundKeys& encryption_keys, RoundKeys& decryption_keys);
+
+/**
+ * Transcodes in CTR mode, the counter is the big endian 128-bit value of the first block. A
+ * trailing partial block consumes a whole counter value.
+ */
+void CTRTranscode(const RoundKeys& keys, const u8* src, std::size_t size, u8* dest,
+                  const std::array<u8, 16>& counter);
+
+/**
+ * Transcodes consecutive XTS sectors. The tweak of a sector is its number as a big endian 128-bit
+ * value encrypted with the tweak key, as Nintendo uses it.
+ * @param data_keys Encryption or decryption keys of the data key, depending on encrypt
+ * @param tweak_keys Encryption keys of the tweak key
+ */
+void XTSTranscode(const RoundKeys& data_keys, const RoundKeys& tweak_keys, const u8* src,
+                  std::size_t size, u8* dest, std::size_t sector_id, std::size_t sector_size,
+                  bool encrypt);
+
+} // namespace Core::Crypto::AESNI
@@ -2,14 +2,21 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <mbedtls/cipher.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
+#include "core/crypto/aes_ni.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
 
 namespace Core::Crypto {
 namespace {
+/// Transcodes at least this large are split across threads
+constexpr std::size_t ParallelThreshold = 0x200000;
+constexpr u32 MaxParallelWorkers = 4;
+
 std::vector<u8> CalculateNintendoTweak(std::size_t sector_id) {
     std::vector<u8> out(0x10);
     for (std::size_t i = 0xF; i <= 0xF; --i) {
@@ -18,6 +25,42 @@ std::vector<u8> CalculateNintendoTweak(std::size_t sector_id) {
     }
     return out;
 }
+
+/// Adds to a big endian 128-bit counter
+std::array<u8, 16> AddToCounter(std::array<u8, 16> counter, u64 value) {
+    for (std::size_t i = counter.size(); i-- > 0 && value != 0;) {
+        const u64 sum = counter[i] + (value & 0xFF);
+        counter[i] = static_cast<u8>(sum);
+        value = (value >> 8) + (sum >> 8);
+    }
+    return counter;
+}
+
+/**
+ * Calls func(offset, size) over chunks of size bytes that are multiples of granularity. Large
+ * ranges are split across the thread pool, the calling thread takes the first chunk.
+ */
+template <typename Func>
+void ParallelTranscode(std::size_t size, std::size_t granularity, Func&& func) {
+    auto& pool = Common::GetThreadPool();
+    const std::size_t num_workers =
+        std::min<std::size_t>(pool.GetNumWorkers() + 1, MaxParallelWorkers);
+    if (size < ParallelThreshold || num_workers == 1) {
+        func(std::size_t{0}, size);
+        return;
+    }
+    const std::size_t num_units = (size + granularity - 1) / granularity;
+    const std::size_t chunk_size = (num_units + num_workers - 1) / num_workers * granularity;
+
+    // Decryption sits on the loading path of the game, don't queue it behind background work
+    Common::TaskGroup group{pool};
+    for (std::size_t offset = chunk_size; offset < size; offset += chunk_size) {
+        const std::size_t length = std::min(chunk_size, size - offset);
+        group.Submit([&func, offset, length] { func(offset, length); }, Common::TaskPriority::High);
+    }
+    func(std::size_t{0}, std::min(chunk_size, size));
+    group.Wait();
+}
 } // Anonymous namespace
 
 static_assert(static_cast<std::size_t>(Mode::CTR) ==
@@ -34,6 +77,14 @@ static_assert(static_cast<std::size_t>(Mode::XTS) ==
 struct CipherContext {
     mbedtls_cipher_context_t encryption_context;
     mbedtls_cipher_context_t decryption_context;
+
+    // CTR and XTS use the AES instructions of the host when it has them
+    Mode mode;
+    bool use_aesni = false;
+    AESNI::RoundKeys encryption_keys;
+    AESNI::RoundKeys decryption_keys;
+    AESNI::RoundKeys tweak_keys;
+    std::array<u8, 16> counter{};
 };
 
 template <typename Key, std::size_t KeySize>
@@ -55,6 +106,19 @@ Crypto::AESCipher<Key, KeySize>::AESCipher(Key key, Mode mode)
     ASSERT(
         !mbedtls_cipher_setkey(&ctx->decryption_context, key.data(), KeySize * 8, MBEDTLS_DECRYPT));
     //"Failed to set key on mbedtls ciphers.");
+
+    ctx->mode = mode;
+    const bool is_ctr = mode == Mode::CTR && KeySize == 0x10;
+    const bool is_xts = mode == Mode::XTS && KeySize == 0x20;
+    if ((is_ctr || is_xts) && AESNI::IsSupported()) {
+        ctx->use_aesni = true;
+        AESNI::ExpandKey(key.data(), ctx->encryption_keys, ctx->decryption_keys);
+        if (is_xts) {
+            // The second half of XTS keys encrypts the tweaks, only its encryption keys are used
+            AESNI::RoundKeys unused_keys;
+            AESNI::ExpandKey(key.data() + 0x10, ctx->tweak_keys, unused_keys);
+        }
+    }
 }
 
 template <typename Key, std::size_t KeySize>
@@ -68,10 +132,22 @@ void AESCipher<Key, KeySize>::SetIV(std::vector<u8> iv) {
     ASSERT_MSG((mbedtls_cipher_set_iv(&ctx->encryption_context, iv.data(), iv.size()) ||
                 mbedtls_cipher_set_iv(&ctx->decryption_context, iv.data(), iv.size())) == 0,
                "Failed to set IV on mbedtls ciphers.");
+    std::copy_n(iv.begin(), std::min(iv.size(), ctx->counter.size()), ctx->counter.begin());
 }
 
 template <typename Key, std::size_t KeySize>
 void AESCipher<Key, KeySize>::Transcode(const u8* src, std::size_t size, u8* dest, Op op) const {
+    if (ctx->use_aesni && ctx->mode == Mode::CTR) {
+        const auto counter = ctx->counter;
+        ParallelTranscode(size, 0x10, [&](std::size_t offset, std::size_t length) {
+            AESNI::CTRTranscode(ctx->encryption_keys, src + offset, length, dest + offset,
+                                AddToCounter(counter, offset / 0x10));
+        });
+        // Continue the stream where it ended like mbedtls does, partial blocks are discarded
+        ctx->counter = AddToCounter(counter, (size + 0xF) / 0x10);
+        return;
+    }
+
     auto* const context = op == Op::Encrypt ? &ctx->encryption_context : &ctx->decryption_context;
 
     mbedtls_cipher_reset(context);
@@ -118,6 +194,16 @@ void AESCipher<Key, KeySize>::XTSTranscode(const u8* src, std::size_t size, u8*
                                            std::size_t sector_id, std::size_t sector_size, Op op) {
     ASSERT_MSG(size % sector_size == 0, "XTS decryption size must be a multiple of sector size.");
 
+    if (ctx->use_aesni && sector_size % 0x10 == 0) {
+        const auto& data_keys = op == Op::Encrypt ? ctx->encryption_keys : ctx->decryption_keys;
+        ParallelTranscode(size, sector_size, [&](std::size_t offset, std::size_t length) {
+            AESNI::XTSTranscode(data_keys, ctx->tweak_keys, src + offset, length, dest + offset,
+                                sector_id + offset / sector_size, sector_size,
+                                op == Op::Encrypt);
+        });
+        return;
+    }
+
     for (std::size_t i = 0; i < size; i += sector_size) {
         SetIV(CalculateNintendoTweak(sector_id++));
         Transcode<u8, u8>(src + i, sector_size, dest + i, op);
@@ -9,6 +9,7 @@
 #include <fstream>
 #include <locale>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string_view>
 #include <tuple>
@@ -26,6 +27,7 @@
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
 #include "core/crypto/partition_data_manager.h"
+#include "core/crypto/sha_util.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/partition_filesystem.h"
@@ -485,20 +487,26 @@ KeyManager::KeyManager() {
     // Initialize keys
     const std::string hactool_keys_dir = FileUtil::GetHactoolConfigurationPath();
     const std::string yuzu_keys_dir = FileUtil::GetUserPath(FileUtil::UserPath::KeysDir);
+    std::vector<KeyFile> key_files;
     if (Settings::values.use_dev_keys) {
         dev_mode = true;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "dev.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "dev.keys_autogenerated", false);
+        AttemptReadKeyFile(key_files, yuzu_keys_dir, hactool_keys_dir, "dev.keys", false);
+        AttemptReadKeyFile(key_files, yuzu_keys_dir, yuzu_keys_dir, "dev.keys_autogenerated",
+                           false);
     } else {
         dev_mode = false;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "prod.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "prod.keys_autogenerated", false);
+        AttemptReadKeyFile(key_files, yuzu_keys_dir, hactool_keys_dir, "prod.keys", false);
+        AttemptReadKeyFile(key_files, yuzu_keys_dir, yuzu_keys_dir, "prod.keys_autogenerated",
+                           false);
     }
 
-    AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "title.keys", true);
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true);
-    AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "console.keys", false);
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "console.keys_autogenerated", false);
+    AttemptReadKeyFile(key_files, yuzu_keys_dir, hactool_keys_dir, "title.keys", true);
+    AttemptReadKeyFile(key_files, yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true);
+    AttemptReadKeyFile(key_files, yuzu_keys_dir, hactool_keys_dir, "console.keys", false);
+    AttemptReadKeyFile(key_files, yuzu_keys_dir, yuzu_keys_dir, "console.keys_autogenerated",
+                       false);
+
+    LoadKeyFiles(key_files);
 }
 
 static bool ValidCryptoRevisionString(std::string_view base, size_t begin, size_t length) {
@@ -508,12 +516,8 @@ static bool ValidCryptoRevisionString(std::string_view base, size_t begin, size_
                        [](u8 c) { return std::isxdigit(c); });
 }
 
-void KeyManager::LoadFromFile(const std::string& filename, bool is_title_keys) {
-    std::ifstream file;
-    OpenFStream(file, filename, std::ios_base::in);
-    if (!file.is_open())
-        return;
-
+void KeyManager::LoadFromString(const std::string& contents, bool is_title_keys) {
+    std::istringstream file(contents);
     std::string line;
     while (std::getline(file, line)) {
         std::vector<std::string> out;
@@ -598,12 +602,59 @@ void KeyManager::LoadFromFile(const std::string& filename, bool is_title_keys) {
     }
 }
 
-void KeyManager::AttemptLoadKeyFile(const std::string& dir1, const std::string& dir2,
-                                    const std::string& filename, bool title) {
-    if (FileUtil::Exists(dir1 + DIR_SEP + filename))
-        LoadFromFile(dir1 + DIR_SEP + filename, title);
-    else if (FileUtil::Exists(dir2 + DIR_SEP + filename))
-        LoadFromFile(dir2 + DIR_SEP + filename, title);
+void KeyManager::AttemptReadKeyFile(std::vector<KeyFile>& key_files, const std::string& dir1,
+                                    const std::string& dir2, const std::string& filename,
+                                    bool title) {
+    std::string path = dir1 + DIR_SEP + filename;
+    if (!FileUtil::Exists(path)) {
+        path = dir2 + DIR_SEP + filename;
+        if (!FileUtil::Exists(path))
+            return;
+    }
+
+    KeyFile key_file{{}, title};
+    FileUtil::ReadFileToString(true, path, key_file.contents);
+    key_files.push_back(std::move(key_file));
+}
+
+void KeyManager::LoadKeyFiles(const std::vector<KeyFile>& key_files) {
+    // A KeyManager is constructed for every NCA that is opened, so the keys parsed from the files
+    // are kept for the following instances, until the contents of the files change.
+    struct ParsedKeyFiles {
+        std::vector<std::pair<SHA256Hash, bool>> sources;
+        std::map<KeyIndex<S128KeyType>, Key128> s128_keys;
+        std::map<KeyIndex<S256KeyType>, Key256> s256_keys;
+        std::array<std::array<u8, 0xB0>, 0x20> encrypted_keyblobs;
+        std::array<std::array<u8, 0x90>, 0x20> keyblobs;
+        std::array<u8, 576> eticket_extended_kek;
+    };
+    static std::mutex cache_mutex;
+    static std::optional<ParsedKeyFiles> cache;
+
+    std::vector<std::pair<SHA256Hash, bool>> sources;
+    sources.reserve(key_files.size());
+    for (const auto& key_file : key_files) {
+        const auto data = reinterpret_cast<const u8*>(key_file.contents.data());
+        sources.emplace_back(SHA256(data, key_file.contents.size()), key_file.is_title_keys);
+    }
+
+    std::lock_guard lock{cache_mutex};
+    if (cache && cache->sources == sources) {
+        s128_keys = cache->s128_keys;
+        s256_keys = cache->s256_keys;
+        encrypted_keyblobs = cache->encrypted_keyblobs;
+        keyblobs = cache->keyblobs;
+        eticket_extended_kek = cache->eticket_extended_kek;
+        return;
+    }
+
+    for (const auto& key_file : key_files) {
+        LoadFromString(key_file.contents, key_file.is_title_keys);
+    }
+    cache = ParsedKeyFiles{
+        std::move(sources), s128_keys, s256_keys, encrypted_keyblobs, keyblobs,
+        eticket_extended_kek,
+    };
 }
 
 bool KeyManager::BaseDeriveNecessary() const {
@@ -685,7 +736,6 @@ void KeyManager::WriteKeyToFile(KeyCategory category, std::string_view keyname,
     }
 
     file << fmt::format("\n{} = {}", keyname, Common::HexToString(key));
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, filename, category == KeyCategory::Title);
 }
 
 void KeyManager::SetKey(S128KeyType id, Key128 key, u64 field1, u64 field2) {
@@ -10,6 +10,7 @@
 #include <string>
 
 #include <variant>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 #include <fmt/format.h>
 #include "common/common_funcs.h"
@@ -269,9 +270,17 @@ private:
     std::array<u8, 576> eticket_extended_kek{};
 
     bool dev_mode;
-    void LoadFromFile(const std::string& filename, bool is_title_keys);
-    void AttemptLoadKeyFile(const std::string& dir1, const std::string& dir2,
-                            const std::string& filename, bool title);
+
+    struct KeyFile {
+        std::string contents;
+        bool is_title_keys;
+    };
+
+    void LoadFromString(const std::string& contents, bool is_title_keys);
+    static void AttemptReadKeyFile(std::vector<KeyFile>& key_files, const std::string& dir1,
+                                   const std::string& dir2, const std::string& filename,
+                                   bool title);
+    void LoadKeyFiles(const std::vector<KeyFile>& key_files);
     template <size_t Size>
     void WriteKeyToFile(KeyCategory category, std::string_view keyname,
                         const std::array<u8, Size>& key);
@@ -2,4 +2,221 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-namespace Crypto {} // namespace Crypto
+#include <cstring>
+#include "common/swap.h"
+#include "core/crypto/sha_util.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define SHANI_TARGET
+#endif
+#endif
+
+namespace Core::Crypto {
+
+namespace {
+
+constexpr std::array<u32, 8> InitialState{0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                                          0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+alignas(16) constexpr std::array<u32, 64> RoundConstants{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+constexpr u32 RotateRight(u32 value, int amount) {
+    return (value >> amount) | (value << (32 - amount));
+}
+
+void ProcessBlocksGeneric(std::array<u32, 8>& state, const u8* data, std::size_t num_blocks) {
+    for (; num_blocks != 0; --num_blocks, data += 0x40) {
+        std::array<u32, 64> w;
+        for (std::size_t i = 0; i < 16; ++i) {
+            u32 word;
+            std::memcpy(&word, data + i * sizeof(u32), sizeof(u32));
+            w[i] = Common::swap32(word);
+        }
+        for (std::size_t i = 16; i < w.size(); ++i) {
+            const u32 w15 = w[i - 15];
+            const u32 w2 = w[i - 2];
+            const u32 s0 = RotateRight(w15, 7) ^ RotateRight(w15, 18) ^ (w15 >> 3);
+            const u32 s1 = RotateRight(w2, 17) ^ RotateRight(w2, 19) ^ (w2 >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto [a, b, c, d, e, f, g, h] = state;
+        for (std::size_t i = 0; i < w.size(); ++i) {
+            const u32 s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+            const u32 choice = (e & f) ^ (~e & g);
+            const u32 temp1 = h + s1 + choice + RoundConstants[i] + w[i];
+            const u32 s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+            const u32 majority = (a & b) ^ (a & c) ^ (b & c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + s0 + majority;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+SHANI_TARGET void ProcessBlocksSHANI(std::array<u32, 8>& state, const u8* data,
+                                     std::size_t num_blocks) {
+    const __m128i byte_swap = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+    // The instructions work on the state words in ABEF and CDGH order
+    const __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.data()));
+    const __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.data() + 4));
+    const __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+    const __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; num_blocks != 0; --num_blocks, data += 0x40) {
+        const __m128i abef_save = abef;
+        const __m128i cdgh_save = cdgh;
+
+        // Four rounds per iteration, the last four message words are kept for the schedule
+        __m128i messages[4];
+        for (std::size_t i = 0; i < 16; ++i) {
+            __m128i message;
+            if (i < 4) {
+                message = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+                message = _mm_shuffle_epi8(message, byte_swap);
+            } else {
+                const __m128i previous = messages[(i - 1) % 4];
+                message = _mm_sha256msg1_epu32(messages[i % 4], messages[(i - 3) % 4]);
+                message = _mm_add_epi32(message,
+                                        _mm_alignr_epi8(previous, messages[(i - 2) % 4], 4));
+                message = _mm_sha256msg2_epu32(message, previous);
+            }
+            messages[i % 4] = message;
+
+            const auto constants = reinterpret_cast<const __m128i*>(RoundConstants.data() + i * 4);
+            __m128i words = _mm_add_epi32(message, _mm_load_si128(constants));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, words);
+            words = _mm_shuffle_epi32(words, 0x0E);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, words);
+        }
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    }
+
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state.data()), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state.data() + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#endif
+
+} // Anonymous namespace
+
+SHA256Context::SHA256Context() {
+    Reset();
+}
+
+void SHA256Context::Update(const u8* data, std::size_t size) {
+    total_size += size;
+
+    if (buffered_size != 0) {
+        const std::size_t copy_size = std::min(size, BlockSize - buffered_size);
+        std::memcpy(buffer.data() + buffered_size, data, copy_size);
+        buffered_size += copy_size;
+        data += copy_size;
+        size -= copy_size;
+        if (buffered_size != BlockSize) {
+            return;
+        }
+        ProcessBlocks(buffer.data(), 1);
+        buffered_size = 0;
+    }
+
+    const std::size_t num_blocks = size / BlockSize;
+    ProcessBlocks(data, num_blocks);
+    data += num_blocks * BlockSize;
+    size -= num_blocks * BlockSize;
+
+    std::memcpy(buffer.data(), data, size);
+    buffered_size = size;
+}
+
+SHA256Hash SHA256Context::Finish() {
+    const u64 bit_size = Common::swap64(total_size * 8);
+
+    // A 0x80 byte, zeros up to the last 8 bytes of a block and the big endian size in bits
+    std::array<u8, BlockSize + sizeof(u64)> padding{0x80};
+    const std::size_t padding_size =
+        (buffered_size < BlockSize - sizeof(u64) ? BlockSize : BlockSize * 2) - buffered_size;
+    std::memcpy(padding.data() + padding_size - sizeof(u64), &bit_size, sizeof(u64));
+    Update(padding.data(), padding_size);
+
+    SHA256Hash hash;
+    for (std::size_t i = 0; i < state.size(); ++i) {
+        const u32 word = Common::swap32(state[i]);
+        std::memcpy(hash.data() + i * sizeof(u32), &word, sizeof(u32));
+    }
+    return hash;
+}
+
+void SHA256Context::Reset() {
+    state = InitialState;
+    buffered_size = 0;
+    total_size = 0;
+}
+
+void SHA256Context::ProcessBlocks(const u8* data, std::size_t num_blocks) {
+    if (num_blocks == 0) {
+        return;
+    }
+#ifdef ARCHITECTURE_x86_64
+    if (IsSHA256Accelerated()) {
+        ProcessBlocksSHANI(state, data, num_blocks);
+        return;
+    }
+#endif
+    ProcessBlocksGeneric(state, data, num_blocks);
+}
+
+bool IsSHA256Accelerated() {
+#ifdef ARCHITECTURE_x86_64
+    static const bool is_accelerated = Common::GetCPUCaps().sha && Common::GetCPUCaps().sse4_1;
+    return is_accelerated;
+#else
+    return false;
+#endif
+}
+
+SHA256Hash SHA256(const u8* data, std::size_t size) {
+    SHA256Context context;
+    context.Update(data, size);
+    return context.Finish();
+}
+
+} // namespace Core::Crypto
@@ -4,17 +4,39 @@
 
 #pragma once
 
-#include "common/assert.h"
-#include "core/file_sys/vfs.h"
-#include "key_manager.h"
-#include "mbedtls/cipher.h"
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+#include "core/crypto/key_manager.h"
 
-namespace Crypto {
-typedef std::array<u8, 0x20> SHA256Hash;
+namespace Core::Crypto {
 
-inline SHA256Hash operator"" _HASH(const char* data, size_t len) {
-    if (len != 0x40)
-        return {};
-}
+/// Incremental SHA-256, using the SHA instructions of the host CPU when it has them.
+class SHA256Context {
+public:
+    SHA256Context();
 
-} // namespace Crypto
+    void Update(const u8* data, std::size_t size);
+
+    /// Pads the message and returns its hash, the context has to be reset to be used again.
+    SHA256Hash Finish();
+
+    void Reset();
+
+private:
+    static constexpr std::size_t BlockSize = 0x40;
+
+    void ProcessBlocks(const u8* data, std::size_t num_blocks);
+
+    std::array<u32, 8> state;
+    std::array<u8, BlockSize> buffer;
+    std::size_t buffered_size;
+    u64 total_size;
+};
+
+/// Returns true when SHA256Context uses the SHA instructions of the host CPU.
+bool IsSHA256Accelerated();
+
+SHA256Hash SHA256(const u8* data, std::size_t size);
+
+} // namespace Core::Crypto
@@ -0,0 +1,133 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "core/file_sys/block_cache.h"
+
+namespace FileSys {
+
+BlockCache::BlockCache(std::size_t capacity)
+    : blocks_per_stripe{std::max<std::size_t>(capacity / BlockSize / NumStripes, 1)} {}
+
+BlockCache::~BlockCache() = default;
+
+std::size_t BlockCache::Read(u64 file_id, u8* data, std::size_t length, u64 offset,
+                             bool sequential, const FetchFunction& fetch) {
+    if (length >= BypassSize) {
+        return fetch(data, length, offset);
+    }
+    std::vector<u8> buffer;
+    std::size_t done = 0;
+    while (done < length) {
+        const u64 position = offset + done;
+        const BlockKey key{file_id, position / BlockSize};
+        const auto block_offset = static_cast<std::size_t>(position % BlockSize);
+        std::size_t copied = 0;
+        std::size_t expected = std::min(length - done, BlockSize - block_offset);
+        if (!CopyFromBlock(key, data + done, length - done, block_offset, copied)) {
+            // Sequential misses fetch the blocks after this one in the same host read
+            const std::size_t num_blocks = sequential ? ReadaheadBlocks : 1;
+            buffer.resize(num_blocks * BlockSize);
+            const std::size_t read = fetch(buffer.data(), buffer.size(), key.index * BlockSize);
+            for (std::size_t i = 0; i < num_blocks && i * BlockSize < read; ++i) {
+                InsertBlock({file_id, key.index + i}, buffer.data() + i * BlockSize,
+                            std::min(BlockSize, read - i * BlockSize));
+            }
+            if (read > block_offset) {
+                copied = std::min(length - done, read - block_offset);
+                std::memcpy(data + done, buffer.data() + block_offset, copied);
+            }
+            expected = std::min(length - done, buffer.size() - block_offset);
+        }
+        done += copied;
+        if (copied < expected) {
+            // Short blocks are at the end of the file
+            break;
+        }
+    }
+    return done;
+}
+
+void BlockCache::Invalidate(u64 file_id) {
+    for (Stripe& stripe : stripes) {
+        std::lock_guard lock{stripe.mutex};
+        for (auto it = stripe.lru.begin(); it != stripe.lru.end();) {
+            if (it->key.file_id == file_id) {
+                stripe.blocks.erase(it->key);
+                it = stripe.lru.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+u64 BlockCache::GenerateFileId() {
+    return next_file_id++;
+}
+
+u64 BlockCache::GetHitCount() const {
+    u64 hits = 0;
+    for (const Stripe& stripe : stripes) {
+        std::lock_guard lock{stripe.mutex};
+        hits += stripe.hits;
+    }
+    return hits;
+}
+
+u64 BlockCache::GetMissCount() const {
+    u64 misses = 0;
+    for (const Stripe& stripe : stripes) {
+        std::lock_guard lock{stripe.mutex};
+        misses += stripe.misses;
+    }
+    return misses;
+}
+
+BlockCache::Stripe& BlockCache::GetStripe(const BlockKey& key) {
+    // Consecutive blocks go to different stripes, readahead spreads over all of them
+    return stripes[(key.index + key.file_id) % NumStripes];
+}
+
+bool BlockCache::CopyFromBlock(const BlockKey& key, u8* data, std::size_t length,
+                               std::size_t block_offset, std::size_t& copied) {
+    Stripe& stripe = GetStripe(key);
+    std::lock_guard lock{stripe.mutex};
+    const auto it = stripe.blocks.find(key);
+    if (it == stripe.blocks.end()) {
+        ++stripe.misses;
+        return false;
+    }
+    ++stripe.hits;
+    stripe.lru.splice(stripe.lru.begin(), stripe.lru, it->second);
+
+    const std::vector<u8>& block = it->second->data;
+    copied = block.size() > block_offset ? std::min(length, block.size() - block_offset) : 0;
+    std::memcpy(data, block.data() + block_offset, copied);
+    return true;
+}
+
+void BlockCache::InsertBlock(const BlockKey& key, const u8* data, std::size_t size) {
+    Stripe& stripe = GetStripe(key);
+    std::lock_guard lock{stripe.mutex};
+    if (stripe.blocks.count(key) != 0) {
+        return;
+    }
+    if (stripe.lru.size() >= blocks_per_stripe) {
+        // Reuse the storage of the evicted block
+        auto last = std::prev(stripe.lru.end());
+        stripe.blocks.erase(last->key);
+        stripe.lru.splice(stripe.lru.begin(), stripe.lru, last);
+    } else {
+        stripe.lru.emplace_front();
+    }
+    Block& block = stripe.lru.front();
+    block.key = key;
+    block.data.assign(data, data + size);
+    block.memory.Resize(block.data.capacity());
+    stripe.blocks.emplace(key, stripe.lru.begin());
+}
+
+} // namespace FileSys
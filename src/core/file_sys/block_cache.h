@@ -0,0 +1,108 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+
+namespace FileSys {
+
+/**
+ * Size-bounded cache of fixed size blocks of host files, shared by every file of a filesystem.
+ * Blocks are evicted in least recently used order. The cache is split in stripes with their own
+ * lock and LRU list so files read from several threads don't contend on a single mutex.
+ */
+class BlockCache {
+public:
+    static constexpr std::size_t BlockSize = 0x10000;
+    static constexpr std::size_t NumStripes = 16;
+    /// Blocks fetched ahead of a miss when a file is read sequentially
+    static constexpr std::size_t ReadaheadBlocks = 8;
+    /// Reads at least this large skip the cache, they gain nothing from it and would evict it
+    static constexpr std::size_t BypassSize = BlockSize * ReadaheadBlocks;
+
+    /// Reads length bytes of a file at an offset into data, returns the number of bytes read.
+    using FetchFunction = std::function<std::size_t(u8* data, std::size_t length, u64 offset)>;
+
+    explicit BlockCache(std::size_t capacity);
+    ~BlockCache();
+
+    /**
+     * Reads from a file through the cache.
+     * @param file_id Unique identifier of the file, as given by GenerateFileId
+     * @param data Where to write the data read
+     * @param length Number of bytes to read
+     * @param offset Offset in the file to read from
+     * @param sequential True when this read continues the previous one, misses read ahead
+     * @param fetch Reads from the file on misses
+     * @returns The number of bytes read, short reads only happen at the end of the file
+     */
+    std::size_t Read(u64 file_id, u8* data, std::size_t length, u64 offset, bool sequential,
+                     const FetchFunction& fetch);
+
+    /// Drops the blocks of a file, for files that have been changed or deleted.
+    void Invalidate(u64 file_id);
+
+    /// Returns an identifier that hasn't been given to any other file.
+    u64 GenerateFileId();
+
+    u64 GetHitCount() const;
+    u64 GetMissCount() const;
+
+private:
+    struct BlockKey {
+        u64 file_id;
+        u64 index;
+
+        bool operator==(const BlockKey& rhs) const {
+            return file_id == rhs.file_id && index == rhs.index;
+        }
+    };
+
+    struct BlockKeyHash {
+        std::size_t operator()(const BlockKey& key) const {
+            return static_cast<std::size_t>(key.file_id * 0x9E3779B97F4A7C15ULL ^ key.index);
+        }
+    };
+
+    struct Block {
+        BlockKey key;
+        std::vector<u8> data; ///< Shorter than BlockSize at the end of the file
+        Common::MemoryAccounting::TrackedAllocation memory{
+            Common::MemoryAccounting::Tag::FileSystemCache};
+    };
+
+    struct Stripe {
+        mutable std::mutex mutex;
+        std::list<Block> lru; ///< Most recently used first
+        std::unordered_map<BlockKey, std::list<Block>::iterator, BlockKeyHash> blocks;
+        u64 hits = 0;
+        u64 misses = 0;
+    };
+
+    Stripe& GetStripe(const BlockKey& key);
+
+    /// Copies from a cached block, returns false when the block isn't cached.
+    bool CopyFromBlock(const BlockKey& key, u8* data, std::size_t length,
+                       std::size_t block_offset, std::size_t& copied);
+
+    /// Inserts a block, evicting the least recently used ones of its stripe when it's full.
+    void InsertBlock(const BlockKey& key, const u8* data, std::size_t size);
+
+    std::size_t blocks_per_stripe;
+    std::array<Stripe, NumStripes> stripes;
+
+    std::atomic<u64> next_file_id{1};
+};
+
+} // namespace FileSys
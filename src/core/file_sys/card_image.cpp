@@ -9,6 +9,7 @@
 
 #include "common/logging/log.h"
 #include "core/file_sys/card_image.h"
+#include "core/file_sys/compressed_archive.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/partition_filesystem.h"
@@ -207,8 +208,13 @@ Loader::ResultStatus XCI::AddNCAFromPartition(XCIPartition part) {
         return Loader::ResultStatus::ErrorXCIMissingPartition;
     }
 
-    for (const VirtualFile& file : partition->GetFiles()) {
-        if (file->GetExtension() != "nca") {
+    for (VirtualFile file : partition->GetFiles()) {
+        if (file->GetExtension() == "ncz") {
+            file = NCZFile::Open(std::move(file));
+            if (file == nullptr) {
+                continue;
+            }
+        } else if (file->GetExtension() != "nca") {
             continue;
         }
 
@@ -0,0 +1,315 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/logging/log.h"
+#include "common/thread_pool.h"
+#include "common/zstd_compression.h"
+#include "core/crypto/aes_util.h"
+#include "core/crypto/key_manager.h"
+#include "core/file_sys/compressed_archive.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr std::array<char, 8> SectionMagic{'N', 'C', 'Z', 'S', 'E', 'C', 'T', 'N'};
+constexpr std::array<char, 8> BlockMagic{'N', 'C', 'Z', 'B', 'L', 'O', 'C', 'K'};
+
+// Blocks are aligned to the AES blocks, and limited so a cached block stays reasonably small
+constexpr u32 MinBlockSizeExponent = 14;
+constexpr u32 MaxBlockSizeExponent = 24;
+
+// Bounds the section table of malformed files, an NCA has at most four sections
+constexpr u64 MaxSections = 0x10;
+
+// Crypto types of the sections, the ones using AES-CTR were stored decrypted
+enum class SectionCrypto : u64 {
+    None = 1,
+    XTS = 2,
+    CTR = 3,
+    BKTR = 4,
+};
+
+bool MagicMatches(const std::array<char, 8>& magic, u64 value) {
+    return std::memcmp(magic.data(), &value, sizeof(value)) == 0;
+}
+
+} // Anonymous namespace
+
+NCZFile::NCZFile(VirtualFile base_) : base(std::move(base_)) {}
+
+NCZFile::~NCZFile() = default;
+
+std::shared_ptr<NCZFile> NCZFile::Open(VirtualFile file) {
+    if (file == nullptr) {
+        return nullptr;
+    }
+    std::shared_ptr<NCZFile> ncz{new NCZFile(std::move(file))};
+    if (!ncz->Parse()) {
+        return nullptr;
+    }
+    return ncz;
+}
+
+bool NCZFile::Parse() {
+    u64 offset = NCAHeaderSize;
+    u64_le magic{};
+    u64_le num_sections{};
+    if (base->ReadObject(&magic, offset) != sizeof(magic) || !MagicMatches(SectionMagic, magic) ||
+        base->ReadObject(&num_sections, offset + sizeof(magic)) != sizeof(num_sections)) {
+        LOG_ERROR(Loader, "{} is not an NCZ.", base->GetName());
+        return false;
+    }
+    offset += sizeof(magic) + sizeof(num_sections);
+    if (num_sections == 0 || num_sections > MaxSections) {
+        LOG_ERROR(Loader, "NCZ {} has an invalid section count {}.", base->GetName(),
+                  num_sections);
+        return false;
+    }
+    sections.resize(num_sections);
+    const std::size_t sections_size = sections.size() * sizeof(SectionHeader);
+    if (base->Read(reinterpret_cast<u8*>(sections.data()), sections_size, offset) !=
+        sections_size) {
+        LOG_ERROR(Loader, "NCZ {} has a truncated section table.", base->GetName());
+        return false;
+    }
+    offset += sections_size;
+
+    BlockHeader header{};
+    if (base->ReadObject(&header, offset) != sizeof(header) ||
+        !MagicMatches(BlockMagic, header.magic)) {
+        // Without a block table the data is a single zstd stream that can't be read at random
+        LOG_ERROR(Loader, "NCZ {} is not block compressed, which is not supported.",
+                  base->GetName());
+        return false;
+    }
+    offset += sizeof(header);
+
+    block_size_exponent = header.block_size_exponent;
+    decompressed_size = header.decompressed_size;
+    const u64 num_blocks = header.num_blocks;
+    if (block_size_exponent < MinBlockSizeExponent || block_size_exponent > MaxBlockSizeExponent ||
+        num_blocks != (decompressed_size + (1ULL << block_size_exponent) - 1) >>
+                          block_size_exponent) {
+        LOG_ERROR(Loader, "NCZ {} has an invalid block table.", base->GetName());
+        return false;
+    }
+
+    std::vector<u32_le> compressed_sizes(num_blocks);
+    const std::size_t table_size = compressed_sizes.size() * sizeof(u32_le);
+    if (base->Read(reinterpret_cast<u8*>(compressed_sizes.data()), table_size, offset) !=
+        table_size) {
+        LOG_ERROR(Loader, "NCZ {} has a truncated block table.", base->GetName());
+        return false;
+    }
+    offset += table_size;
+
+    block_offsets.reserve(num_blocks + 1);
+    block_offsets.push_back(offset);
+    for (const u32 compressed_size : compressed_sizes) {
+        offset += compressed_size;
+        block_offsets.push_back(offset);
+    }
+    if (offset > base->GetSize()) {
+        LOG_ERROR(Loader, "NCZ {} is truncated.", base->GetName());
+        return false;
+    }
+
+    cache_capacity = std::max<std::size_t>(CacheSize >> block_size_exponent, 2);
+    return true;
+}
+
+std::string NCZFile::GetName() const {
+    std::string name = base->GetName();
+    const std::string extension = base->GetExtension();
+    if (!extension.empty()) {
+        // The view holds the NCA, the name is the one it had before it was compressed
+        name.replace(name.size() - extension.size(), extension.size(), "nca");
+    }
+    return name;
+}
+
+std::size_t NCZFile::GetSize() const {
+    return static_cast<std::size_t>(NCAHeaderSize + decompressed_size);
+}
+
+bool NCZFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+std::shared_ptr<VfsDirectory> NCZFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool NCZFile::IsWritable() const {
+    return false;
+}
+
+bool NCZFile::IsReadable() const {
+    return true;
+}
+
+std::size_t NCZFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    const std::size_t size = GetSize();
+    if (offset >= size) {
+        return 0;
+    }
+    length = std::min(length, size - offset);
+
+    std::size_t done = 0;
+    if (offset < NCAHeaderSize) {
+        const std::size_t header_length = std::min(length, NCAHeaderSize - offset);
+        done = base->Read(data, header_length, offset);
+        if (done != header_length) {
+            return done;
+        }
+    }
+    if (done == length) {
+        return done;
+    }
+
+    const bool sequential = next_offset.exchange(offset + length) == offset;
+    const u64 stream_offset = offset + done - NCAHeaderSize;
+    const u64 first = stream_offset >> block_size_exponent;
+    const u64 last = (offset + length - 1 - NCAHeaderSize) >> block_size_exponent;
+    const u64 num_blocks = block_offsets.size() - 1;
+    const u64 readahead_last = sequential ? std::min(last + ReadaheadBlocks, num_blocks - 1) : last;
+
+    const u64 block_mask = (1ULL << block_size_exponent) - 1;
+    std::size_t block_offset = static_cast<std::size_t>(stream_offset & block_mask);
+    for (const Block& block : GetBlocks(first, last, readahead_last)) {
+        if (block == nullptr) {
+            break;
+        }
+        const std::size_t copied = std::min(length - done, block->size() - block_offset);
+        std::memcpy(data + done, block->data() + block_offset, copied);
+        done += copied;
+        block_offset = 0;
+    }
+    return done;
+}
+
+std::size_t NCZFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool NCZFile::Rename(std::string_view name) {
+    return base->Rename(name);
+}
+
+std::vector<NCZFile::Block> NCZFile::GetBlocks(u64 first, u64 last, u64 readahead_last) const {
+    std::vector<Block> blocks(readahead_last - first + 1);
+    std::vector<u64> missing;
+    {
+        std::lock_guard lock{cache_mutex};
+        for (u64 index = first; index <= readahead_last; ++index) {
+            const auto it = std::find_if(cache.begin(), cache.end(), [index](const auto& entry) {
+                return entry.index == index;
+            });
+            if (it == cache.end()) {
+                missing.push_back(index);
+                continue;
+            }
+            blocks[index - first] = it->data;
+            cache.splice(cache.begin(), cache, it);
+        }
+    }
+    if (missing.empty()) {
+        blocks.resize(last - first + 1);
+        return blocks;
+    }
+
+    // Blocks are compressed independently, decompress the missing ones side by side
+    std::atomic<std::size_t> next_block{0};
+    const auto worker = [&] {
+        for (std::size_t i = next_block++; i < missing.size(); i = next_block++) {
+            blocks[missing[i] - first] = DecompressBlock(missing[i]);
+        }
+    };
+    auto& pool = Common::GetThreadPool();
+    const std::size_t num_threads =
+        std::clamp<std::size_t>(pool.GetNumWorkers() + 1, 1, missing.size());
+    {
+        Common::TaskGroup group{pool};
+        for (std::size_t i = 1; i < num_threads; ++i) {
+            group.Submit(worker, Common::TaskPriority::High);
+        }
+        worker();
+        group.Wait();
+    }
+
+    {
+        std::lock_guard lock{cache_mutex};
+        for (const u64 index : missing) {
+            if (blocks[index - first] == nullptr) {
+                continue;
+            }
+            cache.push_front({index, blocks[index - first]});
+        }
+        while (cache.size() > cache_capacity) {
+            cache.pop_back();
+        }
+    }
+    blocks.resize(last - first + 1);
+    return blocks;
+}
+
+NCZFile::Block NCZFile::DecompressBlock(u64 index) const {
+    const u64 stream_offset = index << block_size_exponent;
+    const auto size = static_cast<std::size_t>(
+        std::min<u64>(1ULL << block_size_exponent, decompressed_size - stream_offset));
+    const auto compressed_size =
+        static_cast<std::size_t>(block_offsets[index + 1] - block_offsets[index]);
+
+    auto block = std::make_shared<std::vector<u8>>(size);
+    if (compressed_size >= size) {
+        // Blocks that don't shrink are stored as they are
+        if (base->Read(block->data(), size, block_offsets[index]) != size) {
+            LOG_ERROR(Loader, "Could not read block {} of NCZ {}.", index, base->GetName());
+            return nullptr;
+        }
+    } else {
+        std::vector<u8> compressed(compressed_size);
+        if (base->Read(compressed.data(), compressed_size, block_offsets[index]) !=
+                compressed_size ||
+            !Common::Compression::DecompressDataZSTD(compressed.data(), compressed.size(),
+                                                     block->data(), size)) {
+            LOG_ERROR(Loader, "Could not decompress block {} of NCZ {}.", index,
+                      base->GetName());
+            return nullptr;
+        }
+    }
+
+    const u64 block_start = NCAHeaderSize + stream_offset;
+    const u64 block_end = block_start + size;
+    for (const SectionHeader& section : sections) {
+        const auto crypto = static_cast<SectionCrypto>(static_cast<u64>(section.crypto_type));
+        if (crypto != SectionCrypto::CTR && crypto != SectionCrypto::BKTR) {
+            continue;
+        }
+        const u64 start = std::max<u64>(block_start, section.offset);
+        const u64 end = std::min<u64>(block_end, section.offset + section.size);
+        if (start >= end) {
+            continue;
+        }
+
+        // Sections start on 0x200 byte boundaries, so the counter never starts mid AES block
+        std::vector<u8> iv(section.counter.begin(), section.counter.end());
+        u64 counter = start >> 4;
+        for (std::size_t i = 0; i < sizeof(u64); ++i) {
+            iv[0xF - i] = static_cast<u8>(counter & 0xFF);
+            counter >>= 8;
+        }
+        Core::Crypto::AESCipher<Core::Crypto::Key128> cipher(section.key, Core::Crypto::Mode::CTR);
+        cipher.SetIV(iv);
+        u8* const section_data = block->data() + (start - block_start);
+        cipher.Transcode(section_data, static_cast<std::size_t>(end - start), section_data,
+                         Core::Crypto::Op::Encrypt);
+    }
+    return block;
+}
+
+} // namespace FileSys
@@ -0,0 +1,110 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+#include "common/swap.h"
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+/**
+ * Read-only view of an NCZ, an NCA whose contents past the header were decrypted and compressed
+ * with zstd in independently compressed blocks. Reads decompress the blocks covering them and
+ * encrypt them again with the keys stored in the NCZ, so the view reads exactly like the original
+ * NCA and can be handed to the NCA parser. Decompressed blocks are kept in a small cache and
+ * sequential reads decompress the blocks after them in parallel.
+ */
+class NCZFile : public VfsFile {
+public:
+    /// Uncompressed NCA header stored in front of the compressed data
+    static constexpr std::size_t NCAHeaderSize = 0x4000;
+    /// Blocks decompressed ahead of a sequential read
+    static constexpr std::size_t ReadaheadBlocks = 4;
+    /// Bytes of decompressed blocks cached per file
+    static constexpr std::size_t CacheSize = 0x1000000;
+
+    ~NCZFile() override;
+
+    /// Returns a view of the NCA stored in an NCZ, or nullptr if the file is not a valid NCZ.
+    static std::shared_ptr<NCZFile> Open(VirtualFile file);
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view name) override;
+
+private:
+    struct SectionHeader {
+        u64_le offset;
+        u64_le size;
+        u64_le crypto_type;
+        INSERT_PADDING_BYTES(8);
+        std::array<u8, 0x10> key;
+        std::array<u8, 0x10> counter;
+    };
+    static_assert(sizeof(SectionHeader) == 0x40, "SectionHeader has incorrect size.");
+
+#pragma pack(push, 1)
+    struct BlockHeader {
+        u64_le magic;
+        u8 version;
+        u8 type;
+        INSERT_PADDING_BYTES(1);
+        u8 block_size_exponent;
+        u32_le num_blocks;
+        u64_le decompressed_size;
+    };
+#pragma pack(pop)
+    static_assert(sizeof(BlockHeader) == 0x18, "BlockHeader has incorrect size.");
+
+    using Block = std::shared_ptr<const std::vector<u8>>;
+
+    struct CachedBlock {
+        u64 index;
+        Block data;
+        Common::MemoryAccounting::TrackedAllocation memory{
+            Common::MemoryAccounting::Tag::FileSystemCache, data->size()};
+    };
+
+    explicit NCZFile(VirtualFile base);
+
+    /// Reads the section and block tables, returns false if they are malformed.
+    bool Parse();
+
+    /// Returns the blocks first to last, decompressing the missing ones up to readahead_last.
+    std::vector<Block> GetBlocks(u64 first, u64 last, u64 readahead_last) const;
+
+    /// Decompresses a block and encrypts the parts of it that belong to encrypted sections.
+    Block DecompressBlock(u64 index) const;
+
+    VirtualFile base;
+    std::vector<SectionHeader> sections;
+
+    u32 block_size_exponent = 0;
+    u64 decompressed_size = 0;
+    std::vector<u64> block_offsets; ///< Offsets of the compressed blocks, and the end of the last
+    std::size_t cache_capacity = 0;
+
+    mutable std::mutex cache_mutex;
+    mutable std::list<CachedBlock> cache; ///< Most recently used first
+    mutable std::atomic<u64> next_offset{0};
+};
+
+} // namespace FileSys
@@ -3,10 +3,13 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <optional>
 #include <utility>
+#include <mbedtls/sha256.h>
 
+#include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/ctr_encryption_layer.h"
@@ -14,8 +17,10 @@
 #include "core/file_sys/nca_patch.h"
 #include "core/file_sys/partition_filesystem.h"
 #include "core/file_sys/romfs.h"
+#include "core/file_sys/section_cache.h"
 #include "core/file_sys/vfs_offset.h"
 #include "core/loader/loader.h"
+#include "core/settings.h"
 
 namespace FileSys {
 
@@ -483,6 +488,9 @@ VirtualFile NCA::Decrypt(const NCASectionHeader& s_header, VirtualFile in, u64 s
             for (u8 i = 0; i < 8; ++i)
                 iv[i] = s_header.raw.section_ctr[0x8 - i - 1];
             out->SetIV(iv);
+            if (s_header.raw.header.crypto_type == NCASectionCryptoType::CTR) {
+                return CacheSection(std::move(out), starting_offset);
+            }
             return std::static_pointer_cast<VfsFile>(out);
         }
     case NCASectionCryptoType::XTS:
@@ -494,6 +502,28 @@ VirtualFile NCA::Decrypt(const NCASectionHeader& s_header, VirtualFile in, u64 s
     }
 }
 
+VirtualFile NCA::CacheSection(VirtualFile decrypted, u64 starting_offset) const {
+    if (!Settings::values.cache_decrypted_nca_sections) {
+        return decrypted;
+    }
+
+    // The header holds the hashes of every section, the cache is dropped when any of them changes
+    std::array<u8, 0x20> header_hash;
+    mbedtls_sha256(reinterpret_cast<const u8*>(&header), sizeof(NCAHeader), header_hash.data(), 0);
+
+    // Files are named after their NCA ID, fall back to the header hash when they were renamed
+    std::string nca_id = GetName().substr(0, GetName().find('.'));
+    const bool is_nca_id =
+        nca_id.size() == 0x20 && std::all_of(nca_id.begin(), nca_id.end(), [](char c) {
+            return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+        });
+    if (!is_nca_id) {
+        nca_id = Common::HexToString(header_hash).substr(0, 0x20);
+    }
+    return std::make_shared<SectionCacheFile>(
+        std::move(decrypted), SectionCacheFile::GetCachePath(nca_id, starting_offset), header_hash);
+}
+
 Loader::ResultStatus NCA::GetStatus() const {
     return status;
 }
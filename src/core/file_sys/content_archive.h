@@ -140,6 +140,7 @@ private:
     std::optional<Core::Crypto::Key128> GetKeyAreaKey(NCASectionCryptoType type) const;
     std::optional<Core::Crypto::Key128> GetTitlekey();
     VirtualFile Decrypt(const NCASectionHeader& header, VirtualFile in, u64 starting_offset);
+    VirtualFile CacheSection(VirtualFile decrypted, u64 starting_offset) const;
 
     std::vector<VirtualDir> dirs;
     std::vector<VirtualFile> files;
@@ -23,7 +23,10 @@
  */
 
 #include <cstring>
+#include <set>
 #include <string_view>
+#include <utility>
+#include <vector>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "core/file_sys/fsmitm_romfsbuild.h"
@@ -126,69 +129,77 @@ static u64 romfs_get_hash_table_count(u64 num_entries) {
     return count;
 }
 
-void RomFSBuildContext::VisitDirectory(VirtualDir root_romfs, VirtualDir ext,
+void RomFSBuildContext::VisitDirectory(VirtualDir dir, VirtualDir ext_dir,
                                        std::shared_ptr<RomFSBuildDirectoryContext> parent) {
-    std::vector<std::shared_ptr<RomFSBuildDirectoryContext>> child_dirs;
-
-    VirtualDir dir;
-
-    if (parent->path_len == 0)
-        dir = root_romfs;
-    else
-        dir = root_romfs->GetDirectoryRelative(parent->path);
-
-    const auto entries = dir->GetEntries();
-
-    for (const auto& kv : entries) {
-        if (kv.second == VfsEntryType::Directory) {
-            const auto child = std::make_shared<RomFSBuildDirectoryContext>();
-            // Set child's path.
-            child->cur_path_ofs = parent->path_len + 1;
-            child->path_len = child->cur_path_ofs + static_cast<u32>(kv.first.size());
-            child->path = parent->path + "/" + kv.first;
-
-            if (ext != nullptr && ext->GetFileRelative(child->path + ".stub") != nullptr)
-                continue;
-
-            // Sanity check on path_len
-            ASSERT(child->path_len < FS_MAX_PATH);
-
-            if (AddDirectory(parent, child)) {
-                child_dirs.push_back(child);
-            }
-        } else {
-            const auto child = std::make_shared<RomFSBuildFileContext>();
-            // Set child's path.
-            child->cur_path_ofs = parent->path_len + 1;
-            child->path_len = child->cur_path_ofs + static_cast<u32>(kv.first.size());
-            child->path = parent->path + "/" + kv.first;
+    // The directory and its ext counterpart are walked together, paths are never looked up from
+    // the root again. Layered directories would otherwise query every layer for every file.
+    std::map<std::string, VirtualFile, std::less<>> ext_files;
+    if (ext_dir != nullptr) {
+        for (auto& file : ext_dir->GetFiles()) {
+            ext_files.emplace(file->GetName(), std::move(file));
+        }
+    }
+    const auto is_stubbed = [&ext_files](const std::string& name) {
+        return ext_files.find(name + ".stub") != ext_files.end();
+    };
+
+    std::vector<std::pair<std::shared_ptr<RomFSBuildDirectoryContext>, VirtualDir>> child_dirs;
+    std::set<std::string, std::less<>> dir_names;
+    for (auto& subdir : dir->GetSubdirectories()) {
+        const std::string name = subdir->GetName();
+        dir_names.insert(name);
+
+        const auto child = std::make_shared<RomFSBuildDirectoryContext>();
+        // Set child's path.
+        child->cur_path_ofs = parent->path_len + 1;
+        child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
+        child->path = parent->path + "/" + name;
+
+        if (is_stubbed(name))
+            continue;
+
+        // Sanity check on path_len
+        ASSERT(child->path_len < FS_MAX_PATH);
+
+        if (AddDirectory(parent, child)) {
+            child_dirs.emplace_back(child, std::move(subdir));
+        }
+    }
 
-            if (ext != nullptr && ext->GetFileRelative(child->path + ".stub") != nullptr)
-                continue;
+    for (auto& file : dir->GetFiles()) {
+        const std::string name = file->GetName();
+        // Directories take precedence over files of the same name
+        if (dir_names.find(name) != dir_names.end() || is_stubbed(name))
+            continue;
 
-            // Sanity check on path_len
-            ASSERT(child->path_len < FS_MAX_PATH);
+        const auto child = std::make_shared<RomFSBuildFileContext>();
+        // Set child's path.
+        child->cur_path_ofs = parent->path_len + 1;
+        child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
+        child->path = parent->path + "/" + name;
 
-            child->source = root_romfs->GetFileRelative(child->path);
+        // Sanity check on path_len
+        ASSERT(child->path_len < FS_MAX_PATH);
 
-            if (ext != nullptr) {
-                const auto ips = ext->GetFileRelative(child->path + ".ips");
+        child->source = std::move(file);
 
-                if (ips != nullptr) {
-                    auto patched = PatchIPS(child->source, ips);
-                    if (patched != nullptr)
-                        child->source = std::move(patched);
-                }
-            }
+        const auto ips = ext_files.find(name + ".ips");
+        if (ips != ext_files.end()) {
+            auto patched = PatchIPS(child->source, ips->second);
+            if (patched != nullptr)
+                child->source = std::move(patched);
+        }
 
-            child->size = child->source->GetSize();
+        child->size = child->source->GetSize();
 
-            AddFile(parent, child);
-        }
+        AddFile(parent, child);
     }
 
-    for (auto& child : child_dirs) {
-        this->VisitDirectory(root_romfs, ext, child);
+    for (auto& [child, subdir] : child_dirs) {
+        const std::string_view name = std::string_view(child->path).substr(child->cur_path_ofs);
+        this->VisitDirectory(std::move(subdir),
+                             ext_dir == nullptr ? nullptr : ext_dir->GetSubdirectory(name),
+                             child);
     }
 }
 
@@ -383,4 +394,12 @@ std::map<u64, VirtualFile> RomFSBuildContext::Build() {
     return out;
 }
 
+std::map<u64, std::string> RomFSBuildContext::GetFilePaths() const {
+    std::map<u64, std::string> out;
+    for (const auto& it : files) {
+        out.emplace(it.second->offset + ROMFS_FILEPARTITION_OFS, it.second->path);
+    }
+    return out;
+}
+
 } // namespace FileSys
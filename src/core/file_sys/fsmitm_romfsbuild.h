@@ -45,6 +45,10 @@ public:
     // This finalizes the context.
     std::map<u64, VirtualFile> Build();
 
+    // Returns the path of every file of the built image, keyed by the offset of its data. Only
+    // valid once the context has been finalized.
+    std::map<u64, std::string> GetFilePaths() const;
+
 private:
     VirtualDir base;
     VirtualDir ext;
@@ -59,7 +63,7 @@ private:
     u64 file_hash_table_size = 0;
     u64 file_partition_size = 0;
 
-    void VisitDirectory(VirtualDir filesys, VirtualDir ext,
+    void VisitDirectory(VirtualDir dir, VirtualDir ext_dir,
                         std::shared_ptr<RomFSBuildDirectoryContext> parent);
 
     bool AddDirectory(std::shared_ptr<RomFSBuildDirectoryContext> parent_dir_ctx,
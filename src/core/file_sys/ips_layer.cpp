@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iterator>
 #include <map>
 #include <sstream>
 #include <string>
@@ -13,7 +14,6 @@
 #include "common/logging/log.h"
 #include "common/swap.h"
 #include "core/file_sys/ips_layer.h"
-#include "core/file_sys/vfs_vector.h"
 
 namespace FileSys {
 
@@ -65,6 +65,125 @@ static bool IsEOF(IPSFileType type, const std::vector<u8>& data) {
     return type == IPSFileType::IPS32 && std::equal(data.begin(), data.end(), eeof.begin());
 }
 
+PatchedVfsFile::PatchedVfsFile(VirtualFile base_) : base(std::move(base_)) {}
+
+PatchedVfsFile::~PatchedVfsFile() = default;
+
+std::shared_ptr<PatchedVfsFile> PatchedVfsFile::Wrap(const VirtualFile& in) {
+    const auto patched = std::dynamic_pointer_cast<PatchedVfsFile>(in);
+    if (patched == nullptr) {
+        return std::make_shared<PatchedVfsFile>(in);
+    }
+
+    auto out = std::make_shared<PatchedVfsFile>(patched->base);
+    out->records = patched->records;
+    return out;
+}
+
+void PatchedVfsFile::AddRecord(u64 offset, std::vector<u8> data) {
+    const u64 size = base->GetSize();
+    if (offset >= size || data.empty()) {
+        return;
+    }
+    if (offset + data.size() > size) {
+        data.resize(size - offset);
+    }
+    const u64 end = offset + data.size();
+
+    // Trim the records the new one overlaps, keeping whatever sticks out on either side
+    auto iter = records.lower_bound(offset);
+    if (iter != records.begin()) {
+        const auto prev = std::prev(iter);
+        if (prev->first + prev->second.size() > offset) {
+            iter = prev;
+        }
+    }
+    while (iter != records.end() && iter->first < end) {
+        const u64 record_end = iter->first + iter->second.size();
+        if (record_end > end) {
+            std::vector<u8> tail(iter->second.end() - (record_end - end), iter->second.end());
+            records.emplace(end, std::move(tail));
+        }
+        if (iter->first < offset) {
+            iter->second.resize(offset - iter->first);
+            ++iter;
+        } else {
+            iter = records.erase(iter);
+        }
+    }
+
+    records.emplace(offset, std::move(data));
+}
+
+std::size_t PatchedVfsFile::GetRecordCount() const {
+    return records.size();
+}
+
+std::string PatchedVfsFile::GetName() const {
+    return base->GetName();
+}
+
+std::size_t PatchedVfsFile::GetSize() const {
+    return base->GetSize();
+}
+
+bool PatchedVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+std::shared_ptr<VfsDirectory> PatchedVfsFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool PatchedVfsFile::IsWritable() const {
+    return false;
+}
+
+bool PatchedVfsFile::IsReadable() const {
+    return true;
+}
+
+std::size_t PatchedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    const std::size_t read = base->Read(data, length, offset);
+    const u64 end = offset + read;
+
+    auto iter = records.upper_bound(offset);
+    if (iter != records.begin()) {
+        --iter;
+    }
+    for (; iter != records.end() && iter->first < end; ++iter) {
+        const u64 record_begin = std::max<u64>(iter->first, offset);
+        const u64 record_end = std::min<u64>(iter->first + iter->second.size(), end);
+        if (record_begin >= record_end) {
+            continue;
+        }
+        std::memcpy(data + (record_begin - offset),
+                    iter->second.data() + (record_begin - iter->first), record_end - record_begin);
+    }
+
+    return read;
+}
+
+std::size_t PatchedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+const u8* PatchedVfsFile::GetPointer(std::size_t length, std::size_t offset) const {
+    // The base data can only be handed out when no record touches the range
+    const auto iter = records.lower_bound(offset + length);
+    if (iter != records.begin()) {
+        const auto prev = std::prev(iter);
+        if (prev->first + prev->second.size() > offset) {
+            return nullptr;
+        }
+    }
+    return base->GetPointer(length, offset);
+}
+
+bool PatchedVfsFile::Rename(std::string_view name) {
+    return false;
+}
+
 VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
     if (in == nullptr || ips == nullptr)
         return nullptr;
@@ -73,7 +192,7 @@ VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
     if (type == IPSFileType::Error)
         return nullptr;
 
-    auto in_data = in->ReadAllBytes();
+    const auto out = PatchedVfsFile::Wrap(in);
 
     std::vector<u8> temp(type == IPSFileType::IPS ? 3 : 4);
     u64 offset = 5; // After header
@@ -106,16 +225,14 @@ VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
             if (!data)
                 return nullptr;
 
-            if (real_offset + rle_size > in_data.size())
-                rle_size = static_cast<u16>(in_data.size() - real_offset);
-            std::memset(in_data.data() + real_offset, *data, rle_size);
+            out->AddRecord(real_offset, std::vector<u8>(rle_size, *data));
         } else { // Standard Patch
-            auto read = data_size;
-            if (real_offset + read > in_data.size())
-                read = static_cast<u16>(in_data.size() - real_offset);
-            if (ips->Read(in_data.data() + real_offset, read, offset) != data_size)
+            auto data = ips->ReadBytes(data_size, offset);
+            if (data.size() != data_size)
                 return nullptr;
             offset += data_size;
+
+            out->AddRecord(real_offset, std::move(data));
         }
     }
 
@@ -123,8 +240,7 @@ VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
         return nullptr;
     }
 
-    return std::make_shared<VectorVfsFile>(std::move(in_data), in->GetName(),
-                                           in->GetContainingDirectory());
+    return out;
 }
 
 struct IPSwitchCompiler::IPSwitchPatch {
@@ -313,25 +429,18 @@ VirtualFile IPSwitchCompiler::Apply(const VirtualFile& in) const {
     if (in == nullptr || !valid)
         return nullptr;
 
-    auto in_data = in->ReadAllBytes();
+    const auto out = PatchedVfsFile::Wrap(in);
 
     for (const auto& patch : patches) {
         if (!patch.enabled)
             continue;
 
         for (const auto& record : patch.records) {
-            if (record.first >= in_data.size())
-                continue;
-            auto replace_size = record.second.size();
-            if (record.first + replace_size > in_data.size())
-                replace_size = in_data.size() - record.first;
-            for (std::size_t i = 0; i < replace_size; ++i)
-                in_data[i + record.first] = record.second[i];
+            out->AddRecord(record.first, record.second);
         }
     }
 
-    return std::make_shared<VectorVfsFile>(std::move(in_data), in->GetName(),
-                                           in->GetContainingDirectory());
+    return out;
 }
 
 } // namespace FileSys
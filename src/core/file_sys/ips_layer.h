@@ -5,7 +5,9 @@
 #pragma once
 
 #include <array>
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "common/common_types.h"
@@ -13,6 +15,41 @@
 
 namespace FileSys {
 
+/**
+ * A read-only view of a file with patch records laid over it. The base file is never copied, the
+ * records covering a range are applied on top of the base data in Read. Records never extend the
+ * file, the parts of them past the end of the base are dropped like the IPS formats expect.
+ */
+class PatchedVfsFile : public VfsFile {
+public:
+    explicit PatchedVfsFile(VirtualFile base);
+    ~PatchedVfsFile() override;
+
+    /// Returns a patched view of in, sharing in's records and base file if it is already one.
+    static std::shared_ptr<PatchedVfsFile> Wrap(const VirtualFile& in);
+
+    /// Lays data over the file at offset, replacing any bytes of earlier records it overlaps.
+    void AddRecord(u64 offset, std::vector<u8> data);
+
+    /// Returns the number of disjoint patched ranges.
+    std::size_t GetRecordCount() const;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetPointer(std::size_t length, std::size_t offset) const override;
+    bool Rename(std::string_view name) override;
+
+private:
+    VirtualFile base;
+    std::map<u64, std::vector<u8>> records; ///< Disjoint ranges keyed by their offset
+};
+
 VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips);
 
 class IPSwitchCompiler {
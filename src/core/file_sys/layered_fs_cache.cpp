@@ -0,0 +1,278 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <fmt/format.h>
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/fsmitm_romfsbuild.h"
+#include "core/file_sys/ips_layer.h"
+#include "core/file_sys/layered_fs_cache.h"
+#include "core/file_sys/vfs_concat.h"
+#include "core/file_sys/vfs_layered.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr u32 CacheMagic = Common::MakeMagic('L', 'F', 'S', '0');
+constexpr u32 CacheVersion = 1;
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le key;
+    u64_le header_size;
+    u64_le metadata_offset;
+    u64_le metadata_size;
+    u64_le num_files;
+};
+static_assert(sizeof(CacheHeader) == 0x30, "CacheHeader has incorrect size.");
+
+struct CacheFileRecord {
+    u64_le offset;
+    u64_le size;
+    u32_le path_length;
+    INSERT_PADDING_BYTES(4);
+};
+static_assert(sizeof(CacheFileRecord) == 0x18, "CacheFileRecord has incorrect size.");
+
+struct HostFile {
+    std::string path;
+    u64 size;
+    u64 modification_time;
+};
+
+/// Lists the files under a host directory with paths relative to it, as the RomFS names them
+bool ListHostFiles(const std::string& directory, const std::string& relative_path,
+                   std::vector<HostFile>& out) {
+    return FileUtil::ForeachDirectoryEntry(
+        directory, [&out, &relative_path](const std::string& parent, const std::string& name,
+                                          bool is_directory) {
+            const std::string host_path = parent + DIR_SEP + name;
+            const std::string path = relative_path + '/' + name;
+            if (is_directory) {
+                return ListHostFiles(host_path, path, out);
+            }
+            out.push_back(
+                {path, FileUtil::GetSize(host_path), FileUtil::GetModificationTime(host_path)});
+            return true;
+        });
+}
+
+u64 HashBaseRomFS(const VfsFile& romfs) {
+    // The file table holds the name, offset and size of every file of the image
+    std::vector<u8> data = romfs.ReadBytes(0x50, 0);
+    if (data.size() != 0x50) {
+        return 0;
+    }
+    u64_le file_table_offset;
+    u64_le file_table_size;
+    std::memcpy(&file_table_offset, data.data() + 0x38, sizeof(u64));
+    std::memcpy(&file_table_size, data.data() + 0x40, sizeof(u64));
+    const std::vector<u8> file_table = romfs.ReadBytes(file_table_size, file_table_offset);
+    data.insert(data.end(), file_table.begin(), file_table.end());
+
+    const u64 size = romfs.GetSize();
+    data.insert(data.end(), reinterpret_cast<const u8*>(&size),
+                reinterpret_cast<const u8*>(&size) + sizeof(size));
+    return Common::CityHash64(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+} // Anonymous namespace
+
+LayeredFSCache::LayeredFSCache(std::string path_, const VirtualFile& base_romfs,
+                               std::vector<VirtualDir> layers_, std::vector<VirtualDir> ext_layers_)
+    : path(std::move(path_)), layers(std::move(layers_)), ext_layers(std::move(ext_layers_)) {
+    // Every layer but the base one comes from the host, their files identify the mods
+    std::vector<VirtualDir> mod_layers(layers.begin(), layers.end() - 1);
+    mod_layers.insert(mod_layers.end(), ext_layers.begin(), ext_layers.end());
+
+    std::string fingerprint = fmt::format("{:016X}", HashBaseRomFS(*base_romfs));
+    for (const VirtualDir& layer : mod_layers) {
+        const std::string host_path = layer->GetFullPath();
+        std::vector<HostFile> files;
+        if (host_path.empty() || !FileUtil::IsDirectory(host_path) ||
+            !ListHostFiles(host_path, "", files)) {
+            is_cacheable = false;
+            return;
+        }
+        std::sort(files.begin(), files.end(), [](const HostFile& lhs, const HostFile& rhs) {
+            return lhs.path < rhs.path;
+        });
+
+        fingerprint += fmt::format("|{}", host_path);
+        std::unordered_set<std::string>& paths = layer_files.emplace_back();
+        for (HostFile& file : files) {
+            fingerprint += fmt::format("|{}:{}:{}", file.path, file.size, file.modification_time);
+            paths.insert(std::move(file.path));
+        }
+    }
+    key = Common::CityHash64(fingerprint.data(), fingerprint.size());
+}
+
+LayeredFSCache::~LayeredFSCache() = default;
+
+std::string LayeredFSCache::GetCachePath(u64 title_id, u8 type) {
+    return FileUtil::SanitizePath(fmt::format("{}layeredfs{}{:016X}_{:02X}.bin",
+                                              FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                                              DIR_SEP, title_id, type));
+}
+
+VirtualFile LayeredFSCache::Load() const {
+    if (!is_cacheable || !FileUtil::Exists(path)) {
+        return nullptr;
+    }
+    std::string data;
+    FileUtil::ReadFileToString(false, path, data);
+
+    CacheHeader header{};
+    if (data.size() < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != CacheMagic || header.version != CacheVersion || header.key != key) {
+        LOG_INFO(Loader, "LayeredFS cache {} is outdated, rebuilding it", path);
+        return nullptr;
+    }
+
+    std::size_t position = sizeof(header);
+    const auto read_blob = [&data, &position](std::size_t size) -> std::optional<std::vector<u8>> {
+        if (data.size() - position < size) {
+            return std::nullopt;
+        }
+        std::vector<u8> blob(data.begin() + position, data.begin() + position + size);
+        position += size;
+        return blob;
+    };
+    auto romfs_header = read_blob(header.header_size);
+    auto metadata = read_blob(header.metadata_size);
+    if (!romfs_header || !metadata) {
+        return nullptr;
+    }
+
+    std::map<u64, VirtualFile> files;
+    files.emplace(0, std::make_shared<VectorVfsFile>(std::move(*romfs_header)));
+    files.emplace(header.metadata_offset, std::make_shared<VectorVfsFile>(std::move(*metadata)));
+    for (u64 i = 0; i < header.num_files; ++i) {
+        CacheFileRecord record{};
+        if (data.size() - position < sizeof(record)) {
+            return nullptr;
+        }
+        std::memcpy(&record, data.data() + position, sizeof(record));
+        position += sizeof(record);
+        if (data.size() - position < record.path_length) {
+            return nullptr;
+        }
+        const std::string file_path = data.substr(position, record.path_length);
+        position += record.path_length;
+
+        VirtualFile source = OpenSource(file_path);
+        if (source == nullptr || source->GetSize() != record.size) {
+            LOG_WARNING(Loader, "LayeredFS cache {} doesn't match {}, rebuilding it", path,
+                        file_path);
+            return nullptr;
+        }
+        files.emplace(record.offset, std::move(source));
+    }
+
+    LOG_INFO(Loader, "Loaded LayeredFS image of {} files from the cache", header.num_files);
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(files),
+                                                     layers.front()->GetName());
+}
+
+VirtualFile LayeredFSCache::Build() const {
+    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(layers);
+    if (layered == nullptr) {
+        return nullptr;
+    }
+    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(ext_layers);
+
+    RomFSBuildContext context{layered, layered_ext};
+    std::map<u64, VirtualFile> files = context.Build();
+    if (!is_cacheable) {
+        return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(files), layered->GetName());
+    }
+
+    // The header comes first and the tables last, everything in between is a file of the layers
+    const auto metadata = std::prev(files.end());
+    std::vector<u8> header_data = files.begin()->second->ReadAllBytes();
+    std::vector<u8> metadata_data = metadata->second->ReadAllBytes();
+    const std::map<u64, std::string> paths = context.GetFilePaths();
+
+    const std::string directory = path.substr(0, path.find_last_of(DIR_SEP_CHR));
+    FileUtil::IOFile file;
+    if (FileUtil::CreateFullPath(directory + DIR_SEP)) {
+        file.Open(path, "wb");
+    }
+    CacheHeader header{};
+    header.magic = CacheMagic;
+    header.version = CacheVersion;
+    header.key = key;
+    header.header_size = header_data.size();
+    header.metadata_offset = metadata->first;
+    header.metadata_size = metadata_data.size();
+    header.num_files = files.size() - 2;
+    bool success = file.IsOpen() && file.WriteObject(header) == 1 &&
+                   file.WriteBytes(header_data.data(), header_data.size()) == header_data.size() &&
+                   file.WriteBytes(metadata_data.data(), metadata_data.size()) ==
+                       metadata_data.size();
+    for (auto it = std::next(files.begin()); success && it != metadata; ++it) {
+        const std::string& file_path = paths.at(it->first);
+        CacheFileRecord record{};
+        record.offset = it->first;
+        record.size = it->second->GetSize();
+        record.path_length = static_cast<u32>(file_path.size());
+        success = file.WriteObject(record) == 1 &&
+                  file.WriteString(file_path) == file_path.size();
+    }
+    if (!success) {
+        LOG_ERROR(Loader, "Failed to write LayeredFS cache {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+    }
+
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(files), layered->GetName());
+}
+
+VirtualFile LayeredFSCache::OpenSource(const std::string& file_path) const {
+    VirtualFile source;
+    for (std::size_t i = 0; i + 1 < layers.size(); ++i) {
+        if (layer_files[i].count(file_path) != 0) {
+            source = layers[i]->GetFileRelative(file_path);
+            break;
+        }
+    }
+    if (source == nullptr) {
+        source = layers.back()->GetFileRelative(file_path);
+    }
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    const std::string ips_path = file_path + ".ips";
+    for (std::size_t i = 0; i < ext_layers.size(); ++i) {
+        if (layer_files[layers.size() - 1 + i].count(ips_path) != 0) {
+            auto patched = PatchIPS(source, ext_layers[i]->GetFileRelative(ips_path));
+            if (patched != nullptr) {
+                source = std::move(patched);
+            }
+            break;
+        }
+    }
+    return source;
+}
+
+} // namespace FileSys
@@ -0,0 +1,57 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+/**
+ * Stores the metadata of the RomFS images LayeredFS builds from mods, so modded titles don't walk
+ * the base RomFS and the mods on every boot. A cached image is only used while the base RomFS,
+ * the set of enabled mods and the size and modification time of every file of the mods match
+ * the ones it was built from, anything else rebuilds it.
+ */
+class LayeredFSCache {
+public:
+    /**
+     * @param path Path of the cache file of this title and content type
+     * @param base_romfs RomFS image the mods are applied to
+     * @param layers romfs directories of the mods by priority, followed by the base RomFS
+     * @param ext_layers romfs_ext directories of the mods by priority
+     */
+    LayeredFSCache(std::string path, const VirtualFile& base_romfs, std::vector<VirtualDir> layers,
+                   std::vector<VirtualDir> ext_layers);
+    ~LayeredFSCache();
+
+    /// Returns the path of the cache file of a title and content type.
+    static std::string GetCachePath(u64 title_id, u8 type);
+
+    /// Returns the image stored by a previous Build, or nullptr when it's missing or outdated.
+    VirtualFile Load() const;
+
+    /// Builds the image from the layers and stores its metadata when the mods are on the host.
+    VirtualFile Build() const;
+
+private:
+    /// Returns the file an image built from the layers has at path, with its IPS patch applied.
+    VirtualFile OpenSource(const std::string& path) const;
+
+    std::string path;
+    std::vector<VirtualDir> layers;
+    std::vector<VirtualDir> ext_layers;
+
+    /// Relative paths of the files of each mod layer, ext layers follow the romfs ones
+    std::vector<std::unordered_set<std::string>> layer_files;
+
+    bool is_cacheable = true;
+    u64 key = 0;
+};
+
+} // namespace FileSys
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstring>
+#include <limits>
 
 #include "common/assert.h"
 #include "core/crypto/aes_util.h"
@@ -12,6 +13,60 @@
 
 namespace FileSys {
 
+namespace {
+
+using EntryPosition = std::pair<std::size_t, std::size_t>;
+
+/// Returns the position following an entry. The last entry is followed by the end marker of the
+/// last bucket.
+template <typename BucketType>
+EntryPosition NextPosition(const std::vector<BucketType>& buckets, EntryPosition position) {
+    if (position.second + 1 < buckets[position.first].number_entries ||
+        position.first + 1 == buckets.size()) {
+        return {position.first, position.second + 1};
+    }
+    return {position.first + 1, 0};
+}
+
+/// Returns true when the position holds an entry rather than an end marker.
+template <typename BucketType>
+bool IsEntry(const std::vector<BucketType>& buckets, EntryPosition position) {
+    return position.first < buckets.size() &&
+           position.second < buckets[position.first].number_entries;
+}
+
+/// Returns the offset an entry ends at, where the entry or end marker following it starts.
+template <typename BucketType>
+u64 GetEntryEnd(const std::vector<BucketType>& buckets, EntryPosition position) {
+    return buckets[position.first].entries[position.second + 1].address_patch;
+}
+
+u64 PackPosition(EntryPosition position) {
+    return static_cast<u64>(position.first) << 32 | static_cast<u64>(position.second);
+}
+
+EntryPosition UnpackPosition(u64 packed) {
+    return {static_cast<std::size_t>(packed >> 32), static_cast<std::size_t>(packed & 0xFFFFFFFF)};
+}
+
+std::vector<u8> MakeIV(const std::array<u8, 8>& section_ctr, u32 subsection_ctr, u64 offset) {
+    std::vector<u8> iv(16);
+    for (std::size_t i = 0; i < section_ctr.size(); ++i)
+        iv[i] = section_ctr[0x8 - i - 1];
+    offset >>= 4;
+    for (std::size_t i = 0; i < sizeof(u64); ++i) {
+        iv[0xF - i] = static_cast<u8>(offset & 0xFF);
+        offset >>= 8;
+    }
+    for (std::size_t i = 0; i < sizeof(u32); ++i) {
+        iv[0x7 - i] = static_cast<u8>(subsection_ctr & 0xFF);
+        subsection_ctr >>= 8;
+    }
+    return iv;
+}
+
+} // Anonymous namespace
+
 BKTR::BKTR(VirtualFile base_romfs_, VirtualFile bktr_romfs_, RelocationBlock relocation_,
            std::vector<RelocationBucket> relocation_buckets_, SubsectionBlock subsection_,
            std::vector<SubsectionBucket> subsection_buckets_, bool is_encrypted_,
@@ -27,12 +82,15 @@ BKTR::BKTR(VirtualFile base_romfs_, VirtualFile bktr_romfs_, RelocationBlock rel
     }
 
     for (std::size_t i = 0; i < subsection.number_buckets - 1; ++i) {
-        subsection_buckets[i].entries.push_back({subsection_buckets[i + 1].entries[0].address_patch,
-                                                 {0},
-                                                 subsection_buckets[i + 1].entries[0].ctr});
+        const auto& next_entry = subsection_buckets[i + 1].entries[0];
+        subsection_buckets[i].entries.push_back({next_entry.address_patch, {0}, next_entry.ctr});
     }
 
     relocation_buckets.back().entries.push_back({relocation.size, 0, 0});
+    // Data past the last subsection keeps its counter
+    auto& last_subsection = subsection_buckets.back();
+    last_subsection.entries.push_back(
+        {subsection.size, {0}, last_subsection.entries[last_subsection.number_entries - 1].ctr});
 }
 
 BKTR::~BKTR() = default;
@@ -41,138 +99,153 @@ std::size_t BKTR::Read(u8* data, std::size_t length, std::size_t offset) const {
     // Read out of bounds.
     if (offset >= relocation.size)
         return 0;
-    const auto relocation = GetRelocationEntry(offset);
-    const auto section_offset = offset - relocation.address_patch + relocation.address_source;
-    const auto bktr_read = relocation.from_patch;
-
-    const auto next_relocation = GetNextRelocationEntry(offset);
-
-    if (offset + length > next_relocation.address_patch) {
-        const u64 partition = next_relocation.address_patch - offset;
-        return Read(data, partition, offset) +
-               Read(data + partition, length - partition, offset + partition);
-    }
-
-    if (!bktr_read) {
-        ASSERT_MSG(section_offset >= ivfc_offset, "Offset calculation negative.");
-        return base_romfs->Read(data, length, section_offset - ivfc_offset);
+    length = static_cast<std::size_t>(std::min<u64>(length, relocation.size - offset));
+
+    std::size_t total_read = 0;
+    EntryPosition position =
+        FindEntry<false>(offset, relocation, relocation_buckets, relocation_cursor);
+    while (total_read < length) {
+        const u64 patch_offset = offset + total_read;
+        const RelocationEntry& entry = relocation_buckets[position.first].entries[position.second];
+        const u64 entry_patch = entry.address_patch;
+        const u64 entry_source = entry.address_source;
+
+        // Following entries that map the same source contiguously are read at once
+        EntryPosition last = position;
+        EntryPosition next = NextPosition(relocation_buckets, last);
+        u64 end = GetEntryEnd(relocation_buckets, last);
+        while (end < offset + length && IsEntry(relocation_buckets, next)) {
+            const RelocationEntry& next_entry = relocation_buckets[next.first].entries[next.second];
+            const u64 next_delta = next_entry.address_source - entry_source;
+            if (next_entry.from_patch != entry.from_patch ||
+                next_delta != next_entry.address_patch - entry_patch) {
+                break;
+            }
+            last = next;
+            next = NextPosition(relocation_buckets, last);
+            end = GetEntryEnd(relocation_buckets, last);
+        }
+        relocation_cursor.store(PackPosition(last), std::memory_order_relaxed);
+
+        const auto chunk =
+            static_cast<std::size_t>(std::min<u64>(length - total_read, end - patch_offset));
+        const u64 section_offset = patch_offset - entry_patch + entry_source;
+        std::size_t read;
+        if (entry.from_patch == 0) {
+            ASSERT_MSG(section_offset >= ivfc_offset, "Offset calculation negative.");
+            read = base_romfs->Read(data + total_read, chunk, section_offset - ivfc_offset);
+        } else {
+            read = ReadPatch(data + total_read, chunk, section_offset);
+        }
+        total_read += read;
+        if (read != chunk) {
+            break;
+        }
+        position = next;
     }
+    return total_read;
+}
 
+std::size_t BKTR::ReadPatch(u8* data, std::size_t length, u64 section_offset) const {
     if (!encrypted) {
         return bktr_romfs->Read(data, length, section_offset);
     }
 
-    const auto subsection = GetSubsectionEntry(section_offset);
-    Core::Crypto::AESCipher<Core::Crypto::Key128> cipher(key, Core::Crypto::Mode::CTR);
-
-    // Calculate AES IV
-    std::vector<u8> iv(16);
-    auto subsection_ctr = subsection.ctr;
-    auto offset_iv = section_offset + base_offset;
-    for (std::size_t i = 0; i < section_ctr.size(); ++i)
-        iv[i] = section_ctr[0x8 - i - 1];
-    offset_iv >>= 4;
-    for (std::size_t i = 0; i < sizeof(u64); ++i) {
-        iv[0xF - i] = static_cast<u8>(offset_iv & 0xFF);
-        offset_iv >>= 8;
-    }
-    for (std::size_t i = 0; i < sizeof(u32); ++i) {
-        iv[0x7 - i] = static_cast<u8>(subsection_ctr & 0xFF);
-        subsection_ctr >>= 8;
+    // The key stream is generated per 16-byte block, a read starting within one decrypts it whole
+    std::size_t total_read = 0;
+    const u64 block_offset = section_offset & 0xF;
+    if (block_offset != 0) {
+        std::array<u8, 0x10> block{};
+        const u64 block_start = section_offset - block_offset;
+        const std::size_t block_read = bktr_romfs->Read(block.data(), block.size(), block_start);
+        if (block_read <= block_offset) {
+            return 0;
+        }
+        DecryptPatch(block.data(), block_read, block_start);
+        total_read = std::min<std::size_t>(length, block_read - block_offset);
+        std::memcpy(data, block.data() + block_offset, total_read);
+        if (total_read == length || block_read != block.size()) {
+            return total_read;
+        }
     }
-    cipher.SetIV(iv);
 
-    const auto next_subsection = GetNextSubsectionEntry(section_offset);
+    const std::size_t raw_read =
+        bktr_romfs->Read(data + total_read, length - total_read, section_offset + total_read);
+    DecryptPatch(data + total_read, raw_read, section_offset + total_read);
+    return total_read + raw_read;
+}
 
-    if (section_offset + length > next_subsection.address_patch) {
-        const u64 partition = next_subsection.address_patch - section_offset;
-        return Read(data, partition, offset) +
-               Read(data + partition, length - partition, offset + partition);
-    }
+void BKTR::DecryptPatch(u8* data, std::size_t length, u64 section_offset) const {
+    Core::Crypto::AESCipher<Core::Crypto::Key128> cipher(key, Core::Crypto::Mode::CTR);
 
-    const auto block_offset = section_offset & 0xF;
-    if (block_offset != 0) {
-        auto block = bktr_romfs->ReadBytes(0x10, section_offset & ~0xF);
-        cipher.Transcode(block.data(), block.size(), block.data(), Core::Crypto::Op::Decrypt);
-        if (length + block_offset < 0x10) {
-            std::memcpy(data, block.data() + block_offset, std::min(length, block.size()));
-            return std::min(length, block.size());
+    std::size_t done = 0;
+    EntryPosition position =
+        FindEntry<true>(section_offset, subsection, subsection_buckets, subsection_cursor);
+    while (done < length) {
+        const u64 offset = section_offset + done;
+        const u32 ctr = subsection_buckets[position.first].entries[position.second].ctr;
+
+        // Following subsections with the same counter continue the same key stream
+        EntryPosition last = position;
+        EntryPosition next = NextPosition(subsection_buckets, last);
+        u64 end = IsEntry(subsection_buckets, last) ? GetEntryEnd(subsection_buckets, last)
+                                                    : std::numeric_limits<u64>::max();
+        while (end < section_offset + length && IsEntry(subsection_buckets, next) &&
+               subsection_buckets[next.first].entries[next.second].ctr == ctr) {
+            last = next;
+            next = NextPosition(subsection_buckets, last);
+            end = GetEntryEnd(subsection_buckets, last);
         }
+        subsection_cursor.store(PackPosition(last), std::memory_order_relaxed);
 
-        const auto read = 0x10 - block_offset;
-        std::memcpy(data, block.data() + block_offset, read);
-        return read + Read(data + read, length - read, offset + read);
+        const auto chunk = static_cast<std::size_t>(std::min<u64>(length - done, end - offset));
+        cipher.SetIV(MakeIV(section_ctr, ctr, offset + base_offset));
+        cipher.Transcode(data + done, chunk, data + done, Core::Crypto::Op::Decrypt);
+        done += chunk;
+        position = next;
     }
-
-    const auto raw_read = bktr_romfs->Read(data, length, section_offset);
-    cipher.Transcode(data, raw_read, data, Core::Crypto::Op::Decrypt);
-    return raw_read;
 }
 
 template <bool Subsection, typename BlockType, typename BucketType>
-std::pair<std::size_t, std::size_t> BKTR::SearchBucketEntry(u64 offset, BlockType block,
-                                                            BucketType buckets) const {
+BKTR::EntryPosition BKTR::SearchBucketEntry(u64 offset, const BlockType& block,
+                                            const BucketType& buckets) const {
     if constexpr (Subsection) {
-        const auto last_bucket = buckets[block.number_buckets - 1];
+        const auto& last_bucket = buckets[block.number_buckets - 1];
         if (offset >= last_bucket.entries[last_bucket.number_entries].address_patch)
             return {block.number_buckets - 1, last_bucket.number_entries};
     } else {
         ASSERT_MSG(offset <= block.size, "Offset is out of bounds in BKTR relocation block.");
     }
 
-    std::size_t bucket_id = std::count_if(
-        block.base_offsets.begin() + 1, block.base_offsets.begin() + block.number_buckets,
-        [&offset](u64 base_offset) { return base_offset <= offset; });
-
-    const auto bucket = buckets[bucket_id];
-
-    if (bucket.number_entries == 1)
-        return {bucket_id, 0};
-
-    std::size_t low = 0;
-    std::size_t mid = 0;
-    std::size_t high = bucket.number_entries - 1;
-    while (low <= high) {
-        mid = (low + high) / 2;
-        if (bucket.entries[mid].address_patch > offset) {
-            high = mid - 1;
-        } else {
-            if (mid == bucket.number_entries - 1 ||
-                bucket.entries[mid + 1].address_patch > offset) {
-                return {bucket_id, mid};
-            }
+    // Both the bucket base offsets and the entries within a bucket are sorted
+    const auto base_offsets_begin = block.base_offsets.begin() + 1;
+    const auto base_offsets_end = block.base_offsets.begin() + block.number_buckets;
+    const auto bucket_id = static_cast<std::size_t>(
+        std::upper_bound(base_offsets_begin, base_offsets_end, offset) - base_offsets_begin);
+
+    const auto& bucket = buckets[bucket_id];
+    const auto entries_begin = bucket.entries.begin();
+    const auto it = std::upper_bound(
+        entries_begin, entries_begin + bucket.number_entries, offset,
+        [](u64 value, const auto& entry) { return value < entry.address_patch; });
+    ASSERT_MSG(it != entries_begin || bucket.number_entries == 1,
+               "Offset could not be found in BKTR block.");
+    return {bucket_id, it == entries_begin ? 0 : static_cast<std::size_t>(it - entries_begin - 1)};
+}
 
-            low = mid + 1;
+template <bool Subsection, typename BlockType, typename BucketType>
+BKTR::EntryPosition BKTR::FindEntry(u64 offset, const BlockType& block, const BucketType& buckets,
+                                    std::atomic<u64>& cursor) const {
+    // Sequential reads stay in the entry the last read ended in, or continue in the next one
+    EntryPosition position = UnpackPosition(cursor.load(std::memory_order_relaxed));
+    for (int i = 0; i < 2 && IsEntry(buckets, position); ++i) {
+        if (buckets[position.first].entries[position.second].address_patch <= offset &&
+            offset < GetEntryEnd(buckets, position)) {
+            return position;
         }
+        position = NextPosition(buckets, position);
     }
-
-    UNREACHABLE_MSG("Offset could not be found in BKTR block.");
-}
-
-RelocationEntry BKTR::GetRelocationEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<false>(offset, relocation, relocation_buckets);
-    return relocation_buckets[res.first].entries[res.second];
-}
-
-RelocationEntry BKTR::GetNextRelocationEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<false>(offset, relocation, relocation_buckets);
-    const auto bucket = relocation_buckets[res.first];
-    if (res.second + 1 < bucket.entries.size())
-        return bucket.entries[res.second + 1];
-    return relocation_buckets[res.first + 1].entries[0];
-}
-
-SubsectionEntry BKTR::GetSubsectionEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<true>(offset, subsection, subsection_buckets);
-    return subsection_buckets[res.first].entries[res.second];
-}
-
-SubsectionEntry BKTR::GetNextSubsectionEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<true>(offset, subsection, subsection_buckets);
-    const auto bucket = subsection_buckets[res.first];
-    if (res.second + 1 < bucket.entries.size())
-        return bucket.entries[res.second + 1];
-    return subsection_buckets[res.first + 1].entries[0];
+    return SearchBucketEntry<Subsection>(offset, block, buckets);
 }
 
 std::string BKTR::GetName() const {
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "common/common_funcs.h"
@@ -117,15 +119,23 @@ public:
     bool Rename(std::string_view name) override;
 
 private:
+    /// Bucket and index of an entry in a relocation or subsection block.
+    using EntryPosition = std::pair<std::size_t, std::size_t>;
+
+    template <bool Subsection, typename BlockType, typename BucketType>
+    EntryPosition SearchBucketEntry(u64 offset, const BlockType& block,
+                                    const BucketType& buckets) const;
+
+    /// Finds the entry holding an offset, starting from the one the previous read ended in.
     template <bool Subsection, typename BlockType, typename BucketType>
-    std::pair<std::size_t, std::size_t> SearchBucketEntry(u64 offset, BlockType block,
-                                                          BucketType buckets) const;
+    EntryPosition FindEntry(u64 offset, const BlockType& block, const BucketType& buckets,
+                            std::atomic<u64>& cursor) const;
 
-    RelocationEntry GetRelocationEntry(u64 offset) const;
-    RelocationEntry GetNextRelocationEntry(u64 offset) const;
+    /// Reads from the patch data, decrypting it when needed.
+    std::size_t ReadPatch(u8* data, std::size_t length, u64 section_offset) const;
 
-    SubsectionEntry GetSubsectionEntry(u64 offset) const;
-    SubsectionEntry GetNextSubsectionEntry(u64 offset) const;
+    /// Decrypts patch data read from a 16-byte aligned offset.
+    void DecryptPatch(u8* data, std::size_t length, u64 section_offset) const;
 
     RelocationBlock relocation;
     std::vector<RelocationBucket> relocation_buckets;
@@ -145,6 +155,10 @@ private:
     // Distance between IVFC start and RomFS start, used for base reads
     u64 ivfc_offset;
     std::array<u8, 8> section_ctr;
+
+    // Entries the last read ended in, reads are mostly sequential.
+    mutable std::atomic<u64> relocation_cursor{};
+    mutable std::atomic<u64> subsection_cursor{};
 };
 
 } // namespace FileSys
@@ -46,13 +46,16 @@ PartitionFilesystem::PartitionFilesystem(std::shared_ptr<VfsFile> file) {
     std::size_t metadata_size =
         sizeof(Header) + (pfs_header.num_entries * entry_size) + pfs_header.strtab_size;
 
-    // Actually read in now...
-    std::vector<u8> file_data = file->ReadBytes(metadata_size);
-    const std::size_t total_size = file_data.size();
-
-    if (total_size != metadata_size) {
-        status = Loader::ResultStatus::ErrorIncorrectPFSFileSize;
-        return;
+    // Parse the metadata in place when the file is in memory, read it in otherwise
+    std::vector<u8> file_buffer;
+    const u8* file_data = file->GetPointer(metadata_size);
+    if (file_data == nullptr) {
+        file_buffer = file->ReadBytes(metadata_size);
+        if (file_buffer.size() != metadata_size) {
+            status = Loader::ResultStatus::ErrorIncorrectPFSFileSize;
+            return;
+        }
+        file_data = file_buffer.data();
     }
 
     std::size_t entries_offset = sizeof(Header);
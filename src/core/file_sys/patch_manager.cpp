@@ -14,6 +14,7 @@
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/ips_layer.h"
+#include "core/file_sys/layered_fs_cache.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs.h"
@@ -202,23 +203,25 @@ std::vector<u8> PatchManager::PatchNSO(const std::vector<u8>& nso, const std::st
               [](const VirtualDir& l, const VirtualDir& r) { return l->GetName() < r->GetName(); });
     const auto patches = CollectPatches(patch_dirs, build_id);
 
-    auto out = nso;
+    // The patches only collect records over the NSO, it is copied once after all of them
+    VirtualFile out_file = std::make_shared<VectorVfsFile>(nso);
     for (const auto& patch_file : patches) {
         if (patch_file->GetExtension() == "ips") {
             LOG_INFO(Loader, "    - Applying IPS patch from mod \"{}\"",
                      patch_file->GetContainingDirectory()->GetParentDirectory()->GetName());
-            const auto patched = PatchIPS(std::make_shared<VectorVfsFile>(out), patch_file);
+            auto patched = PatchIPS(out_file, patch_file);
             if (patched != nullptr)
-                out = patched->ReadAllBytes();
+                out_file = std::move(patched);
         } else if (patch_file->GetExtension() == "pchtxt") {
             LOG_INFO(Loader, "    - Applying IPSwitch patch from mod \"{}\"",
                      patch_file->GetContainingDirectory()->GetParentDirectory()->GetName());
             const IPSwitchCompiler compiler{patch_file};
-            const auto patched = compiler.Apply(std::make_shared<VectorVfsFile>(out));
+            auto patched = compiler.Apply(out_file);
             if (patched != nullptr)
-                out = patched->ReadAllBytes();
+                out_file = std::move(patched);
         }
     }
+    auto out = out_file->ReadAllBytes();
 
     if (out.size() < sizeof(Loader::NSOHeader)) {
         return nso;
@@ -344,14 +347,12 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
     }
     layers.push_back(std::move(extracted));
 
-    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
-    if (layered == nullptr) {
-        return;
+    const LayeredFSCache cache(LayeredFSCache::GetCachePath(title_id, static_cast<u8>(type)),
+                               romfs, std::move(layers), std::move(layers_ext));
+    auto packed = cache.Load();
+    if (packed == nullptr) {
+        packed = cache.Build();
     }
-
-    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
-
-    auto packed = CreateRomFS(std::move(layered), std::move(layered_ext));
     if (packed == nullptr) {
         return;
     }
@@ -3,20 +3,27 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
 #include <random>
 #include <regex>
 #include <mbedtls/sha256.h>
 #include "common/assert.h"
+#include "common/common_funcs.h"
 #include "common/file_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
+#include "common/swap.h"
 #include "core/crypto/key_manager.h"
+#include "core/crypto/sha_util.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/submission_package.h"
 #include "core/file_sys/vfs_concat.h"
+#include "core/file_sys/vfs_vector.h"
 #include "core/loader/loader.h"
 
 namespace FileSys {
@@ -24,6 +31,27 @@ namespace FileSys {
 // The size of blocks to use when vfs raw copying into nand.
 constexpr size_t VFS_RC_LARGE_COPY_BLOCK = 0x400000;
 
+// The index of the NCAs in a registered directory, see RegisteredCache::IndexEntry.
+constexpr char INDEX_FILE_NAME[] = "yuzu_index";
+constexpr u32 INDEX_MAGIC = Common::MakeMagic('R', 'C', 'I', '0');
+constexpr u32 INDEX_VERSION = 1;
+
+struct IndexHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le num_entries;
+};
+static_assert(sizeof(IndexHeader) == 0x10, "IndexHeader has incorrect size.");
+
+struct IndexEntryHeader {
+    NcaID nca_id;
+    u64_le size;
+    u64_le title_id;
+    u32_le is_meta;
+    u32_le cnmt_size;
+};
+static_assert(sizeof(IndexEntryHeader) == 0x28, "IndexEntryHeader has incorrect size.");
+
 std::string ContentProviderEntry::DebugInfo() const {
     return fmt::format("title_id={:016X}, content_type={:02X}", title_id, static_cast<u8>(type));
 }
@@ -199,7 +227,7 @@ bool PlaceholderCache::Register(RegisteredCache* cache, const NcaID& placeholder
     if (file == nullptr)
         return false;
 
-    const auto res = cache->RawInstallNCA(NCA{file}, &VfsRawCopy, false, install);
+    const auto res = cache->RawInstallNCA(NCA{file}, {}, false, install);
 
     if (res != InstallResult::Success)
         return false;
@@ -403,27 +431,123 @@ std::vector<NcaID> RegisteredCache::AccumulateFiles() const {
 }
 
 void RegisteredCache::ProcessFiles(const std::vector<NcaID>& ids) {
+    std::map<NcaID, IndexEntry> new_index;
+    bool index_changed = false;
+
     for (const auto& id : ids) {
         const auto file = GetFileAtID(id);
 
         if (file == nullptr)
             continue;
-        const auto nca = std::make_shared<NCA>(parser(file, id), nullptr, 0, keys);
-        if (nca->GetStatus() != Loader::ResultStatus::Success ||
-            nca->GetType() != NCAContentType::Meta) {
-            continue;
+
+        // NcaIDs are hashes of the contents, an NCA of the same size under the same ID is the same
+        const auto cached = index.find(id);
+        std::optional<IndexEntry> entry;
+        if (cached != index.end() && cached->second.size == file->GetSize()) {
+            entry = std::move(cached->second);
+        } else {
+            entry = ParseIndexEntry(file, id);
+            if (!entry)
+                continue;
+            index_changed = true;
         }
 
-        const auto section0 = nca->GetSubdirectories()[0];
+        if (entry->is_meta) {
+            meta.insert_or_assign(entry->title_id,
+                                  CNMT(std::make_shared<VectorVfsFile>(entry->cnmt)));
+            meta_id.insert_or_assign(entry->title_id, id);
+        }
 
-        for (const auto& section0_file : section0->GetFiles()) {
-            if (section0_file->GetExtension() != "cnmt")
-                continue;
+        new_index.insert_or_assign(id, std::move(*entry));
+    }
+
+    // Entries for NCAs that were removed also have to go
+    index_changed |= new_index.size() != index.size();
+    index = std::move(new_index);
+    if (index_changed)
+        SaveIndex();
+}
+
+std::optional<RegisteredCache::IndexEntry> RegisteredCache::ParseIndexEntry(
+    const VirtualFile& file, const NcaID& id) const {
+    const NCA nca(parser(file, id), nullptr, 0, keys);
+
+    // Updates can't find their base here, but their header is still good enough to be indexed.
+    // Anything else that fails to parse (e.g. missing keys) is retried on the next refresh.
+    if (nca.GetStatus() == Loader::ResultStatus::ErrorMissingBKTRBaseRomFS)
+        return IndexEntry{file->GetSize(), nca.GetTitleId(), false, {}};
+    if (nca.GetStatus() != Loader::ResultStatus::Success)
+        return {};
+
+    IndexEntry entry{file->GetSize(), nca.GetTitleId(), false, {}};
+    if (nca.GetType() != NCAContentType::Meta)
+        return entry;
+
+    const auto section0 = nca.GetSubdirectories()[0];
+    for (const auto& section0_file : section0->GetFiles()) {
+        if (section0_file->GetExtension() != "cnmt")
+            continue;
+
+        entry.is_meta = true;
+        entry.cnmt = section0_file->ReadAllBytes();
+        break;
+    }
+
+    return entry;
+}
+
+void RegisteredCache::LoadIndex() {
+    index.clear();
+
+    const auto file = dir->GetFile(INDEX_FILE_NAME);
+    if (file == nullptr)
+        return;
+
+    IndexHeader header{};
+    if (file->ReadObject(&header) != sizeof(IndexHeader) || header.magic != INDEX_MAGIC ||
+        header.version != INDEX_VERSION) {
+        return;
+    }
 
-            meta.insert_or_assign(nca->GetTitleId(), CNMT(section0_file));
-            meta_id.insert_or_assign(nca->GetTitleId(), id);
+    std::size_t offset = sizeof(IndexHeader);
+    for (u64 i = 0; i < header.num_entries; ++i) {
+        IndexEntryHeader entry_header{};
+        if (file->ReadObject(&entry_header, offset) != sizeof(IndexEntryHeader))
             break;
-        }
+        offset += sizeof(IndexEntryHeader);
+
+        auto cnmt = file->ReadBytes(entry_header.cnmt_size, offset);
+        if (cnmt.size() != entry_header.cnmt_size)
+            break;
+        offset += cnmt.size();
+
+        index.insert_or_assign(entry_header.nca_id,
+                               IndexEntry{entry_header.size, entry_header.title_id,
+                                          entry_header.is_meta != 0, std::move(cnmt)});
+    }
+
+    LOG_DEBUG(Loader, "Loaded {} entries from the index of the registered cache", index.size());
+}
+
+void RegisteredCache::SaveIndex() const {
+    std::vector<u8> out(sizeof(IndexHeader));
+    const IndexHeader header{INDEX_MAGIC, INDEX_VERSION, index.size()};
+    std::memcpy(out.data(), &header, sizeof(IndexHeader));
+
+    for (const auto& [id, entry] : index) {
+        const IndexEntryHeader entry_header{id, entry.size, entry.title_id, entry.is_meta,
+                                            static_cast<u32>(entry.cnmt.size())};
+        const auto entry_offset = out.size();
+        out.resize(entry_offset + sizeof(IndexEntryHeader));
+        std::memcpy(out.data() + entry_offset, &entry_header, sizeof(IndexEntryHeader));
+        out.insert(out.end(), entry.cnmt.begin(), entry.cnmt.end());
+    }
+
+    auto file = dir->GetFile(INDEX_FILE_NAME);
+    if (file == nullptr)
+        file = dir->CreateFile(INDEX_FILE_NAME);
+    if (file == nullptr || !file->Resize(out.size()) || file->WriteBytes(out) != out.size()) {
+        LOG_WARNING(Loader, "Failed to write the index of the registered cache");
     }
 }
 
@@ -451,6 +575,8 @@ void RegisteredCache::Refresh() {
 
 RegisteredCache::RegisteredCache(VirtualDir dir_, ContentProviderParsingFunction parsing_function)
     : dir(std::move(dir_)), parser(std::move(parsing_function)) {
+    if (dir != nullptr)
+        LoadIndex();
     Refresh();
 }
 
@@ -542,13 +668,67 @@ static std::shared_ptr<NCA> GetNCAFromNSPForID(const NSP& nsp, const NcaID& id)
     return std::make_shared<NCA>(std::move(file));
 }
 
+// Copies the file in blocks, reading the next block on another thread while the current one is
+// hashed and written.
+static bool CopyAndHash(const VirtualFile& in, const VirtualFile& out,
+                        const InstallProgressCallback& progress,
+                        Core::Crypto::SHA256Hash& hash) {
+    const std::size_t size = in->GetSize();
+    if (!out->Resize(size))
+        return false;
+
+    const std::size_t block_size = std::min(VFS_RC_LARGE_COPY_BLOCK, size);
+    std::array<std::vector<u8>, 2> buffers{std::vector<u8>(block_size),
+                                           std::vector<u8>(block_size)};
+    const auto read_block = [&in, size, block_size](std::vector<u8>& buffer, std::size_t offset) {
+        const std::size_t length = std::min(block_size, size - offset);
+        return in->Read(buffer.data(), length, offset) == length;
+    };
+
+    Core::Crypto::SHA256Context context;
+    const auto start = std::chrono::steady_clock::now();
+    bool read_success = size == 0 || read_block(buffers[0], 0);
+    for (std::size_t offset = 0, index = 0; offset < size; offset += block_size, index ^= 1) {
+        if (!read_success)
+            return false;
+
+        const std::size_t length = std::min(block_size, size - offset);
+        const std::size_t next_offset = offset + length;
+        std::future<bool> next_read;
+        if (next_offset < size) {
+            next_read = std::async(std::launch::async, read_block, std::ref(buffers[index ^ 1]),
+                                   next_offset);
+        }
+
+        context.Update(buffers[index].data(), length);
+        const bool write_success = out->Write(buffers[index].data(), length, offset) == length;
+        read_success = !next_read.valid() || next_read.get();
+        if (!write_success)
+            return false;
+
+        if (progress) {
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (!progress(in, next_offset, next_offset / elapsed.count()))
+                return false;
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double size_mib = static_cast<double>(size) / 0x100000;
+    LOG_INFO(Loader, "Copied {} ({:.1f} MiB) at {:.1f} MiB/s", in->GetName(), size_mib,
+             size_mib / elapsed.count());
+
+    hash = context.Finish();
+    return true;
+}
+
 InstallResult RegisteredCache::InstallEntry(const XCI& xci, bool overwrite_if_exists,
-                                            const VfsCopyFunction& copy) {
-    return InstallEntry(*xci.GetSecurePartitionNSP(), overwrite_if_exists, copy);
+                                            const InstallProgressCallback& progress) {
+    return InstallEntry(*xci.GetSecurePartitionNSP(), overwrite_if_exists, progress);
 }
 
 InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_exists,
-                                            const VfsCopyFunction& copy) {
+                                            const InstallProgressCallback& progress) {
     const auto ncas = nsp.GetNCAsCollapsed();
     const auto meta_iter = std::find_if(ncas.begin(), ncas.end(), [](const auto& nca) {
         return nca->GetType() == NCAContentType::Meta;
@@ -564,7 +744,7 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
     const auto meta_id_raw = (*meta_iter)->GetName().substr(0, 32);
     const auto meta_id = Common::HexStringToArray<16>(meta_id_raw);
 
-    const auto res = RawInstallNCA(**meta_iter, copy, overwrite_if_exists, meta_id);
+    const auto res = RawInstallNCA(**meta_iter, progress, overwrite_if_exists, meta_id, true);
     if (res != InstallResult::Success)
         return res;
 
@@ -579,7 +759,7 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
         const auto nca = GetNCAFromNSPForID(nsp, record.nca_id);
         if (nca == nullptr)
             return InstallResult::ErrorCopyFailed;
-        const auto res2 = RawInstallNCA(*nca, copy, overwrite_if_exists, record.nca_id);
+        const auto res2 = RawInstallNCA(*nca, progress, overwrite_if_exists, record.nca_id, true);
         if (res2 != InstallResult::Success)
             return res2;
     }
@@ -589,7 +769,8 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
 }
 
 InstallResult RegisteredCache::InstallEntry(const NCA& nca, TitleType type,
-                                            bool overwrite_if_exists, const VfsCopyFunction& copy) {
+                                            bool overwrite_if_exists,
+                                            const InstallProgressCallback& progress) {
     CNMTHeader header{
         nca.GetTitleId(), ///< Title ID
         0,                ///< Ignore/Default title version
@@ -608,12 +789,13 @@ InstallResult RegisteredCache::InstallEntry(const NCA& nca, TitleType type,
     const CNMT new_cnmt(header, opt_header, {c_rec}, {});
     if (!RawInstallYuzuMeta(new_cnmt))
         return InstallResult::ErrorMetaFailed;
-    return RawInstallNCA(nca, copy, overwrite_if_exists, c_rec.nca_id);
+    return RawInstallNCA(nca, progress, overwrite_if_exists, c_rec.nca_id);
 }
 
-InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
+InstallResult RegisteredCache::RawInstallNCA(const NCA& nca,
+                                             const InstallProgressCallback& progress,
                                              bool overwrite_if_exists,
-                                             std::optional<NcaID> override_id) {
+                                             std::optional<NcaID> override_id, bool verify_id) {
     const auto in = nca.GetBaseFile();
     Core::Crypto::SHA256Hash hash{};
 
@@ -647,8 +829,29 @@ InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFuncti
     auto out = dir->CreateFileRelative(path);
     if (out == nullptr)
         return InstallResult::ErrorCopyFailed;
-    return copy(in, out, VFS_RC_LARGE_COPY_BLOCK) ? InstallResult::Success
-                                                  : InstallResult::ErrorCopyFailed;
+
+    const auto remove_output = [&out] {
+        const auto out_dir = out->GetContainingDirectory();
+        const auto out_name = out->GetName();
+        out = nullptr;
+        if (out_dir != nullptr)
+            out_dir->DeleteFile(out_name);
+    };
+
+    if (!CopyAndHash(in, out, progress, hash)) {
+        remove_output();
+        return InstallResult::ErrorCopyFailed;
+    }
+
+    // The ID of an NCA is the start of its hash
+    if (verify_id && std::memcmp(hash.data(), id.data(), id.size()) != 0) {
+        LOG_ERROR(Loader, "The hash of NCA {} doesn't match its ID, the file is corrupted.",
+                  Common::HexToString(id, false));
+        remove_output();
+        return InstallResult::ErrorHashMismatch;
+    }
+
+    return InstallResult::Success;
 }
 
 bool RegisteredCache::RawInstallYuzuMeta(const CNMT& cnmt) {
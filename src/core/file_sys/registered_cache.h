@@ -6,7 +6,9 @@
 
 #include <array>
 #include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <boost/container/flat_map.hpp>
@@ -30,13 +32,20 @@ class RegisteredCache;
 
 using NcaID = std::array<u8, 0x10>;
 using ContentProviderParsingFunction = std::function<VirtualFile(const VirtualFile&, const NcaID&)>;
-using VfsCopyFunction = std::function<bool(const VirtualFile&, const VirtualFile&, size_t)>;
+
+/**
+ * Receives the NCA being installed, how many of its bytes were copied and the throughput of the
+ * copy in bytes per second. Returning false cancels the install.
+ */
+using InstallProgressCallback =
+    std::function<bool(const VirtualFile& nca, std::size_t copied, double throughput)>;
 
 enum class InstallResult {
     Success,
     ErrorAlreadyExists,
     ErrorCopyFailed,
     ErrorMetaFailed,
+    ErrorHashMismatch,
 };
 
 struct ContentProviderEntry {
@@ -155,18 +164,19 @@ public:
         std::optional<u64> title_id = {}) const override;
 
     // Raw copies all the ncas from the xci/nsp to the csache. Does some quick checks to make sure
-    // there is a meta NCA and all of them are accessible.
+    // there is a meta NCA and all of them are accessible. The NCAs are hashed while they are
+    // copied and have to match their IDs.
     InstallResult InstallEntry(const XCI& xci, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const InstallProgressCallback& progress = {});
     InstallResult InstallEntry(const NSP& nsp, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const InstallProgressCallback& progress = {});
 
     // Due to the fact that we must use Meta-type NCAs to determine the existance of files, this
     // poses quite a challenge. Instead of creating a new meta NCA for this file, yuzu will create a
     // dir inside the NAND called 'yuzu_meta' and store the raw CNMT there.
     // TODO(DarkLordZach): Author real meta-type NCAs and install those.
     InstallResult InstallEntry(const NCA& nca, TitleType type, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const InstallProgressCallback& progress = {});
 
 private:
     template <typename T>
@@ -179,13 +189,30 @@ private:
     std::optional<NcaID> GetNcaIDFromMetadata(u64 title_id, ContentRecordType type) const;
     VirtualFile GetFileAtID(NcaID id) const;
     VirtualFile OpenFileOrDirectoryConcat(const VirtualDir& dir, std::string_view path) const;
-    InstallResult RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
-                                bool overwrite_if_exists, std::optional<NcaID> override_id = {});
+    InstallResult RawInstallNCA(const NCA& nca, const InstallProgressCallback& progress,
+                                bool overwrite_if_exists, std::optional<NcaID> override_id = {},
+                                bool verify_id = false);
     bool RawInstallYuzuMeta(const CNMT& cnmt);
 
+    // What Refresh needs to know about an NCA, kept in the yuzu_index file so that unchanged NCAs
+    // don't have to be opened and parsed again.
+    struct IndexEntry {
+        u64 size;
+        u64 title_id;
+        bool is_meta;
+        std::vector<u8> cnmt; ///< Raw CNMT file of meta NCAs
+    };
+
+    void LoadIndex();
+    void SaveIndex() const;
+    std::optional<IndexEntry> ParseIndexEntry(const VirtualFile& file, const NcaID& id) const;
+
     VirtualDir dir;
     ContentProviderParsingFunction parser;
 
+    // maps NcaID -> index entry of every NCA seen by the last Refresh
+    std::map<NcaID, IndexEntry> index;
+
     // maps tid -> NcaID of meta
     std::map<u64, NcaID> meta_id;
     // maps tid -> meta
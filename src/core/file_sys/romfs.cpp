@@ -2,7 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "common/swap.h"
 #include "core/file_sys/fsmitm_romfsbuild.h"
 #include "core/file_sys/romfs.h"
@@ -32,101 +40,262 @@ struct RomFSHeader {
 static_assert(sizeof(RomFSHeader) == 0x50, "RomFSHeader has incorrect size.");
 
 struct DirectoryEntry {
+    u32_le parent;
     u32_le sibling;
     u32_le child_dir;
     u32_le child_file;
-    u32_le hash;
+    u32_le next_in_bucket;
     u32_le name_length;
 };
-static_assert(sizeof(DirectoryEntry) == 0x14, "DirectoryEntry has incorrect size.");
+static_assert(sizeof(DirectoryEntry) == 0x18, "DirectoryEntry has incorrect size.");
 
 struct FileEntry {
     u32_le parent;
     u32_le sibling;
     u64_le offset;
     u64_le size;
-    u32_le hash;
+    u32_le next_in_bucket;
     u32_le name_length;
 };
 static_assert(sizeof(FileEntry) == 0x20, "FileEntry has incorrect size.");
 
-template <typename Entry>
-static std::pair<Entry, std::string> GetEntry(const VirtualFile& file, std::size_t offset) {
-    Entry entry{};
-    if (file->ReadObject(&entry, offset) != sizeof(Entry))
-        return {};
-    std::string string(entry.name_length, '\0');
-    if (file->ReadArray(&string[0], string.size(), offset + sizeof(Entry)) != string.size())
-        return {};
-    return {entry, string};
+namespace {
+
+// Same hash as the one the RomFS builder and the console use to fill the hash tables
+u32 CalculatePathHash(u32 parent, std::string_view name) {
+    u32 hash = parent ^ 123456789;
+    for (const char c : name) {
+        hash = (hash >> 5) | (hash << 27);
+        hash ^= c;
+    }
+    return hash;
 }
 
-void ProcessFile(VirtualFile file, std::size_t file_offset, std::size_t data_offset,
-                 u32 this_file_offset, std::shared_ptr<VectorVfsDirectory> parent) {
-    while (true) {
-        auto entry = GetEntry<FileEntry>(file, file_offset + this_file_offset);
+// Tables of a RomFS, shared by every directory and file opened from it. Entries are parsed when
+// they're looked up, mapped RomFS images are used in place.
+class RomFSMetadata {
+public:
+    static std::shared_ptr<RomFSMetadata> Open(VirtualFile file) {
+        auto metadata = std::make_shared<RomFSMetadata>();
+        RomFSHeader& header = metadata->header;
+        if (file->ReadObject(&header) != sizeof(RomFSHeader) ||
+            header.header_size != sizeof(RomFSHeader)) {
+            return nullptr;
+        }
+        if (!metadata->directory_hash.Load(*file, header.directory_hash) ||
+            !metadata->directory_meta.Load(*file, header.directory_meta) ||
+            !metadata->file_hash.Load(*file, header.file_hash) ||
+            !metadata->file_meta.Load(*file, header.file_meta)) {
+            return nullptr;
+        }
+        metadata->file = std::move(file);
+        return metadata;
+    }
 
-        parent->AddFile(std::make_shared<OffsetVfsFile>(
-            file, entry.first.size, entry.first.offset + data_offset, entry.second));
+    std::optional<std::pair<DirectoryEntry, std::string_view>> GetDirectory(u32 offset) const {
+        return GetEntry<DirectoryEntry>(directory_meta, offset);
+    }
 
-        if (entry.first.sibling == ROMFS_ENTRY_EMPTY)
-            break;
+    std::optional<std::pair<FileEntry, std::string_view>> GetFile(u32 offset) const {
+        return GetEntry<FileEntry>(file_meta, offset);
+    }
 
-        this_file_offset = entry.first.sibling;
+    /// Returns the offset of the subdirectory of parent with a name, through the hash table
+    std::optional<u32> FindDirectory(u32 parent, std::string_view name) const {
+        return FindEntry<DirectoryEntry>(directory_hash, directory_meta, parent, name);
     }
-}
 
-void ProcessDirectory(VirtualFile file, std::size_t dir_offset, std::size_t file_offset,
-                      std::size_t data_offset, u32 this_dir_offset,
-                      std::shared_ptr<VectorVfsDirectory> parent) {
-    while (true) {
-        auto entry = GetEntry<DirectoryEntry>(file, dir_offset + this_dir_offset);
-        auto current = std::make_shared<VectorVfsDirectory>(
-            std::vector<VirtualFile>{}, std::vector<VirtualDir>{}, entry.second);
+    /// Returns the offset of the file of parent with a name, through the hash table
+    std::optional<u32> FindFile(u32 parent, std::string_view name) const {
+        return FindEntry<FileEntry>(file_hash, file_meta, parent, name);
+    }
+
+    VirtualFile OpenFile(const FileEntry& entry, std::string_view name) const {
+        return std::make_shared<OffsetVfsFile>(file, entry.size, header.data_offset + entry.offset,
+                                               std::string(name));
+    }
 
-        if (entry.first.child_file != ROMFS_ENTRY_EMPTY) {
-            ProcessFile(file, file_offset, data_offset, entry.first.child_file, current);
+private:
+    struct Table {
+        bool Load(const VfsFile& file, const TableLocation& location) {
+            size = static_cast<std::size_t>(location.size);
+            data = file.GetPointer(size, location.offset);
+            if (data == nullptr) {
+                buffer = file.ReadBytes(size, location.offset);
+                if (buffer.size() != size) {
+                    return false;
+                }
+                data = buffer.data();
+                memory.Resize(buffer.size());
+            }
+            return true;
         }
 
-        if (entry.first.child_dir != ROMFS_ENTRY_EMPTY) {
-            ProcessDirectory(file, dir_offset, file_offset, data_offset, entry.first.child_dir,
-                             current);
+        const u8* data = nullptr;
+        std::size_t size = 0;
+        std::vector<u8> buffer; ///< Copy of the table when the file can't be accessed in place
+        Common::MemoryAccounting::TrackedAllocation memory{Common::MemoryAccounting::Tag::RomFS};
+    };
+
+    template <typename Entry>
+    static std::optional<std::pair<Entry, std::string_view>> GetEntry(const Table& table,
+                                                                      u32 offset) {
+        Entry entry{};
+        if (offset > table.size || table.size - offset < sizeof(Entry)) {
+            return {};
         }
+        std::memcpy(&entry, table.data + offset, sizeof(Entry));
+        if (table.size - offset - sizeof(Entry) < entry.name_length) {
+            return {};
+        }
+        const auto name = reinterpret_cast<const char*>(table.data + offset + sizeof(Entry));
+        return std::make_pair(entry, std::string_view(name, entry.name_length));
+    }
 
-        parent->AddDirectory(current);
-        if (entry.first.sibling == ROMFS_ENTRY_EMPTY)
-            break;
-        this_dir_offset = entry.first.sibling;
+    template <typename Entry>
+    static std::optional<u32> FindEntry(const Table& hash_table, const Table& meta, u32 parent,
+                                        std::string_view name) {
+        const std::size_t num_buckets = hash_table.size / sizeof(u32);
+        if (num_buckets == 0) {
+            return {};
+        }
+        const std::size_t bucket = CalculatePathHash(parent, name) % num_buckets;
+        u32_le offset;
+        std::memcpy(&offset, hash_table.data + bucket * sizeof(u32), sizeof(u32));
+        // Chains are bounded by the number of entries that fit in the table, in case of loops
+        for (std::size_t i = 0; offset != ROMFS_ENTRY_EMPTY && i <= meta.size / sizeof(Entry);
+             ++i) {
+            const auto entry = GetEntry<Entry>(meta, offset);
+            if (!entry) {
+                return {};
+            }
+            if (entry->first.parent == parent && entry->second == name) {
+                return offset;
+            }
+            offset = entry->first.next_in_bucket;
+        }
+        return {};
     }
-}
 
-VirtualDir ExtractRomFS(VirtualFile file, RomFSExtractionType type) {
+    VirtualFile file;
     RomFSHeader header{};
-    if (file->ReadObject(&header) != sizeof(RomFSHeader))
-        return nullptr;
+    Table directory_hash;
+    Table directory_meta;
+    Table file_hash;
+    Table file_meta;
+};
 
-    if (header.header_size != sizeof(RomFSHeader))
-        return nullptr;
+// Directory of a RomFS that only creates the objects of its children when they're requested
+class RomFSDirectory : public ReadOnlyVfsDirectory {
+public:
+    RomFSDirectory(std::shared_ptr<const RomFSMetadata> metadata, u32 offset, std::string name)
+        : metadata(std::move(metadata)), offset(offset), name(std::move(name)) {}
 
-    const u64 file_offset = header.file_meta.offset;
-    const u64 dir_offset = header.directory_meta.offset + 4;
+    std::vector<VirtualFile> GetFiles() const override {
+        std::vector<VirtualFile> files;
+        const auto entry = metadata->GetDirectory(offset);
+        if (!entry) {
+            return files;
+        }
+        for (u32 child = entry->first.child_file; child != ROMFS_ENTRY_EMPTY;) {
+            const auto file = metadata->GetFile(child);
+            if (!file) {
+                break;
+            }
+            files.push_back(metadata->OpenFile(file->first, file->second));
+            child = file->first.sibling;
+        }
+        return files;
+    }
+
+    std::vector<VirtualDir> GetSubdirectories() const override {
+        std::vector<VirtualDir> dirs;
+        const auto entry = metadata->GetDirectory(offset);
+        if (!entry) {
+            return dirs;
+        }
+        for (u32 child = entry->first.child_dir; child != ROMFS_ENTRY_EMPTY;) {
+            const auto dir = metadata->GetDirectory(child);
+            if (!dir) {
+                break;
+            }
+            dirs.push_back(
+                std::make_shared<RomFSDirectory>(metadata, child, std::string(dir->second)));
+            child = dir->first.sibling;
+        }
+        return dirs;
+    }
 
-    auto root =
-        std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{}, std::vector<VirtualDir>{},
-                                             file->GetName(), file->GetContainingDirectory());
+    VirtualFile GetFile(std::string_view file_name) const override {
+        const auto child = metadata->FindFile(offset, file_name);
+        if (!child) {
+            return nullptr;
+        }
+        const auto entry = metadata->GetFile(*child);
+        return metadata->OpenFile(entry->first, entry->second);
+    }
 
-    ProcessDirectory(file, dir_offset, file_offset, header.data_offset, 0, root);
+    VirtualDir GetSubdirectory(std::string_view dir_name) const override {
+        const auto child = metadata->FindDirectory(offset, dir_name);
+        if (!child) {
+            return nullptr;
+        }
+        return std::make_shared<RomFSDirectory>(metadata, *child, std::string(dir_name));
+    }
 
-    VirtualDir out = std::move(root);
+    std::string GetName() const override {
+        return name;
+    }
+
+    VirtualDir GetParentDirectory() const override {
+        // The root of the RomFS has no parent
+        if (offset == 0) {
+            return nullptr;
+        }
+        const auto entry = metadata->GetDirectory(offset);
+        if (!entry) {
+            return nullptr;
+        }
+        const auto parent = metadata->GetDirectory(entry->first.parent);
+        if (!parent) {
+            return nullptr;
+        }
+        return std::make_shared<RomFSDirectory>(metadata, entry->first.parent,
+                                                std::string(parent->second));
+    }
+
+private:
+    std::shared_ptr<const RomFSMetadata> metadata;
+    u32 offset;
+    std::string name;
+};
+
+} // Anonymous namespace
+
+VirtualDir ExtractRomFS(VirtualFile file, RomFSExtractionType type) {
+    std::string name = file->GetName();
+    VirtualDir parent = file->GetContainingDirectory();
+    const auto metadata = RomFSMetadata::Open(std::move(file));
+    if (metadata == nullptr)
+        return nullptr;
+
+    // The RomFS root is unnamed, it's put in a directory named after the file
+    VirtualDir out = std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{},
+        std::vector<VirtualDir>{std::make_shared<RomFSDirectory>(metadata, 0, "")},
+        std::move(name), std::move(parent));
 
     if (type == RomFSExtractionType::SingleDiscard)
         return out->GetSubdirectories().front();
 
-    while (out->GetSubdirectories().size() == 1 && out->GetFiles().empty()) {
-        if (out->GetSubdirectories().front()->GetName() == "data" &&
+    while (true) {
+        auto subdirectories = out->GetSubdirectories();
+        if (subdirectories.size() != 1 || !out->GetFiles().empty())
+            break;
+        if (subdirectories.front()->GetName() == "data" &&
             type == RomFSExtractionType::Truncated)
             break;
-        out = out->GetSubdirectories().front();
+        out = std::move(subdirectories.front());
     }
 
     return out;
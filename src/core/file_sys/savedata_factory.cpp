@@ -8,6 +8,7 @@
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/savedata_factory.h"
+#include "core/file_sys/savedata_journal.h"
 #include "core/file_sys/vfs.h"
 #include "core/hle/kernel/process.h"
 
@@ -85,7 +86,7 @@ ResultVal<VirtualDir> SaveDataFactory::Create(SaveDataSpaceId space,
         return ResultCode(-1);
     }
 
-    return MakeResult<VirtualDir>(std::move(out));
+    return MakeResult<VirtualDir>(OpenJournaled(meta.type, save_directory, std::move(out)));
 }
 
 ResultVal<VirtualDir> SaveDataFactory::Open(SaveDataSpaceId space,
@@ -102,7 +103,29 @@ ResultVal<VirtualDir> SaveDataFactory::Open(SaveDataSpaceId space,
         return ResultCode(-1);
     }
 
-    return MakeResult<VirtualDir>(std::move(out));
+    return MakeResult<VirtualDir>(OpenJournaled(meta.type, save_directory, std::move(out)));
+}
+
+VirtualDir SaveDataFactory::OpenJournaled(SaveDataType type, const std::string& path,
+                                          VirtualDir save) const {
+    // Only these are journaled on hardware, the others are written through
+    if (type != SaveDataType::SystemSaveData && type != SaveDataType::SaveData &&
+        type != SaveDataType::DeviceSaveData) {
+        return save;
+    }
+
+    std::lock_guard lock{journal_mutex};
+    for (auto it = journals.begin(); it != journals.end();) {
+        it = it->second.expired() ? journals.erase(it) : std::next(it);
+    }
+
+    auto& weak_journal = journals[path];
+    auto journal = weak_journal.lock();
+    if (journal == nullptr) {
+        journal = std::make_shared<SaveDataJournal>(std::move(save));
+        weak_journal = journal;
+    }
+    return journal->GetRoot();
 }
 
 VirtualDir SaveDataFactory::GetSaveDataSpaceDirectory(SaveDataSpaceId space) const {
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
@@ -14,6 +16,8 @@
 
 namespace FileSys {
 
+class SaveDataJournal;
+
 enum class SaveDataSpaceId : u8 {
     NandSystem = 0,
     NandUser = 1,
@@ -78,7 +82,13 @@ public:
                            SaveDataSize new_value) const;
 
 private:
+    /// Puts journaled save data behind the overlay that is shared by everything opening it.
+    VirtualDir OpenJournaled(SaveDataType type, const std::string& path, VirtualDir save) const;
+
     VirtualDir dir;
+
+    mutable std::mutex journal_mutex;
+    mutable std::map<std::string, std::weak_ptr<SaveDataJournal>> journals;
 };
 
 } // namespace FileSys
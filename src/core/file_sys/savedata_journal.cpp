@@ -0,0 +1,668 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/file_sys/savedata_journal.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr char ManifestName[] = "manifest";
+constexpr char PartialManifestName[] = "manifest.tmp";
+
+std::string JoinPath(const std::string& path, const std::string& name) {
+    return path.empty() ? name : path + '/' + name;
+}
+
+} // Anonymous namespace
+
+struct SaveDataJournal::Node : std::enable_shared_from_this<Node> {
+    std::string name;
+    std::weak_ptr<Node> parent;
+    bool is_directory = false;
+
+    // Files
+    VirtualFile base_file;
+    /// Contents of the file once it has been changed, until then it's read from base_file
+    std::optional<std::vector<u8>> data;
+    /// The contents differ from the file in the save directory
+    bool dirty = false;
+
+    // Directories
+    VirtualDir base_dir;
+    bool populated = false;
+    /// The directory doesn't exist in the save directory yet
+    bool is_new = false;
+    std::map<std::string, std::shared_ptr<Node>, std::less<>> children;
+    /// Entries of the directory in the save directory, as of the last commit
+    std::set<std::string, std::less<>> committed_files;
+    std::set<std::string, std::less<>> committed_dirs;
+};
+
+struct SaveDataJournal::Operation {
+    enum class Type : char {
+        DeleteFile = 'F',
+        DeleteDirectory = 'D',
+        CreateDirectory = 'M',
+        WriteFile = 'W',
+    };
+
+    Type type;
+    /// Index of the journal file holding the contents, for WriteFile
+    std::size_t index;
+    std::string path;
+};
+
+class JournalVfsFile final : public VfsFile {
+public:
+    JournalVfsFile(std::shared_ptr<SaveDataJournal> journal,
+                   std::shared_ptr<SaveDataJournal::Node> node)
+        : journal{std::move(journal)}, node{std::move(node)} {}
+
+    std::string GetName() const override {
+        std::lock_guard lock{journal->mutex};
+        return node->name;
+    }
+
+    std::size_t GetSize() const override {
+        std::lock_guard lock{journal->mutex};
+        return GetSizeLocked();
+    }
+
+    bool Resize(std::size_t new_size) override {
+        std::lock_guard lock{journal->mutex};
+        journal->LoadData(*node);
+        node->data->resize(new_size);
+        node->dirty = true;
+        journal->MarkDirty();
+        return true;
+    }
+
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+
+    bool IsWritable() const override {
+        return true;
+    }
+
+    bool IsReadable() const override {
+        return true;
+    }
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        std::lock_guard lock{journal->mutex};
+        if (!node->data) {
+            return node->base_file != nullptr ? node->base_file->Read(data, length, offset) : 0;
+        }
+        const auto& contents = *node->data;
+        if (offset >= contents.size()) {
+            return 0;
+        }
+        const std::size_t read = std::min(length, contents.size() - offset);
+        std::memcpy(data, contents.data() + offset, read);
+        return read;
+    }
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        std::lock_guard lock{journal->mutex};
+        journal->LoadData(*node);
+        auto& contents = *node->data;
+        if (offset + length > contents.size()) {
+            contents.resize(offset + length);
+        }
+        std::memcpy(contents.data() + offset, data, length);
+        node->dirty = true;
+        journal->MarkDirty();
+        return length;
+    }
+
+    bool Rename(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        const auto parent = node->parent.lock();
+        if (parent == nullptr || parent->children.find(name) != parent->children.end()) {
+            return false;
+        }
+        parent->children.erase(node->name);
+        node->name = name;
+        parent->children.emplace(node->name, node);
+        node->dirty = true;
+        journal->MarkDirty();
+        return true;
+    }
+
+private:
+    std::size_t GetSizeLocked() const {
+        if (node->data) {
+            return node->data->size();
+        }
+        return node->base_file != nullptr ? node->base_file->GetSize() : 0;
+    }
+
+    std::shared_ptr<SaveDataJournal> journal;
+    std::shared_ptr<SaveDataJournal::Node> node;
+};
+
+class JournalVfsDirectory final : public VfsDirectory {
+public:
+    JournalVfsDirectory(std::shared_ptr<SaveDataJournal> journal,
+                        std::shared_ptr<SaveDataJournal::Node> node)
+        : journal{std::move(journal)}, node{std::move(node)} {}
+
+    std::vector<std::shared_ptr<VfsFile>> GetFiles() const override {
+        std::lock_guard lock{journal->mutex};
+        journal->Populate(*node);
+        std::vector<std::shared_ptr<VfsFile>> files;
+        for (const auto& [name, child] : node->children) {
+            if (!child->is_directory) {
+                files.push_back(std::make_shared<JournalVfsFile>(journal, child));
+            }
+        }
+        return files;
+    }
+
+    std::shared_ptr<VfsFile> GetFile(std::string_view name) const override {
+        std::lock_guard lock{journal->mutex};
+        const auto child = FindChild(name);
+        if (child == nullptr || child->is_directory) {
+            return nullptr;
+        }
+        return std::make_shared<JournalVfsFile>(journal, child);
+    }
+
+    std::vector<std::shared_ptr<VfsDirectory>> GetSubdirectories() const override {
+        std::lock_guard lock{journal->mutex};
+        journal->Populate(*node);
+        std::vector<std::shared_ptr<VfsDirectory>> dirs;
+        for (const auto& [name, child] : node->children) {
+            if (child->is_directory) {
+                dirs.push_back(std::make_shared<JournalVfsDirectory>(journal, child));
+            }
+        }
+        return dirs;
+    }
+
+    std::shared_ptr<VfsDirectory> GetSubdirectory(std::string_view name) const override {
+        std::lock_guard lock{journal->mutex};
+        const auto child = FindChild(name);
+        if (child == nullptr || !child->is_directory) {
+            return nullptr;
+        }
+        return std::make_shared<JournalVfsDirectory>(journal, child);
+    }
+
+    bool IsWritable() const override {
+        return true;
+    }
+
+    bool IsReadable() const override {
+        return true;
+    }
+
+    std::string GetName() const override {
+        std::lock_guard lock{journal->mutex};
+        return node->name;
+    }
+
+    std::shared_ptr<VfsDirectory> GetParentDirectory() const override {
+        std::lock_guard lock{journal->mutex};
+        auto parent = node->parent.lock();
+        if (parent == nullptr) {
+            return nullptr;
+        }
+        return std::make_shared<JournalVfsDirectory>(journal, std::move(parent));
+    }
+
+    std::shared_ptr<VfsDirectory> CreateSubdirectory(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        if (const auto child = FindChild(name)) {
+            return child->is_directory ? std::make_shared<JournalVfsDirectory>(journal, child)
+                                       : nullptr;
+        }
+        auto child = std::make_shared<SaveDataJournal::Node>();
+        child->name = name;
+        child->parent = node;
+        child->is_directory = true;
+        child->populated = true;
+        child->is_new = true;
+        node->children.emplace(child->name, child);
+        journal->MarkDirty();
+        return std::make_shared<JournalVfsDirectory>(journal, std::move(child));
+    }
+
+    std::shared_ptr<VfsFile> CreateFile(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        if (const auto child = FindChild(name)) {
+            return child->is_directory ? nullptr
+                                       : std::make_shared<JournalVfsFile>(journal, child);
+        }
+        auto child = std::make_shared<SaveDataJournal::Node>();
+        child->name = name;
+        child->parent = node;
+        child->data.emplace();
+        child->dirty = true;
+        node->children.emplace(child->name, child);
+        journal->MarkDirty();
+        return std::make_shared<JournalVfsFile>(journal, std::move(child));
+    }
+
+    bool DeleteSubdirectory(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        const auto child = FindChild(name);
+        if (child == nullptr || !child->is_directory) {
+            return false;
+        }
+        journal->Populate(*child);
+        if (!child->children.empty()) {
+            return false;
+        }
+        return RemoveChild(name);
+    }
+
+    bool DeleteSubdirectoryRecursive(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        const auto child = FindChild(name);
+        if (child == nullptr || !child->is_directory) {
+            return false;
+        }
+        return RemoveChild(name);
+    }
+
+    bool CleanSubdirectoryRecursive(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        const auto child = FindChild(name);
+        if (child == nullptr || !child->is_directory) {
+            return false;
+        }
+        journal->Populate(*child);
+        child->children.clear();
+        journal->MarkDirty();
+        return true;
+    }
+
+    bool DeleteFile(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        const auto child = FindChild(name);
+        if (child == nullptr || child->is_directory) {
+            return false;
+        }
+        return RemoveChild(name);
+    }
+
+    bool Rename(std::string_view name) override {
+        std::lock_guard lock{journal->mutex};
+        const auto parent = node->parent.lock();
+        if (parent == nullptr || parent->children.find(name) != parent->children.end()) {
+            return false;
+        }
+        // The contents have to be written under the new name, they're read from the old one
+        // before it's deleted by the commit.
+        journal->MarkNew(*node);
+        parent->children.erase(node->name);
+        node->name = name;
+        parent->children.emplace(node->name, node);
+        journal->MarkDirty();
+        return true;
+    }
+
+private:
+    friend class SaveDataJournal;
+
+    std::shared_ptr<SaveDataJournal::Node> FindChild(std::string_view name) const {
+        journal->Populate(*node);
+        const auto it = node->children.find(name);
+        return it != node->children.end() ? it->second : nullptr;
+    }
+
+    bool RemoveChild(std::string_view name) {
+        const auto it = node->children.find(name);
+        it->second->parent.reset();
+        node->children.erase(it);
+        journal->MarkDirty();
+        return true;
+    }
+
+    std::shared_ptr<SaveDataJournal> journal;
+    std::shared_ptr<SaveDataJournal::Node> node;
+};
+
+std::shared_ptr<VfsDirectory> JournalVfsFile::GetContainingDirectory() const {
+    std::lock_guard lock{journal->mutex};
+    auto parent = node->parent.lock();
+    if (parent == nullptr) {
+        return nullptr;
+    }
+    return std::make_shared<JournalVfsDirectory>(journal, std::move(parent));
+}
+
+namespace {
+
+VirtualDir GetParentOf(const VirtualDir& base, const std::string& path) {
+    const auto separator = path.rfind('/');
+    return separator == std::string::npos ? base
+                                          : base->GetDirectoryRelative(path.substr(0, separator));
+}
+
+std::string GetNameOf(const std::string& path) {
+    const auto separator = path.rfind('/');
+    return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+} // Anonymous namespace
+
+bool SaveDataJournal::ApplyJournal(const VirtualDir& base, const VirtualDir& journal_dir,
+                                   const std::vector<Operation>& operations) {
+    bool success = true;
+    for (const auto& operation : operations) {
+        const auto& path = operation.path;
+        switch (operation.type) {
+        case Operation::Type::DeleteFile:
+            if (const auto parent = GetParentOf(base, path)) {
+                parent->DeleteFile(GetNameOf(path));
+            }
+            break;
+        case Operation::Type::DeleteDirectory:
+            if (const auto parent = GetParentOf(base, path)) {
+                parent->DeleteSubdirectoryRecursive(GetNameOf(path));
+            }
+            break;
+        case Operation::Type::CreateDirectory:
+            if (base->GetDirectoryRelative(path) == nullptr &&
+                base->CreateDirectoryRelative(path) == nullptr) {
+                success = false;
+            }
+            break;
+        case Operation::Type::WriteFile: {
+            const auto source = journal_dir->GetFile(std::to_string(operation.index));
+            const auto target = base->CreateFileRelative(path);
+            if (source == nullptr || target == nullptr) {
+                success = false;
+                break;
+            }
+            const auto contents = source->ReadAllBytes();
+            if (!target->Resize(contents.size()) ||
+                target->WriteBytes(contents) != contents.size()) {
+                success = false;
+            }
+            break;
+        }
+        }
+    }
+    return success;
+}
+
+std::string SaveDataJournal::SerializeOperations(const std::vector<Operation>& operations) {
+    std::string manifest;
+    for (const auto& operation : operations) {
+        manifest += static_cast<char>(operation.type);
+        manifest += ' ';
+        manifest += std::to_string(operation.index);
+        manifest += ' ';
+        manifest += operation.path;
+        manifest += '\n';
+    }
+    return manifest;
+}
+
+std::optional<std::vector<SaveDataJournal::Operation>> SaveDataJournal::ParseOperations(
+    const std::vector<u8>& manifest) {
+    std::vector<Operation> operations;
+    std::istringstream stream(std::string(manifest.begin(), manifest.end()));
+    std::string line;
+    while (std::getline(stream, line)) {
+        // Lines are "<type> <index> <path>", the path goes up to the end of the line
+        const auto index_end = line.find(' ', 2);
+        if (line.size() < 4 || line[1] != ' ' || index_end == std::string::npos) {
+            return std::nullopt;
+        }
+        const auto type = static_cast<Operation::Type>(line[0]);
+        if (type != Operation::Type::DeleteFile && type != Operation::Type::DeleteDirectory &&
+            type != Operation::Type::CreateDirectory && type != Operation::Type::WriteFile) {
+            return std::nullopt;
+        }
+        const auto index = std::strtoull(line.c_str() + 2, nullptr, 10);
+        operations.push_back({type, static_cast<std::size_t>(index), line.substr(index_end + 1)});
+    }
+    return operations;
+}
+
+SaveDataJournal::SaveDataJournal(VirtualDir base_)
+    : base{std::move(base_)}, root{std::make_shared<Node>()} {
+    root->name = base->GetName();
+    root->is_directory = true;
+    root->base_dir = base;
+    Recover();
+}
+
+SaveDataJournal::~SaveDataJournal() {
+    std::lock_guard lock{mutex};
+    if (dirty && !CommitLocked()) {
+        LOG_ERROR(Service_FS, "Could not commit save data in {}, changes are lost",
+                  base->GetFullPath());
+    }
+}
+
+VirtualDir SaveDataJournal::GetRoot() {
+    return std::make_shared<JournalVfsDirectory>(shared_from_this(), root);
+}
+
+bool SaveDataJournal::Commit() {
+    std::lock_guard lock{mutex};
+    return CommitLocked();
+}
+
+bool SaveDataJournal::HasPendingChanges() const {
+    std::lock_guard lock{mutex};
+    return dirty;
+}
+
+std::shared_ptr<SaveDataJournal> SaveDataJournal::FromDirectory(const VirtualDir& directory) {
+    const auto journaled = std::dynamic_pointer_cast<JournalVfsDirectory>(directory);
+    return journaled != nullptr ? journaled->journal : nullptr;
+}
+
+void SaveDataJournal::Populate(Node& node) {
+    if (node.populated) {
+        return;
+    }
+    node.populated = true;
+    if (node.base_dir == nullptr) {
+        return;
+    }
+
+    for (const auto& file : node.base_dir->GetFiles()) {
+        auto child = std::make_shared<Node>();
+        child->name = file->GetName();
+        child->parent = node.shared_from_this();
+        child->base_file = file;
+        node.committed_files.insert(child->name);
+        node.children.emplace(child->name, std::move(child));
+    }
+    for (const auto& dir : node.base_dir->GetSubdirectories()) {
+        const auto name = dir->GetName();
+        if (&node == root.get() && name == JournalDirectoryName) {
+            continue;
+        }
+        auto child = std::make_shared<Node>();
+        child->name = name;
+        child->parent = node.shared_from_this();
+        child->is_directory = true;
+        child->base_dir = dir;
+        node.committed_dirs.insert(name);
+        node.children.emplace(name, std::move(child));
+    }
+}
+
+void SaveDataJournal::LoadData(Node& node) {
+    if (node.data) {
+        return;
+    }
+    node.data = node.base_file != nullptr ? node.base_file->ReadAllBytes() : std::vector<u8>{};
+}
+
+void SaveDataJournal::MarkNew(Node& node) {
+    if (!node.is_directory) {
+        node.dirty = true;
+        return;
+    }
+    Populate(node);
+    node.is_new = true;
+    node.committed_files.clear();
+    node.committed_dirs.clear();
+    for (const auto& [name, child] : node.children) {
+        MarkNew(*child);
+    }
+}
+
+void SaveDataJournal::MarkDirty() {
+    const auto now = std::chrono::steady_clock::now();
+    if (!dirty) {
+        dirty = true;
+        dirty_since = now;
+        return;
+    }
+    if (now - dirty_since >= CheckpointInterval) {
+        LOG_DEBUG(Service_FS, "Checkpointing save data in {}", base->GetFullPath());
+        CommitLocked();
+    }
+}
+
+void SaveDataJournal::CollectChanges(Node& node, const std::string& path,
+                                     std::vector<Operation>& operations,
+                                     std::vector<Node*>& written) {
+    if (!node.populated) {
+        return;
+    }
+
+    // Deletions come first, an entry can be replaced by one of the other type
+    for (const auto& name : node.committed_files) {
+        const auto it = node.children.find(name);
+        if (it == node.children.end() || it->second->is_directory) {
+            operations.push_back({Operation::Type::DeleteFile, 0, JoinPath(path, name)});
+        }
+    }
+    for (const auto& name : node.committed_dirs) {
+        const auto it = node.children.find(name);
+        if (it == node.children.end() || !it->second->is_directory || it->second->is_new) {
+            operations.push_back({Operation::Type::DeleteDirectory, 0, JoinPath(path, name)});
+        }
+    }
+
+    for (const auto& [name, child] : node.children) {
+        const auto child_path = JoinPath(path, name);
+        if (child->is_directory) {
+            if (child->is_new) {
+                operations.push_back({Operation::Type::CreateDirectory, 0, child_path});
+            }
+            CollectChanges(*child, child_path, operations, written);
+        } else if (child->dirty || node.committed_files.count(name) == 0) {
+            operations.push_back({Operation::Type::WriteFile, written.size(), child_path});
+            written.push_back(child.get());
+        }
+    }
+}
+
+void SaveDataJournal::MarkCommitted(Node& node) {
+    if (!node.populated) {
+        return;
+    }
+    node.is_new = false;
+    node.committed_files.clear();
+    node.committed_dirs.clear();
+    for (const auto& [name, child] : node.children) {
+        if (child->is_directory) {
+            node.committed_dirs.insert(name);
+            MarkCommitted(*child);
+        } else {
+            node.committed_files.insert(name);
+            child->dirty = false;
+        }
+    }
+}
+
+bool SaveDataJournal::CommitLocked() {
+    std::vector<Operation> operations;
+    std::vector<Node*> written;
+    CollectChanges(*root, "", operations, written);
+    if (operations.empty()) {
+        dirty = false;
+        return true;
+    }
+
+    // Everything is written to the journal before anything in the save is touched
+    base->DeleteSubdirectoryRecursive(JournalDirectoryName);
+    const auto journal_dir = base->CreateSubdirectory(JournalDirectoryName);
+    if (journal_dir == nullptr) {
+        LOG_ERROR(Service_FS, "Could not create the save data journal in {}",
+                  base->GetFullPath());
+        return false;
+    }
+    for (std::size_t index = 0; index < written.size(); ++index) {
+        Node& node = *written[index];
+        LoadData(node);
+        const auto file = journal_dir->CreateFile(std::to_string(index));
+        if (file == nullptr || !file->Resize(node.data->size()) ||
+            file->WriteBytes(*node.data) != node.data->size()) {
+            LOG_ERROR(Service_FS, "Could not write the save data journal in {}",
+                      base->GetFullPath());
+            base->DeleteSubdirectoryRecursive(JournalDirectoryName);
+            return false;
+        }
+    }
+
+    const auto manifest_text = SerializeOperations(operations);
+
+    // Renaming the complete manifest into place is what commits the journal
+    const auto manifest = journal_dir->CreateFile(PartialManifestName);
+    if (manifest == nullptr || !manifest->Resize(manifest_text.size()) ||
+        manifest->WriteBytes(manifest_text.data(), manifest_text.size()) != manifest_text.size() ||
+        !manifest->Rename(ManifestName)) {
+        LOG_ERROR(Service_FS, "Could not write the save data journal in {}", base->GetFullPath());
+        base->DeleteSubdirectoryRecursive(JournalDirectoryName);
+        return false;
+    }
+
+    if (!ApplyJournal(base, journal_dir, operations)) {
+        // The journal stays, applying it is retried when the save is opened again
+        LOG_ERROR(Service_FS, "Could not apply the save data journal in {}", base->GetFullPath());
+        return false;
+    }
+    base->DeleteSubdirectoryRecursive(JournalDirectoryName);
+
+    LOG_DEBUG(Service_FS, "Committed {} changes to {}", operations.size(), base->GetFullPath());
+    MarkCommitted(*root);
+    dirty = false;
+    return true;
+}
+
+void SaveDataJournal::Recover() {
+    const auto journal_dir = base->GetSubdirectory(JournalDirectoryName);
+    if (journal_dir == nullptr) {
+        return;
+    }
+
+    // Without a manifest the journal wasn't finished, the save is still as it was before
+    if (const auto manifest = journal_dir->GetFile(ManifestName)) {
+        const auto operations = ParseOperations(manifest->ReadAllBytes());
+        if (!operations) {
+            LOG_ERROR(Service_FS, "Corrupted save data journal in {}", base->GetFullPath());
+        } else if (!ApplyJournal(base, journal_dir, *operations)) {
+            LOG_ERROR(Service_FS, "Could not apply the save data journal in {}",
+                      base->GetFullPath());
+            return;
+        } else {
+            LOG_INFO(Service_FS, "Applied the save data journal in {}", base->GetFullPath());
+        }
+    }
+    base->DeleteSubdirectoryRecursive(JournalDirectoryName);
+}
+
+} // namespace FileSys
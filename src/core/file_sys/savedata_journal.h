@@ -0,0 +1,100 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+class JournalVfsDirectory;
+class JournalVfsFile;
+
+/**
+ * Write-back overlay over a save data directory. Changes made through it stay in memory until
+ * they're committed, which first writes them to a journal inside the save directory and then
+ * applies the journal. A crash in between leaves a journal that is applied the next time the save
+ * is opened, so the host only ever ends up with the old or the new save, never a mix of both.
+ *
+ * Saves are committed when the guest commits them, once changes have been pending for longer than
+ * CheckpointInterval, and when the last handle to the save is released.
+ */
+class SaveDataJournal final : public std::enable_shared_from_this<SaveDataJournal> {
+public:
+    static constexpr char JournalDirectoryName[] = ".yuzu_save_journal";
+    static constexpr std::chrono::seconds CheckpointInterval{10};
+
+    /// Applies or discards a journal left behind in the directory.
+    explicit SaveDataJournal(VirtualDir base);
+    ~SaveDataJournal();
+
+    SaveDataJournal(const SaveDataJournal&) = delete;
+    SaveDataJournal& operator=(const SaveDataJournal&) = delete;
+
+    /// Returns the root of the overlay.
+    VirtualDir GetRoot();
+
+    /// Writes the pending changes to the save directory. Returns false if that failed, the changes
+    /// stay pending then.
+    bool Commit();
+
+    bool HasPendingChanges() const;
+
+    /// Returns the journal a directory belongs to, or nullptr if it isn't part of an overlay.
+    static std::shared_ptr<SaveDataJournal> FromDirectory(const VirtualDir& directory);
+
+private:
+    friend class JournalVfsDirectory;
+    friend class JournalVfsFile;
+
+    struct Node;
+    struct Operation;
+
+    /// Fills in the entries of a directory from the save directory the first time it's accessed.
+    void Populate(Node& node);
+
+    /// Reads the whole file into memory before it's changed.
+    void LoadData(Node& node);
+
+    /// Marks a node and its children as not existing in the save directory yet.
+    void MarkNew(Node& node);
+
+    /// Notes a change, committing if changes have been pending for too long.
+    void MarkDirty();
+
+    bool CommitLocked();
+
+    void CollectChanges(Node& node, const std::string& path, std::vector<Operation>& operations,
+                        std::vector<Node*>& written);
+
+    /// Marks everything in the overlay as being what the save directory holds.
+    void MarkCommitted(Node& node);
+
+    /// Applies a completely written journal and deletes it.
+    void Recover();
+
+    /// Applies the operations of a journal. Entries that are already gone are skipped, so a
+    /// journal can be applied again after being interrupted.
+    static bool ApplyJournal(const VirtualDir& base, const VirtualDir& journal_dir,
+                             const std::vector<Operation>& operations);
+
+    static std::string SerializeOperations(const std::vector<Operation>& operations);
+    static std::optional<std::vector<Operation>> ParseOperations(const std::vector<u8>& manifest);
+
+    VirtualDir base;
+    std::shared_ptr<Node> root;
+
+    mutable std::mutex mutex;
+    bool dirty = false;
+    std::chrono::steady_clock::time_point dirty_since;
+};
+
+} // namespace FileSys
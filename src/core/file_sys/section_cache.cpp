@@ -0,0 +1,257 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <fmt/format.h>
+#include "common/common_funcs.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+#include "core/file_sys/section_cache.h"
+
+namespace FileSys {
+
+constexpr u32 CacheMagic = Common::MakeMagic('N', 'S', 'C', '0');
+
+SectionCacheFile::SectionCacheFile(VirtualFile base_, std::string path_,
+                                   const std::array<u8, 0x20>& header_hash_)
+    : base(std::move(base_)), path(std::move(path_)), header_hash(header_hash_) {
+    LoadCache();
+}
+
+SectionCacheFile::~SectionCacheFile() {
+    SaveCache();
+}
+
+std::string SectionCacheFile::GetCachePath(std::string_view nca_id, u64 section_offset) {
+    return FileUtil::SanitizePath(fmt::format("{}nca{}{}_{:012X}.bin",
+                                              FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                                              DIR_SEP, nca_id, section_offset));
+}
+
+std::string SectionCacheFile::GetName() const {
+    return base->GetName();
+}
+
+std::size_t SectionCacheFile::GetSize() const {
+    return base->GetSize();
+}
+
+bool SectionCacheFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+std::shared_ptr<VfsDirectory> SectionCacheFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool SectionCacheFile::IsWritable() const {
+    return false;
+}
+
+bool SectionCacheFile::IsReadable() const {
+    return true;
+}
+
+std::size_t SectionCacheFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    const std::size_t size = GetSize();
+    if (offset >= size) {
+        return 0;
+    }
+    length = std::min(length, size - offset);
+
+    std::size_t done = 0;
+    while (done < length) {
+        const std::size_t position = offset + done;
+        const u64 index = position / BlockSize;
+        const std::size_t block_offset = position % BlockSize;
+        const std::size_t block_pos = FindBlock(index);
+        if (block_pos != cached_blocks.size()) {
+            const std::size_t chunk = std::min(length - done, BlockSize - block_offset);
+            std::memcpy(data + done, cached_data + block_pos * BlockSize + block_offset, chunk);
+            done += chunk;
+            continue;
+        }
+
+        // Blocks missing from the cache are read from the base file in a single run
+        u64 last = index;
+        const std::size_t end = offset + length;
+        while ((last + 1) * BlockSize < end && FindBlock(last + 1) == cached_blocks.size()) {
+            ++last;
+        }
+        const std::size_t run = std::min<std::size_t>((last + 1) * BlockSize, end) - position;
+        const std::size_t read = base->Read(data + done, run, position);
+        RecordBlocks(index, last);
+        done += read;
+        if (read != run) {
+            break;
+        }
+    }
+    return done;
+}
+
+std::size_t SectionCacheFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+const u8* SectionCacheFile::GetPointer(std::size_t length, std::size_t offset) const {
+    if (length == 0 || offset >= GetSize() || length > GetSize() - offset) {
+        return nullptr;
+    }
+    const u64 first = offset / BlockSize;
+    const u64 last = (offset + length - 1) / BlockSize;
+    const std::size_t first_pos = FindBlock(first);
+    const std::size_t last_pos = first_pos + static_cast<std::size_t>(last - first);
+    // Indices are sorted and unique, the range is contiguous in the file when both ends match
+    if (first_pos == cached_blocks.size() || last_pos >= cached_blocks.size() ||
+        cached_blocks[last_pos] != last) {
+        return nullptr;
+    }
+    return cached_data + first_pos * BlockSize + offset % BlockSize;
+}
+
+bool SectionCacheFile::Rename(std::string_view name) {
+    return false;
+}
+
+std::size_t SectionCacheFile::GetCachedBlockCount() const {
+    return cached_blocks.size();
+}
+
+void SectionCacheFile::LoadCache() {
+    if (!FileUtil::Exists(path)) {
+        return;
+    }
+    auto file = std::make_unique<Common::MappedFile>(path);
+    CacheHeader header{};
+    if (!file->IsOpen() || file->Size() < sizeof(header)) {
+        return;
+    }
+    std::memcpy(&header, file->Data(), sizeof(header));
+    const std::size_t size = GetSize();
+    const u64 max_blocks = (size + BlockSize - 1) / BlockSize;
+    if (header.magic != CacheMagic || header.version != CacheVersion ||
+        header.header_hash != header_hash || header.section_size != size ||
+        header.num_blocks > max_blocks) {
+        LOG_DEBUG(Loader, "Ignoring stale NCA section cache {}", path);
+        return;
+    }
+
+    std::vector<u64> blocks(header.num_blocks);
+    const std::size_t table_size = blocks.size() * sizeof(u64);
+    if (file->Size() < sizeof(header) + table_size) {
+        return;
+    }
+    std::memcpy(blocks.data(), file->Data() + sizeof(header), table_size);
+
+    // Every block is whole except the last block of the section, which can only be stored last
+    std::size_t data_size = blocks.size() * BlockSize;
+    if (!blocks.empty() && blocks.back() == max_blocks - 1) {
+        data_size -= max_blocks * BlockSize - size;
+    }
+    if (!std::is_sorted(blocks.begin(), blocks.end()) ||
+        std::adjacent_find(blocks.begin(), blocks.end()) != blocks.end() ||
+        (!blocks.empty() && blocks.back() >= max_blocks) ||
+        file->Size() != sizeof(header) + table_size + data_size) {
+        LOG_WARNING(Loader, "NCA section cache {} is corrupted, ignoring it", path);
+        return;
+    }
+
+    cached_data = file->Data() + sizeof(header) + table_size;
+    cached_blocks = std::move(blocks);
+    mapping = std::move(file);
+}
+
+void SectionCacheFile::SaveCache() {
+    std::vector<u64> blocks;
+    {
+        std::lock_guard lock{mutex};
+        if (read_blocks.empty()) {
+            return;
+        }
+        blocks.reserve(cached_blocks.size() + read_blocks.size());
+        std::set_union(cached_blocks.begin(), cached_blocks.end(), read_blocks.begin(),
+                       read_blocks.end(), std::back_inserter(blocks));
+    }
+    blocks.resize(std::min(blocks.size(), MaxBlocks));
+
+    const std::string directory = path.substr(0, path.find_last_of(DIR_SEP_CHR));
+    if (!FileUtil::CreateFullPath(directory + DIR_SEP)) {
+        LOG_ERROR(Loader, "Failed to create directory={}", directory);
+        return;
+    }
+
+    // The current cache file is still mapped, the new one replaces it once it has been written
+    const std::string temp_path = path + ".tmp";
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        CacheHeader header{};
+        header.magic = CacheMagic;
+        header.version = CacheVersion;
+        header.header_hash = header_hash;
+        header.section_size = GetSize();
+        header.num_blocks = blocks.size();
+        if (!file.IsOpen() || file.WriteObject(header) != 1 ||
+            file.WriteArray(blocks.data(), blocks.size()) != blocks.size()) {
+            LOG_ERROR(Loader, "Failed to write NCA section cache {}", temp_path);
+            return;
+        }
+
+        std::vector<u8> block(BlockSize);
+        for (const u64 index : blocks) {
+            const u64 block_offset = index * BlockSize;
+            const std::size_t block_size = std::min<u64>(BlockSize, GetSize() - block_offset);
+            const std::size_t block_pos = FindBlock(index);
+            const u8* data = block.data();
+            if (block_pos != cached_blocks.size()) {
+                data = cached_data + block_pos * BlockSize;
+            } else if (base->Read(block.data(), block_size, block_offset) != block_size) {
+                LOG_ERROR(Loader, "Failed to read block {} of NCA section cache {}", index, path);
+                file.Close();
+                FileUtil::Delete(temp_path);
+                return;
+            }
+            if (file.WriteBytes(data, block_size) != block_size) {
+                LOG_ERROR(Loader, "Failed to write NCA section cache {}", temp_path);
+                file.Close();
+                FileUtil::Delete(temp_path);
+                return;
+            }
+        }
+    }
+
+    mapping.reset();
+    cached_data = nullptr;
+    cached_blocks.clear();
+    if (FileUtil::Exists(path)) {
+        FileUtil::Delete(path);
+    }
+    if (!FileUtil::Rename(temp_path, path)) {
+        LOG_ERROR(Loader, "Failed to replace NCA section cache {}", path);
+        FileUtil::Delete(temp_path);
+    }
+}
+
+std::size_t SectionCacheFile::FindBlock(u64 index) const {
+    const auto it = std::lower_bound(cached_blocks.begin(), cached_blocks.end(), index);
+    if (it == cached_blocks.end() || *it != index) {
+        return cached_blocks.size();
+    }
+    return static_cast<std::size_t>(it - cached_blocks.begin());
+}
+
+void SectionCacheFile::RecordBlocks(u64 first, u64 last) const {
+    std::lock_guard lock{mutex};
+    for (u64 index = first; index <= last; ++index) {
+        if (cached_blocks.size() + read_blocks.size() >= MaxBlocks) {
+            return;
+        }
+        read_blocks.insert(index);
+    }
+}
+
+} // namespace FileSys
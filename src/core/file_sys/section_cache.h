@@ -0,0 +1,92 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+#include "common/swap.h"
+#include "core/file_sys/vfs.h"
+
+namespace Common {
+class MappedFile;
+}
+
+namespace FileSys {
+
+/**
+ * Wraps the decrypted view of an NCA section and keeps the blocks read from it in a file on the
+ * host. The next time the section is opened those blocks are served from the mapped cache file
+ * instead of being decrypted again, and GetPointer can hand them out in place.
+ * The cache file is only trusted when it was written for an NCA with the same header hash, the
+ * header holds the master hash of every section so any change of the contents invalidates it.
+ */
+class SectionCacheFile : public VfsFile {
+public:
+    static constexpr std::size_t BlockSize = 0x10000;
+    /// Blocks kept per section, bounds the disk space of a single section to 128 MiB
+    static constexpr std::size_t MaxBlocks = 0x800;
+
+    SectionCacheFile(VirtualFile base, std::string path, const std::array<u8, 0x20>& header_hash);
+    ~SectionCacheFile() override;
+
+    /// Returns the path of the cache file of the section at section_offset of an NCA.
+    static std::string GetCachePath(std::string_view nca_id, u64 section_offset);
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetPointer(std::size_t length, std::size_t offset) const override;
+    bool Rename(std::string_view name) override;
+
+    /// Returns the number of blocks loaded from the cache file.
+    std::size_t GetCachedBlockCount() const;
+
+private:
+    struct CacheHeader {
+        u32_le magic;
+        u32_le version;
+        std::array<u8, 0x20> header_hash;
+        u64_le section_size;
+        u64_le num_blocks;
+    };
+    static_assert(sizeof(CacheHeader) == 0x38, "CacheHeader has incorrect size.");
+
+    static constexpr u32 CacheVersion = 1;
+
+    void LoadCache();
+
+    /// Writes the cached blocks and the ones read this session to the cache file.
+    void SaveCache();
+
+    /// Returns the position of a block in the cache file, or cached_blocks.size() if it's absent.
+    std::size_t FindBlock(u64 index) const;
+
+    /// Remembers blocks read from the base file so the next session finds them cached.
+    void RecordBlocks(u64 first, u64 last) const;
+
+    VirtualFile base;
+    std::string path;
+    std::array<u8, 0x20> header_hash;
+
+    std::unique_ptr<Common::MappedFile> mapping;
+    std::vector<u64> cached_blocks; ///< Sorted block indices of the cache file
+    const u8* cached_data = nullptr;
+
+    mutable std::mutex mutex;
+    mutable std::set<u64> read_blocks;
+};
+
+} // namespace FileSys
@@ -112,6 +112,9 @@ public:
     // Reads all the bytes from the file into a vector. Equivalent to 'file->Read(file->GetSize(),
     // 0)'
     virtual std::vector<u8> ReadAllBytes() const;
+    // Returns a pointer to length bytes starting at offset when the file's contents are in host
+    // memory, nullptr otherwise. The pointer stays valid for as long as the file is alive.
+    virtual const u8* GetPointer(std::size_t length, std::size_t offset = 0) const;
 
     // Reads an array of type T, size number_elements starting at offset.
     // Returns the number of bytes (sizeof(T)*number_elements) read successfully.
@@ -25,16 +25,34 @@ static bool VerifyConcatenationMapContinuity(const std::map<u64, VirtualFile>& m
 
 ConcatenatedVfsFile::ConcatenatedVfsFile(std::vector<VirtualFile> files_, std::string name)
     : name(std::move(name)) {
-    std::size_t next_offset = 0;
-    for (const auto& file : files_) {
-        files[next_offset] = file;
-        next_offset += file->GetSize();
+    u64 next_offset = 0;
+    for (auto& file : files_) {
+        const u64 size = file->GetSize();
+        if (size == 0) {
+            continue;
+        }
+        files.push_back(std::move(file));
+        offsets.push_back(next_offset);
+        next_offset += size;
     }
+    offsets.push_back(next_offset);
 }
 
 ConcatenatedVfsFile::ConcatenatedVfsFile(std::map<u64, VirtualFile> files_, std::string name)
-    : files(std::move(files_)), name(std::move(name)) {
-    ASSERT(VerifyConcatenationMapContinuity(files));
+    : name(std::move(name)) {
+    ASSERT(VerifyConcatenationMapContinuity(files_));
+
+    u64 end_offset = 0;
+    for (auto& [offset, file] : files_) {
+        const u64 size = file->GetSize();
+        if (size == 0) {
+            continue;
+        }
+        files.push_back(std::move(file));
+        offsets.push_back(offset);
+        end_offset = offset + size;
+    }
+    offsets.push_back(end_offset);
 }
 
 ConcatenatedVfsFile::~ConcatenatedVfsFile() = default;
@@ -79,13 +97,11 @@ std::string ConcatenatedVfsFile::GetName() const {
         return "";
     if (!name.empty())
         return name;
-    return files.begin()->second->GetName();
+    return files.front()->GetName();
 }
 
 std::size_t ConcatenatedVfsFile::GetSize() const {
-    if (files.empty())
-        return 0;
-    return files.rbegin()->first + files.rbegin()->second->GetSize();
+    return offsets.back();
 }
 
 bool ConcatenatedVfsFile::Resize(std::size_t new_size) {
@@ -95,7 +111,7 @@ bool ConcatenatedVfsFile::Resize(std::size_t new_size) {
 std::shared_ptr<VfsDirectory> ConcatenatedVfsFile::GetContainingDirectory() const {
     if (files.empty())
         return nullptr;
-    return files.begin()->second->GetContainingDirectory();
+    return files.front()->GetContainingDirectory();
 }
 
 bool ConcatenatedVfsFile::IsWritable() const {
@@ -107,33 +123,59 @@ bool ConcatenatedVfsFile::IsReadable() const {
 }
 
 std::size_t ConcatenatedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
-    auto entry = --files.end();
-    for (auto iter = files.begin(); iter != files.end(); ++iter) {
-        if (iter->first > offset) {
-            entry = --iter;
+    if (offset >= GetSize()) {
+        return 0;
+    }
+    length = std::min<u64>(length, GetSize() - offset);
+
+    // Search once, then hand each file its share of the range in a single pass
+    std::size_t read = 0;
+    for (std::size_t index = FindFile(offset); read < length; ++index) {
+        const std::size_t file_offset = offset + read - offsets[index];
+        const std::size_t file_length =
+            std::min<u64>(length - read, offsets[index + 1] - offsets[index] - file_offset);
+        const std::size_t file_read = files[index]->Read(data + read, file_length, file_offset);
+        read += file_read;
+        if (file_read != file_length) {
             break;
         }
     }
-
-    if (entry->first + entry->second->GetSize() <= offset)
-        return 0;
-
-    const auto read_in =
-        std::min<u64>(entry->first + entry->second->GetSize() - offset, entry->second->GetSize());
-    if (length > read_in) {
-        return entry->second->Read(data, read_in, offset - entry->first) +
-               Read(data + read_in, length - read_in, offset + read_in);
-    }
-
-    return entry->second->Read(data, std::min<u64>(read_in, length), offset - entry->first);
+    return read;
 }
 
 std::size_t ConcatenatedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
     return 0;
 }
 
+const u8* ConcatenatedVfsFile::GetPointer(std::size_t length, std::size_t offset) const {
+    if (offset >= GetSize()) {
+        return nullptr;
+    }
+
+    // Only ranges that don't cross the files are contiguous in memory
+    const std::size_t index = FindFile(offset);
+    const std::size_t file_offset = offset - offsets[index];
+    if (length > offsets[index + 1] - offsets[index] - file_offset) {
+        return nullptr;
+    }
+    return files[index]->GetPointer(length, file_offset);
+}
+
 bool ConcatenatedVfsFile::Rename(std::string_view name) {
     return false;
 }
 
+std::size_t ConcatenatedVfsFile::FindFile(std::size_t offset) const {
+    // Branch-free binary search for the last file starting at or before the offset, the first
+    // one always starts at 0. The conditional compiles to a cmov.
+    const u64* base = offsets.data();
+    std::size_t count = files.size();
+    while (count > 1) {
+        const std::size_t half = count / 2;
+        base = base[half] <= offset ? base + half : base;
+        count -= half;
+    }
+    return static_cast<std::size_t>(base - offsets.data());
+}
+
 } // namespace FileSys
@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <string_view>
+#include <vector>
 #include "core/file_sys/vfs.h"
 
 namespace FileSys {
@@ -36,11 +37,17 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetPointer(std::size_t length, std::size_t offset) const override;
     bool Rename(std::string_view name) override;
 
 private:
-    // Maps starting offset to file -- more efficient.
-    std::map<u64, VirtualFile> files;
+    /// Gets the index of the file holding the given offset, which has to be within the file.
+    std::size_t FindFile(std::size_t offset) const;
+
+    // Flat arrays instead of a map, these are searched on every read. Empty files are left out.
+    std::vector<VirtualFile> files;
+    /// Starting offset of each file, followed by the total size
+    std::vector<u64> offsets;
     std::string name;
 };
 
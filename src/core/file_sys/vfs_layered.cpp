@@ -2,7 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <algorithm>
+#include <string>
+#include <unordered_set>
 #include <utility>
 #include "core/file_sys/vfs_layered.h"
 
@@ -24,17 +25,31 @@ VirtualDir LayeredVfsDirectory::MakeLayeredDirectory(std::vector<VirtualDir> dir
 }
 
 std::shared_ptr<VfsFile> LayeredVfsDirectory::GetFileRelative(std::string_view path) const {
+    std::lock_guard lock{cache_mutex};
+    const auto [it, inserted] = file_cache.try_emplace(std::string(path));
+    if (!inserted) {
+        return it->second;
+    }
+
     for (const auto& layer : dirs) {
-        const auto file = layer->GetFileRelative(path);
-        if (file != nullptr)
-            return file;
+        auto file = layer->GetFileRelative(path);
+        if (file != nullptr) {
+            it->second = std::move(file);
+            break;
+        }
     }
 
-    return nullptr;
+    return it->second;
 }
 
 std::shared_ptr<VfsDirectory> LayeredVfsDirectory::GetDirectoryRelative(
     std::string_view path) const {
+    std::lock_guard lock{cache_mutex};
+    const auto [it, inserted] = directory_cache.try_emplace(std::string(path));
+    if (!inserted) {
+        return it->second;
+    }
+
     std::vector<VirtualDir> out;
     for (const auto& layer : dirs) {
         auto dir = layer->GetDirectoryRelative(path);
@@ -42,7 +57,9 @@ std::shared_ptr<VfsDirectory> LayeredVfsDirectory::GetDirectoryRelative(
             out.push_back(std::move(dir));
     }
 
-    return MakeLayeredDirectory(std::move(out));
+    // The merged directory is kept too, so lookups through it are cached as well
+    it->second = MakeLayeredDirectory(std::move(out));
+    return it->second;
 }
 
 std::shared_ptr<VfsFile> LayeredVfsDirectory::GetFile(std::string_view name) const {
@@ -59,12 +76,11 @@ std::string LayeredVfsDirectory::GetFullPath() const {
 
 std::vector<std::shared_ptr<VfsFile>> LayeredVfsDirectory::GetFiles() const {
     std::vector<VirtualFile> out;
+    std::unordered_set<std::string> names;
     for (const auto& layer : dirs) {
-        for (const auto& file : layer->GetFiles()) {
-            if (std::find_if(out.begin(), out.end(), [&file](const VirtualFile& comp) {
-                    return comp->GetName() == file->GetName();
-                }) == out.end()) {
-                out.push_back(file);
+        for (auto& file : layer->GetFiles()) {
+            if (names.insert(file->GetName()).second) {
+                out.push_back(std::move(file));
             }
         }
     }
@@ -74,9 +90,10 @@ std::vector<std::shared_ptr<VfsFile>> LayeredVfsDirectory::GetFiles() const {
 
 std::vector<std::shared_ptr<VfsDirectory>> LayeredVfsDirectory::GetSubdirectories() const {
     std::vector<std::string> names;
+    std::unordered_set<std::string> known_names;
     for (const auto& layer : dirs) {
         for (const auto& sd : layer->GetSubdirectories()) {
-            if (std::find(names.begin(), names.end(), sd->GetName()) == names.end())
+            if (known_names.insert(sd->GetName()).second)
                 names.push_back(sd->GetName());
         }
     }
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include "core/file_sys/vfs.h"
 
 namespace FileSys {
@@ -12,6 +15,9 @@ namespace FileSys {
 // Class that stacks multiple VfsDirectories on top of each other, attempting to read from the first
 // one and falling back to the one after. The highest priority directory (overwrites all others)
 // should be element 0 in the dirs vector.
+// Path lookups are cached, including the ones that found nothing, so each path walks the layers
+// only once. The layers must not change while they're layered, the directory itself can't be
+// written to.
 class LayeredVfsDirectory : public VfsDirectory {
     LayeredVfsDirectory(std::vector<VirtualDir> dirs, std::string name);
 
@@ -42,6 +48,10 @@ public:
 private:
     std::vector<VirtualDir> dirs;
     std::string name;
+
+    mutable std::mutex cache_mutex;
+    mutable std::unordered_map<std::string, VirtualFile> file_cache;
+    mutable std::unordered_map<std::string, VirtualDir> directory_cache;
 };
 
 } // namespace FileSys
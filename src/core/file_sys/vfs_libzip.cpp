@@ -2,75 +2,490 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 #include <zip.h>
-#include "common/logging/backend.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
 #include "core/file_sys/vfs.h"
 #include "core/file_sys/vfs_libzip.h"
+#include "core/file_sys/vfs_offset.h"
 #include "core/file_sys/vfs_vector.h"
 
 namespace FileSys {
 
-VirtualDir ExtractZIP(VirtualFile file) {
-    zip_error_t error{};
+namespace {
 
-    const auto data = file->ReadAllBytes();
-    std::unique_ptr<zip_source_t, decltype(&zip_source_close)> src{
-        zip_source_buffer_create(data.data(), data.size(), 0, &error), zip_source_close};
-    if (src == nullptr)
-        return nullptr;
+constexpr u32 LocalHeaderMagic = 0x04034B50;
+constexpr u32 CentralHeaderMagic = 0x02014B50;
+constexpr u32 EndOfCentralDirMagic = 0x06054B50;
+constexpr u32 Zip64EndOfCentralDirMagic = 0x06064B50;
+constexpr u32 Zip64LocatorMagic = 0x07064B50;
 
-    std::unique_ptr<zip_t, decltype(&zip_close)> zip{zip_open_from_source(src.get(), 0, &error),
-                                                     zip_close};
-    if (zip == nullptr)
-        return nullptr;
+// The end of central directory record is followed by a comment of up to this many bytes
+constexpr std::size_t MaxCommentSize = 0xFFFF;
 
-    std::shared_ptr<VectorVfsDirectory> out = std::make_shared<VectorVfsDirectory>();
+constexpr u16 Zip64ExtraId = 0x0001;
+constexpr u16 FlagEncrypted = 0x0001;
+constexpr u16 MethodStored = 0;
 
-    const auto num_entries = zip_get_num_entries(zip.get(), 0);
+#pragma pack(push, 1)
+struct EndOfCentralDir {
+    u32_le magic;
+    u16_le disk;
+    u16_le directory_disk;
+    u16_le disk_entries;
+    u16_le num_entries;
+    u32_le directory_size;
+    u32_le directory_offset;
+    u16_le comment_size;
+};
+static_assert(sizeof(EndOfCentralDir) == 0x16, "EndOfCentralDir has incorrect size.");
 
-    zip_stat_t stat{};
-    zip_stat_init(&stat);
+struct Zip64Locator {
+    u32_le magic;
+    u32_le directory_disk;
+    u64_le end_offset;
+    u32_le num_disks;
+};
+static_assert(sizeof(Zip64Locator) == 0x14, "Zip64Locator has incorrect size.");
 
-    for (std::size_t i = 0; i < num_entries; ++i) {
-        const auto stat_res = zip_stat_index(zip.get(), i, 0, &stat);
-        if (stat_res == -1)
-            return nullptr;
+struct Zip64EndOfCentralDir {
+    u32_le magic;
+    u64_le record_size;
+    u16_le version;
+    u16_le version_needed;
+    u32_le disk;
+    u32_le directory_disk;
+    u64_le disk_entries;
+    u64_le num_entries;
+    u64_le directory_size;
+    u64_le directory_offset;
+};
+static_assert(sizeof(Zip64EndOfCentralDir) == 0x38, "Zip64EndOfCentralDir has incorrect size.");
+
+struct CentralHeader {
+    u32_le magic;
+    u16_le version;
+    u16_le version_needed;
+    u16_le flags;
+    u16_le method;
+    u16_le time;
+    u16_le date;
+    u32_le crc;
+    u32_le compressed_size;
+    u32_le size;
+    u16_le name_size;
+    u16_le extra_size;
+    u16_le comment_size;
+    u16_le disk;
+    u16_le internal_attributes;
+    u32_le external_attributes;
+    u32_le local_offset;
+};
+static_assert(sizeof(CentralHeader) == 0x2E, "CentralHeader has incorrect size.");
+
+struct LocalHeader {
+    u32_le magic;
+    u16_le version_needed;
+    u16_le flags;
+    u16_le method;
+    u16_le time;
+    u16_le date;
+    u32_le crc;
+    u32_le compressed_size;
+    u32_le size;
+    u16_le name_size;
+    u16_le extra_size;
+};
+static_assert(sizeof(LocalHeader) == 0x1E, "LocalHeader has incorrect size.");
+#pragma pack(pop)
+
+struct ZipEntry {
+    std::string name;
+    u64 index;
+    u16 flags;
+    u16 method;
+    u64 size;
+    u64 compressed_size;
+    u64 local_offset;
+};
 
-        const std::string name(stat.name);
-        if (name.empty())
+template <typename T>
+T ReadAt(const u8* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+/// Replaces the sizes and offset that don't fit the central header with their ZIP64 values.
+void ReadZip64Extra(const u8* extra, std::size_t extra_size, ZipEntry& entry) {
+    std::size_t pos = 0;
+    while (pos + 4 <= extra_size) {
+        const u16 id = ReadAt<u16_le>(extra + pos);
+        const u16 field_size = ReadAt<u16_le>(extra + pos + 2);
+        const u8* const field = extra + pos + 4;
+        pos += 4 + field_size;
+        if (pos > extra_size) {
+            return;
+        }
+        if (id != Zip64ExtraId) {
             continue;
+        }
 
-        if (name.back() != '/') {
-            std::unique_ptr<zip_file_t, decltype(&zip_fclose)> file{
-                zip_fopen_index(zip.get(), i, 0), zip_fclose};
+        // Only the values saturated in the central header are present, in this order
+        std::size_t offset = 0;
+        for (u64* const value : {&entry.size, &entry.compressed_size, &entry.local_offset}) {
+            if (*value == 0xFFFFFFFF && offset + sizeof(u64) <= field_size) {
+                *value = ReadAt<u64_le>(field + offset);
+                offset += sizeof(u64);
+            }
+        }
+        return;
+    }
+}
 
-            std::vector<u8> buf(stat.size);
-            if (zip_fread(file.get(), buf.data(), buf.size()) != buf.size())
-                return nullptr;
+/// Reads the entries of the central directory, returns nullopt if the file isn't a ZIP archive.
+std::optional<std::vector<ZipEntry>> ReadCentralDirectory(const VfsFile& file) {
+    const std::size_t file_size = file.GetSize();
+    if (file_size < sizeof(EndOfCentralDir)) {
+        return std::nullopt;
+    }
+    const std::size_t tail_size =
+        std::min(file_size, sizeof(EndOfCentralDir) + MaxCommentSize);
+    const std::vector<u8> tail = file.ReadBytes(tail_size, file_size - tail_size);
+    if (tail.size() != tail_size) {
+        return std::nullopt;
+    }
+
+    // Search backwards, the comment can't contain the magic of a valid record after it
+    std::size_t end_pos = tail_size - sizeof(EndOfCentralDir) + 1;
+    while (end_pos-- > 0 && ReadAt<u32_le>(tail.data() + end_pos) != EndOfCentralDirMagic) {
+    }
+    if (end_pos == static_cast<std::size_t>(-1)) {
+        return std::nullopt;
+    }
+    const auto end = ReadAt<EndOfCentralDir>(tail.data() + end_pos);
+    u64 num_entries = end.num_entries;
+    u64 directory_size = end.directory_size;
+    u64 directory_offset = end.directory_offset;
+
+    const u64 end_offset = file_size - tail_size + end_pos;
+    if ((num_entries == 0xFFFF || directory_size == 0xFFFFFFFF ||
+         directory_offset == 0xFFFFFFFF) &&
+        end_offset >= sizeof(Zip64Locator)) {
+        Zip64Locator locator{};
+        Zip64EndOfCentralDir end64{};
+        if (file.ReadObject(&locator, end_offset - sizeof(locator)) == sizeof(locator) &&
+            locator.magic == Zip64LocatorMagic &&
+            file.ReadObject(&end64, locator.end_offset) == sizeof(end64) &&
+            end64.magic == Zip64EndOfCentralDirMagic) {
+            num_entries = end64.num_entries;
+            directory_size = end64.directory_size;
+            directory_offset = end64.directory_offset;
+        }
+    }
+    if (directory_size > file_size || directory_offset > file_size - directory_size) {
+        return std::nullopt;
+    }
+
+    const std::vector<u8> directory =
+        file.ReadBytes(static_cast<std::size_t>(directory_size), directory_offset);
+    if (directory.size() != directory_size) {
+        return std::nullopt;
+    }
 
-            const auto parts = FileUtil::SplitPathComponents(stat.name);
-            const auto new_file = std::make_shared<VectorVfsFile>(buf, parts.back());
-
-            std::shared_ptr<VectorVfsDirectory> dtrv = out;
-            for (std::size_t j = 0; j < parts.size() - 1; ++j) {
-                if (dtrv == nullptr)
-                    return nullptr;
-                const auto subdir = dtrv->GetSubdirectory(parts[j]);
-                if (subdir == nullptr) {
-                    const auto temp = std::make_shared<VectorVfsDirectory>(
-                        std::vector<VirtualFile>{}, std::vector<VirtualDir>{}, parts[j]);
-                    dtrv->AddDirectory(temp);
-                    dtrv = temp;
-                } else {
-                    dtrv = std::dynamic_pointer_cast<VectorVfsDirectory>(subdir);
-                }
+    std::vector<ZipEntry> entries;
+    entries.reserve(std::min<u64>(num_entries, directory.size() / sizeof(CentralHeader)));
+    std::size_t pos = 0;
+    for (u64 index = 0; index < num_entries; ++index) {
+        if (directory.size() - pos < sizeof(CentralHeader)) {
+            return std::nullopt;
+        }
+        const auto header = ReadAt<CentralHeader>(directory.data() + pos);
+        const std::size_t name_pos = pos + sizeof(CentralHeader);
+        const std::size_t extra_pos = name_pos + header.name_size;
+        pos = extra_pos + header.extra_size + header.comment_size;
+        if (header.magic != CentralHeaderMagic || pos > directory.size()) {
+            return std::nullopt;
+        }
+
+        ZipEntry entry{};
+        entry.name.assign(reinterpret_cast<const char*>(directory.data() + name_pos),
+                          header.name_size);
+        entry.index = index;
+        entry.flags = header.flags;
+        entry.method = header.method;
+        entry.size = header.size;
+        entry.compressed_size = header.compressed_size;
+        entry.local_offset = header.local_offset;
+        ReadZip64Extra(directory.data() + extra_pos, header.extra_size, entry);
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+/// Returns the offset of the data of an entry, which follows its local header.
+std::optional<u64> GetDataOffset(const VfsFile& file, const ZipEntry& entry) {
+    LocalHeader header{};
+    if (file.ReadObject(&header, entry.local_offset) != sizeof(header) ||
+        header.magic != LocalHeaderMagic) {
+        return std::nullopt;
+    }
+    const u64 offset = entry.local_offset + sizeof(header) + header.name_size + header.extra_size;
+    if (entry.size > file.GetSize() || offset > file.GetSize() - entry.size) {
+        return std::nullopt;
+    }
+    return offset;
+}
+
+/**
+ * The archive opened with libzip to decompress entries. libzip reads the file through a source
+ * callback, so only the parts of it that are needed are read.
+ */
+class ZipArchive {
+public:
+    explicit ZipArchive(VirtualFile file) : file{std::move(file)} {
+        zip_error_init(&error);
+    }
+
+    ~ZipArchive() {
+        if (zip != nullptr) {
+            zip_discard(zip);
+        }
+        zip_error_fini(&error);
+    }
+
+    /// Decompresses an entry of the given size, returns nullopt if it couldn't be.
+    std::optional<std::vector<u8>> Decompress(u64 index, std::size_t size) {
+        std::lock_guard lock{mutex};
+        if (zip == nullptr && !Open()) {
+            return std::nullopt;
+        }
+
+        std::unique_ptr<zip_file_t, decltype(&zip_fclose)> entry{zip_fopen_index(zip, index, 0),
+                                                                 zip_fclose};
+        if (entry == nullptr) {
+            return std::nullopt;
+        }
+        std::vector<u8> data(size);
+        if (zip_fread(entry.get(), data.data(), size) != static_cast<zip_int64_t>(size)) {
+            return std::nullopt;
+        }
+        return data;
+    }
+
+private:
+    bool Open() {
+        zip_source_t* const source =
+            zip_source_function_create(&ZipArchive::SourceCallback, this, &error);
+        if (source == nullptr) {
+            return false;
+        }
+        zip = zip_open_from_source(source, ZIP_RDONLY, &error);
+        if (zip == nullptr) {
+            LOG_ERROR(Service_FS, "libzip could not open {}: {}", file->GetName(),
+                      zip_error_strerror(&error));
+            zip_source_free(source);
+            return false;
+        }
+        return true;
+    }
+
+    static zip_int64_t SourceCallback(void* userdata, void* data, zip_uint64_t length,
+                                      zip_source_cmd_t command) {
+        auto* const archive = static_cast<ZipArchive*>(userdata);
+        switch (command) {
+        case ZIP_SOURCE_OPEN:
+            archive->position = 0;
+            return 0;
+        case ZIP_SOURCE_READ: {
+            const std::size_t read = archive->file->Read(
+                static_cast<u8*>(data), static_cast<std::size_t>(length), archive->position);
+            archive->position += read;
+            return static_cast<zip_int64_t>(read);
+        }
+        case ZIP_SOURCE_CLOSE:
+        case ZIP_SOURCE_FREE:
+            return 0;
+        case ZIP_SOURCE_STAT: {
+            auto* const stat = static_cast<zip_stat_t*>(data);
+            zip_stat_init(stat);
+            stat->valid |= ZIP_STAT_SIZE;
+            stat->size = archive->file->GetSize();
+            return sizeof(zip_stat_t);
+        }
+        case ZIP_SOURCE_SEEK: {
+            const zip_int64_t offset = zip_source_seek_compute_offset(
+                archive->position, archive->file->GetSize(), data, length, &archive->error);
+            if (offset < 0) {
+                return -1;
+            }
+            archive->position = static_cast<std::size_t>(offset);
+            return 0;
+        }
+        case ZIP_SOURCE_TELL:
+            return static_cast<zip_int64_t>(archive->position);
+        case ZIP_SOURCE_ERROR:
+            return zip_error_to_data(&archive->error, data, length);
+        case ZIP_SOURCE_SUPPORTS:
+            return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ,
+                                                  ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT,
+                                                  ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE,
+                                                  ZIP_SOURCE_SEEK, ZIP_SOURCE_TELL,
+                                                  ZIP_SOURCE_SUPPORTS, -1);
+        default:
+            zip_error_set(&archive->error, ZIP_ER_OPNOTSUPP, 0);
+            return -1;
+        }
+    }
+
+    VirtualFile file;
+    std::mutex mutex;
+    zip_t* zip = nullptr;
+    zip_error_t error;
+    std::size_t position = 0; ///< Read position of the source, only used by libzip
+};
+
+/**
+ * Compressed entry of a ZIP archive, decompressed when it's first read. The contents are dropped
+ * once a read reaches the end, as files are usually read through once.
+ */
+class CompressedZipFile : public VfsFile {
+public:
+    CompressedZipFile(std::shared_ptr<ZipArchive> archive, u64 index, std::size_t size,
+                      std::string name)
+        : archive{std::move(archive)}, index{index}, size{size}, name{std::move(name)} {}
+
+    std::string GetName() const override {
+        return name;
+    }
+
+    std::size_t GetSize() const override {
+        return size;
+    }
+
+    bool Resize(std::size_t new_size) override {
+        return false;
+    }
+
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override {
+        return nullptr;
+    }
+
+    bool IsWritable() const override {
+        return false;
+    }
+
+    bool IsReadable() const override {
+        return true;
+    }
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        if (offset >= size) {
+            return 0;
+        }
+        length = std::min(length, size - offset);
+
+        std::lock_guard lock{mutex};
+        if (!contents) {
+            contents = archive->Decompress(index, size);
+            if (!contents) {
+                LOG_ERROR(Service_FS, "Could not decompress {} from a ZIP archive.", name);
+                return 0;
+            }
+        }
+        std::memcpy(data, contents->data() + offset, length);
+        if (offset + length == size) {
+            contents.reset();
+        }
+        return length;
+    }
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        return 0;
+    }
+
+    bool Rename(std::string_view new_name) override {
+        name = new_name;
+        return true;
+    }
+
+private:
+    std::shared_ptr<ZipArchive> archive;
+    u64 index;
+    std::size_t size;
+    std::string name;
+
+    mutable std::mutex mutex;
+    mutable std::optional<std::vector<u8>> contents;
+};
+
+} // Anonymous namespace
+
+VirtualDir OpenZIP(VirtualFile file) {
+    if (file == nullptr) {
+        return nullptr;
+    }
+    const auto entries = ReadCentralDirectory(*file);
+    if (!entries) {
+        LOG_ERROR(Service_FS, "{} is not a valid ZIP archive.", file->GetName());
+        return nullptr;
+    }
+
+    const auto archive = std::make_shared<ZipArchive>(file);
+    std::shared_ptr<VectorVfsDirectory> out = std::make_shared<VectorVfsDirectory>();
+
+    for (const ZipEntry& entry : *entries) {
+        if (entry.name.empty() || entry.name.back() == '/') {
+            continue;
+        }
+        if ((entry.flags & FlagEncrypted) != 0) {
+            LOG_WARNING(Service_FS, "Skipping encrypted ZIP entry {}.", entry.name);
+            continue;
+        }
+
+        const auto parts = FileUtil::SplitPathComponents(entry.name);
+        const std::string& name = parts.back();
+        const auto size = static_cast<std::size_t>(entry.size);
+        VirtualFile new_file;
+        if (entry.method == MethodStored) {
+            const auto offset = GetDataOffset(*file, entry);
+            if (!offset) {
+                LOG_ERROR(Service_FS, "ZIP entry {} has an invalid local header.", entry.name);
+                return nullptr;
             }
+            const auto data_offset = static_cast<std::size_t>(*offset);
+            new_file = std::make_shared<OffsetVfsFile>(file, size, data_offset, name);
+        } else {
+            new_file = std::make_shared<CompressedZipFile>(archive, entry.index, size, name);
+        }
 
+        std::shared_ptr<VectorVfsDirectory> dtrv = out;
+        for (std::size_t j = 0; j < parts.size() - 1; ++j) {
             if (dtrv == nullptr)
                 return nullptr;
-            dtrv->AddFile(new_file);
+            const auto subdir = dtrv->GetSubdirectory(parts[j]);
+            if (subdir == nullptr) {
+                const auto temp = std::make_shared<VectorVfsDirectory>(
+                    std::vector<VirtualFile>{}, std::vector<VirtualDir>{}, parts[j]);
+                dtrv->AddDirectory(temp);
+                dtrv = temp;
+            } else {
+                dtrv = std::dynamic_pointer_cast<VectorVfsDirectory>(subdir);
+            }
         }
+
+        if (dtrv == nullptr)
+            return nullptr;
+        dtrv->AddFile(new_file);
     }
 
     return out;
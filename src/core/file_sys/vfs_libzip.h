@@ -8,6 +8,11 @@
 
 namespace FileSys {
 
-VirtualDir ExtractZIP(VirtualFile zip);
+/**
+ * Opens a ZIP archive as a read-only directory. Only the central directory is read up front:
+ * stored entries are views into the archive and compressed ones are decompressed when read.
+ * Returns nullptr if the file is not a valid ZIP archive.
+ */
+VirtualDir OpenZIP(VirtualFile zip);
 
 } // namespace FileSys
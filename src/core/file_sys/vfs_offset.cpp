@@ -72,6 +72,13 @@ std::vector<u8> OffsetVfsFile::ReadAllBytes() const {
     return file->ReadBytes(size, offset);
 }
 
+const u8* OffsetVfsFile::GetPointer(std::size_t length, std::size_t r_offset) const {
+    if (r_offset > size || length > size - r_offset) {
+        return nullptr;
+    }
+    return file->GetPointer(length, offset + r_offset);
+}
+
 bool OffsetVfsFile::WriteByte(u8 data, std::size_t r_offset) {
     if (r_offset < size)
         return file->WriteByte(data, offset + r_offset);
@@ -4,12 +4,14 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
 #include <utility>
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/mapped_file.h"
 #include "core/file_sys/vfs_real.h"
 
 namespace FileSys {
@@ -66,21 +68,37 @@ VfsEntryType RealVfsFilesystem::GetEntryType(std::string_view path_) const {
 
 VirtualFile RealVfsFilesystem::OpenFile(std::string_view path_, Mode perms) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
-    if (cache.find(path) != cache.end()) {
-        auto weak = cache[path];
-        if (!weak.expired()) {
-            return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, weak.lock(), path, perms));
+    std::lock_guard lock{cache_mutex};
+    if (const auto it = cache.find(path); it != cache.end()) {
+        if (auto backing = it->second.file.lock()) {
+            return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, std::move(backing),
+                                                                it->second.mapping.lock(), path,
+                                                                perms, it->second.cache_id));
         }
+        // The file may have been changed on the host since it was last opened
+        InvalidateFile(path);
     }
 
     if (!FileUtil::Exists(path) && (perms & Mode::WriteAppend) != 0)
         FileUtil::CreateEmptyFile(path);
 
     auto backing = std::make_shared<FileUtil::IOFile>(path, ModeFlagsToString(perms).c_str());
-    cache[path] = backing;
+    // Read only handles can't change the file, they're read in place from a mapping. Files that
+    // can't be mapped go through the block cache.
+    std::shared_ptr<Common::MappedFile> mapping;
+    u64 cache_id = 0;
+    if (perms == Mode::Read && backing->IsOpen()) {
+        mapping = std::make_shared<Common::MappedFile>(path);
+        if (!mapping->IsOpen()) {
+            mapping.reset();
+            cache_id = block_cache.GenerateFileId();
+        }
+    }
+    cache[path] = {backing, mapping, cache_id};
 
     // Cannot use make_shared as RealVfsFile constructor is private
-    return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, backing, path, perms));
+    return std::shared_ptr<RealVfsFile>(
+        new RealVfsFile(*this, backing, std::move(mapping), path, perms, cache_id));
 }
 
 VirtualFile RealVfsFilesystem::CreateFile(std::string_view path_, Mode perms) {
@@ -116,13 +134,17 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
         FileUtil::IsDirectory(old_path) || !FileUtil::Rename(old_path, new_path))
         return nullptr;
 
-    if (cache.find(old_path) != cache.end()) {
-        auto cached = cache[old_path];
-        if (!cached.expired()) {
-            auto file = cached.lock();
-            file->Open(new_path, "r+b");
-            cache.erase(old_path);
-            cache[new_path] = file;
+    {
+        std::lock_guard lock{cache_mutex};
+        if (cache.find(old_path) != cache.end()) {
+            InvalidateFile(old_path);
+            auto cached = cache[old_path];
+            if (!cached.file.expired()) {
+                auto file = cached.file.lock();
+                file->Open(new_path, "r+b");
+                cache.erase(old_path);
+                cache[new_path] = {file, {}, 0};
+            }
         }
     }
     return OpenFile(new_path, Mode::ReadWrite);
@@ -130,9 +152,11 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
 
 bool RealVfsFilesystem::DeleteFile(std::string_view path_) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{cache_mutex};
     if (cache.find(path) != cache.end()) {
-        if (!cache[path].expired())
-            cache[path].lock()->Close();
+        InvalidateFile(path);
+        if (!cache[path].file.expired())
+            cache[path].file.lock()->Close();
         cache.erase(path);
     }
     return FileUtil::Delete(path);
@@ -179,20 +203,24 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
         FileUtil::IsDirectory(old_path) || !FileUtil::Rename(old_path, new_path))
         return nullptr;
 
-    for (auto& kv : cache) {
-        // Path in cache starts with old_path
-        if (kv.first.rfind(old_path, 0) == 0) {
-            const auto file_old_path =
-                FileUtil::SanitizePath(kv.first, FileUtil::DirectorySeparator::PlatformDefault);
-            const auto file_new_path =
-                FileUtil::SanitizePath(new_path + DIR_SEP + kv.first.substr(old_path.size()),
-                                       FileUtil::DirectorySeparator::PlatformDefault);
-            auto cached = cache[file_old_path];
-            if (!cached.expired()) {
-                auto file = cached.lock();
-                file->Open(file_new_path, "r+b");
-                cache.erase(file_old_path);
-                cache[file_new_path] = file;
+    {
+        std::lock_guard lock{cache_mutex};
+        for (auto& kv : cache) {
+            // Path in cache starts with old_path
+            if (kv.first.rfind(old_path, 0) == 0) {
+                const auto file_old_path =
+                    FileUtil::SanitizePath(kv.first, FileUtil::DirectorySeparator::PlatformDefault);
+                const auto file_new_path =
+                    FileUtil::SanitizePath(new_path + DIR_SEP + kv.first.substr(old_path.size()),
+                                           FileUtil::DirectorySeparator::PlatformDefault);
+                InvalidateFile(file_old_path);
+                auto cached = cache[file_old_path];
+                if (!cached.file.expired()) {
+                    auto file = cached.file.lock();
+                    file->Open(file_new_path, "r+b");
+                    cache.erase(file_old_path);
+                    cache[file_new_path] = {file, {}, 0};
+                }
             }
         }
     }
@@ -202,24 +230,35 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
 
 bool RealVfsFilesystem::DeleteDirectory(std::string_view path_) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{cache_mutex};
     for (auto& kv : cache) {
         // Path in cache starts with old_path
         if (kv.first.rfind(path, 0) == 0) {
-            if (!cache[kv.first].expired())
-                cache[kv.first].lock()->Close();
+            InvalidateFile(kv.first);
+            if (!cache[kv.first].file.expired())
+                cache[kv.first].file.lock()->Close();
             cache.erase(kv.first);
         }
     }
     return FileUtil::DeleteDirRecursively(path);
 }
 
+void RealVfsFilesystem::InvalidateFile(const std::string& path) {
+    const auto it = cache.find(path);
+    if (it != cache.end() && it->second.cache_id != 0) {
+        block_cache.Invalidate(it->second.cache_id);
+        it->second.cache_id = 0;
+    }
+}
+
 RealVfsFile::RealVfsFile(RealVfsFilesystem& base_, std::shared_ptr<FileUtil::IOFile> backing_,
-                         const std::string& path_, Mode perms_)
-    : base(base_), backing(std::move(backing_)), path(path_),
+                         std::shared_ptr<Common::MappedFile> mapping_, const std::string& path_,
+                         Mode perms_, u64 cache_id_)
+    : base(base_), backing(std::move(backing_)), mapping(std::move(mapping_)), path(path_),
       parent_path(FileUtil::GetParentPath(path_)),
       path_components(FileUtil::SplitPathComponents(path_)),
       parent_components(FileUtil::SliceVector(path_components, 0, path_components.size() - 1)),
-      perms(perms_) {}
+      perms(perms_), cache_id(cache_id_) {}
 
 RealVfsFile::~RealVfsFile() = default;
 
@@ -248,9 +287,23 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
-    if (!backing->Seek(offset, SEEK_SET))
-        return 0;
-    return backing->ReadBytes(data, length);
+    if (mapping) {
+        if (offset >= mapping->Size())
+            return 0;
+        const std::size_t read = std::min(length, mapping->Size() - offset);
+        std::memcpy(data, mapping->Data() + offset, read);
+        return read;
+    }
+    if (cache_id == 0) {
+        if (!backing->Seek(offset, SEEK_SET))
+            return 0;
+        return backing->ReadBytes(data, length);
+    }
+    const bool sequential = next_read_offset.exchange(offset + length) == offset;
+    return base.block_cache.Read(cache_id, data, length, offset, sequential,
+                                 [this](u8* out, std::size_t size, u64 position) {
+                                     return backing->ReadAt(out, size, position);
+                                 });
 }
 
 std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
@@ -259,6 +312,12 @@ std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t o
     return backing->WriteBytes(data, length);
 }
 
+const u8* RealVfsFile::GetPointer(std::size_t length, std::size_t offset) const {
+    if (!mapping || offset > mapping->Size() || length > mapping->Size() - offset)
+        return nullptr;
+    return mapping->Data() + offset;
+}
+
 bool RealVfsFile::Rename(std::string_view name) {
     return base.MoveFile(path, parent_path + DIR_SEP + std::string(name)) != nullptr;
 }
@@ -277,11 +336,10 @@ std::vector<VirtualFile> RealVfsDirectory::IterateEntries<RealVfsFile, VfsFile>(
 
     std::vector<VirtualFile> out;
     FileUtil::ForeachDirectoryEntry(
-        nullptr, path,
-        [&out, this](u64* entries_out, const std::string& directory, const std::string& filename) {
-            const std::string full_path = directory + DIR_SEP + filename;
-            if (!FileUtil::IsDirectory(full_path))
-                out.emplace_back(base.OpenFile(full_path, perms));
+        path, [&out, this](const std::string& directory, const std::string& filename,
+                           bool is_directory) {
+            if (!is_directory)
+                out.emplace_back(base.OpenFile(directory + DIR_SEP + filename, perms));
             return true;
         });
 
@@ -295,11 +353,10 @@ std::vector<VirtualDir> RealVfsDirectory::IterateEntries<RealVfsDirectory, VfsDi
 
     std::vector<VirtualDir> out;
     FileUtil::ForeachDirectoryEntry(
-        nullptr, path,
-        [&out, this](u64* entries_out, const std::string& directory, const std::string& filename) {
-            const std::string full_path = directory + DIR_SEP + filename;
-            if (FileUtil::IsDirectory(full_path))
-                out.emplace_back(base.OpenDirectory(full_path, perms));
+        path, [&out, this](const std::string& directory, const std::string& filename,
+                           bool is_directory) {
+            if (is_directory)
+                out.emplace_back(base.OpenDirectory(directory + DIR_SEP + filename, perms));
             return true;
         });
 
@@ -419,11 +476,8 @@ std::map<std::string, VfsEntryType, std::less<>> RealVfsDirectory::GetEntries()
 
     std::map<std::string, VfsEntryType, std::less<>> out;
     FileUtil::ForeachDirectoryEntry(
-        nullptr, path,
-        [&out](u64* entries_out, const std::string& directory, const std::string& filename) {
-            const std::string full_path = directory + DIR_SEP + filename;
-            out.emplace(filename, FileUtil::IsDirectory(full_path) ? VfsEntryType::Directory
-                                                                   : VfsEntryType::File);
+        path, [&out](const std::string&, const std::string& filename, bool is_directory) {
+            out.emplace(filename, is_directory ? VfsEntryType::Directory : VfsEntryType::File);
             return true;
         });
 
@@ -4,11 +4,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <string_view>
 #include <boost/container/flat_map.hpp>
+#include "core/file_sys/block_cache.h"
 #include "core/file_sys/mode.h"
 #include "core/file_sys/vfs.h"
 
+namespace Common {
+class MappedFile;
+}
+
 namespace FileUtil {
 class IOFile;
 }
@@ -36,7 +43,24 @@ public:
     bool DeleteDirectory(std::string_view path) override;
 
 private:
-    boost::container::flat_map<std::string, std::weak_ptr<FileUtil::IOFile>> cache;
+    friend class RealVfsFile;
+
+    /// Host memory used to cache the contents of files opened for reading
+    static constexpr std::size_t BlockCacheSize = 64 * 1024 * 1024;
+
+    struct OpenedFile {
+        std::weak_ptr<FileUtil::IOFile> file;
+        std::weak_ptr<Common::MappedFile> mapping; ///< Contents of read only files
+        u64 cache_id = 0; ///< Identifier of the file in the block cache, zero when it's not cached
+    };
+
+    /// Drops the cached blocks of a file that is going to change on the host, cache_mutex has to
+    /// be held
+    void InvalidateFile(const std::string& path);
+
+    std::mutex cache_mutex; ///< Guards cache, files may be opened from several threads
+    boost::container::flat_map<std::string, OpenedFile> cache;
+    BlockCache block_cache{BlockCacheSize};
 };
 
 // An implmentation of VfsFile that represents a file on the user's computer.
@@ -55,21 +79,26 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetPointer(std::size_t length, std::size_t offset) const override;
     bool Rename(std::string_view name) override;
 
 private:
     RealVfsFile(RealVfsFilesystem& base, std::shared_ptr<FileUtil::IOFile> backing,
-                const std::string& path, Mode perms = Mode::Read);
+                std::shared_ptr<Common::MappedFile> mapping, const std::string& path,
+                Mode perms = Mode::Read, u64 cache_id = 0);
 
     bool Close();
 
     RealVfsFilesystem& base;
     std::shared_ptr<FileUtil::IOFile> backing;
+    std::shared_ptr<Common::MappedFile> mapping;
     std::string path;
     std::string parent_path;
     std::vector<std::string> path_components;
     std::vector<std::string> parent_components;
     Mode perms;
+    u64 cache_id;
+    mutable std::atomic<std::size_t> next_read_offset{};
 };
 
 // An implementation of VfsDirectory that represents a directory on the user's computer.
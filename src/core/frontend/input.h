@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -46,8 +48,22 @@ struct FactoryList {
 template <typename InputDeviceType>
 FactoryListType<InputDeviceType> FactoryList<InputDeviceType>::list;
 
+inline std::atomic<std::chrono::steady_clock::rep> last_event_time{};
+
 } // namespace Impl
 
+/// Notes that an event driven backend received a host input event, used to measure input latency.
+inline void NotifyInputEvent() {
+    Impl::last_event_time.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                std::memory_order_relaxed);
+}
+
+/// Returns when the last host input event was received, or the epoch if there hasn't been one.
+inline std::chrono::steady_clock::time_point GetLastInputEventTime() {
+    return std::chrono::steady_clock::time_point{
+        std::chrono::steady_clock::duration{Impl::last_event_time.load(std::memory_order_relaxed)}};
+}
+
 /**
  * Registers an input device factory.
  * @tparam InputDeviceType the type of input devices the factory can create
@@ -5,7 +5,9 @@
 // Originally written by Sven Peter <sven@fail0verflow.com> for anergistic.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <climits>
 #include <csignal>
 #include <cstdarg>
@@ -13,6 +15,7 @@
 #include <cstring>
 #include <map>
 #include <numeric>
+#include <thread>
 #include <fcntl.h>
 
 #ifdef _WIN32
@@ -31,8 +34,10 @@
 #endif
 
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "common/swap.h"
+#include "common/thread.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
@@ -52,6 +57,22 @@ constexpr char GDB_STUB_END = '#';
 constexpr char GDB_STUB_ACK = '+';
 constexpr char GDB_STUB_NACK = '-';
 
+// Largest qXfer chunk that fits in a reply along with its framing and the 'm' or 'l' prefix
+constexpr std::size_t MAX_XFER_CHUNK = GDB_BUFFER_SIZE - 5;
+
+// How long the network thread waits for data before checking whether it should exit
+constexpr std::chrono::milliseconds NETWORK_POLL_TIMEOUT{100};
+
+/// Lowercase hex digits of every byte value.
+constexpr auto hex_table = [] {
+    constexpr char digits[] = "0123456789abcdef";
+    std::array<std::array<u8, 2>, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = {static_cast<u8>(digits[i >> 4]), static_cast<u8>(digits[i & 0xF])};
+    }
+    return table;
+}();
+
 #ifndef SIGTRAP
 constexpr u32 SIGTRAP = 5;
 #endif
@@ -142,6 +163,14 @@ constexpr char target_xml[] =
 
 int gdbserver_socket = -1;
 
+// The network thread waits for the client, so that polling an idle connection costs the CPU
+// loop no system calls. It raises packet_pending when data arrives and sleeps until the CPU
+// thread has read a packet.
+std::thread network_thread;
+std::atomic<bool> network_thread_running{false};
+std::atomic<bool> packet_pending{false};
+Common::Event packet_handled;
+
 u8 command_buffer[GDB_BUFFER_SIZE];
 u32 command_length;
 
@@ -356,10 +385,8 @@ static u64 HexToLong(const u8* src, std::size_t len) {
  * @param len Length of src array.
  */
 static void MemToGdbHex(u8* dest, const u8* src, std::size_t len) {
-    while (len-- > 0) {
-        u8 tmp = *src++;
-        *dest++ = NibbleToHex(tmp >> 4);
-        *dest++ = NibbleToHex(tmp);
+    for (std::size_t i = 0; i < len; ++i) {
+        std::memcpy(dest + i * 2, hex_table[src[i]].data(), 2);
     }
 }
 
@@ -510,7 +537,8 @@ static void RemoveBreakpoint(BreakpointType type, VAddr addr) {
 
     if (type == BreakpointType::Execute) {
         Memory::WriteBlock(bp->second.addr, bp->second.inst.data(), bp->second.inst.size());
-        Core::System::GetInstance().InvalidateCpuInstructionCaches();
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(bp->second.addr,
+                                                                       bp->second.inst.size());
     }
     p.erase(addr);
 }
@@ -622,6 +650,33 @@ static void SendReply(const char* reply) {
     }
 }
 
+/**
+ * Sends the part of a qXfer object asked for by the client. Objects larger than a packet, like
+ * the thread list of a busy process, are read over several requests.
+ *
+ * @param object Whole object being transferred.
+ * @param range  The "offset,length" end of the query, both in hex.
+ */
+static void SendXferReply(const std::string& object, const char* range) {
+    const char* const separator = std::strchr(range, ',');
+    if (separator == nullptr) {
+        return SendReply("E01");
+    }
+    const u64 offset = HexToLong(reinterpret_cast<const u8*>(range),
+                                 static_cast<std::size_t>(separator - range));
+    const u64 length = HexToLong(reinterpret_cast<const u8*>(separator + 1),
+                                 std::strlen(separator + 1));
+    if (offset >= object.size()) {
+        return SendReply("l");
+    }
+
+    const std::size_t chunk_size = static_cast<std::size_t>(
+        std::min<u64>({length, object.size() - offset, MAX_XFER_CHUNK}));
+    const bool is_last = offset + chunk_size == object.size();
+    const std::string reply = (is_last ? 'l' : 'm') + object.substr(offset, chunk_size);
+    SendReply(reply.c_str());
+}
+
 /// Handle query command from gdb client.
 static void HandleQuery() {
     LOG_DEBUG(Debug_GDBStub, "gdb: query '{}'", command_buffer + 1);
@@ -631,7 +686,7 @@ static void HandleQuery() {
     if (strcmp(query, "TStatus") == 0) {
         SendReply("T0");
     } else if (strncmp(query, "Supported", strlen("Supported")) == 0) {
-        // PacketSize needs to be large enough for target xml
+        // PacketSize is in hex, it bounds the memory reads and qXfer chunks the client asks for
         std::string buffer = "PacketSize=2000;qXfer:features:read+;qXfer:threads:read+";
         if (!modules.empty()) {
             buffer += ";qXfer:libraries:read+";
@@ -639,7 +694,7 @@ static void HandleQuery() {
         SendReply(buffer.c_str());
     } else if (strncmp(query, "Xfer:features:read:target.xml:",
                        strlen("Xfer:features:read:target.xml:")) == 0) {
-        SendReply(target_xml);
+        SendXferReply(target_xml, query + strlen("Xfer:features:read:target.xml:"));
     } else if (strncmp(query, "Offsets", strlen("Offsets")) == 0) {
         const VAddr base_address = Core::CurrentProcess()->VMManager().GetCodeRegionBaseAddress();
         std::string buffer = fmt::format("TextSeg={:0x}", base_address);
@@ -656,9 +711,9 @@ static void HandleQuery() {
         SendReply(val.c_str());
     } else if (strncmp(query, "sThreadInfo", strlen("sThreadInfo")) == 0) {
         SendReply("l");
-    } else if (strncmp(query, "Xfer:threads:read", strlen("Xfer:threads:read")) == 0) {
+    } else if (strncmp(query, "Xfer:threads:read::", strlen("Xfer:threads:read::")) == 0) {
         std::string buffer;
-        buffer += "l<?xml version=\"1.0\"?>";
+        buffer += "<?xml version=\"1.0\"?>";
         buffer += "<threads>";
         for (u32 core = 0; core < Core::NUM_CPU_CORES; core++) {
             const auto& threads = Core::System::GetInstance().Scheduler(core).GetThreadList();
@@ -669,18 +724,17 @@ static void HandleQuery() {
             }
         }
         buffer += "</threads>";
-        SendReply(buffer.c_str());
-    } else if (strncmp(query, "Xfer:libraries:read", strlen("Xfer:libraries:read")) == 0) {
+        SendXferReply(buffer, query + strlen("Xfer:threads:read::"));
+    } else if (strncmp(query, "Xfer:libraries:read::", strlen("Xfer:libraries:read::")) == 0) {
         std::string buffer;
-        buffer += "l<?xml version=\"1.0\"?>";
+        buffer += "<?xml version=\"1.0\"?>";
         buffer += "<library-list>";
         for (const auto& module : modules) {
-            buffer +=
-                fmt::format(R"*("<library name = "{}"><segment address = "0x{:x}"/></library>)*",
-                            module.name, module.beg);
+            buffer += fmt::format(R"*(<library name="{}"><segment address="0x{:x}"/></library>)*",
+                                  module.name, module.beg);
         }
         buffer += "</library-list>";
-        SendReply(buffer.c_str());
+        SendXferReply(buffer, query + strlen("Xfer:libraries:read::"));
     } else {
         SendReply("");
     }
@@ -799,8 +853,12 @@ static void ReadCommand() {
     SendPacket(GDB_STUB_ACK);
 }
 
-/// Check if there is data to be read from the gdb client.
-static bool IsDataAvailable() {
+/**
+ * Check if there is data to be read from the gdb client.
+ *
+ * @param timeout How long to wait for data to arrive.
+ */
+static bool IsDataAvailable(std::chrono::microseconds timeout) {
     if (!IsConnected()) {
         return false;
     }
@@ -811,8 +869,8 @@ static bool IsDataAvailable() {
     FD_SET(static_cast<u32>(gdbserver_socket), &fd_socket);
 
     struct timeval t;
-    t.tv_sec = 0;
-    t.tv_usec = 0;
+    t.tv_sec = static_cast<long>(timeout.count() / 1000000);
+    t.tv_usec = static_cast<long>(timeout.count() % 1000000);
 
     if (select(gdbserver_socket + 1, &fd_socket, nullptr, nullptr, &t) < 0) {
         LOG_ERROR(Debug_GDBStub, "select failed");
@@ -822,6 +880,18 @@ static bool IsDataAvailable() {
     return FD_ISSET(gdbserver_socket, &fd_socket) != 0;
 }
 
+/// Waits for data from the gdb client and hands it over to the CPU thread one packet at a time.
+static void NetworkLoop() {
+    Common::SetCurrentThreadName("yuzu:GDBStub");
+    while (network_thread_running) {
+        if (!IsDataAvailable(NETWORK_POLL_TIMEOUT)) {
+            continue;
+        }
+        packet_pending = true;
+        packet_handled.Wait();
+    }
+}
+
 /// Send requested register to gdb client.
 static void ReadRegister() {
     static u8 reply[64];
@@ -969,8 +1039,8 @@ static void ReadMemory() {
 
     LOG_DEBUG(Debug_GDBStub, "gdb: addr: {:016X} len: {:016X}", addr, len);
 
-    if (len * 2 > sizeof(reply)) {
-        SendReply("E01");
+    if (len * 2 + 1 > sizeof(reply)) {
+        return SendReply("E01");
     }
 
     if (!Memory::IsValidVirtualAddress(addr)) {
@@ -1003,7 +1073,7 @@ static void WriteMemory() {
 
     GdbHexToMem(data.data(), len_pos + 1, len);
     Memory::WriteBlock(addr, data.data(), len);
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
+    Core::System::GetInstance().InvalidateCpuInstructionCacheRange(addr, len);
     SendReply("OK");
 }
 
@@ -1064,7 +1134,7 @@ static bool CommitBreakpoint(BreakpointType type, VAddr addr, u64 len) {
     static constexpr std::array<u8, 4> btrap{0x00, 0x7d, 0x20, 0xd4};
     if (type == BreakpointType::Execute) {
         Memory::WriteBlock(addr, btrap.data(), btrap.size());
-        Core::System::GetInstance().InvalidateCpuInstructionCaches();
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(addr, btrap.size());
     }
     p.insert({addr, breakpoint});
 
@@ -1167,9 +1237,11 @@ void HandlePacket() {
         return;
     }
 
-    if (!IsDataAvailable()) {
+    if (!packet_pending.exchange(false)) {
         return;
     }
+    // Let the network thread wait for more data, whatever the packet turns out to be
+    SCOPE_EXIT({ packet_handled.Set(); });
 
     ReadCommand();
     if (command_length == 0) {
@@ -1323,6 +1395,11 @@ static void Init(u16 port) {
     } else {
         LOG_INFO(Debug_GDBStub, "Client connected.");
         saddr_client.sin_addr.s_addr = ntohl(saddr_client.sin_addr.s_addr);
+
+        packet_pending = false;
+        packet_handled.Reset();
+        network_thread_running = true;
+        network_thread = std::thread(NetworkLoop);
     }
 
     // Clean up temporary socket if it's still alive at this point.
@@ -1341,6 +1418,12 @@ void Shutdown() {
     }
 
     LOG_INFO(Debug_GDBStub, "Stopping GDB ...");
+    if (network_thread.joinable()) {
+        // The thread may be waiting for a packet to be handled, this can be called while one is
+        network_thread_running = false;
+        packet_handled.Set();
+        network_thread.join();
+    }
     if (gdbserver_socket != -1) {
         shutdown(gdbserver_socket, SHUT_RDWR);
         gdbserver_socket = -1;
@@ -10,21 +10,41 @@
 
 namespace Core::Hardware {
 
+namespace {
+constexpr u64 PendingBit = 1ULL << 32;
+} // Anonymous namespace
+
 InterruptManager::InterruptManager(Core::System& system_in) : system(system_in) {
-    gpu_interrupt_event =
-        system.CoreTiming().RegisterEvent("GPUInterrupt", [this](u64 message, s64) {
-            auto nvdrv = system.ServiceManager().GetService<Service::Nvidia::NVDRV>("nvdrv");
-            const u32 syncpt = static_cast<u32>(message >> 32);
-            const u32 value = static_cast<u32>(message);
-            nvdrv->SignalGPUInterruptSyncpt(syncpt, value);
-        });
+    gpu_interrupt_event = system.CoreTiming().RegisterEvent(
+        "GPUInterrupt", [this](u64, s64) { DrainSyncptInterrupts(); });
 }
 
 InterruptManager::~InterruptManager() = default;
 
 void InterruptManager::GPUInterruptSyncpt(const u32 syncpoint_id, const u32 value) {
-    const u64 msg = (static_cast<u64>(syncpoint_id) << 32ULL) | value;
-    system.CoreTiming().ScheduleEvent(10, gpu_interrupt_event, msg);
+    // Interrupts of the same syncpoint merge into the highest value, which satisfies the others
+    auto& pending = pending_syncpts[syncpoint_id];
+    const u64 entry = PendingBit | value;
+    u64 current = pending.load();
+    while (current < entry && !pending.compare_exchange_weak(current, entry)) {
+    }
+    if (!drain_scheduled.exchange(true)) {
+        system.CoreTiming().ScheduleEventThreadsafe(10, gpu_interrupt_event);
+    }
+}
+
+void InterruptManager::DrainSyncptInterrupts() {
+    // Cleared before the scan, an interrupt posted meanwhile is either seen here or schedules
+    // another drain
+    drain_scheduled = false;
+
+    auto nvdrv = system.ServiceManager().GetService<Service::Nvidia::NVDRV>("nvdrv");
+    for (u32 syncpoint_id = 0; syncpoint_id < Service::Nvidia::MaxSyncPoints; ++syncpoint_id) {
+        const u64 entry = pending_syncpts[syncpoint_id].exchange(0);
+        if (entry != 0) {
+            nvdrv->SignalGPUInterruptSyncpt(syncpoint_id, static_cast<u32>(entry));
+        }
+    }
 }
 
 } // namespace Core::Hardware
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include "common/common_types.h"
+#include "core/hle/service/nvdrv/nvdata.h"
 
 namespace Core {
 class System;
@@ -21,11 +24,21 @@ public:
     explicit InterruptManager(Core::System& system);
     ~InterruptManager();
 
+    /// Signals the nvdrv events waiting on the syncpoint, can be called from any thread.
     void GPUInterruptSyncpt(u32 syncpoint_id, u32 value);
 
 private:
+    /// Signals every pending syncpoint, runs on the CPU thread.
+    void DrainSyncptInterrupts();
+
     Core::System& system;
     Core::Timing::EventType* gpu_interrupt_event{};
+
+    // Highest value each syncpoint was interrupted at since the last drain, with PendingBit set,
+    // or zero when it has nothing pending
+    std::array<std::atomic<u64>, Service::Nvidia::MaxSyncPoints> pending_syncpts{};
+    // Set while a drain is scheduled, so a burst of interrupts schedules a single event
+    std::atomic<bool> drain_scheduled{};
 };
 
 } // namespace Core::Hardware
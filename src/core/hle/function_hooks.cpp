@@ -0,0 +1,273 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/hle/function_hooks.h"
+#include "core/memory.h"
+
+namespace HLE {
+namespace {
+
+/// Hooks are called with SVC numbers far above the ones of the real kernel (0x01-0x7F)
+constexpr u32 HOOK_SVC_BASE = 0x8000;
+
+constexpr u32 RET_INSTRUCTION = 0xD65F03C0;
+
+constexpr u32 MakeSvcInstruction(u32 immediate) {
+    return 0xD4000001 | (immediate << 5);
+}
+
+constexpr u64 ELF_DYNAMIC_TAG_NULL = 0;
+constexpr u64 ELF_DYNAMIC_TAG_STRTAB = 5;
+constexpr u64 ELF_DYNAMIC_TAG_SYMTAB = 6;
+constexpr u64 ELF_DYNAMIC_TAG_SYMENT = 11;
+
+constexpr u8 ELF_SYMBOL_TYPE_FUNCTION = 2;
+
+struct ELFSymbol {
+    u32 name_index;
+    u8 info;
+    u8 other;
+    u16 sh_index;
+    u64 value;
+    u64 size;
+};
+static_assert(sizeof(ELFSymbol) == 0x18, "ELFSymbol has incorrect size.");
+
+/// Size of the buffer used when memory can't be accessed through a single host pointer
+constexpr std::size_t BOUNCE_BUFFER_SIZE = 0x10000;
+
+void Memmove(Core::ARM_Interface& arm_interface) {
+    // The destination is returned in X0, which already holds it
+    const VAddr dest = arm_interface.GetReg(0);
+    const VAddr src = arm_interface.GetReg(1);
+    const std::size_t size = arm_interface.GetReg(2);
+    if (size == 0 || dest == src) {
+        return;
+    }
+
+    u8* const dest_pointer = Memory::GetContiguousPointer(dest, size);
+    const u8* const src_pointer = Memory::GetContiguousPointer(src, size);
+    if (dest_pointer != nullptr && src_pointer != nullptr) {
+        std::memmove(dest_pointer, src_pointer, size);
+        return;
+    }
+
+    // Copy in chunks, starting from the end when the destination overlaps the end of the source
+    std::vector<u8> buffer(std::min(size, BOUNCE_BUFFER_SIZE));
+    const bool backwards = dest > src && dest < src + size;
+    for (std::size_t copied = 0; copied < size;) {
+        const std::size_t chunk = std::min(size - copied, buffer.size());
+        const std::size_t offset = backwards ? size - copied - chunk : copied;
+        Memory::ReadBlock(src + offset, buffer.data(), chunk);
+        Memory::WriteBlock(dest + offset, buffer.data(), chunk);
+        copied += chunk;
+    }
+}
+
+void Memset(Core::ARM_Interface& arm_interface) {
+    const VAddr dest = arm_interface.GetReg(0);
+    const u8 value = static_cast<u8>(arm_interface.GetReg(1));
+    const std::size_t size = arm_interface.GetReg(2);
+    if (size == 0) {
+        return;
+    }
+
+    if (u8* const dest_pointer = Memory::GetContiguousPointer(dest, size)) {
+        std::memset(dest_pointer, value, size);
+        return;
+    }
+
+    const std::vector<u8> buffer(std::min(size, BOUNCE_BUFFER_SIZE), value);
+    for (std::size_t written = 0; written < size;) {
+        const std::size_t chunk = std::min(size - written, buffer.size());
+        Memory::WriteBlock(dest + written, buffer.data(), chunk);
+        written += chunk;
+    }
+}
+
+/// Bytes from an address to the end of its page
+std::size_t BytesLeftInPage(VAddr addr) {
+    return Memory::PAGE_SIZE - (addr & Memory::PAGE_MASK);
+}
+
+void Strlen(Core::ARM_Interface& arm_interface) {
+    VAddr addr = arm_interface.GetReg(0);
+    u64 length = 0;
+    while (true) {
+        const std::size_t span = BytesLeftInPage(addr);
+        const u8* const pointer = Memory::GetContiguousPointer(addr, span);
+        if (pointer == nullptr) {
+            // Not regular memory, take the slow path for this byte
+            if (Memory::Read8(addr) == 0) {
+                break;
+            }
+            ++length;
+            ++addr;
+            continue;
+        }
+
+        const auto* const terminator = static_cast<const u8*>(std::memchr(pointer, 0, span));
+        if (terminator != nullptr) {
+            length += terminator - pointer;
+            break;
+        }
+        length += span;
+        addr += span;
+    }
+    arm_interface.SetReg(0, length);
+}
+
+void Strcmp(Core::ARM_Interface& arm_interface) {
+    VAddr lhs = arm_interface.GetReg(0);
+    VAddr rhs = arm_interface.GetReg(1);
+    while (true) {
+        const std::size_t span = std::min(BytesLeftInPage(lhs), BytesLeftInPage(rhs));
+        const u8* const lhs_pointer = Memory::GetContiguousPointer(lhs, span);
+        const u8* const rhs_pointer = Memory::GetContiguousPointer(rhs, span);
+
+        for (std::size_t i = 0; i < span; ++i) {
+            const u8 a = lhs_pointer ? lhs_pointer[i] : Memory::Read8(lhs + i);
+            const u8 b = rhs_pointer ? rhs_pointer[i] : Memory::Read8(rhs + i);
+            if (a != b || a == 0) {
+                const s32 result = static_cast<s32>(a) - static_cast<s32>(b);
+                arm_interface.SetReg(0, static_cast<u32>(result));
+                return;
+            }
+        }
+        lhs += span;
+        rhs += span;
+    }
+}
+
+struct HookedFunction {
+    std::string_view name;
+    void (*function)(Core::ARM_Interface&);
+};
+
+constexpr std::array<HookedFunction, 5> hooked_functions{{
+    {"memcpy", Memmove},
+    {"memmove", Memmove},
+    {"memset", Memset},
+    {"strlen", Strlen},
+    {"strcmp", Strcmp},
+}};
+
+/// Reads a value from the image, returns false if it lies outside of it
+template <typename T>
+bool ReadImage(const Kernel::PhysicalMemory& image, u64 offset, T& value) {
+    if (offset > image.size() || image.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, image.data() + offset, sizeof(T));
+    return true;
+}
+
+std::string_view ReadSymbolName(const Kernel::PhysicalMemory& image, u64 offset) {
+    if (offset >= image.size()) {
+        return {};
+    }
+    const auto* const begin = reinterpret_cast<const char*>(image.data() + offset);
+    const auto* const end = static_cast<const char*>(std::memchr(begin, 0, image.size() - offset));
+    return end ? std::string_view(begin, end - begin) : std::string_view{};
+}
+
+} // Anonymous namespace
+
+std::size_t InstallFunctionHooks(Kernel::PhysicalMemory& image, std::size_t text_offset,
+                                 std::size_t text_size) {
+    if (text_offset > image.size() || image.size() - text_offset < text_size) {
+        return 0;
+    }
+    const u64 text_end = text_offset + text_size;
+
+    u32 mod_offset{};
+    u32 magic{};
+    if (!ReadImage(image, text_offset + 4, mod_offset) || !ReadImage(image, mod_offset, magic) ||
+        magic != Common::MakeMagic('M', 'O', 'D', '0')) {
+        return 0;
+    }
+
+    u32 dynamic_offset{};
+    if (!ReadImage(image, mod_offset + 4, dynamic_offset)) {
+        return 0;
+    }
+
+    u64 string_table_offset{};
+    u64 symbol_table_offset{};
+    u64 symbol_entry_size{};
+    for (u64 entry = u64{mod_offset} + dynamic_offset;; entry += 0x10) {
+        u64 tag{};
+        u64 value{};
+        if (!ReadImage(image, entry, tag) || !ReadImage(image, entry + 8, value)) {
+            return 0;
+        }
+        if (tag == ELF_DYNAMIC_TAG_NULL) {
+            break;
+        }
+        if (tag == ELF_DYNAMIC_TAG_STRTAB) {
+            string_table_offset = value;
+        } else if (tag == ELF_DYNAMIC_TAG_SYMTAB) {
+            symbol_table_offset = value;
+        } else if (tag == ELF_DYNAMIC_TAG_SYMENT) {
+            symbol_entry_size = value;
+        }
+    }
+    if (string_table_offset == 0 || symbol_table_offset == 0 ||
+        symbol_entry_size < sizeof(ELFSymbol)) {
+        return 0;
+    }
+
+    std::size_t num_hooked = 0;
+    for (u64 offset = symbol_table_offset; offset < string_table_offset;
+         offset += symbol_entry_size) {
+        ELFSymbol symbol{};
+        if (!ReadImage(image, offset, symbol)) {
+            break;
+        }
+
+        // Only patch functions defined in this module that have room for the stub
+        if ((symbol.info & 0xF) != ELF_SYMBOL_TYPE_FUNCTION || symbol.sh_index == 0 ||
+            symbol.size < 8 || symbol.value < text_offset || symbol.value >= text_end ||
+            text_end - symbol.value < 8) {
+            continue;
+        }
+
+        const std::string_view name =
+            ReadSymbolName(image, string_table_offset + symbol.name_index);
+        const auto hook =
+            std::find_if(hooked_functions.begin(), hooked_functions.end(),
+                         [name](const auto& function) { return function.name == name; });
+        if (hook == hooked_functions.end()) {
+            continue;
+        }
+
+        const auto index = static_cast<u32>(std::distance(hooked_functions.begin(), hook));
+        const std::array<u32, 2> stub{MakeSvcInstruction(HOOK_SVC_BASE + index), RET_INSTRUCTION};
+        std::memcpy(image.data() + symbol.value, stub.data(), sizeof(stub));
+        LOG_DEBUG(Loader, "Hooked {} at offset 0x{:X}", name, symbol.value);
+        ++num_hooked;
+    }
+    return num_hooked;
+}
+
+bool IsFunctionHook(u32 svc_immediate) {
+    return svc_immediate >= HOOK_SVC_BASE &&
+           svc_immediate - HOOK_SVC_BASE < hooked_functions.size();
+}
+
+void CallFunctionHook(Core::ARM_Interface& arm_interface, u32 svc_immediate) {
+    ASSERT(IsFunctionHook(svc_immediate));
+    hooked_functions[svc_immediate - HOOK_SVC_BASE].function(arm_interface);
+}
+
+} // namespace HLE
@@ -0,0 +1,34 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+#include "core/hle/kernel/physical_memory.h"
+
+namespace Core {
+class ARM_Interface;
+}
+
+namespace HLE {
+
+/**
+ * Replaces the libc routines a module exports (memcpy, memset, strlen, ...) with a stub that runs
+ * a native implementation through a reserved SVC. This has to be done before the module is mapped.
+ * @param image       Decompressed image of the module, starting at its base address
+ * @param text_offset Offset of the .text segment within the image
+ * @param text_size   Size of the .text segment in bytes
+ * @return The number of functions that were hooked
+ */
+std::size_t InstallFunctionHooks(Kernel::PhysicalMemory& image, std::size_t text_offset,
+                                 std::size_t text_size);
+
+/// Whether an SVC immediate belongs to a hooked function rather than to the kernel.
+bool IsFunctionHook(u32 svc_immediate);
+
+/// Runs the native implementation of a hooked function on the registers of the calling core.
+void CallFunctionHook(Core::ARM_Interface& arm_interface, u32 svc_immediate);
+
+} // namespace HLE
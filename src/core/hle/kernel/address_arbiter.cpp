@@ -20,30 +20,20 @@
 
 namespace Kernel {
 namespace {
-// Wake up num_to_wake (or all) threads in a vector.
-void WakeThreads(const std::vector<SharedPtr<Thread>>& waiting_threads, s32 num_to_wake) {
-    // Only process up to 'target' threads, unless 'target' is <= 0, in which case process
-    // them all.
-    std::size_t last = waiting_threads.size();
-    if (num_to_wake > 0) {
-        last = std::min(last, static_cast<std::size_t>(num_to_wake));
-    }
-
-    // Signal the waiting threads.
-    for (std::size_t i = 0; i < last; i++) {
-        ASSERT(waiting_threads[i]->GetStatus() == ThreadStatus::WaitArb);
-        waiting_threads[i]->SetWaitSynchronizationResult(RESULT_SUCCESS);
-        waiting_threads[i]->SetArbiterWaitAddress(0);
-        waiting_threads[i]->ResumeFromWait();
-    }
+bool IsWaitingOnAddress(const Thread& thread, VAddr address) {
+    return thread.GetStatus() == ThreadStatus::WaitArb &&
+           thread.GetArbiterWaitAddress() == address;
 }
 } // Anonymous namespace
 
-AddressArbiter::AddressArbiter(Core::System& system) : system{system} {}
+AddressArbiter::AddressArbiter(Core::System& system)
+    : system{system}, waiting_threads{IsWaitingOnAddress} {}
 AddressArbiter::~AddressArbiter() = default;
 
 ResultCode AddressArbiter::SignalToAddress(VAddr address, SignalType type, s32 value,
                                            s32 num_to_wake) {
+    std::lock_guard lock{arbiter_mutex};
+
     switch (type) {
     case SignalType::Signal:
         return SignalToAddressOnly(address, num_to_wake);
@@ -57,8 +47,7 @@ ResultCode AddressArbiter::SignalToAddress(VAddr address, SignalType type, s32 v
 }
 
 ResultCode AddressArbiter::SignalToAddressOnly(VAddr address, s32 num_to_wake) {
-    const std::vector<SharedPtr<Thread>> waiting_threads = GetThreadsWaitingOnAddress(address);
-    WakeThreads(waiting_threads, num_to_wake);
+    WakeThreads(address, GetThreadsWaitingOnAddress(address), num_to_wake);
     return RESULT_SUCCESS;
 }
 
@@ -85,13 +74,13 @@ ResultCode AddressArbiter::ModifyByWaitingCountAndSignalToAddressIfEqual(VAddr a
     }
 
     // Get threads waiting on the address.
-    const std::vector<SharedPtr<Thread>> waiting_threads = GetThreadsWaitingOnAddress(address);
+    const std::vector<SharedPtr<Thread>> threads = GetThreadsWaitingOnAddress(address);
 
     // Determine the modified value depending on the waiting count.
     s32 updated_value;
-    if (waiting_threads.empty()) {
+    if (threads.empty()) {
         updated_value = value + 1;
-    } else if (num_to_wake <= 0 || waiting_threads.size() <= static_cast<u32>(num_to_wake)) {
+    } else if (num_to_wake <= 0 || threads.size() <= static_cast<u32>(num_to_wake)) {
         updated_value = value - 1;
     } else {
         updated_value = value;
@@ -102,12 +91,14 @@ ResultCode AddressArbiter::ModifyByWaitingCountAndSignalToAddressIfEqual(VAddr a
     }
 
     Memory::Write32(address, static_cast<u32>(updated_value));
-    WakeThreads(waiting_threads, num_to_wake);
+    WakeThreads(address, threads, num_to_wake);
     return RESULT_SUCCESS;
 }
 
 ResultCode AddressArbiter::WaitForAddress(VAddr address, ArbitrationType type, s32 value,
                                           s64 timeout_ns) {
+    std::lock_guard lock{arbiter_mutex};
+
     switch (type) {
     case ArbitrationType::WaitIfLessThan:
         return WaitForAddressIfLessThan(address, value, timeout_ns, false);
@@ -166,6 +157,7 @@ ResultCode AddressArbiter::WaitForAddressImpl(VAddr address, s64 timeout) {
     current_thread->SetArbiterWaitAddress(address);
     current_thread->SetStatus(ThreadStatus::WaitArb);
     current_thread->InvalidateWakeupCallback();
+    waiting_threads.Add(address, current_thread);
 
     current_thread->WakeAfterDelay(timeout);
 
@@ -173,33 +165,31 @@ ResultCode AddressArbiter::WaitForAddressImpl(VAddr address, s64 timeout) {
     return RESULT_TIMEOUT;
 }
 
-std::vector<SharedPtr<Thread>> AddressArbiter::GetThreadsWaitingOnAddress(VAddr address) const {
-    const auto RetrieveWaitingThreads = [this](std::size_t core_index,
-                                               std::vector<SharedPtr<Thread>>& waiting_threads,
-                                               VAddr arb_addr) {
-        const auto& scheduler = system.Scheduler(core_index);
-        const auto& thread_list = scheduler.GetThreadList();
-
-        for (const auto& thread : thread_list) {
-            if (thread->GetArbiterWaitAddress() == arb_addr) {
-                waiting_threads.push_back(thread);
-            }
-        }
-    };
-
-    // Retrieve all threads that are waiting for this address.
-    std::vector<SharedPtr<Thread>> threads;
-    RetrieveWaitingThreads(0, threads, address);
-    RetrieveWaitingThreads(1, threads, address);
-    RetrieveWaitingThreads(2, threads, address);
-    RetrieveWaitingThreads(3, threads, address);
-
-    // Sort them by priority, such that the highest priority ones come first.
-    std::sort(threads.begin(), threads.end(),
-              [](const SharedPtr<Thread>& lhs, const SharedPtr<Thread>& rhs) {
-                  return lhs->GetPriority() < rhs->GetPriority();
-              });
-
-    return threads;
+void AddressArbiter::RemoveWaiter(VAddr address, const Thread* thread) {
+    std::lock_guard lock{arbiter_mutex};
+    waiting_threads.Remove(address, thread);
+}
+
+std::vector<SharedPtr<Thread>> AddressArbiter::GetThreadsWaitingOnAddress(VAddr address) {
+    return waiting_threads.GetWaitingThreads(address);
+}
+
+void AddressArbiter::WakeThreads(VAddr address, const std::vector<SharedPtr<Thread>>& threads,
+                                 s32 num_to_wake) {
+    // Only process up to 'target' threads, unless 'target' is <= 0, in which case process
+    // them all.
+    std::size_t last = threads.size();
+    if (num_to_wake > 0) {
+        last = std::min(last, static_cast<std::size_t>(num_to_wake));
+    }
+
+    // Signal the waiting threads.
+    for (std::size_t i = 0; i < last; i++) {
+        ASSERT(threads[i]->GetStatus() == ThreadStatus::WaitArb);
+        threads[i]->SetWaitSynchronizationResult(RESULT_SUCCESS);
+        threads[i]->SetArbiterWaitAddress(0);
+        threads[i]->ResumeFromWait();
+        waiting_threads.Remove(address, threads[i].get());
+    }
 }
 } // namespace Kernel
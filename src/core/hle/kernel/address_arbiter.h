@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include <mutex>
 #include <vector>
 
 #include "common/common_types.h"
+#include "core/hle/kernel/address_wait_queue.h"
 #include "core/hle/kernel/object.h"
 
 union ResultCode;
@@ -39,7 +41,7 @@ public:
     AddressArbiter(const AddressArbiter&) = delete;
     AddressArbiter& operator=(const AddressArbiter&) = delete;
 
-    AddressArbiter(AddressArbiter&&) = default;
+    AddressArbiter(AddressArbiter&&) = delete;
     AddressArbiter& operator=(AddressArbiter&&) = delete;
 
     /// Signals an address being waited on with a particular signaling type.
@@ -48,6 +50,9 @@ public:
     /// Waits on an address with a particular arbitration type.
     ResultCode WaitForAddress(VAddr address, ArbitrationType type, s32 value, s64 timeout_ns);
 
+    /// Stops tracking a thread that stopped waiting on an address without being signaled.
+    void RemoveWaiter(VAddr address, const Thread* thread);
+
 private:
     /// Signals an address being waited on.
     ResultCode SignalToAddressOnly(VAddr address, s32 num_to_wake);
@@ -72,9 +77,20 @@ private:
     ResultCode WaitForAddressImpl(VAddr address, s64 timeout);
 
     // Gets the threads waiting on an address.
-    std::vector<SharedPtr<Thread>> GetThreadsWaitingOnAddress(VAddr address) const;
+    std::vector<SharedPtr<Thread>> GetThreadsWaitingOnAddress(VAddr address);
+
+    // Wakes up num_to_wake (or all) of the given waiting threads.
+    void WakeThreads(VAddr address, const std::vector<SharedPtr<Thread>>& threads,
+                     s32 num_to_wake);
 
     Core::System& system;
+
+    /// Makes checking the value at an address and waiting on or signaling it a single step for
+    /// the threads of this process, no matter which core they run on.
+    std::mutex arbiter_mutex;
+
+    /// Threads waiting on an address of this process, guarded by arbiter_mutex.
+    AddressWaitQueue waiting_threads;
 };
 
 } // namespace Kernel
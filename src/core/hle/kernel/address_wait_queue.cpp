@@ -0,0 +1,75 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+
+#include "core/hle/kernel/address_wait_queue.h"
+#include "core/hle/kernel/thread.h"
+
+namespace Kernel {
+
+AddressWaitQueue::AddressWaitQueue(IsWaitingFunc is_waiting) : is_waiting{is_waiting} {}
+AddressWaitQueue::~AddressWaitQueue() = default;
+
+void AddressWaitQueue::Add(VAddr address, SharedPtr<Thread> thread) {
+    auto& list = waiters[address];
+
+    // A thread which waited on the address before without being removed would pass the predicate
+    // again now, drop that entry so that it isn't listed twice.
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [&](const SharedPtr<Thread>& entry) {
+                                  return entry == thread || !is_waiting(*entry, address);
+                              }),
+               list.end());
+    list.push_back(std::move(thread));
+}
+
+void AddressWaitQueue::Remove(VAddr address, const Thread* thread) {
+    const auto itr = waiters.find(address);
+    if (itr == waiters.end()) {
+        return;
+    }
+
+    auto& list = itr->second;
+    list.erase(std::remove(list.begin(), list.end(), thread), list.end());
+    if (list.empty()) {
+        waiters.erase(itr);
+    }
+}
+
+std::vector<SharedPtr<Thread>> AddressWaitQueue::GetWaitingThreads(VAddr address) {
+    Prune(address);
+
+    const auto itr = waiters.find(address);
+    if (itr == waiters.end()) {
+        return {};
+    }
+
+    std::vector<SharedPtr<Thread>> threads = itr->second;
+    std::stable_sort(threads.begin(), threads.end(),
+                     [](const SharedPtr<Thread>& lhs, const SharedPtr<Thread>& rhs) {
+                         return lhs->GetPriority() < rhs->GetPriority();
+                     });
+    return threads;
+}
+
+void AddressWaitQueue::Prune(VAddr address) {
+    const auto itr = waiters.find(address);
+    if (itr == waiters.end()) {
+        return;
+    }
+
+    auto& list = itr->second;
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [&](const SharedPtr<Thread>& entry) {
+                                  return !is_waiting(*entry, address);
+                              }),
+               list.end());
+    if (list.empty()) {
+        waiters.erase(itr);
+    }
+}
+
+} // namespace Kernel
@@ -0,0 +1,59 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "core/hle/kernel/object.h"
+
+namespace Kernel {
+
+class Thread;
+
+/**
+ * Threads waiting on guest addresses, hashed by the address so that signaling one only looks at
+ * the threads waiting on it instead of at every thread of every core.
+ *
+ * Whether a thread listed for an address still waits on it is decided by a predicate, as threads
+ * stop waiting in several ways (being signaled, timing out, being terminated). Entries which no
+ * longer pass it are dropped whenever their address is touched, so removing a thread explicitly
+ * only serves to release it early.
+ *
+ * The queue isn't synchronized, its owner has to serialize access to it.
+ */
+class AddressWaitQueue final {
+public:
+    /// Returns whether the thread still waits on the given address.
+    using IsWaitingFunc = bool (*)(const Thread& thread, VAddr address);
+
+    explicit AddressWaitQueue(IsWaitingFunc is_waiting);
+    ~AddressWaitQueue();
+
+    AddressWaitQueue(const AddressWaitQueue&) = delete;
+    AddressWaitQueue& operator=(const AddressWaitQueue&) = delete;
+
+    /// Adds a thread that starts waiting on an address, after any other thread waiting on it.
+    void Add(VAddr address, SharedPtr<Thread> thread);
+
+    /// Removes a thread from the waiters of an address.
+    void Remove(VAddr address, const Thread* thread);
+
+    /**
+     * Returns the threads that still wait on an address, highest priority first. Threads of the
+     * same priority are returned in the order they started waiting.
+     */
+    std::vector<SharedPtr<Thread>> GetWaitingThreads(VAddr address);
+
+private:
+    /// Drops the entries of an address that no longer wait on it, and the address if none is left.
+    void Prune(VAddr address);
+
+    IsWaitingFunc is_waiting;
+    std::unordered_map<VAddr, std::vector<SharedPtr<Thread>>> waiters;
+};
+
+} // namespace Kernel
@@ -0,0 +1,137 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "common/assert.h"
+#include "core/hle/kernel/free_region_tree.h"
+
+namespace Kernel {
+
+FreeRegionTree::FreeRegionTree() = default;
+FreeRegionTree::~FreeRegionTree() = default;
+
+void FreeRegionTree::Insert(VAddr base, u64 size) {
+    const u32 index = AllocateNode(base, size);
+    const auto [left, right] = Split(root, base);
+    root = Merge(Merge(left, index), right);
+    ++region_count;
+}
+
+void FreeRegionTree::Erase(VAddr base) {
+    const auto [left, rest] = Split(root, base);
+    const auto [match, right] = Split(rest, base + 1);
+
+    ASSERT_MSG(match != INVALID_INDEX && nodes[match].left == INVALID_INDEX &&
+                   nodes[match].right == INVALID_INDEX,
+               "No free region at 0x{:016X}", base);
+
+    FreeNode(match);
+    root = Merge(left, right);
+    --region_count;
+}
+
+void FreeRegionTree::Clear() {
+    nodes.clear();
+    free_head = INVALID_INDEX;
+    root = INVALID_INDEX;
+    region_count = 0;
+}
+
+std::optional<VAddr> FreeRegionTree::FindFirstFit(VAddr min_base, u64 size) const {
+    return FindFirstFit(root, min_base, size);
+}
+
+u32 FreeRegionTree::AllocateNode(VAddr base, u64 size) {
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+
+    const Node node{base, size, size, rng_state, INVALID_INDEX, INVALID_INDEX};
+    if (free_head != INVALID_INDEX) {
+        const u32 index = free_head;
+        free_head = nodes[index].left;
+        nodes[index] = node;
+        return index;
+    }
+
+    nodes.push_back(node);
+    return static_cast<u32>(nodes.size() - 1);
+}
+
+void FreeRegionTree::FreeNode(u32 index) {
+    nodes[index].left = free_head;
+    free_head = index;
+}
+
+u64 FreeRegionTree::MaxSize(u32 index) const {
+    return index == INVALID_INDEX ? 0 : nodes[index].max_size;
+}
+
+void FreeRegionTree::Update(u32 index) {
+    Node& node = nodes[index];
+    node.max_size = std::max({node.size, MaxSize(node.left), MaxSize(node.right)});
+}
+
+std::pair<u32, u32> FreeRegionTree::Split(u32 index, VAddr key) {
+    if (index == INVALID_INDEX) {
+        return {INVALID_INDEX, INVALID_INDEX};
+    }
+
+    if (nodes[index].base < key) {
+        const auto [left, right] = Split(nodes[index].right, key);
+        nodes[index].right = left;
+        Update(index);
+        return {index, right};
+    }
+
+    const auto [left, right] = Split(nodes[index].left, key);
+    nodes[index].left = right;
+    Update(index);
+    return {left, index};
+}
+
+u32 FreeRegionTree::Merge(u32 left, u32 right) {
+    if (left == INVALID_INDEX) {
+        return right;
+    }
+    if (right == INVALID_INDEX) {
+        return left;
+    }
+
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = Merge(nodes[left].right, right);
+        Update(left);
+        return left;
+    }
+
+    nodes[right].left = Merge(left, nodes[right].left);
+    Update(right);
+    return right;
+}
+
+std::optional<VAddr> FreeRegionTree::FindFirstFit(u32 index, VAddr min_base, u64 size) const {
+    while (index != INVALID_INDEX && nodes[index].max_size >= size) {
+        const Node& node = nodes[index];
+        if (node.base < min_base) {
+            // Everything on the left starts even lower.
+            index = node.right;
+            continue;
+        }
+
+        // Lower candidates on the left take precedence over this node.
+        if (const auto result = FindFirstFit(node.left, min_base, size)) {
+            return result;
+        }
+        if (node.size >= size) {
+            return node.base;
+        }
+        index = node.right;
+    }
+
+    return std::nullopt;
+}
+
+} // namespace Kernel
@@ -0,0 +1,83 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Kernel {
+
+/**
+ * Index over the free regions of an address space, ordered by base address.
+ *
+ * This is a treap where every node also tracks the size of the largest region in its subtree.
+ * That allows finding the lowest free region that is large enough in logarithmic time, rather
+ * than scanning every region in the address space.
+ */
+class FreeRegionTree final {
+public:
+    FreeRegionTree();
+    ~FreeRegionTree();
+
+    /// Adds a free region. Regions must not overlap.
+    void Insert(VAddr base, u64 size);
+
+    /// Removes the free region starting at the given address, which must exist.
+    void Erase(VAddr base);
+
+    /// Removes all free regions.
+    void Clear();
+
+    /// Returns the number of free regions.
+    std::size_t Size() const {
+        return region_count;
+    }
+
+    /**
+     * Finds the free region with the lowest base address that is at least min_base and holds at
+     * least the given size.
+     *
+     * @returns The base address of the region, or an empty optional if there is none.
+     */
+    std::optional<VAddr> FindFirstFit(VAddr min_base, u64 size) const;
+
+private:
+    static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+    struct Node {
+        VAddr base;
+        u64 size;
+        u64 max_size;
+        u32 priority;
+        u32 left;
+        u32 right;
+    };
+
+    u32 AllocateNode(VAddr base, u64 size);
+    void FreeNode(u32 index);
+
+    u64 MaxSize(u32 index) const;
+    void Update(u32 index);
+
+    /// Splits a subtree into the nodes with a base below the key and the rest.
+    std::pair<u32, u32> Split(u32 index, VAddr key);
+
+    /// Joins two subtrees, where all nodes of the left one have a lower base.
+    u32 Merge(u32 left, u32 right);
+
+    std::optional<VAddr> FindFirstFit(u32 index, VAddr min_base, u64 size) const;
+
+    std::vector<Node> nodes;
+    u32 free_head = INVALID_INDEX;
+    u32 root = INVALID_INDEX;
+    std::size_t region_count = 0;
+
+    /// State of the generator used for node priorities, which keeps the tree balanced.
+    u32 rng_state = 0x2545F491;
+};
+
+} // namespace Kernel
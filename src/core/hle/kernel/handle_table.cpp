@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -20,13 +21,29 @@ constexpr u16 GetSlot(Handle handle) {
 constexpr u16 GetGeneration(Handle handle) {
     return static_cast<u16>(handle & 0x7FFF);
 }
+
+/// Accounts for a lookup of the handle table while it is reading the slots.
+class LookupGuard {
+public:
+    explicit LookupGuard(std::atomic<u32>& active_lookups) : active_lookups{active_lookups} {
+        active_lookups.fetch_add(1);
+    }
+    ~LookupGuard() {
+        active_lookups.fetch_sub(1);
+    }
+
+private:
+    std::atomic<u32>& active_lookups;
+};
 } // Anonymous namespace
 
 HandleTable::HandleTable() {
     Clear();
 }
 
-HandleTable::~HandleTable() = default;
+HandleTable::~HandleTable() {
+    Clear();
+}
 
 ResultCode HandleTable::SetSize(s32 handle_table_size) {
     if (static_cast<u32>(handle_table_size) > MAX_COUNT) {
@@ -47,12 +64,14 @@ ResultCode HandleTable::SetSize(s32 handle_table_size) {
 ResultVal<Handle> HandleTable::Create(SharedPtr<Object> obj) {
     DEBUG_ASSERT(obj != nullptr);
 
+    std::lock_guard lock{write_mutex};
+
     const u16 slot = next_free_slot;
     if (slot >= table_size) {
         LOG_ERROR(Kernel, "Unable to allocate Handle, too many slots in use.");
         return ERR_HANDLE_TABLE_FULL;
     }
-    next_free_slot = generations[slot];
+    next_free_slot = next_free_slots[slot];
 
     const u16 generation = next_generation++;
 
@@ -62,8 +81,10 @@ ResultVal<Handle> HandleTable::Create(SharedPtr<Object> obj) {
         next_generation = 1;
     }
 
-    generations[slot] = generation;
-    objects[slot] = std::move(obj);
+    // The generation is published first, a lookup that still sees the generation of an earlier
+    // handle in this slot then fails its second check of it.
+    slots[slot].generation.store(generation);
+    slots[slot].object.store(obj.detach());
 
     Handle handle = generation | (slot << 15);
     return MakeResult<Handle>(handle);
@@ -79,24 +100,30 @@ ResultVal<Handle> HandleTable::Duplicate(Handle handle) {
 }
 
 ResultCode HandleTable::Close(Handle handle) {
-    if (!IsValid(handle)) {
-        return ERR_INVALID_HANDLE;
-    }
+    std::vector<SharedPtr<Object>> released_objects;
+    {
+        std::lock_guard lock{write_mutex};
+        if (!IsValid(handle)) {
+            return ERR_INVALID_HANDLE;
+        }
 
-    const u16 slot = GetSlot(handle);
+        const u16 slot = GetSlot(handle);
+        Release(slot);
 
-    objects[slot] = nullptr;
+        next_free_slots[slot] = next_free_slot;
+        next_free_slot = slot;
+
+        released_objects = TakeRetiredObjects();
+    }
 
-    generations[slot] = next_free_slot;
-    next_free_slot = slot;
+    // Objects are destroyed outside of the lock, their destructors may close other handles.
+    released_objects.clear();
     return RESULT_SUCCESS;
 }
 
 bool HandleTable::IsValid(Handle handle) const {
-    const std::size_t slot = GetSlot(handle);
-    const u16 generation = GetGeneration(handle);
-
-    return slot < table_size && objects[slot] != nullptr && generations[slot] == generation;
+    const LookupGuard guard{active_lookups};
+    return Lookup(handle) != nullptr;
 }
 
 SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
@@ -106,18 +133,60 @@ SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
         return Core::CurrentProcess();
     }
 
-    if (!IsValid(handle)) {
+    const LookupGuard guard{active_lookups};
+    return SharedPtr<Object>{Lookup(handle)};
+}
+
+void HandleTable::Clear() {
+    std::vector<SharedPtr<Object>> released_objects;
+    {
+        std::lock_guard lock{write_mutex};
+        for (u16 i = 0; i < table_size; ++i) {
+            Release(i);
+            next_free_slots[i] = i + 1;
+        }
+        next_free_slot = 0;
+
+        released_objects = TakeRetiredObjects();
+    }
+    released_objects.clear();
+}
+
+Object* HandleTable::Lookup(Handle handle) const {
+    const std::size_t slot = GetSlot(handle);
+    if (slot >= table_size) {
+        return nullptr;
+    }
+
+    // If the generation changed while the object was read, the slot was reused in the meantime
+    // and the object belongs to a different handle.
+    const Slot& entry = slots[slot];
+    const u16 generation = entry.generation.load();
+    Object* const object = entry.object.load();
+    if (object == nullptr || generation != GetGeneration(handle) ||
+        entry.generation.load() != generation) {
         return nullptr;
     }
-    return objects[GetSlot(handle)];
+    return object;
 }
 
-void HandleTable::Clear() {
-    for (u16 i = 0; i < table_size; ++i) {
-        generations[i] = i + 1;
-        objects[i] = nullptr;
+void HandleTable::Release(u16 slot) {
+    Object* const object = slots[slot].object.exchange(nullptr);
+    slots[slot].generation.store(0);
+    if (object != nullptr) {
+        // Adopt the reference the table held instead of adding another one.
+        retired_objects.emplace_back(object, false);
+    }
+}
+
+std::vector<SharedPtr<Object>> HandleTable::TakeRetiredObjects() {
+    // Every retired object was unpublished before this point. A lookup which starts later can't
+    // find it anymore, so once no lookup is running nothing can still be about to reference it.
+    std::vector<SharedPtr<Object>> objects;
+    if (active_lookups.load() == 0) {
+        objects.swap(retired_objects);
     }
-    next_free_slot = 0;
+    return objects;
 }
 
 } // namespace Kernel
@@ -5,7 +5,10 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
+#include <mutex>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/result.h"
@@ -34,12 +37,18 @@ enum KernelHandle : Handle {
  * "generations" array). When looking up a handle, the Handle's generation must match with the
  * value stored on the class, otherwise the Handle is considered invalid.
  *
- * To find free slots when allocating a Handle without needing to scan the entire object array, the
- * generations field of unallocated slots is re-purposed as a linked list of indices to free slots.
- * When a Handle is created, an index is popped off the list and used for the new Handle. When it
- * is destroyed, it is again pushed onto the list to be re-used by the next allocation. It is
- * likely that this allocation strategy differs from the one used in CTR-OS, but this hasn't been
- * verified and isn't likely to cause any problems.
+ * To find free slots when allocating a Handle without needing to scan the entire object array, a
+ * linked list of indices to free slots is kept. When a Handle is created, an index is popped off
+ * the list and used for the new Handle. When it is destroyed, it is again pushed onto the list to
+ * be re-used by the next allocation. It is likely that this allocation strategy differs from the
+ * one used in CTR-OS, but this hasn't been verified and isn't likely to cause any problems.
+ *
+ * Lookups never take a lock, so that cores resolving handles at the same time don't wait for each
+ * other. Slots are published through atomics, and a lookup only accepts an object if the
+ * generation of its slot matched before and after reading it. Closing a handle doesn't drop the
+ * reference of the table right away. It is kept on a list of retired objects until no lookup is
+ * in progress anymore, so that a lookup which read the slot just before it was cleared can still
+ * take its own reference safely. Creating and closing handles is serialized by a mutex.
  */
 class HandleTable final : NonCopyable {
 public:
@@ -108,14 +117,42 @@ public:
     void Clear();
 
 private:
-    /// Stores the Object referenced by the handle or null if the slot is empty.
-    std::array<SharedPtr<Object>, MAX_COUNT> objects;
+    struct Slot {
+        /// The Object referenced by the handle or null if the slot is empty. The table holds a
+        /// reference to it, which is handed to a SharedPtr again when the handle is closed.
+        std::atomic<Object*> object{nullptr};
+
+        /// The value of `next_generation` when the handle was created, used to check for
+        /// validity. Zero for empty slots.
+        std::atomic<u16> generation{0};
+    };
+
+    /// Returns the object of a handle without taking a reference, or null if it is not valid.
+    /// Must only be called while `active_lookups` accounts for the caller.
+    Object* Lookup(Handle handle) const;
+
+    /// Empties a slot and moves the reference the table held to its object to the retired list.
+    void Release(u16 slot);
 
     /**
-     * The value of `next_generation` when the handle was created, used to check for validity. For
-     * empty slots, contains the index of the next free slot in the list.
+     * Takes the list of retired objects if no lookup is in progress, so that the caller can drop
+     * their references once the mutex is no longer held.
      */
-    std::array<u16, MAX_COUNT> generations;
+    std::vector<SharedPtr<Object>> TakeRetiredObjects();
+
+    std::array<Slot, MAX_COUNT> slots;
+
+    /// For empty slots, contains the index of the next free slot in the list.
+    std::array<u16, MAX_COUNT> next_free_slots;
+
+    /// Objects of closed handles which lookups that are still running may be about to reference.
+    std::vector<SharedPtr<Object>> retired_objects;
+
+    /// Number of lookups currently reading from the slots.
+    mutable std::atomic<u32> active_lookups{0};
+
+    /// Serializes the functions that modify the table.
+    std::mutex write_mutex;
 
     /**
      * The limited size of the handle table. This can be specified by process
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <sstream>
 #include <utility>
 
@@ -22,11 +23,65 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/readable_event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/service_thread.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/writable_event.h"
 #include "core/memory.h"
 
 namespace Kernel {
+namespace {
+/// Number of C descriptors carried by a request for each value of the C descriptor flags. Values
+/// above OneDescriptor stand for two descriptors less than their value.
+constexpr std::array<u8, 16> NUM_BUFFER_C_DESCRIPTORS{0, 0, 1, 1, 2, 3, 4, 5,
+                                                      6, 7, 8, 9, 10, 11, 12, 13};
+
+/// Appends the next `count` descriptors of the command buffer to a descriptor list at once.
+template <typename Descriptor, typename List>
+void PopDescriptors(IPC::RequestParser& rp, const u32_le* cmdbuf, std::size_t count, List& list) {
+    constexpr std::size_t words_per_descriptor = sizeof(Descriptor) / sizeof(u32);
+    const std::size_t offset = std::min<std::size_t>(rp.GetCurrentOffset(),
+                                                     IPC::COMMAND_BUFFER_LENGTH);
+    const std::size_t available = (IPC::COMMAND_BUFFER_LENGTH - offset) / words_per_descriptor;
+    ASSERT_MSG(count <= available, "Descriptors overflow the command buffer, count={}", count);
+    count = std::min(count, available);
+
+    const std::size_t first = list.size();
+    list.resize(first + count);
+    std::memcpy(list.data() + first, cmdbuf + offset, count * sizeof(Descriptor));
+    rp.Skip(static_cast<unsigned>(count * words_per_descriptor), false);
+}
+} // Anonymous namespace
+
+ReadBufferView::ReadBufferView(const u8* pointer, std::size_t size)
+    : pointer{pointer}, length{size} {}
+
+ReadBufferView::ReadBufferView(std::vector<u8> buffer)
+    : pointer{buffer.data()}, length{buffer.size()}, copy{std::move(buffer)} {}
+
+ReadBufferView::~ReadBufferView() = default;
+
+ReadBufferView::ReadBufferView(ReadBufferView&&) noexcept = default;
+ReadBufferView& ReadBufferView::operator=(ReadBufferView&&) noexcept = default;
+
+WriteBufferView::WriteBufferView(u8* pointer, std::size_t size)
+    : pointer{pointer}, length{size}, writeback_address{} {}
+
+WriteBufferView::WriteBufferView(std::vector<u8> buffer, VAddr writeback_address)
+    : pointer{buffer.data()}, length{buffer.size()}, copy{std::move(buffer)},
+      writeback_address{writeback_address} {}
+
+WriteBufferView::~WriteBufferView() {
+    // Moving a view leaves the source without a copy, so only one of them writes back.
+    if (!copy.empty()) {
+        Memory::WriteBlock(writeback_address, copy.data(), copy.size());
+    }
+}
+
+WriteBufferView::WriteBufferView(WriteBufferView&& other) noexcept
+    : pointer{other.pointer}, length{other.length}, copy{std::move(other.copy)},
+      writeback_address{other.writeback_address} {
+    other.copy.clear();
+}
 
 SessionRequestHandler::SessionRequestHandler() = default;
 
@@ -76,6 +131,14 @@ SharedPtr<WritableEvent> HLERequestContext::SleepClientThread(
     return writable_event;
 }
 
+void HLERequestContext::RunOnServiceThread(ServiceThread& service_thread,
+                                           const std::string& reason, std::function<void()>&& work,
+                                           WakeupCallback&& callback) {
+    // The thread goes to sleep before the work is queued, so that it can't miss the completion.
+    auto completion_event = SleepClientThread(reason, 0, std::move(callback));
+    service_thread.QueueWork(std::move(work), std::move(completion_event));
+}
+
 HLERequestContext::HLERequestContext(SharedPtr<Kernel::ServerSession> server_session,
                                      SharedPtr<Thread> thread)
     : server_session(std::move(server_session)), thread(std::move(thread)) {
@@ -116,18 +179,14 @@ void HLERequestContext::ParseCommandBuffer(const HandleTable& handle_table, u32_
         }
     }
 
-    for (unsigned i = 0; i < command_header->num_buf_x_descriptors; ++i) {
-        buffer_x_desciptors.push_back(rp.PopRaw<IPC::BufferDescriptorX>());
-    }
-    for (unsigned i = 0; i < command_header->num_buf_a_descriptors; ++i) {
-        buffer_a_desciptors.push_back(rp.PopRaw<IPC::BufferDescriptorABW>());
-    }
-    for (unsigned i = 0; i < command_header->num_buf_b_descriptors; ++i) {
-        buffer_b_desciptors.push_back(rp.PopRaw<IPC::BufferDescriptorABW>());
-    }
-    for (unsigned i = 0; i < command_header->num_buf_w_descriptors; ++i) {
-        buffer_w_desciptors.push_back(rp.PopRaw<IPC::BufferDescriptorABW>());
-    }
+    PopDescriptors<IPC::BufferDescriptorX>(rp, src_cmdbuf, command_header->num_buf_x_descriptors,
+                                           buffer_x_desciptors);
+    PopDescriptors<IPC::BufferDescriptorABW>(rp, src_cmdbuf, command_header->num_buf_a_descriptors,
+                                             buffer_a_desciptors);
+    PopDescriptors<IPC::BufferDescriptorABW>(rp, src_cmdbuf, command_header->num_buf_b_descriptors,
+                                             buffer_b_desciptors);
+    PopDescriptors<IPC::BufferDescriptorABW>(rp, src_cmdbuf, command_header->num_buf_w_descriptors,
+                                             buffer_w_desciptors);
 
     buffer_c_offset = rp.GetCurrentOffset() + command_header->data_size;
 
@@ -168,24 +227,9 @@ void HLERequestContext::ParseCommandBuffer(const HandleTable& handle_table, u32_
 
     // For Inline buffers, the response data is written directly to buffer_c_offset
     // and in this case we don't have any BufferDescriptorC on the request.
-    if (command_header->buf_c_descriptor_flags >
-        IPC::CommandHeader::BufferDescriptorCFlag::InlineDescriptor) {
-        if (command_header->buf_c_descriptor_flags ==
-            IPC::CommandHeader::BufferDescriptorCFlag::OneDescriptor) {
-            buffer_c_desciptors.push_back(rp.PopRaw<IPC::BufferDescriptorC>());
-        } else {
-            unsigned num_buf_c_descriptors =
-                static_cast<unsigned>(command_header->buf_c_descriptor_flags.Value()) - 2;
-
-            // This is used to detect possible underflows, in case something is broken
-            // with the two ifs above and the flags value is == 0 || == 1.
-            ASSERT(num_buf_c_descriptors < 14);
-
-            for (unsigned i = 0; i < num_buf_c_descriptors; ++i) {
-                buffer_c_desciptors.push_back(rp.PopRaw<IPC::BufferDescriptorC>());
-            }
-        }
-    }
+    const auto buf_c_flags = static_cast<u32>(command_header->buf_c_descriptor_flags.Value());
+    PopDescriptors<IPC::BufferDescriptorC>(rp, src_cmdbuf, NUM_BUFFER_C_DESCRIPTORS[buf_c_flags],
+                                           buffer_c_desciptors);
 
     rp.SetCurrentOffset(data_payload_offset);
 
@@ -295,6 +339,18 @@ std::vector<u8> HLERequestContext::ReadBuffer(int buffer_index) const {
     return buffer;
 }
 
+ReadBufferView HLERequestContext::ReadBufferSpan(int buffer_index) const {
+    const bool is_buffer_a{BufferDescriptorA().size() && BufferDescriptorA()[buffer_index].Size()};
+    const VAddr address{is_buffer_a ? BufferDescriptorA()[buffer_index].Address()
+                                    : BufferDescriptorX()[buffer_index].Address()};
+    const std::size_t size{GetReadBufferSize(buffer_index)};
+
+    if (const u8* pointer = Memory::GetContiguousPointer(address, size)) {
+        return ReadBufferView{pointer, size};
+    }
+    return ReadBufferView{ReadBuffer(buffer_index)};
+}
+
 std::size_t HLERequestContext::WriteBuffer(const void* buffer, std::size_t size,
                                            int buffer_index) const {
     if (size == 0) {
@@ -319,6 +375,30 @@ std::size_t HLERequestContext::WriteBuffer(const void* buffer, std::size_t size,
     return size;
 }
 
+WriteBufferView HLERequestContext::WriteBufferSpan(int buffer_index) const {
+    const bool is_buffer_b{BufferDescriptorB().size() && BufferDescriptorB()[buffer_index].Size()};
+    const VAddr address{is_buffer_b ? BufferDescriptorB()[buffer_index].Address()
+                                    : BufferDescriptorC()[buffer_index].Address()};
+    const std::size_t size{GetWriteBufferSize(buffer_index)};
+
+    if (u8* pointer = Memory::GetContiguousPointer(address, size)) {
+        return WriteBufferView{pointer, size};
+    }
+
+    // Start out with the current contents so that bytes the caller leaves alone keep their value
+    // once the copy is written back.
+    std::vector<u8> copy(size);
+    Memory::ReadBlock(address, copy.data(), size);
+    return WriteBufferView{std::move(copy), address};
+}
+
+u8* HLERequestContext::GetWriteBufferPointer(int buffer_index) const {
+    const bool is_buffer_b{BufferDescriptorB().size() && BufferDescriptorB()[buffer_index].Size()};
+    const VAddr address{is_buffer_b ? BufferDescriptorB()[buffer_index].Address()
+                                    : BufferDescriptorC()[buffer_index].Address()};
+    return Memory::GetContiguousPointer(address, GetWriteBufferSize(buffer_index));
+}
+
 std::size_t HLERequestContext::GetReadBufferSize(int buffer_index) const {
     const bool is_buffer_a{BufferDescriptorA().size() && BufferDescriptorA()[buffer_index].Size()};
     return is_buffer_a ? BufferDescriptorA()[buffer_index].Size()
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +30,7 @@ class HandleTable;
 class HLERequestContext;
 class Process;
 class ServerSession;
+class ServiceThread;
 class Thread;
 class ReadableEvent;
 class WritableEvent;
@@ -76,6 +78,84 @@ protected:
     std::vector<SharedPtr<ServerSession>> connected_sessions;
 };
 
+/**
+ * Read-only view of an IPC input buffer. It refers straight to guest memory when the buffer is
+ * regular memory that is contiguous on the host, and to a private copy of the buffer otherwise.
+ */
+class ReadBufferView {
+public:
+    ReadBufferView(const u8* pointer, std::size_t size);
+    explicit ReadBufferView(std::vector<u8> buffer);
+    ~ReadBufferView();
+
+    ReadBufferView(const ReadBufferView&) = delete;
+    ReadBufferView& operator=(const ReadBufferView&) = delete;
+
+    ReadBufferView(ReadBufferView&&) noexcept;
+    ReadBufferView& operator=(ReadBufferView&&) noexcept;
+
+    const u8* data() const {
+        return pointer;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+    const u8* begin() const {
+        return pointer;
+    }
+
+    const u8* end() const {
+        return pointer + length;
+    }
+
+private:
+    const u8* pointer;
+    std::size_t length;
+    std::vector<u8> copy;
+};
+
+/**
+ * Writable view of an IPC output buffer. It refers straight to guest memory when the buffer is
+ * regular memory that is contiguous on the host. Otherwise it refers to a private copy of the
+ * buffer, which is written back to guest memory when the view is destroyed.
+ */
+class WriteBufferView {
+public:
+    WriteBufferView(u8* pointer, std::size_t size);
+    WriteBufferView(std::vector<u8> buffer, VAddr writeback_address);
+    ~WriteBufferView();
+
+    WriteBufferView(const WriteBufferView&) = delete;
+    WriteBufferView& operator=(const WriteBufferView&) = delete;
+
+    WriteBufferView(WriteBufferView&&) noexcept;
+    WriteBufferView& operator=(WriteBufferView&&) = delete;
+
+    u8* data() const {
+        return pointer;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+    u8* begin() const {
+        return pointer;
+    }
+
+    u8* end() const {
+        return pointer + length;
+    }
+
+private:
+    u8* pointer;
+    std::size_t length;
+    std::vector<u8> copy;
+    VAddr writeback_address;
+};
+
 /**
  * Class containing information about an in-flight IPC request being handled by an HLE service
  * implementation. Services should avoid using old global APIs (e.g. Kernel::GetCommandBuffer()) and
@@ -97,6 +177,11 @@ protected:
  */
 class HLERequestContext {
 public:
+    /// Requests rarely carry more than a few buffers of each kind, so their descriptors are kept
+    /// inline instead of allocating on every request.
+    template <typename T>
+    using DescriptorList = boost::container::small_vector<T, 4>;
+
     explicit HLERequestContext(SharedPtr<ServerSession> session, SharedPtr<Thread> thread);
     ~HLERequestContext();
 
@@ -133,6 +218,19 @@ public:
                                                WakeupCallback&& callback,
                                                SharedPtr<WritableEvent> writable_event = nullptr);
 
+    /**
+     * Puts the specified guest thread to sleep while the blocking part of a request runs on a
+     * service thread, and wakes it up once it completed.
+     * @param service_thread Service thread to run the work on.
+     * @param reason Reason for pausing the thread, to be used for debugging purposes.
+     * @param work Blocking part of the request. It runs on another host thread, so it must neither
+     * touch guest memory nor kernel objects.
+     * @param callback Callback invoked on the emulated CPU thread once the work completed. Like for
+     * SleepClientThread, it must write the entire command response.
+     */
+    void RunOnServiceThread(ServiceThread& service_thread, const std::string& reason,
+                            std::function<void()>&& work, WakeupCallback&& callback);
+
     /// Populates this context with data from the requesting process/thread.
     ResultCode PopulateFromIncomingCommandBuffer(const HandleTable& handle_table,
                                                  u32_le* src_cmdbuf);
@@ -152,19 +250,19 @@ public:
         return data_payload_offset;
     }
 
-    const std::vector<IPC::BufferDescriptorX>& BufferDescriptorX() const {
+    const DescriptorList<IPC::BufferDescriptorX>& BufferDescriptorX() const {
         return buffer_x_desciptors;
     }
 
-    const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorA() const {
+    const DescriptorList<IPC::BufferDescriptorABW>& BufferDescriptorA() const {
         return buffer_a_desciptors;
     }
 
-    const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorB() const {
+    const DescriptorList<IPC::BufferDescriptorABW>& BufferDescriptorB() const {
         return buffer_b_desciptors;
     }
 
-    const std::vector<IPC::BufferDescriptorC>& BufferDescriptorC() const {
+    const DescriptorList<IPC::BufferDescriptorC>& BufferDescriptorC() const {
         return buffer_c_desciptors;
     }
 
@@ -179,9 +277,28 @@ public:
     /// Helper function to read a buffer using the appropriate buffer descriptor
     std::vector<u8> ReadBuffer(int buffer_index = 0) const;
 
+    /**
+     * Helper function to access an input buffer without copying it whenever possible. The view
+     * must not outlive the request.
+     */
+    ReadBufferView ReadBufferSpan(int buffer_index = 0) const;
+
     /// Helper function to write a buffer using the appropriate buffer descriptor
     std::size_t WriteBuffer(const void* buffer, std::size_t size, int buffer_index = 0) const;
 
+    /**
+     * Helper function to fill an output buffer in place whenever possible. The view covers the
+     * whole buffer and must not outlive the request.
+     */
+    WriteBufferView WriteBufferSpan(int buffer_index = 0) const;
+
+    /**
+     * Returns host memory backing the whole output buffer, or nullptr if it isn't contiguous.
+     * Unlike the other helpers, the pointer may be written from a service thread while the
+     * requesting thread sleeps.
+     */
+    u8* GetWriteBufferPointer(int buffer_index = 0) const;
+
     /* Helper function to write a buffer using the appropriate buffer descriptor
      *
      * @tparam ContiguousContainer an arbitrary container that satisfies the
@@ -232,12 +349,12 @@ public:
 
     template <typename T>
     std::shared_ptr<T> GetDomainRequestHandler(std::size_t index) const {
-        return std::static_pointer_cast<T>(domain_request_handlers.at(index));
+        return std::static_pointer_cast<T>(domain_request_handlers->at(index));
     }
 
     void SetDomainRequestHandlers(
         const std::vector<std::shared_ptr<SessionRequestHandler>>& handlers) {
-        domain_request_handlers = handlers;
+        domain_request_handlers = &handlers;
     }
 
     /// Clears the list of objects so that no lingering objects are written accidentally to the
@@ -277,17 +394,19 @@ private:
     std::optional<IPC::HandleDescriptorHeader> handle_descriptor_header;
     std::optional<IPC::DataPayloadHeader> data_payload_header;
     std::optional<IPC::DomainMessageHeader> domain_message_header;
-    std::vector<IPC::BufferDescriptorX> buffer_x_desciptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_a_desciptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_b_desciptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_w_desciptors;
-    std::vector<IPC::BufferDescriptorC> buffer_c_desciptors;
+    DescriptorList<IPC::BufferDescriptorX> buffer_x_desciptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_a_desciptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_b_desciptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_w_desciptors;
+    DescriptorList<IPC::BufferDescriptorC> buffer_c_desciptors;
 
     unsigned data_payload_offset{};
     unsigned buffer_c_offset{};
     u32_le command{};
 
-    std::vector<std::shared_ptr<SessionRequestHandler>> domain_request_handlers;
+    /// Handlers of the domain this request targets. Owned by the server session, which outlives
+    /// the request.
+    const std::vector<std::shared_ptr<SessionRequestHandler>>* domain_request_handlers{};
 };
 
 } // namespace Kernel
@@ -0,0 +1,42 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/hle/kernel/idle_loop_detector.h"
+
+namespace Kernel {
+
+bool IdleLoopDetector::RecordPollingCall(u64 signature) {
+    const auto recorded_at = [this](std::size_t distance) {
+        return history[(num_recorded - distance) % MAX_PERIOD];
+    };
+
+    if (period != 0 && recorded_at(period) == signature) {
+        ++repeats;
+    } else {
+        // Look for the shortest sequence that this call would repeat
+        period = 0;
+        repeats = 0;
+        for (std::size_t distance = 1; distance <= MAX_PERIOD && distance <= num_recorded;
+             ++distance) {
+            if (recorded_at(distance) == signature) {
+                period = distance;
+                repeats = 1;
+                break;
+            }
+        }
+    }
+
+    history[num_recorded % MAX_PERIOD] = signature;
+    ++num_recorded;
+
+    return repeats >= IDLE_THRESHOLD;
+}
+
+void IdleLoopDetector::Reset() {
+    num_recorded = 0;
+    period = 0;
+    repeats = 0;
+}
+
+} // namespace Kernel
@@ -0,0 +1,45 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Kernel {
+
+/**
+ * Detects guest threads that spin on polling SVCs without making progress, like a loop calling
+ * WaitSynchronization with a zero timeout or reading svcGetSystemTick until a deadline passes.
+ *
+ * Every polling SVC a thread makes is recorded as a signature of the SVC number, the calling PC
+ * and its arguments. Once the same short sequence of signatures keeps repeating, the thread is
+ * considered idle and the time it would spend spinning can be skipped.
+ */
+class IdleLoopDetector {
+public:
+    /**
+     * Records a polling SVC.
+     * @param signature Value identifying the SVC, its call site and its arguments.
+     * @returns true if the thread is considered to be stuck in an idle loop.
+     */
+    bool RecordPollingCall(u64 signature);
+
+    /// Forgets the recorded history, called whenever the thread does something else.
+    void Reset();
+
+private:
+    /// Longest sequence of SVCs that is recognized as a loop.
+    static constexpr std::size_t MAX_PERIOD = 4;
+    /// Number of times a sequence has to repeat before the thread is considered idle.
+    static constexpr u32 IDLE_THRESHOLD = 32;
+
+    std::array<u64, MAX_PERIOD> history{};
+    std::size_t num_recorded = 0;
+    std::size_t period = 0;
+    u32 repeats = 0;
+};
+
+} // namespace Kernel
@@ -2,10 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -18,7 +20,9 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/svc.h"
 #include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/writable_event.h"
 #include "core/hle/lock.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
@@ -64,6 +68,10 @@ static void ThreadWakeupCallback(u64 thread_handle, [[maybe_unused]] s64 cycles_
         thread->GetWaitHandle() != 0) {
         ASSERT(thread->GetStatus() == ThreadStatus::WaitMutex ||
                thread->GetStatus() == ThreadStatus::WaitCondVar);
+        if (thread->GetCondVarWaitAddress() != 0) {
+            thread->GetOwnerProcess()->GetCondVarWaitQueue().Remove(
+                thread->GetCondVarWaitAddress(), thread.get());
+        }
         thread->SetMutexWaitAddress(0);
         thread->SetCondVarWaitAddress(0);
         thread->SetWaitHandle(0);
@@ -79,6 +87,8 @@ static void ThreadWakeupCallback(u64 thread_handle, [[maybe_unused]] s64 cycles_
 
     if (thread->GetArbiterWaitAddress() != 0) {
         ASSERT(thread->GetStatus() == ThreadStatus::WaitArb);
+        thread->GetOwnerProcess()->GetAddressArbiter().RemoveWaiter(
+            thread->GetArbiterWaitAddress(), thread.get());
         thread->SetArbiterWaitAddress(0);
     }
 
@@ -111,7 +121,20 @@ struct KernelCore::Impl {
         thread_wakeup_callback_handle_table.Clear();
         thread_wakeup_event_type = nullptr;
 
+        {
+            std::lock_guard lock{service_work_mutex};
+            completed_service_work.clear();
+        }
+        service_work_completed_event_type = nullptr;
+
         named_ports.clear();
+
+        idle_loop_skip_count = 0;
+        idle_loop_skipped_ticks = 0;
+        for (std::size_t i = 0; i < NUM_SVCS; ++i) {
+            svc_call_counts[i] = 0;
+            svc_host_times[i] = 0;
+        }
     }
 
     // Creates the default system resource limit
@@ -130,6 +153,24 @@ struct KernelCore::Impl {
     void InitializeThreads() {
         thread_wakeup_event_type =
             system.CoreTiming().RegisterEvent("ThreadWakeupCallback", ThreadWakeupCallback);
+        service_work_completed_event_type = system.CoreTiming().RegisterEvent(
+            "ServiceWorkCompleted", [this](u64, s64) { SignalCompletedServiceWork(); });
+    }
+
+    // Wakes up the client threads whose requests were completed by a service thread.
+    void SignalCompletedServiceWork() {
+        std::lock_guard hle_lock{HLE::g_hle_lock};
+
+        std::vector<SharedPtr<WritableEvent>> events;
+        {
+            std::lock_guard lock{service_work_mutex};
+            events.swap(completed_service_work);
+        }
+        for (const auto& event : events) {
+            if (event) {
+                event->Signal();
+            }
+        }
     }
 
     std::atomic<u32> next_object_id{0};
@@ -137,6 +178,13 @@ struct KernelCore::Impl {
     std::atomic<u64> next_user_process_id{Process::ProcessIDMin};
     std::atomic<u64> next_thread_id{1};
 
+    std::atomic<u64> idle_loop_skip_count{0};
+    std::atomic<u64> idle_loop_skipped_ticks{0};
+
+    // Per-SVC statistics, indexed by SVC number
+    std::array<std::atomic<u64>, NUM_SVCS> svc_call_counts{};
+    std::array<std::atomic<u64>, NUM_SVCS> svc_host_times{};
+
     // Lists all processes that exist in the current session.
     std::vector<SharedPtr<Process>> process_list;
     Process* current_process = nullptr;
@@ -148,6 +196,10 @@ struct KernelCore::Impl {
     // allowing us to simply use a pool index or similar.
     Kernel::HandleTable thread_wakeup_callback_handle_table;
 
+    Core::Timing::EventType* service_work_completed_event_type = nullptr;
+    std::mutex service_work_mutex;
+    std::vector<SharedPtr<WritableEvent>> completed_service_work;
+
     /// Map of named ports managed by the kernel, which can be retrieved using
     /// the ConnectToPort SVC.
     NamedPortTable named_ports;
@@ -220,6 +272,41 @@ bool KernelCore::IsValidNamedPort(NamedPortTable::const_iterator port) const {
     return port != impl->named_ports.cend();
 }
 
+void KernelCore::RecordIdleLoopSkip(u64 skipped_ticks) {
+    ++impl->idle_loop_skip_count;
+    impl->idle_loop_skipped_ticks += skipped_ticks;
+}
+
+u64 KernelCore::GetIdleLoopSkipCount() const {
+    return impl->idle_loop_skip_count;
+}
+
+u64 KernelCore::GetIdleLoopSkippedTicks() const {
+    return impl->idle_loop_skipped_ticks;
+}
+
+void KernelCore::RecordSVCCall(u32 svc_id, u64 host_time_ns) {
+    ASSERT(svc_id < NUM_SVCS);
+    impl->svc_call_counts[svc_id].fetch_add(1, std::memory_order_relaxed);
+    impl->svc_host_times[svc_id].fetch_add(host_time_ns, std::memory_order_relaxed);
+}
+
+u64 KernelCore::GetSVCCallCount(u32 svc_id) const {
+    return svc_id < NUM_SVCS ? impl->svc_call_counts[svc_id].load() : 0;
+}
+
+u64 KernelCore::GetSVCHostTime(u32 svc_id) const {
+    return svc_id < NUM_SVCS ? impl->svc_host_times[svc_id].load() : 0;
+}
+
+void KernelCore::QueueServiceWorkCompletion(SharedPtr<WritableEvent> event) {
+    {
+        std::lock_guard lock{impl->service_work_mutex};
+        impl->completed_service_work.push_back(std::move(event));
+    }
+    impl->system.CoreTiming().ScheduleEventThreadsafe(0, impl->service_work_completed_event_type);
+}
+
 u32 KernelCore::CreateNewObjectID() {
     return impl->next_object_id++;
 }
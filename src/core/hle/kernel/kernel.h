@@ -25,6 +25,7 @@ class HandleTable;
 class Process;
 class ResourceLimit;
 class Thread;
+class WritableEvent;
 
 /// Represents a single instance of the kernel.
 class KernelCore {
@@ -87,6 +88,28 @@ public:
     /// Determines whether or not the given port is a valid named port.
     bool IsValidNamedPort(NamedPortTable::const_iterator port) const;
 
+    /// Records that an idle loop was detected and the given number of cycles were skipped.
+    void RecordIdleLoopSkip(u64 skipped_ticks);
+
+    /// Gets the number of times time was skipped because of idle loops.
+    u64 GetIdleLoopSkipCount() const;
+
+    /// Gets the total number of cycles skipped because of idle loops.
+    u64 GetIdleLoopSkippedTicks() const;
+
+    /// Records a call to the given SVC which took the given amount of host time.
+    void RecordSVCCall(u32 svc_id, u64 host_time_ns);
+
+    /// Gets the number of times the given SVC was called.
+    u64 GetSVCCallCount(u32 svc_id) const;
+
+    /// Gets the total host time in nanoseconds spent handling the given SVC.
+    u64 GetSVCHostTime(u32 svc_id) const;
+
+    /// Queues an event to be signaled on the emulated CPU thread, once a service thread finished
+    /// the work a client thread waits on. Can be called from any host thread.
+    void QueueServiceWorkCompletion(SharedPtr<WritableEvent> event);
+
 private:
     friend class Object;
     friend class Process;
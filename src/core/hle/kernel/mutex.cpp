@@ -69,6 +69,8 @@ ResultCode Mutex::TryAcquire(VAddr address, Handle holding_thread_handle,
         return ERR_INVALID_ADDRESS;
     }
 
+    std::lock_guard lock{state_mutex};
+
     const auto& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
     Thread* const current_thread = system.CurrentScheduler().GetCurrentThread();
     SharedPtr<Thread> holding_thread = handle_table.Get<Thread>(holding_thread_handle);
@@ -110,6 +112,8 @@ ResultCode Mutex::Release(VAddr address) {
         return ERR_INVALID_ADDRESS;
     }
 
+    std::lock_guard lock{state_mutex};
+
     auto* const current_thread = system.CurrentScheduler().GetCurrentThread();
     auto [thread, num_waiters] = GetHighestPriorityMutexWaitingThread(current_thread, address);
 
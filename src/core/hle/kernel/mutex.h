@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <mutex>
 #include "common/common_types.h"
 
 union ResultCode;
@@ -33,6 +34,10 @@ public:
 
 private:
     Core::System& system;
+
+    /// Serializes acquiring and releasing the mutexes of this process across cores, as both read
+    /// and update the mutex value in guest memory and the waiter lists of its threads.
+    std::mutex state_mutex;
 };
 
 } // namespace Kernel
@@ -4,16 +4,78 @@
 
 #pragma once
 
+#include <cstddef>
+#include <new>
+#include <vector>
 #include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+#include "common/virtual_buffer.h"
 
 namespace Kernel {
 
+/**
+ * Allocator of host memory backing guest memory. Large blocks come straight from the host OS:
+ * they are page aligned, eligible for huge pages, and only backed by memory once touched. Smaller
+ * blocks use the aligned heap. Every block is accounted as guest memory.
+ */
+template <typename T, std::size_t Align>
+class PhysicalMemoryAllocator : public Common::AlignmentAllocator<T, Align> {
+    using Base = Common::AlignmentAllocator<T, Align>;
+
+public:
+    /// Size in bytes from which blocks are allocated from the host OS, the size of a huge page.
+    static constexpr std::size_t PageAllocationThreshold = 0x200000;
+
+    template <typename T2>
+    struct rebind {
+        using other = PhysicalMemoryAllocator<T2, Align>;
+    };
+
+    static constexpr bool IsPageAllocation(std::size_t n) {
+        return n * sizeof(T) >= PageAllocationThreshold;
+    }
+
+    T* allocate(std::size_t n) {
+        T* const pointer = IsPageAllocation(n) ? AllocatePages(n) : Base::allocate(n);
+        Common::MemoryAccounting::Allocate(Common::MemoryAccounting::Tag::GuestMemory,
+                                           n * sizeof(T));
+        return pointer;
+    }
+
+    void deallocate(T* pointer, std::size_t n) {
+        Common::MemoryAccounting::Free(Common::MemoryAccounting::Tag::GuestMemory, n * sizeof(T));
+        if (!IsPageAllocation(n)) {
+            Base::deallocate(pointer, n);
+            return;
+        }
+        Common::FreeMemoryPages(pointer, n * sizeof(T));
+    }
+
+    bool operator==(const PhysicalMemoryAllocator&) const noexcept {
+        return true;
+    }
+
+    bool operator!=(const PhysicalMemoryAllocator&) const noexcept {
+        return false;
+    }
+
+private:
+    static T* AllocatePages(std::size_t n) {
+        void* const pointer = Common::TryAllocateMemoryPages(n * sizeof(T));
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(pointer);
+    }
+};
+
 // This encapsulation serves 2 purposes:
 // - First, to encapsulate host physical memory under a single type and set an
 // standard for managing it.
 // - Second to ensure all host backing memory used is aligned to 256 bytes due
 // to strict alignment restrictions on GPU memory.
 
-using PhysicalMemory = std::vector<u8, Common::AlignmentAllocator<u8, 256>>;
+using PhysicalMemory = std::vector<u8, PhysicalMemoryAllocator<u8, 256>>;
 
 } // namespace Kernel
@@ -47,6 +47,10 @@ void SetupMainThread(Process& owner_process, KernelCore& kernel, u32 priority) {
     // Threads by default are dormant, wake up the main thread so it runs when the scheduler fires
     thread->ResumeFromWait();
 }
+
+bool IsWaitingOnCondVar(const Thread& thread, VAddr address) {
+    return thread.GetCondVarWaitAddress() == address;
+}
 } // Anonymous namespace
 
 // Represents a page used for thread-local storage.
@@ -298,7 +302,8 @@ void Process::LoadModule(CodeSet module_, VAddr base_addr) {
 
 Process::Process(Core::System& system)
     : WaitObject{system.Kernel()}, vm_manager{system},
-      address_arbiter{system}, mutex{system}, system{system} {}
+      address_arbiter{system}, mutex{system}, condvar_wait_queue{IsWaitingOnCondVar},
+      system{system} {}
 
 Process::~Process() = default;
 
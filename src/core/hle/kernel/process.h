@@ -11,6 +11,7 @@
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/address_wait_queue.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/process_capability.h"
@@ -125,6 +126,11 @@ public:
         return address_arbiter;
     }
 
+    /// Gets a reference to the threads waiting on the condition variables of this process.
+    AddressWaitQueue& GetCondVarWaitQueue() {
+        return condvar_wait_queue;
+    }
+
     /// Gets a reference to the process' mutex lock.
     Mutex& GetMutex() {
         return mutex;
@@ -366,6 +372,9 @@ private:
     /// variable related facilities.
     Mutex mutex;
 
+    /// Threads waiting on a condition variable, keyed by its address.
+    AddressWaitQueue condvar_wait_queue;
+
     /// Address indicating the location of the process' dedicated TLS region.
     VAddr tls_region_address = 0;
 
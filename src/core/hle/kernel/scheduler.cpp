@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <mutex>
 #include <utility>
 
 #include "common/assert.h"
@@ -14,13 +16,12 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/scheduler.h"
+#include "core/settings.h"
 
 namespace Kernel {
 
-std::mutex Scheduler::scheduler_mutex;
-
-Scheduler::Scheduler(Core::System& system, Core::ARM_Interface& cpu_core)
-    : cpu_core{cpu_core}, system{system} {}
+Scheduler::Scheduler(Core::System& system, Core::ARM_Interface& cpu_core, u32 core_index)
+    : cpu_core{cpu_core}, core_index{core_index}, system{system} {}
 
 Scheduler::~Scheduler() {
     for (auto& thread : thread_list) {
@@ -30,7 +31,7 @@ Scheduler::~Scheduler() {
 
 bool Scheduler::HaveReadyThreads() const {
     std::lock_guard lock{scheduler_mutex};
-    return !ready_queue.empty();
+    return !ready_queue.Empty();
 }
 
 Thread* Scheduler::GetCurrentThread() const {
@@ -46,31 +47,105 @@ Thread* Scheduler::PopNextReadyThread() {
     Thread* thread = GetCurrentThread();
 
     if (thread && thread->GetStatus() == ThreadStatus::Running) {
-        if (ready_queue.empty()) {
+        if (ready_queue.Empty()) {
             return thread;
         }
         // We have to do better than the current thread.
         // This call returns null when that's not possible.
-        next = ready_queue.front();
+        next = ready_queue.Front();
         if (next == nullptr || next->GetPriority() >= thread->GetPriority()) {
             next = thread;
         }
     } else {
-        if (ready_queue.empty()) {
+        if (ready_queue.Empty()) {
             return nullptr;
         }
-        next = ready_queue.front();
+        next = ready_queue.Front();
     }
 
     return next;
 }
 
+Thread* Scheduler::FindSuggestedThread(u32 core, u32 maximum_priority) const {
+    // Threads are visited in priority order, so the search can stop at the first one that is not
+    // better than the requested priority.
+    const u64 mask = 1ULL << core;
+    for (Thread* thread = ready_queue.Front(); thread != nullptr;
+         thread = ready_queue.Next(thread)) {
+        if (thread->GetPriority() >= maximum_priority) {
+            break;
+        }
+        if ((thread->GetAffinityMask() & mask) != 0) {
+            return thread;
+        }
+    }
+    return nullptr;
+}
+
+Thread* Scheduler::StealReadyThread() {
+    Thread* suggested_thread = nullptr;
+    Scheduler* owner = nullptr;
+
+    // Cores whose scheduler is busy are skipped instead of waited for, which also keeps two cores
+    // that look at each other's queues at the same time from deadlocking.
+    std::array<std::unique_lock<std::mutex>, Core::NUM_CPU_CORES> other_locks;
+    for (u32 other_core = 0; other_core < Core::NUM_CPU_CORES; ++other_core) {
+        if (other_core == core_index) {
+            continue;
+        }
+
+        Scheduler& other = system.Scheduler(other_core);
+        other_locks[other_core] = std::unique_lock{other.scheduler_mutex, std::try_to_lock};
+        if (!other_locks[other_core].owns_lock()) {
+            continue;
+        }
+
+        // An idle core runs its own ready threads on its next reschedule, only take threads that
+        // would otherwise keep waiting.
+        if (other.current_thread == nullptr) {
+            continue;
+        }
+
+        const u32 maximum_priority =
+            suggested_thread != nullptr ? suggested_thread->GetPriority() : THREADPRIO_COUNT;
+        Thread* const thread = other.FindSuggestedThread(core_index, maximum_priority);
+        if (thread != nullptr) {
+            suggested_thread = thread;
+            owner = &other;
+        }
+    }
+
+    if (suggested_thread == nullptr) {
+        return nullptr;
+    }
+
+    LOG_TRACE(Kernel, "core {} takes thread {} from core {}", core_index,
+              suggested_thread->GetObjectId(), suggested_thread->GetProcessorID());
+
+    owner->ready_queue.Remove(suggested_thread);
+    thread_list.push_back(suggested_thread);
+    owner->thread_list.erase(
+        std::find(owner->thread_list.begin(), owner->thread_list.end(), suggested_thread));
+    ready_queue.PushBack(suggested_thread, suggested_thread->GetPriority());
+    suggested_thread->SetScheduler(*this, static_cast<s32>(core_index));
+
+    return suggested_thread;
+}
+
 void Scheduler::SwitchContext(Thread* new_thread) {
     Thread* previous_thread = GetCurrentThread();
     Process* const previous_process = system.Kernel().CurrentProcess();
 
     UpdateLastContextSwitchTime(previous_thread, previous_process);
 
+    if (new_thread != nullptr && new_thread == previous_thread &&
+        new_thread->GetStatus() == ThreadStatus::Running) {
+        // The running thread keeps the core, its registers are still loaded in the CPU. Saving and
+        // loading them again would copy the whole context, vector registers included, for nothing.
+        cpu_core.ClearExclusiveState();
+        return;
+    }
+
     // Save context for previous thread
     if (previous_thread) {
         cpu_core.SaveContext(previous_thread->GetContext());
@@ -80,7 +155,7 @@ void Scheduler::SwitchContext(Thread* new_thread) {
         if (previous_thread->GetStatus() == ThreadStatus::Running) {
             // This is only the case when a reschedule is triggered without the current thread
             // yielding execution (i.e. an event triggered, system core time-sliced, etc)
-            ready_queue.add(previous_thread, previous_thread->GetPriority(), false);
+            ready_queue.PushFront(previous_thread, previous_thread->GetPriority());
             previous_thread->SetStatus(ThreadStatus::Ready);
         }
     }
@@ -95,7 +170,7 @@ void Scheduler::SwitchContext(Thread* new_thread) {
 
         current_thread = new_thread;
 
-        ready_queue.remove(new_thread, new_thread->GetPriority());
+        ready_queue.Remove(new_thread);
         new_thread->SetStatus(ThreadStatus::Running);
 
         auto* const thread_owner_process = current_thread->GetOwnerProcess();
@@ -135,6 +210,10 @@ void Scheduler::Reschedule() {
 
     Thread* cur = GetCurrentThread();
     Thread* next = PopNextReadyThread();
+    if (next == nullptr && Settings::values.use_multi_core &&
+        Settings::values.use_cpu_load_balancing) {
+        next = StealReadyThread();
+    }
 
     if (cur && next) {
         LOG_TRACE(Kernel, "context switch {} -> {}", cur->GetObjectId(), next->GetObjectId());
@@ -164,14 +243,14 @@ void Scheduler::ScheduleThread(Thread* thread, u32 priority) {
     std::lock_guard lock{scheduler_mutex};
 
     ASSERT(thread->GetStatus() == ThreadStatus::Ready);
-    ready_queue.add(thread, priority);
+    ready_queue.PushBack(thread, priority);
 }
 
 void Scheduler::UnscheduleThread(Thread* thread, u32 priority) {
     std::lock_guard lock{scheduler_mutex};
 
     ASSERT(thread->GetStatus() == ThreadStatus::Ready);
-    ready_queue.remove(thread, priority);
+    ready_queue.Remove(thread);
 }
 
 void Scheduler::SetThreadPriority(Thread* thread, u32 priority) {
@@ -182,19 +261,13 @@ void Scheduler::SetThreadPriority(Thread* thread, u32 priority) {
 
     // If thread was ready, adjust queues
     if (thread->GetStatus() == ThreadStatus::Ready)
-        ready_queue.adjust(thread, thread->GetPriority(), priority);
+        ready_queue.ChangePriority(thread, priority);
 }
 
 Thread* Scheduler::GetNextSuggestedThread(u32 core, u32 maximum_priority) const {
     std::lock_guard lock{scheduler_mutex};
 
-    const u32 mask = 1U << core;
-    for (auto* thread : ready_queue) {
-        if ((thread->GetAffinityMask() & mask) != 0 && thread->GetPriority() < maximum_priority) {
-            return thread;
-        }
-    }
-    return nullptr;
+    return FindSuggestedThread(core, maximum_priority);
 }
 
 void Scheduler::YieldWithoutLoadBalancing(Thread* thread) {
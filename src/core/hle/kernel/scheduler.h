@@ -7,7 +7,7 @@
 #include <mutex>
 #include <vector>
 #include "common/common_types.h"
-#include "common/multi_level_queue.h"
+#include "common/intrusive_priority_queue.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/thread.h"
 
@@ -22,7 +22,7 @@ class Process;
 
 class Scheduler final {
 public:
-    explicit Scheduler(Core::System& system, Core::ARM_Interface& cpu_core);
+    explicit Scheduler(Core::System& system, Core::ARM_Interface& cpu_core, u32 core_index);
     ~Scheduler();
 
     /// Returns whether there are any threads that are ready to run.
@@ -133,6 +133,18 @@ private:
      */
     Thread* PopNextReadyThread();
 
+    /// Returns the best ready thread of this scheduler which may run on the given core and has a
+    /// better priority than the given one. The mutex of this scheduler must be held.
+    Thread* FindSuggestedThread(u32 core, u32 maximum_priority) const;
+
+    /**
+     * Takes over the best ready thread that waits behind the running thread of another core and
+     * whose affinity mask allows it to run on this one. Used to keep cores busy when CPU load
+     * balancing is enabled. The mutex of this scheduler must be held.
+     * @return The thread that was moved to this scheduler, or nullptr if there was none
+     */
+    Thread* StealReadyThread();
+
     /**
      * Switches the CPU's active thread context to that of the specified thread
      * @param new_thread The thread to switch to
@@ -155,16 +167,20 @@ private:
     /// Lists all thread ids that aren't deleted/etc.
     std::vector<SharedPtr<Thread>> thread_list;
 
-    /// Lists only ready thread ids.
-    Common::MultiLevelQueue<Thread*, THREADPRIO_LOWEST + 1> ready_queue;
+    /// Lists only ready threads, linked through the threads themselves.
+    Common::IntrusivePriorityQueue<Thread, THREADPRIO_LOWEST + 1> ready_queue;
 
     SharedPtr<Thread> current_thread = nullptr;
 
     Core::ARM_Interface& cpu_core;
+    u32 core_index;
     u64 last_context_switch_time = 0;
 
     Core::System& system;
-    static std::mutex scheduler_mutex;
+
+    /// Guards the queues and the current thread. When the scheduler of another core has to be
+    /// looked at while this one is locked, its mutex may only be tried, never waited for.
+    mutable std::mutex scheduler_mutex;
 };
 
 } // namespace Kernel
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <tuple>
 #include <utility>
 
@@ -19,6 +20,7 @@
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
 #include "core/hle/kernel/thread.h"
+#include "core/memory.h"
 
 namespace Kernel {
 
@@ -131,8 +133,13 @@ ResultCode ServerSession::HandleSyncRequest(SharedPtr<Thread> thread) {
     // from its ClientSession, so wake up any threads that may be waiting on a svcReplyAndReceive or
     // similar.
     Kernel::HLERequestContext context(this, thread);
-    u32* cmd_buf = (u32*)Memory::GetPointer(thread->GetTLSAddress());
-    context.PopulateFromIncomingCommandBuffer(kernel.CurrentProcess()->GetHandleTable(), cmd_buf);
+
+    // Copy the whole command buffer out of guest memory at once, parsing then only touches the
+    // host copy.
+    std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
+    Memory::ReadBlock(thread->GetTLSAddress(), cmd_buf.data(), sizeof(cmd_buf));
+    context.PopulateFromIncomingCommandBuffer(kernel.CurrentProcess()->GetHandleTable(),
+                                              cmd_buf.data());
 
     ResultCode result = RESULT_SUCCESS;
     // If the session has been converted to a domain, handle the domain request
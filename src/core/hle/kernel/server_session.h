@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
@@ -36,7 +37,7 @@ class Thread;
  * After the server replies to the request, the response is marshalled back to the caller's
  * TLS buffer and control is transferred back to it.
  */
-class ServerSession final : public WaitObject {
+class ServerSession final : public WaitObject, public SlabAllocated<ServerSession> {
 public:
     std::string GetTypeName() const override {
         return "ServerSession";
@@ -47,6 +48,7 @@ public:
     }
 
     static constexpr HandleType HANDLE_TYPE = HandleType::ServerSession;
+    static constexpr char SLAB_HEAP_NAME[] = "ServerSession";
     HandleType GetHandleType() const override {
         return HANDLE_TYPE;
     }
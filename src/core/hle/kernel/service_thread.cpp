@@ -0,0 +1,60 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+
+#include "common/thread.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/service_thread.h"
+#include "core/hle/kernel/writable_event.h"
+
+namespace Kernel {
+
+ServiceThread::ServiceThread(KernelCore& kernel, std::string name)
+    : kernel{kernel}, name{std::move(name)}, thread{&ServiceThread::Run, this} {}
+
+ServiceThread::~ServiceThread() {
+    stop_requested = true;
+    jobs.Push(Job{});
+    thread.join();
+
+    // Work that never ran is dropped here, on the emulated CPU thread, along with its event.
+    skipped_jobs.clear();
+}
+
+void ServiceThread::QueueWork(std::function<void()> work,
+                              SharedPtr<WritableEvent> completion_event) {
+    jobs.Push(Job{std::move(work), std::move(completion_event)});
+}
+
+void ServiceThread::RunSynchronously(const std::function<void()>& work) {
+    std::lock_guard lock{work_mutex};
+    work();
+}
+
+void ServiceThread::Run() {
+    Common::SetCurrentThreadName(name.c_str());
+
+    while (true) {
+        Job job = jobs.PopWait();
+        if (!job.work) {
+            return;
+        }
+        if (stop_requested) {
+            skipped_jobs.push_back(std::move(job));
+            continue;
+        }
+
+        {
+            std::lock_guard work_lock{work_mutex};
+            job.work();
+        }
+
+        // The event is handed back instead of being released here, kernel objects are only ever
+        // destroyed on the emulated CPU thread.
+        kernel.QueueServiceWorkCompletion(std::move(job.completion_event));
+    }
+}
+
+} // namespace Kernel
@@ -0,0 +1,74 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/threadsafe_queue.h"
+#include "core/hle/kernel/object.h"
+
+namespace Kernel {
+
+class KernelCore;
+class WritableEvent;
+
+/**
+ * Host thread that runs the blocking parts of HLE service requests, so that the emulated core
+ * which issued a request can run other guest threads in the meantime.
+ *
+ * Queued work runs in order, and never at the same time as work run synchronously. A service
+ * routes every request touching the same non-thread-safe state (like a VFS backend) through the
+ * same service thread, which keeps those requests from racing each other. Queued work must not
+ * touch kernel objects or guest memory, it only prepares the data that the completion callback
+ * writes back on the emulated CPU thread. The one exception is the output buffer of the request
+ * being waited on, when HLERequestContext::GetWriteBufferPointer hands out its host memory.
+ */
+class ServiceThread final {
+public:
+    explicit ServiceThread(KernelCore& kernel, std::string name);
+    ~ServiceThread();
+
+    ServiceThread(const ServiceThread&) = delete;
+    ServiceThread& operator=(const ServiceThread&) = delete;
+
+    /**
+     * Queues work to be run on this thread. Once it completes, the event is signaled on the
+     * emulated CPU thread. Work nobody waits for, like reading ahead, passes a null event.
+     * Blocks while the queue is full.
+     */
+    void QueueWork(std::function<void()> work, SharedPtr<WritableEvent> completion_event);
+
+    /// Runs work on the calling thread, in between the work queued on this thread.
+    void RunSynchronously(const std::function<void()>& work);
+
+private:
+    struct Job {
+        std::function<void()> work;
+        SharedPtr<WritableEvent> completion_event;
+    };
+
+    void Run();
+
+    KernelCore& kernel;
+    std::string name;
+
+    /// Held while work runs, no matter on which thread.
+    std::mutex work_mutex;
+
+    /// Any emulated core may queue work, a job without work tells the thread to exit.
+    Common::MPMCQueue<Job, 256> jobs;
+    std::atomic_bool stop_requested{false};
+    /// Work still queued when stopping, it's released by the destructor.
+    std::vector<Job> skipped_jobs;
+
+    std::thread thread;
+};
+
+} // namespace Kernel
@@ -0,0 +1,95 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <new>
+
+#include "common/alignment.h"
+#include "core/hle/kernel/slab_heap.h"
+
+namespace Kernel {
+namespace {
+/// Number of slots reserved at once when a heap runs out of free slots.
+constexpr std::size_t SlotsPerBlock = 32;
+
+struct SlabHeapRegistry {
+    std::mutex mutex;
+    std::vector<const SlabHeap*> heaps;
+};
+
+SlabHeapRegistry& GetRegistry() {
+    // Never destroyed, like the heaps it lists.
+    static SlabHeapRegistry* const registry = new SlabHeapRegistry;
+    return *registry;
+}
+} // Anonymous namespace
+
+SlabHeap::SlabHeap(const char* name, std::size_t object_size, std::size_t object_alignment)
+    : name{name}, slot_alignment{std::max(object_alignment, alignof(FreeSlot))} {
+    ASSERT(slot_alignment <= alignof(std::max_align_t));
+    slot_size = Common::AlignUp(std::max(object_size, sizeof(FreeSlot)), slot_alignment);
+
+    auto& registry = GetRegistry();
+    std::lock_guard lock{registry.mutex};
+    registry.heaps.push_back(this);
+}
+
+SlabHeap::~SlabHeap() {
+    auto& registry = GetRegistry();
+    std::lock_guard lock{registry.mutex};
+    registry.heaps.erase(std::remove(registry.heaps.begin(), registry.heaps.end(), this),
+                         registry.heaps.end());
+}
+
+void* SlabHeap::Allocate() {
+    std::lock_guard lock{mutex};
+    if (free_list == nullptr) {
+        Grow();
+    }
+
+    FreeSlot* const slot = free_list;
+    free_list = slot->next;
+    peak_objects = std::max(peak_objects, ++live_objects);
+    return slot;
+}
+
+void SlabHeap::Free(void* object) {
+    if (object == nullptr) {
+        return;
+    }
+
+    std::lock_guard lock{mutex};
+    ASSERT(live_objects > 0);
+    free_list = new (object) FreeSlot{free_list};
+    --live_objects;
+}
+
+SlabHeapStatistics SlabHeap::GetStatistics() const {
+    std::lock_guard lock{mutex};
+    return {name, live_objects, peak_objects, blocks.size() * SlotsPerBlock};
+}
+
+void SlabHeap::Grow() {
+    // new[] of u8 is aligned for any fundamental type, which covers every slot alignment.
+    auto& block = blocks.emplace_back(std::make_unique<u8[]>(slot_size * SlotsPerBlock));
+
+    // Thread the free list through the new slots in address order.
+    for (std::size_t i = SlotsPerBlock; i-- > 0;) {
+        free_list = new (block.get() + i * slot_size) FreeSlot{free_list};
+    }
+}
+
+std::vector<SlabHeapStatistics> GetSlabHeapStatistics() {
+    auto& registry = GetRegistry();
+    std::lock_guard lock{registry.mutex};
+
+    std::vector<SlabHeapStatistics> statistics;
+    statistics.reserve(registry.heaps.size());
+    for (const SlabHeap* heap : registry.heaps) {
+        statistics.push_back(heap->GetStatistics());
+    }
+    return statistics;
+}
+
+} // namespace Kernel
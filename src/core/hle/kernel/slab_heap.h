@@ -0,0 +1,89 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace Kernel {
+
+/// Allocation statistics of a slab heap.
+struct SlabHeapStatistics {
+    const char* name;
+    std::size_t live_objects; ///< Objects currently allocated from the heap.
+    std::size_t peak_objects; ///< Highest number of objects that were allocated at once.
+    std::size_t capacity;     ///< Number of slots the heap reserved so far.
+};
+
+/**
+ * Free-list allocator for kernel objects of a single type, similar to the slab heaps of the real
+ * kernel. Memory is reserved in blocks of slots and freed slots are reused for the next object,
+ * so creating and destroying objects of the type doesn't go through the general-purpose heap.
+ * Reserved memory is kept until exit.
+ */
+class SlabHeap final {
+public:
+    SlabHeap(const char* name, std::size_t object_size, std::size_t object_alignment);
+    ~SlabHeap();
+
+    SlabHeap(const SlabHeap&) = delete;
+    SlabHeap& operator=(const SlabHeap&) = delete;
+
+    void* Allocate();
+    void Free(void* object);
+
+    SlabHeapStatistics GetStatistics() const;
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    void Grow();
+
+    const char* name;
+    std::size_t slot_size;
+    std::size_t slot_alignment;
+
+    mutable std::mutex mutex;
+    FreeSlot* free_list = nullptr;
+    std::vector<std::unique_ptr<u8[]>> blocks;
+    std::size_t live_objects = 0;
+    std::size_t peak_objects = 0;
+};
+
+/// Returns the statistics of every slab heap that allocated an object so far.
+std::vector<SlabHeapStatistics> GetSlabHeapStatistics();
+
+/**
+ * Makes a kernel object type allocate its instances from its own slab heap. The type names its
+ * heap with a SLAB_HEAP_NAME constant.
+ */
+template <typename T>
+class SlabAllocated {
+public:
+    static void* operator new(std::size_t size) {
+        ASSERT(size == sizeof(T));
+        return GetSlabHeap().Allocate();
+    }
+
+    static void operator delete(void* object) {
+        GetSlabHeap().Free(object);
+    }
+
+private:
+    static SlabHeap& GetSlabHeap() {
+        // Intentionally never destroyed, objects may still be released during static destruction.
+        static SlabHeap* const heap = new SlabHeap(T::SLAB_HEAP_NAME, sizeof(T), alignof(T));
+        return *heap;
+    }
+};
+
+} // namespace Kernel
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cinttypes>
 #include <iterator>
 #include <mutex>
@@ -17,6 +19,7 @@
 #include "core/core.h"
 #include "core/core_cpu.h"
 #include "core/core_timing.h"
+#include "core/hle/function_hooks.h"
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
@@ -39,6 +42,7 @@
 #include "core/hle/service/service.h"
 #include "core/memory.h"
 #include "core/reporter.h"
+#include "core/tools/guest_profiler.h"
 
 namespace Kernel {
 namespace {
@@ -1617,6 +1621,7 @@ static ResultCode WaitProcessWideKeyAtomic(Core::System& system, VAddr mutex_add
     current_thread->SetWaitHandle(thread_handle);
     current_thread->SetStatus(ThreadStatus::WaitCondVar);
     current_thread->InvalidateWakeupCallback();
+    current_process->GetCondVarWaitQueue().Add(condition_variable_addr, current_thread);
 
     current_thread->WakeAfterDelay(nano_seconds);
 
@@ -1632,29 +1637,11 @@ static ResultCode SignalProcessWideKey(Core::System& system, VAddr condition_var
     LOG_TRACE(Kernel_SVC, "called, condition_variable_addr=0x{:X}, target=0x{:08X}",
               condition_variable_addr, target);
 
-    const auto RetrieveWaitingThreads = [&system](std::size_t core_index,
-                                                  std::vector<SharedPtr<Thread>>& waiting_threads,
-                                                  VAddr condvar_addr) {
-        const auto& scheduler = system.Scheduler(core_index);
-        const auto& thread_list = scheduler.GetThreadList();
-
-        for (const auto& thread : thread_list) {
-            if (thread->GetCondVarWaitAddress() == condvar_addr)
-                waiting_threads.push_back(thread);
-        }
-    };
-
-    // Retrieve a list of all threads that are waiting for this condition variable.
-    std::vector<SharedPtr<Thread>> waiting_threads;
-    RetrieveWaitingThreads(0, waiting_threads, condition_variable_addr);
-    RetrieveWaitingThreads(1, waiting_threads, condition_variable_addr);
-    RetrieveWaitingThreads(2, waiting_threads, condition_variable_addr);
-    RetrieveWaitingThreads(3, waiting_threads, condition_variable_addr);
-    // Sort them by priority, such that the highest priority ones come first.
-    std::sort(waiting_threads.begin(), waiting_threads.end(),
-              [](const SharedPtr<Thread>& lhs, const SharedPtr<Thread>& rhs) {
-                  return lhs->GetPriority() < rhs->GetPriority();
-              });
+    // Retrieve a list of all threads that are waiting for this condition variable, highest
+    // priority first.
+    auto& condvar_wait_queue = system.Kernel().CurrentProcess()->GetCondVarWaitQueue();
+    const std::vector<SharedPtr<Thread>> waiting_threads =
+        condvar_wait_queue.GetWaitingThreads(condition_variable_addr);
 
     // Only process up to 'target' threads, unless 'target' is -1, in which case process
     // them all.
@@ -1667,12 +1654,13 @@ static ResultCode SignalProcessWideKey(Core::System& system, VAddr condition_var
         return RESULT_SUCCESS;
 
     for (std::size_t index = 0; index < last; ++index) {
-        auto& thread = waiting_threads[index];
+        const auto& thread = waiting_threads[index];
 
         ASSERT(thread->GetCondVarWaitAddress() == condition_variable_addr);
 
         // liberate Cond Var Thread.
         thread->SetCondVarWaitAddress(0);
+        condvar_wait_queue.Remove(condition_variable_addr, thread.get());
 
         const std::size_t current_core = system.CurrentCoreIndex();
         auto& monitor = system.Monitor();
@@ -1785,7 +1773,7 @@ static u64 GetSystemTick(Core::System& system) {
     LOG_TRACE(Kernel_SVC, "called");
 
     auto& core_timing = system.CoreTiming();
-    const u64 result{core_timing.GetTicks()};
+    const u64 result{core_timing.GetSystemTicks()};
 
     // Advance time to defeat dumb games that busy-wait for the frame to end.
     core_timing.AddTicks(400);
@@ -2340,7 +2328,7 @@ static ResultCode GetThreadList(Core::System& system, u32* out_num_threads, VAdd
 
 namespace {
 struct FunctionDef {
-    using Func = void(Core::System&);
+    using Func = void(Core::System&, const SVCArguments&);
 
     u32 id;
     Func* func;
@@ -2348,7 +2336,7 @@ struct FunctionDef {
 };
 } // namespace
 
-static const FunctionDef SVC_Table[] = {
+constexpr FunctionDef SVC_Table[] = {
     {0x00, nullptr, "Unknown"},
     {0x01, SvcWrap<SetHeapSize>, "SetHeapSize"},
     {0x02, SvcWrap<SetMemoryPermission>, "SetMemoryPermission"},
@@ -2479,6 +2467,26 @@ static const FunctionDef SVC_Table[] = {
     {0x7F, nullptr, "CallSecureMonitor"},
 };
 
+static_assert(std::size(SVC_Table) == NUM_SVCS);
+
+/// The table is indexed directly by SVC number, which only works while every entry is in place.
+constexpr bool IsSVCTableOrdered() {
+    for (std::size_t i = 0; i < std::size(SVC_Table); ++i) {
+        if (SVC_Table[i].id != i) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(IsSVCTableOrdered(), "SVC_Table entries must be sorted by SVC number");
+
+const char* GetSVCName(u32 immediate) {
+    if (immediate >= std::size(SVC_Table)) {
+        return "Unknown";
+    }
+    return SVC_Table[immediate].name;
+}
+
 static const FunctionDef* GetSVCInfo(u32 func_num) {
     if (func_num >= std::size(SVC_Table)) {
         LOG_ERROR(Kernel_SVC, "Unknown svc=0x{:02X}", func_num);
@@ -2487,24 +2495,162 @@ static const FunctionDef* GetSVCInfo(u32 func_num) {
     return &SVC_Table[func_num];
 }
 
+/// Computes the value identifying an SVC call for idle loop detection.
+static u64 GetSVCSignature(const Core::ARM_Interface& arm_interface, u32 immediate,
+                           const SVCArguments& args) {
+    u64 signature = immediate;
+    const auto combine = [&signature](u64 value) {
+        signature ^= value + 0x9E3779B97F4A7C15ULL + (signature << 6) + (signature >> 2);
+    };
+
+    combine(arm_interface.GetPC());
+    for (std::size_t reg = 0; reg < 4; ++reg) {
+        combine(args[reg]);
+    }
+    return signature;
+}
+
+/// Returns whether an SVC call only polled for a state change without finding one.
+static bool IsPollingSVC(const Core::ARM_Interface& arm_interface, u32 immediate,
+                         u64 timeout_argument) {
+    switch (immediate) {
+    case 0x18: // WaitSynchronization
+        return timeout_argument == 0 &&
+               static_cast<u32>(arm_interface.GetReg(0)) == RESULT_TIMEOUT.raw;
+    case 0x1E: // GetSystemTick
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Ends the time slice of the current core early after an idle loop was detected, so that time
+/// skips ahead to the next CoreTiming event instead of being spent spinning.
+static void SkipIdleLoop(Core::System& system) {
+    auto& cpu_core = system.CpuCore(system.CurrentCoreIndex());
+
+    // Except in parallel mode, all cores share the same timeline. Only skip time when no other
+    // core has a thread to run then.
+    if (!Core::Cpu::IsParallelModeEnabled()) {
+        for (std::size_t i = 0; i < Core::NUM_CPU_CORES; ++i) {
+            if (i != cpu_core.CoreIndex() && !system.CpuCore(i).IsIdle()) {
+                return;
+            }
+        }
+    }
+
+    const s64 downcount = cpu_core.GetDowncount();
+    if (downcount <= 0) {
+        return;
+    }
+
+    cpu_core.AddTicks(static_cast<u64>(downcount));
+    system.Kernel().RecordIdleLoopSkip(static_cast<u64>(downcount));
+}
+
 MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
 
+#if MICROPROFILE_ENABLED
+/// Returns the profiler timer of an SVC, so that kernel time is broken down per call.
+static MicroProfileToken GetSVCProfileToken(u32 immediate) {
+    static const auto tokens = [] {
+        std::array<MicroProfileToken, NUM_SVCS> result{};
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            result[i] = MicroProfileGetToken("Kernel SVC", SVC_Table[i].name,
+                                             MP_RGB(70, 200, 70), MicroProfileTokenTypeCpu);
+        }
+        return result;
+    }();
+    return tokens[immediate];
+}
+#endif
+
+/// Runs the handler of a known SVC and accounts the host time it took against it.
+static void DispatchSVC(Core::System& system, const FunctionDef& info, u32 immediate,
+                        const SVCArguments& args) {
+    MICROPROFILE_SCOPE_TOKEN(GetSVCProfileToken(immediate));
+
+    const auto start = std::chrono::steady_clock::now();
+    info.func(system, args);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    system.Kernel().RecordSVCCall(
+        immediate,
+        static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+/// Returns whether an SVC only touches the state of the calling core or guest memory, those
+/// don't wait for the other cores to leave the kernel.
+static bool IsLockFreeSVC(u32 immediate) {
+    switch (immediate) {
+    case 0x10: // GetCurrentProcessorNumber
+    case 0x1E: // GetSystemTick
+    case 0x27: // OutputDebugString
+        return true;
+    default:
+        return false;
+    }
+}
+
 void CallSVC(Core::System& system, u32 immediate) {
+    // Hooked guest functions only touch guest memory, they don't need the kernel lock
+    if (HLE::IsFunctionHook(immediate)) {
+        HLE::CallFunctionHook(system.CurrentArmInterface(), immediate);
+        return;
+    }
+
     MICROPROFILE_SCOPE(Kernel_SVC);
 
     // Lock the global kernel mutex when we enter the kernel HLE.
-    std::lock_guard lock{HLE::g_hle_lock};
+    std::unique_lock lock{HLE::g_hle_lock, std::defer_lock};
+    if (!IsLockFreeSVC(immediate)) {
+        lock.lock();
+    }
+
+    // Read all argument registers up front. The wrappers take their parameters from this copy,
+    // and it keeps the arguments around after the SVC overwrote them with its results.
+    auto& arm_interface = system.CurrentArmInterface();
+    SVCArguments args;
+    for (std::size_t reg = 0; reg < args.size(); ++reg) {
+        args[reg] = arm_interface.GetReg(static_cast<int>(reg));
+    }
+
+    auto* const thread = system.CurrentScheduler().GetCurrentThread();
+    const u64 signature = GetSVCSignature(arm_interface, immediate, args);
 
     const FunctionDef* info = GetSVCInfo(immediate);
     if (info) {
         if (info->func) {
-            info->func(system);
+            auto* const profiler = system.GetGuestProfiler();
+            if (profiler == nullptr) {
+                DispatchSVC(system, *info, immediate, args);
+            } else {
+                // The SVC may switch threads, read the caller's frame first
+                const VAddr pc = arm_interface.GetPC();
+                const VAddr lr = arm_interface.GetReg(30);
+                const auto start = std::chrono::steady_clock::now();
+                DispatchSVC(system, *info, immediate, args);
+                profiler->RecordSVC(info->name, pc, lr, std::chrono::steady_clock::now() - start);
+            }
         } else {
             LOG_CRITICAL(Kernel_SVC, "Unimplemented SVC function {}(..)", info->name);
         }
     } else {
         LOG_CRITICAL(Kernel_SVC, "Unknown SVC function 0x{:X}", immediate);
     }
+
+    if (thread == nullptr) {
+        return;
+    }
+
+    auto& idle_loop_detector = thread->GetIdleLoopDetector();
+    if (!IsPollingSVC(arm_interface, immediate, args[3])) {
+        idle_loop_detector.Reset();
+        return;
+    }
+    if (idle_loop_detector.RecordPollingCall(signature)) {
+        SkipIdleLoop(system);
+    }
 }
 
 } // namespace Kernel
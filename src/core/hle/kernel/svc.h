@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 
 namespace Core {
@@ -12,6 +13,12 @@ class System;
 
 namespace Kernel {
 
+/// Number of SVC numbers the kernel dispatches, 0x00 through 0x7F.
+constexpr std::size_t NUM_SVCS = 0x80;
+
+/// Returns the name of an SVC, or "Unknown" if the number is out of range.
+const char* GetSVCName(u32 immediate);
+
 void CallSVC(Core::System& system, u32 immediate);
 
 } // namespace Kernel
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -11,8 +12,11 @@
 
 namespace Kernel {
 
-static inline u64 Param(const Core::System& system, int n) {
-    return system.CurrentArmInterface().GetReg(n);
+/// Argument registers X0-X7 of an SVC call, read from the guest once before it is dispatched.
+using SVCArguments = std::array<u64, 8>;
+
+static inline u64 Param(const SVCArguments& args, int n) {
+    return args[n];
 }
 
 /**
@@ -28,36 +32,36 @@ static inline void FuncReturn(Core::System& system, u64 result) {
 // Function wrappers that return type ResultCode
 
 template <ResultCode func(Core::System&, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0)).raw);
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0)).raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1)).raw);
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), Param(args, 1)).raw);
 }
 
 template <ResultCode func(Core::System&, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0))).raw);
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, static_cast<u32>(Param(args, 0))).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     FuncReturn(
         system,
-        func(system, static_cast<u32>(Param(system, 0)), static_cast<u32>(Param(system, 1))).raw);
+        func(system, static_cast<u32>(Param(args, 0)), static_cast<u32>(Param(args, 1))).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1),
-                            Param(system, 2), Param(system, 3))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, static_cast<u32>(Param(args, 0)), Param(args, 1),
+                            Param(args, 2), Param(args, 3))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u32*)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param = 0;
     const u32 retval = func(system, &param).raw;
     system.CurrentArmInterface().SetReg(1, param);
@@ -65,15 +69,15 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, u32*, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, static_cast<u32>(Param(system, 1))).raw;
+    const u32 retval = func(system, &param_1, static_cast<u32>(Param(args, 1))).raw;
     system.CurrentArmInterface().SetReg(1, param_1);
     FuncReturn(system, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u32*)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
     u32 param_2 = 0;
     const u32 retval = func(system, &param_1, &param_2).raw;
@@ -86,56 +90,56 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, u32*, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1)).raw;
+    const u32 retval = func(system, &param_1, Param(args, 1)).raw;
     system.CurrentArmInterface().SetReg(1, param_1);
     FuncReturn(system, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
     const u32 retval =
-        func(system, &param_1, Param(system, 1), static_cast<u32>(Param(system, 2))).raw;
+        func(system, &param_1, Param(args, 1), static_cast<u32>(Param(args, 2))).raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
     FuncReturn(system, retval);
 }
 
 template <ResultCode func(Core::System&, u64*, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u64 param_1 = 0;
-    const u32 retval = func(system, &param_1, static_cast<u32>(Param(system, 1))).raw;
+    const u32 retval = func(system, &param_1, static_cast<u32>(Param(args, 1))).raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
     FuncReturn(system, retval);
 }
 
 template <ResultCode func(Core::System&, u64, s32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<s32>(Param(system, 1))).raw);
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), static_cast<s32>(Param(args, 1))).raw);
 }
 
 template <ResultCode func(Core::System&, u64, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<u32>(Param(system, 1))).raw);
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), static_cast<u32>(Param(args, 1))).raw);
 }
 
 template <ResultCode func(Core::System&, u64*, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u64 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1)).raw;
+    const u32 retval = func(system, &param_1, Param(args, 1)).raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
     FuncReturn(system, retval);
 }
 
 template <ResultCode func(Core::System&, u64*, u32, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u64 param_1 = 0;
-    const u32 retval = func(system, &param_1, static_cast<u32>(Param(system, 1)),
-                            static_cast<u32>(Param(system, 2)))
+    const u32 retval = func(system, &param_1, static_cast<u32>(Param(args, 1)),
+                            static_cast<u32>(Param(args, 2)))
                            .raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
@@ -143,22 +147,22 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, u32, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1)).raw);
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, static_cast<u32>(Param(args, 0)), Param(args, 1)).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u32, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)),
-                            static_cast<u32>(Param(system, 1)), Param(system, 2))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, static_cast<u32>(Param(args, 0)),
+                            static_cast<u32>(Param(args, 1)), Param(args, 2))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u32, u32*, u64*)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
     u64 param_2 = 0;
-    const ResultCode retval = func(system, static_cast<u32>(Param(system, 2)), &param_1, &param_2);
+    const ResultCode retval = func(system, static_cast<u32>(Param(args, 2)), &param_1, &param_2);
 
     system.CurrentArmInterface().SetReg(1, param_1);
     system.CurrentArmInterface().SetReg(2, param_2);
@@ -166,57 +170,57 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)), static_cast<u32>(Param(system, 3)))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), Param(args, 1),
+                            static_cast<u32>(Param(args, 2)), static_cast<u32>(Param(args, 3)))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)), Param(system, 3))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), Param(args, 1),
+                            static_cast<u32>(Param(args, 2)), Param(args, 3))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, static_cast<u32>(Param(args, 0)), Param(args, 1),
+                            static_cast<u32>(Param(args, 2)))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1), Param(system, 2)).raw);
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), Param(args, 1), Param(args, 2)).raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     FuncReturn(
         system,
-        func(system, Param(system, 0), Param(system, 1), static_cast<u32>(Param(system, 2))).raw);
+        func(system, Param(args, 0), Param(args, 1), static_cast<u32>(Param(args, 2))).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u64, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1),
-                            Param(system, 2), static_cast<u32>(Param(system, 3)))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, static_cast<u32>(Param(args, 0)), Param(args, 1),
+                            Param(args, 2), static_cast<u32>(Param(args, 3)))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     FuncReturn(
         system,
-        func(system, static_cast<u32>(Param(system, 0)), Param(system, 1), Param(system, 2)).raw);
+        func(system, static_cast<u32>(Param(args, 0)), Param(args, 1), Param(args, 2)).raw);
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u64, s64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), static_cast<u32>(Param(system, 2)),
-                            static_cast<s64>(Param(system, 3)))
+    const u32 retval = func(system, &param_1, Param(args, 1), static_cast<u32>(Param(args, 2)),
+                            static_cast<s64>(Param(args, 3)))
                            .raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
@@ -224,27 +228,27 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32, s64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)), static_cast<s64>(Param(system, 3)))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), Param(args, 1),
+                            static_cast<u32>(Param(args, 2)), static_cast<s64>(Param(args, 3)))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u64*, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u64 param_1 = 0;
     const u32 retval =
-        func(system, &param_1, Param(system, 1), Param(system, 2), Param(system, 3)).raw;
+        func(system, &param_1, Param(args, 1), Param(args, 2), Param(args, 3)).raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
     FuncReturn(system, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u64, u64, u32, s32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), Param(system, 2), Param(system, 3),
-                            static_cast<u32>(Param(system, 4)), static_cast<s32>(Param(system, 5)))
+    const u32 retval = func(system, &param_1, Param(args, 1), Param(args, 2), Param(args, 3),
+                            static_cast<u32>(Param(args, 4)), static_cast<s32>(Param(args, 5)))
                            .raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
@@ -252,10 +256,10 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u64, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), Param(system, 2),
-                            static_cast<u32>(Param(system, 3)))
+    const u32 retval = func(system, &param_1, Param(args, 1), Param(args, 2),
+                            static_cast<u32>(Param(args, 3)))
                            .raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
@@ -263,10 +267,10 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, Handle*, u64, u32, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), static_cast<u32>(Param(system, 2)),
-                            static_cast<u32>(Param(system, 3)))
+    const u32 retval = func(system, &param_1, Param(args, 1), static_cast<u32>(Param(args, 2)),
+                            static_cast<u32>(Param(args, 3)))
                            .raw;
 
     system.CurrentArmInterface().SetReg(1, param_1);
@@ -274,16 +278,16 @@ void SvcWrap(Core::System& system) {
 }
 
 template <ResultCode func(Core::System&, u64, u32, s32, s64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<u32>(Param(system, 1)),
-                            static_cast<s32>(Param(system, 2)), static_cast<s64>(Param(system, 3)))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), static_cast<u32>(Param(args, 1)),
+                            static_cast<s32>(Param(args, 2)), static_cast<s64>(Param(args, 3)))
                            .raw);
 }
 
 template <ResultCode func(Core::System&, u64, u32, s32, s32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<u32>(Param(system, 1)),
-                            static_cast<s32>(Param(system, 2)), static_cast<s32>(Param(system, 3)))
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    FuncReturn(system, func(system, Param(args, 0), static_cast<u32>(Param(args, 1)),
+                            static_cast<s32>(Param(args, 2)), static_cast<s32>(Param(args, 3)))
                            .raw);
 }
 
@@ -291,7 +295,7 @@ void SvcWrap(Core::System& system) {
 // Function wrappers that return type u32
 
 template <u32 func(Core::System&)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     FuncReturn(system, func(system));
 }
 
@@ -299,7 +303,7 @@ void SvcWrap(Core::System& system) {
 // Function wrappers that return type u64
 
 template <u64 func(Core::System&)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     FuncReturn(system, func(system));
 }
 
@@ -307,28 +311,28 @@ void SvcWrap(Core::System& system) {
 /// Function wrappers that return type void
 
 template <void func(Core::System&)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, const SVCArguments& args) {
     func(system);
 }
 
 template <void func(Core::System&, s64)>
-void SvcWrap(Core::System& system) {
-    func(system, static_cast<s64>(Param(system, 0)));
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    func(system, static_cast<s64>(Param(args, 0)));
 }
 
 template <void func(Core::System&, u64, u64)>
-void SvcWrap(Core::System& system) {
-    func(system, Param(system, 0), Param(system, 1));
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    func(system, Param(args, 0), Param(args, 1));
 }
 
 template <void func(Core::System&, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
-    func(system, Param(system, 0), Param(system, 1), Param(system, 2));
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    func(system, Param(args, 0), Param(args, 1), Param(args, 2));
 }
 
 template <void func(Core::System&, u32, u64, u64)>
-void SvcWrap(Core::System& system) {
-    func(system, static_cast<u32>(Param(system, 0)), Param(system, 1), Param(system, 2));
+void SvcWrap(Core::System& system, const SVCArguments& args) {
+    func(system, static_cast<u32>(Param(args, 0)), Param(args, 1), Param(args, 2));
 }
 
 } // namespace Kernel
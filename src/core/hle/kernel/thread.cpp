@@ -371,6 +371,11 @@ void Thread::ChangeScheduler() {
     system.CpuCore(processor_id).PrepareReschedule();
 }
 
+void Thread::SetScheduler(Scheduler& new_scheduler, s32 new_processor_id) {
+    scheduler = &new_scheduler;
+    processor_id = new_processor_id;
+}
+
 bool Thread::AllWaitObjectsReady() const {
     return std::none_of(
         wait_objects.begin(), wait_objects.end(),
@@ -9,8 +9,11 @@
 #include <vector>
 
 #include "common/common_types.h"
+#include "common/intrusive_priority_queue.h"
 #include "core/arm/arm_interface.h"
+#include "core/hle/kernel/idle_loop_detector.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
@@ -75,7 +78,7 @@ enum class ThreadActivity : u32 {
     Paused = 1,
 };
 
-class Thread final : public WaitObject {
+class Thread final : public WaitObject, public SlabAllocated<Thread> {
 public:
     using MutexWaitingThreads = std::vector<SharedPtr<Thread>>;
 
@@ -116,6 +119,7 @@ public:
     }
 
     static constexpr HandleType HANDLE_TYPE = HandleType::Thread;
+    static constexpr char SLAB_HEAP_NAME[] = "Thread";
     HandleType GetHandleType() const override {
         return HANDLE_TYPE;
     }
@@ -278,6 +282,9 @@ public:
         return processor_id;
     }
 
+    /// Hands the thread over to the scheduler of another core, leaving its affinity unchanged.
+    void SetScheduler(Scheduler& new_scheduler, s32 new_processor_id);
+
     Process* GetOwnerProcess() {
         return owner_process;
     }
@@ -383,6 +390,19 @@ public:
     /// Sleeps this thread for the given amount of nanoseconds.
     void Sleep(s64 nanoseconds);
 
+    IdleLoopDetector& GetIdleLoopDetector() {
+        return idle_loop_detector;
+    }
+
+    /// Links of this thread in the ready queue of its scheduler.
+    Common::PriorityQueueLink<Thread, THREADPRIO_COUNT>& GetPriorityQueueLink() {
+        return ready_queue_link;
+    }
+
+    const Common::PriorityQueueLink<Thread, THREADPRIO_COUNT>& GetPriorityQueueLink() const {
+        return ready_queue_link;
+    }
+
 private:
     explicit Thread(KernelCore& kernel);
     ~Thread() override;
@@ -447,12 +467,16 @@ private:
     WakeupCallback wakeup_callback;
 
     Scheduler* scheduler = nullptr;
+    Common::PriorityQueueLink<Thread, THREADPRIO_COUNT> ready_queue_link;
 
     u32 ideal_core{0xFFFFFFFF};
     u64 affinity_mask{0x1};
 
     ThreadActivity activity = ThreadActivity::Normal;
 
+    /// Watches the SVCs made by this thread for signs of it spinning in an idle loop.
+    IdleLoopDetector idle_loop_detector;
+
     std::string name;
 };
 
@@ -4,11 +4,13 @@
 
 #include <algorithm>
 #include <iterator>
+#include <new>
 #include <utility>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/memory_hook.h"
+#include "common/virtual_buffer.h"
 #include "core/core.h"
 #include "core/file_sys/program_metadata.h"
 #include "core/hle/kernel/errors.h"
@@ -43,6 +45,10 @@ constexpr bool IsInsideAddressRange(VAddr address, u64 size, VAddr address_range
     const VAddr end_address = address + size - 1;
     return address_range_begin <= address && end_address <= address_range_end - 1;
 }
+
+// The most address space reserved for the heap, the size of the console's DRAM. A larger heap
+// still works but moves whenever it grows past this.
+constexpr u64 MAX_HEAP_RESERVATION = 0x100000000;
 } // Anonymous namespace
 
 bool VirtualMemoryArea::CanBeMergedWith(const VirtualMemoryArea& next) const {
@@ -87,6 +93,7 @@ void VMManager::Reset(FileSys::ProgramAddressSpaceType type) {
     VirtualMemoryArea initial_vma;
     initial_vma.size = address_space_end;
     vma_map.emplace(initial_vma.base, initial_vma);
+    free_regions.Insert(initial_vma.base, initial_vma.size);
 
     UpdatePageTableForVMA(initial_vma);
 }
@@ -151,27 +158,31 @@ ResultVal<VAddr> VMManager::FindFreeRegion(VAddr begin, VAddr end, u64 size) con
     ASSERT(begin < end);
     ASSERT(size <= end - begin);
 
-    const VMAHandle vma_handle =
-        std::find_if(vma_map.begin(), vma_map.end(), [begin, end, size](const auto& vma) {
-            if (vma.second.type != VMAType::Free) {
-                return false;
-            }
-            const VAddr vma_base = vma.second.base;
-            const VAddr vma_end = vma_base + vma.second.size;
-            const VAddr assumed_base = (begin < vma_base) ? vma_base : begin;
-            const VAddr used_range = assumed_base + size;
+    const auto fits = [begin, end, size](VAddr vma_base, u64 vma_size) {
+        const VAddr vma_end = vma_base + vma_size;
+        const VAddr assumed_base = (begin < vma_base) ? vma_base : begin;
+        const VAddr used_range = assumed_base + size;
+
+        return vma_base <= assumed_base && assumed_base < used_range && used_range < end &&
+               used_range <= vma_end;
+    };
 
-            return vma_base <= assumed_base && assumed_base < used_range && used_range < end &&
-                   used_range <= vma_end;
-        });
+    // Only the free region containing the start of the range can begin before it. Every other
+    // candidate starts at or after it, where the lowest large enough region is the only one that
+    // needs to be checked.
+    const VMAHandle first_vma = FindVMA(begin);
+    if (first_vma != vma_map.end() && first_vma->second.type == VMAType::Free &&
+        fits(first_vma->second.base, first_vma->second.size)) {
+        return MakeResult<VAddr>(begin);
+    }
 
-    if (vma_handle == vma_map.cend()) {
+    const auto region_base = free_regions.FindFirstFit(begin, size);
+    if (!region_base || !fits(*region_base, size)) {
         // TODO(Subv): Find the correct error code here.
         return ResultCode(-1);
     }
 
-    const VAddr target = std::max(begin, vma_handle->second.base);
-    return MakeResult<VAddr>(target);
+    return MakeResult<VAddr>(*region_base);
 }
 
 ResultVal<VMManager::VMAHandle> VMManager::MapMMIO(VAddr target, PAddr paddr, u64 size,
@@ -205,6 +216,7 @@ VMManager::VMAIter VMManager::Unmap(VMAIter vma_handle) {
     vma.paddr = 0;
 
     UpdatePageTableForVMA(vma);
+    free_regions.Insert(vma.base, vma.size);
 
     return MergeAdjacent(vma_handle);
 }
@@ -260,26 +272,29 @@ ResultVal<VAddr> VMManager::SetHeapSize(u64 size) {
     }
 
     if (heap_memory == nullptr) {
-        // Initialize heap
-        heap_memory = std::make_shared<PhysicalMemory>(size);
-        heap_end = heap_region_base + size;
+        // Initialize heap. Reserve the address space for the largest heap up front, so that
+        // growing the heap never moves it, which would copy it and rebuild every page table
+        // entry pointing into it. Pages are only backed by host memory once touched.
+        heap_memory = std::make_shared<PhysicalMemory>();
+        const u64 reservation = std::min(GetHeapRegionSize(), MAX_HEAP_RESERVATION);
+        try {
+            heap_memory->reserve(reservation);
+        } catch (const std::bad_alloc&) {
+            LOG_WARNING(Kernel, "Failed to reserve 0x{:X} bytes for the heap", reservation);
+        }
     } else {
         UnmapRange(heap_region_base, GetCurrentHeapSize());
     }
 
-    // If necessary, expand backing vector to cover new heap extents in
-    // the case of allocating. Otherwise, shrink the backing memory,
-    // if a smaller heap has been requested.
+    // Resize the backing vector to cover the new heap extents. It only moves when the heap grows
+    // past the reservation, a smaller heap hands its tail back to the host instead.
     const u64 old_heap_size = GetCurrentHeapSize();
-    if (size > old_heap_size) {
-        const u64 alloc_size = size - old_heap_size;
-
-        heap_memory->insert(heap_memory->end(), alloc_size, 0);
-        RefreshMemoryBlockMappings(heap_memory.get());
-    } else if (size < old_heap_size) {
-        heap_memory->resize(size);
-        heap_memory->shrink_to_fit();
-
+    const u8* const old_heap_data = heap_memory->data();
+    heap_memory->resize(size);
+    if (size < old_heap_size) {
+        DiscardHeapTail(old_heap_size);
+    }
+    if (heap_memory->data() != old_heap_data) {
         RefreshMemoryBlockMappings(heap_memory.get());
     }
 
@@ -477,7 +492,12 @@ ResultCode VMManager::MapCodeMemory(VAddr dst_address, VAddr src_address, u64 si
     Reprotect(src_vma_iter, VMAPermission::Read);
 
     // The destination memory region is fine as is, however we need to make it read-only.
-    return ReprotectRange(dst_address, size, VMAPermission::Read);
+    const auto reprotect_result = ReprotectRange(dst_address, size, VMAPermission::Read);
+
+    // Drop any code translated from whatever was mapped at the destination before
+    system.InvalidateCpuInstructionCacheRange(dst_address, size);
+
+    return reprotect_result;
 }
 
 ResultCode VMManager::UnmapCodeMemory(VAddr dst_address, VAddr src_address, u64 size) {
@@ -525,7 +545,7 @@ ResultCode VMManager::UnmapCodeMemory(VAddr dst_address, VAddr src_address, u64
     Reprotect(src_vma_iter, VMAPermission::ReadWrite);
 
     if (dst_memory_state == MemoryState::ModuleCode) {
-        system.InvalidateCpuInstructionCaches();
+        system.InvalidateCpuInstructionCacheRange(dst_address, size);
     }
 
     return unmap_result;
@@ -603,6 +623,20 @@ ResultCode VMManager::MirrorMemory(VAddr dst_addr, VAddr src_addr, u64 size, Mem
     return RESULT_SUCCESS;
 }
 
+void VMManager::DiscardHeapTail(u64 old_heap_size) {
+    // The capacity is kept so the heap can grow in place again, only the host pages between the
+    // new and the old end are handed back. They read as zero when the heap grows over them.
+    if (!PhysicalMemory::allocator_type::IsPageAllocation(heap_memory->capacity())) {
+        return;
+    }
+    u8* const data = heap_memory->data();
+    const u64 begin = Common::AlignUp(heap_memory->size(), Memory::PAGE_SIZE);
+    const u64 end = Common::AlignDown(old_heap_size, Memory::PAGE_SIZE);
+    if (begin < end) {
+        Common::DiscardMemoryPages(data + begin, end - begin);
+    }
+}
+
 void VMManager::RefreshMemoryBlockMappings(const PhysicalMemory* block) {
     // If this ever proves to have a noticeable performance impact, allow users of the function to
     // specify a specific range of addresses to limit the scan to.
@@ -656,6 +690,15 @@ ResultVal<VMManager::VMAIter> VMManager::CarveVMA(VAddr base, u64 size) {
         return ERR_INVALID_ADDRESS_STATE;
     }
 
+    // The carved out region is about to be mapped by the caller.
+    free_regions.Erase(vma.base);
+    if (start_in_vma != 0) {
+        free_regions.Insert(vma.base, start_in_vma);
+    }
+    if (end_in_vma != vma.size) {
+        free_regions.Insert(vma.base + end_in_vma, vma.size - end_in_vma);
+    }
+
     if (end_in_vma != vma.size) {
         // Split VMA at the end of the allocated region
         SplitVMA(vma_handle, end_in_vma);
@@ -750,6 +793,12 @@ VMManager::VMAIter VMManager::MergeAdjacent(VMAIter iter) {
 void VMManager::MergeAdjacentVMA(VirtualMemoryArea& left, const VirtualMemoryArea& right) {
     ASSERT(left.CanBeMergedWith(right));
 
+    if (left.type == VMAType::Free) {
+        free_regions.Erase(right.base);
+        free_regions.Erase(left.base);
+        free_regions.Insert(left.base, left.size + right.size);
+    }
+
     // Always merge allocated memory blocks, even when they don't share the same backing block.
     if (left.type == VMAType::AllocatedMemoryBlock &&
         (left.backing_block != right.backing_block || left.offset + left.size != right.offset)) {
@@ -890,6 +939,7 @@ void VMManager::Clear() {
 
 void VMManager::ClearVMAMap() {
     vma_map.clear();
+    free_regions.Clear();
 }
 
 void VMManager::ClearPageTable() {
@@ -11,6 +11,7 @@
 #include "common/common_types.h"
 #include "common/memory_hook.h"
 #include "common/page_table.h"
+#include "core/hle/kernel/free_region_tree.h"
 #include "core/hle/kernel/physical_memory.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
@@ -695,6 +696,9 @@ private:
     /// Updates the pages corresponding to this VMA so they match the VMA's attributes.
     void UpdatePageTableForVMA(const VirtualMemoryArea& vma);
 
+    /// Returns the host pages of the heap past its current size to the host after it shrank.
+    void DiscardHeapTail(u64 old_heap_size);
+
     /// Initializes memory region ranges to adhere to a given address space type.
     void InitializeMemoryRegionRanges(FileSys::ProgramAddressSpaceType type);
 
@@ -752,6 +756,9 @@ private:
      */
     VMAMap vma_map;
 
+    /// Index of all Free VMAs in `vma_map`, used to search for free space without a linear scan.
+    FreeRegionTree free_regions;
+
     u32 address_space_width = 0;
     VAddr address_space_base = 0;
     VAddr address_space_end = 0;
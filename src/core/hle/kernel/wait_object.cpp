@@ -16,12 +16,14 @@ WaitObject::WaitObject(KernelCore& kernel) : Object{kernel} {}
 WaitObject::~WaitObject() = default;
 
 void WaitObject::AddWaitingThread(SharedPtr<Thread> thread) {
+    std::lock_guard lock{waiting_threads_mutex};
     auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
     if (itr == waiting_threads.end())
         waiting_threads.push_back(std::move(thread));
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
+    std::lock_guard lock{waiting_threads_mutex};
     auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
     // If a thread passed multiple handles to the same object,
     // the kernel might attempt to remove the thread from the object's
@@ -31,10 +33,12 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
 }
 
 SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
-    Thread* candidate = nullptr;
+    SharedPtr<Thread> candidate;
     u32 candidate_priority = THREADPRIO_LOWEST + 1;
 
-    for (const auto& thread : waiting_threads) {
+    // Checking whether a thread is ready looks at the other objects it waits for, so the list is
+    // copied instead of keeping it locked meanwhile.
+    for (const auto& thread : GetWaitingThreads()) {
         const ThreadStatus thread_status = thread->GetStatus();
 
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
@@ -56,7 +60,7 @@ SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
         }
 
         if (ready_to_run) {
-            candidate = thread.get();
+            candidate = thread;
             candidate_priority = thread->GetPriority();
         }
     }
@@ -104,7 +108,8 @@ void WaitObject::WakeupAllWaitingThreads() {
     }
 }
 
-const std::vector<SharedPtr<Thread>>& WaitObject::GetWaitingThreads() const {
+std::vector<SharedPtr<Thread>> WaitObject::GetWaitingThreads() const {
+    std::lock_guard lock{waiting_threads_mutex};
     return waiting_threads;
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <vector>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
 #include "core/hle/kernel/object.h"
@@ -56,12 +57,16 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     SharedPtr<Thread> GetHighestPriorityReadyThread() const;
 
-    /// Get a const reference to the waiting threads list for debug use
-    const std::vector<SharedPtr<Thread>>& GetWaitingThreads() const;
+    /// Get a copy of the waiting threads list for debug use
+    std::vector<SharedPtr<Thread>> GetWaitingThreads() const;
 
 private:
     /// Threads waiting for this object to become available
     std::vector<SharedPtr<Thread>> waiting_threads;
+
+    /// Guards the waiting threads list. It is never held while a thread is woken up, as that
+    /// touches the lists of the other objects the thread waits for.
+    mutable std::mutex waiting_threads_mutex;
 };
 
 // Specialization of DynamicObjectCast for WaitObjects
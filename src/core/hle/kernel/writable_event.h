@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/slab_heap.h"
 
 namespace Kernel {
 
@@ -17,7 +18,7 @@ struct EventPair {
     SharedPtr<WritableEvent> writable;
 };
 
-class WritableEvent final : public Object {
+class WritableEvent final : public Object, public SlabAllocated<WritableEvent> {
 public:
     ~WritableEvent() override;
 
@@ -38,6 +39,7 @@ public:
     }
 
     static constexpr HandleType HANDLE_TYPE = HandleType::WritableEvent;
+    static constexpr char SLAB_HEAP_NAME[] = "WritableEvent";
     HandleType GetHandleType() const override {
         return HANDLE_TYPE;
     }
@@ -2,8 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <core/hle/lock.h>
+#include "common/microprofile.h"
+#include "core/hle/lock.h"
 
 namespace HLE {
-std::recursive_mutex g_hle_lock;
+
+MICROPROFILE_DEFINE(HLE_Lock_Wait, "Kernel", "HLE Lock Wait", MP_RGB(200, 70, 70));
+
+KernelLock g_hle_lock;
+
+void KernelLock::lock() {
+    if (mutex.try_lock()) {
+        return;
+    }
+    contention_count.fetch_add(1, std::memory_order_relaxed);
+    MICROPROFILE_META_CPU("HLE Lock Contentions", 1);
+    MICROPROFILE_SCOPE(HLE_Lock_Wait);
+    mutex.lock();
 }
+
+} // namespace HLE
@@ -4,9 +4,35 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include "common/common_types.h"
 
 namespace HLE {
+
+/// Recursive mutex counting how many times it had to be waited for.
+class KernelLock {
+public:
+    void lock();
+
+    bool try_lock() {
+        return mutex.try_lock();
+    }
+
+    void unlock() {
+        mutex.unlock();
+    }
+
+    /// Returns how many times a thread had to wait for the lock, can be called from any thread.
+    u64 GetContentionCount() const {
+        return contention_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::recursive_mutex mutex;
+    std::atomic<u64> contention_count{};
+};
+
 /*
  * Synchronizes access to the internal HLE kernel structures, it is acquired when a guest
  * application thread performs a syscall. It should be acquired by any host threads that read or
@@ -14,5 +40,6 @@ namespace HLE {
  * to the emulated memory is not protected by this mutex, and should be avoided in any threads other
  * than the CPU thread.
  */
-extern std::recursive_mutex g_hle_lock;
+extern KernelLock g_hle_lock;
+
 } // namespace HLE
@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <opus.h>
@@ -34,6 +36,16 @@ struct OpusPacketHeader {
 };
 static_assert(sizeof(OpusPacketHeader) == 0x8, "OpusHeader is an invalid size");
 
+struct OpusMultiStreamParameters {
+    u32_le sample_rate;
+    u32_le channel_count;
+    u32_le number_streams;
+    u32_le number_stereo_streams;
+    std::array<u8, 0x100> channel_mappings;
+};
+static_assert(sizeof(OpusMultiStreamParameters) == 0x110,
+              "OpusMultiStreamParameters is an invalid size");
+
 class OpusDecoderState {
 public:
     /// Describes extra behavior that may be asked of the decoding context.
@@ -68,15 +80,31 @@ public:
 private:
     void DecodeInterleavedHelper(Kernel::HLERequestContext& ctx, u64* performance,
                                  ExtraBehavior extra_behavior) {
-        u32 consumed = 0;
-        u32 sample_count = 0;
-        std::vector<opus_int16> samples(ctx.GetWriteBufferSize() / sizeof(opus_int16));
-
         if (extra_behavior == ExtraBehavior::ResetContext) {
             ResetDecoderContext();
         }
 
-        if (!DecodeOpusData(consumed, sample_count, ctx.ReadBuffer(), samples, performance)) {
+        // Both buffers are accessed in place, the samples are decoded straight into guest memory
+        const auto input = ctx.ReadBufferSpan();
+        auto output = ctx.WriteBufferSpan();
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        // Games may submit several packets back to back in one request, all that fit are decoded
+        u32 consumed = 0;
+        u32 sample_count = 0;
+        while (consumed < input.size()) {
+            const auto result =
+                DecodeOpusPacket(input.data() + consumed, input.size() - consumed,
+                                 output.data() + sample_count * channel_count * sizeof(s16),
+                                 output.size() - sample_count * channel_count * sizeof(s16),
+                                 consumed == 0);
+            if (!result) {
+                break;
+            }
+            consumed += result->consumed;
+            sample_count += result->sample_count;
+        }
+        if (consumed == 0) {
             LOG_ERROR(Audio, "Failed to decode opus data");
             IPC::ResponseBuilder rb{ctx, 2};
             // TODO(ogniK): Use correct error code
@@ -84,6 +112,11 @@ private:
             return;
         }
 
+        if (performance != nullptr) {
+            const auto end_time = std::chrono::high_resolution_clock::now() - start_time;
+            *performance = std::chrono::duration_cast<std::chrono::milliseconds>(end_time).count();
+        }
+
         const u32 param_size = performance != nullptr ? 6 : 4;
         IPC::ResponseBuilder rb{ctx, param_size};
         rb.Push(RESULT_SUCCESS);
@@ -92,59 +125,79 @@ private:
         if (performance) {
             rb.Push<u64>(*performance);
         }
-        ctx.WriteBuffer(samples.data(), samples.size() * sizeof(s16));
     }
 
-    bool DecodeOpusData(u32& consumed, u32& sample_count, const std::vector<u8>& input,
-                        std::vector<opus_int16>& output, u64* out_performance_time) const {
-        const auto start_time = std::chrono::high_resolution_clock::now();
-        const std::size_t raw_output_sz = output.size() * sizeof(opus_int16);
-        if (sizeof(OpusPacketHeader) > input.size()) {
-            LOG_ERROR(Audio, "Input is smaller than the header size, header_sz={}, input_sz={}",
-                      sizeof(OpusPacketHeader), input.size());
-            return false;
+    struct DecodeResult {
+        u32 consumed;     ///< Bytes of input consumed, header included
+        u32 sample_count; ///< Samples decoded per channel
+    };
+
+    /// Decodes the packet at the start of input into output. Errors are only logged for the first
+    /// packet of a request, what follows it may legitimately not be a packet.
+    std::optional<DecodeResult> DecodeOpusPacket(const u8* input, std::size_t input_size,
+                                                 u8* output, std::size_t raw_output_sz,
+                                                 bool log_errors) {
+        if (sizeof(OpusPacketHeader) > input_size) {
+            if (log_errors) {
+                LOG_ERROR(Audio,
+                          "Input is smaller than the header size, header_sz={}, input_sz={}",
+                          sizeof(OpusPacketHeader), input_size);
+            }
+            return std::nullopt;
         }
 
         OpusPacketHeader hdr{};
-        std::memcpy(&hdr, input.data(), sizeof(OpusPacketHeader));
-        if (sizeof(OpusPacketHeader) + static_cast<u32>(hdr.size) > input.size()) {
-            LOG_ERROR(Audio, "Input does not fit in the opus header size. data_sz={}, input_sz={}",
-                      sizeof(OpusPacketHeader) + static_cast<u32>(hdr.size), input.size());
-            return false;
+        std::memcpy(&hdr, input, sizeof(OpusPacketHeader));
+        if (hdr.size == 0 || sizeof(OpusPacketHeader) + static_cast<u32>(hdr.size) > input_size) {
+            if (log_errors) {
+                LOG_ERROR(Audio,
+                          "Input does not fit in the opus header size. data_sz={}, input_sz={}",
+                          sizeof(OpusPacketHeader) + static_cast<u32>(hdr.size), input_size);
+            }
+            return std::nullopt;
         }
 
-        const auto frame = input.data() + sizeof(OpusPacketHeader);
-        const auto decoded_sample_count = opus_packet_get_nb_samples(
-            frame, static_cast<opus_int32>(input.size() - sizeof(OpusPacketHeader)),
-            static_cast<opus_int32>(sample_rate));
-        if (decoded_sample_count * channel_count * sizeof(u16) > raw_output_sz) {
-            LOG_ERROR(
-                Audio,
-                "Decoded data does not fit into the output data, decoded_sz={}, raw_output_sz={}",
-                decoded_sample_count * channel_count * sizeof(u16), raw_output_sz);
-            return false;
+        const auto frame = input + sizeof(OpusPacketHeader);
+        const auto decoded_sample_count =
+            opus_packet_get_nb_samples(frame, static_cast<opus_int32>(hdr.size),
+                                       static_cast<opus_int32>(sample_rate));
+        if (decoded_sample_count < 0 ||
+            decoded_sample_count * channel_count * sizeof(u16) > raw_output_sz) {
+            if (log_errors) {
+                LOG_ERROR(Audio,
+                          "Decoded data does not fit into the output data, decoded_sz={}, "
+                          "raw_output_sz={}",
+                          decoded_sample_count * channel_count * sizeof(u16), raw_output_sz);
+            }
+            return std::nullopt;
         }
 
+        // Guest buffers are normally aligned, others go through an intermediate buffer
         const int frame_size = (static_cast<int>(raw_output_sz / sizeof(s16) / channel_count));
+        const bool is_aligned = reinterpret_cast<std::uintptr_t>(output) % alignof(opus_int16) == 0;
+        if (!is_aligned) {
+            unaligned_output.resize(static_cast<std::size_t>(frame_size) * channel_count);
+        }
+        opus_int16* const pcm =
+            is_aligned ? reinterpret_cast<opus_int16*>(output) : unaligned_output.data();
+
         const auto out_sample_count =
-            opus_multistream_decode(decoder.get(), frame, hdr.size, output.data(), frame_size, 0);
+            opus_multistream_decode(decoder.get(), frame, hdr.size, pcm, frame_size, 0);
         if (out_sample_count < 0) {
-            LOG_ERROR(Audio,
-                      "Incorrect sample count received from opus_decode, "
-                      "output_sample_count={}, frame_size={}, data_sz_from_hdr={}",
-                      out_sample_count, frame_size, static_cast<u32>(hdr.size));
-            return false;
+            if (log_errors) {
+                LOG_ERROR(Audio,
+                          "Incorrect sample count received from opus_decode, "
+                          "output_sample_count={}, frame_size={}, data_sz_from_hdr={}",
+                          out_sample_count, frame_size, static_cast<u32>(hdr.size));
+            }
+            return std::nullopt;
         }
-
-        const auto end_time = std::chrono::high_resolution_clock::now() - start_time;
-        sample_count = out_sample_count;
-        consumed = static_cast<u32>(sizeof(OpusPacketHeader) + hdr.size);
-        if (out_performance_time != nullptr) {
-            *out_performance_time =
-                std::chrono::duration_cast<std::chrono::milliseconds>(end_time).count();
+        if (!is_aligned) {
+            std::memcpy(output, pcm, out_sample_count * channel_count * sizeof(opus_int16));
         }
 
-        return true;
+        return DecodeResult{static_cast<u32>(sizeof(OpusPacketHeader) + hdr.size),
+                            static_cast<u32>(out_sample_count)};
     }
 
     void ResetDecoderContext() {
@@ -156,6 +209,7 @@ private:
     OpusDecoderPtr decoder;
     u32 sample_rate;
     u32 channel_count;
+    std::vector<opus_int16> unaligned_output;
 };
 
 class IHardwareOpusDecoderManager final : public ServiceFramework<IHardwareOpusDecoderManager> {
@@ -166,12 +220,12 @@ public:
         static const FunctionInfo functions[] = {
             {0, &IHardwareOpusDecoderManager::DecodeInterleavedOld, "DecodeInterleavedOld"},
             {1, nullptr, "SetContext"},
-            {2, nullptr, "DecodeInterleavedForMultiStreamOld"},
+            {2, &IHardwareOpusDecoderManager::DecodeInterleavedOld, "DecodeInterleavedForMultiStreamOld"},
             {3, nullptr, "SetContextForMultiStream"},
             {4, &IHardwareOpusDecoderManager::DecodeInterleavedWithPerfOld, "DecodeInterleavedWithPerfOld"},
-            {5, nullptr, "DecodeInterleavedForMultiStreamWithPerfOld"},
+            {5, &IHardwareOpusDecoderManager::DecodeInterleavedWithPerfOld, "DecodeInterleavedForMultiStreamWithPerfOld"},
             {6, &IHardwareOpusDecoderManager::DecodeInterleaved, "DecodeInterleaved"},
-            {7, nullptr, "DecodeInterleavedForMultiStream"},
+            {7, &IHardwareOpusDecoderManager::DecodeInterleaved, "DecodeInterleavedForMultiStream"},
         };
         // clang-format on
 
@@ -228,6 +282,38 @@ std::array<u8, 2> CreateMappingTable(u32 channel_count) {
 
     return {{0, 255}};
 }
+
+bool IsValidSampleRate(u32 sample_rate) {
+    return sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
+           sample_rate == 12000 || sample_rate == 8000;
+}
+
+bool IsValidMultiStreamParameters(const OpusMultiStreamParameters& params) {
+    return IsValidSampleRate(params.sample_rate) && params.channel_count >= 1 &&
+           params.channel_count <= params.channel_mappings.size() && params.number_streams >= 1 &&
+           params.number_stereo_streams <= params.number_streams &&
+           params.number_streams + params.number_stereo_streams <= 255;
+}
+
+void OpenDecoder(Kernel::HLERequestContext& ctx, u32 sample_rate, u32 channel_count,
+                 u32 number_streams, u32 number_stereo_streams, const u8* mapping_table) {
+    int error = 0;
+    OpusDecoderPtr decoder{opus_multistream_decoder_create(
+        sample_rate, static_cast<int>(channel_count), static_cast<int>(number_streams),
+        static_cast<int>(number_stereo_streams), mapping_table, &error)};
+    if (error != OPUS_OK || decoder == nullptr) {
+        LOG_ERROR(Audio, "Failed to create Opus decoder (error={}).", error);
+        IPC::ResponseBuilder rb{ctx, 2};
+        // TODO(ogniK): Use correct error code
+        rb.Push(ResultCode(-1));
+        return;
+    }
+
+    IPC::ResponseBuilder rb{ctx, 2, 0, 1};
+    rb.Push(RESULT_SUCCESS);
+    rb.PushIpcInterface<IHardwareOpusDecoderManager>(
+        OpusDecoderState{std::move(decoder), sample_rate, channel_count});
+}
 } // Anonymous namespace
 
 void HwOpus::GetWorkBufferSize(Kernel::HLERequestContext& ctx) {
@@ -237,9 +323,7 @@ void HwOpus::GetWorkBufferSize(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Audio, "called with sample_rate={}, channel_count={}", sample_rate, channel_count);
 
-    ASSERT_MSG(sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
-                   sample_rate == 12000 || sample_rate == 8000,
-               "Invalid sample rate");
+    ASSERT_MSG(IsValidSampleRate(sample_rate), "Invalid sample rate");
     ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
 
     const u32 worker_buffer_sz = static_cast<u32>(WorkerBufferSize(channel_count));
@@ -259,41 +343,78 @@ void HwOpus::OpenOpusDecoder(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Audio, "called sample_rate={}, channel_count={}, buffer_size={}", sample_rate,
               channel_count, buffer_sz);
 
-    ASSERT_MSG(sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
-                   sample_rate == 12000 || sample_rate == 8000,
-               "Invalid sample rate");
+    ASSERT_MSG(IsValidSampleRate(sample_rate), "Invalid sample rate");
     ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
 
     const std::size_t worker_sz = WorkerBufferSize(channel_count);
     ASSERT_MSG(buffer_sz >= worker_sz, "Worker buffer too large");
 
-    const int num_stereo_streams = channel_count == 2 ? 1 : 0;
+    const u32 num_stereo_streams = channel_count == 2 ? 1 : 0;
     const auto mapping_table = CreateMappingTable(channel_count);
+    OpenDecoder(ctx, sample_rate, channel_count, 1, num_stereo_streams, mapping_table.data());
+}
 
-    int error = 0;
-    OpusDecoderPtr decoder{
-        opus_multistream_decoder_create(sample_rate, static_cast<int>(channel_count), 1,
-                                        num_stereo_streams, mapping_table.data(), &error)};
-    if (error != OPUS_OK || decoder == nullptr) {
-        LOG_ERROR(Audio, "Failed to create Opus decoder (error={}).", error);
+void HwOpus::OpenOpusDecoderForMultiStream(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const auto buffer_sz = rp.Pop<u32>();
+
+    OpusMultiStreamParameters params{};
+    const auto input = ctx.ReadBufferSpan();
+    std::memcpy(&params, input.data(), std::min(input.size(), sizeof(params)));
+
+    LOG_DEBUG(Audio,
+              "called sample_rate={}, channel_count={}, number_streams={}, "
+              "number_stereo_streams={}, buffer_size={}",
+              params.sample_rate, params.channel_count, params.number_streams,
+              params.number_stereo_streams, buffer_sz);
+
+    if (!IsValidMultiStreamParameters(params)) {
+        LOG_ERROR(Audio, "Invalid multistream parameters");
         IPC::ResponseBuilder rb{ctx, 2};
         // TODO(ogniK): Use correct error code
         rb.Push(ResultCode(-1));
         return;
     }
 
-    IPC::ResponseBuilder rb{ctx, 2, 0, 1};
+    const std::size_t worker_sz = opus_multistream_decoder_get_size(
+        static_cast<int>(params.number_streams), static_cast<int>(params.number_stereo_streams));
+    ASSERT_MSG(buffer_sz >= worker_sz, "Worker buffer too large");
+
+    OpenDecoder(ctx, params.sample_rate, params.channel_count, params.number_streams,
+                params.number_stereo_streams, params.channel_mappings.data());
+}
+
+void HwOpus::GetWorkBufferSizeForMultiStream(Kernel::HLERequestContext& ctx) {
+    OpusMultiStreamParameters params{};
+    const auto input = ctx.ReadBufferSpan();
+    std::memcpy(&params, input.data(), std::min(input.size(), sizeof(params)));
+
+    LOG_DEBUG(Audio, "called with number_streams={}, number_stereo_streams={}",
+              params.number_streams, params.number_stereo_streams);
+
+    if (!IsValidMultiStreamParameters(params)) {
+        LOG_ERROR(Audio, "Invalid multistream parameters");
+        IPC::ResponseBuilder rb{ctx, 2};
+        // TODO(ogniK): Use correct error code
+        rb.Push(ResultCode(-1));
+        return;
+    }
+
+    const u32 worker_buffer_sz = static_cast<u32>(opus_multistream_decoder_get_size(
+        static_cast<int>(params.number_streams), static_cast<int>(params.number_stereo_streams)));
+    LOG_DEBUG(Audio, "worker_buffer_sz={}", worker_buffer_sz);
+
+    IPC::ResponseBuilder rb{ctx, 3};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<IHardwareOpusDecoderManager>(
-        OpusDecoderState{std::move(decoder), sample_rate, channel_count});
+    rb.Push<u32>(worker_buffer_sz);
 }
 
 HwOpus::HwOpus() : ServiceFramework("hwopus") {
     static const FunctionInfo functions[] = {
         {0, &HwOpus::OpenOpusDecoder, "OpenOpusDecoder"},
         {1, &HwOpus::GetWorkBufferSize, "GetWorkBufferSize"},
-        {2, nullptr, "OpenOpusDecoderForMultiStream"},
-        {3, nullptr, "GetWorkBufferSizeForMultiStream"},
+        {2, &HwOpus::OpenOpusDecoderForMultiStream, "OpenOpusDecoderForMultiStream"},
+        {3, &HwOpus::GetWorkBufferSizeForMultiStream, "GetWorkBufferSizeForMultiStream"},
     };
     RegisterHandlers(functions);
 }
@@ -311,7 +311,8 @@ void SynchronizeInternal(DirectoryGetter dir_getter, TitleIDVersion title,
         return;
     }
 
-    const auto extracted = FileSys::ExtractZIP(std::make_shared<FileSys::VectorVfsFile>(bytes));
+    const auto extracted =
+        FileSys::OpenZIP(std::make_shared<FileSys::VectorVfsFile>(std::move(bytes)));
     if (extracted == nullptr) {
         LOG_ERROR(Service_BCAT, "Boxcat failed to extract ZIP file!");
         progress.FinishDownload(ERROR_GENERAL_BCAT_FAILURE);
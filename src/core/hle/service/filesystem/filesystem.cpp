@@ -2,10 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <utility>
 
 #include "common/assert.h"
 #include "common/file_util.h"
+#include "common/scope_exit.h"
 #include "core/core.h"
 #include "core/file_sys/bis_factory.h"
 #include "core/file_sys/card_image.h"
@@ -17,6 +19,7 @@
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs_factory.h"
 #include "core/file_sys/savedata_factory.h"
+#include "core/file_sys/savedata_journal.h"
 #include "core/file_sys/sdmc_factory.h"
 #include "core/file_sys/vfs.h"
 #include "core/file_sys/vfs_offset.h"
@@ -43,6 +46,41 @@ static FileSys::VirtualDir GetDirectoryRelativeWrapped(FileSys::VirtualDir base,
     return base->GetDirectoryRelative(dir_name);
 }
 
+/// Bumped by every write through a filesystem, caches filled before it are stale
+static std::atomic<u64> filesystem_generation{1};
+
+/// Caches are dropped as a whole once they reach this many directories
+constexpr std::size_t MaxCachedDirectories = 0x400;
+
+template <typename T>
+static void AppendEntries(std::vector<FileSys::Entry>& entries, const std::vector<T>& new_data,
+                          FileSys::EntryType type) {
+    for (const auto& new_entry : new_data) {
+        entries.emplace_back(new_entry->GetName(), type, new_entry->GetSize());
+    }
+}
+
+DirectoryListing::DirectoryListing(const FileSys::VfsDirectory& directory) {
+    const auto files = directory.GetFiles();
+    const auto subdirectories = directory.GetSubdirectories();
+    entries.reserve(files.size() + subdirectories.size());
+    AppendEntries(entries, files, FileSys::File);
+    AppendEntries(entries, subdirectories, FileSys::Directory);
+
+    types.reserve(entries.size());
+    for (const auto& entry : entries) {
+        types.emplace(entry.filename, entry.type);
+    }
+}
+
+std::optional<FileSys::EntryType> DirectoryListing::FindEntry(std::string_view name) const {
+    const auto it = types.find(name);
+    if (it == types.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
 VfsDirectoryServiceWrapper::VfsDirectoryServiceWrapper(FileSys::VirtualDir backing_)
     : backing(std::move(backing_)) {}
 
@@ -53,8 +91,9 @@ std::string VfsDirectoryServiceWrapper::GetName() const {
 }
 
 ResultCode VfsDirectoryServiceWrapper::CreateFile(const std::string& path_, u64 size) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     std::string path(FileUtil::SanitizePath(path_));
-    auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
+    auto dir = GetDirectory(FileUtil::GetParentPath(path));
     auto file = dir->CreateFile(FileUtil::GetFilename(path));
     if (file == nullptr) {
         // TODO(DarkLordZach): Find a better error code for this
@@ -68,13 +107,14 @@ ResultCode VfsDirectoryServiceWrapper::CreateFile(const std::string& path_, u64
 }
 
 ResultCode VfsDirectoryServiceWrapper::DeleteFile(const std::string& path_) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     std::string path(FileUtil::SanitizePath(path_));
     if (path.empty()) {
         // TODO(DarkLordZach): Why do games call this and what should it do? Works as is but...
         return RESULT_SUCCESS;
     }
 
-    auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
+    auto dir = GetDirectory(FileUtil::GetParentPath(path));
     if (dir->GetFile(FileUtil::GetFilename(path)) == nullptr) {
         return FileSys::ERROR_PATH_NOT_FOUND;
     }
@@ -87,8 +127,9 @@ ResultCode VfsDirectoryServiceWrapper::DeleteFile(const std::string& path_) cons
 }
 
 ResultCode VfsDirectoryServiceWrapper::CreateDirectory(const std::string& path_) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     std::string path(FileUtil::SanitizePath(path_));
-    auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
+    auto dir = GetDirectory(FileUtil::GetParentPath(path));
     if (dir == nullptr && FileUtil::GetFilename(FileUtil::GetParentPath(path)).empty())
         dir = backing;
     auto new_dir = dir->CreateSubdirectory(FileUtil::GetFilename(path));
@@ -100,8 +141,9 @@ ResultCode VfsDirectoryServiceWrapper::CreateDirectory(const std::string& path_)
 }
 
 ResultCode VfsDirectoryServiceWrapper::DeleteDirectory(const std::string& path_) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     std::string path(FileUtil::SanitizePath(path_));
-    auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
+    auto dir = GetDirectory(FileUtil::GetParentPath(path));
     if (!dir->DeleteSubdirectory(FileUtil::GetFilename(path))) {
         // TODO(DarkLordZach): Find a better error code for this
         return ResultCode(-1);
@@ -110,8 +152,9 @@ ResultCode VfsDirectoryServiceWrapper::DeleteDirectory(const std::string& path_)
 }
 
 ResultCode VfsDirectoryServiceWrapper::DeleteDirectoryRecursively(const std::string& path_) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     std::string path(FileUtil::SanitizePath(path_));
-    auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
+    auto dir = GetDirectory(FileUtil::GetParentPath(path));
     if (!dir->DeleteSubdirectoryRecursive(FileUtil::GetFilename(path))) {
         // TODO(DarkLordZach): Find a better error code for this
         return ResultCode(-1);
@@ -120,8 +163,9 @@ ResultCode VfsDirectoryServiceWrapper::DeleteDirectoryRecursively(const std::str
 }
 
 ResultCode VfsDirectoryServiceWrapper::CleanDirectoryRecursively(const std::string& path) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     const std::string sanitized_path(FileUtil::SanitizePath(path));
-    auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(sanitized_path));
+    auto dir = GetDirectory(FileUtil::GetParentPath(sanitized_path));
 
     if (!dir->CleanSubdirectoryRecursive(FileUtil::GetFilename(sanitized_path))) {
         // TODO(DarkLordZach): Find a better error code for this
@@ -133,6 +177,7 @@ ResultCode VfsDirectoryServiceWrapper::CleanDirectoryRecursively(const std::stri
 
 ResultCode VfsDirectoryServiceWrapper::RenameFile(const std::string& src_path_,
                                                   const std::string& dest_path_) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     std::string src_path(FileUtil::SanitizePath(src_path_));
     std::string dest_path(FileUtil::SanitizePath(dest_path_));
     auto src = backing->GetFileRelative(src_path);
@@ -168,9 +213,10 @@ ResultCode VfsDirectoryServiceWrapper::RenameFile(const std::string& src_path_,
 
 ResultCode VfsDirectoryServiceWrapper::RenameDirectory(const std::string& src_path_,
                                                        const std::string& dest_path_) const {
+    SCOPE_EXIT({ InvalidateCaches(); });
     std::string src_path(FileUtil::SanitizePath(src_path_));
     std::string dest_path(FileUtil::SanitizePath(dest_path_));
-    auto src = GetDirectoryRelativeWrapped(backing, src_path);
+    auto src = GetDirectory(src_path);
     if (FileUtil::GetParentPath(src_path) == FileUtil::GetParentPath(dest_path)) {
         // Use more-optimized vfs implementation rename.
         if (src == nullptr)
@@ -215,7 +261,7 @@ ResultVal<FileSys::VirtualFile> VfsDirectoryServiceWrapper::OpenFile(const std::
 
 ResultVal<FileSys::VirtualDir> VfsDirectoryServiceWrapper::OpenDirectory(const std::string& path_) {
     std::string path(FileUtil::SanitizePath(path_));
-    auto dir = GetDirectoryRelativeWrapped(backing, path);
+    auto dir = GetDirectory(path);
     if (dir == nullptr) {
         // TODO(DarkLordZach): Find a better error code for this
         return FileSys::ERROR_PATH_NOT_FOUND;
@@ -226,21 +272,85 @@ ResultVal<FileSys::VirtualDir> VfsDirectoryServiceWrapper::OpenDirectory(const s
 ResultVal<FileSys::EntryType> VfsDirectoryServiceWrapper::GetEntryType(
     const std::string& path_) const {
     std::string path(FileUtil::SanitizePath(path_));
-    auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
-    if (dir == nullptr)
+    const auto listing = GetListing(FileUtil::GetParentPath(path));
+    if (listing == nullptr)
         return FileSys::ERROR_PATH_NOT_FOUND;
     auto filename = FileUtil::GetFilename(path);
     // TODO(Subv): Some games use the '/' path, find out what this means.
     if (filename.empty())
         return MakeResult(FileSys::EntryType::Directory);
 
-    if (dir->GetFile(filename) != nullptr)
-        return MakeResult(FileSys::EntryType::File);
-    if (dir->GetSubdirectory(filename) != nullptr)
-        return MakeResult(FileSys::EntryType::Directory);
+    if (const auto type = listing->FindEntry(filename))
+        return MakeResult<FileSys::EntryType>(*type);
     return FileSys::ERROR_PATH_NOT_FOUND;
 }
 
+ResultCode VfsDirectoryServiceWrapper::Commit() const {
+    const auto journal = FileSys::SaveDataJournal::FromDirectory(backing);
+    if (journal != nullptr && !journal->Commit()) {
+        // TODO(DarkLordZach): Find a better error code for this
+        return ResultCode(-1);
+    }
+    return RESULT_SUCCESS;
+}
+
+ResultVal<std::shared_ptr<const DirectoryListing>> VfsDirectoryServiceWrapper::GetDirectoryListing(
+    const std::string& path) const {
+    auto listing = GetListing(path);
+    if (listing == nullptr) {
+        // TODO(DarkLordZach): Find a better error code for this
+        return FileSys::ERROR_PATH_NOT_FOUND;
+    }
+    return MakeResult(std::move(listing));
+}
+
+void VfsDirectoryServiceWrapper::InvalidateCaches() {
+    ++filesystem_generation;
+}
+
+FileSys::VirtualDir VfsDirectoryServiceWrapper::GetDirectory(std::string_view path) const {
+    ValidateCaches();
+    std::string key(FileUtil::SanitizePath(path));
+    if (const auto it = directory_cache.find(key); it != directory_cache.end()) {
+        return it->second;
+    }
+    if (directory_cache.size() >= MaxCachedDirectories) {
+        directory_cache.clear();
+    }
+    auto dir = GetDirectoryRelativeWrapped(backing, key);
+    directory_cache.emplace(std::move(key), dir);
+    return dir;
+}
+
+std::shared_ptr<const DirectoryListing> VfsDirectoryServiceWrapper::GetListing(
+    std::string_view path) const {
+    ValidateCaches();
+    std::string key(FileUtil::SanitizePath(path));
+    if (const auto it = listing_cache.find(key); it != listing_cache.end()) {
+        return it->second;
+    }
+    const auto dir = GetDirectory(key);
+    if (dir == nullptr) {
+        return nullptr;
+    }
+    if (listing_cache.size() >= MaxCachedDirectories) {
+        listing_cache.clear();
+    }
+    auto listing = std::make_shared<const DirectoryListing>(*dir);
+    listing_cache.emplace(std::move(key), listing);
+    return listing;
+}
+
+void VfsDirectoryServiceWrapper::ValidateCaches() const {
+    const u64 generation = filesystem_generation.load(std::memory_order_relaxed);
+    if (cache_generation == generation) {
+        return;
+    }
+    directory_cache.clear();
+    listing_cache.clear();
+    cache_generation = generation;
+}
+
 FileSystemController::FileSystemController() = default;
 
 FileSystemController::~FileSystemController() = default;
@@ -722,7 +832,8 @@ void FileSystemController::CreateFactories(FileSys::VfsFilesystem& vfs, bool ove
 void InstallInterfaces(Core::System& system) {
     std::make_shared<FSP_LDR>()->InstallAsService(system.ServiceManager());
     std::make_shared<FSP_PR>()->InstallAsService(system.ServiceManager());
-    std::make_shared<FSP_SRV>(system.GetFileSystemController(), system.GetReporter())
+    std::make_shared<FSP_SRV>(system.GetFileSystemController(), system.GetReporter(),
+                              system.Kernel())
         ->InstallAsService(system.ServiceManager());
 }
 
@@ -5,6 +5,11 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "core/file_sys/directory.h"
 #include "core/file_sys/vfs.h"
@@ -129,9 +134,28 @@ private:
 
 void InstallInterfaces(Core::System& system);
 
+/// Packed snapshot of the entries of a directory, files first, as IDirectory::Read returns them.
+struct DirectoryListing {
+    explicit DirectoryListing(const FileSys::VfsDirectory& directory);
+
+    // The names in types point into entries
+    DirectoryListing(const DirectoryListing&) = delete;
+    DirectoryListing& operator=(const DirectoryListing&) = delete;
+
+    /// Returns the type of the entry with the given name, if there is one.
+    std::optional<FileSys::EntryType> FindEntry(std::string_view name) const;
+
+    std::vector<FileSys::Entry> entries;
+    std::unordered_map<std::string_view, FileSys::EntryType> types;
+};
+
 // A class that wraps a VfsDirectory with methods that return ResultVal and ResultCode instead of
 // pointers and booleans. This makes using a VfsDirectory with switch services much easier and
 // avoids repetitive code.
+//
+// Resolved directories and listings are cached, titles tend to enumerate and query the same
+// directories over and over. Writing through any wrapper or through files opened from one drops
+// the caches of every wrapper.
 class VfsDirectoryServiceWrapper {
 public:
     explicit VfsDirectoryServiceWrapper(FileSys::VirtualDir backing);
@@ -227,8 +251,40 @@ public:
      */
     ResultVal<FileSys::EntryType> GetEntryType(const std::string& path) const;
 
+    /**
+     * Writes pending changes of journaled save data to the host, does nothing for other archives
+     * @return Result of the operation
+     */
+    ResultCode Commit() const;
+
+    /**
+     * Get a snapshot of the entries of a directory, shared until something is written
+     * @param path Path relative to the archive
+     * @return The entries of the directory or error code
+     */
+    ResultVal<std::shared_ptr<const DirectoryListing>> GetDirectoryListing(
+        const std::string& path) const;
+
+    /// Drops the cached directories and listings of every wrapper, after a filesystem has been
+    /// written to outside of the wrapper's own methods.
+    static void InvalidateCaches();
+
 private:
+    /// Resolves a directory relative to the backing through the cache, nullptr if there's none
+    FileSys::VirtualDir GetDirectory(std::string_view path) const;
+
+    /// Returns the listing of a directory through the cache, nullptr if there's no directory
+    std::shared_ptr<const DirectoryListing> GetListing(std::string_view path) const;
+
+    /// Drops the caches when anything has been written since they were filled
+    void ValidateCaches() const;
+
     FileSys::VirtualDir backing;
+
+    // Keyed by sanitized path, null entries remember paths that don't exist
+    mutable u64 cache_generation = 0;
+    mutable std::unordered_map<std::string, FileSys::VirtualDir> directory_cache;
+    mutable std::unordered_map<std::string, std::shared_ptr<const DirectoryListing>> listing_cache;
 };
 
 } // namespace FileSystem
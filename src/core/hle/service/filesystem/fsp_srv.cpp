@@ -2,9 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,6 +29,9 @@
 #include "core/file_sys/vfs.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/service_thread.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/writable_event.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/hle/service/filesystem/fsp_srv.h"
 #include "core/reporter.h"
@@ -43,6 +50,167 @@ struct SizeGetter {
     }
 };
 
+/// Reads of at least this many bytes run on the service thread instead of the emulated CPU thread.
+/// Below it, handing the request over costs more than the read itself.
+constexpr std::size_t ServiceThreadReadThreshold = 0x40000;
+
+/// Data read ahead after the first sequential read of a file, doubled by every further one
+constexpr std::size_t MinReadaheadSize = 0x10000;
+constexpr std::size_t MaxReadaheadSize = 0x100000;
+
+/**
+ * Reads ahead of a file that is read sequentially. Once a read continues where the previous one
+ * ended, the data after it is read on the service thread while the guest works with what it got,
+ * so that the next read finds it in memory instead of waiting for the disk and the decryption
+ * layers. Files that can be written aren't read ahead, as other handles could change them.
+ *
+ * Read, Prefetch and Invalidate only run as work of the file's service thread.
+ */
+class FileReadahead final : public std::enable_shared_from_this<FileReadahead> {
+public:
+    explicit FileReadahead(FileSys::VirtualFile backend_)
+        : backend{std::move(backend_)}, enabled{!backend->IsWritable()} {}
+
+    /**
+     * Reads from the file, taking what it can from the data read ahead, and queues reading ahead
+     * of it on the service thread the read runs on.
+     * @returns The number of bytes read
+     */
+    std::size_t Read(Kernel::ServiceThread& service_thread, u8* data, std::size_t length,
+                     u64 offset) {
+        if (!enabled) {
+            return backend->Read(data, length, offset);
+        }
+
+        std::size_t read = 0;
+        if (offset >= buffer_offset && offset < buffer_offset + buffer.size()) {
+            const auto start = static_cast<std::size_t>(offset - buffer_offset);
+            read = std::min(length, buffer.size() - start);
+            std::memcpy(data, buffer.data() + start, read);
+        }
+        if (read < length) {
+            read += backend->Read(data + read, length - read, offset + read);
+        }
+
+        sequential = offset == next_offset;
+        next_offset = offset + read;
+        if (!sequential) {
+            readahead_size = MinReadaheadSize;
+            return read;
+        }
+
+        // Stop at the end of the file, and don't queue more while enough is left
+        const u64 buffer_end = buffer_offset + buffer.size();
+        if (read < length || prefetch_queued || buffer_end >= next_offset + readahead_size / 2) {
+            return read;
+        }
+        readahead_size = std::min(std::max(readahead_size * 2, length), MaxReadaheadSize);
+        prefetch_queued = true;
+        service_thread.QueueWork([readahead = shared_from_this()] { readahead->Prefetch(); },
+                                 nullptr);
+        return read;
+    }
+
+    /// Drops the data read ahead, for when the file has been changed through its own handle.
+    void Invalidate() {
+        buffer.clear();
+        sequential = false;
+        next_offset = std::numeric_limits<u64>::max();
+    }
+
+private:
+    void Prefetch() {
+        prefetch_queued = false;
+        if (!sequential) {
+            // A read somewhere else came in before this ran
+            return;
+        }
+
+        // Keep the data that hasn't been read yet and append to it
+        const u64 buffer_end = buffer_offset + buffer.size();
+        if (next_offset < buffer_offset || next_offset >= buffer_end) {
+            buffer.clear();
+        } else {
+            buffer.erase(buffer.begin(),
+                         buffer.begin() + static_cast<std::ptrdiff_t>(next_offset - buffer_offset));
+        }
+        buffer_offset = next_offset;
+
+        const std::size_t buffered = buffer.size();
+        if (buffered >= readahead_size) {
+            return;
+        }
+        buffer.resize(readahead_size);
+        buffer.resize(buffered + backend->Read(buffer.data() + buffered, readahead_size - buffered,
+                                               buffer_offset + buffered));
+    }
+
+    FileSys::VirtualFile backend;
+    bool enabled;
+
+    std::vector<u8> buffer;
+    u64 buffer_offset = 0;
+    /// Offset a read continuing the previous one starts at
+    u64 next_offset = std::numeric_limits<u64>::max();
+    std::size_t readahead_size = MinReadaheadSize;
+    bool sequential = false;
+    bool prefetch_queued = false;
+};
+
+/**
+ * Reads from a file into the output buffer of a request. Small reads run right away, large ones
+ * on the service thread while the requesting guest thread sleeps. Those are read straight into
+ * guest memory when the output buffer is contiguous, and through a host buffer otherwise.
+ * @param respond Writes the response, given the number of bytes read
+ */
+void ReadFileIntoBuffer(Kernel::HLERequestContext& ctx, Kernel::ServiceThread& service_thread,
+                        const std::shared_ptr<FileReadahead>& readahead, const char* reason,
+                        u64 offset, std::size_t length,
+                        std::function<void(Kernel::HLERequestContext&, std::size_t)> respond) {
+    const auto read_size = std::min(ctx.GetWriteBufferSize(), length);
+    if (read_size < ServiceThreadReadThreshold) {
+        auto output = ctx.WriteBufferSpan();
+        std::size_t read = 0;
+        service_thread.RunSynchronously([&] {
+            read = readahead->Read(service_thread, output.data(),
+                                   std::min(output.size(), read_size), offset);
+        });
+        respond(ctx, read);
+        return;
+    }
+
+    const auto read = std::make_shared<std::size_t>(0);
+    if (u8* const pointer = ctx.GetWriteBufferPointer()) {
+        ctx.RunOnServiceThread(
+            service_thread, reason,
+            [&service_thread, readahead, read, pointer, read_size, offset] {
+                *read = readahead->Read(service_thread, pointer, read_size, offset);
+            },
+            [read, respond = std::move(respond)](Kernel::SharedPtr<Kernel::Thread>,
+                                                 Kernel::HLERequestContext& ctx,
+                                                 Kernel::ThreadWakeupReason) {
+                respond(ctx, *read);
+            });
+        return;
+    }
+
+    // Guest memory is only written on the emulated CPU thread when it isn't contiguous
+    const auto output = std::make_shared<std::vector<u8>>(read_size);
+    ctx.RunOnServiceThread(
+        service_thread, reason,
+        [&service_thread, readahead, read, output, offset] {
+            *read = readahead->Read(service_thread, output->data(), output->size(), offset);
+        },
+        [read, output, respond = std::move(respond)](Kernel::SharedPtr<Kernel::Thread>,
+                                                     Kernel::HLERequestContext& ctx,
+                                                     Kernel::ThreadWakeupReason) {
+            if (*read > 0) {
+                ctx.WriteBuffer(output->data(), *read);
+            }
+            respond(ctx, *read);
+        });
+}
+
 enum class FileSystemType : u8 {
     Invalid0 = 0,
     Invalid1 = 1,
@@ -56,8 +224,11 @@ enum class FileSystemType : u8 {
 
 class IStorage final : public ServiceFramework<IStorage> {
 public:
-    explicit IStorage(FileSys::VirtualFile backend_)
-        : ServiceFramework("IStorage"), backend(std::move(backend_)) {
+    explicit IStorage(FileSys::VirtualFile backend_,
+                      std::shared_ptr<Kernel::ServiceThread> service_thread_)
+        : ServiceFramework("IStorage"), backend(std::move(backend_)),
+          service_thread(std::move(service_thread_)),
+          readahead(std::make_shared<FileReadahead>(backend)) {
         static const FunctionInfo functions[] = {
             {0, &IStorage::Read, "Read"},
             {1, nullptr, "Write"},
@@ -71,6 +242,8 @@ public:
 
 private:
     FileSys::VirtualFile backend;
+    std::shared_ptr<Kernel::ServiceThread> service_thread;
+    std::shared_ptr<FileReadahead> readahead;
 
     void Read(Kernel::HLERequestContext& ctx) {
         IPC::RequestParser rp{ctx};
@@ -93,17 +266,17 @@ private:
             return;
         }
 
-        // Read the data from the Storage backend
-        std::vector<u8> output = backend->ReadBytes(length, offset);
-        // Write the data to memory
-        ctx.WriteBuffer(output);
-
-        IPC::ResponseBuilder rb{ctx, 2};
-        rb.Push(RESULT_SUCCESS);
+        ReadFileIntoBuffer(ctx, *service_thread, readahead, "IStorage::Read",
+                           static_cast<u64>(offset), static_cast<std::size_t>(length),
+                           [](Kernel::HLERequestContext& ctx, std::size_t) {
+                               IPC::ResponseBuilder rb{ctx, 2};
+                               rb.Push(RESULT_SUCCESS);
+                           });
     }
 
     void GetSize(Kernel::HLERequestContext& ctx) {
-        const u64 size = backend->GetSize();
+        u64 size = 0;
+        service_thread->RunSynchronously([this, &size] { size = backend->GetSize(); });
         LOG_DEBUG(Service_FS, "called, size={}", size);
 
         IPC::ResponseBuilder rb{ctx, 4};
@@ -114,8 +287,11 @@ private:
 
 class IFile final : public ServiceFramework<IFile> {
 public:
-    explicit IFile(FileSys::VirtualFile backend_)
-        : ServiceFramework("IFile"), backend(std::move(backend_)) {
+    explicit IFile(FileSys::VirtualFile backend_,
+                   std::shared_ptr<Kernel::ServiceThread> service_thread_)
+        : ServiceFramework("IFile"), backend(std::move(backend_)),
+          service_thread(std::move(service_thread_)),
+          readahead(std::make_shared<FileReadahead>(backend)) {
         static const FunctionInfo functions[] = {
             {0, &IFile::Read, "Read"},       {1, &IFile::Write, "Write"},
             {2, &IFile::Flush, "Flush"},     {3, &IFile::SetSize, "SetSize"},
@@ -126,6 +302,8 @@ public:
 
 private:
     FileSys::VirtualFile backend;
+    std::shared_ptr<Kernel::ServiceThread> service_thread;
+    std::shared_ptr<FileReadahead> readahead;
 
     void Read(Kernel::HLERequestContext& ctx) {
         IPC::RequestParser rp{ctx};
@@ -150,15 +328,13 @@ private:
             return;
         }
 
-        // Read the data from the Storage backend
-        std::vector<u8> output = backend->ReadBytes(length, offset);
-
-        // Write the data to memory
-        ctx.WriteBuffer(output);
-
-        IPC::ResponseBuilder rb{ctx, 4};
-        rb.Push(RESULT_SUCCESS);
-        rb.Push(static_cast<u64>(output.size()));
+        ReadFileIntoBuffer(ctx, *service_thread, readahead, "IFile::Read",
+                           static_cast<u64>(offset), static_cast<std::size_t>(length),
+                           [](Kernel::HLERequestContext& ctx, std::size_t read) {
+                               IPC::ResponseBuilder rb{ctx, 4};
+                               rb.Push(RESULT_SUCCESS);
+                               rb.Push(static_cast<u64>(read));
+                           });
     }
 
     void Write(Kernel::HLERequestContext& ctx) {
@@ -184,7 +360,7 @@ private:
             return;
         }
 
-        const std::vector<u8> data = ctx.ReadBuffer();
+        const auto data = ctx.ReadBufferSpan();
 
         ASSERT_MSG(
             static_cast<s64>(data.size()) <= length,
@@ -192,9 +368,13 @@ private:
             length, data.size());
 
         // Write the data to the Storage backend
-        const auto write_size =
-            static_cast<std::size_t>(std::distance(data.begin(), data.begin() + length));
-        const std::size_t written = backend->Write(data.data(), write_size, offset);
+        const auto write_size = static_cast<std::size_t>(length);
+        std::size_t written = 0;
+        service_thread->RunSynchronously([&] {
+            readahead->Invalidate();
+            written = backend->Write(data.data(), write_size, offset);
+        });
+        VfsDirectoryServiceWrapper::InvalidateCaches();
 
         ASSERT_MSG(static_cast<s64>(written) == length,
                    "Could not write all bytes to file (requested={:016X}, actual={:016X}).", length,
@@ -218,14 +398,19 @@ private:
         const u64 size = rp.Pop<u64>();
         LOG_DEBUG(Service_FS, "called, size={}", size);
 
-        backend->Resize(size);
+        service_thread->RunSynchronously([this, size] {
+            readahead->Invalidate();
+            backend->Resize(size);
+        });
+        VfsDirectoryServiceWrapper::InvalidateCaches();
 
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(RESULT_SUCCESS);
     }
 
     void GetSize(Kernel::HLERequestContext& ctx) {
-        const u64 size = backend->GetSize();
+        u64 size = 0;
+        service_thread->RunSynchronously([this, &size] { size = backend->GetSize(); });
         LOG_DEBUG(Service_FS, "called, size={}", size);
 
         IPC::ResponseBuilder rb{ctx, 4};
@@ -234,56 +419,41 @@ private:
     }
 };
 
-template <typename T>
-static void BuildEntryIndex(std::vector<FileSys::Entry>& entries, const std::vector<T>& new_data,
-                            FileSys::EntryType type) {
-    entries.reserve(entries.size() + new_data.size());
-
-    for (const auto& new_entry : new_data) {
-        entries.emplace_back(new_entry->GetName(), type, new_entry->GetSize());
-    }
-}
-
 class IDirectory final : public ServiceFramework<IDirectory> {
 public:
-    explicit IDirectory(FileSys::VirtualDir backend_)
-        : ServiceFramework("IDirectory"), backend(std::move(backend_)) {
+    explicit IDirectory(std::shared_ptr<const DirectoryListing> listing_)
+        : ServiceFramework("IDirectory"), listing(std::move(listing_)) {
         static const FunctionInfo functions[] = {
             {0, &IDirectory::Read, "Read"},
             {1, &IDirectory::GetEntryCount, "GetEntryCount"},
         };
         RegisterHandlers(functions);
-
-        // TODO(DarkLordZach): Verify that this is the correct behavior.
-        // Build entry index now to save time later.
-        BuildEntryIndex(entries, backend->GetFiles(), FileSys::File);
-        BuildEntryIndex(entries, backend->GetSubdirectories(), FileSys::Directory);
     }
 
 private:
-    FileSys::VirtualDir backend;
-    std::vector<FileSys::Entry> entries;
+    // TODO(DarkLordZach): Verify that this is the correct behavior.
+    // The entries are those of the directory at the time it was opened.
+    std::shared_ptr<const DirectoryListing> listing;
     u64 next_entry_index = 0;
 
     void Read(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_FS, "called.");
 
+        const auto& entries = listing->entries;
+
         // Calculate how many entries we can fit in the output buffer
         const u64 count_entries = ctx.GetWriteBufferSize() / sizeof(FileSys::Entry);
 
         // Cap at total number of entries.
         const u64 actual_entries = std::min(count_entries, entries.size() - next_entry_index);
 
-        // Determine data start and end
-        const auto* begin = reinterpret_cast<u8*>(entries.data() + next_entry_index);
-        const auto* end = reinterpret_cast<u8*>(entries.data() + next_entry_index + actual_entries);
-        const auto range_size = static_cast<std::size_t>(std::distance(begin, end));
-
+        // Write the data to memory, the entries are already laid out as the guest expects them
+        if (actual_entries > 0) {
+            ctx.WriteBuffer(entries.data() + next_entry_index,
+                            actual_entries * sizeof(FileSys::Entry));
+        }
         next_entry_index += actual_entries;
 
-        // Write the data to memory
-        ctx.WriteBuffer(begin, range_size);
-
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
         rb.Push(actual_entries);
@@ -292,7 +462,7 @@ private:
     void GetEntryCount(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_FS, "called");
 
-        u64 count = entries.size() - next_entry_index;
+        u64 count = listing->entries.size() - next_entry_index;
 
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
@@ -302,8 +472,10 @@ private:
 
 class IFileSystem final : public ServiceFramework<IFileSystem> {
 public:
-    explicit IFileSystem(FileSys::VirtualDir backend, SizeGetter size)
-        : ServiceFramework("IFileSystem"), backend(std::move(backend)), size(std::move(size)) {
+    explicit IFileSystem(FileSys::VirtualDir backend, SizeGetter size,
+                         std::shared_ptr<Kernel::ServiceThread> service_thread)
+        : ServiceFramework("IFileSystem"), backend(std::move(backend)), size(std::move(size)),
+          service_thread(std::move(service_thread)) {
         static const FunctionInfo functions[] = {
             {0, &IFileSystem::CreateFile, "CreateFile"},
             {1, &IFileSystem::DeleteFile, "DeleteFile"},
@@ -423,7 +595,7 @@ public:
             return;
         }
 
-        IFile file(result.Unwrap());
+        IFile file(result.Unwrap(), service_thread);
 
         IPC::ResponseBuilder rb{ctx, 2, 0, 1};
         rb.Push(RESULT_SUCCESS);
@@ -441,7 +613,7 @@ public:
 
         LOG_DEBUG(Service_FS, "called. directory={}, filter={}", name, filter_flags);
 
-        auto result = backend.OpenDirectory(name);
+        auto result = backend.GetDirectoryListing(name);
         if (result.Failed()) {
             IPC::ResponseBuilder rb{ctx, 2};
             rb.Push(result.Code());
@@ -474,10 +646,10 @@ public:
     }
 
     void Commit(Kernel::HLERequestContext& ctx) {
-        LOG_WARNING(Service_FS, "(STUBBED) called");
+        LOG_DEBUG(Service_FS, "called");
 
         IPC::ResponseBuilder rb{ctx, 2};
-        rb.Push(RESULT_SUCCESS);
+        rb.Push(backend.Commit());
     }
 
     void GetFreeSpaceSize(Kernel::HLERequestContext& ctx) {
@@ -499,6 +671,7 @@ public:
 private:
     VfsDirectoryServiceWrapper backend;
     SizeGetter size;
+    std::shared_ptr<Kernel::ServiceThread> service_thread;
 };
 
 class ISaveDataInfoReader final : public ServiceFramework<ISaveDataInfoReader> {
@@ -650,8 +823,11 @@ private:
     u64 next_entry_index = 0;
 };
 
-FSP_SRV::FSP_SRV(FileSystemController& fsc, const Core::Reporter& reporter)
-    : ServiceFramework("fsp-srv"), fsc(fsc), reporter(reporter) {
+FSP_SRV::FSP_SRV(FileSystemController& fsc, const Core::Reporter& reporter,
+                 Kernel::KernelCore& kernel)
+    : ServiceFramework("fsp-srv"), fsc(fsc),
+      service_thread(std::make_shared<Kernel::ServiceThread>(kernel, "yuzu:FspSrv")),
+      reporter(reporter) {
     // clang-format off
     static const FunctionInfo functions[] = {
         {0, nullptr, "OpenFileSystem"},
@@ -792,7 +968,8 @@ void FSP_SRV::OpenSdCardFileSystem(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_FS, "called");
 
     IFileSystem filesystem(fsc.OpenSDMC().Unwrap(),
-                           SizeGetter::FromStorageId(fsc, FileSys::StorageId::SdCard));
+                           SizeGetter::FromStorageId(fsc, FileSys::StorageId::SdCard),
+                           service_thread);
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
@@ -843,7 +1020,8 @@ void FSP_SRV::OpenSaveDataFileSystem(Kernel::HLERequestContext& ctx) {
         id = FileSys::StorageId::NandSystem;
     }
 
-    IFileSystem filesystem(std::move(dir.Unwrap()), SizeGetter::FromStorageId(fsc, id));
+    IFileSystem filesystem(std::move(dir.Unwrap()), SizeGetter::FromStorageId(fsc, id),
+                           service_thread);
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
@@ -895,7 +1073,7 @@ void FSP_SRV::OpenDataStorageByCurrentProcess(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    IStorage storage(std::move(romfs.Unwrap()));
+    IStorage storage(std::move(romfs.Unwrap()), service_thread);
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
@@ -919,7 +1097,7 @@ void FSP_SRV::OpenDataStorageByDataId(Kernel::HLERequestContext& ctx) {
         if (archive != nullptr) {
             IPC::ResponseBuilder rb{ctx, 2, 0, 1};
             rb.Push(RESULT_SUCCESS);
-            rb.PushIpcInterface(std::make_shared<IStorage>(archive));
+            rb.PushIpcInterface(std::make_shared<IStorage>(archive, service_thread));
             return;
         }
 
@@ -934,7 +1112,8 @@ void FSP_SRV::OpenDataStorageByDataId(Kernel::HLERequestContext& ctx) {
 
     FileSys::PatchManager pm{title_id};
 
-    IStorage storage(pm.PatchRomFS(std::move(data.Unwrap()), 0, FileSys::ContentRecordType::Data));
+    IStorage storage(pm.PatchRomFS(std::move(data.Unwrap()), 0, FileSys::ContentRecordType::Data),
+                     service_thread);
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
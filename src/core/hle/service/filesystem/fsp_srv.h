@@ -15,6 +15,11 @@ namespace FileSys {
 class FileSystemBackend;
 }
 
+namespace Kernel {
+class KernelCore;
+class ServiceThread;
+} // namespace Kernel
+
 namespace Service::FileSystem {
 
 enum class AccessLogVersion : u32 {
@@ -32,7 +37,8 @@ enum class LogMode : u32 {
 
 class FSP_SRV final : public ServiceFramework<FSP_SRV> {
 public:
-    explicit FSP_SRV(FileSystemController& fsc, const Core::Reporter& reporter);
+    explicit FSP_SRV(FileSystemController& fsc, const Core::Reporter& reporter,
+                     Kernel::KernelCore& kernel);
     ~FSP_SRV() override;
 
 private:
@@ -53,6 +59,9 @@ private:
 
     FileSystemController& fsc;
 
+    /// Runs the file and storage accesses of every interface opened through this service.
+    std::shared_ptr<Kernel::ServiceThread> service_thread;
+
     FileSys::VirtualFile romfs;
     u64 current_process_id = 0;
     u32 access_log_program_index = 0;
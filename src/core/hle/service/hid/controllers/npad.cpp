@@ -9,6 +9,7 @@
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/frontend/input.h"
@@ -94,7 +95,16 @@ u32 Controller_NPad::IndexToNPad(std::size_t index) {
 }
 
 Controller_NPad::Controller_NPad(Core::System& system) : ControllerBase(system), system(system) {}
-Controller_NPad::~Controller_NPad() = default;
+Controller_NPad::~Controller_NPad() {
+    {
+        std::lock_guard lock{input_mutex};
+        stop_polling = true;
+    }
+    poll_cv.notify_all();
+    if (poll_thread.joinable()) {
+        poll_thread.join();
+    }
+}
 
 void Controller_NPad::InitNewlyAddedControler(std::size_t controller_idx) {
     const auto controller_type = connected_controllers[controller_idx].type;
@@ -102,6 +112,7 @@ void Controller_NPad::InitNewlyAddedControler(std::size_t controller_idx) {
     if (controller_type == NPadControllerType::None) {
         return;
     }
+    full_write_pending = true;
     controller.joy_styles.raw = 0; // Zero out
     controller.device_type.raw = 0;
     switch (controller_type) {
@@ -224,28 +235,30 @@ void Controller_NPad::OnInit() {
 }
 
 void Controller_NPad::OnLoadInputDevices() {
-    const auto& players = Settings::values.players;
-    for (std::size_t i = 0; i < players.size(); ++i) {
-        std::transform(players[i].buttons.begin() + Settings::NativeButton::BUTTON_HID_BEGIN,
-                       players[i].buttons.begin() + Settings::NativeButton::BUTTON_HID_END,
-                       buttons[i].begin(), Input::CreateDevice<Input::ButtonDevice>);
-        std::transform(players[i].analogs.begin() + Settings::NativeAnalog::STICK_HID_BEGIN,
-                       players[i].analogs.begin() + Settings::NativeAnalog::STICK_HID_END,
-                       sticks[i].begin(), Input::CreateDevice<Input::AnalogDevice>);
+    {
+        std::lock_guard lock{input_mutex};
+        const auto& players = Settings::values.players;
+        for (std::size_t i = 0; i < players.size(); ++i) {
+            std::transform(players[i].buttons.begin() + Settings::NativeButton::BUTTON_HID_BEGIN,
+                           players[i].buttons.begin() + Settings::NativeButton::BUTTON_HID_END,
+                           buttons[i].begin(), Input::CreateDevice<Input::ButtonDevice>);
+            std::transform(players[i].analogs.begin() + Settings::NativeAnalog::STICK_HID_BEGIN,
+                           players[i].analogs.begin() + Settings::NativeAnalog::STICK_HID_END,
+                           sticks[i].begin(), Input::CreateDevice<Input::AnalogDevice>);
+        }
+    }
+    if (!poll_thread.joinable()) {
+        poll_thread = std::thread(&Controller_NPad::PollThread, this);
     }
 }
 
 void Controller_NPad::OnRelease() {}
 
-void Controller_NPad::RequestPadStateUpdate(u32 npad_id) {
-    const auto controller_idx = NPadIdToIndex(npad_id);
-    const auto controller_type = connected_controllers[controller_idx].type;
-    if (!connected_controllers[controller_idx].is_connected) {
-        return;
-    }
-    auto& pad_state = npad_pad_states[controller_idx].pad_states;
-    auto& lstick_entry = npad_pad_states[controller_idx].l_stick;
-    auto& rstick_entry = npad_pad_states[controller_idx].r_stick;
+Controller_NPad::ControllerPad Controller_NPad::PollPadState(std::size_t controller_idx) const {
+    ControllerPad state{};
+    auto& pad_state = state.pad_states;
+    auto& lstick_entry = state.l_stick;
+    auto& rstick_entry = state.r_stick;
     const auto& button_state = buttons[controller_idx];
     const auto& analog_state = sticks[controller_idx];
 
@@ -289,6 +302,92 @@ void Controller_NPad::RequestPadStateUpdate(u32 npad_id) {
     lstick_entry.y = static_cast<s32>(stick_l_y_f * HID_JOYSTICK_MAX);
     rstick_entry.x = static_cast<s32>(stick_r_x_f * HID_JOYSTICK_MAX);
     rstick_entry.y = static_cast<s32>(stick_r_y_f * HID_JOYSTICK_MAX);
+    return state;
+}
+
+void Controller_NPad::PollThread() {
+    Common::SetCurrentThreadName("yuzu:HidPoll");
+
+    std::array<ControllerPad, 10> last_states{};
+    std::unique_lock lock{input_mutex};
+    while (!stop_polling) {
+        for (std::size_t i = 0; i < last_states.size(); ++i) {
+            if (!buttons[i][0] || !sticks[i][0]) {
+                continue;
+            }
+            const ControllerPad state = PollPadState(i);
+            if (std::memcmp(&state, &last_states[i], sizeof(state)) == 0) {
+                continue;
+            }
+            last_states[i] = state;
+            PublishPadState(i, state, Input::GetLastInputEventTime());
+        }
+        poll_cv.wait_for(lock, PollInterval, [this] { return stop_polling; });
+    }
+}
+
+void Controller_NPad::PublishPadState(std::size_t controller_idx, const ControllerPad& state,
+                                      std::chrono::steady_clock::time_point event_time) {
+    auto& snapshot = pad_state_snapshots[controller_idx];
+    const u32 sequence = snapshot.sequence.load(std::memory_order_relaxed);
+    snapshot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&snapshot.state, &state, sizeof(state));
+    std::memcpy(&snapshot.event_time, &event_time, sizeof(event_time));
+    snapshot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void Controller_NPad::ReadPadState(std::size_t controller_idx) {
+    auto& snapshot = pad_state_snapshots[controller_idx];
+    auto& last_sequence = read_pad_state_sequences[controller_idx];
+    while (true) {
+        const u32 sequence = snapshot.sequence.load(std::memory_order_acquire);
+        if (sequence == last_sequence) {
+            return;
+        }
+        if (sequence % 2 != 0) {
+            continue;
+        }
+        ControllerPad state;
+        std::chrono::steady_clock::time_point event_time;
+        std::memcpy(&state, &snapshot.state, sizeof(state));
+        std::memcpy(&event_time, &snapshot.event_time, sizeof(event_time));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (snapshot.sequence.load(std::memory_order_relaxed) == sequence) {
+            npad_pad_states[controller_idx] = state;
+            last_sequence = sequence;
+            if (Settings::values.record_input_latency) {
+                RecordInputLatency(event_time);
+            }
+            return;
+        }
+    }
+}
+
+void Controller_NPad::RecordInputLatency(std::chrono::steady_clock::time_point event_time) {
+    // Only measure changes caused by a new event, backends that aren't event driven don't report
+    // any
+    if (event_time <= input_latency.last_event) {
+        return;
+    }
+    input_latency.last_event = event_time;
+
+    const auto latency = std::chrono::steady_clock::now() - event_time;
+    input_latency.total += latency;
+    input_latency.max = std::max(input_latency.max, latency);
+    if (++input_latency.samples < 64) {
+        return;
+    }
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    LOG_INFO(Service_HID, "Input latency over {} events: average {}us, max {}us",
+             input_latency.samples,
+             duration_cast<microseconds>(input_latency.total / input_latency.samples).count(),
+             duration_cast<microseconds>(input_latency.max).count());
+    input_latency.total = {};
+    input_latency.max = {};
+    input_latency.samples = 0;
 }
 
 void Controller_NPad::OnUpdate(const Core::Timing::CoreTiming& core_timing, u8* data,
@@ -327,9 +426,8 @@ void Controller_NPad::OnUpdate(const Core::Timing::CoreTiming& core_timing, u8*
         if (controller_type == NPadControllerType::None || !connected_controllers[i].is_connected) {
             continue;
         }
-        const u32 npad_index = static_cast<u32>(i);
-        RequestPadStateUpdate(npad_index);
-        auto& pad_state = npad_pad_states[npad_index];
+        ReadPadState(i);
+        const auto& pad_state = npad_pad_states[i];
 
         auto& main_controller =
             npad.main_controller_states.npad[npad.main_controller_states.common.last_entry_index];
@@ -417,8 +515,30 @@ void Controller_NPad::OnUpdate(const Core::Timing::CoreTiming& core_timing, u8*
 
         press_state |= static_cast<u32>(pad_state.pad_states.raw);
     }
-    std::memcpy(data + NPAD_OFFSET, shared_memory_entries.data(),
-                shared_memory_entries.size() * sizeof(NPadEntry));
+
+    if (full_write_pending || data != last_shared_memory) {
+        std::memcpy(data + NPAD_OFFSET, shared_memory_entries.data(),
+                    shared_memory_entries.size() * sizeof(NPadEntry));
+        full_write_pending = false;
+        last_shared_memory = data;
+        return;
+    }
+
+    // Only the newest entry and the header of each lifo changed, the guest reads the header first
+    // so the entry is written before it.
+    const auto* const base = reinterpret_cast<const u8*>(shared_memory_entries.data());
+    const auto write_back = [data, base](const auto& field) {
+        const auto offset = reinterpret_cast<const u8*>(&field) - base;
+        std::memcpy(data + NPAD_OFFSET + offset, &field, sizeof(field));
+    };
+    for (auto& npad : shared_memory_entries) {
+        for (const auto* lifo : {&npad.main_controller_states, &npad.handheld_states,
+                                 &npad.dual_states, &npad.left_joy_states, &npad.right_joy_states,
+                                 &npad.pokeball_states, &npad.libnx}) {
+            write_back(lifo->npad[lifo->common.last_entry_index]);
+            write_back(lifo->common);
+        }
+    }
 }
 
 void Controller_NPad::SetSupportedStyleSet(NPadType style_set) {
@@ -478,6 +598,7 @@ void Controller_NPad::SetNpadMode(u32 npad_id, NPadAssignments assignment_mode)
     ASSERT(npad_index < shared_memory_entries.size());
     if (shared_memory_entries[npad_index].pad_assignment != assignment_mode) {
         shared_memory_entries[npad_index].pad_assignment = assignment_mode;
+        full_write_pending = true;
     }
 }
 
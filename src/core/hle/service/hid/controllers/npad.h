@@ -5,6 +5,11 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "core/frontend/input.h"
@@ -301,6 +306,26 @@ private:
         bool is_connected;
     };
 
+    /// Pad state published by the polling thread. Readers retry while the sequence is odd or
+    /// changes under them, so neither side ever waits on the other.
+    struct PadStateSnapshot {
+        std::atomic<u32> sequence{};
+        ControllerPad state{};
+        /// Time of the last host input event when the state was polled.
+        std::chrono::steady_clock::time_point event_time{};
+    };
+
+    /// Delay between host input events and the guest seeing them, for record_input_latency.
+    struct InputLatency {
+        std::chrono::steady_clock::time_point last_event{};
+        std::chrono::steady_clock::duration total{};
+        std::chrono::steady_clock::duration max{};
+        u32 samples{};
+    };
+
+    /// How often the polling thread reads the input devices.
+    static constexpr std::chrono::milliseconds PollInterval{4};
+
     u32 press_state{};
 
     NPadType style{};
@@ -324,8 +349,27 @@ private:
     void InitNewlyAddedControler(std::size_t controller_idx);
     bool IsControllerSupported(NPadControllerType controller) const;
     NPadControllerType DecideBestController(NPadControllerType priority) const;
-    void RequestPadStateUpdate(u32 npad_id);
+    ControllerPad PollPadState(std::size_t controller_idx) const;
+    void PollThread();
+    void PublishPadState(std::size_t controller_idx, const ControllerPad& state,
+                         std::chrono::steady_clock::time_point event_time);
+    /// Copies the pad state into npad_pad_states if the polling thread published a new one.
+    void ReadPadState(std::size_t controller_idx);
     std::array<ControllerPad, 10> npad_pad_states{};
+    std::array<PadStateSnapshot, 10> pad_state_snapshots{};
+    std::array<u32, 10> read_pad_state_sequences{};
+    void RecordInputLatency(std::chrono::steady_clock::time_point event_time);
+    InputLatency input_latency{};
+
+    /// Set when anything besides the lifos changed and all entries have to be written out again.
+    bool full_write_pending{true};
+    const u8* last_shared_memory{};
+
+    /// Protects the input devices and stop_polling.
+    std::mutex input_mutex;
+    std::condition_variable poll_cv;
+    bool stop_polling{false};
+    std::thread poll_thread;
     bool IsControllerSupported(NPadControllerType controller);
     bool is_in_lr_assignment_mode{false};
     Core::System& system;
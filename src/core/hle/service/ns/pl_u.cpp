@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <vector>
 
@@ -14,6 +15,8 @@
 #include <FontStandard.h>
 
 #include "common/assert.h"
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
 #include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -72,26 +75,57 @@ constexpr u32 EXPECTED_MAGIC{0x36f81a1e};  // What we expect the encrypted bfttf
 constexpr u64 SHARED_FONT_MEM_SIZE{0x1100000};
 constexpr FontRegion EMPTY_REGION{0, 0};
 
+// Decrypted fonts of the system archives are cached, the file starts with a FontCacheHeader
+// followed by the font regions and the font data
+constexpr u32 FONT_CACHE_MAGIC{Common::MakeMagic('S', 'F', 'N', 'T')};
+constexpr u32 FONT_CACHE_VERSION{1};
+
+struct FontCacheHeader {
+    u32_le magic;
+    u32_le version;
+    u32_le num_regions;
+    u32_le data_size;
+};
+static_assert(sizeof(FontCacheHeader) == 0x10, "FontCacheHeader has incorrect size.");
+
 enum class LoadState : u32 {
     Loading = 0,
     Done = 1,
 };
 
-static void DecryptSharedFont(const std::vector<u32>& input, Kernel::PhysicalMemory& output,
-                              std::size_t& offset) {
-    ASSERT_MSG(offset + (input.size() * sizeof(u32)) < SHARED_FONT_MEM_SIZE,
-               "Shared fonts exceeds 17mb!");
-    ASSERT_MSG(input[0] == EXPECTED_MAGIC, "Failed to derive key, unexpected magic number");
-
-    const u32 KEY = input[0] ^ EXPECTED_RESULT; // Derive key using an inverse xor
-    std::vector<u32> transformed_font(input.size());
-    // TODO(ogniK): Figure out a better way to do this
-    std::transform(input.begin(), input.end(), transformed_font.begin(),
-                   [&KEY](u32 font_data) { return Common::swap32(font_data ^ KEY); });
-    transformed_font[1] = Common::swap32(transformed_font[1]) ^ KEY; // "re-encrypt" the size
-    std::memcpy(output.data() + offset, transformed_font.data(),
-                transformed_font.size() * sizeof(u32));
-    offset += transformed_font.size() * sizeof(u32);
+// Helper function to make BuildSharedFontsRawRegions a bit nicer
+static u32 GetU32Swapped(const u8* data) {
+    u32 value;
+    std::memcpy(&value, data, sizeof(value));
+    return Common::swap32(value);
+}
+
+/// Decrypts a font read to output at offset in place
+static void DecryptSharedFont(Kernel::PhysicalMemory& output, std::size_t offset,
+                              std::size_t size) {
+    u8* const font = output.data() + offset;
+    ASSERT_MSG(GetU32Swapped(font) == EXPECTED_MAGIC,
+               "Failed to derive key, unexpected magic number");
+
+    // The font is XORed with the key as big endian words, the key is derived using an inverse xor
+    const u32 key = GetU32Swapped(font) ^ EXPECTED_RESULT;
+    const u64 key_pattern = static_cast<u64>(Common::swap32(key)) * 0x100000001ULL;
+
+    // The size stays encrypted, as a little endian word
+    std::array<u8, sizeof(u32)> encrypted_size;
+    std::reverse_copy(font + 4, font + 8, encrypted_size.begin());
+
+    std::size_t i = 0;
+    for (; i + sizeof(u64) <= size; i += sizeof(u64)) {
+        u64 words;
+        std::memcpy(&words, font + i, sizeof(words));
+        words ^= key_pattern;
+        std::memcpy(font + i, &words, sizeof(words));
+    }
+    for (; i < size; ++i) {
+        font[i] ^= static_cast<u8>(key >> (24 - (i % 4) * 8));
+    }
+    std::memcpy(font + 4, encrypted_size.data(), encrypted_size.size());
 }
 
 static void EncryptSharedFont(const std::vector<u8>& input, Kernel::PhysicalMemory& output,
@@ -105,11 +139,26 @@ static void EncryptSharedFont(const std::vector<u8>& input, Kernel::PhysicalMemo
     offset += input.size() + (sizeof(u32) * 2);
 }
 
-// Helper function to make BuildSharedFontsRawRegions a bit nicer
-static u32 GetU32Swapped(const u8* data) {
-    u32 value;
-    std::memcpy(&value, data, sizeof(value));
-    return Common::swap32(value);
+/// Hashes the headers of the font archives, they hold the hashes of the archive contents
+static u64 HashFontArchives(const FileSys::RegisteredCache& nand) {
+    u64 hash = FONT_CACHE_VERSION;
+    for (const auto& font : SHARED_FONTS) {
+        std::array<u8, 0x400> header{};
+        const auto file =
+            nand.GetEntryRaw(static_cast<u64>(font.first), FileSys::ContentRecordType::Data);
+        if (file != nullptr) {
+            file->Read(header.data(), header.size());
+        }
+        hash = Common::CityHash64WithSeed(reinterpret_cast<const char*>(header.data()),
+                                          header.size(), hash);
+    }
+    return hash;
+}
+
+static std::string GetFontCachePath(u64 hash) {
+    return fmt::format("{}{}shared_font{}{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP, DIR_SEP,
+                       hash);
 }
 
 struct PL_U::Impl {
@@ -140,6 +189,93 @@ struct PL_U::Impl {
         }
     }
 
+    /// Decrypts the fonts of the system archives, returns false if any of them is missing
+    bool DecryptArchives(const FileSys::RegisteredCache& nand) {
+        bool complete = true;
+        std::size_t offset = 0;
+        for (const auto& font : SHARED_FONTS) {
+            const auto nca =
+                nand.GetEntry(static_cast<u64>(font.first), FileSys::ContentRecordType::Data);
+            if (!nca) {
+                LOG_ERROR(Service_NS, "Failed to find {:016X}! Skipping",
+                          static_cast<u64>(font.first));
+                complete = false;
+                continue;
+            }
+            const auto romfs = nca->GetRomFS();
+            if (!romfs) {
+                LOG_ERROR(Service_NS, "{:016X} has no RomFS! Skipping",
+                          static_cast<u64>(font.first));
+                complete = false;
+                continue;
+            }
+            const auto extracted_romfs = FileSys::ExtractRomFS(romfs);
+            if (!extracted_romfs) {
+                LOG_ERROR(Service_NS, "Failed to extract RomFS for {:016X}! Skipping",
+                          static_cast<u64>(font.first));
+                complete = false;
+                continue;
+            }
+            const auto font_fp = extracted_romfs->GetFile(font.second);
+            if (!font_fp) {
+                LOG_ERROR(Service_NS, "{:016X} has no file \"{}\"! Skipping",
+                          static_cast<u64>(font.first), font.second);
+                complete = false;
+                continue;
+            }
+            // The font is read in place, only whole words of it are used
+            const std::size_t size = font_fp->GetSize() / sizeof(u32) * sizeof(u32);
+            ASSERT_MSG(offset + size < SHARED_FONT_MEM_SIZE, "Shared fonts exceeds 17mb!");
+            font_fp->Read(shared_font->data() + offset, size);
+            DecryptSharedFont(*shared_font, offset, size);
+
+            // Font offset and size do not account for the header
+            shared_font_regions.push_back(
+                FontRegion{static_cast<u32>(offset + 8), static_cast<u32>(size - 8)});
+            offset += size;
+        }
+        return complete;
+    }
+
+    /// Loads fonts decrypted on a previous boot, returns false if the cache is missing or invalid
+    bool LoadCache(const std::string& path) {
+        FileUtil::IOFile file(path, "rb");
+        FontCacheHeader header{};
+        if (!file.IsOpen() || file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+            header.magic != FONT_CACHE_MAGIC || header.version != FONT_CACHE_VERSION ||
+            header.num_regions > SHARED_FONTS.size() || header.data_size >= SHARED_FONT_MEM_SIZE) {
+            return false;
+        }
+        std::vector<FontRegion> regions(header.num_regions);
+        if (file.ReadArray(regions.data(), regions.size()) != regions.size() ||
+            file.ReadBytes(shared_font->data(), header.data_size) != header.data_size) {
+            std::fill(shared_font->begin(), shared_font->end(), u8{0});
+            return false;
+        }
+        shared_font_regions = std::move(regions);
+        return true;
+    }
+
+    void SaveCache(const std::string& path) const {
+        if (shared_font_regions.empty() || !FileUtil::CreateFullPath(path)) {
+            return;
+        }
+        const std::size_t data_size =
+            shared_font_regions.back().offset + shared_font_regions.back().size;
+        FileUtil::IOFile file(path, "wb");
+        const FontCacheHeader header{FONT_CACHE_MAGIC, FONT_CACHE_VERSION,
+                                     static_cast<u32>(shared_font_regions.size()),
+                                     static_cast<u32>(data_size)};
+        if (!file.IsOpen() || file.WriteObject(header) != 1 ||
+            file.WriteArray(shared_font_regions.data(), shared_font_regions.size()) !=
+                shared_font_regions.size() ||
+            file.WriteBytes(shared_font->data(), data_size) != data_size) {
+            LOG_WARNING(Service_NS, "Failed to write the shared font cache to {}", path);
+            file.Close();
+            FileUtil::Delete(path);
+        }
+    }
+
     /// Handle to shared memory region designated for a shared font
     Kernel::SharedPtr<Kernel::SharedMemory> shared_font_mem;
 
@@ -172,45 +308,12 @@ PL_U::PL_U(Core::System& system)
     if (nand->HasEntry(static_cast<u64>(FontArchives::Standard),
                        FileSys::ContentRecordType::Data)) {
         impl->shared_font = std::make_shared<Kernel::PhysicalMemory>(SHARED_FONT_MEM_SIZE);
-        for (auto font : SHARED_FONTS) {
-            const auto nca =
-                nand->GetEntry(static_cast<u64>(font.first), FileSys::ContentRecordType::Data);
-            if (!nca) {
-                LOG_ERROR(Service_NS, "Failed to find {:016X}! Skipping",
-                          static_cast<u64>(font.first));
-                continue;
-            }
-            const auto romfs = nca->GetRomFS();
-            if (!romfs) {
-                LOG_ERROR(Service_NS, "{:016X} has no RomFS! Skipping",
-                          static_cast<u64>(font.first));
-                continue;
-            }
-            const auto extracted_romfs = FileSys::ExtractRomFS(romfs);
-            if (!extracted_romfs) {
-                LOG_ERROR(Service_NS, "Failed to extract RomFS for {:016X}! Skipping",
-                          static_cast<u64>(font.first));
-                continue;
-            }
-            const auto font_fp = extracted_romfs->GetFile(font.second);
-            if (!font_fp) {
-                LOG_ERROR(Service_NS, "{:016X} has no file \"{}\"! Skipping",
-                          static_cast<u64>(font.first), font.second);
-                continue;
-            }
-            std::vector<u32> font_data_u32(font_fp->GetSize() / sizeof(u32));
-            font_fp->ReadBytes<u32>(font_data_u32.data(), font_fp->GetSize());
-            // We need to be BigEndian as u32s for the xor encryption
-            std::transform(font_data_u32.begin(), font_data_u32.end(), font_data_u32.begin(),
-                           Common::swap32);
-            FontRegion region{
-                static_cast<u32>(offset + 8),
-                static_cast<u32>((font_data_u32.size() * sizeof(u32)) -
-                                 8)}; // Font offset and size do not account for the header
-            DecryptSharedFont(font_data_u32, *impl->shared_font, offset);
-            impl->shared_font_regions.push_back(region);
-        }
 
+        // The decrypted fonts only change with the archives, reuse the ones of the last boot
+        const std::string cache_path = GetFontCachePath(HashFontArchives(*nand));
+        if (!impl->LoadCache(cache_path) && impl->DecryptArchives(*nand)) {
+            impl->SaveCache(cache_path);
+        }
     } else {
         impl->shared_font = std::make_shared<Kernel::PhysicalMemory>(
             SHARED_FONT_MEM_SIZE); // Shared memory needs to always be allocated and a fixed size
@@ -26,8 +26,8 @@ nvhost_as_gpu::nvhost_as_gpu(Core::System& system, std::shared_ptr<nvmap> nvmap_
     : nvdevice(system), nvmap_dev(std::move(nvmap_dev)) {}
 nvhost_as_gpu::~nvhost_as_gpu() = default;
 
-u32 nvhost_as_gpu::ioctl(Ioctl command, const std::vector<u8>& input, const std::vector<u8>& input2,
-                         std::vector<u8>& output, std::vector<u8>& output2, IoctlCtrl& ctrl,
+u32 nvhost_as_gpu::ioctl(Ioctl command, Common::Span<const u8> input, Common::Span<const u8> input2,
+                         Common::Span<u8> output, Common::Span<u8> output2, IoctlCtrl& ctrl,
                          IoctlVersion version) {
     LOG_DEBUG(Service_NVDRV, "called, command=0x{:08X}, input_size=0x{:X}, output_size=0x{:X}",
               command.raw, input.size(), output.size());
@@ -54,7 +54,7 @@ u32 nvhost_as_gpu::ioctl(Ioctl command, const std::vector<u8>& input, const std:
     return 0;
 }
 
-u32 nvhost_as_gpu::InitalizeEx(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::InitalizeEx(Common::Span<const u8> input, Common::Span<u8> output) {
     IoctlInitalizeEx params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, big_page_size=0x{:X}", params.big_page_size);
@@ -62,7 +62,7 @@ u32 nvhost_as_gpu::InitalizeEx(const std::vector<u8>& input, std::vector<u8>& ou
     return 0;
 }
 
-u32 nvhost_as_gpu::AllocateSpace(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::AllocateSpace(Common::Span<const u8> input, Common::Span<u8> output) {
     IoctlAllocSpace params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "called, pages={:X}, page_size={:X}, flags={:X}", params.pages,
@@ -75,12 +75,13 @@ u32 nvhost_as_gpu::AllocateSpace(const std::vector<u8>& input, std::vector<u8>&
     } else {
         params.offset = gpu.MemoryManager().AllocateSpace(size, params.align);
     }
+    InvalidateRemaps(params.offset, size);
 
     std::memcpy(output.data(), &params, output.size());
     return 0;
 }
 
-u32 nvhost_as_gpu::Remap(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::Remap(Common::Span<const u8> input, Common::Span<u8> output) {
     std::size_t num_entries = input.size() / sizeof(IoctlRemapEntry);
 
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, num_entries=0x{:X}", num_entries);
@@ -105,14 +106,23 @@ u32 nvhost_as_gpu::Remap(const std::vector<u8>& input, std::vector<u8>& output)
         u64 size = static_cast<u64>(entry.pages) << 0x10;
         ASSERT(size <= object->size);
 
+        const auto cached = remap_mappings.find(offset);
+        if (cached != remap_mappings.end() && cached->second.cpu_addr == object->addr &&
+            cached->second.size == size) {
+            continue;
+        }
+
         GPUVAddr returned = gpu.MemoryManager().MapBufferEx(object->addr, offset, size);
         ASSERT(returned == offset);
+
+        InvalidateRemaps(offset, size);
+        remap_mappings.insert_or_assign(offset, RemapMapping{object->addr, size});
     }
     std::memcpy(output.data(), entries.data(), output.size());
     return 0;
 }
 
-u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::MapBufferEx(Common::Span<const u8> input, Common::Span<u8> output) {
     IoctlMapBufferEx params{};
     std::memcpy(&params, input.data(), input.size());
 
@@ -142,10 +152,18 @@ u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& ou
     auto& gpu = system.GPU();
 
     if (params.flags & 1) {
+        const auto itr = buffer_mappings.find(params.offset);
+        if (itr != buffer_mappings.end() && itr->second.nvmap_handle == params.nvmap_handle &&
+            itr->second.cpu_addr == object->addr && itr->second.size == object->size) {
+            // The buffer is already mapped right there, the page table doesn't change
+            std::memcpy(output.data(), &params, output.size());
+            return 0;
+        }
         params.offset = gpu.MemoryManager().MapBufferEx(object->addr, params.offset, object->size);
     } else {
         params.offset = gpu.MemoryManager().MapBufferEx(object->addr, object->size);
     }
+    InvalidateRemaps(params.offset, object->size);
 
     // Create a new mapping entry for this operation.
     ASSERT_MSG(buffer_mappings.find(params.offset) == buffer_mappings.end(),
@@ -155,6 +173,7 @@ u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& ou
     mapping.nvmap_handle = params.nvmap_handle;
     mapping.offset = params.offset;
     mapping.size = object->size;
+    mapping.cpu_addr = object->addr;
 
     buffer_mappings[params.offset] = mapping;
 
@@ -162,7 +181,7 @@ u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& ou
     return 0;
 }
 
-u32 nvhost_as_gpu::UnmapBuffer(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::UnmapBuffer(Common::Span<const u8> input, Common::Span<u8> output) {
     IoctlUnmapBuffer params{};
     std::memcpy(&params, input.data(), input.size());
 
@@ -176,14 +195,26 @@ u32 nvhost_as_gpu::UnmapBuffer(const std::vector<u8>& input, std::vector<u8>& ou
         return 0;
     }
 
+    InvalidateRemaps(itr->second.offset, itr->second.size);
     params.offset = system.GPU().MemoryManager().UnmapBuffer(params.offset, itr->second.size);
-    buffer_mappings.erase(itr->second.offset);
+    buffer_mappings.erase(itr);
 
     std::memcpy(output.data(), &params, output.size());
     return 0;
 }
 
-u32 nvhost_as_gpu::BindChannel(const std::vector<u8>& input, std::vector<u8>& output) {
+void nvhost_as_gpu::InvalidateRemaps(GPUVAddr offset, u64 size) {
+    for (auto it = remap_mappings.begin(); it != remap_mappings.end();) {
+        const GPUVAddr remap_offset = it->first;
+        if (remap_offset < offset + size && offset < remap_offset + it->second.size) {
+            it = remap_mappings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+u32 nvhost_as_gpu::BindChannel(Common::Span<const u8> input, Common::Span<u8> output) {
     IoctlBindChannel params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "called, fd={:X}", params.fd);
@@ -192,7 +223,7 @@ u32 nvhost_as_gpu::BindChannel(const std::vector<u8>& input, std::vector<u8>& ou
     return 0;
 }
 
-u32 nvhost_as_gpu::GetVARegions(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::GetVARegions(Common::Span<const u8> input, Common::Span<u8> output) {
     IoctlGetVaRegions params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, buf_addr={:X}, buf_size={:X}", params.buf_addr,
@@ -20,8 +20,8 @@ public:
     explicit nvhost_as_gpu(Core::System& system, std::shared_ptr<nvmap> nvmap_dev);
     ~nvhost_as_gpu() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, const std::vector<u8>& input2,
-              std::vector<u8>& output, std::vector<u8>& output2, IoctlCtrl& ctrl,
+    u32 ioctl(Ioctl command, Common::Span<const u8> input, Common::Span<const u8> input2,
+              Common::Span<u8> output, Common::Span<u8> output2, IoctlCtrl& ctrl,
               IoctlVersion version) override;
 
 private:
@@ -109,21 +109,34 @@ private:
     struct BufferMapping {
         u64 offset;
         u64 size;
+        VAddr cpu_addr;
         u32 nvmap_handle;
     };
 
+    struct RemapMapping {
+        VAddr cpu_addr;
+        u64 size;
+    };
+
     /// Map containing the nvmap object mappings in GPU memory.
     std::unordered_map<u64, BufferMapping> buffer_mappings;
 
+    /// Last mapping made by Remap at each GPU address. Titles remap the same pages every frame, so
+    /// identical remaps skip the memory manager.
+    std::unordered_map<GPUVAddr, RemapMapping> remap_mappings;
+
+    /// Forgets the remaps overlapping a GPU range whose mapping changed.
+    void InvalidateRemaps(GPUVAddr offset, u64 size);
+
     u32 channel{};
 
-    u32 InitalizeEx(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 AllocateSpace(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 Remap(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 MapBufferEx(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 UnmapBuffer(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 BindChannel(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetVARegions(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 InitalizeEx(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 AllocateSpace(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 Remap(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 MapBufferEx(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 UnmapBuffer(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 BindChannel(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 GetVARegions(Common::Span<const u8> input, Common::Span<u8> output);
 
     std::shared_ptr<nvmap> nvmap_dev;
 };
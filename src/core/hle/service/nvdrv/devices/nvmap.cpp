@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iterator>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -28,8 +29,8 @@ VAddr nvmap::GetObjectAddress(u32 handle) const {
     return object->addr;
 }
 
-u32 nvmap::ioctl(Ioctl command, const std::vector<u8>& input, const std::vector<u8>& input2,
-                 std::vector<u8>& output, std::vector<u8>& output2, IoctlCtrl& ctrl,
+u32 nvmap::ioctl(Ioctl command, Common::Span<const u8> input, Common::Span<const u8> input2,
+                 Common::Span<u8> output, Common::Span<u8> output2, IoctlCtrl& ctrl,
                  IoctlVersion version) {
     switch (static_cast<IoctlCommand>(command.raw)) {
     case IoctlCommand::Create:
@@ -50,7 +51,7 @@ u32 nvmap::ioctl(Ioctl command, const std::vector<u8>& input, const std::vector<
     return 0;
 }
 
-u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocCreate(Common::Span<const u8> input, Common::Span<u8> output) {
     IocCreateParams params;
     std::memcpy(&params, input.data(), sizeof(params));
     LOG_DEBUG(Service_NVDRV, "size=0x{:08X}", params.size);
@@ -67,6 +68,9 @@ u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
     object->refcount = 1;
 
     u32 handle = next_handle++;
+    if (handles.size() <= handle) {
+        handles.resize(handle + 1);
+    }
     handles[handle] = std::move(object);
 
     params.handle = handle;
@@ -75,7 +79,7 @@ u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocAlloc(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocAlloc(Common::Span<const u8> input, Common::Span<u8> output) {
     IocAllocParams params;
     std::memcpy(&params, input.data(), sizeof(params));
     LOG_DEBUG(Service_NVDRV, "called, addr={:X}", params.addr);
@@ -116,7 +120,7 @@ u32 nvmap::IocAlloc(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocGetId(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocGetId(Common::Span<const u8> input, Common::Span<u8> output) {
     IocGetIdParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
@@ -139,35 +143,35 @@ u32 nvmap::IocGetId(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocFromId(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocFromId(Common::Span<const u8> input, Common::Span<u8> output) {
     IocFromIdParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
     LOG_WARNING(Service_NVDRV, "(STUBBED) called");
 
     auto itr = std::find_if(handles.begin(), handles.end(),
-                            [&](const auto& entry) { return entry.second->id == params.id; });
+                            [&](const auto& entry) { return entry && entry->id == params.id; });
     if (itr == handles.end()) {
         LOG_ERROR(Service_NVDRV, "Object does not exist, handle={:08X}", params.handle);
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
 
-    auto& object = itr->second;
+    auto& object = *itr;
     if (object->status != Object::Status::Allocated) {
         LOG_ERROR(Service_NVDRV, "Object is not allocated, handle={:08X}", params.handle);
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
 
-    itr->second->refcount++;
+    object->refcount++;
 
     // Return the existing handle instead of creating a new one.
-    params.handle = itr->first;
+    params.handle = static_cast<u32>(std::distance(handles.begin(), itr));
 
     std::memcpy(output.data(), &params, sizeof(params));
     return 0;
 }
 
-u32 nvmap::IocParam(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocParam(Common::Span<const u8> input, Common::Span<u8> output) {
     enum class ParamTypes { Size = 1, Alignment = 2, Base = 3, Heap = 4, Kind = 5, Compr = 6 };
 
     IocParamParams params;
@@ -208,7 +212,7 @@ u32 nvmap::IocParam(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocFree(Common::Span<const u8> input, Common::Span<u8> output) {
     // TODO(Subv): These flags are unconfirmed.
     enum FreeFlags {
         Freed = 0,
@@ -220,12 +224,12 @@ u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
 
     LOG_WARNING(Service_NVDRV, "(STUBBED) called");
 
-    auto itr = handles.find(params.handle);
-    if (itr == handles.end()) {
+    const auto object = GetObject(params.handle);
+    if (!object) {
         LOG_ERROR(Service_NVDRV, "Object does not exist, handle={:08X}", params.handle);
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
-    if (!itr->second->refcount) {
+    if (!object->refcount) {
         LOG_ERROR(
             Service_NVDRV,
             "There is no references to this object. The object is already freed. handle={:08X}",
@@ -233,21 +237,21 @@ u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
 
-    itr->second->refcount--;
+    object->refcount--;
 
-    params.size = itr->second->size;
+    params.size = object->size;
 
-    if (itr->second->refcount == 0) {
+    if (object->refcount == 0) {
         params.flags = Freed;
         // The address of the nvmap is written to the output if we're finally freeing it, otherwise
         // 0 is written.
-        params.address = itr->second->addr;
+        params.address = object->addr;
     } else {
         params.flags = NotFreedYet;
         params.address = 0;
     }
 
-    handles.erase(params.handle);
+    handles[params.handle].reset();
 
     std::memcpy(output.data(), &params, sizeof(params));
     return 0;
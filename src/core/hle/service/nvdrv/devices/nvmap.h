@@ -5,7 +5,6 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <vector>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
@@ -22,8 +21,8 @@ public:
     /// Returns the allocated address of an nvmap object given its handle.
     VAddr GetObjectAddress(u32 handle) const;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, const std::vector<u8>& input2,
-              std::vector<u8>& output, std::vector<u8>& output2, IoctlCtrl& ctrl,
+    u32 ioctl(Ioctl command, Common::Span<const u8> input, Common::Span<const u8> input2,
+              Common::Span<u8> output, Common::Span<u8> output2, IoctlCtrl& ctrl,
               IoctlVersion version) override;
 
     /// Represents an nvmap object.
@@ -40,11 +39,10 @@ public:
     };
 
     std::shared_ptr<Object> GetObject(u32 handle) const {
-        auto itr = handles.find(handle);
-        if (itr != handles.end()) {
-            return itr->second;
+        if (handle >= handles.size()) {
+            return {};
         }
-        return {};
+        return handles[handle];
     }
 
 private:
@@ -54,8 +52,9 @@ private:
     /// Id to use for the next object that is created.
     u32 next_id = 1;
 
-    /// Mapping of currently allocated handles to the objects they represent.
-    std::unordered_map<u32, std::shared_ptr<Object>> handles;
+    /// Objects indexed by their handle, freed handles are left empty. Handles are handed out in
+    /// order and never reused, so the table stays dense.
+    std::vector<std::shared_ptr<Object>> handles;
 
     enum class IoctlCommand : u32 {
         Create = 0xC0080101,
@@ -119,12 +118,12 @@ private:
     };
     static_assert(sizeof(IocGetIdParams) == 8, "IocGetIdParams has wrong size");
 
-    u32 IocCreate(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocAlloc(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocGetId(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocFromId(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocParam(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocFree(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 IocCreate(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 IocAlloc(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 IocGetId(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 IocFromId(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 IocParam(Common::Span<const u8> input, Common::Span<u8> output);
+    u32 IocFree(Common::Span<const u8> input, Common::Span<u8> output);
 };
 
 } // namespace Service::Nvidia::Devices
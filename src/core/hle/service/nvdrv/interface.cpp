@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cinttypes>
+#include <optional>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
@@ -33,30 +34,37 @@ void NVDRV::Open(Kernel::HLERequestContext& ctx) {
     rb.Push<u32>(0);
 }
 
-void NVDRV::IoctlBase(Kernel::HLERequestContext& ctx, IoctlVersion version) {
-    IPC::RequestParser rp{ctx};
-    u32 fd = rp.Pop<u32>();
-    u32 command = rp.Pop<u32>();
+/// Runs an ioctl on the request's buffers, which are accessed in place whenever possible.
+static u32 RunIoctl(Module& nvdrv, Kernel::HLERequestContext& ctx, u32 fd, u32 command,
+                    IoctlCtrl& ctrl, IoctlVersion version) {
+    /// Ioctl2 has 2 inputs. It's used to pass data directly instead of providing a pointer.
+    /// KickOfPB uses this
+    const auto input = ctx.ReadBufferSpan(0);
+    std::optional<Kernel::ReadBufferView> input2;
+    Common::Span<const u8> input2_span;
+    if (version == IoctlVersion::Version2) {
+        input2_span = input2.emplace(ctx.ReadBufferSpan(1));
+    }
 
     /// Ioctl 3 has 2 outputs, first in the input params, second is the result
-    std::vector<u8> output(ctx.GetWriteBufferSize(0));
-    std::vector<u8> output2;
+    const auto output = ctx.WriteBufferSpan(0);
+    std::optional<Kernel::WriteBufferView> output2;
+    Common::Span<u8> output2_span;
     if (version == IoctlVersion::Version3) {
-        output2.resize((ctx.GetWriteBufferSize(1)));
+        output2_span = output2.emplace(ctx.WriteBufferSpan(1));
     }
 
-    /// Ioctl2 has 2 inputs. It's used to pass data directly instead of providing a pointer.
-    /// KickOfPB uses this
-    auto input = ctx.ReadBuffer(0);
+    return nvdrv.Ioctl(fd, command, input, input2_span, output, output2_span, ctrl, version);
+}
 
-    std::vector<u8> input2;
-    if (version == IoctlVersion::Version2) {
-        input2 = ctx.ReadBuffer(1);
-    }
+void NVDRV::IoctlBase(Kernel::HLERequestContext& ctx, IoctlVersion version) {
+    IPC::RequestParser rp{ctx};
+    u32 fd = rp.Pop<u32>();
+    u32 command = rp.Pop<u32>();
 
     IoctlCtrl ctrl{};
 
-    u32 result = nvdrv->Ioctl(fd, command, input, input2, output, output2, ctrl, version);
+    u32 result = RunIoctl(*nvdrv, ctx, fd, command, ctrl, version);
 
     if (ctrl.must_delay) {
         ctrl.fresh_call = false;
@@ -65,24 +73,12 @@ void NVDRV::IoctlBase(Kernel::HLERequestContext& ctx, IoctlVersion version) {
                                   Kernel::HLERequestContext& ctx,
                                   Kernel::ThreadWakeupReason reason) {
                                   IoctlCtrl ctrl2{ctrl};
-                                  std::vector<u8> tmp_output = output;
-                                  std::vector<u8> tmp_output2 = output2;
-                                  u32 result = nvdrv->Ioctl(fd, command, input, input2, tmp_output,
-                                                            tmp_output2, ctrl2, version);
-                                  ctx.WriteBuffer(tmp_output, 0);
-                                  if (version == IoctlVersion::Version3) {
-                                      ctx.WriteBuffer(tmp_output2, 1);
-                                  }
+                                  u32 result = RunIoctl(*nvdrv, ctx, fd, command, ctrl2, version);
                                   IPC::ResponseBuilder rb{ctx, 3};
                                   rb.Push(RESULT_SUCCESS);
                                   rb.Push(result);
                               },
                               nvdrv->GetEventWriteable(ctrl.event_id));
-    } else {
-        ctx.WriteBuffer(output);
-        if (version == IoctlVersion::Version3) {
-            ctx.WriteBuffer(output2, 1);
-        }
     }
     IPC::ResponseBuilder rb{ctx, 3};
     rb.Push(RESULT_SUCCESS);
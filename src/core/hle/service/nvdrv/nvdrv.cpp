@@ -71,8 +71,8 @@ u32 Module::Open(const std::string& device_name) {
     return fd;
 }
 
-u32 Module::Ioctl(u32 fd, u32 command, const std::vector<u8>& input, const std::vector<u8>& input2,
-                  std::vector<u8>& output, std::vector<u8>& output2, IoctlCtrl& ctrl,
+u32 Module::Ioctl(u32 fd, u32 command, Common::Span<const u8> input, Common::Span<const u8> input2,
+                  Common::Span<u8> output, Common::Span<u8> output2, IoctlCtrl& ctrl,
                   IoctlVersion version) {
     auto itr = open_files.find(fd);
     ASSERT_MSG(itr != open_files.end(), "Tried to talk to an invalid device");
@@ -93,8 +93,9 @@ ResultCode Module::Close(u32 fd) {
 
 void Module::SignalSyncpt(const u32 syncpoint_id, const u32 value) {
     for (u32 i = 0; i < MaxNvEvents; i++) {
+        // Interrupts of a syncpoint are merged, the value may be past the one an event awaits
         if (events_interface.assigned_syncpt[i] == syncpoint_id &&
-            events_interface.assigned_value[i] == value) {
+            events_interface.assigned_value[i] <= value) {
             events_interface.LiberateEvent(i);
             events_interface.events[i].writable->Signal();
         }
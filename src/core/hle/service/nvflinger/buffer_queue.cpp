@@ -76,6 +76,10 @@ void BufferQueue::QueueBuffer(u32 slot, BufferTransformFlags transform,
     itr->swap_interval = swap_interval;
     itr->multi_fence = multi_fence;
     queue_sequence.push_back(slot);
+
+    if (queue_callback) {
+        queue_callback();
+    }
 }
 
 std::optional<std::reference_wrapper<const BufferQueue::Buffer>> BufferQueue::AcquireBuffer() {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <optional>
 #include <vector>
@@ -89,6 +90,11 @@ public:
         return id;
     }
 
+    /// Sets a function that is called whenever a buffer is queued.
+    void SetQueueCallback(std::function<void()> callback) {
+        queue_callback = std::move(callback);
+    }
+
     Kernel::SharedPtr<Kernel::WritableEvent> GetWritableBufferWaitEvent() const;
 
     Kernel::SharedPtr<Kernel::ReadableEvent> GetBufferWaitEvent() const;
@@ -100,6 +106,7 @@ private:
     std::vector<Buffer> queue;
     std::list<u32> queue_sequence;
     Kernel::EventPair buffer_wait_event;
+    std::function<void()> queue_callback;
 };
 
 } // namespace Service::NVFlinger
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <iterator>
 #include <optional>
 
 #include "common/assert.h"
@@ -35,13 +36,16 @@ NVFlinger::NVFlinger(Core::System& system) : system(system) {
     displays.emplace_back(2, "Edid", system);
     displays.emplace_back(3, "Internal", system);
     displays.emplace_back(4, "Null", system);
+    frame_presented.resize(displays.size());
 
     // Schedule the screen composition events
     composition_event = system.CoreTiming().RegisterEvent(
         "ScreenComposition", [this](u64 userdata, s64 cycles_late) {
             Compose();
-            const auto ticks =
-                Settings::values.force_30fps_mode ? frame_ticks_30fps : GetNextTicks();
+            const auto ticks = Settings::values.force_30fps_mode &&
+                                       !Settings::values.uncap_composition_rate
+                                   ? frame_ticks_30fps
+                                   : GetNextTicks();
             this->system.CoreTiming().ScheduleEvent(std::max<s64>(0LL, ticks - cycles_late),
                                                     composition_event);
         });
@@ -84,6 +88,7 @@ std::optional<u64> NVFlinger::CreateLayer(u64 display_id) {
     const u64 layer_id = next_layer_id++;
     const u32 buffer_queue_id = next_buffer_queue_id++;
     buffer_queues.emplace_back(buffer_queue_id, layer_id);
+    buffer_queues.back().SetQueueCallback([this, display_id] { OnBufferQueued(display_id); });
     display->CreateLayer(layer_id, buffer_queues.back());
     return layer_id;
 }
@@ -169,7 +174,9 @@ const VI::Layer* NVFlinger::FindLayer(u64 display_id, u64 layer_id) const {
 }
 
 void NVFlinger::Compose() {
-    for (auto& display : displays) {
+    for (std::size_t i = 0; i < displays.size(); ++i) {
+        auto& display = displays[i];
+
         // Trigger vsync for this display at the end of drawing
         SCOPE_EXIT({ display.SignalVSyncEvent(); });
 
@@ -177,41 +184,76 @@ void NVFlinger::Compose() {
         if (!display.HasLayers())
             continue;
 
-        // TODO(Subv): Support more than 1 layer.
-        VI::Layer& layer = display.GetLayer(0);
-        auto& buffer_queue = layer.GetBufferQueue();
-
-        // Search for a queued buffer and acquire it
-        auto buffer = buffer_queue.AcquireBuffer();
-
-        MicroProfileFlip();
-
-        if (!buffer) {
+        // Buffers queued since the last vsync were presented right away, only those that were
+        // held back to keep one frame per interval are left.
+        const bool presented_early = frame_presented[i];
+        frame_presented[i] = PresentQueuedBuffer(display);
+        if (!frame_presented[i] && !presented_early) {
             // There was no queued buffer to draw, render previous frame
+            MicroProfileFlip();
             system.GetPerfStats().EndGameFrame();
             system.GPU().SwapBuffers({});
-            continue;
         }
+    }
+}
 
-        const auto& igbp_buffer = buffer->get().igbp_buffer;
+void NVFlinger::OnBufferQueued(u64 display_id) {
+    const auto itr =
+        std::find_if(displays.begin(), displays.end(),
+                     [&](const VI::Display& display) { return display.GetID() == display_id; });
+    if (itr == displays.end()) {
+        return;
+    }
 
-        // Now send the buffer to the GPU for drawing.
-        // TODO(Subv): Support more than just disp0. The display device selection is probably based
-        // on which display we're drawing (Default, Internal, External, etc)
-        auto nvdisp = nvdrv->GetDevice<Nvidia::Devices::nvdisp_disp0>("/dev/nvdisp_disp0");
-        ASSERT(nvdisp);
+    const auto index = static_cast<std::size_t>(std::distance(displays.begin(), itr));
+    if (frame_presented[index] && !Settings::values.uncap_composition_rate) {
+        // Keep it queued until the next vsync
+        return;
+    }
+    if (PresentQueuedBuffer(*itr)) {
+        frame_presented[index] = true;
+    }
+}
 
-        nvdisp->flip(igbp_buffer.gpu_buffer_id, igbp_buffer.offset, igbp_buffer.format,
-                     igbp_buffer.width, igbp_buffer.height, igbp_buffer.stride,
-                     buffer->get().transform, buffer->get().crop_rect);
+bool NVFlinger::PresentQueuedBuffer(VI::Display& display) {
+    if (!display.HasLayers()) {
+        return false;
+    }
+
+    // TODO(Subv): Support more than 1 layer.
+    VI::Layer& layer = display.GetLayer(0);
+    auto& buffer_queue = layer.GetBufferQueue();
 
-        swap_interval = buffer->get().swap_interval;
-        buffer_queue.ReleaseBuffer(buffer->get().slot);
+    // Search for a queued buffer and acquire it
+    auto buffer = buffer_queue.AcquireBuffer();
+    if (!buffer) {
+        return false;
     }
+
+    MicroProfileFlip();
+
+    const auto& igbp_buffer = buffer->get().igbp_buffer;
+
+    // Now send the buffer to the GPU for drawing.
+    // TODO(Subv): Support more than just disp0. The display device selection is probably based
+    // on which display we're drawing (Default, Internal, External, etc)
+    auto nvdisp = nvdrv->GetDevice<Nvidia::Devices::nvdisp_disp0>("/dev/nvdisp_disp0");
+    ASSERT(nvdisp);
+
+    nvdisp->flip(igbp_buffer.gpu_buffer_id, igbp_buffer.offset, igbp_buffer.format,
+                 igbp_buffer.width, igbp_buffer.height, igbp_buffer.stride,
+                 buffer->get().transform, buffer->get().crop_rect);
+
+    swap_interval = buffer->get().swap_interval;
+    buffer_queue.ReleaseBuffer(buffer->get().slot);
+    return true;
 }
 
 s64 NVFlinger::GetNextTicks() const {
     constexpr s64 max_hertz = 120LL;
+    if (Settings::values.uncap_composition_rate) {
+        return Core::Timing::BASE_CLOCK_RATE / max_hertz;
+    }
     return (Core::Timing::BASE_CLOCK_RATE * (1LL << swap_interval)) / max_hertz;
 }
 
@@ -77,6 +77,14 @@ public:
     s64 GetNextTicks() const;
 
 private:
+    /// Presents a buffer queued on a display as soon as it's queued, unless the display already
+    /// presented a frame in the current vsync interval.
+    void OnBufferQueued(u64 display_id);
+
+    /// Sends the next queued buffer of the display's layer to the GPU. Returns false if there was
+    /// none.
+    bool PresentQueuedBuffer(VI::Display& display);
+
     /// Finds the display identified by the specified ID.
     VI::Display* FindDisplay(u64 display_id);
 
@@ -94,6 +102,9 @@ private:
     std::vector<VI::Display> displays;
     std::vector<BufferQueue> buffer_queues;
 
+    /// Whether each display presented a frame since its last vsync.
+    std::vector<bool> frame_presented;
+
     /// Id to use for the next layer that is created, this counter is shared among all displays.
     u64 next_layer_id = 1;
     /// Id to use for the next buffer queue that is created, this counter is shared among all
@@ -3,8 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <utility>
 #include <fmt/format.h>
 #include "common/assert.h"
+#include "common/bit_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/core.h"
@@ -69,6 +77,7 @@
 #include "core/hle/service/vi/vi.h"
 #include "core/hle/service/wlan/wlan.h"
 #include "core/reporter.h"
+#include "core/settings.h"
 
 namespace Service {
 
@@ -89,6 +98,78 @@ namespace Service {
     return function_string;
 }
 
+struct CommandStatistics {
+    const char* name = nullptr;
+    std::atomic<u64> call_count{};
+    std::atomic<u64> host_time_ns{};
+    std::array<std::atomic<u64>, NumIPCTimeBuckets> histogram{};
+
+    void Record(u64 time_ns) {
+        const u64 time_us = time_ns / 1000;
+        const std::size_t bucket =
+            time_us == 0 ? 0 : std::min<std::size_t>(Common::Log2Floor64(time_us) + 1,
+                                                      NumIPCTimeBuckets - 1);
+        call_count.fetch_add(1, std::memory_order_relaxed);
+        host_time_ns.fetch_add(time_ns, std::memory_order_relaxed);
+        histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+namespace {
+struct StatisticsRegistry {
+    std::mutex mutex;
+    /// Keyed by service name and command id. Entries are never erased, so handlers can keep
+    /// pointers to them.
+    std::map<std::pair<std::string, u32>, CommandStatistics> commands;
+};
+
+StatisticsRegistry& GetStatisticsRegistry() {
+    static StatisticsRegistry registry;
+    return registry;
+}
+} // Anonymous namespace
+
+/// Returns the statistics shared by every session of a service for one of its commands.
+static CommandStatistics& GetCommandStatistics(const std::string& service_name, u32 command_id,
+                                               const char* name) {
+    StatisticsRegistry& registry = GetStatisticsRegistry();
+    std::lock_guard lock{registry.mutex};
+    CommandStatistics& statistics = registry.commands[{service_name, command_id}];
+    statistics.name = name;
+    return statistics;
+}
+
+std::vector<CommandStatisticsEntry> GetIPCStatistics() {
+    StatisticsRegistry& registry = GetStatisticsRegistry();
+    std::lock_guard lock{registry.mutex};
+    std::vector<CommandStatisticsEntry> entries;
+    entries.reserve(registry.commands.size());
+    for (const auto& [key, statistics] : registry.commands) {
+        CommandStatisticsEntry& entry = entries.emplace_back();
+        entry.service_name = key.first;
+        entry.command_name = statistics.name;
+        entry.command_id = key.second;
+        entry.call_count = statistics.call_count.load(std::memory_order_relaxed);
+        entry.host_time_ns = statistics.host_time_ns.load(std::memory_order_relaxed);
+        for (std::size_t bucket = 0; bucket < NumIPCTimeBuckets; ++bucket) {
+            entry.histogram[bucket] = statistics.histogram[bucket].load(std::memory_order_relaxed);
+        }
+    }
+    return entries;
+}
+
+void ResetIPCStatistics() {
+    StatisticsRegistry& registry = GetStatisticsRegistry();
+    std::lock_guard lock{registry.mutex};
+    for (auto& [key, statistics] : registry.commands) {
+        statistics.call_count = 0;
+        statistics.host_time_ns = 0;
+        for (auto& bucket : statistics.histogram) {
+            bucket = 0;
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 ServiceFrameworkBase::ServiceFrameworkBase(const char* service_name, u32 max_sessions,
@@ -131,8 +212,33 @@ Kernel::SharedPtr<Kernel::ClientPort> ServiceFrameworkBase::CreatePort() {
 void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n) {
     handlers.reserve(handlers.size() + n);
     for (std::size_t i = 0; i < n; ++i) {
-        // Usually this array is sorted by id already, so hint to insert at the end
-        handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
+        handlers.push_back({functions[i], nullptr});
+    }
+    // The first handler registered for an id wins
+    const auto id_less = [](const HandlerEntry& lhs, const HandlerEntry& rhs) {
+        return lhs.info.expected_header < rhs.info.expected_header;
+    };
+    std::stable_sort(handlers.begin(), handlers.end(), id_less);
+    handlers.erase(std::unique(handlers.begin(), handlers.end(),
+                               [](const HandlerEntry& lhs, const HandlerEntry& rhs) {
+                                   return lhs.info.expected_header == rhs.info.expected_header;
+                               }),
+                   handlers.end());
+    ASSERT(handlers.size() < std::numeric_limits<u16>::max());
+
+    // Most services use small, dense command ids, so a flat table resolves them with one load
+    u32 table_size = 0;
+    for (const HandlerEntry& entry : handlers) {
+        if (entry.info.expected_header < MaxDispatchTableSize) {
+            table_size = entry.info.expected_header + 1;
+        }
+    }
+    handler_table.assign(table_size, 0);
+    for (std::size_t index = 0; index < handlers.size(); ++index) {
+        const u32 id = handlers[index].info.expected_header;
+        if (id < table_size) {
+            handler_table[id] = static_cast<u16>(index + 1);
+        }
     }
 }
 
@@ -154,15 +260,39 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(Kernel::HLERequestContext
     UNIMPLEMENTED_MSG("Unknown / unimplemented {}", fmt::to_string(buf));
 }
 
+ServiceFrameworkBase::HandlerEntry* ServiceFrameworkBase::FindHandler(u32 command_id) {
+    if (command_id < handler_table.size()) {
+        const u16 index = handler_table[command_id];
+        return index != 0 ? &handlers[index - 1] : nullptr;
+    }
+    const auto it = std::lower_bound(
+        handlers.begin(), handlers.end(), command_id,
+        [](const HandlerEntry& entry, u32 id) { return entry.info.expected_header < id; });
+    return it != handlers.end() && it->info.expected_header == command_id ? &*it : nullptr;
+}
+
 void ServiceFrameworkBase::InvokeRequest(Kernel::HLERequestContext& ctx) {
-    auto itr = handlers.find(ctx.GetCommand());
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
+    HandlerEntry* const entry = FindHandler(ctx.GetCommand());
+    const FunctionInfoBase* info = entry == nullptr ? nullptr : &entry->info;
     if (info == nullptr || info->handler_callback == nullptr) {
         return ReportUnimplementedFunction(ctx, info);
     }
 
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName(), ctx.CommandBuffer()));
+    if (!Settings::values.record_ipc_statistics) {
+        handler_invoker(this, info->handler_callback, ctx);
+        return;
+    }
+    if (entry->statistics == nullptr) {
+        entry->statistics = &GetCommandStatistics(service_name, info->expected_header, info->name);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
     handler_invoker(this, info->handler_callback, ctx);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    entry->statistics->Record(
+        static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
 }
 
 ResultCode ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
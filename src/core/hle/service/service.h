@@ -4,9 +4,10 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <string>
-#include <boost/container/flat_map.hpp>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/object.h"
@@ -39,6 +40,29 @@ static const int kMaxPortSize = 8; ///< Maximum size of a port name (8 character
 /// Arbitrary default number of maximum connections to an HLE service.
 static const u32 DefaultMaxSessions = 10;
 
+/// Number of buckets of the IPC host time histograms. Bucket 0 counts the calls that took under a
+/// microsecond, bucket i the calls under 2^i microseconds, and the last bucket all slower calls.
+constexpr std::size_t NumIPCTimeBuckets = 16;
+
+struct CommandStatistics;
+
+/// Snapshot of the calls to a command, accumulated over every session of its service.
+struct CommandStatisticsEntry {
+    std::string service_name;
+    std::string command_name;
+    u32 command_id;
+    u64 call_count;
+    u64 host_time_ns;
+    std::array<u64, NumIPCTimeBuckets> histogram;
+};
+
+/// Returns the statistics of the commands called while Settings::values.record_ipc_statistics was
+/// enabled, sorted by service name and command id.
+std::vector<CommandStatisticsEntry> GetIPCStatistics();
+
+/// Clears the statistics of every command.
+void ResetIPCStatistics();
+
 /**
  * This is an non-templated base of ServiceFramework to reduce code bloat and compilation times, it
  * is not meant to be used directly.
@@ -89,12 +113,20 @@ private:
     using InvokerFn = void(ServiceFrameworkBase* object, HandlerFnP<ServiceFrameworkBase> member,
                            Kernel::HLERequestContext& ctx);
 
+    struct HandlerEntry {
+        FunctionInfoBase info;
+        CommandStatistics* statistics; ///< Looked up on the first call that is recorded
+    };
+
     ServiceFrameworkBase(const char* service_name, u32 max_sessions, InvokerFn* handler_invoker);
     ~ServiceFrameworkBase() override;
 
     void RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n);
     void ReportUnimplementedFunction(Kernel::HLERequestContext& ctx, const FunctionInfoBase* info);
 
+    /// Returns the handler of a command id, or nullptr when it wasn't registered.
+    HandlerEntry* FindHandler(u32 command_id);
+
     /// Identifier string used to connect to the service.
     std::string service_name;
     /// Maximum number of concurrent sessions that this service can handle.
@@ -106,7 +138,12 @@ private:
 
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
-    boost::container::flat_map<u32, FunctionInfoBase> handlers;
+    static constexpr u32 MaxDispatchTableSize = 0x1000;
+    /// Registered handlers, sorted by command id.
+    std::vector<HandlerEntry> handlers;
+    /// Dispatch table from command ids to their index in handlers plus one, zero when unknown.
+    /// Only covers ids below MaxDispatchTableSize, the rare higher ids are binary searched.
+    std::vector<u16> handler_table;
 };
 
 /**
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <tuple>
 #include "common/assert.h"
 #include "core/core.h"
@@ -26,14 +27,16 @@ void ServiceManager::InvokeControlRequest(Kernel::HLERequestContext& context) {
     controller_interface->InvokeRequest(context);
 }
 
-static ResultCode ValidateServiceName(const std::string& name) {
-    if (name.size() <= 0 || name.size() > 8) {
-        return ERR_INVALID_NAME;
+std::optional<u64> ServiceManager::PackServiceName(std::string_view name) {
+    if (name.empty() || name.size() > sizeof(u64)) {
+        return std::nullopt;
     }
-    if (name.find('\0') != std::string::npos) {
-        return ERR_INVALID_NAME;
+    if (name.find('\0') != std::string_view::npos) {
+        return std::nullopt;
     }
-    return RESULT_SUCCESS;
+    u64 packed = 0;
+    std::memcpy(&packed, name.data(), name.size());
+    return packed;
 }
 
 void ServiceManager::InstallInterfaces(std::shared_ptr<ServiceManager> self) {
@@ -48,23 +51,27 @@ void ServiceManager::InstallInterfaces(std::shared_ptr<ServiceManager> self) {
 ResultVal<Kernel::SharedPtr<Kernel::ServerPort>> ServiceManager::RegisterService(
     std::string name, unsigned int max_sessions) {
 
-    CASCADE_CODE(ValidateServiceName(name));
-
-    if (registered_services.find(name) != registered_services.end())
+    const auto key = PackServiceName(name);
+    if (!key) {
+        return ERR_INVALID_NAME;
+    }
+    if (registered_services.find(*key) != registered_services.end())
         return ERR_ALREADY_REGISTERED;
 
     auto& kernel = Core::System::GetInstance().Kernel();
     auto [server_port, client_port] =
-        Kernel::ServerPort::CreatePortPair(kernel, max_sessions, name);
+        Kernel::ServerPort::CreatePortPair(kernel, max_sessions, std::move(name));
 
-    registered_services.emplace(std::move(name), std::move(client_port));
+    registered_services.emplace(*key, std::move(client_port));
     return MakeResult(std::move(server_port));
 }
 
-ResultCode ServiceManager::UnregisterService(const std::string& name) {
-    CASCADE_CODE(ValidateServiceName(name));
-
-    const auto iter = registered_services.find(name);
+ResultCode ServiceManager::UnregisterService(std::string_view name) {
+    const auto key = PackServiceName(name);
+    if (!key) {
+        return ERR_INVALID_NAME;
+    }
+    const auto iter = registered_services.find(*key);
     if (iter == registered_services.end())
         return ERR_SERVICE_NOT_REGISTERED;
 
@@ -73,10 +80,13 @@ ResultCode ServiceManager::UnregisterService(const std::string& name) {
 }
 
 ResultVal<Kernel::SharedPtr<Kernel::ClientPort>> ServiceManager::GetServicePort(
-    const std::string& name) {
+    std::string_view name) {
 
-    CASCADE_CODE(ValidateServiceName(name));
-    auto it = registered_services.find(name);
+    const auto key = PackServiceName(name);
+    if (!key) {
+        return ERR_INVALID_NAME;
+    }
+    auto it = registered_services.find(*key);
     if (it == registered_services.end()) {
         return ERR_SERVICE_NOT_REGISTERED;
     }
@@ -85,7 +95,7 @@ ResultVal<Kernel::SharedPtr<Kernel::ClientPort>> ServiceManager::GetServicePort(
 }
 
 ResultVal<Kernel::SharedPtr<Kernel::ClientSession>> ServiceManager::ConnectToService(
-    const std::string& name) {
+    std::string_view name) {
 
     CASCADE_RESULT(auto client_port, GetServicePort(name));
     return client_port->Connect();
@@ -109,10 +119,11 @@ void SM::Initialize(Kernel::HLERequestContext& ctx) {
 
 void SM::GetService(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx};
-    auto name_buf = rp.PopRaw<std::array<char, 8>>();
-    auto end = std::find(name_buf.begin(), name_buf.end(), '\0');
+    const auto name_buf = rp.PopRaw<std::array<char, 8>>();
+    const auto end = std::find(name_buf.begin(), name_buf.end(), '\0');
 
-    std::string name(name_buf.begin(), end);
+    // Looked up without building a string, titles may call this very often
+    const std::string_view name(name_buf.data(), static_cast<std::size_t>(end - name_buf.begin()));
 
     // TODO(yuriks): Permission checks go here
 
@@ -171,7 +182,7 @@ void SM::UnregisterService(Kernel::HLERequestContext& ctx) {
     const auto name_buf = rp.PopRaw<std::array<char, 8>>();
     const auto end = std::find(name_buf.begin(), name_buf.end(), '\0');
 
-    const std::string name(name_buf.begin(), end);
+    const std::string_view name(name_buf.data(), static_cast<std::size_t>(end - name_buf.begin()));
     LOG_DEBUG(Service_SM, "called with name={}", name);
 
     IPC::ResponseBuilder rb{ctx, 2};
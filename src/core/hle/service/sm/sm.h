@@ -5,7 +5,9 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 
@@ -50,15 +52,16 @@ public:
 
     ResultVal<Kernel::SharedPtr<Kernel::ServerPort>> RegisterService(std::string name,
                                                                      unsigned int max_sessions);
-    ResultCode UnregisterService(const std::string& name);
-    ResultVal<Kernel::SharedPtr<Kernel::ClientPort>> GetServicePort(const std::string& name);
-    ResultVal<Kernel::SharedPtr<Kernel::ClientSession>> ConnectToService(const std::string& name);
+    ResultCode UnregisterService(std::string_view name);
+    ResultVal<Kernel::SharedPtr<Kernel::ClientPort>> GetServicePort(std::string_view name);
+    ResultVal<Kernel::SharedPtr<Kernel::ClientSession>> ConnectToService(std::string_view name);
 
     template <typename T>
-    std::shared_ptr<T> GetService(const std::string& service_name) const {
+    std::shared_ptr<T> GetService(std::string_view service_name) const {
         static_assert(std::is_base_of_v<Kernel::SessionRequestHandler, T>,
                       "Not a base of ServiceFrameworkBase");
-        auto service = registered_services.find(service_name);
+        const auto key = PackServiceName(service_name);
+        const auto service = key ? registered_services.find(*key) : registered_services.end();
         if (service == registered_services.end()) {
             LOG_DEBUG(Service, "Can't find service: {}", service_name);
             return nullptr;
@@ -76,8 +79,16 @@ private:
     std::weak_ptr<SM> sm_interface;
     std::unique_ptr<Controller> controller_interface;
 
-    /// Map of registered services, retrieved using GetServicePort or ConnectToService.
-    std::unordered_map<std::string, Kernel::SharedPtr<Kernel::ClientPort>> registered_services;
+    /**
+     * Packs a service name into an integer, the way sm: receives it: up to 8 characters padded
+     * with null characters.
+     * @returns The packed name, or nothing when the name isn't valid.
+     */
+    static std::optional<u64> PackServiceName(std::string_view name);
+
+    /// Map of registered services by packed name, retrieved using GetServicePort or
+    /// ConnectToService.
+    std::unordered_map<u64, Kernel::SharedPtr<Kernel::ClientPort>> registered_services;
 };
 
 } // namespace Service::SM
@@ -15,6 +15,7 @@
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
+#include "common/span.h"
 #include "common/swap.h"
 #include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
@@ -59,21 +60,28 @@ struct DisplayInfo {
 };
 static_assert(sizeof(DisplayInfo) == 0x60, "DisplayInfo has wrong size");
 
+/**
+ * Binder parcel. Requests are read in place from the IPC input buffer and responses are
+ * serialized straight into the output buffer, so transactions don't allocate.
+ */
 class Parcel {
 public:
-    // This default size was chosen arbitrarily.
+    /// Serialized parcels are padded with zeroes up to this size.
     static constexpr std::size_t DefaultBufferSize = 0x40;
-    Parcel() : buffer(DefaultBufferSize) {}
-    explicit Parcel(std::vector<u8> data) : buffer(std::move(data)) {}
+
+    /// Creates a parcel to be serialized.
+    Parcel() = default;
+    /// Creates a parcel to be deserialized from data, which must outlive it.
+    explicit Parcel(Common::Span<const u8> data) : read_buffer(data) {}
     virtual ~Parcel() = default;
 
     template <typename T>
     T Read() {
         static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
-        ASSERT(read_index + sizeof(T) <= buffer.size());
+        ASSERT(read_index + sizeof(T) <= read_buffer.size());
 
         T val;
-        std::memcpy(&val, buffer.data() + read_index, sizeof(T));
+        std::memcpy(&val, read_buffer.data() + read_index, sizeof(T));
         read_index += sizeof(T);
         read_index = Common::AlignUp(read_index, 4);
         return val;
@@ -82,17 +90,17 @@ public:
     template <typename T>
     T ReadUnaligned() {
         static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
-        ASSERT(read_index + sizeof(T) <= buffer.size());
+        ASSERT(read_index + sizeof(T) <= read_buffer.size());
 
         T val;
-        std::memcpy(&val, buffer.data() + read_index, sizeof(T));
+        std::memcpy(&val, read_buffer.data() + read_index, sizeof(T));
         read_index += sizeof(T);
         return val;
     }
 
     std::vector<u8> ReadBlock(std::size_t length) {
-        ASSERT(read_index + length <= buffer.size());
-        const u8* const begin = buffer.data() + read_index;
+        ASSERT(read_index + length <= read_buffer.size());
+        const u8* const begin = read_buffer.data() + read_index;
         const u8* const end = begin + length;
         std::vector<u8> data(begin, end);
         read_index += length;
@@ -100,32 +108,27 @@ public:
         return data;
     }
 
-    std::u16string ReadInterfaceToken() {
-        u32 unknown = Read<u32_le>();
-        u32 length = Read<u32_le>();
-
-        std::u16string token{};
-
-        for (u32 ch = 0; ch < length + 1; ++ch) {
-            token.push_back(ReadUnaligned<u16_le>());
-        }
+    /// Skips the interface token of a request, nothing checks it.
+    void SkipInterfaceToken() {
+        Read<u32_le>(); // Unknown
+        const u32 length = Read<u32_le>();
 
-        read_index = Common::AlignUp(read_index, 4);
-
-        return token;
+        // UTF-16 characters, followed by a null terminator
+        const std::size_t token_size = (static_cast<std::size_t>(length) + 1) * sizeof(u16);
+        ASSERT(read_index + token_size <= read_buffer.size());
+        read_index = Common::AlignUp(read_index + token_size, 4);
     }
 
     template <typename T>
     void Write(const T& val) {
         static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+        const std::size_t end = Common::AlignUp(write_index + sizeof(T), 4);
+        ASSERT_MSG(end <= write_buffer.size(), "Parcel doesn't fit in the output buffer");
 
-        if (buffer.size() < write_index + sizeof(T)) {
-            buffer.resize(buffer.size() + sizeof(T) + DefaultBufferSize);
-        }
-
-        std::memcpy(buffer.data() + write_index, &val, sizeof(T));
-        write_index += sizeof(T);
-        write_index = Common::AlignUp(write_index, 4);
+        std::memcpy(write_buffer.data() + write_index, &val, sizeof(T));
+        std::memset(write_buffer.data() + write_index + sizeof(T), 0,
+                    end - write_index - sizeof(T));
+        write_index = end;
     }
 
     template <typename T>
@@ -140,17 +143,20 @@ public:
     }
 
     void Deserialize() {
-        ASSERT(buffer.size() > sizeof(Header));
+        ASSERT(read_buffer.size() > sizeof(Header));
 
         Header header{};
-        std::memcpy(&header, buffer.data(), sizeof(Header));
+        std::memcpy(&header, read_buffer.data(), sizeof(Header));
 
         read_index = header.data_offset;
         DeserializeData();
     }
 
-    std::vector<u8> Serialize() {
+    /// Serializes the parcel into output, returns the number of bytes written.
+    std::size_t Serialize(Common::Span<u8> output) {
         ASSERT(read_index == 0);
+        ASSERT_MSG(output.size() >= sizeof(Header), "Parcel doesn't fit in the output buffer");
+        write_buffer = output;
         write_index = sizeof(Header);
 
         SerializeData();
@@ -160,9 +166,16 @@ public:
         header.data_offset = sizeof(Header);
         header.objects_size = 4;
         header.objects_offset = sizeof(Header) + header.data_size;
-        std::memcpy(buffer.data(), &header, sizeof(Header));
-
-        return buffer;
+        std::memcpy(output.data(), &header, sizeof(Header));
+
+        // The objects and the padding are zeroes
+        const std::size_t size = std::min(
+            std::max<std::size_t>(write_index + header.objects_size, DefaultBufferSize),
+            output.size());
+        if (size > write_index) {
+            std::memset(output.data() + write_index, 0, size - write_index);
+        }
+        return size;
     }
 
 protected:
@@ -179,11 +192,18 @@ private:
     };
     static_assert(sizeof(Header) == 16, "ParcelHeader has wrong size");
 
-    std::vector<u8> buffer;
+    Common::Span<const u8> read_buffer;
+    Common::Span<u8> write_buffer;
     std::size_t read_index = 0;
     std::size_t write_index = 0;
 };
 
+/// Serializes a parcel into the output buffer of a request, returns the number of bytes written.
+static std::size_t WriteParcel(Kernel::HLERequestContext& ctx, Parcel& parcel) {
+    const auto output = ctx.WriteBufferSpan();
+    return parcel.Serialize({output.data(), output.size()});
+}
+
 class NativeWindow : public Parcel {
 public:
     explicit NativeWindow(u32 id) {
@@ -212,13 +232,13 @@ private:
 
 class IGBPConnectRequestParcel : public Parcel {
 public:
-    explicit IGBPConnectRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
+    explicit IGBPConnectRequestParcel(Common::Span<const u8> buffer) : Parcel(buffer) {
         Deserialize();
     }
     ~IGBPConnectRequestParcel() override = default;
 
     void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
+        SkipInterfaceToken();
         data = Read<Data>();
     }
 
@@ -275,14 +295,14 @@ private:
 
 class IGBPSetPreallocatedBufferRequestParcel : public Parcel {
 public:
-    explicit IGBPSetPreallocatedBufferRequestParcel(std::vector<u8> buffer)
-        : Parcel(std::move(buffer)) {
+    explicit IGBPSetPreallocatedBufferRequestParcel(Common::Span<const u8> buffer)
+        : Parcel(buffer) {
         Deserialize();
     }
     ~IGBPSetPreallocatedBufferRequestParcel() override = default;
 
     void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
+        SkipInterfaceToken();
         data = Read<Data>();
         buffer = Read<NVFlinger::IGBPBuffer>();
     }
@@ -308,13 +328,13 @@ protected:
 
 class IGBPDequeueBufferRequestParcel : public Parcel {
 public:
-    explicit IGBPDequeueBufferRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
+    explicit IGBPDequeueBufferRequestParcel(Common::Span<const u8> buffer) : Parcel(buffer) {
         Deserialize();
     }
     ~IGBPDequeueBufferRequestParcel() override = default;
 
     void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
+        SkipInterfaceToken();
         data = Read<Data>();
     }
 
@@ -349,13 +369,13 @@ protected:
 
 class IGBPRequestBufferRequestParcel : public Parcel {
 public:
-    explicit IGBPRequestBufferRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
+    explicit IGBPRequestBufferRequestParcel(Common::Span<const u8> buffer) : Parcel(buffer) {
         Deserialize();
     }
     ~IGBPRequestBufferRequestParcel() override = default;
 
     void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
+        SkipInterfaceToken();
         slot = Read<u32_le>();
     }
 
@@ -381,13 +401,13 @@ protected:
 
 class IGBPQueueBufferRequestParcel : public Parcel {
 public:
-    explicit IGBPQueueBufferRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
+    explicit IGBPQueueBufferRequestParcel(Common::Span<const u8> buffer) : Parcel(buffer) {
         Deserialize();
     }
     ~IGBPQueueBufferRequestParcel() override = default;
 
     void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
+        SkipInterfaceToken();
         data = Read<Data>();
     }
 
@@ -444,13 +464,13 @@ private:
 
 class IGBPQueryRequestParcel : public Parcel {
 public:
-    explicit IGBPQueryRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
+    explicit IGBPQueryRequestParcel(Common::Span<const u8> buffer) : Parcel(buffer) {
         Deserialize();
     }
     ~IGBPQueryRequestParcel() override = default;
 
     void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
+        SkipInterfaceToken();
         type = Read<u32_le>();
     }
 
@@ -514,22 +534,25 @@ private:
         auto& buffer_queue = nv_flinger->FindBufferQueue(id);
 
         if (transaction == TransactionId::Connect) {
-            IGBPConnectRequestParcel request{ctx.ReadBuffer()};
+            const auto input = ctx.ReadBufferSpan();
+            IGBPConnectRequestParcel request{input};
             IGBPConnectResponseParcel response{
                 static_cast<u32>(static_cast<u32>(DisplayResolution::UndockedWidth) *
                                  Settings::values.resolution_factor),
                 static_cast<u32>(static_cast<u32>(DisplayResolution::UndockedHeight) *
                                  Settings::values.resolution_factor)};
-            ctx.WriteBuffer(response.Serialize());
+            WriteParcel(ctx, response);
         } else if (transaction == TransactionId::SetPreallocatedBuffer) {
-            IGBPSetPreallocatedBufferRequestParcel request{ctx.ReadBuffer()};
+            const auto input = ctx.ReadBufferSpan();
+            IGBPSetPreallocatedBufferRequestParcel request{input};
 
             buffer_queue.SetPreallocatedBuffer(request.data.slot, request.buffer);
 
             IGBPSetPreallocatedBufferResponseParcel response{};
-            ctx.WriteBuffer(response.Serialize());
+            WriteParcel(ctx, response);
         } else if (transaction == TransactionId::DequeueBuffer) {
-            IGBPDequeueBufferRequestParcel request{ctx.ReadBuffer()};
+            const auto input = ctx.ReadBufferSpan();
+            IGBPDequeueBufferRequestParcel request{input};
             const u32 width{request.data.width};
             const u32 height{request.data.height};
             auto result = buffer_queue.DequeueBuffer(width, height);
@@ -537,7 +560,7 @@ private:
             if (result) {
                 // Buffer is available
                 IGBPDequeueBufferResponseParcel response{result->first, *result->second};
-                ctx.WriteBuffer(response.Serialize());
+                WriteParcel(ctx, response);
             } else {
                 // Wait the current thread until a buffer becomes available
                 ctx.SleepClientThread(
@@ -550,44 +573,45 @@ private:
                         ASSERT_MSG(result != std::nullopt, "Could not dequeue buffer.");
 
                         IGBPDequeueBufferResponseParcel response{result->first, *result->second};
-                        ctx.WriteBuffer(response.Serialize());
+                        WriteParcel(ctx, response);
                         IPC::ResponseBuilder rb{ctx, 2};
                         rb.Push(RESULT_SUCCESS);
                     },
                     buffer_queue.GetWritableBufferWaitEvent());
             }
         } else if (transaction == TransactionId::RequestBuffer) {
-            IGBPRequestBufferRequestParcel request{ctx.ReadBuffer()};
+            const auto input = ctx.ReadBufferSpan();
+            IGBPRequestBufferRequestParcel request{input};
 
             auto& buffer = buffer_queue.RequestBuffer(request.slot);
 
             IGBPRequestBufferResponseParcel response{buffer};
-            ctx.WriteBuffer(response.Serialize());
+            WriteParcel(ctx, response);
         } else if (transaction == TransactionId::QueueBuffer) {
-            IGBPQueueBufferRequestParcel request{ctx.ReadBuffer()};
+            const auto input = ctx.ReadBufferSpan();
+            IGBPQueueBufferRequestParcel request{input};
 
             buffer_queue.QueueBuffer(request.data.slot, request.data.transform,
                                      request.data.GetCropRect(), request.data.swap_interval,
                                      request.data.multi_fence);
 
             IGBPQueueBufferResponseParcel response{1280, 720};
-            ctx.WriteBuffer(response.Serialize());
+            WriteParcel(ctx, response);
         } else if (transaction == TransactionId::Query) {
-            IGBPQueryRequestParcel request{ctx.ReadBuffer()};
+            const auto input = ctx.ReadBufferSpan();
+            IGBPQueryRequestParcel request{input};
 
             const u32 value =
                 buffer_queue.Query(static_cast<NVFlinger::BufferQueue::QueryType>(request.type));
 
             IGBPQueryResponseParcel response{value};
-            ctx.WriteBuffer(response.Serialize());
+            WriteParcel(ctx, response);
         } else if (transaction == TransactionId::CancelBuffer) {
             LOG_CRITICAL(Service_VI, "(STUBBED) called, transaction=CancelBuffer");
         } else if (transaction == TransactionId::Disconnect ||
                    transaction == TransactionId::DetachBuffer) {
-            const auto buffer = ctx.ReadBuffer();
-
             IGBPEmptyResponseParcel response{};
-            ctx.WriteBuffer(response.Serialize());
+            WriteParcel(ctx, response);
         } else {
             ASSERT_MSG(false, "Unimplemented");
         }
@@ -1057,7 +1081,7 @@ private:
         NativeWindow native_window{*buffer_queue_id};
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
-        rb.Push<u64>(ctx.WriteBuffer(native_window.Serialize()));
+        rb.Push<u64>(WriteParcel(ctx, native_window));
     }
 
     void CreateStrayLayer(Kernel::HLERequestContext& ctx) {
@@ -1088,7 +1112,7 @@ private:
         IPC::ResponseBuilder rb{ctx, 6};
         rb.Push(RESULT_SUCCESS);
         rb.Push(*layer_id);
-        rb.Push<u64>(ctx.WriteBuffer(native_window.Serialize()));
+        rb.Push<u64>(WriteParcel(ctx, native_window));
     }
 
     void DestroyStrayLayer(Kernel::HLERequestContext& ctx) {
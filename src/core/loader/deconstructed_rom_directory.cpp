@@ -144,27 +144,31 @@ AppLoader_DeconstructedRomDirectory::LoadResult AppLoader_DeconstructedRomDirect
     // Load NSO modules
     modules.clear();
     const VAddr base_address = process.VMManager().GetCodeRegionBaseAddress();
-    VAddr next_load_addr = base_address;
+    std::vector<const char*> module_names;
+    std::vector<AppLoader_NSO::ModuleFile> module_files;
     for (const auto& module : {"rtld", "main", "subsdk0", "subsdk1", "subsdk2", "subsdk3",
                                "subsdk4", "subsdk5", "subsdk6", "subsdk7", "sdk"}) {
-        const FileSys::VirtualFile module_file = dir->GetFile(module);
+        FileSys::VirtualFile module_file = dir->GetFile(module);
         if (module_file == nullptr) {
             continue;
         }
 
-        const VAddr load_addr = next_load_addr;
         const bool should_pass_arguments = std::strcmp(module, "rtld") == 0;
-        const auto tentative_next_load_addr =
-            AppLoader_NSO::LoadModule(process, *module_file, load_addr, should_pass_arguments, pm);
-        if (!tentative_next_load_addr) {
-            return {ResultStatus::ErrorLoadingNSO, {}};
-        }
+        module_names.push_back(module);
+        module_files.push_back({std::move(module_file), should_pass_arguments});
+    }
 
-        next_load_addr = *tentative_next_load_addr;
-        modules.insert_or_assign(load_addr, module);
-        LOG_DEBUG(Loader, "loaded module {} @ 0x{:X}", module, load_addr);
+    const auto load_addresses = AppLoader_NSO::LoadModules(process, module_files, base_address, pm);
+    if (!load_addresses) {
+        return {ResultStatus::ErrorLoadingNSO, {}};
+    }
+    for (std::size_t i = 0; i < module_names.size(); ++i) {
+        const VAddr load_addr = (*load_addresses)[i];
+        const VAddr next_load_addr = (*load_addresses)[i + 1];
+        modules.insert_or_assign(load_addr, module_names[i]);
+        LOG_DEBUG(Loader, "loaded module {} @ 0x{:X}", module_names[i], load_addr);
         // Register module with GDBStub
-        GDBStub::RegisterModule(module, load_addr, next_load_addr - 1, false);
+        GDBStub::RegisterModule(module_names[i], load_addr, next_load_addr - 1, false);
     }
 
     // Find the RomFS by searching for a ".romfs" file in this directory
@@ -61,9 +61,9 @@ FileType GuessFromFilename(const std::string& name) {
         return FileType::NSO;
     if (extension == "nca")
         return FileType::NCA;
-    if (extension == "xci")
+    if (extension == "xci" || extension == "xcz")
         return FileType::XCI;
-    if (extension == "nsp")
+    if (extension == "nsp" || extension == "nsz")
         return FileType::NSP;
     if (extension == "kip")
         return FileType::KIP;
@@ -2,7 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
+#include <cstring>
+#include <utility>
 #include <vector>
 
 #include "common/common_funcs.h"
@@ -11,9 +16,11 @@
 #include "common/logging/log.h"
 #include "common/lz4_compression.h"
 #include "common/swap.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/function_hooks.h"
 #include "core/hle/kernel/code_set.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/vm_manager.h"
@@ -34,76 +41,132 @@ struct MODHeader {
 };
 static_assert(sizeof(MODHeader) == 0x1c, "MODHeader has incorrect size.");
 
-std::vector<u8> DecompressSegment(const std::vector<u8>& compressed_data,
-                                  const NSOSegmentHeader& header) {
-    const std::vector<u8> uncompressed_data =
-        Common::Compression::DecompressDataLZ4(compressed_data, header.size);
-
-    ASSERT_MSG(uncompressed_data.size() == header.size, "{} != {}", header.size,
-               uncompressed_data.size());
-
-    return uncompressed_data;
-}
+/// NSO read from its file, its segments still have to be decompressed into the program image
+struct PendingModule {
+    const FileSys::VfsFile* file{};
+    NSOHeader header{};
+    bool should_pass_arguments{};
+    std::array<const u8*, 3> segment_data{};
+    /// Segment data read from the file, when it can't be accessed in place
+    std::array<std::vector<u8>, 3> segment_buffers;
+    Kernel::PhysicalMemory program_image;
+};
 
 constexpr u32 PageAlignSize(u32 size) {
     return (size + Memory::PAGE_MASK) & ~Memory::PAGE_MASK;
 }
-} // Anonymous namespace
-
-bool NSOHeader::IsSegmentCompressed(size_t segment_num) const {
-    ASSERT_MSG(segment_num < 3, "Invalid segment {}", segment_num);
-    return ((flags >> segment_num) & 1) != 0;
-}
 
-AppLoader_NSO::AppLoader_NSO(FileSys::VirtualFile file) : AppLoader(std::move(file)) {}
+std::optional<PendingModule> ReadModule(const FileSys::VfsFile& file, bool should_pass_arguments) {
+    if (file.GetSize() < sizeof(NSOHeader)) {
+        return {};
+    }
 
-FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& file) {
-    u32 magic = 0;
-    if (file->ReadObject(&magic) != sizeof(magic)) {
-        return FileType::Error;
+    PendingModule module;
+    module.file = &file;
+    module.should_pass_arguments = should_pass_arguments;
+    NSOHeader& header = module.header;
+    if (sizeof(NSOHeader) != file.ReadObject(&header)) {
+        return {};
     }
 
-    if (Common::MakeMagic('N', 'S', 'O', '0') != magic) {
-        return FileType::Error;
+    if (header.magic != Common::MakeMagic('N', 'S', 'O', '0')) {
+        return {};
     }
 
-    return FileType::NSO;
+    std::size_t image_size = 0;
+    for (std::size_t i = 0; i < header.segments.size(); ++i) {
+        const NSOSegmentHeader& segment = header.segments[i];
+        if (segment.location < image_size) {
+            LOG_ERROR(Loader, "Segment {} of {} overlaps the previous one", i, file.GetName());
+            return {};
+        }
+        image_size = std::size_t{segment.location} + segment.size;
+
+        const std::size_t compressed_size = header.segments_compressed_size[i];
+        module.segment_data[i] = file.GetPointer(compressed_size, segment.offset);
+        if (module.segment_data[i] == nullptr) {
+            module.segment_buffers[i] = file.ReadBytes(compressed_size, segment.offset);
+            if (module.segment_buffers[i].size() != compressed_size) {
+                LOG_ERROR(Loader, "Segment {} of {} is truncated", i, file.GetName());
+                return {};
+            }
+            module.segment_data[i] = module.segment_buffers[i].data();
+        }
+    }
+    module.program_image.resize(image_size);
+    return module;
 }
 
-std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
-                                               const FileSys::VfsFile& file, VAddr load_base,
-                                               bool should_pass_arguments,
-                                               std::optional<FileSys::PatchManager> pm) {
-    if (file.GetSize() < sizeof(NSOHeader)) {
-        return {};
+bool DecompressSegment(PendingModule& module, std::size_t segment_num) {
+    const NSOSegmentHeader& segment = module.header.segments[segment_num];
+    const std::size_t compressed_size = module.header.segments_compressed_size[segment_num];
+    u8* const destination = module.program_image.data() + segment.location;
+    if (!module.header.IsSegmentCompressed(segment_num)) {
+        const std::size_t size = std::min<std::size_t>(compressed_size, segment.size);
+        if (size != 0) {
+            std::memcpy(destination, module.segment_data[segment_num], size);
+        }
+        return true;
     }
-
-    NSOHeader nso_header{};
-    if (sizeof(NSOHeader) != file.ReadObject(&nso_header)) {
-        return {};
+    if (!Common::Compression::DecompressDataLZ4(module.segment_data[segment_num],
+                                                compressed_size, destination, segment.size)) {
+        LOG_ERROR(Loader, "Failed to decompress segment {} of {}", segment_num,
+                  module.file->GetName());
+        return false;
     }
+    return true;
+}
 
-    if (nso_header.magic != Common::MakeMagic('N', 'S', 'O', '0')) {
-        return {};
+/// Decompresses the segments of every module on a pool of threads, largest segments first
+bool DecompressModules(std::vector<PendingModule>& modules) {
+    std::vector<std::pair<std::size_t, std::size_t>> segments;
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        for (std::size_t segment = 0; segment < modules[i].header.segments.size(); ++segment) {
+            segments.emplace_back(i, segment);
+        }
     }
+    std::sort(segments.begin(), segments.end(), [&modules](const auto& lhs, const auto& rhs) {
+        return modules[lhs.first].header.segments[lhs.second].size >
+               modules[rhs.first].header.segments[rhs.second].size;
+    });
+
+    std::atomic<std::size_t> next_segment{0};
+    std::atomic<bool> success{true};
+    const auto worker = [&] {
+        for (std::size_t i = next_segment++; i < segments.size(); i = next_segment++) {
+            const auto [module, segment] = segments[i];
+            if (!DecompressSegment(modules[module], segment)) {
+                success = false;
+            }
+        }
+    };
+    auto& pool = Common::GetThreadPool();
+    const std::size_t num_threads =
+        std::clamp<std::size_t>(pool.GetNumWorkers() + 1, 1, segments.size());
+    Common::TaskGroup group{pool};
+    for (std::size_t i = 1; i < num_threads; ++i) {
+        group.Submit(worker, Common::TaskPriority::High);
+    }
+    worker();
+    group.Wait();
+    return success;
+}
+
+/// Lays out the rest of a decompressed module and maps it, returns the end of the module
+VAddr MapModule(Kernel::Process& process, PendingModule&& module, VAddr load_base,
+                const std::optional<FileSys::PatchManager>& pm) {
+    NSOHeader& nso_header = module.header;
+    const FileSys::VfsFile& file = *module.file;
+    Kernel::PhysicalMemory& program_image = module.program_image;
 
-    // Build program image
     Kernel::CodeSet codeset;
-    Kernel::PhysicalMemory program_image;
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
-        std::vector<u8> data =
-            file.ReadBytes(nso_header.segments_compressed_size[i], nso_header.segments[i].offset);
-        if (nso_header.IsSegmentCompressed(i)) {
-            data = DecompressSegment(data, nso_header.segments[i]);
-        }
-        program_image.resize(nso_header.segments[i].location);
-        program_image.insert(program_image.end(), data.begin(), data.end());
         codeset.segments[i].addr = nso_header.segments[i].location;
         codeset.segments[i].offset = nso_header.segments[i].location;
-        codeset.segments[i].size = PageAlignSize(static_cast<u32>(data.size()));
+        codeset.segments[i].size = PageAlignSize(nso_header.segments[i].size);
     }
 
-    if (should_pass_arguments && !Settings::values.program_args.empty()) {
+    if (module.should_pass_arguments && !Settings::values.program_args.empty()) {
         const auto arg_data = Settings::values.program_args;
         codeset.DataSegment().size += NSO_ARGUMENT_DATA_ALLOCATION_SIZE;
         NSOArgumentHeader args_header{
@@ -157,6 +220,16 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
         }
     }
 
+    if (Settings::values.use_native_libc_functions) {
+        const auto& text = nso_header.segments[0];
+        const std::size_t num_hooked =
+            HLE::InstallFunctionHooks(program_image, text.location, text.size);
+        if (num_hooked != 0) {
+            LOG_INFO(Loader, "Replaced {} libc functions of {} with native ones", num_hooked,
+                     file.GetName());
+        }
+    }
+
     // Load codeset for current process
     codeset.memory = std::move(program_image);
     process.LoadModule(std::move(codeset), load_base);
@@ -167,6 +240,86 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
     return load_base + image_size;
 }
 
+s64 ElapsedMilliseconds(std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+} // Anonymous namespace
+
+bool NSOHeader::IsSegmentCompressed(size_t segment_num) const {
+    ASSERT_MSG(segment_num < 3, "Invalid segment {}", segment_num);
+    return ((flags >> segment_num) & 1) != 0;
+}
+
+AppLoader_NSO::AppLoader_NSO(FileSys::VirtualFile file) : AppLoader(std::move(file)) {}
+
+FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& file) {
+    u32 magic = 0;
+    if (file->ReadObject(&magic) != sizeof(magic)) {
+        return FileType::Error;
+    }
+
+    if (Common::MakeMagic('N', 'S', 'O', '0') != magic) {
+        return FileType::Error;
+    }
+
+    return FileType::NSO;
+}
+
+std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
+                                               const FileSys::VfsFile& file, VAddr load_base,
+                                               bool should_pass_arguments,
+                                               std::optional<FileSys::PatchManager> pm) {
+    std::vector<PendingModule> modules;
+    auto module = ReadModule(file, should_pass_arguments);
+    if (!module) {
+        return {};
+    }
+    modules.push_back(std::move(*module));
+    if (!DecompressModules(modules)) {
+        return {};
+    }
+    return MapModule(process, std::move(modules.front()), load_base, pm);
+}
+
+std::optional<std::vector<VAddr>> AppLoader_NSO::LoadModules(
+    Kernel::Process& process, const std::vector<ModuleFile>& files, VAddr load_base,
+    std::optional<FileSys::PatchManager> pm) {
+    using Clock = std::chrono::steady_clock;
+    const auto start_time = Clock::now();
+
+    // Reads stay on this thread, decryption layers of the underlying files aren't thread safe
+    std::vector<PendingModule> modules;
+    modules.reserve(files.size());
+    for (const ModuleFile& module_file : files) {
+        auto module = ReadModule(*module_file.file, module_file.should_pass_arguments);
+        if (!module) {
+            return {};
+        }
+        modules.push_back(std::move(*module));
+    }
+    const auto read_time = Clock::now();
+
+    if (!DecompressModules(modules)) {
+        return {};
+    }
+    const auto decompress_time = Clock::now();
+
+    std::vector<VAddr> addresses{load_base};
+    for (PendingModule& module : modules) {
+        addresses.push_back(MapModule(process, std::move(module), addresses.back(), pm));
+    }
+    const auto end_time = Clock::now();
+
+    LOG_INFO(Loader,
+             "Loaded {} NSO modules in {} ms: read {} ms, decompress {} ms, patch and map {} ms",
+             modules.size(), ElapsedMilliseconds(start_time, end_time),
+             ElapsedMilliseconds(start_time, read_time),
+             ElapsedMilliseconds(read_time, decompress_time),
+             ElapsedMilliseconds(decompress_time, end_time));
+    return addresses;
+}
+
 AppLoader_NSO::LoadResult AppLoader_NSO::Load(Kernel::Process& process) {
     if (is_loaded) {
         return {ResultStatus::ErrorAlreadyLoaded, {}};
@@ -7,6 +7,7 @@
 #include <array>
 #include <optional>
 #include <type_traits>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/patch_manager.h"
@@ -80,10 +81,27 @@ public:
         return IdentifyType(file);
     }
 
+    /// NSO file loaded by LoadModules
+    struct ModuleFile {
+        FileSys::VirtualFile file;
+        bool should_pass_arguments;
+    };
+
     static std::optional<VAddr> LoadModule(Kernel::Process& process, const FileSys::VfsFile& file,
                                            VAddr load_base, bool should_pass_arguments,
                                            std::optional<FileSys::PatchManager> pm = {});
 
+    /**
+     * Loads NSOs next to each other, starting at load_base. The files are read on the calling
+     * thread, then the segments of every module are decompressed in parallel straight into their
+     * program images.
+     * @returns The load address of every module followed by the end of the last one, or nullopt
+     * when a module couldn't be loaded
+     */
+    static std::optional<std::vector<VAddr>> LoadModules(
+        Kernel::Process& process, const std::vector<ModuleFile>& files, VAddr load_base,
+        std::optional<FileSys::PatchManager> pm = {});
+
     LoadResult Load(Kernel::Process& process) override;
 
     ResultStatus ReadNSOModules(Modules& modules) override;
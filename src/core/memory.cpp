@@ -248,6 +248,35 @@ u8* GetPointer(const VAddr vaddr) {
     return nullptr;
 }
 
+u8* GetContiguousPointer(const Kernel::Process& process, const VAddr vaddr,
+                         const std::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    const auto& page_table = process.VMManager().page_table;
+    const std::size_t first_page = vaddr >> PAGE_BITS;
+    const std::size_t last_page = (vaddr + size - 1) >> PAGE_BITS;
+
+    // A non-null pointer already implies the page is regular memory.
+    u8* const base_pointer = page_table.pointers[first_page];
+    if (base_pointer == nullptr) {
+        return nullptr;
+    }
+
+    for (std::size_t page = first_page + 1; page <= last_page; ++page) {
+        if (page_table.pointers[page] != base_pointer + (page - first_page) * PAGE_SIZE) {
+            return nullptr;
+        }
+    }
+
+    return base_pointer + (vaddr & PAGE_MASK);
+}
+
+u8* GetContiguousPointer(const VAddr vaddr, const std::size_t size) {
+    return GetContiguousPointer(*Core::CurrentProcess(), vaddr, size);
+}
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
@@ -341,49 +370,95 @@ u64 Read64(const VAddr addr) {
     return Read<u64_le>(addr);
 }
 
-void ReadBlock(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
-               const std::size_t size) {
+namespace {
+
+/// A run of consecutive guest pages of one type whose host memory is contiguous as well.
+struct PageRun {
+    Common::PageType type;
+    VAddr vaddr;
+    u8* host_ptr;
+    std::size_t size;
+};
+
+/**
+ * Splits a guest memory range into runs of pages that can each be handled with a single host
+ * operation, and invokes the given function on every run in address order.
+ */
+template <typename Func>
+void WalkBlock(const Kernel::Process& process, const VAddr addr, const std::size_t size,
+               Func&& func) {
     const auto& page_table = process.VMManager().page_table;
 
+    const auto resolve = [&](std::size_t page_index) -> std::pair<Common::PageType, u8*> {
+        u8* const page_pointer = page_table.pointers[page_index];
+        if (page_pointer != nullptr) {
+            return {Common::PageType::Memory, page_pointer};
+        }
+
+        const Common::PageType type = page_table.attributes[page_index];
+        if (type == Common::PageType::RasterizerCachedMemory) {
+            return {type, GetPointerFromVMA(process, static_cast<VAddr>(page_index << PAGE_BITS))};
+        }
+        return {type, nullptr};
+    };
+
     std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
+    std::size_t page_index = addr >> PAGE_BITS;
+    std::size_t page_offset = addr & PAGE_MASK;
+    VAddr current_vaddr = addr;
+    auto next_page = resolve(page_index);
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+        const auto [type, page_pointer] = next_page;
+        PageRun run{type, current_vaddr, page_pointer ? page_pointer + page_offset : nullptr,
+                    std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size)};
+
+        while (run.size < remaining_size) {
+            next_page = resolve(++page_index);
+            const bool contiguous =
+                run.host_ptr == nullptr || next_page.second == run.host_ptr + run.size;
+            if (next_page.first != run.type || !contiguous) {
+                break;
+            }
+            run.size += std::min(static_cast<std::size_t>(PAGE_SIZE), remaining_size - run.size);
+        }
 
-        switch (page_table.attributes[page_index]) {
+        func(run);
+
+        page_offset = 0;
+        current_vaddr += static_cast<VAddr>(run.size);
+        remaining_size -= run.size;
+    }
+}
+
+} // Anonymous namespace
+
+void ReadBlock(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
+               const std::size_t size) {
+    WalkBlock(process, src_addr, size, [&](const PageRun& run) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped ReadBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, src_addr, size);
-            std::memset(dest_buffer, 0, copy_amount);
+                      run.vaddr, src_addr, size);
+            std::memset(dest_buffer, 0, run.size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_buffer, src_ptr, copy_amount);
+            std::memcpy(dest_buffer, run.host_ptr, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().FlushRegion(ToCacheAddr(host_ptr), copy_amount);
-            std::memcpy(dest_buffer, host_ptr, copy_amount);
+            Core::System::GetInstance().GPU().FlushRegion(ToCacheAddr(run.host_ptr), run.size);
+            std::memcpy(dest_buffer, run.host_ptr, run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-        remaining_size -= copy_amount;
-    }
+        dest_buffer = static_cast<u8*>(dest_buffer) + run.size;
+    });
 }
 
 void ReadBlock(const VAddr src_addr, void* dest_buffer, const std::size_t size) {
@@ -408,45 +483,30 @@ void Write64(const VAddr addr, const u64 data) {
 
 void WriteBlock(const Kernel::Process& process, const VAddr dest_addr, const void* src_buffer,
                 const std::size_t size) {
-    const auto& page_table = process.VMManager().page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
+    WalkBlock(process, dest_addr, size, [&](const PageRun& run) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped WriteBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, dest_addr, size);
+                      run.vaddr, dest_addr, size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_ptr, src_buffer, copy_amount);
+            std::memcpy(run.host_ptr, src_buffer, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().InvalidateRegion(ToCacheAddr(host_ptr), copy_amount);
-            std::memcpy(host_ptr, src_buffer, copy_amount);
+            Core::System::GetInstance().GPU().InvalidateRegion(ToCacheAddr(run.host_ptr),
+                                                               run.size);
+            std::memcpy(run.host_ptr, src_buffer, run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-        remaining_size -= copy_amount;
-    }
+        src_buffer = static_cast<const u8*>(src_buffer) + run.size;
+    });
 }
 
 void WriteBlock(const VAddr dest_addr, const void* src_buffer, const std::size_t size) {
@@ -454,88 +514,56 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const std::size_t
 }
 
 void ZeroBlock(const Kernel::Process& process, const VAddr dest_addr, const std::size_t size) {
-    const auto& page_table = process.VMManager().page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
+    WalkBlock(process, dest_addr, size, [&](const PageRun& run) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped ZeroBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, dest_addr, size);
+                      run.vaddr, dest_addr, size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memset(dest_ptr, 0, copy_amount);
+            std::memset(run.host_ptr, 0, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().InvalidateRegion(ToCacheAddr(host_ptr), copy_amount);
-            std::memset(host_ptr, 0, copy_amount);
+            Core::System::GetInstance().GPU().InvalidateRegion(ToCacheAddr(run.host_ptr),
+                                                               run.size);
+            std::memset(run.host_ptr, 0, run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
-
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
-    }
+    });
 }
 
 void CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
                const std::size_t size) {
-    const auto& page_table = process.VMManager().page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
+    WalkBlock(process, src_addr, size, [&](const PageRun& run) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped CopyBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, src_addr, size);
-            ZeroBlock(process, dest_addr, copy_amount);
+                      run.vaddr, src_addr, size);
+            ZeroBlock(process, dest_addr, run.size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            WriteBlock(process, dest_addr, src_ptr, copy_amount);
+            WriteBlock(process, dest_addr, run.host_ptr, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().FlushRegion(ToCacheAddr(host_ptr), copy_amount);
-            WriteBlock(process, dest_addr, host_ptr, copy_amount);
+            Core::System::GetInstance().GPU().FlushRegion(ToCacheAddr(run.host_ptr), run.size);
+            WriteBlock(process, dest_addr, run.host_ptr, run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
-    }
+        dest_addr += static_cast<VAddr>(run.size);
+    });
 }
 
 void CopyBlock(VAddr dest_addr, VAddr src_addr, std::size_t size) {
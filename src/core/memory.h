@@ -66,6 +66,16 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, std::size_t size);
 
 u8* GetPointer(VAddr vaddr);
 
+/**
+ * Gets a host pointer to a whole range of guest memory. This only succeeds if every page in the
+ * range is regular memory and the pages are contiguous in host memory as well.
+ *
+ * @returns The host pointer to the start of the range, or nullptr if the range can't be accessed
+ *          through a single pointer.
+ */
+u8* GetContiguousPointer(const Kernel::Process& process, VAddr vaddr, std::size_t size);
+u8* GetContiguousPointer(VAddr vaddr, std::size_t size);
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length);
 
 /**
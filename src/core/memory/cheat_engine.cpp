@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <locale>
 #include "common/hex_util.h"
 #include "common/microprofile.h"
@@ -31,7 +32,19 @@ void StandardVmCallbacks::MemoryRead(VAddr address, void* data, u64 size) {
 }
 
 void StandardVmCallbacks::MemoryWrite(VAddr address, const void* data, u64 size) {
-    WriteBlock(SanitizeAddress(address), data, size);
+    const VAddr sanitized = SanitizeAddress(address);
+
+    // Most cheats freeze a value that the game rarely touches, rewriting it every frame would
+    // needlessly invalidate any GPU caches over the page. Only write values that changed.
+    if (size <= sizeof(u64)) {
+        u64 current_value{};
+        ReadBlock(sanitized, &current_value, size);
+        if (std::memcmp(&current_value, data, size) == 0) {
+            return;
+        }
+    }
+
+    WriteBlock(sanitized, data, size);
 }
 
 u64 StandardVmCallbacks::HidKeysDown() {
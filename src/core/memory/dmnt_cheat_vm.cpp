@@ -605,26 +605,11 @@ bool DmntCheatVm::DecodeNextOpcode(CheatVmOpcode& out) {
     return valid;
 }
 
-void DmntCheatVm::SkipConditionalBlock() {
+void DmntCheatVm::SkipConditionalBlock(std::size_t begin_index) {
     if (condition_depth > 0) {
-        // We want to continue until we're out of the current block.
-        const std::size_t desired_depth = condition_depth - 1;
-
-        CheatVmOpcode skip_opcode{};
-        while (condition_depth > desired_depth && DecodeNextOpcode(skip_opcode)) {
-            // Decode instructions until we see end of the current conditional block.
-            // NOTE: This is broken in gateway's implementation.
-            // Gateway currently checks for "0x2" instead of "0x20000000"
-            // In addition, they do a linear scan instead of correctly decoding opcodes.
-            // This causes issues if "0x2" appears as an immediate in the conditional block...
-
-            // We also support nesting of conditional blocks, and Gateway does not.
-            if (skip_opcode.begin_conditional_block) {
-                condition_depth++;
-            } else if (std::holds_alternative<EndConditionalOpcode>(skip_opcode.opcode)) {
-                condition_depth--;
-            }
-        }
+        // The end of the block was resolved when the program was compiled, jump right past it.
+        instruction_ptr = block_ends[begin_index];
+        condition_depth--;
     } else {
         // Skipping, but condition_depth = 0.
         // This is an error condition.
@@ -635,6 +620,39 @@ void DmntCheatVm::SkipConditionalBlock() {
     }
 }
 
+void DmntCheatVm::CompileProgram() {
+    compiled_program.clear();
+    block_ends.clear();
+
+    // Decode the whole program once, execution stops at the first opcode that fails to decode so
+    // nothing past it is kept.
+    instruction_ptr = 0;
+    decode_success = true;
+    CheatVmOpcode opcode{};
+    while (DecodeNextOpcode(opcode)) {
+        compiled_program.push_back(opcode);
+    }
+
+    // Match every conditional block with its end.
+    // NOTE: This is broken in gateway's implementation.
+    // Gateway currently checks for "0x2" instead of "0x20000000"
+    // In addition, they do a linear scan instead of correctly decoding opcodes.
+    // This causes issues if "0x2" appears as an immediate in the conditional block...
+    // We also support nesting of conditional blocks, and Gateway does not.
+    // Blocks left open skip to the end of the program.
+    block_ends.assign(compiled_program.size(), compiled_program.size());
+    std::vector<std::size_t> open_blocks;
+    for (std::size_t i = 0; i < compiled_program.size(); i++) {
+        if (compiled_program[i].begin_conditional_block) {
+            open_blocks.push_back(i);
+        } else if (std::holds_alternative<EndConditionalOpcode>(compiled_program[i].opcode) &&
+                   !open_blocks.empty()) {
+            block_ends[open_blocks.back()] = i + 1;
+            open_blocks.pop_back();
+        }
+    }
+}
+
 u64 DmntCheatVm::GetVmInt(VmInt value, u32 bit_width) {
     switch (bit_width) {
     case 1:
@@ -668,7 +686,6 @@ void DmntCheatVm::ResetState() {
     loop_tops.fill(0);
     instruction_ptr = 0;
     condition_depth = 0;
-    decode_success = true;
 }
 
 bool DmntCheatVm::LoadProgram(const std::vector<CheatEntry>& entries) {
@@ -680,6 +697,7 @@ bool DmntCheatVm::LoadProgram(const std::vector<CheatEntry>& entries) {
             // Bounds check.
             if (entries[i].definition.num_opcodes + num_opcodes > MaximumProgramOpcodeCount) {
                 num_opcodes = 0;
+                CompileProgram();
                 return false;
             }
 
@@ -689,27 +707,31 @@ bool DmntCheatVm::LoadProgram(const std::vector<CheatEntry>& entries) {
         }
     }
 
+    CompileProgram();
     return true;
 }
 
 void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
-    CheatVmOpcode cur_opcode{};
-
     // Get Keys down.
     u64 kDown = callbacks->HidKeysDown();
 
+#ifdef DMNT_CHEAT_VM_DEBUG_LOG
     callbacks->CommandLog("Started VM execution.");
     callbacks->CommandLog(fmt::format("Main NSO:  {:012X}", metadata.main_nso_extents.base));
     callbacks->CommandLog(fmt::format("Heap:      {:012X}", metadata.main_nso_extents.base));
     callbacks->CommandLog(fmt::format("Keys Down: {:08X}", static_cast<u32>(kDown & 0x0FFFFFFF)));
+#endif
 
     // Clear VM state.
     ResetState();
 
     // Loop until program finishes.
-    while (DecodeNextOpcode(cur_opcode)) {
-        callbacks->CommandLog(
-            fmt::format("Instruction Ptr: {:04X}", static_cast<u32>(instruction_ptr)));
+    while (instruction_ptr < compiled_program.size()) {
+        const std::size_t cur_index = instruction_ptr++;
+        const CheatVmOpcode& cur_opcode = compiled_program[cur_index];
+
+#ifdef DMNT_CHEAT_VM_DEBUG_LOG
+        callbacks->CommandLog(fmt::format("Instruction Ptr: {:04X}", static_cast<u32>(cur_index)));
 
         for (std::size_t i = 0; i < NumRegisters; i++) {
             callbacks->CommandLog(fmt::format("Registers[{:02X}]: {:016X}", i, registers[i]));
@@ -719,6 +741,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             callbacks->CommandLog(fmt::format("SavedRegs[{:02X}]: {:016X}", i, saved_values[i]));
         }
         LogOpcode(cur_opcode);
+#endif
 
         // Increment conditional depth, if relevant.
         if (cur_opcode.begin_conditional_block) {
@@ -744,7 +767,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             u64 src_address =
                 GetCheatProcessAddress(metadata, begin_cond->mem_type, begin_cond->rel_address);
             u64 src_value = 0;
-            switch (store_static->bit_width) {
+            switch (begin_cond->bit_width) {
             case 1:
             case 2:
             case 4:
@@ -777,7 +800,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             }
             // Skip conditional block if condition not met.
             if (!cond_met) {
-                SkipConditionalBlock();
+                SkipConditionalBlock(cur_index);
             }
         } else if (auto end_cond = std::get_if<EndConditionalOpcode>(&cur_opcode.opcode)) {
             // Decrement the condition depth.
@@ -891,7 +914,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             // Check for keypress.
             if ((begin_keypress_cond->key_mask & kDown) != begin_keypress_cond->key_mask) {
                 // Keys not pressed. Skip conditional block.
-                SkipConditionalBlock();
+                SkipConditionalBlock(cur_index);
             }
         } else if (auto perform_math_reg =
                        std::get_if<PerformArithmeticRegisterOpcode>(&cur_opcode.opcode)) {
@@ -1099,7 +1122,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
 
             // Skip conditional block if condition not met.
             if (!cond_met) {
-                SkipConditionalBlock();
+                SkipConditionalBlock(cur_index);
             }
         } else if (auto save_restore_reg =
                        std::get_if<SaveRestoreRegisterOpcode>(&cur_opcode.opcode)) {
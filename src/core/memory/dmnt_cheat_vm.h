@@ -304,8 +304,14 @@ private:
     std::array<u64, NumRegisters> saved_values{};
     std::array<std::size_t, NumRegisters> loop_tops{};
 
+    // Program decoded once on load, instruction_ptr and loop_tops index into it while executing.
+    std::vector<CheatVmOpcode> compiled_program;
+    // For each opcode starting a conditional block, the index right after its matching end.
+    std::vector<std::size_t> block_ends;
+
     bool DecodeNextOpcode(CheatVmOpcode& out);
-    void SkipConditionalBlock();
+    void CompileProgram();
+    void SkipConditionalBlock(std::size_t begin_index);
     void ResetState();
 
     // For implementing the DebugLog opcode.
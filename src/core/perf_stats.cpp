@@ -9,6 +9,7 @@
 #include <numeric>
 #include <sstream>
 #include <thread>
+#include <vector>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
@@ -25,8 +26,25 @@ using std::chrono::microseconds;
 // booting that we shouldn't account for
 constexpr std::size_t IgnoreFrames = 5;
 
+// Bounds of the spin the frame limiter does after sleeping. The upper bound keeps a badly
+// overshooting scheduler from turning the whole wait into a spin.
+constexpr auto MinSpinMargin = 100us;
+constexpr auto MaxSpinMargin = 5ms;
+
 namespace Core {
 
+namespace {
+
+/// Returns the value at the given fraction of the distribution, reordering the values.
+double Percentile(std::vector<double>& values, double fraction) {
+    const auto index = fraction * static_cast<double>(values.size() - 1);
+    const auto nth = values.begin() + static_cast<std::ptrdiff_t>(index);
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+} // Anonymous namespace
+
 PerfStats::PerfStats(u64 title_id) : title_id(title_id) {}
 
 PerfStats::~PerfStats() {
@@ -63,6 +81,7 @@ void PerfStats::EndSystemFrame() {
     }
     accumulated_frametime += frame_time;
     system_frames += 1;
+    total_system_frames += 1;
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
@@ -81,10 +100,82 @@ double PerfStats::GetMeanFrametime() {
         return 0;
     }
     const double sum = std::accumulate(perf_history.begin() + IgnoreFrames,
-                                       perf_history.begin() + current_index, 0);
+                                       perf_history.begin() + current_index, 0.0);
     return sum / (current_index - IgnoreFrames);
 }
 
+FrametimeHistogram PerfStats::GetFrametimeHistogram() {
+    std::vector<double> frametimes;
+    {
+        std::lock_guard lock{object_mutex};
+        if (current_index <= IgnoreFrames) {
+            return {};
+        }
+        frametimes.assign(perf_history.begin() + IgnoreFrames,
+                          perf_history.begin() + current_index);
+    }
+
+    FrametimeHistogram histogram;
+    const auto& limits = FrametimeHistogram::BucketLimits;
+    for (const double frametime : frametimes) {
+        const auto bucket = std::lower_bound(limits.begin(), limits.end(), frametime);
+        ++histogram.buckets[static_cast<std::size_t>(bucket - limits.begin())];
+    }
+
+    histogram.p50 = Percentile(frametimes, 0.50);
+    histogram.p95 = Percentile(frametimes, 0.95);
+    histogram.p99 = Percentile(frametimes, 0.99);
+    histogram.max = *std::max_element(frametimes.begin(), frametimes.end());
+    return histogram;
+}
+
+void PerfStats::AddFramePacingError(microseconds lateness) {
+    std::lock_guard lock{object_mutex};
+
+    if (pacing_history.size() < perf_history.size()) {
+        pacing_history.push_back(std::chrono::duration<double, std::milli>(lateness).count());
+    }
+}
+
+FramePacingSummary PerfStats::GetFramePacingSummary() {
+    std::vector<double> errors;
+    {
+        std::lock_guard lock{object_mutex};
+        if (pacing_history.empty()) {
+            return {};
+        }
+        errors = pacing_history;
+    }
+
+    FramePacingSummary summary;
+    summary.p50 = Percentile(errors, 0.50);
+    summary.p95 = Percentile(errors, 0.95);
+    summary.p99 = Percentile(errors, 0.99);
+    summary.max = *std::max_element(errors.begin(), errors.end());
+    summary.num_samples = errors.size();
+    return summary;
+}
+
+EmulationSpeedSummary PerfStats::GetEmulationSpeedSummary() {
+    std::lock_guard lock{object_mutex};
+
+    EmulationSpeedSummary summary;
+    if (emulation_speed_samples == 0) {
+        return summary;
+    }
+    summary.mean = session_system_us.count() / 1'000'000.0 / session_walltime.count();
+    summary.min = min_emulation_speed;
+    summary.max = max_emulation_speed;
+    summary.num_samples = emulation_speed_samples;
+    return summary;
+}
+
+u64 PerfStats::GetSystemFrameCount() {
+    std::lock_guard lock{object_mutex};
+
+    return total_system_frames;
+}
+
 PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::lock_guard lock{object_mutex};
 
@@ -101,6 +192,18 @@ PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
 
+    // Loading screens and pauses don't present frames, they would skew the session's speed
+    if (system_frames != 0) {
+        session_system_us += current_system_time_us - reset_point_system_us;
+        session_walltime += DoubleSecs(interval);
+        if (emulation_speed_samples == 0) {
+            min_emulation_speed = max_emulation_speed = results.emulation_speed;
+        }
+        min_emulation_speed = std::min(min_emulation_speed, results.emulation_speed);
+        max_emulation_speed = std::max(max_emulation_speed, results.emulation_speed);
+        ++emulation_speed_samples;
+    }
+
     // Reset counters
     reset_point = now;
     reset_point_system_us = current_system_time_us;
@@ -118,9 +221,9 @@ double PerfStats::GetLastFrameTimeScale() {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
-void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
+std::optional<microseconds> FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     if (!Settings::values.use_frame_limit) {
-        return;
+        return std::nullopt;
     }
 
     auto now = Clock::now();
@@ -140,15 +243,42 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     frame_limiting_delta_err =
         std::clamp(frame_limiting_delta_err, -max_lag_time_us, max_lag_time_us);
 
+    std::optional<microseconds> lateness;
     if (frame_limiting_delta_err > microseconds::zero()) {
-        std::this_thread::sleep_for(frame_limiting_delta_err);
-        auto now_after_sleep = Clock::now();
+        const auto deadline = now + frame_limiting_delta_err;
+        const auto now_after_sleep = WaitUntil(deadline);
+        lateness = duration_cast<microseconds>(now_after_sleep - deadline);
         frame_limiting_delta_err -= duration_cast<microseconds>(now_after_sleep - now);
         now = now_after_sleep;
     }
 
     previous_system_time_us = current_system_time_us;
     previous_walltime = now;
+    return lateness;
+}
+
+FrameLimiter::Clock::time_point FrameLimiter::WaitUntil(Clock::time_point deadline) {
+    auto now = Clock::now();
+    if (deadline - now > spin_margin) {
+        const auto wake_target = deadline - spin_margin;
+        std::this_thread::sleep_until(wake_target);
+        now = Clock::now();
+
+        // Grow the margin at once when the sleep overshot it and shrink it slowly otherwise, so a
+        // single late wakeup doesn't keep the limiter spinning for long.
+        const auto oversleep = now - wake_target;
+        if (oversleep > spin_margin) {
+            spin_margin = oversleep;
+        } else {
+            spin_margin -= (spin_margin - oversleep) / 16;
+        }
+        spin_margin = std::clamp<Clock::duration>(spin_margin, MinSpinMargin, MaxSpinMargin);
+    }
+    while (now < deadline) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+    return now;
 }
 
 } // namespace Core
@@ -8,6 +8,8 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <optional>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Core {
@@ -23,6 +25,35 @@ struct PerfStatsResults {
     double emulation_speed;
 };
 
+/// Distribution of the frametimes of a session, excluding the frames spent booting.
+struct FrametimeHistogram {
+    /// Upper bounds of the buckets in milliseconds, the last bucket holds the slower frames
+    static constexpr std::array<double, 5> BucketLimits{8.4, 16.7, 33.4, 50.0, 100.0};
+
+    std::array<u64, BucketLimits.size() + 1> buckets{};
+    double p50{};
+    double p95{};
+    double p99{};
+    double max{};
+};
+
+/// How late the frame limiter returned past its deadlines, in milliseconds.
+struct FramePacingSummary {
+    double p50{};
+    double p95{};
+    double p99{};
+    double max{};
+    u64 num_samples{};
+};
+
+/// Emulation speed over the intervals the stats were read at, skipping those without frames.
+struct EmulationSpeedSummary {
+    double mean{};
+    double min{};
+    double max{};
+    u32 num_samples{};
+};
+
 /**
  * Class to manage and query performance/timing statistics. All public functions of this class are
  * thread-safe unless stated otherwise.
@@ -46,6 +77,21 @@ public:
      */
     double GetMeanFrametime();
 
+    /// Sorts the frametimes stored in the performance history into a histogram.
+    FrametimeHistogram GetFrametimeHistogram();
+
+    /// Records how late the frame limiter returned past the deadline of a frame.
+    void AddFramePacingError(std::chrono::microseconds lateness);
+
+    /// Gets the distribution of the frame pacing errors recorded in the session.
+    FramePacingSummary GetFramePacingSummary();
+
+    /// Gets the emulation speed of the session, as sampled by every call to GetAndResetStats.
+    EmulationSpeedSummary GetEmulationSpeedSummary();
+
+    /// Gets the number of system frames presented since the session started.
+    u64 GetSystemFrameCount();
+
     /**
      * Gets the ratio between walltime and the emulated time of the previous system frame. This is
      * useful for scaling inputs or outputs moving between the two time domains.
@@ -62,6 +108,8 @@ private:
     /// Stores an hour of historical frametime data useful for processing and tracking performance
     /// regressions with code changes.
     std::array<double, 216000> perf_history = {};
+    /// Frame pacing errors in milliseconds, capped to the same length as the frametime history
+    std::vector<double> pacing_history;
 
     /// Point when the cumulative counters were reset
     Clock::time_point reset_point = Clock::now();
@@ -74,6 +122,16 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Number of system frames presented in the whole session
+    u64 total_system_frames = 0;
+
+    /// Emulated and wall time of the session, summed over the intervals that presented frames
+    std::chrono::microseconds session_system_us{0};
+    std::chrono::duration<double> session_walltime{0};
+    /// Slowest and fastest emulation speed of those intervals
+    double min_emulation_speed = 0;
+    double max_emulation_speed = 0;
+    u32 emulation_speed_samples = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -87,9 +145,21 @@ class FrameLimiter {
 public:
     using Clock = std::chrono::high_resolution_clock;
 
-    void DoFrameLimiting(std::chrono::microseconds current_system_time_us);
+    /**
+     * Waits until walltime catches up with the emulated time.
+     * @returns How late the wait finished past its deadline, if the limiter had to wait at all.
+     */
+    std::optional<std::chrono::microseconds> DoFrameLimiting(
+        std::chrono::microseconds current_system_time_us);
 
 private:
+    /**
+     * Sleeps until shortly before the deadline and spins for the rest of the wait, as sleeps can
+     * overshoot by a whole scheduler quantum.
+     * @returns The time at which the wait finished.
+     */
+    Clock::time_point WaitUntil(Clock::time_point deadline);
+
     /// Emulated system time (in microseconds) at the last limiter invocation
     std::chrono::microseconds previous_system_time_us{0};
     /// Walltime at the last limiter invocation
@@ -97,6 +167,9 @@ private:
 
     /// Accumulated difference between walltime and emulated time
     std::chrono::microseconds frame_limiting_delta_err{0};
+
+    /// Time spun before each deadline, calibrated to how much the coarse sleeps overshoot
+    Clock::duration spin_margin = std::chrono::milliseconds{2};
 };
 
 } // namespace Core
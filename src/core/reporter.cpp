@@ -15,7 +15,9 @@
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/svc.h"
 #include "core/hle/result.h"
 #include "core/reporter.h"
 #include "core/settings.h"
@@ -144,8 +146,8 @@ json GetFullDataAuto(const std::string& timestamp, u64 title_id, Core::System& s
     return out;
 }
 
-template <bool read_value, typename DescriptorType>
-json GetHLEBufferDescriptorData(const std::vector<DescriptorType>& buffer) {
+template <bool read_value, typename DescriptorList>
+json GetHLEBufferDescriptorData(const DescriptorList& buffer) {
     auto buffer_out = json::array();
     for (const auto& desc : buffer) {
         auto entry = json{
@@ -384,6 +386,40 @@ void Reporter::SaveUserReport() const {
                GetPath("user_report", title_id, timestamp));
 }
 
+void Reporter::SaveSVCStatisticsReport() const {
+    if (!IsReportingEnabled()) {
+        return;
+    }
+
+    const auto timestamp = GetTimestamp();
+    const auto title_id = system.CurrentProcess()->GetTitleID();
+    const auto& kernel = system.Kernel();
+    json out;
+
+    out["yuzu_version"] = GetYuzuVersionData();
+    out["report_common"] = GetReportCommonData(title_id, RESULT_SUCCESS, timestamp);
+
+    auto svcs = json::array();
+    for (u32 id = 0; id < Kernel::NUM_SVCS; ++id) {
+        const u64 call_count = kernel.GetSVCCallCount(id);
+        if (call_count == 0) {
+            continue;
+        }
+
+        const u64 host_time = kernel.GetSVCHostTime(id);
+        svcs.push_back({
+            {"id", fmt::format("{:02X}", id)},
+            {"name", Kernel::GetSVCName(id)},
+            {"call_count", call_count},
+            {"host_time_ns", host_time},
+            {"mean_host_time_ns", host_time / call_count},
+        });
+    }
+    out["svcs"] = std::move(svcs);
+
+    SaveToFile(std::move(out), GetPath("svc_statistics_report", title_id, timestamp));
+}
+
 bool Reporter::IsReportingEnabled() const {
     return Settings::values.reporting_services;
 }
@@ -64,6 +64,9 @@ public:
 
     void SaveUserReport() const;
 
+    /// Saves the call count and host time of every SVC the current session has called.
+    void SaveSVCStatisticsReport() const;
+
 private:
     bool IsReportingEnabled() const;
 
@@ -87,6 +87,15 @@ void LogSettings() {
     LogSetting("System_CurrentUser", Settings::values.current_user);
     LogSetting("System_LanguageIndex", Settings::values.language_index);
     LogSetting("Core_UseMultiCore", Settings::values.use_multi_core);
+    LogSetting("Core_UseParallelCpu", Settings::values.use_parallel_cpu);
+    LogSetting("Core_UseCpuLoadBalancing", Settings::values.use_cpu_load_balancing);
+    LogSetting("Core_UseSharedJitCache", Settings::values.use_shared_jit_cache);
+    LogSetting("Core_UseNativeLibcFunctions", Settings::values.use_native_libc_functions);
+    LogSetting("Core_UseHostClock", Settings::values.use_host_clock);
+    LogSetting("Core_CpuThreadAffinity", Settings::values.cpu_thread_affinity);
+    LogSetting("Core_GpuThreadAffinity", Settings::values.gpu_thread_affinity);
+    LogSetting("Core_AudioThreadAffinity", Settings::values.audio_thread_affinity);
+    LogSetting("Core_UseHighThreadPriority", Settings::values.use_high_thread_priority);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
     LogSetting("Renderer_FrameLimit", Settings::values.frame_limit);
@@ -94,11 +103,21 @@ void LogSettings() {
     LogSetting("Renderer_UseAccurateGpuEmulation", Settings::values.use_accurate_gpu_emulation);
     LogSetting("Renderer_UseAsynchronousGpuEmulation",
                Settings::values.use_asynchronous_gpu_emulation);
+    LogSetting("Renderer_UseAsynchronousShaders", Settings::values.use_asynchronous_shaders);
+    LogSetting("Renderer_TextureCacheBudgetMb", Settings::values.texture_cache_budget_mb);
+    LogSetting("Renderer_UseGpuTextureSwizzle", Settings::values.use_gpu_texture_swizzle);
+    LogSetting("Renderer_UseBindlessTextures", Settings::values.use_bindless_textures);
+    LogSetting("Renderer_TranscodeAstcTextures", Settings::values.transcode_astc_textures);
     LogSetting("Renderer_UseResolutionScanner", Settings::values.use_resolution_scanner);
+    LogSetting("Renderer_UseFrameSmoothing", Settings::values.use_frame_smoothing);
+    LogSetting("Renderer_UncapCompositionRate", Settings::values.uncap_composition_rate);
     LogSetting("Audio_OutputEngine", Settings::values.sink_id);
     LogSetting("Audio_EnableAudioStretching", Settings::values.enable_audio_stretching);
+    LogSetting("Audio_UseLinearAudioResampling", Settings::values.use_linear_audio_resampling);
     LogSetting("Audio_OutputDevice", Settings::values.audio_device_id);
     LogSetting("DataStorage_UseVirtualSd", Settings::values.use_virtual_sd);
+    LogSetting("DataStorage_CacheDecryptedNcaSections",
+               Settings::values.cache_decrypted_nca_sections);
     LogSetting("DataStorage_NandDir", FileUtil::GetUserPath(FileUtil::UserPath::NANDDir));
     LogSetting("DataStorage_SdmcDir", FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir));
     LogSetting("Debugging_UseGdbstub", Settings::values.use_gdbstub);
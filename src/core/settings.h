@@ -404,9 +404,21 @@ struct Values {
 
     // Core
     bool use_multi_core;
+    bool use_parallel_cpu;
+    bool use_cpu_load_balancing;
+    bool use_shared_jit_cache;
+    bool use_native_libc_functions;
+    bool use_host_clock;
+
+    // Host threads, the affinities are masks of host cores and zero leaves them to the OS
+    u64 cpu_thread_affinity;
+    u64 gpu_thread_affinity;
+    u64 audio_thread_affinity;
+    bool use_high_thread_priority;
 
     // Data Storage
     bool use_virtual_sd;
+    bool cache_decrypted_nca_sections;
     bool gamecard_inserted;
     bool gamecard_current_game;
     std::string gamecard_path;
@@ -422,7 +434,14 @@ struct Values {
     bool use_disk_shader_cache;
     bool use_accurate_gpu_emulation;
     bool use_asynchronous_gpu_emulation;
+    bool use_asynchronous_shaders;
+    u32 texture_cache_budget_mb; ///< Memory the texture cache tries to stay under, 0 is unlimited
+    bool use_gpu_texture_swizzle;
+    bool use_bindless_textures;
+    bool transcode_astc_textures;
     bool force_30fps_mode;
+    bool use_frame_smoothing;
+    bool uncap_composition_rate;
     bool use_resolution_scanner;
 
     float bg_red;
@@ -436,11 +455,16 @@ struct Values {
     // Audio
     std::string sink_id;
     bool enable_audio_stretching;
+    bool use_linear_audio_resampling;
     std::string audio_device_id;
     float volume;
 
     // Debugging
     bool record_frame_times;
+    bool record_input_latency;
+    bool profile_guest_code;
+    bool record_session_telemetry;
+    bool record_ipc_statistics;
     bool use_gdbstub;
     u16 gdbstub_port;
     std::string program_args;
@@ -3,7 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
 
+#include <fmt/chrono.h>
+#include <json.hpp>
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/entropy.h>
 
@@ -25,6 +30,87 @@
 
 namespace Core {
 
+namespace {
+
+/// Writes the fields of a session to a JSON file, with the same sections as the web service.
+class LocalTelemetryJson final : public Telemetry::VisitorInterface {
+public:
+    void Visit(const Telemetry::Field<bool>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<double>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<float>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<u8>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<u16>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<u32>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<u64>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<s8>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<s16>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<s32>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<s64>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<std::string>& field) override {
+        Serialize(field, field.GetValue());
+    }
+    void Visit(const Telemetry::Field<const char*>& field) override {
+        Serialize(field, std::string(field.GetValue()));
+    }
+    void Visit(const Telemetry::Field<std::chrono::microseconds>& field) override {
+        Serialize(field, field.GetValue().count());
+    }
+
+    void Complete() override {}
+
+    bool SubmitTestcase() override {
+        return false;
+    }
+
+    void Save(const std::string& filename) const {
+        if (!FileUtil::CreateFullPath(filename)) {
+            LOG_ERROR(Core, "Failed to create path for '{}' to save telemetry", filename);
+            return;
+        }
+        std::ostringstream stream;
+        stream << std::setw(4) << output << std::endl;
+        FileUtil::IOFile file(filename, "w");
+        file.WriteString(stream.str());
+    }
+
+private:
+    template <typename T, typename V>
+    void Serialize(const Telemetry::Field<T>& field, V value) {
+        static constexpr std::array<const char*, 7> section_names{
+            nullptr, "App", "Session", "Performance", "UserFeedback", "UserConfig", "UserSystem",
+        };
+        const char* const section_name = section_names[static_cast<u8>(field.GetType())];
+        auto& section = section_name != nullptr ? output[section_name] : output;
+        section[field.GetName()] = std::move(value);
+    }
+
+    nlohmann::json output;
+};
+
+} // Anonymous namespace
+
 static u64 GenerateTelemetryId() {
     u64 telemetry_id{};
 
@@ -121,6 +207,19 @@ TelemetrySession::~TelemetrySession() {
     if (Settings::values.enable_telemetry) {
         backend->Complete();
     }
+
+    if (Settings::values.record_session_telemetry && program_id != 0) {
+        LocalTelemetryJson local_backend;
+        field_collection.Accept(local_backend);
+
+        const std::time_t t = std::time(nullptr);
+        const std::string& path = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+        // %F Date format expanded is "%Y-%m-%d"
+        const std::string filename = fmt::format("{}/{:%F-%H-%M}_{:016X}_telemetry.json", path,
+                                                 *std::localtime(&t), program_id);
+        local_backend.Save(filename);
+        LOG_INFO(Core, "Session telemetry written to {}", filename);
+    }
 }
 
 void TelemetrySession::AddInitialInfo(Loader::AppLoader& app_loader) {
@@ -133,7 +232,6 @@ void TelemetrySession::AddInitialInfo(Loader::AppLoader& app_loader) {
                             .count()};
     AddField(Telemetry::FieldType::Session, "Init_Time", init_time);
 
-    u64 program_id{};
     const Loader::ResultStatus res{app_loader.ReadProgramId(program_id)};
     if (res == Loader::ResultStatus::Success) {
         const std::string formatted_program_id{fmt::format("{:016X}", program_id)};
@@ -170,6 +268,18 @@ void TelemetrySession::AddInitialInfo(Loader::AppLoader& app_loader) {
              Settings::values.enable_audio_stretching);
     AddField(Telemetry::FieldType::UserConfig, "Core_UseMultiCore",
              Settings::values.use_multi_core);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseParallelCpu",
+             Settings::values.use_parallel_cpu);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseCpuLoadBalancing",
+             Settings::values.use_cpu_load_balancing);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseSharedJitCache",
+             Settings::values.use_shared_jit_cache);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseNativeLibcFunctions",
+             Settings::values.use_native_libc_functions);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseHostClock",
+             Settings::values.use_host_clock);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseHighThreadPriority",
+             Settings::values.use_high_thread_priority);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_ResolutionFactor",
              Settings::values.resolution_factor);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseFrameLimit",
@@ -181,6 +291,16 @@ void TelemetrySession::AddInitialInfo(Loader::AppLoader& app_loader) {
              Settings::values.use_accurate_gpu_emulation);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseAsynchronousGpuEmulation",
              Settings::values.use_asynchronous_gpu_emulation);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseAsynchronousShaders",
+             Settings::values.use_asynchronous_shaders);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_TextureCacheBudgetMb",
+             Settings::values.texture_cache_budget_mb);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseGpuTextureSwizzle",
+             Settings::values.use_gpu_texture_swizzle);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseBindlessTextures",
+             Settings::values.use_bindless_textures);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_TranscodeAstcTextures",
+             Settings::values.transcode_astc_textures);
     AddField(Telemetry::FieldType::UserConfig, "System_UseDockedMode",
              Settings::values.use_docked_mode);
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include "common/common_types.h"
 #include "common/telemetry.h"
 
 namespace Loader {
@@ -64,6 +65,7 @@ public:
 
 private:
     Telemetry::FieldCollection field_collection; ///< Tracks all added fields for the session
+    u64 program_id{};                            ///< Program ID of the title, 0 if it has none
 };
 
 /**
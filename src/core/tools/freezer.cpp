@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -16,6 +18,20 @@ namespace {
 
 constexpr s64 MEMORY_FREEZER_TICKS = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE / 60);
 
+// Every page holding frozen values costs a scan per pass, passes over many pages are spread out
+// over a few frames instead.
+constexpr std::size_t PAGES_PER_FRAME = 64;
+constexpr s64 MAX_FRAMES_PER_PASS = 4;
+
+s64 PassInterval(std::size_t num_pages) {
+    const auto frames = static_cast<s64>(num_pages / PAGES_PER_FRAME) + 1;
+    return MEMORY_FREEZER_TICKS * std::min(frames, MAX_FRAMES_PER_PASS);
+}
+
+u64 WidthMask(u32 width) {
+    return width >= 8 ? ~0ULL : (1ULL << (width * 8)) - 1;
+}
+
 u64 MemoryReadWidth(u32 width, VAddr addr) {
     switch (width) {
     case 1:
@@ -51,6 +67,39 @@ void MemoryWriteWidth(u32 width, VAddr addr, u64 value) {
     }
 }
 
+using EntryIterator = std::vector<Freezer::Entry>::const_iterator;
+
+/// Restores the frozen values of entries sharing a page, only touching the ones that changed.
+void EnforcePage(EntryIterator first, EntryIterator last) {
+    const VAddr start = first->address;
+    VAddr end = start;
+    for (auto it = first; it != last; ++it) {
+        end = std::max<VAddr>(end, it->address + it->width);
+    }
+
+    // Regular memory is compared and written in place. Pages cached by the rasterizer have no
+    // host pointer and go through the regular accessors, so the rasterizer sees the writes.
+    u8* const pointer = Memory::GetContiguousPointer(start, end - start);
+    for (auto it = first; it != last; ++it) {
+        if (pointer != nullptr) {
+            u8* const host = pointer + (it->address - start);
+            if (std::memcmp(host, &it->value, it->width) == 0) {
+                continue;
+            }
+            std::memcpy(host, &it->value, it->width);
+        } else {
+            const u64 value = it->value & WidthMask(it->width);
+            if (MemoryReadWidth(it->width, it->address) == value) {
+                continue;
+            }
+            MemoryWriteWidth(it->width, it->address, value);
+        }
+        LOG_DEBUG(Common_Memory,
+                  "Enforcing memory freeze at address={:016X}, value={:016X}, width={:02X}",
+                  it->address, it->value, it->width);
+    }
+}
+
 } // Anonymous namespace
 
 Freezer::Freezer(Core::Timing::CoreTiming& core_timing) : core_timing(core_timing) {
@@ -89,8 +138,12 @@ void Freezer::Clear() {
 u64 Freezer::Freeze(VAddr address, u32 width) {
     std::lock_guard lock{entries_mutex};
 
+    // Entries are kept sorted by address, so entries sharing a page are next to each other.
     const auto current_value = MemoryReadWidth(width, address);
-    entries.push_back({address, width, current_value});
+    const auto iter = std::upper_bound(
+        entries.begin(), entries.end(), address,
+        [](VAddr address, const Entry& entry) { return address < entry.address; });
+    entries.insert(iter, {address, width, current_value});
 
     LOG_DEBUG(Common_Memory,
               "Freezing memory for address={:016X}, width={:02X}, current_value={:016X}", address,
@@ -165,14 +218,17 @@ void Freezer::FrameCallback(u64 userdata, s64 cycles_late) {
 
     std::lock_guard lock{entries_mutex};
 
-    for (const auto& entry : entries) {
-        LOG_DEBUG(Common_Memory,
-                  "Enforcing memory freeze at address={:016X}, value={:016X}, width={:02X}",
-                  entry.address, entry.value, entry.width);
-        MemoryWriteWidth(entry.width, entry.address, entry.value);
+    std::size_t num_pages = 0;
+    for (auto first = entries.cbegin(); first != entries.cend(); ++num_pages) {
+        const VAddr page = first->address & ~Memory::PAGE_MASK;
+        const auto last = std::find_if(first, entries.cend(), [page](const Entry& entry) {
+            return (entry.address & ~Memory::PAGE_MASK) != page;
+        });
+        EnforcePage(first, last);
+        first = last;
     }
 
-    core_timing.ScheduleEvent(MEMORY_FREEZER_TICKS - cycles_late, event);
+    core_timing.ScheduleEvent(PassInterval(num_pages) - cycles_late, event);
 }
 
 void Freezer::FillEntryReads() {
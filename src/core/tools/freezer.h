@@ -73,6 +73,7 @@ private:
     std::atomic_bool active{false};
 
     mutable std::mutex entries_mutex;
+    /// Sorted by address, so entries on the same page are enforced together.
     std::vector<Entry> entries;
 
     Core::Timing::EventType* event;
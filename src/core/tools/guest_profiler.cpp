@@ -0,0 +1,162 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_cpu.h"
+#include "core/core_timing.h"
+#include "core/core_timing_util.h"
+#include "core/hle/kernel/scheduler.h"
+#include "core/settings.h"
+#include "core/tools/guest_profiler.h"
+
+namespace Tools {
+
+namespace {
+
+constexpr s64 GUEST_PROFILER_TICKS = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE / 1000);
+
+// Longest host time a single sample can account for, so that pausing emulation doesn't end up
+// attributed to whatever the guest was running at the time.
+constexpr std::chrono::nanoseconds MAX_SAMPLE_TIME = std::chrono::milliseconds(100);
+
+std::string FrameName(const Core::ARM_Interface::BacktraceEntry& entry) {
+    if (entry.name.empty()) {
+        return fmt::format("{}+0x{:X}", entry.module, entry.offset);
+    }
+    return fmt::format("{}!{}", entry.module, entry.name);
+}
+
+} // Anonymous namespace
+
+GuestProfiler::GuestProfiler(Core::System& system, u64 title_id)
+    : system{system}, title_id{title_id}, last_sample_time{std::chrono::steady_clock::now()} {
+    auto& core_timing = system.CoreTiming();
+    event = core_timing.RegisterEvent(
+        "GuestProfiler::SampleCallback",
+        [this](u64 userdata, s64 cycles_late) { SampleCallback(userdata, cycles_late); });
+    core_timing.ScheduleEvent(GUEST_PROFILER_TICKS, event);
+}
+
+GuestProfiler::~GuestProfiler() {
+    system.CoreTiming().UnscheduleEvent(event, 0);
+    WriteFlamegraph();
+}
+
+void GuestProfiler::RecordSVC(const char* name, VAddr pc, VAddr lr,
+                              std::chrono::nanoseconds duration) {
+    std::lock_guard lock{samples_mutex};
+    samples[{StackKind::HLE, pc, lr, name}] += static_cast<u64>(duration.count());
+
+    // In parallel CPU mode only the main core is sampled, the others run alongside it
+    if (!Settings::values.use_multi_core || system.CurrentCoreIndex() == 0) {
+        hle_time_since_sample += duration;
+    }
+}
+
+void GuestProfiler::SampleCallback(u64 userdata, s64 cycles_late) {
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock{samples_mutex};
+        const auto elapsed = std::min<std::chrono::nanoseconds>(now - last_sample_time,
+                                                                MAX_SAMPLE_TIME);
+        const auto guest_time =
+            std::max(elapsed - hle_time_since_sample, std::chrono::nanoseconds::zero());
+        last_sample_time = now;
+        hle_time_since_sample = {};
+
+        // Without parallel CPU emulation all cores are interleaved on this thread and can be
+        // read safely, they share its time. Otherwise only the core running this can be.
+        const bool multi_core = Settings::values.use_multi_core;
+        const std::size_t first_core = multi_core ? system.CurrentCoreIndex() : 0;
+        const std::size_t num_cores = multi_core ? 1 : Core::NUM_CPU_CORES;
+        const u64 weight = static_cast<u64>(guest_time.count()) / num_cores;
+        for (std::size_t core = first_core; core < first_core + num_cores; ++core) {
+            if (system.Scheduler(core).GetCurrentThread() == nullptr) {
+                samples[{StackKind::Idle, 0, 0, nullptr}] += weight;
+                continue;
+            }
+            const auto& arm_interface = system.ArmInterface(core);
+            samples[{StackKind::Guest, arm_interface.GetPC(), arm_interface.GetReg(30),
+                     nullptr}] += weight;
+        }
+    }
+
+    system.CoreTiming().ScheduleEvent(GUEST_PROFILER_TICKS - cycles_late, event);
+}
+
+void GuestProfiler::WriteFlamegraph() const {
+    std::lock_guard lock{samples_mutex};
+    if (samples.empty() || title_id == 0) {
+        return;
+    }
+
+    // Symbolize each address once, the link register points after the call instruction
+    std::vector<VAddr> addresses;
+    for (const auto& [stack, time] : samples) {
+        if (stack.kind != StackKind::Idle) {
+            addresses.push_back(stack.pc);
+            addresses.push_back(stack.lr - 4);
+        }
+    }
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+    const auto entries = Core::ARM_Interface::SymbolizeAddresses(addresses);
+    std::map<VAddr, std::string> frames;
+    for (const auto& entry : entries) {
+        frames.emplace(entry.original_address, FrameName(entry));
+    }
+    const auto frame_name = [&frames](VAddr address) -> std::string {
+        const auto it = frames.find(address);
+        return it != frames.end() ? it->second : fmt::format("0x{:016X}", address);
+    };
+
+    // Stacks that only differ by address within the same functions are merged
+    std::map<std::string, u64> folded;
+    for (const auto& [stack, time] : samples) {
+        switch (stack.kind) {
+        case StackKind::Guest:
+            folded[fmt::format("guest;{};{}", frame_name(stack.lr - 4), frame_name(stack.pc))] +=
+                time;
+            break;
+        case StackKind::HLE:
+            folded[fmt::format("hle;{};{};{}", frame_name(stack.lr - 4), frame_name(stack.pc),
+                               stack.svc_name)] += time;
+            break;
+        case StackKind::Idle:
+            folded["idle"] += time;
+            break;
+        }
+    }
+
+    std::string contents;
+    for (const auto& [stack, time] : folded) {
+        // Weights are in microseconds of host time
+        const u64 time_us = time / 1000;
+        if (time_us != 0) {
+            contents += fmt::format("{} {}\n", stack, time_us);
+        }
+    }
+
+    const std::time_t t = std::time(nullptr);
+    const std::string& path = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+    // %F Date format expanded is "%Y-%m-%d"
+    const std::string filename = fmt::format("{}/{:%F-%H-%M}_{:016X}_guest.folded", path,
+                                             *std::localtime(&t), title_id);
+    FileUtil::IOFile file(filename, "w");
+    file.WriteString(contents);
+    LOG_INFO(Core, "Guest profile written to {}", filename);
+}
+
+} // namespace Tools
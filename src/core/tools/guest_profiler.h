@@ -0,0 +1,81 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+}
+
+namespace Core::Timing {
+struct EventType;
+}
+
+namespace Tools {
+
+/**
+ * Sampling profiler for guest code. At a fixed rate of emulated time it captures the PC and LR of
+ * the CPU cores, and it times the HLE handling of every SVC. When the session ends, the samples are
+ * symbolized against the loaded NSOs and written to the log directory as a flamegraph in the folded
+ * stack format (flamegraph.pl, speedscope...), weighted by host time.
+ *
+ * Stacks are rooted at "guest", "hle" or "idle", which tells at a glance whether a slowdown comes
+ * from the game's code or from our implementation of the kernel and services.
+ */
+class GuestProfiler {
+public:
+    explicit GuestProfiler(Core::System& system, u64 title_id);
+    ~GuestProfiler();
+
+    /// Accounts the host time spent handling an SVC called from pc, in a function returning to lr.
+    void RecordSVC(const char* name, VAddr pc, VAddr lr, std::chrono::nanoseconds duration);
+
+private:
+    enum class StackKind : u8 {
+        Guest,
+        HLE,
+        Idle,
+    };
+
+    struct Stack {
+        StackKind kind;
+        VAddr pc;
+        VAddr lr;
+        const char* svc_name;
+
+        bool operator==(const Stack& other) const {
+            return kind == other.kind && pc == other.pc && lr == other.lr &&
+                   svc_name == other.svc_name;
+        }
+    };
+
+    struct StackHash {
+        std::size_t operator()(const Stack& stack) const {
+            return static_cast<std::size_t>(stack.pc * 0x9E3779B97F4A7C15ULL ^ stack.lr ^
+                                            static_cast<u64>(stack.kind));
+        }
+    };
+
+    void SampleCallback(u64 userdata, s64 cycles_late);
+    void WriteFlamegraph() const;
+
+    Core::System& system;
+    u64 title_id;
+    Core::Timing::EventType* event;
+
+    mutable std::mutex samples_mutex;
+    /// Host time spent in each stack, in nanoseconds.
+    std::unordered_map<Stack, u64, StackHash> samples;
+    std::chrono::steady_clock::time_point last_sample_time;
+    /// Host time already accounted to SVCs since the last sample.
+    std::chrono::nanoseconds hle_time_since_sample{};
+};
+
+} // namespace Tools
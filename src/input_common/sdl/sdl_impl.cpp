@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <functional>
@@ -17,6 +18,7 @@
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/param_package.h"
+#include "common/thread.h"
 #include "common/threadsafe_queue.h"
 #include "core/frontend/input.h"
 #include "input_common/sdl/sdl_impl.h"
@@ -52,23 +54,29 @@ public:
         : guid{std::move(guid_)}, port{port_}, sdl_joystick{joystick, &SDL_JoystickClose} {}
 
     void SetButton(int button, bool value) {
-        std::lock_guard lock{mutex};
-        state.buttons.insert_or_assign(button, value);
+        if (IsValidIndex(button, state.buttons)) {
+            state.buttons[button].store(value, std::memory_order_relaxed);
+        }
     }
 
     bool GetButton(int button) const {
-        std::lock_guard lock{mutex};
-        return state.buttons.at(button);
+        if (!IsValidIndex(button, state.buttons)) {
+            return false;
+        }
+        return state.buttons[button].load(std::memory_order_relaxed);
     }
 
     void SetAxis(int axis, Sint16 value) {
-        std::lock_guard lock{mutex};
-        state.axes.insert_or_assign(axis, value);
+        if (IsValidIndex(axis, state.axes)) {
+            state.axes[axis].store(value, std::memory_order_relaxed);
+        }
     }
 
     float GetAxis(int axis) const {
-        std::lock_guard lock{mutex};
-        return state.axes.at(axis) / 32767.0f;
+        if (!IsValidIndex(axis, state.axes)) {
+            return 0.0f;
+        }
+        return state.axes[axis].load(std::memory_order_relaxed) / 32767.0f;
     }
 
     std::tuple<float, float> GetAnalog(int axis_x, int axis_y) const {
@@ -89,13 +97,16 @@ public:
     }
 
     void SetHat(int hat, Uint8 direction) {
-        std::lock_guard lock{mutex};
-        state.hats.insert_or_assign(hat, direction);
+        if (IsValidIndex(hat, state.hats)) {
+            state.hats[hat].store(direction, std::memory_order_relaxed);
+        }
     }
 
     bool GetHatDirection(int hat, Uint8 direction) const {
-        std::lock_guard lock{mutex};
-        return (state.hats.at(hat) & direction) != 0;
+        if (!IsValidIndex(hat, state.hats)) {
+            return false;
+        }
+        return (state.hats[hat].load(std::memory_order_relaxed) & direction) != 0;
     }
     /**
      * The guid of the joystick
@@ -120,15 +131,21 @@ public:
     }
 
 private:
+    template <typename Array>
+    static bool IsValidIndex(int index, const Array& array) {
+        return index >= 0 && static_cast<std::size_t>(index) < array.size();
+    }
+
+    /// Written by the SDL event thread and read by the emulated devices, every value is updated on
+    /// its own so they don't need a lock.
     struct State {
-        std::unordered_map<int, bool> buttons;
-        std::unordered_map<int, Sint16> axes;
-        std::unordered_map<int, Uint8> hats;
+        std::array<std::atomic<bool>, 128> buttons{};
+        std::array<std::atomic<Sint16>, 32> axes{};
+        std::array<std::atomic<Uint8>, 16> hats{};
     } state;
     std::string guid;
     int port;
     std::unique_ptr<SDL_Joystick, decltype(&SDL_JoystickClose)> sdl_joystick;
-    mutable std::mutex mutex;
 };
 
 std::shared_ptr<SDLJoystick> SDLState::GetSDLJoystickByGUID(const std::string& guid, int port) {
@@ -239,24 +256,28 @@ void SDLState::HandleGameControllerEvent(const SDL_Event& event) {
     case SDL_JOYBUTTONUP: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jbutton.which)) {
             joystick->SetButton(event.jbutton.button, false);
+            Input::NotifyInputEvent();
         }
         break;
     }
     case SDL_JOYBUTTONDOWN: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jbutton.which)) {
             joystick->SetButton(event.jbutton.button, true);
+            Input::NotifyInputEvent();
         }
         break;
     }
     case SDL_JOYHATMOTION: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jhat.which)) {
             joystick->SetHat(event.jhat.hat, event.jhat.value);
+            Input::NotifyInputEvent();
         }
         break;
     }
     case SDL_JOYAXISMOTION: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jaxis.which)) {
             joystick->SetAxis(event.jaxis.axis, event.jaxis.value);
+            Input::NotifyInputEvent();
         }
         break;
     }
@@ -391,8 +412,6 @@ public:
             } else {
                 direction = 0;
             }
-            // This is necessary so accessing GetHat with hat won't crash
-            joystick->SetHat(hat, SDL_HAT_CENTERED);
             return std::make_unique<SDLDirectionButton>(joystick, hat, direction);
         }
 
@@ -409,14 +428,10 @@ public:
                 trigger_if_greater = true;
                 LOG_ERROR(Input, "Unknown direction {}", direction_name);
             }
-            // This is necessary so accessing GetAxis with axis won't crash
-            joystick->SetAxis(axis, 0);
             return std::make_unique<SDLAxisButton>(joystick, axis, threshold, trigger_if_greater);
         }
 
         const int button = params.Get("button", 0);
-        // This is necessary so accessing GetButton with button won't crash
-        joystick->SetButton(button, false);
         return std::make_unique<SDLButton>(joystick, button);
     }
 
@@ -444,10 +459,6 @@ public:
         const float deadzone = std::clamp(params.Get("deadzone", 0.0f), 0.0f, .99f);
 
         auto joystick = state.GetSDLJoystickByGUID(guid, port);
-
-        // This is necessary so accessing GetAxis with axis_x and axis_y won't crash
-        joystick->SetAxis(axis_x, 0);
-        joystick->SetAxis(axis_y, 0);
         return std::make_unique<SDLAnalog>(joystick, axis_x, axis_y, deadzone);
     }
 
@@ -475,10 +486,12 @@ SDLState::SDLState() {
     initialized = true;
     if (start_thread) {
         poll_thread = std::thread([this] {
-            using namespace std::chrono_literals;
+            Common::SetCurrentThreadName("yuzu:SDLInput");
+            SDL_Event event;
             while (initialized) {
-                SDL_PumpEvents();
-                std::this_thread::sleep_for(10ms);
+                // The event watcher handles the events as they are queued, this only wakes the
+                // thread up when one arrives. The timeout keeps joysticks being pumped.
+                SDL_WaitEventTimeout(&event, 100);
             }
         });
     }
@@ -499,6 +512,10 @@ SDLState::~SDLState() {
 
     initialized = false;
     if (start_thread) {
+        // Wake the event thread up so it sees it should stop
+        SDL_Event wake_event{};
+        wake_event.type = SDL_USEREVENT;
+        SDL_PushEvent(&wake_event);
         poll_thread.join();
         SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
     }
@@ -0,0 +1,112 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/algorithm/interpolate.h"
+#include "audio_core/codec.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+namespace {
+
+/// The decoder as it was before it wrote into caller owned buffers
+std::vector<s16> DecodeADPCMReference(const u8* data, std::size_t size,
+                                      const Codec::ADPCM_Coeff& coeff, Codec::ADPCMState& state) {
+    constexpr std::array<int, 16> SIGNED_NIBBLES = {
+        {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
+    std::vector<s16> ret;
+    int yn1 = state.yn1, yn2 = state.yn2;
+    for (std::size_t frame = 0; frame < size / 8; ++frame) {
+        const int header = data[frame * 8];
+        const int scale = 1 << (header & 0xF);
+        const int idx = (header >> 4) & 0x7;
+        for (std::size_t i = 1; i < 8; ++i) {
+            for (const int nibble : {data[frame * 8 + i] >> 4, data[frame * 8 + i] & 0xF}) {
+                int val = ((SIGNED_NIBBLES[nibble] * scale << 11) + 0x400 +
+                           coeff[idx * 2] * yn1 + coeff[idx * 2 + 1] * yn2) >>
+                          11;
+                val = std::clamp(val, -32768, 32767);
+                yn2 = yn1;
+                yn1 = val;
+                ret.push_back(static_cast<s16>(val));
+            }
+        }
+    }
+    state.yn1 = static_cast<s16>(yn1);
+    state.yn2 = static_cast<s16>(yn2);
+    return ret;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Codec::DecodeADPCM", "[audio_core]") {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> byte(0, 0xFF);
+    std::uniform_int_distribution<int> coefficient(-4096, 4096);
+
+    Codec::ADPCM_Coeff coeff;
+    std::generate(coeff.begin(), coeff.end(), [&] { return static_cast<s16>(coefficient(rng)); });
+
+    Codec::ADPCMState expected_state{};
+    Codec::ADPCMState state{};
+    std::vector<s16> out;
+    for (const std::size_t size : {0, 7, 8, 64, 1000, 4096}) {
+        std::vector<u8> data(size);
+        std::generate(data.begin(), data.end(), [&] { return static_cast<u8>(byte(rng)); });
+
+        const auto expected = DecodeADPCMReference(data.data(), size, coeff, expected_state);
+        REQUIRE(Codec::GetADPCMSampleCount(size) == expected.size());
+
+        // The same storage is decoded into every time
+        Codec::DecodeADPCM(data.data(), size, coeff, state, out);
+        REQUIRE(out == expected);
+        REQUIRE(state.yn1 == expected_state.yn1);
+        REQUIRE(state.yn2 == expected_state.yn2);
+    }
+}
+
+TEST_CASE("Codec::ConvertPCM16ToStereoFloat", "[audio_core]") {
+    std::vector<s16> samples(2 * 37);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<s16>(i % 2 == 0 ? -32768 + static_cast<int>(i) * 997
+                                                 : 32767 - static_cast<int>(i) * 13);
+    }
+
+    for (const std::size_t frame_count : {0, 1, 3, 4, 5, 8, 37}) {
+        std::vector<float> out(frame_count * 2, 1.0f);
+        Codec::ConvertPCM16ToStereoFloat(samples.data(), frame_count, 1, out.data());
+        for (std::size_t i = 0; i < frame_count; ++i) {
+            REQUIRE(out[i * 2] == samples[i]);
+            REQUIRE(out[i * 2 + 1] == samples[i]);
+        }
+
+        Codec::ConvertPCM16ToStereoFloat(samples.data(), frame_count, 2, out.data());
+        for (std::size_t i = 0; i < frame_count * 2; ++i) {
+            REQUIRE(out[i] == samples[i]);
+        }
+    }
+}
+
+TEST_CASE("Interpolate::IntoBuffer", "[audio_core]") {
+    std::vector<s16> input(2 * 240);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<s16>((i * 7919) % 20000) - 10000;
+    }
+
+    InterpolationState expected_state;
+    InterpolationState state;
+    std::vector<s16> output;
+    for (int i = 0; i < 4; ++i) {
+        const auto expected = Interpolate(expected_state, input, 32000, 48000);
+        output.clear();
+        Interpolate(state, input.data(), input.size(), 32000.0 / 48000.0, output);
+        REQUIRE(output == expected);
+    }
+}
+
+} // namespace AudioCore
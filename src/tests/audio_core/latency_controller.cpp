@@ -0,0 +1,104 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/latency_controller.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+TEST_CASE("LatencyController::AdaptsTarget", "[audio_core]") {
+    LatencyController latency(48000);
+    const std::size_t initial = latency.GetTargetFrames();
+
+    // An underrun in a window grows the target
+    latency.Update(0, 512, 100);
+    for (int i = 0; i < 50; ++i) {
+        latency.Update(initial, 512, 512);
+    }
+    const std::size_t grown = latency.GetTargetFrames();
+    REQUIRE(grown > initial);
+
+    // A long stretch without underruns brings it back down, but not below its minimum
+    for (int i = 0; i < 10000; ++i) {
+        latency.Update(grown, 512, 512);
+    }
+    REQUIRE(latency.GetTargetFrames() < grown);
+    REQUIRE(latency.GetTargetFrames() > 0);
+
+    const auto statistics = latency.GetStatistics();
+    REQUIRE(statistics.underrun_count == 1);
+    REQUIRE(statistics.target_ms == Approx(latency.GetTargetFrames() * 1000.0 / 48000.0));
+}
+
+TEST_CASE("LatencyController::DriftsTowardsTarget", "[audio_core]") {
+    LatencyController latency(48000);
+    const std::size_t target = latency.GetTargetFrames();
+    REQUIRE(latency.GetDriftRatio(target) == 1.0);
+    REQUIRE(latency.GetDriftRatio(target * 2) > 1.0);
+    REQUIRE(latency.GetDriftRatio(target / 2) < 1.0);
+    // The correction stays too small to be heard
+    REQUIRE(latency.GetDriftRatio(target * 100) <= 1.01);
+    REQUIRE(latency.GetDriftRatio(0) >= 0.99);
+}
+
+TEST_CASE("LatencyController::DetectsSpeed", "[audio_core]") {
+    LatencyController latency(48000);
+    REQUIRE(latency.IsNearFullSpeed());
+
+    // Half as many frames queued as played
+    for (int i = 0; i < 1000; ++i) {
+        latency.ReportEnqueued(256);
+        latency.Update(2400, 512, 512);
+    }
+    REQUIRE(!latency.IsNearFullSpeed());
+    REQUIRE(latency.GetStatistics().emulation_speed == Approx(0.5).margin(0.05));
+
+    for (int i = 0; i < 1000; ++i) {
+        latency.ReportEnqueued(512);
+        latency.Update(2400, 512, 512);
+    }
+    REQUIRE(latency.IsNearFullSpeed());
+}
+
+TEST_CASE("DriftCorrector::Process", "[audio_core]") {
+    std::vector<s16> source(2 * 4096);
+    for (std::size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<s16>(i / 2 * (i % 2 == 0 ? 1 : -1));
+    }
+    std::size_t read = 0;
+    const auto pop = [&](s16* frames, std::size_t count) {
+        count = std::min(count, source.size() / 2 - read);
+        std::copy_n(source.begin() + read * 2, count * 2, frames);
+        read += count;
+        return count;
+    };
+
+    DriftCorrector drift(2);
+    std::vector<s16> out(2 * 4096);
+
+    // Unity ratio passes the frames through
+    REQUIRE(drift.Process(pop, out.data(), 256, 1.0) == 256);
+    for (std::size_t i = 0; i < 2 * 256; ++i) {
+        REQUIRE(out[i] == source[i]);
+    }
+
+    // Consuming faster stays continuous across calls, every frame is the rounded ramp
+    double position = 256.0;
+    for (int call = 0; call < 8; ++call) {
+        REQUIRE(drift.Process(pop, out.data(), 256, 1.005) == 256);
+        for (std::size_t i = 0; i < 256; ++i) {
+            REQUIRE(out[i * 2] == Approx(position).margin(0.51));
+            REQUIRE(out[i * 2 + 1] == Approx(-position).margin(0.51));
+            position += 1.005;
+        }
+    }
+
+    // Running out of input produces fewer frames
+    REQUIRE(drift.Process(pop, out.data(), 4096, 1.0) < 4096);
+}
+
+} // namespace AudioCore
@@ -0,0 +1,202 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/algorithm/interpolate.h"
+#include "audio_core/algorithm/resampler.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+namespace {
+
+constexpr std::size_t History = Resampler::HistoryFrames;
+
+/// Builds stereo input led by a silent history, the channels hold left(i) and right(i)
+template <typename Left, typename Right>
+std::vector<float> MakeInput(std::size_t num_frames, Left&& left, Right&& right) {
+    std::vector<float> input(History * 2);
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        input.push_back(left(i));
+        input.push_back(right(i));
+    }
+    return input;
+}
+
+/// Feeds the input to the resampler in chunks, carrying the history over like the voices do
+std::vector<float> ResampleInChunks(Resampler& resampler, const std::vector<float>& input,
+                                    std::size_t chunk_frames, std::size_t output_frames) {
+    std::vector<float> output(output_frames * 2);
+    std::vector<float> frames(input.begin(), input.begin() + History * 2);
+    std::size_t fed = History;
+    std::size_t produced = 0;
+    while (produced < output_frames && fed < input.size() / 2) {
+        const std::size_t old_frames = frames.size() / 2;
+        frames.erase(frames.begin(), frames.end() - History * 2);
+        resampler.Shift(old_frames - History);
+
+        const std::size_t chunk = std::min(chunk_frames, input.size() / 2 - fed);
+        frames.insert(frames.end(), input.begin() + fed * 2, input.begin() + (fed + chunk) * 2);
+        fed += chunk;
+
+        produced += resampler.Process(frames.data(), frames.size() / 2,
+                                      output.data() + produced * 2, output_frames - produced, 1.0f);
+    }
+    output.resize(produced * 2);
+    return output;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Resampler::Passthrough", "[audio_core]") {
+    const auto input = MakeInput(64, [](std::size_t i) { return static_cast<float>(i); },
+                                 [](std::size_t i) { return -static_cast<float>(i); });
+    Resampler resampler;
+    std::vector<float> mix(128, 1.0f);
+    REQUIRE(resampler.Process(input.data(), input.size() / 2, mix.data(), 64, 0.5f) == 64);
+    for (std::size_t i = 0; i < 64; ++i) {
+        REQUIRE(mix[i * 2] == 1.0f + static_cast<float>(i) * 0.5f);
+        REQUIRE(mix[i * 2 + 1] == 1.0f - static_cast<float>(i) * 0.5f);
+    }
+    REQUIRE(resampler.GetPosition() == History + 64);
+}
+
+TEST_CASE("Resampler::Linear", "[audio_core]") {
+    const auto input = MakeInput(64, [](std::size_t i) { return static_cast<float>(i); },
+                                 [](std::size_t i) { return static_cast<float>(i) * 2.0f; });
+    Resampler resampler;
+    resampler.SetQuality(ResamplingQuality::Linear);
+    resampler.SetRatio(0.5);
+
+    std::vector<float> mix(200 * 2);
+    const std::size_t produced =
+        resampler.Process(input.data(), input.size() / 2, mix.data(), 200, 1.0f);
+    // The last input frame is only reached by the next input
+    REQUIRE(produced == 126);
+    for (std::size_t i = 0; i < produced; ++i) {
+        REQUIRE(mix[i * 2] == Approx(static_cast<float>(i) * 0.5f));
+        REQUIRE(mix[i * 2 + 1] == Approx(static_cast<float>(i)));
+    }
+}
+
+TEST_CASE("Resampler::PolyphaseConstant", "[audio_core]") {
+    const auto input = MakeInput(4096, [](std::size_t) { return 1000.0f; },
+                                 [](std::size_t) { return -1000.0f; });
+    for (const double ratio : {32000.0 / 48000.0, 22050.0 / 48000.0, 96000.0 / 48000.0}) {
+        Resampler resampler;
+        resampler.SetRatio(ratio);
+        const auto output = ResampleInChunks(resampler, input, 240, 1024);
+        REQUIRE(output.size() == 1024 * 2);
+
+        // The silent history fades the signal in, past it a constant has to stay constant
+        for (std::size_t i = 16; i < output.size() / 2; ++i) {
+            REQUIRE(output[i * 2] == Approx(1000.0f).margin(0.01));
+            REQUIRE(output[i * 2 + 1] == Approx(-1000.0f).margin(0.01));
+        }
+    }
+}
+
+TEST_CASE("Resampler::Chunked", "[audio_core]") {
+    const auto input =
+        MakeInput(4096, [](std::size_t i) { return std::sin(static_cast<float>(i) * 0.05f); },
+                  [](std::size_t i) { return std::cos(static_cast<float>(i) * 0.01f); });
+    for (const auto quality : {ResamplingQuality::Linear, ResamplingQuality::Polyphase}) {
+        Resampler whole;
+        whole.SetQuality(quality);
+        whole.SetRatio(0.6875);
+        const auto expected = ResampleInChunks(whole, input, input.size(), 4096);
+
+        // Feeding small buffers must not change the signal at their boundaries
+        Resampler chunked;
+        chunked.SetQuality(quality);
+        chunked.SetRatio(0.6875);
+        const auto output = ResampleInChunks(chunked, input, 37, expected.size() / 2);
+        REQUIRE(output == expected);
+    }
+}
+
+TEST_CASE("Resampler[Benchmark]", "[.][benchmark]") {
+    constexpr std::size_t frames_per_mix = 512;
+    constexpr std::size_t num_mixes = 200;
+    constexpr u32 voice_rate = 32000;
+    constexpr double ratio = voice_rate / 48000.0;
+    // Enough input for every mix, wave buffers are 5 ms long
+    constexpr std::size_t buffer_frames = voice_rate / 200;
+
+    const auto measure = [](auto&& run) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    };
+
+    std::vector<s16> wave(buffer_frames * 2);
+    for (std::size_t i = 0; i < wave.size(); ++i) {
+        wave[i] = static_cast<s16>(std::sin(static_cast<double>(i) * 0.01) * 8000.0);
+    }
+
+    for (const std::size_t num_voices : {32, 96, 192}) {
+        // The previous pipeline, resampling every wave buffer into new vectors of PCM16
+        const auto interpolate_time = measure([&] {
+            std::vector<InterpolationState> states(num_voices);
+            std::vector<std::vector<s16>> pending(num_voices);
+            for (std::size_t mix = 0; mix < num_mixes; ++mix) {
+                std::vector<s32> out(frames_per_mix * 2);
+                for (std::size_t voice = 0; voice < num_voices; ++voice) {
+                    while (pending[voice].size() < out.size()) {
+                        const auto samples = Interpolate(states[voice], wave, voice_rate, 48000);
+                        pending[voice].insert(pending[voice].end(), samples.begin(),
+                                              samples.end());
+                    }
+                    for (std::size_t i = 0; i < out.size(); ++i) {
+                        out[i] += static_cast<s32>(pending[voice][i] * 0.5f);
+                    }
+                    pending[voice].erase(pending[voice].begin(),
+                                         pending[voice].begin() + out.size());
+                }
+            }
+        });
+
+        std::vector<float> frames(History * 2);
+        for (const s16 sample : wave) {
+            frames.push_back(sample);
+        }
+        const auto measure_resampler = [&](ResamplingQuality quality) {
+            return measure([&] {
+                std::vector<Resampler> resamplers(num_voices);
+                for (auto& resampler : resamplers) {
+                    resampler.SetQuality(quality);
+                    resampler.SetRatio(ratio);
+                }
+                std::vector<float> mix_buffer(frames_per_mix * 2);
+                for (std::size_t mix = 0; mix < num_mixes; ++mix) {
+                    std::fill(mix_buffer.begin(), mix_buffer.end(), 0.0f);
+                    for (auto& resampler : resamplers) {
+                        std::size_t produced = 0;
+                        while (produced < frames_per_mix) {
+                            produced += resampler.Process(
+                                frames.data(), frames.size() / 2,
+                                mix_buffer.data() + produced * 2, frames_per_mix - produced, 0.5f);
+                            if (produced < frames_per_mix) {
+                                // The same wave buffer is queued again
+                                resampler.Shift(frames.size() / 2 - History);
+                            }
+                        }
+                    }
+                }
+            });
+        };
+        const auto linear_time = measure_resampler(ResamplingQuality::Linear);
+        const auto polyphase_time = measure_resampler(ResamplingQuality::Polyphase);
+
+        WARN(num_voices << " voices, " << num_mixes << " mixes: Interpolate " << interpolate_time
+                        << " us, linear " << linear_time << " us, polyphase " << polyphase_time
+                        << " us");
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,68 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/x64/atomic_ops.h"
+
+namespace Common {
+
+TEST_CASE("AtomicOps::CompareAndSwap", "[common]") {
+    u8 value8 = 1;
+    REQUIRE(!AtomicCompareAndSwap(&value8, u8{2}, u8{0}));
+    REQUIRE(value8 == 1);
+    REQUIRE(AtomicCompareAndSwap(&value8, u8{2}, u8{1}));
+    REQUIRE(value8 == 2);
+
+    u32 value32 = 0xDEADBEEF;
+    REQUIRE(!AtomicCompareAndSwap(&value32, 0u, 0xDEADBEEEu));
+    REQUIRE(AtomicCompareAndSwap(&value32, 0u, 0xDEADBEEFu));
+    REQUIRE(value32 == 0);
+
+    u64 value64 = 0x123456789ABCDEF0;
+    REQUIRE(AtomicCompareAndSwap(&value64, u64{7}, u64{0x123456789ABCDEF0}));
+    REQUIRE(value64 == 7);
+}
+
+TEST_CASE("AtomicOps::CompareAndSwap128", "[common]") {
+    alignas(16) std::array<u64, 2> value{1, 2};
+
+    // Both halves have to match
+    REQUIRE(!AtomicCompareAndSwap(value.data(), u128{3, 4}, u128{1, 0}));
+    REQUIRE(!AtomicCompareAndSwap(value.data(), u128{3, 4}, u128{0, 2}));
+    REQUIRE(value == std::array<u64, 2>{1, 2});
+
+    REQUIRE(AtomicCompareAndSwap(value.data(), u128{3, 4}, u128{1, 2}));
+    REQUIRE(value == std::array<u64, 2>{3, 4});
+}
+
+TEST_CASE("AtomicOps::CompareAndSwap128 across threads", "[common]") {
+    constexpr int NumThreads = 4;
+    constexpr int NumIncrements = 10000;
+    alignas(16) std::array<u64, 2> counter{0, 0};
+
+    // Each thread bumps both halves together, a torn update would make them drift apart
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NumThreads; ++i) {
+        threads.emplace_back([&counter] {
+            for (int j = 0; j < NumIncrements; ++j) {
+                u128 expected{counter[0], counter[1]};
+                while (!AtomicCompareAndSwap(counter.data(), u128{expected[0] + 1, expected[1] + 1},
+                                             expected)) {
+                    expected = {counter[0], counter[1]};
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(counter[0] == NumThreads * NumIncrements);
+    REQUIRE(counter[1] == NumThreads * NumIncrements);
+}
+
+} // namespace Common
@@ -0,0 +1,91 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/lz4_compression.h"
+#include "common/zstd_compression.h"
+
+namespace Common::Compression {
+
+namespace {
+
+/// Data with runs and repeats to compress, mixed with noise so it doesn't collapse entirely.
+std::vector<u8> MakeData(std::size_t size) {
+    std::vector<u8> data(size);
+    u32 state = 0x12345678;
+    for (std::size_t i = 0; i < size; ++i) {
+        if ((i / 0x100) % 4 == 3) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            data[i] = static_cast<u8>(state);
+        } else {
+            data[i] = static_cast<u8>(i / 0x40 + (i & 0x7));
+        }
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Compression[LZ4]", "[common]") {
+    const std::vector<u8> data = MakeData(0x12345);
+    const std::vector<u8> compressed = CompressDataLZ4(data.data(), data.size());
+    REQUIRE(compressed.size() < data.size());
+    REQUIRE(DecompressDataLZ4(compressed, data.size()) == data);
+
+    std::vector<u8> output(data.size());
+    REQUIRE(DecompressDataLZ4(compressed.data(), compressed.size(), output.data(), output.size()));
+    REQUIRE(output == data);
+
+    // The size has to match exactly
+    REQUIRE(!DecompressDataLZ4(compressed.data(), compressed.size(), output.data(),
+                               output.size() - 1));
+}
+
+TEST_CASE("Compression[ZSTD]", "[common]") {
+    const std::vector<u8> data = MakeData(0x12345);
+    const std::vector<u8> compressed = CompressDataZSTDDefault(data.data(), data.size());
+    REQUIRE(compressed.size() < data.size());
+    REQUIRE(DecompressDataZSTD(compressed) == data);
+
+    std::vector<u8> output(data.size());
+    REQUIRE(DecompressDataZSTD(compressed.data(), compressed.size(), output.data(), output.size()));
+    REQUIRE(output == data);
+
+    REQUIRE(!DecompressDataZSTD(compressed.data(), compressed.size(), output.data(),
+                                output.size() - 1));
+}
+
+TEST_CASE("Compression[Benchmark]", "[.][benchmark]") {
+    constexpr std::size_t size = 32 * 1024 * 1024;
+    constexpr int rounds = 8;
+    const std::vector<u8> data = MakeData(size);
+    const std::vector<u8> lz4 = CompressDataLZ4(data.data(), size);
+    const std::vector<u8> zstd = CompressDataZSTDDefault(data.data(), size);
+    std::vector<u8> output(size);
+
+    const auto measure = [&](auto&& decompress) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            REQUIRE(decompress());
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(size) * rounds / elapsed.count() / (1024.0 * 1024.0);
+    };
+    const double lz4_speed = measure([&] {
+        return DecompressDataLZ4(lz4.data(), lz4.size(), output.data(), output.size());
+    });
+    const double zstd_speed = measure([&] {
+        return DecompressDataZSTD(zstd.data(), zstd.size(), output.data(), output.size());
+    });
+
+    WARN("Decompression: LZ4 " << lz4_speed << " MiB/s, ZSTD " << zstd_speed << " MiB/s");
+}
+
+} // namespace Common::Compression
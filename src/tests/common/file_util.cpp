@@ -0,0 +1,73 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+
+namespace FileUtil {
+
+namespace {
+
+/// Creates root/a/b/c with a file in each directory and returns the relative paths of all entries.
+std::vector<std::pair<std::string, bool>> MakeTree(const std::string& root) {
+    std::vector<std::pair<std::string, bool>> entries;
+    std::string relative;
+    for (const char* const name : {"a", "b", "c"}) {
+        relative += std::string(relative.empty() ? "" : DIR_SEP) + name;
+        REQUIRE(CreateFullPath(root + DIR_SEP + relative + DIR_SEP));
+        REQUIRE(CreateEmptyFile(root + DIR_SEP + relative + DIR_SEP + "file.bin"));
+        entries.emplace_back(relative, true);
+        entries.emplace_back(relative + DIR_SEP + "file.bin", false);
+    }
+    return entries;
+}
+
+std::vector<std::pair<std::string, bool>> Walk(const std::string& root, unsigned int recursion,
+                                               std::size_t num_threads) {
+    std::mutex mutex;
+    std::vector<std::pair<std::string, bool>> entries;
+    REQUIRE(WalkDirectoryTree(root, recursion, num_threads,
+                              [&](const std::string& directory, const std::string& name,
+                                  bool is_directory) {
+                                  std::lock_guard lock{mutex};
+                                  const std::string path = directory + DIR_SEP + name;
+                                  entries.emplace_back(path.substr(root.size() + 1), is_directory);
+                                  return true;
+                              }));
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("FileUtil::WalkDirectoryTree", "[common]") {
+    const std::string root =
+        GetCurrentDir().value_or(".") + DIR_SEP + "file_util_test" + DIR_SEP + "walk";
+    DeleteDirRecursively(root);
+    std::vector<std::pair<std::string, bool>> entries = MakeTree(root);
+    std::sort(entries.begin(), entries.end());
+
+    REQUIRE(Walk(root, 3, 1) == entries);
+    REQUIRE(Walk(root, 3, 4) == entries);
+
+    // Directories past the recursion limit are listed but not entered
+    REQUIRE(Walk(root, 2, 4).size() == entries.size() - 1);
+    REQUIRE(Walk(root, 0, 4) == std::vector<std::pair<std::string, bool>>{{"a", true}});
+
+    // Stopping the walk fails it
+    REQUIRE(!WalkDirectoryTree(root, 3, 4, [](const std::string&, const std::string&, bool) {
+        return false;
+    }));
+
+    REQUIRE(DeleteDirRecursively(root));
+    REQUIRE(!Exists(root));
+}
+
+} // namespace FileUtil
@@ -0,0 +1,105 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <set>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/hash.h"
+
+namespace Common {
+
+namespace {
+
+std::vector<u8> RandomBytes(std::size_t size, u32 seed) {
+    std::mt19937 generator{seed};
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(generator());
+    }
+    return bytes;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ComputeFastHash64: Every size hashes every byte", "[common]") {
+    // Sizes around the short input limit, the stripes and the blocks of the long input loop
+    for (const std::size_t size : {1, 63, 64, 65, 255, 256, 257, 1023, 1024, 1025, 4097, 65536}) {
+        std::vector<u8> data = RandomBytes(size, static_cast<u32>(size));
+        const u64 hash = ComputeFastHash64(data.data(), data.size());
+        REQUIRE(hash == ComputeFastHash64(data.data(), data.size()));
+
+        std::set<u64> flipped_hashes{hash};
+        for (const std::size_t position : {std::size_t{0}, size / 2, size - 1}) {
+            data[position] ^= 1;
+            flipped_hashes.insert(ComputeFastHash64(data.data(), data.size()));
+            data[position] ^= 1;
+        }
+        // Distinct positions have to give distinct hashes, small sizes repeat positions
+        const std::set<std::size_t> positions{0, size / 2, size - 1};
+        REQUIRE(flipped_hashes.size() == positions.size() + 1);
+    }
+}
+
+TEST_CASE("ComputeFastHash64: Length is part of the hash", "[common]") {
+    const std::vector<u8> zeros(4096);
+    std::set<u64> hashes;
+    for (std::size_t size = 250; size < 4096; size += 7) {
+        hashes.insert(ComputeFastHash64(zeros.data(), size));
+    }
+    REQUIRE(hashes.size() == (4096 - 250 + 6) / 7);
+}
+
+TEST_CASE("IncrementalHash: Matches a full rehash", "[common]") {
+    constexpr std::size_t size = IncrementalHash::BlockSize * 5 + 123;
+    std::vector<u8> data = RandomBytes(size, 1);
+
+    IncrementalHash incremental;
+    incremental.Reset(data.data(), data.size());
+    const u64 original = incremental.Get();
+
+    // Modify a range straddling two blocks, and the partial last block
+    for (const std::size_t offset : {IncrementalHash::BlockSize - 8, size - 10}) {
+        for (std::size_t i = 0; i < 10; ++i) {
+            data[offset + i] ^= 0xFF;
+        }
+        incremental.Update(data.data(), offset, 10);
+
+        IncrementalHash full;
+        full.Reset(data.data(), data.size());
+        REQUIRE(incremental.Get() == full.Get());
+        REQUIRE(incremental.Get() != original);
+    }
+
+    // Undoing the changes brings the original hash back
+    data = RandomBytes(size, 1);
+    incremental.Update(data.data(), 0, size);
+    REQUIRE(incremental.Get() == original);
+}
+
+TEST_CASE("ComputeFastHash64[Benchmark]", "[.][benchmark]") {
+    constexpr std::size_t size = 16 * 1024 * 1024;
+    constexpr int rounds = 16;
+    const std::vector<u8> data = RandomBytes(size, 0);
+
+    u64 sink = 0;
+    const auto measure = [&](auto&& hash) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            sink += hash();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(size) * rounds / elapsed.count() / (1024.0 * 1024.0 * 1024.0);
+    };
+    const double city = measure([&] { return ComputeHash64(data.data(), size); });
+    const double fast = measure([&] { return ComputeFastHash64(data.data(), size); });
+
+    WARN("Throughput: CityHash64 " << city << " GiB/s, fast hash " << fast << " GiB/s ("
+                                   << sink << ")");
+}
+
+} // namespace Common
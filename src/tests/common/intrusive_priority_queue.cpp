@@ -0,0 +1,262 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/intrusive_priority_queue.h"
+#include "common/multi_level_queue.h"
+
+namespace Common {
+
+namespace {
+
+constexpr std::size_t NUM_PRIORITIES = 64;
+
+struct Element {
+    u32 priority = 0;
+    PriorityQueueLink<Element, NUM_PRIORITIES> link;
+
+    PriorityQueueLink<Element, NUM_PRIORITIES>& GetPriorityQueueLink() {
+        return link;
+    }
+    const PriorityQueueLink<Element, NUM_PRIORITIES>& GetPriorityQueueLink() const {
+        return link;
+    }
+};
+
+using Queue = IntrusivePriorityQueue<Element, NUM_PRIORITIES>;
+
+std::vector<Element*> Contents(const Queue& queue) {
+    std::vector<Element*> result;
+    for (Element* element = queue.Front(); element != nullptr; element = queue.Next(element)) {
+        result.push_back(element);
+    }
+    return result;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("IntrusivePriorityQueue", "[common]") {
+    std::array<Element, 6> elements{};
+    Queue queue;
+    REQUIRE(queue.Empty());
+    REQUIRE(queue.Front() == nullptr);
+    REQUIRE(queue.HighestPriority() == NUM_PRIORITIES);
+
+    queue.PushBack(&elements[0], 10);
+    queue.PushBack(&elements[1], 3);
+    queue.PushBack(&elements[2], 10);
+    queue.PushBack(&elements[3], 63);
+    queue.PushFront(&elements[4], 10);
+    REQUIRE(queue.Size() == 5);
+    REQUIRE(queue.HighestPriority() == 3);
+    REQUIRE(Contents(queue) == std::vector<Element*>{&elements[1], &elements[4], &elements[0],
+                                                     &elements[2], &elements[3]});
+
+    queue.Remove(&elements[0]);
+    queue.Remove(&elements[5]);
+    REQUIRE(!queue.Contains(&elements[0]));
+    REQUIRE(queue.Size() == 4);
+    REQUIRE(Contents(queue) ==
+            std::vector<Element*>{&elements[1], &elements[4], &elements[2], &elements[3]});
+
+    queue.ChangePriority(&elements[4], 0);
+    queue.ChangePriority(&elements[1], 63);
+    REQUIRE(queue.Front() == &elements[4]);
+    REQUIRE(queue.Empty(3));
+    REQUIRE(Contents(queue) ==
+            std::vector<Element*>{&elements[4], &elements[2], &elements[3], &elements[1]});
+
+    // Pushing an element that is already queued elsewhere moves it.
+    Queue other;
+    other.PushBack(&elements[2], 5);
+    REQUIRE(other.Contains(&elements[2]));
+    REQUIRE(!queue.Contains(&elements[2]));
+    REQUIRE(queue.Size() == 3);
+    REQUIRE(other.Front(5) == &elements[2]);
+
+    other.Remove(&elements[2]);
+    for (auto* element : Contents(queue)) {
+        queue.Remove(element);
+    }
+    REQUIRE(queue.Empty());
+    REQUIRE(other.Empty());
+}
+
+TEST_CASE("IntrusivePriorityQueue[MatchesMultiLevelQueue]", "[common]") {
+    std::mt19937 rng{0x5C4ED};
+    std::vector<Element> elements(256);
+    std::vector<bool> queued(elements.size());
+    Queue queue;
+    MultiLevelQueue<Element*, NUM_PRIORITIES> reference;
+
+    for (int i = 0; i < 20000; ++i) {
+        const std::size_t index = rng() % elements.size();
+        Element& element = elements[index];
+        const u32 priority = rng() % NUM_PRIORITIES;
+
+        switch (rng() % 4) {
+        case 0:
+        case 1: {
+            if (queued[index]) {
+                reference.remove(&element, element.priority);
+                queue.Remove(&element);
+            }
+            const bool send_back = rng() % 2 == 0;
+            reference.add(&element, priority, send_back);
+            if (send_back) {
+                queue.PushBack(&element, priority);
+            } else {
+                queue.PushFront(&element, priority);
+            }
+            element.priority = priority;
+            queued[index] = true;
+            break;
+        }
+        case 2:
+            reference.remove(&element, element.priority);
+            queue.Remove(&element);
+            queued[index] = false;
+            break;
+        case 3:
+            if (!reference.empty()) {
+                Element* const front = reference.front();
+                REQUIRE(queue.Front() == front);
+                reference.remove(front, front->priority);
+                queue.Remove(front);
+                queued[front - elements.data()] = false;
+            }
+            break;
+        }
+
+        REQUIRE(queue.Size() == reference.size());
+        REQUIRE(queue.HighestPriority() == reference.highest_priority_set());
+    }
+
+    const auto contents = Contents(queue);
+    for (Element* element : contents) {
+        REQUIRE(reference.front() == element);
+        reference.remove(element, element->priority);
+    }
+    REQUIRE(reference.empty());
+}
+
+namespace {
+
+/// Drives a queue the way the scheduler does: the front thread runs, then either yields, goes
+/// to sleep or changes its priority, while sleeping threads wake up and ready ones block.
+template <typename Schedule, typename Unschedule>
+u64 SimulateScheduler(std::vector<Element>& threads, Schedule&& schedule,
+                      Unschedule&& unschedule) {
+    std::mt19937 rng{1234};
+    std::vector<bool> ready(threads.size());
+    std::vector<std::size_t> sleeping;
+
+    const auto wake = [&](std::size_t index) {
+        schedule(&threads[index], threads[index].priority);
+        ready[index] = true;
+    };
+    for (std::size_t index = 0; index < threads.size(); ++index) {
+        threads[index].priority = 24 + rng() % 40;
+        wake(index);
+    }
+
+    u64 checksum = 0;
+    for (int i = 0; i < 200000; ++i) {
+        Element* const running = unschedule(nullptr);
+        if (running == nullptr) {
+            break;
+        }
+        const std::size_t index = running - threads.data();
+        ready[index] = false;
+        checksum = checksum * 31 + index;
+
+        switch (rng() % 4) {
+        case 0:
+            sleeping.push_back(index);
+            break;
+        case 1:
+            running->priority = 24 + rng() % 40;
+            [[fallthrough]];
+        default:
+            wake(index);
+            break;
+        }
+
+        // Most of the time, wake a sleeping thread and block a ready one
+        if (!sleeping.empty() && rng() % 4 != 0) {
+            const std::size_t slot = rng() % sleeping.size();
+            wake(sleeping[slot]);
+            sleeping[slot] = sleeping.back();
+            sleeping.pop_back();
+        }
+        const std::size_t victim = rng() % threads.size();
+        if (ready[victim] && rng() % 2 == 0) {
+            unschedule(&threads[victim]);
+            ready[victim] = false;
+            sleeping.push_back(victim);
+        }
+    }
+    return checksum;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("IntrusivePriorityQueue[Benchmark]", "[.][benchmark]") {
+    constexpr std::size_t num_threads = 512;
+
+    const auto measure = [](auto&& run) {
+        const auto start = std::chrono::steady_clock::now();
+        const u64 checksum = run();
+        const auto end = std::chrono::steady_clock::now();
+        return std::make_pair(checksum,
+                              std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+    };
+
+    // Unscheduling null pops the front thread, like the scheduler switching to it.
+    std::vector<Element> list_threads(num_threads);
+    MultiLevelQueue<Element*, NUM_PRIORITIES> list_queue;
+    const auto [list_checksum, list_time] = measure([&] {
+        return SimulateScheduler(
+            list_threads,
+            [&](Element* thread, u32 priority) { list_queue.add(thread, priority); },
+            [&](Element* thread) -> Element* {
+                if (thread == nullptr) {
+                    if (list_queue.empty()) {
+                        return nullptr;
+                    }
+                    thread = list_queue.front();
+                }
+                list_queue.remove(thread, thread->priority);
+                return thread;
+            });
+    });
+
+    std::vector<Element> intrusive_threads(num_threads);
+    Queue intrusive_queue;
+    const auto [intrusive_checksum, intrusive_time] = measure([&] {
+        return SimulateScheduler(
+            intrusive_threads,
+            [&](Element* thread, u32 priority) { intrusive_queue.PushBack(thread, priority); },
+            [&](Element* thread) {
+                if (thread == nullptr) {
+                    thread = intrusive_queue.Front();
+                }
+                if (thread != nullptr) {
+                    intrusive_queue.Remove(thread);
+                }
+                return thread;
+            });
+    });
+
+    WARN("MultiLevelQueue: " << list_time.count() << " us, IntrusivePriorityQueue: "
+                             << intrusive_time.count() << " us");
+    REQUIRE(list_checksum == intrusive_checksum);
+}
+
+} // namespace Common
@@ -0,0 +1,90 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#define CATCH_CONFIG_EXTERNAL_INTERFACES // For the listener
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "common/memory_accounting.h"
+
+namespace Common::MemoryAccounting {
+
+namespace {
+
+// No code run by the tests accounts audio buffers, so the counters are only changed here
+constexpr Tag TestTag = Tag::AudioBuffers;
+
+Statistics GetTagStatistics() {
+    return GetStatistics()[static_cast<std::size_t>(TestTag)];
+}
+
+/// Prints the host memory peaks after runs including benchmarks, they end up in yuzu-bench's log.
+class MemoryReportListener : public Catch::TestEventListenerBase {
+public:
+    using TestEventListenerBase::TestEventListenerBase;
+
+    void testCaseStarting(const Catch::TestCaseInfo& info) override {
+        if (std::find(info.tags.begin(), info.tags.end(), "benchmark") != info.tags.end()) {
+            ran_benchmarks = true;
+        }
+    }
+
+    void testRunEnded(const Catch::TestRunStats&) override {
+        if (!ran_benchmarks) {
+            return;
+        }
+        for (const auto& usage : GetStatistics()) {
+            fmt::print("Host memory of {}: {} KiB peak\n", usage.name, usage.peak_bytes >> 10);
+        }
+    }
+
+private:
+    bool ran_benchmarks = false;
+};
+
+} // Anonymous namespace
+
+CATCH_REGISTER_LISTENER(MemoryReportListener)
+
+TEST_CASE("MemoryAccounting: Counts allocations and peaks", "[common]") {
+    const u64 base = GetTagStatistics().current_bytes;
+
+    Allocate(TestTag, 0x1000);
+    Allocate(TestTag, 0x3000);
+    Free(TestTag, 0x1000);
+    REQUIRE(GetTagStatistics().current_bytes == base + 0x3000);
+    REQUIRE(GetTagStatistics().peak_bytes >= base + 0x4000);
+
+    Free(TestTag, 0x3000);
+    REQUIRE(GetTagStatistics().current_bytes == base);
+    REQUIRE(std::string(GetTagStatistics().name) == "AudioBuffers");
+}
+
+TEST_CASE("MemoryAccounting: TrackedAllocation", "[common]") {
+    const u64 base = GetTagStatistics().current_bytes;
+    {
+        TrackedAllocation allocation{TestTag, 0x100};
+        REQUIRE(GetTagStatistics().current_bytes == base + 0x100);
+
+        allocation.Resize(0x400);
+        REQUIRE(GetTagStatistics().current_bytes == base + 0x400);
+        allocation.Resize(0x80);
+        REQUIRE(GetTagStatistics().current_bytes == base + 0x80);
+
+        // Ownership of the accounted size moves along
+        TrackedAllocation moved{std::move(allocation)};
+        REQUIRE(moved.GetSize() == 0x80);
+        REQUIRE(allocation.GetSize() == 0);
+        REQUIRE(GetTagStatistics().current_bytes == base + 0x80);
+
+        TrackedAllocation assigned{TestTag, 0x10};
+        assigned = std::move(moved);
+        REQUIRE(GetTagStatistics().current_bytes == base + 0x80);
+    }
+    REQUIRE(GetTagStatistics().current_bytes == base);
+}
+
+} // namespace Common::MemoryAccounting
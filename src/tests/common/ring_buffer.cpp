@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <numeric>
 #include <thread>
@@ -127,4 +128,25 @@ TEST_CASE("RingBuffer: Threaded Test", "[common]") {
     printf("RingBuffer: Threaded Test: full: %zu, empty: %zu\n", full, empty);
 }
 
+TEST_CASE("RingBuffer: Push/Pop[Benchmark]", "[.][benchmark]") {
+    // Stereo samples pushed and popped in the chunk sizes the audio renderer uses
+    constexpr std::size_t chunk = 240;
+    constexpr std::size_t rounds = 1 << 18;
+    RingBuffer<s16, 0x8000, 2> buf;
+    const std::vector<s16> input(chunk * 2, 1);
+    std::vector<s16> output(chunk * 2);
+
+    std::size_t popped = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i) {
+        buf.Push(input.data(), chunk);
+        popped += buf.Pop(output.data(), chunk);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(popped == chunk * rounds);
+    WARN("Throughput: " << static_cast<double>(popped) / elapsed.count() / 1e6
+                        << " million frames/s");
+}
+
 } // namespace Common
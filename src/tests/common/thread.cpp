@@ -0,0 +1,172 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread.h"
+
+namespace Common {
+
+TEST_CASE("Event: Basic Tests", "[common]") {
+    Event event;
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds{1};
+    REQUIRE(!event.WaitUntil(timeout));
+
+    event.Set();
+    event.Wait();
+
+    // It resets itself after a wait and multiple sets collapse into one
+    event.Set();
+    event.Set();
+    event.Wait();
+    REQUIRE(!event.WaitUntil(std::chrono::steady_clock::now()));
+
+    event.Set();
+    event.Reset();
+    REQUIRE(!event.WaitUntil(std::chrono::steady_clock::now()));
+}
+
+TEST_CASE("Event: Threaded Handoff", "[common]") {
+    // The threads take turns, each side only runs after the other one signaled it
+    constexpr int rounds = 10000;
+    Event ping;
+    Event pong;
+    int counter = 0;
+
+    std::thread thread([&] {
+        for (int i = 0; i < rounds; ++i) {
+            ping.Wait();
+            ++counter;
+            pong.Set();
+        }
+    });
+    for (int i = 0; i < rounds; ++i) {
+        ping.Set();
+        pong.Wait();
+        REQUIRE(counter == i + 1);
+    }
+    thread.join();
+}
+
+TEST_CASE("Barrier: Threaded Test", "[common]") {
+    constexpr std::size_t num_threads = 4;
+    constexpr int rounds = 2000;
+    Barrier barrier{num_threads};
+    std::atomic<int> arrived{0};
+    std::atomic<bool> failed{false};
+
+    std::vector<std::thread> threads;
+    for (std::size_t thread = 0; thread < num_threads; ++thread) {
+        threads.emplace_back([&] {
+            for (int round = 0; round < rounds; ++round) {
+                ++arrived;
+                if (!barrier.Sync()) {
+                    failed = true;
+                }
+                // Nobody can be on the next round before everyone left this one
+                if (arrived < (round + 1) * static_cast<int>(num_threads)) {
+                    failed = true;
+                }
+                barrier.Sync();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(!failed);
+    REQUIRE(arrived == rounds * static_cast<int>(num_threads));
+}
+
+TEST_CASE("Barrier: Cancel", "[common]") {
+    Barrier barrier{3};
+    std::atomic<int> failed_syncs{0};
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 2; ++thread) {
+        threads.emplace_back([&] {
+            if (!barrier.Sync()) {
+                ++failed_syncs;
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    barrier.Cancel();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(failed_syncs == 2);
+    REQUIRE(barrier.IsCancelled());
+    REQUIRE(!barrier.Sync());
+}
+
+namespace {
+
+/// Reference event, the implementation Event had before it spun.
+class CondVarEvent {
+public:
+    void Set() {
+        std::lock_guard lock{mutex};
+        is_set = true;
+        condvar.notify_one();
+    }
+
+    void Wait() {
+        std::unique_lock lock{mutex};
+        condvar.wait(lock, [this] { return is_set; });
+        is_set = false;
+    }
+
+private:
+    bool is_set = false;
+    std::condition_variable condvar;
+    std::mutex mutex;
+};
+
+/// Returns the median round trip between two threads handing control back and forth.
+template <typename EventType>
+std::chrono::nanoseconds MeasureRoundTrip(int rounds) {
+    EventType ping;
+    EventType pong;
+    std::thread thread([&] {
+        for (int i = 0; i < rounds; ++i) {
+            ping.Wait();
+            pong.Set();
+        }
+    });
+
+    std::vector<std::chrono::nanoseconds> samples;
+    samples.reserve(rounds);
+    for (int i = 0; i < rounds; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        ping.Set();
+        pong.Wait();
+        samples.push_back(std::chrono::steady_clock::now() - start);
+    }
+    thread.join();
+
+    std::nth_element(samples.begin(), samples.begin() + rounds / 2, samples.end());
+    return samples[rounds / 2];
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Event[Benchmark]", "[.][benchmark]") {
+    constexpr int rounds = 100000;
+    const auto condvar_time = MeasureRoundTrip<CondVarEvent>(rounds);
+    const auto event_time = MeasureRoundTrip<Event>(rounds);
+
+    WARN("Median round trip: condition variable " << condvar_time.count() << " ns, adaptive "
+                                                   << event_time.count() << " ns");
+}
+
+} // namespace Common
@@ -0,0 +1,117 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+TEST_CASE("ThreadPool: Runs every task of a group", "[common]") {
+    ThreadPool pool{4};
+    std::vector<std::atomic<int>> counters(1000);
+    {
+        TaskGroup group{pool};
+        for (auto& counter : counters) {
+            group.Submit([&counter] { ++counter; });
+        }
+        group.Wait();
+    }
+    for (const auto& counter : counters) {
+        REQUIRE(counter == 1);
+    }
+}
+
+TEST_CASE("ThreadPool: Nested tasks", "[common]") {
+    // A single worker has to make progress through tasks that wait on their own groups
+    ThreadPool pool{1};
+    std::atomic<int> leaves{0};
+    TaskGroup group{pool};
+    for (int i = 0; i < 8; ++i) {
+        group.Submit([&] {
+            TaskGroup inner{pool};
+            for (int j = 0; j < 8; ++j) {
+                inner.Submit([&] { ++leaves; });
+            }
+            inner.Wait();
+        });
+    }
+    group.Wait();
+    REQUIRE(leaves == 64);
+}
+
+TEST_CASE("ThreadPool: Priorities", "[common]") {
+    ThreadPool pool{1};
+    Event blocker_started;
+    Event release_blocker;
+    std::mutex mutex;
+    std::vector<TaskPriority> order;
+
+    TaskGroup group{pool};
+    group.Submit([&] {
+        blocker_started.Set();
+        release_blocker.Wait();
+    });
+    // The only worker is busy, queue the rest before letting it go
+    blocker_started.Wait();
+    for (const auto priority : {TaskPriority::Low, TaskPriority::Normal, TaskPriority::High}) {
+        group.Submit(
+            [&, priority] {
+                std::lock_guard lock{mutex};
+                order.push_back(priority);
+            },
+            priority);
+    }
+    release_blocker.Set();
+
+    // Let the worker drain the queues alone, Wait would help it from this thread
+    while (true) {
+        std::lock_guard lock{mutex};
+        if (order.size() == 3) {
+            break;
+        }
+    }
+    group.Wait();
+    REQUIRE(order == std::vector{TaskPriority::High, TaskPriority::Normal, TaskPriority::Low});
+}
+
+TEST_CASE("ThreadPool: Cancellation", "[common]") {
+    ThreadPool pool{1};
+    Event blocker_started;
+    Event release_blocker;
+    std::atomic<int> executed{0};
+
+    TaskGroup group{pool};
+    group.Submit([&] {
+        blocker_started.Set();
+        release_blocker.Wait();
+    });
+    blocker_started.Wait();
+    for (int i = 0; i < 16; ++i) {
+        group.Submit([&] { ++executed; });
+    }
+    group.Cancel();
+    release_blocker.Set();
+    group.Wait();
+
+    REQUIRE(group.IsCancelled());
+    REQUIRE(executed == 0);
+}
+
+TEST_CASE("ThreadPool: Detached tasks finish before the pool is destroyed", "[common]") {
+    std::atomic<int> executed{0};
+    {
+        ThreadPool pool{2};
+        for (int i = 0; i < 100; ++i) {
+            pool.Submit([&] { ++executed; });
+        }
+    }
+    REQUIRE(executed == 100);
+}
+
+} // namespace Common
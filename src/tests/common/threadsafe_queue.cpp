@@ -0,0 +1,175 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/threadsafe_queue.h"
+
+namespace Common {
+
+TEST_CASE("SPSCRingQueue: Basic Tests", "[common]") {
+    SPSCRingQueue<int, 4> queue;
+    REQUIRE(queue.Empty());
+
+    int value;
+    REQUIRE(!queue.Pop(value));
+
+    for (int i = 0; i < 4; ++i) {
+        queue.Push(i);
+    }
+    REQUIRE(queue.Size() == 4);
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(queue.Pop(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE(queue.Empty());
+
+    // The indices wrap around the slots
+    for (int i = 0; i < 10; ++i) {
+        queue.Push(i);
+        REQUIRE(queue.PopWait() == i);
+    }
+}
+
+TEST_CASE("SPSCRingQueue: Threaded Test", "[common]") {
+    // A small queue makes the writer wait for the reader and the reader for the writer
+    SPSCRingQueue<std::vector<std::size_t>, 8> queue;
+    constexpr std::size_t count = 100000;
+
+    std::thread producer{[&queue] {
+        for (std::size_t i = 0; i < count; ++i) {
+            queue.Push(std::vector<std::size_t>(i % 4 + 1, i));
+        }
+    }};
+
+    bool in_order = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto value = queue.PopWait();
+        in_order &= value.size() == i % 4 + 1 && value.front() == i;
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("MPMCQueue: Basic Tests", "[common]") {
+    MPMCQueue<int, 4> queue;
+    REQUIRE(queue.Empty());
+
+    int value;
+    REQUIRE(!queue.Pop(value));
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(queue.Push(i) == static_cast<std::size_t>(i));
+    }
+    REQUIRE(queue.Size() == 4);
+    REQUIRE(!queue.TryPush(4));
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(queue.Pop(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE(queue.Empty());
+
+    // The indices wrap around the slots
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(queue.TryPush(i));
+        REQUIRE(queue.PopWait() == i);
+    }
+}
+
+TEST_CASE("MPMCQueue: Threaded Test", "[common]") {
+    // A small queue makes writers wait for readers and readers for writers
+    constexpr std::size_t num_producers = 4;
+    constexpr std::size_t num_consumers = 3;
+    constexpr std::size_t count = 20000;
+    MPMCQueue<std::size_t, 8> queue;
+
+    std::vector<std::thread> producers;
+    for (std::size_t producer = 0; producer < num_producers; ++producer) {
+        producers.emplace_back([&queue, producer] {
+            for (std::size_t i = 0; i < count; ++i) {
+                queue.Push(producer * count + i);
+            }
+        });
+    }
+
+    // Every value has to come out exactly once, in the order its producer pushed it
+    std::vector<std::atomic<int>> seen(num_producers * count);
+    std::atomic<bool> in_order{true};
+    std::vector<std::thread> consumers;
+    for (std::size_t consumer = 0; consumer < num_consumers; ++consumer) {
+        consumers.emplace_back([&] {
+            std::vector<std::size_t> last(num_producers, 0);
+            for (std::size_t i = 0; i < num_producers * count / num_consumers; ++i) {
+                const std::size_t value = queue.PopWait();
+                const std::size_t producer = value / count;
+                if (value % count < last[producer]) {
+                    in_order = false;
+                }
+                last[producer] = value % count;
+                ++seen[value];
+            }
+        });
+    }
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    for (auto& thread : consumers) {
+        thread.join();
+    }
+    for (std::size_t value; queue.Pop(value);) {
+        ++seen[value];
+    }
+
+    REQUIRE(in_order);
+    for (const auto& times : seen) {
+        REQUIRE(times == 1);
+    }
+}
+
+namespace {
+
+/// Returns the millions of elements per second moved from the producers to a single consumer.
+template <typename Queue>
+double MeasureThroughput(std::size_t num_producers) {
+    constexpr std::size_t count = 200000;
+    Queue queue;
+    std::vector<std::thread> producers;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t producer = 0; producer < num_producers; ++producer) {
+        producers.emplace_back([&queue] {
+            for (std::size_t i = 0; i < count; ++i) {
+                queue.Push(i);
+            }
+        });
+    }
+    for (std::size_t i = 0; i < num_producers * count; ++i) {
+        queue.PopWait();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    return static_cast<double>(num_producers * count) / elapsed.count() / 1e6;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MPMCQueue[Benchmark]", "[.][benchmark]") {
+    for (const std::size_t num_producers : {1, 2, 4, 8}) {
+        const double locked = MeasureThroughput<MPSCQueue<std::size_t>>(num_producers);
+        const double bounded = MeasureThroughput<MPMCQueue<std::size_t, 1024>>(num_producers);
+        WARN(num_producers << " producers: MPSCQueue " << locked << " M/s, MPMCQueue " << bounded
+                           << " M/s");
+    }
+}
+
+} // namespace Common
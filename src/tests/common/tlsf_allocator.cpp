@@ -0,0 +1,213 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <optional>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/tlsf_allocator.h"
+
+namespace Common {
+
+TEST_CASE("TLSFAllocator", "[common]") {
+    TLSFAllocator allocator{0x10000};
+    REQUIRE(allocator.Empty());
+
+    const auto first = allocator.Allocate(0x100, 1);
+    REQUIRE(first);
+    REQUIRE(first->offset == 0);
+
+    // The padding in front of an aligned allocation stays available.
+    const auto aligned = allocator.Allocate(0x10, 0x1000);
+    REQUIRE(aligned);
+    REQUIRE(aligned->offset == 0x1000);
+    const auto small = allocator.Allocate(1, 1);
+    REQUIRE(small);
+    REQUIRE(small->offset < 0x1000);
+    REQUIRE(allocator.GetUsed() == 0x100 + 0x10 + TLSFAllocator::GRANULARITY);
+
+    REQUIRE(!allocator.Allocate(0x10001, 1));
+
+    allocator.Free(first->handle);
+    allocator.Free(aligned->handle);
+    allocator.Free(small->handle);
+    REQUIRE(allocator.Empty());
+
+    // Everything merged back, so the whole space can be handed out at once.
+    const auto stats = allocator.GetStatistics();
+    REQUIRE(stats.free_blocks == 1);
+    REQUIRE(stats.largest_free == 0x10000);
+    REQUIRE(stats.Fragmentation() == 0.0);
+    const auto whole = allocator.Allocate(0x10000, 0x10000);
+    REQUIRE(whole);
+    REQUIRE(whole->offset == 0);
+    REQUIRE(!allocator.Allocate(1, 1));
+}
+
+TEST_CASE("TLSFAllocator[Random]", "[common]") {
+    constexpr u64 space_size = 0x400000;
+    std::mt19937 rng{0x7157F};
+    TLSFAllocator allocator{space_size};
+
+    struct Live {
+        u64 size;
+        u32 handle;
+    };
+    std::map<u64, Live> live;
+    u64 used = 0;
+
+    for (int i = 0; i < 20000; ++i) {
+        if (live.empty() || rng() % 3 != 0) {
+            const u64 size = 1 + rng() % (rng() % 8 == 0 ? 0x40000 : 0x800);
+            const u64 alignment = u64{1} << (rng() % 13);
+            const auto allocation = allocator.Allocate(size, alignment);
+            if (!allocation) {
+                continue;
+            }
+            const u64 rounded = AlignUp(size, TLSFAllocator::GRANULARITY);
+            REQUIRE(allocation->offset % alignment == 0);
+            REQUIRE(allocation->offset + rounded <= space_size);
+
+            // Nothing handed out may overlap a live allocation.
+            const auto next = live.lower_bound(allocation->offset);
+            REQUIRE((next == live.end() || allocation->offset + rounded <= next->first));
+            if (next != live.begin()) {
+                const auto prev = std::prev(next);
+                REQUIRE(prev->first + prev->second.size <= allocation->offset);
+            }
+            live.emplace(allocation->offset, Live{rounded, allocation->handle});
+            used += rounded;
+        } else {
+            auto it = live.begin();
+            std::advance(it, rng() % live.size());
+            allocator.Free(it->second.handle);
+            used -= it->second.size;
+            live.erase(it);
+        }
+        REQUIRE(allocator.GetUsed() == used);
+    }
+
+    for (const auto& [offset, allocation] : live) {
+        allocator.Free(allocation.handle);
+    }
+    REQUIRE(allocator.Empty());
+    REQUIRE(allocator.GetStatistics().largest_free == space_size);
+}
+
+namespace {
+
+/// First fit allocator that scans every live range, like the Vulkan memory manager used to.
+class LinearAllocator {
+public:
+    explicit LinearAllocator(u64 size) : size{size} {}
+
+    std::optional<u64> Allocate(u64 alloc_size, u64 alignment) {
+        u64 iterator = 0;
+        while (iterator + alloc_size <= size) {
+            const u64 left = AlignUp(iterator, alignment);
+            const u64 right = left + alloc_size;
+            const auto overlap =
+                std::find_if(ranges.begin(), ranges.end(), [&](const auto& range) {
+                    return left < range.second && range.first < right;
+                });
+            if (overlap == ranges.end()) {
+                if (right > size) {
+                    break;
+                }
+                ranges.emplace_back(left, right);
+                return left;
+            }
+            iterator = overlap->second;
+        }
+        return std::nullopt;
+    }
+
+    void Free(u64 offset) {
+        ranges.erase(std::find_if(ranges.begin(), ranges.end(),
+                                  [offset](const auto& range) { return range.first == offset; }));
+    }
+
+private:
+    u64 size;
+    std::vector<std::pair<u64, u64>> ranges;
+};
+
+/// Replays the allocations of a texture cache that keeps recycling a working set of surfaces.
+template <typename Allocate, typename Free>
+u64 SimulateTextureChurn(Allocate&& allocate, Free&& release) {
+    std::mt19937 rng{0xC4A5E};
+    std::vector<std::pair<u64, u64>> textures;
+    u64 failures = 0;
+    for (int i = 0; i < 20000; ++i) {
+        if (textures.size() > 1000 || (!textures.empty() && rng() % 2 == 0)) {
+            const std::size_t index = rng() % textures.size();
+            release(textures[index]);
+            textures[index] = textures.back();
+            textures.pop_back();
+            continue;
+        }
+        // Mostly small textures and buffers, with the occasional render target.
+        const u64 size = rng() % 16 == 0 ? 0x100000 + rng() % 0x400000 : 0x400 + rng() % 0x20000;
+        const u64 alignment = rng() % 4 == 0 ? 0x10000 : 0x100;
+        if (const auto allocation = allocate(size, alignment)) {
+            textures.push_back(*allocation);
+        } else {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TLSFAllocator[Benchmark]", "[.][benchmark]") {
+    constexpr u64 space_size = 0x10000000;
+
+    const auto measure = [](auto&& run) {
+        const auto start = std::chrono::steady_clock::now();
+        const u64 failures = run();
+        const auto end = std::chrono::steady_clock::now();
+        return std::make_pair(failures,
+                              std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+    };
+
+    LinearAllocator linear{space_size};
+    const auto [linear_failures, linear_time] = measure([&] {
+        return SimulateTextureChurn(
+            [&](u64 size, u64 alignment) -> std::optional<std::pair<u64, u64>> {
+                if (const auto offset = linear.Allocate(size, alignment)) {
+                    return std::make_pair(*offset, u64{0});
+                }
+                return std::nullopt;
+            },
+            [&](const std::pair<u64, u64>& allocation) { linear.Free(allocation.first); });
+    });
+
+    TLSFAllocator tlsf{space_size};
+    const auto [tlsf_failures, tlsf_time] = measure([&] {
+        return SimulateTextureChurn(
+            [&](u64 size, u64 alignment) -> std::optional<std::pair<u64, u64>> {
+                if (const auto allocation = tlsf.Allocate(size, alignment)) {
+                    return std::make_pair(allocation->offset, u64{allocation->handle});
+                }
+                return std::nullopt;
+            },
+            [&](const std::pair<u64, u64>& allocation) {
+                tlsf.Free(static_cast<u32>(allocation.second));
+            });
+    });
+
+    const auto stats = tlsf.GetStatistics();
+    WARN("Linear: " << linear_time.count() << " us, " << linear_failures << " failures; TLSF: "
+                    << tlsf_time.count() << " us, " << tlsf_failures << " failures, "
+                    << stats.Fragmentation() * 100.0 << "% fragmentation");
+    REQUIRE(tlsf_failures <= linear_failures);
+}
+
+} // namespace Common
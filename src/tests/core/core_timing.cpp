@@ -4,12 +4,20 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <optional>
+#include <random>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/core_timing_wheel.h"
 
 // Numbers are chosen randomly to make sure the correct one is given.
 static constexpr std::array<u64, 5> CB_IDS{{42, 144, 93, 1026, UINT64_C(0xFFFF7FFFF7FFFF)}};
@@ -127,6 +135,65 @@ TEST_CASE("CoreTiming[Threadsave]", "[core]") {
     AdvanceAndCheck(core_timing, 4, MAX_SLICE_LENGTH);
 }
 
+TEST_CASE("CoreTiming[ScheduleEventThreadsafe]", "[core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+
+    Core::Timing::EventType* cb_a = core_timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::Timing::EventType* cb_b = core_timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    core_timing.Advance();
+
+    std::thread host_thread{[&] {
+        core_timing.ScheduleEventThreadsafe(100, cb_a, CB_IDS[0]);
+        core_timing.ScheduleEventThreadsafe(300, cb_b, CB_IDS[1]);
+    }};
+    host_thread.join();
+
+    // Events posted from other threads don't shorten the current slice.
+    REQUIRE(MAX_SLICE_LENGTH == core_timing.GetDowncount());
+
+    // They are picked up at the next slice boundary, which becomes their reference point.
+    core_timing.AddTicks(core_timing.GetDowncount());
+    core_timing.Advance();
+    REQUIRE(100 == core_timing.GetDowncount());
+
+    AdvanceAndCheck(core_timing, 0, 200);
+    AdvanceAndCheck(core_timing, 1, MAX_SLICE_LENGTH);
+}
+
+TEST_CASE("CoreTiming[CoreTimeline]", "[core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+
+    Core::Timing::EventType* cb_a = core_timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+
+    // Enter slice 0
+    core_timing.Advance();
+    core_timing.ScheduleEvent(1000, cb_a, CB_IDS[0]);
+
+    // The slice of a secondary core ends at the next event, not at a shared downcount.
+    REQUIRE(core_timing.AdvanceCore(1));
+    REQUIRE(1000 == core_timing.GetCoreDowncount(1));
+    core_timing.AddCoreTicks(1, 600);
+    REQUIRE(600 == core_timing.GetCoreTicks(1));
+    REQUIRE(1000 == core_timing.GetDowncount());
+
+    // Once the event is due on its timeline, the core has to wait for the main core.
+    core_timing.AddCoreTicks(1, 400);
+    REQUIRE_FALSE(core_timing.AdvanceCore(1));
+
+    AdvanceAndCheck(core_timing, 0, MAX_SLICE_LENGTH);
+
+    REQUIRE(core_timing.AdvanceCore(1));
+    REQUIRE(MAX_SLICE_LENGTH == core_timing.GetCoreDowncount(1));
+
+    // A core that fell behind catches up with the global timeline.
+    REQUIRE(core_timing.AdvanceCore(2));
+    REQUIRE(1000 == core_timing.GetCoreTicks(2));
+}
+
 namespace SharedSlotTest {
 static unsigned int counter = 0;
 
@@ -245,3 +312,160 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == core_timing.GetDowncount());
 }
+
+namespace TimerWheelTest {
+using Event = Core::Timing::TimerWheel::Event;
+
+// Reference queue matching the min-heap CoreTiming used before the timer wheel.
+class HeapQueue {
+public:
+    void Push(const Event& event) {
+        events.push_back(event);
+        std::push_heap(events.begin(), events.end(), Greater);
+    }
+
+    void Remove(const Core::Timing::EventType* type, u64 userdata) {
+        const auto itr = std::remove_if(events.begin(), events.end(), [&](const Event& e) {
+            return e.type == type && e.userdata == userdata;
+        });
+        if (itr != events.end()) {
+            events.erase(itr, events.end());
+            std::make_heap(events.begin(), events.end(), Greater);
+        }
+    }
+
+    std::optional<Event> PopDue(s64 limit) {
+        if (events.empty() || events.front().time > limit) {
+            return std::nullopt;
+        }
+        std::pop_heap(events.begin(), events.end(), Greater);
+        const Event event = events.back();
+        events.pop_back();
+        return event;
+    }
+
+private:
+    static bool Greater(const Event& left, const Event& right) {
+        return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
+    }
+
+    std::vector<Event> events;
+};
+
+// Schedules short timers and cancels most of them again, as audio and syncpoint events do.
+template <typename Queue>
+u64 RunWorkload(Queue& queue, const std::array<Core::Timing::EventType, 8>& types,
+                std::size_t iterations) {
+    std::mt19937_64 rng{1234};
+    u64 fifo_id = 0;
+    u64 checksum = 0;
+    s64 now = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        const auto& type = types[rng() % types.size()];
+        const u64 userdata = rng() % 64;
+        queue.Push({now + static_cast<s64>(rng() % 100000), fifo_id++, userdata, &type});
+        if (rng() % 4 != 0) {
+            queue.Remove(&types[rng() % types.size()], rng() % 64);
+        }
+        if (i % 16 == 0) {
+            now += static_cast<s64>(rng() % 20000);
+            while (const auto event = queue.PopDue(now)) {
+                checksum = checksum * 31 + event->fifo_order;
+            }
+        }
+    }
+    return checksum;
+}
+} // namespace TimerWheelTest
+
+TEST_CASE("CoreTiming[TimerWheelOrder]", "[core]") {
+    using namespace TimerWheelTest;
+
+    std::array<Core::Timing::EventType, 8> types{};
+    std::mt19937_64 rng{42};
+    Core::Timing::TimerWheel wheel;
+    HeapQueue heap;
+    u64 fifo_id = 0;
+    s64 now = 0;
+
+    for (int i = 0; i < 20000; ++i) {
+        // Mix deadlines at, behind and far ahead of the current time to hit every level.
+        const int shift = static_cast<int>(rng() % 40);
+        const s64 delay = static_cast<s64>(rng() % (u64{1} << shift)) - 16;
+        const Event event{now + delay, fifo_id++, rng() % 4, &types[rng() % types.size()]};
+        wheel.Push(event);
+        heap.Push(event);
+
+        if (rng() % 8 == 0) {
+            const auto* type = &types[rng() % types.size()];
+            const u64 userdata = rng() % 4;
+            wheel.Remove(type, userdata);
+            heap.Remove(type, userdata);
+        }
+
+        if (rng() % 4 == 0) {
+            now += static_cast<s64>(rng() % (u64{1} << (rng() % 24)));
+            while (true) {
+                const auto expected = heap.PopDue(now);
+                const auto actual = wheel.PopDue(now);
+                REQUIRE(expected.has_value() == actual.has_value());
+                if (!expected) {
+                    break;
+                }
+                REQUIRE(expected->fifo_order == actual->fifo_order);
+            }
+            wheel.AdvanceTo(now);
+        }
+    }
+}
+
+TEST_CASE("CoreTiming[TimerWheelBenchmark]", "[.][benchmark]") {
+    using namespace TimerWheelTest;
+
+    constexpr std::size_t iterations = 1000000;
+    std::array<Core::Timing::EventType, 8> types{};
+
+    const auto measure = [&](auto& queue) {
+        const auto start = std::chrono::steady_clock::now();
+        const u64 checksum = RunWorkload(queue, types, iterations);
+        const auto end = std::chrono::steady_clock::now();
+        return std::make_pair(checksum,
+                              std::chrono::duration_cast<std::chrono::milliseconds>(end - start));
+    };
+
+    HeapQueue heap;
+    Core::Timing::TimerWheel wheel;
+    const auto [heap_checksum, heap_time] = measure(heap);
+    const auto [wheel_checksum, wheel_time] = measure(wheel);
+
+    WARN("min-heap: " << heap_time.count() << " ms, timer wheel: " << wheel_time.count()
+                      << " ms");
+    REQUIRE(heap_checksum == wheel_checksum);
+}
+
+TEST_CASE("CoreTiming::ScheduleEvent[Benchmark]", "[.][benchmark]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+
+    constexpr std::size_t iterations = 1000000;
+    u64 fired = 0;
+    Core::Timing::EventType* const type =
+        core_timing.RegisterEvent("benchmark", [&fired](u64, s64) { ++fired; });
+    core_timing.Advance();
+
+    // Events land a few slices ahead, slices run every 64 of them to keep the queue populated
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<s64> delay(1, MAX_SLICE_LENGTH * 4);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        core_timing.ScheduleEvent(delay(rng), type, i);
+        if (i % 64 == 63) {
+            core_timing.AddTicks(core_timing.GetDowncount());
+            core_timing.Advance();
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    WARN("ScheduleEvent: " << iterations / elapsed.count() / 1e6 << " million events/s ("
+                           << fired << " fired)");
+}
@@ -0,0 +1,58 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/hex_util.h"
+#include "core/crypto/sha_util.h"
+
+namespace Core::Crypto {
+
+namespace {
+
+std::string HashString(std::string_view message) {
+    const auto hash = SHA256(reinterpret_cast<const u8*>(message.data()), message.size());
+    return Common::HexToString(hash, false);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SHA256", "[core][crypto]") {
+    // FIPS 180-2 examples
+    REQUIRE(HashString("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    REQUIRE(HashString("abc") ==
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    REQUIRE(HashString("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST_CASE("SHA256Context", "[core][crypto]") {
+    const std::vector<u8> message(1000000, 'a');
+
+    SECTION("Updates of varying sizes") {
+        SHA256Context context;
+        std::size_t offset = 0;
+        for (std::size_t size = 1; offset < message.size(); size = size * 3 % 1000 + 1) {
+            const std::size_t length = std::min(size, message.size() - offset);
+            context.Update(message.data() + offset, length);
+            offset += length;
+        }
+        REQUIRE(Common::HexToString(context.Finish(), false) ==
+                "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+
+    SECTION("Reset") {
+        SHA256Context context;
+        context.Update(message.data(), 100);
+        context.Reset();
+        context.Update(message.data(), 0);
+        REQUIRE(context.Finish() == SHA256(message.data(), 0));
+    }
+}
+
+} // namespace Core::Crypto
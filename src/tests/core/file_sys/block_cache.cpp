@@ -0,0 +1,131 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "core/file_sys/block_cache.h"
+
+namespace FileSys {
+
+namespace {
+
+class FakeFile {
+public:
+    explicit FakeFile(std::size_t size) : contents(size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            contents[i] = static_cast<u8>(i * 13 + (i >> 8));
+        }
+    }
+
+    std::size_t Fetch(u8* data, std::size_t length, u64 offset) {
+        ++num_fetches;
+        if (offset >= contents.size()) {
+            return 0;
+        }
+        const std::size_t size = std::min<std::size_t>(length, contents.size() - offset);
+        std::memcpy(data, contents.data() + offset, size);
+        return size;
+    }
+
+    BlockCache::FetchFunction Function() {
+        return [this](u8* data, std::size_t length, u64 offset) {
+            return Fetch(data, length, offset);
+        };
+    }
+
+    std::vector<u8> contents;
+    u32 num_fetches = 0;
+};
+
+bool Matches(const FakeFile& file, const std::vector<u8>& data, u64 offset) {
+    return std::equal(data.begin(), data.end(), file.contents.begin() + offset);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BlockCache[Read]", "[core][file_sys]") {
+    constexpr std::size_t BlockSize = BlockCache::BlockSize;
+    BlockCache cache(BlockSize * BlockCache::NumStripes * 4);
+    FakeFile file(BlockSize * 3 + 100);
+    const u64 id = cache.GenerateFileId();
+    REQUIRE(cache.GenerateFileId() != id);
+
+    SECTION("Reads spanning blocks are served from the cache once fetched") {
+        std::vector<u8> data(300);
+        REQUIRE(cache.Read(id, data.data(), data.size(), BlockSize - 100, false,
+                           file.Function()) == data.size());
+        REQUIRE(Matches(file, data, BlockSize - 100));
+        REQUIRE(file.num_fetches == 2);
+
+        REQUIRE(cache.Read(id, data.data(), data.size(), BlockSize - 200, false,
+                           file.Function()) == data.size());
+        REQUIRE(Matches(file, data, BlockSize - 200));
+        REQUIRE(file.num_fetches == 2);
+        REQUIRE(cache.GetHitCount() == 2);
+        REQUIRE(cache.GetMissCount() == 2);
+    }
+
+    SECTION("Reads are short at the end of the file") {
+        std::vector<u8> data(400);
+        REQUIRE(cache.Read(id, data.data(), data.size(), BlockSize * 3, false, file.Function()) ==
+                100);
+        REQUIRE(cache.Read(id, data.data(), data.size(), BlockSize * 3, false, file.Function()) ==
+                100);
+        REQUIRE(cache.Read(id, data.data(), data.size(), BlockSize * 4, false, file.Function()) ==
+                0);
+    }
+
+    SECTION("Sequential misses read ahead") {
+        std::vector<u8> data(0x1000);
+        REQUIRE(cache.Read(id, data.data(), data.size(), 0, true, file.Function()) ==
+                data.size());
+        REQUIRE(file.num_fetches == 1);
+        for (u64 offset = data.size(); offset + data.size() <= file.contents.size();
+             offset += data.size()) {
+            REQUIRE(cache.Read(id, data.data(), data.size(), offset, true, file.Function()) ==
+                    data.size());
+            REQUIRE(Matches(file, data, offset));
+        }
+        REQUIRE(file.num_fetches == 1);
+    }
+
+    SECTION("Invalidated files are fetched again") {
+        std::vector<u8> data(16);
+        cache.Read(id, data.data(), data.size(), 0, false, file.Function());
+        cache.Invalidate(id);
+        file.contents[0] = ~file.contents[0];
+        cache.Read(id, data.data(), data.size(), 0, false, file.Function());
+        REQUIRE(file.num_fetches == 2);
+        REQUIRE(data[0] == file.contents[0]);
+    }
+
+    SECTION("Large reads skip the cache") {
+        std::vector<u8> data(BlockCache::BypassSize);
+        FakeFile large(BlockCache::BypassSize * 2);
+        REQUIRE(cache.Read(id, data.data(), data.size(), 10, false, large.Function()) ==
+                data.size());
+        REQUIRE(Matches(large, data, 10));
+        REQUIRE(cache.GetMissCount() == 0);
+    }
+}
+
+TEST_CASE("BlockCache[Eviction]", "[core][file_sys]") {
+    // One block per stripe
+    BlockCache cache(BlockCache::BlockSize * BlockCache::NumStripes);
+    FakeFile file(BlockCache::BlockSize * BlockCache::NumStripes * 2);
+    const u64 id = cache.GenerateFileId();
+
+    u8 value{};
+    cache.Read(id, &value, 1, 0, false, file.Function());
+    cache.Read(id, &value, 1, BlockCache::BlockSize * BlockCache::NumStripes, false,
+               file.Function());
+    cache.Read(id, &value, 1, 0, false, file.Function());
+    REQUIRE(file.num_fetches == 3);
+    REQUIRE(value == file.contents[0]);
+}
+
+} // namespace FileSys
@@ -0,0 +1,177 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/zstd_compression.h"
+#include "core/crypto/aes_util.h"
+#include "core/crypto/key_manager.h"
+#include "core/file_sys/compressed_archive.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr u8 BlockSizeExponent = 14;
+constexpr std::size_t BlockSize = std::size_t{1} << BlockSizeExponent;
+constexpr std::size_t DataSize = BlockSize * 3 + 0x1230;
+
+// An encrypted section starting and ending within blocks
+constexpr u64 SectionOffset = 0x6000;
+constexpr u64 SectionSize = 0x8000;
+constexpr Core::Crypto::Key128 SectionKey{0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                                          0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+constexpr std::array<u8, 0x10> SectionCounter{0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7};
+
+template <typename T>
+void Append(std::vector<u8>& out, const T& value) {
+    const auto* const bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+void AppendMagic(std::vector<u8>& out, const char* magic) {
+    out.insert(out.end(), magic, magic + 8);
+}
+
+/// Decrypted NCA contents past the header, the second block doesn't compress.
+std::vector<u8> MakeData() {
+    std::vector<u8> data(DataSize);
+    u32 state = 0x12345678;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        if (i / BlockSize == 1) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            data[i] = static_cast<u8>(state);
+        } else {
+            data[i] = static_cast<u8>(i / 0x100 + (i & 0x7));
+        }
+    }
+    return data;
+}
+
+std::vector<u8> MakeHeader() {
+    std::vector<u8> header(NCZFile::NCAHeaderSize);
+    for (std::size_t i = 0; i < header.size(); ++i) {
+        header[i] = static_cast<u8>(i * 13);
+    }
+    return header;
+}
+
+/// The NCA the NCZ is made from, with its section encrypted.
+std::vector<u8> MakeNCA() {
+    std::vector<u8> nca = MakeHeader();
+    const std::vector<u8> data = MakeData();
+    nca.insert(nca.end(), data.begin(), data.end());
+
+    std::vector<u8> iv(SectionCounter.begin(), SectionCounter.end());
+    u64 counter = SectionOffset >> 4;
+    for (std::size_t i = 0; i < sizeof(u64); ++i) {
+        iv[0xF - i] = static_cast<u8>(counter >> (i * 8));
+    }
+    Core::Crypto::AESCipher<Core::Crypto::Key128> cipher(SectionKey, Core::Crypto::Mode::CTR);
+    cipher.SetIV(iv);
+    cipher.Transcode(nca.data() + SectionOffset, SectionSize, nca.data() + SectionOffset,
+                     Core::Crypto::Op::Encrypt);
+    return nca;
+}
+
+std::vector<u8> MakeNCZ(bool block_compressed = true) {
+    std::vector<u8> ncz = MakeHeader();
+    AppendMagic(ncz, "NCZSECTN");
+    Append(ncz, u64{2});
+    // Section: offset, size, crypto type, padding, key, counter
+    Append(ncz, u64{NCZFile::NCAHeaderSize});
+    Append(ncz, SectionOffset - NCZFile::NCAHeaderSize);
+    Append(ncz, u64{1});
+    Append(ncz, u64{0});
+    Append(ncz, std::array<u8, 0x20>{});
+    Append(ncz, SectionOffset);
+    Append(ncz, SectionSize);
+    Append(ncz, u64{3});
+    Append(ncz, u64{0});
+    Append(ncz, SectionKey);
+    Append(ncz, SectionCounter);
+
+    const std::vector<u8> data = MakeData();
+    if (!block_compressed) {
+        const std::vector<u8> stream =
+            Common::Compression::CompressDataZSTDDefault(data.data(), data.size());
+        ncz.insert(ncz.end(), stream.begin(), stream.end());
+        return ncz;
+    }
+
+    std::vector<std::vector<u8>> blocks;
+    for (std::size_t offset = 0; offset < data.size(); offset += BlockSize) {
+        const std::size_t size = std::min(BlockSize, data.size() - offset);
+        std::vector<u8> block =
+            Common::Compression::CompressDataZSTDDefault(data.data() + offset, size);
+        if (block.size() >= size) {
+            block.assign(data.begin() + offset, data.begin() + offset + size);
+        }
+        blocks.push_back(std::move(block));
+    }
+    REQUIRE(blocks[0].size() < BlockSize);
+    REQUIRE(blocks[1].size() == BlockSize);
+
+    AppendMagic(ncz, "NCZBLOCK");
+    ncz.insert(ncz.end(), {2, 1, 0, BlockSizeExponent});
+    Append(ncz, static_cast<u32>(blocks.size()));
+    Append(ncz, u64{DataSize});
+    for (const auto& block : blocks) {
+        Append(ncz, static_cast<u32>(block.size()));
+    }
+    for (const auto& block : blocks) {
+        ncz.insert(ncz.end(), block.begin(), block.end());
+    }
+    return ncz;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("NCZFile reads like the original NCA", "[core][file_sys]") {
+    const std::vector<u8> nca = MakeNCA();
+    const auto file = NCZFile::Open(std::make_shared<VectorVfsFile>(MakeNCZ(), "game.ncz"));
+    REQUIRE(file != nullptr);
+    REQUIRE(file->GetName() == "game.nca");
+    REQUIRE(file->GetSize() == nca.size());
+    REQUIRE(file->ReadAllBytes() == nca);
+
+    // Reads across the header, blocks and section boundaries
+    for (const auto [offset, length] : std::array<std::pair<std::size_t, std::size_t>, 4>{{
+             {0x3FF0, 0x20},
+             {SectionOffset - 0x7, 0x10},
+             {0x7FF9, BlockSize + 0x13},
+             {nca.size() - 0x100, 0x200},
+         }}) {
+        const std::size_t end = std::min(offset + length, nca.size());
+        REQUIRE(file->ReadBytes(length, offset) ==
+                std::vector<u8>(nca.begin() + offset, nca.begin() + end));
+    }
+
+    SECTION("Sequential reads") {
+        std::vector<u8> read(nca.size());
+        for (std::size_t offset = 0; offset < read.size(); offset += 0x1100) {
+            const std::size_t length = std::min<std::size_t>(0x1100, read.size() - offset);
+            REQUIRE(file->Read(read.data() + offset, length, offset) == length);
+        }
+        REQUIRE(read == nca);
+    }
+}
+
+TEST_CASE("NCZFile rejects unsupported files", "[core][file_sys]") {
+    REQUIRE(NCZFile::Open(std::make_shared<VectorVfsFile>(MakeNCA())) == nullptr);
+    REQUIRE(NCZFile::Open(std::make_shared<VectorVfsFile>(MakeNCZ(false))) == nullptr);
+
+    std::vector<u8> truncated = MakeNCZ();
+    truncated.resize(truncated.size() - 1);
+    REQUIRE(NCZFile::Open(std::make_shared<VectorVfsFile>(std::move(truncated))) == nullptr);
+}
+
+} // namespace FileSys
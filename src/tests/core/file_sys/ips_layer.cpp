@@ -0,0 +1,93 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <numeric>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "core/file_sys/ips_layer.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+VirtualFile MakeBase(std::size_t size) {
+    std::vector<u8> data(size);
+    std::iota(data.begin(), data.end(), u8{0});
+    return std::make_shared<VectorVfsFile>(std::move(data), "main");
+}
+
+/// Applies records to a copy of the base data, the way patches used to be applied
+std::vector<u8> PatchCopy(std::vector<u8> data, u64 offset, const std::vector<u8>& record) {
+    for (std::size_t i = 0; i < record.size() && offset + i < data.size(); ++i) {
+        data[offset + i] = record[i];
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("IPS::PatchIPS", "[core][file_sys]") {
+    const auto base = MakeBase(0x100);
+    // Two bytes at 0x10, an RLE run of four bytes at 0x20 and a record clipped by the file's end
+    const std::vector<u8> ips{
+        'P',  'A',  'T',  'C',  'H',  0x00, 0x00, 0x10, 0x00, 0x02, 0xAA, 0xBB, 0x00,
+        0x00, 0x20, 0x00, 0x00, 0x00, 0x04, 0xCC, 0x00, 0x00, 0xFE, 0x00, 0x04, 0x01,
+        0x02, 0x03, 0x04, 'E',  'O',  'F',
+    };
+
+    const auto patched = PatchIPS(base, std::make_shared<VectorVfsFile>(ips));
+    REQUIRE(patched != nullptr);
+    REQUIRE(patched->GetSize() == base->GetSize());
+
+    auto expected = base->ReadAllBytes();
+    expected = PatchCopy(expected, 0x10, {0xAA, 0xBB});
+    expected = PatchCopy(expected, 0x20, {0xCC, 0xCC, 0xCC, 0xCC});
+    expected = PatchCopy(expected, 0xFE, {1, 2, 3, 4});
+    REQUIRE(patched->ReadAllBytes() == expected);
+    REQUIRE(patched->ReadBytes(3, 0x1F) == std::vector<u8>{0x1F, 0xCC, 0xCC});
+
+    // The base file is left untouched
+    REQUIRE(base->ReadByte(0x10) == u8{0x10});
+
+    std::vector<u8> truncated(ips.begin(), ips.end() - 3);
+    REQUIRE(PatchIPS(base, std::make_shared<VectorVfsFile>(truncated)) == nullptr);
+}
+
+TEST_CASE("IPS::PatchedVfsFile", "[core][file_sys]") {
+    const auto base = MakeBase(0x1000);
+    auto expected = base->ReadAllBytes();
+    const auto patched = PatchedVfsFile::Wrap(base);
+
+    const auto add = [&](u64 offset, const std::vector<u8>& record) {
+        patched->AddRecord(offset, record);
+        expected = PatchCopy(expected, offset, record);
+    };
+
+    add(0x100, std::vector<u8>(0x100, 1));
+    add(0x180, std::vector<u8>(0x10, 2)); // Splits the first record
+    add(0x0F0, std::vector<u8>(0x20, 3)); // Trims its head
+    add(0x1F8, std::vector<u8>(0x10, 4)); // Trims its tail
+    add(0x400, std::vector<u8>(0x10, 5));
+    add(0x3F0, std::vector<u8>(0x40, 6)); // Replaces a record entirely
+    add(0x2000, std::vector<u8>(0x10, 7)); // Past the end of the file
+
+    REQUIRE(patched->GetRecordCount() == 6);
+    REQUIRE(patched->ReadAllBytes() == expected);
+    for (std::size_t offset = 0xE0; offset < 0x440; offset += 0x1F) {
+        const auto read = patched->ReadBytes(0x23, offset);
+        REQUIRE(std::equal(read.begin(), read.end(), expected.begin() + offset));
+    }
+
+    // Patching a patched file stacks records over the same base
+    const auto stacked = PatchedVfsFile::Wrap(patched);
+    stacked->AddRecord(0x180, {8});
+    REQUIRE(stacked->GetRecordCount() == 7);
+    REQUIRE(stacked->ReadByte(0x180) == u8{8});
+    REQUIRE(patched->ReadByte(0x180) == u8{2});
+}
+
+} // namespace FileSys
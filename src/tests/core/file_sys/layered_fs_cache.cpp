@@ -0,0 +1,89 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/file_sys/layered_fs_cache.h"
+#include "core/file_sys/mode.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_real.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+VirtualFile MakeFile(const std::string& name, const std::string& contents) {
+    return std::make_shared<VectorVfsFile>(std::vector<u8>(contents.begin(), contents.end()),
+                                           name);
+}
+
+VirtualFile BuildBaseRomFS() {
+    std::vector<VirtualFile> files;
+    for (int i = 0; i < 50; ++i) {
+        files.push_back(MakeFile(fmt::format("file{}", i), fmt::format("base {}", i)));
+    }
+    auto data = std::make_shared<VectorVfsDirectory>(std::move(files), std::vector<VirtualDir>{},
+                                                     "data");
+    return CreateRomFS(std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{MakeFile("root", "root")}, std::vector<VirtualDir>{data}));
+}
+
+void WriteHostFile(const std::string& path, const std::string& contents) {
+    FileUtil::CreateFullPath(path);
+    FileUtil::WriteStringToFile(false, path, contents);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LayeredFSCache", "[core][file_sys]") {
+    const std::string root = FileUtil::GetCurrentDir().value_or(".") + DIR_SEP + "layeredfs_test";
+    const std::string mod_dir = root + DIR_SEP + "mod" + DIR_SEP + "romfs";
+    const std::string cache_path = root + DIR_SEP + "cache.bin";
+    FileUtil::DeleteDirRecursively(root);
+    WriteHostFile(mod_dir + DIR_SEP + "data" + DIR_SEP + "file3", "modded file");
+    WriteHostFile(mod_dir + DIR_SEP + "data" + DIR_SEP + "new", "new file");
+
+    RealVfsFilesystem filesystem;
+    const VirtualFile base = BuildBaseRomFS();
+    const auto make_cache = [&] {
+        std::vector<VirtualDir> layers{filesystem.OpenDirectory(mod_dir, Mode::Read),
+                                       ExtractRomFS(base)};
+        return LayeredFSCache(cache_path, base, std::move(layers), {});
+    };
+
+    const VirtualFile built = make_cache().Build();
+    REQUIRE(built != nullptr);
+    REQUIRE(FileUtil::Exists(cache_path));
+    const VirtualDir built_dir = ExtractRomFS(built);
+    REQUIRE(built_dir->GetFileRelative("data/file3")->ReadAllBytes().size() == 11);
+    REQUIRE(built_dir->GetFileRelative("data/new") != nullptr);
+    REQUIRE(built_dir->GetFileRelative("data/file4") != nullptr);
+
+    SECTION("Unchanged mods load the cached image") {
+        const VirtualFile loaded = make_cache().Load();
+        REQUIRE(loaded != nullptr);
+        REQUIRE(loaded->ReadAllBytes() == built->ReadAllBytes());
+    }
+
+    SECTION("Changed mods rebuild the image") {
+        WriteHostFile(mod_dir + DIR_SEP + "data" + DIR_SEP + "file3", "modded file, again");
+        REQUIRE(make_cache().Load() == nullptr);
+    }
+
+    SECTION("Added mod files rebuild the image") {
+        WriteHostFile(mod_dir + DIR_SEP + "root2", "");
+        REQUIRE(make_cache().Load() == nullptr);
+    }
+
+    FileUtil::DeleteDirRecursively(root);
+}
+
+} // namespace FileSys
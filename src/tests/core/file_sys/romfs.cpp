@@ -0,0 +1,90 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "common/common_types.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+VirtualFile MakeFile(const std::string& name) {
+    return std::make_shared<VectorVfsFile>(std::vector<u8>(name.begin(), name.end()), name);
+}
+
+std::string ReadString(const VirtualFile& file) {
+    const std::vector<u8> data = file->ReadAllBytes();
+    return std::string(data.begin(), data.end());
+}
+
+VirtualFile BuildRomFS() {
+    std::vector<VirtualFile> many_files;
+    for (int i = 0; i < 500; ++i) {
+        many_files.push_back(MakeFile(fmt::format("file{}", i)));
+    }
+    auto many = std::make_shared<VectorVfsDirectory>(std::move(many_files),
+                                                     std::vector<VirtualDir>{}, "many");
+    auto deep = std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{MakeFile("leaf")},
+                                                     std::vector<VirtualDir>{}, "deep");
+    auto data = std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{MakeFile("b.bin")},
+                                                     std::vector<VirtualDir>{many, deep}, "data");
+    auto root = std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{},
+                                                     std::vector<VirtualDir>{data}, "romfs");
+    return CreateRomFS(root);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ExtractRomFS", "[core][file_sys]") {
+    const VirtualFile romfs = BuildRomFS();
+    REQUIRE(romfs != nullptr);
+
+    SECTION("Truncated extraction stops at the data directory") {
+        const VirtualDir root = ExtractRomFS(romfs);
+        REQUIRE(root != nullptr);
+        REQUIRE(root->GetName().empty());
+        const VirtualDir data = root->GetSubdirectory("data");
+        REQUIRE(data != nullptr);
+        REQUIRE(ReadString(data->GetFile("b.bin")) == "b.bin");
+        REQUIRE(data->GetSubdirectories().size() == 2);
+        REQUIRE(data->GetFiles().size() == 1);
+    }
+
+    SECTION("Paths resolve through the hash tables") {
+        const VirtualDir root = ExtractRomFS(romfs, RomFSExtractionType::Full);
+        REQUIRE(root->GetName() == "data");
+        for (int i = 0; i < 500; i += 7) {
+            const std::string name = fmt::format("file{}", i);
+            const VirtualFile file = root->GetFileRelative("many/" + name);
+            REQUIRE(file != nullptr);
+            REQUIRE(file->GetName() == name);
+            REQUIRE(ReadString(file) == name);
+        }
+        REQUIRE(root->GetFileRelative("deep/leaf") != nullptr);
+        REQUIRE(root->GetFileRelative("many/file500") == nullptr);
+        REQUIRE(root->GetFileRelative("deep/file1") == nullptr);
+        REQUIRE(root->GetFile("leaf") == nullptr);
+        REQUIRE(root->GetSubdirectory("b.bin") == nullptr);
+    }
+
+    SECTION("Listings enumerate every child") {
+        const VirtualDir many = ExtractRomFS(romfs)->GetDirectoryRelative("data/many");
+        REQUIRE(many != nullptr);
+        REQUIRE(many->GetFiles().size() == 500);
+        REQUIRE(many->GetSubdirectories().empty());
+        REQUIRE(many->GetParentDirectory()->GetName() == "data");
+    }
+
+    SECTION("Invalid images are rejected") {
+        REQUIRE(ExtractRomFS(std::make_shared<VectorVfsFile>(std::vector<u8>(0x20))) == nullptr);
+    }
+}
+
+} // namespace FileSys
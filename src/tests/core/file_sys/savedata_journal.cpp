@@ -0,0 +1,165 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_paths.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/file_sys/mode.h"
+#include "core/file_sys/savedata_journal.h"
+#include "core/file_sys/vfs_real.h"
+
+namespace FileSys {
+
+namespace {
+
+void WriteHostFile(const std::string& path, const std::string& contents) {
+    FileUtil::CreateFullPath(path);
+    FileUtil::WriteStringToFile(false, path, contents);
+}
+
+std::string ReadHostFile(const std::string& path) {
+    std::string contents;
+    FileUtil::ReadFileToString(false, path, contents);
+    return contents;
+}
+
+void WriteString(const VirtualFile& file, const std::string& contents) {
+    file->Resize(contents.size());
+    file->WriteBytes(contents.data(), contents.size());
+}
+
+std::string ReadString(const VirtualFile& file) {
+    const auto bytes = file->ReadAllBytes();
+    return std::string(bytes.begin(), bytes.end());
+}
+
+class TestSaveDirectory {
+public:
+    TestSaveDirectory()
+        : path{FileUtil::GetCurrentDir().value_or(".") + DIR_SEP + "savedata_journal_test"} {
+        FileUtil::DeleteDirRecursively(path);
+        FileUtil::CreateFullPath(path + DIR_SEP);
+    }
+
+    ~TestSaveDirectory() {
+        FileUtil::DeleteDirRecursively(path);
+    }
+
+    VirtualDir Open() {
+        return filesystem.OpenDirectory(path, Mode::ReadWrite);
+    }
+
+    std::string HostPath(const std::string& relative) const {
+        return path + DIR_SEP + relative;
+    }
+
+private:
+    std::string path;
+    RealVfsFilesystem filesystem;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("SaveDataJournal::WriteBack", "[core][file_sys]") {
+    TestSaveDirectory save;
+    const auto journal = std::make_shared<SaveDataJournal>(save.Open());
+    const auto root = journal->GetRoot();
+
+    const auto file = root->CreateFile("data.bin");
+    REQUIRE(file != nullptr);
+    for (char c = 'a'; c <= 'z'; ++c) {
+        file->WriteBytes(&c, 1, static_cast<std::size_t>(c - 'a'));
+    }
+
+    // Nothing reaches the host before the commit, but the guest sees its changes
+    REQUIRE(!FileUtil::Exists(save.HostPath("data.bin")));
+    REQUIRE(ReadString(root->GetFile("data.bin")) == "abcdefghijklmnopqrstuvwxyz");
+    REQUIRE(journal->HasPendingChanges());
+
+    REQUIRE(journal->Commit());
+    REQUIRE(!journal->HasPendingChanges());
+    REQUIRE(ReadHostFile(save.HostPath("data.bin")) == "abcdefghijklmnopqrstuvwxyz");
+    REQUIRE(!FileUtil::Exists(save.HostPath(SaveDataJournal::JournalDirectoryName)));
+}
+
+TEST_CASE("SaveDataJournal::Restructure", "[core][file_sys]") {
+    TestSaveDirectory save;
+    WriteHostFile(save.HostPath("old"), "old contents");
+    WriteHostFile(save.HostPath("dir" DIR_SEP "stale"), "stale");
+    WriteHostFile(save.HostPath("keep" DIR_SEP "kept"), "kept");
+
+    const auto journal = std::make_shared<SaveDataJournal>(save.Open());
+    const auto root = journal->GetRoot();
+
+    REQUIRE(root->GetFile("old")->Rename("new"));
+    REQUIRE(root->DeleteSubdirectoryRecursive("dir"));
+    const auto dir = root->CreateSubdirectory("dir");
+    REQUIRE(dir != nullptr);
+    WriteString(dir->CreateFile("fresh"), "fresh");
+    REQUIRE(root->GetSubdirectory("keep")->Rename("moved"));
+
+    REQUIRE(journal->Commit());
+    REQUIRE(!FileUtil::Exists(save.HostPath("old")));
+    REQUIRE(ReadHostFile(save.HostPath("new")) == "old contents");
+    REQUIRE(!FileUtil::Exists(save.HostPath("dir" DIR_SEP "stale")));
+    REQUIRE(ReadHostFile(save.HostPath("dir" DIR_SEP "fresh")) == "fresh");
+    REQUIRE(!FileUtil::Exists(save.HostPath("keep")));
+    REQUIRE(ReadHostFile(save.HostPath("moved" DIR_SEP "kept")) == "kept");
+
+    // Later commits only write what changed since
+    WriteString(root->GetSubdirectory("dir")->GetFile("fresh"), "changed");
+    REQUIRE(journal->Commit());
+    REQUIRE(ReadHostFile(save.HostPath("dir" DIR_SEP "fresh")) == "changed");
+    REQUIRE(ReadHostFile(save.HostPath("new")) == "old contents");
+}
+
+TEST_CASE("SaveDataJournal::CommitOnRelease", "[core][file_sys]") {
+    TestSaveDirectory save;
+    VirtualFile file;
+    {
+        const auto journal = std::make_shared<SaveDataJournal>(save.Open());
+        file = journal->GetRoot()->CreateFile("file");
+    }
+    // Handles keep the overlay alive
+    WriteString(file, "contents");
+    REQUIRE(!FileUtil::Exists(save.HostPath("file")));
+
+    file.reset();
+    REQUIRE(ReadHostFile(save.HostPath("file")) == "contents");
+}
+
+TEST_CASE("SaveDataJournal::Recovery", "[core][file_sys]") {
+    const std::string journal_dir = SaveDataJournal::JournalDirectoryName;
+
+    SECTION("A complete journal is applied") {
+        TestSaveDirectory save;
+        WriteHostFile(save.HostPath("deleted"), "deleted");
+        WriteHostFile(save.HostPath(journal_dir + DIR_SEP "0"), "restored");
+        WriteHostFile(save.HostPath(journal_dir + DIR_SEP "manifest"),
+                      "F 0 deleted\nM 0 sub\nW 0 sub/file with spaces\n");
+
+        const auto journal = std::make_shared<SaveDataJournal>(save.Open());
+        REQUIRE(!FileUtil::Exists(save.HostPath("deleted")));
+        REQUIRE(ReadHostFile(save.HostPath("sub" DIR_SEP "file with spaces")) == "restored");
+        REQUIRE(!FileUtil::Exists(save.HostPath(journal_dir)));
+        REQUIRE(journal->GetRoot()->GetSubdirectory(journal_dir) == nullptr);
+    }
+
+    SECTION("An unfinished journal is discarded") {
+        TestSaveDirectory save;
+        WriteHostFile(save.HostPath("file"), "original");
+        WriteHostFile(save.HostPath(journal_dir + DIR_SEP "0"), "unfinished");
+        WriteHostFile(save.HostPath(journal_dir + DIR_SEP "manifest.tmp"), "W 0 file\n");
+
+        const auto journal = std::make_shared<SaveDataJournal>(save.Open());
+        REQUIRE(ReadHostFile(save.HostPath("file")) == "original");
+        REQUIRE(!FileUtil::Exists(save.HostPath(journal_dir)));
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,89 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_paths.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/file_sys/section_cache.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr std::size_t SectionSize = SectionCacheFile::BlockSize * 5 + 0x1234;
+
+std::vector<u8> MakeSection(u8 seed) {
+    std::vector<u8> data(SectionSize);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7 + (i >> 12) + seed);
+    }
+    return data;
+}
+
+std::shared_ptr<SectionCacheFile> MakeFile(const std::vector<u8>& data, const std::string& path,
+                                           u8 hash_seed) {
+    std::array<u8, 0x20> hash{};
+    hash.fill(hash_seed);
+    return std::make_shared<SectionCacheFile>(std::make_shared<VectorVfsFile>(data), path, hash);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SectionCacheFile", "[core][file_sys]") {
+    const std::string path = FileUtil::GetCurrentDir().value_or(".") + DIR_SEP +
+                             "section_cache_test" + DIR_SEP + "section.bin";
+    FileUtil::Delete(path);
+
+    const std::vector<u8> data = MakeSection(0);
+    const std::size_t offset = SectionCacheFile::BlockSize * 4 + 0x100;
+    const std::size_t length = SectionSize - offset;
+    {
+        const auto file = MakeFile(data, path, 1);
+        REQUIRE(file->GetCachedBlockCount() == 0);
+        REQUIRE(file->GetPointer(0x10, 0) == nullptr);
+        REQUIRE(file->ReadBytes(0x10, 0x20) ==
+                std::vector<u8>(data.begin() + 0x20, data.begin() + 0x30));
+        REQUIRE(file->ReadBytes(length, offset) ==
+                std::vector<u8>(data.begin() + offset, data.end()));
+    }
+    REQUIRE(FileUtil::Exists(path));
+
+    SECTION("Blocks read before are served from the cache") {
+        // The base file is different to tell the cached data apart
+        const auto file = MakeFile(MakeSection(1), path, 1);
+        REQUIRE(file->GetCachedBlockCount() == 3);
+        REQUIRE(file->ReadBytes(0x10, 0x20) ==
+                std::vector<u8>(data.begin() + 0x20, data.begin() + 0x30));
+
+        const u8* pointer = file->GetPointer(length, offset);
+        REQUIRE(pointer != nullptr);
+        REQUIRE(std::vector<u8>(pointer, pointer + length) ==
+                std::vector<u8>(data.begin() + offset, data.end()));
+        REQUIRE(file->GetPointer(SectionCacheFile::BlockSize * 2, 0) == nullptr);
+    }
+
+    SECTION("Blocks read later are added to the cache") {
+        MakeFile(data, path, 1)->ReadBytes(0x10, SectionCacheFile::BlockSize * 2);
+        const auto file = MakeFile(MakeSection(1), path, 1);
+        REQUIRE(file->GetCachedBlockCount() == 4);
+        REQUIRE(file->ReadAllBytes() != data);
+        REQUIRE(file->GetPointer(0x10, SectionCacheFile::BlockSize * 2) != nullptr);
+    }
+
+    SECTION("Caches of another header are ignored") {
+        const std::vector<u8> other_data = MakeSection(1);
+        const auto file = MakeFile(other_data, path, 2);
+        REQUIRE(file->GetCachedBlockCount() == 0);
+        REQUIRE(file->ReadAllBytes() == other_data);
+    }
+
+    FileUtil::Delete(path);
+}
+
+} // namespace FileSys
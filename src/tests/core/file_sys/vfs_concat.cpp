@@ -0,0 +1,76 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "core/file_sys/vfs_concat.h"
+#include "core/file_sys/vfs_static.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+VirtualFile MakeFile(std::size_t size, u8 seed) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(seed + i);
+    }
+    return std::make_shared<VectorVfsFile>(std::move(data));
+}
+
+std::vector<u8> ReadAll(const VirtualFile& file) {
+    std::vector<u8> data(file->GetSize());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        file->Read(&data[i], 1, i);
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ConcatenatedVfsFile::Read", "[core][file_sys]") {
+    const std::vector<VirtualFile> parts{MakeFile(3, 0), MakeFile(0, 0), MakeFile(5, 100),
+                                         MakeFile(1, 200), MakeFile(7, 50)};
+    const auto file = ConcatenatedVfsFile::MakeConcatenatedFile(parts, "test");
+    REQUIRE(file->GetSize() == 16);
+
+    std::vector<u8> expected;
+    for (const auto& part : parts) {
+        const auto bytes = part->ReadAllBytes();
+        expected.insert(expected.end(), bytes.begin(), bytes.end());
+    }
+    REQUIRE(ReadAll(file) == expected);
+
+    SECTION("Ranges crossing several parts") {
+        for (std::size_t offset = 0; offset < expected.size(); ++offset) {
+            for (std::size_t length = 1; length <= expected.size() - offset; ++length) {
+                std::vector<u8> data(length);
+                REQUIRE(file->Read(data.data(), length, offset) == length);
+                REQUIRE(std::equal(data.begin(), data.end(), expected.begin() + offset));
+            }
+        }
+    }
+
+    SECTION("Reads past the end are truncated") {
+        std::vector<u8> data(8);
+        REQUIRE(file->Read(data.data(), data.size(), 12) == 4);
+        REQUIRE(file->Read(data.data(), data.size(), 16) == 0);
+    }
+}
+
+TEST_CASE("ConcatenatedVfsFile::MakeConcatenatedFile with filler", "[core][file_sys]") {
+    std::map<u64, VirtualFile> parts;
+    parts[2] = MakeFile(2, 10);
+    parts[6] = MakeFile(3, 20);
+    const auto file = ConcatenatedVfsFile::MakeConcatenatedFile(0xFF, std::move(parts), "test");
+    REQUIRE(file->GetSize() == 9);
+    REQUIRE(ReadAll(file) == std::vector<u8>{0xFF, 0xFF, 10, 11, 0xFF, 0xFF, 20, 21, 22});
+}
+
+} // namespace FileSys
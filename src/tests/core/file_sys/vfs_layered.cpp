@@ -0,0 +1,66 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "core/file_sys/vfs_layered.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+VirtualFile MakeFile(const std::string& name, const std::string& contents) {
+    return std::make_shared<VectorVfsFile>(std::vector<u8>(contents.begin(), contents.end()),
+                                           name);
+}
+
+std::string ReadString(const VirtualFile& file) {
+    const std::vector<u8> data = file->ReadAllBytes();
+    return std::string(data.begin(), data.end());
+}
+
+/// A layer holding data/<name> and data/<layer name> files, and a top level file of the same name.
+VirtualDir MakeLayer(const std::string& layer_name, const std::vector<std::string>& names) {
+    std::vector<VirtualFile> files;
+    for (const auto& file_name : names) {
+        files.push_back(MakeFile(file_name, layer_name));
+    }
+    files.push_back(MakeFile(layer_name, layer_name));
+    auto data = std::make_shared<VectorVfsDirectory>(std::move(files), std::vector<VirtualDir>{},
+                                                     "data");
+    return std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{MakeFile("top", layer_name)}, std::vector<VirtualDir>{data});
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LayeredVfsDirectory lookups", "[core][file_sys]") {
+    const auto layered = LayeredVfsDirectory::MakeLayeredDirectory(
+        {MakeLayer("mod", {"shared"}), MakeLayer("base", {"shared", "base_only"})});
+    REQUIRE(layered != nullptr);
+
+    // Repeated lookups are served from the cache and resolve the same way
+    for (int i = 0; i < 2; ++i) {
+        REQUIRE(ReadString(layered->GetFileRelative("top")) == "mod");
+        REQUIRE(ReadString(layered->GetFileRelative("data/shared")) == "mod");
+        REQUIRE(ReadString(layered->GetFileRelative("data/base_only")) == "base");
+        REQUIRE(ReadString(layered->GetFileRelative("data/mod")) == "mod");
+        REQUIRE(ReadString(layered->GetFileRelative("data/base")) == "base");
+        REQUIRE(layered->GetFileRelative("data/missing") == nullptr);
+        REQUIRE(layered->GetDirectoryRelative("missing") == nullptr);
+    }
+
+    const auto data = layered->GetSubdirectory("data");
+    REQUIRE(data != nullptr);
+    REQUIRE(data == layered->GetDirectoryRelative("data"));
+    REQUIRE(data->GetFiles().size() == 4);
+    REQUIRE(ReadString(data->GetFile("shared")) == "mod");
+    REQUIRE(ReadString(data->GetFile("base_only")) == "base");
+}
+
+} // namespace FileSys
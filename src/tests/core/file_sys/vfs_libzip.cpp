@@ -0,0 +1,89 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "core/file_sys/vfs_libzip.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+// romfs/stored.bin holds the bytes 0 to 63 stored as they are, romfs/data/deflated.txt holds
+// "yuzu " 100 times deflated
+const std::vector<u8> ArchiveData{
+    0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x21, 0x4E, 0x8C, 0xCE, 0x0E, 0x10, 0x40, 0x00, 0x00, 0x00, 0x40, 0x00,
+    0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x72, 0x6F, 0x6D, 0x66, 0x73, 0x2F,
+    0x73, 0x74, 0x6F, 0x72, 0x65, 0x64, 0x2E, 0x62, 0x69, 0x6E, 0x00, 0x01,
+    0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D,
+    0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+    0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25,
+    0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31,
+    0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D,
+    0x3E, 0x3F, 0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00,
+    0x00, 0x00, 0x21, 0x4E, 0xD2, 0xA6, 0x92, 0xDE, 0x0C, 0x00, 0x00, 0x00,
+    0xF4, 0x01, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x72, 0x6F, 0x6D, 0x66,
+    0x73, 0x2F, 0x64, 0x61, 0x74, 0x61, 0x2F, 0x64, 0x65, 0x66, 0x6C, 0x61,
+    0x74, 0x65, 0x64, 0x2E, 0x74, 0x78, 0x74, 0xAB, 0x2C, 0xAD, 0x2A, 0x55,
+    0xA8, 0x1C, 0x25, 0x46, 0x12, 0x01, 0x00, 0x50, 0x4B, 0x01, 0x02, 0x14,
+    0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x4E, 0x8C,
+    0xCE, 0x0E, 0x10, 0x40, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x72, 0x6F, 0x6D, 0x66, 0x73, 0x2F, 0x73,
+    0x74, 0x6F, 0x72, 0x65, 0x64, 0x2E, 0x62, 0x69, 0x6E, 0x50, 0x4B, 0x01,
+    0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21,
+    0x4E, 0xD2, 0xA6, 0x92, 0xDE, 0x0C, 0x00, 0x00, 0x00, 0xF4, 0x01, 0x00,
+    0x00, 0x17, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x01, 0x6E, 0x00, 0x00, 0x00, 0x72, 0x6F, 0x6D, 0x66, 0x73,
+    0x2F, 0x64, 0x61, 0x74, 0x61, 0x2F, 0x64, 0x65, 0x66, 0x6C, 0x61, 0x74,
+    0x65, 0x64, 0x2E, 0x74, 0x78, 0x74, 0x50, 0x4B, 0x05, 0x06, 0x00, 0x00,
+    0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x83, 0x00, 0x00, 0x00, 0xAF, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+};
+
+} // Anonymous namespace
+
+TEST_CASE("OpenZIP reads stored and compressed entries", "[core][file_sys]") {
+    const auto dir = OpenZIP(std::make_shared<VectorVfsFile>(ArchiveData, "mod.zip"));
+    REQUIRE(dir != nullptr);
+
+    const auto stored = dir->GetFileRelative("romfs/stored.bin");
+    REQUIRE(stored != nullptr);
+    std::vector<u8> expected(64);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        expected[i] = static_cast<u8>(i);
+    }
+    REQUIRE(stored->ReadAllBytes() == expected);
+    REQUIRE(stored->ReadBytes(4, 60) == std::vector<u8>{60, 61, 62, 63});
+
+    const auto deflated = dir->GetFileRelative("romfs/data/deflated.txt");
+    REQUIRE(deflated != nullptr);
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "yuzu ";
+    }
+    REQUIRE(deflated->GetSize() == text.size());
+    REQUIRE(deflated->ReadBytes(5, 10) == std::vector<u8>{'y', 'u', 'z', 'u', ' '});
+
+    // Reading up to the end drops the decompressed contents, later reads decompress them again
+    REQUIRE(deflated->ReadAllBytes() == std::vector<u8>(text.begin(), text.end()));
+    REQUIRE(deflated->ReadAllBytes() == std::vector<u8>(text.begin(), text.end()));
+}
+
+TEST_CASE("OpenZIP rejects invalid archives", "[core][file_sys]") {
+    REQUIRE(OpenZIP(nullptr) == nullptr);
+    REQUIRE(OpenZIP(std::make_shared<VectorVfsFile>(std::vector<u8>(0x100, 0x50))) == nullptr);
+
+    // Without its central directory
+    std::vector<u8> truncated = ArchiveData;
+    truncated.erase(truncated.begin() + 0x80, truncated.end() - 0x16);
+    REQUIRE(OpenZIP(std::make_shared<VectorVfsFile>(std::move(truncated))) == nullptr);
+}
+
+} // namespace FileSys
@@ -0,0 +1,101 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string_view>
+#include <catch2/catch.hpp>
+#include "common/common_funcs.h"
+#include "core/hle/function_hooks.h"
+
+namespace HLE {
+namespace {
+
+constexpr u32 RET_INSTRUCTION = 0xD65F03C0;
+constexpr u32 NOP_INSTRUCTION = 0xD503201F;
+
+struct TestSymbol {
+    u32 name_index;
+    u8 info;
+    u8 other;
+    u16 sh_index;
+    u64 value;
+    u64 size;
+};
+
+template <typename T>
+void Write(Kernel::PhysicalMemory& image, std::size_t offset, const T& value) {
+    std::memcpy(image.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T Read(const Kernel::PhysicalMemory& image, std::size_t offset) {
+    T value;
+    std::memcpy(&value, image.data() + offset, sizeof(T));
+    return value;
+}
+
+/// Builds a module exporting memcpy and a function that isn't hooked, and importing strlen
+Kernel::PhysicalMemory MakeModule() {
+    Kernel::PhysicalMemory image(0x1000);
+    for (std::size_t offset = 0; offset < 0x100; offset += 4) {
+        Write(image, offset, NOP_INSTRUCTION);
+    }
+
+    // MOD0 header pointing at the dynamic section
+    Write<u32>(image, 4, 0x100);
+    Write<u32>(image, 0x100, Common::MakeMagic('M', 'O', 'D', '0'));
+    Write<u32>(image, 0x104, 0x100);
+
+    constexpr std::array<u64, 8> dynamic{6, 0x300, 5, 0x400, 11, sizeof(TestSymbol), 0, 0};
+    Write(image, 0x200, dynamic);
+
+    constexpr std::string_view strings{"\0memcpy\0strlen\0foo\0", 19};
+    std::memcpy(image.data() + 0x400, strings.data(), strings.size());
+
+    constexpr u8 global_function = 0x12;
+    Write(image, 0x300, TestSymbol{});
+    Write(image, 0x318, TestSymbol{1, global_function, 0, 1, 0x40, 0x20});
+    Write(image, 0x330, TestSymbol{8, global_function, 0, 0, 0, 0});
+    Write(image, 0x348, TestSymbol{15, global_function, 0, 1, 0x80, 0x20});
+    return image;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("FunctionHooks::InstallFunctionHooks", "[core]") {
+    auto image = MakeModule();
+    REQUIRE(InstallFunctionHooks(image, 0, 0x100) == 1);
+
+    // memcpy is replaced with "svc #hook; ret"
+    const u32 svc = Read<u32>(image, 0x40);
+    REQUIRE((svc & 0xFFE0001F) == 0xD4000001);
+    REQUIRE(IsFunctionHook((svc >> 5) & 0xFFFF));
+    REQUIRE(Read<u32>(image, 0x44) == RET_INSTRUCTION);
+
+    // Other functions are left alone
+    REQUIRE(Read<u32>(image, 0x80) == NOP_INSTRUCTION);
+}
+
+TEST_CASE("FunctionHooks::InstallFunctionHooks outside of text", "[core]") {
+    auto image = MakeModule();
+    const auto original = image;
+
+    // memcpy lies past the end of .text, so it must not be patched
+    REQUIRE(InstallFunctionHooks(image, 0, 0x40) == 0);
+    REQUIRE(image == original);
+}
+
+TEST_CASE("FunctionHooks::InstallFunctionHooks without MOD0", "[core]") {
+    Kernel::PhysicalMemory image(0x1000);
+    REQUIRE(InstallFunctionHooks(image, 0, 0x1000) == 0);
+}
+
+TEST_CASE("FunctionHooks::IsFunctionHook", "[core]") {
+    // The SVCs of the kernel are never taken for hooks
+    for (u32 svc = 0; svc < 0x80; ++svc) {
+        REQUIRE(!IsFunctionHook(svc));
+    }
+}
+
+} // namespace HLE
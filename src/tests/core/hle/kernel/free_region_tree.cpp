@@ -0,0 +1,86 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <optional>
+#include <random>
+#include "common/common_types.h"
+#include "core/hle/kernel/free_region_tree.h"
+
+namespace Kernel {
+
+namespace {
+
+std::optional<VAddr> ReferenceFirstFit(const std::map<VAddr, u64>& regions, VAddr min_base,
+                                       u64 size) {
+    for (auto it = regions.lower_bound(min_base); it != regions.end(); ++it) {
+        if (it->second >= size) {
+            return it->first;
+        }
+    }
+    return std::nullopt;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("FreeRegionTree[FindFirstFit]", "[kernel]") {
+    FreeRegionTree tree;
+    REQUIRE(!tree.FindFirstFit(0, 1));
+
+    tree.Insert(0x1000, 0x1000);
+    tree.Insert(0x8000, 0x4000);
+    tree.Insert(0x4000, 0x2000);
+    REQUIRE(tree.Size() == 3);
+
+    REQUIRE(tree.FindFirstFit(0, 0x1000) == 0x1000);
+    REQUIRE(tree.FindFirstFit(0, 0x2000) == 0x4000);
+    REQUIRE(tree.FindFirstFit(0x1001, 0x1000) == 0x4000);
+    REQUIRE(tree.FindFirstFit(0, 0x3000) == 0x8000);
+    REQUIRE(!tree.FindFirstFit(0, 0x5000));
+    REQUIRE(!tree.FindFirstFit(0x8001, 1));
+
+    tree.Erase(0x4000);
+    REQUIRE(tree.Size() == 2);
+    REQUIRE(tree.FindFirstFit(0, 0x2000) == 0x8000);
+
+    tree.Clear();
+    REQUIRE(tree.Size() == 0);
+    REQUIRE(!tree.FindFirstFit(0, 1));
+}
+
+TEST_CASE("FreeRegionTree[Randomized]", "[kernel]") {
+    std::mt19937_64 rng{0x1234};
+    FreeRegionTree tree;
+    std::map<VAddr, u64> reference;
+
+    constexpr u64 num_slots = 4096;
+    const auto random_slot = [&] { return std::uniform_int_distribution<u64>{0, num_slots}(rng); };
+    const auto random_size = [&] { return std::uniform_int_distribution<u64>{1, 64}(rng); };
+
+    for (int i = 0; i < 20000; ++i) {
+        const VAddr base = random_slot() * 0x1000;
+        const u64 choice = std::uniform_int_distribution<u64>{0, 2}(rng);
+
+        if (choice == 0 && reference.count(base) == 0) {
+            const u64 size = random_size() * 0x1000;
+            tree.Insert(base, size);
+            reference.emplace(base, size);
+        } else if (choice == 1 && !reference.empty()) {
+            const auto it = reference.lower_bound(base);
+            if (it != reference.end()) {
+                tree.Erase(it->first);
+                reference.erase(it);
+            }
+        } else {
+            const u64 size = random_size() * 0x1000;
+            REQUIRE(tree.FindFirstFit(base, size) == ReferenceFirstFit(reference, base, size));
+        }
+
+        REQUIRE(tree.Size() == reference.size());
+    }
+}
+
+} // namespace Kernel
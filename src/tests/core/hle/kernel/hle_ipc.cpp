@@ -0,0 +1,213 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include "common/common_funcs.h"
+#include "core/core.h"
+#include "core/hle/ipc.h"
+#include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/thread.h"
+
+namespace Kernel {
+
+namespace {
+
+/// Replies to every request with the single word parameter it was sent, plus one.
+class IncrementHandler final : public SessionRequestHandler {
+public:
+    ResultCode HandleSyncRequest(HLERequestContext& context) override {
+        IPC::RequestParser rp{context};
+        const u32 value = rp.Pop<u32>();
+
+        IPC::ResponseBuilder rb{context, 3};
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(value + 1);
+        return RESULT_SUCCESS;
+    }
+};
+
+/// Builds an incoming request for the given command, carrying a single word parameter.
+std::array<u32, IPC::COMMAND_BUFFER_LENGTH> MakeRequest(u32 command, u32 value) {
+    std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf{};
+
+    // The raw data holds the 16 bytes of padding, the payload header, the u64 command id and the
+    // parameter.
+    IPC::CommandHeader header{};
+    header.type.Assign(IPC::CommandType::Request);
+    header.data_size.Assign(4 + sizeof(IPC::DataPayloadHeader) / 4 + 2 + 1);
+    std::memcpy(cmd_buf.data(), &header, sizeof(header));
+
+    IPC::DataPayloadHeader payload_header{};
+    payload_header.magic = Common::MakeMagic('S', 'F', 'C', 'I');
+    std::memcpy(&cmd_buf[4], &payload_header, sizeof(payload_header));
+
+    cmd_buf[6] = command;
+    cmd_buf[8] = value;
+    return cmd_buf;
+}
+
+/**
+ * Builds an incoming request carrying two X, two A, one B and two C descriptors. Descriptor i of
+ * each kind points at 0x1000 * kind + 0x100 * i, with kind 1 to 4 for X, A, B and C.
+ */
+std::array<u32, IPC::COMMAND_BUFFER_LENGTH> MakeRequestWithDescriptors() {
+    std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf{};
+
+    IPC::CommandHeader header{};
+    header.type.Assign(IPC::CommandType::Request);
+    header.num_buf_x_descriptors.Assign(2);
+    header.num_buf_a_descriptors.Assign(2);
+    header.num_buf_b_descriptors.Assign(1);
+    header.data_size.Assign(4 + sizeof(IPC::DataPayloadHeader) / 4 + 2 + 1);
+    header.buf_c_descriptor_flags.Assign(IPC::CommandHeader::BufferDescriptorCFlag{4});
+    std::memcpy(cmd_buf.data(), &header, sizeof(header));
+
+    std::size_t index = 2;
+    for (u32 i = 0; i < 2; ++i) {
+        cmd_buf[index + 1] = 0x1000 + 0x100 * i;
+        index += 2;
+    }
+    for (u32 i = 0; i < 3; ++i) {
+        cmd_buf[index] = 0x10;
+        cmd_buf[index + 1] = (i < 2 ? 0x2000 + 0x100 * i : 0x3000);
+        index += 3;
+    }
+
+    // The raw data starts right after the descriptors, with the payload header aligned to 16
+    // bytes. The C descriptors follow it.
+    const std::size_t buffer_c_offset = index + header.data_size;
+    index = (index + 3) & ~std::size_t{3};
+    IPC::DataPayloadHeader payload_header{};
+    payload_header.magic = Common::MakeMagic('S', 'F', 'C', 'I');
+    std::memcpy(&cmd_buf[index], &payload_header, sizeof(payload_header));
+    cmd_buf[index + 2] = 1;
+
+    for (u32 i = 0; i < 2; ++i) {
+        cmd_buf[buffer_c_offset + 2 * i] = 0x4000 + 0x100 * i;
+        cmd_buf[buffer_c_offset + 2 * i + 1] = 0x10 << 16;
+    }
+    return cmd_buf;
+}
+
+struct Reply {
+    u32 result;
+    u32 value;
+};
+
+/// Parses a request and runs it through the handler, like ServerSession does for HLE services.
+Reply RoundTrip(SharedPtr<ServerSession> session, SessionRequestHandler& handler,
+                const HandleTable& handle_table, u32 value) {
+    auto request = MakeRequest(1, value);
+
+    HLERequestContext context(std::move(session), nullptr);
+    context.PopulateFromIncomingCommandBuffer(handle_table, request.data());
+    handler.HandleSyncRequest(context);
+
+    // The reply is made of the command header, padding, the payload header and the parameters.
+    IPC::RequestParser rp{context.CommandBuffer()};
+    rp.Skip(6, false);
+    Reply reply{};
+    reply.result = rp.Pop<u32>();
+    rp.Skip(1, false);
+    reply.value = rp.Pop<u32>();
+    return reply;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("HLERequestContext[RoundTrip]", "[kernel]") {
+    KernelCore kernel{Core::System::GetInstance()};
+    const auto [server, client] = ServerSession::CreateSessionPair(kernel, "Test");
+    IncrementHandler handler;
+    HandleTable handle_table;
+
+    const Reply first = RoundTrip(server, handler, handle_table, 41);
+    REQUIRE(first.result == RESULT_SUCCESS.raw);
+    REQUIRE(first.value == 42);
+
+    const Reply second = RoundTrip(server, handler, handle_table, 0xFFFFFFFE);
+    REQUIRE(second.result == RESULT_SUCCESS.raw);
+    REQUIRE(second.value == 0xFFFFFFFF);
+}
+
+TEST_CASE("HLERequestContext[Descriptors]", "[kernel]") {
+    KernelCore kernel{Core::System::GetInstance()};
+    const auto [server, client] = ServerSession::CreateSessionPair(kernel, "Test");
+    HandleTable handle_table;
+
+    auto request = MakeRequestWithDescriptors();
+    HLERequestContext context(server, nullptr);
+    context.PopulateFromIncomingCommandBuffer(handle_table, request.data());
+
+    REQUIRE(context.GetCommand() == 1);
+    REQUIRE(context.BufferDescriptorX().size() == 2);
+    REQUIRE(context.BufferDescriptorA().size() == 2);
+    REQUIRE(context.BufferDescriptorB().size() == 1);
+    REQUIRE(context.BufferDescriptorC().size() == 2);
+    for (std::size_t i = 0; i < 2; ++i) {
+        REQUIRE(context.BufferDescriptorX()[i].Address() == 0x1000 + 0x100 * i);
+        REQUIRE(context.BufferDescriptorA()[i].Address() == 0x2000 + 0x100 * i);
+        REQUIRE(context.BufferDescriptorC()[i].Address() == 0x4000 + 0x100 * i);
+        REQUIRE(context.BufferDescriptorC()[i].Size() == 0x10);
+    }
+    REQUIRE(context.BufferDescriptorB()[0].Address() == 0x3000);
+    REQUIRE(context.BufferDescriptorB()[0].Size() == 0x10);
+}
+
+// Measures the HLE side of a svcSendSyncRequest round trip: parsing the request, dispatching it
+// to the handler and building the reply.
+TEST_CASE("HLERequestContext[Benchmark]", "[.][benchmark]") {
+    KernelCore kernel{Core::System::GetInstance()};
+    const auto [server, client] = ServerSession::CreateSessionPair(kernel, "Benchmark");
+    IncrementHandler handler;
+    HandleTable handle_table;
+
+    constexpr u32 iterations = 1000000;
+    u32 value = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < iterations; ++i) {
+        value = RoundTrip(server, handler, handle_table, value).value;
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    WARN("round trip: " << elapsed.count() / iterations << " ns");
+    REQUIRE(value == iterations);
+}
+
+// Measures parsing a request which carries buffer descriptors of every kind.
+TEST_CASE("HLERequestContext[BenchmarkDescriptors]", "[.][benchmark]") {
+    KernelCore kernel{Core::System::GetInstance()};
+    const auto [server, client] = ServerSession::CreateSessionPair(kernel, "Benchmark");
+    HandleTable handle_table;
+    const auto request = MakeRequestWithDescriptors();
+
+    constexpr u32 iterations = 1000000;
+    std::size_t descriptors = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < iterations; ++i) {
+        auto cmd_buf = request;
+        HLERequestContext context(server, nullptr);
+        context.PopulateFromIncomingCommandBuffer(handle_table, cmd_buf.data());
+        descriptors += context.BufferDescriptorC().size();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    WARN("parse: " << elapsed.count() / iterations << " ns");
+    REQUIRE(descriptors == 2 * iterations);
+}
+
+} // namespace Kernel
@@ -0,0 +1,51 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/hle/kernel/slab_heap.h"
+
+namespace Kernel {
+
+TEST_CASE("SlabHeap", "[core][kernel]") {
+    SlabHeap heap{"Test", 24, 8};
+
+    std::vector<void*> objects;
+    for (int i = 0; i < 40; ++i) {
+        void* const object = heap.Allocate();
+        REQUIRE(reinterpret_cast<std::uintptr_t>(object) % 8 == 0);
+        REQUIRE(std::find(objects.begin(), objects.end(), object) == objects.end());
+        objects.push_back(object);
+    }
+
+    auto statistics = heap.GetStatistics();
+    REQUIRE(statistics.live_objects == 40);
+    REQUIRE(statistics.peak_objects == 40);
+    REQUIRE(statistics.capacity >= 40);
+
+    // Freed slots are handed out again before the heap grows.
+    const std::size_t capacity = statistics.capacity;
+    void* const freed = objects[7];
+    heap.Free(freed);
+    REQUIRE(heap.Allocate() == freed);
+
+    for (void* object : objects) {
+        heap.Free(object);
+    }
+    statistics = heap.GetStatistics();
+    REQUIRE(statistics.live_objects == 0);
+    REQUIRE(statistics.peak_objects == 40);
+    REQUIRE(statistics.capacity == capacity);
+
+    const auto all_statistics = GetSlabHeapStatistics();
+    REQUIRE(std::any_of(all_statistics.begin(), all_statistics.end(),
+                        [](const SlabHeapStatistics& entry) {
+                            return std::string_view{entry.name} == "Test";
+                        }));
+}
+
+} // namespace Kernel
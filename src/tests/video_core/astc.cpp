@@ -0,0 +1,130 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/textures/astc.h"
+
+namespace Tegra::Texture::ASTC {
+
+namespace {
+
+/// Void extent block mode with the LDR bit clear and the extent coordinates all set
+constexpr u64 VOID_EXTENT_LDR = 0xFFFFFFFFFFFFFDFCULL;
+
+/// Builds constant color blocks, returning the RGBA8 color each one decodes to.
+std::vector<u32> GenerateBlocks(std::mt19937& rng, std::size_t count, std::vector<u8>& data) {
+    std::vector<u32> colors(count);
+    data.resize(count * 16);
+    for (std::size_t i = 0; i < count; ++i) {
+        const u64 rgba16 = (u64{rng()} << 32) | rng();
+        std::memcpy(&data[i * 16], &VOID_EXTENT_LDR, sizeof(u64));
+        std::memcpy(&data[i * 16 + 8], &rgba16, sizeof(u64));
+        colors[i] = 0;
+        for (u32 component = 0; component < 4; ++component) {
+            colors[i] |= static_cast<u32>((rgba16 >> (component * 16 + 8)) & 0xFF)
+                         << (component * 8);
+        }
+    }
+    return colors;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ASTC[void_extent]", "[video_core]") {
+    std::mt19937 rng(7);
+    for (const auto [width, height, depth, block_width, block_height] :
+         {std::make_tuple(4U, 4U, 1U, 4U, 4U), std::make_tuple(100U, 37U, 2U, 8U, 5U),
+          std::make_tuple(257U, 129U, 1U, 10U, 8U), std::make_tuple(13U, 3U, 6U, 5U, 4U)}) {
+        const u32 blocks_x = (width + block_width - 1) / block_width;
+        const u32 blocks_y = (height + block_height - 1) / block_height;
+        std::vector<u8> data;
+        const std::vector<u32> colors = GenerateBlocks(rng, blocks_x * blocks_y * depth, data);
+
+        const std::vector<u8> decoded =
+            Decompress(data.data(), width, height, depth, block_width, block_height, 1);
+        REQUIRE(decoded.size() == std::size_t{width} * height * depth * 4);
+        bool matches = true;
+        for (u32 z = 0; z < depth; ++z) {
+            for (u32 y = 0; y < height; ++y) {
+                for (u32 x = 0; x < width; ++x) {
+                    const std::size_t block =
+                        (z * blocks_y + y / block_height) * blocks_x + x / block_width;
+                    u32 texel;
+                    std::memcpy(&texel, &decoded[((z * height + y) * width + x) * 4],
+                                sizeof(texel));
+                    matches &= texel == colors[block];
+                }
+            }
+        }
+        REQUIRE(matches);
+
+        // Splitting the rows between threads must not change the result
+        for (const u32 num_threads : {0U, 2U, 3U, 16U, 1000U}) {
+            REQUIRE(Decompress(data.data(), width, height, depth, block_width, block_height,
+                               num_threads) == decoded);
+        }
+    }
+}
+
+TEST_CASE("ASTC[decode_cache]", "[video_core]") {
+    std::mt19937 rng(11);
+    constexpr u32 width = 64;
+    constexpr u32 height = 64;
+    constexpr std::size_t decoded_size = width * height * 4;
+    std::vector<u8> first;
+    std::vector<u8> second;
+    GenerateBlocks(rng, 16 * 16, first);
+    GenerateBlocks(rng, 16 * 16, second);
+
+    DecodeCache cache(decoded_size * 2);
+    const u8* const first_decoded = cache.Decompress(first.data(), width, height, 1, 4, 4).data();
+    REQUIRE(cache.GetResidentBytes() == decoded_size);
+
+    // The same contents are served from the cache
+    REQUIRE(cache.Decompress(first.data(), width, height, 1, 4, 4).data() == first_decoded);
+    REQUIRE(cache.GetResidentBytes() == decoded_size);
+
+    // The same data read with another layout is decoded again
+    REQUIRE(cache.Decompress(first.data(), width / 2, height * 2, 1, 4, 4) ==
+            Decompress(first.data(), width / 2, height * 2, 1, 4, 4));
+
+    // Going over the capacity drops the least recently used result
+    REQUIRE(cache.Decompress(second.data(), width, height, 1, 4, 4) ==
+            Decompress(second.data(), width, height, 1, 4, 4));
+    REQUIRE(cache.GetResidentBytes() == decoded_size * 2);
+    REQUIRE(cache.Decompress(first.data(), width, height, 1, 4, 4) ==
+            Decompress(first.data(), width, height, 1, 4, 4));
+}
+
+TEST_CASE("ASTC::Decompress[Benchmark]", "[.][benchmark]") {
+    constexpr u32 width = 1024;
+    constexpr u32 height = 1024;
+    constexpr int rounds = 8;
+    std::mt19937 rng(0);
+    std::vector<u8> data;
+    GenerateBlocks(rng, (width / 4) * (height / 4), data);
+
+    u64 sink = 0;
+    const auto measure = [&](u32 num_threads) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            sink += Decompress(data.data(), width, height, 1, 4, 4, num_threads)[0];
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(width) * height * rounds / elapsed.count() / 1e6;
+    };
+    const double single = measure(1);
+    const double threaded = measure(0);
+
+    WARN("Decompress: " << single << " Mpixels/s on one thread, " << threaded
+                        << " Mpixels/s threaded (" << sink << ")");
+}
+
+} // namespace Tegra::Texture::ASTC
@@ -0,0 +1,122 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstdlib>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/textures/bc_encoder.h"
+
+namespace Tegra::Texture {
+
+namespace {
+
+std::array<u32, 3> Expand565(u32 packed) {
+    const u32 r = (packed >> 11) & 0x1F;
+    const u32 g = (packed >> 5) & 0x3F;
+    const u32 b = packed & 0x1F;
+    return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+/// Reference BC3 decoder, returns width * height RGBA8 texels.
+std::vector<u8> DecodeBC3(const u8* data, u32 width, u32 height) {
+    std::vector<u8> texels(width * height * 4);
+    for (u32 y = 0; y < height; y += 4) {
+        for (u32 x = 0; x < width; x += 4, data += 16) {
+            std::array<u32, 8> alphas{data[0], data[1]};
+            for (u32 i = 2; i < 8; ++i) {
+                alphas[i] = data[0] > data[1] ? ((8 - i) * data[0] + (i - 1) * data[1]) / 7
+                                              : (i < 6 ? ((6 - i) * data[0] + (i - 1) * data[1]) / 5
+                                                       : (i == 6 ? 0 : 255));
+            }
+            u64 alpha_indices = 0;
+            for (u32 i = 0; i < 6; ++i) {
+                alpha_indices |= u64{data[2 + i]} << (i * 8);
+            }
+            const auto color0 = Expand565(data[8] | (data[9] << 8));
+            const auto color1 = Expand565(data[10] | (data[11] << 8));
+            const u32 color_indices =
+                data[12] | (data[13] << 8) | (data[14] << 16) | (u32{data[15]} << 24);
+
+            for (u32 texel = 0; texel < 16; ++texel) {
+                const u32 px = x + texel % 4;
+                const u32 py = y + texel / 4;
+                if (px >= width || py >= height) {
+                    continue;
+                }
+                u8* const out = &texels[(py * width + px) * 4];
+                const u32 index = (color_indices >> (texel * 2)) & 3;
+                for (u32 c = 0; c < 3; ++c) {
+                    const std::array<u32, 4> palette{color0[c], color1[c],
+                                                     (2 * color0[c] + color1[c]) / 3,
+                                                     (color0[c] + 2 * color1[c]) / 3};
+                    out[c] = static_cast<u8>(palette[index]);
+                }
+                out[3] = static_cast<u8>(alphas[(alpha_indices >> (texel * 3)) & 7]);
+            }
+        }
+    }
+    return texels;
+}
+
+u32 MaxError(const std::vector<u8>& lhs, const std::vector<u8>& rhs) {
+    u32 max_error = 0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        max_error = std::max<u32>(max_error, std::abs(lhs[i] - rhs[i]));
+    }
+    return max_error;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BCEncoder[solid]", "[video_core]") {
+    constexpr u32 width = 6;
+    constexpr u32 height = 5;
+    std::vector<u8> rgba8(width * height * 4);
+    for (std::size_t i = 0; i < rgba8.size(); i += 4) {
+        rgba8[i] = 0xFF;
+        rgba8[i + 1] = 0x80;
+        rgba8[i + 2] = 0x00;
+        rgba8[i + 3] = 0x40;
+    }
+    std::vector<u8> encoded(GetBC3Size(width, height, 1));
+    REQUIRE(encoded.size() == 4 * 16);
+    EncodeBC3(rgba8.data(), width, height, 1, encoded.data());
+
+    // 565 endpoints are exact to the precision of each channel
+    REQUIRE(MaxError(DecodeBC3(encoded.data(), width, height), rgba8) <= 2);
+}
+
+TEST_CASE("BCEncoder[gradient]", "[video_core]") {
+    constexpr u32 width = 32;
+    constexpr u32 height = 32;
+    constexpr u32 depth = 2;
+    std::vector<u8> rgba8(width * height * depth * 4);
+    for (u32 z = 0; z < depth; ++z) {
+        for (u32 y = 0; y < height; ++y) {
+            for (u32 x = 0; x < width; ++x) {
+                u8* const texel = &rgba8[((z * height + y) * width + x) * 4];
+                // Colors of a block lie on a line, which is what BC3 can represent
+                texel[0] = static_cast<u8>((x + y) * 4);
+                texel[1] = static_cast<u8>(255 - (x + y) * 4);
+                texel[2] = static_cast<u8>(z * 128);
+                texel[3] = static_cast<u8>(255 - x * 4);
+            }
+        }
+    }
+    const std::size_t layer_size = GetBC3Size(width, height, 1);
+    std::vector<u8> encoded(GetBC3Size(width, height, depth));
+    REQUIRE(encoded.size() == layer_size * depth);
+    EncodeBC3(rgba8.data(), width, height, depth, encoded.data());
+
+    for (u32 z = 0; z < depth; ++z) {
+        const std::vector<u8> layer(rgba8.begin() + z * width * height * 4,
+                                    rgba8.begin() + (z + 1) * width * height * 4);
+        const std::vector<u8> decoded = DecodeBC3(encoded.data() + z * layer_size, width, height);
+        REQUIRE(MaxError(decoded, layer) <= 12);
+    }
+}
+
+} // namespace Tegra::Texture
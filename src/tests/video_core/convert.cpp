@@ -0,0 +1,63 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/textures/convert.h"
+
+namespace Tegra::Texture {
+
+namespace {
+
+std::vector<u8> MakePixels(std::size_t num_pixels) {
+    std::vector<u8> data(num_pixels * sizeof(u32));
+    u32 state = 0x9E3779B9;
+    for (u8& value : data) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        value = static_cast<u8>(state);
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SwapS8Z24ToZ24S8 moves the stencil", "[video_core]") {
+    const u32 s8z24 = 0xAA123456;
+    for (const bool accelerated : {false, true}) {
+        std::vector<u8> data(16 * sizeof(u32));
+        for (std::size_t i = 0; i < data.size(); i += sizeof(u32)) {
+            std::memcpy(&data[i], &s8z24, sizeof(u32));
+        }
+        SwapS8Z24ToZ24S8(data.data(), 16, false, accelerated);
+        for (std::size_t i = 0; i < data.size(); i += sizeof(u32)) {
+            u32 z24s8;
+            std::memcpy(&z24s8, &data[i], sizeof(u32));
+            REQUIRE(z24s8 == 0x123456AA);
+        }
+    }
+}
+
+TEST_CASE("SwapS8Z24ToZ24S8 SIMD kernels match the generic path", "[video_core]") {
+    // Sizes that leave tails for the 4 and 8 pixel kernels, with an unaligned start
+    for (const std::size_t num_pixels : {0, 1, 3, 4, 7, 8, 9, 15, 17, 33, 1027}) {
+        const std::vector<u8> pixels = MakePixels(num_pixels + 1);
+        for (const bool reverse : {false, true}) {
+            std::vector<u8> expected = pixels;
+            std::vector<u8> result = pixels;
+            SwapS8Z24ToZ24S8(expected.data() + 1, num_pixels, reverse, false);
+            SwapS8Z24ToZ24S8(result.data() + 1, num_pixels, reverse, true);
+            REQUIRE(result == expected);
+
+            // The conversions are the inverse of each other
+            SwapS8Z24ToZ24S8(result.data() + 1, num_pixels, !reverse, true);
+            REQUIRE(result == pixels);
+        }
+    }
+}
+
+} // namespace Tegra::Texture
@@ -0,0 +1,81 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/textures/decoders.h"
+
+namespace Tegra::Texture {
+
+namespace {
+
+std::vector<u8> RandomBytes(std::size_t size, u32 seed) {
+    std::mt19937 rng(seed);
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("UnswizzleTexture[round_trip]", "[video_core]") {
+    // Widths that take the aligned row path and ones that fall back to per pixel copies
+    for (const auto [bytes_per_pixel, width, height, depth, block_height, block_depth] :
+         std::vector<std::tuple<u32, u32, u32, u32, u32, u32>>{
+             {4, 256, 128, 1, 4, 0},
+             {4, 100, 37, 1, 3, 0},
+             {2, 70, 30, 1, 2, 0},
+             {16, 33, 17, 1, 1, 0},
+             {1, 512, 8, 1, 0, 0},
+             {8, 64, 32, 5, 2, 1},
+         }) {
+        const std::vector<u8> linear =
+            RandomBytes(std::size_t{width} * height * depth * bytes_per_pixel, width ^ height);
+        std::vector<u8> swizzled(
+            CalculateSize(true, bytes_per_pixel, width, height, depth, block_height, block_depth));
+        std::vector<u8> input = linear;
+        CopySwizzledData(width, height, depth, bytes_per_pixel, bytes_per_pixel, swizzled.data(),
+                         input.data(), false, block_height, block_depth, 1);
+
+        REQUIRE(UnswizzleTexture(swizzled.data(), 1, 1, bytes_per_pixel, width, height, depth,
+                                 block_height, block_depth, 1) == linear);
+    }
+}
+
+TEST_CASE("UnswizzleTexture[Benchmark]", "[.][benchmark]") {
+    constexpr u32 width = 2048;
+    constexpr u32 height = 2048;
+    constexpr u32 block_height = 4;
+    constexpr int rounds = 16;
+    std::vector<u8> unswizzled(width * height * 4);
+
+    u64 sink = 0;
+    const auto measure = [&](u32 bytes_per_pixel) {
+        const u32 pixel_width = width * 4 / bytes_per_pixel;
+        std::vector<u8> swizzled = RandomBytes(
+            CalculateSize(true, bytes_per_pixel, pixel_width, height, 1, block_height, 0), 0);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            UnswizzleTexture(unswizzled.data(), swizzled.data(), 1, 1, bytes_per_pixel,
+                             pixel_width, height, 1, block_height, 0, 1);
+            sink += unswizzled[i];
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(unswizzled.size()) * rounds / elapsed.count() /
+               (1024.0 * 1024.0);
+    };
+    const double rgba8 = measure(4);
+    const double rgba32f = measure(16);
+
+    WARN("Throughput: 4 bytes per pixel " << rgba8 << " MiB/s, 16 bytes per pixel " << rgba32f
+                                          << " MiB/s (" << sink << ")");
+}
+
+} // namespace Tegra::Texture
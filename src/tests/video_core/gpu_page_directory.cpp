@@ -0,0 +1,168 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/page_table.h"
+#include "video_core/gpu_page_directory.h"
+
+namespace Tegra {
+
+namespace {
+
+constexpr std::size_t PageBits = 16;
+constexpr std::size_t AddressWidth = 40;
+constexpr u64 PageSize = u64{1} << PageBits;
+
+using Directory = PageDirectory<PageBits, AddressWidth>;
+
+struct Mapping {
+    GPUVAddr gpu_addr;
+    u64 size;
+    std::size_t arena_offset;
+};
+
+/// Maps buffers the way nvmap hands them out, from 64 KiB to 16 MiB with gaps between them.
+std::vector<Mapping> GenerateMappings(std::mt19937& rng, std::size_t count,
+                                      std::size_t arena_size) {
+    std::vector<Mapping> mappings;
+    GPUVAddr gpu_addr = 0x100000;
+    for (std::size_t i = 0; i < count; ++i) {
+        const u64 num_pages = u64{1} << (rng() % 9);
+        const u64 size = num_pages * PageSize;
+        const std::size_t arena_pages = (arena_size - size) / PageSize;
+        mappings.push_back({gpu_addr, size, (rng() % (arena_pages + 1)) * PageSize});
+        gpu_addr += size + (rng() % 4) * PageSize;
+        if (rng() % 16 == 0) {
+            // Jump to another part of the address space, like a separate allocator would
+            gpu_addr = (gpu_addr + (u64{1} << 32)) & ~(PageSize - 1);
+        }
+    }
+    return mappings;
+}
+
+template <typename GetPointer>
+void ReadBlock(const GetPointer& get_pointer, GPUVAddr addr, u8* output, std::size_t size) {
+    std::size_t page = addr >> PageBits;
+    std::size_t offset = addr & (PageSize - 1);
+    while (size > 0) {
+        const std::size_t copy_amount = std::min<std::size_t>(PageSize - offset, size);
+        if (const u8* const pointer = get_pointer(page)) {
+            std::memcpy(output, pointer + offset, copy_amount);
+        } else {
+            std::memset(output, 0, copy_amount);
+        }
+        ++page;
+        offset = 0;
+        output += copy_amount;
+        size -= copy_amount;
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PageDirectory[video_core]", "[video_core]") {
+    std::vector<u8> arena(PageSize * 64);
+    auto directory = std::make_unique<Directory>();
+
+    SECTION("Unmapped pages have no pointer") {
+        REQUIRE(directory->GetPointer(0) == nullptr);
+        REQUIRE(directory->GetPointer(Directory::num_pages - 1) == nullptr);
+        REQUIRE(directory->GetAttribute(1234) == Common::PageType::Unmapped);
+        REQUIRE(directory->GetBackingAddr(1234) == 0);
+    }
+
+    SECTION("Mappings span second level tables") {
+        // Crosses the boundary between the first two second level tables
+        const std::size_t first_page = 4096 - 8;
+        directory->Map(first_page, 16, arena.data(), Common::PageType::Memory, 0x8000000);
+        for (std::size_t i = 0; i < 16; ++i) {
+            REQUIRE(directory->GetPointer(first_page + i) == arena.data() + i * PageSize);
+            REQUIRE(directory->GetBackingAddr(first_page + i) == 0x8000000 + i * PageSize);
+            REQUIRE(directory->GetAttribute(first_page + i) == Common::PageType::Memory);
+        }
+        REQUIRE(directory->GetPointer(first_page - 1) == nullptr);
+        REQUIRE(directory->GetPointer(first_page + 16) == nullptr);
+
+        directory->Map(first_page + 4, 8, nullptr, Common::PageType::Unmapped, 0);
+        REQUIRE(directory->GetPointer(first_page + 3) == arena.data() + 3 * PageSize);
+        REQUIRE(directory->GetPointer(first_page + 4) == nullptr);
+        REQUIRE(directory->GetPointer(first_page + 11) == nullptr);
+        REQUIRE(directory->GetAttribute(first_page + 11) == Common::PageType::Unmapped);
+        REQUIRE(directory->GetPointer(first_page + 12) == arena.data() + 12 * PageSize);
+    }
+
+    SECTION("Allocated pages share their backing address") {
+        directory->Map(100, 4, nullptr, Common::PageType::Allocated, 0x1000);
+        REQUIRE(directory->GetPointer(101) == nullptr);
+        REQUIRE(directory->GetBackingAddr(103) == 0x1000);
+        REQUIRE(directory->GetAttribute(103) == Common::PageType::Allocated);
+    }
+}
+
+TEST_CASE("PageDirectory[Benchmark]", "[.][benchmark]") {
+    // Replays texture and buffer cache lookups over nvmap style mappings, against a flat table
+    std::mt19937 rng{0x6B5};
+    std::vector<u8> arena(PageSize * 512);
+    const std::vector<Mapping> mappings = GenerateMappings(rng, 2048, arena.size());
+
+    auto directory = std::make_unique<Directory>();
+    Common::PageTable flat_table{PageBits};
+    flat_table.Resize(AddressWidth);
+    for (const Mapping& mapping : mappings) {
+        u8* const memory = arena.data() + mapping.arena_offset;
+        const std::size_t first_page = mapping.gpu_addr >> PageBits;
+        const std::size_t num_pages = mapping.size >> PageBits;
+        directory->Map(first_page, num_pages, memory, Common::PageType::Memory, 0);
+        for (std::size_t i = 0; i < num_pages; ++i) {
+            flat_table.pointers[first_page + i] = memory + i * PageSize;
+        }
+    }
+
+    std::vector<GPUVAddr> lookups;
+    std::vector<std::pair<GPUVAddr, std::size_t>> reads;
+    for (int i = 0; i < 1000000; ++i) {
+        const Mapping& mapping = mappings[rng() % mappings.size()];
+        lookups.push_back(mapping.gpu_addr + rng() % mapping.size);
+    }
+    for (int i = 0; i < 20000; ++i) {
+        const Mapping& mapping = mappings[rng() % mappings.size()];
+        const std::size_t size = std::min<u64>(mapping.size, 0x1000 << (rng() % 7));
+        reads.emplace_back(mapping.gpu_addr + rng() % (mapping.size - size + 1), size);
+    }
+
+    std::vector<u8> output(0x40000);
+    const auto measure = [&](const auto& get_pointer) {
+        const auto start = std::chrono::steady_clock::now();
+        u64 checksum = 0;
+        for (const GPUVAddr addr : lookups) {
+            checksum += reinterpret_cast<std::uintptr_t>(get_pointer(addr >> PageBits)) +
+                        (addr & (PageSize - 1));
+        }
+        for (const auto& [addr, size] : reads) {
+            ReadBlock(get_pointer, addr, output.data(), size);
+            checksum += output[size - 1];
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::make_pair(checksum,
+                              std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+    };
+
+    const auto [flat_checksum, flat_time] =
+        measure([&flat_table](std::size_t page) { return flat_table.pointers[page]; });
+    const auto [directory_checksum, directory_time] =
+        measure([&directory](std::size_t page) { return directory->GetPointer(page); });
+
+    WARN("Flat table: " << flat_time.count() << " us; PageDirectory: " << directory_time.count()
+                        << " us");
+    REQUIRE(flat_checksum == directory_checksum);
+}
+
+} // namespace Tegra
@@ -0,0 +1,52 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/gpu_profiler.h"
+
+namespace VideoCore {
+
+TEST_CASE("GPUProfiler[MostExpensiveShaders]", "[video_core]") {
+    const std::vector<GPUProfileEvent> events{
+        {"VS 1 FS 2", 0, 1, 0, 100},    {"VS 1 FS 3", 0, 1, 100, 400},
+        {"VS 1 FS 2", 0, 2, 400, 600},  {"CS 4", 0, 2, 600, 650},
+        {"VS 1 FS 3", 1, 1, 1000, 1010},
+    };
+
+    const auto costs = GPUProfiler::GetMostExpensiveShaders(events, 2);
+    REQUIRE(costs.size() == 2);
+    REQUIRE(costs[0].name == "VS 1 FS 3");
+    REQUIRE(costs[0].total_ns == 310);
+    REQUIRE(costs[0].max_ns == 300);
+    REQUIRE(costs[0].count == 2);
+    REQUIRE(costs[1].name == "VS 1 FS 2");
+    REQUIRE(costs[1].total_ns == 300);
+    REQUIRE(costs[1].count == 2);
+
+    REQUIRE(GPUProfiler::GetMostExpensiveShaders(events, 20).size() == 3);
+    REQUIRE(GPUProfiler::GetMostExpensiveShaders({}, 20).empty());
+}
+
+TEST_CASE("GPUProfiler[ChromeTrace]", "[video_core]") {
+    const std::vector<GPUProfileEvent> events{
+        {"VS 1 FS 2", 0, 1, 0, 1500},
+        {"VS \"quoted\"", 0, 2, 1500, 2000},
+        {"CS 4", 1, 1, 5000, 6000},
+    };
+
+    const std::string json = GPUProfiler::SerializeChromeTrace(events);
+    REQUIRE(json.find("{\"traceEvents\":[") == 0);
+    REQUIRE(json.find("\"name\":\"Frame 0\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+                      "\"ts\":0.000,\"dur\":2.000}") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"Pass 2\",\"cat\":\"pass\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+                      "\"ts\":1.500,\"dur\":0.500}") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"Frame 1\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"VS \\\"quoted\\\"\",\"cat\":\"draw\"") != std::string::npos);
+    REQUIRE(json.find(",\n]") == std::string::npos);
+    REQUIRE(json.substr(json.size() - 4) == "\n]}\n");
+}
+
+} // namespace VideoCore
@@ -0,0 +1,219 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/macro_compiler.h"
+#include "video_core/macro_engine_interface.h"
+#include "video_core/macro_interpreter.h"
+#include "video_core/macro_opcode.h"
+
+namespace Tegra {
+
+namespace {
+
+using Macro::ALUOperation;
+using Macro::BranchCondition;
+using Macro::Opcode;
+using Macro::Operation;
+using Macro::ResultOperation;
+
+/// Engine which records every method a macro calls.
+class FakeEngine final : public MacroEngineInterface {
+public:
+    explicit FakeEngine(const std::vector<u32>& code, u32 seed = 0)
+        : macro_memory{std::make_unique<MacroMemory>()} {
+        macro_memory->fill(0);
+        std::copy(code.begin(), code.end(), macro_memory->begin());
+
+        std::mt19937 rng{seed};
+        for (u32& value : registers) {
+            value = rng() % 4 == 0 ? 0 : static_cast<u32>(rng());
+        }
+    }
+
+    const MacroMemory& GetMacroMemory() const override {
+        return *macro_memory;
+    }
+
+    void CallMethodFromMacro(u32 method, u32 argument) override {
+        calls.emplace_back(method, argument);
+        registers[method % registers.size()] = argument;
+    }
+
+    u32 ReadRegisterFromMacro(u32 method) const override {
+        return registers[method % registers.size()];
+    }
+
+    std::vector<std::pair<u32, u32>> calls;
+
+private:
+    std::unique_ptr<MacroMemory> macro_memory;
+    std::array<u32, 0x1000> registers{};
+};
+
+Opcode MakeOpcode(Operation operation, ResultOperation result, u32 dst, u32 src_a) {
+    Opcode opcode{};
+    opcode.operation.Assign(operation);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    return opcode;
+}
+
+u32 AddImmediate(ResultOperation result, u32 dst, u32 src_a, s32 immediate) {
+    Opcode opcode = MakeOpcode(Operation::AddImmediate, result, dst, src_a);
+    opcode.immediate.Assign(immediate);
+    return opcode.raw;
+}
+
+u32 ALU(ALUOperation operation, ResultOperation result, u32 dst, u32 src_a, u32 src_b) {
+    Opcode opcode = MakeOpcode(Operation::ALU, result, dst, src_a);
+    opcode.src_b.Assign(src_b);
+    opcode.alu_operation.Assign(operation);
+    return opcode.raw;
+}
+
+u32 Branch(BranchCondition condition, u32 src_a, s32 offset, bool annul, bool exit = false) {
+    Opcode opcode = MakeOpcode(Operation::Branch, {}, 0, src_a);
+    opcode.immediate.Assign(offset);
+    opcode.branch_condition.Assign(condition);
+    opcode.branch_annul.Assign(annul ? 1 : 0);
+    opcode.is_exit.Assign(exit ? 1 : 0);
+    return opcode.raw;
+}
+
+u32 Exit(u32 raw) {
+    Opcode opcode{raw};
+    opcode.is_exit.Assign(1);
+    return opcode.raw;
+}
+
+/// Generates a random macro that consumes only its first parameter and only branches forward.
+std::vector<u32> RandomMacro(std::mt19937& rng) {
+    constexpr std::array<ALUOperation, 9> alu_operations{
+        ALUOperation::Add, ALUOperation::AddWithCarry, ALUOperation::Subtract,
+        ALUOperation::SubtractWithBorrow, ALUOperation::Xor, ALUOperation::Or,
+        ALUOperation::And, ALUOperation::AndNot, ALUOperation::Nand};
+    constexpr std::array<ResultOperation, 4> result_operations{
+        ResultOperation::Move, ResultOperation::MoveAndSetMethod, ResultOperation::MoveAndSend,
+        ResultOperation::MoveAndSetMethodSend};
+
+    const u32 length = 4 + rng() % 40;
+    std::vector<u32> code(length);
+    bool previous_was_branch = true;
+    for (u32 index = 0; index < length; ++index) {
+        Opcode opcode{static_cast<u32>(rng())};
+        opcode.is_exit.Assign(0);
+        opcode.result_operation.Assign(result_operations[rng() % result_operations.size()]);
+        opcode.bf_size.Assign(opcode.bf_size % 31);
+
+        // Branches never sit in a delay slot, and only jump to instructions before the exit.
+        const u32 kind = previous_was_branch || index + 3 > length ? rng() % 6 : rng() % 7;
+        switch (kind) {
+        case 0:
+            opcode.operation.Assign(Operation::ALU);
+            opcode.alu_operation.Assign(alu_operations[rng() % alu_operations.size()]);
+            break;
+        case 1:
+            opcode.operation.Assign(Operation::AddImmediate);
+            break;
+        case 2:
+            opcode.operation.Assign(Operation::ExtractInsert);
+            break;
+        case 3:
+            // Keep the register shift amount at zero.
+            opcode.operation.Assign(rng() % 2 == 0 ? Operation::ExtractShiftLeftImmediate
+                                                   : Operation::ExtractShiftLeftRegister);
+            opcode.src_a.Assign(0);
+            break;
+        case 4:
+        case 5:
+            opcode.operation.Assign(Operation::Read);
+            break;
+        case 6:
+            opcode.operation.Assign(Operation::Branch);
+            opcode.immediate.Assign(static_cast<s32>(1 + rng() % (length - 2 - index)));
+            break;
+        }
+        previous_was_branch = kind == 6;
+        code[index] = opcode.raw;
+    }
+    code[length - 2] = Exit(code[length - 2]);
+    return code;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MacroCompiler[Loop]", "[video_core]") {
+    // Sends every parameter after the count in $r1 to consecutive methods starting at 0x100.
+    const std::vector<u32> code{
+        AddImmediate(ResultOperation::MoveAndSetMethod, 2, 0, 0x1100),
+        ALU(ALUOperation::Add, ResultOperation::IgnoreAndFetch, 3, 0, 0),
+        AddImmediate(ResultOperation::Move, 1, 1, -1),
+        Branch(BranchCondition::NotZero, 1, -2, false, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 3, 0),
+    };
+    const std::vector<u32> parameters{3, 10, 20, 30};
+
+    FakeEngine engine{code};
+    MacroCompiler compiler{engine};
+    REQUIRE(compiler.Execute(0, parameters.size(), parameters.data()));
+    REQUIRE(engine.calls ==
+            std::vector<std::pair<u32, u32>>{{0x100, 10}, {0x101, 20}, {0x102, 30}});
+}
+
+TEST_CASE("MacroCompiler[Fallback]", "[video_core]") {
+    Opcode unused{};
+    unused.operation.Assign(Operation::Unused);
+    const std::vector<u32> parameters{0};
+
+    FakeEngine invalid_engine{{unused.raw, 0}};
+    MacroCompiler invalid_compiler{invalid_engine};
+    REQUIRE(!invalid_compiler.Execute(0, parameters.size(), parameters.data()));
+
+    // Branching inside a delay slot is not valid either.
+    const u32 branch = Branch(BranchCondition::Zero, 0, 1, false);
+    const u32 nop = AddImmediate(ResultOperation::Move, 0, 0, 0);
+    FakeEngine delay_engine{{branch, branch, Exit(nop), nop}};
+    MacroCompiler delay_compiler{delay_engine};
+    REQUIRE(!delay_compiler.Execute(0, parameters.size(), parameters.data()));
+
+    // Whatever follows the exit delay slot is never looked at.
+    FakeEngine exit_engine{{Exit(nop), nop, unused.raw}};
+    MacroCompiler exit_compiler{exit_engine};
+    REQUIRE(exit_compiler.Execute(0, parameters.size(), parameters.data()));
+}
+
+TEST_CASE("MacroCompiler[MatchesInterpreter]", "[video_core]") {
+    std::mt19937 rng{0x3ACE0};
+    for (u32 iteration = 0; iteration < 2000; ++iteration) {
+        const std::vector<u32> code = RandomMacro(rng);
+        const std::vector<u32> parameters{static_cast<u32>(rng())};
+        const u32 seed = static_cast<u32>(rng());
+
+        FakeEngine interpreted{code, seed};
+        MacroInterpreter interpreter{interpreted};
+        interpreter.Execute(0, parameters.size(), parameters.data());
+
+        FakeEngine compiled{code, seed};
+        MacroCompiler compiler{compiled};
+        REQUIRE(compiler.Execute(0, parameters.size(), parameters.data()));
+        REQUIRE(compiled.calls == interpreted.calls);
+
+        // Running the cached translation again gives the same result.
+        compiled.calls.clear();
+        interpreted.calls.clear();
+        interpreter.Execute(0, parameters.size(), parameters.data());
+        REQUIRE(compiler.Execute(0, parameters.size(), parameters.data()));
+        REQUIRE(compiled.calls == interpreted.calls);
+    }
+}
+
+} // namespace Tegra
@@ -0,0 +1,155 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+#include <boost/icl/interval_map.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/page_index.h"
+
+namespace VideoCommon {
+
+namespace {
+
+struct Range {
+    CacheAddr start;
+    CacheAddr end;
+    int id;
+};
+
+template <typename Index>
+std::vector<int> Collect(const Index& index, CacheAddr start, CacheAddr end) {
+    std::vector<int> ids;
+    index.ForEachInRange(start, end, [&ids](int id) { ids.push_back(id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+/// Generates the kind of ranges a buffer cache sees, mostly small with the odd large buffer.
+std::vector<Range> GenerateRanges(std::mt19937& rng, std::size_t count) {
+    std::vector<Range> ranges;
+    for (std::size_t i = 0; i < count; ++i) {
+        const CacheAddr start = 0x10000000 + (rng() % 0x4000000 & ~CacheAddr{0xFF});
+        const bool is_large = rng() % 16 == 0;
+        const CacheAddr size = is_large ? 0x10000 + rng() % 0x200000 : 0x100 + rng() % 0x4000;
+        ranges.push_back({start, start + size, static_cast<int>(i)});
+    }
+    return ranges;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PageIndex", "[video_core]") {
+    PageIndex<int, 12> index;
+    index.Insert(0x1000, 0x1100, 1);
+    index.Insert(0x1F00, 0x5000, 2); // Spans four pages
+    index.Insert(0x8000, 0x9000, 3);
+
+    REQUIRE(Collect(index, 0x1000, 0x2000) == std::vector<int>{1, 2});
+    REQUIRE(Collect(index, 0x3000, 0x9000) == std::vector<int>{2, 3});
+    REQUIRE(Collect(index, 0x1100, 0x1F00).empty());
+    REQUIRE(Collect(index, 0x5000, 0x8000).empty());
+    REQUIRE(Collect(index, 0, 0x10000) == std::vector<int>{1, 2, 3});
+
+    index.Remove(0x1F00, 0x5000, 2);
+    REQUIRE(Collect(index, 0, 0x10000) == std::vector<int>{1, 3});
+}
+
+TEST_CASE("PageIndex[Random]", "[video_core]") {
+    std::mt19937 rng{0x9A6E};
+    PageIndex<int, 16> index;
+    std::vector<Range> live;
+
+    const std::vector<Range> ranges = GenerateRanges(rng, 2000);
+    for (const Range& range : ranges) {
+        if (!live.empty() && rng() % 3 == 0) {
+            const std::size_t victim = rng() % live.size();
+            index.Remove(live[victim].start, live[victim].end, live[victim].id);
+            live.erase(live.begin() + victim);
+        }
+        index.Insert(range.start, range.end, range.id);
+        live.push_back(range);
+
+        const CacheAddr query_start = 0x10000000 + rng() % 0x4000000;
+        const CacheAddr query_end = query_start + 1 + rng() % 0x100000;
+        std::vector<int> expected;
+        for (const Range& other : live) {
+            if (other.start < query_end && other.end > query_start) {
+                expected.push_back(other.id);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(Collect(index, query_start, query_end) == expected);
+    }
+}
+
+TEST_CASE("PageIndex[Benchmark]", "[.][benchmark]") {
+    // Replays registrations, lookups and removals in the pattern of a buffer cache working set
+    std::mt19937 rng{0xB0FFE};
+    const std::vector<Range> ranges = GenerateRanges(rng, 4096);
+    std::vector<std::pair<CacheAddr, CacheAddr>> queries;
+    for (int i = 0; i < 200000; ++i) {
+        const Range& range = ranges[rng() % ranges.size()];
+        queries.emplace_back(range.start, range.end);
+    }
+
+    const auto measure = [&](auto&& insert, auto&& remove, auto&& lookup) {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t found = 0;
+        for (int round = 0; round < 4; ++round) {
+            for (const Range& range : ranges) {
+                insert(range);
+            }
+            for (const auto& [query_start, query_end] : queries) {
+                found += lookup(query_start, query_end);
+            }
+            for (const Range& range : ranges) {
+                remove(range);
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::make_pair(found,
+                              std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+    };
+
+    using IntervalMap = boost::icl::interval_map<CacheAddr, std::set<int>>;
+    using IntervalType = IntervalMap::interval_type;
+    IntervalMap interval_map;
+    const auto [icl_found, icl_time] = measure(
+        [&](const Range& range) {
+            interval_map.add({IntervalType{range.start, range.end}, std::set<int>{range.id}});
+        },
+        [&](const Range& range) {
+            interval_map.subtract({IntervalType{range.start, range.end}, std::set<int>{range.id}});
+        },
+        [&](CacheAddr start, CacheAddr end) {
+            std::set<int> objects;
+            const IntervalType interval{start, end};
+            for (const auto& pair :
+                 boost::make_iterator_range(interval_map.equal_range(interval))) {
+                objects.insert(pair.second.begin(), pair.second.end());
+            }
+            return objects.size();
+        });
+
+    PageIndex<int, 16> page_index;
+    const auto [page_found, page_time] = measure(
+        [&](const Range& range) { page_index.Insert(range.start, range.end, range.id); },
+        [&](const Range& range) { page_index.Remove(range.start, range.end, range.id); },
+        [&](CacheAddr start, CacheAddr end) {
+            std::size_t count = 0;
+            page_index.ForEachInRange(start, end, [&count](int) { ++count; });
+            return count;
+        });
+
+    WARN("boost::icl: " << icl_time.count() << " us; PageIndex: " << page_time.count() << " us");
+    REQUIRE(icl_found == page_found);
+}
+
+} // namespace VideoCommon
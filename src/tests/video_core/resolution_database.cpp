@@ -0,0 +1,79 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "video_core/texture_cache/resolution_scaling/database.h"
+
+namespace VideoCommon::Resolution {
+
+namespace {
+
+constexpr u64 TitleID = 0x0100000000010000;
+constexpr auto Format = PixelFormat::ABGR8U;
+
+std::string GetTestDirectory() {
+    return FileUtil::GetCurrentDir().value_or(".") + DIR_SEP "resolution_database_test";
+}
+
+void RegisterFrames(ScalingDatabase& database, u32 num_frames, u32 width, u32 height) {
+    for (u32 i = 0; i < num_frames; ++i) {
+        // Surfaces gain confidence once per frame
+        database.Register(Format, width, height);
+        database.Register(Format, width, height);
+        database.TickFrame();
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ScalingDatabase[video_core]", "[video_core]") {
+    const std::string directory = GetTestDirectory();
+    FileUtil::DeleteDirRecursively(directory);
+
+    SECTION("Surfaces are trusted after enough frames") {
+        ScalingDatabase database(directory);
+        RegisterFrames(database, ScalingDatabase::ConfidenceThreshold - 1, 1280, 720);
+        REQUIRE(database.IsInDatabase(Format, 1280, 720));
+        REQUIRE(!database.IsTrusted(Format, 1280, 720));
+        RegisterFrames(database, 1, 1280, 720);
+        REQUIRE(database.IsTrusted(Format, 1280, 720));
+
+        database.Unregister(Format, 1280, 720);
+        RegisterFrames(database, ScalingDatabase::ConfidenceThreshold, 1280, 720);
+        REQUIRE(database.IsBlacklisted(Format, 1280, 720));
+        REQUIRE(!database.IsInDatabase(Format, 1280, 720));
+        REQUIRE(!database.IsTrusted(Format, 1280, 720));
+    }
+
+    SECTION("Learned surfaces persist per title") {
+        {
+            ScalingDatabase database(directory);
+            database.Init(TitleID);
+            RegisterFrames(database, ScalingDatabase::ConfidenceThreshold, 1280, 720);
+            RegisterFrames(database, 1, 640, 360);
+            database.Unregister(Format, 320, 180);
+        }
+        REQUIRE(FileUtil::Exists(directory + DIR_SEP "0100000000010000.bin"));
+
+        ScalingDatabase database(directory);
+        database.Init(TitleID);
+        database.WaitForLoad();
+        REQUIRE(database.IsTrusted(Format, 1280, 720));
+        REQUIRE(database.IsInDatabase(Format, 640, 360));
+        REQUIRE(!database.IsTrusted(Format, 640, 360));
+        REQUIRE(database.IsBlacklisted(Format, 320, 180));
+
+        ScalingDatabase other_title(directory);
+        other_title.Init(TitleID + 1);
+        other_title.WaitForLoad();
+        REQUIRE(!other_title.IsInDatabase(Format, 1280, 720));
+    }
+
+    FileUtil::DeleteDirRecursively(directory);
+}
+
+} // namespace VideoCommon::Resolution
@@ -0,0 +1,205 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/shader/ast.h"
+#include "video_core/shader/expr.h"
+
+namespace VideoCommon::Shader {
+
+namespace {
+
+/// Flat program in the shape DecompileShader hands it to the ASTManager.
+class ProgramBuilder {
+public:
+    u32 NewLabel() {
+        return next_label++;
+    }
+
+    void Label(u32 label) {
+        ops.push_back({Op::Type::Label, label});
+    }
+
+    void Block() {
+        ops.push_back({Op::Type::Block, next_address++});
+    }
+
+    void Goto(u32 label) {
+        ops.push_back({Op::Type::Goto, label});
+    }
+
+    void Return() {
+        ops.push_back({Op::Type::Return, 0});
+    }
+
+    void Build(ASTManager& manager) const {
+        manager.Init();
+        for (const Op& op : ops) {
+            if (op.type == Op::Type::Label) {
+                manager.DeclareLabel(op.value);
+            }
+        }
+        for (const Op& op : ops) {
+            switch (op.type) {
+            case Op::Type::Label:
+                manager.InsertLabel(op.value);
+                break;
+            case Op::Type::Block:
+                manager.InsertBlock(op.value, op.value);
+                break;
+            case Op::Type::Goto:
+                manager.InsertGoto(MakeExpr<ExprPredicate>(op.value % 7), op.value);
+                break;
+            case Op::Type::Return:
+                manager.InsertReturn(MakeExpr<ExprBoolean>(true), false);
+                break;
+            }
+        }
+    }
+
+private:
+    struct Op {
+        enum class Type { Label, Block, Goto, Return } type;
+        u32 value;
+    };
+
+    std::vector<Op> ops;
+    u32 next_label = 0;
+    u32 next_address = 0;
+};
+
+/// Loops holding a forward jump over a nested copy, followed by another nested copy.
+void EmitNested(ProgramBuilder& builder, u32 depth) {
+    if (depth == 0) {
+        builder.Block();
+        return;
+    }
+    const u32 loop = builder.NewLabel();
+    const u32 skip = builder.NewLabel();
+    builder.Label(loop);
+    builder.Block();
+    builder.Goto(skip);
+    EmitNested(builder, depth - 1);
+    builder.Label(skip);
+    builder.Block();
+    EmitNested(builder, depth - 1);
+    builder.Goto(loop);
+}
+
+/// If-else chains, whose jumps cross each other.
+void EmitIfElse(ProgramBuilder& builder, u32 depth) {
+    if (depth == 0) {
+        builder.Block();
+        return;
+    }
+    const u32 else_label = builder.NewLabel();
+    const u32 end_label = builder.NewLabel();
+    builder.Block();
+    builder.Goto(else_label);
+    EmitIfElse(builder, depth - 1);
+    builder.Block();
+    builder.Goto(end_label);
+    builder.Label(else_label);
+    EmitIfElse(builder, depth - 1);
+    builder.Label(end_label);
+    builder.Block();
+}
+
+/// Early exits all jumping to the end of the program.
+void EmitSharedExit(ProgramBuilder& builder, u32 depth) {
+    const u32 exit = builder.NewLabel();
+    for (u32 i = 0; i < (2U << depth) - 2; ++i) {
+        builder.Block();
+        builder.Goto(exit);
+    }
+    builder.Label(exit);
+}
+
+ProgramBuilder MakeProgram(void (*emit)(ProgramBuilder&, u32), u32 depth) {
+    ProgramBuilder builder;
+    const u32 entry = builder.NewLabel();
+    builder.Label(entry);
+    emit(builder, depth);
+    builder.Block();
+    builder.Return();
+    return builder;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ASTManager: Forward jumps to a shared label", "[video_core]") {
+    ProgramBuilder builder;
+    const u32 entry = builder.NewLabel();
+    const u32 end = builder.NewLabel();
+    builder.Label(entry);
+    builder.Block();
+    builder.Goto(end);
+    builder.Block();
+    builder.Goto(end);
+    builder.Block();
+    builder.Label(end);
+    builder.Block();
+    builder.Return();
+
+    ASTManager manager{true, false};
+    builder.Build(manager);
+    manager.Decompile();
+    REQUIRE(manager.IsFullyDecompiled());
+    // Nested ifs, without flags to carry the outer jump out of the inner if
+    REQUIRE(manager.GetVariables() == 0);
+    REQUIRE(manager.Print().find("goto") == std::string::npos);
+}
+
+TEST_CASE("ASTManager: Nested loops and ifs", "[video_core]") {
+    ASTManager manager{true, false};
+    MakeProgram(EmitNested, 4).Build(manager);
+    manager.Decompile();
+    REQUIRE(manager.IsFullyDecompiled());
+    REQUIRE(manager.GetVariables() == 0);
+    REQUIRE(manager.Print().find("do {") != std::string::npos);
+}
+
+TEST_CASE("ASTManager: Crossing jumps", "[video_core]") {
+    ASTManager manager{true, false};
+    MakeProgram(EmitIfElse, 4).Build(manager);
+    manager.Decompile();
+    REQUIRE(manager.IsFullyDecompiled());
+    REQUIRE(manager.Print().find("goto") == std::string::npos);
+}
+
+TEST_CASE("ASTManager: Backward jumps only", "[video_core]") {
+    ASTManager manager{false, false};
+    MakeProgram(EmitNested, 3).Build(manager);
+    manager.Decompile();
+    REQUIRE(manager.IsFullyDecompiled());
+    // Forward jumps are kept as gotos
+    REQUIRE(manager.Print().find("goto") != std::string::npos);
+}
+
+TEST_CASE("ASTManager::Decompile[Benchmark]", "[.][benchmark]") {
+    const auto measure = [](void (*emit)(ProgramBuilder&, u32), u32 depth) {
+        const ProgramBuilder builder = MakeProgram(emit, depth);
+        ASTManager manager{true, false};
+        builder.Build(manager);
+        const auto start = std::chrono::steady_clock::now();
+        manager.Decompile();
+        const std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+        REQUIRE(manager.IsFullyDecompiled());
+        return elapsed.count();
+    };
+    for (u32 depth = 4; depth <= 10; depth += 2) {
+        WARN("Depth " << depth << " (" << ((2U << depth) - 2) << " gotos): nested "
+                      << measure(EmitNested, depth) << " us, if-else "
+                      << measure(EmitIfElse, depth) << " us, shared exit "
+                      << measure(EmitSharedExit, depth) << " us");
+    }
+}
+
+} // namespace VideoCommon::Shader
@@ -0,0 +1,86 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/engines/shader_bytecode.h"
+
+namespace Tegra::Shader {
+
+namespace {
+
+using MatcherRef = std::optional<std::reference_wrapper<const OpCode::Matcher>>;
+
+Instruction MakeInstruction(u32 opcode) {
+    return Instruction{static_cast<u64>(opcode) << 48};
+}
+
+MatcherRef DecodeLinear(Instruction instr) {
+    const auto& matchers = OpCode::GetMatchers();
+    const auto it = std::find_if(matchers.begin(), matchers.end(), [instr](const auto& matcher) {
+        return matcher.Matches(static_cast<u16>(instr.opcode));
+    });
+    return it != matchers.end() ? MatcherRef{*it} : std::nullopt;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("OpCode::Decode matches a linear scan for every opcode", "[video_core]") {
+    std::size_t mismatches = 0;
+    for (u32 opcode = 0; opcode <= 0xFFFF; ++opcode) {
+        const Instruction instr = MakeInstruction(opcode);
+        const MatcherRef fast = OpCode::Decode(instr);
+        const MatcherRef slow = DecodeLinear(instr);
+        if (fast.has_value() != slow.has_value() ||
+            (fast && &fast->get() != &slow->get())) {
+            ++mismatches;
+        }
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("OpCode::Decode resolves known instructions", "[video_core]") {
+    const auto exit = OpCode::Decode(MakeInstruction(0b1110'0011'0000'0000));
+    REQUIRE(exit);
+    REQUIRE(exit->get().GetId() == OpCode::Id::EXIT);
+
+    // LD_A is more specific than LD, which shares its top bits
+    const auto ld_a = OpCode::Decode(MakeInstruction(0b1110'1111'1101'1000));
+    REQUIRE(ld_a);
+    REQUIRE(ld_a->get().GetId() == OpCode::Id::LD_A);
+}
+
+TEST_CASE("OpCode::Decode[Benchmark]", "[.][benchmark]") {
+    std::vector<Instruction> instructions;
+    for (u32 opcode = 0; opcode <= 0xFFFF; ++opcode) {
+        instructions.push_back(MakeInstruction(opcode));
+    }
+
+    // Returns the millions of instructions decoded per second
+    const auto measure = [&instructions](auto&& decode, std::size_t& found) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < 16; ++pass) {
+            for (const Instruction instr : instructions) {
+                found += decode(instr).has_value() ? 1 : 0;
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(16 * instructions.size()) / elapsed.count() / 1e6;
+    };
+
+    std::size_t found_linear = 0;
+    std::size_t found_lookup = 0;
+    const double linear = measure(DecodeLinear, found_linear);
+    const double lookup =
+        measure([](Instruction instr) { return OpCode::Decode(instr); }, found_lookup);
+    REQUIRE(found_linear == found_lookup);
+    WARN("Linear scan " << linear << " M/s, lookup table " << lookup << " M/s");
+}
+
+} // namespace Tegra::Shader
@@ -0,0 +1,96 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/engines/shader_bytecode.h"
+#include "video_core/shader/compiler_settings.h"
+#include "video_core/shader/shader_ir.h"
+
+namespace VideoCommon::Shader {
+
+namespace {
+
+constexpr u32 MainOffset = 10;
+
+constexpr u64 PredicateTrue = 7ULL << 16;
+constexpr u64 ConditionTrue = static_cast<u64>(Tegra::Shader::ConditionCode::T);
+
+u64 Branch(s32 offset, u64 predicate) {
+    // Offsets are stored in bytes, relative to the next instruction
+    const u64 target = static_cast<u32>((offset - 1) * 8) & 0xFFFFFF;
+    return 0xE240ULL << 48 | target << 20 | predicate << 16 | ConditionTrue;
+}
+
+/// A vertex shader with a constant buffer read, a texture sample, a forward branch and a loop.
+ProgramCode MakeProgram() {
+    ProgramCode code(MainOffset);
+    code.push_back(0);                                                             // Scheduling
+    code.push_back(0x0101ULL << 48 | 0x3F800000ULL << 20 | PredicateTrue | 1);     // MOV32I R1
+    code.push_back(Branch(4, 0));                                                  // @P0 BRA
+    code.push_back(0x4C98ULL << 48 | 1ULL << 34 | 4ULL << 20 | PredicateTrue | 2); // MOV R2, c1
+    code.push_back(0);                                                             // Scheduling
+    code.push_back(0xC038ULL << 48 | 1ULL << 31 | PredicateTrue | 4);              // TEX R4
+    code.push_back(0x0101ULL << 48 | PredicateTrue | 3);                           // MOV32I R3
+    code.push_back(Branch(-1, 1));                                                 // @P1 BRA
+    code.push_back(0);                                                             // Scheduling
+    code.push_back(0xE300ULL << 48 | PredicateTrue | ConditionTrue);               // EXIT
+    return code;
+}
+
+std::size_t GetSize(const ProgramCode& code) {
+    return code.size() * sizeof(u64);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ShaderIR: Serialization round trip", "[video_core]") {
+    const ProgramCode code = MakeProgram();
+    for (const CompileDepth depth : {CompileDepth::BruteForce, CompileDepth::FlowStack,
+                                     CompileDepth::NoFlowStack, CompileDepth::FullDecompile}) {
+        const CompilerSettings settings{depth, false};
+        const ShaderIR ir(code, MainOffset, GetSize(code), settings);
+        REQUIRE(ir.IsDecompiled() == (depth == CompileDepth::FullDecompile));
+        const std::vector<u8> data = ir.Serialize();
+        REQUIRE(!data.empty());
+
+        const auto loaded = ShaderIR::Deserialize(code, MainOffset, GetSize(code), settings, data);
+        REQUIRE(loaded);
+        // Serializing what was loaded gives the same nodes, resources and control flow back
+        REQUIRE(loaded->Serialize() == data);
+        REQUIRE(loaded->IsDecompiled() == ir.IsDecompiled());
+        REQUIRE(loaded->GetBasicBlocks().size() == ir.GetBasicBlocks().size());
+        REQUIRE(loaded->GetSamplers().size() == 1);
+        REQUIRE(loaded->GetConstantBuffers().count(1) == 1);
+        REQUIRE(loaded->GetLength() == ir.GetLength());
+    }
+}
+
+TEST_CASE("ShaderIR: Serialized data is validated", "[video_core]") {
+    const ProgramCode code = MakeProgram();
+    const CompilerSettings settings{CompileDepth::FullDecompile, false};
+    const ShaderIR ir(code, MainOffset, GetSize(code), settings);
+    std::vector<u8> data = ir.Serialize();
+    REQUIRE(!data.empty());
+
+    // Built with other parameters
+    const CompilerSettings other_settings{CompileDepth::NoFlowStack, false};
+    REQUIRE(!ShaderIR::Deserialize(code, MainOffset, GetSize(code), other_settings, data));
+    REQUIRE(!ShaderIR::Deserialize(code, MainOffset + 1, GetSize(code), settings, data));
+
+    // Truncated
+    for (const std::size_t size : {std::size_t{0}, std::size_t{16}, data.size() / 2,
+                                   data.size() - 1}) {
+        const std::vector<u8> truncated(data.begin(), data.begin() + size);
+        REQUIRE(!ShaderIR::Deserialize(code, MainOffset, GetSize(code), settings, truncated));
+    }
+
+    // Another version of the format
+    data[4] ^= 0xFF;
+    REQUIRE(!ShaderIR::Deserialize(code, MainOffset, GetSize(code), settings, data));
+}
+
+} // namespace VideoCommon::Shader
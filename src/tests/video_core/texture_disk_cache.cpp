@@ -0,0 +1,85 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_paths.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/texture_cache/texture_disk_cache.h"
+
+namespace VideoCommon {
+
+namespace {
+
+std::string GetTestDirectory() {
+    return FileUtil::GetCurrentDir().value_or(".") + DIR_SEP "texture_disk_cache_test";
+}
+
+std::vector<u8> MakeTexture(std::size_t size, u8 seed) {
+    std::vector<u8> texture(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        texture[i] = static_cast<u8>(seed + i * 7 + (i >> 5));
+    }
+    return texture;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TextureDiskCache[video_core]", "[video_core]") {
+    const std::string directory = GetTestDirectory();
+    FileUtil::DeleteDirRecursively(directory);
+
+    const std::vector<u8> first = MakeTexture(0x10000, 1);
+    const std::vector<u8> second = MakeTexture(0x10000, 2);
+    std::vector<u8> output(first.size());
+
+    SECTION("Stored textures are read back") {
+        TextureDiskCache cache(directory, 1ULL << 30);
+        REQUIRE(!cache.Load(1, output.data(), output.size()));
+        cache.Save(1, first.data(), first.size());
+        cache.Save(2, second.data(), second.size());
+        REQUIRE(cache.Load(1, output.data(), output.size()));
+        REQUIRE(output == first);
+        REQUIRE(cache.Load(2, output.data(), output.size()));
+        REQUIRE(output == second);
+        // A different host size is a miss and drops the stale entry
+        REQUIRE(!cache.Load(1, output.data(), output.size() / 2));
+        REQUIRE(!cache.Load(1, output.data(), output.size()));
+    }
+
+    SECTION("Textures persist between instances") {
+        {
+            TextureDiskCache cache(directory, 1ULL << 30);
+            cache.Save(1, first.data(), first.size());
+        }
+        TextureDiskCache cache(directory, 1ULL << 30);
+        REQUIRE(cache.GetResidentBytes() > 0);
+        REQUIRE(cache.Load(1, output.data(), output.size()));
+        REQUIRE(output == first);
+    }
+
+    SECTION("Least recently used textures are pruned") {
+        std::size_t entry_size = 0;
+        {
+            TextureDiskCache cache(directory, 1ULL << 30);
+            cache.Save(1, first.data(), first.size());
+            entry_size = cache.GetResidentBytes();
+        }
+        // Room for the two entries with the largest compressed size, plus some slack
+        TextureDiskCache cache(directory, entry_size * 2 + entry_size / 2);
+        cache.Save(2, second.data(), second.size());
+        REQUIRE(cache.Load(1, output.data(), output.size()));
+        cache.Save(3, first.data(), first.size());
+        REQUIRE(cache.Load(1, output.data(), output.size()));
+        REQUIRE(!cache.Load(2, output.data(), output.size()));
+        REQUIRE(cache.Load(3, output.data(), output.size()));
+        REQUIRE(cache.GetResidentBytes() <= entry_size * 2 + entry_size / 2);
+    }
+
+    FileUtil::DeleteDirRecursively(directory);
+}
+
+} // namespace VideoCommon
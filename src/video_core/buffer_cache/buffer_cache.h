@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <mutex>
@@ -18,6 +19,7 @@
 #include "video_core/buffer_cache/buffer_block.h"
 #include "video_core/buffer_cache/map_interval.h"
 #include "video_core/memory_manager.h"
+#include "video_core/page_index.h"
 #include "video_core/rasterizer_interface.h"
 
 namespace VideoCommon {
@@ -63,7 +65,7 @@ public:
             }
         }
 
-        const u64 offset = static_cast<u64>(block->GetOffset(cache_addr));
+        const u64 offset = GetBlockOffset(block) + static_cast<u64>(block->GetOffset(cache_addr));
 
         return {ToHandle(block), offset};
     }
@@ -80,6 +82,9 @@ public:
 
         std::tie(buffer_ptr, buffer_offset_base, invalidated) = stream_buffer->Map(max_size, 4);
         buffer_offset = buffer_offset_base;
+        if (invalidated) {
+            ++stream_generation;
+        }
     }
 
     /// Finishes the upload stream, returns true on bindings invalidation.
@@ -90,6 +95,17 @@ public:
         return std::exchange(invalidated, false);
     }
 
+    /// Returns true when the uploaded memory was copied to the stream buffer.
+    bool IsStreamed(const BufferInfo& info) const {
+        return info.first == &stream_buffer_handle;
+    }
+
+    /// Returns a counter increased every time the stream buffer is invalidated, copies made to it
+    /// under a previous value are gone.
+    u64 GetStreamGeneration() const {
+        return stream_generation;
+    }
+
     void TickFrame() {
         ++epoch;
         while (!pending_destruction.empty()) {
@@ -115,15 +131,32 @@ public:
         }
     }
 
+    /// Returns true when a buffer in the region was written by the GPU and not yet flushed
+    bool MustFlushRegion(CacheAddr addr, std::size_t size) {
+        std::lock_guard lock{mutex};
+
+        const std::vector<MapInterval> objects = GetMapsInRange(addr, size);
+        return std::any_of(objects.begin(), objects.end(), [](const MapInterval& object) {
+            return object->IsModified() && object->IsRegistered();
+        });
+    }
+
     /// Mark the specified region as being invalidated
     void InvalidateRegion(CacheAddr addr, u64 size) {
         std::lock_guard lock{mutex};
 
         std::vector<MapInterval> objects = GetMapsInRange(addr, size);
         for (auto& object : objects) {
-            if (object->IsRegistered()) {
+            if (!object->IsRegistered()) {
+                continue;
+            }
+            if (object->IsWritten() || object->IsModified()) {
                 Unregister(object);
+                continue;
             }
+            // Keep buffers the GPU only reads, the pages written by the CPU are uploaded again
+            // the next time the buffer is used
+            object->MarkAsDirty(addr, addr + size);
         }
     }
 
@@ -139,6 +172,9 @@ protected:
 
     virtual const TBufferType* ToHandle(const TBuffer& storage) = 0;
 
+    /// Returns where the block starts in the buffer returned by ToHandle
+    virtual u64 GetBlockOffset(const TBuffer& storage) = 0;
+
     virtual void WriteBarrier() = 0;
 
     virtual TBuffer CreateBlock(CacheAddr cache_addr, std::size_t size) = 0;
@@ -165,8 +201,7 @@ protected:
         const std::size_t size = new_map->GetEnd() - new_map->GetStart();
         new_map->SetCpuAddress(*cpu_addr);
         new_map->MarkAsRegistered(true);
-        const IntervalType interval{new_map->GetStart(), new_map->GetEnd()};
-        mapped_addresses.insert({interval, new_map});
+        mapped_addresses.Insert(new_map->GetStart(), new_map->GetEnd(), new_map);
         rasterizer.UpdatePagesCachedCount(*cpu_addr, size, 1);
         if (inherit_written) {
             MarkRegionAsWritten(new_map->GetStart(), new_map->GetEnd() - 1);
@@ -182,8 +217,7 @@ protected:
         if (map->IsWritten()) {
             UnmarkRegionAsWritten(map->GetStart(), map->GetEnd() - 1);
         }
-        const IntervalType delete_interval{map->GetStart(), map->GetEnd()};
-        mapped_addresses.erase(delete_interval);
+        mapped_addresses.Remove(map->GetStart(), map->GetEnd(), map);
     }
 
 private:
@@ -208,6 +242,7 @@ private:
         if (overlaps.size() == 1) {
             MapInterval& current_map = overlaps[0];
             if (current_map->IsInside(cache_addr, cache_addr_end)) {
+                UploadDirtyPages(block, current_map);
                 return current_map;
             }
         }
@@ -224,6 +259,7 @@ private:
         }
         GPUVAddr new_gpu_addr = gpu_addr + new_start - cache_addr;
         for (auto& overlap : overlaps) {
+            UploadDirtyPages(block, overlap);
             Unregister(overlap);
         }
         UpdateBlock(block, new_start, new_end, overlaps);
@@ -235,6 +271,14 @@ private:
         return new_map;
     }
 
+    /// Uploads the pages of a map written by the CPU since it was last used
+    void UploadDirtyPages(const TBuffer& block, MapInterval& map) {
+        map->ConsumeDirtyRanges([&](CacheAddr range_start, CacheAddr range_end) {
+            UploadBlockData(block, block->GetOffset(range_start), range_end - range_start,
+                            FromCacheAddr(range_start));
+        });
+    }
+
     void UpdateBlock(const TBuffer& block, CacheAddr start, CacheAddr end,
                      std::vector<MapInterval>& overlaps) {
         const IntervalType base_interval{start, end};
@@ -259,11 +303,8 @@ private:
         }
 
         std::vector<MapInterval> objects{};
-        const IntervalType interval{addr, addr + size};
-        for (auto& pair : boost::make_iterator_range(mapped_addresses.equal_range(interval))) {
-            objects.push_back(pair.second);
-        }
-
+        mapped_addresses.ForEachInRange(
+            addr, addr + size, [&objects](const MapInterval& map) { objects.push_back(map); });
         return objects;
     }
 
@@ -420,15 +461,15 @@ private:
     TBufferType stream_buffer_handle{};
 
     bool invalidated = false;
+    u64 stream_generation = 0;
 
     u8* buffer_ptr = nullptr;
     u64 buffer_offset = 0;
     u64 buffer_offset_base = 0;
 
     using IntervalSet = boost::icl::interval_set<CacheAddr>;
-    using IntervalCache = boost::icl::interval_map<CacheAddr, MapInterval>;
-    using IntervalType = typename IntervalCache::interval_type;
-    IntervalCache mapped_addresses{};
+    using IntervalType = typename IntervalSet::interval_type;
+    PageIndex<MapInterval, 16> mapped_addresses;
 
     static constexpr u64 write_page_bit{11};
     std::unordered_map<u64, u32> written_pages{};
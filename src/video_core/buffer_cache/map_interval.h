@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include "common/common_types.h"
 #include "video_core/gpu.h"
 
@@ -75,7 +78,62 @@ public:
         return is_written;
     }
 
+    /// Marks the pages of the interval overlapping [dirty_start, dirty_end) as written by the CPU
+    void MarkAsDirty(CacheAddr dirty_start, CacheAddr dirty_end) {
+        dirty_start = std::max(dirty_start, start);
+        dirty_end = std::min(dirty_end, end);
+        if (dirty_start >= dirty_end) {
+            return;
+        }
+        const u64 base_page = start >> DIRTY_PAGE_BITS;
+        if (dirty_pages.empty()) {
+            const u64 num_pages = ((end - 1) >> DIRTY_PAGE_BITS) - base_page + 1;
+            dirty_pages.resize((num_pages + 63) / 64);
+        }
+        const u64 last_page = ((dirty_end - 1) >> DIRTY_PAGE_BITS) - base_page;
+        for (u64 page = (dirty_start >> DIRTY_PAGE_BITS) - base_page; page <= last_page; ++page) {
+            dirty_pages[page / 64] |= u64{1} << (page % 64);
+        }
+        is_dirty = true;
+    }
+
+    bool IsDirty() const {
+        return is_dirty;
+    }
+
+    /// Calls func with every run of dirty pages, clipped to the interval, and marks them clean
+    template <typename Func>
+    void ConsumeDirtyRanges(Func&& func) {
+        if (!is_dirty) {
+            return;
+        }
+        const u64 base_page = start >> DIRTY_PAGE_BITS;
+        const u64 num_pages = ((end - 1) >> DIRTY_PAGE_BITS) - base_page + 1;
+        const auto is_page_dirty = [this](u64 page) {
+            return (dirty_pages[page / 64] >> (page % 64)) & 1;
+        };
+        u64 page = 0;
+        while (page < num_pages) {
+            if (!is_page_dirty(page)) {
+                ++page;
+                continue;
+            }
+            const u64 run_begin = page;
+            while (page < num_pages && is_page_dirty(page)) {
+                ++page;
+            }
+            const CacheAddr run_start = (base_page + run_begin) << DIRTY_PAGE_BITS;
+            const CacheAddr run_end = (base_page + page) << DIRTY_PAGE_BITS;
+            func(std::max(start, run_start), std::min(end, run_end));
+        }
+        std::fill(dirty_pages.begin(), dirty_pages.end(), 0);
+        is_dirty = false;
+    }
+
 private:
+    /// Granularity of the CPU write tracking, matches the CPU page size
+    static constexpr u32 DIRTY_PAGE_BITS = 12;
+
     CacheAddr start;
     CacheAddr end;
     GPUVAddr gpu_addr;
@@ -83,7 +141,9 @@ private:
     bool is_written{};
     bool is_modified{};
     bool is_registered{};
+    bool is_dirty{};
     u64 ticks{};
+    std::vector<u64> dirty_pages; ///< Bitmap of the pages written by the CPU, allocated on demand
 };
 
 } // namespace VideoCommon
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "common/microprofile.h"
 #include "core/core.h"
 #include "core/memory.h"
@@ -34,6 +36,33 @@ void DmaPusher::DispatchCalls() {
     gpu.FlushCommands();
 }
 
+CommandList CommandListPool::Acquire(std::size_t num_entries) {
+    CommandList list;
+    {
+        std::lock_guard lock{mutex};
+        if (!free_lists.empty()) {
+            list = std::move(free_lists.back());
+            free_lists.pop_back();
+        }
+    }
+    list.resize(num_entries);
+    return list;
+}
+
+void CommandListPool::Release(CommandList&& list) {
+    list.clear();
+    std::lock_guard lock{mutex};
+    if (free_lists.size() < MaxPooledLists) {
+        free_lists.push_back(std::move(list));
+    }
+}
+
+void DmaPusher::PopCommandList() {
+    command_list_pool.Release(std::move(dma_pushbuffer.front()));
+    dma_pushbuffer.pop();
+    dma_pushbuffer_subindex = 0;
+}
+
 bool DmaPusher::Step() {
     if (!ib_enable || dma_pushbuffer.empty()) {
         // pushbuffer empty and IB empty or nonexistent - nothing to do
@@ -44,8 +73,7 @@ bool DmaPusher::Step() {
     ASSERT_OR_EXECUTE(!command_list.empty(), {
         // Somehow the command_list is empty, in order to avoid a crash
         // We ignore it and assume its size is 0.
-        dma_pushbuffer.pop();
-        dma_pushbuffer_subindex = 0;
+        PopCommandList();
         return true;
     });
     const CommandListHeader command_list_header{command_list[dma_pushbuffer_subindex++]};
@@ -55,8 +83,7 @@ bool DmaPusher::Step() {
 
     if (dma_pushbuffer_subindex >= command_list.size()) {
         // We've gone through the current list, remove it from the queue
-        dma_pushbuffer.pop();
-        dma_pushbuffer_subindex = 0;
+        PopCommandList();
     }
 
     if (command_list_header.size == 0) {
@@ -64,17 +91,35 @@ bool DmaPusher::Step() {
     }
 
     // Push buffer non-empty, read a word
-    command_headers.resize(command_list_header.size);
-    gpu.MemoryManager().ReadBlockUnsafe(dma_get, command_headers.data(),
-                                        command_list_header.size * sizeof(u32));
+    const std::size_t num_headers = command_list_header.size;
+    const std::size_t headers_size = num_headers * sizeof(u32);
+    auto& memory_manager = gpu.MemoryManager();
+    const CommandHeader* headers;
+    if (memory_manager.IsBlockContinuous(dma_get, headers_size)) {
+        // The commands are contiguous in host memory, parse them in place.
+        headers = reinterpret_cast<const CommandHeader*>(memory_manager.GetPointer(dma_get));
+    } else {
+        command_headers.resize(num_headers);
+        memory_manager.ReadBlockUnsafe(dma_get, command_headers.data(), headers_size);
+        headers = command_headers.data();
+    }
 
-    for (const CommandHeader& command_header : command_headers) {
+    for (std::size_t index = 0; index < num_headers; ++index) {
+        const CommandHeader& command_header = headers[index];
 
         // now, see if we're in the middle of a command
         if (dma_state.length_pending) {
             // Second word of long non-inc methods command - method count
             dma_state.length_pending = 0;
             dma_state.method_count = command_header.method_count_;
+        } else if (dma_state.method_count && dma_state.non_incrementing) {
+            // Data words of a non-incrementing command all go to the same method, hand the engine
+            // the ones in this buffer at once.
+            const u32 num_methods = static_cast<u32>(
+                std::min<std::size_t>(dma_state.method_count, num_headers - index));
+            CallMultiMethod(&command_header.argument, num_methods);
+            dma_state.method_count -= num_methods;
+            index += num_methods - 1;
         } else if (dma_state.method_count) {
             // Data word of methods command
             CallMethod(command_header.argument);
@@ -137,4 +182,9 @@ void DmaPusher::CallMethod(u32 argument) const {
     gpu.CallMethod({dma_state.method, argument, dma_state.subchannel, dma_state.method_count});
 }
 
+void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
+    gpu.CallMultiMethod(dma_state.method, dma_state.subchannel, base_start, num_methods,
+                        dma_state.method_count);
+}
+
 } // namespace Tegra
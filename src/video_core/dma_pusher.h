@@ -4,8 +4,9 @@
 
 #pragma once
 
-#include <vector>
+#include <mutex>
 #include <queue>
+#include <vector>
 
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -47,6 +48,26 @@ class GPU;
 
 using CommandList = std::vector<Tegra::CommandListHeader>;
 
+/**
+ * Recycles the storage of command lists once the DMA pusher is done with them, so that submitting
+ * a list from nvdrv doesn't allocate. Lists are acquired from the service thread and released from
+ * the GPU thread.
+ */
+class CommandListPool {
+public:
+    /// Returns a list with the given number of entries, reusing released storage when available.
+    CommandList Acquire(std::size_t num_entries);
+
+    /// Gives the storage of a processed list back to the pool.
+    void Release(CommandList&& list);
+
+private:
+    static constexpr std::size_t MaxPooledLists = 64;
+
+    std::mutex mutex;
+    std::vector<CommandList> free_lists;
+};
+
 /**
  * The DmaPusher class implements DMA submission to FIFOs, providing an area of memory that the
  * emulated app fills with commands and tells PFIFO to process. The pushbuffers are then assembled
@@ -65,17 +86,27 @@ public:
 
     void DispatchCalls();
 
+    CommandListPool& GetCommandListPool() {
+        return command_list_pool;
+    }
+
 private:
     bool Step();
 
+    /// Removes the front command list from the queue and recycles its storage.
+    void PopCommandList();
+
     void SetState(const CommandHeader& command_header);
 
     void CallMethod(u32 argument) const;
+    void CallMultiMethod(const u32* base_start, u32 num_methods) const;
 
     GPU& gpu;
 
-    std::vector<CommandHeader> command_headers; ///< Buffer for list of commands fetched at once
+    /// Buffer for command lists which are not contiguous in host memory
+    std::vector<CommandHeader> command_headers;
 
+    CommandListPool command_list_pool;
     std::queue<CommandList> dma_pushbuffer; ///< Queue of command lists to be processed
     std::size_t dma_pushbuffer_subindex{};  ///< Index within a command list within the pushbuffer
 
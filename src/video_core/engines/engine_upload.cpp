@@ -2,17 +2,20 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 
 #include "common/assert.h"
 #include "video_core/engines/engine_upload.h"
 #include "video_core/memory_manager.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/textures/decoders.h"
 
 namespace Tegra::Engines::Upload {
 
-State::State(MemoryManager& memory_manager, Registers& regs)
-    : regs{regs}, memory_manager{memory_manager} {}
+State::State(MemoryManager& memory_manager, VideoCore::RasterizerInterface& rasterizer,
+             Registers& regs)
+    : regs{regs}, memory_manager{memory_manager}, rasterizer{rasterizer} {}
 
 State::~State() = default;
 
@@ -24,14 +27,24 @@ void State::ProcessExec(const bool is_linear) {
 }
 
 void State::ProcessData(const u32 data, const bool is_last_call) {
-    const u32 sub_copy_size = std::min(4U, copy_size - write_offset);
-    std::memcpy(&inner_buffer[write_offset], &data, sub_copy_size);
+    ProcessData(&data, 1, is_last_call);
+}
+
+void State::ProcessData(const u32* data, std::size_t num_words, const bool is_last_call) {
+    const u32 sub_copy_size =
+        static_cast<u32>(std::min<std::size_t>(num_words * sizeof(u32), copy_size - write_offset));
+    std::memcpy(inner_buffer.data() + write_offset, data, sub_copy_size);
     write_offset += sub_copy_size;
     if (!is_last_call) {
         return;
     }
     const GPUVAddr address{regs.dest.Address()};
     if (is_linear) {
+        // Data for buffers the host GPU wrote goes straight to them, guest memory gets it when
+        // the buffer is flushed
+        if (rasterizer.AccelerateInlineToMemory(address, copy_size, inner_buffer.data())) {
+            return;
+        }
         memory_manager.WriteBlock(address, inner_buffer.data(), copy_size);
     } else {
         UNIMPLEMENTED_IF(regs.dest.z != 0);
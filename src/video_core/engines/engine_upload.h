@@ -12,6 +12,10 @@ namespace Tegra {
 class MemoryManager;
 }
 
+namespace VideoCore {
+class RasterizerInterface;
+}
+
 namespace Tegra::Engines::Upload {
 
 struct Registers {
@@ -54,11 +58,13 @@ struct Registers {
 
 class State {
 public:
-    State(MemoryManager& memory_manager, Registers& regs);
+    State(MemoryManager& memory_manager, VideoCore::RasterizerInterface& rasterizer,
+          Registers& regs);
     ~State();
 
     void ProcessExec(bool is_linear);
     void ProcessData(u32 data, bool is_last_call);
+    void ProcessData(const u32* data, std::size_t num_words, bool is_last_call);
 
 private:
     u32 write_offset = 0;
@@ -68,6 +74,7 @@ private:
     bool is_linear = false;
     Registers& regs;
     MemoryManager& memory_manager;
+    VideoCore::RasterizerInterface& rasterizer;
 };
 
 } // namespace Tegra::Engines::Upload
@@ -17,9 +17,8 @@ namespace Tegra::Engines {
 
 KeplerCompute::KeplerCompute(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
                              MemoryManager& memory_manager)
-    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager}, upload_state{
-                                                                                  memory_manager,
-                                                                                  regs.upload} {}
+    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager},
+      upload_state{memory_manager, rasterizer, regs.upload} {}
 
 KeplerCompute::~KeplerCompute() = default;
 
@@ -50,6 +49,24 @@ void KeplerCompute::CallMethod(const GPU::MethodCall& method_call) {
     }
 }
 
+void KeplerCompute::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                                    u32 methods_pending) {
+    if (method != KEPLER_COMPUTE_REG_INDEX(data_upload)) {
+        for (u32 i = 0; i < amount; ++i) {
+            CallMethod({method, base_start[i], 0, methods_pending - i});
+        }
+        return;
+    }
+
+    // Inline upload data is copied in bulk.
+    regs.reg_array[method] = base_start[amount - 1];
+    const bool is_last_call = amount == methods_pending;
+    upload_state.ProcessData(base_start, amount, is_last_call);
+    if (is_last_call) {
+        system.GPU().Maxwell3D().dirty.OnMemoryWrite();
+    }
+}
+
 Tegra::Texture::FullTextureInfo KeplerCompute::GetTexture(std::size_t offset) const {
     const std::bitset<8> cbuf_mask = launch_description.const_buffer_enable_mask.Value();
     ASSERT(cbuf_mask[regs.tex_cb_index]);
@@ -195,6 +195,9 @@ public:
     /// Write the value to the register identified by method.
     void CallMethod(const GPU::MethodCall& method_call);
 
+    /// Write multiple values to the register identified by method.
+    void CallMultiMethod(u32 method, const u32* base_start, u32 amount, u32 methods_pending);
+
     Tegra::Texture::FullTextureInfo GetTexture(std::size_t offset) const;
 
     /// Given a Texture Handle, returns the TSC and TIC entries.
@@ -2,8 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
+#include <iterator>
+#include <boost/functional/hash.hpp>
 #include "common/assert.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -18,14 +21,43 @@ namespace Tegra::Engines {
 /// First register id that is actually a Macro call.
 constexpr u32 MacroRegistersStart = 0xE00;
 
+/// Returns true for the CB_DATA[i] registers, the index only picks which one is written.
+constexpr bool IsCBDataMethod(u32 method) {
+    constexpr u32 first_cb_data = MAXWELL3D_REG_INDEX(const_buffer.cb_data[0]);
+    return method - first_cb_data < Maxwell3D::Regs::NumCBData;
+}
+
+/// Returns true for the registers that only describe the range and instances of the next draw.
+constexpr bool IsDrawParameter(u32 method) {
+    switch (method) {
+    case MAXWELL3D_REG_INDEX(vertex_buffer.first):
+    case MAXWELL3D_REG_INDEX(vertex_buffer.count):
+    case MAXWELL3D_REG_INDEX(index_array.first):
+    case MAXWELL3D_REG_INDEX(index_array.count):
+    case MAXWELL3D_REG_INDEX(vb_element_base):
+    case MAXWELL3D_REG_INDEX(vb_base_instance):
+    case MAXWELL3D_REG_INDEX(draw.vertex_begin_gl):
+    case MAXWELL3D_REG_INDEX(draw.vertex_end_gl):
+        return true;
+    default:
+        return false;
+    }
+}
+
 Maxwell3D::Maxwell3D(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
                      MemoryManager& memory_manager)
     : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager},
-      macro_interpreter{*this}, upload_state{memory_manager, regs.upload} {
+      macro_interpreter{*this}, macro_compiler{*this}, macro_hle{*this},
+      upload_state{memory_manager, rasterizer, regs.upload} {
     InitDirtySettings();
+    InitMethodHandlers();
     InitializeRegisterDefaults();
 }
 
+Maxwell3D::~Maxwell3D() {
+    macro_hle.LogStatistics();
+}
+
 void Maxwell3D::InitializeRegisterDefaults() {
     // Initializes registers to their default values - what games expect them to be at boot. This is
     // for certain registers that may not be explicitly set by games.
@@ -249,6 +281,176 @@ void Maxwell3D::InitDirtySettings() {
     dirty_pointers[MAXWELL3D_REG_INDEX(polygon_offset_units)] = polygon_offset_dirty_reg;
     dirty_pointers[MAXWELL3D_REG_INDEX(polygon_offset_factor)] = polygon_offset_dirty_reg;
     dirty_pointers[MAXWELL3D_REG_INDEX(polygon_offset_clamp)] = polygon_offset_dirty_reg;
+
+    // Logic Operation
+    set_block(MAXWELL3D_REG_INDEX(logic_op), sizeof(regs.logic_op) / sizeof(u32),
+              DIRTY_REGS_POS(logic_op));
+
+    // Multisample Control
+    dirty_pointers[MAXWELL3D_REG_INDEX(multisample_control)] = DIRTY_REGS_POS(multisample_control);
+
+    // Fragment Color Clamp
+    dirty_pointers[MAXWELL3D_REG_INDEX(frag_color_clamp)] = DIRTY_REGS_POS(fragment_color_clamp);
+
+    // Point Size
+    dirty_pointers[MAXWELL3D_REG_INDEX(point_size)] = DIRTY_REGS_POS(point_size);
+
+    // Alpha Test
+    constexpr u32 alpha_test_dirty_reg = DIRTY_REGS_POS(alpha_test);
+    dirty_pointers[MAXWELL3D_REG_INDEX(alpha_test_enabled)] = alpha_test_dirty_reg;
+    dirty_pointers[MAXWELL3D_REG_INDEX(alpha_test_ref)] = alpha_test_dirty_reg;
+    dirty_pointers[MAXWELL3D_REG_INDEX(alpha_test_func)] = alpha_test_dirty_reg;
+}
+
+template <bool is_draw_parameter, Maxwell3D::DirtyGroup group>
+void Maxwell3D::WriteRegister(Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+    u32& reg = maxwell3d.regs.reg_array[method_call.method];
+    if (reg == method_call.argument) {
+        return;
+    }
+    reg = method_call.argument;
+
+    auto& dirty = maxwell3d.dirty;
+    if constexpr (!is_draw_parameter) {
+        dirty.draw_state = true;
+    }
+    if constexpr (group != DirtyGroup::Untracked) {
+        dirty.regs[maxwell3d.dirty_pointers[method_call.method]] = true;
+    }
+    if constexpr (group == DirtyGroup::VertexArray) {
+        dirty.vertex_array_buffers = true;
+    } else if constexpr (group == DirtyGroup::VertexInstance) {
+        dirty.vertex_instances = true;
+    } else if constexpr (group == DirtyGroup::RenderTarget) {
+        dirty.render_settings = true;
+    }
+}
+
+void Maxwell3D::InitMethodHandlers() {
+    // Plain writes, specialized on the dirty flags they set so each write is a single call
+    const auto select_write = [](auto is_draw_parameter, DirtyGroup group) -> MethodHandler {
+        constexpr bool draw = decltype(is_draw_parameter)::value;
+        switch (group) {
+        case DirtyGroup::Untracked:
+            return &WriteRegister<draw, DirtyGroup::Untracked>;
+        case DirtyGroup::Tracked:
+            return &WriteRegister<draw, DirtyGroup::Tracked>;
+        case DirtyGroup::VertexArray:
+            return &WriteRegister<draw, DirtyGroup::VertexArray>;
+        case DirtyGroup::VertexInstance:
+            return &WriteRegister<draw, DirtyGroup::VertexInstance>;
+        case DirtyGroup::RenderTarget:
+            return &WriteRegister<draw, DirtyGroup::RenderTarget>;
+        }
+        UNREACHABLE();
+        return nullptr;
+    };
+    for (u32 method = 0; method < Regs::NUM_REGS; ++method) {
+        const std::size_t dirty_reg = dirty_pointers[method];
+        DirtyGroup group = DirtyGroup::Untracked;
+        if (dirty_reg >= DIRTY_REGS_POS(vertex_array) &&
+            dirty_reg < DIRTY_REGS_POS(vertex_array_buffers)) {
+            group = DirtyGroup::VertexArray;
+        } else if (dirty_reg >= DIRTY_REGS_POS(vertex_instance) &&
+                   dirty_reg < DIRTY_REGS_POS(vertex_instances)) {
+            group = DirtyGroup::VertexInstance;
+        } else if (dirty_reg >= DIRTY_REGS_POS(render_target) &&
+                   dirty_reg < DIRTY_REGS_POS(render_settings)) {
+            group = DirtyGroup::RenderTarget;
+        } else if (dirty_reg != 0) {
+            group = DirtyGroup::Tracked;
+        }
+        method_handlers[method] = IsDrawParameter(method) ? select_write(std::true_type{}, group)
+                                                          : select_write(std::false_type{}, group);
+    }
+
+    // Writes with side effects, none of these registers is tracked by a dirty flag
+    const auto set_trigger = [this](u32 method, MethodHandler handler) {
+        ASSERT(dirty_pointers[method] == 0);
+        method_handlers[method] = handler;
+        method_has_trigger[method] = true;
+    };
+    set_trigger(MAXWELL3D_REG_INDEX(macros.upload_address),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.macro_upload_start = maxwell3d.regs.macros.upload_address;
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(macros.data),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessMacroUpload(method_call.argument);
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(macros.bind),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessMacroBind(method_call.argument);
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(firmware[4]),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessFirmwareCall4();
+                });
+    for (u32 index = 0; index < Regs::NumCBData; ++index) {
+        set_trigger(MAXWELL3D_REG_INDEX(const_buffer.cb_data) + index,
+                    [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                        WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                        maxwell3d.StartCBData(method_call.method);
+                    });
+    }
+    constexpr u32 cb_bind_start = MAXWELL3D_REG_INDEX(cb_bind[0].raw_config);
+    constexpr u32 cb_bind_stride = MAXWELL3D_REG_INDEX(cb_bind[1].raw_config) - cb_bind_start;
+    for (u32 stage = 0; stage < Regs::MaxShaderStage; ++stage) {
+        set_trigger(cb_bind_start + stage * cb_bind_stride,
+                    [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                        WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                        const u32 stage = (method_call.method - cb_bind_start) / cb_bind_stride;
+                        maxwell3d.ProcessCBBind(static_cast<Regs::ShaderStage>(stage));
+                    });
+    }
+    set_trigger(MAXWELL3D_REG_INDEX(draw.vertex_end_gl),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<true, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.DrawArrays();
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(clear_buffers),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessClearBuffers();
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(query.query_get),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessQueryGet();
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(condition.mode),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessQueryCondition();
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(counter_reset),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessCounterReset();
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(sync_info),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.ProcessSyncPoint();
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(exec_upload),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    maxwell3d.upload_state.ProcessExec(maxwell3d.regs.exec_upload.linear != 0);
+                });
+    set_trigger(MAXWELL3D_REG_INDEX(data_upload),
+                [](Maxwell3D& maxwell3d, const GPU::MethodCall& method_call) {
+                    WriteRegister<false, DirtyGroup::Untracked>(maxwell3d, method_call);
+                    const bool is_last_call = method_call.IsLastCall();
+                    maxwell3d.upload_state.ProcessData(method_call.argument, is_last_call);
+                    if (is_last_call) {
+                        maxwell3d.dirty.OnMemoryWrite();
+                    }
+                });
 }
 
 void Maxwell3D::CallMacroMethod(u32 method, std::size_t num_parameters, const u32* parameters) {
@@ -259,7 +461,11 @@ void Maxwell3D::CallMacroMethod(u32 method, std::size_t num_parameters, const u3
     const u32 entry = ((method - MacroRegistersStart) >> 1) % macro_positions.size();
 
     // Execute the current macro.
-    macro_interpreter.Execute(macro_positions[entry], num_parameters, parameters);
+    const u32 offset = macro_positions[entry];
+    if (!macro_hle.Execute(GetMacroHash(offset), num_parameters, parameters) &&
+        !macro_compiler.Execute(offset, num_parameters, parameters)) {
+        macro_interpreter.Execute(offset, num_parameters, parameters);
+    }
     if (mme_draw.current_mode != MMEDrawMode::Undefined) {
         FlushMMEInlineDraw();
     }
@@ -270,11 +476,14 @@ void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
 
     const u32 method = method_call.method;
 
-    if (method == cb_data_state.current) {
-        regs.reg_array[method] = method_call.argument;
-        ProcessCBData(method_call.argument);
-        return;
-    } else if (cb_data_state.current != null_cb_data) {
+    if (cb_data_state.active) {
+        // Any CB_DATA[i] register writes at CB_POS, so the run continues across them and is only
+        // committed when something else is written
+        if (IsCBDataMethod(method)) {
+            regs.reg_array[method] = method_call.argument;
+            ProcessCBData(method_call.argument);
+            return;
+        }
         FinishCBData();
     }
 
@@ -312,114 +521,60 @@ void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
         debug_context->OnEvent(Tegra::DebugContext::Event::MaxwellCommandLoaded, nullptr);
     }
 
-    if (regs.reg_array[method] != method_call.argument) {
-        regs.reg_array[method] = method_call.argument;
-        const std::size_t dirty_reg = dirty_pointers[method];
-        if (dirty_reg) {
-            dirty.regs[dirty_reg] = true;
-            if (dirty_reg >= DIRTY_REGS_POS(vertex_array) &&
-                dirty_reg < DIRTY_REGS_POS(vertex_array_buffers)) {
-                dirty.vertex_array_buffers = true;
-            } else if (dirty_reg >= DIRTY_REGS_POS(vertex_instance) &&
-                       dirty_reg < DIRTY_REGS_POS(vertex_instances)) {
-                dirty.vertex_instances = true;
-            } else if (dirty_reg >= DIRTY_REGS_POS(render_target) &&
-                       dirty_reg < DIRTY_REGS_POS(render_settings)) {
-                dirty.render_settings = true;
-            }
-        }
-    }
+    method_handlers[method](*this, method_call);
 
-    switch (method) {
-    case MAXWELL3D_REG_INDEX(macros.data): {
-        ProcessMacroUpload(method_call.argument);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(macros.bind): {
-        ProcessMacroBind(method_call.argument);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(firmware[4]): {
-        ProcessFirmwareCall4();
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[0]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[1]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[2]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[3]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[4]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[5]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[6]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[7]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[8]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[9]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[10]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[11]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[12]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[13]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[14]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[15]): {
-        StartCBData(method);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[0].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::Vertex);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[1].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::TesselationControl);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[2].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::TesselationEval);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[3].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::Geometry);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[4].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::Fragment);
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(draw.vertex_end_gl): {
-        DrawArrays();
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(clear_buffers): {
-        ProcessClearBuffers();
-        break;
-    }
-    case MAXWELL3D_REG_INDEX(query.query_get): {
-        ProcessQueryGet();
-        break;
+    if (debug_context) {
+        debug_context->OnEvent(Tegra::DebugContext::Event::MaxwellCommandProcessed, nullptr);
     }
-    case MAXWELL3D_REG_INDEX(condition.mode): {
-        ProcessQueryCondition();
-        break;
+}
+
+void Maxwell3D::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                                u32 methods_pending) {
+    // The first word takes the regular path, which starts macro calls and const buffer uploads.
+    CallMethod({method, base_start[0], 0, methods_pending});
+    if (amount == 1) {
+        return;
     }
-    case MAXWELL3D_REG_INDEX(sync_info): {
-        ProcessSyncPoint();
-        break;
+
+    const u32* const data = base_start + 1;
+    const u32 count = amount - 1;
+    const bool is_last_call = amount == methods_pending;
+
+    if (method >= MacroRegistersStart) {
+        // Macro parameters are queued until the last one arrives.
+        ASSERT(method == executing_macro + 1);
+        macro_params.insert(macro_params.end(), data, data + count);
+        if (is_last_call) {
+            CallMacroMethod(executing_macro, macro_params.size(), macro_params.data());
+            macro_params.clear();
+        }
+        return;
     }
-    case MAXWELL3D_REG_INDEX(exec_upload): {
-        upload_state.ProcessExec(regs.exec_upload.linear != 0);
-        break;
+
+    if (cb_data_state.active && IsCBDataMethod(method)) {
+        regs.reg_array[method] = data[count - 1];
+        ProcessCBMultiData(data, count);
+        return;
     }
-    case MAXWELL3D_REG_INDEX(data_upload): {
-        const bool is_last_call = method_call.IsLastCall();
-        upload_state.ProcessData(method_call.argument, is_last_call);
+
+    if (method == MAXWELL3D_REG_INDEX(data_upload)) {
+        regs.reg_array[method] = data[count - 1];
+        upload_state.ProcessData(data, count, is_last_call);
         if (is_last_call) {
             dirty.OnMemoryWrite();
         }
-        break;
+        return;
     }
-    default:
-        break;
+
+    if (!method_has_trigger[method]) {
+        // Without side effects only the last value written is observable, the dirty flags are
+        // only read by draws
+        CallMethod({method, data[count - 1], 0, methods_pending - count});
+        return;
     }
 
-    if (debug_context) {
-        debug_context->OnEvent(Tegra::DebugContext::Event::MaxwellCommandProcessed, nullptr);
+    for (u32 i = 0; i < count; ++i) {
+        CallMethod({method, data[i], 0, methods_pending - 1 - i});
     }
 }
 
@@ -518,6 +673,27 @@ void Maxwell3D::ProcessMacroUpload(u32 data) {
     ASSERT_MSG(regs.macros.upload_address < macro_memory.size(),
                "upload_address exceeded macro_memory size!");
     macro_memory[regs.macros.upload_address++] = data;
+    macro_upload_ends[macro_upload_start] = regs.macros.upload_address;
+    macro_hashes.clear();
+    macro_compiler.Invalidate();
+}
+
+u64 Maxwell3D::GetMacroHash(u32 offset) {
+    const auto [it, inserted] = macro_hashes.try_emplace(offset);
+    if (!inserted) {
+        return it->second;
+    }
+
+    // A macro spans from its offset to the end of the upload it is part of, the latest upload
+    // starting at or before the offset.
+    const u32 start = std::min(offset, static_cast<u32>(macro_memory.size()));
+    u32 end = start;
+    const auto upload = macro_upload_ends.upper_bound(start);
+    if (upload != macro_upload_ends.begin()) {
+        end = std::max(start, std::prev(upload)->second);
+    }
+    it->second = boost::hash_range(macro_memory.begin() + start, macro_memory.begin() + end);
+    return it->second;
 }
 
 void Maxwell3D::ProcessMacroBind(u32 data) {
@@ -537,18 +713,28 @@ void Maxwell3D::ProcessQueryGet() {
     // Since the sequence address is given as a GPU VAddr, we have to convert it to an application
     // VAddr before writing.
 
-    // TODO(Subv): Support the other query units.
-    ASSERT_MSG(regs.query.query_get.unit == Regs::QueryUnit::Crop,
-               "Units other than CROP are unimplemented");
+    if (regs.query.query_get.mode != Regs::QueryMode::Write &&
+        regs.query.query_get.mode != Regs::QueryMode::Write2) {
+        UNIMPLEMENTED_MSG("Query mode {} not implemented",
+                          static_cast<u32>(regs.query.query_get.mode.Value()));
+        return;
+    }
 
     u64 result = 0;
 
     // TODO(Subv): Support the other query variables
     switch (regs.query.query_get.select) {
     case Regs::QuerySelect::Zero:
+        // TODO(Subv): Support the other query units.
+        ASSERT_MSG(regs.query.query_get.unit == Regs::QueryUnit::Crop,
+                   "Units other than CROP are unimplemented");
         // This seems to actually write the query sequence to the query address.
         result = regs.query.query_sequence;
         break;
+    case Regs::QuerySelect::SamplesPassed:
+        // Counters are written by the host GPU, the guest only waits on them when it reads them.
+        QueryCounter(VideoCore::QueryType::SamplesPassed);
+        return;
     default:
         result = 1;
         UNIMPLEMENTED_MSG("Unimplemented query select type {}",
@@ -563,35 +749,52 @@ void Maxwell3D::ProcessQueryGet() {
     };
     static_assert(sizeof(LongQueryResult) == 16, "LongQueryResult has wrong size");
 
-    switch (regs.query.query_get.mode) {
-    case Regs::QueryMode::Write:
-    case Regs::QueryMode::Write2: {
-        u32 sequence = regs.query.query_sequence;
-        if (regs.query.query_get.short_query) {
-            // Write the current query sequence to the sequence address.
-            // TODO(Subv): Find out what happens if you use a long query type but mark it as a short
-            // query.
-            memory_manager.Write<u32>(sequence_address, sequence);
-        } else {
-            // Write the 128-bit result structure in long mode. Note: We emulate an infinitely fast
-            // GPU, this command may actually take a while to complete in real hardware due to GPU
-            // wait queues.
-            LongQueryResult query_result{};
-            query_result.value = result;
-            // TODO(Subv): Generate a real GPU timestamp and write it here instead of CoreTiming
-            query_result.timestamp = system.CoreTiming().GetTicks();
-            memory_manager.WriteBlock(sequence_address, &query_result, sizeof(query_result));
-        }
-        break;
+    u32 sequence = regs.query.query_sequence;
+    if (regs.query.query_get.short_query) {
+        // Write the current query sequence to the sequence address.
+        // TODO(Subv): Find out what happens if you use a long query type but mark it as a short
+        // query.
+        rasterizer.SignalSemaphore(sequence_address, &sequence, sizeof(sequence));
+    } else {
+        // Write the 128-bit result structure in long mode. The write retires once the host GPU
+        // has executed the commands before it, much like the wait queues of real hardware.
+        LongQueryResult query_result{};
+        query_result.value = result;
+        // TODO(Subv): Generate a real GPU timestamp and write it here instead of CoreTiming
+        query_result.timestamp = system.CoreTiming().GetTicks();
+        rasterizer.SignalSemaphore(sequence_address, &query_result, sizeof(query_result));
+    }
+}
+
+void Maxwell3D::QueryCounter(VideoCore::QueryType type) {
+    std::optional<u64> timestamp;
+    if (!regs.query.query_get.short_query) {
+        // TODO(Subv): Generate a real GPU timestamp and write it here instead of CoreTiming
+        timestamp = system.CoreTiming().GetTicks();
     }
+    rasterizer.Query(regs.query.QueryAddress(), type, timestamp);
+}
+
+void Maxwell3D::ProcessCounterReset() {
+    switch (regs.counter_reset) {
+    case Regs::CounterReset::SampleCnt:
+        rasterizer.ResetCounter(VideoCore::QueryType::SamplesPassed);
+        break;
     default:
-        UNIMPLEMENTED_MSG("Query mode {} not implemented",
-                          static_cast<u32>(regs.query.query_get.mode.Value()));
+        LOG_DEBUG(HW_GPU, "Unimplemented counter reset={}",
+                  static_cast<u32>(regs.counter_reset));
+        break;
     }
 }
 
 void Maxwell3D::ProcessQueryCondition() {
     const GPUVAddr condition_address{regs.condition.Address()};
+    if (regs.condition.mode != Regs::ConditionMode::Always &&
+        regs.condition.mode != Regs::ConditionMode::Never) {
+        // Queries retire asynchronously, make sure the ones being compared have been written.
+        rasterizer.FlushRegion(ToCacheAddr(memory_manager.GetPointer(condition_address)),
+                               sizeof(Regs::QueryCompare));
+    }
     switch (regs.condition.mode) {
     case Regs::ConditionMode::Always: {
         execute_on = true;
@@ -695,20 +898,26 @@ void Maxwell3D::ProcessCBBind(Regs::ShaderStage stage) {
 }
 
 void Maxwell3D::ProcessCBData(u32 value) {
-    const u32 id = cb_data_state.id;
-    cb_data_state.buffer[id][cb_data_state.counter] = value;
+    ASSERT(cb_data_state.counter < cb_data_state.buffer.size());
+    cb_data_state.buffer[cb_data_state.counter] = value;
     // Increment the current buffer position.
     regs.const_buffer.cb_pos = regs.const_buffer.cb_pos + 4;
     cb_data_state.counter++;
 }
 
+void Maxwell3D::ProcessCBMultiData(const u32* data, u32 count) {
+    ASSERT(cb_data_state.counter + count <= cb_data_state.buffer.size());
+    std::memcpy(cb_data_state.buffer.data() + cb_data_state.counter, data, count * sizeof(u32));
+    // Increment the current buffer position.
+    regs.const_buffer.cb_pos = regs.const_buffer.cb_pos + 4 * count;
+    cb_data_state.counter += count;
+}
+
 void Maxwell3D::StartCBData(u32 method) {
-    constexpr u32 first_cb_data = MAXWELL3D_REG_INDEX(const_buffer.cb_data[0]);
     cb_data_state.start_pos = regs.const_buffer.cb_pos;
-    cb_data_state.id = method - first_cb_data;
-    cb_data_state.current = method;
+    cb_data_state.active = true;
     cb_data_state.counter = 0;
-    ProcessCBData(regs.const_buffer.cb_data[cb_data_state.id]);
+    ProcessCBData(regs.reg_array[method]);
 }
 
 void Maxwell3D::FinishCBData() {
@@ -722,12 +931,10 @@ void Maxwell3D::FinishCBData() {
     const GPUVAddr address{buffer_address + cb_data_state.start_pos};
     const std::size_t size = regs.const_buffer.cb_pos - cb_data_state.start_pos;
 
-    const u32 id = cb_data_state.id;
-    memory_manager.WriteBlock(address, cb_data_state.buffer[id].data(), size);
+    memory_manager.WriteBlock(address, cb_data_state.buffer.data(), size);
     dirty.OnMemoryWrite();
 
-    cb_data_state.id = null_cb_data;
-    cb_data_state.current = null_cb_data;
+    cb_data_state.active = false;
 }
 
 Texture::TICEntry Maxwell3D::GetTICEntry(u32 tic_index) const {
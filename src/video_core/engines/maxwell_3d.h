@@ -6,6 +6,7 @@
 
 #include <array>
 #include <bitset>
+#include <map>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -18,6 +19,9 @@
 #include "video_core/engines/const_buffer_info.h"
 #include "video_core/engines/engine_upload.h"
 #include "video_core/gpu.h"
+#include "video_core/macro_compiler.h"
+#include "video_core/macro_engine_interface.h"
+#include "video_core/macro_hle.h"
 #include "video_core/macro_interpreter.h"
 #include "video_core/textures/texture.h"
 
@@ -31,6 +35,7 @@ class MemoryManager;
 
 namespace VideoCore {
 class RasterizerInterface;
+enum class QueryType;
 }
 
 namespace Tegra::Engines {
@@ -44,11 +49,11 @@ namespace Tegra::Engines {
 #define MAXWELL3D_REG_INDEX(field_name)                                                            \
     (offsetof(Tegra::Engines::Maxwell3D::Regs, field_name) / sizeof(u32))
 
-class Maxwell3D final {
+class Maxwell3D final : public MacroEngineInterface {
 public:
     explicit Maxwell3D(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
                        MemoryManager& memory_manager);
-    ~Maxwell3D() = default;
+    ~Maxwell3D();
 
     /// Register structure of the Maxwell3D engine.
     /// TODO(Subv): This structure will need to be made bigger as more registers are discovered.
@@ -98,6 +103,27 @@ public:
             TransformFeedbackUnknown = 26,
         };
 
+        enum class CounterReset : u32 {
+            SampleCnt = 0x01,
+            Unk02 = 0x02,
+            Unk03 = 0x03,
+            Unk04 = 0x04,
+            EmittedPrimitives = 0x10,
+            Unk11 = 0x11,
+            Unk12 = 0x12,
+            Unk13 = 0x13,
+            Unk15 = 0x15,
+            Unk16 = 0x16,
+            Unk17 = 0x17,
+            Unk18 = 0x18,
+            Unk1A = 0x1A,
+            Unk1B = 0x1B,
+            Unk1C = 0x1C,
+            Unk1D = 0x1D,
+            Unk1E = 0x1E,
+            GeneratedPrimitives = 0x1F,
+        };
+
         struct QueryCompare {
             u32 initial_sequence;
             u32 initial_mode;
@@ -635,7 +661,11 @@ public:
                     };
                 } sync_info;
 
-                INSERT_PADDING_WORDS(0x11E);
+                INSERT_PADDING_WORDS(0xF1);
+
+                u32 samplecnt_enable;
+
+                INSERT_PADDING_WORDS(0x2C);
 
                 u32 tfb_enabled;
 
@@ -830,7 +860,11 @@ public:
 
                 float point_size;
 
-                INSERT_PADDING_WORDS(0x7);
+                INSERT_PADDING_WORDS(0x5);
+
+                CounterReset counter_reset;
+
+                INSERT_PADDING_WORDS(0x1);
 
                 u32 zeta_enable;
 
@@ -1201,16 +1235,29 @@ public:
                 bool transform_feedback;
                 bool color_mask;
                 bool polygon_offset;
+                bool logic_op;
+                bool multisample_control;
+                bool fragment_color_clamp;
+                bool point_size;
+                bool alpha_test;
 
                 // Complementary
                 bool viewport_transform;
                 bool screen_y_control;
 
                 bool memory_general;
+
+                // Any register other than the draw parameters, consecutive draws without changes
+                // in between can be batched
+                bool draw_state;
             };
             std::array<bool, NUM_REGS> regs;
         };
 
+        /// Increased whenever guest memory may have been written, data read from memory under the
+        /// same value is still current
+        u64 memory_generation{};
+
         void ResetVertexArrays() {
             vertex_array.fill(true);
             vertex_array_buffers = true;
@@ -1223,6 +1270,7 @@ public:
         }
 
         void OnMemoryWrite() {
+            ++memory_generation;
             shaders = true;
             memory_general = true;
             ResetRenderTargets();
@@ -1239,6 +1287,9 @@ public:
     /// Write the value to the register identified by method.
     void CallMethod(const GPU::MethodCall& method_call);
 
+    /// Write multiple values to the register identified by method.
+    void CallMultiMethod(u32 method, const u32* base_start, u32 amount, u32 methods_pending);
+
     /// Write the value to the register identified by method.
     void CallMethodFromMME(const GPU::MethodCall& method_call);
 
@@ -1256,15 +1307,19 @@ public:
 
     u32 AccessConstBuffer32(Regs::ShaderStage stage, u64 const_buffer, u64 offset) const;
 
-    /// Memory for macro code - it's undetermined how big this is, however 1MB is much larger than
-    /// we've seen used.
-    using MacroMemory = std::array<u32, 0x40000>;
-
     /// Gets a reference to macro memory.
-    const MacroMemory& GetMacroMemory() const {
+    const MacroMemory& GetMacroMemory() const override {
         return macro_memory;
     }
 
+    void CallMethodFromMacro(u32 method, u32 argument) override {
+        CallMethodFromMME({method, argument});
+    }
+
+    u32 ReadRegisterFromMacro(u32 method) const override {
+        return GetRegisterValue(method);
+    }
+
     bool ShouldExecute() const {
         return execute_on;
     }
@@ -1301,6 +1356,13 @@ private:
     /// Memory for macro code
     MacroMemory macro_memory;
 
+    /// Address the current batch of macro code uploads started at.
+    u32 macro_upload_start = 0;
+    /// End address of each batch of uploaded macro code, by its start address.
+    std::map<u32, u32> macro_upload_ends;
+    /// Hash of the code of each macro that was called since the last upload, by its offset.
+    std::unordered_map<u32, u64> macro_hashes;
+
     /// Macro method that is currently being executed / being fed parameters.
     u32 executing_macro = 0;
     /// Parameters that have been submitted to the macro call so far.
@@ -1308,12 +1370,16 @@ private:
 
     /// Interpreter for the macro codes uploaded to the GPU.
     MacroInterpreter macro_interpreter;
+    /// Translated form of the uploaded macros, preferred over the interpreter.
+    MacroCompiler macro_compiler;
+    /// Native replacements for well known macros.
+    MacroHLE macro_hle;
 
-    static constexpr u32 null_cb_data = 0xFFFFFFFF;
+    /// Run of CB_DATA writes staged to be written to memory at once, a const buffer holds at most
+    /// 0x4000 words.
     struct {
-        std::array<std::array<u32, 0x4000>, 16> buffer;
-        u32 current{null_cb_data};
-        u32 id{null_cb_data};
+        std::array<u32, 0x4000> buffer;
+        bool active{};
         u32 start_pos{};
         u32 counter{};
     } cb_data_state;
@@ -1330,6 +1396,30 @@ private:
 
     void InitDirtySettings();
 
+    /// Which of the dirty flags covering several registers a register write sets.
+    enum class DirtyGroup {
+        Untracked,      ///< The register isn't tracked by any dirty flag
+        Tracked,        ///< Only the register's own dirty flag
+        VertexArray,    ///< Also vertex_array_buffers
+        VertexInstance, ///< Also vertex_instances
+        RenderTarget,   ///< Also render_settings
+    };
+
+    /// Writes a register, sets the dirty flags it's tracked by and runs what the write triggers.
+    using MethodHandler = void (*)(Maxwell3D& maxwell3d, const GPU::MethodCall& method_call);
+
+    /// Fills the method handlers, the dirty pointers have to be initialized first.
+    void InitMethodHandlers();
+
+    /// Writes a register without side effects.
+    template <bool is_draw_parameter, DirtyGroup group>
+    static void WriteRegister(Maxwell3D& maxwell3d, const GPU::MethodCall& method_call);
+
+    /// Handler of each register.
+    std::array<MethodHandler, Regs::NUM_REGS> method_handlers{};
+    /// Registers whose writes do more than update the dirty flags.
+    std::array<bool, Regs::NUM_REGS> method_has_trigger{};
+
     /**
      * Call a macro on this engine.
      * @param method Method to call
@@ -1341,6 +1431,9 @@ private:
     /// Handles writes to the macro uploading register.
     void ProcessMacroUpload(u32 data);
 
+    /// Returns the hash of the code of the macro at the given offset, as it was uploaded.
+    u64 GetMacroHash(u32 offset);
+
     /// Handles writes to the macro bind register.
     void ProcessMacroBind(u32 data);
 
@@ -1353,15 +1446,22 @@ private:
     /// Handles a write to the QUERY_GET register.
     void ProcessQueryGet();
 
+    /// Writes the value of a host counter to the query address.
+    void QueryCounter(VideoCore::QueryType type);
+
+    /// Handles a write to the COUNTER_RESET register.
+    void ProcessCounterReset();
+
     // Handles Conditional Rendering
     void ProcessQueryCondition();
 
     /// Handles writes to syncing register.
     void ProcessSyncPoint();
 
-    /// Handles a write to the CB_DATA[i] register.
+    /// Handles writes to the CB_DATA[i] registers, consecutive writes are committed as one block.
     void StartCBData(u32 method);
     void ProcessCBData(u32 value);
+    void ProcessCBMultiData(const u32* data, u32 count);
     void FinishCBData();
 
     /// Handles a write to the CB_BIND register.
@@ -1383,6 +1483,7 @@ ASSERT_REG_POSITION(upload, 0x60);
 ASSERT_REG_POSITION(exec_upload, 0x6C);
 ASSERT_REG_POSITION(data_upload, 0x6D);
 ASSERT_REG_POSITION(sync_info, 0xB2);
+ASSERT_REG_POSITION(samplecnt_enable, 0x1A4);
 ASSERT_REG_POSITION(tfb_enabled, 0x1D1);
 ASSERT_REG_POSITION(rt, 0x200);
 ASSERT_REG_POSITION(viewport_transform, 0x280);
@@ -1431,6 +1532,7 @@ ASSERT_REG_POSITION(vb_element_base, 0x50D);
 ASSERT_REG_POSITION(vb_base_instance, 0x50E);
 ASSERT_REG_POSITION(clip_distance_enabled, 0x544);
 ASSERT_REG_POSITION(point_size, 0x546);
+ASSERT_REG_POSITION(counter_reset, 0x54C);
 ASSERT_REG_POSITION(zeta_enable, 0x54E);
 ASSERT_REG_POSITION(multisample_control, 0x54F);
 ASSERT_REG_POSITION(condition, 0x554);
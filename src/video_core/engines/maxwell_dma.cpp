@@ -9,13 +9,15 @@
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/memory_manager.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/textures/decoders.h"
 
 namespace Tegra::Engines {
 
-MaxwellDMA::MaxwellDMA(Core::System& system, MemoryManager& memory_manager)
-    : system{system}, memory_manager{memory_manager} {}
+MaxwellDMA::MaxwellDMA(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
+                       MemoryManager& memory_manager)
+    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager} {}
 
 void MaxwellDMA::CallMethod(const GPU::MethodCall& method_call) {
     ASSERT_MSG(method_call.method < Regs::NUM_REGS,
@@ -36,6 +38,13 @@ void MaxwellDMA::CallMethod(const GPU::MethodCall& method_call) {
 #undef MAXWELLDMA_REG_INDEX
 }
 
+void MaxwellDMA::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                                 u32 methods_pending) {
+    for (u32 i = 0; i < amount; ++i) {
+        CallMethod({method, base_start[i], 0, methods_pending - i});
+    }
+}
+
 void MaxwellDMA::HandleCopy() {
     LOG_TRACE(HW_GPU, "Requested a DMA copy");
 
@@ -64,7 +73,7 @@ void MaxwellDMA::HandleCopy() {
         // buffer of length `x_count`, otherwise we copy a 2D image of dimensions (x_count,
         // y_count).
         if (!regs.exec.enable_2d) {
-            memory_manager.CopyBlock(dest, source, regs.x_count);
+            CopyLinear(dest, source, regs.x_count);
             return;
         }
 
@@ -72,10 +81,14 @@ void MaxwellDMA::HandleCopy() {
         // copy. We're going to take a subrect of size (x_count, y_count) from the source
         // rectangle. There is no need to manually flush/invalidate the regions because
         // CopyBlock does that for us.
+        if (regs.src_pitch == regs.x_count && regs.dst_pitch == regs.x_count) {
+            CopyLinear(dest, source, static_cast<std::size_t>(regs.x_count) * regs.y_count);
+            return;
+        }
         for (u32 line = 0; line < regs.y_count; ++line) {
             const GPUVAddr source_line = source + line * regs.src_pitch;
             const GPUVAddr dest_line = dest + line * regs.dst_pitch;
-            memory_manager.CopyBlock(dest_line, source_line, regs.x_count);
+            CopyLinear(dest_line, source_line, regs.x_count);
         }
         return;
     }
@@ -154,4 +167,13 @@ void MaxwellDMA::HandleCopy() {
     }
 }
 
+void MaxwellDMA::CopyLinear(GPUVAddr dest, GPUVAddr source, std::size_t size) {
+    // Copying on the host GPU avoids downloading data the guest memory doesn't have yet, the
+    // destination is written back to guest memory when it's flushed.
+    if (rasterizer.AccelerateDMACopy(dest, source, size)) {
+        return;
+    }
+    memory_manager.CopyBlock(dest, source, size);
+}
+
 } // namespace Tegra::Engines
@@ -20,6 +20,10 @@ namespace Tegra {
 class MemoryManager;
 }
 
+namespace VideoCore {
+class RasterizerInterface;
+}
+
 namespace Tegra::Engines {
 
 /**
@@ -29,12 +33,16 @@ namespace Tegra::Engines {
 
 class MaxwellDMA final {
 public:
-    explicit MaxwellDMA(Core::System& system, MemoryManager& memory_manager);
+    explicit MaxwellDMA(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
+                        MemoryManager& memory_manager);
     ~MaxwellDMA() = default;
 
     /// Write the value to the register identified by method.
     void CallMethod(const GPU::MethodCall& method_call);
 
+    /// Write multiple values to the register identified by method.
+    void CallMultiMethod(u32 method, const u32* base_start, u32 amount, u32 methods_pending);
+
     struct Regs {
         static constexpr std::size_t NUM_REGS = 0x1D6;
 
@@ -175,6 +183,8 @@ public:
 private:
     Core::System& system;
 
+    VideoCore::RasterizerInterface& rasterizer;
+
     MemoryManager& memory_manager;
 
     std::vector<u8> read_buffer;
@@ -183,6 +193,9 @@ private:
     /// Performs the copy from the source buffer to the destination buffer as configured in the
     /// registers.
     void HandleCopy();
+
+    /// Copies a linear block, on the host GPU when the rasterizer holds the source.
+    void CopyLinear(GPUVAddr dest, GPUVAddr source, std::size_t size);
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <functional>
 #include <optional>
 #include <tuple>
 #include <vector>
@@ -1771,6 +1773,10 @@ public:
             return mask;
         }
 
+        u16 GetExpected() const {
+            return expected;
+        }
+
         Id GetId() const {
             return id;
         }
@@ -1797,18 +1803,75 @@ public:
     };
 
     static std::optional<std::reference_wrapper<const Matcher>> Decode(Instruction instr) {
-        static const auto table{GetDecodeTable()};
-
-        const auto matches_instruction = [instr](const auto& matcher) {
-            return matcher.Matches(static_cast<u16>(instr.opcode));
-        };
+        static const DecodeLookup lookup{GetMatchers()};
+        return lookup.Find(static_cast<u16>(instr.opcode));
+    }
 
-        auto iter = std::find_if(table.begin(), table.end(), matches_instruction);
-        return iter != table.end() ? std::optional<std::reference_wrapper<const Matcher>>(*iter)
-                                   : std::nullopt;
+    /// Returns every matcher, the most specific ones first. The first one matching wins.
+    static const std::vector<Matcher>& GetMatchers() {
+        static const auto table{GetDecodeTable()};
+        return table;
     }
 
 private:
+    /**
+     * Resolves an opcode to the first matcher that matches it in two lookups. The first level is
+     * indexed by the top byte of the opcode. Top bytes that leave the matcher undecided point to
+     * a second level block indexed by the bottom byte.
+     */
+    class DecodeLookup {
+    public:
+        explicit DecodeLookup(const std::vector<Matcher>& matchers) : matchers{matchers} {
+            std::vector<u16> candidates;
+            for (std::size_t high = 0; high < first_level.size(); ++high) {
+                // Only matchers agreeing with the top byte can match any of its opcodes
+                candidates.clear();
+                for (std::size_t i = 0; i < matchers.size(); ++i) {
+                    const u16 high_mask = matchers[i].GetMask() & 0xFF00;
+                    if (((high << 8) & high_mask) == (matchers[i].GetExpected() & high_mask)) {
+                        candidates.push_back(static_cast<u16>(i));
+                    }
+                }
+
+                std::array<u16, 256> block;
+                for (std::size_t low = 0; low < block.size(); ++low) {
+                    const auto opcode = static_cast<u16>((high << 8) | low);
+                    const auto it = std::find_if(
+                        candidates.begin(), candidates.end(),
+                        [&](u16 index) { return matchers[index].Matches(opcode); });
+                    block[low] = it != candidates.end() ? *it : NoMatch;
+                }
+
+                if (std::all_of(block.begin(), block.end(),
+                                [&block](u16 entry) { return entry == block[0]; })) {
+                    first_level[high] = block[0];
+                } else {
+                    first_level[high] = static_cast<u16>(SecondLevelFlag | second_level.size());
+                    second_level.push_back(block);
+                }
+            }
+        }
+
+        std::optional<std::reference_wrapper<const Matcher>> Find(u16 opcode) const {
+            u16 entry = first_level[opcode >> 8];
+            if ((entry & SecondLevelFlag) != 0) {
+                entry = second_level[entry & ~SecondLevelFlag][opcode & 0xFF];
+            }
+            if (entry == NoMatch) {
+                return std::nullopt;
+            }
+            return matchers[entry];
+        }
+
+    private:
+        static constexpr u16 SecondLevelFlag = 0x8000;
+        static constexpr u16 NoMatch = 0x7FFF;
+
+        const std::vector<Matcher>& matchers;
+        std::array<u16, 256> first_level{};
+        std::vector<std::array<u16, 256>> second_level;
+    };
+
     struct Detail {
     private:
         static constexpr std::size_t opcode_bitsize = 16;
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <functional>
+
 #include "common/assert.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -12,6 +15,7 @@
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
+#include "video_core/gpu_profiler.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_base.h"
 
@@ -25,8 +29,9 @@ GPU::GPU(Core::System& system, VideoCore::RendererBase& renderer, bool is_async)
     maxwell_3d = std::make_unique<Engines::Maxwell3D>(system, rasterizer, *memory_manager);
     fermi_2d = std::make_unique<Engines::Fermi2D>(rasterizer);
     kepler_compute = std::make_unique<Engines::KeplerCompute>(system, rasterizer, *memory_manager);
-    maxwell_dma = std::make_unique<Engines::MaxwellDMA>(system, *memory_manager);
-    kepler_memory = std::make_unique<Engines::KeplerMemory>(system, *memory_manager);
+    maxwell_dma = std::make_unique<Engines::MaxwellDMA>(system, rasterizer, *memory_manager);
+    kepler_memory = std::make_unique<Engines::KeplerMemory>(system, rasterizer, *memory_manager);
+    profiler = std::make_unique<VideoCore::GPUProfiler>();
 }
 
 GPU::~GPU() = default;
@@ -63,20 +68,19 @@ const DmaPusher& GPU::DmaPusher() const {
     return *dma_pusher;
 }
 
+VideoCore::GPUProfiler& GPU::Profiler() {
+    return *profiler;
+}
+
 void GPU::IncrementSyncPoint(const u32 syncpoint_id) {
-    syncpoints[syncpoint_id]++;
+    const u32 value = ++syncpoints[syncpoint_id];
     std::lock_guard lock{sync_mutex};
-    if (!syncpt_interrupts[syncpoint_id].empty()) {
-        u32 value = syncpoints[syncpoint_id].load();
-        auto it = syncpt_interrupts[syncpoint_id].begin();
-        while (it != syncpt_interrupts[syncpoint_id].end()) {
-            if (value >= *it) {
-                TriggerCpuInterrupt(syncpoint_id, *it);
-                it = syncpt_interrupts[syncpoint_id].erase(it);
-                continue;
-            }
-            it++;
-        }
+    // Thresholds are kept in a min-heap, only the satisfied ones are visited
+    auto& interrupt = syncpt_interrupts[syncpoint_id];
+    while (!interrupt.empty() && interrupt.front() <= value) {
+        TriggerCpuInterrupt(syncpoint_id, interrupt.front());
+        std::pop_heap(interrupt.begin(), interrupt.end(), std::greater<>{});
+        interrupt.pop_back();
     }
 }
 
@@ -86,25 +90,22 @@ u32 GPU::GetSyncpointValue(const u32 syncpoint_id) const {
 
 void GPU::RegisterSyncptInterrupt(const u32 syncpoint_id, const u32 value) {
     auto& interrupt = syncpt_interrupts[syncpoint_id];
-    bool contains = std::any_of(interrupt.begin(), interrupt.end(),
-                                [value](u32 in_value) { return in_value == value; });
-    if (contains) {
+    if (std::find(interrupt.begin(), interrupt.end(), value) != interrupt.end()) {
         return;
     }
-    syncpt_interrupts[syncpoint_id].emplace_back(value);
+    interrupt.push_back(value);
+    std::push_heap(interrupt.begin(), interrupt.end(), std::greater<>{});
 }
 
 bool GPU::CancelSyncptInterrupt(const u32 syncpoint_id, const u32 value) {
     std::lock_guard lock{sync_mutex};
     auto& interrupt = syncpt_interrupts[syncpoint_id];
-    const auto iter =
-        std::find_if(interrupt.begin(), interrupt.end(),
-                     [value](u32 interrupt_value) { return value == interrupt_value; });
-
+    const auto iter = std::find(interrupt.begin(), interrupt.end(), value);
     if (iter == interrupt.end()) {
         return false;
     }
     interrupt.erase(iter);
+    std::make_heap(interrupt.begin(), interrupt.end(), std::greater<>{});
     return true;
 }
 
@@ -215,16 +216,31 @@ void GPU::CallMethod(const MethodCall& method_call) {
 
     ASSERT(method_call.subchannel < bound_engines.size());
 
-    if (ExecuteMethodOnEngine(method_call)) {
+    if (ExecuteMethodOnEngine(method_call.method)) {
         CallEngineMethod(method_call);
     } else {
         CallPullerMethod(method_call);
     }
 }
 
-bool GPU::ExecuteMethodOnEngine(const MethodCall& method_call) {
-    const auto method = static_cast<BufferMethods>(method_call.method);
-    return method >= BufferMethods::NonPullerMethods;
+void GPU::CallMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                          u32 methods_pending) {
+    LOG_TRACE(HW_GPU, "Processing method {:08X} {} times on subchannel {}", method, amount,
+              subchannel);
+
+    ASSERT(subchannel < bound_engines.size());
+
+    if (ExecuteMethodOnEngine(method)) {
+        CallEngineMultiMethod(method, subchannel, base_start, amount, methods_pending);
+        return;
+    }
+    for (u32 i = 0; i < amount; ++i) {
+        CallPullerMethod({method, base_start[i], subchannel, methods_pending - i});
+    }
+}
+
+bool GPU::ExecuteMethodOnEngine(u32 method) {
+    return static_cast<BufferMethods>(method) >= BufferMethods::NonPullerMethods;
 }
 
 void GPU::CallPullerMethod(const MethodCall& method_call) {
@@ -304,6 +320,31 @@ void GPU::CallEngineMethod(const MethodCall& method_call) {
     }
 }
 
+void GPU::CallEngineMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                                u32 methods_pending) {
+    const EngineID engine = bound_engines[subchannel];
+
+    switch (engine) {
+    case EngineID::FERMI_TWOD_A:
+        fermi_2d->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::MAXWELL_B:
+        maxwell_3d->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::KEPLER_COMPUTE_B:
+        kepler_compute->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::MAXWELL_DMA_COPY_A:
+        maxwell_dma->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::KEPLER_INLINE_TO_MEMORY_B:
+        kepler_memory->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    default:
+        UNIMPLEMENTED_MSG("Unimplemented engine");
+    }
+}
+
 void GPU::ProcessBindMethod(const MethodCall& method_call) {
     // Bind the current subchannel to the desired engine id.
     LOG_DEBUG(HW_GPU, "Binding subchannel {} to engine {}", method_call.subchannel,
@@ -327,10 +368,13 @@ void GPU::ProcessSemaphoreTriggerMethod() {
         // TODO(Kmather73): Generate a real GPU timestamp and write it here instead of
         // CoreTiming
         block.timestamp = Core::System::GetInstance().CoreTiming().GetTicks();
-        memory_manager->WriteBlock(regs.semaphore_address.SemaphoreAddress(), &block,
-                                   sizeof(block));
+        renderer.Rasterizer().SignalSemaphore(regs.semaphore_address.SemaphoreAddress(), &block,
+                                              sizeof(block));
     } else {
-        const u32 word{memory_manager->Read<u32>(regs.semaphore_address.SemaphoreAddress())};
+        const GPUVAddr address{regs.semaphore_address.SemaphoreAddress()};
+        renderer.Rasterizer().FlushRegion(ToCacheAddr(memory_manager->GetPointer(address)),
+                                          sizeof(u32));
+        const u32 word{memory_manager->Read<u32>(address)};
         if ((op == GpuSemaphoreOperation::AcquireEqual && word == regs.semaphore_sequence) ||
             (op == GpuSemaphoreOperation::AcquireGequal &&
              static_cast<s32>(word - regs.semaphore_sequence) > 0) ||
@@ -357,11 +401,16 @@ void GPU::ProcessSemaphoreTriggerMethod() {
 }
 
 void GPU::ProcessSemaphoreRelease() {
-    memory_manager->Write<u32>(regs.semaphore_address.SemaphoreAddress(), regs.semaphore_release);
+    const u32 value = regs.semaphore_release;
+    renderer.Rasterizer().SignalSemaphore(regs.semaphore_address.SemaphoreAddress(), &value,
+                                          sizeof(value));
 }
 
 void GPU::ProcessSemaphoreAcquire() {
-    const u32 word = memory_manager->Read<u32>(regs.semaphore_address.SemaphoreAddress());
+    const GPUVAddr address = regs.semaphore_address.SemaphoreAddress();
+    renderer.Rasterizer().FlushRegion(ToCacheAddr(memory_manager->GetPointer(address)),
+                                      sizeof(u32));
+    const u32 word = memory_manager->Read<u32>(address);
     const auto value = regs.semaphore_acquire;
     if (word != value) {
         regs.acquire_active = true;
@@ -6,9 +6,9 @@
 
 #include <array>
 #include <atomic>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/service/nvdrv/nvdata.h"
 #include "core/hle/service/nvflinger/buffer_queue.h"
@@ -28,6 +28,7 @@ class System;
 }
 
 namespace VideoCore {
+class GPUProfiler;
 class RendererBase;
 } // namespace VideoCore
 
@@ -154,6 +155,17 @@ public:
     /// Calls a GPU method.
     void CallMethod(const MethodCall& method_call);
 
+    /**
+     * Calls a GPU method several times in a row with consecutive arguments.
+     * @param method Method to call.
+     * @param subchannel Subchannel of the engine the method belongs to.
+     * @param base_start Arguments of the calls.
+     * @param amount Number of calls to make.
+     * @param methods_pending Number of calls left in the command, including these.
+     */
+    void CallMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                         u32 methods_pending);
+
     void FlushCommands();
 
     /// Returns a reference to the Maxwell3D GPU engine.
@@ -177,6 +189,9 @@ public:
     /// Returns a reference to the GPU DMA pusher.
     Tegra::DmaPusher& DmaPusher();
 
+    /// Returns a reference to the profiler of the host GPU work.
+    VideoCore::GPUProfiler& Profiler();
+
     void IncrementSyncPoint(u32 syncpoint_id);
 
     u32 GetSyncpointValue(u32 syncpoint_id) const;
@@ -276,8 +291,12 @@ private:
     /// Calls a GPU engine method.
     void CallEngineMethod(const MethodCall& method_call);
 
+    /// Calls a GPU engine method several times in a row.
+    void CallEngineMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                               u32 methods_pending);
+
     /// Determines where the method should be executed.
-    bool ExecuteMethodOnEngine(const MethodCall& method_call);
+    bool ExecuteMethodOnEngine(u32 method);
 
 protected:
     std::unique_ptr<Tegra::DmaPusher> dma_pusher;
@@ -286,6 +305,7 @@ protected:
 
 private:
     std::unique_ptr<Tegra::MemoryManager> memory_manager;
+    std::unique_ptr<VideoCore::GPUProfiler> profiler;
 
     /// Mapping of command subchannels to their bound engine ids
     std::array<EngineID, 8> bound_engines = {};
@@ -302,7 +322,8 @@ private:
 
     std::array<std::atomic<u32>, Service::Nvidia::MaxSyncPoints> syncpoints{};
 
-    std::array<std::list<u32>, Service::Nvidia::MaxSyncPoints> syncpt_interrupts;
+    /// Min-heaps of the pending interrupt thresholds of each syncpoint
+    std::array<std::vector<u32>, Service::Nvidia::MaxSyncPoints> syncpt_interrupts;
 
     std::mutex sync_mutex;
 
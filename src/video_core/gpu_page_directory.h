@@ -0,0 +1,98 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "common/common_types.h"
+#include "common/page_table.h"
+
+namespace Tegra {
+
+/**
+ * Translation table of a GPU address space. Pages are looked up through a two-level table whose
+ * second level is only allocated for the parts of the address space that have been mapped, so a
+ * 40-bit address space costs a small directory instead of a flat array with an entry per page.
+ *
+ * @tparam page_bits     Size of a page in bits.
+ * @tparam address_width Size of the address space in bits.
+ */
+template <std::size_t page_bits, std::size_t address_width>
+class PageDirectory {
+    static constexpr std::size_t page_index_bits = address_width - page_bits;
+    static constexpr std::size_t leaf_bits = page_index_bits / 2;
+    static constexpr std::size_t leaf_size = std::size_t{1} << leaf_bits;
+    static constexpr std::size_t leaf_mask = leaf_size - 1;
+    static constexpr std::size_t directory_size = std::size_t{1} << (page_index_bits - leaf_bits);
+
+public:
+    static constexpr std::size_t num_pages = std::size_t{1} << page_index_bits;
+    static constexpr u64 page_size = u64{1} << page_bits;
+
+    /// Returns the host pointer backing a page, or null when it's not mapped to memory.
+    u8* GetPointer(std::size_t page) const {
+        const Leaf* const leaf = directory[page >> leaf_bits].get();
+        return leaf ? leaf->pointers[page & leaf_mask] : nullptr;
+    }
+
+    /// Returns the CPU address backing a page, or zero when there is none.
+    VAddr GetBackingAddr(std::size_t page) const {
+        const Leaf* const leaf = directory[page >> leaf_bits].get();
+        return leaf ? leaf->backing_addr[page & leaf_mask] : 0;
+    }
+
+    Common::PageType GetAttribute(std::size_t page) const {
+        const Leaf* const leaf = directory[page >> leaf_bits].get();
+        return leaf ? leaf->attributes[page & leaf_mask] : Common::PageType::Unmapped;
+    }
+
+    /**
+     * Maps a range of pages. Non-null memory and its backing address advance a page at a time,
+     * otherwise every page in the range takes the same backing address.
+     */
+    void Map(std::size_t page, std::size_t count, u8* memory, Common::PageType type,
+             VAddr backing_addr) {
+        const bool is_empty = memory == nullptr && backing_addr == 0 &&
+                              type == Common::PageType::Unmapped;
+        while (count > 0) {
+            const std::size_t first = page & leaf_mask;
+            const std::size_t leaf_count = std::min(count, leaf_size - first);
+            std::unique_ptr<Leaf>& leaf = directory[page >> leaf_bits];
+            if (!leaf && !is_empty) {
+                leaf = std::make_unique<Leaf>();
+            }
+            if (leaf) {
+                std::fill_n(leaf->attributes.begin() + first, leaf_count, type);
+                if (memory == nullptr) {
+                    std::fill_n(leaf->pointers.begin() + first, leaf_count, nullptr);
+                    std::fill_n(leaf->backing_addr.begin() + first, leaf_count, backing_addr);
+                } else {
+                    for (std::size_t i = first; i < first + leaf_count; ++i) {
+                        leaf->pointers[i] = memory;
+                        leaf->backing_addr[i] = backing_addr;
+                        memory += page_size;
+                        backing_addr += page_size;
+                    }
+                }
+            }
+            page += leaf_count;
+            count -= leaf_count;
+        }
+    }
+
+private:
+    struct Leaf {
+        std::array<u8*, leaf_size> pointers{};
+        std::array<VAddr, leaf_size> backing_addr{};
+        std::array<Common::PageType, leaf_size> attributes{};
+    };
+
+    std::array<std::unique_ptr<Leaf>, directory_size> directory;
+};
+
+} // namespace Tegra
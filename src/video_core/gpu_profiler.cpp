@@ -0,0 +1,159 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <ctime>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <fmt/format.h>
+
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "video_core/gpu_profiler.h"
+
+namespace VideoCore {
+
+namespace {
+
+/// Appends a complete event, Chrome nests the ones on the same thread that fit in each other.
+void AppendTraceEvent(std::string& json, std::string_view name, std::string_view category,
+                      u64 start_ns, u64 end_ns) {
+    if (json.back() == '}') {
+        json += ',';
+    }
+    json += "\n{\"name\":\"";
+    for (const char c : name) {
+        if (c == '"' || c == '\\') {
+            json += '\\';
+        }
+        json += c;
+    }
+    json += fmt::format("\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":{:.3f},"
+                        "\"dur\":{:.3f}}}",
+                        category, start_ns / 1000.0, (end_ns - start_ns) / 1000.0);
+}
+
+} // Anonymous namespace
+
+GPUProfiler::GPUProfiler() = default;
+
+GPUProfiler::~GPUProfiler() = default;
+
+void GPUProfiler::RequestCapture(u32 num_frames) {
+    requested_frames = num_frames;
+}
+
+void GPUProfiler::AddEvent(std::string name, u32 pass, u64 start_ns, u64 end_ns) {
+    if (!base_ns) {
+        base_ns = start_ns;
+    }
+    // Timestamps before the first one of the capture are clamped to its start
+    start_ns = start_ns - std::min(start_ns, *base_ns);
+    end_ns = std::max(end_ns - std::min(end_ns, *base_ns), start_ns);
+    events.push_back({std::move(name), frame, pass, start_ns, end_ns});
+}
+
+void GPUProfiler::EndFrame() {
+    if (is_capturing) {
+        ++frame;
+        if (--remaining_frames == 0) {
+            FinishCapture();
+        }
+        return;
+    }
+    const u32 num_frames = requested_frames.exchange(0);
+    if (num_frames == 0) {
+        return;
+    }
+    LOG_INFO(HW_GPU, "Capturing a GPU profile of {} frames", num_frames);
+    is_capturing = true;
+    remaining_frames = num_frames;
+    frame = 0;
+    base_ns.reset();
+    events.clear();
+}
+
+std::string GPUProfiler::SerializeChromeTrace(const std::vector<GPUProfileEvent>& events) {
+    std::string json = "{\"traceEvents\":[";
+    auto it = events.begin();
+    while (it != events.end()) {
+        // Frames and passes span the work that ran in them
+        const u32 frame = it->frame;
+        const auto frame_end = std::find_if(
+            it, events.end(), [frame](const auto& event) { return event.frame != frame; });
+        const auto frame_stop = std::max_element(
+            it, frame_end, [](const auto& a, const auto& b) { return a.end_ns < b.end_ns; });
+        AppendTraceEvent(json, fmt::format("Frame {}", frame), "frame", it->start_ns,
+                         frame_stop->end_ns);
+        while (it != frame_end) {
+            const u32 pass = it->pass;
+            const auto pass_end = std::find_if(
+                it, frame_end, [pass](const auto& event) { return event.pass != pass; });
+            const auto pass_stop = std::max_element(
+                it, pass_end, [](const auto& a, const auto& b) { return a.end_ns < b.end_ns; });
+            AppendTraceEvent(json, fmt::format("Pass {}", pass), "pass", it->start_ns,
+                             pass_stop->end_ns);
+            for (; it != pass_end; ++it) {
+                AppendTraceEvent(json, it->name, "draw", it->start_ns, it->end_ns);
+            }
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+std::vector<GPUShaderCost> GPUProfiler::GetMostExpensiveShaders(
+    const std::vector<GPUProfileEvent>& events, std::size_t count) {
+    std::unordered_map<std::string, GPUShaderCost> costs;
+    for (const auto& event : events) {
+        GPUShaderCost& cost = costs[event.name];
+        const u64 duration = event.end_ns - event.start_ns;
+        cost.total_ns += duration;
+        cost.max_ns = std::max(cost.max_ns, duration);
+        ++cost.count;
+    }
+
+    std::vector<GPUShaderCost> sorted;
+    sorted.reserve(costs.size());
+    for (auto& [name, cost] : costs) {
+        cost.name = name;
+        sorted.push_back(std::move(cost));
+    }
+    const auto middle = sorted.begin() + std::min(count, sorted.size());
+    std::partial_sort(sorted.begin(), middle, sorted.end(), [](const auto& a, const auto& b) {
+        return a.total_ns != b.total_ns ? a.total_ns > b.total_ns : a.name < b.name;
+    });
+    sorted.erase(middle, sorted.end());
+    return sorted;
+}
+
+void GPUProfiler::FinishCapture() {
+    is_capturing = false;
+
+    const std::string path =
+        fmt::format("{}gpu_profile_{}.json", FileUtil::GetUserPath(FileUtil::UserPath::LogDir),
+                    static_cast<s64>(std::time(nullptr)));
+    FileUtil::CreateFullPath(path);
+    if (FileUtil::WriteStringToFile(true, path, SerializeChromeTrace(events)) == 0) {
+        LOG_ERROR(HW_GPU, "Failed to write the GPU profile to {}", path);
+    } else {
+        LOG_INFO(HW_GPU, "GPU profile of {} frames written to {}", frame, path);
+    }
+
+    u64 total_ns = 0;
+    for (const auto& event : events) {
+        total_ns += event.end_ns - event.start_ns;
+    }
+    LOG_INFO(HW_GPU, "Most expensive shaders, of {:.3f} ms of GPU work:", total_ns / 1e6);
+    for (const auto& cost : GetMostExpensiveShaders(events, NumTopShaders)) {
+        LOG_INFO(HW_GPU, "{:9.3f} ms {:5.1f}% {:6} draws, {:8.3f} ms max  {}", cost.total_ns / 1e6,
+                 total_ns ? 100.0 * cost.total_ns / total_ns : 0.0, cost.count,
+                 cost.max_ns / 1e6, cost.name);
+    }
+    events.clear();
+    events.shrink_to_fit();
+}
+
+} // namespace VideoCore
@@ -0,0 +1,80 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace VideoCore {
+
+/// Host GPU time spent on a draw or a dispatch.
+struct GPUProfileEvent {
+    std::string name; ///< Shaders that ran
+    u32 frame{};      ///< Frame of the capture it ran in
+    u32 pass{};       ///< Render target bind of the frame it ran in
+    u64 start_ns{};   ///< Relative to the start of the capture
+    u64 end_ns{};
+};
+
+/// GPU time spent on the shaders of a name over a whole capture.
+struct GPUShaderCost {
+    std::string name;
+    u64 total_ns{};
+    u64 max_ns{};
+    u32 count{};
+};
+
+/**
+ * Collects the host GPU timings of a few frames. Captures are requested by the frontend and
+ * filled in by the renderer, a finished capture is written to the log directory as a Chrome trace
+ * and its most expensive shaders are logged.
+ */
+class GPUProfiler final {
+public:
+    static constexpr std::size_t NumTopShaders = 20;
+
+    GPUProfiler();
+    ~GPUProfiler();
+
+    /// Captures the next frames, starting at the next frame boundary. Thread safe.
+    void RequestCapture(u32 num_frames);
+
+    /// Returns true while the renderer has to time its work.
+    bool IsCapturing() const {
+        return is_capturing;
+    }
+
+    /// Adds the timing of a draw or a dispatch of the current frame, in host GPU nanoseconds.
+    void AddEvent(std::string name, u32 pass, u64 start_ns, u64 end_ns);
+
+    /// Marks the end of a frame, starts requested captures and finishes the running one.
+    void EndFrame();
+
+    /// Serializes the events in the Chrome trace format, nested in their frames and passes.
+    static std::string SerializeChromeTrace(const std::vector<GPUProfileEvent>& events);
+
+    /// Returns up to count shader names with the most GPU time, the most expensive first.
+    static std::vector<GPUShaderCost> GetMostExpensiveShaders(
+        const std::vector<GPUProfileEvent>& events, std::size_t count);
+
+private:
+    void FinishCapture();
+
+    std::atomic<u32> requested_frames{};
+
+    // Only used by the GPU thread
+    bool is_capturing = false;
+    u32 frame = 0;
+    u32 remaining_frames = 0;
+    std::optional<u64> base_ns;
+    std::vector<GPUProfileEvent> events;
+};
+
+} // namespace VideoCore
@@ -3,11 +3,14 @@
 // Refer to the license.txt file included.
 
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/scope_exit.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/core_timing_util.h"
-#include "core/frontend/scope_acquire_window_context.h"
+#include "core/settings.h"
 #include "video_core/dma_pusher.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_thread.h"
@@ -19,38 +22,45 @@ namespace VideoCommon::GPUThread {
 static void RunThread(VideoCore::RendererBase& renderer, Tegra::DmaPusher& dma_pusher,
                       SynchState& state) {
     MicroProfileOnThreadCreate("GpuThread");
+    if (!Common::SetCurrentThreadAffinity(Settings::values.gpu_thread_affinity)) {
+        LOG_WARNING(HW_GPU, "Failed to pin the GPU thread to the host cores {:016X}",
+                    Settings::values.gpu_thread_affinity);
+    }
+    if (Settings::values.use_high_thread_priority &&
+        !Common::SetCurrentThreadPriority(Common::ThreadPriority::High)) {
+        LOG_WARNING(HW_GPU, "Failed to raise the priority of the GPU thread");
+    }
 
     // Wait for first GPU command before acquiring the window context
-    while (state.queue.Empty())
-        ;
+    state.queue.Wait();
 
     // If emulation was stopped during disk shader loading, abort before trying to acquire context
     if (!state.is_running) {
         return;
     }
 
-    Core::Frontend::ScopeAcquireWindowContext acquire_context{renderer.GetRenderWindow()};
+    auto& context = renderer.GetRenderContext();
+    context.MakeCurrent();
+    SCOPE_EXIT({ context.DoneCurrent(); });
 
-    CommandDataContainer next;
+    u64 fence{};
     while (state.is_running) {
-        while (!state.queue.Empty()) {
-            state.queue.Pop(next);
-            if (const auto submit_list = std::get_if<SubmitListCommand>(&next.data)) {
-                dma_pusher.Push(std::move(submit_list->entries));
-                dma_pusher.DispatchCalls();
-            } else if (const auto data = std::get_if<SwapBuffersCommand>(&next.data)) {
-                renderer.SwapBuffers(data->framebuffer ? &*data->framebuffer : nullptr);
-            } else if (const auto data = std::get_if<FlushRegionCommand>(&next.data)) {
-                renderer.Rasterizer().FlushRegion(data->addr, data->size);
-            } else if (const auto data = std::get_if<InvalidateRegionCommand>(&next.data)) {
-                renderer.Rasterizer().InvalidateRegion(data->addr, data->size);
-            } else if (std::holds_alternative<EndProcessingCommand>(next.data)) {
-                return;
-            } else {
-                UNREACHABLE();
-            }
-            state.signaled_fence.store(next.fence);
+        CommandData next = state.queue.PopWait();
+        if (const auto submit_list = std::get_if<SubmitListCommand>(&next)) {
+            dma_pusher.Push(std::move(submit_list->entries));
+            dma_pusher.DispatchCalls();
+        } else if (const auto data = std::get_if<SwapBuffersCommand>(&next)) {
+            renderer.SwapBuffers(data->framebuffer ? &*data->framebuffer : nullptr);
+        } else if (const auto data = std::get_if<FlushRegionCommand>(&next)) {
+            renderer.Rasterizer().FlushRegion(data->addr, data->size);
+        } else if (const auto data = std::get_if<InvalidateRegionCommand>(&next)) {
+            renderer.Rasterizer().InvalidateRegion(data->addr, data->size);
+        } else if (std::holds_alternative<EndProcessingCommand>(next)) {
+            return;
+        } else {
+            UNREACHABLE();
         }
+        state.SignalFence(++fence);
     }
 }
 
@@ -84,7 +94,14 @@ void ThreadManager::SwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
 }
 
 void ThreadManager::FlushRegion(CacheAddr addr, u64 size) {
-    PushCommand(FlushRegionCommand(addr, size));
+    // Most guest reads touch memory the GPU never wrote, don't get in the way of the GPU thread
+    if (!system.Renderer().Rasterizer().MustFlushRegion(addr, size)) {
+        return;
+    }
+    const u64 fence{PushCommand(FlushRegionCommand(addr, size))};
+    if (Settings::values.use_accurate_gpu_emulation) {
+        state.WaitForSynchronization(fence);
+    }
 }
 
 void ThreadManager::InvalidateRegion(CacheAddr addr, u64 size) {
@@ -97,15 +114,25 @@ void ThreadManager::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
 }
 
 u64 ThreadManager::PushCommand(CommandData&& command_data) {
-    const u64 fence{++state.last_fence};
-    state.queue.Push(CommandDataContainer(std::move(command_data), fence));
-    return fence;
+    return state.queue.Push(std::move(command_data)) + 1;
 }
 
 MICROPROFILE_DEFINE(GPU_wait, "GPU", "Wait for the GPU", MP_RGB(128, 128, 192));
 void SynchState::WaitForSynchronization(u64 fence) {
-    while (signaled_fence.load() < fence)
-        ;
+    if (signaled_fence.load() >= fence) {
+        return;
+    }
+    MICROPROFILE_SCOPE(GPU_wait);
+    std::unique_lock lock{signal_mutex};
+    signal_cv.wait(lock, [this, fence] { return signaled_fence.load() >= fence; });
+}
+
+void SynchState::SignalFence(u64 fence) {
+    {
+        std::lock_guard lock{signal_mutex};
+        signaled_fence.store(fence);
+    }
+    signal_cv.notify_all();
 }
 
 } // namespace VideoCommon::GPUThread
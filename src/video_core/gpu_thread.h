@@ -75,26 +75,22 @@ using CommandData =
     std::variant<EndProcessingCommand, SubmitListCommand, SwapBuffersCommand, FlushRegionCommand,
                  InvalidateRegionCommand, FlushAndInvalidateRegionCommand>;
 
-struct CommandDataContainer {
-    CommandDataContainer() = default;
-
-    CommandDataContainer(CommandData&& data, u64 next_fence)
-        : data{std::move(data)}, fence{next_fence} {}
-
-    CommandData data;
-    u64 fence{};
-};
-
 /// Struct used to synchronize the GPU thread
 struct SynchState final {
     std::atomic_bool is_running{true};
 
+    /// Blocks the calling thread until the GPU thread has processed the given fence.
     void WaitForSynchronization(u64 fence);
 
-    using CommandQueue = Common::SPSCQueue<CommandDataContainer>;
+    /// Marks a fence as processed and wakes up the threads waiting on it.
+    void SignalFence(u64 fence);
+
+    /// Any emulated core may push commands, the fence of a command is its position in the queue
+    using CommandQueue = Common::MPMCQueue<CommandData, 1024>;
     CommandQueue queue;
-    u64 last_fence{};
     std::atomic<u64> signaled_fence{};
+    std::mutex signal_mutex;
+    std::condition_variable signal_cv;
 };
 
 /// Class used to manage the GPU thread
@@ -0,0 +1,352 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "video_core/macro_compiler.h"
+#include "video_core/macro_engine_interface.h"
+
+MICROPROFILE_DEFINE(MacroCompiled, "GPU", "Execute translated macro", MP_RGB(128, 192, 128));
+
+namespace Tegra {
+
+namespace {
+/// Macros reaching further than this many instructions are left to the interpreter.
+constexpr u32 MaxProgramLength = 0x1000;
+} // Anonymous namespace
+
+MacroCompiler::MacroCompiler(MacroEngineInterface& engine) : engine(engine) {}
+
+MacroCompiler::~MacroCompiler() = default;
+
+bool MacroCompiler::Execute(u32 offset, std::size_t num_parameters, const u32* parameters) {
+    const auto [it, inserted] = programs.try_emplace(offset);
+    if (inserted) {
+        it->second = Compile(offset);
+        if (!it->second) {
+            LOG_DEBUG(HW_GPU, "Macro at offset {:#x} can't be translated, interpreting it",
+                      offset);
+        }
+    }
+    if (!it->second) {
+        return false;
+    }
+
+    MICROPROFILE_SCOPE(MacroCompiled);
+    Run(*it->second, num_parameters, parameters);
+    return true;
+}
+
+void MacroCompiler::Invalidate() {
+    programs.clear();
+}
+
+std::unique_ptr<MacroCompiler::Program> MacroCompiler::Compile(u32 offset) const {
+    using Macro::ALUOperation;
+    using Macro::BranchCondition;
+    using Macro::Operation;
+
+    const auto& macro_memory = engine.GetMacroMemory();
+    if (offset >= macro_memory.size()) {
+        return nullptr;
+    }
+    const u32 max_length =
+        std::min(MaxProgramLength, static_cast<u32>(macro_memory.size()) - offset);
+
+    auto program = std::make_unique<Program>();
+    auto& code = program->code;
+    std::vector<bool> visited;
+
+    // Decodes the instruction at the given index unless that was already done, fails on the
+    // encodings the interpreter doesn't implement either.
+    const auto decode = [&](u32 index) {
+        if (index >= max_length) {
+            return false;
+        }
+        if (index >= code.size()) {
+            code.resize(index + 1);
+            visited.resize(index + 1);
+        }
+        Instruction& inst = code[index];
+        if (inst.kind != Kind::Invalid) {
+            return true;
+        }
+
+        const Macro::Opcode opcode{macro_memory[offset + index]};
+        switch (opcode.operation) {
+        case Operation::ALU:
+            switch (opcode.alu_operation) {
+            case ALUOperation::Add:
+                inst.kind = Kind::Add;
+                break;
+            case ALUOperation::AddWithCarry:
+                inst.kind = Kind::AddWithCarry;
+                break;
+            case ALUOperation::Subtract:
+                inst.kind = Kind::Subtract;
+                break;
+            case ALUOperation::SubtractWithBorrow:
+                inst.kind = Kind::SubtractWithBorrow;
+                break;
+            case ALUOperation::Xor:
+                inst.kind = Kind::Xor;
+                break;
+            case ALUOperation::Or:
+                inst.kind = Kind::Or;
+                break;
+            case ALUOperation::And:
+                inst.kind = Kind::And;
+                break;
+            case ALUOperation::AndNot:
+                inst.kind = Kind::AndNot;
+                break;
+            case ALUOperation::Nand:
+                inst.kind = Kind::Nand;
+                break;
+            default:
+                return false;
+            }
+            break;
+        case Operation::AddImmediate:
+            inst.kind = Kind::AddImmediate;
+            break;
+        case Operation::ExtractInsert:
+            inst.kind = Kind::ExtractInsert;
+            break;
+        case Operation::ExtractShiftLeftImmediate:
+            inst.kind = Kind::ExtractShiftLeftImmediate;
+            break;
+        case Operation::ExtractShiftLeftRegister:
+            inst.kind = Kind::ExtractShiftLeftRegister;
+            break;
+        case Operation::Read:
+            inst.kind = Kind::Read;
+            break;
+        case Operation::Branch: {
+            const s64 target = static_cast<s64>(index) + opcode.immediate;
+            if (target < 0 || target >= max_length) {
+                return false;
+            }
+            inst.kind = opcode.branch_condition == BranchCondition::Zero ? Kind::BranchZero
+                                                                          : Kind::BranchNotZero;
+            inst.branch_target = static_cast<u32>(target);
+            break;
+        }
+        default:
+            return false;
+        }
+
+        inst.result_operation = opcode.result_operation;
+        inst.dst = static_cast<u8>(opcode.dst == 0 ? ScratchRegister : opcode.dst.Value());
+        inst.src_a = static_cast<u8>(opcode.src_a.Value());
+        inst.src_b = static_cast<u8>(opcode.src_b.Value());
+        inst.is_exit = opcode.is_exit != 0;
+        inst.branch_annul = opcode.branch_annul != 0;
+        inst.bf_src_bit = static_cast<u8>(opcode.bf_src_bit.Value());
+        inst.bf_dst_bit = static_cast<u8>(opcode.bf_dst_bit.Value());
+        inst.bf_mask = opcode.GetBitfieldMask();
+        inst.immediate = opcode.immediate;
+        return true;
+    };
+    const auto is_branch = [](const Instruction& inst) {
+        return inst.kind == Kind::BranchZero || inst.kind == Kind::BranchNotZero;
+    };
+
+    // Only follow the paths execution can take, macro memory after the exit of a macro usually
+    // holds the next macro or garbage.
+    std::vector<u32> pending{0};
+    while (!pending.empty()) {
+        const u32 index = pending.back();
+        pending.pop_back();
+        if (!decode(index)) {
+            return nullptr;
+        }
+        if (visited[index]) {
+            continue;
+        }
+        visited[index] = true;
+
+        const Instruction inst = code[index];
+        const bool has_delay_slot = inst.is_exit || (is_branch(inst) && !inst.branch_annul);
+        if (has_delay_slot) {
+            // Delay slots ignore their exit flag, and branches in them are invalid.
+            if (!decode(index + 1) || is_branch(code[index + 1])) {
+                return nullptr;
+            }
+        }
+        if (is_branch(inst)) {
+            pending.push_back(inst.branch_target);
+        }
+        if (!inst.is_exit) {
+            pending.push_back(index + 1);
+        }
+    }
+
+    return program;
+}
+
+void MacroCompiler::Run(const Program& program, std::size_t num_parameters,
+                        const u32* parameters) {
+    registers = {};
+    registers[1] = parameters[0];
+    method_address.raw = 0;
+    carry_flag = false;
+
+    this->parameters = parameters;
+    this->num_parameters = num_parameters;
+    // $r1 already holds the first parameter.
+    next_parameter_index = 1;
+
+    const Instruction* const code = program.code.data();
+    u32 pc = 0;
+    while (true) {
+        const Instruction& inst = code[pc];
+        if (inst.kind == Kind::BranchZero || inst.kind == Kind::BranchNotZero) {
+            const bool taken = (registers[inst.src_a] == 0) == (inst.kind == Kind::BranchZero);
+            if (taken) {
+                if (!inst.branch_annul) {
+                    ExecuteInstruction(code[pc + 1]);
+                }
+                pc = inst.branch_target;
+                continue;
+            }
+        } else {
+            ExecuteInstruction(inst);
+        }
+
+        if (inst.is_exit) {
+            // Exit has a delay slot, execute the next instruction
+            ExecuteInstruction(code[pc + 1]);
+            break;
+        }
+        ++pc;
+    }
+
+    // Assert that the macro used all the input parameters
+    ASSERT(next_parameter_index == num_parameters);
+    this->parameters = nullptr;
+}
+
+void MacroCompiler::ExecuteInstruction(const Instruction& inst) {
+    const u32 src_a = registers[inst.src_a];
+    const u32 src_b = registers[inst.src_b];
+
+    switch (inst.kind) {
+    case Kind::Add: {
+        const u64 result{static_cast<u64>(src_a) + src_b};
+        carry_flag = result > 0xffffffff;
+        ProcessResult(inst, static_cast<u32>(result));
+        break;
+    }
+    case Kind::AddWithCarry: {
+        const u64 result{static_cast<u64>(src_a) + src_b + (carry_flag ? 1ULL : 0ULL)};
+        carry_flag = result > 0xffffffff;
+        ProcessResult(inst, static_cast<u32>(result));
+        break;
+    }
+    case Kind::Subtract: {
+        const u64 result{static_cast<u64>(src_a) - src_b};
+        carry_flag = result < 0x100000000;
+        ProcessResult(inst, static_cast<u32>(result));
+        break;
+    }
+    case Kind::SubtractWithBorrow: {
+        const u64 result{static_cast<u64>(src_a) - src_b - (carry_flag ? 0ULL : 1ULL)};
+        carry_flag = result < 0x100000000;
+        ProcessResult(inst, static_cast<u32>(result));
+        break;
+    }
+    case Kind::Xor:
+        ProcessResult(inst, src_a ^ src_b);
+        break;
+    case Kind::Or:
+        ProcessResult(inst, src_a | src_b);
+        break;
+    case Kind::And:
+        ProcessResult(inst, src_a & src_b);
+        break;
+    case Kind::AndNot:
+        ProcessResult(inst, src_a & ~src_b);
+        break;
+    case Kind::Nand:
+        ProcessResult(inst, ~(src_a & src_b));
+        break;
+    case Kind::AddImmediate:
+        ProcessResult(inst, src_a + inst.immediate);
+        break;
+    case Kind::ExtractInsert: {
+        u32 dst = src_a;
+        dst &= ~(inst.bf_mask << inst.bf_dst_bit);
+        dst |= ((src_b >> inst.bf_src_bit) & inst.bf_mask) << inst.bf_dst_bit;
+        ProcessResult(inst, dst);
+        break;
+    }
+    case Kind::ExtractShiftLeftImmediate:
+        ProcessResult(inst, ((src_b >> src_a) & inst.bf_mask) << inst.bf_dst_bit);
+        break;
+    case Kind::ExtractShiftLeftRegister:
+        ProcessResult(inst, ((src_b >> inst.bf_src_bit) & inst.bf_mask) << src_a);
+        break;
+    case Kind::Read:
+        ProcessResult(inst, engine.ReadRegisterFromMacro(src_a + inst.immediate));
+        break;
+    default:
+        UNREACHABLE_MSG("Invalid translated macro instruction {}", static_cast<u32>(inst.kind));
+    }
+}
+
+void MacroCompiler::ProcessResult(const Instruction& inst, u32 result) {
+    using Macro::ResultOperation;
+
+    switch (inst.result_operation) {
+    case ResultOperation::IgnoreAndFetch:
+        registers[inst.dst] = FetchParameter();
+        break;
+    case ResultOperation::Move:
+        registers[inst.dst] = result;
+        break;
+    case ResultOperation::MoveAndSetMethod:
+        registers[inst.dst] = result;
+        method_address.raw = result;
+        break;
+    case ResultOperation::FetchAndSend:
+        registers[inst.dst] = FetchParameter();
+        Send(result);
+        break;
+    case ResultOperation::MoveAndSend:
+        registers[inst.dst] = result;
+        Send(result);
+        break;
+    case ResultOperation::FetchAndSetMethod:
+        registers[inst.dst] = FetchParameter();
+        method_address.raw = result;
+        break;
+    case ResultOperation::MoveAndSetMethodFetchAndSend:
+        registers[inst.dst] = result;
+        method_address.raw = result;
+        Send(FetchParameter());
+        break;
+    case ResultOperation::MoveAndSetMethodSend:
+        registers[inst.dst] = result;
+        method_address.raw = result;
+        Send((result >> 12) & 0b111111);
+        break;
+    }
+}
+
+u32 MacroCompiler::FetchParameter() {
+    ASSERT(next_parameter_index < num_parameters);
+    return parameters[next_parameter_index++];
+}
+
+void MacroCompiler::Send(u32 value) {
+    engine.CallMethodFromMacro(method_address.address, value);
+    method_address.address.Assign(method_address.address.Value() +
+                                  method_address.increment.Value());
+}
+
+} // namespace Tegra
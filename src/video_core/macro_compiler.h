@@ -0,0 +1,112 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/macro_opcode.h"
+
+namespace Tegra {
+
+class MacroEngineInterface;
+
+/**
+ * Executes macros from a pre-decoded form instead of decoding every instruction each time it
+ * runs. Each macro is translated once, the first time it is called after it was uploaded: the
+ * instructions reachable from its entry point are split into their fields, branch targets are
+ * resolved to instruction indices and writes to the zero register are redirected to a scratch
+ * register. Macros using encodings the interpreter doesn't handle are not translated, the caller
+ * runs those through the interpreter instead.
+ */
+class MacroCompiler final {
+public:
+    explicit MacroCompiler(MacroEngineInterface& engine);
+    ~MacroCompiler();
+
+    /**
+     * Executes the macro code with the specified input parameters, translating it if needed.
+     * @param offset Offset to start execution at.
+     * @param parameters The parameters of the macro.
+     * @returns false if the macro can't be translated and has to be interpreted instead.
+     */
+    bool Execute(u32 offset, std::size_t num_parameters, const u32* parameters);
+
+    /// Drops every translated macro, this has to be called whenever macro memory changes.
+    void Invalidate();
+
+private:
+    enum class Kind : u8 {
+        Invalid,
+        Add,
+        AddWithCarry,
+        Subtract,
+        SubtractWithBorrow,
+        Xor,
+        Or,
+        And,
+        AndNot,
+        Nand,
+        AddImmediate,
+        ExtractInsert,
+        ExtractShiftLeftImmediate,
+        ExtractShiftLeftRegister,
+        Read,
+        BranchZero,
+        BranchNotZero,
+    };
+
+    struct Instruction {
+        Kind kind = Kind::Invalid;
+        Macro::ResultOperation result_operation{};
+        u8 dst = 0;
+        u8 src_a = 0;
+        u8 src_b = 0;
+        bool is_exit = false;
+        bool branch_annul = false;
+        u8 bf_src_bit = 0;
+        u8 bf_dst_bit = 0;
+        u32 bf_mask = 0;
+        s32 immediate = 0;
+        u32 branch_target = 0; ///< Index of the instruction a taken branch continues at.
+    };
+
+    struct Program {
+        std::vector<Instruction> code;
+    };
+
+    /// Translates the macro starting at the given offset, returns null if that isn't possible.
+    std::unique_ptr<Program> Compile(u32 offset) const;
+
+    void Run(const Program& program, std::size_t num_parameters, const u32* parameters);
+
+    /// Executes any instruction but a branch.
+    void ExecuteInstruction(const Instruction& inst);
+
+    void ProcessResult(const Instruction& inst, u32 result);
+    u32 FetchParameter();
+    void Send(u32 value);
+
+    MacroEngineInterface& engine;
+
+    /// Translated macros by their offset in macro memory, null for macros that can't be.
+    std::unordered_map<u32, std::unique_ptr<Program>> programs;
+
+    /// Register 0 reads as zero, writes to it go to the extra scratch register instead.
+    static constexpr std::size_t ScratchRegister = 8;
+    std::array<u32, ScratchRegister + 1> registers{};
+
+    Macro::MethodAddress method_address{};
+    bool carry_flag = false;
+
+    const u32* parameters = nullptr;
+    std::size_t num_parameters = 0;
+    std::size_t next_parameter_index = 0;
+};
+
+} // namespace Tegra
@@ -0,0 +1,32 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+
+#include "common/common_types.h"
+
+namespace Tegra {
+
+/// Engine state that macros read and write, implemented by Maxwell3D.
+class MacroEngineInterface {
+public:
+    /// Memory for macro code - it's undetermined how big this is, however 1MB is much larger than
+    /// we've seen used.
+    using MacroMemory = std::array<u32, 0x40000>;
+
+    virtual ~MacroEngineInterface() = default;
+
+    /// Gets a reference to macro memory.
+    virtual const MacroMemory& GetMacroMemory() const = 0;
+
+    /// Calls an engine method on behalf of a macro.
+    virtual void CallMethodFromMacro(u32 method, u32 argument) = 0;
+
+    /// Reads an engine register on behalf of a macro.
+    virtual u32 ReadRegisterFromMacro(u32 method) const = 0;
+};
+
+} // namespace Tegra
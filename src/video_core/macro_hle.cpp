@@ -0,0 +1,117 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "common/logging/log.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/macro_hle.h"
+
+namespace Tegra {
+
+namespace {
+
+using Maxwell3D = Engines::Maxwell3D;
+
+/// Register the NVN driver keeps the instance count mask of the current draw in.
+constexpr u32 InstanceCountMaskRegister = 0xD1B;
+
+/// Submits the draw the replaced macro would have made through inline draw methods.
+void Draw(Maxwell3D& maxwell3d, Maxwell3D::MMEDrawMode mode, u32 count, u32 instance_count) {
+    if (instance_count == 0) {
+        // The macro loops once per instance, so nothing is drawn.
+        if (mode == Maxwell3D::MMEDrawMode::Indexed) {
+            maxwell3d.regs.index_array.count = 0;
+        } else {
+            maxwell3d.regs.vertex_buffer.count = 0;
+        }
+        return;
+    }
+
+    auto& mme_draw = maxwell3d.mme_draw;
+    mme_draw.current_mode = mode;
+    mme_draw.current_count = count;
+    mme_draw.instance_count = instance_count;
+    mme_draw.instance_mode = instance_count > 1;
+    mme_draw.gl_begin_consume = false;
+    mme_draw.gl_end_count = instance_count;
+    maxwell3d.FlushMMEInlineDraw();
+}
+
+/// Instanced indexed draw: topology, count, instance count, base vertex, first and base instance.
+void DrawIndexedInstanced(Maxwell3D& maxwell3d, const u32* parameters) {
+    const u32 instance_count =
+        parameters[2] & maxwell3d.GetRegisterValue(InstanceCountMaskRegister);
+
+    auto& regs = maxwell3d.regs;
+    regs.draw.topology.Assign(static_cast<Maxwell3D::Regs::PrimitiveTopology>(parameters[0]));
+    regs.index_array.count = parameters[1];
+    regs.vb_element_base = parameters[3];
+    regs.index_array.first = parameters[4];
+    regs.vb_base_instance = parameters[5];
+    Draw(maxwell3d, Maxwell3D::MMEDrawMode::Indexed, parameters[1], instance_count);
+}
+
+/// Instanced array draw: topology, count, instance count, first vertex and base instance.
+void DrawArraysInstanced(Maxwell3D& maxwell3d, const u32* parameters) {
+    const u32 instance_count =
+        parameters[2] & maxwell3d.GetRegisterValue(InstanceCountMaskRegister);
+
+    auto& regs = maxwell3d.regs;
+    regs.draw.topology.Assign(static_cast<Maxwell3D::Regs::PrimitiveTopology>(parameters[0]));
+    regs.vertex_buffer.count = parameters[1];
+    regs.vertex_buffer.first = parameters[3];
+    regs.vb_base_instance = parameters[4];
+    Draw(maxwell3d, Maxwell3D::MMEDrawMode::Array, parameters[1], instance_count);
+}
+
+struct Replacement {
+    u64 hash;
+    std::size_t num_parameters;
+    void (*function)(Maxwell3D& maxwell3d, const u32* parameters);
+};
+
+constexpr std::array<Replacement, 2> replacements{{
+    {0x771BB18C62444DA0, 6, &DrawIndexedInstanced},
+    {0x0D61FC9FAAC9FCAD, 5, &DrawArraysInstanced},
+}};
+
+} // Anonymous namespace
+
+MacroHLE::MacroHLE(Engines::Maxwell3D& maxwell3d) : maxwell3d(maxwell3d) {}
+
+MacroHLE::~MacroHLE() = default;
+
+bool MacroHLE::Execute(u64 hash, std::size_t num_parameters, const u32* parameters) {
+    Statistics& entry = statistics[hash];
+    ++entry.calls;
+
+    const auto it = std::find_if(replacements.begin(), replacements.end(),
+                                 [hash](const Replacement& replacement) {
+                                     return replacement.hash == hash;
+                                 });
+    if (it == replacements.end() || num_parameters != it->num_parameters) {
+        return false;
+    }
+
+    entry.replaced = true;
+    it->function(maxwell3d, parameters);
+    return true;
+}
+
+void MacroHLE::LogStatistics() const {
+    std::vector<std::pair<u64, Statistics>> sorted(statistics.begin(), statistics.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second.calls > rhs.second.calls;
+    });
+    for (const auto& [hash, entry] : sorted) {
+        LOG_INFO(HW_GPU, "Macro {:016X}: {} calls, {}", hash, entry.calls,
+                 entry.replaced ? "replaced" : "executed from code");
+    }
+}
+
+} // namespace Tegra
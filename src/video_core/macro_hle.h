@@ -0,0 +1,48 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "common/common_types.h"
+
+namespace Tegra {
+
+namespace Engines {
+class Maxwell3D;
+}
+
+/**
+ * Registry of native implementations for macro programs that show up in most titles, such as the
+ * instanced draw helpers of the NVN driver. Macros are recognized by the hash of their uploaded
+ * code. Every call is counted per hash, including the ones of unrecognized macros, which helps
+ * finding the next candidates for a replacement.
+ */
+class MacroHLE final {
+public:
+    explicit MacroHLE(Engines::Maxwell3D& maxwell3d);
+    ~MacroHLE();
+
+    /**
+     * Runs the native implementation of the macro with the given code hash.
+     * @returns false if there is none, the macro has to be executed from its code then.
+     */
+    bool Execute(u64 hash, std::size_t num_parameters, const u32* parameters);
+
+    /// Logs how many times each macro was called and whether it was replaced.
+    void LogStatistics() const;
+
+private:
+    struct Statistics {
+        u64 calls = 0;
+        bool replaced = false;
+    };
+
+    Engines::Maxwell3D& maxwell3d;
+    std::unordered_map<u64, Statistics> statistics;
+};
+
+} // namespace Tegra
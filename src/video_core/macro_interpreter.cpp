@@ -2,17 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
-#include "video_core/engines/maxwell_3d.h"
+#include "video_core/macro_engine_interface.h"
 #include "video_core/macro_interpreter.h"
 
 MICROPROFILE_DEFINE(MacroInterp, "GPU", "Execute macro interpreter", MP_RGB(128, 128, 192));
 
 namespace Tegra {
 
-MacroInterpreter::MacroInterpreter(Engines::Maxwell3D& maxwell3d) : maxwell3d(maxwell3d) {}
+MacroInterpreter::MacroInterpreter(MacroEngineInterface& engine) : engine(engine) {}
 
 void MacroInterpreter::Execute(u32 offset, std::size_t num_parameters, const u32* parameters) {
     MICROPROFILE_SCOPE(MacroInterp);
@@ -141,7 +143,7 @@ bool MacroInterpreter::Step(u32 offset, bool is_delay_slot) {
 }
 
 MacroInterpreter::Opcode MacroInterpreter::GetOpcode(u32 offset) const {
-    const auto& macro_memory{maxwell3d.GetMacroMemory()};
+    const auto& macro_memory{engine.GetMacroMemory()};
     ASSERT((pc % sizeof(u32)) == 0);
     ASSERT((pc + offset) < macro_memory.size() * sizeof(u32));
     return {macro_memory[offset + pc / sizeof(u32)]};
@@ -257,14 +259,14 @@ void MacroInterpreter::SetMethodAddress(u32 address) {
 }
 
 void MacroInterpreter::Send(u32 value) {
-    maxwell3d.CallMethodFromMME({method_address.address, value});
+    engine.CallMethodFromMacro(method_address.address, value);
     // Increment the method address by the method increment.
     method_address.address.Assign(method_address.address.Value() +
                                   method_address.increment.Value());
 }
 
 u32 MacroInterpreter::Read(u32 method) const {
-    return maxwell3d.GetRegisterValue(method);
+    return engine.ReadRegisterFromMacro(method);
 }
 
 bool MacroInterpreter::EvaluateBranchCondition(BranchCondition cond, u32 value) const {
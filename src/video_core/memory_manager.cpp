@@ -16,11 +16,6 @@ namespace Tegra {
 
 MemoryManager::MemoryManager(Core::System& system, VideoCore::RasterizerInterface& rasterizer)
     : rasterizer{rasterizer}, system{system} {
-    std::fill(page_table.pointers.begin(), page_table.pointers.end(), nullptr);
-    std::fill(page_table.attributes.begin(), page_table.attributes.end(),
-              Common::PageType::Unmapped);
-    page_table.Resize(address_space_width);
-
     // Initialize the map with a single free region covering the entire managed space.
     VirtualMemoryArea initial_vma;
     initial_vma.size = address_space_end;
@@ -115,7 +110,25 @@ GPUVAddr MemoryManager::FindFreeRegion(GPUVAddr region_start, u64 size) const {
 }
 
 bool MemoryManager::IsAddressValid(GPUVAddr addr) const {
-    return (addr >> page_bits) < page_table.pointers.size();
+    return (addr >> page_bits) < page_table.num_pages;
+}
+
+std::size_t MemoryManager::GetContiguousSize(GPUVAddr addr, std::size_t max_size) const {
+    std::size_t page_index{addr >> page_bits};
+    std::size_t size{std::min(static_cast<std::size_t>(page_size - (addr & page_mask)), max_size)};
+
+    const u8* page_pointer{page_table.GetPointer(page_index)};
+    if (page_pointer == nullptr) {
+        return size;
+    }
+
+    while (size < max_size && page_index + 1 < page_table.num_pages &&
+           page_table.GetPointer(page_index + 1) == page_pointer + page_size) {
+        page_pointer += page_size;
+        ++page_index;
+        size += std::min(static_cast<std::size_t>(page_size), max_size - size);
+    }
+    return size;
 }
 
 std::optional<VAddr> MemoryManager::GpuToCpuAddress(GPUVAddr addr) const {
@@ -123,7 +136,7 @@ std::optional<VAddr> MemoryManager::GpuToCpuAddress(GPUVAddr addr) const {
         return {};
     }
 
-    const VAddr cpu_addr{page_table.backing_addr[addr >> page_bits]};
+    const VAddr cpu_addr{page_table.GetBackingAddr(addr >> page_bits)};
     if (cpu_addr) {
         return cpu_addr + (addr & page_mask);
     }
@@ -137,7 +150,7 @@ T MemoryManager::Read(GPUVAddr addr) const {
         return {};
     }
 
-    const u8* page_pointer{page_table.pointers[addr >> page_bits]};
+    const u8* page_pointer{page_table.GetPointer(addr >> page_bits)};
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         T value;
@@ -145,7 +158,7 @@ T MemoryManager::Read(GPUVAddr addr) const {
         return value;
     }
 
-    switch (page_table.attributes[addr >> page_bits]) {
+    switch (page_table.GetAttribute(addr >> page_bits)) {
     case Common::PageType::Unmapped:
         LOG_ERROR(HW_GPU, "Unmapped Read{} @ 0x{:08X}", sizeof(T) * 8, addr);
         return 0;
@@ -164,14 +177,14 @@ void MemoryManager::Write(GPUVAddr addr, T data) {
         return;
     }
 
-    u8* page_pointer{page_table.pointers[addr >> page_bits]};
+    u8* page_pointer{page_table.GetPointer(addr >> page_bits)};
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         std::memcpy(&page_pointer[addr & page_mask], &data, sizeof(T));
         return;
     }
 
-    switch (page_table.attributes[addr >> page_bits]) {
+    switch (page_table.GetAttribute(addr >> page_bits)) {
     case Common::PageType::Unmapped:
         LOG_ERROR(HW_GPU, "Unmapped Write{} 0x{:08X} @ 0x{:016X}", sizeof(data) * 8,
                   static_cast<u32>(data), addr);
@@ -198,7 +211,7 @@ u8* MemoryManager::GetPointer(GPUVAddr addr) {
         return {};
     }
 
-    u8* const page_pointer{page_table.pointers[addr >> page_bits]};
+    u8* const page_pointer{page_table.GetPointer(addr >> page_bits)};
     if (page_pointer != nullptr) {
         return page_pointer + (addr & page_mask);
     }
@@ -212,7 +225,7 @@ const u8* MemoryManager::GetPointer(GPUVAddr addr) const {
         return {};
     }
 
-    const u8* const page_pointer{page_table.pointers[addr >> page_bits]};
+    const u8* const page_pointer{page_table.GetPointer(addr >> page_bits)};
     if (page_pointer != nullptr) {
         return page_pointer + (addr & page_mask);
     }
@@ -232,16 +245,14 @@ bool MemoryManager::IsBlockContinuous(const GPUVAddr start, const std::size_t si
 
 void MemoryManager::ReadBlock(GPUVAddr src_addr, void* dest_buffer, const std::size_t size) const {
     std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> page_bits};
-    std::size_t page_offset{src_addr & page_mask};
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
+        const std::size_t page_index{src_addr >> page_bits};
+        const std::size_t copy_amount{GetContiguousSize(src_addr, remaining_size)};
 
-        switch (page_table.attributes[page_index]) {
+        switch (page_table.GetAttribute(page_index)) {
         case Common::PageType::Memory: {
-            const u8* src_ptr{page_table.pointers[page_index] + page_offset};
+            const u8* src_ptr{page_table.GetPointer(page_index) + (src_addr & page_mask)};
             rasterizer.FlushRegion(ToCacheAddr(src_ptr), copy_amount);
             std::memcpy(dest_buffer, src_ptr, copy_amount);
             break;
@@ -250,8 +261,7 @@ void MemoryManager::ReadBlock(GPUVAddr src_addr, void* dest_buffer, const std::s
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
+        src_addr += copy_amount;
         dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
         remaining_size -= copy_amount;
     }
@@ -266,7 +276,7 @@ void MemoryManager::ReadBlockUnsafe(GPUVAddr src_addr, void* dest_buffer,
     while (remaining_size > 0) {
         const std::size_t copy_amount{
             std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
-        const u8* page_pointer = page_table.pointers[page_index];
+        const u8* page_pointer = page_table.GetPointer(page_index);
         if (page_pointer) {
             const u8* src_ptr{page_pointer + page_offset};
             std::memcpy(dest_buffer, src_ptr, copy_amount);
@@ -282,16 +292,14 @@ void MemoryManager::ReadBlockUnsafe(GPUVAddr src_addr, void* dest_buffer,
 
 void MemoryManager::WriteBlock(GPUVAddr dest_addr, const void* src_buffer, const std::size_t size) {
     std::size_t remaining_size{size};
-    std::size_t page_index{dest_addr >> page_bits};
-    std::size_t page_offset{dest_addr & page_mask};
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
+        const std::size_t page_index{dest_addr >> page_bits};
+        const std::size_t copy_amount{GetContiguousSize(dest_addr, remaining_size)};
 
-        switch (page_table.attributes[page_index]) {
+        switch (page_table.GetAttribute(page_index)) {
         case Common::PageType::Memory: {
-            u8* dest_ptr{page_table.pointers[page_index] + page_offset};
+            u8* dest_ptr{page_table.GetPointer(page_index) + (dest_addr & page_mask)};
             rasterizer.InvalidateRegion(ToCacheAddr(dest_ptr), copy_amount);
             std::memcpy(dest_ptr, src_buffer, copy_amount);
             break;
@@ -300,8 +308,7 @@ void MemoryManager::WriteBlock(GPUVAddr dest_addr, const void* src_buffer, const
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
+        dest_addr += copy_amount;
         src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
         remaining_size -= copy_amount;
     }
@@ -316,7 +323,7 @@ void MemoryManager::WriteBlockUnsafe(GPUVAddr dest_addr, const void* src_buffer,
     while (remaining_size > 0) {
         const std::size_t copy_amount{
             std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
-        u8* page_pointer = page_table.pointers[page_index];
+        u8* page_pointer = page_table.GetPointer(page_index);
         if (page_pointer) {
             u8* dest_ptr{page_pointer + page_offset};
             std::memcpy(dest_ptr, src_buffer, copy_amount);
@@ -330,16 +337,14 @@ void MemoryManager::WriteBlockUnsafe(GPUVAddr dest_addr, const void* src_buffer,
 
 void MemoryManager::CopyBlock(GPUVAddr dest_addr, GPUVAddr src_addr, const std::size_t size) {
     std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> page_bits};
-    std::size_t page_offset{src_addr & page_mask};
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
+        const std::size_t page_index{src_addr >> page_bits};
+        const std::size_t copy_amount{GetContiguousSize(src_addr, remaining_size)};
 
-        switch (page_table.attributes[page_index]) {
+        switch (page_table.GetAttribute(page_index)) {
         case Common::PageType::Memory: {
-            const u8* src_ptr{page_table.pointers[page_index] + page_offset};
+            const u8* src_ptr{page_table.GetPointer(page_index) + (src_addr & page_mask)};
             rasterizer.FlushRegion(ToCacheAddr(src_ptr), copy_amount);
             WriteBlock(dest_addr, src_ptr, copy_amount);
             break;
@@ -348,10 +353,8 @@ void MemoryManager::CopyBlock(GPUVAddr dest_addr, GPUVAddr src_addr, const std::
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
+        dest_addr += copy_amount;
+        src_addr += copy_amount;
         remaining_size -= copy_amount;
     }
 }
@@ -367,26 +370,9 @@ void MemoryManager::MapPages(GPUVAddr base, u64 size, u8* memory, Common::PageTy
     LOG_DEBUG(HW_GPU, "Mapping {} onto {:016X}-{:016X}", fmt::ptr(memory), base * page_size,
               (base + size) * page_size);
 
-    const VAddr end{base + size};
-    ASSERT_MSG(end <= page_table.pointers.size(), "out of range mapping at {:016X}",
-               base + page_table.pointers.size());
-
-    std::fill(page_table.attributes.begin() + base, page_table.attributes.begin() + end, type);
-
-    if (memory == nullptr) {
-        std::fill(page_table.pointers.begin() + base, page_table.pointers.begin() + end, memory);
-        std::fill(page_table.backing_addr.begin() + base, page_table.backing_addr.begin() + end,
-                  backing_addr);
-    } else {
-        while (base != end) {
-            page_table.pointers[base] = memory;
-            page_table.backing_addr[base] = backing_addr;
-
-            base += 1;
-            memory += page_size;
-            backing_addr += page_size;
-        }
-    }
+    ASSERT_MSG(base + size <= page_table.num_pages, "out of range mapping at {:016X}",
+               base * page_size);
+    page_table.Map(base, size, memory, type, backing_addr);
 }
 
 void MemoryManager::MapMemoryRegion(GPUVAddr base, u64 size, u8* target, VAddr backing_addr) {
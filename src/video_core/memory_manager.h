@@ -9,6 +9,7 @@
 
 #include "common/common_types.h"
 #include "common/page_table.h"
+#include "video_core/gpu_page_directory.h"
 
 namespace VideoCore {
 class RasterizerInterface;
@@ -103,6 +104,12 @@ private:
     using VMAIter = VMAMap::iterator;
 
     bool IsAddressValid(GPUVAddr addr) const;
+
+    /**
+     * Returns how many bytes, up to max_size, starting at the given address are backed by
+     * contiguous host memory. Always covers at least the remainder of the first page.
+     */
+    std::size_t GetContiguousSize(GPUVAddr addr, std::size_t max_size) const;
     void MapPages(GPUVAddr base, u64 size, u8* memory, Common::PageType type,
                   VAddr backing_addr = 0);
     void MapMemoryRegion(GPUVAddr base, u64 size, u8* target, VAddr backing_addr);
@@ -174,7 +181,8 @@ private:
     /// End of address space, based on address space in bits.
     static constexpr GPUVAddr address_space_end{1ULL << address_space_width};
 
-    Common::PageTable page_table{page_bits};
+    /// Translates addresses on lookups, the VMA map is only used to change the mappings.
+    PageDirectory<page_bits, address_space_width> page_table;
     VMAMap vma_map;
     VideoCore::RasterizerInterface& rasterizer;
 
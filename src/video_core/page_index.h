@@ -0,0 +1,87 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/gpu.h"
+
+namespace VideoCommon {
+
+/**
+ * Index of objects covering ranges of host memory, bucketed by page. Each object is listed in
+ * every page it touches. Buckets keep their storage once created, so registering and looking up
+ * objects in pages that have been used before doesn't allocate.
+ */
+template <typename T, u32 PageBits>
+class PageIndex {
+public:
+    /// Adds an object covering [start, end).
+    void Insert(CacheAddr start, CacheAddr end, const T& object) {
+        const u64 last_page = (end - 1) >> PageBits;
+        for (u64 page = start >> PageBits; page <= last_page; ++page) {
+            buckets[page].push_back({start, end, object});
+        }
+    }
+
+    /// Removes an object, the range must be the same one it was inserted with.
+    void Remove(CacheAddr start, CacheAddr end, const T& object) {
+        const u64 last_page = (end - 1) >> PageBits;
+        for (u64 page = start >> PageBits; page <= last_page; ++page) {
+            const auto bucket = buckets.find(page);
+            if (bucket == buckets.end()) {
+                continue;
+            }
+            auto& entries = bucket->second;
+            const auto it =
+                std::find_if(entries.begin(), entries.end(),
+                             [&object](const Entry& entry) { return entry.object == object; });
+            if (it != entries.end()) {
+                entries.erase(it);
+            }
+        }
+    }
+
+    /// Calls func once for every object overlapping [start, end), sorted by page and by insertion
+    /// order within a page.
+    template <typename Func>
+    void ForEachInRange(CacheAddr start, CacheAddr end, Func&& func) const {
+        if (start >= end) {
+            return;
+        }
+        const u64 first_page = start >> PageBits;
+        const u64 last_page = (end - 1) >> PageBits;
+        for (u64 page = first_page; page <= last_page; ++page) {
+            const auto it = buckets.find(page);
+            if (it == buckets.end()) {
+                continue;
+            }
+            for (const Entry& entry : it->second) {
+                // Objects spanning several pages are only reported from the first page they
+                // share with the range.
+                if (page != first_page && (entry.start >> PageBits) != page) {
+                    continue;
+                }
+                if (entry.start < end && entry.end > start) {
+                    func(entry.object);
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        CacheAddr start;
+        CacheAddr end;
+        T object;
+    };
+
+    std::unordered_map<u64, std::vector<Entry>> buckets;
+};
+
+} // namespace VideoCommon
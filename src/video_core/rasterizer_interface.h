@@ -5,7 +5,10 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <functional>
+#include <optional>
 #include "common/common_types.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/gpu.h"
@@ -16,6 +19,12 @@ class MemoryManager;
 
 namespace VideoCore {
 
+/// Counters of the host GPU that guest queries can read.
+enum class QueryType {
+    SamplesPassed,
+};
+constexpr std::size_t NumQueryTypes = 1;
+
 enum class LoadCallbackStage {
     Prepare,
     Decompile,
@@ -24,6 +33,14 @@ enum class LoadCallbackStage {
 };
 using DiskResourceLoadCallback = std::function<void(LoadCallbackStage, std::size_t, std::size_t)>;
 
+/// Cache counters accumulated over an emulation session, reported in its telemetry.
+struct RasterizerStatistics {
+    u64 shader_builds{};                          ///< Host shader programs built
+    std::chrono::nanoseconds shader_build_time{}; ///< Host time spent building them
+    u64 surface_lookups{};                        ///< Texture cache lookups
+    u64 surface_misses{};                         ///< Lookups that had to create a new surface
+};
+
 class RasterizerInterface {
 public:
     virtual ~RasterizerInterface() {}
@@ -46,6 +63,11 @@ public:
     /// Notify rasterizer that any caches of the specified region should be flushed to Switch memory
     virtual void FlushRegion(CacheAddr addr, u64 size) = 0;
 
+    /// Returns true when the host holds data of the specified region that guest memory lacks
+    virtual bool MustFlushRegion(CacheAddr addr, u64 size) {
+        return true;
+    }
+
     /// Notify rasterizer that any caches of the specified region should be invalidated
     virtual void InvalidateRegion(CacheAddr addr, u64 size) = 0;
 
@@ -56,6 +78,17 @@ public:
     /// Notify the rasterizer to send all written commands to the host GPU.
     virtual void FlushCommands() = 0;
 
+    /// Writes data to GPU memory once the host GPU has executed the commands recorded before it.
+    /// Flushing the region makes the write visible immediately.
+    virtual void SignalSemaphore(GPUVAddr addr, const void* data, std::size_t size) = 0;
+
+    /// Sets a counter back to zero.
+    virtual void ResetCounter(QueryType type) = 0;
+
+    /// Writes the value of a counter to GPU memory once the host GPU has computed it, followed by
+    /// a timestamp when one is given. Flushing the region makes the write visible immediately.
+    virtual void Query(GPUVAddr gpu_addr, QueryType type, std::optional<u64> timestamp) = 0;
+
     /// Notify rasterizer that a frame is about to finish
     virtual void TickFrame() = 0;
 
@@ -66,6 +99,18 @@ public:
         return false;
     }
 
+    /// Attempt to copy a linear block of GPU memory on the host GPU
+    virtual bool AccelerateDMACopy(GPUVAddr dest, GPUVAddr source, std::size_t size) {
+        return false;
+    }
+
+    /// Attempt to write inline data uploaded by the engines directly to the host GPU resource
+    /// holding the destination, instead of writing it to guest memory
+    virtual bool AccelerateInlineToMemory(GPUVAddr address, std::size_t copy_size,
+                                          const u8* data) {
+        return false;
+    }
+
     /// Attempt to use a faster method to display the framebuffer to screen
     virtual bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
                                    u32 pixel_stride) {
@@ -75,8 +120,17 @@ public:
     /// Increase/decrease the number of object in pages touching the specified region
     virtual void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {}
 
+    /// Starts reading the disk cached resources of the given title in the background, so it
+    /// overlaps with loading the game. LoadDiskResources picks up what was read.
+    virtual void PrefetchDiskResources(u64 title_id) {}
+
     /// Initialize disk cached resources for the game being emulated
     virtual void LoadDiskResources(const std::atomic_bool& stop_loading = false,
                                    const DiskResourceLoadCallback& callback = {}) {}
+
+    /// Gets the cache counters of the session, safe to call from any thread
+    virtual RasterizerStatistics GetStatistics() const {
+        return {};
+    }
 };
 } // namespace VideoCore
@@ -40,4 +40,18 @@ void RendererBase::RequestScreenshot(void* data, std::function<void()> callback,
     renderer_settings.screenshot_requested = true;
 }
 
+void RendererBase::StartFrameCapture(FrameCaptureCallback callback,
+                                     const Layout::FramebufferLayout& layout) {
+    std::lock_guard lock{renderer_settings.frame_capture_mutex};
+    renderer_settings.frame_capture_callback = std::move(callback);
+    renderer_settings.frame_capture_layout = layout;
+    renderer_settings.frame_capture_enabled = true;
+}
+
+void RendererBase::StopFrameCapture() {
+    std::lock_guard lock{renderer_settings.frame_capture_mutex};
+    renderer_settings.frame_capture_enabled = false;
+    renderer_settings.frame_capture_callback = nullptr;
+}
+
 } // namespace VideoCore
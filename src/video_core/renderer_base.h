@@ -5,7 +5,9 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 
 #include "common/common_types.h"
@@ -19,6 +21,10 @@ class EmuWindow;
 
 namespace VideoCore {
 
+/// Receives a captured frame as BGRA8 rows, bottom to top. The pixels are only valid during the
+/// call, which happens on the GPU thread: copy them out and encode elsewhere.
+using FrameCaptureCallback = std::function<void(const u8* pixels, u32 width, u32 height)>;
+
 struct RendererSettings {
     std::atomic_bool use_framelimiter{false};
     std::atomic_bool set_background_color{false};
@@ -28,6 +34,12 @@ struct RendererSettings {
     void* screenshot_bits;
     std::function<void()> screenshot_complete_callback;
     Layout::FramebufferLayout screenshot_framebuffer_layout;
+
+    // Continuous frame capture
+    std::atomic_bool frame_capture_enabled{false};
+    std::mutex frame_capture_mutex; ///< Guards the callback and layout, set from other threads
+    FrameCaptureCallback frame_capture_callback;
+    Layout::FramebufferLayout frame_capture_layout;
 };
 
 class RendererBase : NonCopyable {
@@ -71,6 +83,11 @@ public:
         return render_window;
     }
 
+    /// Returns the context the GPU thread renders with
+    virtual Core::Frontend::GraphicsContext& GetRenderContext() {
+        return render_window;
+    }
+
     RendererSettings& Settings() {
         return renderer_settings;
     }
@@ -86,6 +103,12 @@ public:
     void RequestScreenshot(void* data, std::function<void()> callback,
                            const Layout::FramebufferLayout& layout);
 
+    /// Start handing every presented frame, drawn with the given layout, to the callback
+    void StartFrameCapture(FrameCaptureCallback callback, const Layout::FramebufferLayout& layout);
+
+    /// Stop the frame capture, no frame is handed to the callback anymore once this returns
+    void StopFrameCapture();
+
 protected:
     Core::Frontend::EmuWindow& render_window; ///< Reference to the render window handle.
     std::unique_ptr<RasterizerInterface> rasterizer;
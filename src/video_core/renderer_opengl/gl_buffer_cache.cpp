@@ -2,14 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 #include <glad/glad.h>
 
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/microprofile.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_opengl/gl_buffer_cache.h"
+#include "video_core/renderer_opengl/gl_device.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 
@@ -17,23 +21,109 @@ namespace OpenGL {
 
 MICROPROFILE_DEFINE(OpenGL_Buffer_Download, "OpenGL", "Buffer Download", MP_RGB(192, 192, 128));
 
-CachedBufferBlock::CachedBufferBlock(CacheAddr cache_addr, const std::size_t size)
-    : VideoCommon::BufferBlock{cache_addr, size} {
-    gl_buffer.Create();
-    glNamedBufferData(gl_buffer.handle, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+struct BufferArenaPool::Arena {
+    explicit Arena(std::size_t size) : allocator{size} {}
+
+    OGLBuffer buffer;
+    u8* pointer = nullptr;
+    Common::TLSFAllocator allocator;
+};
+
+BufferArenaPool::BufferArenaPool(std::size_t alignment) : alignment{alignment} {}
+
+BufferArenaPool::~BufferArenaPool() {
+    for (auto& arena : arenas) {
+        glUnmapNamedBuffer(arena->buffer.handle);
+    }
+}
+
+BufferArenaPool::Allocation BufferArenaPool::Allocate(std::size_t size) {
+    for (auto& arena : arenas) {
+        if (const auto allocation = arena->allocator.Allocate(size, alignment)) {
+            return {arena.get(), arena->buffer.handle, allocation->offset,
+                    arena->pointer + allocation->offset, allocation->handle};
+        }
+    }
+    Arena& arena = CreateArena(std::max(size, ArenaSize));
+    const auto allocation = arena.allocator.Allocate(size, alignment);
+    ASSERT(allocation);
+    return {&arena, arena.buffer.handle, allocation->offset, arena.pointer + allocation->offset,
+            allocation->handle};
 }
 
-CachedBufferBlock::~CachedBufferBlock() = default;
+void BufferArenaPool::Free(const Allocation& allocation) {
+    unfenced_frees.push_back({allocation.arena, allocation.allocation_handle});
+}
+
+void BufferArenaPool::TickFrame() {
+    while (!fenced_frees.empty()) {
+        FencedFrees& batch = fenced_frees.front();
+        if (glClientWaitSync(batch.fence.handle, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        for (const PendingFree& pending : batch.frees) {
+            pending.arena->allocator.Free(pending.allocation_handle);
+            if (pending.arena->allocator.Empty() &&
+                pending.arena->allocator.GetSize() > ArenaSize) {
+                // Dedicated arenas are unlikely to fit anything else as well, give the memory back
+                ReleaseArena(*pending.arena);
+            }
+        }
+        fenced_frees.pop_front();
+    }
+    if (unfenced_frees.empty()) {
+        return;
+    }
+    FencedFrees& batch = fenced_frees.emplace_back();
+    batch.fence.Create();
+    batch.frees = std::move(unfenced_frees);
+    unfenced_frees.clear();
+}
+
+BufferArenaPool::Arena& BufferArenaPool::CreateArena(std::size_t size) {
+    auto& arena = arenas.emplace_back(std::make_unique<Arena>(size));
+    // Uploads to ranges the GPU may be reading still go through glNamedBufferSubData,
+    // hence the dynamic storage bit.
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    arena->buffer.Create();
+    glNamedBufferStorage(arena->buffer.handle, static_cast<GLsizeiptr>(arena->allocator.GetSize()),
+                         nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+    arena->pointer = static_cast<u8*>(glMapNamedBufferRange(
+        arena->buffer.handle, 0, static_cast<GLsizeiptr>(arena->allocator.GetSize()), flags));
+    return *arena;
+}
+
+void BufferArenaPool::ReleaseArena(Arena& arena) {
+    glUnmapNamedBuffer(arena.buffer.handle);
+    arenas.erase(std::find_if(arenas.begin(), arenas.end(),
+                              [&arena](const auto& entry) { return entry.get() == &arena; }));
+}
+
+CachedBufferBlock::CachedBufferBlock(CacheAddr cache_addr, const std::size_t size,
+                                     std::shared_ptr<BufferArenaPool> pool_)
+    : VideoCommon::BufferBlock{cache_addr, size}, pool{std::move(pool_)},
+      allocation{pool->Allocate(size)} {}
+
+CachedBufferBlock::~CachedBufferBlock() {
+    pool->Free(allocation);
+}
 
 OGLBufferCache::OGLBufferCache(RasterizerOpenGL& rasterizer, Core::System& system,
-                               std::size_t stream_size)
+                               const Device& device, std::size_t stream_size)
     : VideoCommon::BufferCache<Buffer, GLuint, OGLStreamBuffer>{
-          rasterizer, system, std::make_unique<OGLStreamBuffer>(stream_size, true)} {}
+          rasterizer, system, std::make_unique<OGLStreamBuffer>(stream_size, true)},
+      arena_pool{std::make_shared<BufferArenaPool>(std::max(
+          device.GetUniformBufferAlignment(), device.GetShaderStorageBufferAlignment()))} {}
 
 OGLBufferCache::~OGLBufferCache() = default;
 
+void OGLBufferCache::TickFrame() {
+    BufferCache::TickFrame();
+    arena_pool->TickFrame();
+}
+
 Buffer OGLBufferCache::CreateBlock(CacheAddr cache_addr, std::size_t size) {
-    return std::make_shared<CachedBufferBlock>(cache_addr, size);
+    return std::make_shared<CachedBufferBlock>(cache_addr, size, arena_pool);
 }
 
 void OGLBufferCache::WriteBarrier() {
@@ -41,9 +131,14 @@ void OGLBufferCache::WriteBarrier() {
 }
 
 const GLuint* OGLBufferCache::ToHandle(const Buffer& buffer) {
+    buffer->MarkAsUsedByGPU();
     return buffer->GetHandle();
 }
 
+u64 OGLBufferCache::GetBlockOffset(const Buffer& buffer) {
+    return buffer->GetBaseOffset();
+}
+
 const GLuint* OGLBufferCache::GetEmptyBuffer(std::size_t) {
     static const GLuint null_buffer = 0;
     return &null_buffer;
@@ -51,21 +146,32 @@ const GLuint* OGLBufferCache::GetEmptyBuffer(std::size_t) {
 
 void OGLBufferCache::UploadBlockData(const Buffer& buffer, std::size_t offset, std::size_t size,
                                      const u8* data) {
-    glNamedBufferSubData(*buffer->GetHandle(), static_cast<GLintptr>(offset),
+    if (!buffer->IsUsedByGPU()) {
+        // Nothing can be reading the block yet, write straight to the mapped memory
+        std::memcpy(buffer->GetMappedPointer() + offset, data, size);
+        return;
+    }
+    glNamedBufferSubData(*buffer->GetHandle(),
+                         static_cast<GLintptr>(buffer->GetBaseOffset() + offset),
                          static_cast<GLsizeiptr>(size), data);
 }
 
 void OGLBufferCache::DownloadBlockData(const Buffer& buffer, std::size_t offset, std::size_t size,
                                        u8* data) {
     MICROPROFILE_SCOPE(OpenGL_Buffer_Download);
-    glGetNamedBufferSubData(*buffer->GetHandle(), static_cast<GLintptr>(offset),
+    glGetNamedBufferSubData(*buffer->GetHandle(),
+                            static_cast<GLintptr>(buffer->GetBaseOffset() + offset),
                             static_cast<GLsizeiptr>(size), data);
 }
 
 void OGLBufferCache::CopyBlock(const Buffer& src, const Buffer& dst, std::size_t src_offset,
                                std::size_t dst_offset, std::size_t size) {
+    // The copy is queued, later writes to either block have to be ordered after it
+    src->MarkAsUsedByGPU();
+    dst->MarkAsUsedByGPU();
     glCopyNamedBufferSubData(*src->GetHandle(), *dst->GetHandle(),
-                             static_cast<GLintptr>(src_offset), static_cast<GLintptr>(dst_offset),
+                             static_cast<GLintptr>(src->GetBaseOffset() + src_offset),
+                             static_cast<GLintptr>(dst->GetBaseOffset() + dst_offset),
                              static_cast<GLsizeiptr>(size));
 }
 
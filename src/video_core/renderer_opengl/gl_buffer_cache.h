@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <cstddef>
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include "common/common_types.h"
+#include "common/tlsf_allocator.h"
 #include "video_core/buffer_cache/buffer_cache.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
@@ -18,6 +22,7 @@ class System;
 
 namespace OpenGL {
 
+class Device;
 class OGLStreamBuffer;
 class RasterizerOpenGL;
 
@@ -25,27 +30,101 @@ class CachedBufferBlock;
 
 using Buffer = std::shared_ptr<CachedBufferBlock>;
 
+/**
+ * Large persistently mapped buffers that cached blocks are sub-allocated from. Released ranges are
+ * only handed out again once the GPU has finished the commands that could be reading them.
+ */
+class BufferArenaPool final {
+public:
+    struct Arena;
+
+    struct Allocation {
+        Arena* arena;
+        GLuint handle; ///< Buffer holding the range.
+        u64 offset;    ///< Offset of the range in the buffer.
+        u8* pointer;   ///< Mapped pointer to the start of the range.
+        u32 allocation_handle;
+    };
+
+    explicit BufferArenaPool(std::size_t alignment);
+    ~BufferArenaPool();
+
+    Allocation Allocate(std::size_t size);
+
+    /// Returns a range to the pool, it won't be reused before the next fence is signaled.
+    void Free(const Allocation& allocation);
+
+    /// Fences the ranges released since the last call and reclaims the ones already signaled.
+    void TickFrame();
+
+private:
+    /// Size of the arenas, larger blocks get an arena of their own.
+    static constexpr std::size_t ArenaSize = 64 * 1024 * 1024;
+
+    struct PendingFree {
+        Arena* arena;
+        u32 allocation_handle;
+    };
+
+    struct FencedFrees {
+        OGLSync fence;
+        std::vector<PendingFree> frees;
+    };
+
+    Arena& CreateArena(std::size_t size);
+
+    void ReleaseArena(Arena& arena);
+
+    std::size_t alignment;
+    std::vector<std::unique_ptr<Arena>> arenas;
+    std::vector<PendingFree> unfenced_frees;
+    std::deque<FencedFrees> fenced_frees;
+};
+
 class CachedBufferBlock : public VideoCommon::BufferBlock {
 public:
-    explicit CachedBufferBlock(CacheAddr cache_addr, const std::size_t size);
+    explicit CachedBufferBlock(CacheAddr cache_addr, const std::size_t size,
+                               std::shared_ptr<BufferArenaPool> pool);
     ~CachedBufferBlock();
 
     const GLuint* GetHandle() const {
-        return &gl_buffer.handle;
+        return &allocation.handle;
+    }
+
+    /// Returns the offset of the start of the block in its buffer.
+    u64 GetBaseOffset() const {
+        return allocation.offset;
+    }
+
+    u8* GetMappedPointer() const {
+        return allocation.pointer;
+    }
+
+    /// Returns true when commands that access the block may have been submitted.
+    bool IsUsedByGPU() const {
+        return is_used_by_gpu;
+    }
+
+    void MarkAsUsedByGPU() {
+        is_used_by_gpu = true;
     }
 
 private:
-    OGLBuffer gl_buffer{};
+    std::shared_ptr<BufferArenaPool> pool;
+    BufferArenaPool::Allocation allocation;
+    bool is_used_by_gpu = false;
 };
 
 class OGLBufferCache final : public VideoCommon::BufferCache<Buffer, GLuint, OGLStreamBuffer> {
 public:
     explicit OGLBufferCache(RasterizerOpenGL& rasterizer, Core::System& system,
-                            std::size_t stream_size);
+                            const Device& device, std::size_t stream_size);
     ~OGLBufferCache();
 
     const GLuint* GetEmptyBuffer(std::size_t) override;
 
+    void TickFrame();
+
 protected:
     Buffer CreateBlock(CacheAddr cache_addr, std::size_t size) override;
 
@@ -53,6 +132,8 @@ protected:
 
     const GLuint* ToHandle(const Buffer& buffer) override;
 
+    u64 GetBlockOffset(const Buffer& buffer) override;
+
     void UploadBlockData(const Buffer& buffer, std::size_t offset, std::size_t size,
                          const u8* data) override;
 
@@ -61,6 +142,9 @@ protected:
 
     void CopyBlock(const Buffer& src, const Buffer& dst, std::size_t src_offset,
                    std::size_t dst_offset, std::size_t size) override;
+
+private:
+    std::shared_ptr<BufferArenaPool> arena_pool;
 };
 
 } // namespace OpenGL
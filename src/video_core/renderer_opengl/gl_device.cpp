@@ -64,10 +64,16 @@ Device::Device() {
     has_variable_aoffi = TestVariableAoffi();
     has_component_indexing_bug = TestComponentIndexingBug();
     has_precise_bug = TestPreciseBug();
+    has_arb_parallel_shader_compile = GLAD_GL_ARB_parallel_shader_compile;
+    has_parallel_shader_compile =
+        has_arb_parallel_shader_compile || GLAD_GL_KHR_parallel_shader_compile;
+    has_bindless_textures = GLAD_GL_ARB_bindless_texture;
 
     LOG_INFO(Render_OpenGL, "Renderer_VariableAOFFI: {}", has_variable_aoffi);
     LOG_INFO(Render_OpenGL, "Renderer_ComponentIndexingBug: {}", has_component_indexing_bug);
     LOG_INFO(Render_OpenGL, "Renderer_PreciseBug: {}", has_precise_bug);
+    LOG_INFO(Render_OpenGL, "Renderer_ParallelShaderCompile: {}", has_parallel_shader_compile);
+    LOG_INFO(Render_OpenGL, "Renderer_BindlessTextures: {}", has_bindless_textures);
 }
 
 Device::Device(std::nullptr_t) {
@@ -80,6 +86,9 @@ Device::Device(std::nullptr_t) {
     has_variable_aoffi = true;
     has_component_indexing_bug = false;
     has_precise_bug = false;
+    has_parallel_shader_compile = false;
+    has_arb_parallel_shader_compile = false;
+    has_bindless_textures = false;
 }
 
 bool Device::TestVariableAoffi() {
@@ -54,6 +54,18 @@ public:
         return has_precise_bug;
     }
 
+    bool HasParallelShaderCompile() const {
+        return has_parallel_shader_compile;
+    }
+
+    bool HasARBParallelShaderCompile() const {
+        return has_arb_parallel_shader_compile;
+    }
+
+    bool HasBindlessTextures() const {
+        return has_bindless_textures;
+    }
+
 private:
     static bool TestVariableAoffi();
     static bool TestComponentIndexingBug();
@@ -69,6 +81,9 @@ private:
     bool has_variable_aoffi{};
     bool has_component_indexing_bug{};
     bool has_precise_bug{};
+    bool has_parallel_shader_compile{};
+    bool has_arb_parallel_shader_compile{};
+    bool has_bindless_textures{};
 };
 
 } // namespace OpenGL
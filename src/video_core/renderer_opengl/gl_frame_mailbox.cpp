@@ -0,0 +1,193 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <glad/glad.h>
+
+#include "common/microprofile.h"
+#include "core/frontend/emu_window.h"
+#include "core/settings.h"
+#include "video_core/renderer_opengl/gl_frame_mailbox.h"
+#include "video_core/renderer_opengl/gl_state.h"
+
+namespace OpenGL {
+
+MICROPROFILE_DEFINE(OpenGL_Present, "OpenGL", "Present", MP_RGB(128, 128, 128));
+
+namespace {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+/// Time the presentation thread waits for a frame before checking if it has to stop.
+constexpr auto PresentTimeout = std::chrono::milliseconds{100};
+
+/// Longer gaps between frames are stalls, they aren't taken into account by the frame pacing.
+constexpr auto MaxFrameInterval = microseconds{50000};
+
+/// Moves a running average a fraction of the way to a new sample.
+microseconds UpdateAverage(microseconds average, microseconds sample) {
+    return average + (sample - average) / 8;
+}
+
+} // Anonymous namespace
+
+FrameMailbox::FrameMailbox(Core::Frontend::EmuWindow& render_window)
+    : render_window{render_window} {
+    for (Frame& frame : swap_chain) {
+        free_queue.push_back(&frame);
+    }
+    present_thread = std::thread([this] { PresentLoop(); });
+}
+
+FrameMailbox::~FrameMailbox() {
+    {
+        std::lock_guard lock{queue_mutex};
+        stop_requested = true;
+    }
+    present_cv.notify_all();
+    present_thread.join();
+}
+
+Frame& FrameMailbox::GetRenderFrame() {
+    Frame* frame;
+    {
+        std::unique_lock lock{queue_mutex};
+        free_cv.wait(lock, [this] { return !free_queue.empty(); });
+        frame = free_queue.front();
+        free_queue.pop_front();
+    }
+    if (frame->present_fence.handle != 0) {
+        // Don't overwrite the frame while the presentation is still reading it
+        glWaitSync(frame->present_fence.handle, 0, GL_TIMEOUT_IGNORED);
+        frame->present_fence.Release();
+    }
+    return *frame;
+}
+
+void FrameMailbox::ReloadRenderFrame(Frame& frame, u32 width, u32 height, bool is_srgb) {
+    frame.width = width;
+    frame.height = height;
+    frame.is_srgb = is_srgb;
+    frame.color_reloaded = true;
+
+    frame.color.Release();
+    frame.color.Create(GL_TEXTURE_2D);
+    glTextureStorage2D(frame.color.handle, 1, is_srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8, width, height);
+
+    // Framebuffers created with glGenFramebuffers have to be bound once before they can be used
+    frame.render_fbo.Create();
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frame.render_fbo.handle);
+    glFramebufferTexture(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, frame.color.handle, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, OpenGLState::GetCurState().draw.draw_framebuffer);
+}
+
+void FrameMailbox::ReleaseRenderFrame(Frame& frame) {
+    frame.render_fence.Create();
+    // Submit the frame so the presentation context can wait on its fence
+    glFlush();
+    frame.submit_time = steady_clock::now();
+    {
+        std::lock_guard lock{queue_mutex};
+        if (stop_requested) {
+            // Nobody is going to present it, keep it available for the render thread
+            frame.render_fence.Release();
+            free_queue.push_back(&frame);
+            return;
+        }
+        present_queue.push_back(&frame);
+    }
+    present_cv.notify_one();
+}
+
+void FrameMailbox::PresentLoop() {
+    MicroProfileOnThreadCreate("PresentThread");
+    render_window.MakeCurrent();
+
+    while (Frame* const frame = TryGetPresentFrame()) {
+        Present(*frame);
+    }
+
+    for (Frame& frame : swap_chain) {
+        glDeleteFramebuffers(1, &frame.present_fbo);
+        frame.present_fbo = 0;
+    }
+    render_window.DoneCurrent();
+}
+
+Frame* FrameMailbox::TryGetPresentFrame() {
+    std::unique_lock lock{queue_mutex};
+    while (present_queue.empty()) {
+        if (stop_requested) {
+            return nullptr;
+        }
+        present_cv.wait_for(lock, PresentTimeout);
+    }
+
+    // Only the newest frame is presented, return the rest to the render thread
+    while (present_queue.size() > 1) {
+        Frame* const dropped = present_queue.front();
+        present_queue.pop_front();
+        dropped->render_fence.Release();
+        free_queue.push_back(dropped);
+        ++frames_dropped;
+    }
+    Frame* const frame = present_queue.front();
+    present_queue.pop_front();
+    lock.unlock();
+
+    free_cv.notify_one();
+    return frame;
+}
+
+void FrameMailbox::Present(Frame& frame) {
+    MICROPROFILE_SCOPE(OpenGL_Present);
+
+    glWaitSync(frame.render_fence.handle, 0, GL_TIMEOUT_IGNORED);
+    frame.render_fence.Release();
+
+    if (frame.color_reloaded) {
+        if (frame.present_fbo == 0) {
+            glCreateFramebuffers(1, &frame.present_fbo);
+        }
+        glNamedFramebufferTexture(frame.present_fbo, GL_COLOR_ATTACHMENT0, frame.color.handle, 0);
+        frame.color_reloaded = false;
+    }
+
+    if (last_submit_time != steady_clock::time_point{}) {
+        const auto interval = duration_cast<microseconds>(frame.submit_time - last_submit_time);
+        average_interval = UpdateAverage(average_interval, std::min(interval, MaxFrameInterval));
+    }
+    last_submit_time = frame.submit_time;
+
+    if (Settings::values.use_frame_smoothing) {
+        // Frames that were rendered early wait for the average interval, evening out the pacing
+        const auto target_time = last_present_time + average_interval;
+        if (steady_clock::now() < target_time) {
+            std::this_thread::sleep_until(target_time);
+        }
+    }
+
+    const auto& layout = render_window.GetFramebufferLayout();
+    glBlitNamedFramebuffer(frame.present_fbo, 0, 0, 0, frame.width, frame.height, 0, 0,
+                           layout.width, layout.height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    frame.present_fence.Create();
+    render_window.SwapBuffers();
+
+    last_present_time = steady_clock::now();
+    average_latency = UpdateAverage(
+        average_latency, duration_cast<microseconds>(last_present_time - frame.submit_time));
+    MICROPROFILE_META_CPU("Present latency (us)", static_cast<int>(average_latency.count()));
+    MICROPROFILE_META_CPU("Frame interval (us)", static_cast<int>(average_interval.count()));
+    MICROPROFILE_META_CPU("Frames dropped", static_cast<int>(frames_dropped));
+
+    {
+        std::lock_guard lock{queue_mutex};
+        free_queue.push_back(&frame);
+    }
+    free_cv.notify_one();
+}
+
+} // namespace OpenGL
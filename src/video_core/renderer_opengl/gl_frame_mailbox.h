@@ -0,0 +1,86 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Core::Frontend {
+class EmuWindow;
+}
+
+namespace OpenGL {
+
+/// Rendered frame waiting to be presented, the color texture is shared between both contexts.
+struct Frame {
+    u32 width{};
+    u32 height{};
+    bool is_srgb{};
+    OGLTexture color;
+    OGLFramebuffer render_fbo; ///< Only valid in the render context
+    GLuint present_fbo{};      ///< Only valid in the presentation context
+    bool color_reloaded{};     ///< The presentation framebuffer has to attach the new color texture
+    OGLSync render_fence;      ///< Signaled when the frame has been drawn
+    OGLSync present_fence;     ///< Signaled when the presentation is done reading the frame
+    std::chrono::steady_clock::time_point submit_time;
+};
+
+/**
+ * Hands rendered frames from the GPU thread to a dedicated presentation thread, so a present
+ * blocked on vsync doesn't stall the processing of the next frame. The presentation thread owns
+ * the window context and only presents the newest frame, older frames are dropped.
+ */
+class FrameMailbox final {
+public:
+    explicit FrameMailbox(Core::Frontend::EmuWindow& render_window);
+    ~FrameMailbox();
+
+    /// Returns a frame to render to, called from the render context.
+    Frame& GetRenderFrame();
+
+    /// Reallocates the color texture of a frame, called from the render context.
+    void ReloadRenderFrame(Frame& frame, u32 width, u32 height, bool is_srgb);
+
+    /// Queues a rendered frame for presentation, called from the render context.
+    void ReleaseRenderFrame(Frame& frame);
+
+private:
+    static constexpr std::size_t SwapChainSize = 3;
+
+    void PresentLoop();
+
+    Frame* TryGetPresentFrame();
+
+    void Present(Frame& frame);
+
+    Core::Frontend::EmuWindow& render_window;
+
+    std::array<Frame, SwapChainSize> swap_chain;
+    std::deque<Frame*> free_queue;
+    std::deque<Frame*> present_queue;
+    std::mutex queue_mutex;
+    std::condition_variable free_cv;
+    std::condition_variable present_cv;
+    bool stop_requested = false;
+
+    // Only used by the presentation thread
+    std::chrono::steady_clock::time_point last_submit_time;
+    std::chrono::steady_clock::time_point last_present_time;
+    std::chrono::microseconds average_interval{};
+    std::chrono::microseconds average_latency{};
+    u64 frames_dropped = 0;
+
+    std::thread present_thread;
+};
+
+} // namespace OpenGL
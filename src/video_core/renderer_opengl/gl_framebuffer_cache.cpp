@@ -2,9 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <tuple>
 
-#include "common/cityhash.h"
+#include "common/hash.h"
 #include "common/scope_exit.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/renderer_opengl/gl_framebuffer_cache.h"
@@ -18,15 +19,83 @@ FramebufferCacheOpenGL::FramebufferCacheOpenGL() = default;
 
 FramebufferCacheOpenGL::~FramebufferCacheOpenGL() = default;
 
+namespace {
+
+/// Calls func with the surface of every view attached by the key
+template <typename Func>
+void ForEachSurface(const FramebufferCacheKey& key, Func&& func) {
+    for (const auto& color : key.colors) {
+        if (color) {
+            func(color->GetParent());
+        }
+    }
+    if (key.zeta) {
+        func(key.zeta->GetParent());
+    }
+}
+
+} // Anonymous namespace
+
 GLuint FramebufferCacheOpenGL::GetFramebuffer(const FramebufferCacheKey& key) {
     const auto [entry, is_cache_miss] = cache.try_emplace(key);
-    auto& framebuffer{entry->second};
-    if (is_cache_miss) {
-        framebuffer = CreateFramebuffer(key);
+    auto& [framebuffer, last_frame] = entry->second;
+    last_frame = frame;
+    if (!is_cache_miss) {
+        ++hits;
+        return framebuffer.handle;
     }
+    ++misses;
+    framebuffer = CreateFramebuffer(key);
+    ForEachSurface(key, [this, &key](const CachedSurface& surface) {
+        surface_keys[&surface].push_back(key);
+    });
     return framebuffer.handle;
 }
 
+void FramebufferCacheOpenGL::InvalidateSurface(const CachedSurface& surface) {
+    const auto node = surface_keys.extract(&surface);
+    if (!node) {
+        return;
+    }
+    for (const auto& key : node.mapped()) {
+        if (const auto it = cache.find(key); it != cache.end()) {
+            Erase(it);
+        }
+    }
+}
+
+void FramebufferCacheOpenGL::TickFrame() {
+    ++frame;
+    if (frame <= FramebufferLifetime) {
+        return;
+    }
+    const u64 threshold = frame - FramebufferLifetime;
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.last_frame < threshold) {
+            it = Erase(it);
+            ++evictions;
+        } else {
+            ++it;
+        }
+    }
+}
+
+FramebufferCacheOpenGL::Cache::iterator FramebufferCacheOpenGL::Erase(Cache::iterator it) {
+    const FramebufferCacheKey& key = it->first;
+    ForEachSurface(key, [this, &key](const CachedSurface& surface) {
+        const auto keys_it = surface_keys.find(&surface);
+        if (keys_it == surface_keys.end()) {
+            return;
+        }
+        auto& keys = keys_it->second;
+        keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+        if (keys.empty()) {
+            surface_keys.erase(keys_it);
+        }
+    });
+    return cache.erase(it);
+}
+
 OGLFramebuffer FramebufferCacheOpenGL::CreateFramebuffer(const FramebufferCacheKey& key) {
     OGLFramebuffer framebuffer;
     framebuffer.Create();
@@ -57,8 +126,7 @@ OGLFramebuffer FramebufferCacheOpenGL::CreateFramebuffer(const FramebufferCacheK
 
 std::size_t FramebufferCacheKey::Hash() const {
     static_assert(sizeof(*this) % sizeof(u64) == 0, "Unaligned struct");
-    return static_cast<std::size_t>(
-        Common::CityHash64(reinterpret_cast<const char*>(this), sizeof(*this)));
+    return static_cast<std::size_t>(Common::ComputeFastHash64(this, sizeof(*this)));
 }
 
 bool FramebufferCacheKey::operator==(const FramebufferCacheKey& rhs) const {
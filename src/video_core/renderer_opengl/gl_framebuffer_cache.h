@@ -7,6 +7,7 @@
 #include <array>
 #include <cstddef>
 #include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -50,18 +51,54 @@ struct hash<OpenGL::FramebufferCacheKey> {
 
 namespace OpenGL {
 
+struct FramebufferCacheStats {
+    u64 hits{};
+    u64 misses{};
+    u64 evictions{};
+    std::size_t size{};
+};
+
 class FramebufferCacheOpenGL {
 public:
+    /// Framebuffers not bound for this many frames are deleted
+    static constexpr u64 FramebufferLifetime = 600;
+
     FramebufferCacheOpenGL();
     ~FramebufferCacheOpenGL();
 
     GLuint GetFramebuffer(const FramebufferCacheKey& key);
 
+    /// Deletes the framebuffers attaching views of a surface the texture cache is releasing
+    void InvalidateSurface(const CachedSurface& surface);
+
+    /// Deletes the framebuffers that haven't been bound for a while
+    void TickFrame();
+
+    FramebufferCacheStats GetStats() const {
+        return {hits, misses, evictions, cache.size()};
+    }
+
 private:
+    struct Entry {
+        OGLFramebuffer framebuffer;
+        u64 last_frame{};
+    };
+
+    using Cache = std::unordered_map<FramebufferCacheKey, Entry>;
+
     OGLFramebuffer CreateFramebuffer(const FramebufferCacheKey& key);
 
+    /// Removes a framebuffer from the cache and from the index of the surfaces it attaches
+    Cache::iterator Erase(Cache::iterator it);
+
     OpenGLState local_state;
-    std::unordered_map<FramebufferCacheKey, OGLFramebuffer> cache;
+    Cache cache;
+    std::unordered_map<const CachedSurface*, std::vector<FramebufferCacheKey>> surface_keys;
+
+    u64 frame = 0;
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 evictions = 0;
 };
 
 } // namespace OpenGL
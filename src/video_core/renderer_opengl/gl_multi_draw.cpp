@@ -0,0 +1,122 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include <glad/glad.h>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+#include "common/microprofile.h"
+#include "video_core/renderer_opengl/gl_multi_draw.h"
+
+namespace OpenGL {
+
+MICROPROFILE_DEFINE(OpenGL_MultiDraw, "OpenGL", "Multi Draw", MP_RGB(128, 128, 192));
+
+namespace {
+
+/// Draws in a single indirect call, bounds the size of each indirect buffer write.
+constexpr std::size_t MaxBatchSize = 1024;
+
+constexpr GLsizeiptr IndirectBufferSize = 4 * 1024 * 1024;
+
+/// Non-indexed commands read the first four words of a DrawArraysIndirectCommand.
+struct DrawArraysCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first;
+    GLuint base_instance;
+};
+
+GLintptr GetIndexSize(GLenum index_format) {
+    switch (index_format) {
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_UNSIGNED_SHORT:
+        return 2;
+    case GL_UNSIGNED_INT:
+        return 4;
+    }
+    UNREACHABLE();
+    return 1;
+}
+
+} // Anonymous namespace
+
+MultiDrawBuffer::MultiDrawBuffer() : indirect_buffer{IndirectBufferSize, false} {
+    commands.reserve(MaxBatchSize);
+}
+
+MultiDrawBuffer::~MultiDrawBuffer() = default;
+
+void MultiDrawBuffer::Begin(GLenum primitive_mode_, GLenum index_format_) {
+    ASSERT(!is_open);
+    primitive_mode = primitive_mode_;
+    index_format = index_format_;
+    is_open = true;
+}
+
+void MultiDrawBuffer::Push(const DrawCommand& command) {
+    ASSERT(is_open);
+    if (commands.size() == MaxBatchSize) {
+        Dispatch();
+    }
+    commands.push_back(command);
+}
+
+void MultiDrawBuffer::Flush() {
+    Dispatch();
+    is_open = false;
+}
+
+void MultiDrawBuffer::Dispatch() {
+    if (commands.empty()) {
+        return;
+    }
+    MICROPROFILE_SCOPE(OpenGL_MultiDraw);
+
+    const bool is_indexed = index_format != 0;
+    if (commands.size() == 1) {
+        // Not worth going through the indirect buffer
+        const DrawCommand& command = commands.front();
+        if (is_indexed) {
+            const GLintptr offset = command.first * GetIndexSize(index_format);
+            glDrawElementsInstancedBaseVertexBaseInstance(
+                primitive_mode, command.count, index_format, reinterpret_cast<const void*>(offset),
+                command.instance_count, command.base_vertex, command.base_instance);
+        } else {
+            glDrawArraysInstancedBaseInstance(primitive_mode, command.first, command.count,
+                                              command.instance_count, command.base_instance);
+        }
+        commands.clear();
+        return;
+    }
+
+    const auto draw_count = static_cast<GLsizei>(commands.size());
+    const GLsizeiptr size = commands.size() * sizeof(DrawCommand);
+    const auto [pointer, offset, invalidated] = indirect_buffer.Map(size, 4);
+    if (is_indexed) {
+        std::memcpy(pointer, commands.data(), size);
+    } else {
+        auto* const array_commands = reinterpret_cast<DrawArraysCommand*>(pointer);
+        for (std::size_t i = 0; i < commands.size(); ++i) {
+            const DrawCommand& command = commands[i];
+            array_commands[i] = {command.count, command.instance_count, command.first,
+                                 command.base_instance};
+        }
+    }
+    indirect_buffer.Unmap(is_indexed ? size : draw_count * sizeof(DrawArraysCommand));
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer.GetHandle());
+    const auto indirect = reinterpret_cast<const void*>(offset);
+    if (is_indexed) {
+        glMultiDrawElementsIndirect(primitive_mode, index_format, indirect, draw_count, 0);
+    } else {
+        glMultiDrawArraysIndirect(primitive_mode, indirect, draw_count, 0);
+    }
+    commands.clear();
+}
+
+} // namespace OpenGL
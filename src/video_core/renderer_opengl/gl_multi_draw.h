@@ -0,0 +1,62 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_stream_buffer.h"
+
+namespace OpenGL {
+
+/// Range and instances of a single draw, laid out as a DrawElementsIndirectCommand.
+struct DrawCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first;       ///< First vertex, or first index in the bound index buffer
+    GLint base_vertex;  ///< Ignored by non-indexed draws
+    GLuint base_instance;
+};
+static_assert(sizeof(DrawCommand) == 5 * sizeof(GLuint), "DrawCommand is incorrect size");
+
+/**
+ * Collects consecutive draws that share all of their state and dispatches them with a single
+ * glMultiDraw*Indirect call, the commands are written to a persistent indirect buffer. All the
+ * state of the draws has to be bound before the batch is flushed.
+ */
+class MultiDrawBuffer final {
+public:
+    explicit MultiDrawBuffer();
+    ~MultiDrawBuffer();
+
+    /// Opens a batch, index_format is zero for non-indexed draws.
+    void Begin(GLenum primitive_mode, GLenum index_format);
+
+    /// Returns true when a draw of the given topology and index format can join the open batch.
+    bool IsCompatible(GLenum primitive_mode, GLenum index_format) const {
+        return is_open && this->primitive_mode == primitive_mode &&
+               this->index_format == index_format;
+    }
+
+    /// Adds a draw to the open batch.
+    void Push(const DrawCommand& command);
+
+    /// Dispatches the pending draws and closes the batch.
+    void Flush();
+
+private:
+    /// Dispatches the pending draws, the batch stays open.
+    void Dispatch();
+
+    OGLStreamBuffer indirect_buffer;
+    std::vector<DrawCommand> commands;
+
+    GLenum primitive_mode{};
+    GLenum index_format{};
+    bool is_open = false;
+};
+
+} // namespace OpenGL
@@ -0,0 +1,104 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include <glad/glad.h>
+
+#include "video_core/renderer_opengl/gl_query_cache.h"
+
+namespace OpenGL {
+
+HostCounter::HostCounter(std::shared_ptr<HostCounter> dependency_, OGLQuery query)
+    : dependency{std::move(dependency_)}, query{std::move(query)} {
+    if (!dependency) {
+        return;
+    }
+    if (dependency->Depth() >= MaxDependencyDepth) {
+        // Keep the chain from growing without bounds, the older counter is likely done by now
+        dependency->Query();
+    }
+    depth = dependency->Depth() + 1;
+}
+
+HostCounter::~HostCounter() = default;
+
+u64 HostCounter::Query() {
+    if (result) {
+        return *result;
+    }
+    u64 value = 0;
+    if (query.handle != 0) {
+        glGetQueryObjectui64v(query.handle, GL_QUERY_RESULT, &value);
+        query.Release();
+    }
+    if (dependency) {
+        value += dependency->Query();
+        dependency.reset();
+    }
+    depth = 0;
+    result = value;
+    return value;
+}
+
+CounterStream::CounterStream(GLenum target) : target{target} {}
+
+CounterStream::~CounterStream() = default;
+
+void CounterStream::Update(bool enabled) {
+    if (enabled == (current.handle != 0)) {
+        return;
+    }
+    if (enabled) {
+        current.Create(target);
+        glBeginQuery(target, current.handle);
+    } else {
+        EndQuery();
+    }
+}
+
+void CounterStream::Reset() {
+    last.reset();
+    if (current.handle != 0) {
+        // Samples counted so far are discarded with the query
+        glEndQuery(target);
+        current.Release();
+        current.Create(target);
+        glBeginQuery(target, current.handle);
+    }
+}
+
+std::shared_ptr<HostCounter> CounterStream::GetCurrent() {
+    if (current.handle != 0) {
+        EndQuery();
+        current.Create(target);
+        glBeginQuery(target, current.handle);
+    }
+    if (!last) {
+        last = std::make_shared<HostCounter>(nullptr, OGLQuery{});
+    }
+    return last;
+}
+
+void CounterStream::EndQuery() {
+    glEndQuery(target);
+    last = std::make_shared<HostCounter>(std::move(last), std::move(current));
+}
+
+QueryCache::QueryCache() : streams{{CounterStream{GL_SAMPLES_PASSED}}} {}
+
+QueryCache::~QueryCache() = default;
+
+void QueryCache::UpdateCounters(const Tegra::Engines::Maxwell3D::Regs& regs) {
+    GetStream(VideoCore::QueryType::SamplesPassed).Update(regs.samplecnt_enable != 0);
+}
+
+void QueryCache::ResetCounter(VideoCore::QueryType type) {
+    GetStream(type).Reset();
+}
+
+std::shared_ptr<HostCounter> QueryCache::GetCounter(VideoCore::QueryType type) {
+    return GetStream(type).GetCurrent();
+}
+
+} // namespace OpenGL
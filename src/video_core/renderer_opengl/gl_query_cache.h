@@ -0,0 +1,90 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Value of a counter at the point the guest queried it. A counter accumulates the results of every
+ * GL query since it was reset, so each one holds the query it ended and the counter before it.
+ * Resolving it only blocks when the host GPU hasn't executed the draws it counts yet.
+ */
+class HostCounter final {
+public:
+    explicit HostCounter(std::shared_ptr<HostCounter> dependency, OGLQuery query);
+    ~HostCounter();
+
+    /// Returns the value of the counter, waiting for the host GPU when it has to.
+    u64 Query();
+
+    /// Returns how many counters have to be resolved to resolve this one.
+    u32 Depth() const {
+        return depth;
+    }
+
+private:
+    /// Dependency chains longer than this are resolved, so they can't grow without bounds.
+    static constexpr u32 MaxDependencyDepth = 256;
+
+    std::shared_ptr<HostCounter> dependency;
+    OGLQuery query;
+    std::optional<u64> result;
+    u32 depth = 0;
+};
+
+/// Counts with a GL query while the guest has the counter enabled, split at every guest query.
+class CounterStream final {
+public:
+    explicit CounterStream(GLenum target);
+    ~CounterStream();
+
+    /// Starts or stops counting.
+    void Update(bool enabled);
+
+    /// Sets the counter back to zero.
+    void Reset();
+
+    /// Returns the counter at this point of the command stream.
+    std::shared_ptr<HostCounter> GetCurrent();
+
+private:
+    void EndQuery();
+
+    GLenum target;
+    OGLQuery current;
+    std::shared_ptr<HostCounter> last;
+};
+
+class QueryCache final {
+public:
+    QueryCache();
+    ~QueryCache();
+
+    /// Starts or stops the counters the guest enabled or disabled, called before draws.
+    void UpdateCounters(const Tegra::Engines::Maxwell3D::Regs& regs);
+
+    void ResetCounter(VideoCore::QueryType type);
+
+    std::shared_ptr<HostCounter> GetCounter(VideoCore::QueryType type);
+
+private:
+    CounterStream& GetStream(VideoCore::QueryType type) {
+        return streams[static_cast<std::size_t>(type)];
+    }
+
+    std::array<CounterStream, VideoCore::NumQueryTypes> streams;
+};
+
+} // namespace OpenGL
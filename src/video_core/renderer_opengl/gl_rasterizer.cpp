@@ -5,11 +5,15 @@
 #include <algorithm>
 #include <array>
 #include <bitset>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <utility>
+#include <fmt/format.h>
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/assert.h"
@@ -22,6 +26,7 @@
 #include "core/settings.h"
 #include "video_core/engines/kepler_compute.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/gpu_profiler.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
@@ -64,12 +69,63 @@ static std::size_t GetConstBufferSize(const Tegra::Engines::ConstBufferInfo& buf
     return buffer.size;
 }
 
+/// Returns the texture target a shader declares a sampler with, buffers aside
+static GLenum GetSamplerTarget(const GLShader::SamplerEntry& entry) {
+    switch (entry.GetType()) {
+    case Tegra::Shader::TextureType::Texture1D:
+        return entry.IsArray() ? GL_TEXTURE_1D_ARRAY : GL_TEXTURE_1D;
+    case Tegra::Shader::TextureType::Texture2D:
+        return entry.IsArray() ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+    case Tegra::Shader::TextureType::Texture3D:
+        return GL_TEXTURE_3D;
+    case Tegra::Shader::TextureType::TextureCube:
+        return entry.IsArray() ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_CUBE_MAP;
+    default:
+        UNREACHABLE();
+        return GL_TEXTURE_2D;
+    }
+}
+
+/// Creates a cleared single texel texture, sampling it reads zeros like an unbound texture unit
+static OGLTexture CreateNullTexture(GLenum target, bool is_shadow) {
+    OGLTexture texture;
+    texture.Create(target);
+    const GLenum internal_format = is_shadow ? GL_DEPTH_COMPONENT32F : GL_RGBA8;
+    switch (target) {
+    case GL_TEXTURE_1D:
+        glTextureStorage1D(texture.handle, 1, internal_format, 1);
+        break;
+    case GL_TEXTURE_1D_ARRAY:
+    case GL_TEXTURE_2D:
+    case GL_TEXTURE_CUBE_MAP:
+        glTextureStorage2D(texture.handle, 1, internal_format, 1, 1);
+        break;
+    case GL_TEXTURE_2D_ARRAY:
+    case GL_TEXTURE_3D:
+        glTextureStorage3D(texture.handle, 1, internal_format, 1, 1, 1);
+        break;
+    case GL_TEXTURE_CUBE_MAP_ARRAY:
+        glTextureStorage3D(texture.handle, 1, internal_format, 1, 1, 6);
+        break;
+    default:
+        UNREACHABLE();
+    }
+    if (is_shadow) {
+        glTextureParameteri(texture.handle, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glClearTexImage(texture.handle, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    } else {
+        glClearTexImage(texture.handle, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    return texture;
+}
+
 RasterizerOpenGL::RasterizerOpenGL(Core::System& system, Core::Frontend::EmuWindow& emu_window,
                                    ScreenInfo& info)
-    : texture_cache{system, *this, device}, shader_cache{*this, system, emu_window, device},
-      system{system}, screen_info{info}, buffer_cache{*this, system, STREAM_BUFFER_SIZE} {
+    : texture_cache{system, *this, device, framebuffer_cache}, shader_cache{*this, system, emu_window, device},
+      system{system}, screen_info{info}, buffer_cache{*this, system, device, STREAM_BUFFER_SIZE} {
     OpenGLState::ApplyDefaultState();
 
+    cached_pages.resize(std::size_t{1} << (MAX_ADDRESS_SPACE_BITS - Memory::PAGE_BITS));
     shader_program_manager = std::make_unique<GLShader::ProgramManager>();
     state.draw.shader_program = 0;
     state.Apply();
@@ -224,25 +280,33 @@ void RasterizerOpenGL::SetupVertexInstances(GLuint vao) {
     }
 }
 
-GLintptr RasterizerOpenGL::SetupIndexBuffer() {
+void RasterizerOpenGL::SetupIndexBuffer() {
     if (accelerate_draw != AccelDraw::Indexed) {
-        return 0;
+        batch_index = {};
+        return;
     }
     MICROPROFILE_SCOPE(OpenGL_Index);
-    const auto& regs = system.GPU().Maxwell3D().regs;
-    const std::size_t size = CalculateIndexBufferSize();
-    const auto [buffer, offset] = buffer_cache.UploadMemory(regs.index_array.IndexStart(), size);
+    const auto [address, size] = GetIndexBufferRange();
+    const auto [buffer, offset] = buffer_cache.UploadMemory(address, size);
     vertex_array_pushbuffer.SetIndexBuffer(buffer);
-    return offset;
+    batch_index.address = address;
+    batch_index.size = size;
+    batch_index.offset = static_cast<GLintptr>(offset);
 }
 
-void RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
+bool RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
     MICROPROFILE_SCOPE(OpenGL_Shader);
     auto& gpu = system.GPU().Maxwell3D();
 
+    bool is_ready = true;
     BaseBindings base_bindings;
     std::array<bool, Maxwell::NumClipDistances> clip_distances{};
 
+    const bool is_profiling = system.GPU().Profiler().IsCapturing();
+    if (is_profiling) {
+        profile_shaders.clear();
+    }
+
     for (std::size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
         const auto& shader_config = gpu.regs.shader_config[index];
         const Maxwell::ShaderProgram program{static_cast<Maxwell::ShaderProgram>(index)};
@@ -265,6 +329,12 @@ void RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
         const std::size_t stage{index == 0 ? 0 : index - 1}; // Stage indices are 0 - 5
 
         Shader shader{shader_cache.GetStageProgram(program)};
+        if (is_profiling) {
+            static constexpr std::array<const char*, Maxwell::MaxShaderProgram> stage_names{
+                "VS", "VS", "TCS", "TES", "GS", "FS"};
+            profile_shaders += fmt::format("{}{} {:016x}", profile_shaders.empty() ? "" : " ",
+                                           stage_names[index], shader->GetUniqueIdentifier());
+        }
 
         const auto stage_enum = static_cast<Maxwell::ShaderStage>(stage);
         SetupDrawConstBuffers(stage_enum, shader);
@@ -272,18 +342,24 @@ void RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
         const auto texture_buffer_usage{SetupDrawTextures(stage_enum, shader, base_bindings)};
 
         const ProgramVariant variant{base_bindings, primitive_mode, texture_buffer_usage};
-        const auto [program_handle, next_bindings] = shader->GetProgramHandle(variant);
+        auto [program_handle, next_bindings] = shader->GetProgramHandle(variant);
+        if (!program_handle) {
+            // Draw approximately with a generic program until the stage's program is built. Keep
+            // going either way, so the other stages get queued too
+            program_handle = shader_cache.GetFallbackProgram(program);
+            is_ready = is_ready && program_handle;
+        }
 
         switch (program) {
         case Maxwell::ShaderProgram::VertexA:
         case Maxwell::ShaderProgram::VertexB:
-            shader_program_manager->BindVertexShader(&program_handle);
+            shader_program_manager->BindVertexShader(program_handle);
             break;
         case Maxwell::ShaderProgram::Geometry:
-            shader_program_manager->BindGeometryShader(&program_handle);
+            shader_program_manager->BindGeometryShader(program_handle);
             break;
         case Maxwell::ShaderProgram::Fragment:
-            shader_program_manager->BindFragmentShader(&program_handle);
+            shader_program_manager->BindFragmentShader(program_handle);
             break;
         default:
             UNIMPLEMENTED_MSG("Unimplemented shader index={}, enable={}, offset=0x{:08X}", index,
@@ -310,6 +386,7 @@ void RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
     SyncClipEnabled(clip_distances);
 
     gpu.dirty.shaders = false;
+    return is_ready;
 }
 
 std::size_t RasterizerOpenGL::CalculateVertexArraysSize() const {
@@ -337,39 +414,56 @@ std::size_t RasterizerOpenGL::CalculateIndexBufferSize() const {
            static_cast<std::size_t>(regs.index_array.FormatSizeInBytes());
 }
 
-template <typename Map, typename Interval>
-static constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
-    return boost::make_iterator_range(map.equal_range(interval));
+std::pair<GPUVAddr, std::size_t> RasterizerOpenGL::GetIndexBufferRange() const {
+    const auto& index_array = system.GPU().Maxwell3D().regs.index_array;
+    const GPUVAddr start = index_array.IndexStart();
+    const std::size_t size = CalculateIndexBufferSize();
+    if (upload_whole_index_buffer) {
+        const GPUVAddr buffer_start = index_array.StartAddress();
+        const GPUVAddr buffer_end = index_array.EndAddress();
+        if (buffer_end > buffer_start && buffer_end - buffer_start <= MaxBatchIndexBufferSize &&
+            start + size <= buffer_end) {
+            return {buffer_start, static_cast<std::size_t>(buffer_end - buffer_start)};
+        }
+    }
+    return {start, size};
 }
 
 void RasterizerOpenGL::UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {
     const u64 page_start{addr >> Memory::PAGE_BITS};
     const u64 page_end{(addr + size + Memory::PAGE_SIZE - 1) >> Memory::PAGE_BITS};
-
-    // Interval maps will erase segments if count reaches 0, so if delta is negative we have to
-    // subtract after iterating
-    const auto pages_interval = CachedPageMap::interval_type::right_open(page_start, page_end);
-    if (delta > 0)
-        cached_pages.add({pages_interval, delta});
-
-    for (const auto& pair : RangeFromInterval(cached_pages, pages_interval)) {
-        const auto interval = pair.first & pages_interval;
-        const int count = pair.second;
-
-        const VAddr interval_start_addr = boost::icl::first(interval) << Memory::PAGE_BITS;
-        const VAddr interval_end_addr = boost::icl::last_next(interval) << Memory::PAGE_BITS;
-        const u64 interval_size = interval_end_addr - interval_start_addr;
-
-        if (delta > 0 && count == delta)
-            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
-        else if (delta < 0 && count == -delta)
-            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-        else
-            ASSERT(count >= 0);
+    ASSERT(page_end <= cached_pages.size());
+
+    // Pages whose count crosses zero change state, consecutive ones are marked with a single call
+    const bool cached = delta > 0;
+    const auto mark_run = [cached](u64 run_start, u64 run_end) {
+        Memory::RasterizerMarkRegionCached(run_start << Memory::PAGE_BITS,
+                                           (run_end - run_start) << Memory::PAGE_BITS, cached);
+    };
+
+    std::lock_guard lock{cached_pages_mutex};
+    std::optional<u64> run_start;
+    for (u64 page = page_start; page < page_end; ++page) {
+        const int old_count = cached_pages[page];
+        const int count = old_count + delta;
+        ASSERT(count >= 0 && count <= std::numeric_limits<u16>::max());
+        cached_pages[page] = static_cast<u16>(count);
+
+        const bool crossed = (old_count == 0) != (count == 0);
+        if (crossed && !run_start) {
+            run_start = page;
+        } else if (!crossed && run_start) {
+            mark_run(*run_start, page);
+            run_start.reset();
+        }
     }
+    if (run_start) {
+        mark_run(*run_start, page_end);
+    }
+}
 
-    if (delta < 0)
-        cached_pages.add({pages_interval, delta});
+void RasterizerOpenGL::PrefetchDiskResources(u64 title_id) {
+    shader_cache.PrefetchDiskCache(title_id);
 }
 
 void RasterizerOpenGL::LoadDiskResources(const std::atomic_bool& stop_loading,
@@ -378,6 +472,46 @@ void RasterizerOpenGL::LoadDiskResources(const std::atomic_bool& stop_loading,
     texture_cache.LoadResources();
 }
 
+VideoCore::RasterizerStatistics RasterizerOpenGL::GetStatistics() const {
+    const auto& shader_statistics = shader_cache.GetBuildStatistics();
+    VideoCore::RasterizerStatistics statistics;
+    statistics.shader_builds = shader_statistics.count.load(std::memory_order_relaxed);
+    statistics.shader_build_time =
+        std::chrono::nanoseconds{shader_statistics.time_ns.load(std::memory_order_relaxed)};
+    statistics.surface_lookups = texture_cache.GetSurfaceLookupCount();
+    statistics.surface_misses = texture_cache.GetSurfaceMissCount();
+    return statistics;
+}
+
+void RasterizerOpenGL::BeginProfiledWork() {
+    profile_start.Create(GL_TIMESTAMP);
+    glQueryCounter(profile_start.handle, GL_TIMESTAMP);
+}
+
+void RasterizerOpenGL::EndProfiledWork(std::string name) {
+    ProfiledWork& work = profiled_work.emplace_back();
+    work.name = std::move(name);
+    work.pass = profile_pass;
+    work.start = std::move(profile_start);
+    work.end.Create(GL_TIMESTAMP);
+    glQueryCounter(work.end.handle, GL_TIMESTAMP);
+}
+
+void RasterizerOpenGL::ResolveProfiledWork() {
+    auto& profiler = system.GPU().Profiler();
+    for (ProfiledWork& work : profiled_work) {
+        GLuint64 start_ns{};
+        GLuint64 end_ns{};
+        glGetQueryObjectui64v(work.start.handle, GL_QUERY_RESULT, &start_ns);
+        glGetQueryObjectui64v(work.end.handle, GL_QUERY_RESULT, &end_ns);
+        profiler.AddEvent(std::move(work.name), work.pass, start_ns, end_ns);
+    }
+    profiled_work.clear();
+    profile_framebuffer = 0;
+    profile_pass = 0;
+    profiler.EndFrame();
+}
+
 void RasterizerOpenGL::ConfigureFramebuffers() {
     MICROPROFILE_SCOPE(OpenGL_Framebuffer);
     auto& gpu = system.GPU().Maxwell3D();
@@ -469,6 +603,8 @@ void RasterizerOpenGL::ConfigureClearFramebuffer(OpenGLState& current_state, boo
 }
 
 void RasterizerOpenGL::Clear() {
+    multi_draw_buffer.Flush();
+    last_dispatch.is_valid = false;
     const auto& maxwell3d = system.GPU().Maxwell3D();
 
     if (!maxwell3d.ShouldExecute()) {
@@ -579,8 +715,11 @@ void RasterizerOpenGL::Clear() {
     }
 }
 
-void RasterizerOpenGL::DrawPrelude() {
+bool RasterizerOpenGL::DrawPrelude() {
     auto& gpu = system.GPU().Maxwell3D();
+    last_dispatch.is_valid = false;
+
+    query_cache.UpdateCounters(gpu.regs);
 
     SyncColorMask();
     SyncFragmentColorClampState();
@@ -603,13 +742,19 @@ void RasterizerOpenGL::DrawPrelude() {
 
     // Add space for index buffer
     if (is_indexed) {
-        buffer_size = Common::AlignUp(buffer_size, 4) + CalculateIndexBufferSize();
+        buffer_size = Common::AlignUp(buffer_size, 4) + GetIndexBufferRange().second;
     }
 
     // Add space for at least 18 constant buffers
     buffer_size += Maxwell::MaxConstBuffers *
                    (Maxwell::MaxConstBufferSize + device.GetUniformBufferAlignment());
 
+    // Add space for the bindless texture handles of each stage
+    if (shader_cache.UseBindlessTextures()) {
+        buffer_size += Maxwell::MaxShaderStage *
+                       (MaxTextureHandlesSize + device.GetUniformBufferAlignment());
+    }
+
     // Prepare the vertex array.
     buffer_cache.Map(buffer_size);
 
@@ -620,7 +765,7 @@ void RasterizerOpenGL::DrawPrelude() {
     // Upload vertex and index data.
     SetupVertexBuffer(vao);
     SetupVertexInstances(vao);
-    index_buffer_offset = SetupIndexBuffer();
+    SetupIndexBuffer();
 
     // Prepare packed bindings.
     bind_ubo_pushbuffer.Setup(0);
@@ -629,7 +774,7 @@ void RasterizerOpenGL::DrawPrelude() {
     // Setup shaders and their used resources.
     texture_cache.GuardSamplers(true);
     const auto primitive_mode = MaxwellToGL::PrimitiveTopology(gpu.regs.draw.topology);
-    SetupShaders(primitive_mode);
+    const bool shaders_ready = SetupShaders(primitive_mode);
     texture_cache.GuardSamplers(false);
 
     ConfigureFramebuffers();
@@ -655,131 +800,151 @@ void RasterizerOpenGL::DrawPrelude() {
     shader_program_manager->ApplyTo(state);
     state.Apply();
 
-    if (texture_cache.TextureBarrier()) {
+    texture_barrier = texture_cache.TextureBarrier();
+    if (texture_barrier) {
         glTextureBarrier();
     }
+    return shaders_ready;
 }
 
-struct DrawParams {
-    bool is_indexed{};
-    bool is_instanced{};
-    GLenum primitive_mode{};
-    GLint count{};
-    GLint base_vertex{};
-
-    // Indexed settings
-    GLenum index_format{};
-    GLintptr index_buffer_offset{};
-
-    // Instanced setting
-    GLint num_instances{};
-    GLint base_instance{};
-
-    void DispatchDraw() {
-        if (is_indexed) {
-            const auto index_buffer_ptr = reinterpret_cast<const void*>(index_buffer_offset);
-            if (is_instanced) {
-                glDrawElementsInstancedBaseVertexBaseInstance(primitive_mode, count, index_format,
-                                                              index_buffer_ptr, num_instances,
-                                                              base_vertex, base_instance);
-            } else {
-                glDrawElementsBaseVertex(primitive_mode, count, index_format, index_buffer_ptr,
-                                         base_vertex);
-            }
-        } else {
-            if (is_instanced) {
-                glDrawArraysInstancedBaseInstance(primitive_mode, base_vertex, count, num_instances,
-                                                  base_instance);
-            } else {
-                glDrawArrays(primitive_mode, base_vertex, count);
-            }
-        }
-    }
-};
-
 bool RasterizerOpenGL::DrawBatch(bool is_indexed) {
-    accelerate_draw = is_indexed ? AccelDraw::Indexed : AccelDraw::Arrays;
-
     MICROPROFILE_SCOPE(OpenGL_Drawing);
-
-    DrawPrelude();
-
-    auto& maxwell3d = system.GPU().Maxwell3D();
-    const auto& regs = maxwell3d.regs;
-    const auto current_instance = maxwell3d.state.current_instance;
-    DrawParams draw_call{};
-    draw_call.is_indexed = is_indexed;
-    draw_call.num_instances = static_cast<GLint>(1);
-    draw_call.base_instance = static_cast<GLint>(current_instance);
-    draw_call.is_instanced = current_instance > 0;
-    draw_call.primitive_mode = MaxwellToGL::PrimitiveTopology(regs.draw.topology);
-    if (draw_call.is_indexed) {
-        draw_call.count = static_cast<GLint>(regs.index_array.count);
-        draw_call.base_vertex = static_cast<GLint>(regs.vb_element_base);
-        draw_call.index_format = MaxwellToGL::IndexFormat(regs.index_array.format);
-        draw_call.index_buffer_offset = index_buffer_offset;
-    } else {
-        draw_call.count = static_cast<GLint>(regs.vertex_buffer.count);
-        draw_call.base_vertex = static_cast<GLint>(regs.vertex_buffer.first);
-    }
-    draw_call.DispatchDraw();
-
-    maxwell3d.dirty.memory_general = false;
-    accelerate_draw = AccelDraw::Disabled;
+    const auto current_instance = system.GPU().Maxwell3D().state.current_instance;
+    Draw(is_indexed, 1, current_instance);
     return true;
 }
 
 bool RasterizerOpenGL::DrawMultiBatch(bool is_indexed) {
-    accelerate_draw = is_indexed ? AccelDraw::Indexed : AccelDraw::Arrays;
-
     MICROPROFILE_SCOPE(OpenGL_Drawing);
+    const auto& maxwell3d = system.GPU().Maxwell3D();
+    const u32 num_instances = maxwell3d.mme_draw.instance_count;
+    Draw(is_indexed, num_instances, num_instances > 1 ? maxwell3d.regs.vb_base_instance : 0);
+    return true;
+}
 
-    DrawPrelude();
-
+void RasterizerOpenGL::Draw(bool is_indexed, u32 num_instances, u32 base_instance) {
     auto& maxwell3d = system.GPU().Maxwell3D();
     const auto& regs = maxwell3d.regs;
-    const auto& draw_setup = maxwell3d.mme_draw;
-    DrawParams draw_call{};
-    draw_call.is_indexed = is_indexed;
-    draw_call.num_instances = static_cast<GLint>(draw_setup.instance_count);
-    draw_call.base_instance = static_cast<GLint>(regs.vb_base_instance);
-    draw_call.is_instanced = draw_setup.instance_count > 1;
-    draw_call.primitive_mode = MaxwellToGL::PrimitiveTopology(regs.draw.topology);
-    if (draw_call.is_indexed) {
-        draw_call.count = static_cast<GLint>(regs.index_array.count);
-        draw_call.base_vertex = static_cast<GLint>(regs.vb_element_base);
-        draw_call.index_format = MaxwellToGL::IndexFormat(regs.index_array.format);
-        draw_call.index_buffer_offset = index_buffer_offset;
+    const GLenum primitive_mode = MaxwellToGL::PrimitiveTopology(regs.draw.topology);
+    const GLenum index_format = is_indexed ? MaxwellToGL::IndexFormat(regs.index_array.format) : 0;
+
+    DrawCommand command{};
+    command.instance_count = num_instances;
+    command.base_instance = base_instance;
+    if (is_indexed) {
+        command.count = regs.index_array.count;
+        command.base_vertex = static_cast<GLint>(regs.vb_element_base);
     } else {
-        draw_call.count = static_cast<GLint>(regs.vertex_buffer.count);
-        draw_call.base_vertex = static_cast<GLint>(regs.vertex_buffer.first);
+        command.count = regs.vertex_buffer.count;
+        command.first = regs.vertex_buffer.first;
+    }
+
+    // Draws that only change their range or instances reuse everything the first draw of the
+    // batch bound, the index data included
+    // Profiled draws are timed on their own
+    const bool is_profiling = system.GPU().Profiler().IsCapturing();
+    const bool same_state = !maxwell3d.dirty.draw_state && !maxwell3d.dirty.memory_general &&
+                            multi_draw_buffer.IsCompatible(primitive_mode, index_format) &&
+                            !is_profiling;
+    maxwell3d.dirty.draw_state = false;
+    maxwell3d.dirty.memory_general = false;
+    if (same_state && (!is_indexed || GetBatchFirstIndex(command.first))) {
+        multi_draw_buffer.Push(command);
+        return;
     }
-    draw_call.DispatchDraw();
+    // Draws that keep moving through the same index buffer can share it if it's uploaded whole
+    upload_whole_index_buffer = same_state;
+    multi_draw_buffer.Flush();
 
-    maxwell3d.dirty.memory_general = false;
+    accelerate_draw = is_indexed ? AccelDraw::Indexed : AccelDraw::Arrays;
+    const bool shaders_ready = DrawPrelude();
     accelerate_draw = AccelDraw::Disabled;
+    if (!shaders_ready) {
+        return;
+    }
+
+    if (is_profiling) {
+        if (state.draw.draw_framebuffer != profile_framebuffer) {
+            profile_framebuffer = state.draw.draw_framebuffer;
+            ++profile_pass;
+        }
+        BeginProfiledWork();
+    }
+    if (is_indexed && !GetBatchFirstIndex(command.first)) {
+        // Index data that is not aligned to its size can't be addressed by a draw command
+        const auto offset = static_cast<GLintptr>(
+            batch_index.offset + (regs.index_array.IndexStart() - batch_index.address));
+        glDrawElementsInstancedBaseVertexBaseInstance(
+            primitive_mode, command.count, index_format, reinterpret_cast<const void*>(offset),
+            command.instance_count, command.base_vertex, command.base_instance);
+    } else {
+        multi_draw_buffer.Begin(primitive_mode, index_format);
+        multi_draw_buffer.Push(command);
+        if (texture_barrier || is_profiling) {
+            // Later draws may read what this one writes and need a barrier of their own, profiled
+            // draws are timed one at a time
+            multi_draw_buffer.Flush();
+        }
+    }
+    if (is_profiling) {
+        EndProfiledWork(profile_shaders);
+    }
+}
+
+bool RasterizerOpenGL::GetBatchFirstIndex(GLuint& first) const {
+    const auto& index_array = system.GPU().Maxwell3D().regs.index_array;
+    const GPUVAddr start = index_array.IndexStart();
+    const std::size_t size = CalculateIndexBufferSize();
+    if (start < batch_index.address || start + size > batch_index.address + batch_index.size) {
+        return false;
+    }
+    const u64 index_size = index_array.FormatSizeInBytes();
+    const u64 offset = static_cast<u64>(batch_index.offset) + (start - batch_index.address);
+    if (offset % index_size != 0) {
+        return false;
+    }
+    first = static_cast<GLuint>(offset / index_size);
     return true;
 }
 
 void RasterizerOpenGL::DispatchCompute(GPUVAddr code_addr) {
+    multi_draw_buffer.Flush();
     if (!GLAD_GL_ARB_compute_variable_group_size) {
         LOG_ERROR(Render_OpenGL, "Compute is currently not supported on this device due to the "
                                  "lack of GL_ARB_compute_variable_group_size");
         return;
     }
 
+    const auto& launch_desc = system.GPU().KeplerCompute().launch_description;
+    const bool is_profiling = system.GPU().Profiler().IsCapturing();
+    if (!is_profiling && IsLastDispatchReusable(code_addr, launch_desc)) {
+        // Only the grid changed, the program and its buffers are still bound
+        state.ApplyShaderProgram();
+        state.ApplyProgramPipeline();
+        glDispatchComputeGroupSizeARB(launch_desc.grid_dim_x, launch_desc.grid_dim_y,
+                                      launch_desc.grid_dim_z, launch_desc.block_dim_x,
+                                      launch_desc.block_dim_y, launch_desc.block_dim_z);
+        return;
+    }
+    last_dispatch.is_valid = false;
+
     auto kernel = shader_cache.GetComputeKernel(code_addr);
     ProgramVariant variant;
     variant.texture_buffer_usage = SetupComputeTextures(kernel);
     SetupComputeImages(kernel);
 
     const auto [program, next_bindings] = kernel->GetProgramHandle(variant);
-    state.draw.shader_program = program.handle;
+    if (!program) {
+        // The kernel is still being built asynchronously
+        return;
+    }
+    state.draw.shader_program = program->handle;
     state.draw.program_pipeline = 0;
 
     const std::size_t buffer_size =
         Tegra::Engines::KeplerCompute::NumConstBuffers *
-        (Maxwell::MaxConstBufferSize + device.GetUniformBufferAlignment());
+            (Maxwell::MaxConstBufferSize + device.GetUniformBufferAlignment()) +
+        MaxTextureHandlesSize + device.GetUniformBufferAlignment();
     buffer_cache.Map(buffer_size);
 
     bind_ubo_pushbuffer.Setup(0);
@@ -787,6 +952,10 @@ void RasterizerOpenGL::DispatchCompute(GPUVAddr code_addr) {
 
     SetupComputeConstBuffers(kernel);
     SetupComputeGlobalMemory(kernel);
+    if (shader_cache.UseBindlessTextures() && !kernel->GetShaderEntries().samplers.empty()) {
+        // The handles block follows the const buffers of the kernel
+        PushTextureHandles();
+    }
 
     buffer_cache.Unmap();
 
@@ -798,10 +967,101 @@ void RasterizerOpenGL::DispatchCompute(GPUVAddr code_addr) {
     state.ApplyShaderProgram();
     state.ApplyProgramPipeline();
 
-    const auto& launch_desc = system.GPU().KeplerCompute().launch_description;
+    SaveLastDispatch(code_addr, kernel, launch_desc);
+    if (is_profiling) {
+        BeginProfiledWork();
+    }
     glDispatchComputeGroupSizeARB(launch_desc.grid_dim_x, launch_desc.grid_dim_y,
                                   launch_desc.grid_dim_z, launch_desc.block_dim_x,
                                   launch_desc.block_dim_y, launch_desc.block_dim_z);
+    if (is_profiling) {
+        EndProfiledWork(fmt::format("CS {:016x}", kernel->GetUniqueIdentifier()));
+    }
+}
+
+bool RasterizerOpenGL::IsLastDispatchReusable(
+    GPUVAddr code_addr, const Tegra::Engines::KeplerCompute::LaunchParams& launch_desc) {
+    if (!last_dispatch.is_valid) {
+        return false;
+    }
+    auto key = launch_desc;
+    key.grid_dim_x.Assign(0);
+    key.grid_dim_y.Assign(0);
+    key.grid_dim_z.Assign(0);
+
+    std::lock_guard lock{last_dispatch_mutex};
+    return last_dispatch.is_valid && last_dispatch.code_addr == code_addr &&
+           std::memcmp(&last_dispatch.launch_desc, &key, sizeof(key)) == 0;
+}
+
+void RasterizerOpenGL::SaveLastDispatch(
+    GPUVAddr code_addr, const Shader& kernel,
+    const Tegra::Engines::KeplerCompute::LaunchParams& launch_desc) {
+    std::lock_guard lock{last_dispatch_mutex};
+    last_dispatch.is_valid = false;
+
+    // Sampled textures and images are looked up through the texture cache on every dispatch
+    const auto& entries = kernel->GetShaderEntries();
+    if (!entries.samplers.empty() || !entries.images.empty()) {
+        return;
+    }
+
+    auto& memory_manager = system.GPU().MemoryManager();
+    auto& inputs = last_dispatch.inputs;
+    inputs.clear();
+    inputs.emplace_back(kernel->GetCacheAddr(), kernel->GetSizeInBytes());
+    const auto add_input = [&](GPUVAddr gpu_addr, std::size_t size) {
+        const CacheAddr addr = ToCacheAddr(memory_manager.GetPointer(gpu_addr));
+        inputs.emplace_back(addr, size);
+        return addr != 0;
+    };
+    const std::bitset<8> cbuf_mask = launch_desc.const_buffer_enable_mask.Value();
+    for (const auto& entry : entries.const_buffers) {
+        const auto& config = launch_desc.const_buffer_config[entry.GetIndex()];
+        if (cbuf_mask[entry.GetIndex()] && !add_input(config.Address(), config.size)) {
+            return;
+        }
+    }
+    const std::size_t num_cbuf_inputs = inputs.size();
+    for (const auto& entry : entries.global_memory_entries) {
+        const auto& config = launch_desc.const_buffer_config[entry.GetCbufIndex()];
+        const GPUVAddr addr = config.Address() + entry.GetCbufOffset();
+        if (!add_input(addr, 12) ||
+            !add_input(memory_manager.Read<u64>(addr), memory_manager.Read<u32>(addr + 8))) {
+            return;
+        }
+        if (!entry.IsWritten()) {
+            continue;
+        }
+        // Const buffers are copied on upload, they would miss the writes of the dispatch
+        const auto [written_addr, written_size] = inputs.back();
+        for (std::size_t i = 1; i < num_cbuf_inputs; ++i) {
+            const auto [cbuf_addr, cbuf_size] = inputs[i];
+            if (written_addr < cbuf_addr + cbuf_size && cbuf_addr < written_addr + written_size) {
+                return;
+            }
+        }
+    }
+
+    last_dispatch.code_addr = code_addr;
+    last_dispatch.launch_desc = launch_desc;
+    last_dispatch.launch_desc.grid_dim_x.Assign(0);
+    last_dispatch.launch_desc.grid_dim_y.Assign(0);
+    last_dispatch.launch_desc.grid_dim_z.Assign(0);
+    last_dispatch.is_valid = true;
+}
+
+void RasterizerOpenGL::InvalidateLastDispatch(CacheAddr addr, u64 size) {
+    if (!last_dispatch.is_valid) {
+        return;
+    }
+    std::lock_guard lock{last_dispatch_mutex};
+    for (const auto [input_addr, input_size] : last_dispatch.inputs) {
+        if (addr < input_addr + input_size && input_addr < addr + size) {
+            last_dispatch.is_valid = false;
+            return;
+        }
+    }
 }
 
 void RasterizerOpenGL::FlushAll() {}
@@ -811,8 +1071,21 @@ void RasterizerOpenGL::FlushRegion(CacheAddr addr, u64 size) {
     if (!addr || !size) {
         return;
     }
+    multi_draw_buffer.Flush();
+    last_dispatch.is_valid = false;
     texture_cache.FlushRegion(addr, size);
     buffer_cache.FlushRegion(addr, size);
+    if (const std::size_t wait_count = GetSemaphoreWaitCount(addr, size); wait_count > 0) {
+        ReleaseSemaphores(wait_count);
+    }
+}
+
+bool RasterizerOpenGL::MustFlushRegion(CacheAddr addr, u64 size) {
+    if (!addr || !size) {
+        return false;
+    }
+    return texture_cache.MustFlushRegion(addr, size) || buffer_cache.MustFlushRegion(addr, size) ||
+           GetSemaphoreWaitCount(addr, size) > 0;
 }
 
 void RasterizerOpenGL::InvalidateRegion(CacheAddr addr, u64 size) {
@@ -823,6 +1096,7 @@ void RasterizerOpenGL::InvalidateRegion(CacheAddr addr, u64 size) {
     texture_cache.InvalidateRegion(addr, size);
     shader_cache.InvalidateRegion(addr, size);
     buffer_cache.InvalidateRegion(addr, size);
+    InvalidateLastDispatch(addr, size);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
@@ -833,23 +1107,195 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
 }
 
 void RasterizerOpenGL::FlushCommands() {
+    multi_draw_buffer.Flush();
     glFlush();
+    ReleaseSemaphores(0);
+}
+
+void RasterizerOpenGL::SignalSemaphore(GPUVAddr addr, const void* data, std::size_t size) {
+    multi_draw_buffer.Flush();
+    auto& memory_manager = system.GPU().MemoryManager();
+    const std::optional<VAddr> cpu_addr = memory_manager.GpuToCpuAddress(addr);
+    const CacheAddr cache_addr = ToCacheAddr(memory_manager.GetPointer(addr));
+    if (!Settings::values.use_accurate_gpu_emulation || !cpu_addr || !cache_addr) {
+        // Pretend the GPU is infinitely fast, the write lands before the guest can look for it.
+        memory_manager.WriteBlock(addr, data, size);
+        return;
+    }
+
+    PendingSemaphore semaphore;
+    ASSERT(size <= semaphore.data.size());
+    semaphore.gpu_addr = addr;
+    semaphore.cpu_addr = *cpu_addr;
+    semaphore.cache_addr = cache_addr;
+    semaphore.size = size;
+    std::memcpy(semaphore.data.data(), data, size);
+    QueueSemaphore(std::move(semaphore));
+}
+
+void RasterizerOpenGL::ResetCounter(VideoCore::QueryType type) {
+    multi_draw_buffer.Flush();
+    query_cache.ResetCounter(type);
+}
+
+void RasterizerOpenGL::Query(GPUVAddr gpu_addr, VideoCore::QueryType type,
+                             std::optional<u64> timestamp) {
+    multi_draw_buffer.Flush();
+    auto& memory_manager = system.GPU().MemoryManager();
+    const std::optional<VAddr> cpu_addr = memory_manager.GpuToCpuAddress(gpu_addr);
+    const CacheAddr cache_addr = ToCacheAddr(memory_manager.GetPointer(gpu_addr));
+
+    // Short queries write the low word of the counter, long ones the counter and a timestamp
+    PendingSemaphore semaphore;
+    semaphore.gpu_addr = gpu_addr;
+    semaphore.size = timestamp ? sizeof(u64) * 2 : sizeof(u32);
+    if (timestamp) {
+        std::memcpy(semaphore.data.data() + sizeof(u64), &*timestamp, sizeof(u64));
+    }
+    semaphore.counter = query_cache.GetCounter(type);
+
+    if (!cpu_addr || !cache_addr) {
+        // Guest reads of the result can't be caught, so it has to be written right away
+        const u64 value = semaphore.counter->Query();
+        std::memcpy(semaphore.data.data(), &value, std::min(semaphore.size, sizeof(u64)));
+        memory_manager.WriteBlock(gpu_addr, semaphore.data.data(), semaphore.size);
+        return;
+    }
+    semaphore.cpu_addr = *cpu_addr;
+    semaphore.cache_addr = cache_addr;
+    QueueSemaphore(std::move(semaphore));
+}
+
+void RasterizerOpenGL::QueueSemaphore(PendingSemaphore semaphore) {
+    semaphore.fence.Create();
+
+    // Route guest reads of the semaphore through FlushRegion until it has been written.
+    UpdatePagesCachedCount(semaphore.cpu_addr, semaphore.size, 1);
+    {
+        std::lock_guard lock{semaphore_mutex};
+        pending_semaphores.push_back(std::move(semaphore));
+    }
+    ReleaseSemaphores(0);
+}
+
+void RasterizerOpenGL::ReleaseSemaphores(std::size_t wait_count) {
+    auto& memory_manager = system.GPU().MemoryManager();
+    std::lock_guard lock{semaphore_mutex};
+    while (!pending_semaphores.empty()) {
+        PendingSemaphore& semaphore = pending_semaphores.front();
+        const bool wait = wait_count > 0;
+        const GLenum result =
+            glClientWaitSync(semaphore.fence.handle, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                             wait ? std::numeric_limits<GLuint64>::max() : 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        if (semaphore.counter) {
+            // The fence covers the end of the query, reading its result doesn't block anymore
+            const u64 value = semaphore.counter->Query();
+            std::memcpy(semaphore.data.data(), &value, std::min(semaphore.size, sizeof(u64)));
+        }
+        memory_manager.WriteBlock(semaphore.gpu_addr, semaphore.data.data(), semaphore.size);
+        UpdatePagesCachedCount(semaphore.cpu_addr, semaphore.size, -1);
+        pending_semaphores.pop_front();
+        if (wait) {
+            --wait_count;
+        }
+    }
+}
+
+std::size_t RasterizerOpenGL::GetSemaphoreWaitCount(CacheAddr addr, u64 size) {
+    std::lock_guard lock{semaphore_mutex};
+    for (std::size_t index = pending_semaphores.size(); index > 0; --index) {
+        const PendingSemaphore& semaphore = pending_semaphores[index - 1];
+        if (semaphore.cache_addr < addr + size && addr < semaphore.cache_addr + semaphore.size) {
+            return index;
+        }
+    }
+    return 0;
 }
 
 void RasterizerOpenGL::TickFrame() {
+    multi_draw_buffer.Flush();
+    last_dispatch.is_valid = false;
+    ResolveProfiledWork();
     buffer_cache.TickFrame();
+    shader_cache.TickFrame();
+    texture_cache.TickFrame();
+    framebuffer_cache.TickFrame();
+    ReleaseSemaphores(0);
 }
 
 bool RasterizerOpenGL::AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
                                              const Tegra::Engines::Fermi2D::Regs::Surface& dst,
                                              const Tegra::Engines::Fermi2D::Config& copy_config) {
     MICROPROFILE_SCOPE(OpenGL_Blits);
+    multi_draw_buffer.Flush();
+    last_dispatch.is_valid = false;
     texture_cache.DoFermiCopy(src, dst, copy_config);
     return true;
 }
 
+bool RasterizerOpenGL::AccelerateDMACopy(GPUVAddr dest, GPUVAddr source, std::size_t size) {
+    auto& memory_manager = system.GPU().MemoryManager();
+    const CacheAddr dest_addr = ToCacheAddr(memory_manager.GetPointer(dest));
+    const CacheAddr source_addr = ToCacheAddr(memory_manager.GetPointer(source));
+    if (!dest_addr || !source_addr || size == 0) {
+        return false;
+    }
+    // Copies from guest memory are cheaper on the CPU, only copy buffers written by the host GPU
+    if (!buffer_cache.MustFlushRegion(source_addr, size) ||
+        (dest_addr < source_addr + size && source_addr < dest_addr + size)) {
+        return false;
+    }
+    MICROPROFILE_SCOPE(OpenGL_Blits);
+    multi_draw_buffer.Flush();
+    last_dispatch.is_valid = false;
+
+    texture_cache.FlushRegion(source_addr, size);
+    texture_cache.InvalidateRegion(dest_addr, size);
+    shader_cache.InvalidateRegion(dest_addr, size);
+
+    // The destination is marked as modified, guest memory gets the data when it's flushed
+    InvalidateCachedConstBuffers();
+    const auto [source_buffer, source_offset] = buffer_cache.UploadMemory(source, size);
+    const auto [dest_buffer, dest_offset] = buffer_cache.UploadMemory(dest, size, 4, true);
+    glCopyNamedBufferSubData(*source_buffer, *dest_buffer, static_cast<GLintptr>(source_offset),
+                             static_cast<GLintptr>(dest_offset), static_cast<GLsizeiptr>(size));
+    return true;
+}
+
+bool RasterizerOpenGL::AccelerateInlineToMemory(GPUVAddr address, std::size_t copy_size,
+                                                const u8* data) {
+    auto& memory_manager = system.GPU().MemoryManager();
+    const CacheAddr dest_addr = ToCacheAddr(memory_manager.GetPointer(address));
+    if (!dest_addr || copy_size == 0) {
+        return false;
+    }
+    // Writing guest memory is cheaper unless the destination is in a buffer written by the host
+    // GPU, those would have to be flushed before and uploaded again after the write
+    if (!buffer_cache.MustFlushRegion(dest_addr, copy_size)) {
+        return false;
+    }
+    MICROPROFILE_SCOPE(OpenGL_Blits);
+    multi_draw_buffer.Flush();
+    last_dispatch.is_valid = false;
+
+    texture_cache.InvalidateRegion(dest_addr, copy_size);
+    shader_cache.InvalidateRegion(dest_addr, copy_size);
+
+    // The buffer stays marked as modified, guest memory gets the data when it's flushed
+    InvalidateCachedConstBuffers();
+    const auto [buffer, offset] = buffer_cache.UploadMemory(address, copy_size, 4, true);
+    glNamedBufferSubData(*buffer, static_cast<GLintptr>(offset),
+                         static_cast<GLsizeiptr>(copy_size), data);
+    return true;
+}
+
 bool RasterizerOpenGL::AccelerateDisplay(const Tegra::FramebufferConfig& config,
                                          VAddr framebuffer_addr, u32 pixel_stride) {
+    multi_draw_buffer.Flush();
+    last_dispatch.is_valid = false;
     if (!framebuffer_addr) {
         return {};
     }
@@ -884,9 +1330,10 @@ void RasterizerOpenGL::SetupDrawConstBuffers(Tegra::Engines::Maxwell3D::Regs::Sh
     MICROPROFILE_SCOPE(OpenGL_UBO);
     const auto& stages = system.GPU().Maxwell3D().state.shader_stages;
     const auto& shader_stage = stages[static_cast<std::size_t>(stage)];
+    auto& cached_stage = cached_draw_const_buffers[static_cast<std::size_t>(stage)];
     for (const auto& entry : shader->GetShaderEntries().const_buffers) {
         const auto& buffer = shader_stage.const_buffers[entry.GetIndex()];
-        SetupConstBuffer(buffer, entry);
+        SetupConstBuffer(buffer, entry, cached_stage[entry.GetIndex()]);
     }
 }
 
@@ -900,12 +1347,13 @@ void RasterizerOpenGL::SetupComputeConstBuffers(const Shader& kernel) {
         buffer.address = config.Address();
         buffer.size = config.size;
         buffer.enabled = mask[entry.GetIndex()];
-        SetupConstBuffer(buffer, entry);
+        SetupConstBuffer(buffer, entry, cached_compute_const_buffers[entry.GetIndex()]);
     }
 }
 
 void RasterizerOpenGL::SetupConstBuffer(const Tegra::Engines::ConstBufferInfo& buffer,
-                                        const GLShader::ConstBufferEntry& entry) {
+                                        const GLShader::ConstBufferEntry& entry,
+                                        CachedConstBuffer& cached) {
     if (!buffer.enabled) {
         // Set values to zero to unbind buffers
         bind_ubo_pushbuffer.Push(buffer_cache.GetEmptyBuffer(sizeof(float)), 0, sizeof(float));
@@ -916,9 +1364,34 @@ void RasterizerOpenGL::SetupConstBuffer(const Tegra::Engines::ConstBufferInfo& b
     // UBO alignment requirements.
     const std::size_t size = Common::AlignUp(GetConstBufferSize(buffer, entry), sizeof(GLvec4));
 
+    // Bind the previous copy again when nothing could have changed it
+    const u64 memory_generation = system.GPU().Maxwell3D().dirty.memory_generation;
+    const u64 stream_generation = buffer_cache.GetStreamGeneration();
+    if (cached.buffer && cached.address == buffer.address && cached.size == size &&
+        cached.memory_generation == memory_generation &&
+        cached.stream_generation == stream_generation) {
+        bind_ubo_pushbuffer.Push(cached.buffer, cached.offset, size);
+        return;
+    }
+
     const auto alignment = device.GetUniformBufferAlignment();
-    const auto [cbuf, offset] = buffer_cache.UploadMemory(buffer.address, size, alignment);
+    const auto info = buffer_cache.UploadMemory(buffer.address, size, alignment);
+    const auto [cbuf, offset] = info;
     bind_ubo_pushbuffer.Push(cbuf, offset, size);
+
+    // Buffers kept in cached blocks are already tracked by the buffer cache
+    if (buffer_cache.IsStreamed(info)) {
+        cached = {buffer.address, size, memory_generation, stream_generation, cbuf, offset};
+    } else {
+        cached = {};
+    }
+}
+
+void RasterizerOpenGL::InvalidateCachedConstBuffers() {
+    for (auto& stage : cached_draw_const_buffers) {
+        stage.fill({});
+    }
+    cached_compute_const_buffers.fill({});
 }
 
 void RasterizerOpenGL::SetupDrawGlobalMemory(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage,
@@ -949,6 +1422,9 @@ void RasterizerOpenGL::SetupComputeGlobalMemory(const Shader& kernel) {
 void RasterizerOpenGL::SetupGlobalMemory(const GLShader::GlobalMemoryEntry& entry,
                                          GPUVAddr gpu_addr, std::size_t size) {
     const auto alignment{device.GetShaderStorageBufferAlignment()};
+    if (entry.IsWritten()) {
+        InvalidateCachedConstBuffers();
+    }
     const auto [ssbo, buffer_offset] =
         buffer_cache.UploadMemory(gpu_addr, size, alignment, entry.IsWritten());
     bind_ssbo_pushbuffer.Push(ssbo, buffer_offset, static_cast<GLsizeiptr>(size));
@@ -961,11 +1437,14 @@ TextureBufferUsage RasterizerOpenGL::SetupDrawTextures(Maxwell::ShaderStage stag
     const auto& gpu = system.GPU();
     const auto& maxwell3d = gpu.Maxwell3D();
     const auto& entries = shader->GetShaderEntries().samplers;
+    const bool bindless_textures = shader_cache.UseBindlessTextures();
 
-    ASSERT_MSG(base_bindings.sampler + entries.size() <= std::size(state.textures),
+    ASSERT_MSG(bindless_textures ||
+                   base_bindings.sampler + entries.size() <= std::size(state.textures),
                "Exceeded the number of active textures.");
 
     TextureBufferUsage texture_buffer_usage{0};
+    texture_handles.clear();
 
     for (u32 bindpoint = 0; bindpoint < entries.size(); ++bindpoint) {
         const auto& entry = entries[bindpoint];
@@ -984,6 +1463,10 @@ TextureBufferUsage RasterizerOpenGL::SetupDrawTextures(Maxwell::ShaderStage stag
         }
     }
 
+    if (bindless_textures && !entries.empty()) {
+        // The handles block follows the const buffers of the stage
+        PushTextureHandles();
+    }
     return texture_buffer_usage;
 }
 
@@ -992,10 +1475,11 @@ TextureBufferUsage RasterizerOpenGL::SetupComputeTextures(const Shader& kernel)
     const auto& compute = system.GPU().KeplerCompute();
     const auto& entries = kernel->GetShaderEntries().samplers;
 
-    ASSERT_MSG(entries.size() <= std::size(state.textures),
+    ASSERT_MSG(shader_cache.UseBindlessTextures() || entries.size() <= std::size(state.textures),
                "Exceeded the number of active textures.");
 
     TextureBufferUsage texture_buffer_usage{0};
+    texture_handles.clear();
 
     for (u32 bindpoint = 0; bindpoint < entries.size(); ++bindpoint) {
         const auto& entry = entries[bindpoint];
@@ -1019,6 +1503,11 @@ TextureBufferUsage RasterizerOpenGL::SetupComputeTextures(const Shader& kernel)
 
 bool RasterizerOpenGL::SetupTexture(u32 binding, const Tegra::Texture::FullTextureInfo& texture,
                                     const GLShader::SamplerEntry& entry) {
+    if (shader_cache.UseBindlessTextures()) {
+        return SetupBindlessTexture(texture, entry);
+    }
+
+    state.MarkDirtyTexture(binding);
     state.samplers[binding] = sampler_cache.GetSampler(texture.tsc);
 
     const auto view = texture_cache.GetTextureSurface(texture.tic, entry);
@@ -1039,6 +1528,43 @@ bool RasterizerOpenGL::SetupTexture(u32 binding, const Tegra::Texture::FullTextu
     return false;
 }
 
+bool RasterizerOpenGL::SetupBindlessTexture(const Tegra::Texture::FullTextureInfo& texture,
+                                            const GLShader::SamplerEntry& entry) {
+    const auto view = texture_cache.GetTextureSurface(texture.tic, entry);
+    if (!view) {
+        // Can occur when texture addr is null or its memory is unmapped/invalid
+        texture_handles.push_back(GetNullTextureHandle(entry));
+        return false;
+    }
+    const GLuint sampler = sampler_cache.GetSampler(texture.tsc);
+    texture_handles.push_back(view->GetBindlessHandle(sampler, texture.tic.x_source,
+                                                      texture.tic.y_source, texture.tic.z_source,
+                                                      texture.tic.w_source));
+    return view->GetSurfaceParams().IsBuffer();
+}
+
+GLuint64 RasterizerOpenGL::GetNullTextureHandle(const GLShader::SamplerEntry& entry) {
+    const GLenum target = GetSamplerTarget(entry);
+    auto& null_texture = null_textures[{target, entry.IsShadow()}];
+    if (null_texture.handle == 0) {
+        null_texture.texture = CreateNullTexture(target, entry.IsShadow());
+        null_texture.handle = glGetTextureHandleARB(null_texture.texture.handle);
+        glMakeTextureHandleResidentARB(null_texture.handle);
+    }
+    return null_texture.handle;
+}
+
+void RasterizerOpenGL::PushTextureHandles() {
+    // Handles are packed 8 bytes apart in the std140 block, its size is rounded like a cbuf's
+    const std::size_t size =
+        Common::AlignUp(texture_handles.size() * sizeof(GLuint64), sizeof(GLvec4));
+    ASSERT_MSG(size <= MaxTextureHandlesSize, "Exceeded the number of bindless textures.");
+    texture_handles.resize(size / sizeof(GLuint64));
+    const auto [buffer, offset] = buffer_cache.UploadHostMemory(
+        texture_handles.data(), size, device.GetUniformBufferAlignment());
+    bind_ubo_pushbuffer.Push(buffer, offset, size);
+}
+
 void RasterizerOpenGL::SetupComputeImages(const Shader& shader) {
     const auto& compute = system.GPU().KeplerCompute();
     const auto& entries = shader->GetShaderEntries().images;
@@ -1059,6 +1585,7 @@ void RasterizerOpenGL::SetupComputeImages(const Shader& shader) {
 
 void RasterizerOpenGL::SetupImage(u32 binding, const Tegra::Texture::TICEntry& tic,
                                   const GLShader::ImageEntry& entry) {
+    state.MarkDirtyImage(binding);
     const auto view = texture_cache.GetImageSurface(tic, entry);
     if (!view) {
         state.images[binding] = 0;
@@ -1081,6 +1608,7 @@ void RasterizerOpenGL::SyncViewport(OpenGLState& current_state, bool rescaling)
         geometry_shaders_enabled ? Tegra::Engines::Maxwell3D::Regs::NumViewports : 1;
     const float factor = rescaling ? Settings::values.resolution_factor : 1.0f;
     for (std::size_t i = 0; i < viewport_count; i++) {
+        current_state.MarkDirtyViewport(i);
         auto& viewport = current_state.viewports[i];
         const auto& src = regs.viewports[i];
         const Common::Rectangle<s32> viewport_rect{regs.viewport_transform[i].GetRect()};
@@ -1116,6 +1644,14 @@ void RasterizerOpenGL::SyncClipCoef() {
 
 void RasterizerOpenGL::SyncCullMode() {
     auto& maxwell3d = system.GPU().Maxwell3D();
+    auto& dirty = maxwell3d.dirty;
+    // The front face also depends on the screen y control and on the first viewport transform.
+    if (!dirty.cull_mode && !dirty.screen_y_control && !dirty.viewport_transform) {
+        return;
+    }
+    dirty.cull_mode = false;
+    dirty.screen_y_control = false;
+    dirty.viewport_transform = false;
 
     const auto& regs = maxwell3d.regs;
 
@@ -1140,14 +1676,26 @@ void RasterizerOpenGL::SyncCullMode() {
 }
 
 void RasterizerOpenGL::SyncPrimitiveRestart() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.dirty.primitive_restart) {
+        return;
+    }
+    maxwell3d.dirty.primitive_restart = false;
+
+    const auto& regs = maxwell3d.regs;
 
     state.primitive_restart.enabled = regs.primitive_restart.enabled;
     state.primitive_restart.index = regs.primitive_restart.index;
 }
 
 void RasterizerOpenGL::SyncDepthTestState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.dirty.depth_test) {
+        return;
+    }
+    maxwell3d.dirty.depth_test = false;
+
+    const auto& regs = maxwell3d.regs;
 
     state.depth.test_enabled = regs.depth_test_enable != 0;
     state.depth.write_mask = regs.depth_write_enabled ? GL_TRUE : GL_FALSE;
@@ -1223,13 +1771,25 @@ void RasterizerOpenGL::SyncColorMask() {
 }
 
 void RasterizerOpenGL::SyncMultiSampleState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.dirty.multisample_control) {
+        return;
+    }
+    maxwell3d.dirty.multisample_control = false;
+
+    const auto& regs = maxwell3d.regs;
     state.multisample_control.alpha_to_coverage = regs.multisample_control.alpha_to_coverage != 0;
     state.multisample_control.alpha_to_one = regs.multisample_control.alpha_to_one != 0;
 }
 
 void RasterizerOpenGL::SyncFragmentColorClampState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.dirty.fragment_color_clamp) {
+        return;
+    }
+    maxwell3d.dirty.fragment_color_clamp = false;
+
+    const auto& regs = maxwell3d.regs;
     state.fragment_color_clamp.enabled = regs.frag_color_clamp != 0;
 }
 
@@ -1285,7 +1845,13 @@ void RasterizerOpenGL::SyncBlendState() {
 }
 
 void RasterizerOpenGL::SyncLogicOpState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.dirty.logic_op) {
+        return;
+    }
+    maxwell3d.dirty.logic_op = false;
+
+    const auto& regs = maxwell3d.regs;
 
     state.logic_op.enabled = regs.logic_op.enable != 0;
 
@@ -1306,6 +1872,7 @@ void RasterizerOpenGL::SyncScissorTest(OpenGLState& current_state, bool rescalin
         geometry_shaders_enabled ? Tegra::Engines::Maxwell3D::Regs::NumViewports : 1;
     const float factor = rescaling ? Settings::values.resolution_factor : 1.0f;
     for (std::size_t i = 0; i < viewport_count; i++) {
+        current_state.MarkDirtyViewport(i);
         const auto& src = regs.scissor_test[i];
         auto& dst = current_state.viewports[i].scissor;
         dst.enabled = (src.enable != 0);
@@ -1327,7 +1894,13 @@ void RasterizerOpenGL::SyncTransformFeedback() {
 }
 
 void RasterizerOpenGL::SyncPointState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.dirty.point_size) {
+        return;
+    }
+    maxwell3d.dirty.point_size = false;
+
+    const auto& regs = maxwell3d.regs;
     // Limit the point size to 1 since nouveau sometimes sets a point size of 0 (and that's invalid
     // in OpenGL).
     state.point.size = std::max(1.0f, regs.point_size);
@@ -1352,7 +1925,13 @@ void RasterizerOpenGL::SyncPolygonOffset() {
 }
 
 void RasterizerOpenGL::SyncAlphaTest() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.dirty.alpha_test) {
+        return;
+    }
+    maxwell3d.dirty.alpha_test = false;
+
+    const auto& regs = maxwell3d.regs;
     UNIMPLEMENTED_IF_MSG(regs.alpha_test_enabled != 0 && regs.rt_control.count > 1,
                          "Alpha Testing is enabled with more than one rendertarget");
 
@@ -7,23 +7,30 @@
 #include <array>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
-#include <boost/icl/interval_map.hpp>
 #include <glad/glad.h>
 
 #include "common/common_types.h"
+#include "common/virtual_buffer.h"
 #include "video_core/engines/const_buffer_info.h"
+#include "video_core/engines/kepler_compute.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_opengl/gl_buffer_cache.h"
 #include "video_core/renderer_opengl/gl_device.h"
 #include "video_core/renderer_opengl/gl_framebuffer_cache.h"
+#include "video_core/renderer_opengl/gl_multi_draw.h"
+#include "video_core/renderer_opengl/gl_query_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_sampler_cache.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
@@ -63,20 +70,60 @@ public:
     void DispatchCompute(GPUVAddr code_addr) override;
     void FlushAll() override;
     void FlushRegion(CacheAddr addr, u64 size) override;
+    bool MustFlushRegion(CacheAddr addr, u64 size) override;
     void InvalidateRegion(CacheAddr addr, u64 size) override;
     void FlushAndInvalidateRegion(CacheAddr addr, u64 size) override;
     void FlushCommands() override;
+    void SignalSemaphore(GPUVAddr addr, const void* data, std::size_t size) override;
+    void ResetCounter(VideoCore::QueryType type) override;
+    void Query(GPUVAddr gpu_addr, VideoCore::QueryType type,
+               std::optional<u64> timestamp) override;
     void TickFrame() override;
     bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
                                const Tegra::Engines::Fermi2D::Regs::Surface& dst,
                                const Tegra::Engines::Fermi2D::Config& copy_config) override;
+    bool AccelerateDMACopy(GPUVAddr dest, GPUVAddr source, std::size_t size) override;
+    bool AccelerateInlineToMemory(GPUVAddr address, std::size_t copy_size,
+                                  const u8* data) override;
     bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
                            u32 pixel_stride) override;
     void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) override;
+    void PrefetchDiskResources(u64 title_id) override;
     void LoadDiskResources(const std::atomic_bool& stop_loading,
                            const VideoCore::DiskResourceLoadCallback& callback) override;
+    VideoCore::RasterizerStatistics GetStatistics() const override;
 
 private:
+    /// Guest memory write waiting for the host GPU to catch up with the commands before it.
+    struct PendingSemaphore {
+        OGLSync fence;
+        GPUVAddr gpu_addr{};
+        VAddr cpu_addr{};
+        CacheAddr cache_addr{};
+        std::size_t size{};
+        std::array<u8, 16> data{};
+        std::shared_ptr<HostCounter> counter; ///< Its value is written over the start of data
+    };
+
+    /// Queues a write to GPU memory behind a fence of the commands recorded so far.
+    void QueueSemaphore(PendingSemaphore semaphore);
+
+    /// Writes the pending semaphores in order, waiting for the first wait_count of them and
+    /// stopping at the first unsignaled fence after that.
+    void ReleaseSemaphores(std::size_t wait_count);
+
+    /// Returns how many pending semaphores have to be released to cover the region.
+    std::size_t GetSemaphoreWaitCount(CacheAddr addr, u64 size);
+
+    /// Writes a timestamp before the draw or dispatch about to be recorded.
+    void BeginProfiledWork();
+
+    /// Writes a timestamp after the recorded work, it's profiled under the given shader names.
+    void EndProfiledWork(std::string name);
+
+    /// Hands the timings of the frame to the GPU profiler, waiting for the host GPU.
+    void ResolveProfiledWork();
+
     /// Configures the color and depth framebuffer states.
     void ConfigureFramebuffers();
 
@@ -90,9 +137,23 @@ private:
     /// Configures the current constbuffers to use for the kernel invocation.
     void SetupComputeConstBuffers(const Shader& kernel);
 
+    /// Const buffer copied to the stream buffer, reused by later draws while its memory and the
+    /// stream buffer stay unchanged.
+    struct CachedConstBuffer {
+        GPUVAddr address{};
+        std::size_t size{};
+        u64 memory_generation{};
+        u64 stream_generation{};
+        const GLuint* buffer{};
+        u64 offset{};
+    };
+
     /// Configures a constant buffer.
     void SetupConstBuffer(const Tegra::Engines::ConstBufferInfo& buffer,
-                          const GLShader::ConstBufferEntry& entry);
+                          const GLShader::ConstBufferEntry& entry, CachedConstBuffer& cached);
+
+    /// Forgets the cached const buffers, their memory may have been written by the host GPU.
+    void InvalidateCachedConstBuffers();
 
     /// Configures the current global memory entries to use for the draw command.
     void SetupDrawGlobalMemory(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage,
@@ -101,12 +162,32 @@ private:
     /// Configures the current global memory entries to use for the kernel invocation.
     void SetupComputeGlobalMemory(const Shader& kernel);
 
+    /// Returns true when the last dispatch only differs from the next one in its grid size.
+    bool IsLastDispatchReusable(GPUVAddr code_addr,
+                                const Tegra::Engines::KeplerCompute::LaunchParams& launch_desc);
+
+    /// Saves the guest memory read by a dispatch whose bindings can be reused.
+    void SaveLastDispatch(GPUVAddr code_addr, const Shader& kernel,
+                          const Tegra::Engines::KeplerCompute::LaunchParams& launch_desc);
+
+    /// Forgets the last dispatch when the given range overlaps memory it read.
+    void InvalidateLastDispatch(CacheAddr addr, u64 size);
+
     /// Configures a constant buffer.
     void SetupGlobalMemory(const GLShader::GlobalMemoryEntry& entry, GPUVAddr gpu_addr,
                            std::size_t size);
 
+    /// Adds a draw to the open batch when nothing but its parameters changed, otherwise syncs the
+    /// state and opens a new batch with it.
+    void Draw(bool is_indexed, u32 num_instances, u32 base_instance);
+
+    /// Returns in first where the indices of the draw start in the index buffer of the batch,
+    /// fails when they were not uploaded with it.
+    bool GetBatchFirstIndex(GLuint& first) const;
+
     /// Syncs all the state, shaders, render targets and textures setting before a draw call.
-    void DrawPrelude();
+    /// Returns false when a shader program is not ready and the draw has to be skipped.
+    bool DrawPrelude();
 
     /// Configures the current textures to use for the draw command. Returns shaders texture buffer
     /// usage.
@@ -120,6 +201,18 @@ private:
     bool SetupTexture(u32 binding, const Tegra::Texture::FullTextureInfo& texture,
                       const GLShader::SamplerEntry& entry);
 
+    /// Appends the resident handle of a texture to the handles of the program. Returns true when
+    /// the texture is a texture buffer.
+    bool SetupBindlessTexture(const Tegra::Texture::FullTextureInfo& texture,
+                              const GLShader::SamplerEntry& entry);
+
+    /// Returns the handle of an empty texture sampled in place of textures that can't be found.
+    GLuint64 GetNullTextureHandle(const GLShader::SamplerEntry& entry);
+
+    /// Uploads the texture handles of the program set up last and binds them to the next uniform
+    /// block binding.
+    void PushTextureHandles();
+
     /// Configures images in a compute shader.
     void SetupComputeImages(const Shader& shader);
 
@@ -187,6 +280,7 @@ private:
     OpenGLState state;
 
     TextureCacheOpenGL texture_cache;
+    QueryCache query_cache;
     ShaderCacheOpenGL shader_cache;
     SamplerCacheOpenGL sampler_cache;
     FramebufferCacheOpenGL framebuffer_cache;
@@ -201,35 +295,97 @@ private:
         vertex_array_cache;
 
     static constexpr std::size_t STREAM_BUFFER_SIZE = 128 * 1024 * 1024;
+    /// Widest guest address space, bounds the pages tracked by the cached page counters
+    static constexpr std::size_t MAX_ADDRESS_SPACE_BITS = 39;
     OGLBufferCache buffer_cache;
 
     VertexArrayPushBuffer vertex_array_pushbuffer;
     BindBuffersRangePushBuffer bind_ubo_pushbuffer{GL_UNIFORM_BUFFER};
     BindBuffersRangePushBuffer bind_ssbo_pushbuffer{GL_SHADER_STORAGE_BUFFER};
 
+    std::array<std::array<CachedConstBuffer, Tegra::Engines::Maxwell3D::Regs::MaxConstBuffers>,
+               Tegra::Engines::Maxwell3D::Regs::MaxShaderStage>
+        cached_draw_const_buffers{};
+    std::array<CachedConstBuffer, Tegra::Engines::KeplerCompute::NumConstBuffers>
+        cached_compute_const_buffers{};
+
+    /// Bytes of bindless handles a program reads at most, one for each texture unit of a stage
+    static constexpr std::size_t MaxTextureHandlesSize =
+        Tegra::Engines::Maxwell3D::Regs::NumTextureSamplers * sizeof(GLuint64);
+    std::vector<GLuint64> texture_handles; ///< Handles of the program being set up
+
+    struct NullTexture {
+        OGLTexture texture;
+        GLuint64 handle = 0;
+    };
+    std::map<std::pair<GLenum, bool>, NullTexture> null_textures; ///< By target and shadow
+
     std::size_t CalculateVertexArraysSize() const;
 
     std::size_t CalculateIndexBufferSize() const;
 
+    /// Returns the guest range of index data uploaded for the draw.
+    std::pair<GPUVAddr, std::size_t> GetIndexBufferRange() const;
+
     /// Updates and returns a vertex array object representing current vertex format
     GLuint SetupVertexFormat();
 
     void SetupVertexBuffer(GLuint vao);
     void SetupVertexInstances(GLuint vao);
 
-    GLintptr SetupIndexBuffer();
+    void SetupIndexBuffer();
+
+    /// Index buffers up to this size are uploaded whole while draws are being batched.
+    static constexpr std::size_t MaxBatchIndexBufferSize = 256 * 1024;
+
+    /// Index data bound for the open batch of draws.
+    struct {
+        GPUVAddr address{};
+        std::size_t size{};
+        GLintptr offset{};
+    } batch_index;
+
+    bool upload_whole_index_buffer = false;
+    bool texture_barrier = false; ///< The last draw prelude issued a texture barrier
 
-    GLintptr index_buffer_offset;
+    MultiDrawBuffer multi_draw_buffer;
 
-    void SetupShaders(GLenum primitive_mode);
+    /// Binds the shader programs of the draw, returns false when one of them is still being built.
+    bool SetupShaders(GLenum primitive_mode);
 
     enum class AccelDraw { Disabled, Arrays, Indexed };
     AccelDraw accelerate_draw = AccelDraw::Disabled;
 
     OGLFramebuffer clear_framebuffer;
 
-    using CachedPageMap = boost::icl::interval_map<u64, int>;
-    CachedPageMap cached_pages;
+    /// Host GPU timestamps around a draw or a dispatch, read at the end of the frame
+    struct ProfiledWork {
+        std::string name;
+        u32 pass{};
+        OGLQuery start;
+        OGLQuery end;
+    };
+    std::vector<ProfiledWork> profiled_work;
+    OGLQuery profile_start;
+    std::string profile_shaders;    ///< Shaders bound by the last draw prelude
+    GLuint profile_framebuffer = 0; ///< Draw framebuffer of the profiled pass
+    u32 profile_pass = 0;
+
+    /// Number of cached objects on each guest page, pages are marked as cached while non-zero
+    Common::VirtualBuffer<u16> cached_pages;
+    std::mutex cached_pages_mutex; ///< Semaphores are released from the CPU thread as well
+
+    std::deque<PendingSemaphore> pending_semaphores;
+    std::mutex semaphore_mutex; ///< Guards the pending semaphores from the CPU thread
+
+    /// Bindings of the last compute dispatch, still bound while nothing else touched the GL state
+    struct {
+        std::atomic_bool is_valid{};
+        GPUVAddr code_addr{};
+        Tegra::Engines::KeplerCompute::LaunchParams launch_desc{}; ///< Grid size cleared
+        std::vector<std::pair<CacheAddr, std::size_t>> inputs;     ///< Guest memory it read
+    } last_dispatch;
+    std::mutex last_dispatch_mutex; ///< Guards the dispatch inputs from the CPU thread
 };
 
 } // namespace OpenGL
@@ -2,20 +2,28 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
 #include <mutex>
 #include <thread>
 #include <boost/functional/hash.hpp>
 #include "common/assert.h"
 #include "common/hash.h"
 #include "common/scope_exit.h"
+#include "common/thread.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
+#include "core/settings.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
 #include "video_core/renderer_opengl/gl_shader_decompiler.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+#include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/utils.h"
 #include "video_core/shader/shader_ir.h"
 
@@ -82,6 +90,7 @@ constexpr std::tuple<const char*, const char*, u32> GetPrimitiveDescription(GLen
     case GL_POINTS:
         return {"points", "Points", 1};
     case GL_LINES:
+    case GL_LINE_LOOP:
     case GL_LINE_STRIP:
         return {"lines", "Lines", 2};
     case GL_LINES_ADJACENCY:
@@ -201,9 +210,41 @@ GLShader::ProgramResult CreateProgram(const Device& device, ProgramType program_
     }
 }
 
+/// Returns the uniform blocks a program binds, bindless textures take one after the const buffers
+u32 GetNumUniformBlocks(const GLShader::ShaderEntries& entries, bool bindless_textures) {
+    const bool has_bindless_block = bindless_textures && !entries.samplers.empty();
+    return static_cast<u32>(entries.const_buffers.size()) + (has_bindless_block ? 1 : 0);
+}
+
+/// Clears the fields of a variant the program doesn't read, states that only differ in them share
+/// the same program
+ProgramVariant MinimizeVariant(ProgramVariant variant, const GLShader::ShaderEntries& entries,
+                               ProgramType program_type, bool bindless_textures) {
+    auto& base_bindings = variant.base_bindings;
+    if (GetNumUniformBlocks(entries, bindless_textures) == 0) {
+        base_bindings.cbuf = 0;
+    }
+    if (entries.global_memory_entries.empty()) {
+        base_bindings.gmem = 0;
+    }
+    if (entries.samplers.empty() || bindless_textures) {
+        base_bindings.sampler = 0;
+    }
+    if (entries.images.empty()) {
+        base_bindings.image = 0;
+    }
+    if (program_type != ProgramType::Geometry) {
+        variant.primitive_mode = {};
+    }
+    return variant;
+}
+
+/// Builds a host program for a variant, guest programs are accounted in the build statistics
 CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEntries& entries,
                                ProgramType program_type, const ProgramVariant& variant,
+                               bool bindless_textures, ShaderBuildStatistics* build_statistics,
                                bool hint_retrievable = false) {
+    const auto build_start = std::chrono::steady_clock::now();
     auto base_bindings{variant.base_bindings};
     const auto primitive_mode{variant.primitive_mode};
     const auto texture_buffer_usage{variant.texture_buffer_usage};
@@ -219,6 +260,9 @@ CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEn
     if (program_type == ProgramType::Compute) {
         source += "#extension GL_ARB_compute_variable_group_size : require\n";
     }
+    if (bindless_textures) {
+        source += "#extension GL_ARB_bindless_texture : require\n";
+    }
     source += '\n';
 
     for (const auto& cbuf : entries.const_buffers) {
@@ -229,9 +273,14 @@ CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEn
         source += fmt::format("#define GMEM_BINDING_{}_{} {}\n", gmem.GetCbufIndex(),
                               gmem.GetCbufOffset(), base_bindings.gmem++);
     }
-    for (const auto& sampler : entries.samplers) {
-        source += fmt::format("#define SAMPLER_BINDING_{} {}\n", sampler.GetIndex(),
-                              base_bindings.sampler++);
+    if (bindless_textures && !entries.samplers.empty()) {
+        source += "#define BINDLESS_TEXTURES\n";
+        source += fmt::format("#define BINDLESS_TEXTURES_BINDING {}\n", base_bindings.cbuf++);
+    } else {
+        for (const auto& sampler : entries.samplers) {
+            source += fmt::format("#define SAMPLER_BINDING_{} {}\n", sampler.GetIndex(),
+                                  base_bindings.sampler++);
+        }
     }
     for (const auto& image : entries.images) {
         source +=
@@ -269,6 +318,10 @@ CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEn
     auto program = std::make_shared<GLShader::StageProgram>();
     program->Create(true, hint_retrievable, shader.handle);
     program->SetUniformLocations();
+    program->AccountProgramSize();
+    if (build_statistics) {
+        build_statistics->Record(std::chrono::steady_clock::now() - build_start);
+    }
     return program;
 }
 
@@ -286,14 +339,107 @@ std::set<GLenum> GetSupportedFormats() {
     return supported_formats;
 }
 
+/// Number of threads building programs asynchronously, each one holds its own context
+std::size_t GetNumAsyncShaderWorkers() {
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency() / 4, 1, 4);
+}
+
 } // Anonymous namespace
 
+AsyncShaderBuilder::AsyncShaderBuilder(
+    std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts_,
+    ShaderBuildStatistics& build_statistics, bool bindless_textures)
+    : build_statistics{build_statistics}, bindless_textures{bindless_textures},
+      contexts{std::move(contexts_)} {
+    workers.reserve(contexts.size());
+    for (auto& context : contexts) {
+        workers.emplace_back(&AsyncShaderBuilder::WorkerThread, this, context.get());
+    }
+}
+
+AsyncShaderBuilder::~AsyncShaderBuilder() {
+    {
+        std::lock_guard lock{mutex};
+        quit = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<AsyncProgram> AsyncShaderBuilder::QueueProgram(
+    const std::string& code, const GLShader::ShaderEntries& entries, ProgramType program_type,
+    const ProgramVariant& variant) {
+    auto job = std::make_shared<AsyncProgram>();
+    job->code = code;
+    job->entries = entries;
+    job->program_type = program_type;
+    job->variant = variant;
+    job->last_request = frame;
+    job->num_requests = 1;
+    {
+        std::lock_guard lock{mutex};
+        queue.push_back(job);
+    }
+    cv.notify_one();
+    return job;
+}
+
+void AsyncShaderBuilder::RequestProgram(AsyncProgram& job) {
+    std::lock_guard lock{mutex};
+    job.last_request = frame;
+    ++job.num_requests;
+}
+
+void AsyncShaderBuilder::WorkerThread(Core::Frontend::GraphicsContext* context) {
+    Common::SetCurrentThreadName("yuzu:ShaderBuilder");
+    context->MakeCurrent();
+    SCOPE_EXIT({ return context->DoneCurrent(); });
+
+    while (const auto job = PopProgram()) {
+        if (job->is_canceled) {
+            continue;
+        }
+        job->program = SpecializeShader(job->code, job->entries, job->program_type, job->variant,
+                                        bindless_textures, &build_statistics);
+
+        // The program is used from another context, make sure the driver is done with it first
+        glFinish();
+        job->is_ready = true;
+    }
+}
+
+std::shared_ptr<AsyncProgram> AsyncShaderBuilder::PopProgram() {
+    std::unique_lock lock{mutex};
+    cv.wait(lock, [this] { return quit || !queue.empty(); });
+    if (quit) {
+        return {};
+    }
+    const auto it = std::max_element(queue.begin(), queue.end(), [](const auto& a, const auto& b) {
+        return std::tie(a->last_request, a->num_requests) <
+               std::tie(b->last_request, b->num_requests);
+    });
+    auto job = std::move(*it);
+    *it = std::move(queue.back());
+    queue.pop_back();
+    return job;
+}
+
 CachedShader::CachedShader(const ShaderParameters& params, ProgramType program_type,
                            GLShader::ProgramResult result)
     : RasterizerCacheObject{params.host_ptr}, cpu_addr{params.cpu_addr},
       unique_identifier{params.unique_identifier}, program_type{program_type},
       disk_cache{params.disk_cache}, precompiled_programs{params.precompiled_programs},
-      entries{result.second}, code{std::move(result.first)}, shader_length{entries.shader_length} {}
+      async_builder{params.async_builder}, build_statistics{params.build_statistics},
+      bindless_textures{params.bindless_textures}, entries{result.second},
+      code{std::move(result.first)}, shader_length{entries.shader_length} {}
+
+CachedShader::~CachedShader() {
+    for (auto& [variant, job] : pending_programs) {
+        job->is_canceled = true;
+    }
+}
 
 Shader CachedShader::CreateStageFromMemory(const ShaderParameters& params,
                                            Maxwell::ShaderProgram program_type,
@@ -342,26 +488,25 @@ Shader CachedShader::CreateKernelFromCache(const ShaderParameters& params,
         new CachedShader(params, ProgramType::Compute, std::move(result)));
 }
 
-std::tuple<GLShader::StageProgram&, BaseBindings> CachedShader::GetProgramHandle(
+std::tuple<GLShader::StageProgram*, BaseBindings> CachedShader::GetProgramHandle(
     const ProgramVariant& variant) {
-    const auto [entry, is_cache_miss] = programs.try_emplace(variant);
-    auto& stage_program = entry->second;
-    if (is_cache_miss) {
-        stage_program = TryLoadProgram(variant);
+    auto base_bindings{variant.base_bindings};
+    base_bindings.cbuf += GetNumUniformBlocks(entries, bindless_textures);
+    base_bindings.gmem += static_cast<u32>(entries.global_memory_entries.size());
+    if (!bindless_textures) {
+        base_bindings.sampler += static_cast<u32>(entries.samplers.size());
+    }
+
+    const ProgramVariant key = MinimizeVariant(variant, entries, program_type, bindless_textures);
+    auto& stage_program = programs[key];
+    if (!stage_program) {
+        stage_program = BuildProgram(key);
         if (!stage_program) {
-            stage_program = SpecializeShader(code, entries, program_type, variant);
-            disk_cache.SaveUsage(GetUsage(variant));
+            return {nullptr, base_bindings};
         }
-
         LabelGLObject(GL_PROGRAM, stage_program->handle, cpu_addr);
     }
-
-    auto base_bindings{variant.base_bindings};
-    base_bindings.cbuf += static_cast<u32>(entries.const_buffers.size());
-    base_bindings.gmem += static_cast<u32>(entries.global_memory_entries.size());
-    base_bindings.sampler += static_cast<u32>(entries.samplers.size());
-
-    return {*stage_program, base_bindings};
+    return {stage_program.get(), base_bindings};
 }
 
 CachedProgram CachedShader::TryLoadProgram(const ProgramVariant& variant) const {
@@ -372,6 +517,33 @@ CachedProgram CachedShader::TryLoadProgram(const ProgramVariant& variant) const
     return found->second;
 }
 
+CachedProgram CachedShader::BuildProgram(const ProgramVariant& variant) {
+    if (auto program = TryLoadProgram(variant)) {
+        return program;
+    }
+    if (!async_builder) {
+        auto program = SpecializeShader(code, entries, program_type, variant, bindless_textures,
+                                        &build_statistics);
+        disk_cache.SaveUsage(GetUsage(variant));
+        return program;
+    }
+
+    const auto [it, is_new] = pending_programs.try_emplace(variant);
+    auto& job = it->second;
+    if (is_new) {
+        job = async_builder->QueueProgram(code, entries, program_type, variant);
+        return {};
+    }
+    if (!job->is_ready) {
+        async_builder->RequestProgram(*job);
+        return {};
+    }
+    auto program = std::move(job->program);
+    pending_programs.erase(it);
+    disk_cache.SaveUsage(GetUsage(variant));
+    return program;
+}
+
 ShaderDiskCacheUsage CachedShader::GetUsage(const ProgramVariant& variant) const {
     ShaderDiskCacheUsage usage;
     usage.unique_identifier = unique_identifier;
@@ -382,7 +554,42 @@ ShaderDiskCacheUsage CachedShader::GetUsage(const ProgramVariant& variant) const
 ShaderCacheOpenGL::ShaderCacheOpenGL(RasterizerOpenGL& rasterizer, Core::System& system,
                                      Core::Frontend::EmuWindow& emu_window, const Device& device)
     : RasterizerCache{rasterizer}, system{system}, emu_window{emu_window}, device{device},
-      disk_cache{system} {}
+      use_bindless_textures{device.HasBindlessTextures() &&
+                            Settings::values.use_bindless_textures},
+      disk_cache{system, use_bindless_textures} {
+    if (device.HasParallelShaderCompile()) {
+        // Programs built on the emulation context can use the driver's own compiler threads.
+        // Shared contexts are left alone, the workers already build one program each.
+        const GLuint num_threads = std::numeric_limits<GLuint>::max();
+        if (device.HasARBParallelShaderCompile()) {
+            glMaxShaderCompilerThreadsARB(num_threads);
+        } else {
+            glMaxShaderCompilerThreadsKHR(num_threads);
+        }
+    }
+    if (!Settings::values.use_asynchronous_shaders) {
+        return;
+    }
+    std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts;
+    for (std::size_t i = 0; i < GetNumAsyncShaderWorkers(); ++i) {
+        auto context = emu_window.CreateSharedContext();
+        if (!context) {
+            break;
+        }
+        contexts.push_back(std::move(context));
+    }
+    if (contexts.empty()) {
+        LOG_WARNING(Render_OpenGL, "Shared contexts are not available, building shaders "
+                                   "synchronously");
+        return;
+    }
+    async_builder = std::make_unique<AsyncShaderBuilder>(std::move(contexts), build_statistics,
+                                                         use_bindless_textures);
+}
+
+void ShaderCacheOpenGL::PrefetchDiskCache(u64 title_id) {
+    disk_cache.PrefetchTransferable(title_id);
+}
 
 void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
                                       const VideoCore::DiskResourceLoadCallback& callback) {
@@ -392,19 +599,15 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
     }
     const auto [raws, shader_usages] = *transferable;
 
-    auto [decompiled, dumps] = disk_cache.LoadPrecompiled();
+    // Only the index is read here, entries are read by the workers as they need them
+    disk_cache.LoadPrecompiled();
 
     const auto supported_formats{GetSupportedFormats()};
-    const auto unspecialized_shaders{
-        GenerateUnspecializedShaders(stop_loading, callback, raws, decompiled)};
+    const auto unspecialized_shaders{GenerateUnspecializedShaders(stop_loading, callback, raws)};
     if (stop_loading) {
         return;
     }
 
-    // Track if precompiled cache was altered during loading to know if we have to serialize the
-    // virtual precompiled cache file back to the hard drive
-    bool precompiled_cache_altered = false;
-
     // Inform the frontend about shader build initialization
     if (callback) {
         callback(VideoCore::LoadCallbackStage::Build, 0, shader_usages.size());
@@ -414,13 +617,16 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
     std::size_t built_shaders = 0; // It doesn't have be atomic since it's used behind a mutex
     std::atomic_bool compilation_failed = false;
 
-    const auto Worker = [&](Core::Frontend::GraphicsContext* context, std::size_t begin,
-                            std::size_t end, const std::vector<ShaderDiskCacheUsage>& shader_usages,
-                            const ShaderDumpsMap& dumps) {
+    // Shaders take very different times to build, so workers take them one by one instead of
+    // splitting the list in even buckets up front
+    std::atomic_size_t next_usage = 0;
+
+    const auto Worker = [&](Core::Frontend::GraphicsContext* context,
+                            const std::vector<ShaderDiskCacheUsage>& shader_usages) {
         context->MakeCurrent();
         SCOPE_EXIT({ return context->DoneCurrent(); });
 
-        for (std::size_t i = begin; i < end; ++i) {
+        for (std::size_t i = next_usage++; i < shader_usages.size(); i = next_usage++) {
             if (stop_loading || compilation_failed) {
                 return;
             }
@@ -429,12 +635,23 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
                      usage.unique_identifier, i, shader_usages.size());
 
             const auto& unspecialized{unspecialized_shaders.at(usage.unique_identifier)};
-            const auto dump{dumps.find(usage)};
+            if (MinimizeVariant(usage.variant, unspecialized.entries, unspecialized.program_type,
+                                use_bindless_textures) != usage.variant) {
+                // Stored before variants were minimized or with the other texture binding model,
+                // it will never be looked up again
+                std::scoped_lock lock(mutex);
+                if (callback) {
+                    callback(VideoCore::LoadCallbackStage::Build, ++built_shaders,
+                             shader_usages.size());
+                }
+                continue;
+            }
+            const auto dump{disk_cache.LoadDump(usage)};
 
             CachedProgram shader;
-            if (dump != dumps.end()) {
+            if (dump) {
                 // If the shader is dumped, attempt to load it with
-                shader = GeneratePrecompiledProgram(dump->second, supported_formats);
+                shader = GeneratePrecompiledProgram(*dump, supported_formats);
                 if (!shader) {
                     compilation_failed = true;
                     return;
@@ -442,7 +659,8 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
             }
             if (!shader) {
                 shader = SpecializeShader(unspecialized.code, unspecialized.entries,
-                                          unspecialized.program_type, usage.variant, true);
+                                          unspecialized.program_type, usage.variant,
+                                          use_bindless_textures, &build_statistics, true);
             }
 
             std::scoped_lock lock(mutex);
@@ -456,17 +674,12 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
     };
 
     const auto num_workers{static_cast<std::size_t>(std::thread::hardware_concurrency() + 1)};
-    const std::size_t bucket_size{shader_usages.size() / num_workers};
     std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts(num_workers);
     std::vector<std::thread> threads(num_workers);
     for (std::size_t i = 0; i < num_workers; ++i) {
-        const bool is_last_worker = i + 1 == num_workers;
-        const std::size_t start{bucket_size * i};
-        const std::size_t end{is_last_worker ? shader_usages.size() : start + bucket_size};
-
         // On some platforms the shared context has to be created from the GUI thread
         contexts[i] = emu_window.CreateSharedContext();
-        threads[i] = std::thread(Worker, contexts[i].get(), start, end, shader_usages, dumps);
+        threads[i] = std::thread(Worker, contexts[i].get(), std::cref(shader_usages));
     }
     for (auto& thread : threads) {
         thread.join();
@@ -475,8 +688,6 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
     if (compilation_failed) {
         // Invalidate the precompiled cache if a shader dumped shader was rejected
         disk_cache.InvalidatePrecompiled();
-        dumps.clear();
-        precompiled_cache_altered = true;
         return;
     }
     if (stop_loading) {
@@ -488,16 +699,14 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
 
     for (std::size_t i = 0; i < shader_usages.size(); ++i) {
         const auto& usage{shader_usages[i]};
-        if (dumps.find(usage) == dumps.end()) {
-            const auto& program{precompiled_programs.at(usage)};
-            disk_cache.SaveDump(usage, program->handle);
-            precompiled_cache_altered = true;
+        const auto program{precompiled_programs.find(usage)};
+        if (program != precompiled_programs.end() && !disk_cache.HasDump(usage)) {
+            disk_cache.SaveDump(usage, program->second->handle);
         }
     }
 
-    if (precompiled_cache_altered) {
-        disk_cache.SaveVirtualPrecompiledFile();
-    }
+    // Appends whatever was decompiled or dumped during this boot
+    disk_cache.SavePrecompiledFile();
 }
 
 CachedProgram ShaderCacheOpenGL::GeneratePrecompiledProgram(
@@ -520,58 +729,95 @@ CachedProgram ShaderCacheOpenGL::GeneratePrecompiledProgram(
         LOG_INFO(Render_OpenGL, "Precompiled cache rejected by the driver - removing");
         return {};
     }
+    shader->AccountProgramSize();
 
     return shader;
 }
 
 std::unordered_map<u64, UnspecializedShader> ShaderCacheOpenGL::GenerateUnspecializedShaders(
     const std::atomic_bool& stop_loading, const VideoCore::DiskResourceLoadCallback& callback,
-    const std::vector<ShaderDiskCacheRaw>& raws,
-    const std::unordered_map<u64, ShaderDiskCacheDecompiled>& decompiled) {
-    std::unordered_map<u64, UnspecializedShader> unspecialized;
-
+    const std::vector<ShaderDiskCacheRaw>& raws) {
     if (callback) {
         callback(VideoCore::LoadCallbackStage::Decompile, 0, raws.size());
     }
 
-    for (std::size_t i = 0; i < raws.size(); ++i) {
-        if (stop_loading) {
-            return {};
+    std::vector<GLShader::ProgramResult> results(raws.size());
+    std::vector<u8> is_new_result(raws.size()); // Not a vector<bool>, workers write it in parallel
+    std::atomic_size_t next_raw = 0;
+    std::atomic_bool invalid_hash = false;
+
+    std::mutex mutex;
+    std::size_t decompiled_shaders = 0; // It doesn't have be atomic since it's used behind a mutex
+
+    const auto Worker = [&] {
+        for (std::size_t i = next_raw++; i < raws.size(); i = next_raw++) {
+            if (stop_loading || invalid_hash) {
+                return;
+            }
+            const auto& raw{raws[i]};
+            const u64 unique_identifier{raw.GetUniqueIdentifier()};
+            const u64 calculated_hash{GetUniqueIdentifier(
+                raw.GetProgramType(), raw.GetProgramCode(), raw.GetProgramCodeB())};
+            if (unique_identifier != calculated_hash) {
+                LOG_ERROR(
+                    Render_OpenGL,
+                    "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing shader cache",
+                    raw.GetUniqueIdentifier(), calculated_hash);
+                invalid_hash = true;
+                return;
+            }
+
+            if (auto stored_decompiled = disk_cache.LoadDecompiled(unique_identifier)) {
+                // If it's stored in the precompiled file, avoid decompiling it here
+                results[i] = {std::move(stored_decompiled->code),
+                              std::move(stored_decompiled->entries)};
+            } else {
+                // Otherwise decompile the shader at boot and save the result to the decompiled file
+                results[i] = CreateProgram(device, raw.GetProgramType(), raw.GetProgramCode(),
+                                           raw.GetProgramCodeB());
+                is_new_result[i] = 1;
+            }
+
+            if (callback) {
+                std::scoped_lock lock{mutex};
+                callback(VideoCore::LoadCallbackStage::Decompile, ++decompiled_shaders,
+                         raws.size());
+            }
         }
+    };
+
+    // Decompilation doesn't touch OpenGL, so it can run on the thread pool without a context
+    auto& pool{Common::GetThreadPool()};
+    Common::TaskGroup group{pool};
+    for (std::size_t i = 0; i < pool.GetNumWorkers(); ++i) {
+        group.Submit(Worker);
+    }
+    Worker();
+    group.Wait();
+
+    if (invalid_hash) {
+        disk_cache.InvalidateTransferable();
+        return {};
+    }
+    if (stop_loading) {
+        return {};
+    }
+
+    // The disk cache is not thread safe, store the results in order from this thread
+    std::unordered_map<u64, UnspecializedShader> unspecialized;
+    for (std::size_t i = 0; i < raws.size(); ++i) {
         const auto& raw{raws[i]};
         const u64 unique_identifier{raw.GetUniqueIdentifier()};
-        const u64 calculated_hash{
-            GetUniqueIdentifier(raw.GetProgramType(), raw.GetProgramCode(), raw.GetProgramCodeB())};
-        if (unique_identifier != calculated_hash) {
-            LOG_ERROR(
-                Render_OpenGL,
-                "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing shader cache",
-                raw.GetUniqueIdentifier(), calculated_hash);
-            disk_cache.InvalidateTransferable();
-            return {};
-        }
-
-        GLShader::ProgramResult result;
-        if (const auto it = decompiled.find(unique_identifier); it != decompiled.end()) {
-            // If it's stored in the precompiled file, avoid decompiling it here
-            const auto& stored_decompiled{it->second};
-            result = {stored_decompiled.code, stored_decompiled.entries};
-        } else {
-            // Otherwise decompile the shader at boot and save the result to the decompiled file
-            result = CreateProgram(device, raw.GetProgramType(), raw.GetProgramCode(),
-                                   raw.GetProgramCodeB());
+        auto& result{results[i]};
+        if (is_new_result[i]) {
             disk_cache.SaveDecompiled(unique_identifier, result.first, result.second);
         }
 
         precompiled_shaders.insert({unique_identifier, result});
 
         unspecialized.insert(
-            {raw.GetUniqueIdentifier(),
+            {unique_identifier,
              {std::move(result.first), std::move(result.second), raw.GetProgramType()}});
-
-        if (callback) {
-            callback(VideoCore::LoadCallbackStage::Decompile, i, raws.size());
-        }
     }
     return unspecialized;
 }
@@ -604,8 +850,9 @@ Shader ShaderCacheOpenGL::GetStageProgram(Maxwell::ShaderProgram program) {
     const auto unique_identifier =
         GetUniqueIdentifier(GetProgramType(program), program_code, program_code_b);
     const auto cpu_addr{*memory_manager.GpuToCpuAddress(program_addr)};
-    const ShaderParameters params{disk_cache, precompiled_programs, device, cpu_addr,
-                                  host_ptr,   unique_identifier};
+    const ShaderParameters params{disk_cache, precompiled_programs, async_builder.get(),
+                                  build_statistics, device, use_bindless_textures, cpu_addr,
+                                  host_ptr, unique_identifier};
 
     const auto found = precompiled_shaders.find(unique_identifier);
     if (found == precompiled_shaders.end()) {
@@ -631,8 +878,9 @@ Shader ShaderCacheOpenGL::GetComputeKernel(GPUVAddr code_addr) {
     auto code{GetShaderCode(memory_manager, code_addr, host_ptr)};
     const auto unique_identifier{GetUniqueIdentifier(ProgramType::Compute, code, {})};
     const auto cpu_addr{*memory_manager.GpuToCpuAddress(code_addr)};
-    const ShaderParameters params{disk_cache, precompiled_programs, device, cpu_addr,
-                                  host_ptr,   unique_identifier};
+    const ShaderParameters params{disk_cache, precompiled_programs, async_builder.get(),
+                                  build_statistics, device, use_bindless_textures, cpu_addr,
+                                  host_ptr, unique_identifier};
 
     const auto found = precompiled_shaders.find(unique_identifier);
     if (found == precompiled_shaders.end()) {
@@ -645,4 +893,32 @@ Shader ShaderCacheOpenGL::GetComputeKernel(GPUVAddr code_addr) {
     return kernel;
 }
 
+void ShaderCacheOpenGL::TickFrame() {
+    if (async_builder) {
+        async_builder->TickFrame();
+    }
+}
+
+GLShader::StageProgram* ShaderCacheOpenGL::GetFallbackProgram(Maxwell::ShaderProgram program) {
+    switch (program) {
+    case Maxwell::ShaderProgram::VertexA:
+    case Maxwell::ShaderProgram::VertexB:
+        if (!fallback_vertex_program) {
+            fallback_vertex_program = SpecializeShader(GLShader::GenerateFallbackVertexShader(), {},
+                                                       ProgramType::VertexB, {}, false, nullptr);
+        }
+        return fallback_vertex_program.get();
+    case Maxwell::ShaderProgram::Fragment:
+        if (!fallback_fragment_program) {
+            fallback_fragment_program =
+                SpecializeShader(GLShader::GenerateFallbackFragmentShader(), {},
+                                 ProgramType::Fragment, {}, false, nullptr);
+        }
+        return fallback_fragment_program.get();
+    default:
+        // Skipping a geometry stage changes too much of the output to be worth it
+        return nullptr;
+    }
+}
+
 } // namespace OpenGL
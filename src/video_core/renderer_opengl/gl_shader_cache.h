@@ -7,8 +7,13 @@
 #include <array>
 #include <atomic>
 #include <bitset>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -28,6 +33,7 @@ class System;
 
 namespace Core::Frontend {
 class EmuWindow;
+class GraphicsContext;
 }
 
 namespace OpenGL {
@@ -43,10 +49,85 @@ using Maxwell = Tegra::Engines::Maxwell3D::Regs;
 using PrecompiledPrograms = std::unordered_map<ShaderDiskCacheUsage, CachedProgram>;
 using PrecompiledShaders = std::unordered_map<u64, GLShader::ProgramResult>;
 
+/// Guest programs built on the host during the session, read by its telemetry from another thread.
+struct ShaderBuildStatistics {
+    void Record(std::chrono::nanoseconds build_time) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        time_ns.fetch_add(static_cast<u64>(build_time.count()), std::memory_order_relaxed);
+    }
+
+    std::atomic<u64> count{};
+    std::atomic<u64> time_ns{};
+};
+
+/// Program variant being built by the asynchronous shader builder.
+struct AsyncProgram {
+    std::string code;
+    GLShader::ShaderEntries entries;
+    ProgramType program_type{};
+    ProgramVariant variant;
+
+    u64 last_request{}; ///< Frame the program was last asked for, guarded by the builder
+    u32 num_requests{}; ///< Times the program was asked for, guarded by the builder
+
+    std::atomic_bool is_canceled{};
+    std::atomic_bool is_ready{};
+    CachedProgram program; ///< Built program, only valid once is_ready is set
+};
+
+/**
+ * Specializes and links shader programs on worker threads, each with a context shared with the
+ * emulation window. Queued programs are built in order of how recently they were asked for, with
+ * the number of requests breaking the ties.
+ */
+class AsyncShaderBuilder final {
+public:
+    explicit AsyncShaderBuilder(
+        std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts,
+        ShaderBuildStatistics& build_statistics, bool bindless_textures);
+    ~AsyncShaderBuilder();
+
+    /// Queues a program to be built, the returned job is marked as ready once it's done
+    std::shared_ptr<AsyncProgram> QueueProgram(const std::string& code,
+                                               const GLShader::ShaderEntries& entries,
+                                               ProgramType program_type,
+                                               const ProgramVariant& variant);
+
+    /// Raises the priority of a queued program that was asked for again
+    void RequestProgram(AsyncProgram& job);
+
+    /// Notifies the builder that a frame has finished, older requests lose priority
+    void TickFrame() {
+        ++frame;
+    }
+
+private:
+    void WorkerThread(Core::Frontend::GraphicsContext* context);
+
+    /// Waits for a queued program and takes the one with the highest priority, returns null when
+    /// the builder is shutting down
+    std::shared_ptr<AsyncProgram> PopProgram();
+
+    ShaderBuildStatistics& build_statistics;
+    bool bindless_textures{};
+    u64 frame{};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<AsyncProgram>> queue;
+    bool quit{};
+
+    std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts;
+    std::vector<std::thread> workers;
+};
+
 struct ShaderParameters {
     ShaderDiskCacheOpenGL& disk_cache;
     const PrecompiledPrograms& precompiled_programs;
+    AsyncShaderBuilder* async_builder;
+    ShaderBuildStatistics& build_statistics;
     const Device& device;
+    bool bindless_textures;
     VAddr cpu_addr;
     u8* host_ptr;
     u64 unique_identifier;
@@ -67,6 +148,8 @@ public:
     static Shader CreateKernelFromCache(const ShaderParameters& params,
                                         GLShader::ProgramResult result);
 
+    ~CachedShader() override;
+
     VAddr GetCpuAddr() const override {
         return cpu_addr;
     }
@@ -80,8 +163,13 @@ public:
         return entries;
     }
 
-    /// Gets the GL program handle for the shader
-    std::tuple<GLShader::StageProgram&, BaseBindings> GetProgramHandle(
+    /// Gets the hash of the guest code, it names the shader in dumps and profiles
+    u64 GetUniqueIdentifier() const {
+        return unique_identifier;
+    }
+
+    /// Gets the GL program handle for the shader, null while it's being built asynchronously
+    std::tuple<GLShader::StageProgram*, BaseBindings> GetProgramHandle(
         const ProgramVariant& variant);
 
 private:
@@ -90,6 +178,9 @@ private:
 
     CachedProgram TryLoadProgram(const ProgramVariant& variant) const;
 
+    /// Builds a program that isn't in the cache, returns null while asynchronous builds are pending
+    CachedProgram BuildProgram(const ProgramVariant& variant);
+
     ShaderDiskCacheUsage GetUsage(const ProgramVariant& variant) const;
 
     VAddr cpu_addr{};
@@ -97,12 +188,16 @@ private:
     ProgramType program_type{};
     ShaderDiskCacheOpenGL& disk_cache;
     const PrecompiledPrograms& precompiled_programs;
+    AsyncShaderBuilder* async_builder;
+    ShaderBuildStatistics& build_statistics;
+    bool bindless_textures{};
 
     GLShader::ShaderEntries entries;
     std::string code;
     std::size_t shader_length{};
 
     std::unordered_map<ProgramVariant, CachedProgram> programs;
+    std::unordered_map<ProgramVariant, std::shared_ptr<AsyncProgram>> pending_programs;
 };
 
 class ShaderCacheOpenGL final : public RasterizerCache<Shader> {
@@ -110,6 +205,9 @@ public:
     explicit ShaderCacheOpenGL(RasterizerOpenGL& rasterizer, Core::System& system,
                                Core::Frontend::EmuWindow& emu_window, const Device& device);
 
+    /// Starts reading the disk cache of the given title in the background
+    void PrefetchDiskCache(u64 title_id);
+
     /// Loads disk cache for the current game
     void LoadDiskCache(const std::atomic_bool& stop_loading,
                        const VideoCore::DiskResourceLoadCallback& callback);
@@ -120,6 +218,23 @@ public:
     /// Gets a compute kernel in the passed address
     Shader GetComputeKernel(GPUVAddr code_addr);
 
+    /// Notifies the cache that a frame has finished
+    void TickFrame();
+
+    /// Returns a generic program to draw with while the stage's program is being built, or null
+    /// when the stage has none
+    GLShader::StageProgram* GetFallbackProgram(Maxwell::ShaderProgram program);
+
+    /// Returns true when programs read their textures from resident bindless handles
+    bool UseBindlessTextures() const {
+        return use_bindless_textures;
+    }
+
+    /// Gets the counters of the programs built this session, safe to call from any thread
+    const ShaderBuildStatistics& GetBuildStatistics() const {
+        return build_statistics;
+    }
+
 protected:
     // We do not have to flush this cache as things in it are never modified by us.
     void FlushObjectInner(const Shader& object) override {}
@@ -127,8 +242,7 @@ protected:
 private:
     std::unordered_map<u64, UnspecializedShader> GenerateUnspecializedShaders(
         const std::atomic_bool& stop_loading, const VideoCore::DiskResourceLoadCallback& callback,
-        const std::vector<ShaderDiskCacheRaw>& raws,
-        const std::unordered_map<u64, ShaderDiskCacheDecompiled>& decompiled);
+        const std::vector<ShaderDiskCacheRaw>& raws);
 
     CachedProgram GeneratePrecompiledProgram(const ShaderDiskCacheDump& dump,
                                              const std::set<GLenum>& supported_formats);
@@ -136,11 +250,17 @@ private:
     Core::System& system;
     Core::Frontend::EmuWindow& emu_window;
     const Device& device;
+    const bool use_bindless_textures;
     ShaderDiskCacheOpenGL disk_cache;
 
+    ShaderBuildStatistics build_statistics;
     PrecompiledShaders precompiled_shaders;
     PrecompiledPrograms precompiled_programs;
     std::array<Shader, Maxwell::MaxShaderProgram> last_shaders;
+
+    std::unique_ptr<AsyncShaderBuilder> async_builder;
+    CachedProgram fallback_vertex_program;
+    CachedProgram fallback_fragment_program;
 };
 
 } // namespace OpenGL
@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <iterator>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -15,6 +17,7 @@
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/renderer_opengl/gl_device.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
@@ -25,6 +28,8 @@
 
 namespace OpenGL::GLShader {
 
+MICROPROFILE_DEFINE(OpenGL_GLSLEmit, "OpenGL", "GLSL Emit", MP_RGB(128, 128, 192));
+
 namespace {
 
 using Tegra::Shader::Attribute;
@@ -50,14 +55,23 @@ using TextureIR = std::variant<TextureAoffi, TextureArgument>;
 constexpr u32 MAX_CONSTBUFFER_ELEMENTS =
     static_cast<u32>(Maxwell::MaxConstBufferSize) / (4 * sizeof(float));
 
+/// Estimate of the generated source size, used to size the source buffer up front.
+constexpr std::size_t SourceSizeBase = 0x2000;
+constexpr std::size_t SourceSizePerInstruction = 0x100;
+
+/// Writes the whole shader source into a single buffer, lines are formatted straight into it.
 class ShaderWriter final {
 public:
+    void Reserve(std::size_t size) {
+        shader_source.reserve(size);
+    }
+
     void AddExpression(std::string_view text) {
         DEBUG_ASSERT(scope >= 0);
         if (!text.empty()) {
             AppendIndentation();
         }
-        shader_source += text;
+        shader_source.append(text.data(), text.data() + text.size());
     }
 
     // Forwards all arguments directly to libfmt.
@@ -67,13 +81,17 @@ public:
     // etc).
     template <typename... Args>
     void AddLine(std::string_view text, Args&&... args) {
-        AddExpression(fmt::format(text, std::forward<Args>(args)...));
+        DEBUG_ASSERT(scope >= 0);
+        if (!text.empty()) {
+            AppendIndentation();
+        }
+        fmt::format_to(std::back_inserter(shader_source), text, std::forward<Args>(args)...);
         AddNewLine();
     }
 
     void AddNewLine() {
         DEBUG_ASSERT(scope >= 0);
-        shader_source += '\n';
+        shader_source.push_back('\n');
     }
 
     std::string GenerateTemporary() {
@@ -81,17 +99,20 @@ public:
     }
 
     std::string GetResult() {
-        return std::move(shader_source);
+        return fmt::to_string(shader_source);
     }
 
     s32 scope = 0;
 
 private:
     void AppendIndentation() {
-        shader_source.append(static_cast<std::size_t>(scope) * 4, ' ');
+        const std::size_t size = shader_source.size();
+        const std::size_t indentation = static_cast<std::size_t>(scope) * 4;
+        shader_source.resize(size + indentation);
+        std::fill_n(shader_source.data() + size, indentation, ' ');
     }
 
-    std::string shader_source;
+    fmt::memory_buffer shader_source;
     u32 temporary_index = 1;
 };
 
@@ -106,7 +127,7 @@ public:
         return type;
     }
 
-    std::string GetCode() const {
+    const std::string& GetCode() const {
         return code;
     }
 
@@ -342,7 +363,9 @@ class GLSLDecompiler final {
 public:
     explicit GLSLDecompiler(const Device& device, const ShaderIR& ir, ProgramType stage,
                             std::string suffix)
-        : device{device}, ir{ir}, stage{stage}, suffix{suffix}, header{ir.GetHeader()} {}
+        : device{device}, ir{ir}, stage{stage}, suffix{suffix}, header{ir.GetHeader()} {
+        code.Reserve(SourceSizeBase + ir.GetLength() / sizeof(u64) * SourceSizePerInstruction);
+    }
 
     void DecompileBranchMode() {
         // VM's program counter
@@ -674,49 +697,66 @@ private:
 
     void DeclareSamplers() {
         const auto& samplers = ir.GetSamplers();
+        if (samplers.empty()) {
+            return;
+        }
+        // Programs are specialized to read resident bindless handles from a uniform block, or to
+        // sample the textures bound to their units
+        code.AddLine("#ifdef BINDLESS_TEXTURES");
+        code.AddLine("layout (std140, binding = BINDLESS_TEXTURES_BINDING) uniform {} {{",
+                     GetBindlessTexturesBlock());
+        ++code.scope;
         for (const auto& sampler : samplers) {
-            const std::string name{GetSampler(sampler)};
-            const std::string description{"layout (binding = SAMPLER_BINDING_" +
-                                          std::to_string(sampler.GetIndex()) + ") uniform"};
-            std::string sampler_type = [&]() {
-                switch (sampler.GetType()) {
-                case Tegra::Shader::TextureType::Texture1D:
-                    // Special cased, read below.
-                    return "sampler1D";
-                case Tegra::Shader::TextureType::Texture2D:
-                    return "sampler2D";
-                case Tegra::Shader::TextureType::Texture3D:
-                    return "sampler3D";
-                case Tegra::Shader::TextureType::TextureCube:
-                    return "samplerCube";
-                default:
-                    UNREACHABLE();
-                    return "sampler2D";
-                }
-            }();
-            if (sampler.IsArray()) {
-                sampler_type += "Array";
-            }
-            if (sampler.IsShadow()) {
-                sampler_type += "Shadow";
-            }
+            DeclareSampler(sampler, "");
+        }
+        --code.scope;
+        code.AddLine("}};");
+        code.AddLine("#else");
+        for (const auto& sampler : samplers) {
+            DeclareSampler(sampler, "layout (binding = SAMPLER_BINDING_" +
+                                        std::to_string(sampler.GetIndex()) + ") uniform ");
+        }
+        code.AddLine("#endif");
+        code.AddNewLine();
+    }
 
-            if (sampler.GetType() == Tegra::Shader::TextureType::Texture1D) {
-                // 1D textures can be aliased to texture buffers, hide the declarations behind a
-                // preprocessor flag and use one or the other from the GPU state. This has to be
-                // done because shaders don't have enough information to determine the texture type.
-                EmitIfdefIsBuffer(sampler);
-                code.AddLine("{} samplerBuffer {};", description, name);
-                code.AddLine("#else");
-                code.AddLine("{} {} {};", description, sampler_type, name);
-                code.AddLine("#endif");
-            } else {
-                // The other texture types (2D, 3D and cubes) don't have this issue.
-                code.AddLine("{} {} {};", description, sampler_type, name);
+    void DeclareSampler(const Sampler& sampler, const std::string& description) {
+        const std::string name{GetSampler(sampler)};
+        std::string sampler_type = [&]() {
+            switch (sampler.GetType()) {
+            case Tegra::Shader::TextureType::Texture1D:
+                // Special cased, read below.
+                return "sampler1D";
+            case Tegra::Shader::TextureType::Texture2D:
+                return "sampler2D";
+            case Tegra::Shader::TextureType::Texture3D:
+                return "sampler3D";
+            case Tegra::Shader::TextureType::TextureCube:
+                return "samplerCube";
+            default:
+                UNREACHABLE();
+                return "sampler2D";
             }
-        }
-        if (!samplers.empty()) {
-            code.AddNewLine();
+        }();
+        if (sampler.IsArray()) {
+            sampler_type += "Array";
+        }
+        if (sampler.IsShadow()) {
+            sampler_type += "Shadow";
+        }
+
+        if (sampler.GetType() == Tegra::Shader::TextureType::Texture1D) {
+            // 1D textures can be aliased to texture buffers, hide the declarations behind a
+            // preprocessor flag and use one or the other from the GPU state. This has to be
+            // done because shaders don't have enough information to determine the texture type.
+            EmitIfdefIsBuffer(sampler);
+            code.AddLine("{}samplerBuffer {};", description, name);
+            code.AddLine("#else");
+            code.AddLine("{}{} {};", description, sampler_type, name);
+            code.AddLine("#endif");
+        } else {
+            // The other texture types (2D, 3D and cubes) don't have this issue.
+            code.AddLine("{}{} {};", description, sampler_type, name);
         }
     }
 
@@ -2193,12 +2233,12 @@ private:
     };
     static_assert(operation_decompilers.size() == static_cast<std::size_t>(OperationCode::Amount));
 
-    std::string GetRegister(u32 index) const {
-        return GetDeclarationWithSuffix(index, "gpr");
+    const std::string& GetRegister(u32 index) const {
+        return InternName(register_names, index, "gpr");
     }
 
-    std::string GetPredicate(Tegra::Shader::Pred pred) const {
-        return GetDeclarationWithSuffix(static_cast<u32>(pred), "pred");
+    const std::string& GetPredicate(Tegra::Shader::Pred pred) const {
+        return InternName(predicate_names, static_cast<u32>(pred), "pred");
     }
 
     std::string GetInputAttribute(Attribute::Index attribute) const {
@@ -2226,6 +2266,10 @@ private:
         return GetDeclarationWithSuffix(index, "cbuf_block");
     }
 
+    std::string GetBindlessTexturesBlock() const {
+        return "bindless_textures_" + suffix;
+    }
+
     std::string GetLocalMemory() const {
         return "lmem_" + suffix;
     }
@@ -2234,13 +2278,17 @@ private:
         return fmt::format("smem_{}", suffix);
     }
 
-    std::string GetInternalFlag(InternalFlag flag) const {
+    const std::string& GetInternalFlag(InternalFlag flag) const {
         constexpr std::array InternalFlagNames = {"zero_flag", "sign_flag", "carry_flag",
                                                   "overflow_flag"};
         const auto index = static_cast<u32>(flag);
         ASSERT(index < static_cast<u32>(InternalFlag::Amount));
 
-        return fmt::format("{}_{}", InternalFlagNames[index], suffix);
+        std::string& name = internal_flag_names[index];
+        if (name.empty()) {
+            name = fmt::format("{}_{}", InternalFlagNames[index], suffix);
+        }
+        return name;
     }
 
     std::string GetSampler(const Sampler& sampler) const {
@@ -2259,6 +2307,20 @@ private:
         return fmt::format("{}_{}_{}", name, index, suffix);
     }
 
+    /// Formats the name of a variable the first time it's used, every node reading or writing
+    /// the variable then shares the same string.
+    const std::string& InternName(std::vector<std::string>& names, u32 index,
+                                  const std::string& name) const {
+        if (index >= names.size()) {
+            names.resize(index + 1);
+        }
+        std::string& interned = names[index];
+        if (interned.empty()) {
+            interned = GetDeclarationWithSuffix(index, name);
+        }
+        return interned;
+    }
+
     u32 GetNumPhysicalInputAttributes() const {
         return IsVertexShader(stage) ? GetNumPhysicalAttributes() : GetNumPhysicalVaryings();
     }
@@ -2277,6 +2339,11 @@ private:
     const std::string suffix;
     const Header header;
 
+    mutable std::vector<std::string> register_names;
+    mutable std::vector<std::string> predicate_names;
+    mutable std::array<std::string, static_cast<std::size_t>(InternalFlag::Amount)>
+        internal_flag_names;
+
     ShaderWriter code;
 };
 
@@ -2502,6 +2569,7 @@ std::string GetCommonDeclarations() {
 
 ProgramResult Decompile(const Device& device, const ShaderIR& ir, ProgramType stage,
                         const std::string& suffix) {
+    MICROPROFILE_SCOPE(OpenGL_GLSLEmit);
     GLSLDecompiler decompiler(device, ir, stage, suffix);
     decompiler.Decompile();
     return {decompiler.GetResult(), decompiler.GetShaderEntries()};
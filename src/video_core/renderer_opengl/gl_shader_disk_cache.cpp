@@ -6,6 +6,7 @@
 #include <fmt/format.h>
 
 #include "common/assert.h"
+#include "common/common_funcs.h"
 #include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -29,16 +30,30 @@ enum class TransferableEntryKind : u32 {
     Usage,
 };
 
-enum class PrecompiledEntryKind : u32 {
-    Decompiled,
-    Dump,
+constexpr u32 NativeVersion = 4;
+
+constexpr u32 PrecompiledMagic = Common::MakeMagic('Y', 'P', 'S', 'C');
+constexpr u32 PrecompiledVersion = 2;
+
+/// Starts the precompiled file, entries follow it.
+struct PrecompiledHeader {
+    u32 magic;
+    u32 version;
+    ShaderCacheVersionHash version_hash;
 };
 
-constexpr u32 NativeVersion = 4;
+/// Ends the precompiled file, pointing to the index written right before it.
+struct PrecompiledFooter {
+    u64 index_offset;
+    u32 num_entries;
+    u32 magic;
+};
 
 // Making sure sizes doesn't change by accident
 static_assert(sizeof(BaseBindings) == 16);
 static_assert(sizeof(ShaderDiskCacheUsage) == 40);
+static_assert(sizeof(PrecompiledHeader) == 72);
+static_assert(sizeof(PrecompiledFooter) == 16);
 
 namespace {
 
@@ -104,10 +119,22 @@ bool ShaderDiskCacheRaw::Save(FileUtil::IOFile& file) const {
     return true;
 }
 
-ShaderDiskCacheOpenGL::ShaderDiskCacheOpenGL(Core::System& system) : system{system} {}
+ShaderDiskCacheOpenGL::ShaderDiskCacheOpenGL(Core::System& system, bool bindless_textures)
+    : system{system}, bindless_textures{bindless_textures} {}
 
 ShaderDiskCacheOpenGL::~ShaderDiskCacheOpenGL() = default;
 
+void ShaderDiskCacheOpenGL::PrefetchTransferable(u64 title_id) {
+    if (!Settings::values.use_disk_shader_cache || title_id == 0)
+        return;
+
+    const std::string title = fmt::format("{:016X}", title_id);
+    const std::string path =
+        FileUtil::SanitizePath(GetTransferableDir() + DIR_SEP_CHR + title + ".bin");
+    prefetched_title_id = title_id;
+    prefetched_transferable = std::async(std::launch::async, &ReadTransferable, path, title);
+}
+
 std::optional<std::pair<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>>>
 ShaderDiskCacheOpenGL::LoadTransferable() {
     // Skip games without title id
@@ -116,10 +143,34 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
         return {};
     tried_to_load = true;
 
-    FileUtil::IOFile file(GetTransferablePath(), "rb");
+    TransferableFile file;
+    if (prefetched_transferable.valid() &&
+        prefetched_title_id == system.CurrentProcess()->GetTitleID()) {
+        file = prefetched_transferable.get();
+    } else {
+        file = ReadTransferable(GetTransferablePath(), GetTitleID());
+    }
+
+    if (file.is_outdated) {
+        InvalidateTransferable();
+        return {};
+    }
+    if (!file.entries) {
+        return {};
+    }
+
+    for (const auto& raw : file.entries->first) {
+        transferable.insert({raw.GetUniqueIdentifier(), {}});
+    }
+    return std::move(file.entries);
+}
+
+ShaderDiskCacheOpenGL::TransferableFile ShaderDiskCacheOpenGL::ReadTransferable(
+    const std::string& path, const std::string& title_id) {
+    FileUtil::IOFile file(path, "rb");
     if (!file.IsOpen()) {
         LOG_INFO(Render_OpenGL, "No transferable shader cache found for game with title id={}",
-                 GetTitleID());
+                 title_id);
         return {};
     }
 
@@ -127,15 +178,13 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
     if (file.ReadBytes(&version, sizeof(version)) != sizeof(version)) {
         LOG_ERROR(Render_OpenGL,
                   "Failed to get transferable cache version for title id={} - skipping",
-                  GetTitleID());
+                  title_id);
         return {};
     }
 
     if (version < NativeVersion) {
         LOG_INFO(Render_OpenGL, "Transferable shader cache is old - removing");
-        file.Close();
-        InvalidateTransferable();
-        return {};
+        return {{}, true};
     }
     if (version > NativeVersion) {
         LOG_WARNING(Render_OpenGL, "Transferable shader cache was generated with a newer version "
@@ -160,7 +209,6 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
                 LOG_ERROR(Render_OpenGL, "Failed to load transferable raw entry - skipping");
                 return {};
             }
-            transferable.insert({entry.GetUniqueIdentifier(), {}});
             raws.push_back(std::move(entry));
             break;
         }
@@ -180,104 +228,146 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
         }
     }
 
-    return {{raws, usages}};
+    TransferableFile result;
+    result.entries.emplace(std::move(raws), std::move(usages));
+    return result;
 }
 
-std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>, ShaderDumpsMap>
-ShaderDiskCacheOpenGL::LoadPrecompiled() {
+void ShaderDiskCacheOpenGL::LoadPrecompiled() {
     if (!IsUsable())
-        return {};
+        return;
 
-    FileUtil::IOFile file(GetPrecompiledPath(), "rb");
-    if (!file.IsOpen()) {
+    precompiled_file.Open(GetPrecompiledPath(), "rb");
+    if (!precompiled_file.IsOpen()) {
         LOG_INFO(Render_OpenGL, "No precompiled shader cache found for game with title id={}",
                  GetTitleID());
-        return {};
+        return;
     }
 
-    const auto result = LoadPrecompiledFile(file);
-    if (!result) {
+    if (!LoadPrecompiledIndex()) {
         LOG_INFO(Render_OpenGL,
                  "Failed to load precompiled cache for game with title id={} - removing",
                  GetTitleID());
-        file.Close();
         InvalidatePrecompiled();
-        return {};
     }
-    return *result;
 }
 
-std::optional<std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>, ShaderDumpsMap>>
-ShaderDiskCacheOpenGL::LoadPrecompiledFile(FileUtil::IOFile& file) {
-    // Read compressed file from disk and decompress to virtual precompiled cache file
-    std::vector<u8> compressed(file.GetSize());
-    file.ReadBytes(compressed.data(), compressed.size());
-    const std::vector<u8> decompressed = Common::Compression::DecompressDataZSTD(compressed);
-    SaveArrayToPrecompiled(decompressed.data(), decompressed.size());
-    precompiled_cache_virtual_file_offset = 0;
-
-    ShaderCacheVersionHash file_hash{};
-    if (!LoadArrayFromPrecompiled(file_hash.data(), file_hash.size())) {
-        precompiled_cache_virtual_file_offset = 0;
+std::optional<ShaderDiskCacheDecompiled> ShaderDiskCacheOpenGL::LoadDecompiled(
+    u64 unique_identifier) {
+    const auto it = decompiled_index.find(unique_identifier);
+    if (it == decompiled_index.end()) {
         return {};
     }
-    if (GetShaderCacheVersionHash() != file_hash) {
-        LOG_INFO(Render_OpenGL, "Precompiled cache is from another version of the emulator");
-        precompiled_cache_virtual_file_offset = 0;
+    std::lock_guard lock{precompiled_mutex};
+    if (!ReadPrecompiledEntry(it->second)) {
+        LOG_ERROR(Render_OpenGL, "Failed to read decompiled entry of shader={:016x}",
+                  unique_identifier);
         return {};
     }
+    return LoadDecompiledEntry();
+}
 
-    std::unordered_map<u64, ShaderDiskCacheDecompiled> decompiled;
-    ShaderDumpsMap dumps;
-    while (precompiled_cache_virtual_file_offset < precompiled_cache_virtual_file.GetSize()) {
-        PrecompiledEntryKind kind{};
-        if (!LoadObjectFromPrecompiled(kind)) {
-            return {};
-        }
-
-        switch (kind) {
-        case PrecompiledEntryKind::Decompiled: {
-            u64 unique_identifier{};
-            if (!LoadObjectFromPrecompiled(unique_identifier)) {
-                return {};
-            }
+std::optional<ShaderDiskCacheDump> ShaderDiskCacheOpenGL::LoadDump(
+    const ShaderDiskCacheUsage& usage) {
+    const auto it = dump_index.find(usage);
+    if (it == dump_index.end()) {
+        return {};
+    }
+    std::lock_guard lock{precompiled_mutex};
+    ShaderDiskCacheDump dump;
+    u32 binary_length{};
+    if (!ReadPrecompiledEntry(it->second) || !LoadObjectFromPrecompiled(dump.binary_format) ||
+        !LoadObjectFromPrecompiled(binary_length)) {
+        LOG_ERROR(Render_OpenGL, "Failed to read dump entry of shader={:016x}",
+                  usage.unique_identifier);
+        return {};
+    }
+    dump.binary.resize(binary_length);
+    if (!LoadArrayFromPrecompiled(dump.binary.data(), dump.binary.size())) {
+        return {};
+    }
+    return dump;
+}
 
-            auto entry = LoadDecompiledEntry();
-            if (!entry) {
-                return {};
-            }
-            decompiled.insert({unique_identifier, std::move(*entry)});
-            break;
-        }
-        case PrecompiledEntryKind::Dump: {
-            ShaderDiskCacheUsage usage;
-            if (!LoadObjectFromPrecompiled(usage)) {
-                return {};
-            }
+bool ShaderDiskCacheOpenGL::HasDump(const ShaderDiskCacheUsage& usage) const {
+    return dump_index.find(usage) != dump_index.end();
+}
 
-            ShaderDiskCacheDump dump;
-            if (!LoadObjectFromPrecompiled(dump.binary_format)) {
-                return {};
-            }
+bool ShaderDiskCacheOpenGL::LoadPrecompiledIndex() {
+    static_assert(sizeof(PrecompiledIndexEntry) == 56);
 
-            u32 binary_length{};
-            if (!LoadObjectFromPrecompiled(binary_length)) {
-                return {};
-            }
+    PrecompiledHeader header{};
+    if (precompiled_file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != PrecompiledMagic || header.version != PrecompiledVersion) {
+        LOG_INFO(Render_OpenGL, "Precompiled cache has an unknown format");
+        return false;
+    }
+    if (GetShaderCacheVersionHash() != header.version_hash) {
+        LOG_INFO(Render_OpenGL, "Precompiled cache is from another version of the emulator");
+        return false;
+    }
 
-            dump.binary.resize(binary_length);
-            if (!LoadArrayFromPrecompiled(dump.binary.data(), dump.binary.size())) {
-                return {};
-            }
+    const u64 file_size = precompiled_file.GetSize();
+    PrecompiledFooter footer{};
+    if (file_size < sizeof(header) + sizeof(footer) ||
+        !precompiled_file.Seek(static_cast<s64>(file_size - sizeof(footer)), SEEK_SET) ||
+        precompiled_file.ReadBytes(&footer, sizeof(footer)) != sizeof(footer) ||
+        footer.magic != PrecompiledMagic) {
+        return false;
+    }
+    const u64 index_size = u64{footer.num_entries} * sizeof(PrecompiledIndexEntry);
+    if (footer.index_offset < sizeof(header) ||
+        footer.index_offset + index_size > file_size - sizeof(footer)) {
+        return false;
+    }
 
-            dumps.insert({usage, dump});
-            break;
+    std::vector<PrecompiledIndexEntry> entries(footer.num_entries);
+    if (!precompiled_file.Seek(static_cast<s64>(footer.index_offset), SEEK_SET) ||
+        precompiled_file.ReadArray(entries.data(), entries.size()) != entries.size()) {
+        return false;
+    }
+    for (const auto& entry : entries) {
+        if (entry.offset < sizeof(header) || entry.offset + entry.size > footer.index_offset) {
+            return false;
         }
+        switch (entry.kind) {
+        case PrecompiledEntryKind::Decompiled:
+            decompiled_index.insert_or_assign(entry.usage.unique_identifier, entry);
+            break;
+        case PrecompiledEntryKind::Dump:
+            dump_index.insert_or_assign(entry.usage, entry);
+            break;
         default:
-            return {};
+            return false;
         }
     }
-    return {{decompiled, dumps}};
+    return true;
+}
+
+bool ShaderDiskCacheOpenGL::ReadPrecompiledEntry(const PrecompiledIndexEntry& entry) {
+    std::vector<u8> compressed(entry.size);
+    if (!precompiled_file.Seek(static_cast<s64>(entry.offset), SEEK_SET) ||
+        precompiled_file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        return false;
+    }
+    precompiled_cache_virtual_file.Assign(Common::Compression::DecompressDataZSTD(compressed));
+    precompiled_cache_virtual_file_offset = 0;
+    return precompiled_cache_virtual_file.GetSize() != 0;
+}
+
+void ShaderDiskCacheOpenGL::QueuePrecompiledEntry(PrecompiledEntryKind kind,
+                                                  const ShaderDiskCacheUsage& usage) {
+    const std::vector<u8> uncompressed = precompiled_cache_virtual_file.ReadAllBytes();
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTDDefault(uncompressed.data(), uncompressed.size());
+
+    PrecompiledIndexEntry entry{};
+    entry.kind = kind;
+    entry.size = static_cast<u32>(compressed.size());
+    entry.offset = pending_data.size();
+    entry.usage = usage;
+    pending_entries.push_back(entry);
+    pending_data.insert(pending_data.end(), compressed.begin(), compressed.end());
 }
 
 std::optional<ShaderDiskCacheDecompiled> ShaderDiskCacheOpenGL::LoadDecompiledEntry() {
@@ -388,11 +478,9 @@ std::optional<ShaderDiskCacheDecompiled> ShaderDiskCacheOpenGL::LoadDecompiledEn
     return entry;
 }
 
-bool ShaderDiskCacheOpenGL::SaveDecompiledFile(u64 unique_identifier, const std::string& code,
+bool ShaderDiskCacheOpenGL::SaveDecompiledFile(const std::string& code,
                                                const GLShader::ShaderEntries& entries) {
-    if (!SaveObjectToPrecompiled(static_cast<u32>(PrecompiledEntryKind::Decompiled)) ||
-        !SaveObjectToPrecompiled(unique_identifier) ||
-        !SaveObjectToPrecompiled(static_cast<u32>(code.size())) ||
+    if (!SaveObjectToPrecompiled(static_cast<u32>(code.size())) ||
         !SaveArrayToPrecompiled(code.data(), code.size())) {
         return false;
     }
@@ -472,6 +560,11 @@ void ShaderDiskCacheOpenGL::InvalidateTransferable() {
 void ShaderDiskCacheOpenGL::InvalidatePrecompiled() {
     // Clear virtaul precompiled cache file
     precompiled_cache_virtual_file.Resize(0);
+    precompiled_file.Close();
+    decompiled_index.clear();
+    dump_index.clear();
+    pending_entries.clear();
+    pending_data.clear();
 
     if (!FileUtil::Delete(GetPrecompiledPath())) {
         LOG_ERROR(Render_OpenGL, "Failed to invalidate precompiled file={}", GetPrecompiledPath());
@@ -531,15 +624,18 @@ void ShaderDiskCacheOpenGL::SaveDecompiled(u64 unique_identifier, const std::str
     if (!IsUsable())
         return;
 
-    if (precompiled_cache_virtual_file.GetSize() == 0) {
-        SavePrecompiledHeaderToVirtualPrecompiledCache();
-    }
-
-    if (!SaveDecompiledFile(unique_identifier, code, entries)) {
+    precompiled_cache_virtual_file.Resize(0);
+    precompiled_cache_virtual_file_offset = 0;
+    if (!SaveDecompiledFile(code, entries)) {
         LOG_ERROR(Render_OpenGL,
                   "Failed to save decompiled entry to the precompiled file - removing");
         InvalidatePrecompiled();
+        return;
     }
+
+    ShaderDiskCacheUsage usage;
+    usage.unique_identifier = unique_identifier;
+    QueuePrecompiledEntry(PrecompiledEntryKind::Decompiled, usage);
 }
 
 void ShaderDiskCacheOpenGL::SaveDump(const ShaderDiskCacheUsage& usage, GLuint program) {
@@ -553,9 +649,9 @@ void ShaderDiskCacheOpenGL::SaveDump(const ShaderDiskCacheUsage& usage, GLuint p
     std::vector<u8> binary(binary_length);
     glGetProgramBinary(program, binary_length, nullptr, &binary_format, binary.data());
 
-    if (!SaveObjectToPrecompiled(static_cast<u32>(PrecompiledEntryKind::Dump)) ||
-        !SaveObjectToPrecompiled(usage) ||
-        !SaveObjectToPrecompiled(static_cast<u32>(binary_format)) ||
+    precompiled_cache_virtual_file.Resize(0);
+    precompiled_cache_virtual_file_offset = 0;
+    if (!SaveObjectToPrecompiled(static_cast<u32>(binary_format)) ||
         !SaveObjectToPrecompiled(static_cast<u32>(binary_length)) ||
         !SaveArrayToPrecompiled(binary.data(), binary.size())) {
         LOG_ERROR(Render_OpenGL, "Failed to save binary program file in shader={:016x} - removing",
@@ -563,6 +659,7 @@ void ShaderDiskCacheOpenGL::SaveDump(const ShaderDiskCacheUsage& usage, GLuint p
         InvalidatePrecompiled();
         return;
     }
+    QueuePrecompiledEntry(PrecompiledEntryKind::Dump, usage);
 }
 
 bool ShaderDiskCacheOpenGL::IsUsable() const {
@@ -592,33 +689,71 @@ FileUtil::IOFile ShaderDiskCacheOpenGL::AppendTransferableFile() const {
     return file;
 }
 
-void ShaderDiskCacheOpenGL::SavePrecompiledHeaderToVirtualPrecompiledCache() {
-    const auto hash{GetShaderCacheVersionHash()};
-    if (!SaveArrayToPrecompiled(hash.data(), hash.size())) {
-        LOG_ERROR(
-            Render_OpenGL,
-            "Failed to write precompiled cache version hash to virtual precompiled cache file");
+void ShaderDiskCacheOpenGL::SavePrecompiledFile() {
+    if (pending_entries.empty() || !EnsureDirectories()) {
+        return;
     }
-}
 
-void ShaderDiskCacheOpenGL::SaveVirtualPrecompiledFile() {
-    precompiled_cache_virtual_file_offset = 0;
-    const std::vector<u8>& uncompressed = precompiled_cache_virtual_file.ReadAllBytes();
-    const std::vector<u8>& compressed =
-        Common::Compression::CompressDataZSTDDefault(uncompressed.data(), uncompressed.size());
+    // Entries are appended to a valid file, otherwise a new one is started
+    const bool append = precompiled_file.IsOpen();
+    precompiled_file.Close();
 
     const auto precompiled_path{GetPrecompiledPath()};
-    FileUtil::IOFile file(precompiled_path, "wb");
-
+    FileUtil::IOFile file(precompiled_path, append ? "ab" : "wb");
     if (!file.IsOpen()) {
         LOG_ERROR(Render_OpenGL, "Failed to open precompiled cache in path={}", precompiled_path);
         return;
     }
-    if (file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
-        LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache version in path={}",
-                  precompiled_path);
+
+    u64 base_offset = sizeof(PrecompiledHeader);
+    if (append) {
+        base_offset = file.GetSize();
+    } else {
+        const PrecompiledHeader header{PrecompiledMagic, PrecompiledVersion,
+                                       GetShaderCacheVersionHash()};
+        if (file.WriteObject(header) != 1) {
+            LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache header in path={}",
+                      precompiled_path);
+            return;
+        }
+    }
+
+    for (auto& entry : pending_entries) {
+        entry.offset += base_offset;
+        if (entry.kind == PrecompiledEntryKind::Decompiled) {
+            decompiled_index.insert_or_assign(entry.usage.unique_identifier, entry);
+        } else {
+            dump_index.insert_or_assign(entry.usage, entry);
+        }
+    }
+    pending_entries.clear();
+
+    // The new index covers every entry, the previous one is left behind as dead space
+    std::vector<PrecompiledIndexEntry> index;
+    index.reserve(decompiled_index.size() + dump_index.size());
+    for (const auto& [unique_identifier, entry] : decompiled_index) {
+        index.push_back(entry);
+    }
+    for (const auto& [usage, entry] : dump_index) {
+        index.push_back(entry);
+    }
+    const PrecompiledFooter footer{base_offset + pending_data.size(),
+                                   static_cast<u32>(index.size()), PrecompiledMagic};
+
+    if (file.WriteBytes(pending_data.data(), pending_data.size()) != pending_data.size() ||
+        file.WriteArray(index.data(), index.size()) != index.size() ||
+        file.WriteObject(footer) != 1) {
+        LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache in path={}", precompiled_path);
+        pending_data.clear();
+        file.Close();
+        InvalidatePrecompiled();
         return;
     }
+    pending_data.clear();
+    file.Close();
+
+    // Keep the file open to read entries from it
+    precompiled_file.Open(precompiled_path, "rb");
 }
 
 bool ShaderDiskCacheOpenGL::EnsureDirectories() const {
@@ -640,7 +775,9 @@ std::string ShaderDiskCacheOpenGL::GetTransferablePath() const {
 }
 
 std::string ShaderDiskCacheOpenGL::GetPrecompiledPath() const {
-    return FileUtil::SanitizePath(GetPrecompiledDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
+    // Program binaries specialized for bindless textures don't replace the regular ones
+    const char* const suffix = bindless_textures ? "_bindless.bin" : ".bin";
+    return FileUtil::SanitizePath(GetPrecompiledDir() + DIR_SEP_CHR + GetTitleID() + suffix);
 }
 
 std::string ShaderDiskCacheOpenGL::GetTransferableDir() const {
@@ -5,6 +5,8 @@
 #pragma once
 
 #include <bitset>
+#include <future>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -17,6 +19,7 @@
 
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "core/file_sys/vfs_vector.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 
@@ -24,17 +27,9 @@ namespace Core {
 class System;
 }
 
-namespace FileUtil {
-class IOFile;
-}
-
 namespace OpenGL {
 
-struct ShaderDiskCacheUsage;
-struct ShaderDiskCacheDump;
-
 using ProgramCode = std::vector<u64>;
-using ShaderDumpsMap = std::unordered_map<ShaderDiskCacheUsage, ShaderDiskCacheDump>;
 using TextureBufferUsage = std::bitset<64>;
 
 /// Allocated bindings used by an OpenGL shader program
@@ -176,17 +171,29 @@ struct ShaderDiskCacheDump {
 
 class ShaderDiskCacheOpenGL {
 public:
-    explicit ShaderDiskCacheOpenGL(Core::System& system);
+    explicit ShaderDiskCacheOpenGL(Core::System& system, bool bindless_textures);
     ~ShaderDiskCacheOpenGL();
 
+    /// Starts reading the transferable cache of the given title on another thread, while the game
+    /// is still loading. LoadTransferable takes the result if the title is the one that booted.
+    void PrefetchTransferable(u64 title_id);
+
     /// Loads transferable cache. If file has a old version or on failure, it deletes the file.
     std::optional<std::pair<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>>>
     LoadTransferable();
 
-    /// Loads current game's precompiled cache. Invalidates on failure.
-    std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>,
-              std::unordered_map<ShaderDiskCacheUsage, ShaderDiskCacheDump>>
-    LoadPrecompiled();
+    /// Loads the index of current game's precompiled cache, entries are only read once they are
+    /// asked for. Invalidates on failure.
+    void LoadPrecompiled();
+
+    /// Reads a decompiled entry from the precompiled cache. Thread safe.
+    std::optional<ShaderDiskCacheDecompiled> LoadDecompiled(u64 unique_identifier);
+
+    /// Reads a dump entry from the precompiled cache. Thread safe.
+    std::optional<ShaderDiskCacheDump> LoadDump(const ShaderDiskCacheUsage& usage);
+
+    /// Returns true when the precompiled cache has a dump for the given usage.
+    bool HasDump(const ShaderDiskCacheUsage& usage) const;
 
     /// Removes the transferable (and precompiled) cache file.
     void InvalidateTransferable();
@@ -200,29 +207,58 @@ public:
     /// Saves shader usage to the transferable file. Does not check for collisions.
     void SaveUsage(const ShaderDiskCacheUsage& usage);
 
-    /// Saves a decompiled entry to the precompiled file. Does not check for collisions.
+    /// Queues a decompiled entry for the precompiled file. Does not check for collisions.
     void SaveDecompiled(u64 unique_identifier, const std::string& code,
                         const GLShader::ShaderEntries& entries);
 
-    /// Saves a dump entry to the precompiled file. Does not check for collisions.
+    /// Queues a dump entry for the precompiled file. Does not check for collisions.
     void SaveDump(const ShaderDiskCacheUsage& usage, GLuint program);
 
-    /// Serializes virtual precompiled shader cache file to real file
-    void SaveVirtualPrecompiledFile();
+    /// Appends the queued entries and a new index to the precompiled file. Space taken by
+    /// superseded indices is only reclaimed when the file is rebuilt.
+    void SavePrecompiledFile();
 
 private:
-    /// Loads the transferable cache. Returns empty on failure.
-    std::optional<std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>,
-                            std::unordered_map<ShaderDiskCacheUsage, ShaderDiskCacheDump>>>
-    LoadPrecompiledFile(FileUtil::IOFile& file);
+    enum class PrecompiledEntryKind : u32 {
+        Decompiled,
+        Dump,
+    };
+
+    /// Locates a compressed entry in the precompiled file.
+    struct PrecompiledIndexEntry {
+        PrecompiledEntryKind kind;
+        u32 size;
+        u64 offset;
+        ShaderDiskCacheUsage usage; ///< Only the unique identifier is used by decompiled entries
+    };
+
+    /// Contents of a transferable file as read from disk.
+    struct TransferableFile {
+        std::optional<
+            std::pair<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>>>
+            entries;
+        bool is_outdated{}; ///< The file has an older version and has to be removed
+    };
+
+    /// Reads and parses a transferable file. Doesn't touch the cache, so it can run on any thread.
+    static TransferableFile ReadTransferable(const std::string& path, const std::string& title_id);
+
+    /// Reads the header and the index of the precompiled file. Returns false on failure.
+    bool LoadPrecompiledIndex();
+
+    /// Reads and decompresses an entry into the virtual precompiled cache file. Has to be called
+    /// with the precompiled mutex held.
+    bool ReadPrecompiledEntry(const PrecompiledIndexEntry& entry);
+
+    /// Compresses the contents of the virtual precompiled cache file and queues them as an entry.
+    void QueuePrecompiledEntry(PrecompiledEntryKind kind, const ShaderDiskCacheUsage& usage);
 
     /// Loads a decompiled cache entry from m_precompiled_cache_virtual_file. Returns empty on
     /// failure.
     std::optional<ShaderDiskCacheDecompiled> LoadDecompiledEntry();
 
-    /// Saves a decompiled entry to the passed file. Returns true on success.
-    bool SaveDecompiledFile(u64 unique_identifier, const std::string& code,
-                            const GLShader::ShaderEntries& entries);
+    /// Saves a decompiled entry to the virtual precompiled cache file. Returns true on success.
+    bool SaveDecompiledFile(const std::string& code, const GLShader::ShaderEntries& entries);
 
     /// Returns if the cache can be used
     bool IsUsable() const;
@@ -230,9 +266,6 @@ private:
     /// Opens current game's transferable file and write it's header if it doesn't exist
     FileUtil::IOFile AppendTransferableFile() const;
 
-    /// Save precompiled header to precompiled_cache_in_memory
-    void SavePrecompiledHeaderToVirtualPrecompiledCache();
-
     /// Create shader disk cache directories. Returns true on success.
     bool EnsureDirectories() const;
 
@@ -286,16 +319,32 @@ private:
     }
 
     Core::System& system;
+    bool bindless_textures{}; ///< Programs are specialized to read bindless texture handles
 
-    // Stores whole precompiled cache which will be read from or saved to the precompiled chache
-    // file
+    // Stores the uncompressed entry of the precompiled cache being read or written
     FileSys::VectorVfsFile precompiled_cache_virtual_file;
     // Stores the current offset of the precompiled cache file for IO purposes
     std::size_t precompiled_cache_virtual_file_offset = 0;
 
+    // Precompiled file kept open to read entries on demand, guarded by precompiled_mutex
+    FileUtil::IOFile precompiled_file;
+    std::mutex precompiled_mutex;
+
+    // Index of the entries in the precompiled file
+    std::unordered_map<u64, PrecompiledIndexEntry> decompiled_index;
+    std::unordered_map<ShaderDiskCacheUsage, PrecompiledIndexEntry> dump_index;
+
+    // Entries waiting to be appended, their offsets are relative to the start of pending_data
+    std::vector<PrecompiledIndexEntry> pending_entries;
+    std::vector<u8> pending_data;
+
     // Stored transferable shaders
     std::unordered_map<u64, std::unordered_set<ShaderDiskCacheUsage>> transferable;
 
+    // Transferable file being read by PrefetchTransferable and the title it belongs to
+    std::future<TransferableFile> prefetched_transferable;
+    u64 prefetched_title_id{};
+
     // The cache has been loaded at boot
     bool tried_to_load{};
 };
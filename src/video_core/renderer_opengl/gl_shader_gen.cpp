@@ -21,6 +21,9 @@ static constexpr u32 COMPUTE_OFFSET = 0;
 
 static constexpr CompilerSettings settings{CompileDepth::NoFlowStack, true};
 
+/// Generic attributes forwarded by the fallback programs
+static constexpr u32 NUM_FALLBACK_ATTRIBUTES = 8;
+
 ProgramResult GenerateVertexShader(const Device& device, const ShaderSetup& setup) {
     const std::string id = fmt::format("{:016x}", setup.program.unique_identifier);
 
@@ -130,4 +133,46 @@ void main() {
     return {std::move(out), std::move(program.second)};
 }
 
+std::string GenerateFallbackVertexShader() {
+    std::string out = "// Fallback vertex shader\n\n";
+    out += GetCommonDeclarations();
+
+    for (u32 i = 0; i < NUM_FALLBACK_ATTRIBUTES; ++i) {
+        out += fmt::format("layout (location = {0}) in vec4 input_attr_{0};\n", i);
+        out += fmt::format("layout (location = {0}) out vec4 output_attr_{0};\n", i);
+    }
+
+    out += R"(
+void main() {
+    // Assume the position is the first attribute and is already in clip space, as it is for most
+    // full screen and 2D draws
+    gl_Position = input_attr_0;
+)";
+    for (u32 i = 0; i < NUM_FALLBACK_ATTRIBUTES; ++i) {
+        out += fmt::format("    output_attr_{0} = input_attr_{0};\n", i);
+    }
+    out += R"(
+    gl_Position.y *= utof(config_pack[2]);
+    if (config_pack[1] == 1) {
+        gl_Position.xy *= viewport_flip.xy;
+    }
+})";
+    return out;
+}
+
+std::string GenerateFallbackFragmentShader() {
+    std::string out = "// Fallback fragment shader\n\n";
+    out += GetCommonDeclarations();
+
+    out += R"(
+layout (location = 0) in vec4 input_attr_0;
+layout (location = 0) out vec4 FragColor0;
+
+void main() {
+    // The first varying is usually a color or a texture coordinate, either is a fair guess
+    FragColor0 = input_attr_0;
+})";
+    return out;
+}
+
 } // namespace OpenGL::GLShader
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "common/common_types.h"
@@ -57,4 +58,12 @@ ProgramResult GenerateFragmentShader(const Device& device, const ShaderSetup& se
 /// Generates the GLSL compute shader program source code for the given CS program
 ProgramResult GenerateComputeShader(const Device& device, const ShaderSetup& setup);
 
+/// Generates a GLSL vertex shader that passes through the vertex attributes, to stand in for a
+/// vertex program that is still being built
+std::string GenerateFallbackVertexShader();
+
+/// Generates a GLSL fragment shader that writes the first varying to the first render target, to
+/// stand in for a fragment program that is still being built
+std::string GenerateFallbackFragmentShader();
+
 } // namespace OpenGL::GLShader
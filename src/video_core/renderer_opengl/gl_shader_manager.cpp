@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include "common/common_types.h"
 #include "core/settings.h"
@@ -21,6 +22,12 @@ void StageProgram::SetUniformLocations() {
     viewport_flip_location = glGetUniformLocation(handle, "viewport_flip");
 }
 
+void StageProgram::AccountProgramSize() {
+    GLint binary_length = 0;
+    glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    program_memory.Resize(static_cast<std::size_t>(std::max(binary_length, 0)));
+}
+
 void StageProgram::UpdateConstants() {
     if (state.config_pack != old_state.config_pack) {
         glProgramUniform4uiv(handle, config_pack_location, 1, state.config_pack.data());
@@ -11,6 +11,7 @@
 #include <glad/glad.h>
 
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/maxwell_to_gl.h"
@@ -28,6 +29,9 @@ public:
 
     void SetUniformLocations();
 
+    /// Accounts the size of the linked program, as reported by the driver, as shader memory.
+    void AccountProgramSize();
+
     void UpdateConstants();
 
     void SetInstanceID(GLuint instance_id) {
@@ -70,6 +74,9 @@ private:
 
     State state;
     State old_state;
+
+    Common::MemoryAccounting::TrackedAllocation program_memory{
+        Common::MemoryAccounting::Tag::ShaderPrograms};
 };
 
 class ProgramManager final {
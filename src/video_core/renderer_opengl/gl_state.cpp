@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <bitset>
 #include <iterator>
 #include <glad/glad.h>
 #include "common/assert.h"
+#include "common/bit_util.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "video_core/renderer_opengl/gl_state.h"
@@ -16,9 +18,23 @@ namespace OpenGL {
 using Maxwell = Tegra::Engines::Maxwell3D::Regs;
 
 OpenGLState OpenGLState::cur_state;
+const OpenGLState* OpenGLState::applied_state = nullptr;
+
+static_assert(Maxwell::NumTextureSamplers <= 32 && Maxwell::NumImages <= 32 &&
+                  Maxwell::NumViewports <= 32,
+              "Dirty masks are too small");
 
 namespace {
 
+/// Returns a mask with one bit for each entry of an array of the given size.
+constexpr u32 FullMask(std::size_t size) {
+    return size >= 32 ? ~0U : (1U << size) - 1;
+}
+
+u32 CountBits(u32 mask) {
+    return static_cast<u32>(std::bitset<32>(mask).count());
+}
+
 template <typename T>
 bool UpdateValue(T& current_value, const T new_value) {
     const bool changed = current_value != new_value;
@@ -33,11 +49,14 @@ bool UpdateTie(T1 current_value, const T2 new_value) {
     return changed;
 }
 
+/// Updates the entries in the mask, returns the range that has to be bound again if any changed.
 template <typename T>
-std::optional<std::pair<GLuint, GLsizei>> UpdateArray(T& current_values, const T& new_values) {
+std::optional<std::pair<GLuint, GLsizei>> UpdateArray(T& current_values, const T& new_values,
+                                                      u32 mask) {
     std::optional<std::size_t> first;
     std::size_t last;
-    for (std::size_t i = 0; i < std::size(current_values); ++i) {
+    for (mask &= FullMask(std::size(current_values)); mask != 0; mask &= mask - 1) {
+        const std::size_t i = Common::CountTrailingZeroes32(mask);
         if (!UpdateValue(current_values[i], new_values[i])) {
             continue;
         }
@@ -177,6 +196,8 @@ OpenGLState::OpenGLState() {
     alpha_test.enabled = false;
     alpha_test.func = GL_ALWAYS;
     alpha_test.ref = 0.0f;
+
+    AllDirty();
 }
 
 void OpenGLState::SetDefaultViewports() {
@@ -196,6 +217,17 @@ void OpenGLState::SetDefaultViewports() {
 
     depth_clamp.far_plane = false;
     depth_clamp.near_plane = false;
+    dirty.viewports = ~0U;
+}
+
+void OpenGLState::MarkDirtyIfSwitched() {
+    if (applied_state == this) {
+        return;
+    }
+    // Another state was applied in between, what was written to this one since its last apply is
+    // not enough to know what differs from the current state
+    AllDirty();
+    applied_state = this;
 }
 
 void OpenGLState::ApplyDefaultState() {
@@ -366,8 +398,13 @@ void OpenGLState::ApplyStencilTest() const {
     ConfigStencil(GL_BACK, stencil.back, cur_state.stencil.back);
 }
 
-void OpenGLState::ApplyViewport() const {
-    for (GLuint i = 0; i < static_cast<GLuint>(Maxwell::NumViewports); ++i) {
+void OpenGLState::ApplyViewport() {
+    MarkDirtyIfSwitched();
+    const u32 mask = dirty.viewports & FullMask(Maxwell::NumViewports);
+    dirty.viewports = 0;
+    stats.calls_avoided += static_cast<u32>(Maxwell::NumViewports) - CountBits(mask);
+    for (u32 remaining = mask; remaining != 0; remaining &= remaining - 1) {
+        const GLuint i = Common::CountTrailingZeroes32(remaining);
         const auto& updated = viewports[i];
         auto& current = cur_state.viewports[i];
 
@@ -380,12 +417,14 @@ void OpenGLState::ApplyViewport() const {
             glViewportIndexedf(i, static_cast<GLfloat>(updated.x), static_cast<GLfloat>(updated.y),
                                static_cast<GLfloat>(updated.width),
                                static_cast<GLfloat>(updated.height));
+            ++stats.calls_issued;
         }
         if (current.depth_range_near != updated.depth_range_near ||
             current.depth_range_far != updated.depth_range_far) {
             current.depth_range_near = updated.depth_range_near;
             current.depth_range_far = updated.depth_range_far;
             glDepthRangeIndexed(i, updated.depth_range_near, updated.depth_range_far);
+            ++stats.calls_issued;
         }
 
         Enable(GL_SCISSOR_TEST, i, current.scissor.enabled, updated.scissor.enabled);
@@ -399,6 +438,7 @@ void OpenGLState::ApplyViewport() const {
             current.scissor.height = updated.scissor.height;
             glScissorIndexed(i, updated.scissor.x, updated.scissor.y, updated.scissor.width,
                              updated.scissor.height);
+            ++stats.calls_issued;
         }
     }
 }
@@ -507,26 +547,43 @@ void OpenGLState::ApplyAlphaTest() const {
     }
 }
 
-void OpenGLState::ApplyTextures() const {
-    if (const auto update = UpdateArray(cur_state.textures, textures)) {
+void OpenGLState::ApplyTextures() {
+    MarkDirtyIfSwitched();
+    stats.calls_avoided += static_cast<u32>(Maxwell::NumTextureSamplers) -
+                           CountBits(dirty.textures & FullMask(textures.size()));
+    if (const auto update = UpdateArray(cur_state.textures, textures, dirty.textures)) {
         glBindTextures(update->first, update->second, textures.data() + update->first);
+        ++stats.calls_issued;
     }
+    dirty.textures = 0;
 }
 
-void OpenGLState::ApplySamplers() const {
-    if (const auto update = UpdateArray(cur_state.samplers, samplers)) {
+void OpenGLState::ApplySamplers() {
+    MarkDirtyIfSwitched();
+    stats.calls_avoided += static_cast<u32>(Maxwell::NumTextureSamplers) -
+                           CountBits(dirty.samplers & FullMask(samplers.size()));
+    if (const auto update = UpdateArray(cur_state.samplers, samplers, dirty.samplers)) {
         glBindSamplers(update->first, update->second, samplers.data() + update->first);
+        ++stats.calls_issued;
     }
+    dirty.samplers = 0;
 }
 
-void OpenGLState::ApplyImages() const {
-    if (const auto update = UpdateArray(cur_state.images, images)) {
+void OpenGLState::ApplyImages() {
+    MarkDirtyIfSwitched();
+    stats.calls_avoided += static_cast<u32>(Maxwell::NumImages) -
+                           CountBits(dirty.images & FullMask(images.size()));
+    if (const auto update = UpdateArray(cur_state.images, images, dirty.images)) {
         glBindImageTextures(update->first, update->second, images.data() + update->first);
+        ++stats.calls_issued;
     }
+    dirty.images = 0;
 }
 
 void OpenGLState::Apply() {
     MICROPROFILE_SCOPE(OpenGL_State);
+    stats = {};
+    MarkDirtyIfSwitched();
     ApplyFramebufferState();
     ApplyVertexArrayState();
     ApplyShaderProgram();
@@ -538,12 +595,16 @@ void OpenGLState::Apply() {
     if (dirty.color_mask) {
         ApplyColorMask();
         dirty.color_mask = false;
+    } else {
+        ++stats.calls_avoided;
     }
     ApplyDepthClamp();
     ApplyViewport();
     if (dirty.stencil_state) {
         ApplyStencilTest();
         dirty.stencil_state = false;
+    } else {
+        ++stats.calls_avoided;
     }
     ApplySRgb();
     ApplyCulling();
@@ -552,6 +613,8 @@ void OpenGLState::Apply() {
     if (dirty.blend_state) {
         ApplyBlending();
         dirty.blend_state = false;
+    } else {
+        ++stats.calls_avoided;
     }
     ApplyLogicOp();
     ApplyTextures();
@@ -560,11 +623,17 @@ void OpenGLState::Apply() {
     if (dirty.polygon_offset) {
         ApplyPolygonOffset();
         dirty.polygon_offset = false;
+    } else {
+        ++stats.calls_avoided;
     }
     ApplyAlphaTest();
+
+    MICROPROFILE_META_CPU("GL calls issued", static_cast<int>(stats.calls_issued));
+    MICROPROFILE_META_CPU("GL calls avoided", static_cast<int>(stats.calls_avoided));
 }
 
 void OpenGLState::EmulateViewportWithScissor() {
+    MarkDirtyViewport(0);
     auto& current = viewports[0];
     if (current.scissor.enabled) {
         const GLint left = std::max(current.x, current.scissor.x);
@@ -592,6 +661,7 @@ OpenGLState& OpenGLState::UnbindTexture(GLuint handle) {
             texture = 0;
         }
     }
+    dirty.textures = ~0U;
     return *this;
 }
 
@@ -601,6 +671,7 @@ OpenGLState& OpenGLState::ResetSampler(GLuint handle) {
             sampler = 0;
         }
     }
+    dirty.samplers = ~0U;
     return *this;
 }
 
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <glad/glad.h>
+#include "common/common_types.h"
 #include "video_core/engines/maxwell_3d.h"
 
 namespace OpenGL {
@@ -170,9 +171,11 @@ public:
 
     OpenGLState();
 
-    /// Get the currently active OpenGL state
+    /// Get the currently active OpenGL state, the copy is marked as dirty as a whole
     static OpenGLState GetCurState() {
-        return cur_state;
+        OpenGLState state = cur_state;
+        state.AllDirty();
+        return state;
     }
 
     void SetDefaultViewports();
@@ -193,14 +196,14 @@ public:
     void ApplyDepth() const;
     void ApplyPrimitiveRestart() const;
     void ApplyStencilTest() const;
-    void ApplyViewport() const;
+    void ApplyViewport();
     void ApplyTargetBlending(std::size_t target, bool force) const;
     void ApplyGlobalBlending() const;
     void ApplyBlending() const;
     void ApplyLogicOp() const;
-    void ApplyTextures() const;
-    void ApplySamplers() const;
-    void ApplyImages() const;
+    void ApplyTextures();
+    void ApplySamplers();
+    void ApplyImages();
     void ApplyDepthClamp() const;
     void ApplyPolygonOffset() const;
     void ApplyAlphaTest() const;
@@ -235,23 +238,57 @@ public:
         dirty.color_mask = true;
     }
 
+    /// Marks the texture and the sampler of a unit as written.
+    void MarkDirtyTexture(std::size_t unit) {
+        dirty.textures |= 1U << unit;
+        dirty.samplers |= 1U << unit;
+    }
+
+    void MarkDirtyImage(std::size_t unit) {
+        dirty.images |= 1U << unit;
+    }
+
+    /// Marks the viewport and the scissor of an index as written.
+    void MarkDirtyViewport(std::size_t index) {
+        dirty.viewports |= 1U << index;
+    }
+
     void AllDirty() {
         dirty.blend_state = true;
         dirty.stencil_state = true;
         dirty.polygon_offset = true;
         dirty.color_mask = true;
+        dirty.textures = ~0U;
+        dirty.samplers = ~0U;
+        dirty.images = ~0U;
+        dirty.viewports = ~0U;
     }
 
 private:
+    /// Marks everything as dirty when the last applied state was a different one.
+    void MarkDirtyIfSwitched();
+
     static OpenGLState cur_state;
 
+    /// State applied last, any other state has to compare all of its sections against cur_state.
+    static const OpenGLState* applied_state;
+
     struct {
         bool blend_state;
         bool stencil_state;
-        bool viewport_state;
         bool polygon_offset;
         bool color_mask;
+        u32 textures;  ///< Texture units written since the last apply, one bit each
+        u32 samplers;  ///< Sampler units written since the last apply, one bit each
+        u32 images;    ///< Image units written since the last apply, one bit each
+        u32 viewports; ///< Viewports and scissors written since the last apply, one bit each
     } dirty{};
+
+    /// GL calls issued and bindings skipped as clean by the apply in progress.
+    struct {
+        u32 calls_issued;
+        u32 calls_avoided;
+    } stats{};
 };
 
 } // namespace OpenGL
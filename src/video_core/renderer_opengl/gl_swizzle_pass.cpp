@@ -0,0 +1,178 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+
+#include <glad/glad.h>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_swizzle_pass.h"
+#include "video_core/texture_cache/surface_params.h"
+
+namespace OpenGL {
+
+using VideoCore::Surface::SurfaceCompression;
+using VideoCore::Surface::SurfaceTarget;
+using VideoCommon::SurfaceParams;
+
+namespace {
+
+/// Surfaces smaller than this are cheaper to convert on the CPU than to dispatch for.
+constexpr std::size_t MinGuestSize = 1ULL << 20;
+
+constexpr u32 GobSizeX = 64;
+constexpr u32 LocalSizeX = 32;
+constexpr u32 LocalSizeY = 8;
+
+constexpr GLuint SwizzledBinding = 0;
+constexpr GLuint LinearBinding = 1;
+
+// Every invocation moves one element, made of one to four words. The addressing is the same as
+// the CPU implementation in video_core/textures/decoders.cpp.
+constexpr char SWIZZLE_SOURCE[] = R"(
+layout (local_size_x = 32, local_size_y = 8) in;
+
+layout (std430, binding = 0) buffer SwizzledBuffer {
+    uint swizzled[];
+};
+
+layout (std430, binding = 1) buffer LinearBuffer {
+    uint linear[];
+};
+
+layout (location = 0) uniform uvec3 size;
+layout (location = 1) uniform uint words_per_element;
+layout (location = 2) uniform uint block_height;
+layout (location = 3) uniform uint block_depth;
+layout (location = 4) uniform uint gobs_on_x;
+layout (location = 5) uniform uint swizzled_offset;
+layout (location = 6) uniform uint linear_offset;
+
+uint GobOffset(uint x, uint y) {
+    return ((x % 64) / 32) * 256 + ((y % 8) / 2) * 64 + ((x % 32) / 16) * 32 + (y % 2) * 16 +
+           (x % 16);
+}
+
+void main() {
+    const uvec3 pos = gl_GlobalInvocationID;
+    if (any(greaterThanEqual(pos, size))) {
+        return;
+    }
+    const uint x = pos.x * words_per_element * 4;
+    const uint block_rows = 8U << block_height;
+    const uint blocks_on_y = (size.y + block_rows - 1) / block_rows;
+    const uint block_size = 512U << (block_height + block_depth);
+
+    const uint block_index = (pos.z >> block_depth) * blocks_on_y * gobs_on_x +
+                             (pos.y / block_rows) * gobs_on_x + x / 64;
+    uint offset = block_index * block_size;
+    offset += (pos.z & ((1U << block_depth) - 1)) * (512U << block_height);
+    offset += ((pos.y % block_rows) / 8) * 512;
+    offset += GobOffset(x, pos.y);
+
+    const uint swizzled_index = swizzled_offset + offset / 4;
+    const uint linear_index =
+        linear_offset + ((pos.z * size.y + pos.y) * size.x + pos.x) * words_per_element;
+    for (uint word = 0; word < words_per_element; ++word) {
+#ifdef UNSWIZZLE
+        linear[linear_index + word] = swizzled[swizzled_index + word];
+#else
+        swizzled[swizzled_index + word] = linear[linear_index + word];
+#endif
+    }
+}
+)";
+
+OGLProgram CreateProgram(bool unswizzle) {
+    std::string source = "#version 430 core\n";
+    if (unswizzle) {
+        source += "#define UNSWIZZLE\n";
+    }
+    source += SWIZZLE_SOURCE;
+
+    OGLShader shader;
+    shader.Create(source.c_str(), GL_COMPUTE_SHADER);
+    OGLProgram program;
+    program.Create(false, false, shader.handle);
+    return program;
+}
+
+void Grow(OGLBuffer& buffer, std::size_t& capacity, std::size_t size) {
+    if (size <= capacity) {
+        return;
+    }
+    capacity = Common::AlignUp(size, MinGuestSize);
+    buffer.Release();
+    buffer.Create();
+    buffer.MakeStreamCopy(capacity);
+}
+
+} // Anonymous namespace
+
+SwizzlePass::SwizzlePass()
+    : unswizzle_program{CreateProgram(true)}, swizzle_program{CreateProgram(false)} {}
+
+SwizzlePass::~SwizzlePass() = default;
+
+bool SwizzlePass::IsCompatible(const SurfaceParams& params) {
+    if (!params.is_tiled || params.block_width != 0 || params.IsBuffer()) {
+        return false;
+    }
+    if (params.GetCompressionType() != SurfaceCompression::None) {
+        return false;
+    }
+    const u32 bytes_per_pixel = params.GetBytesPerPixel();
+    if (bytes_per_pixel != 4 && bytes_per_pixel != 8 && bytes_per_pixel != 16) {
+        return false;
+    }
+    return params.GetGuestSizeInBytes() >= MinGuestSize;
+}
+
+void SwizzlePass::Reserve(std::size_t swizzled_size, std::size_t linear_size) {
+    Grow(swizzled_buffer, swizzled_capacity, swizzled_size);
+    Grow(linear_buffer, linear_capacity, linear_size);
+}
+
+void SwizzlePass::Unswizzle(const Image& image, u32 bytes_per_pixel) {
+    Dispatch(unswizzle_program, image, bytes_per_pixel);
+}
+
+void SwizzlePass::Swizzle(const Image& image, u32 bytes_per_pixel) {
+    Dispatch(swizzle_program, image, bytes_per_pixel);
+}
+
+void SwizzlePass::Dispatch(const OGLProgram& program, const Image& image, u32 bytes_per_pixel) {
+    ASSERT(bytes_per_pixel % 4 == 0);
+    ASSERT(image.swizzled_offset % 4 == 0 && image.linear_offset % 4 == 0);
+
+    const u32 gob_elements_x = GobSizeX / bytes_per_pixel;
+    const u32 aligned_width =
+        Common::AlignUp(image.width, gob_elements_x * image.tile_width_spacing);
+    const u32 gobs_on_x = aligned_width / gob_elements_x;
+
+    const GLuint handle = program.handle;
+    glProgramUniform3ui(handle, 0, image.width, image.height, image.depth);
+    glProgramUniform1ui(handle, 1, bytes_per_pixel / 4);
+    glProgramUniform1ui(handle, 2, image.block_height);
+    glProgramUniform1ui(handle, 3, image.block_depth);
+    glProgramUniform1ui(handle, 4, gobs_on_x);
+    glProgramUniform1ui(handle, 5, static_cast<GLuint>(image.swizzled_offset / 4));
+    glProgramUniform1ui(handle, 6, static_cast<GLuint>(image.linear_offset / 4));
+
+    // Storage buffer bindings are set again by the rasterizer before each draw.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SwizzledBinding, swizzled_buffer.handle);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LinearBinding, linear_buffer.handle);
+
+    OpenGLState state = OpenGLState::GetCurState();
+    state.draw.shader_program = handle;
+    state.ApplyShaderProgram();
+
+    glDispatchCompute(Common::AlignUp(image.width, LocalSizeX) / LocalSizeX,
+                      Common::AlignUp(image.height, LocalSizeY) / LocalSizeY, image.depth);
+}
+
+} // namespace OpenGL
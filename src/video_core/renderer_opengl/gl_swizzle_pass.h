@@ -0,0 +1,73 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace VideoCommon {
+class SurfaceParams;
+}
+
+namespace OpenGL {
+
+/**
+ * Converts block linear textures to and from a linear layout with compute shaders. The guest data
+ * is copied as is into a buffer and the (un)swizzling happens on the GPU, the linear result is
+ * then used as a pixel buffer to upload to or download from the texture.
+ */
+class SwizzlePass final {
+public:
+    /// Layout of one image to convert, either a layer or the whole depth of a level.
+    struct Image {
+        u32 width;
+        u32 height;
+        u32 depth;
+        u32 block_height; ///< Log2 of the GOBs in a block on the Y axis.
+        u32 block_depth;  ///< Log2 of the GOBs in a block on the Z axis.
+        u32 tile_width_spacing;
+        std::size_t swizzled_offset; ///< Offset in the swizzled buffer in bytes.
+        std::size_t linear_offset;   ///< Offset in the linear buffer in bytes.
+    };
+
+    SwizzlePass();
+    ~SwizzlePass();
+
+    /// Returns true when surfaces with these parameters can be converted by this pass.
+    static bool IsCompatible(const VideoCommon::SurfaceParams& params);
+
+    /// Makes both buffers at least the given sizes, their previous contents are lost.
+    void Reserve(std::size_t swizzled_size, std::size_t linear_size);
+
+    /// Converts an image from the swizzled buffer into the linear buffer.
+    void Unswizzle(const Image& image, u32 bytes_per_pixel);
+
+    /// Converts an image from the linear buffer into the swizzled buffer.
+    void Swizzle(const Image& image, u32 bytes_per_pixel);
+
+    GLuint GetSwizzledBuffer() const {
+        return swizzled_buffer.handle;
+    }
+
+    GLuint GetLinearBuffer() const {
+        return linear_buffer.handle;
+    }
+
+private:
+    void Dispatch(const OGLProgram& program, const Image& image, u32 bytes_per_pixel);
+
+    OGLProgram unswizzle_program;
+    OGLProgram swizzle_program;
+
+    OGLBuffer swizzled_buffer;
+    OGLBuffer linear_buffer;
+    std::size_t swizzled_capacity = 0;
+    std::size_t linear_capacity = 0;
+};
+
+} // namespace OpenGL
@@ -2,13 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <limits>
 #include "common/assert.h"
 #include "common/bit_util.h"
 #include "common/common_types.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "core/core.h"
+#include "core/settings.h"
 #include "video_core/morton.h"
+#include "video_core/renderer_opengl/gl_framebuffer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_texture_cache.h"
@@ -236,15 +239,26 @@ OGLTexture CreateTexture(const SurfaceParams& params, GLenum target, GLenum inte
     return texture;
 }
 
+bool IsIntegerFormat(ComponentType component_type) {
+    return component_type == ComponentType::SInt || component_type == ComponentType::UInt;
+}
+
 } // Anonymous namespace
 
-CachedSurface::CachedSurface(const GPUVAddr gpu_addr, const SurfaceParams& params)
-    : VideoCommon::SurfaceBase<View>(gpu_addr, params) {
+CachedSurface::CachedSurface(const GPUVAddr gpu_addr, const SurfaceParams& params,
+                             SwizzlePass& swizzle_pass)
+    : VideoCommon::SurfaceBase<View>(gpu_addr, params), swizzle_pass{swizzle_pass} {
     const auto& tuple{GetFormatTuple(params.pixel_format, params.component_type)};
     internal_format = tuple.internal_format;
     format = tuple.format;
     type = tuple.type;
     is_compressed = tuple.compressed;
+    if (params.IsTranscoded()) {
+        internal_format = VideoCore::Surface::IsPixelFormatSRGB(params.pixel_format)
+                              ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                              : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        is_compressed = true;
+    }
 }
 
 void CachedSurface::Init() {
@@ -263,44 +277,195 @@ CachedSurface::~CachedSurface() = default;
 void CachedSurface::DownloadTexture(std::vector<u8>& staging_buffer) {
     MICROPROFILE_SCOPE(OpenGL_Texture_Download);
 
+    if (download_fence.handle != 0) {
+        if (download_tick == GetModificationTick()) {
+            // The texture was already copied when it stopped being rendered to
+            glClientWaitSync(download_fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT,
+                             std::numeric_limits<GLuint64>::max());
+            download_fence.Release();
+            glGetNamedBufferSubData(download_buffer.handle, 0,
+                                    static_cast<GLsizeiptr>(host_memory_size),
+                                    staging_buffer.data());
+            return;
+        }
+        download_fence.Release();
+    }
+
     SCOPE_EXIT({ glPixelStorei(GL_PACK_ROW_LENGTH, 0); });
 
     for (u32 level = 0; level < params.emulated_levels; ++level) {
-        glPixelStorei(GL_PACK_ALIGNMENT, std::min(8U, params.GetRowAlignment(level)));
-        glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(params.GetMipWidth(level)));
-        const std::size_t mip_offset = params.GetHostMipmapLevelOffset(level);
-        if (is_compressed) {
-            glGetCompressedTextureImage(texture.handle, level,
-                                        static_cast<GLsizei>(params.GetHostMipmapSize(level)),
-                                        staging_buffer.data() + mip_offset);
-        } else {
-            glGetTextureImage(texture.handle, level, format, type,
-                              static_cast<GLsizei>(params.GetHostMipmapSize(level)),
-                              staging_buffer.data() + mip_offset);
-        }
+        DownloadTextureMipmap(level,
+                              staging_buffer.data() + params.GetHostMipmapLevelOffset(level));
     }
 }
 
+void CachedSurface::PrefetchDownload() {
+    if (IsRescaled() || UseSwizzlePass()) {
+        // Rescaled textures aren't downloaded at their host size, the swizzle pass flushes from
+        // its own buffers
+        return;
+    }
+    MICROPROFILE_SCOPE(OpenGL_Texture_Download);
+
+    if (download_buffer.handle == 0) {
+        download_buffer.Create();
+        glNamedBufferStorage(download_buffer.handle, static_cast<GLsizeiptr>(host_memory_size),
+                             nullptr, GL_CLIENT_STORAGE_BIT);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, download_buffer.handle);
+    for (u32 level = 0; level < params.emulated_levels; ++level) {
+        DownloadTextureMipmap(level, reinterpret_cast<u8*>(params.GetHostMipmapLevelOffset(level)));
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    download_fence.Release();
+    download_fence.Create();
+    download_tick = GetModificationTick();
+}
+
 void CachedSurface::UploadTexture(const std::vector<u8>& staging_buffer) {
     MICROPROFILE_SCOPE(OpenGL_Texture_Upload);
     SCOPE_EXIT({ glPixelStorei(GL_UNPACK_ROW_LENGTH, 0); });
+    const bool is_converted = params.GetCompressionType() == SurfaceCompression::Converted;
     for (u32 level = 0; level < params.emulated_levels; ++level) {
-        UploadTextureMipmap(level, staging_buffer);
+        const std::size_t mip_offset = is_converted ? params.GetConvertedMipmapOffset(level)
+                                                    : params.GetHostMipmapLevelOffset(level);
+        UploadTextureMipmap(level, staging_buffer.data() + mip_offset);
     }
 }
 
-void CachedSurface::UploadTextureMipmap(u32 level, const std::vector<u8>& staging_buffer) {
+void CachedSurface::UploadDirtyTexture(const std::vector<u8>& staging_buffer) {
+    MICROPROFILE_SCOPE(OpenGL_Texture_Upload);
+    SCOPE_EXIT({ glPixelStorei(GL_UNPACK_ROW_LENGTH, 0); });
+    ForEachDirtySubresource([&](u32 level, u32 layer) {
+        if (level >= params.emulated_levels) {
+            return;
+        }
+        const u8* const buffer = staging_buffer.data() + params.GetHostMipmapLevelOffset(level);
+        if (params.is_layered) {
+            UploadTextureLayer(level, layer, buffer + params.GetHostLayerSize(level) * layer);
+        } else {
+            UploadTextureMipmap(level, buffer);
+        }
+    });
+}
+
+bool CachedSurface::UseSwizzlePass() const {
+    return Settings::values.use_gpu_texture_swizzle && !IsRescaled() &&
+           SwizzlePass::IsCompatible(params);
+}
+
+template <typename Func>
+void CachedSurface::ForEachSwizzledImage(Func&& func) const {
+    for (u32 level = 0; level < params.num_levels; ++level) {
+        SwizzlePass::Image image;
+        image.width = params.GetMipWidth(level);
+        image.height = params.GetMipHeight(level);
+        image.depth = params.is_layered ? 1 : params.GetMipDepth(level);
+        image.block_height = params.GetMipBlockHeight(level);
+        image.block_depth = params.GetMipBlockDepth(level);
+        image.tile_width_spacing = params.tile_width_spacing;
+        image.swizzled_offset = mipmap_offsets[level];
+        image.linear_offset = params.GetHostMipmapLevelOffset(level);
+        if (!params.is_layered) {
+            func(image);
+            continue;
+        }
+        for (u32 layer = 0; layer < params.depth; ++layer) {
+            func(image);
+            image.swizzled_offset += layer_size;
+            image.linear_offset += params.GetHostLayerSize(level);
+        }
+    }
+}
+
+bool CachedSurface::UploadSwizzledTexture(Tegra::MemoryManager& memory_manager,
+                                          VideoCommon::StagingCache& staging_cache) {
+    if (!UseSwizzlePass()) {
+        return false;
+    }
+    is_continuous = memory_manager.IsBlockContinuous(gpu_addr, guest_memory_size);
+    const u8* const guest_data = GetGuestMemory(memory_manager, staging_cache, true);
+    if (!guest_data) {
+        return false;
+    }
+    MICROPROFILE_SCOPE(OpenGL_Texture_Upload);
+
+    const u32 bytes_per_pixel = params.GetBytesPerPixel();
+    swizzle_pass.Reserve(guest_memory_size, host_memory_size);
+    glNamedBufferSubData(swizzle_pass.GetSwizzledBuffer(), 0,
+                         static_cast<GLsizeiptr>(guest_memory_size), guest_data);
+    ForEachSwizzledImage(
+        [&](const SwizzlePass::Image& image) { swizzle_pass.Unswizzle(image, bytes_per_pixel); });
+    glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, swizzle_pass.GetLinearBuffer());
+    SCOPE_EXIT({
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    });
+    for (u32 level = 0; level < params.emulated_levels; ++level) {
+        UploadTextureMipmap(level,
+                            reinterpret_cast<const u8*>(params.GetHostMipmapLevelOffset(level)));
+    }
+    return true;
+}
+
+bool CachedSurface::DownloadSwizzledTexture(Tegra::MemoryManager& memory_manager,
+                                            VideoCommon::StagingCache& staging_cache) {
+    if (!UseSwizzlePass()) {
+        return false;
+    }
+    // The texels don't cover the whole guest memory, what's between them has to be kept
+    u8* const guest_data = GetGuestMemory(memory_manager, staging_cache, true);
+    if (!guest_data) {
+        return false;
+    }
+    MICROPROFILE_SCOPE(OpenGL_Texture_Download);
+
+    const u32 bytes_per_pixel = params.GetBytesPerPixel();
+    swizzle_pass.Reserve(guest_memory_size, host_memory_size);
+    const GLuint swizzled_buffer = swizzle_pass.GetSwizzledBuffer();
+    glNamedBufferSubData(swizzled_buffer, 0, static_cast<GLsizeiptr>(guest_memory_size),
+                         guest_data);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, swizzle_pass.GetLinearBuffer());
+    for (u32 level = 0; level < params.emulated_levels; ++level) {
+        DownloadTextureMipmap(level, reinterpret_cast<u8*>(params.GetHostMipmapLevelOffset(level)));
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    ForEachSwizzledImage(
+        [&](const SwizzlePass::Image& image) { swizzle_pass.Swizzle(image, bytes_per_pixel); });
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(swizzled_buffer, 0, static_cast<GLsizeiptr>(guest_memory_size),
+                            guest_data);
+    CommitGuestMemory(memory_manager, guest_data);
+    return true;
+}
+
+void CachedSurface::DownloadTextureMipmap(u32 level, u8* buffer) {
+    glPixelStorei(GL_PACK_ALIGNMENT, std::min(8U, params.GetRowAlignment(level)));
+    glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(params.GetMipWidth(level)));
+    if (is_compressed) {
+        glGetCompressedTextureImage(texture.handle, level,
+                                    static_cast<GLsizei>(params.GetHostMipmapSize(level)), buffer);
+    } else {
+        glGetTextureImage(texture.handle, level, format, type,
+                          static_cast<GLsizei>(params.GetHostMipmapSize(level)), buffer);
+    }
+}
+
+void CachedSurface::UploadTextureMipmap(u32 level, const u8* buffer) {
     glPixelStorei(GL_UNPACK_ALIGNMENT, std::min(8U, params.GetRowAlignment(level)));
     glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(params.GetMipWidth(level)));
 
-    auto compression_type = params.GetCompressionType();
-
-    const std::size_t mip_offset = compression_type == SurfaceCompression::Converted
-                                       ? params.GetConvertedMipmapOffset(level)
-                                       : params.GetHostMipmapLevelOffset(level);
-    const u8* buffer{staging_buffer.data() + mip_offset};
     if (is_compressed) {
-        const auto image_size{static_cast<GLsizei>(params.GetHostMipmapSize(level))};
+        const std::size_t mipmap_size = params.IsTranscoded() ? params.GetConvertedMipmapSize(level)
+                                                              : params.GetHostMipmapSize(level);
+        const auto image_size{static_cast<GLsizei>(mipmap_size)};
         switch (params.target) {
         case SurfaceTarget::Texture2D:
             glCompressedTextureSubImage2D(texture.handle, level, 0, 0,
@@ -318,7 +483,8 @@ void CachedSurface::UploadTextureMipmap(u32 level, const std::vector<u8>& stagin
                                           internal_format, image_size, buffer);
             break;
         case SurfaceTarget::TextureCubemap: {
-            const std::size_t layer_size{params.GetHostLayerSize(level)};
+            const std::size_t layer_size{params.IsTranscoded() ? mipmap_size / params.depth
+                                                               : params.GetHostLayerSize(level)};
             for (std::size_t face = 0; face < params.depth; ++face) {
                 glCompressedTextureSubImage3D(texture.handle, level, 0, 0, static_cast<GLint>(face),
                                               static_cast<GLsizei>(params.GetMipWidth(level)),
@@ -370,12 +536,36 @@ void CachedSurface::UploadTextureMipmap(u32 level, const std::vector<u8>& stagin
     }
 }
 
+void CachedSurface::UploadTextureLayer(u32 level, u32 layer, const u8* buffer) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, std::min(8U, params.GetRowAlignment(level)));
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(params.GetMipWidth(level)));
+
+    const auto width = static_cast<GLsizei>(params.GetMipWidth(level));
+    const auto height = static_cast<GLsizei>(params.GetMipHeight(level));
+    if (params.target == SurfaceTarget::Texture1DArray) {
+        // Layers of 1D arrays are the rows of the texture
+        glTextureSubImage2D(texture.handle, level, 0, static_cast<GLint>(layer), width, 1, format,
+                            type, buffer);
+    } else if (is_compressed) {
+        glCompressedTextureSubImage3D(texture.handle, level, 0, 0, static_cast<GLint>(layer), width,
+                                      height, 1, internal_format,
+                                      static_cast<GLsizei>(params.GetHostLayerSize(level)), buffer);
+    } else {
+        glTextureSubImage3D(texture.handle, level, 0, 0, static_cast<GLint>(layer), width, height,
+                            1, format, type, buffer);
+    }
+}
+
 void CachedSurface::DecorateSurfaceName() {
     LabelGLObject(GL_TEXTURE, texture.handle, GetGpuAddr(), params.TargetName());
 }
 
 void CachedSurfaceView::DecorateViewName(GPUVAddr gpu_addr, std::string prefix) {
-    LabelGLObject(GL_TEXTURE, texture_view.handle, gpu_addr, prefix);
+    name_gpu_addr = gpu_addr;
+    name = std::move(prefix);
+    if (texture_view.handle != 0) {
+        LabelGLObject(GL_TEXTURE, texture_view.handle, name_gpu_addr, name);
+    }
 }
 
 View CachedSurface::CreateView(const ViewParams& view_key) {
@@ -394,13 +584,14 @@ CachedSurfaceView::CachedSurfaceView(CachedSurface& surface, const ViewParams& p
                                      const bool is_proxy)
     : VideoCommon::ViewBase(params), surface{surface}, is_proxy{is_proxy} {
     target = GetTextureTarget(params.target);
-    if (!is_proxy) {
-        texture_view = CreateTextureView();
-    }
     swizzle = EncodeSwizzle(SwizzleSource::R, SwizzleSource::G, SwizzleSource::B, SwizzleSource::A);
 }
 
-CachedSurfaceView::~CachedSurfaceView() = default;
+CachedSurfaceView::~CachedSurfaceView() {
+    for (const auto& [key, handle] : bindless_handles) {
+        glMakeTextureHandleNonResidentARB(handle);
+    }
+}
 
 void CachedSurfaceView::Attach(GLenum attachment, GLenum target) const {
     ASSERT(params.num_layers == 1 && params.num_levels == 1);
@@ -434,6 +625,10 @@ void CachedSurfaceView::ApplySwizzle(SwizzleSource x_source, SwizzleSource y_sou
     if (new_swizzle == swizzle)
         return;
     swizzle = new_swizzle;
+    if (!is_proxy && texture_view.handle == 0) {
+        // The swizzle is applied when the texture view is created
+        return;
+    }
     const std::array<GLint, 4> gl_swizzle = {GetSwizzleSource(x_source), GetSwizzleSource(y_source),
                                              GetSwizzleSource(z_source),
                                              GetSwizzleSource(w_source)};
@@ -441,17 +636,63 @@ void CachedSurfaceView::ApplySwizzle(SwizzleSource x_source, SwizzleSource y_sou
     glTextureParameteriv(handle, GL_TEXTURE_SWIZZLE_RGBA, gl_swizzle.data());
 }
 
+GLuint64 CachedSurfaceView::GetBindlessHandle(GLuint sampler, SwizzleSource x_source,
+                                              SwizzleSource y_source, SwizzleSource z_source,
+                                              SwizzleSource w_source) {
+    const bool is_buffer = GetSurfaceParams().IsBuffer();
+    const u32 handle_swizzle =
+        is_buffer ? 0 : EncodeSwizzle(x_source, y_source, z_source, w_source);
+    const u64 key = (static_cast<u64>(handle_swizzle) << 32) | (is_buffer ? 0 : sampler);
+    const auto [it, is_new] = bindless_handles.try_emplace(key);
+    if (!is_new) {
+        return it->second;
+    }
+
+    GLuint64 handle;
+    if (is_buffer) {
+        // Buffer textures are never sampled through a sampler nor swizzled
+        handle = glGetTextureHandleARB(GetTexture());
+    } else {
+        // Creating a handle makes the state of its texture immutable, so handles don't use the
+        // view ApplySwizzle changes but views of their own with the swizzle baked in
+        auto [view, is_new_view] = swizzle_views.try_emplace(handle_swizzle);
+        if (is_new_view) {
+            view->second = CreateTextureView();
+            const std::array<GLint, 4> gl_swizzle = {
+                GetSwizzleSource(x_source), GetSwizzleSource(y_source),
+                GetSwizzleSource(z_source), GetSwizzleSource(w_source)};
+            glTextureParameteriv(view->second.handle, GL_TEXTURE_SWIZZLE_RGBA, gl_swizzle.data());
+        }
+        handle = glGetTextureSamplerHandleARB(view->second.handle, sampler);
+    }
+    glMakeTextureHandleResidentARB(handle);
+    it->second = handle;
+    return handle;
+}
+
+void CachedSurfaceView::CreateMainTextureView() const {
+    texture_view = CreateTextureView();
+    if (swizzle != EncodeSwizzle(SwizzleSource::R, SwizzleSource::G, SwizzleSource::B,
+                                 SwizzleSource::A)) {
+        const auto source = [this](u32 shift) {
+            return GetSwizzleSource(static_cast<SwizzleSource>((swizzle >> shift) & 0xFF));
+        };
+        const std::array<GLint, 4> gl_swizzle = {source(24), source(16), source(8), source(0)};
+        glTextureParameteriv(texture_view.handle, GL_TEXTURE_SWIZZLE_RGBA, gl_swizzle.data());
+    }
+    if (!name.empty()) {
+        LabelGLObject(GL_TEXTURE, texture_view.handle, name_gpu_addr, name);
+    }
+}
+
 OGLTextureView CachedSurfaceView::CreateTextureView() const {
     const auto& owner_params = surface.GetSurfaceParams();
     OGLTextureView texture_view;
     texture_view.Create();
 
     const GLuint handle{texture_view.handle};
-    const FormatTuple& tuple{
-        GetFormatTuple(owner_params.pixel_format, owner_params.component_type)};
-
-    glTextureView(handle, target, surface.texture.handle, tuple.internal_format, params.base_level,
-                  params.num_levels, params.base_layer, params.num_layers);
+    glTextureView(handle, target, surface.texture.handle, surface.internal_format,
+                  params.base_level, params.num_levels, params.base_layer, params.num_layers);
 
     ApplyTextureDefaults(owner_params, handle);
 
@@ -460,8 +701,9 @@ OGLTextureView CachedSurfaceView::CreateTextureView() const {
 
 TextureCacheOpenGL::TextureCacheOpenGL(Core::System& system,
                                        VideoCore::RasterizerInterface& rasterizer,
-                                       const Device& device)
-    : TextureCacheBase{system, rasterizer} {
+                                       const Device& device,
+                                       FramebufferCacheOpenGL& framebuffer_cache)
+    : TextureCacheBase{system, rasterizer}, framebuffer_cache{framebuffer_cache} {
     src_framebuffer.Create();
     dst_framebuffer.Create();
 }
@@ -469,7 +711,7 @@ TextureCacheOpenGL::TextureCacheOpenGL(Core::System& system,
 TextureCacheOpenGL::~TextureCacheOpenGL() = default;
 
 Surface TextureCacheOpenGL::CreateSurface(GPUVAddr gpu_addr, const SurfaceParams& params) {
-    Surface new_surface = std::make_shared<CachedSurface>(gpu_addr, params);
+    Surface new_surface = std::make_shared<CachedSurface>(gpu_addr, params, swizzle_pass);
     SignalCreatedSurface(new_surface);
     new_surface->Init();
     return new_surface;
@@ -505,6 +747,51 @@ void TextureCacheOpenGL::ImageBlit(View& src_view, View& dst_view,
     const auto& src_params{src_view->GetSurfaceParams()};
     const auto& dst_params{dst_view->GetSurfaceParams()};
 
+    if (src_params.target == SurfaceTarget::Texture3D ||
+        dst_params.target == SurfaceTarget::Texture3D) {
+        CountBlitFallback(BlitFallback::Texture3D);
+        return;
+    }
+    if (src_params.type != dst_params.type) {
+        CountBlitFallback(BlitFallback::TypeMismatch);
+        return;
+    }
+
+    const Common::Rectangle<u32>& src_rect = copy_config.src_rect;
+    const Common::Rectangle<u32>& dst_rect = copy_config.dst_rect;
+    const bool is_linear = copy_config.filter == Tegra::Engines::Fermi2D::Filter::Linear;
+
+    const bool src_rescaled = src_view->GetParent().IsRescaled();
+    const bool dst_rescaled = dst_view->GetParent().IsRescaled();
+    const u32 factor1 = src_rescaled ? static_cast<u32>(Settings::values.resolution_factor) : 1U;
+    const u32 factor2 = dst_rescaled ? static_cast<u32>(Settings::values.resolution_factor) : 1U;
+
+    const auto& src_surface = src_view->GetParent();
+    const auto& dst_surface = dst_view->GetParent();
+    const auto& src_view_params = src_view->GetViewParams();
+    const auto& dst_view_params = dst_view->GetViewParams();
+
+    const bool src_integer = IsIntegerFormat(src_params.component_type);
+    const bool dst_integer = IsIntegerFormat(dst_params.component_type);
+    const bool is_scaled = src_rect.GetWidth() * factor1 != dst_rect.GetWidth() * factor2 ||
+                           src_rect.GetHeight() * factor1 != dst_rect.GetHeight() * factor2;
+    if (src_integer != dst_integer ||
+        (src_integer && src_params.component_type != dst_params.component_type)) {
+        // Blits can't convert between these, unscaled copies of the same size are reinterpreted
+        if (is_scaled || src_params.GetBytesPerPixel() != dst_params.GetBytesPerPixel()) {
+            CountBlitFallback(BlitFallback::IntegerMismatch);
+            return;
+        }
+        glCopyImageSubData(src_surface.GetTexture(), src_surface.GetTarget(),
+                           src_view_params.base_level, src_rect.left * factor1,
+                           src_rect.top * factor1, src_view_params.base_layer,
+                           dst_surface.GetTexture(), dst_surface.GetTarget(),
+                           dst_view_params.base_level, dst_rect.left * factor2,
+                           dst_rect.top * factor2, dst_view_params.base_layer,
+                           src_rect.GetWidth() * factor1, src_rect.GetHeight() * factor1, 1);
+        return;
+    }
+
     OpenGLState prev_state{OpenGLState::GetCurState()};
     SCOPE_EXIT({
         prev_state.AllDirty();
@@ -517,13 +804,43 @@ void TextureCacheOpenGL::ImageBlit(View& src_view, View& dst_view,
     state.AllDirty();
     state.Apply();
 
-    u32 buffers{};
+    // Blits within the same image are undefined when the regions overlap, read from a copy instead
+    const bool is_overlapping =
+        &src_surface == &dst_surface && src_view_params.base_layer == dst_view_params.base_layer &&
+        src_view_params.base_level == dst_view_params.base_level &&
+        src_rect.left < dst_rect.right && dst_rect.left < src_rect.right &&
+        src_rect.top < dst_rect.bottom && dst_rect.top < src_rect.bottom;
+    u32 src_x0 = src_rect.left * factor1;
+    u32 src_y0 = src_rect.top * factor1;
+    u32 src_x1 = src_rect.right * factor1;
+    u32 src_y1 = src_rect.bottom * factor1;
+    OGLTexture overlap_copy;
+    if (is_overlapping) {
+        const u32 width = src_x1 - src_x0;
+        const u32 height = src_y1 - src_y0;
+        overlap_copy.Create(GL_TEXTURE_2D);
+        glTextureStorage2D(overlap_copy.handle, 1, src_surface.GetInternalFormat(), width, height);
+        glCopyImageSubData(src_surface.GetTexture(), src_surface.GetTarget(),
+                           src_view_params.base_level, src_x0, src_y0, src_view_params.base_layer,
+                           overlap_copy.handle, GL_TEXTURE_2D, 0, 0, 0, 0, width, height, 1);
+        src_x0 = 0;
+        src_y0 = 0;
+        src_x1 = width;
+        src_y1 = height;
+    }
+    const auto attach_src = [&](GLenum attachment) {
+        if (is_overlapping) {
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D,
+                                   overlap_copy.handle, 0);
+        } else {
+            src_view->Attach(attachment, GL_READ_FRAMEBUFFER);
+        }
+    };
 
-    UNIMPLEMENTED_IF(src_params.target == SurfaceTarget::Texture3D);
-    UNIMPLEMENTED_IF(dst_params.target == SurfaceTarget::Texture3D);
+    u32 buffers{};
 
     if (src_params.type == SurfaceType::ColorTexture) {
-        src_view->Attach(GL_COLOR_ATTACHMENT0, GL_READ_FRAMEBUFFER);
+        attach_src(GL_COLOR_ATTACHMENT0);
         glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
                                0);
 
@@ -534,7 +851,7 @@ void TextureCacheOpenGL::ImageBlit(View& src_view, View& dst_view,
         buffers = GL_COLOR_BUFFER_BIT;
     } else if (src_params.type == SurfaceType::Depth) {
         glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-        src_view->Attach(GL_DEPTH_ATTACHMENT, GL_READ_FRAMEBUFFER);
+        attach_src(GL_DEPTH_ATTACHMENT);
         glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
 
         glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
@@ -544,7 +861,7 @@ void TextureCacheOpenGL::ImageBlit(View& src_view, View& dst_view,
         buffers = GL_DEPTH_BUFFER_BIT;
     } else if (src_params.type == SurfaceType::DepthStencil) {
         glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-        src_view->Attach(GL_DEPTH_STENCIL_ATTACHMENT, GL_READ_FRAMEBUFFER);
+        attach_src(GL_DEPTH_STENCIL_ATTACHMENT);
 
         glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
         dst_view->Attach(GL_DEPTH_STENCIL_ATTACHMENT, GL_DRAW_FRAMEBUFFER);
@@ -552,19 +869,11 @@ void TextureCacheOpenGL::ImageBlit(View& src_view, View& dst_view,
         buffers = GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
     }
 
-    const Common::Rectangle<u32>& src_rect = copy_config.src_rect;
-    const Common::Rectangle<u32>& dst_rect = copy_config.dst_rect;
-    const bool is_linear = copy_config.filter == Tegra::Engines::Fermi2D::Filter::Linear;
-
-    const bool src_rescaled = src_view->GetParent().IsRescaled();
-    const bool dst_rescaled = dst_view->GetParent().IsRescaled();
-    const u32 factor1 = src_rescaled ? static_cast<u32>(Settings::values.resolution_factor) : 1U;
-    const u32 factor2 = dst_rescaled ? static_cast<u32>(Settings::values.resolution_factor) : 1U;
-
-    glBlitFramebuffer(src_rect.left * factor1, src_rect.top * factor1, src_rect.right * factor1,
-                      src_rect.bottom * factor1, dst_rect.left * factor2, dst_rect.top * factor2,
-                      dst_rect.right * factor2, dst_rect.bottom * factor2, buffers,
-                      is_linear && (buffers == GL_COLOR_BUFFER_BIT) ? GL_LINEAR : GL_NEAREST);
+    // Integer formats can only be blitted with nearest filtering
+    const bool filter_linear = is_linear && buffers == GL_COLOR_BUFFER_BIT && !src_integer;
+    glBlitFramebuffer(src_x0, src_y0, src_x1, src_y1, dst_rect.left * factor2,
+                      dst_rect.top * factor2, dst_rect.right * factor2, dst_rect.bottom * factor2,
+                      buffers, filter_linear ? GL_LINEAR : GL_NEAREST);
 }
 
 void TextureCacheOpenGL::BufferCopy(Surface& src_surface, Surface& dst_surface) {
@@ -640,6 +949,10 @@ void TextureCacheOpenGL::BufferCopy(Surface& src_surface, Surface& dst_surface)
     glTextureBarrier();
 }
 
+void TextureCacheOpenGL::OnSurfaceReleased(const Surface& surface) {
+    framebuffer_cache.InvalidateSurface(*surface);
+}
+
 GLuint TextureCacheOpenGL::FetchPBO(std::size_t buffer_size) {
     ASSERT_OR_EXECUTE(buffer_size > 0, { return 0; });
     const u32 l2 = Common::Log2Ceil64(static_cast<u64>(buffer_size));
@@ -17,6 +17,7 @@
 #include "video_core/engines/shader_bytecode.h"
 #include "video_core/renderer_opengl/gl_device.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_swizzle_pass.h"
 #include "video_core/texture_cache/texture_cache.h"
 
 namespace OpenGL {
@@ -26,6 +27,7 @@ using VideoCommon::ViewParams;
 
 class CachedSurfaceView;
 class CachedSurface;
+class FramebufferCacheOpenGL;
 class TextureCacheOpenGL;
 
 using Surface = std::shared_ptr<CachedSurface>;
@@ -36,13 +38,21 @@ class CachedSurface final : public VideoCommon::SurfaceBase<View> {
     friend CachedSurfaceView;
 
 public:
-    explicit CachedSurface(GPUVAddr gpu_addr, const SurfaceParams& params);
+    explicit CachedSurface(GPUVAddr gpu_addr, const SurfaceParams& params,
+                           SwizzlePass& swizzle_pass);
     ~CachedSurface();
 
     void Init();
 
     void UploadTexture(const std::vector<u8>& staging_buffer) override;
     void DownloadTexture(std::vector<u8>& staging_buffer) override;
+    void UploadDirtyTexture(const std::vector<u8>& staging_buffer) override;
+    void PrefetchDownload() override;
+
+    bool UploadSwizzledTexture(Tegra::MemoryManager& memory_manager,
+                               VideoCommon::StagingCache& staging_cache) override;
+    bool DownloadSwizzledTexture(Tegra::MemoryManager& memory_manager,
+                                 VideoCommon::StagingCache& staging_cache) override;
 
     GLenum GetTarget() const {
         return target;
@@ -52,6 +62,10 @@ public:
         return texture.handle;
     }
 
+    GLenum GetInternalFormat() const {
+        return internal_format;
+    }
+
 protected:
     void DecorateSurfaceName() override;
 
@@ -59,7 +73,23 @@ protected:
     View CreateViewInner(const ViewParams& view_key, bool is_proxy);
 
 private:
-    void UploadTextureMipmap(u32 level, const std::vector<u8>& staging_buffer);
+    /// Uploads a level from memory, or from the offset in the bound pixel unpack buffer.
+    void UploadTextureMipmap(u32 level, const u8* buffer);
+
+    /// Uploads a single layer of a level of a layered surface.
+    void UploadTextureLayer(u32 level, u32 layer, const u8* buffer);
+
+    /// Downloads a level to memory, or to the offset in the bound pixel pack buffer.
+    void DownloadTextureMipmap(u32 level, u8* buffer);
+
+    /// Returns true when the swizzle pass is enabled and can convert this surface.
+    bool UseSwizzlePass() const;
+
+    /// Calls func with every layer or level the swizzle pass has to convert on its own.
+    template <typename Func>
+    void ForEachSwizzledImage(Func&& func) const;
+
+    SwizzlePass& swizzle_pass;
 
     GLenum internal_format{};
     GLenum format{};
@@ -70,6 +100,10 @@ private:
 
     OGLTexture texture;
     OGLBuffer texture_buffer;
+
+    OGLBuffer download_buffer; ///< Pixel pack buffer prefetched downloads are copied to
+    OGLSync download_fence;    ///< Signaled once the prefetched download is complete
+    u64 download_tick{};       ///< Modification tick of the prefetched contents
 };
 
 class CachedSurfaceView final : public VideoCommon::ViewBase {
@@ -85,16 +119,28 @@ public:
                       Tegra::Texture::SwizzleSource z_source,
                       Tegra::Texture::SwizzleSource w_source);
 
+    /// Returns a resident bindless handle sampling the view with the given sampler and swizzle,
+    /// handles stay resident until the view is destroyed with its surface.
+    GLuint64 GetBindlessHandle(GLuint sampler, Tegra::Texture::SwizzleSource x_source,
+                               Tegra::Texture::SwizzleSource y_source,
+                               Tegra::Texture::SwizzleSource z_source,
+                               Tegra::Texture::SwizzleSource w_source);
+
     void DecorateViewName(GPUVAddr gpu_addr, std::string prefix);
 
     void MarkAsModified(u64 tick) {
         surface.MarkAsModified(true, tick);
     }
 
+    /// Returns the texture sampling the view, texture views are created the first time they are
+    /// asked for as views only attached to framebuffers never need them.
     GLuint GetTexture() const {
         if (is_proxy) {
             return surface.GetTexture();
         }
+        if (texture_view.handle == 0) {
+            CreateMainTextureView();
+        }
         return texture_view.handle;
     }
 
@@ -117,18 +163,27 @@ private:
 
     OGLTextureView CreateTextureView() const;
 
+    /// Creates the texture view GetTexture returns, with the current swizzle and name.
+    void CreateMainTextureView() const;
+
     CachedSurface& surface;
     GLenum target{};
 
-    OGLTextureView texture_view;
+    mutable OGLTextureView texture_view;
     u32 swizzle{};
     bool is_proxy{};
+
+    GPUVAddr name_gpu_addr{};
+    std::string name; ///< Label given to the texture view once it's created
+
+    std::unordered_map<u32, OGLTextureView> swizzle_views; ///< Views frozen by bindless handles
+    std::unordered_map<u64, GLuint64> bindless_handles;   ///< Keyed by swizzle and sampler
 };
 
 class TextureCacheOpenGL final : public TextureCacheBase {
 public:
     explicit TextureCacheOpenGL(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
-                                const Device& device);
+                                const Device& device, FramebufferCacheOpenGL& framebuffer_cache);
     ~TextureCacheOpenGL();
 
 protected:
@@ -142,9 +197,14 @@ protected:
 
     void BufferCopy(Surface& src_surface, Surface& dst_surface) override;
 
+    void OnSurfaceReleased(const Surface& surface) override;
+
 private:
     GLuint FetchPBO(std::size_t buffer_size);
 
+    FramebufferCacheOpenGL& framebuffer_cache;
+    SwizzlePass swizzle_pass;
+
     OGLFramebuffer src_framebuffer;
     OGLFramebuffer dst_framebuffer;
     std::unordered_map<u32, OGLBuffer> copy_pbo_cache;
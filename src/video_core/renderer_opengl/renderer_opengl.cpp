@@ -5,10 +5,14 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
 #include "common/telemetry.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -19,6 +23,7 @@
 #include "core/settings.h"
 #include "core/telemetry_session.h"
 #include "video_core/morton.h"
+#include "video_core/renderer_opengl/gl_frame_mailbox.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 
@@ -104,6 +109,9 @@ RendererOpenGL::~RendererOpenGL() = default;
 void RendererOpenGL::SwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
     system.GetPerfStats().EndSystemFrame();
 
+    // Batched draws have to be submitted before the presentation touches the GL state
+    rasterizer->FlushCommands();
+
     // Maintain the rasterizer's state as a priority
     OpenGLState prev_state = OpenGLState::GetCurState();
     state.AllDirty();
@@ -123,20 +131,60 @@ void RendererOpenGL::SwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
         // Load the framebuffer from memory, draw it to the screen, and swap buffers
         LoadFBToScreenInfo(*framebuffer);
 
-        if (renderer_settings.screenshot_requested)
-            CaptureScreenshot();
+        // Hand out the captures of previous frames the GPU is done with
+        while (PopCapture(false)) {
+        }
+        if (renderer_settings.screenshot_requested && !screenshot_in_flight) {
+            QueueCapture(renderer_settings.screenshot_framebuffer_layout, true);
+        }
+        if (renderer_settings.frame_capture_enabled) {
+            Layout::FramebufferLayout capture_layout;
+            {
+                std::lock_guard lock{renderer_settings.frame_capture_mutex};
+                capture_layout = renderer_settings.frame_capture_layout;
+            }
+            QueueCapture(capture_layout, false);
+        }
 
-        DrawScreen(render_window.GetFramebufferLayout());
+        const auto& layout = render_window.GetFramebufferLayout();
+        if (render_context) {
+            // Frontends may hold the window context while loading, the presentation thread can
+            // only take it from the first frame on
+            if (!frame_mailbox) {
+                frame_mailbox = std::make_unique<FrameMailbox>(render_window);
+            }
+            Frame& frame = frame_mailbox->GetRenderFrame();
+            if (frame.width != layout.width || frame.height != layout.height ||
+                frame.is_srgb != screen_info.display_srgb) {
+                frame_mailbox->ReloadRenderFrame(frame, layout.width, layout.height,
+                                                 screen_info.display_srgb);
+            }
+            state.draw.draw_framebuffer = frame.render_fbo.handle;
+            state.Apply();
+            DrawScreen(layout);
+            state.draw.draw_framebuffer = 0;
+            state.Apply();
+            frame_mailbox->ReleaseRenderFrame(frame);
+        } else {
+            DrawScreen(layout);
+        }
 
         rasterizer->TickFrame();
 
-        render_window.SwapBuffers();
+        if (!render_context) {
+            render_window.SwapBuffers();
+        }
     }
 
     render_window.PollEvents();
 
-    system.FrameLimiter().DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
-    system.GetPerfStats().BeginSystemFrame();
+    auto& perf_stats = system.GetPerfStats();
+    const auto frame_lateness =
+        system.FrameLimiter().DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
+    if (frame_lateness) {
+        perf_stats.AddFramePacingError(*frame_lateness);
+    }
+    perf_stats.BeginSystemFrame();
 
     // Restore the rasterizer state
     prev_state.AllDirty();
@@ -387,38 +435,102 @@ void RendererOpenGL::DrawScreen(const Layout::FramebufferLayout& layout) {
 /// Updates the framerate
 void RendererOpenGL::UpdateFramerate() {}
 
-void RendererOpenGL::CaptureScreenshot() {
-    // Draw the current frame to the screenshot framebuffer
-    screenshot_framebuffer.Create();
-    GLuint old_read_fb = state.draw.read_framebuffer;
-    GLuint old_draw_fb = state.draw.draw_framebuffer;
-    state.draw.read_framebuffer = state.draw.draw_framebuffer = screenshot_framebuffer.handle;
-    state.AllDirty();
-    state.Apply();
+void RendererOpenGL::QueueCapture(const Layout::FramebufferLayout& layout, bool is_screenshot) {
+    if (captures_in_flight == captures.size()) {
+        // The GPU is a whole ring of captures behind, wait for the oldest one to free its buffer
+        PopCapture(true);
+    }
+    Capture& capture = captures[(capture_head + captures_in_flight) % captures.size()];
+
+    if (capture_width != layout.width || capture_height != layout.height ||
+        capture_is_srgb != screen_info.display_srgb) {
+        capture_width = layout.width;
+        capture_height = layout.height;
+        capture_is_srgb = screen_info.display_srgb;
+
+        capture_color.Release();
+        capture_color.Create(GL_TEXTURE_2D);
+        glTextureStorage2D(capture_color.handle, 1, capture_is_srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8,
+                           layout.width, layout.height);
+
+        // Framebuffers created with glGenFramebuffers have to be bound once before they can be used
+        capture_framebuffer.Release();
+        capture_framebuffer.Create();
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, capture_framebuffer.handle);
+        glFramebufferTexture(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, capture_color.handle, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, OpenGLState::GetCurState().draw.draw_framebuffer);
+    }
 
-    Layout::FramebufferLayout layout{renderer_settings.screenshot_framebuffer_layout};
+    const std::size_t size = std::size_t{layout.width} * layout.height * 4;
+    if (capture.buffer_size != size) {
+        capture.buffer.Release();
+        capture.buffer.Create();
+        glNamedBufferStorage(capture.buffer.handle, static_cast<GLsizeiptr>(size), nullptr,
+                             GL_MAP_READ_BIT | GL_CLIENT_STORAGE_BIT);
+        capture.buffer_size = size;
+    }
 
-    GLuint renderbuffer;
-    glGenRenderbuffers(1, &renderbuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, screen_info.display_srgb ? GL_SRGB8 : GL_RGB8,
-                          layout.width, layout.height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    // Draw the current frame to the capture framebuffer
+    const GLuint old_read_fb = state.draw.read_framebuffer;
+    const GLuint old_draw_fb = state.draw.draw_framebuffer;
+    state.draw.read_framebuffer = state.draw.draw_framebuffer = capture_framebuffer.handle;
+    state.AllDirty();
+    state.Apply();
 
     DrawScreen(layout);
 
-    glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
-                 renderer_settings.screenshot_bits);
+    // Read into the pixel pack buffer, the copy runs asynchronously on the GPU
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture.buffer.handle);
+    glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture.fence.Create();
 
-    screenshot_framebuffer.Release();
     state.draw.read_framebuffer = old_read_fb;
     state.draw.draw_framebuffer = old_draw_fb;
     state.AllDirty();
     state.Apply();
-    glDeleteRenderbuffers(1, &renderbuffer);
 
-    renderer_settings.screenshot_complete_callback();
-    renderer_settings.screenshot_requested = false;
+    capture.width = layout.width;
+    capture.height = layout.height;
+    capture.is_screenshot = is_screenshot;
+    ++captures_in_flight;
+    if (is_screenshot) {
+        screenshot_in_flight = true;
+    }
+}
+
+bool RendererOpenGL::PopCapture(bool wait) {
+    if (captures_in_flight == 0) {
+        return false;
+    }
+    Capture& capture = captures[capture_head];
+    const GLenum result = glClientWaitSync(capture.fence.handle,
+                                           wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                           wait ? std::numeric_limits<GLuint64>::max() : 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    capture.fence.Release();
+    capture_head = (capture_head + 1) % captures.size();
+    --captures_in_flight;
+
+    const std::size_t size = std::size_t{capture.width} * capture.height * 4;
+    const auto pixels = static_cast<const u8*>(glMapNamedBufferRange(
+        capture.buffer.handle, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+    if (capture.is_screenshot) {
+        std::memcpy(renderer_settings.screenshot_bits, pixels, size);
+        screenshot_in_flight = false;
+        renderer_settings.screenshot_complete_callback();
+        renderer_settings.screenshot_requested = false;
+    } else {
+        std::lock_guard lock{renderer_settings.frame_capture_mutex};
+        // Frames captured before the capture was stopped are dropped
+        if (renderer_settings.frame_capture_enabled) {
+            renderer_settings.frame_capture_callback(pixels, capture.width, capture.height);
+        }
+    }
+    glUnmapNamedBuffer(capture.buffer.handle);
+    return true;
 }
 
 static const char* GetSource(GLenum source) {
@@ -479,7 +591,15 @@ static void APIENTRY DebugHandler(GLenum source, GLenum type, GLuint id, GLenum
 }
 
 bool RendererOpenGL::Init() {
-    Core::Frontend::ScopeAcquireWindowContext acquire_context{render_window};
+    // Render on a shared context so the window context is free to present from its own thread
+    {
+        Core::Frontend::ScopeAcquireWindowContext acquire_context{render_window};
+        render_context = render_window.CreateSharedContext();
+    }
+
+    auto& context = GetRenderContext();
+    context.MakeCurrent();
+    SCOPE_EXIT({ context.DoneCurrent(); });
 
     if (GLAD_GL_KHR_debug) {
         glEnable(GL_DEBUG_OUTPUT);
@@ -501,4 +621,11 @@ bool RendererOpenGL::Init() {
 /// Shutdown the renderer
 void RendererOpenGL::ShutDown() {}
 
+Core::Frontend::GraphicsContext& RendererOpenGL::GetRenderContext() {
+    if (render_context) {
+        return *render_context;
+    }
+    return render_window;
+}
+
 } // namespace OpenGL
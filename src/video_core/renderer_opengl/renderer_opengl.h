@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
@@ -26,6 +29,8 @@ struct FramebufferLayout;
 
 namespace OpenGL {
 
+class FrameMailbox;
+
 /// Structure used for storing information about the textures for the Switch screen
 struct TextureInfo {
     OGLTexture resource;
@@ -58,6 +63,8 @@ public:
     /// Shutdown the renderer
     void ShutDown() override;
 
+    Core::Frontend::GraphicsContext& GetRenderContext() override;
+
 private:
     void InitOpenGLObjects();
     void AddTelemetryFields();
@@ -69,7 +76,10 @@ private:
     void DrawScreenTriangles(const ScreenInfo& screen_info, float x, float y, float w, float h);
     void UpdateFramerate();
 
-    void CaptureScreenshot();
+    /// Draws the current frame with the given layout and queues reading it back to the host
+    void QueueCapture(const Layout::FramebufferLayout& layout, bool is_screenshot);
+    /// Delivers the oldest queued capture, returns false when there was none or it isn't ready
+    bool PopCapture(bool wait);
 
     // Loads framebuffer from emulated memory into the display information structure
     void LoadFBToScreenInfo(const Tegra::FramebufferConfig& framebuffer);
@@ -86,7 +96,28 @@ private:
     OGLVertexArray vertex_array;
     OGLBuffer vertex_buffer;
     OGLProgram shader;
-    OGLFramebuffer screenshot_framebuffer;
+
+    /// Frame read back into a pixel pack buffer, mapped once the GPU signals its fence
+    struct Capture {
+        OGLBuffer buffer;
+        OGLSync fence;
+        std::size_t buffer_size = 0;
+        u32 width = 0;
+        u32 height = 0;
+        bool is_screenshot = false;
+    };
+    static constexpr std::size_t NUM_CAPTURES = 3;
+    std::array<Capture, NUM_CAPTURES> captures;
+    std::size_t capture_head = 0;       ///< Index of the oldest capture in flight
+    std::size_t captures_in_flight = 0; ///< Number of captures waiting for the GPU
+    bool screenshot_in_flight = false;  ///< The requested screenshot has already been queued
+
+    /// Target captured frames are drawn to before being read back
+    OGLTexture capture_color;
+    OGLFramebuffer capture_framebuffer;
+    u32 capture_width = 0;
+    u32 capture_height = 0;
+    bool capture_is_srgb = false;
 
     /// Display information for Switch screen
     ScreenInfo screen_info;
@@ -105,6 +136,12 @@ private:
     /// Used for transforming the framebuffer orientation
     Tegra::FramebufferConfig::TransformFlags framebuffer_transform_flags;
     Common::Rectangle<int> framebuffer_crop_rect;
+
+    /// Context frames are rendered with, when the frontend can share one. Frames are then
+    /// presented from their own thread.
+    std::unique_ptr<Core::Frontend::GraphicsContext> render_context;
+    /// Hands rendered frames to the presentation thread
+    std::unique_ptr<FrameMailbox> frame_mailbox;
 };
 
 } // namespace OpenGL
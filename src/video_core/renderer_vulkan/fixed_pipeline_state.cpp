@@ -0,0 +1,160 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/renderer_vulkan/fixed_pipeline_state.h"
+
+namespace Vulkan {
+
+namespace {
+
+std::size_t GetAttachmentsCount(const Maxwell& regs) {
+    return std::min<std::size_t>(regs.rt_control.count, Maxwell::NumRenderTargets);
+}
+
+FixedPipelineState::VertexInput GetVertexInputState(const Maxwell& regs) {
+    FixedPipelineState::VertexInput input;
+    for (u32 index = 0; index < static_cast<u32>(Maxwell::NumVertexAttributes); ++index) {
+        const auto& attrib = regs.vertex_attrib_format[index];
+        if (attrib.constant != 0 || !attrib.IsValid()) {
+            continue;
+        }
+        input.attributes[input.num_attributes++] = {index, attrib.buffer, attrib.offset,
+                                                    attrib.type, attrib.size};
+    }
+    for (u32 index = 0; index < static_cast<u32>(Maxwell::NumVertexArrays); ++index) {
+        const auto& vertex_array = regs.vertex_array[index];
+        if (!vertex_array.IsEnabled()) {
+            continue;
+        }
+        const u32 divisor =
+            regs.instanced_arrays.IsInstancingEnabled(index) ? vertex_array.divisor : 0;
+        input.bindings[input.num_bindings++] = {index, vertex_array.stride, divisor};
+    }
+    return input;
+}
+
+FixedPipelineState::InputAssembly GetInputAssemblyState(const Maxwell& regs) {
+    return {regs.draw.topology, regs.primitive_restart.enabled};
+}
+
+bool IsDepthBiasEnabled(const Maxwell& regs) {
+    switch (regs.draw.topology) {
+    case Maxwell::PrimitiveTopology::Points:
+        return regs.polygon_offset_point_enable != 0;
+    case Maxwell::PrimitiveTopology::Lines:
+    case Maxwell::PrimitiveTopology::LineLoop:
+    case Maxwell::PrimitiveTopology::LineStrip:
+    case Maxwell::PrimitiveTopology::LinesAdjacency:
+    case Maxwell::PrimitiveTopology::LineStripAdjacency:
+        return regs.polygon_offset_line_enable != 0;
+    default:
+        return regs.polygon_offset_fill_enable != 0;
+    }
+}
+
+FixedPipelineState::Rasterizer GetRasterizerState(const Maxwell& regs) {
+    const auto& clip = regs.view_volume_clip_control;
+    const bool depth_clamp = clip.depth_clamp_near == 1 || clip.depth_clamp_far == 1;
+    return {regs.cull.enabled, regs.cull.cull_face, regs.cull.front_face,
+            IsDepthBiasEnabled(regs) ? 1U : 0U, depth_clamp ? 1U : 0U};
+}
+
+FixedPipelineState::DepthStencil GetDepthStencilState(const Maxwell& regs) {
+    FixedPipelineState::DepthStencil state;
+    state.depth_test_enable = regs.depth_test_enable;
+    state.depth_write_enable = regs.depth_write_enabled;
+    if (regs.depth_test_enable != 0) {
+        state.depth_test_func = regs.depth_test_func;
+    }
+    state.stencil_enable = regs.stencil_enable;
+    if (regs.stencil_enable == 0) {
+        return state;
+    }
+    state.front = {regs.stencil_front_op_fail, regs.stencil_front_op_zfail,
+                   regs.stencil_front_op_zpass, regs.stencil_front_func_func};
+    // Without two sided stencil the back face uses the front face state.
+    state.back = regs.stencil_two_side_enable != 0
+                     ? FixedPipelineState::StencilFace{regs.stencil_back_op_fail,
+                                                       regs.stencil_back_op_zfail,
+                                                       regs.stencil_back_op_zpass,
+                                                       regs.stencil_back_func_func}
+                     : state.front;
+    return state;
+}
+
+FixedPipelineState::BlendingAttachment GetBlendingAttachmentState(const Maxwell& regs,
+                                                                  std::size_t render_target) {
+    const auto& mask = regs.color_mask[regs.color_mask_common ? 0 : render_target];
+    FixedPipelineState::BlendingAttachment attachment;
+    attachment.components = (mask.R != 0 ? 1U : 0U) | (mask.G != 0 ? 2U : 0U) |
+                            (mask.B != 0 ? 4U : 0U) | (mask.A != 0 ? 8U : 0U);
+    if (regs.blend.enable[render_target] == 0) {
+        return attachment;
+    }
+    attachment.enable = 1;
+
+    const auto set = [&attachment](const auto& blend) {
+        attachment.rgb_equation = blend.equation_rgb;
+        attachment.src_rgb_func = blend.factor_source_rgb;
+        attachment.dst_rgb_func = blend.factor_dest_rgb;
+        attachment.a_equation = blend.equation_a;
+        attachment.src_a_func = blend.factor_source_a;
+        attachment.dst_a_func = blend.factor_dest_a;
+    };
+    if (regs.independent_blend_enable != 0) {
+        set(regs.independent_blend[render_target]);
+    } else {
+        set(regs.blend);
+    }
+    return attachment;
+}
+
+FixedPipelineState::ColorBlending GetColorBlendingState(const Maxwell& regs) {
+    FixedPipelineState::ColorBlending state;
+    state.attachments_count = static_cast<u32>(GetAttachmentsCount(regs));
+    for (std::size_t index = 0; index < state.attachments_count; ++index) {
+        state.attachments[index] = GetBlendingAttachmentState(regs, index);
+    }
+    return state;
+}
+
+FixedPipelineState::Attachments GetAttachmentsState(const Maxwell& regs) {
+    FixedPipelineState::Attachments state;
+    for (std::size_t index = 0; index < GetAttachmentsCount(regs); ++index) {
+        state.color_formats[index] = regs.rt[regs.rt_control.GetMap(index)].format;
+    }
+    if (regs.zeta_enable != 0) {
+        state.has_zeta = 1;
+        state.zeta_format = regs.zeta.format;
+    }
+    return state;
+}
+
+} // Anonymous namespace
+
+std::size_t FixedPipelineState::Hash() const noexcept {
+    return static_cast<std::size_t>(Common::ComputeFastHash64(this, sizeof(*this)));
+}
+
+bool FixedPipelineState::operator==(const FixedPipelineState& rhs) const noexcept {
+    return std::memcmp(this, &rhs, sizeof(*this)) == 0;
+}
+
+FixedPipelineState GetFixedPipelineState(const Maxwell& regs) {
+    FixedPipelineState fixed_state;
+    fixed_state.vertex_input = GetVertexInputState(regs);
+    fixed_state.input_assembly = GetInputAssemblyState(regs);
+    fixed_state.rasterizer = GetRasterizerState(regs);
+    fixed_state.depth_stencil = GetDepthStencilState(regs);
+    fixed_state.color_blending = GetColorBlendingState(regs);
+    fixed_state.attachments = GetAttachmentsState(regs);
+    return fixed_state;
+}
+
+} // namespace Vulkan
@@ -0,0 +1,131 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/gpu.h"
+
+namespace Vulkan {
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+/**
+ * Maxwell state that is baked into a Vulkan graphics pipeline. State that Vulkan can change
+ * dynamically (viewports, scissors, stencil references and masks, depth bias values and blend
+ * constants) is left out so it doesn't create new pipelines. Unused entries are kept zeroed, the
+ * structure is compared and hashed as raw memory.
+ */
+struct FixedPipelineState {
+    struct VertexBinding {
+        u32 index = 0;
+        u32 stride = 0;
+        u32 divisor = 0; ///< Zero for arrays read per vertex.
+    };
+
+    struct VertexAttribute {
+        u32 index = 0;
+        u32 buffer = 0;
+        u32 offset = 0;
+        Maxwell::VertexAttribute::Type type{};
+        Maxwell::VertexAttribute::Size size{};
+    };
+
+    struct VertexInput {
+        u32 num_bindings = 0;
+        u32 num_attributes = 0;
+        std::array<VertexBinding, Maxwell::NumVertexArrays> bindings{};
+        std::array<VertexAttribute, Maxwell::NumVertexAttributes> attributes{};
+    };
+
+    struct InputAssembly {
+        Maxwell::PrimitiveTopology topology{};
+        u32 primitive_restart_enable = 0;
+    };
+
+    struct Rasterizer {
+        u32 cull_enable = 0;
+        Maxwell::Cull::CullFace cull_face{};
+        Maxwell::Cull::FrontFace front_face{};
+        u32 depth_bias_enable = 0;
+        u32 depth_clamp_enable = 0;
+    };
+
+    struct StencilFace {
+        Maxwell::StencilOp action_stencil_fail{};
+        Maxwell::StencilOp action_depth_fail{};
+        Maxwell::StencilOp action_depth_pass{};
+        Maxwell::ComparisonOp test_func{};
+    };
+
+    struct DepthStencil {
+        u32 depth_test_enable = 0;
+        u32 depth_write_enable = 0;
+        Maxwell::ComparisonOp depth_test_func{};
+        u32 stencil_enable = 0;
+        StencilFace front;
+        StencilFace back;
+    };
+
+    struct BlendingAttachment {
+        u32 enable = 0;
+        Maxwell::Blend::Equation rgb_equation{};
+        Maxwell::Blend::Factor src_rgb_func{};
+        Maxwell::Blend::Factor dst_rgb_func{};
+        Maxwell::Blend::Equation a_equation{};
+        Maxwell::Blend::Factor src_a_func{};
+        Maxwell::Blend::Factor dst_a_func{};
+        u32 components = 0; ///< Written components, one bit each for R, G, B and A.
+    };
+
+    struct ColorBlending {
+        u32 attachments_count = 0;
+        std::array<BlendingAttachment, Maxwell::NumRenderTargets> attachments{};
+    };
+
+    /// Formats of the bound attachments, these decide which render passes are compatible.
+    struct Attachments {
+        std::array<Tegra::RenderTargetFormat, Maxwell::NumRenderTargets> color_formats{};
+        u32 has_zeta = 0;
+        Tegra::DepthFormat zeta_format{};
+    };
+
+    VertexInput vertex_input;
+    InputAssembly input_assembly;
+    Rasterizer rasterizer;
+    DepthStencil depth_stencil;
+    ColorBlending color_blending;
+    Attachments attachments;
+
+    std::size_t Hash() const noexcept;
+
+    bool operator==(const FixedPipelineState& rhs) const noexcept;
+
+    bool operator!=(const FixedPipelineState& rhs) const noexcept {
+        return !operator==(rhs);
+    }
+};
+static_assert(std::has_unique_object_representations_v<FixedPipelineState>,
+              "FixedPipelineState must not have padding, it's hashed as raw memory");
+
+/// Gathers the fixed pipeline state of the given registers.
+FixedPipelineState GetFixedPipelineState(const Maxwell& regs);
+
+} // namespace Vulkan
+
+namespace std {
+
+template <>
+struct hash<Vulkan::FixedPipelineState> {
+    std::size_t operator()(const Vulkan::FixedPipelineState& k) const noexcept {
+        return k.Hash();
+    }
+};
+
+} // namespace std
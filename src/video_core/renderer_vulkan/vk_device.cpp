@@ -148,6 +148,9 @@ bool VKDevice::Create(const vk::DispatchLoaderDynamic& dldi, vk::Instance instan
 
     graphics_queue = logical->getQueue(graphics_family, 0, dld);
     present_queue = logical->getQueue(present_family, 0, dld);
+    if (transfer_family) {
+        transfer_queue = logical->getQueue(*transfer_family, 0, dld);
+    }
     return true;
 }
 
@@ -356,6 +359,22 @@ void VKDevice::SetupFamilies(const vk::DispatchLoaderDynamic& dldi, vk::SurfaceK
 
     graphics_family = *graphics_family_;
     present_family = *present_family_;
+
+    // Families that can only transfer are backed by the copy engines of the GPU, work submitted
+    // to them runs alongside the graphics queue
+    for (u32 i = 0; i < static_cast<u32>(queue_family_properties.size()); ++i) {
+        const auto& queue_family = queue_family_properties[i];
+        const auto other_flags = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute;
+        if (queue_family.queueCount > 0 &&
+            (queue_family.queueFlags & vk::QueueFlagBits::eTransfer) &&
+            !(queue_family.queueFlags & other_flags)) {
+            transfer_family = i;
+            break;
+        }
+    }
+    if (!transfer_family) {
+        LOG_INFO(Render_Vulkan, "Device lacks a dedicated transfer queue");
+    }
 }
 
 void VKDevice::SetupProperties(const vk::DispatchLoaderDynamic& dldi) {
@@ -375,6 +394,9 @@ std::vector<vk::DeviceQueueCreateInfo> VKDevice::GetDeviceQueueCreateInfos() con
     static const float QUEUE_PRIORITY = 1.0f;
 
     std::set<u32> unique_queue_families = {graphics_family, present_family};
+    if (transfer_family) {
+        unique_queue_families.insert(*transfer_family);
+    }
     std::vector<vk::DeviceQueueCreateInfo> queue_cis;
 
     for (u32 queue_family : unique_queue_families)
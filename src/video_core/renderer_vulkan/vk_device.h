@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <optional>
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
@@ -69,6 +70,21 @@ public:
         return present_family;
     }
 
+    /// Returns true if the device has a queue family dedicated to transfers.
+    bool HasDedicatedTransferQueue() const {
+        return transfer_family.has_value();
+    }
+
+    /// Returns the dedicated transfer queue, only valid if the device has one.
+    vk::Queue GetTransferQueue() const {
+        return transfer_queue;
+    }
+
+    /// Returns the dedicated transfer queue family index, only valid if the device has one.
+    u32 GetTransferFamily() const {
+        return *transfer_family;
+    }
+
     /// Returns true if the device is integrated with the host CPU.
     bool IsIntegrated() const {
         return device_type == vk::PhysicalDeviceType::eIntegratedGpu;
@@ -153,6 +169,8 @@ private:
     vk::Queue present_queue;                   ///< Main present queue.
     u32 graphics_family{};                     ///< Main graphics queue family index.
     u32 present_family{};                      ///< Main present queue family index.
+    vk::Queue transfer_queue;                  ///< Dedicated transfer queue.
+    std::optional<u32> transfer_family;        ///< Dedicated transfer queue family index.
     vk::PhysicalDeviceType device_type;        ///< Physical device type.
     vk::DriverIdKHR driver_id{};               ///< Driver ID.
     u64 uniform_buffer_alignment{};            ///< Uniform buffer alignment requeriment.
@@ -2,14 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <algorithm>
-#include <optional>
-#include <tuple>
+#include <memory>
 #include <vector>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
+#include "common/tlsf_allocator.h"
 #include "video_core/renderer_vulkan/declarations.h"
 #include "video_core/renderer_vulkan/vk_device.h"
 #include "video_core/renderer_vulkan/vk_memory_manager.h"
@@ -19,18 +19,27 @@ namespace Vulkan {
 // TODO(Rodrigo): Fine tune this number
 constexpr u64 ALLOC_CHUNK_SIZE = 64 * 1024 * 1024;
 
+/// Commits at least this large get device memory of their own instead of filling a chunk.
+constexpr u64 DEDICATED_ALLOC_THRESHOLD = 16 * 1024 * 1024;
+
 class VKMemoryAllocation final {
 public:
     explicit VKMemoryAllocation(const VKDevice& device, vk::DeviceMemory memory,
-                                vk::MemoryPropertyFlags properties, u64 alloc_size, u32 type)
+                                vk::MemoryPropertyFlags properties, u64 alloc_size, u32 type,
+                                VKMemoryManager::Statistics* dedicated_stats)
         : device{device}, memory{memory}, properties{properties}, alloc_size{alloc_size},
-          shifted_type{ShiftType(type)}, is_mappable{properties &
-                                                     vk::MemoryPropertyFlagBits::eHostVisible} {
+          type{type}, is_mappable{properties & vk::MemoryPropertyFlagBits::eHostVisible},
+          dedicated_stats{dedicated_stats}, allocator{alloc_size},
+          accounting{Common::MemoryAccounting::Tag::VulkanMemory, alloc_size} {
         if (is_mappable) {
             const auto dev = device.GetLogical();
             const auto& dld = device.GetDispatchLoader();
             base_address = static_cast<u8*>(dev.mapMemory(memory, 0, alloc_size, {}, dld));
         }
+        if (dedicated_stats) {
+            dedicated_stats->dedicated += alloc_size;
+            ++dedicated_stats->num_dedicated;
+        }
     }
 
     ~VKMemoryAllocation() {
@@ -39,96 +48,57 @@ public:
         if (is_mappable)
             dev.unmapMemory(memory, dld);
         dev.free(memory, nullptr, dld);
+        if (dedicated_stats) {
+            dedicated_stats->dedicated -= alloc_size;
+            --dedicated_stats->num_dedicated;
+        }
     }
 
     VKMemoryCommit Commit(vk::DeviceSize commit_size, vk::DeviceSize alignment) {
-        auto found = TryFindFreeSection(free_iterator, alloc_size, static_cast<u64>(commit_size),
-                                        static_cast<u64>(alignment));
-        if (!found) {
-            found = TryFindFreeSection(0, free_iterator, static_cast<u64>(commit_size),
-                                       static_cast<u64>(alignment));
-            if (!found) {
-                // Signal out of memory, it'll try to do more allocations.
-                return nullptr;
-            }
+        const auto range =
+            allocator.Allocate(static_cast<u64>(commit_size), static_cast<u64>(alignment));
+        if (!range) {
+            // Signal out of memory, it'll try to do more allocations.
+            return nullptr;
         }
-        u8* address = is_mappable ? base_address + *found : nullptr;
-        auto commit = std::make_unique<VKMemoryCommitImpl>(this, memory, address, *found,
-                                                           *found + commit_size);
-        commits.push_back(commit.get());
-
-        // Last commit's address is highly probable to be free.
-        free_iterator = *found + commit_size;
-
-        return commit;
+        u8* address = is_mappable ? base_address + range->offset : nullptr;
+        return std::make_unique<VKMemoryCommitImpl>(this, memory, address, range->offset,
+                                                    range->handle);
     }
 
     void Free(const VKMemoryCommitImpl* commit) {
         ASSERT(commit);
-        const auto it =
-            std::find_if(commits.begin(), commits.end(),
-                         [&](const auto& stored_commit) { return stored_commit == commit; });
-        if (it == commits.end()) {
-            LOG_CRITICAL(Render_Vulkan, "Freeing unallocated commit!");
-            UNREACHABLE();
-            return;
-        }
-        commits.erase(it);
-    }
-
-    /// Returns whether this allocation is compatible with the arguments.
-    bool IsCompatible(vk::MemoryPropertyFlags wanted_properties, u32 type_mask) const {
-        return (wanted_properties & properties) != vk::MemoryPropertyFlagBits(0) &&
-               (type_mask & shifted_type) != 0;
+        allocator.Free(commit->handle);
     }
 
-private:
-    static constexpr u32 ShiftType(u32 type) {
-        return 1U << type;
+    /// Returns the index of the Vulkan memory type of this allocation.
+    u32 GetType() const {
+        return type;
     }
 
-    /// A memory allocator, it may return a free region between "start" and "end" with the solicited
-    /// requeriments.
-    std::optional<u64> TryFindFreeSection(u64 start, u64 end, u64 size, u64 alignment) const {
-        u64 iterator = start;
-        while (iterator + size < end) {
-            const u64 try_left = Common::AlignUp(iterator, alignment);
-            const u64 try_right = try_left + size;
-
-            bool overlap = false;
-            for (const auto& commit : commits) {
-                const auto [commit_left, commit_right] = commit->interval;
-                if (try_left < commit_right && commit_left < try_right) {
-                    // There's an overlap, continue the search where the overlapping commit ends.
-                    iterator = commit_right;
-                    overlap = true;
-                    break;
-                }
-            }
-            if (!overlap) {
-                // A free address has been found.
-                return try_left;
-            }
-        }
-        // No free regions where found, return an empty optional.
-        return std::nullopt;
+    Common::TLSFAllocator::Statistics GetStatistics() const {
+        return allocator.GetStatistics();
     }
 
+private:
     const VKDevice& device;                   ///< Vulkan device.
     const vk::DeviceMemory memory;            ///< Vulkan memory allocation handler.
     const vk::MemoryPropertyFlags properties; ///< Vulkan properties.
     const u64 alloc_size;                     ///< Size of this allocation.
-    const u32 shifted_type;                   ///< Stored Vulkan type of this allocation, shifted.
+    const u32 type;                           ///< Vulkan memory type of this allocation.
     const bool is_mappable;                   ///< Whether the allocation is mappable.
 
+    /// Usage counters of dedicated allocations, null for chunks.
+    VKMemoryManager::Statistics* const dedicated_stats;
+
     /// Base address of the mapped pointer.
     u8* base_address{};
 
-    /// Hints where the next free region is likely going to be.
-    u64 free_iterator{};
+    /// Sub-allocates the commits done from this allocation.
+    Common::TLSFAllocator allocator;
 
-    /// Stores all commits done from this allocation.
-    std::vector<const VKMemoryCommitImpl*> commits;
+    /// Accounts the allocation for as long as it lives.
+    Common::MemoryAccounting::TrackedAllocation accounting;
 };
 
 VKMemoryManager::VKMemoryManager(const VKDevice& device)
@@ -138,8 +108,6 @@ VKMemoryManager::VKMemoryManager(const VKDevice& device)
 VKMemoryManager::~VKMemoryManager() = default;
 
 VKMemoryCommit VKMemoryManager::Commit(const vk::MemoryRequirements& reqs, bool host_visible) {
-    ASSERT(reqs.size < ALLOC_CHUNK_SIZE);
-
     // When a host visible commit is asked, search for host visible and coherent, otherwise search
     // for a fast device local type.
     const vk::MemoryPropertyFlags wanted_properties =
@@ -147,33 +115,40 @@ VKMemoryCommit VKMemoryManager::Commit(const vk::MemoryRequirements& reqs, bool
             ? vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
             : vk::MemoryPropertyFlagBits::eDeviceLocal;
 
-    const auto TryCommit = [&]() -> VKMemoryCommit {
-        for (auto& alloc : allocs) {
-            if (!alloc->IsCompatible(wanted_properties, reqs.memoryTypeBits))
-                continue;
-
-            if (auto commit = alloc->Commit(reqs.size, reqs.alignment); commit) {
-                return commit;
-            }
+    if (reqs.size >= DEDICATED_ALLOC_THRESHOLD) {
+        const u64 size = Common::AlignUp(reqs.size, Common::TLSFAllocator::GRANULARITY);
+        auto allocation =
+            AllocMemory(wanted_properties, reqs.memoryTypeBits, size, &dedicated_stats);
+        if (!allocation) {
+            // TODO(Rodrigo): Try to use host memory.
+            LOG_CRITICAL(Render_Vulkan, "Ran out of memory!");
+            UNREACHABLE();
+            return {};
         }
-        return {};
-    };
+        auto commit = allocation->Commit(reqs.size, reqs.alignment);
+        ASSERT(commit);
+        commit->dedicated_allocation = std::move(allocation);
+        return commit;
+    }
 
-    if (auto commit = TryCommit(); commit) {
+    if (auto commit = TryCommit(reqs, wanted_properties); commit) {
         return commit;
     }
 
     // Commit has failed, allocate more memory.
-    if (!AllocMemory(wanted_properties, reqs.memoryTypeBits, ALLOC_CHUNK_SIZE)) {
+    auto chunk = AllocMemory(wanted_properties, reqs.memoryTypeBits, ALLOC_CHUNK_SIZE, nullptr);
+    if (!chunk) {
         // TODO(Rodrigo): Try to use host memory.
         LOG_CRITICAL(Render_Vulkan, "Ran out of memory!");
         UNREACHABLE();
+        return {};
     }
 
     // Commit again, this time it won't fail since there's a fresh allocation above. If it does,
     // there's a bug.
-    auto commit = TryCommit();
+    auto commit = chunk->Commit(reqs.size, reqs.alignment);
     ASSERT(commit);
+    chunks[chunk->GetType()].push_back(std::move(chunk));
     return commit;
 }
 
@@ -195,8 +170,25 @@ VKMemoryCommit VKMemoryManager::Commit(vk::Image image, bool host_visible) {
     return commit;
 }
 
-bool VKMemoryManager::AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32 type_mask,
-                                  u64 size) {
+VKMemoryManager::Statistics VKMemoryManager::GetStatistics() const {
+    Statistics stats;
+    stats.dedicated = dedicated_stats.dedicated;
+    stats.num_dedicated = dedicated_stats.num_dedicated;
+    for (const auto& type_chunks : chunks) {
+        for (const auto& chunk : type_chunks) {
+            const auto chunk_stats = chunk->GetStatistics();
+            stats.committed += chunk_stats.size;
+            stats.used += chunk_stats.used;
+            stats.largest_free += chunk_stats.largest_free;
+            ++stats.num_chunks;
+        }
+    }
+    return stats;
+}
+
+std::unique_ptr<VKMemoryAllocation> VKMemoryManager::AllocMemory(
+    vk::MemoryPropertyFlags wanted_properties, u32 type_mask, u64 size,
+    Statistics* dedicated_stats) {
     const u32 type = [&]() {
         for (u32 type_index = 0; type_index < props.memoryTypeCount; ++type_index) {
             const auto flags = props.memoryTypes[type_index].propertyFlags;
@@ -219,11 +211,26 @@ bool VKMemoryManager::AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32
     if (const vk::Result res = dev.allocateMemory(&memory_ai, nullptr, &memory, dld);
         res != vk::Result::eSuccess) {
         LOG_CRITICAL(Render_Vulkan, "Device allocation failed with code {}!", vk::to_string(res));
-        return false;
+        return nullptr;
     }
-    allocs.push_back(
-        std::make_unique<VKMemoryAllocation>(device, memory, wanted_properties, size, type));
-    return true;
+    return std::make_unique<VKMemoryAllocation>(device, memory, wanted_properties, size, type,
+                                                dedicated_stats);
+}
+
+VKMemoryCommit VKMemoryManager::TryCommit(const vk::MemoryRequirements& reqs,
+                                          vk::MemoryPropertyFlags wanted_properties) {
+    for (u32 type_index = 0; type_index < props.memoryTypeCount; ++type_index) {
+        const auto flags = props.memoryTypes[type_index].propertyFlags;
+        if (!(reqs.memoryTypeBits & (1U << type_index)) || !(flags & wanted_properties)) {
+            continue;
+        }
+        for (auto& chunk : chunks[type_index]) {
+            if (auto commit = chunk->Commit(reqs.size, reqs.alignment); commit) {
+                return commit;
+            }
+        }
+    }
+    return {};
 }
 
 /*static*/ bool VKMemoryManager::GetMemoryUnified(const vk::PhysicalDeviceMemoryProperties& props) {
@@ -237,8 +244,8 @@ bool VKMemoryManager::AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32
 }
 
 VKMemoryCommitImpl::VKMemoryCommitImpl(VKMemoryAllocation* allocation, vk::DeviceMemory memory,
-                                       u8* data, u64 begin, u64 end)
-    : interval(std::make_pair(begin, end)), memory{memory}, allocation{allocation}, data{data} {}
+                                       u8* data, u64 offset, u32 handle)
+    : offset{offset}, handle{handle}, memory{memory}, allocation{allocation}, data{data} {}
 
 VKMemoryCommitImpl::~VKMemoryCommitImpl() {
     allocation->Free(this);
@@ -4,8 +4,8 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
-#include <utility>
 #include <vector>
 #include "common/common_types.h"
 #include "video_core/renderer_vulkan/declarations.h"
@@ -20,6 +20,21 @@ using VKMemoryCommit = std::unique_ptr<VKMemoryCommitImpl>;
 
 class VKMemoryManager final {
 public:
+    struct Statistics {
+        u64 committed = 0;    ///< Device memory allocated in shared chunks.
+        u64 used = 0;         ///< Part of the chunks handed out to commits.
+        u64 largest_free = 0; ///< Sum of the largest free range of each chunk.
+        u64 dedicated = 0;    ///< Device memory allocated for single large commits.
+        u32 num_chunks = 0;
+        u32 num_dedicated = 0;
+
+        /// Share of the free chunk memory that isn't in the largest free range of its chunk.
+        double Fragmentation() const {
+            const u64 free = committed - used;
+            return free == 0 ? 0.0 : 1.0 - static_cast<double>(largest_free) / free;
+        }
+    };
+
     explicit VKMemoryManager(const VKDevice& device);
     ~VKMemoryManager();
 
@@ -43,25 +58,40 @@ public:
         return is_memory_unified;
     }
 
+    /// Returns how much memory is allocated and how much of it is in use.
+    Statistics GetStatistics() const;
+
 private:
-    /// Allocates a chunk of memory.
-    bool AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32 type_mask, u64 size);
+    /// Allocates device memory of a type compatible with the arguments.
+    std::unique_ptr<VKMemoryAllocation> AllocMemory(vk::MemoryPropertyFlags wanted_properties,
+                                                    u32 type_mask, u64 size,
+                                                    Statistics* dedicated_stats);
+
+    /// Commits from the existing chunks of the compatible memory types.
+    VKMemoryCommit TryCommit(const vk::MemoryRequirements& reqs,
+                             vk::MemoryPropertyFlags wanted_properties);
 
     /// Returns true if the device uses an unified memory model.
     static bool GetMemoryUnified(const vk::PhysicalDeviceMemoryProperties& props);
 
-    const VKDevice& device;                                  ///< Device handler.
-    const vk::PhysicalDeviceMemoryProperties props;          ///< Physical device properties.
-    const bool is_memory_unified;                            ///< True if memory model is unified.
-    std::vector<std::unique_ptr<VKMemoryAllocation>> allocs; ///< Current allocations.
+    const VKDevice& device;                         ///< Device handler.
+    const vk::PhysicalDeviceMemoryProperties props; ///< Physical device properties.
+    const bool is_memory_unified;                   ///< True if memory model is unified.
+
+    /// Shared chunks of each memory type.
+    std::array<std::vector<std::unique_ptr<VKMemoryAllocation>>, VK_MAX_MEMORY_TYPES> chunks;
+
+    /// Usage of the dedicated allocations, these are owned by their commits.
+    Statistics dedicated_stats;
 };
 
 class VKMemoryCommitImpl final {
     friend VKMemoryAllocation;
+    friend VKMemoryManager;
 
 public:
     explicit VKMemoryCommitImpl(VKMemoryAllocation* allocation, vk::DeviceMemory memory, u8* data,
-                                u64 begin, u64 end);
+                                u64 offset, u32 handle);
     ~VKMemoryCommitImpl();
 
     /// Returns the writeable memory map. The commit has to be mappable.
@@ -74,14 +104,18 @@ public:
 
     /// Returns the start position of the commit relative to the allocation.
     vk::DeviceSize GetOffset() const {
-        return static_cast<vk::DeviceSize>(interval.first);
+        return static_cast<vk::DeviceSize>(offset);
     }
 
 private:
-    std::pair<u64, u64> interval{};   ///< Interval where the commit exists.
+    u64 offset{};                     ///< Start of the commit in the allocation.
+    u32 handle{};                     ///< Handle of the range in the allocation's allocator.
     vk::DeviceMemory memory;          ///< Vulkan device memory handler.
     VKMemoryAllocation* allocation{}; ///< Pointer to the large memory allocation.
     u8* data{}; ///< Pointer to the host mapped memory, it has the commit offset included.
+
+    /// Allocation made only for this commit, released with it.
+    std::unique_ptr<VKMemoryAllocation> dedicated_allocation;
 };
 
 } // namespace Vulkan
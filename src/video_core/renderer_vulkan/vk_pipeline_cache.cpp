@@ -0,0 +1,216 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+
+#include "common/common_paths.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/settings.h"
+
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/vk_device.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+
+namespace Vulkan {
+
+namespace {
+
+/// Bumped whenever the layout of GraphicsPipelineCacheKey changes.
+constexpr u32 NativeVersion = 1;
+
+/// Size of the header the Vulkan specification puts in front of pipeline cache data.
+constexpr std::size_t PipelineCacheHeaderSize = 16 + VK_UUID_SIZE;
+
+} // Anonymous namespace
+
+std::size_t GraphicsPipelineCacheKey::Hash() const noexcept {
+    return static_cast<std::size_t>(Common::ComputeFastHash64(this, sizeof(*this)));
+}
+
+bool GraphicsPipelineCacheKey::operator==(const GraphicsPipelineCacheKey& rhs) const noexcept {
+    return std::memcmp(this, &rhs, sizeof(*this)) == 0;
+}
+
+VKPipelineDiskCache::VKPipelineDiskCache(Core::System& system, const VKDevice& device)
+    : system{system}, device{device} {
+    CreatePipelineCache({});
+}
+
+VKPipelineDiskCache::~VKPipelineDiskCache() {
+    SavePipelineCache();
+}
+
+std::vector<GraphicsPipelineCacheKey> VKPipelineDiskCache::Load() {
+    // Skip games without title id. It's kept since the cache is saved again on shutdown, when the
+    // process might be gone.
+    title_id = system.CurrentProcess()->GetTitleID();
+    if (!Settings::values.use_disk_shader_cache || title_id == 0) {
+        return {};
+    }
+    tried_to_load = true;
+
+    CreatePipelineCache(LoadPipelineCacheData());
+
+    FileUtil::IOFile file(GetTransferablePath(), "rb");
+    if (!file.IsOpen()) {
+        LOG_INFO(Render_Vulkan, "No pipeline cache found for game with title id={}", GetTitleID());
+        return {};
+    }
+
+    u32 version{};
+    if (file.ReadBytes(&version, sizeof(version)) != sizeof(version) ||
+        version != NativeVersion) {
+        LOG_INFO(Render_Vulkan, "Pipeline cache for title id={} is outdated - removing",
+                 GetTitleID());
+        file.Close();
+        if (!FileUtil::Delete(GetTransferablePath())) {
+            LOG_ERROR(Render_Vulkan, "Failed to invalidate pipeline cache file={}",
+                      GetTransferablePath());
+        }
+        return {};
+    }
+
+    std::vector<GraphicsPipelineCacheKey> keys;
+    GraphicsPipelineCacheKey key;
+    while (file.ReadBytes(&key, sizeof(key)) == sizeof(key)) {
+        if (stored_keys.insert(key).second) {
+            keys.push_back(key);
+        }
+    }
+    LOG_INFO(Render_Vulkan, "Loaded {} pipeline keys for title id={}", keys.size(), GetTitleID());
+    return keys;
+}
+
+void VKPipelineDiskCache::SaveKey(const GraphicsPipelineCacheKey& key) {
+    if (!IsUsable() || !stored_keys.insert(key).second) {
+        return;
+    }
+    if (!EnsureDirectories()) {
+        return;
+    }
+
+    const auto transferable_path{GetTransferablePath()};
+    const bool existed = FileUtil::Exists(transferable_path);
+
+    FileUtil::IOFile file(transferable_path, "ab");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_Vulkan, "Failed to open pipeline cache in path={}", transferable_path);
+        return;
+    }
+    if (!existed || file.GetSize() == 0) {
+        // If the file didn't exist, write its version
+        if (file.WriteObject(NativeVersion) != 1) {
+            LOG_ERROR(Render_Vulkan, "Failed to write pipeline cache version in path={}",
+                      transferable_path);
+            return;
+        }
+    }
+    if (file.WriteObject(key) != 1) {
+        LOG_ERROR(Render_Vulkan, "Failed to write pipeline key in path={}", transferable_path);
+    }
+}
+
+void VKPipelineDiskCache::SavePipelineCache() const {
+    if (!IsUsable() || !EnsureDirectories()) {
+        return;
+    }
+
+    const auto dev = device.GetLogical();
+    const auto& dld = device.GetDispatchLoader();
+    const std::vector<u8> data = dev.getPipelineCacheData(*pipeline_cache, dld);
+
+    const auto path{GetPipelineCachePath()};
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_Vulkan, "Failed to open driver pipeline cache in path={}", path);
+        return;
+    }
+    if (file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Render_Vulkan, "Failed to write driver pipeline cache in path={}", path);
+    }
+}
+
+std::vector<u8> VKPipelineDiskCache::LoadPipelineCacheData() const {
+    FileUtil::IOFile file(GetPipelineCachePath(), "rb");
+    if (!file.IsOpen()) {
+        return {};
+    }
+    std::vector<u8> data(static_cast<std::size_t>(file.GetSize()));
+    if (data.size() < PipelineCacheHeaderSize ||
+        file.ReadBytes(data.data(), data.size()) != data.size()) {
+        return {};
+    }
+
+    // Drivers are supposed to reject foreign data themselves, but some don't handle it well.
+    // Only hand over blobs that were written by this same device.
+    const auto properties = device.GetPhysical().getProperties(device.GetDispatchLoader());
+    u32 vendor_id{};
+    u32 device_id{};
+    std::memcpy(&vendor_id, data.data() + 8, sizeof(vendor_id));
+    std::memcpy(&device_id, data.data() + 12, sizeof(device_id));
+    if (vendor_id != properties.vendorID || device_id != properties.deviceID ||
+        std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        LOG_INFO(Render_Vulkan, "Driver pipeline cache was built by another driver - skipping");
+        return {};
+    }
+    return data;
+}
+
+void VKPipelineDiskCache::CreatePipelineCache(const std::vector<u8>& initial_data) {
+    const vk::PipelineCacheCreateInfo cache_ci({}, initial_data.size(), initial_data.data());
+    const auto dev = device.GetLogical();
+    const auto& dld = device.GetDispatchLoader();
+    pipeline_cache = dev.createPipelineCacheUnique(cache_ci, nullptr, dld);
+}
+
+bool VKPipelineDiskCache::IsUsable() const {
+    return tried_to_load && Settings::values.use_disk_shader_cache;
+}
+
+bool VKPipelineDiskCache::EnsureDirectories() const {
+    const auto CreateDir = [](const std::string& dir) {
+        if (!FileUtil::CreateDir(dir)) {
+            LOG_ERROR(Render_Vulkan, "Failed to create directory={}", dir);
+            return false;
+        }
+        return true;
+    };
+
+    return CreateDir(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)) &&
+           CreateDir(GetBaseDir()) && CreateDir(GetTransferableDir()) &&
+           CreateDir(GetPipelineCacheDir());
+}
+
+std::string VKPipelineDiskCache::GetTransferablePath() const {
+    return FileUtil::SanitizePath(GetTransferableDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
+}
+
+std::string VKPipelineDiskCache::GetPipelineCachePath() const {
+    return FileUtil::SanitizePath(GetPipelineCacheDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
+}
+
+std::string VKPipelineDiskCache::GetTransferableDir() const {
+    return GetBaseDir() + DIR_SEP "transferable";
+}
+
+std::string VKPipelineDiskCache::GetPipelineCacheDir() const {
+    return GetBaseDir() + DIR_SEP "pipeline";
+}
+
+std::string VKPipelineDiskCache::GetBaseDir() const {
+    return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "vulkan";
+}
+
+std::string VKPipelineDiskCache::GetTitleID() const {
+    return fmt::format("{:016X}", title_id);
+}
+
+} // namespace Vulkan
@@ -0,0 +1,109 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/fixed_pipeline_state.h"
+
+namespace Core {
+class System;
+}
+
+namespace Vulkan {
+
+class VKDevice;
+
+/// Everything a graphics pipeline is built from: its fixed state and the guest shaders whose
+/// SPIR-V modules are bound to each stage.
+struct GraphicsPipelineCacheKey {
+    FixedPipelineState fixed_state;
+    std::array<u64, Maxwell::MaxShaderProgram> shaders{}; ///< Shader unique ids, zero if unused.
+
+    std::size_t Hash() const noexcept;
+
+    bool operator==(const GraphicsPipelineCacheKey& rhs) const noexcept;
+
+    bool operator!=(const GraphicsPipelineCacheKey& rhs) const noexcept {
+        return !operator==(rhs);
+    }
+};
+static_assert(std::has_unique_object_representations_v<GraphicsPipelineCacheKey>,
+              "GraphicsPipelineCacheKey must not have padding, it's stored as raw memory");
+
+} // namespace Vulkan
+
+namespace std {
+
+template <>
+struct hash<Vulkan::GraphicsPipelineCacheKey> {
+    std::size_t operator()(const Vulkan::GraphicsPipelineCacheKey& k) const noexcept {
+        return k.Hash();
+    }
+};
+
+} // namespace std
+
+namespace Vulkan {
+
+/**
+ * Keeps what pipeline creation learns about a title across boots. The keys of every pipeline
+ * built are recorded in a transferable file, so they can be built ahead of time on the next boot,
+ * and the driver's VkPipelineCache is seeded from and saved back to a per device blob.
+ */
+class VKPipelineDiskCache final {
+public:
+    explicit VKPipelineDiskCache(Core::System& system, const VKDevice& device);
+    ~VKPipelineDiskCache();
+
+    /// Loads the cache files of the current title, returns the keys of previously built pipelines.
+    std::vector<GraphicsPipelineCacheKey> Load();
+
+    /// Records the key of a pipeline that has been built, keys already on disk are skipped.
+    void SaveKey(const GraphicsPipelineCacheKey& key);
+
+    /// Writes the contents of the driver pipeline cache to disk.
+    void SavePipelineCache() const;
+
+    /// Returns the pipeline cache to pass to pipeline creation.
+    vk::PipelineCache GetPipelineCache() const {
+        return *pipeline_cache;
+    }
+
+private:
+    /// Returns the blob if it was written by this device and driver, an empty vector otherwise.
+    std::vector<u8> LoadPipelineCacheData() const;
+
+    /// Creates the driver pipeline cache, optionally seeded with previously saved data.
+    void CreatePipelineCache(const std::vector<u8>& initial_data);
+
+    bool IsUsable() const;
+
+    bool EnsureDirectories() const;
+
+    std::string GetTransferablePath() const;
+    std::string GetPipelineCachePath() const;
+    std::string GetTransferableDir() const;
+    std::string GetPipelineCacheDir() const;
+    std::string GetBaseDir() const;
+    std::string GetTitleID() const;
+
+    Core::System& system;
+    const VKDevice& device;
+    UniquePipelineCache pipeline_cache;
+
+    std::unordered_set<GraphicsPipelineCacheKey> stored_keys;
+    u64 title_id = 0;
+    bool tried_to_load = false;
+};
+
+} // namespace Vulkan
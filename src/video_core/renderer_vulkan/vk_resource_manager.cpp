@@ -62,12 +62,8 @@ private:
     std::vector<std::unique_ptr<Pool>> pools;
 };
 
-VKResource::VKResource() = default;
-
-VKResource::~VKResource() = default;
-
-VKFence::VKFence(const VKDevice& device, UniqueFence handle)
-    : device{device}, handle{std::move(handle)} {}
+VKFence::VKFence(const VKDevice& device, VKResourceManager& resource_manager, UniqueFence handle)
+    : device{device}, resource_manager{resource_manager}, handle{std::move(handle)} {}
 
 VKFence::~VKFence() = default;
 
@@ -75,13 +71,15 @@ void VKFence::Wait() {
     const auto dev = device.GetLogical();
     const auto& dld = device.GetDispatchLoader();
     dev.waitForFences({*handle}, true, std::numeric_limits<u64>::max(), dld);
+    resource_manager.OnTickCompleted(tick);
 }
 
 void VKFence::Release() {
     is_owned = false;
 }
 
-void VKFence::Commit() {
+void VKFence::Commit(u64 new_tick) {
+    tick = new_tick;
     is_owned = true;
     is_used = true;
 }
@@ -109,11 +107,8 @@ bool VKFence::Tick(bool gpu_wait, bool owner_wait) {
         }
     }
 
-    // Broadcast resources their free state.
-    for (auto* resource : protected_resources) {
-        resource->OnFenceRemoval(this);
-    }
-    protected_resources.clear();
+    // Resources watching this tick or an older one are now free.
+    resource_manager.OnTickCompleted(tick);
 
     // Prepare fence for reusage.
     dev.resetFences({*handle}, dld);
@@ -121,54 +116,33 @@ bool VKFence::Tick(bool gpu_wait, bool owner_wait) {
     return true;
 }
 
-void VKFence::Protect(VKResource* resource) {
-    protected_resources.push_back(resource);
-}
-
-void VKFence::Unprotect(VKResource* resource) {
-    const auto it = std::find(protected_resources.begin(), protected_resources.end(), resource);
-    ASSERT(it != protected_resources.end());
-
-    resource->OnFenceRemoval(this);
-    protected_resources.erase(it);
-}
-
 VKFenceWatch::VKFenceWatch() = default;
 
-VKFenceWatch::~VKFenceWatch() {
-    if (fence) {
-        fence->Unprotect(this);
-    }
-}
+VKFenceWatch::~VKFenceWatch() = default;
 
 void VKFenceWatch::Wait() {
-    if (fence == nullptr) {
+    if (resource_manager == nullptr) {
         return;
     }
-    fence->Wait();
-    fence->Unprotect(this);
+    resource_manager->WaitTick(tick);
+    resource_manager = nullptr;
 }
 
 void VKFenceWatch::Watch(VKFence& new_fence) {
     Wait();
-    fence = &new_fence;
-    fence->Protect(this);
+    resource_manager = &new_fence.GetResourceManager();
+    tick = new_fence.GetTick();
 }
 
 bool VKFenceWatch::TryWatch(VKFence& new_fence) {
-    if (fence) {
+    if (resource_manager && !resource_manager->IsTickComplete(tick)) {
         return false;
     }
-    fence = &new_fence;
-    fence->Protect(this);
+    resource_manager = &new_fence.GetResourceManager();
+    tick = new_fence.GetTick();
     return true;
 }
 
-void VKFenceWatch::OnFenceRemoval(VKFence* signaling_fence) {
-    ASSERT_MSG(signaling_fence == fence, "Removing the wrong fence");
-    fence = nullptr;
-}
-
 VKFencedPool::VKFencedPool(std::size_t grow_step) : grow_step{grow_step} {}
 
 VKFencedPool::~VKFencedPool() = default;
@@ -243,7 +217,7 @@ VKFence& VKResourceManager::CommitFence() {
             fences_iterator = 0;
 
         auto& fence = *it;
-        fence->Commit();
+        fence->Commit(++current_tick);
         return fence.get();
     };
 
@@ -269,6 +243,25 @@ vk::CommandBuffer VKResourceManager::CommitCommandBuffer(VKFence& fence) {
     return command_buffer_pool->Commit(fence);
 }
 
+void VKResourceManager::WaitTick(u64 tick) {
+    if (IsTickComplete(tick)) {
+        return;
+    }
+    const auto it = std::find_if(fences.begin(), fences.end(), [tick](const auto& fence) {
+        return fence->is_used && fence->tick == tick;
+    });
+    if (it == fences.end()) {
+        // Fences are only reused after completing, so the tick has finished
+        OnTickCompleted(tick);
+        return;
+    }
+    (*it)->Wait();
+}
+
+void VKResourceManager::OnTickCompleted(u64 tick) {
+    completed_tick = std::max(completed_tick, tick);
+}
+
 void VKResourceManager::GrowFences(std::size_t new_fences_count) {
     const auto dev = device.GetLogical();
     const auto& dld = device.GetDispatchLoader();
@@ -278,7 +271,8 @@ void VKResourceManager::GrowFences(std::size_t new_fences_count) {
     fences.resize(previous_size + new_fences_count);
 
     std::generate(fences.begin() + previous_size, fences.end(), [&]() {
-        return std::make_unique<VKFence>(device, dev.createFenceUnique(fence_ci, nullptr, dld));
+        return std::make_unique<VKFence>(device, *this,
+                                         dev.createFenceUnique(fence_ci, nullptr, dld));
     });
 }
 
@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <memory>
 #include <vector>
+#include "common/common_types.h"
 #include "video_core/renderer_vulkan/declarations.h"
 
 namespace Vulkan {
@@ -17,32 +18,21 @@ class VKResourceManager;
 
 class CommandBufferPool;
 
-/// Interface for a Vulkan resource
-class VKResource {
-public:
-    explicit VKResource();
-    virtual ~VKResource();
-
-    /**
-     * Signals the object that an owning fence has been signaled.
-     * @param signaling_fence Fence that signals its usage end.
-     */
-    virtual void OnFenceRemoval(VKFence* signaling_fence) = 0;
-};
-
 /**
  * Fences take ownership of objects, protecting them from GPU-side or driver-side concurrent access.
  * They must be commited from the resource manager. Their usage flow is: commit the fence from the
  * resource manager, protect resources with it and use them, send the fence to an execution queue
- * and Wait for it if needed and then call Release. Used resources will automatically be signaled
- * when they are free to be reused.
+ * and Wait for it if needed and then call Release. Each commit is numbered with a tick, resources
+ * only remember the tick of their last use and are free once the resource manager has seen that
+ * tick complete.
  * @brief Protects resources for concurrent usage and signals its release.
  */
 class VKFence {
     friend class VKResourceManager;
 
 public:
-    explicit VKFence(const VKDevice& device, UniqueFence handle);
+    explicit VKFence(const VKDevice& device, VKResourceManager& resource_manager,
+                     UniqueFence handle);
     ~VKFence();
 
     /**
@@ -59,11 +49,15 @@ public:
      */
     void Release();
 
-    /// Protects a resource with this fence.
-    void Protect(VKResource* resource);
+    /// Returns the tick of the execution this fence protects.
+    u64 GetTick() const {
+        return tick;
+    }
 
-    /// Removes protection for a resource.
-    void Unprotect(VKResource* resource);
+    /// Returns the resource manager the fence was committed from.
+    VKResourceManager& GetResourceManager() const {
+        return resource_manager;
+    }
 
     /// Retreives the fence.
     operator vk::Fence() const {
@@ -72,7 +66,7 @@ public:
 
 private:
     /// Take ownership of the fence.
-    void Commit();
+    void Commit(u64 new_tick);
 
     /**
      * Updates the fence status.
@@ -83,21 +77,23 @@ private:
      */
     bool Tick(bool gpu_wait, bool owner_wait);
 
-    const VKDevice& device;                       ///< Device handler
-    UniqueFence handle;                           ///< Vulkan fence
-    std::vector<VKResource*> protected_resources; ///< List of resources protected by this fence
+    const VKDevice& device;              ///< Device handler
+    VKResourceManager& resource_manager; ///< Resource manager notified when the fence completes
+    UniqueFence handle;                  ///< Vulkan fence
+    u64 tick = 0;                        ///< Tick of the last commit
     bool is_owned = false; ///< The fence has been commited but not released yet.
     bool is_used = false;  ///< The fence has been commited but it has not been checked to be free.
 };
 
 /**
  * A fence watch is used to keep track of the usage of a fence and protect a resource or set of
- * resources without having to inherit VKResource from their handlers.
+ * resources. It only stores the tick of the fence it watches, so fences don't keep track of their
+ * watches.
  */
-class VKFenceWatch final : public VKResource {
+class VKFenceWatch final {
 public:
     explicit VKFenceWatch();
-    ~VKFenceWatch() override;
+    ~VKFenceWatch();
 
     /// Waits for the fence to be released.
     void Wait();
@@ -114,10 +110,9 @@ public:
      */
     bool TryWatch(VKFence& new_fence);
 
-    void OnFenceRemoval(VKFence* signaling_fence) override;
-
 private:
-    VKFence* fence{}; ///< Fence watching this resource. nullptr when the watch is free.
+    VKResourceManager* resource_manager{}; ///< Manager of the watched fence, nullptr if unused.
+    u64 tick{};                            ///< Tick of the watched fence.
 };
 
 /**
@@ -157,6 +152,8 @@ private:
  * driver-side or GPU-side concurrent usage. Usage is documented in VKFence.
  */
 class VKResourceManager final {
+    friend class VKFence;
+
 public:
     explicit VKResourceManager(const VKDevice& device);
     ~VKResourceManager();
@@ -167,12 +164,26 @@ public:
     /// Commits an unused command buffer and protects it with a fence.
     vk::CommandBuffer CommitCommandBuffer(VKFence& fence);
 
+    /// Returns true when the execution of the tick is known to have completed. It's updated every
+    /// time a fence is committed or waited for.
+    bool IsTickComplete(u64 tick) const {
+        return tick <= completed_tick;
+    }
+
+    /// Waits for the execution of the tick to complete.
+    void WaitTick(u64 tick);
+
 private:
+    /// Records that every execution up to the tick has completed, they are executed in order.
+    void OnTickCompleted(u64 tick);
+
     /// Allocates new fences.
     void GrowFences(std::size_t new_fences_count);
 
     const VKDevice& device;          ///< Device handler.
     std::size_t fences_iterator = 0; ///< Index where a free fence is likely to be found.
+    u64 current_tick = 0;            ///< Tick of the last committed fence.
+    u64 completed_tick = 0;          ///< Last tick known to have completed.
     std::vector<std::unique_ptr<VKFence>> fences;           ///< Pool of fences.
     std::unique_ptr<CommandBufferPool> command_buffer_pool; ///< Pool of command buffers.
 };
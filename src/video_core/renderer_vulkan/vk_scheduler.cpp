@@ -2,8 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <mutex>
+#include <utility>
+
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
 #include "video_core/renderer_vulkan/declarations.h"
 #include "video_core/renderer_vulkan/vk_device.h"
 #include "video_core/renderer_vulkan/vk_resource_manager.h"
@@ -11,13 +16,48 @@
 
 namespace Vulkan {
 
+MICROPROFILE_DEFINE(Vulkan_WaitForWorker, "Vulkan", "Wait for worker", MP_RGB(255, 192, 192));
+
+VKScheduler::CommandChunk::~CommandChunk() {
+    Clear();
+}
+
+void VKScheduler::CommandChunk::ExecuteAll(vk::CommandBuffer cmdbuf,
+                                           const vk::DispatchLoaderDynamic& dld) {
+    for (Command* command = first; command != nullptr; command = command->GetNext()) {
+        command->Execute(cmdbuf, dld);
+    }
+    Clear();
+}
+
+void VKScheduler::CommandChunk::Clear() {
+    Command* command = first;
+    while (command != nullptr) {
+        Command* const next = command->GetNext();
+        command->~Command();
+        command = next;
+    }
+    first = nullptr;
+    last = nullptr;
+    command_offset = 0;
+}
+
 VKScheduler::VKScheduler(const VKDevice& device, VKResourceManager& resource_manager)
     : device{device}, resource_manager{resource_manager} {
+    chunk = AcquireChunk();
     next_fence = &resource_manager.CommitFence();
     AllocateNewContext();
+    worker_thread = std::thread(&VKScheduler::WorkerThread, this);
 }
 
-VKScheduler::~VKScheduler() = default;
+VKScheduler::~VKScheduler() {
+    {
+        std::scoped_lock lock{mutex};
+        quit = true;
+    }
+    work_cv.notify_all();
+    worker_thread.join();
+}
 
 void VKScheduler::Flush(bool release_fence, vk::Semaphore semaphore) {
     SubmitExecution(semaphore);
@@ -34,7 +74,30 @@ void VKScheduler::Finish(bool release_fence, vk::Semaphore semaphore) {
     AllocateNewContext();
 }
 
+void VKScheduler::DispatchWork() {
+    if (chunk->Empty()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{mutex};
+        chunk_queue.push(std::move(chunk));
+    }
+    work_cv.notify_one();
+    chunk = AcquireChunk();
+}
+
+void VKScheduler::WaitWorker() {
+    DispatchWork();
+
+    MICROPROFILE_SCOPE(Vulkan_WaitForWorker);
+    std::unique_lock lock{mutex};
+    idle_cv.wait(lock, [this] { return chunk_queue.empty() && !worker_busy; });
+}
+
 void VKScheduler::SubmitExecution(vk::Semaphore semaphore) {
+    // The command buffer can't be ended while the worker is still recording to it.
+    WaitWorker();
+
     const auto& dld = device.GetDispatchLoader();
     current_cmdbuf.end(dld);
 
@@ -48,9 +111,48 @@ void VKScheduler::AllocateNewContext() {
     current_fence = next_fence;
     current_cmdbuf = resource_manager.CommitCommandBuffer(*current_fence);
     next_fence = &resource_manager.CommitFence();
+    ++context_count;
 
     const auto& dld = device.GetDispatchLoader();
     current_cmdbuf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit}, dld);
 }
 
+std::unique_ptr<VKScheduler::CommandChunk> VKScheduler::AcquireChunk() {
+    {
+        std::scoped_lock lock{mutex};
+        if (!chunk_reserve.empty()) {
+            std::unique_ptr<CommandChunk> reserved = std::move(chunk_reserve.back());
+            chunk_reserve.pop_back();
+            return reserved;
+        }
+    }
+    return std::make_unique<CommandChunk>();
+}
+
+void VKScheduler::WorkerThread() {
+    MicroProfileOnThreadCreate("VulkanWorker");
+    Common::SetCurrentThreadName("yuzu:VulkanWorker");
+
+    const auto& dld = device.GetDispatchLoader();
+    std::unique_lock lock{mutex};
+    while (true) {
+        work_cv.wait(lock, [this] { return !chunk_queue.empty() || quit; });
+        if (chunk_queue.empty()) {
+            return;
+        }
+        std::unique_ptr<CommandChunk> work = std::move(chunk_queue.front());
+        chunk_queue.pop();
+        worker_busy = true;
+
+        // The command buffer is only swapped once the worker is idle, it's safe to use unlocked.
+        lock.unlock();
+        work->ExecuteAll(current_cmdbuf, dld);
+        lock.lock();
+
+        chunk_reserve.push_back(std::move(work));
+        worker_busy = false;
+        idle_cv.notify_all();
+    }
+}
+
 } // namespace Vulkan
@@ -4,6 +4,18 @@
 
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/alignment.h"
 #include "common/common_types.h"
 #include "video_core/renderer_vulkan/declarations.h"
 
@@ -30,25 +42,9 @@ private:
     VKFence* const& fence;
 };
 
-class VKCommandBufferView {
-public:
-    VKCommandBufferView() = default;
-    VKCommandBufferView(const vk::CommandBuffer& cmdbuf) : cmdbuf{cmdbuf} {}
-
-    const vk::CommandBuffer* operator->() const noexcept {
-        return &cmdbuf;
-    }
-
-    operator vk::CommandBuffer() const noexcept {
-        return cmdbuf;
-    }
-
-private:
-    const vk::CommandBuffer& cmdbuf;
-};
-
 /// The scheduler abstracts command buffer and fence management with an interface that's able to do
-/// OpenGL-like operations on Vulkan command buffers.
+/// OpenGL-like operations on Vulkan command buffers. Commands are recorded by a worker thread, the
+/// caller only queues them in chunks.
 class VKScheduler {
 public:
     explicit VKScheduler(const VKDevice& device, VKResourceManager& resource_manager);
@@ -59,9 +55,9 @@ public:
         return current_fence;
     }
 
-    /// Gets a reference to the current command buffer.
-    VKCommandBufferView GetCommandBuffer() const {
-        return current_cmdbuf;
+    /// Returns a counter increased every time a new execution context begins.
+    u64 GetContextCount() const {
+        return context_count;
     }
 
     /// Sends the current execution context to the GPU.
@@ -70,16 +66,138 @@ public:
     /// Sends the current execution context to the GPU and waits for it to complete.
     void Finish(bool release_fence = true, vk::Semaphore semaphore = nullptr);
 
+    /// Hands the commands queued so far to the worker thread.
+    void DispatchWork();
+
+    /// Waits for the worker thread to record every command queued so far.
+    void WaitWorker();
+
+    /// Queues a command to be recorded on the current command buffer. The command is invoked on
+    /// the worker thread as command(vk::CommandBuffer, const vk::DispatchLoaderDynamic&), so it
+    /// has to own everything it references.
+    template <typename T>
+    void Record(T&& command) {
+        if (chunk->Record(command)) {
+            return;
+        }
+        DispatchWork();
+        [[maybe_unused]] const bool recorded = chunk->Record(command);
+    }
+
 private:
+    class Command {
+    public:
+        virtual ~Command() = default;
+
+        virtual void Execute(vk::CommandBuffer cmdbuf,
+                             const vk::DispatchLoaderDynamic& dld) const = 0;
+
+        Command* GetNext() const {
+            return next;
+        }
+
+        void SetNext(Command* next_) {
+            next = next_;
+        }
+
+    private:
+        Command* next = nullptr;
+    };
+
+    template <typename T>
+    class TypedCommand final : public Command {
+    public:
+        explicit TypedCommand(T&& command) : command{std::move(command)} {}
+        ~TypedCommand() override = default;
+
+        TypedCommand(TypedCommand&&) = delete;
+        TypedCommand& operator=(TypedCommand&&) = delete;
+
+        void Execute(vk::CommandBuffer cmdbuf,
+                     const vk::DispatchLoaderDynamic& dld) const override {
+            command(cmdbuf, dld);
+        }
+
+    private:
+        T command;
+    };
+
+    /// Fixed size block of commands, constructed in place and executed in recording order.
+    class CommandChunk final {
+    public:
+        CommandChunk() = default;
+        ~CommandChunk();
+
+        /// Executes and destroys every command of the chunk, leaving it empty.
+        void ExecuteAll(vk::CommandBuffer cmdbuf, const vk::DispatchLoaderDynamic& dld);
+
+        /// Moves the command into the chunk, returns false if there isn't room for it.
+        template <typename T>
+        bool Record(T& command) {
+            using FuncType = TypedCommand<T>;
+            static_assert(sizeof(FuncType) < ChunkSize, "Command is too large");
+            static_assert(alignof(FuncType) <= alignof(std::max_align_t),
+                          "Command is over-aligned");
+
+            const std::size_t offset = Common::AlignUp(command_offset, alignof(FuncType));
+            if (offset + sizeof(FuncType) > ChunkSize) {
+                return false;
+            }
+            Command* const current_last = last;
+            last = new (data.data() + offset) FuncType(std::move(command));
+            if (current_last != nullptr) {
+                current_last->SetNext(last);
+            } else {
+                first = last;
+            }
+            command_offset = offset + sizeof(FuncType);
+            return true;
+        }
+
+        bool Empty() const {
+            return first == nullptr;
+        }
+
+    private:
+        static constexpr std::size_t ChunkSize = 0x8000;
+
+        /// Destroys the commands without executing the ones that are left.
+        void Clear();
+
+        Command* first = nullptr;
+        Command* last = nullptr;
+        std::size_t command_offset = 0;
+        alignas(std::max_align_t) std::array<u8, ChunkSize> data{};
+    };
+
     void SubmitExecution(vk::Semaphore semaphore);
 
     void AllocateNewContext();
 
+    /// Takes a cleared chunk from the reserve, allocating one if there are none left.
+    std::unique_ptr<CommandChunk> AcquireChunk();
+
+    void WorkerThread();
+
     const VKDevice& device;
     VKResourceManager& resource_manager;
     vk::CommandBuffer current_cmdbuf;
     VKFence* current_fence = nullptr;
     VKFence* next_fence = nullptr;
+    u64 context_count = 0;
+
+    /// Chunk commands are being queued to, only touched by the caller's thread.
+    std::unique_ptr<CommandChunk> chunk;
+
+    std::mutex mutex;
+    std::condition_variable work_cv; ///< Signaled when chunks are dispatched or on shutdown.
+    std::condition_variable idle_cv; ///< Signaled when the worker finishes a chunk.
+    std::queue<std::unique_ptr<CommandChunk>> chunk_queue; ///< Chunks waiting to be recorded.
+    std::vector<std::unique_ptr<CommandChunk>> chunk_reserve; ///< Cleared chunks to reuse.
+    bool worker_busy = false;
+    bool quit = false;
+
+    std::thread worker_thread;
 };
 
 } // namespace Vulkan
@@ -14,6 +14,7 @@
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/shader_bytecode.h"
 #include "video_core/engines/shader_header.h"
@@ -24,6 +25,8 @@
 
 namespace Vulkan::VKShader {
 
+MICROPROFILE_DEFINE(Vulkan_SPIRVEmit, "Vulkan", "SPIR-V Emit", MP_RGB(192, 128, 192));
+
 using Sirit::Id;
 using Tegra::Shader::Attribute;
 using Tegra::Shader::AttributeUse;
@@ -1863,6 +1866,7 @@ void SPIRVDecompiler::DecompileAST() {
 
 DecompilerResult Decompile(const VKDevice& device, const VideoCommon::Shader::ShaderIR& ir,
                            Maxwell::ShaderStage stage) {
+    MICROPROFILE_SCOPE(Vulkan_SPIRVEmit);
     auto decompiler = std::make_unique<SPIRVDecompiler>(device, ir, stage);
     decompiler->Decompile();
     return {std::move(decompiler), decompiler->GetShaderEntries()};
@@ -0,0 +1,107 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <utility>
+
+#include "common/bit_util.h"
+#include "common/common_types.h"
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/vk_device.h"
+#include "video_core/renderer_vulkan/vk_memory_manager.h"
+#include "video_core/renderer_vulkan/vk_resource_manager.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_staging_buffer_pool.h"
+
+namespace Vulkan {
+
+namespace {
+
+/// Smallest buffer handed out, smaller requests share its level.
+constexpr std::size_t MinLevel = 12;
+
+} // Anonymous namespace
+
+VKStagingBufferPool::StagingBuffer::StagingBuffer(std::unique_ptr<VKBuffer> buffer)
+    : buffer{std::move(buffer)}, watch{std::make_unique<VKFenceWatch>()} {}
+
+VKStagingBufferPool::StagingBuffer::~StagingBuffer() = default;
+
+VKStagingBufferPool::StagingBuffer::StagingBuffer(StagingBuffer&&) noexcept = default;
+
+VKStagingBufferPool::StagingBuffer& VKStagingBufferPool::StagingBuffer::operator=(
+    StagingBuffer&&) noexcept = default;
+
+VKStagingBufferPool::VKStagingBufferPool(const VKDevice& device, VKMemoryManager& memory_manager,
+                                         VKScheduler& scheduler)
+    : device{device}, memory_manager{memory_manager}, scheduler{scheduler} {}
+
+VKStagingBufferPool::~VKStagingBufferPool() = default;
+
+VKBuffer& VKStagingBufferPool::GetUnusedBuffer(std::size_t size) {
+    const std::size_t level = GetLevel(size);
+    ++stats.requests;
+    if (VKBuffer* const buffer = TryGetReservedBuffer(level)) {
+        ++stats.hits;
+        return *buffer;
+    }
+    if (levels[level].size() >= MaxBuffersPerLevel) {
+        ++stats.hits;
+        ++stats.stalls;
+        return WaitReservedBuffer(level);
+    }
+    return CreateStagingBuffer(level);
+}
+
+VKBuffer* VKStagingBufferPool::TryGetReservedBuffer(std::size_t level) {
+    auto& buffers = levels[level];
+    const std::size_t count = buffers.size();
+    for (std::size_t step = 0; step < count; ++step) {
+        const std::size_t index = (iterators[level] + step) % count;
+        if (buffers[index].watch->TryWatch(scheduler.GetFence())) {
+            iterators[level] = (index + 1) % count;
+            return buffers[index].buffer.get();
+        }
+    }
+    return nullptr;
+}
+
+VKBuffer& VKStagingBufferPool::WaitReservedBuffer(std::size_t level) {
+    auto& buffers = levels[level];
+    const std::size_t index = iterators[level];
+    iterators[level] = (index + 1) % buffers.size();
+
+    // Buffers are taken in a round robin, this is likely the one released the longest ago.
+    buffers[index].watch->Watch(scheduler.GetFence());
+    return *buffers[index].buffer;
+}
+
+VKBuffer& VKStagingBufferPool::CreateStagingBuffer(std::size_t level) {
+    const u64 size = u64{1} << level;
+    const vk::BufferCreateInfo buffer_ci(
+        {}, size, vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+        vk::SharingMode::eExclusive, 0, nullptr);
+
+    const auto dev = device.GetLogical();
+    const auto& dld = device.GetDispatchLoader();
+    auto buffer = std::make_unique<VKBuffer>();
+    buffer->handle = dev.createBufferUnique(buffer_ci, nullptr, dld);
+    buffer->commit = memory_manager.Commit(*buffer->handle, true);
+
+    auto& entry = levels[level].emplace_back(std::move(buffer));
+    entry.watch->Watch(scheduler.GetFence());
+
+    stats.resident_bytes += size;
+    ++stats.num_buffers;
+    return *entry.buffer;
+}
+
+std::size_t VKStagingBufferPool::GetLevel(std::size_t size) {
+    if (size <= (std::size_t{1} << MinLevel)) {
+        return MinLevel;
+    }
+    return Common::Log2Ceil64(static_cast<u64>(size));
+}
+
+} // namespace Vulkan
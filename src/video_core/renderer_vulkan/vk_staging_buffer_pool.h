@@ -0,0 +1,100 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/vk_memory_manager.h"
+
+namespace Vulkan {
+
+class VKDevice;
+class VKFenceWatch;
+class VKScheduler;
+
+/// Host visible buffer with its memory.
+struct VKBuffer final {
+    UniqueBuffer handle;
+    VKMemoryCommit commit;
+};
+
+/**
+ * Hands out host visible buffers to copy data from or to the GPU. Buffers are binned by the power
+ * of two of their size and are reused once the fence of the last execution that used them has
+ * been signaled, so large copies neither wait for a stream buffer to wrap around nor allocate
+ * memory every time.
+ */
+class VKStagingBufferPool final {
+public:
+    struct Statistics {
+        u64 requests = 0;       ///< Buffers asked for.
+        u64 hits = 0;           ///< Requests served with a buffer that was already allocated.
+        u64 stalls = 0;         ///< Requests that had to wait for the GPU to release a buffer.
+        u64 resident_bytes = 0; ///< Memory held by the pool.
+        u32 num_buffers = 0;
+
+        double HitRate() const {
+            return requests == 0 ? 0.0 : static_cast<double>(hits) / requests;
+        }
+    };
+
+    explicit VKStagingBufferPool(const VKDevice& device, VKMemoryManager& memory_manager,
+                                 VKScheduler& scheduler);
+    ~VKStagingBufferPool();
+
+    /**
+     * Returns a buffer holding at least the given size. It's protected by the current fence of
+     * the scheduler and shouldn't be used after that execution has been flushed.
+     */
+    VKBuffer& GetUnusedBuffer(std::size_t size);
+
+    const Statistics& GetStatistics() const {
+        return stats;
+    }
+
+private:
+    /// Buffers in use at once before requests of that size wait for one to be released.
+    static constexpr std::size_t MaxBuffersPerLevel = 32;
+
+    static constexpr std::size_t NumLevels = sizeof(std::size_t) * CHAR_BIT;
+
+    struct StagingBuffer {
+        explicit StagingBuffer(std::unique_ptr<VKBuffer> buffer);
+        ~StagingBuffer();
+
+        StagingBuffer(StagingBuffer&&) noexcept;
+        StagingBuffer& operator=(StagingBuffer&&) noexcept;
+
+        std::unique_ptr<VKBuffer> buffer;
+        std::unique_ptr<VKFenceWatch> watch;
+    };
+
+    /// Returns a buffer of the level that's no longer in use, or null if there is none.
+    VKBuffer* TryGetReservedBuffer(std::size_t level);
+
+    /// Waits for the next buffer of a full level to be released and returns it.
+    VKBuffer& WaitReservedBuffer(std::size_t level);
+
+    VKBuffer& CreateStagingBuffer(std::size_t level);
+
+    static std::size_t GetLevel(std::size_t size);
+
+    const VKDevice& device;
+    VKMemoryManager& memory_manager;
+    VKScheduler& scheduler;
+
+    std::array<std::vector<StagingBuffer>, NumLevels> levels;
+    std::array<std::size_t, NumLevels> iterators{}; ///< Where a free buffer is likely to be found.
+
+    Statistics stats;
+};
+
+} // namespace Vulkan
@@ -0,0 +1,100 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/vk_descriptor_pool.h"
+#include "video_core/renderer_vulkan/vk_device.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_shader_decompiler.h"
+#include "video_core/renderer_vulkan/vk_update_descriptor.h"
+
+namespace Vulkan {
+
+void FillDescriptorUpdateTemplateEntries(
+    const VKShader::ShaderEntries& entries, u32& offset,
+    std::vector<vk::DescriptorUpdateTemplateEntry>& template_entries) {
+    constexpr auto entry_size = static_cast<u32>(sizeof(DescriptorUpdateEntry));
+    const auto AddEntries = [&](vk::DescriptorType descriptor_type, u32 base_binding,
+                                std::size_t count) {
+        for (u32 index = 0; index < static_cast<u32>(count); ++index) {
+            template_entries.emplace_back(base_binding + index, 0, 1, descriptor_type, offset,
+                                          entry_size);
+            offset += entry_size;
+        }
+    };
+    AddEntries(vk::DescriptorType::eUniformBuffer, entries.const_buffers_base_binding,
+               entries.const_buffers.size());
+    AddEntries(vk::DescriptorType::eStorageBuffer, entries.global_buffers_base_binding,
+               entries.global_buffers.size());
+    AddEntries(vk::DescriptorType::eCombinedImageSampler, entries.samplers_base_binding,
+               entries.samplers.size());
+}
+
+UniqueDescriptorUpdateTemplate CreateDescriptorUpdateTemplate(
+    const VKDevice& device, vk::DescriptorSetLayout layout, vk::PipelineBindPoint bind_point,
+    vk::PipelineLayout pipeline_layout,
+    const std::vector<vk::DescriptorUpdateTemplateEntry>& template_entries) {
+    const vk::DescriptorUpdateTemplateCreateInfo create_info(
+        {}, static_cast<u32>(template_entries.size()), template_entries.data(),
+        vk::DescriptorUpdateTemplateType::eDescriptorSet, layout, bind_point, pipeline_layout,
+        VKShader::DESCRIPTOR_SET);
+    const auto dev = device.GetLogical();
+    return dev.createDescriptorUpdateTemplateUnique(create_info, nullptr,
+                                                    device.GetDispatchLoader());
+}
+
+VKUpdateDescriptorQueue::VKUpdateDescriptorQueue(const VKDevice& device, VKScheduler& scheduler)
+    : device{device}, scheduler{scheduler} {}
+
+VKUpdateDescriptorQueue::~VKUpdateDescriptorQueue() = default;
+
+void VKUpdateDescriptorQueue::Acquire() {
+    // Sets are only known to be alive until the fence of the context they were written in
+    const u64 context = scheduler.GetContextCount();
+    if (context != written_sets_context) {
+        written_sets_context = context;
+        written_sets.clear();
+        payload.clear();
+    }
+    payload_start = payload.size();
+}
+
+vk::DescriptorSet VKUpdateDescriptorQueue::Send(vk::DescriptorUpdateTemplate update_template,
+                                                DescriptorAllocator& allocator) {
+    const std::size_t begin = payload_start;
+    const std::size_t end = payload.size();
+    const u64 hash = Common::ComputeFastHash64(payload.data() + begin,
+                                               (end - begin) * sizeof(DescriptorUpdateEntry));
+
+    const auto [first, last] = written_sets.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        const WrittenSet& written = it->second;
+        if (written.update_template == update_template &&
+            written.end - written.begin == end - begin &&
+            IsPayloadEqual(written.begin, begin, end - begin)) {
+            payload.resize(begin);
+            return written.set;
+        }
+    }
+
+    const vk::DescriptorSet set = allocator.Commit(scheduler.GetFence());
+    const auto dev = device.GetLogical();
+    dev.updateDescriptorSetWithTemplate(set, update_template, payload.data() + begin,
+                                        device.GetDispatchLoader());
+    written_sets.emplace(hash, WrittenSet{update_template, begin, end, set});
+    return set;
+}
+
+bool VKUpdateDescriptorQueue::IsPayloadEqual(std::size_t lhs_begin, std::size_t rhs_begin,
+                                             std::size_t count) const {
+    return std::memcmp(payload.data() + lhs_begin, payload.data() + rhs_begin,
+                       count * sizeof(DescriptorUpdateEntry)) == 0;
+}
+
+} // namespace Vulkan
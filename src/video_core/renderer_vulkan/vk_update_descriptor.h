@@ -0,0 +1,129 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/renderer_vulkan/declarations.h"
+
+namespace Vulkan {
+
+class DescriptorAllocator;
+class VKDevice;
+class VKScheduler;
+
+namespace VKShader {
+struct ShaderEntries;
+}
+
+/// Descriptor written through an update template, entries are laid out with this stride.
+class DescriptorUpdateEntry {
+public:
+    DescriptorUpdateEntry(vk::DescriptorImageInfo image_) {
+        Clear();
+        image = image_;
+    }
+
+    DescriptorUpdateEntry(vk::DescriptorBufferInfo buffer_) {
+        Clear();
+        buffer = buffer_;
+    }
+
+    DescriptorUpdateEntry(vk::BufferView texel_buffer_) {
+        Clear();
+        texel_buffer = texel_buffer_;
+    }
+
+private:
+    /// Zeroes the padding too, entries are hashed and compared as raw memory.
+    void Clear() {
+        std::memset(this, 0, sizeof(*this));
+    }
+
+    union {
+        vk::DescriptorImageInfo image;
+        vk::DescriptorBufferInfo buffer;
+        vk::BufferView texel_buffer;
+    };
+};
+static_assert(std::is_trivially_copyable_v<DescriptorUpdateEntry>);
+
+/**
+ * Appends the update template entries of the descriptors used by a shader stage. Descriptors are
+ * read from consecutive DescriptorUpdateEntry values, starting at offset.
+ */
+void FillDescriptorUpdateTemplateEntries(
+    const VKShader::ShaderEntries& entries, u32& offset,
+    std::vector<vk::DescriptorUpdateTemplateEntry>& template_entries);
+
+/// Creates the update template writing the entries to sets of the layout.
+UniqueDescriptorUpdateTemplate CreateDescriptorUpdateTemplate(
+    const VKDevice& device, vk::DescriptorSetLayout layout, vk::PipelineBindPoint bind_point,
+    vk::PipelineLayout pipeline_layout,
+    const std::vector<vk::DescriptorUpdateTemplateEntry>& template_entries);
+
+/**
+ * Gathers the descriptors of a draw or dispatch and writes them to a set in a single template
+ * update. Sets written with the same template and descriptors earlier in the same submission are
+ * bound again instead of taking a new set.
+ */
+class VKUpdateDescriptorQueue final {
+public:
+    explicit VKUpdateDescriptorQueue(const VKDevice& device, VKScheduler& scheduler);
+    ~VKUpdateDescriptorQueue();
+
+    /// Starts gathering the descriptors of a new set.
+    void Acquire();
+
+    void AddSampledImage(vk::Sampler sampler, vk::ImageView image_view) {
+        payload.emplace_back(
+            vk::DescriptorImageInfo{sampler, image_view, vk::ImageLayout::eGeneral});
+    }
+
+    void AddImage(vk::ImageView image_view) {
+        payload.emplace_back(vk::DescriptorImageInfo{{}, image_view, vk::ImageLayout::eGeneral});
+    }
+
+    void AddBuffer(vk::Buffer buffer, u64 offset, std::size_t size) {
+        payload.emplace_back(vk::DescriptorBufferInfo{buffer, offset, size});
+    }
+
+    void AddTexelBuffer(vk::BufferView texel_buffer) {
+        payload.emplace_back(texel_buffer);
+    }
+
+    /// Returns a set holding the descriptors gathered since Acquire.
+    vk::DescriptorSet Send(vk::DescriptorUpdateTemplate update_template,
+                           DescriptorAllocator& allocator);
+
+private:
+    /// Set written in the current submission.
+    struct WrittenSet {
+        vk::DescriptorUpdateTemplate update_template;
+        std::size_t begin;
+        std::size_t end;
+        vk::DescriptorSet set;
+    };
+
+    /// Returns true when both ranges of the payload hold the same descriptors.
+    bool IsPayloadEqual(std::size_t lhs_begin, std::size_t rhs_begin, std::size_t count) const;
+
+    const VKDevice& device;
+    VKScheduler& scheduler;
+
+    std::vector<DescriptorUpdateEntry> payload;
+    std::size_t payload_start = 0;
+
+    /// Sets written in the current execution context, by the hash of their descriptors.
+    std::unordered_multimap<u64, WrittenSet> written_sets;
+    u64 written_sets_context = 0;
+};
+
+} // namespace Vulkan
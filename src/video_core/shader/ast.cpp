@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -439,6 +441,8 @@ void ASTManager::InsertReturn(Expr condition, bool kills) {
 // through outward/inward movements and lifting. Once they are at the same
 // level, you can enclose them in an "if" structure or a "do-while" structure.
 void ASTManager::Decompile() {
+    EncloseNestedGotos();
+
     auto it = gotos.begin();
     while (it != gotos.end()) {
         const ASTNode goto_node = *it;
@@ -496,28 +500,96 @@ void ASTManager::Decompile() {
         }
         labels.clear();
     } else {
-        auto it = labels.begin();
-        while (it != labels.end()) {
-            bool can_remove = true;
-            ASTNode label = *it;
-            for (const ASTNode& goto_node : gotos) {
-                const auto label_index = goto_node->GetGotoLabel();
-                if (!label_index) {
-                    return;
-                }
-                ASTNode& glabel = labels[*label_index];
-                if (glabel == label) {
-                    can_remove = false;
-                    break;
-                }
+        std::vector<bool> used_labels(labels.size());
+        for (const ASTNode& goto_node : gotos) {
+            const auto label_index = goto_node->GetGotoLabel();
+            if (!label_index) {
+                return;
             }
-            if (can_remove) {
-                label->MarkLabelUnused();
+            used_labels[*label_index] = true;
+        }
+        for (std::size_t index = 0; index < labels.size(); ++index) {
+            if (labels[index] && !used_labels[index]) {
+                labels[index]->MarkLabelUnused();
             }
         }
     }
 }
 
+// Gotos still have to be taken apart one by one by Decompile when their jumps cross each other.
+// Most shaders however only have jumps nesting within each other, which can be enclosed straight
+// away when going from the innermost jump outwards. Enclosing a jump collapses its body into a
+// single node, so every node is walked a bounded number of times instead of once per jump around
+// it, and no flag variables are needed. Jumps whose goto and label no longer share a parent by the
+// time they are reached are left to Decompile.
+void ASTManager::EncloseNestedGotos() {
+    struct Jump {
+        std::list<ASTNode>::iterator goto_it;
+        ASTNode label;
+        u32 body_start;
+        u32 body_end;
+        bool is_loop;
+    };
+
+    // The program is still flat, number its nodes in order
+    std::vector<u32> label_positions(labels.size());
+    std::vector<u32> goto_positions;
+    goto_positions.reserve(gotos.size());
+    u32 position = 0;
+    for (ASTNode current = program->nodes.GetFirst(); current; current = current->GetNext()) {
+        if (const auto label_index = current->GetLabelIndex()) {
+            label_positions[*label_index] = position;
+        } else if (current->GetGotoLabel()) {
+            goto_positions.push_back(position);
+        }
+        ++position;
+    }
+    if (goto_positions.size() != gotos.size()) {
+        return;
+    }
+
+    std::vector<Jump> jumps;
+    jumps.reserve(gotos.size());
+    auto goto_position = goto_positions.begin();
+    for (auto it = gotos.begin(); it != gotos.end(); ++it, ++goto_position) {
+        const ASTNode label = labels[*(*it)->GetGotoLabel()];
+        if (!label) {
+            continue;
+        }
+        const u32 label_position = label_positions[*(*it)->GetGotoLabel()];
+        if (label_position > *goto_position) {
+            jumps.push_back({it, label, *goto_position, label_position - 1, false});
+        } else {
+            jumps.push_back({it, label, label_position + 1, *goto_position, true});
+        }
+    }
+
+    // A jump nested within another one ends first, or at the same node but starts later
+    std::sort(jumps.begin(), jumps.end(), [](const Jump& lhs, const Jump& rhs) {
+        if (lhs.body_end != rhs.body_end) {
+            return lhs.body_end < rhs.body_end;
+        }
+        return lhs.body_start > rhs.body_start;
+    });
+
+    for (const Jump& jump : jumps) {
+        const ASTNode goto_node = *jump.goto_it;
+        if (!full_decompile && !jump.is_loop) {
+            // We only decompile backward jumps
+            continue;
+        }
+        if (goto_node->GetParent() != jump.label->GetParent()) {
+            continue;
+        }
+        if (jump.is_loop) {
+            EncloseDoWhile(goto_node, jump.label);
+        } else {
+            EncloseIfThen(goto_node, jump.label);
+        }
+        gotos.erase(jump.goto_it);
+    }
+}
+
 bool ASTManager::IsBackwardsJump(ASTNode goto_node, ASTNode label_node) const {
     u32 goto_level = goto_node->GetLevel();
     u32 label_level = label_node->GetLevel();
@@ -355,6 +355,10 @@ public:
         return variables;
     }
 
+    void SetVariables(u32 num_variables) {
+        variables = num_variables;
+    }
+
     const std::vector<ASTNode>& GetLabels() const {
         return labels;
     }
@@ -366,6 +370,8 @@ private:
 
     bool DirectlyRelated(ASTNode first, ASTNode second);
 
+    void EncloseNestedGotos();
+
     void EncloseDoWhile(ASTNode goto_node, ASTNode label);
 
     void EncloseIfThen(ASTNode goto_node, ASTNode label);
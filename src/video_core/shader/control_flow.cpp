@@ -11,11 +11,16 @@
 
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/microprofile.h"
 #include "video_core/shader/ast.h"
 #include "video_core/shader/control_flow.h"
 #include "video_core/shader/shader_ir.h"
 
 namespace VideoCommon::Shader {
+
+MICROPROFILE_DEFINE(Shader_ScanFlow, "GPU", "Shader Flow Scan", MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(Shader_ASTDecompile, "GPU", "Shader AST Decompile", MP_RGB(128, 128, 192));
+
 namespace {
 using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
@@ -456,6 +461,7 @@ void InsertBranch(ASTManager& mm, const BlockBranchInfo& branch) {
 }
 
 void DecompileShader(CFGRebuildState& state) {
+    MICROPROFILE_SCOPE(Shader_ASTDecompile);
     state.manager->Init();
     for (auto label : state.labels) {
         state.manager->DeclareLabel(label);
@@ -476,6 +482,7 @@ void DecompileShader(CFGRebuildState& state) {
 std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code, u32 program_size,
                                                 u32 start_address,
                                                 const CompilerSettings& settings) {
+    MICROPROFILE_SCOPE(Shader_ScanFlow);
     auto result_out = std::make_unique<ShaderCharacteristics>();
     if (settings.depth == CompileDepth::BruteForce) {
         result_out->settings.depth = CompileDepth::BruteForce;
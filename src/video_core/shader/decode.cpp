@@ -9,6 +9,7 @@
 
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/microprofile.h"
 #include "video_core/engines/shader_bytecode.h"
 #include "video_core/engines/shader_header.h"
 #include "video_core/shader/control_flow.h"
@@ -17,6 +18,8 @@
 
 namespace VideoCommon::Shader {
 
+MICROPROFILE_DEFINE(Shader_Decode, "GPU", "Shader Decode", MP_RGB(128, 128, 192));
+
 using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
 
@@ -104,6 +107,8 @@ void ShaderIR::Decode() {
     decompiled = false;
     auto info = ScanFlow(program_code, program_size, main_offset, settings);
     auto& shader_info = *info;
+
+    MICROPROFILE_SCOPE(Shader_Decode);
     coverage_begin = shader_info.start;
     coverage_end = shader_info.end;
     switch (shader_info.settings.depth) {
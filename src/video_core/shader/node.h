@@ -6,7 +6,6 @@
 
 #include <array>
 #include <cstddef>
-#include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -223,7 +222,7 @@ class CommentNode;
 using NodeData =
     std::variant<OperationNode, ConditionalNode, GprNode, ImmediateNode, InternalFlagNode,
                  PredicateNode, AbufNode, CbufNode, LmemNode, SmemNode, GmemNode, CommentNode>;
-using Node = std::shared_ptr<NodeData>;
+using Node = NodeData*; ///< Owned by the NodePool of the shader
 using Node4 = std::array<Node, 4>;
 using NodeBlock = std::vector<Node>;
 
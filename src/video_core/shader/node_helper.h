@@ -4,7 +4,6 @@
 
 #pragma once
 
-#include <memory>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -13,6 +12,7 @@
 
 #include "common/common_types.h"
 #include "video_core/shader/node.h"
+#include "video_core/shader/node_pool.h"
 
 namespace VideoCommon::Shader {
 
@@ -42,7 +42,7 @@ OperationCode SignedToUnsignedCode(OperationCode operation_code, bool is_signed)
 template <typename T, typename... Args>
 Node MakeNode(Args&&... args) {
     static_assert(std::is_convertible_v<T, NodeData>);
-    return std::make_shared<NodeData>(T(std::forward<Args>(args)...));
+    return NodePool::Current().Allocate(T(std::forward<Args>(args)...));
 }
 
 template <typename... Args>
@@ -0,0 +1,39 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "video_core/shader/node_pool.h"
+
+namespace VideoCommon::Shader {
+
+namespace {
+/// Shaders can be built on several threads at once, each one has its own active pool.
+thread_local NodePool* current_pool = nullptr;
+} // Anonymous namespace
+
+NodePool::Scope::Scope(NodePool& pool) : previous{current_pool} {
+    current_pool = &pool;
+}
+
+NodePool::Scope::~Scope() {
+    current_pool = previous;
+}
+
+NodePool::NodePool() = default;
+
+NodePool::~NodePool() {
+    for (std::size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+        const std::size_t count = chunk + 1 == chunks.size() ? chunk_used : NodesPerChunk;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::launder(reinterpret_cast<NodeData*>(&chunks[chunk][i]))->~NodeData();
+        }
+    }
+}
+
+NodePool& NodePool::Current() {
+    ASSERT_MSG(current_pool != nullptr, "Shader nodes created without a node pool");
+    return *current_pool;
+}
+
+} // namespace VideoCommon::Shader
@@ -0,0 +1,71 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "video_core/shader/node.h"
+
+namespace VideoCommon::Shader {
+
+/**
+ * Owns the nodes of a shader. Nodes are constructed in chunks of storage and all of them are
+ * destroyed together with the pool, so nodes are plain pointers without reference counting.
+ */
+class NodePool final {
+public:
+    /// Makes the given pool the one nodes are allocated from in this thread while it lives.
+    class Scope final {
+    public:
+        explicit Scope(NodePool& pool);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        NodePool* previous;
+    };
+
+    explicit NodePool();
+    ~NodePool();
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /// Returns the pool of the innermost scope in this thread.
+    static NodePool& Current();
+
+    template <typename T>
+    Node Allocate(T&& data) {
+        if (chunk_used == NodesPerChunk) {
+            chunks.push_back(std::make_unique<Storage[]>(NodesPerChunk));
+            chunk_used = 0;
+        }
+        void* const storage = &chunks.back()[chunk_used];
+        const Node node = new (storage) NodeData(std::forward<T>(data));
+        ++chunk_used;
+        return node;
+    }
+
+    std::size_t GetNumNodes() const {
+        return chunks.empty() ? 0 : (chunks.size() - 1) * NodesPerChunk + chunk_used;
+    }
+
+private:
+    static constexpr std::size_t NodesPerChunk = 512;
+
+    using Storage = std::aligned_storage_t<sizeof(NodeData), alignof(NodeData)>;
+
+    std::vector<std::unique_ptr<Storage[]>> chunks;
+    std::size_t chunk_used = NodesPerChunk; ///< Nodes constructed in the last chunk.
+};
+
+} // namespace VideoCommon::Shader
@@ -0,0 +1,932 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "video_core/shader/ast.h"
+#include "video_core/shader/expr.h"
+#include "video_core/shader/node_helper.h"
+#include "video_core/shader/shader_ir.h"
+
+namespace VideoCommon::Shader {
+
+namespace {
+
+constexpr u32 SerializedMagic = Common::MakeMagic('Y', 'S', 'I', 'R');
+
+// Has to be bumped whenever the nodes, the AST or the format itself change.
+constexpr u32 SerializedVersion = 1;
+
+/// Identifier of a null node.
+constexpr u32 NullNode = std::numeric_limits<u32>::max();
+
+/// Kind of a null expression.
+constexpr u8 NullExpr = std::numeric_limits<u8>::max();
+
+/// Kind of a node, expression or meta in the serialized data, the index of T in its variant.
+template <typename T, typename Variant, std::size_t Index = 0>
+constexpr u8 KindOf() {
+    if constexpr (std::is_same_v<std::variant_alternative_t<Index, Variant>, T>) {
+        return static_cast<u8>(Index);
+    } else {
+        return KindOf<T, Variant, Index + 1>();
+    }
+}
+
+class Writer {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteString(const std::string& string) {
+        Write(static_cast<u32>(string.size()));
+        data.insert(data.end(), string.begin(), string.end());
+    }
+
+    void Append(const Writer& other) {
+        data.insert(data.end(), other.data.begin(), other.data.end());
+    }
+
+    std::vector<u8>& GetData() {
+        return data;
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::vector<u8>& data) : data{data} {}
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (data.size() - position < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& string) {
+        u32 size;
+        if (!Read(size) || data.size() - position < size) {
+            return false;
+        }
+        string.assign(reinterpret_cast<const char*>(data.data() + position), size);
+        position += size;
+        return true;
+    }
+
+    std::size_t GetRemainingSize() const {
+        return data.size() - position;
+    }
+
+    bool IsAtEnd() const {
+        return position == data.size();
+    }
+
+private:
+    const std::vector<u8>& data;
+    std::size_t position = 0;
+};
+
+/// Writes the nodes reachable from the shader in post order, so every node comes after the nodes
+/// it refers to. Nodes referred to from more than one place are written once.
+class NodeWriter {
+public:
+    explicit NodeWriter(const std::set<Sampler>& samplers, const std::map<u64, Image>& images) {
+        u32 index = 0;
+        for (const Sampler& sampler : samplers) {
+            sampler_indices.emplace(&sampler, index++);
+        }
+        for (const auto& [key, image] : images) {
+            image_keys.emplace(&image, key);
+        }
+    }
+
+    u32 GetId(const NodeData* node) {
+        if (!node) {
+            return NullNode;
+        }
+        if (const auto it = ids.find(node); it != ids.end()) {
+            return it->second;
+        }
+        std::visit([this](const auto& data) { WriteNode(data); }, *node);
+        const u32 id = num_nodes++;
+        ids.emplace(node, id);
+        return id;
+    }
+
+    void WriteBlock(Writer& writer, const NodeBlock& block) {
+        WriteIds(writer, GetIds(block));
+    }
+
+    u32 GetNumNodes() const {
+        return num_nodes;
+    }
+
+    const Writer& GetNodes() const {
+        return nodes;
+    }
+
+private:
+    static void WriteIds(Writer& writer, const std::vector<u32>& node_ids) {
+        writer.Write(static_cast<u32>(node_ids.size()));
+        for (const u32 id : node_ids) {
+            writer.Write(id);
+        }
+    }
+
+    std::vector<u32> GetIds(const std::vector<Node>& block) {
+        std::vector<u32> block_ids(block.size());
+        for (std::size_t i = 0; i < block.size(); ++i) {
+            block_ids[i] = GetId(block[i]);
+        }
+        return block_ids;
+    }
+
+    template <typename T>
+    void WriteKind() {
+        nodes.Write(KindOf<T, NodeData>());
+    }
+
+    void WriteNode(const OperationNode& operation) {
+        // Children are written before the node itself, get their ids first
+        std::vector<u32> operands(operation.GetOperandsCount());
+        for (std::size_t i = 0; i < operands.size(); ++i) {
+            operands[i] = GetId(operation[i]);
+        }
+        Writer meta;
+        const Meta& operation_meta = operation.GetMeta();
+        meta.Write(static_cast<u8>(operation_meta.index()));
+        if (const auto arithmetic = std::get_if<MetaArithmetic>(&operation_meta)) {
+            meta.Write(arithmetic->precise);
+        } else if (const auto texture = std::get_if<MetaTexture>(&operation_meta)) {
+            meta.Write(sampler_indices.at(&texture->sampler));
+            meta.Write(GetId(texture->array));
+            meta.Write(GetId(texture->depth_compare));
+            meta.Write(GetId(texture->bias));
+            meta.Write(GetId(texture->lod));
+            meta.Write(GetId(texture->component));
+            WriteIds(meta, GetIds(texture->aoffi));
+            meta.Write(texture->element);
+        } else if (const auto image = std::get_if<MetaImage>(&operation_meta)) {
+            meta.Write(image_keys.at(&image->image));
+            WriteIds(meta, GetIds(image->values));
+            meta.Write(image->element);
+        } else if (const auto stack_class = std::get_if<MetaStackClass>(&operation_meta)) {
+            meta.Write(*stack_class);
+        } else if (const auto half_type = std::get_if<Tegra::Shader::HalfType>(&operation_meta)) {
+            meta.Write(*half_type);
+        }
+
+        WriteKind<OperationNode>();
+        nodes.Write(operation.GetCode());
+        nodes.Append(meta);
+        WriteIds(nodes, operands);
+    }
+
+    void WriteNode(const ConditionalNode& conditional) {
+        const u32 condition = GetId(conditional.GetCondition());
+        const std::vector<u32> code = GetIds(conditional.GetCode());
+        WriteKind<ConditionalNode>();
+        nodes.Write(condition);
+        WriteIds(nodes, code);
+    }
+
+    void WriteNode(const GprNode& gpr) {
+        WriteKind<GprNode>();
+        nodes.Write(gpr.GetIndex());
+    }
+
+    void WriteNode(const ImmediateNode& immediate) {
+        WriteKind<ImmediateNode>();
+        nodes.Write(immediate.GetValue());
+    }
+
+    void WriteNode(const InternalFlagNode& flag) {
+        WriteKind<InternalFlagNode>();
+        nodes.Write(flag.GetFlag());
+    }
+
+    void WriteNode(const PredicateNode& predicate) {
+        WriteKind<PredicateNode>();
+        nodes.Write(predicate.GetIndex());
+        nodes.Write(predicate.IsNegated());
+    }
+
+    void WriteNode(const AbufNode& abuf) {
+        const u32 physical_address = GetId(abuf.GetPhysicalAddress());
+        const u32 buffer = GetId(abuf.GetBuffer());
+        WriteKind<AbufNode>();
+        nodes.Write(physical_address);
+        nodes.Write(buffer);
+        nodes.Write(abuf.GetIndex());
+        nodes.Write(abuf.GetElement());
+    }
+
+    void WriteNode(const CbufNode& cbuf) {
+        const u32 offset = GetId(cbuf.GetOffset());
+        WriteKind<CbufNode>();
+        nodes.Write(cbuf.GetIndex());
+        nodes.Write(offset);
+    }
+
+    void WriteNode(const LmemNode& lmem) {
+        const u32 address = GetId(lmem.GetAddress());
+        WriteKind<LmemNode>();
+        nodes.Write(address);
+    }
+
+    void WriteNode(const SmemNode& smem) {
+        const u32 address = GetId(smem.GetAddress());
+        WriteKind<SmemNode>();
+        nodes.Write(address);
+    }
+
+    void WriteNode(const GmemNode& gmem) {
+        const u32 real_address = GetId(gmem.GetRealAddress());
+        const u32 base_address = GetId(gmem.GetBaseAddress());
+        WriteKind<GmemNode>();
+        nodes.Write(real_address);
+        nodes.Write(base_address);
+        nodes.Write(gmem.GetDescriptor());
+    }
+
+    void WriteNode(const CommentNode& comment) {
+        WriteKind<CommentNode>();
+        nodes.WriteString(comment.GetText());
+    }
+
+    Writer nodes;
+    u32 num_nodes = 0;
+    std::unordered_map<const NodeData*, u32> ids;
+    std::unordered_map<const Sampler*, u32> sampler_indices;
+    std::unordered_map<const Image*, u64> image_keys;
+};
+
+void WriteExpr(Writer& writer, const Expr& expr) {
+    if (!expr) {
+        writer.Write(NullExpr);
+        return;
+    }
+    writer.Write(static_cast<u8>(expr->index()));
+    if (const auto var = std::get_if<ExprVar>(expr.get())) {
+        writer.Write(var->var_index);
+    } else if (const auto cond_code = std::get_if<ExprCondCode>(expr.get())) {
+        writer.Write(cond_code->cc);
+    } else if (const auto predicate = std::get_if<ExprPredicate>(expr.get())) {
+        writer.Write(predicate->predicate);
+    } else if (const auto expr_not = std::get_if<ExprNot>(expr.get())) {
+        WriteExpr(writer, expr_not->operand1);
+    } else if (const auto expr_or = std::get_if<ExprOr>(expr.get())) {
+        WriteExpr(writer, expr_or->operand1);
+        WriteExpr(writer, expr_or->operand2);
+    } else if (const auto expr_and = std::get_if<ExprAnd>(expr.get())) {
+        WriteExpr(writer, expr_and->operand1);
+        WriteExpr(writer, expr_and->operand2);
+    } else if (const auto boolean = std::get_if<ExprBoolean>(expr.get())) {
+        writer.Write(boolean->value);
+    }
+}
+
+bool ReadExpr(Reader& reader, Expr& expr) {
+    u8 kind;
+    if (!reader.Read(kind)) {
+        return false;
+    }
+    if (kind == NullExpr) {
+        expr = nullptr;
+        return true;
+    }
+    switch (kind) {
+    case KindOf<ExprVar, ExprData>(): {
+        u32 var_index;
+        if (!reader.Read(var_index)) {
+            return false;
+        }
+        expr = MakeExpr<ExprVar>(var_index);
+        return true;
+    }
+    case KindOf<ExprCondCode, ExprData>(): {
+        ConditionCode cc;
+        if (!reader.Read(cc)) {
+            return false;
+        }
+        expr = MakeExpr<ExprCondCode>(cc);
+        return true;
+    }
+    case KindOf<ExprPredicate, ExprData>(): {
+        u32 predicate;
+        if (!reader.Read(predicate)) {
+            return false;
+        }
+        expr = MakeExpr<ExprPredicate>(predicate);
+        return true;
+    }
+    case KindOf<ExprNot, ExprData>(): {
+        Expr operand;
+        if (!ReadExpr(reader, operand)) {
+            return false;
+        }
+        expr = MakeExpr<ExprNot>(std::move(operand));
+        return true;
+    }
+    case KindOf<ExprOr, ExprData>(): {
+        Expr operand1;
+        Expr operand2;
+        if (!ReadExpr(reader, operand1) || !ReadExpr(reader, operand2)) {
+            return false;
+        }
+        expr = MakeExpr<ExprOr>(std::move(operand1), std::move(operand2));
+        return true;
+    }
+    case KindOf<ExprAnd, ExprData>(): {
+        Expr operand1;
+        Expr operand2;
+        if (!ReadExpr(reader, operand1) || !ReadExpr(reader, operand2)) {
+            return false;
+        }
+        expr = MakeExpr<ExprAnd>(std::move(operand1), std::move(operand2));
+        return true;
+    }
+    case KindOf<ExprBoolean, ExprData>(): {
+        bool value;
+        if (!reader.Read(value)) {
+            return false;
+        }
+        expr = MakeExpr<ExprBoolean>(value);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+} // Anonymous namespace
+
+std::vector<u8> ShaderIR::Serialize() const {
+    Writer writer;
+    writer.Write(SerializedMagic);
+    writer.Write(SerializedVersion);
+    writer.Write(main_offset);
+    writer.Write(static_cast<u64>(program_size));
+    writer.Write(settings.depth);
+    writer.Write(settings.disable_else_derivation);
+    writer.Write(decompiled);
+    writer.Write(disable_flow_stack);
+    writer.Write(coverage_begin);
+    writer.Write(coverage_end);
+    writer.Write(header);
+
+    writer.Write(static_cast<u32>(used_registers.size()));
+    for (const u32 reg : used_registers) {
+        writer.Write(reg);
+    }
+    writer.Write(static_cast<u32>(used_predicates.size()));
+    for (const auto pred : used_predicates) {
+        writer.Write(pred);
+    }
+    for (const auto* attributes : {&used_input_attributes, &used_output_attributes}) {
+        writer.Write(static_cast<u32>(attributes->size()));
+        for (const auto attribute : *attributes) {
+            writer.Write(attribute);
+        }
+    }
+    writer.Write(static_cast<u32>(used_cbufs.size()));
+    for (const auto& [index, cbuf] : used_cbufs) {
+        writer.Write(index);
+        writer.Write(cbuf.GetMaxOffset());
+        writer.Write(cbuf.IsIndirect());
+    }
+    writer.Write(static_cast<u32>(used_samplers.size()));
+    for (const Sampler& sampler : used_samplers) {
+        writer.Write(static_cast<u64>(sampler.GetOffset()));
+        writer.Write(static_cast<u64>(sampler.GetIndex()));
+        writer.Write(sampler.GetType());
+        writer.Write(sampler.IsArray());
+        writer.Write(sampler.IsShadow());
+        writer.Write(sampler.IsBindless());
+    }
+    writer.Write(static_cast<u32>(used_images.size()));
+    for (const auto& [key, image] : used_images) {
+        writer.Write(key);
+        writer.Write(static_cast<u64>(image.GetOffset()));
+        writer.Write(static_cast<u64>(image.GetIndex()));
+        writer.Write(image.GetType());
+        writer.Write(image.IsBindless());
+        writer.Write(image.IsWritten());
+        writer.Write(image.IsRead());
+        writer.Write(image.IsAtomic());
+    }
+    writer.Write(used_clip_distances);
+    writer.Write(static_cast<u32>(used_global_memory.size()));
+    for (const auto& [base, usage] : used_global_memory) {
+        writer.Write(base);
+        writer.Write(usage);
+    }
+    writer.Write(uses_layer);
+    writer.Write(uses_viewport_index);
+    writer.Write(uses_point_size);
+    writer.Write(uses_physical_attributes);
+    writer.Write(uses_instance_id);
+    writer.Write(uses_vertex_id);
+
+    // Nodes are gathered while the code referring to them is written, and go before it
+    NodeWriter node_writer{used_samplers, used_images};
+    Writer code;
+    code.Write(static_cast<u32>(basic_blocks.size()));
+    for (const auto& [address, block] : basic_blocks) {
+        code.Write(address);
+        node_writer.WriteBlock(code, block);
+    }
+
+    const auto write_ast = [&](const auto& self, const ASTNode& parent) -> bool {
+        u32 num_children = 0;
+        for (ASTNode child = parent->GetSubNodes()->GetFirst(); child; child = child->GetNext()) {
+            ++num_children;
+        }
+        code.Write(num_children);
+        for (ASTNode child = parent->GetSubNodes()->GetFirst(); child; child = child->GetNext()) {
+            ASTData& data = *child->GetInnerData();
+            code.Write(static_cast<u8>(data.index()));
+            if (const auto if_then = std::get_if<ASTIfThen>(&data)) {
+                WriteExpr(code, if_then->condition);
+            } else if (const auto block = std::get_if<ASTBlockDecoded>(&data)) {
+                node_writer.WriteBlock(code, block->nodes);
+                continue;
+            } else if (const auto var_set = std::get_if<ASTVarSet>(&data)) {
+                code.Write(var_set->index);
+                WriteExpr(code, var_set->condition);
+                continue;
+            } else if (const auto do_while = std::get_if<ASTDoWhile>(&data)) {
+                WriteExpr(code, do_while->condition);
+            } else if (const auto ast_return = std::get_if<ASTReturn>(&data)) {
+                WriteExpr(code, ast_return->condition);
+                code.Write(ast_return->kills);
+                continue;
+            } else if (const auto ast_break = std::get_if<ASTBreak>(&data)) {
+                WriteExpr(code, ast_break->condition);
+                continue;
+            } else if (!std::holds_alternative<ASTIfElse>(data)) {
+                // Labels, gotos and encoded blocks only exist while decompiling
+                return false;
+            }
+            if (!self(self, child)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (decompiled) {
+        code.Write(program_manager.GetVariables());
+        if (!write_ast(write_ast, program_manager.GetProgram())) {
+            return {};
+        }
+    }
+
+    writer.Write(node_writer.GetNumNodes());
+    writer.Append(node_writer.GetNodes());
+    writer.Append(code);
+    return std::move(writer.GetData());
+}
+
+std::unique_ptr<ShaderIR> ShaderIR::Deserialize(const ProgramCode& program_code, u32 main_offset,
+                                                std::size_t size, CompilerSettings settings,
+                                                const std::vector<u8>& data) {
+    std::unique_ptr<ShaderIR> shader{
+        new ShaderIR(program_code, main_offset, size, settings, SkipDecode{})};
+    if (!shader->LoadSerialized(data)) {
+        return nullptr;
+    }
+    return shader;
+}
+
+bool ShaderIR::LoadSerialized(const std::vector<u8>& data) {
+    Reader reader{data};
+    u32 magic;
+    u32 version;
+    u32 serialized_main_offset;
+    u64 serialized_size;
+    CompilerSettings serialized_settings;
+    if (!reader.Read(magic) || !reader.Read(version) || magic != SerializedMagic ||
+        version != SerializedVersion || !reader.Read(serialized_main_offset) ||
+        !reader.Read(serialized_size) || !reader.Read(serialized_settings.depth) ||
+        !reader.Read(serialized_settings.disable_else_derivation)) {
+        return false;
+    }
+    if (serialized_main_offset != main_offset || serialized_size != program_size ||
+        serialized_settings.depth != settings.depth ||
+        serialized_settings.disable_else_derivation != settings.disable_else_derivation) {
+        return false;
+    }
+    if (!reader.Read(decompiled) || !reader.Read(disable_flow_stack) ||
+        !reader.Read(coverage_begin) || !reader.Read(coverage_end) || !reader.Read(header)) {
+        return false;
+    }
+
+    u32 count;
+    if (!reader.Read(count)) {
+        return false;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        u32 reg;
+        if (!reader.Read(reg)) {
+            return false;
+        }
+        used_registers.insert(reg);
+    }
+    if (!reader.Read(count)) {
+        return false;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        Tegra::Shader::Pred pred;
+        if (!reader.Read(pred)) {
+            return false;
+        }
+        used_predicates.insert(pred);
+    }
+    for (auto* attributes : {&used_input_attributes, &used_output_attributes}) {
+        if (!reader.Read(count)) {
+            return false;
+        }
+        for (u32 i = 0; i < count; ++i) {
+            Tegra::Shader::Attribute::Index attribute;
+            if (!reader.Read(attribute)) {
+                return false;
+            }
+            attributes->insert(attribute);
+        }
+    }
+    if (!reader.Read(count)) {
+        return false;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        u32 index;
+        u32 max_offset;
+        bool is_indirect;
+        if (!reader.Read(index) || !reader.Read(max_offset) || !reader.Read(is_indirect)) {
+            return false;
+        }
+        used_cbufs.emplace(index, ConstBuffer{max_offset, is_indirect});
+    }
+
+    // Texture operations refer to the samplers in the order they are stored
+    std::vector<const Sampler*> samplers;
+    if (!reader.Read(count)) {
+        return false;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        u64 offset;
+        u64 index;
+        Tegra::Shader::TextureType type;
+        bool is_array;
+        bool is_shadow;
+        bool is_bindless;
+        if (!reader.Read(offset) || !reader.Read(index) || !reader.Read(type) ||
+            !reader.Read(is_array) || !reader.Read(is_shadow) || !reader.Read(is_bindless)) {
+            return false;
+        }
+        const auto [it, is_new] = used_samplers.emplace(static_cast<std::size_t>(offset),
+                                                        static_cast<std::size_t>(index), type,
+                                                        is_array, is_shadow, is_bindless);
+        samplers.push_back(&*it);
+    }
+    if (!reader.Read(count)) {
+        return false;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        u64 key;
+        u64 offset;
+        u64 index;
+        Tegra::Shader::ImageType type;
+        bool is_bindless;
+        bool is_written;
+        bool is_read;
+        bool is_atomic;
+        if (!reader.Read(key) || !reader.Read(offset) || !reader.Read(index) ||
+            !reader.Read(type) || !reader.Read(is_bindless) || !reader.Read(is_written) ||
+            !reader.Read(is_read) || !reader.Read(is_atomic)) {
+            return false;
+        }
+        used_images.emplace(key, Image{static_cast<std::size_t>(offset),
+                                       static_cast<std::size_t>(index), type, is_bindless,
+                                       is_written, is_read, is_atomic});
+    }
+    if (!reader.Read(used_clip_distances) || !reader.Read(count)) {
+        return false;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        GlobalMemoryBase base;
+        GlobalMemoryUsage usage;
+        if (!reader.Read(base) || !reader.Read(usage)) {
+            return false;
+        }
+        used_global_memory.emplace(base, usage);
+    }
+    if (!reader.Read(uses_layer) || !reader.Read(uses_viewport_index) ||
+        !reader.Read(uses_point_size) || !reader.Read(uses_physical_attributes) ||
+        !reader.Read(uses_instance_id) || !reader.Read(uses_vertex_id)) {
+        return false;
+    }
+
+    NodePool::Scope scope{node_pool};
+    std::vector<Node> nodes;
+    bool is_valid = true;
+    const auto read_node = [&]() -> Node {
+        u32 id;
+        if (!reader.Read(id) || (id != NullNode && id >= nodes.size())) {
+            is_valid = false;
+            return nullptr;
+        }
+        return id == NullNode ? nullptr : nodes[id];
+    };
+    const auto read_block = [&]() -> NodeBlock {
+        u32 size;
+        if (!reader.Read(size) || size > reader.GetRemainingSize() / sizeof(u32)) {
+            is_valid = false;
+            return {};
+        }
+        NodeBlock block(size);
+        for (Node& node : block) {
+            node = read_node();
+        }
+        return block;
+    };
+
+    u32 num_nodes;
+    if (!reader.Read(num_nodes)) {
+        return false;
+    }
+    nodes.reserve(num_nodes);
+    for (u32 i = 0; i < num_nodes && is_valid; ++i) {
+        u8 kind;
+        if (!reader.Read(kind)) {
+            return false;
+        }
+        Node node{};
+        switch (kind) {
+        case KindOf<OperationNode, NodeData>(): {
+            OperationCode code;
+            u8 meta_kind;
+            if (!reader.Read(code) || !reader.Read(meta_kind)) {
+                return false;
+            }
+            std::optional<Meta> meta;
+            switch (meta_kind) {
+            case KindOf<MetaArithmetic, Meta>(): {
+                MetaArithmetic arithmetic;
+                is_valid &= reader.Read(arithmetic.precise);
+                meta.emplace(arithmetic);
+                break;
+            }
+            case KindOf<MetaTexture, Meta>(): {
+                u32 sampler_index;
+                if (!reader.Read(sampler_index) || sampler_index >= samplers.size()) {
+                    return false;
+                }
+                Node array = read_node();
+                Node depth_compare = read_node();
+                Node bias = read_node();
+                Node lod = read_node();
+                Node component = read_node();
+                std::vector<Node> aoffi = read_block();
+                u32 element{};
+                is_valid &= reader.Read(element);
+                meta.emplace(MetaTexture{*samplers[sampler_index], array, depth_compare,
+                                         std::move(aoffi), bias, lod, component, element});
+                break;
+            }
+            case KindOf<MetaImage, Meta>(): {
+                u64 key;
+                if (!reader.Read(key)) {
+                    return false;
+                }
+                const auto image = used_images.find(key);
+                if (image == used_images.end()) {
+                    return false;
+                }
+                std::vector<Node> values = read_block();
+                u32 element{};
+                is_valid &= reader.Read(element);
+                meta.emplace(MetaImage{image->second, std::move(values), element});
+                break;
+            }
+            case KindOf<MetaStackClass, Meta>(): {
+                MetaStackClass stack_class{};
+                is_valid &= reader.Read(stack_class);
+                meta.emplace(stack_class);
+                break;
+            }
+            case KindOf<Tegra::Shader::HalfType, Meta>(): {
+                Tegra::Shader::HalfType half_type{};
+                is_valid &= reader.Read(half_type);
+                meta.emplace(half_type);
+                break;
+            }
+            default:
+                return false;
+            }
+            NodeBlock operands = read_block();
+            node = MakeNode<OperationNode>(code, std::move(*meta), std::move(operands));
+            break;
+        }
+        case KindOf<ConditionalNode, NodeData>(): {
+            Node condition = read_node();
+            NodeBlock code = read_block();
+            node = MakeNode<ConditionalNode>(condition, std::move(code));
+            break;
+        }
+        case KindOf<GprNode, NodeData>(): {
+            u32 index{};
+            is_valid &= reader.Read(index);
+            node = MakeNode<GprNode>(Tegra::Shader::Register{index});
+            break;
+        }
+        case KindOf<ImmediateNode, NodeData>(): {
+            u32 value{};
+            is_valid &= reader.Read(value);
+            node = MakeNode<ImmediateNode>(value);
+            break;
+        }
+        case KindOf<InternalFlagNode, NodeData>(): {
+            InternalFlag flag{};
+            is_valid &= reader.Read(flag);
+            node = MakeNode<InternalFlagNode>(flag);
+            break;
+        }
+        case KindOf<PredicateNode, NodeData>(): {
+            Tegra::Shader::Pred pred{};
+            bool negated{};
+            is_valid &= reader.Read(pred) && reader.Read(negated);
+            node = MakeNode<PredicateNode>(pred, negated);
+            break;
+        }
+        case KindOf<AbufNode, NodeData>(): {
+            Node physical_address = read_node();
+            Node buffer = read_node();
+            Tegra::Shader::Attribute::Index index{};
+            u32 element{};
+            is_valid &= reader.Read(index) && reader.Read(element);
+            if (physical_address) {
+                node = MakeNode<AbufNode>(physical_address, buffer);
+            } else {
+                node = MakeNode<AbufNode>(index, element, buffer);
+            }
+            break;
+        }
+        case KindOf<CbufNode, NodeData>(): {
+            u32 index{};
+            is_valid &= reader.Read(index);
+            node = MakeNode<CbufNode>(index, read_node());
+            break;
+        }
+        case KindOf<LmemNode, NodeData>():
+            node = MakeNode<LmemNode>(read_node());
+            break;
+        case KindOf<SmemNode, NodeData>():
+            node = MakeNode<SmemNode>(read_node());
+            break;
+        case KindOf<GmemNode, NodeData>(): {
+            Node real_address = read_node();
+            Node base_address = read_node();
+            GlobalMemoryBase descriptor{};
+            is_valid &= reader.Read(descriptor);
+            node = MakeNode<GmemNode>(real_address, base_address, descriptor);
+            break;
+        }
+        case KindOf<CommentNode, NodeData>(): {
+            std::string text;
+            is_valid &= reader.ReadString(text);
+            node = MakeNode<CommentNode>(std::move(text));
+            break;
+        }
+        default:
+            return false;
+        }
+        nodes.push_back(node);
+    }
+
+    if (!reader.Read(count)) {
+        return false;
+    }
+    for (u32 i = 0; i < count && is_valid; ++i) {
+        u32 address;
+        if (!reader.Read(address)) {
+            return false;
+        }
+        basic_blocks.insert_or_assign(address, read_block());
+    }
+    if (!is_valid) {
+        return false;
+    }
+
+    if (decompiled) {
+        const auto read_ast = [&](const auto& self, const ASTNode& parent, u32 depth) -> bool {
+            u32 num_children;
+            if (depth > MAX_PROGRAM_LENGTH || !reader.Read(num_children)) {
+                return false;
+            }
+            for (u32 i = 0; i < num_children; ++i) {
+                u8 kind;
+                if (!reader.Read(kind)) {
+                    return false;
+                }
+                ASTNode node;
+                switch (kind) {
+                case KindOf<ASTIfThen, ASTData>(): {
+                    Expr condition;
+                    if (!ReadExpr(reader, condition)) {
+                        return false;
+                    }
+                    node = ASTBase::Make<ASTIfThen>(parent, std::move(condition));
+                    break;
+                }
+                case KindOf<ASTIfElse, ASTData>():
+                    node = ASTBase::Make<ASTIfElse>(parent);
+                    break;
+                case KindOf<ASTBlockDecoded, ASTData>(): {
+                    NodeBlock block = read_block();
+                    if (!is_valid) {
+                        return false;
+                    }
+                    node = ASTBase::Make<ASTBlockDecoded>(parent, std::move(block));
+                    break;
+                }
+                case KindOf<ASTVarSet, ASTData>(): {
+                    u32 index;
+                    Expr condition;
+                    if (!reader.Read(index) || !ReadExpr(reader, condition)) {
+                        return false;
+                    }
+                    node = ASTBase::Make<ASTVarSet>(parent, index, std::move(condition));
+                    break;
+                }
+                case KindOf<ASTDoWhile, ASTData>(): {
+                    Expr condition;
+                    if (!ReadExpr(reader, condition)) {
+                        return false;
+                    }
+                    node = ASTBase::Make<ASTDoWhile>(parent, std::move(condition));
+                    break;
+                }
+                case KindOf<ASTReturn, ASTData>(): {
+                    Expr condition;
+                    bool kills;
+                    if (!ReadExpr(reader, condition) || !reader.Read(kills)) {
+                        return false;
+                    }
+                    node = ASTBase::Make<ASTReturn>(parent, std::move(condition), kills);
+                    break;
+                }
+                case KindOf<ASTBreak, ASTData>(): {
+                    Expr condition;
+                    if (!ReadExpr(reader, condition)) {
+                        return false;
+                    }
+                    node = ASTBase::Make<ASTBreak>(parent, std::move(condition));
+                    break;
+                }
+                default:
+                    return false;
+                }
+                parent->GetSubNodes()->PushBack(node);
+                if (node->GetSubNodes() && !self(self, node, depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        u32 num_variables;
+        if (!reader.Read(num_variables)) {
+            return false;
+        }
+        program_manager.Init();
+        program_manager.SetVariables(num_variables);
+        if (!read_ast(read_ast, program_manager.GetProgram(), 0)) {
+            return false;
+        }
+    }
+    return reader.IsAtEnd();
+}
+
+} // namespace VideoCommon::Shader
@@ -26,9 +26,15 @@ ShaderIR::ShaderIR(const ProgramCode& program_code, u32 main_offset, const std::
                    CompilerSettings settings)
     : program_code{program_code}, main_offset{main_offset}, program_size{size}, basic_blocks{},
       program_manager{true, true}, settings{settings} {
+    NodePool::Scope scope{node_pool};
     Decode();
 }
 
+ShaderIR::ShaderIR(const ProgramCode& program_code, u32 main_offset, std::size_t size,
+                   CompilerSettings settings, SkipDecode)
+    : program_code{program_code}, main_offset{main_offset}, program_size{size},
+      program_manager{true, true}, settings{settings} {}
+
 ShaderIR::~ShaderIR() = default;
 
 Node ShaderIR::GetRegister(Register reg) {
@@ -370,6 +376,7 @@ OperationCode ShaderIR::GetPredicateCombiner(PredOperation operation) {
 }
 
 Node ShaderIR::GetConditionCode(Tegra::Shader::ConditionCode cc) const {
+    NodePool::Scope scope{node_pool};
     switch (cc) {
     case Tegra::Shader::ConditionCode::NEU:
         return GetInternalFlag(InternalFlag::Zero, true);
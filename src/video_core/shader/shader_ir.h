@@ -6,6 +6,7 @@
 
 #include <array>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
 #include <tuple>
@@ -18,6 +19,7 @@
 #include "video_core/shader/ast.h"
 #include "video_core/shader/compiler_settings.h"
 #include "video_core/shader/node.h"
+#include "video_core/shader/node_pool.h"
 
 namespace VideoCommon::Shader {
 
@@ -70,6 +72,19 @@ public:
                       CompilerSettings settings);
     ~ShaderIR();
 
+    /**
+     * Serializes the decoded and analyzed shader, so it can be loaded with Deserialize instead of
+     * being decoded again. The format is the same for every backend. Returns an empty vector when
+     * the shader can't be serialized.
+     */
+    std::vector<u8> Serialize() const;
+
+    /// Loads a shader serialized from a ShaderIR built with the same parameters. Returns null when
+    /// the data is corrupted, from another version of the format or built with other parameters.
+    static std::unique_ptr<ShaderIR> Deserialize(const ProgramCode& program_code, u32 main_offset,
+                                                 std::size_t size, CompilerSettings settings,
+                                                 const std::vector<u8>& data);
+
     const std::map<u32, NodeBlock>& GetBasicBlocks() const {
         return basic_blocks;
     }
@@ -172,6 +187,14 @@ public:
 
 private:
     friend class ASTDecoder;
+
+    struct SkipDecode {};
+
+    explicit ShaderIR(const ProgramCode& program_code, u32 main_offset, std::size_t size,
+                      CompilerSettings settings, SkipDecode);
+
+    bool LoadSerialized(const std::vector<u8>& data);
+
     void Decode();
 
     NodeBlock DecodeRange(u32 begin, u32 end);
@@ -371,6 +394,9 @@ private:
     std::pair<Node, s64> TrackRegister(const GprNode* tracked, const NodeBlock& code,
                                        s64 cursor) const;
 
+    /// Brings global_assignments up to date with the nodes appended to global_code.
+    void IndexGlobalAssignments() const;
+
     std::tuple<Node, Node, GlobalMemoryBase> TrackAndGetGlobalMemory(
         NodeBlock& bb, Tegra::Shader::Instruction instr, bool is_write);
 
@@ -383,8 +409,20 @@ private:
     u32 coverage_begin{};
     u32 coverage_end{};
 
+    /// Owns every node of the shader, GetConditionCode can add nodes after decoding.
+    mutable NodePool node_pool;
+
     std::map<u32, NodeBlock> basic_blocks;
     NodeBlock global_code;
+
+    /// Register assignments of global_code, so tracking a register is a lookup instead of a walk
+    /// back through the whole shader. global_code only grows, the index catches up on queries.
+    struct AssignmentIndex {
+        std::size_t indexed_size{};
+        /// Cursor and assigned value of every assignment, in code order, by register index
+        std::array<std::vector<std::pair<s64, Node>>, 256> by_register;
+    };
+    mutable AssignmentIndex global_assignments;
     ASTManager program_manager;
     CompilerSettings settings{};
 
@@ -3,14 +3,18 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <iterator>
 #include <utility>
 #include <variant>
 
 #include "common/common_types.h"
+#include "common/microprofile.h"
 #include "video_core/shader/shader_ir.h"
 
 namespace VideoCommon::Shader {
 
+MICROPROFILE_DEFINE(Shader_TrackRegister, "GPU", "Shader Track Register", MP_RGB(128, 128, 192));
+
 namespace {
 std::pair<Node, s64> FindOperation(const NodeBlock& code, s64 cursor,
                                    OperationCode operation_code) {
@@ -34,6 +38,20 @@ std::pair<Node, s64> FindOperation(const NodeBlock& code, s64 cursor,
     }
     return {};
 }
+
+/// Returns the assignment FindOperation stops at when it reaches the node, if any.
+Node FindAssignmentAt(Node node) {
+    if (const auto operation = std::get_if<OperationNode>(&*node)) {
+        return operation->GetCode() == OperationCode::Assign ? node : nullptr;
+    }
+    if (const auto conditional = std::get_if<ConditionalNode>(&*node)) {
+        const auto& conditional_code = conditional->GetCode();
+        return FindOperation(conditional_code, static_cast<s64>(conditional_code.size() - 1),
+                             OperationCode::Assign)
+            .first;
+    }
+    return nullptr;
+}
 } // Anonymous namespace
 
 std::tuple<Node, u32, u32> ShaderIR::TrackCbuf(Node tracked, const NodeBlock& code,
@@ -90,6 +108,21 @@ std::optional<u32> ShaderIR::TrackImmediate(Node tracked, const NodeBlock& code,
 
 std::pair<Node, s64> ShaderIR::TrackRegister(const GprNode* tracked, const NodeBlock& code,
                                              s64 cursor) const {
+    MICROPROFILE_SCOPE(Shader_TrackRegister);
+
+    if (&code == &global_code) {
+        IndexGlobalAssignments();
+        const auto& assignments = global_assignments.by_register[tracked->GetIndex()];
+        const auto it = std::upper_bound(
+            assignments.begin(), assignments.end(), cursor,
+            [](s64 cursor, const auto& assignment) { return cursor < assignment.first; });
+        if (it == assignments.begin()) {
+            return {};
+        }
+        const auto& [found_cursor, value] = *std::prev(it);
+        return {value, found_cursor};
+    }
+
     for (; cursor >= 0; --cursor) {
         const auto [found_node, new_cursor] = FindOperation(code, cursor, OperationCode::Assign);
         if (!found_node) {
@@ -104,8 +137,25 @@ std::pair<Node, s64> ShaderIR::TrackRegister(const GprNode* tracked, const NodeB
                 return {(*operation)[1], new_cursor};
             }
         }
+        // Resume before the assignment that was found, instead of finding it again
+        cursor = new_cursor;
     }
     return {};
 }
 
+void ShaderIR::IndexGlobalAssignments() const {
+    auto& index = global_assignments;
+    for (; index.indexed_size < global_code.size(); ++index.indexed_size) {
+        const Node assignment = FindAssignmentAt(global_code[index.indexed_size]);
+        if (!assignment) {
+            continue;
+        }
+        const auto& operation = std::get<OperationNode>(*assignment);
+        if (const auto gpr_target = std::get_if<GprNode>(&*operation[0])) {
+            index.by_register[gpr_target->GetIndex()].emplace_back(
+                static_cast<s64>(index.indexed_size), operation[1]);
+        }
+    }
+}
+
 } // namespace VideoCommon::Shader
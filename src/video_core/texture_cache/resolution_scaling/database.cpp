@@ -2,7 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <cstring>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <fmt/format.h>
 #include <json.hpp>
@@ -11,103 +12,158 @@
 #include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
-#include "core/core.h"
-#include "core/hle/kernel/process.h"
+#include "common/logging/log.h"
 #include "video_core/texture_cache/resolution_scaling/database.h"
 
 namespace VideoCommon::Resolution {
 
 using namespace nlohmann;
 
-std::string GetBaseDir() {
-    return FileUtil::GetUserPath(FileUtil::UserPath::RescalingDir);
-}
+ScalingDatabase::ScalingDatabase()
+    : ScalingDatabase{FileUtil::GetUserPath(FileUtil::UserPath::RescalingDir)} {}
 
-ScalingDatabase::ScalingDatabase(Core::System& system) : system{system} {}
+ScalingDatabase::ScalingDatabase(std::string base_dir) : base_dir{std::move(base_dir)} {}
 
 ScalingDatabase::~ScalingDatabase() {
     SaveDatabase();
 }
 
-void ScalingDatabase::Init() {
-    title_id = system.CurrentProcess()->GetTitleID();
-    LoadDatabase();
+void ScalingDatabase::Init(u64 title_id_) {
+    title_id = title_id_;
     initialized = true;
+    pending_load = std::async(std::launch::async, LoadRecords, GetProfilePath(),
+                              GetLegacyProfilePath());
 }
 
-void ScalingDatabase::LoadDatabase() {
-    const std::string path = GetProfilePath();
-    const bool exists = FileUtil::Exists(path);
-    if (!exists) {
-        return;
+void ScalingDatabase::TickFrame() {
+    ++frame;
+    if (pending_load.valid() &&
+        pending_load.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+        MergeRecords(pending_load.get());
+    }
+}
+
+void ScalingDatabase::WaitForLoad() {
+    if (pending_load.valid()) {
+        MergeRecords(pending_load.get());
     }
+}
+
+std::vector<ScalingDatabase::Record> ScalingDatabase::LoadRecords(
+    const std::string& path, const std::string& legacy_path) {
+    std::vector<Record> records;
+    if (FileUtil::Exists(path)) {
+        FileUtil::IOFile file(path, "rb");
+        u32 magic{};
+        u32 version{};
+        u32 count{};
+        if (!file.IsOpen() || file.ReadBytes(&magic, sizeof(magic)) != sizeof(magic) ||
+            file.ReadBytes(&version, sizeof(version)) != sizeof(version) ||
+            file.ReadBytes(&count, sizeof(count)) != sizeof(count) || magic != DBMagic ||
+            version != DBVersion) {
+            LOG_WARNING(HW_GPU, "Resolution scaling database {} is invalid, ignoring it", path);
+            return records;
+        }
+        records.resize(count);
+        if (file.ReadArray(records.data(), records.size()) != records.size()) {
+            LOG_WARNING(HW_GPU, "Resolution scaling database {} is truncated, ignoring it", path);
+            records.clear();
+        }
+        return records;
+    }
+    if (!FileUtil::Exists(legacy_path)) {
+        return records;
+    }
+
+    // Databases of older versions were written by the scanner, their entries are trusted
     std::ifstream file;
-    OpenFStream(file, path, std::ios_base::in);
+    OpenFStream(file, legacy_path, std::ios_base::in);
     json in;
     file >> in;
-    u32 version = in["version"].get<u32>();
-    if (version != DBVersion) {
-        return;
+    if (in["version"].get<u32>() != 1) {
+        return records;
     }
-    for (const auto& entry : in["entries"]) {
-        ResolutionKey key{};
-        key.format = static_cast<PixelFormat>(entry["format"].get<u32>());
-        key.width = entry["width"].get<u32>();
-        key.height = entry["height"].get<u32>();
-        database.insert(key);
-    }
-    for (const auto& entry : in["blacklist"]) {
-        ResolutionKey key{};
-        key.format = static_cast<PixelFormat>(entry["format"].get<u32>());
-        key.width = entry["width"].get<u32>();
-        key.height = entry["height"].get<u32>();
-        blacklist.insert(key);
+    const auto add_entries = [&records](const json& entries, bool is_blacklisted) {
+        for (const auto& entry : entries) {
+            Record record{};
+            record.format = entry["format"].get<u32>();
+            record.width = entry["width"].get<u32>();
+            record.height = entry["height"].get<u32>();
+            record.confidence = is_blacklisted ? 0 : ConfidenceThreshold;
+            record.is_blacklisted = is_blacklisted ? 1 : 0;
+            records.push_back(record);
+        }
+    };
+    add_entries(in["entries"], false);
+    add_entries(in["blacklist"], true);
+    return records;
+}
+
+void ScalingDatabase::MergeRecords(const std::vector<Record>& records) {
+    for (const Record& record : records) {
+        if (record.format >= static_cast<u32>(PixelFormat::Max)) {
+            continue;
+        }
+        Entry& entry =
+            database[{static_cast<PixelFormat>(record.format), record.width, record.height}];
+        entry.confidence =
+            static_cast<u8>(std::min<u32>(u32{entry.confidence} + record.confidence, 0xFF));
+        entry.is_blacklisted = entry.is_blacklisted || record.is_blacklisted != 0;
     }
+    LOG_INFO(HW_GPU, "Loaded {} resolution scaling entries for title id={}", records.size(),
+             GetTitleID());
 }
 
 void ScalingDatabase::SaveDatabase() {
-    const std::string dir = GetBaseDir();
-    if (!FileUtil::CreateDir(dir)) {
-        LOG_ERROR(HW_GPU, "Failed to create directory={}", dir);
+    if (!initialized) {
         return;
     }
-    json out;
-    out.emplace("version", DBVersion);
-    auto entries = json::array();
-    for (const auto& key : database) {
-        entries.push_back({
-            {"format", static_cast<u32>(key.format)},
-            {"width", key.width},
-            {"height", key.height},
-        });
+    // What was learned this session is merged with the stored database before writing it
+    WaitForLoad();
+    if (database.empty()) {
+        return;
+    }
+    if (!FileUtil::CreateDir(base_dir)) {
+        LOG_ERROR(HW_GPU, "Failed to create directory={}", base_dir);
+        return;
     }
-    out.emplace("entries", std::move(entries));
-    auto blacklist_entries = json::array();
-    for (const auto& key : blacklist) {
-        blacklist_entries.push_back({
-            {"format", static_cast<u32>(key.format)},
-            {"width", key.width},
-            {"height", key.height},
-        });
+
+    std::vector<Record> records;
+    records.reserve(database.size());
+    for (const auto& [key, entry] : database) {
+        Record record{};
+        record.format = static_cast<u32>(key.format);
+        record.width = key.width;
+        record.height = key.height;
+        record.confidence = entry.confidence;
+        record.is_blacklisted = entry.is_blacklisted ? 1 : 0;
+        records.push_back(record);
     }
-    out.emplace("blacklist", std::move(blacklist_entries));
     const std::string path = GetProfilePath();
-    std::ofstream file;
-    OpenFStream(file, path, std::ios_base::out);
-    file << std::setw(4) << out << std::endl;
+    FileUtil::IOFile file(path, "wb");
+    const auto count = static_cast<u32>(records.size());
+    if (!file.IsOpen() || file.WriteObject(DBMagic) != 1 || file.WriteObject(DBVersion) != 1 ||
+        file.WriteObject(count) != 1 ||
+        file.WriteArray(records.data(), records.size()) != records.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write resolution scaling database {}", path);
+    }
 }
 
 void ScalingDatabase::Register(PixelFormat format, u32 width, u32 height) {
-    const ResolutionKey key{format, width, height};
-    if (blacklist.count(key) == 0) {
-        database.insert(key);
+    Entry& entry = database[{format, width, height}];
+    if (entry.is_blacklisted || entry.last_frame == frame) {
+        return;
+    }
+    entry.last_frame = frame;
+    if (entry.confidence < 0xFF) {
+        ++entry.confidence;
     }
 }
 
 void ScalingDatabase::Unregister(PixelFormat format, u32 width, u32 height) {
-    const ResolutionKey key{format, width, height};
-    database.erase(key);
-    blacklist.insert(key);
+    Entry& entry = database[{format, width, height}];
+    entry.confidence = 0;
+    entry.is_blacklisted = true;
 }
 
 std::string ScalingDatabase::GetTitleID() const {
@@ -115,7 +171,11 @@ std::string ScalingDatabase::GetTitleID() const {
 }
 
 std::string ScalingDatabase::GetProfilePath() const {
-    return FileUtil::SanitizePath(GetBaseDir() + DIR_SEP_CHR + GetTitleID() + ".json");
+    return FileUtil::SanitizePath(base_dir + DIR_SEP_CHR + GetTitleID() + ".bin");
+}
+
+std::string ScalingDatabase::GetLegacyProfilePath() const {
+    return FileUtil::SanitizePath(base_dir + DIR_SEP_CHR + GetTitleID() + ".json");
 }
 
 } // namespace VideoCommon::Resolution
@@ -4,13 +4,16 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <future>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
 #include "video_core/surface.h"
 
-namespace Core {
-class System;
-}
-
 namespace VideoCommon::Resolution {
 
 using VideoCore::Surface::PixelFormat;
@@ -50,23 +53,51 @@ struct hash<VideoCommon::Resolution::ResolutionKey> {
 
 namespace VideoCommon::Resolution {
 
+/**
+ * Learns which surfaces of a title can be rendered at a higher resolution. Surfaces gain
+ * confidence in every frame they're seen as render targets or blit sources, and are blacklisted
+ * for good when they're used in a way that can't be rescaled. Each title has a small binary file
+ * that is read in the background when the title boots.
+ */
 class ScalingDatabase {
 public:
-    explicit ScalingDatabase(Core::System& system);
+    /// Surfaces are rescaled once they've been seen in this many frames.
+    static constexpr u8 ConfidenceThreshold = 8;
+
+    /// Uses the rescaling directory under the user path.
+    explicit ScalingDatabase();
+    explicit ScalingDatabase(std::string base_dir);
     ~ScalingDatabase();
 
+    /// Starts loading the database of a title.
+    void Init(u64 title_id);
+
+    /// Writes the database of the current title.
     void SaveDatabase();
-    void LoadDatabase();
-    void Init();
 
+    /// Counts a frame, surfaces gain confidence at most once per frame. Merges the loaded
+    /// database once it's ready.
+    void TickFrame();
+
+    /// Waits until the database of the title has been loaded.
+    void WaitForLoad();
+
+    /// Returns true when the surface has been seen and isn't blacklisted.
     bool IsInDatabase(const PixelFormat format, const u32 width, const u32 height) const {
-        const ResolutionKey key{format, width, height};
-        return database.count(key) > 0;
+        const auto it = database.find({format, width, height});
+        return it != database.end() && !it->second.is_blacklisted;
+    }
+
+    /// Returns true when the surface has been seen often enough to be rescaled.
+    bool IsTrusted(const PixelFormat format, const u32 width, const u32 height) const {
+        const auto it = database.find({format, width, height});
+        return it != database.end() && !it->second.is_blacklisted &&
+               it->second.confidence >= ConfidenceThreshold;
     }
 
     bool IsBlacklisted(const PixelFormat format, const u32 width, const u32 height) const {
-        const ResolutionKey key{format, width, height};
-        return blacklist.count(key) > 0;
+        const auto it = database.find({format, width, height});
+        return it != database.end() && it->second.is_blacklisted;
     }
 
     void Register(const PixelFormat format, const u32 width, const u32 height);
@@ -76,13 +107,41 @@ public:
     std::string GetProfilePath() const;
 
 private:
-    std::unordered_set<ResolutionKey> database{};
-    std::unordered_set<ResolutionKey> blacklist{};
+    struct Entry {
+        u8 confidence{};
+        bool is_blacklisted{};
+        u64 last_frame{}; ///< Frame it last gained confidence in, not stored
+    };
+
+    /// Entry as stored in the database file.
+    struct Record {
+        u32 format;
+        u32 width;
+        u32 height;
+        u8 confidence;
+        u8 is_blacklisted;
+        INSERT_PADDING_BYTES(2);
+    };
+    static_assert(sizeof(Record) == 16, "Record is incorrect size");
+
+    /// Reads the database file of a title, or the JSON file written by older versions.
+    static std::vector<Record> LoadRecords(const std::string& path,
+                                           const std::string& legacy_path);
+
+    /// Adds the loaded records to what has been learned since boot.
+    void MergeRecords(const std::vector<Record>& records);
+
+    std::string GetLegacyProfilePath() const;
+
+    std::string base_dir;
+    std::unordered_map<ResolutionKey, Entry> database;
+    std::future<std::vector<Record>> pending_load;
+    u64 frame = 1;
     bool initialized{};
     u64 title_id{};
-    Core::System& system;
 
-    static constexpr u32 DBVersion = 1;
+    static constexpr u32 DBMagic = 0x42445352; // "RSDB"
+    static constexpr u32 DBVersion = 2;
 };
 
 } // namespace VideoCommon::Resolution
@@ -3,11 +3,13 @@
 // Refer to the license.txt file included.
 
 #include "common/assert.h"
+#include "common/cityhash.h"
 #include "common/common_types.h"
 #include "common/microprofile.h"
 #include "video_core/memory_manager.h"
 #include "video_core/texture_cache/surface_base.h"
 #include "video_core/texture_cache/surface_params.h"
+#include "video_core/textures/bc_encoder.h"
 #include "video_core/textures/convert.h"
 
 namespace VideoCommon {
@@ -17,12 +19,31 @@ MICROPROFILE_DEFINE(GPU_Flush_Texture, "GPU", "Texture Flush", MP_RGB(128, 192,
 
 using Tegra::Texture::ConvertFromGuestToHost;
 using VideoCore::MortonSwizzleMode;
+using VideoCore::Surface::GetASTCBlockSize;
 using VideoCore::Surface::SurfaceCompression;
 
 StagingCache::StagingCache() = default;
 
 StagingCache::~StagingCache() = default;
 
+std::vector<u8>& StagingCache::ResizeBuffer(std::size_t index, std::size_t size) {
+    auto& buffer = staging_buffer[index];
+    const std::size_t old_capacity = buffer.capacity();
+    buffer.resize(size);
+    if (buffer.capacity() != old_capacity) {
+        UpdateAccountedSize();
+    }
+    return buffer;
+}
+
+void StagingCache::UpdateAccountedSize() {
+    std::size_t size = 0;
+    for (const auto& buffer : staging_buffer) {
+        size += buffer.capacity();
+    }
+    staging_memory.Resize(size);
+}
+
 SurfaceBaseImpl::SurfaceBaseImpl(GPUVAddr gpu_addr, const SurfaceParams& params)
     : params{params}, host_memory_size{params.GetHostSizeInBytes()}, gpu_addr{gpu_addr},
       mipmap_sizes(params.num_levels), mipmap_offsets(params.num_levels) {
@@ -179,26 +200,43 @@ void SurfaceBaseImpl::SwizzleFunc(MortonSwizzleMode mode, u8* memory, const Surf
     }
 }
 
+void SurfaceBaseImpl::SwizzleSubresource(MortonSwizzleMode mode, u8* memory, u8* buffer, u32 level,
+                                         u32 layer) {
+    std::size_t guest_offset{mipmap_offsets[level]};
+    std::size_t host_offset{params.GetHostMipmapLevelOffset(level)};
+    u32 depth{1};
+    if (params.is_layered) {
+        guest_offset += layer_size * layer;
+        host_offset += params.GetHostLayerSize(level) * layer;
+    } else {
+        depth = params.GetMipDepth(level);
+    }
+    MortonSwizzle(mode, params.pixel_format, params.GetMipWidth(level),
+                  params.GetMipBlockHeight(level), params.GetMipHeight(level),
+                  params.GetMipBlockDepth(level), depth, params.tile_width_spacing,
+                  buffer + host_offset, memory + guest_offset);
+}
+
 void SurfaceBaseImpl::LoadBuffer(Tegra::MemoryManager& memory_manager,
                                  StagingCache& staging_cache) {
     MICROPROFILE_SCOPE(GPU_Load_Texture);
     auto& staging_buffer = staging_cache.GetBuffer(0);
-    u8* host_ptr;
     is_continuous = memory_manager.IsBlockContinuous(gpu_addr, guest_memory_size);
+    u8* const host_ptr = GetGuestMemory(memory_manager, staging_cache, true);
+    if (!host_ptr) {
+        return;
+    }
 
-    // Handle continuouty
-    if (is_continuous) {
-        // Use physical memory directly
-        host_ptr = memory_manager.GetPointer(gpu_addr);
-        if (!host_ptr) {
+    // Only converted surfaces are worth reading from disk, copying the rest is cheaper
+    const auto compression_type = params.GetCompressionType();
+    const bool use_disk_cache = compression_type == SurfaceCompression::Converted;
+    u64 disk_cache_hash = 0;
+    if (use_disk_cache) {
+        disk_cache_hash = GetDiskCacheHash(host_ptr);
+        if (staging_cache.GetDiskCache().Load(disk_cache_hash, staging_buffer.data(),
+                                              host_memory_size)) {
             return;
         }
-    } else {
-        // Use an extra temporal buffer
-        auto& tmp_buffer = staging_cache.GetBuffer(1);
-        tmp_buffer.resize(guest_memory_size);
-        host_ptr = tmp_buffer.data();
-        memory_manager.ReadBlockUnsafe(gpu_addr, host_ptr, guest_memory_size);
     }
 
     if (params.is_tiled) {
@@ -230,11 +268,76 @@ void SurfaceBaseImpl::LoadBuffer(Tegra::MemoryManager& memory_manager,
         }
     }
 
-    auto compression_type = params.GetCompressionType();
     if (compression_type == SurfaceCompression::None ||
         compression_type == SurfaceCompression::Compressed)
         return;
 
+    if (params.IsTranscoded()) {
+        TranscodeBuffer(staging_cache);
+    } else {
+        ConvertBuffer(staging_cache);
+    }
+    if (use_disk_cache) {
+        staging_cache.GetDiskCache().Save(disk_cache_hash, staging_buffer.data(),
+                                          host_memory_size);
+    }
+}
+
+void SurfaceBaseImpl::LoadDirtyBuffer(Tegra::MemoryManager& memory_manager,
+                                      StagingCache& staging_cache) {
+    MICROPROFILE_SCOPE(GPU_Load_Texture);
+    ASSERT(CanReloadPartially());
+    auto& staging_buffer = staging_cache.GetBuffer(0);
+    is_continuous = memory_manager.IsBlockContinuous(gpu_addr, guest_memory_size);
+    u8* const host_ptr = GetGuestMemory(memory_manager, staging_cache, true);
+    if (!host_ptr) {
+        return;
+    }
+    ForEachDirtySubresource([&](u32 level, u32 layer) {
+        SwizzleSubresource(MortonSwizzleMode::MortonToLinear, host_ptr, staging_buffer.data(),
+                           level, layer);
+    });
+}
+
+bool SurfaceBaseImpl::CanReloadPartially() const {
+    // Converted formats are decoded a whole level at a time and linear surfaces have one level
+    const auto compression_type = params.GetCompressionType();
+    return params.is_tiled && !params.IsBuffer() &&
+           (compression_type == SurfaceCompression::None ||
+            compression_type == SurfaceCompression::Compressed);
+}
+
+bool SurfaceBaseImpl::MarkRegionAsDirty(CacheAddr start, CacheAddr end) {
+    const std::size_t begin_offset = std::max(start, cache_addr) - cache_addr;
+    const std::size_t end_offset = std::min(end, cache_addr_end) - cache_addr;
+    if (begin_offset >= end_offset) {
+        return false;
+    }
+    const u32 num_layers = params.is_layered ? params.depth : 1;
+    dirty_subresources.resize(static_cast<std::size_t>(params.num_levels) * num_layers);
+
+    const auto first_layer = static_cast<u32>(begin_offset / layer_size);
+    const auto last_layer =
+        std::min(static_cast<u32>((end_offset - 1) / layer_size), num_layers - 1);
+    bool marked = false;
+    for (u32 layer = first_layer; layer <= last_layer; ++layer) {
+        const std::size_t layer_offset = layer_size * layer;
+        for (u32 level = 0; level < params.num_levels; ++level) {
+            const std::size_t level_begin = layer_offset + mipmap_offsets[level];
+            const std::size_t level_end = level_begin + mipmap_sizes[level];
+            if (level_begin < end_offset && begin_offset < level_end) {
+                dirty_subresources[level * num_layers + layer] = true;
+                marked = true;
+            }
+        }
+    }
+    is_dirty |= marked;
+    return marked;
+}
+
+void SurfaceBaseImpl::ConvertBuffer(StagingCache& staging_cache) {
+    auto& staging_buffer = staging_cache.GetBuffer(0);
+    const auto compression_type = params.GetCompressionType();
     for (u32 level_up = params.num_levels; level_up > 0; --level_up) {
         const u32 level = level_up - 1;
         const std::size_t in_host_offset{params.GetHostMipmapLevelOffset(level)};
@@ -245,7 +348,38 @@ void SurfaceBaseImpl::LoadBuffer(Tegra::MemoryManager& memory_manager,
         u8* out_buffer = staging_buffer.data() + out_host_offset;
         ConvertFromGuestToHost(in_buffer, out_buffer, params.pixel_format,
                                params.GetMipWidth(level), params.GetMipHeight(level),
-                               params.GetMipDepth(level), true, true);
+                               params.GetMipDepth(level), true, true,
+                               &staging_cache.GetASTCCache());
+    }
+}
+
+u64 SurfaceBaseImpl::GetDiskCacheHash(const u8* host_ptr) const {
+    // The layout is part of the key, the same memory can be viewed with different parameters
+    const u64 size_seed = (static_cast<u64>(params.width) << 32) | params.height;
+    const u64 layout_seed = (static_cast<u64>(params.depth) << 32) |
+                            (static_cast<u64>(params.num_levels) << 24) |
+                            (static_cast<u64>(params.pixel_format) << 8) |
+                            (static_cast<u64>(params.IsTranscoded()) << 2) |
+                            (static_cast<u64>(params.is_tiled) << 1) | (params.is_layered ? 1 : 0);
+    return Common::CityHash64WithSeeds(reinterpret_cast<const char*>(host_ptr), guest_memory_size,
+                                       size_seed, layout_seed);
+}
+
+void SurfaceBaseImpl::TranscodeBuffer(StagingCache& staging_cache) {
+    auto& staging_buffer = staging_cache.GetBuffer(0);
+    const auto [block_width, block_height] = GetASTCBlockSize(params.pixel_format);
+    // BC3 takes more space than any ASTC format, levels are converted from the last one so the
+    // output doesn't overwrite the input of the levels that are still to be converted
+    for (u32 level_up = params.num_levels; level_up > 0; --level_up) {
+        const u32 level = level_up - 1;
+        const u32 width = params.GetMipWidth(level);
+        const u32 height = params.GetMipHeight(level);
+        const u32 depth = params.GetMipDepth(level);
+        const u8* const in_buffer = staging_buffer.data() + params.GetHostMipmapLevelOffset(level);
+        const std::vector<u8>& rgba8_data = staging_cache.GetASTCCache().Decompress(
+            in_buffer, width, height, depth, block_width, block_height);
+        Tegra::Texture::EncodeBC3(rgba8_data.data(), width, height, depth,
+                                  staging_buffer.data() + params.GetConvertedMipmapOffset(level));
     }
 }
 
@@ -253,20 +387,9 @@ void SurfaceBaseImpl::FlushBuffer(Tegra::MemoryManager& memory_manager,
                                   StagingCache& staging_cache) {
     MICROPROFILE_SCOPE(GPU_Flush_Texture);
     auto& staging_buffer = staging_cache.GetBuffer(0);
-    u8* host_ptr;
-
-    // Handle continuouty
-    if (is_continuous) {
-        // Use physical memory directly
-        host_ptr = memory_manager.GetPointer(gpu_addr);
-        if (!host_ptr) {
-            return;
-        }
-    } else {
-        // Use an extra temporal buffer
-        auto& tmp_buffer = staging_cache.GetBuffer(1);
-        tmp_buffer.resize(guest_memory_size);
-        host_ptr = tmp_buffer.data();
+    u8* const host_ptr = GetGuestMemory(memory_manager, staging_cache, false);
+    if (!host_ptr) {
+        return;
     }
 
     if (params.is_tiled) {
@@ -294,6 +417,24 @@ void SurfaceBaseImpl::FlushBuffer(Tegra::MemoryManager& memory_manager,
             }
         }
     }
+    CommitGuestMemory(memory_manager, host_ptr);
+}
+
+u8* SurfaceBaseImpl::GetGuestMemory(Tegra::MemoryManager& memory_manager,
+                                    StagingCache& staging_cache, bool read) {
+    if (is_continuous) {
+        // Use physical memory directly
+        return memory_manager.GetPointer(gpu_addr);
+    }
+    // Use an extra temporal buffer
+    auto& tmp_buffer = staging_cache.ResizeBuffer(1, guest_memory_size);
+    if (read) {
+        memory_manager.ReadBlockUnsafe(gpu_addr, tmp_buffer.data(), guest_memory_size);
+    }
+    return tmp_buffer.data();
+}
+
+void SurfaceBaseImpl::CommitGuestMemory(Tegra::MemoryManager& memory_manager, const u8* host_ptr) {
     if (!is_continuous) {
         memory_manager.WriteBlockUnsafe(gpu_addr, host_ptr, guest_memory_size);
     }
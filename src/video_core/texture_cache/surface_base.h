@@ -11,11 +11,14 @@
 #include "common/assert.h"
 #include "common/binary_find.h"
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "video_core/gpu.h"
 #include "video_core/morton.h"
 #include "video_core/texture_cache/copy_params.h"
 #include "video_core/texture_cache/surface_params.h"
 #include "video_core/texture_cache/surface_view.h"
+#include "video_core/texture_cache/texture_disk_cache.h"
+#include "video_core/textures/astc.h"
 
 namespace Tegra {
 class MemoryManager;
@@ -51,12 +54,36 @@ public:
         return staging_buffer[index];
     }
 
+    /// Resizes a staging buffer, they keep their storage to be reused by the next texture.
+    std::vector<u8>& ResizeBuffer(std::size_t index, std::size_t size);
+
     void SetSize(std::size_t size) {
         staging_buffer.resize(size);
+        UpdateAccountedSize();
+    }
+
+    Tegra::Texture::ASTC::DecodeCache& GetASTCCache() {
+        return astc_cache;
+    }
+
+    TextureDiskCache& GetDiskCache() {
+        return disk_cache;
     }
 
 private:
+    void UpdateAccountedSize();
+
+    /// Decoded ASTC data kept around for textures that are uploaded again.
+    static constexpr std::size_t ASTCCacheSize = 64ULL * 1024 * 1024;
+
+    /// Compressed decoded textures kept on disk between runs.
+    static constexpr std::size_t DiskCacheSize = 1024ULL * 1024 * 1024;
+
     std::vector<std::vector<u8>> staging_buffer;
+    Common::MemoryAccounting::TrackedAllocation staging_memory{
+        Common::MemoryAccounting::Tag::TextureStaging};
+    Tegra::Texture::ASTC::DecodeCache astc_cache{ASTCCacheSize};
+    TextureDiskCache disk_cache{DiskCacheSize};
 };
 
 class SurfaceBaseImpl {
@@ -65,6 +92,47 @@ public:
 
     void FlushBuffer(Tegra::MemoryManager& memory_manager, StagingCache& staging_cache);
 
+    /// Unswizzles only the dirty levels and layers to their place in the staging buffer.
+    void LoadDirtyBuffer(Tegra::MemoryManager& memory_manager, StagingCache& staging_cache);
+
+    /**
+     * Returns true when the surface can reload the levels and layers written by the CPU on their
+     * own. Only block linear surfaces uploaded as they are stored in guest memory qualify.
+     */
+    bool CanReloadPartially() const;
+
+    /**
+     * Marks the levels and layers overlapping a guest memory range as out of date.
+     * @returns True when any of them was marked, writes to the padding between layers mark none.
+     */
+    bool MarkRegionAsDirty(CacheAddr start, CacheAddr end);
+
+    /// Forgets the dirty levels and layers, once they were uploaded or the surface is recycled.
+    void ClearDirty() {
+        std::fill(dirty_subresources.begin(), dirty_subresources.end(), false);
+        is_dirty = false;
+    }
+
+    bool IsDirty() const {
+        return is_dirty;
+    }
+
+    /// Calls func(level, layer) for each dirty subresource, layer is always 0 on unlayered ones.
+    template <typename Func>
+    void ForEachDirtySubresource(Func&& func) const {
+        if (!is_dirty) {
+            return;
+        }
+        const u32 num_layers = params.is_layered ? params.depth : 1;
+        for (u32 level = 0; level < params.num_levels; ++level) {
+            for (u32 layer = 0; layer < num_layers; ++layer) {
+                if (dirty_subresources[level * num_layers + layer]) {
+                    func(level, layer);
+                }
+            }
+        }
+    }
+
     GPUVAddr GetGpuAddr() const {
         return gpu_addr;
     }
@@ -166,6 +234,25 @@ protected:
 
     virtual void DecorateSurfaceName() = 0;
 
+    /**
+     * Returns a pointer to the guest memory of the surface. Memory that isn't continuous goes
+     * through a staging buffer, read from the guest when requested.
+     */
+    u8* GetGuestMemory(Tegra::MemoryManager& memory_manager, StagingCache& staging_cache,
+                       bool read);
+
+    /// Writes guest memory returned by GetGuestMemory back when it went through a staging buffer.
+    void CommitGuestMemory(Tegra::MemoryManager& memory_manager, const u8* host_ptr);
+
+    /// Returns the key of the decoded surface built from the given guest memory.
+    u64 GetDiskCacheHash(const u8* host_ptr) const;
+
+    /// Converts the linear levels in the staging buffer to their host format in place.
+    void ConvertBuffer(StagingCache& staging_cache);
+
+    /// Decodes the linear ASTC levels in the staging buffer and encodes them as BC3 in place.
+    void TranscodeBuffer(StagingCache& staging_cache);
+
     const SurfaceParams params;
     std::size_t layer_size;
     std::size_t guest_memory_size;
@@ -183,9 +270,17 @@ private:
     void SwizzleFunc(MortonSwizzleMode mode, u8* memory, const SurfaceParams& params, u8* buffer,
                      u32 level);
 
+    /// Converts a single layer of a level, or a whole level on unlayered surfaces.
+    void SwizzleSubresource(MortonSwizzleMode mode, u8* memory, u8* buffer, u32 level, u32 layer);
+
     std::vector<CopyParams> BreakDownLayered(const SurfaceParams& in_params) const;
 
     std::vector<CopyParams> BreakDownNonLayered(const SurfaceParams& in_params) const;
+
+    /// Levels and layers written in guest memory since they were loaded, indexed by
+    /// level * num_layers + layer. Allocated the first time the surface is written to.
+    std::vector<bool> dirty_subresources;
+    bool is_dirty{};
 };
 
 template <typename TView>
@@ -195,6 +290,33 @@ public:
 
     virtual void DownloadTexture(std::vector<u8>& staging_buffer) = 0;
 
+    /// Uploads the dirty levels and layers loaded in the staging buffer by LoadDirtyBuffer.
+    virtual void UploadDirtyTexture(const std::vector<u8>& staging_buffer) = 0;
+
+    /**
+     * Uploads the texture from its block linear guest memory without unswizzling it on the CPU.
+     * @returns False when the surface can't be uploaded this way, nothing is done then.
+     */
+    virtual bool UploadSwizzledTexture(Tegra::MemoryManager& memory_manager,
+                                       StagingCache& staging_cache) {
+        return false;
+    }
+
+    /**
+     * Writes the texture to its block linear guest memory without swizzling it on the CPU.
+     * @returns False when the surface can't be flushed this way, nothing is done then.
+     */
+    virtual bool DownloadSwizzledTexture(Tegra::MemoryManager& memory_manager,
+                                         StagingCache& staging_cache) {
+        return false;
+    }
+
+    /**
+     * Starts copying the texture to host memory without waiting for it, so a DownloadTexture of
+     * the same contents later on only has to wait for a copy that most likely finished already.
+     */
+    virtual void PrefetchDownload() {}
+
     void MarkAsModified(bool is_modified_, u64 tick) {
         is_modified = is_modified_ || is_target;
         modification_tick = tick;
@@ -209,6 +331,10 @@ public:
         this->is_rescaled = is_rescaled;
     }
 
+    void MarkAsReadByCpu() {
+        is_read_by_cpu = true;
+    }
+
     void MarkAsPicked(bool is_picked_) {
         is_picked = is_picked_;
     }
@@ -234,6 +360,11 @@ public:
         return is_rescaled;
     }
 
+    /// Returns true when the CPU has read the surface before, it's expected to read it again
+    bool IsReadByCpu() const {
+        return is_read_by_cpu;
+    }
+
     bool IsRegistered() const {
         return is_registered;
     }
@@ -250,6 +381,14 @@ public:
         return modification_tick;
     }
 
+    void MarkAsUsed(u64 frame) {
+        last_used_frame = frame;
+    }
+
+    u64 GetLastUsedFrame() const {
+        return last_used_frame;
+    }
+
     TView EmplaceOverview(const SurfaceParams& overview_params) {
         const u32 num_layers{(params.is_layered && !overview_params.is_layered) ? 1 : params.depth};
         return GetView(ViewParams(overview_params.target, 0, num_layers, 0, params.num_levels));
@@ -327,8 +466,10 @@ private:
     bool is_registered{};
     bool is_picked{};
     bool is_rescaled{};
+    bool is_read_by_cpu{};
     u32 index{NO_RT};
     u64 modification_tick{};
+    u64 last_used_frame{};
 };
 
 } // namespace VideoCommon
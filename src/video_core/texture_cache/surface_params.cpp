@@ -7,9 +7,11 @@
 #include "common/alignment.h"
 #include "common/bit_util.h"
 #include "core/core.h"
+#include "core/settings.h"
 #include "video_core/engines/shader_bytecode.h"
 #include "video_core/surface.h"
 #include "video_core/texture_cache/surface_params.h"
+#include "video_core/textures/bc_encoder.h"
 
 namespace VideoCommon {
 
@@ -321,9 +323,30 @@ std::size_t SurfaceParams::GetConvertedMipmapSize(u32 level) const {
     const std::size_t width_t = GetMipWidth(level);
     const std::size_t height_t = GetMipHeight(level);
     const std::size_t depth_t = is_layered ? depth : GetMipDepth(level);
+    if (IsTranscoded()) {
+        return Tegra::Texture::GetBC3Size(static_cast<u32>(width_t), static_cast<u32>(height_t),
+                                          static_cast<u32>(depth_t));
+    }
     return width_t * height_t * depth_t * rgba8_bpp;
 }
 
+bool SurfaceParams::IsTranscoded() const {
+    if (!Settings::values.transcode_astc_textures ||
+        !VideoCore::Surface::IsPixelFormatASTC(pixel_format)) {
+        return false;
+    }
+    // BC3 is only available for two dimensional targets
+    switch (target) {
+    case SurfaceTarget::Texture2D:
+    case SurfaceTarget::Texture2DArray:
+    case SurfaceTarget::TextureCubemap:
+    case SurfaceTarget::TextureCubeArray:
+        return true;
+    default:
+        return false;
+    }
+}
+
 std::size_t SurfaceParams::GetLayerSize(bool as_host_size, bool uncompressed) const {
     std::size_t size = 0;
     for (u32 level = 0; level < num_levels; ++level) {
@@ -6,8 +6,8 @@
 
 #include "common/alignment.h"
 #include "common/bit_util.h"
-#include "common/cityhash.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/shader/shader_ir.h"
@@ -42,8 +42,7 @@ public:
         const Tegra::Engines::Fermi2D::Regs::Surface& config);
 
     std::size_t Hash() const {
-        return static_cast<std::size_t>(
-            Common::CityHash64(reinterpret_cast<const char*>(this), sizeof(*this)));
+        return static_cast<std::size_t>(Common::ComputeFastHash64(this, sizeof(*this)));
     }
 
     bool operator==(const SurfaceParams& rhs) const;
@@ -59,7 +58,7 @@ public:
     std::size_t GetHostSizeInBytes() const {
         std::size_t host_size_in_bytes;
         if (GetCompressionType() == SurfaceCompression::Converted) {
-            // ASTC is uncompressed in software, in emulated as RGBA8
+            // ASTC is uncompressed in software, in emulated as RGBA8 or BC3
             host_size_in_bytes = 0;
             for (u32 level = 0; level < num_levels; ++level) {
                 host_size_in_bytes += GetConvertedMipmapSize(level);
@@ -97,8 +96,9 @@ public:
 
     /// Returns the best possible row/pitch alignment for the surface.
     u32 GetRowAlignment(u32 level) const {
-        const u32 bpp =
-            GetCompressionType() == SurfaceCompression::Converted ? 4 : GetBytesPerPixel();
+        const u32 bpp = GetCompressionType() == SurfaceCompression::Converted && !IsTranscoded()
+                            ? 4
+                            : GetBytesPerPixel();
         return 1U << Common::CountTrailingZeroes32(GetMipWidth(level) * bpp);
     }
 
@@ -181,6 +181,12 @@ public:
         return VideoCore::Surface::GetFormatCompressionType(pixel_format);
     }
 
+    /**
+     * Returns true when the converted texture is re-encoded to BC3 on the host instead of being
+     * kept as RGBA8.
+     */
+    bool IsTranscoded() const;
+
     /// Returns is the surface is a TextureBuffer type of surface.
     bool IsBuffer() const {
         return target == VideoCore::Surface::SurfaceTarget::TextureBuffer;
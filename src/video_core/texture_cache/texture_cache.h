@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -14,19 +15,21 @@
 #include <vector>
 #include <fmt/format.h>
 
-#include <boost/icl/interval_map.hpp>
 #include <boost/range/iterator_range.hpp>
 
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/math_util.h"
+#include "common/memory_accounting.h"
 #include "core/core.h"
+#include "core/hle/kernel/process.h"
 #include "core/memory.h"
 #include "core/settings.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/gpu.h"
 #include "video_core/memory_manager.h"
+#include "video_core/page_index.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/surface.h"
 #include "video_core/texture_cache/copy_params.h"
@@ -52,8 +55,6 @@ using RenderTargetConfig = Tegra::Engines::Maxwell3D::Regs::RenderTargetConfig;
 
 template <typename TSurface, typename TView>
 class TextureCache {
-    using IntervalMap = boost::icl::interval_map<CacheAddr, std::set<TSurface>>;
-    using IntervalType = typename IntervalMap::interval_type;
 
 private:
     enum class UnregisterReason : u32 {
@@ -64,16 +65,33 @@ private:
     };
 
 public:
+    /// Reasons a Fermi 2D copy couldn't be done with a blit between the host GPU surfaces.
+    enum class BlitFallback : u32 {
+        FlushedOverlaps, ///< Overlapping surfaces went through guest memory to build a surface
+        Texture3D,       ///< 3D surfaces can't be blitted
+        TypeMismatch,    ///< Color and depth surfaces can't be blitted into each other
+        IntegerMismatch, ///< Integer and non-integer formats can only be copied unscaled
+        Count,
+    };
+
     void InvalidateRegion(CacheAddr addr, std::size_t size) {
         std::lock_guard lock{mutex};
 
         for (const auto& surface : GetSurfacesInRegion(addr, size)) {
+            if (CanReloadPartially(surface)) {
+                // Keep the surface and upload the written levels and layers on its next use
+                const bool was_dirty = surface->IsDirty();
+                if (surface->MarkRegionAsDirty(addr, addr + size) && !was_dirty) {
+                    dirty_surfaces.push_back(surface);
+                }
+                continue;
+            }
             Unregister(surface, UnregisterReason::Invalidated);
         }
     }
 
     void LoadResources() {
-        scaling_database.Init();
+        scaling_database.Init(system.CurrentProcess()->GetTitleID());
     }
 
     /***
@@ -100,9 +118,38 @@ public:
         });
         for (const auto& surface : surfaces) {
             FlushSurface(surface);
+            surface->MarkAsReadByCpu();
         }
     }
 
+    /// Returns true when a surface in the region was written by the GPU and not yet flushed
+    bool MustFlushRegion(CacheAddr addr, std::size_t size) {
+        std::lock_guard lock{mutex};
+
+        const auto surfaces = GetSurfacesInRegion(addr, size);
+        return std::any_of(surfaces.begin(), surfaces.end(),
+                           [](const TSurface& surface) { return surface->IsModified(); });
+    }
+
+    /// Releases the surfaces unused for the longest time while the cache is over its budget
+    void TickFrame() {
+        std::lock_guard lock{mutex};
+
+        EvictSurfaces();
+        scaling_database.TickFrame();
+        ++frame;
+    }
+
+    /// Returns the host memory held by all the surfaces of the cache
+    u64 GetResidentBytes() const {
+        return resident_bytes;
+    }
+
+    /// Returns the host memory held by the surfaces of a format
+    u64 GetResidentBytes(PixelFormat format) const {
+        return resident_bytes_per_format[static_cast<std::size_t>(format)];
+    }
+
     TView GetTextureSurface(const Tegra::Texture::TICEntry& tic,
                             const VideoCommon::Shader::Sampler& entry) {
         std::lock_guard lock{mutex};
@@ -112,6 +159,7 @@ public:
         }
         const auto params{SurfaceParams::CreateForTexture(tic, entry)};
         const auto [surface, view] = GetSurface(gpu_addr, params, true, false);
+        surface->MarkAsUsed(frame);
         if (guard_samplers) {
             sampled_textures.push_back(surface);
         }
@@ -127,6 +175,7 @@ public:
         }
         const auto params{SurfaceParams::CreateForImage(tic, entry)};
         const auto [surface, view] = GetSurface(gpu_addr, params, true, false);
+        surface->MarkAsUsed(frame);
         if (guard_samplers) {
             sampled_textures.push_back(surface);
         }
@@ -146,6 +195,9 @@ public:
         auto& maxwell3d = system.GPU().Maxwell3D();
 
         if (!maxwell3d.dirty.depth_buffer) {
+            if (depth_buffer.target) {
+                depth_buffer.target->MarkAsUsed(frame);
+            }
             return depth_buffer.view;
         }
         maxwell3d.dirty.depth_buffer = false;
@@ -161,13 +213,15 @@ public:
             regs.zeta.memory_layout.block_width, regs.zeta.memory_layout.block_height,
             regs.zeta.memory_layout.block_depth, regs.zeta.memory_layout.type)};
         auto surface_view = GetSurface(gpu_addr, depth_params, preserve_contents, true);
-        if (depth_buffer.target)
-            depth_buffer.target->MarkAsRenderTarget(false, NO_RT);
+        surface_view.first->MarkAsUsed(frame);
+        if (depth_buffer.target != surface_view.first) {
+            UnbindRenderTarget(depth_buffer.target);
+        }
         depth_buffer.target = surface_view.first;
         depth_buffer.view = surface_view.second;
         if (depth_buffer.target) {
             depth_buffer.target->MarkAsRenderTarget(true, DEPTH_RT);
-            if (IsResolutionScannerEnabled()) {
+            if (IsResolutionLearningEnabled()) {
                 MarkScanner(depth_buffer.target);
             }
         }
@@ -179,6 +233,9 @@ public:
         ASSERT(index < Tegra::Engines::Maxwell3D::Regs::NumRenderTargets);
         auto& maxwell3d = system.GPU().Maxwell3D();
         if (!maxwell3d.dirty.render_target[index]) {
+            if (render_targets[index].target) {
+                render_targets[index].target->MarkAsUsed(frame);
+            }
             return render_targets[index].view;
         }
         maxwell3d.dirty.render_target[index] = false;
@@ -199,13 +256,15 @@ public:
 
         auto surface_view = GetSurface(gpu_addr, SurfaceParams::CreateForFramebuffer(system, index),
                                        preserve_contents, true);
-        if (render_targets[index].target)
-            render_targets[index].target->MarkAsRenderTarget(false, NO_RT);
+        surface_view.first->MarkAsUsed(frame);
+        if (render_targets[index].target != surface_view.first) {
+            UnbindRenderTarget(render_targets[index].target);
+        }
         render_targets[index].target = surface_view.first;
         render_targets[index].view = surface_view.second;
         if (render_targets[index].target) {
             render_targets[index].target->MarkAsRenderTarget(true, static_cast<u32>(index));
-            if (IsResolutionScannerEnabled()) {
+            if (IsResolutionLearningEnabled()) {
                 MarkScanner(render_targets[index].target);
             }
         }
@@ -228,7 +287,7 @@ public:
         if (depth_buffer.target == nullptr) {
             return;
         }
-        depth_buffer.target->MarkAsRenderTarget(false, NO_RT);
+        UnbindRenderTarget(depth_buffer.target);
         depth_buffer.target = nullptr;
         depth_buffer.view = nullptr;
     }
@@ -237,7 +296,7 @@ public:
         if (render_targets[index].target == nullptr) {
             return;
         }
-        render_targets[index].target->MarkAsRenderTarget(false, NO_RT);
+        UnbindRenderTarget(render_targets[index].target);
         render_targets[index].target = nullptr;
         render_targets[index].view = nullptr;
     }
@@ -251,9 +310,13 @@ public:
         const GPUVAddr src_gpu_addr = src_config.Address();
         const GPUVAddr dst_gpu_addr = dst_config.Address();
         DeduceBestBlit(src_params, dst_params, src_gpu_addr, dst_gpu_addr);
+        is_fermi_copy = true;
         std::pair<TSurface, TView> dst_surface = GetSurface(dst_gpu_addr, dst_params, true, false);
         std::pair<TSurface, TView> src_surface = GetSurface(src_gpu_addr, src_params, true, false);
-        if (IsResolutionScannerEnabled()) {
+        is_fermi_copy = false;
+        dst_surface.first->MarkAsUsed(frame);
+        src_surface.first->MarkAsUsed(frame);
+        if (IsResolutionLearningEnabled()) {
             bool is_candidate = IsInRSDatabase(src_surface.first);
             if (is_candidate) {
                 MarkScanner(dst_surface.first);
@@ -263,19 +326,34 @@ public:
         dst_surface.first->MarkAsModified(true, Tick());
     }
 
+    /// Returns how many Fermi 2D copies fell back for the given reason.
+    u64 GetBlitFallbackCount(BlitFallback reason) const {
+        return blit_fallbacks[static_cast<std::size_t>(reason)];
+    }
+
+    /// Returns how many surfaces were looked up, can be called from any thread.
+    u64 GetSurfaceLookupCount() const {
+        return surface_lookups.load(std::memory_order_relaxed);
+    }
+
+    /// Returns how many lookups had to create a new surface, can be called from any thread.
+    u64 GetSurfaceMissCount() const {
+        return surface_misses.load(std::memory_order_relaxed);
+    }
+
     TSurface TryFindFramebufferSurface(const u8* host_ptr) {
         const CacheAddr cache_addr = ToCacheAddr(host_ptr);
         if (!cache_addr) {
             return nullptr;
         }
-        const CacheAddr page = cache_addr >> registry_page_bits;
-        std::vector<TSurface>& list = registry[page];
-        for (auto& surface : list) {
-            if (surface->GetCacheAddr() == cache_addr) {
-                return surface;
+        ReloadDirtySurfaces(cache_addr, 1);
+        TSurface found;
+        registry.ForEachInRange(cache_addr, cache_addr + 1, [&](const TSurface& surface) {
+            if (!found && surface->GetCacheAddr() == cache_addr) {
+                found = surface;
             }
-        }
-        return nullptr;
+        });
+        return found;
     }
 
     u64 Tick() {
@@ -314,7 +392,7 @@ public:
 
 protected:
     TextureCache(Core::System& system, VideoCore::RasterizerInterface& rasterizer)
-        : system{system}, rasterizer{rasterizer}, scaling_database{system} {
+        : system{system}, rasterizer{rasterizer}, scaling_database{} {
         for (std::size_t i = 0; i < Tegra::Engines::Maxwell3D::Regs::NumRenderTargets; i++) {
             SetEmptyColorBuffer(i);
         }
@@ -337,7 +415,11 @@ protected:
         sampled_textures.reserve(64);
     }
 
-    ~TextureCache() = default;
+    ~TextureCache() {
+        // Surfaces still resident go away with the cache
+        Common::MemoryAccounting::Free(Common::MemoryAccounting::Tag::TextureSurfaces,
+                                       static_cast<std::size_t>(resident_bytes));
+    }
 
     virtual TSurface CreateSurface(GPUVAddr gpu_addr, const SurfaceParams& params) = 0;
 
@@ -351,6 +433,21 @@ protected:
     // and reading it from a sepparate buffer.
     virtual void BufferCopy(TSurface& src_surface, TSurface& dst_surface) = 0;
 
+    /// Called before the cache drops its last reference to a surface, backends release the host
+    /// objects built on top of its views here.
+    virtual void OnSurfaceReleased(const TSurface& surface) {}
+
+    /// Records a Fermi 2D copy that couldn't stay on the host GPU, the first of each reason is
+    /// logged.
+    void CountBlitFallback(BlitFallback reason) {
+        static constexpr std::array<const char*, static_cast<std::size_t>(BlitFallback::Count)>
+            reason_names{"flushed overlaps", "3D surface", "type mismatch", "integer mismatch"};
+        const std::size_t index = static_cast<std::size_t>(reason);
+        if (blit_fallbacks[index]++ == 0) {
+            LOG_WARNING(HW_GPU, "Fermi 2D copy fell back, reason: {}", reason_names[index]);
+        }
+    }
+
     void ManageRenderTargetUnregister(TSurface& surface) {
         auto& maxwell3d = system.GPU().Maxwell3D();
         const u32 index = surface->GetRenderTarget();
@@ -390,11 +487,15 @@ protected:
             ManageRenderTargetUnregister(surface);
         }
 
-        if (IsResolutionScannerEnabled()) {
+        if (IsResolutionLearningEnabled()) {
             if (reason == UnregisterReason::Restructured) {
                 UnmarkScanner(surface);
             }
         }
+        if (surface->IsDirty()) {
+            surface->ClearDirty();
+            dirty_surfaces.erase(std::find(dirty_surfaces.begin(), dirty_surfaces.end(), surface));
+        }
         const std::size_t size = surface->GetSizeInBytes();
         const VAddr cpu_addr = surface->GetCpuAddr();
         rasterizer.UpdatePagesCachedCount(cpu_addr, size, -1);
@@ -410,6 +511,7 @@ protected:
         }
         // No reserved surface available, create a new one and reserve it
         auto new_surface{CreateSurface(gpu_addr, params)};
+        TrackSurface(new_surface);
         return new_surface;
     }
 
@@ -422,7 +524,7 @@ protected:
 
     // Must be called by child's create surface
     void SignalCreatedSurface(TSurface& new_surface) {
-        if (EnabledRescaling() && IsInRSDatabase(new_surface)) {
+        if (EnabledRescaling() && IsRSTrusted(new_surface)) {
             new_surface->MarkAsRescaled(true);
         }
     }
@@ -521,6 +623,9 @@ private:
                       [](const TSurface& a, const TSurface& b) -> bool {
                           return a->GetModificationTick() < b->GetModificationTick();
                       });
+            if (is_fermi_copy) {
+                CountBlitFallback(BlitFallback::FlushedOverlaps);
+            }
             for (auto& surface : overlaps) {
                 FlushSurface(surface);
             }
@@ -569,7 +674,7 @@ private:
                 ImageCopy(current_surface, new_surface, brick);
             }
         }
-        if (IsResolutionScannerEnabled()) {
+        if (IsResolutionLearningEnabled()) {
             if (IsInRSDatabase(current_surface)) {
                 if (IsRSBlacklisted(new_surface)) {
                     UnmarkScanner(current_surface);
@@ -691,6 +796,7 @@ private:
                                           bool preserve_contents, bool is_render) {
         const auto host_ptr{system.GPU().MemoryManager().GetPointer(gpu_addr)};
         const auto cache_addr{ToCacheAddr(host_ptr)};
+        surface_lookups.fetch_add(1, std::memory_order_relaxed);
 
         // Step 0: guarantee a valid surface
         if (!cache_addr) {
@@ -704,6 +810,10 @@ private:
             return InitializeSurface(gpu_addr, new_params, false);
         }
 
+        // Surfaces written by the CPU have to be brought up to date before they are looked at
+        const std::size_t candidate_size = params.GetGuestSizeInBytes();
+        ReloadDirtySurfaces(cache_addr, candidate_size);
+
         // Step 1
         // Check Level 1 Cache for a fast structural match. If candidate surface
         // matches at certain level we are pretty much done.
@@ -729,7 +839,6 @@ private:
 
         // Step 2
         // Obtain all possible overlaps in the memory region
-        const std::size_t candidate_size = params.GetGuestSizeInBytes();
         auto overlaps{GetSurfacesInRegion(cache_addr, candidate_size)};
 
         // If none are found, we are done. we just load the surface and create it.
@@ -924,6 +1033,7 @@ private:
 
     std::pair<TSurface, TView> InitializeSurface(GPUVAddr gpu_addr, const SurfaceParams& params,
                                                  bool preserve_contents) {
+        surface_misses.fetch_add(1, std::memory_order_relaxed);
         auto new_surface{GetUncachedSurface(gpu_addr, params)};
         Register(new_surface);
         if (preserve_contents) {
@@ -937,7 +1047,7 @@ private:
         enable_resolution_scaling = false;
         TSurface proxy = CreateSurface(surface->GetGpuAddr(), params);
         enable_resolution_scaling = true;
-        staging_cache.GetBuffer(0).resize(proxy->GetHostSizeInBytes());
+        staging_cache.ResizeBuffer(0, proxy->GetHostSizeInBytes());
         proxy->LoadBuffer(system.GPU().MemoryManager(), staging_cache);
         proxy->UploadTexture(staging_cache.GetBuffer(0));
         Tegra::Engines::Fermi2D::Config copy_config;
@@ -956,74 +1066,165 @@ private:
             LoadSurfaceRescaled(surface);
             return;
         }
-        staging_cache.GetBuffer(0).resize(surface->GetHostSizeInBytes());
-        surface->LoadBuffer(system.GPU().MemoryManager(), staging_cache);
-        surface->UploadTexture(staging_cache.GetBuffer(0));
+        auto& memory_manager = system.GPU().MemoryManager();
+        if (!surface->UploadSwizzledTexture(memory_manager, staging_cache)) {
+            staging_cache.ResizeBuffer(0, surface->GetHostSizeInBytes());
+            surface->LoadBuffer(memory_manager, staging_cache);
+            surface->UploadTexture(staging_cache.GetBuffer(0));
+        }
         surface->MarkAsModified(false, Tick());
     }
 
+    /// Returns true when a CPU write to the surface can be handled by reloading what it overlaps
+    bool CanReloadPartially(const TSurface& surface) const {
+        // Writes to data only the GPU has or to bound render targets still drop the surface
+        return surface->CanReloadPartially() && !surface->IsModified() &&
+               !surface->IsRenderTarget() && !surface->IsRescaled();
+    }
+
+    /// Uploads the levels and layers written by the CPU of the surfaces overlapping a region
+    void ReloadDirtySurfaces(CacheAddr cache_addr, std::size_t size) {
+        if (dirty_surfaces.empty()) {
+            return;
+        }
+        const CacheAddr cache_addr_end = cache_addr + size;
+        auto& memory_manager = system.GPU().MemoryManager();
+        for (auto it = dirty_surfaces.begin(); it != dirty_surfaces.end();) {
+            TSurface& surface = *it;
+            if (!surface->Overlaps(cache_addr, cache_addr_end)) {
+                ++it;
+                continue;
+            }
+            staging_cache.ResizeBuffer(0, surface->GetHostSizeInBytes());
+            surface->LoadDirtyBuffer(memory_manager, staging_cache);
+            surface->UploadDirtyTexture(staging_cache.GetBuffer(0));
+            surface->ClearDirty();
+            surface->MarkAsModified(false, Tick());
+            it = dirty_surfaces.erase(it);
+        }
+    }
+
+    /// Marks a surface as no longer bound for rendering. Rendering to it is done for now, so when
+    /// the CPU is expected to read it back its download is started right away.
+    void UnbindRenderTarget(const TSurface& surface) {
+        if (!surface) {
+            return;
+        }
+        surface->MarkAsRenderTarget(false, NO_RT);
+        if (surface->IsModified() && surface->IsReadByCpu()) {
+            surface->PrefetchDownload();
+        }
+    }
+
     void FlushSurface(const TSurface& surface) {
         if (!surface->IsModified()) {
             return;
         }
-        if (IsResolutionScannerEnabled()) {
+        if (IsResolutionLearningEnabled()) {
             UnmarkScanner(surface);
         }
-        staging_cache.GetBuffer(0).resize(surface->GetHostSizeInBytes());
-        surface->DownloadTexture(staging_cache.GetBuffer(0));
-        surface->FlushBuffer(system.GPU().MemoryManager(), staging_cache);
+        auto& memory_manager = system.GPU().MemoryManager();
+        if (!surface->DownloadSwizzledTexture(memory_manager, staging_cache)) {
+            staging_cache.ResizeBuffer(0, surface->GetHostSizeInBytes());
+            surface->DownloadTexture(staging_cache.GetBuffer(0));
+            surface->FlushBuffer(memory_manager, staging_cache);
+        }
         surface->MarkAsModified(false, Tick());
     }
 
     void RegisterInnerCache(TSurface& surface) {
         const CacheAddr cache_addr = surface->GetCacheAddr();
-        CacheAddr start = cache_addr >> registry_page_bits;
-        const CacheAddr end = (surface->GetCacheAddrEnd() - 1) >> registry_page_bits;
         l1_cache[cache_addr] = surface;
-        while (start <= end) {
-            registry[start].push_back(surface);
-            start++;
-        }
+        registry.Insert(cache_addr, surface->GetCacheAddrEnd(), surface);
     }
 
     void UnregisterInnerCache(TSurface& surface) {
         const CacheAddr cache_addr = surface->GetCacheAddr();
-        CacheAddr start = cache_addr >> registry_page_bits;
-        const CacheAddr end = (surface->GetCacheAddrEnd() - 1) >> registry_page_bits;
         l1_cache.erase(cache_addr);
-        while (start <= end) {
-            auto& reg{registry[start]};
-            reg.erase(std::find(reg.begin(), reg.end(), surface));
-            start++;
-        }
+        registry.Remove(cache_addr, surface->GetCacheAddrEnd(), surface);
     }
 
     std::vector<TSurface> GetSurfacesInRegion(const CacheAddr cache_addr, const std::size_t size) {
         if (size == 0) {
             return {};
         }
-        const CacheAddr cache_addr_end = cache_addr + size;
-        CacheAddr start = cache_addr >> registry_page_bits;
-        const CacheAddr end = (cache_addr_end - 1) >> registry_page_bits;
         std::vector<TSurface> surfaces;
-        while (start <= end) {
-            std::vector<TSurface>& list = registry[start];
-            for (auto& surface : list) {
-                if (!surface->IsPicked() && surface->Overlaps(cache_addr, cache_addr_end)) {
-                    surface->MarkAsPicked(true);
-                    surfaces.push_back(surface);
-                }
-            }
-            start++;
-        }
-        for (auto& surface : surfaces) {
-            surface->MarkAsPicked(false);
-        }
+        const auto collect = [&surfaces](const TSurface& surface) { surfaces.push_back(surface); };
+        registry.ForEachInRange(cache_addr, cache_addr + size, collect);
         return surfaces;
     }
 
     void ReserveSurface(const SurfaceParams& params, TSurface surface) {
-        surface_reserve[params].push_back(std::move(surface));
+        auto& reserve = surface_reserve[params];
+        // Surfaces taken from the reserve stay in it, avoid listing them twice
+        if (std::find(reserve.begin(), reserve.end(), surface) == reserve.end()) {
+            reserve.push_back(std::move(surface));
+        }
+    }
+
+    void TrackSurface(const TSurface& surface) {
+        const std::size_t size = surface->GetHostSizeInBytes();
+        const auto format = static_cast<std::size_t>(surface->GetSurfaceParams().pixel_format);
+        resident_surfaces.push_back(surface);
+        resident_bytes += size;
+        resident_bytes_per_format[format] += size;
+        Common::MemoryAccounting::Allocate(Common::MemoryAccounting::Tag::TextureSurfaces, size);
+    }
+
+    /// Drops every reference the cache holds to a surface that is no longer registered
+    void ReleaseSurface(const TSurface& surface) {
+        OnSurfaceReleased(surface);
+
+        const auto& params = surface->GetSurfaceParams();
+        if (const auto it = surface_reserve.find(params); it != surface_reserve.end()) {
+            auto& reserve = it->second;
+            reserve.erase(std::remove(reserve.begin(), reserve.end(), surface), reserve.end());
+        }
+        const auto it = std::find(resident_surfaces.begin(), resident_surfaces.end(), surface);
+        ASSERT(it != resident_surfaces.end());
+        *it = std::move(resident_surfaces.back());
+        resident_surfaces.pop_back();
+
+        const std::size_t size = surface->GetHostSizeInBytes();
+        resident_bytes -= size;
+        resident_bytes_per_format[static_cast<std::size_t>(params.pixel_format)] -= size;
+        Common::MemoryAccounting::Free(Common::MemoryAccounting::Tag::TextureSurfaces, size);
+    }
+
+    void EvictSurfaces() {
+        const u64 budget = u64{Settings::values.texture_cache_budget_mb} << 20;
+        if (budget == 0 || resident_bytes <= budget) {
+            return;
+        }
+        // Surfaces holding data only the GPU has are written back before being released when
+        // emulating accurately, otherwise they are kept to avoid stalling on the download.
+        const bool flush_modified = Settings::values.use_accurate_gpu_emulation;
+
+        std::vector<TSurface> candidates;
+        for (const auto& surface : resident_surfaces) {
+            if (surface->GetLastUsedFrame() == frame || surface->IsRenderTarget() ||
+                surface->IsProtected()) {
+                continue;
+            }
+            if (surface->IsRegistered() && surface->IsModified() && !flush_modified) {
+                continue;
+            }
+            candidates.push_back(surface);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const TSurface& a, const TSurface& b) {
+            return a->GetLastUsedFrame() < b->GetLastUsedFrame();
+        });
+
+        for (auto& surface : candidates) {
+            if (resident_bytes <= budget) {
+                break;
+            }
+            if (surface->IsRegistered()) {
+                FlushSurface(surface);
+                Unregister(surface, UnregisterReason::Invalidated);
+            }
+            ReleaseSurface(surface);
+        }
     }
 
     TSurface TryGetReservedSurface(const SurfaceParams& params) {
@@ -1047,6 +1248,11 @@ private:
         return Settings::values.use_resolution_scanner;
     }
 
+    /// The database keeps learning from the surfaces in use while rescaling is enabled
+    bool IsResolutionLearningEnabled() const {
+        return IsResolutionScannerEnabled() || EnabledRescaling();
+    }
+
     void UnmarkScanner(const TSurface& surface) {
         const auto params = surface->GetSurfaceParams();
         scaling_database.Unregister(params.pixel_format, params.width, params.height);
@@ -1071,6 +1277,11 @@ private:
         return scaling_database.IsInDatabase(params.pixel_format, params.width, params.height);
     }
 
+    bool IsRSTrusted(const TSurface& surface) const {
+        const auto& params = surface->GetSurfaceParams();
+        return scaling_database.IsTrusted(params.pixel_format, params.width, params.height);
+    }
+
     bool CheckBlackListMatch() {
         u32 enabled_targets = 0;
         u32 black_listed = 0;
@@ -1139,8 +1350,17 @@ private:
         }
         if (rescaling) {
             if (rescaled_targets != enabled_targets) {
-                LOG_CRITICAL(HW_GPU,
-                             "Rescaling Database is incorrectly set! Rescan the database!.");
+                // Targets that are rendered together can't be rescaled on their own, stop trusting
+                // them so the next sessions leave them at native resolution
+                LOG_WARNING(HW_GPU, "Mixed rescaled render targets, blacklisting them");
+                for (const auto& target : render_targets) {
+                    if (target.target) {
+                        UnmarkScanner(target.target);
+                    }
+                }
+                if (depth_buffer.target) {
+                    UnmarkScanner(depth_buffer.target);
+                }
                 return false;
             }
             return true;
@@ -1161,6 +1381,14 @@ private:
 
     u64 ticks{};
 
+    // Set while the surfaces of a Fermi 2D copy are being looked up.
+    bool is_fermi_copy{};
+    std::array<u64, static_cast<std::size_t>(BlitFallback::Count)> blit_fallbacks{};
+
+    // Read by the session's telemetry from another thread.
+    std::atomic<u64> surface_lookups{};
+    std::atomic<u64> surface_misses{};
+
     // Guards the cache for protection conflicts.
     bool guard_render_targets{};
     bool guard_samplers{};
@@ -1174,9 +1402,7 @@ private:
     // The internal Cache is different for the Texture Cache. It's based on buckets
     // of 1MB. This fits better for the purpose of this cache as textures are normaly
     // large in size.
-    static constexpr u64 registry_page_bits{20};
-    static constexpr u64 registry_page_size{1 << registry_page_bits};
-    std::unordered_map<CacheAddr, std::vector<TSurface>> registry;
+    PageIndex<TSurface, 20> registry;
 
     static constexpr u32 DEPTH_RT = 8;
     static constexpr u32 NO_RT = 0xFFFFFFFF;
@@ -1195,6 +1421,15 @@ private:
 
     std::vector<TSurface> sampled_textures;
 
+    /// Registered surfaces with levels or layers written by the CPU that weren't uploaded yet
+    std::vector<TSurface> dirty_surfaces;
+
+    /// Every surface created by the cache, registered or in the reserve
+    std::vector<TSurface> resident_surfaces;
+    u64 resident_bytes{};
+    std::array<u64, static_cast<std::size_t>(PixelFormat::Max)> resident_bytes_per_format{};
+    u64 frame{};
+
     StagingCache staging_cache;
     std::recursive_mutex mutex;
 
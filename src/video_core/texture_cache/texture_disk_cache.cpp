@@ -0,0 +1,183 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "video_core/texture_cache/texture_disk_cache.h"
+
+namespace VideoCommon {
+
+namespace {
+
+/// Version of the index and texture files, bump it when the decoded format of any texture changes.
+constexpr u32 IndexVersion = 1;
+
+/// Textures are compressed on upload, speed matters more than the ratio.
+constexpr s32 CompressionLevel = 1;
+
+} // Anonymous namespace
+
+TextureDiskCache::TextureDiskCache(std::size_t budget)
+    : TextureDiskCache{FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "textures", budget} {}
+
+TextureDiskCache::TextureDiskCache(std::string base_dir, std::size_t budget)
+    : base_dir{std::move(base_dir)}, budget{budget} {
+    LoadIndex();
+}
+
+TextureDiskCache::~TextureDiskCache() {
+    SaveIndex();
+}
+
+bool TextureDiskCache::Load(u64 hash, u8* data, std::size_t size) {
+    const auto it = lookup.find(hash);
+    if (it == lookup.end()) {
+        return false;
+    }
+    FileUtil::IOFile file(GetPath(hash), "rb");
+    std::vector<u8> compressed(file.IsOpen() ? file.GetSize() : 0);
+    if (compressed.empty() || file.ReadBytes(compressed.data(), compressed.size()) !=
+                                  compressed.size()) {
+        Remove(hash);
+        return false;
+    }
+    const std::vector<u8> decompressed = Common::Compression::DecompressDataZSTD(compressed);
+    if (decompressed.size() != size) {
+        // Either corrupted or stored with a different host size, it will be saved again
+        Remove(hash);
+        return false;
+    }
+    std::memcpy(data, decompressed.data(), size);
+    Touch(it->second);
+    return true;
+}
+
+void TextureDiskCache::Save(u64 hash, const u8* data, std::size_t size) {
+    if (!is_directory_created) {
+        if (!FileUtil::CreateFullPath(base_dir + DIR_SEP)) {
+            LOG_ERROR(HW_GPU, "Failed to create directory={}", base_dir);
+            return;
+        }
+        is_directory_created = true;
+    }
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTD(data, size, CompressionLevel);
+    if (compressed.empty()) {
+        LOG_ERROR(HW_GPU, "Failed to compress texture {:016X}", hash);
+        return;
+    }
+    Remove(hash);
+
+    const std::string path = GetPath(hash);
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen() || file.WriteBytes(compressed.data(), compressed.size()) !=
+                              compressed.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write decoded texture to {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+        return;
+    }
+    resident_bytes += compressed.size();
+    entries.push_front({hash, compressed.size()});
+    lookup.emplace(hash, entries.begin());
+    Prune();
+}
+
+void TextureDiskCache::LoadIndex() {
+    if (!FileUtil::IsDirectory(base_dir)) {
+        return;
+    }
+    FileUtil::IOFile file(GetIndexPath(), "rb");
+    u32 version{};
+    if (file.IsOpen() &&
+        (file.ReadBytes(&version, sizeof(version)) != sizeof(version) || version != IndexVersion)) {
+        LOG_INFO(HW_GPU, "Texture disk cache is outdated, removing it");
+        file.Close();
+        FileUtil::DeleteDirRecursively(base_dir);
+        return;
+    }
+    is_directory_created = true;
+
+    const auto add_entry = [this](u64 hash) {
+        const std::string path = GetPath(hash);
+        if (lookup.count(hash) != 0 || !FileUtil::Exists(path)) {
+            return;
+        }
+        const std::size_t file_size = FileUtil::GetSize(path);
+        resident_bytes += file_size;
+        entries.push_back({hash, file_size});
+        lookup.emplace(hash, std::prev(entries.end()));
+    };
+    u64 hash{};
+    while (file.IsOpen() && file.ReadBytes(&hash, sizeof(hash)) == sizeof(hash)) {
+        add_entry(hash);
+    }
+
+    // Files written by a run that didn't save its index are used first when pruning
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, base_dir,
+        [&add_entry](u64*, const std::string&, const std::string& virtual_name) {
+            if (virtual_name.size() == 20 && virtual_name.compare(16, 4, ".bin") == 0) {
+                add_entry(std::strtoull(virtual_name.c_str(), nullptr, 16));
+            }
+            return true;
+        });
+
+    // The budget might have been lowered since the last run
+    Prune();
+}
+
+void TextureDiskCache::SaveIndex() const {
+    if (!is_directory_created) {
+        return;
+    }
+    FileUtil::IOFile file(GetIndexPath(), "wb");
+    if (!file.IsOpen() || file.WriteObject(IndexVersion) != 1) {
+        LOG_ERROR(HW_GPU, "Failed to write texture disk cache index");
+        return;
+    }
+    for (const Entry& entry : entries) {
+        file.WriteObject(entry.hash);
+    }
+}
+
+void TextureDiskCache::Touch(std::list<Entry>::iterator it) {
+    entries.splice(entries.begin(), entries, it);
+}
+
+void TextureDiskCache::Remove(u64 hash) {
+    const auto it = lookup.find(hash);
+    if (it == lookup.end()) {
+        return;
+    }
+    FileUtil::Delete(GetPath(hash));
+    resident_bytes -= it->second->file_size;
+    entries.erase(it->second);
+    lookup.erase(it);
+}
+
+void TextureDiskCache::Prune() {
+    while (resident_bytes > budget && !entries.empty()) {
+        Remove(entries.back().hash);
+    }
+}
+
+std::string TextureDiskCache::GetPath(u64 hash) const {
+    return fmt::format("{}" DIR_SEP "{:016X}.bin", base_dir, hash);
+}
+
+std::string TextureDiskCache::GetIndexPath() const {
+    return base_dir + DIR_SEP "index.bin";
+}
+
+} // namespace VideoCommon
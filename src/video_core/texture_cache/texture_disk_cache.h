@@ -0,0 +1,73 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "common/common_types.h"
+
+namespace VideoCommon {
+
+/**
+ * Stores decoded textures on disk by the hash of their guest contents and layout, so the cost of
+ * decoding a texture is only paid the first time it's seen. Each texture is a zstd compressed file
+ * of its own. The least recently used files are removed once the cache grows past its budget, the
+ * order of use is kept in an index file between runs.
+ */
+class TextureDiskCache {
+public:
+    /// Uses the texture cache directory under the user cache path.
+    explicit TextureDiskCache(std::size_t budget);
+    explicit TextureDiskCache(std::string base_dir, std::size_t budget);
+    ~TextureDiskCache();
+
+    /// Reads a stored texture into data, returns false when there is none of the given size.
+    bool Load(u64 hash, u8* data, std::size_t size);
+
+    /// Stores a texture, failures are logged and otherwise ignored.
+    void Save(u64 hash, const u8* data, std::size_t size);
+
+    /// Returns the compressed size of all stored textures.
+    std::size_t GetResidentBytes() const {
+        return resident_bytes;
+    }
+
+private:
+    struct Entry {
+        u64 hash;
+        std::size_t file_size;
+    };
+
+    /// Reads the index and the sizes of the files it lists.
+    void LoadIndex();
+
+    /// Writes the order of use of the stored textures.
+    void SaveIndex() const;
+
+    /// Moves an entry to the front, it becomes the last to be removed.
+    void Touch(std::list<Entry>::iterator it);
+
+    /// Removes an entry and its file.
+    void Remove(u64 hash);
+
+    /// Removes the least recently used textures until the cache fits in its budget.
+    void Prune();
+
+    std::string GetPath(u64 hash) const;
+    std::string GetIndexPath() const;
+
+    const std::string base_dir;
+    const std::size_t budget;
+    std::size_t resident_bytes = 0;
+    bool is_directory_created = false;
+
+    std::list<Entry> entries; ///< Most recently used first.
+    std::unordered_map<u64, std::list<Entry>::iterator> lookup;
+};
+
+} // namespace VideoCommon
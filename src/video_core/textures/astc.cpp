@@ -21,6 +21,10 @@
 #include <cstring>
 #include <vector>
 
+#include <boost/container/static_vector.hpp>
+
+#include "common/hash.h"
+#include "common/thread_pool.h"
 #include "video_core/textures/astc.h"
 
 class InputBitStream {
@@ -47,10 +51,21 @@ public:
     }
 
     unsigned int ReadBits(unsigned int nBits) {
+        // Take as many bits as possible from each byte instead of going bit by bit
         unsigned int ret = 0;
-        for (unsigned int i = 0; i < nBits; i++) {
-            ret |= (ReadBit() & 1) << i;
+        unsigned int nRead = 0;
+        while (nRead < nBits) {
+            const unsigned int nTake = std::min(8U - m_NextBit, nBits - nRead);
+            const unsigned int mask = (1U << nTake) - 1;
+            ret |= ((static_cast<unsigned int>(*m_CurByte) >> m_NextBit) & mask) << nRead;
+            nRead += nTake;
+            m_NextBit += nTake;
+            if (m_NextBit >= 8) {
+                m_NextBit -= 8;
+                m_CurByte++;
+            }
         }
+        m_BitsRead += nBits;
         return ret;
     }
 
@@ -146,6 +161,12 @@ private:
 
 enum EIntegerEncoding { eIntegerEncoding_JustBits, eIntegerEncoding_Quint, eIntegerEncoding_Trit };
 
+class IntegerEncodedValue;
+
+// A dual plane 12x12 weight grid, plus the values of a partially used trit block. Keeping these
+// on the stack avoids allocating memory for every decoded block.
+using IntegerEncodedVector = boost::container::static_vector<IntegerEncodedValue, 2 * 144 + 4>;
+
 class IntegerEncodedValue {
 private:
     const EIntegerEncoding m_Encoding;
@@ -158,7 +179,7 @@ private:
 
 public:
     // Jank, but we're not doing any heavy lifting in this class, so it's
-    // probably OK. It allows us to use these in std::vectors...
+    // probably OK. It allows us to use these in vectors...
     IntegerEncodedValue& operator=(const IntegerEncodedValue& other) {
         new (this) IntegerEncodedValue(other);
         return *this;
@@ -250,7 +271,7 @@ public:
     // Fills result with the values that are encoded in the given
     // bitstream. We must know beforehand what the maximum possible
     // value is, and how many values we're decoding.
-    static void DecodeIntegerSequence(std::vector<IntegerEncodedValue>& result,
+    static void DecodeIntegerSequence(IntegerEncodedVector& result,
                                       InputBitStream& bits, uint32_t maxRange, uint32_t nValues) {
         // Determine encoding parameters
         IntegerEncodedValue val = IntegerEncodedValue::CreateEncoding(maxRange);
@@ -279,7 +300,7 @@ public:
     }
 
 private:
-    static void DecodeTritBlock(InputBitStream& bits, std::vector<IntegerEncodedValue>& result,
+    static void DecodeTritBlock(InputBitStream& bits, IntegerEncodedVector& result,
                                 uint32_t nBitsPerValue) {
         // Implement the algorithm in section C.2.12
         uint32_t m[5];
@@ -339,7 +360,7 @@ private:
         }
     }
 
-    static void DecodeQuintBlock(InputBitStream& bits, std::vector<IntegerEncodedValue>& result,
+    static void DecodeQuintBlock(InputBitStream& bits, IntegerEncodedVector& result,
                                  uint32_t nBitsPerValue) {
         // Implement the algorithm in section C.2.12
         uint32_t m[3];
@@ -832,7 +853,7 @@ static void DecodeColorValues(uint32_t* out, uint8_t* data, const uint32_t* mode
     }
 
     // We now have enough to decode our integer sequence.
-    std::vector<IntegerEncodedValue> decodedColorValues;
+    IntegerEncodedVector decodedColorValues;
     InputBitStream colorStream(data);
     IntegerEncodedValue::DecodeIntegerSequence(decodedColorValues, colorStream, range, nValues);
 
@@ -1062,7 +1083,7 @@ static uint32_t UnquantizeTexelWeight(const IntegerEncodedValue& val) {
 }
 
 static void UnquantizeTexelWeights(uint32_t out[2][144],
-                                   const std::vector<IntegerEncodedValue>& weights,
+                                   const IntegerEncodedVector& weights,
                                    const TexelWeightParams& params, const uint32_t blockWidth,
                                    const uint32_t blockHeight) {
     uint32_t weightIdx = 0;
@@ -1560,7 +1581,7 @@ static void DecompressBlock(const uint8_t inBuf[16], const uint32_t blockWidth,
     texelWeightData[clearByteStart - 1] &= (1 << (weightParams.GetPackedBitSize() % 8)) - 1;
     memset(texelWeightData + clearByteStart, 0, 16 - clearByteStart);
 
-    std::vector<IntegerEncodedValue> texelWeightValues;
+    IntegerEncodedVector texelWeightValues;
     InputBitStream weightStream(texelWeightData);
 
     IntegerEncodedValue::DecodeIntegerSequence(texelWeightValues, weightStream,
@@ -1609,36 +1630,109 @@ static void DecompressBlock(const uint8_t inBuf[16], const uint32_t blockWidth,
 
 namespace Tegra::Texture::ASTC {
 
-std::vector<uint8_t> Decompress(const uint8_t* data, uint32_t width, uint32_t height,
-                                uint32_t depth, uint32_t block_width, uint32_t block_height) {
-    uint32_t blockIdx = 0;
-    std::size_t depth_offset = 0;
-    std::vector<uint8_t> outData(height * width * depth * 4);
-    for (uint32_t k = 0; k < depth; k++) {
-        for (uint32_t j = 0; j < height; j += block_height) {
-            for (uint32_t i = 0; i < width; i += block_width) {
-
-                const uint8_t* blockPtr = data + blockIdx * 16;
+/// Blocks below which it isn't worth to start another thread.
+constexpr uint32_t MinBlocksPerThread = 256;
+
+/// Decodes the rows of blocks in [first_row, last_row), counting rows through all the layers.
+static void DecompressRows(const uint8_t* data, uint32_t width, uint32_t height,
+                           uint32_t block_width, uint32_t block_height, uint32_t first_row,
+                           uint32_t last_row, uint8_t* out_data) {
+    const uint32_t blocks_per_row = (width + block_width - 1) / block_width;
+    const uint32_t rows_per_layer = (height + block_height - 1) / block_height;
+    const std::size_t layer_size = static_cast<std::size_t>(height) * width * 4;
+
+    for (uint32_t row = first_row; row < last_row; ++row) {
+        const uint32_t k = row / rows_per_layer;
+        const uint32_t j = (row % rows_per_layer) * block_height;
+        const uint8_t* blockPtr = data + static_cast<std::size_t>(row) * blocks_per_row * 16;
+        uint8_t* const layer_data = out_data + k * layer_size;
+        for (uint32_t i = 0; i < width; i += block_width) {
+            // Blocks can be at most 12x12
+            uint32_t uncompData[144];
+            ASTCC::DecompressBlock(blockPtr, block_width, block_height, uncompData);
+
+            uint32_t decompWidth = std::min(block_width, width - i);
+            uint32_t decompHeight = std::min(block_height, height - j);
+
+            uint8_t* outRow = layer_data + (j * width + i) * 4;
+            for (uint32_t jj = 0; jj < decompHeight; jj++) {
+                memcpy(outRow + jj * width * 4, uncompData + jj * block_width, decompWidth * 4);
+            }
 
-                // Blocks can be at most 12x12
-                uint32_t uncompData[144];
-                ASTCC::DecompressBlock(blockPtr, block_width, block_height, uncompData);
+            blockPtr += 16;
+        }
+    }
+}
 
-                uint32_t decompWidth = std::min(block_width, width - i);
-                uint32_t decompHeight = std::min(block_height, height - j);
+std::vector<uint8_t> Decompress(const uint8_t* data, uint32_t width, uint32_t height,
+                                uint32_t depth, uint32_t block_width, uint32_t block_height,
+                                uint32_t num_threads) {
+    std::vector<uint8_t> outData(height * width * depth * 4);
+    const uint32_t blocks_per_row = (width + block_width - 1) / block_width;
+    const uint32_t num_rows = (height + block_height - 1) / block_height * depth;
+    auto& pool = Common::GetThreadPool();
+    if (num_threads == 0) {
+        const auto max_threads = static_cast<uint32_t>(pool.GetNumWorkers() + 1);
+        const uint32_t num_blocks = blocks_per_row * num_rows;
+        num_threads = std::clamp(num_blocks / MinBlocksPerThread, 1U, max_threads);
+    }
+    num_threads = std::min(num_threads, std::max(num_rows, 1U));
+
+    // Blocks are independent from each other, each task decodes a range of rows
+    Common::TaskGroup group{pool};
+    for (uint32_t thread = 1; thread < num_threads; ++thread) {
+        const uint32_t first_row = num_rows * thread / num_threads;
+        const uint32_t last_row = num_rows * (thread + 1) / num_threads;
+        group.Submit([=, out = outData.data()] {
+            DecompressRows(data, width, height, block_width, block_height, first_row, last_row,
+                           out);
+        });
+    }
+    DecompressRows(data, width, height, block_width, block_height, 0, num_rows / num_threads,
+                   outData.data());
+    group.Wait();
 
-                uint8_t* outRow = depth_offset + outData.data() + (j * width + i) * 4;
-                for (uint32_t jj = 0; jj < decompHeight; jj++) {
-                    memcpy(outRow + jj * width * 4, uncompData + jj * block_width, decompWidth * 4);
-                }
+    return outData;
+}
 
-                blockIdx++;
-            }
+DecodeCache::DecodeCache(std::size_t capacity) : capacity{capacity} {}
+
+DecodeCache::~DecodeCache() = default;
+
+const std::vector<uint8_t>& DecodeCache::Decompress(const uint8_t* data, uint32_t width,
+                                                    uint32_t height, uint32_t depth,
+                                                    uint32_t block_width, uint32_t block_height) {
+    const std::size_t num_blocks = static_cast<std::size_t>((width + block_width - 1) /
+                                                            block_width) *
+                                   ((height + block_height - 1) / block_height) * depth;
+    const uint64_t hash = Common::ComputeFastHash64(data, num_blocks * 16);
+
+    const auto it = lookup.find(hash);
+    if (it != lookup.end()) {
+        const Entry& entry = *it->second;
+        if (entry.width == width && entry.height == height && entry.depth == depth &&
+            entry.block_width == block_width && entry.block_height == block_height) {
+            entries.splice(entries.begin(), entries, it->second);
+            return entries.front().decoded;
         }
-        depth_offset += height * width * 4;
+        resident_bytes -= entry.decoded.size();
+        entries.erase(it->second);
+        lookup.erase(it);
     }
 
-    return outData;
+    std::vector<uint8_t> decoded =
+        ASTC::Decompress(data, width, height, depth, block_width, block_height);
+    resident_bytes += decoded.size();
+    entries.push_front({hash, width, height, depth, block_width, block_height, std::move(decoded)});
+    lookup.emplace(hash, entries.begin());
+
+    // The entry just added is always kept, even when it's larger than the whole capacity
+    while (resident_bytes > capacity && entries.size() > 1) {
+        resident_bytes -= entries.back().decoded.size();
+        lookup.erase(entries.back().hash);
+        entries.pop_back();
+    }
+    return entries.front().decoded;
 }
 
 } // namespace Tegra::Texture::ASTC
@@ -4,12 +4,57 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <list>
+#include <unordered_map>
 #include <vector>
 
 namespace Tegra::Texture::ASTC {
 
+/**
+ * Decodes ASTC blocks into RGBA8. Rows of blocks are split between worker threads.
+ * @param num_threads Threads to decode with, 0 picks them from the hardware concurrency.
+ */
 std::vector<uint8_t> Decompress(const uint8_t* data, uint32_t width, uint32_t height,
-                                uint32_t depth, uint32_t block_width, uint32_t block_height);
+                                uint32_t depth, uint32_t block_width, uint32_t block_height,
+                                uint32_t num_threads = 0);
+
+/**
+ * Keeps recently decoded textures by the hash of their data, so textures that are uploaded again
+ * with the same contents skip decoding. The least recently used results are dropped once the
+ * decoded data outgrows the capacity.
+ */
+class DecodeCache {
+public:
+    explicit DecodeCache(std::size_t capacity);
+    ~DecodeCache();
+
+    /// Decodes like Decompress, the result is valid until the next call.
+    const std::vector<uint8_t>& Decompress(const uint8_t* data, uint32_t width, uint32_t height,
+                                           uint32_t depth, uint32_t block_width,
+                                           uint32_t block_height);
+
+    std::size_t GetResidentBytes() const {
+        return resident_bytes;
+    }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        uint32_t block_width;
+        uint32_t block_height;
+        std::vector<uint8_t> decoded;
+    };
+
+    const std::size_t capacity;
+    std::size_t resident_bytes = 0;
+
+    std::list<Entry> entries; ///< Most recently used first.
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> lookup;
+};
 
 } // namespace Tegra::Texture::ASTC
@@ -0,0 +1,179 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include "common/common_types.h"
+#include "video_core/textures/bc_encoder.h"
+
+namespace Tegra::Texture {
+
+namespace {
+
+constexpr u32 BlockSize = 4;
+constexpr std::size_t BC3BlockBytes = 16;
+
+using Block = std::array<std::array<u8, 4>, BlockSize * BlockSize>;
+
+/// Reads a block of texels, repeating the last row and column of the image past its edges.
+Block FetchBlock(const u8* layer, u32 width, u32 height, u32 x, u32 y) {
+    Block block;
+    for (u32 j = 0; j < BlockSize; ++j) {
+        const u32 row = std::min(y + j, height - 1);
+        for (u32 i = 0; i < BlockSize; ++i) {
+            const u32 column = std::min(x + i, width - 1);
+            std::memcpy(block[j * BlockSize + i].data(),
+                        layer + (static_cast<std::size_t>(row) * width + column) * 4, 4);
+        }
+    }
+    return block;
+}
+
+u16 PackRGB565(const std::array<u32, 3>& color) {
+    return static_cast<u16>(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+std::array<u32, 3> UnpackRGB565(u16 packed) {
+    const u32 r = (packed >> 11) & 0x1F;
+    const u32 g = (packed >> 5) & 0x3F;
+    const u32 b = packed & 0x1F;
+    return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+void EncodeAlpha(const Block& block, u8* out) {
+    u8 max_alpha = 0;
+    u8 min_alpha = 255;
+    for (const auto& texel : block) {
+        max_alpha = std::max(max_alpha, texel[3]);
+        min_alpha = std::min(min_alpha, texel[3]);
+    }
+    out[0] = max_alpha;
+    out[1] = min_alpha;
+
+    u64 indices = 0;
+    if (max_alpha != min_alpha) {
+        // With the first endpoint above the second, the palette has six interpolated values
+        std::array<u32, 8> palette;
+        palette[0] = max_alpha;
+        palette[1] = min_alpha;
+        for (u32 i = 2; i < 8; ++i) {
+            palette[i] = ((8 - i) * max_alpha + (i - 1) * min_alpha) / 7;
+        }
+        for (std::size_t texel = 0; texel < block.size(); ++texel) {
+            const u32 alpha = block[texel][3];
+            u32 best_index = 0;
+            u32 best_error = 256;
+            for (u32 i = 0; i < 8; ++i) {
+                const u32 error = alpha > palette[i] ? alpha - palette[i] : palette[i] - alpha;
+                if (error < best_error) {
+                    best_error = error;
+                    best_index = i;
+                }
+            }
+            indices |= u64{best_index} << (texel * 3);
+        }
+    }
+    for (u32 i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<u8>(indices >> (i * 8));
+    }
+}
+
+void EncodeColor(const Block& block, u8* out) {
+    std::array<u32, 3> max_color{0, 0, 0};
+    std::array<u32, 3> min_color{255, 255, 255};
+    for (const auto& texel : block) {
+        for (u32 c = 0; c < 3; ++c) {
+            max_color[c] = std::max<u32>(max_color[c], texel[c]);
+            min_color[c] = std::min<u32>(min_color[c], texel[c]);
+        }
+    }
+    // Pull the endpoints in a bit, the interpolated colors then cover the box better
+    for (u32 c = 0; c < 3; ++c) {
+        const u32 inset = (max_color[c] - min_color[c]) >> 4;
+        max_color[c] -= inset;
+        min_color[c] += inset;
+    }
+    // The endpoints are on the diagonal of the box the colors follow, green and blue are
+    // swapped when they decrease as red increases
+    std::array<s32, 3> covariance{};
+    for (const auto& texel : block) {
+        const s32 red = 2 * texel[0] - static_cast<s32>(max_color[0] + min_color[0]);
+        for (u32 c = 1; c < 3; ++c) {
+            covariance[c] += red * (2 * texel[c] - static_cast<s32>(max_color[c] + min_color[c]));
+        }
+    }
+    for (u32 c = 1; c < 3; ++c) {
+        if (covariance[c] < 0) {
+            std::swap(max_color[c], min_color[c]);
+        }
+    }
+
+    const u16 color0 = PackRGB565(max_color);
+    const u16 color1 = PackRGB565(min_color);
+    const std::array<u32, 3> endpoint0 = UnpackRGB565(color0);
+    const std::array<u32, 3> endpoint1 = UnpackRGB565(color1);
+    std::array<std::array<u32, 3>, 4> palette;
+    for (u32 c = 0; c < 3; ++c) {
+        palette[0][c] = endpoint0[c];
+        palette[1][c] = endpoint1[c];
+        palette[2][c] = (2 * endpoint0[c] + endpoint1[c]) / 3;
+        palette[3][c] = (endpoint0[c] + 2 * endpoint1[c]) / 3;
+    }
+
+    u32 indices = 0;
+    if (color0 != color1) {
+        for (std::size_t texel = 0; texel < block.size(); ++texel) {
+            u32 best_index = 0;
+            u32 best_error = ~0U;
+            for (u32 i = 0; i < 4; ++i) {
+                u32 error = 0;
+                for (u32 c = 0; c < 3; ++c) {
+                    const s32 delta = static_cast<s32>(block[texel][c]) - palette[i][c];
+                    error += static_cast<u32>(delta * delta);
+                }
+                if (error < best_error) {
+                    best_error = error;
+                    best_index = i;
+                }
+            }
+            indices |= best_index << (texel * 2);
+        }
+    }
+
+    out[0] = static_cast<u8>(color0);
+    out[1] = static_cast<u8>(color0 >> 8);
+    out[2] = static_cast<u8>(color1);
+    out[3] = static_cast<u8>(color1 >> 8);
+    for (u32 i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<u8>(indices >> (i * 8));
+    }
+}
+
+} // Anonymous namespace
+
+std::size_t GetBC3Size(u32 width, u32 height, u32 depth) {
+    const std::size_t blocks_x = (width + BlockSize - 1) / BlockSize;
+    const std::size_t blocks_y = (height + BlockSize - 1) / BlockSize;
+    return blocks_x * blocks_y * depth * BC3BlockBytes;
+}
+
+void EncodeBC3(const u8* rgba8, u32 width, u32 height, u32 depth, u8* out) {
+    const std::size_t layer_size = static_cast<std::size_t>(width) * height * 4;
+    for (u32 z = 0; z < depth; ++z) {
+        const u8* const layer = rgba8 + z * layer_size;
+        for (u32 y = 0; y < height; y += BlockSize) {
+            for (u32 x = 0; x < width; x += BlockSize) {
+                const Block block = FetchBlock(layer, width, height, x, y);
+                EncodeAlpha(block, out);
+                EncodeColor(block, out + 8);
+                out += BC3BlockBytes;
+            }
+        }
+    }
+}
+
+} // namespace Tegra::Texture
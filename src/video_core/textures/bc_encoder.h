@@ -0,0 +1,23 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Tegra::Texture {
+
+/// Returns the size in bytes of a BC3 image with the given dimensions.
+std::size_t GetBC3Size(u32 width, u32 height, u32 depth);
+
+/**
+ * Encodes RGBA8 texels into BC3 (DXT5) blocks. Endpoints are fitted to the bounding box of each
+ * block, trading some quality for an encoding fast enough to run on texture uploads.
+ * @param rgba8 Layers of width * height texels, 4 bytes each.
+ * @param out Buffer of at least GetBC3Size bytes.
+ */
+void EncodeBC3(const u8* rgba8, u32 width, u32 height, u32 depth, u8* out);
+
+} // namespace Tegra::Texture
@@ -14,12 +14,27 @@
 #include "video_core/textures/astc.h"
 #include "video_core/textures/convert.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
+
 namespace Tegra::Texture {
 
 using VideoCore::Surface::PixelFormat;
 
+namespace {
+
 template <bool reverse>
-void SwapS8Z24ToZ24S8(u8* data, u32 width, u32 height) {
+void SwapGeneric(u8* data, std::size_t num_pixels) {
     union S8Z24 {
         BitField<0, 24, u32> z24;
         BitField<24, 8, u32> s8;
@@ -36,45 +51,113 @@ void SwapS8Z24ToZ24S8(u8* data, u32 width, u32 height) {
     Z24S8 z24s8_pixel{};
     constexpr auto bpp{
         VideoCore::Surface::GetBytesPerPixel(VideoCore::Surface::PixelFormat::S8Z24)};
-    for (std::size_t y = 0; y < height; ++y) {
-        for (std::size_t x = 0; x < width; ++x) {
-            const std::size_t offset{bpp * (y * width + x)};
-            if constexpr (reverse) {
-                std::memcpy(&z24s8_pixel, &data[offset], sizeof(Z24S8));
-                s8z24_pixel.s8.Assign(z24s8_pixel.s8);
-                s8z24_pixel.z24.Assign(z24s8_pixel.z24);
-                std::memcpy(&data[offset], &s8z24_pixel, sizeof(S8Z24));
-            } else {
-                std::memcpy(&s8z24_pixel, &data[offset], sizeof(S8Z24));
-                z24s8_pixel.s8.Assign(s8z24_pixel.s8);
-                z24s8_pixel.z24.Assign(s8z24_pixel.z24);
-                std::memcpy(&data[offset], &z24s8_pixel, sizeof(Z24S8));
-            }
+    for (std::size_t i = 0; i < num_pixels; ++i) {
+        const std::size_t offset{bpp * i};
+        if constexpr (reverse) {
+            std::memcpy(&z24s8_pixel, &data[offset], sizeof(Z24S8));
+            s8z24_pixel.s8.Assign(z24s8_pixel.s8);
+            s8z24_pixel.z24.Assign(z24s8_pixel.z24);
+            std::memcpy(&data[offset], &s8z24_pixel, sizeof(S8Z24));
+        } else {
+            std::memcpy(&s8z24_pixel, &data[offset], sizeof(S8Z24));
+            z24s8_pixel.s8.Assign(s8z24_pixel.s8);
+            z24s8_pixel.z24.Assign(s8z24_pixel.z24);
+            std::memcpy(&data[offset], &z24s8_pixel, sizeof(Z24S8));
         }
     }
 }
 
-static void ConvertS8Z24ToZ24S8(u8* data, u32 width, u32 height) {
-    SwapS8Z24ToZ24S8<false>(data, width, height);
+// Moving the stencil between the high and the low byte rotates each pixel by 8 bits, the kernels
+// below return the number of pixels they converted and leave the rest to SwapGeneric
+
+#ifdef ARCHITECTURE_x86_64
+template <bool reverse>
+std::size_t SwapSSE2(u8* data, std::size_t num_pixels) {
+    std::size_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        auto* const pixels = reinterpret_cast<__m128i*>(data + i * sizeof(u32));
+        const __m128i value = _mm_loadu_si128(pixels);
+        const __m128i rotated =
+            reverse ? _mm_or_si128(_mm_srli_epi32(value, 8), _mm_slli_epi32(value, 24))
+                    : _mm_or_si128(_mm_slli_epi32(value, 8), _mm_srli_epi32(value, 24));
+        _mm_storeu_si128(pixels, rotated);
+    }
+    return i;
+}
+
+template <bool reverse>
+AVX2_TARGET std::size_t SwapAVX2(u8* data, std::size_t num_pixels) {
+    std::size_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        auto* const pixels = reinterpret_cast<__m256i*>(data + i * sizeof(u32));
+        const __m256i value = _mm256_loadu_si256(pixels);
+        const __m256i rotated =
+            reverse ? _mm256_or_si256(_mm256_srli_epi32(value, 8), _mm256_slli_epi32(value, 24))
+                    : _mm256_or_si256(_mm256_slli_epi32(value, 8), _mm256_srli_epi32(value, 24));
+        _mm256_storeu_si256(pixels, rotated);
+    }
+    return i;
+}
+#elif defined(ARCHITECTURE_ARM64)
+template <bool reverse>
+std::size_t SwapNEON(u8* data, std::size_t num_pixels) {
+    std::size_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        auto* const pixels = reinterpret_cast<u32*>(data + i * sizeof(u32));
+        const uint32x4_t value = vld1q_u32(pixels);
+        const uint32x4_t rotated = reverse ? vsriq_n_u32(vshlq_n_u32(value, 24), value, 8)
+                                           : vsriq_n_u32(vshlq_n_u32(value, 8), value, 24);
+        vst1q_u32(pixels, rotated);
+    }
+    return i;
+}
+#endif
+
+template <bool reverse>
+void SwapS8Z24(u8* data, std::size_t num_pixels, bool accelerated) {
+    std::size_t converted = 0;
+    if (accelerated) {
+#ifdef ARCHITECTURE_x86_64
+        static const bool has_avx2 = Common::GetCPUCaps().avx2;
+        converted = has_avx2 ? SwapAVX2<reverse>(data, num_pixels)
+                             : SwapSSE2<reverse>(data, num_pixels);
+#elif defined(ARCHITECTURE_ARM64)
+        converted = SwapNEON<reverse>(data, num_pixels);
+#endif
+    }
+    SwapGeneric<reverse>(data + converted * sizeof(u32), num_pixels - converted);
 }
 
-static void ConvertZ24S8ToS8Z24(u8* data, u32 width, u32 height) {
-    SwapS8Z24ToZ24S8<true>(data, width, height);
+} // Anonymous namespace
+
+void SwapS8Z24ToZ24S8(u8* data, std::size_t num_pixels, bool reverse, bool accelerated) {
+    if (reverse) {
+        SwapS8Z24<true>(data, num_pixels, accelerated);
+    } else {
+        SwapS8Z24<false>(data, num_pixels, accelerated);
+    }
 }
 
 void ConvertFromGuestToHost(u8* in_data, u8* out_data, PixelFormat pixel_format, u32 width,
-                            u32 height, u32 depth, bool convert_astc, bool convert_s8z24) {
+                            u32 height, u32 depth, bool convert_astc, bool convert_s8z24,
+                            ASTC::DecodeCache* astc_cache) {
     if (convert_astc && IsPixelFormatASTC(pixel_format)) {
         // Convert ASTC pixel formats to RGBA8, as most desktop GPUs do not support ASTC.
         u32 block_width{};
         u32 block_height{};
         std::tie(block_width, block_height) = GetASTCBlockSize(pixel_format);
+        if (astc_cache) {
+            const std::vector<u8>& rgba8_data = astc_cache->Decompress(
+                in_data, width, height, depth, block_width, block_height);
+            std::copy(rgba8_data.begin(), rgba8_data.end(), out_data);
+            return;
+        }
         const std::vector<u8> rgba8_data = Tegra::Texture::ASTC::Decompress(
             in_data, width, height, depth, block_width, block_height);
         std::copy(rgba8_data.begin(), rgba8_data.end(), out_data);
 
     } else if (convert_s8z24 && pixel_format == PixelFormat::S8Z24) {
-        Tegra::Texture::ConvertS8Z24ToZ24S8(in_data, width, height);
+        SwapS8Z24ToZ24S8(in_data, static_cast<std::size_t>(width) * height, false);
     }
 }
 
@@ -86,7 +169,7 @@ void ConvertFromHostToGuest(u8* data, PixelFormat pixel_format, u32 width, u32 h
         UNREACHABLE();
 
     } else if (convert_s8z24 && pixel_format == PixelFormat::S8Z24) {
-        Tegra::Texture::ConvertZ24S8ToS8Z24(data, width, height);
+        SwapS8Z24ToZ24S8(data, static_cast<std::size_t>(width) * height, true);
     }
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 
 namespace VideoCore::Surface {
@@ -12,11 +13,23 @@ enum class PixelFormat;
 
 namespace Tegra::Texture {
 
+namespace ASTC {
+class DecodeCache;
+}
+
+/// Converts guest data to the host format. ASTC results are looked up in astc_cache when it's set.
 void ConvertFromGuestToHost(u8* in_data, u8* out_data, VideoCore::Surface::PixelFormat pixel_format,
-                            u32 width, u32 height, u32 depth, bool convert_astc,
-                            bool convert_s8z24);
+                            u32 width, u32 height, u32 depth, bool convert_astc, bool convert_s8z24,
+                            ASTC::DecodeCache* astc_cache = nullptr);
 
 void ConvertFromHostToGuest(u8* data, VideoCore::Surface::PixelFormat pixel_format, u32 width,
                             u32 height, u32 depth, bool convert_astc, bool convert_s8z24);
 
+/**
+ * Moves the stencil of S8Z24 pixels to the low byte for Z24S8 in place, or back to the high byte
+ * when reverse is set. The accelerated path uses the SIMD kernels of the host, the other one is the
+ * reference they are tested against.
+ */
+void SwapS8Z24ToZ24S8(u8* data, std::size_t num_pixels, bool reverse, bool accelerated = true);
+
 } // namespace Tegra::Texture
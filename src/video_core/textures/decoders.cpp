@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <cstring>
+#include <type_traits>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "video_core/gpu.h"
@@ -51,17 +52,53 @@ constexpr u32 fast_swizzle_align = 16;
 constexpr auto legacy_swizzle_table = SwizzleTable<gob_size_y, gob_size_x, gob_size_z>();
 constexpr auto fast_swizzle_table = SwizzleTable<gob_size_y, 4, fast_swizzle_align>();
 
+/**
+ * Calls func with the bytes per pixel as an std::integral_constant for the sizes textures commonly
+ * use, so the element copies get a size known at compile time. Other sizes are passed as 0.
+ */
+template <typename Func>
+void DispatchBytesPerPixel(u32 bytes_per_pixel, Func&& func) {
+    switch (bytes_per_pixel) {
+    case 1:
+        return func(std::integral_constant<u32, 1>{});
+    case 2:
+        return func(std::integral_constant<u32, 2>{});
+    case 4:
+        return func(std::integral_constant<u32, 4>{});
+    case 8:
+        return func(std::integral_constant<u32, 8>{});
+    case 12:
+        return func(std::integral_constant<u32, 12>{});
+    case 16:
+        return func(std::integral_constant<u32, 16>{});
+    default:
+        return func(std::integral_constant<u32, 0>{});
+    }
+}
+
+/// Copies size bytes between the swizzled and the linear data, in the direction of the operation
+template <bool unswizzle>
+void CopyElement(u8* swizzled, u8* unswizzled, u32 size) {
+    if constexpr (unswizzle) {
+        std::memcpy(unswizzled, swizzled, size);
+    } else {
+        std::memcpy(swizzled, unswizzled, size);
+    }
+}
+
 /**
  * This function manages ALL the GOBs(Group of Bytes) Inside a single block.
  * Instead of going gob by gob, we map the coordinates inside a block and manage from
  * those. Block_Width is assumed to be 1.
+ * BPP is the bytes per pixel when known at compile time, 0 otherwise.
  */
-void PreciseProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const bool unswizzle,
-                         const u32 x_start, const u32 y_start, const u32 z_start, const u32 x_end,
-                         const u32 y_end, const u32 z_end, const u32 tile_offset,
-                         const u32 xy_block_size, const u32 layer_z, const u32 stride_x,
-                         const u32 bytes_per_pixel, const u32 out_bytes_per_pixel) {
-    std::array<u8*, 2> data_ptrs;
+template <bool unswizzle, u32 BPP>
+void PreciseProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const u32 x_start,
+                         const u32 y_start, const u32 z_start, const u32 x_end, const u32 y_end,
+                         const u32 z_end, const u32 tile_offset, const u32 xy_block_size,
+                         const u32 layer_z, const u32 stride_x, const u32 runtime_bytes_per_pixel,
+                         const u32 out_bytes_per_pixel) {
+    const u32 bytes_per_pixel = BPP != 0 ? BPP : runtime_bytes_per_pixel;
     u32 z_address = tile_offset;
 
     for (u32 z = z_start; z < z_end; z++) {
@@ -72,9 +109,8 @@ void PreciseProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, con
             for (u32 x = x_start; x < x_end; x++) {
                 const u32 swizzle_offset{y_address + table[x * bytes_per_pixel % gob_size_x]};
                 const u32 pixel_index{x * out_bytes_per_pixel + pixel_base};
-                data_ptrs[unswizzle] = swizzled_data + swizzle_offset;
-                data_ptrs[!unswizzle] = unswizzled_data + pixel_index;
-                std::memcpy(data_ptrs[0], data_ptrs[1], bytes_per_pixel);
+                CopyElement<unswizzle>(swizzled_data + swizzle_offset,
+                                       unswizzled_data + pixel_index, bytes_per_pixel);
             }
             pixel_base += stride_x;
             if ((y + 1) % gob_size_y == 0)
@@ -88,29 +124,43 @@ void PreciseProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, con
  * This function manages ALL the GOBs(Group of Bytes) Inside a single block.
  * Instead of going gob by gob, we map the coordinates inside a block and manage from
  * those. Block_Width is assumed to be 1.
+ * Rows are moved in 16 bytes pieces, whole GOB rows are copied without looking up the table.
  */
-void FastProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const bool unswizzle,
-                      const u32 x_start, const u32 y_start, const u32 z_start, const u32 x_end,
-                      const u32 y_end, const u32 z_end, const u32 tile_offset,
-                      const u32 xy_block_size, const u32 layer_z, const u32 stride_x,
-                      const u32 bytes_per_pixel, const u32 out_bytes_per_pixel) {
-    std::array<u8*, 2> data_ptrs;
+template <bool unswizzle>
+void FastProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const u32 x_start,
+                      const u32 y_start, const u32 z_start, const u32 x_end, const u32 y_end,
+                      const u32 z_end, const u32 tile_offset, const u32 xy_block_size,
+                      const u32 layer_z, const u32 stride_x, const u32 bytes_per_pixel,
+                      const u32 out_bytes_per_pixel) {
     u32 z_address = tile_offset;
     const u32 x_startb = x_start * bytes_per_pixel;
     const u32 x_endb = x_end * bytes_per_pixel;
+    const bool is_same_size = bytes_per_pixel == out_bytes_per_pixel;
+    const bool is_whole_row = is_same_size && x_startb % gob_size_x == 0 &&
+                              x_endb - x_startb == gob_size_x;
 
     for (u32 z = z_start; z < z_end; z++) {
         u32 y_address = z_address;
         u32 pixel_base = layer_z * z + y_start * stride_x;
         for (u32 y = y_start; y < y_end; y++) {
             const auto& table = fast_swizzle_table[y % gob_size_y];
-            for (u32 xb = x_startb; xb < x_endb; xb += fast_swizzle_align) {
-                const u32 swizzle_offset{y_address + table[(xb / fast_swizzle_align) % 4]};
-                const u32 out_x = xb * out_bytes_per_pixel / bytes_per_pixel;
-                const u32 pixel_index{out_x + pixel_base};
-                data_ptrs[unswizzle ? 1 : 0] = swizzled_data + swizzle_offset;
-                data_ptrs[unswizzle ? 0 : 1] = unswizzled_data + pixel_index;
-                std::memcpy(data_ptrs[0], data_ptrs[1], fast_swizzle_align);
+            if (is_whole_row) {
+                // The four pieces of a GOB row are contiguous in the linear data
+                u8* const swizzled_row = swizzled_data + y_address;
+                u8* const unswizzled_row = unswizzled_data + pixel_base + x_startb;
+                for (u32 piece = 0; piece < 4; ++piece) {
+                    CopyElement<unswizzle>(swizzled_row + table[piece],
+                                           unswizzled_row + piece * fast_swizzle_align,
+                                           fast_swizzle_align);
+                }
+            } else {
+                for (u32 xb = x_startb; xb < x_endb; xb += fast_swizzle_align) {
+                    const u32 swizzle_offset{y_address + table[(xb / fast_swizzle_align) % 4]};
+                    const u32 out_x = xb * out_bytes_per_pixel / bytes_per_pixel;
+                    const u32 pixel_index{out_x + pixel_base};
+                    CopyElement<unswizzle>(swizzled_data + swizzle_offset,
+                                           unswizzled_data + pixel_index, fast_swizzle_align);
+                }
             }
             pixel_base += stride_x;
             if ((y + 1) % gob_size_y == 0)
@@ -129,9 +179,9 @@ void FastProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const
  * Documentation for the memory layout and decoding can be found at:
  *  https://envytools.readthedocs.io/en/latest/hw/memory/g80-surface.html#blocklinear-surfaces
  */
-template <bool fast>
-void SwizzledData(u8* const swizzled_data, u8* const unswizzled_data, const bool unswizzle,
-                  const u32 width, const u32 height, const u32 depth, const u32 bytes_per_pixel,
+template <bool fast, bool unswizzle, u32 BPP>
+void SwizzledData(u8* const swizzled_data, u8* const unswizzled_data, const u32 width,
+                  const u32 height, const u32 depth, const u32 bytes_per_pixel,
                   const u32 out_bytes_per_pixel, const u32 block_height, const u32 block_depth,
                   const u32 width_spacing) {
     auto div_ceil = [](const u32 x, const u32 y) { return ((x + y - 1) / y); };
@@ -160,13 +210,15 @@ void SwizzledData(u8* const swizzled_data, u8* const unswizzled_data, const bool
                 const u32 x_start = xb * block_x_elements;
                 const u32 x_end = std::min(width, x_start + block_x_elements);
                 if constexpr (fast) {
-                    FastProcessBlock(swizzled_data, unswizzled_data, unswizzle, x_start, y_start,
-                                     z_start, x_end, y_end, z_end, tile_offset, xy_block_size,
-                                     layer_z, stride_x, bytes_per_pixel, out_bytes_per_pixel);
+                    FastProcessBlock<unswizzle>(swizzled_data, unswizzled_data, x_start, y_start,
+                                                z_start, x_end, y_end, z_end, tile_offset,
+                                                xy_block_size, layer_z, stride_x, bytes_per_pixel,
+                                                out_bytes_per_pixel);
                 } else {
-                    PreciseProcessBlock(swizzled_data, unswizzled_data, unswizzle, x_start, y_start,
-                                        z_start, x_end, y_end, z_end, tile_offset, xy_block_size,
-                                        layer_z, stride_x, bytes_per_pixel, out_bytes_per_pixel);
+                    PreciseProcessBlock<unswizzle, BPP>(
+                        swizzled_data, unswizzled_data, x_start, y_start, z_start, x_end, y_end,
+                        z_end, tile_offset, xy_block_size, layer_z, stride_x, bytes_per_pixel,
+                        out_bytes_per_pixel);
                 }
                 tile_offset += block_size;
             }
@@ -174,19 +226,36 @@ void SwizzledData(u8* const swizzled_data, u8* const unswizzled_data, const bool
     }
 }
 
+template <bool unswizzle>
+void CopySwizzledData(u32 width, u32 height, u32 depth, u32 bytes_per_pixel,
+                      u32 out_bytes_per_pixel, u8* const swizzled_data, u8* const unswizzled_data,
+                      u32 block_height_size, u32 block_depth_size, u32 width_spacing) {
+    if (bytes_per_pixel % 3 != 0 && (width * bytes_per_pixel) % fast_swizzle_align == 0) {
+        SwizzledData<true, unswizzle, 0>(swizzled_data, unswizzled_data, width, height, depth,
+                                         bytes_per_pixel, out_bytes_per_pixel, block_height_size,
+                                         block_depth_size, width_spacing);
+        return;
+    }
+    DispatchBytesPerPixel(bytes_per_pixel, [&](auto bpp) {
+        SwizzledData<false, unswizzle, decltype(bpp)::value>(
+            swizzled_data, unswizzled_data, width, height, depth, bytes_per_pixel,
+            out_bytes_per_pixel, block_height_size, block_depth_size, width_spacing);
+    });
+}
+
 void CopySwizzledData(u32 width, u32 height, u32 depth, u32 bytes_per_pixel,
                       u32 out_bytes_per_pixel, u8* const swizzled_data, u8* const unswizzled_data,
                       bool unswizzle, u32 block_height, u32 block_depth, u32 width_spacing) {
     const u32 block_height_size{1U << block_height};
     const u32 block_depth_size{1U << block_depth};
-    if (bytes_per_pixel % 3 != 0 && (width * bytes_per_pixel) % fast_swizzle_align == 0) {
-        SwizzledData<true>(swizzled_data, unswizzled_data, unswizzle, width, height, depth,
-                           bytes_per_pixel, out_bytes_per_pixel, block_height_size,
-                           block_depth_size, width_spacing);
+    if (unswizzle) {
+        CopySwizzledData<true>(width, height, depth, bytes_per_pixel, out_bytes_per_pixel,
+                               swizzled_data, unswizzled_data, block_height_size,
+                               block_depth_size, width_spacing);
     } else {
-        SwizzledData<false>(swizzled_data, unswizzled_data, unswizzle, width, height, depth,
-                            bytes_per_pixel, out_bytes_per_pixel, block_height_size,
-                            block_depth_size, width_spacing);
+        CopySwizzledData<false>(width, height, depth, bytes_per_pixel, out_bytes_per_pixel,
+                                swizzled_data, unswizzled_data, block_height_size,
+                                block_depth_size, width_spacing);
     }
 }
 
@@ -255,50 +324,52 @@ std::vector<u8> UnswizzleTexture(u8* address, u32 tile_size_x, u32 tile_size_y,
     return unswizzled_data;
 }
 
-void SwizzleSubrect(u32 subrect_width, u32 subrect_height, u32 source_pitch, u32 swizzled_width,
-                    u32 bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data,
-                    u32 block_height_bit, u32 offset_x, u32 offset_y) {
+template <bool unswizzle, u32 BPP>
+void CopySubrect(u32 subrect_width, u32 subrect_height, u32 pitch, u32 swizzled_width,
+                 u32 runtime_bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data,
+                 u32 block_height_bit, u32 offset_x, u32 offset_y) {
+    const u32 bytes_per_pixel = BPP != 0 ? BPP : runtime_bytes_per_pixel;
     const u32 block_height = 1U << block_height_bit;
-    const u32 image_width_in_gobs{(swizzled_width * bytes_per_pixel + (gob_size_x - 1)) /
-                                  gob_size_x};
+    // Unswizzled subrects have historically assumed a single GOB wide image
+    const u32 image_width_in_gobs{
+        unswizzle ? 1 : (swizzled_width * bytes_per_pixel + (gob_size_x - 1)) / gob_size_x};
     for (u32 line = 0; line < subrect_height; ++line) {
         const u32 dst_y = line + offset_y;
         const u32 gob_address_y =
             (dst_y / (gob_size_y * block_height)) * gob_size * block_height * image_width_in_gobs +
             ((dst_y % (gob_size_y * block_height)) / gob_size_y) * gob_size;
         const auto& table = legacy_swizzle_table[dst_y % gob_size_y];
+        u8* const line_data = unswizzled_data + line * pitch;
         for (u32 x = 0; x < subrect_width; ++x) {
-            const u32 dst_x = x + offset_x;
-            const u32 gob_address =
-                gob_address_y + (dst_x * bytes_per_pixel / gob_size_x) * gob_size * block_height;
-            const u32 swizzled_offset = gob_address + table[(dst_x * bytes_per_pixel) % gob_size_x];
-            u8* source_line = unswizzled_data + line * source_pitch + x * bytes_per_pixel;
-            u8* dest_addr = swizzled_data + swizzled_offset;
-
-            std::memcpy(dest_addr, source_line, bytes_per_pixel);
+            const u32 dst_x = (x + offset_x) * bytes_per_pixel;
+            const u32 gob_address = gob_address_y + (dst_x / gob_size_x) * gob_size * block_height;
+            const u32 swizzled_offset = gob_address + table[dst_x % gob_size_x];
+            CopyElement<unswizzle>(swizzled_data + swizzled_offset,
+                                   line_data + x * bytes_per_pixel, bytes_per_pixel);
         }
     }
 }
 
+void SwizzleSubrect(u32 subrect_width, u32 subrect_height, u32 source_pitch, u32 swizzled_width,
+                    u32 bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data,
+                    u32 block_height_bit, u32 offset_x, u32 offset_y) {
+    DispatchBytesPerPixel(bytes_per_pixel, [&](auto bpp) {
+        CopySubrect<false, decltype(bpp)::value>(subrect_width, subrect_height, source_pitch,
+                                                 swizzled_width, bytes_per_pixel, swizzled_data,
+                                                 unswizzled_data, block_height_bit, offset_x,
+                                                 offset_y);
+    });
+}
+
 void UnswizzleSubrect(u32 subrect_width, u32 subrect_height, u32 dest_pitch, u32 swizzled_width,
                       u32 bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data,
                       u32 block_height_bit, u32 offset_x, u32 offset_y) {
-    const u32 block_height = 1U << block_height_bit;
-    for (u32 line = 0; line < subrect_height; ++line) {
-        const u32 y2 = line + offset_y;
-        const u32 gob_address_y = (y2 / (gob_size_y * block_height)) * gob_size * block_height +
-                                  ((y2 % (gob_size_y * block_height)) / gob_size_y) * gob_size;
-        const auto& table = legacy_swizzle_table[y2 % gob_size_y];
-        for (u32 x = 0; x < subrect_width; ++x) {
-            const u32 x2 = (x + offset_x) * bytes_per_pixel;
-            const u32 gob_address = gob_address_y + (x2 / gob_size_x) * gob_size * block_height;
-            const u32 swizzled_offset = gob_address + table[x2 % gob_size_x];
-            u8* dest_line = unswizzled_data + line * dest_pitch + x * bytes_per_pixel;
-            u8* source_addr = swizzled_data + swizzled_offset;
-
-            std::memcpy(dest_line, source_addr, bytes_per_pixel);
-        }
-    }
+    DispatchBytesPerPixel(bytes_per_pixel, [&](auto bpp) {
+        CopySubrect<true, decltype(bpp)::value>(subrect_width, subrect_height, dest_pitch,
+                                                swizzled_width, bytes_per_pixel, swizzled_data,
+                                                unswizzled_data, block_height_bit, offset_x,
+                                                offset_y);
+    });
 }
 
 void SwizzleKepler(const u32 width, const u32 height, const u32 dst_x, const u32 dst_y,
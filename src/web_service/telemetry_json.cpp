@@ -3,7 +3,6 @@
 // Refer to the license.txt file included.
 
 #include <json.hpp>
-#include "common/detached_tasks.h"
 #include "common/web_result.h"
 #include "web_service/telemetry_json.h"
 #include "web_service/web_backend.h"
@@ -105,11 +104,8 @@ void TelemetryJson::Complete() {
     impl->SerializeSection(Telemetry::FieldType::UserConfig, "UserConfig");
     impl->SerializeSection(Telemetry::FieldType::UserSystem, "UserSystem");
 
-    auto content = impl->TopSection().dump();
-    // Send the telemetry async but don't handle the errors since they were written to the log
-    Common::DetachedTasks::AddTask([host{impl->host}, content]() {
-        Client{host, "", ""}.PostJson("/telemetry", content, true);
-    });
+    // Sent in the background, the result doesn't matter since errors were written to the log
+    PostJsonAsync(impl->host, "", "", "/telemetry", impl->TopSection().dump(), true);
 }
 
 bool TelemetryJson::SubmitTestcase() {
@@ -118,10 +114,9 @@ bool TelemetryJson::SubmitTestcase() {
     impl->SerializeSection(Telemetry::FieldType::UserFeedback, "UserFeedback");
     impl->SerializeSection(Telemetry::FieldType::UserSystem, "UserSystem");
 
-    auto content = impl->TopSection().dump();
-    Client client(impl->host, impl->username, impl->token);
-    auto value = client.PostJson("/gamedb/testcase", content, false);
-
+    auto value = PostJsonAsync(impl->host, impl->username, impl->token, "/gamedb/testcase",
+                               impl->TopSection().dump(), false)
+                     .get();
     return value.result_code == Common::WebResult::Code::Success;
 }
 
@@ -2,13 +2,21 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 #include <LUrlParser.h>
 #include <httplib.h>
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "common/web_result.h"
 #include "web_service/web_backend.h"
 
@@ -21,6 +29,13 @@ constexpr u32 HTTPS_PORT = 443;
 
 constexpr u32 TIMEOUT_SECONDS = 30;
 
+/// Submissions waiting to be sent, new ones are dropped past this
+constexpr std::size_t MAX_QUEUED_SUBMISSIONS = 32;
+/// Clients kept alive for reuse, one per host and credentials
+constexpr std::size_t MAX_POOLED_CLIENTS = 4;
+/// Time the queued submissions get to go out when the program exits
+constexpr std::chrono::milliseconds SHUTDOWN_BUDGET{1500};
+
 struct Client::Impl {
     Impl(std::string host, std::string username, std::string token)
         : host{std::move(host)}, username{std::move(username)}, token{std::move(token)} {
@@ -192,4 +207,140 @@ Common::WebResult Client::DeleteJson(const std::string& path, const std::string&
     return impl->GenericJson("DELETE", path, data, allow_anonymous);
 }
 
+namespace {
+
+class SubmissionQueue {
+public:
+    SubmissionQueue() : state{std::make_shared<State>()} {
+        worker = std::thread(&SubmissionQueue::WorkerThread, state);
+    }
+
+    ~SubmissionQueue() {
+        std::unique_lock lock{state->mutex};
+        state->quit = true;
+        state->cv.notify_all();
+
+        // Requests can't be interrupted, a worker stuck on the network is left behind. It owns the
+        // state it uses and won't start anything new.
+        if (state->cv.wait_for(lock, SHUTDOWN_BUDGET, [this] { return state->is_done; })) {
+            lock.unlock();
+            worker.join();
+            return;
+        }
+        state->is_abandoned = true;
+        for (auto& submission : state->queue) {
+            submission.result.set_value(Abandoned());
+        }
+        state->queue.clear();
+        lock.unlock();
+        worker.detach();
+    }
+
+    std::future<Common::WebResult> Push(std::string host, std::string username,
+                                        std::string token, std::string path, std::string data,
+                                        bool allow_anonymous) {
+        Submission submission{std::move(host), std::move(username), std::move(token),
+                              std::move(path), std::move(data),     allow_anonymous};
+        auto future = submission.result.get_future();
+
+        std::lock_guard lock{state->mutex};
+        if (state->queue.size() >= MAX_QUEUED_SUBMISSIONS) {
+            LOG_WARNING(WebService, "Submission queue is full, dropping POST to {}",
+                        submission.host + submission.path);
+            submission.result.set_value(
+                Common::WebResult{Common::WebResult::Code::LibError, "Submission queue is full"});
+            return future;
+        }
+        state->queue.push_back(std::move(submission));
+        state->cv.notify_all();
+        return future;
+    }
+
+private:
+    struct Submission {
+        std::string host;
+        std::string username;
+        std::string token;
+        std::string path;
+        std::string data;
+        bool allow_anonymous;
+        std::promise<Common::WebResult> result;
+    };
+
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Submission> queue;
+        bool quit = false;
+        bool is_done = false;
+        bool is_abandoned = false;
+    };
+
+    static Common::WebResult Abandoned() {
+        return Common::WebResult{Common::WebResult::Code::LibError, "Abandoned at exit"};
+    }
+
+    static void WorkerThread(std::shared_ptr<State> state) {
+        Common::SetCurrentThreadName("yuzu:WebService");
+
+        using ClientKey = std::tuple<std::string, std::string, std::string>;
+        std::map<ClientKey, std::unique_ptr<Client>> clients;
+        std::vector<Submission> batch;
+        while (true) {
+            {
+                std::unique_lock lock{state->mutex};
+                state->cv.wait(lock, [&state] { return state->quit || !state->queue.empty(); });
+                if (state->queue.empty() || state->is_abandoned) {
+                    state->is_done = true;
+                    state->cv.notify_all();
+                    return;
+                }
+                // Take everything that piled up, it goes out back to back on the same clients
+                batch.assign(std::make_move_iterator(state->queue.begin()),
+                             std::make_move_iterator(state->queue.end()));
+                state->queue.clear();
+            }
+
+            for (auto& submission : batch) {
+                if (IsAbandoned(*state)) {
+                    submission.result.set_value(Abandoned());
+                    continue;
+                }
+                ClientKey key{submission.host, submission.username, submission.token};
+                auto it = clients.find(key);
+                if (it == clients.end()) {
+                    if (clients.size() >= MAX_POOLED_CLIENTS) {
+                        clients.clear();
+                    }
+                    auto client = std::make_unique<Client>(submission.host, submission.username,
+                                                           submission.token);
+                    it = clients.emplace(std::move(key), std::move(client)).first;
+                }
+                submission.result.set_value(it->second->PostJson(
+                    submission.path, submission.data, submission.allow_anonymous));
+            }
+            batch.clear();
+        }
+    }
+
+    static bool IsAbandoned(State& state) {
+        std::lock_guard lock{state.mutex};
+        return state.is_abandoned;
+    }
+
+    std::shared_ptr<State> state;
+    std::thread worker;
+};
+
+} // Anonymous namespace
+
+std::future<Common::WebResult> PostJsonAsync(std::string host, std::string username,
+                                             std::string token, std::string path,
+                                             std::string data, bool allow_anonymous) {
+    // Started on first use, so that it's torn down before the logger at exit
+    static SubmissionQueue queue;
+    return queue.Push(std::move(host), std::move(username), std::move(token), std::move(path),
+                      std::move(data), allow_anonymous);
+}
+
 } // namespace WebService
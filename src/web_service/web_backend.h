@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
 
@@ -51,4 +52,21 @@ private:
     std::unique_ptr<Impl> impl;
 };
 
+/**
+ * Queues JSON to be posted to the specified path from the background submission thread, callers
+ * never wait on the network. Submissions are sent in order, in batches through clients that are
+ * kept between requests. The queue is bounded, and at program exit whatever couldn't be sent
+ * within a short time budget is abandoned.
+ * @param host the address of the web service.
+ * @param username yuzu username to use for authentication.
+ * @param token yuzu token to use for authentication.
+ * @param path the URL segment after the host address.
+ * @param data String of JSON data to use for the body of the POST request.
+ * @param allow_anonymous If true, allow anonymous unauthenticated requests.
+ * @return the result of the request, LibError when it was dropped or abandoned.
+ */
+std::future<Common::WebResult> PostJsonAsync(std::string host, std::string username,
+                                             std::string token, std::string path,
+                                             std::string data, bool allow_anonymous);
+
 } // namespace WebService
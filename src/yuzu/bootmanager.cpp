@@ -6,10 +6,10 @@
 #include <QHBoxLayout>
 #include <QKeyEvent>
 #include <QOffscreenSurface>
-#include <QOpenGLWindow>
-#include <QPainter>
+#include <QOpenGLContext>
 #include <QScreen>
 #include <QWindow>
+#include <QtConcurrent/QtConcurrentRun>
 #include <fmt/format.h>
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
@@ -29,7 +29,9 @@ EmuThread::EmuThread(GRenderWindow* render_window) : render_window(render_window
 EmuThread::~EmuThread() = default;
 
 void EmuThread::run() {
-    render_window->MakeCurrent();
+    // The window context belongs to the presentation thread, rendering uses the renderer's own
+    auto& context = Core::System::GetInstance().Renderer().GetRenderContext();
+    context.MakeCurrent();
 
     MicroProfileOnThreadCreate("EmuThread");
 
@@ -44,7 +46,7 @@ void EmuThread::run() {
 
     if (Settings::values.use_asynchronous_gpu_emulation) {
         // Release OpenGL context for the GPU thread
-        render_window->DoneCurrent();
+        context.DoneCurrent();
     }
 
     // Holds whether the cpu was running during the last iteration,
@@ -93,14 +95,16 @@ void EmuThread::run() {
 
 class GGLContext : public Core::Frontend::GraphicsContext {
 public:
-    explicit GGLContext(QOpenGLContext* shared_context) : shared_context{shared_context} {
+    /// Shared contexts are made current on the render window, they only ever draw to framebuffer
+    /// objects so they never get in the way of the presentation.
+    explicit GGLContext(QOpenGLContext* shared_context, QSurface* surface) : surface{surface} {
         context.setFormat(shared_context->format());
         context.setShareContext(shared_context);
         context.create();
     }
 
     void MakeCurrent() override {
-        context.makeCurrent(shared_context->surface());
+        context.makeCurrent(surface);
     }
 
     void DoneCurrent() override {
@@ -110,24 +114,22 @@ public:
     void SwapBuffers() override {}
 
 private:
-    QOpenGLContext* shared_context;
+    QSurface* surface;
     QOpenGLContext context;
 };
 
-// This class overrides paintEvent and resizeEvent to prevent the GUI thread from stealing GL
-// context.
-// The corresponding functionality is handled in EmuThread instead
-class GGLWidgetInternal : public QOpenGLWindow {
+// A plain OpenGL window, unlike QOpenGLWindow the GUI thread never makes a context current on it
+// or swaps its buffers. Frames are presented by the renderer's presentation thread instead, so a
+// busy event loop doesn't hold up rendering.
+class GGLWidgetInternal : public QWindow {
 public:
-    GGLWidgetInternal(GRenderWindow* parent, QOpenGLContext* shared_context)
-        : QOpenGLWindow(shared_context), parent(parent) {}
-
-    void paintEvent(QPaintEvent* ev) override {
-        if (do_painting) {
-            QPainter painter(this);
-        }
+    GGLWidgetInternal(GRenderWindow* parent, const QSurfaceFormat& format) : parent(parent) {
+        setSurfaceType(QWindow::OpenGLSurface);
+        setFormat(format);
     }
 
+    void exposeEvent(QExposeEvent* ev) override {}
+
     void resizeEvent(QResizeEvent* ev) override {
         parent->OnClientAreaResized(ev->size().width(), ev->size().height());
         parent->OnFramebufferSizeChanged();
@@ -174,17 +176,8 @@ public:
             InputCommon::GetMotionEmu()->EndTilt();
     }
 
-    void DisablePainting() {
-        do_painting = false;
-    }
-
-    void EnablePainting() {
-        do_painting = true;
-    }
-
 private:
     GRenderWindow* parent;
-    bool do_painting;
 };
 
 GRenderWindow::GRenderWindow(GMainWindow* parent, EmuThread* emu_thread)
@@ -249,8 +242,8 @@ void GRenderWindow::OnFramebufferSizeChanged() {
     // Screen changes potentially incur a change in screen DPI, hence we should update the
     // framebuffer size
     const qreal pixel_ratio = GetWindowPixelRatio();
-    const u32 width = child->QPaintDevice::width() * pixel_ratio;
-    const u32 height = child->QPaintDevice::height() * pixel_ratio;
+    const u32 width = child->width() * pixel_ratio;
+    const u32 height = child->height() * pixel_ratio;
     UpdateCurrentFramebufferLayout(width, height);
 }
 
@@ -360,7 +353,7 @@ void GRenderWindow::OnClientAreaResized(u32 width, u32 height) {
 }
 
 std::unique_ptr<Core::Frontend::GraphicsContext> GRenderWindow::CreateSharedContext() const {
-    return std::make_unique<GGLContext>(context.get());
+    return std::make_unique<GGLContext>(context.get(), child);
 }
 
 void GRenderWindow::InitRenderTarget() {
@@ -392,9 +385,8 @@ void GRenderWindow::InitRenderTarget() {
     context->setShareContext(shared_context.get());
     context->setFormat(fmt);
     context->create();
-    fmt.setSwapInterval(0);
 
-    child = new GGLWidgetInternal(this, shared_context.get());
+    child = new GGLWidgetInternal(this, fmt);
     container = QWidget::createWindowContainer(child, this);
 
     QBoxLayout* layout = new QHBoxLayout(this);
@@ -433,13 +425,17 @@ void GRenderWindow::CaptureScreenshot(u32 res_scale, const QString& screenshot_p
     screenshot_image = QImage(QSize(layout.width, layout.height), QImage::Format_RGB32);
     renderer.RequestScreenshot(
         screenshot_image.bits(),
-        [=] {
-            const std::string std_screenshot_path = screenshot_path.toStdString();
-            if (screenshot_image.mirrored(false, true).save(screenshot_path)) {
-                LOG_INFO(Frontend, "Screenshot saved to \"{}\"", std_screenshot_path);
-            } else {
-                LOG_ERROR(Frontend, "Failed to save screenshot to \"{}\"", std_screenshot_path);
-            }
+        [this, screenshot_path] {
+            // Encode on a worker thread, the callback runs on the GPU thread
+            QtConcurrent::run([image = screenshot_image, screenshot_path] {
+                const std::string std_screenshot_path = screenshot_path.toStdString();
+                if (image.mirrored(false, true).save(screenshot_path)) {
+                    LOG_INFO(Frontend, "Screenshot saved to \"{}\"", std_screenshot_path);
+                } else {
+                    LOG_ERROR(Frontend, "Failed to save screenshot to \"{}\"",
+                              std_screenshot_path);
+                }
+            });
         },
         layout);
 }
@@ -450,12 +446,10 @@ void GRenderWindow::OnMinimalClientAreaChangeRequest(std::pair<u32, u32> minimal
 
 void GRenderWindow::OnEmulationStarting(EmuThread* emu_thread) {
     this->emu_thread = emu_thread;
-    child->DisablePainting();
 }
 
 void GRenderWindow::OnEmulationStopping() {
     emu_thread = nullptr;
-    child->EnablePainting();
 }
 
 void GRenderWindow::showEvent(QShowEvent* event) {
@@ -171,7 +171,8 @@ private:
     QByteArray geometry;
 
     EmuThread* emu_thread;
-    // Context that backs the GGLWidgetInternal (and will be used by core to render)
+    // Context that backs the GGLWidgetInternal, the renderer presents frames with it from its own
+    // thread
     std::unique_ptr<QOpenGLContext> context;
     // Context that will be shared between all newly created contexts. This should never be made
     // current
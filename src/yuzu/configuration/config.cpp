@@ -211,7 +211,8 @@ const std::array<int, Settings::NativeKeyboard::NumKeyboardMods> Config::default
 // This must be in alphabetical order according to action name as it must have the same order as
 // UISetting::values.shortcuts, which is alphabetically ordered.
 // clang-format off
-const std::array<UISettings::Shortcut, 15> default_hotkeys{{
+const std::array<UISettings::Shortcut, 16> default_hotkeys{{
+    {QStringLiteral("Capture GPU Profile"),      QStringLiteral("Main Window"), {QStringLiteral("Ctrl+Shift+P"), Qt::ApplicationShortcut}},
     {QStringLiteral("Capture Screenshot"),       QStringLiteral("Main Window"), {QStringLiteral("Ctrl+P"), Qt::ApplicationShortcut}},
     {QStringLiteral("Continue/Pause Emulation"), QStringLiteral("Main Window"), {QStringLiteral("F4"), Qt::WindowShortcut}},
     {QStringLiteral("Decrease Speed Limit"),     QStringLiteral("Main Window"), {QStringLiteral("-"), Qt::ApplicationShortcut}},
@@ -406,6 +407,8 @@ void Config::ReadAudioValues() {
                                    .toStdString();
     Settings::values.enable_audio_stretching =
         ReadSetting(QStringLiteral("enable_audio_stretching"), true).toBool();
+    Settings::values.use_linear_audio_resampling =
+        ReadSetting(QStringLiteral("use_linear_audio_resampling"), false).toBool();
     Settings::values.audio_device_id =
         ReadSetting(QStringLiteral("output_device"), QStringLiteral("auto"))
             .toString()
@@ -437,6 +440,23 @@ void Config::ReadCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     Settings::values.use_multi_core = ReadSetting(QStringLiteral("use_multi_core"), false).toBool();
+    Settings::values.use_parallel_cpu =
+        ReadSetting(QStringLiteral("use_parallel_cpu"), false).toBool();
+    Settings::values.use_cpu_load_balancing =
+        ReadSetting(QStringLiteral("use_cpu_load_balancing"), false).toBool();
+    Settings::values.use_shared_jit_cache =
+        ReadSetting(QStringLiteral("use_shared_jit_cache"), false).toBool();
+    Settings::values.use_native_libc_functions =
+        ReadSetting(QStringLiteral("use_native_libc_functions"), false).toBool();
+    Settings::values.use_host_clock = ReadSetting(QStringLiteral("use_host_clock"), false).toBool();
+    Settings::values.cpu_thread_affinity =
+        ReadSetting(QStringLiteral("cpu_thread_affinity"), 0).toULongLong();
+    Settings::values.gpu_thread_affinity =
+        ReadSetting(QStringLiteral("gpu_thread_affinity"), 0).toULongLong();
+    Settings::values.audio_thread_affinity =
+        ReadSetting(QStringLiteral("audio_thread_affinity"), 0).toULongLong();
+    Settings::values.use_high_thread_priority =
+        ReadSetting(QStringLiteral("use_high_thread_priority"), false).toBool();
 
     qt_config->endGroup();
 }
@@ -445,6 +465,8 @@ void Config::ReadDataStorageValues() {
     qt_config->beginGroup(QStringLiteral("Data Storage"));
 
     Settings::values.use_virtual_sd = ReadSetting(QStringLiteral("use_virtual_sd"), true).toBool();
+    Settings::values.cache_decrypted_nca_sections =
+        ReadSetting(QStringLiteral("cache_decrypted_nca_sections"), false).toBool();
     FileUtil::GetUserPath(
         FileUtil::UserPath::NANDDir,
         qt_config
@@ -512,6 +534,14 @@ void Config::ReadDebuggingValues() {
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     Settings::values.record_frame_times =
         qt_config->value(QStringLiteral("record_frame_times"), false).toBool();
+    Settings::values.record_input_latency =
+        qt_config->value(QStringLiteral("record_input_latency"), false).toBool();
+    Settings::values.profile_guest_code =
+        qt_config->value(QStringLiteral("profile_guest_code"), false).toBool();
+    Settings::values.record_session_telemetry =
+        qt_config->value(QStringLiteral("record_session_telemetry"), false).toBool();
+    Settings::values.record_ipc_statistics =
+        qt_config->value(QStringLiteral("record_ipc_statistics"), false).toBool();
     Settings::values.use_gdbstub = ReadSetting(QStringLiteral("use_gdbstub"), false).toBool();
     Settings::values.gdbstub_port = ReadSetting(QStringLiteral("gdbstub_port"), 24689).toInt();
     Settings::values.program_args =
@@ -624,10 +654,24 @@ void Config::ReadRendererValues() {
         ReadSetting(QStringLiteral("use_accurate_gpu_emulation"), false).toBool();
     Settings::values.use_asynchronous_gpu_emulation =
         ReadSetting(QStringLiteral("use_asynchronous_gpu_emulation"), false).toBool();
+    Settings::values.use_asynchronous_shaders =
+        ReadSetting(QStringLiteral("use_asynchronous_shaders"), false).toBool();
+    Settings::values.texture_cache_budget_mb =
+        ReadSetting(QStringLiteral("texture_cache_budget_mb"), 0).toUInt();
+    Settings::values.use_gpu_texture_swizzle =
+        ReadSetting(QStringLiteral("use_gpu_texture_swizzle"), false).toBool();
+    Settings::values.use_bindless_textures =
+        ReadSetting(QStringLiteral("use_bindless_textures"), false).toBool();
+    Settings::values.transcode_astc_textures =
+        ReadSetting(QStringLiteral("transcode_astc_textures"), false).toBool();
     Settings::values.use_resolution_scanner =
         ReadSetting(QStringLiteral("use_resolution_scanner"), false).toBool();
     Settings::values.force_30fps_mode =
         ReadSetting(QStringLiteral("force_30fps_mode"), false).toBool();
+    Settings::values.use_frame_smoothing =
+        ReadSetting(QStringLiteral("use_frame_smoothing"), false).toBool();
+    Settings::values.uncap_composition_rate =
+        ReadSetting(QStringLiteral("uncap_composition_rate"), false).toBool();
 
     Settings::values.bg_red = ReadSetting(QStringLiteral("bg_red"), 0.0).toFloat();
     Settings::values.bg_green = ReadSetting(QStringLiteral("bg_green"), 0.0).toFloat();
@@ -892,6 +936,8 @@ void Config::SaveAudioValues() {
                  QStringLiteral("auto"));
     WriteSetting(QStringLiteral("enable_audio_stretching"),
                  Settings::values.enable_audio_stretching, true);
+    WriteSetting(QStringLiteral("use_linear_audio_resampling"),
+                 Settings::values.use_linear_audio_resampling, false);
     WriteSetting(QStringLiteral("output_device"),
                  QString::fromStdString(Settings::values.audio_device_id), QStringLiteral("auto"));
     WriteSetting(QStringLiteral("volume"), Settings::values.volume, 1.0f);
@@ -919,6 +965,22 @@ void Config::SaveCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     WriteSetting(QStringLiteral("use_multi_core"), Settings::values.use_multi_core, false);
+    WriteSetting(QStringLiteral("use_parallel_cpu"), Settings::values.use_parallel_cpu, false);
+    WriteSetting(QStringLiteral("use_cpu_load_balancing"), Settings::values.use_cpu_load_balancing,
+                 false);
+    WriteSetting(QStringLiteral("use_shared_jit_cache"), Settings::values.use_shared_jit_cache,
+                 false);
+    WriteSetting(QStringLiteral("use_native_libc_functions"),
+                 Settings::values.use_native_libc_functions, false);
+    WriteSetting(QStringLiteral("use_host_clock"), Settings::values.use_host_clock, false);
+    WriteSetting(QStringLiteral("cpu_thread_affinity"),
+                 QVariant::fromValue<quint64>(Settings::values.cpu_thread_affinity), 0);
+    WriteSetting(QStringLiteral("gpu_thread_affinity"),
+                 QVariant::fromValue<quint64>(Settings::values.gpu_thread_affinity), 0);
+    WriteSetting(QStringLiteral("audio_thread_affinity"),
+                 QVariant::fromValue<quint64>(Settings::values.audio_thread_affinity), 0);
+    WriteSetting(QStringLiteral("use_high_thread_priority"),
+                 Settings::values.use_high_thread_priority, false);
 
     qt_config->endGroup();
 }
@@ -927,6 +989,8 @@ void Config::SaveDataStorageValues() {
     qt_config->beginGroup(QStringLiteral("Data Storage"));
 
     WriteSetting(QStringLiteral("use_virtual_sd"), Settings::values.use_virtual_sd, true);
+    WriteSetting(QStringLiteral("cache_decrypted_nca_sections"),
+                 Settings::values.cache_decrypted_nca_sections, false);
     WriteSetting(QStringLiteral("nand_directory"),
                  QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)),
                  QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)));
@@ -967,6 +1031,13 @@ void Config::SaveDebuggingValues() {
 
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     qt_config->setValue(QStringLiteral("record_frame_times"), Settings::values.record_frame_times);
+    qt_config->setValue(QStringLiteral("record_input_latency"),
+                        Settings::values.record_input_latency);
+    qt_config->setValue(QStringLiteral("profile_guest_code"), Settings::values.profile_guest_code);
+    qt_config->setValue(QStringLiteral("record_session_telemetry"),
+                        Settings::values.record_session_telemetry);
+    qt_config->setValue(QStringLiteral("record_ipc_statistics"),
+                        Settings::values.record_ipc_statistics);
     WriteSetting(QStringLiteral("use_gdbstub"), Settings::values.use_gdbstub, false);
     WriteSetting(QStringLiteral("gdbstub_port"), Settings::values.gdbstub_port, 24689);
     WriteSetting(QStringLiteral("program_args"),
@@ -1049,9 +1120,23 @@ void Config::SaveRendererValues() {
                  Settings::values.use_accurate_gpu_emulation, false);
     WriteSetting(QStringLiteral("use_asynchronous_gpu_emulation"),
                  Settings::values.use_asynchronous_gpu_emulation, false);
+    WriteSetting(QStringLiteral("use_asynchronous_shaders"),
+                 Settings::values.use_asynchronous_shaders, false);
+    WriteSetting(QStringLiteral("texture_cache_budget_mb"),
+                 Settings::values.texture_cache_budget_mb, 0);
+    WriteSetting(QStringLiteral("use_gpu_texture_swizzle"),
+                 Settings::values.use_gpu_texture_swizzle, false);
+    WriteSetting(QStringLiteral("use_bindless_textures"), Settings::values.use_bindless_textures,
+                 false);
+    WriteSetting(QStringLiteral("transcode_astc_textures"),
+                 Settings::values.transcode_astc_textures, false);
     WriteSetting(QStringLiteral("use_resolution_scanner"), Settings::values.use_resolution_scanner,
                  false);
     WriteSetting(QStringLiteral("force_30fps_mode"), Settings::values.force_30fps_mode, false);
+    WriteSetting(QStringLiteral("use_frame_smoothing"), Settings::values.use_frame_smoothing,
+                 false);
+    WriteSetting(QStringLiteral("uncap_composition_rate"),
+                 Settings::values.uncap_composition_rate, false);
 
     // Cast to double because Qt's written float values are not human-readable
     WriteSetting(QStringLiteral("bg_red"), static_cast<double>(Settings::values.bg_red), 0.0);
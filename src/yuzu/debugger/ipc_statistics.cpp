@@ -0,0 +1,133 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <set>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include "core/hle/service/service.h"
+#include "core/settings.h"
+#include "yuzu/debugger/ipc_statistics.h"
+
+namespace {
+
+enum Column { Name, Calls, TotalTime, MeanTime, Histogram, NumColumns };
+
+constexpr int RefreshIntervalMs = 1000;
+
+QString FormatHistogram(const std::array<u64, Service::NumIPCTimeBuckets>& histogram) {
+    QStringList buckets;
+    for (std::size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        if (histogram[bucket] == 0) {
+            continue;
+        }
+        const QString limit = bucket + 1 == histogram.size()
+                                  ? QStringLiteral(">%1us").arg(1U << (bucket - 1))
+                                  : QStringLiteral("<%1us").arg(1U << bucket);
+        buckets.push_back(QStringLiteral("%1: %2").arg(limit).arg(histogram[bucket]));
+    }
+    return buckets.join(QStringLiteral(", "));
+}
+
+void SetTimes(QTreeWidgetItem* item, u64 call_count, u64 host_time_ns) {
+    // Numbers rather than text, so columns are sorted by value
+    item->setData(Calls, Qt::DisplayRole, static_cast<qulonglong>(call_count));
+    item->setData(TotalTime, Qt::DisplayRole, host_time_ns / 1e6);
+    if (call_count != 0) {
+        item->setData(MeanTime, Qt::DisplayRole, host_time_ns / 1e3 / call_count);
+    }
+}
+
+} // Anonymous namespace
+
+IPCStatisticsWidget::IPCStatisticsWidget(QWidget* parent)
+    : QDockWidget(tr("IPC Statistics"), parent) {
+    setObjectName(QStringLiteral("IPCStatisticsWidget"));
+
+    tree = new QTreeWidget;
+    tree->setColumnCount(NumColumns);
+    tree->setHeaderLabels({tr("Command"), tr("Calls"), tr("Total Time (ms)"),
+                           tr("Mean Time (us)"), tr("Time Histogram")});
+    tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    tree->setSortingEnabled(true);
+    tree->sortByColumn(TotalTime, Qt::DescendingOrder);
+
+    auto* const reset_button = new QPushButton(tr("Reset"));
+    connect(reset_button, &QPushButton::clicked, this, [this] {
+        Service::ResetIPCStatistics();
+        Refresh();
+    });
+
+    auto* const layout = new QVBoxLayout;
+    layout->addWidget(tree);
+    layout->addWidget(reset_button);
+    auto* const main_widget = new QWidget;
+    main_widget->setLayout(layout);
+    setWidget(main_widget);
+
+    refresh_timer = new QTimer(this);
+    connect(refresh_timer, &QTimer::timeout, this, &IPCStatisticsWidget::Refresh);
+}
+
+IPCStatisticsWidget::~IPCStatisticsWidget() = default;
+
+void IPCStatisticsWidget::showEvent(QShowEvent* event) {
+    Refresh();
+    refresh_timer->start(RefreshIntervalMs);
+    QDockWidget::showEvent(event);
+}
+
+void IPCStatisticsWidget::hideEvent(QHideEvent* event) {
+    refresh_timer->stop();
+    QDockWidget::hideEvent(event);
+}
+
+void IPCStatisticsWidget::Refresh() {
+    std::set<QString> expanded;
+    for (int i = 0; i < tree->topLevelItemCount(); ++i) {
+        const QTreeWidgetItem* const item = tree->topLevelItem(i);
+        if (item->isExpanded()) {
+            expanded.insert(item->text(Name));
+        }
+    }
+
+    tree->setSortingEnabled(false);
+    tree->clear();
+    if (!Settings::values.record_ipc_statistics) {
+        auto* const item = new QTreeWidgetItem(tree);
+        item->setText(Name, tr("Enable record_ipc_statistics in the Debugging section of the "
+                               "configuration file to record statistics"));
+        item->setFirstColumnSpanned(true);
+    }
+
+    QTreeWidgetItem* service_item = nullptr;
+    u64 service_calls = 0;
+    u64 service_time_ns = 0;
+    for (const auto& entry : Service::GetIPCStatistics()) {
+        const QString service_name = QString::fromStdString(entry.service_name);
+        if (service_item == nullptr || service_item->text(Name) != service_name) {
+            service_item = new QTreeWidgetItem(tree);
+            service_item->setText(Name, service_name);
+            service_calls = 0;
+            service_time_ns = 0;
+        }
+        auto* const item = new QTreeWidgetItem(service_item);
+        item->setText(Name, QStringLiteral("%1 (%2)")
+                                .arg(QString::fromUtf8(entry.command_name.c_str()))
+                                .arg(entry.command_id));
+        SetTimes(item, entry.call_count, entry.host_time_ns);
+        item->setText(Histogram, FormatHistogram(entry.histogram));
+
+        service_calls += entry.call_count;
+        service_time_ns += entry.host_time_ns;
+        SetTimes(service_item, service_calls, service_time_ns);
+    }
+    for (int i = 0; i < tree->topLevelItemCount(); ++i) {
+        QTreeWidgetItem* const item = tree->topLevelItem(i);
+        item->setExpanded(expanded.count(item->text(Name)) != 0);
+    }
+    tree->setSortingEnabled(true);
+}
@@ -0,0 +1,32 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <QDockWidget>
+
+class QHideEvent;
+class QShowEvent;
+class QTimer;
+class QTreeWidget;
+
+/// Shows the calls to each service command and the host time spent handling them.
+class IPCStatisticsWidget : public QDockWidget {
+    Q_OBJECT
+
+public:
+    explicit IPCStatisticsWidget(QWidget* parent = nullptr);
+    ~IPCStatisticsWidget() override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    /// Reads the statistics again, keeping the services the user expanded open.
+    void Refresh();
+
+    QTreeWidget* tree = nullptr;
+    QTimer* refresh_timer = nullptr;
+};
@@ -0,0 +1,77 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include "common/memory_accounting.h"
+#include "yuzu/debugger/memory_usage.h"
+
+namespace {
+
+enum Column { Name, Current, Peak, NumColumns };
+
+constexpr int RefreshIntervalMs = 1000;
+
+void SetSizes(QTreeWidgetItem* item, u64 current_bytes, u64 peak_bytes) {
+    // Numbers rather than text, so columns are sorted by value
+    item->setData(Current, Qt::DisplayRole, current_bytes / 1048576.0);
+    item->setData(Peak, Qt::DisplayRole, peak_bytes / 1048576.0);
+}
+
+} // Anonymous namespace
+
+MemoryUsageWidget::MemoryUsageWidget(QWidget* parent) : QDockWidget(tr("Memory Usage"), parent) {
+    setObjectName(QStringLiteral("MemoryUsageWidget"));
+
+    tree = new QTreeWidget;
+    tree->setColumnCount(NumColumns);
+    tree->setHeaderLabels({tr("Subsystem"), tr("Current (MiB)"), tr("Peak (MiB)")});
+    tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    tree->setRootIsDecorated(false);
+    tree->setSortingEnabled(true);
+    tree->sortByColumn(Current, Qt::DescendingOrder);
+
+    total_label = new QLabel;
+
+    auto* const layout = new QVBoxLayout;
+    layout->addWidget(tree);
+    layout->addWidget(total_label);
+    auto* const main_widget = new QWidget;
+    main_widget->setLayout(layout);
+    setWidget(main_widget);
+
+    refresh_timer = new QTimer(this);
+    connect(refresh_timer, &QTimer::timeout, this, &MemoryUsageWidget::Refresh);
+}
+
+MemoryUsageWidget::~MemoryUsageWidget() = default;
+
+void MemoryUsageWidget::showEvent(QShowEvent* event) {
+    Refresh();
+    refresh_timer->start(RefreshIntervalMs);
+    QDockWidget::showEvent(event);
+}
+
+void MemoryUsageWidget::hideEvent(QHideEvent* event) {
+    refresh_timer->stop();
+    QDockWidget::hideEvent(event);
+}
+
+void MemoryUsageWidget::Refresh() {
+    tree->setSortingEnabled(false);
+    tree->clear();
+    u64 total_bytes = 0;
+    for (const auto& usage : Common::MemoryAccounting::GetStatistics()) {
+        auto* const item = new QTreeWidgetItem(tree);
+        item->setText(Name, QString::fromUtf8(usage.name));
+        SetSizes(item, usage.current_bytes, usage.peak_bytes);
+        total_bytes += usage.current_bytes;
+    }
+    // Peaks of the subsystems are reached at different times, only current sizes add up
+    total_label->setText(tr("Total: %1 MiB").arg(total_bytes / 1048576.0, 0, 'f', 1));
+    tree->setSortingEnabled(true);
+}
@@ -0,0 +1,33 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <QDockWidget>
+
+class QHideEvent;
+class QLabel;
+class QShowEvent;
+class QTimer;
+class QTreeWidget;
+
+/// Shows the host memory accounted to each subsystem.
+class MemoryUsageWidget : public QDockWidget {
+    Q_OBJECT
+
+public:
+    explicit MemoryUsageWidget(QWidget* parent = nullptr);
+    ~MemoryUsageWidget() override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void Refresh();
+
+    QTreeWidget* tree = nullptr;
+    QLabel* total_label = nullptr;
+    QTimer* refresh_timer = nullptr;
+};
@@ -2,11 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "yuzu/debugger/wait_tree.h"
 #include "yuzu/util/util.h"
 
 #include "common/assert.h"
 #include "core/core.h"
+#include "core/core_cpu.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/process.h"
@@ -29,15 +33,20 @@ std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeItem::GetChildren() const {
 
 void WaitTreeItem::Expand() {
     if (IsExpandable() && !expanded) {
-        children = GetChildren();
-        for (std::size_t i = 0; i < children.size(); ++i) {
-            children[i]->parent = this;
-            children[i]->row = i;
-        }
+        SetChildren(GetChildren());
         expanded = true;
     }
 }
 
+void WaitTreeItem::SetChildren(std::vector<std::unique_ptr<WaitTreeItem>> new_children) {
+    children = std::move(new_children);
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        children[i]->parent = this;
+        children[i]->row = i;
+        children[i]->UpdateCache();
+    }
+}
+
 WaitTreeItem* WaitTreeItem::Parent() const {
     return parent;
 }
@@ -54,24 +63,17 @@ std::size_t WaitTreeItem::Row() const {
     return row;
 }
 
-std::vector<std::unique_ptr<WaitTreeThread>> WaitTreeItem::MakeThreadItemList() {
-    std::vector<std::unique_ptr<WaitTreeThread>> item_list;
-    std::size_t row = 0;
-    auto add_threads = [&](const std::vector<Kernel::SharedPtr<Kernel::Thread>>& threads) {
-        for (std::size_t i = 0; i < threads.size(); ++i) {
-            item_list.push_back(std::make_unique<WaitTreeThread>(*threads[i]));
-            item_list.back()->row = row;
-            ++row;
-        }
-    };
+void WaitTreeItem::UpdateCache() {
+    cached_text = GetText();
+    cached_color = GetColor();
+}
 
-    const auto& system = Core::System::GetInstance();
-    add_threads(system.Scheduler(0).GetThreadList());
-    add_threads(system.Scheduler(1).GetThreadList());
-    add_threads(system.Scheduler(2).GetThreadList());
-    add_threads(system.Scheduler(3).GetThreadList());
+const QString& WaitTreeItem::CachedText() const {
+    return cached_text;
+}
 
-    return item_list;
+const QColor& WaitTreeItem::CachedColor() const {
+    return cached_color;
 }
 
 WaitTreeText::WaitTreeText(QString t) : text(std::move(t)) {}
@@ -135,9 +137,14 @@ std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeCallstack::GetChildren() cons
     return list;
 }
 
-WaitTreeWaitObject::WaitTreeWaitObject(const Kernel::WaitObject& o) : object(o) {}
+WaitTreeWaitObject::WaitTreeWaitObject(const Kernel::WaitObject& o)
+    : object(o), object_id(o.GetObjectId()) {}
 WaitTreeWaitObject::~WaitTreeWaitObject() = default;
 
+u32 WaitTreeWaitObject::GetObjectId() const {
+    return object_id;
+}
+
 WaitTreeExpandableItem::WaitTreeExpandableItem() = default;
 WaitTreeExpandableItem::~WaitTreeExpandableItem() = default;
 
@@ -166,11 +173,11 @@ std::unique_ptr<WaitTreeWaitObject> WaitTreeWaitObject::make(const Kernel::WaitO
 std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeWaitObject::GetChildren() const {
     std::vector<std::unique_ptr<WaitTreeItem>> list;
 
-    const auto& threads = object.GetWaitingThreads();
+    auto threads = object.GetWaitingThreads();
     if (threads.empty()) {
         list.push_back(std::make_unique<WaitTreeText>(tr("waited by no thread")));
     } else {
-        list.push_back(std::make_unique<WaitTreeThreadList>(threads));
+        list.push_back(std::make_unique<WaitTreeThreadList>(std::move(threads)));
     }
     return list;
 }
@@ -349,8 +356,8 @@ std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeEvent::GetChildren() const {
     return list;
 }
 
-WaitTreeThreadList::WaitTreeThreadList(const std::vector<Kernel::SharedPtr<Kernel::Thread>>& list)
-    : thread_list(list) {}
+WaitTreeThreadList::WaitTreeThreadList(std::vector<Kernel::SharedPtr<Kernel::Thread>> list)
+    : thread_list(std::move(list)) {}
 WaitTreeThreadList::~WaitTreeThreadList() = default;
 
 QString WaitTreeThreadList::GetText() const {
@@ -373,7 +380,9 @@ QModelIndex WaitTreeModel::index(int row, int column, const QModelIndex& parent)
 
     if (parent.isValid()) {
         WaitTreeItem* parent_item = static_cast<WaitTreeItem*>(parent.internalPointer());
-        parent_item->Expand();
+        if (kernel_readable) {
+            parent_item->Expand();
+        }
         return createIndex(row, column, parent_item->Children()[row].get());
     }
 
@@ -396,7 +405,9 @@ int WaitTreeModel::rowCount(const QModelIndex& parent) const {
         return static_cast<int>(thread_items.size());
 
     WaitTreeItem* parent_item = static_cast<WaitTreeItem*>(parent.internalPointer());
-    parent_item->Expand();
+    if (kernel_readable) {
+        parent_item->Expand();
+    }
     return static_cast<int>(parent_item->Children().size());
 }
 
@@ -410,20 +421,94 @@ QVariant WaitTreeModel::data(const QModelIndex& index, int role) const {
 
     switch (role) {
     case Qt::DisplayRole:
-        return static_cast<WaitTreeItem*>(index.internalPointer())->GetText();
+        return static_cast<WaitTreeItem*>(index.internalPointer())->CachedText();
     case Qt::ForegroundRole:
-        return static_cast<WaitTreeItem*>(index.internalPointer())->GetColor();
+        return static_cast<WaitTreeItem*>(index.internalPointer())->CachedColor();
     default:
         return {};
     }
 }
 
-void WaitTreeModel::ClearItems() {
-    thread_items.clear();
+void WaitTreeModel::RefreshItems() {
+    kernel_readable = true;
+
+    std::vector<const Kernel::Thread*> threads;
+    std::unordered_map<u32, const Kernel::Thread*> threads_by_id;
+    const auto& system = Core::System::GetInstance();
+    for (std::size_t core = 0; core < Core::NUM_CPU_CORES; ++core) {
+        for (const auto& thread : system.Scheduler(core).GetThreadList()) {
+            threads.push_back(thread.get());
+            threads_by_id.emplace(thread->GetObjectId(), thread.get());
+        }
+    }
+
+    // Object IDs are never reused, an item whose ID is gone refers to a thread that was destroyed
+    for (std::size_t row = thread_items.size(); row-- > 0;) {
+        if (threads_by_id.count(thread_items[row]->GetObjectId()) != 0) {
+            continue;
+        }
+        beginRemoveRows({}, static_cast<int>(row), static_cast<int>(row));
+        thread_items.erase(thread_items.begin() + row);
+        endRemoveRows();
+    }
+
+    std::unordered_set<u32> known_ids;
+    for (std::size_t row = 0; row < thread_items.size(); ++row) {
+        WaitTreeThread& item = *thread_items[row];
+        item.row = row;
+        known_ids.insert(item.GetObjectId());
+        RefreshChildren(item, createIndex(static_cast<int>(row), 0, &item));
+    }
+    if (!thread_items.empty()) {
+        emit dataChanged(createIndex(0, 0, thread_items.front().get()),
+                         createIndex(static_cast<int>(thread_items.size() - 1), 0,
+                                     thread_items.back().get()));
+    }
+
+    std::vector<std::unique_ptr<WaitTreeThread>> new_items;
+    for (const Kernel::Thread* thread : threads) {
+        if (known_ids.count(thread->GetObjectId()) == 0) {
+            new_items.push_back(std::make_unique<WaitTreeThread>(*thread));
+        }
+    }
+    if (new_items.empty()) {
+        return;
+    }
+    const std::size_t first_row = thread_items.size();
+    beginInsertRows({}, static_cast<int>(first_row),
+                    static_cast<int>(first_row + new_items.size() - 1));
+    for (auto& item : new_items) {
+        item->row = thread_items.size();
+        item->UpdateCache();
+        thread_items.push_back(std::move(item));
+    }
+    endInsertRows();
+}
+
+void WaitTreeModel::FreezeItems() {
+    kernel_readable = false;
 }
 
-void WaitTreeModel::InitItems() {
-    thread_items = WaitTreeItem::MakeThreadItemList();
+void WaitTreeModel::RefreshChildren(WaitTreeItem& item, const QModelIndex& index) {
+    item.UpdateCache();
+    if (!item.expanded) {
+        return;
+    }
+
+    // The children may refer to objects destroyed since the last refresh, they are only dropped
+    if (!item.children.empty()) {
+        beginRemoveRows(index, 0, static_cast<int>(item.children.size() - 1));
+        item.children.clear();
+        endRemoveRows();
+    }
+
+    auto children = item.GetChildren();
+    if (children.empty()) {
+        return;
+    }
+    beginInsertRows(index, 0, static_cast<int>(children.size() - 1));
+    item.SetChildren(std::move(children));
+    endInsertRows();
 }
 
 WaitTreeWidget::WaitTreeWidget(QWidget* parent) : QDockWidget(tr("Wait Tree"), parent) {
@@ -439,15 +524,13 @@ WaitTreeWidget::~WaitTreeWidget() = default;
 void WaitTreeWidget::OnDebugModeEntered() {
     if (!Core::System::GetInstance().IsPoweredOn())
         return;
-    model->InitItems();
-    view->setModel(model);
+    model->RefreshItems();
     setEnabled(true);
 }
 
 void WaitTreeWidget::OnDebugModeLeft() {
     setEnabled(false);
-    view->setModel(nullptr);
-    model->ClearItems();
+    model->FreezeItems();
 }
 
 void WaitTreeWidget::OnEmulationStarting(EmuThread* emu_thread) {
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include <QAbstractItemModel>
+#include <QColor>
 #include <QDockWidget>
 #include <QTreeView>
 #include "common/common_types.h"
@@ -23,6 +24,7 @@ class WaitObject;
 class Thread;
 } // namespace Kernel
 
+class WaitTreeModel;
 class WaitTreeThread;
 
 class WaitTreeItem : public QObject {
@@ -40,13 +42,23 @@ public:
     WaitTreeItem* Parent() const;
     const std::vector<std::unique_ptr<WaitTreeItem>>& Children() const;
     std::size_t Row() const;
-    static std::vector<std::unique_ptr<WaitTreeThread>> MakeThreadItemList();
+
+    /// Reads the text and color from the kernel state, the model only displays these copies.
+    void UpdateCache();
+    const QString& CachedText() const;
+    const QColor& CachedColor() const;
 
 private:
+    friend class WaitTreeModel;
+
+    void SetChildren(std::vector<std::unique_ptr<WaitTreeItem>> new_children);
+
     std::size_t row;
     bool expanded = false;
     WaitTreeItem* parent = nullptr;
     std::vector<std::unique_ptr<WaitTreeItem>> children;
+    QString cached_text;
+    QColor cached_color;
 };
 
 class WaitTreeText : public WaitTreeItem {
@@ -109,8 +121,12 @@ public:
     QString GetText() const override;
     std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const override;
 
+    /// Returns the ID of the object, without touching the object as it may be gone by now.
+    u32 GetObjectId() const;
+
 protected:
     const Kernel::WaitObject& object;
+    const u32 object_id;
 
     static QString GetResetTypeQString(Kernel::ResetType reset_type);
 };
@@ -153,14 +169,14 @@ public:
 class WaitTreeThreadList : public WaitTreeExpandableItem {
     Q_OBJECT
 public:
-    explicit WaitTreeThreadList(const std::vector<Kernel::SharedPtr<Kernel::Thread>>& list);
+    explicit WaitTreeThreadList(std::vector<Kernel::SharedPtr<Kernel::Thread>> list);
     ~WaitTreeThreadList() override;
 
     QString GetText() const override;
     std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const override;
 
 private:
-    const std::vector<Kernel::SharedPtr<Kernel::Thread>>& thread_list;
+    std::vector<Kernel::SharedPtr<Kernel::Thread>> thread_list;
 };
 
 class WaitTreeModel : public QAbstractItemModel {
@@ -176,11 +192,22 @@ public:
     int rowCount(const QModelIndex& parent) const override;
     int columnCount(const QModelIndex& parent) const override;
 
-    void ClearItems();
-    void InitItems();
+    /**
+     * Updates the tree to the current kernel state, emulation has to be paused. Threads are
+     * matched by object ID, only the threads that appeared or exited are inserted or removed.
+     * Children are only rebuilt for expanded items, the others are built once expanded.
+     */
+    void RefreshItems();
+
+    /// Stops reading the kernel state, the items keep showing the last refresh until the next.
+    void FreezeItems();
 
 private:
+    void RefreshChildren(WaitTreeItem& item, const QModelIndex& index);
+
     std::vector<std::unique_ptr<WaitTreeThread>> thread_items;
+    /// Items may only read the kernel state while emulation is paused
+    bool kernel_readable = false;
 };
 
 class WaitTreeWidget : public QDockWidget {
@@ -2,11 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -14,6 +17,7 @@
 
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/content_archive.h"
@@ -33,6 +37,20 @@
 
 namespace {
 
+/// Version of the game list metadata cache, bump it when the format of the entries changes
+constexpr quint32 METADATA_CACHE_VERSION = 1;
+
+/// Guards the files of the game list cache, entries of the same title may be generated at once
+std::mutex cache_file_mutex;
+
+/// Threads listing the game directories, listing a directory on a network share mostly waits
+constexpr std::size_t SCAN_THREADS = 4;
+
+std::string GetMetadataCachePath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + DIR_SEP + "game_list" + DIR_SEP +
+           "metadata.bin";
+}
+
 QString GetGameListCachedObject(const std::string& filename, const std::string& ext,
                                 const std::function<QString()>& generator) {
     if (!UISettings::values.cache_game_list || filename == "0000000000000000") {
@@ -44,8 +62,12 @@ QString GetGameListCachedObject(const std::string& filename, const std::string&
 
     FileUtil::CreateFullPath(path);
 
+    std::unique_lock lock{cache_file_mutex};
     if (!FileUtil::Exists(path)) {
+        // Files are scanned on several threads, only the cache file itself is guarded
+        lock.unlock();
         const auto str = generator();
+        lock.lock();
 
         QFile file{QString::fromStdString(path)};
         if (file.open(QFile::WriteOnly)) {
@@ -60,6 +82,7 @@ QString GetGameListCachedObject(const std::string& filename, const std::string&
         return QString::fromUtf8(file.readAll());
     }
 
+    lock.unlock();
     return generator();
 }
 
@@ -188,9 +211,9 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
 }
 
 QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::string& name,
-                                        const std::vector<u8>& icon, Loader::AppLoader& loader,
+                                        const std::vector<u8>& icon, Loader::FileType file_type,
                                         u64 program_id, const CompatibilityList& compatibility_list,
-                                        const FileSys::PatchManager& patch) {
+                                        const std::function<QString()>& patch_versions) {
     const auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
 
     // The game list uses this as compatibility number for untested games
@@ -199,7 +222,6 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
         compatibility = it->second.first;
     }
 
-    const auto file_type = loader.GetFileType();
     const auto file_type_string = QString::fromStdString(Loader::GetFileTypeString(file_type));
 
     QList<QStandardItem*> list{
@@ -211,15 +233,36 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
     };
 
     if (UISettings::values.show_add_ons) {
-        const auto patch_versions = GetGameListCachedObject(
-            fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", [&patch, &loader] {
-                return FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable());
-            });
-        list.insert(2, new GameListItem(patch_versions));
+        list.insert(2, new GameListItem(GetGameListCachedObject(
+                           fmt::format("{:016X}", program_id), "pv.txt", patch_versions)));
     }
 
     return list;
 }
+
+/// Runs func on every index below count on the thread pool and the calling thread
+template <typename Func>
+void ParallelFor(std::size_t count, const std::atomic_bool& stop, Func&& func) {
+    if (count == 0) {
+        return;
+    }
+
+    std::atomic<std::size_t> next_index{0};
+    const auto worker = [&] {
+        for (std::size_t i = next_index++; i < count && !stop; i = next_index++) {
+            func(i);
+        }
+    };
+    auto& pool = Common::GetThreadPool();
+    const std::size_t num_threads = std::clamp<std::size_t>(pool.GetNumWorkers() + 1, 1, count);
+    // Scanning the game list is background work, anything else queued is more urgent
+    Common::TaskGroup group{pool};
+    for (std::size_t i = 1; i < num_threads; ++i) {
+        group.Submit(worker, Common::TaskPriority::Low);
+    }
+    worker();
+    group.Wait();
+}
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(FileSys::VirtualFilesystem vfs,
@@ -271,85 +314,244 @@ void GameListWorker::AddTitlesToGameList(GameListDir* parent_dir) {
         if (control != nullptr)
             GetMetadataFromControlNCA(patch, *control, icon, name);
 
-        emit EntryReady(MakeGameListEntry(file->GetFullPath(), name, icon, *loader, program_id,
-                                          compatibility_list, patch),
+        emit EntryReady(MakeGameListEntry(file->GetFullPath(), name, icon, loader->GetFileType(),
+                                          program_id, compatibility_list,
+                                          [&patch, &loader] {
+                                              return FormatPatchNameVersions(
+                                                  patch, *loader, loader->IsRomFSUpdatable());
+                                          }),
                         parent_dir);
     }
 }
 
 void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_path,
                                     unsigned int recursion, GameListDir* parent_dir) {
-    const auto callback = [this, target, recursion,
-                           parent_dir](u64* num_entries_out, const std::string& directory,
-                                       const std::string& virtual_name) -> bool {
+    std::vector<std::string> paths;
+    CollectGameFiles(paths, dir_path, recursion);
+
+    if (target == ScanTarget::FillManualContentProvider) {
+        FillManualContentProvider(paths);
+    } else {
+        PopulateGameList(paths, parent_dir);
+    }
+}
+
+void GameListWorker::CollectGameFiles(std::vector<std::string>& out, const std::string& dir_path,
+                                      unsigned int recursion) {
+    std::mutex mutex;
+    const auto callback = [this, &out, &mutex, &dir_path, recursion](
+                              const std::string& directory, const std::string& virtual_name,
+                              bool is_dir) -> bool {
         if (stop_processing) {
             // Breaks the callback loop.
             return false;
         }
 
-        const std::string physical_name = directory + DIR_SEP + virtual_name;
-        const bool is_dir = FileUtil::IsDirectory(physical_name);
+        std::string physical_name = directory + DIR_SEP + virtual_name;
         if (!is_dir &&
             (HasSupportedFileExtension(physical_name) || IsExtractedNCAMain(physical_name))) {
-            const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
-            auto loader = Loader::GetLoader(file);
-            if (!loader) {
-                return true;
+            std::lock_guard lock{mutex};
+            out.push_back(std::move(physical_name));
+        } else if (is_dir) {
+            // Only the directories the walk enters are watched
+            const auto depth = static_cast<unsigned int>(
+                std::count(directory.begin() + dir_path.size(), directory.end(), DIR_SEP_CHR));
+            if (depth < recursion) {
+                std::lock_guard lock{mutex};
+                watch_list.append(QString::fromStdString(physical_name));
             }
+        }
 
-            const auto file_type = loader->GetFileType();
-            if ((file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error) &&
-                !UISettings::values.show_unknown) {
-                return true;
-            }
+        return true;
+    };
 
-            u64 program_id = 0;
-            const auto res2 = loader->ReadProgramId(program_id);
-
-            if (target == ScanTarget::FillManualContentProvider) {
-                if (res2 == Loader::ResultStatus::Success && file_type == Loader::FileType::NCA) {
-                    provider->AddEntry(FileSys::TitleType::Application,
-                                       FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
-                                       program_id, file);
-                } else if (res2 == Loader::ResultStatus::Success &&
-                           (file_type == Loader::FileType::XCI ||
-                            file_type == Loader::FileType::NSP)) {
-                    const auto nsp = file_type == Loader::FileType::NSP
-                                         ? std::make_shared<FileSys::NSP>(file)
-                                         : FileSys::XCI{file}.GetSecurePartitionNSP();
-                    for (const auto& title : nsp->GetNCAs()) {
-                        for (const auto& entry : title.second) {
-                            provider->AddEntry(entry.first.first, entry.first.second, title.first,
-                                               entry.second->GetBaseFile());
-                        }
-                    }
-                }
-            } else {
-                std::vector<u8> icon;
-                const auto res1 = loader->ReadIcon(icon);
+    FileUtil::WalkDirectoryTree(dir_path, recursion, SCAN_THREADS, callback);
+    std::sort(out.begin(), out.end());
+}
 
-                std::string name = " ";
-                const auto res3 = loader->ReadTitle(name);
+void GameListWorker::FillManualContentProvider(const std::vector<std::string>& paths) {
+    struct Entry {
+        FileSys::TitleType title_type;
+        FileSys::ContentRecordType record_type;
+        u64 title_id;
+        FileSys::VirtualFile file;
+    };
+
+    // Files are parsed in parallel, the provider itself is only filled from this thread
+    std::vector<std::vector<Entry>> entries(paths.size());
+    ParallelFor(paths.size(), stop_processing, [this, &paths, &entries](std::size_t i) {
+        const auto& path = paths[i];
+        auto& out = entries[i];
 
-                const FileSys::PatchManager patch{program_id};
+        const auto file = vfs->OpenFile(path, FileSys::Mode::Read);
+        const auto loader = Loader::GetLoader(file);
+        if (!loader) {
+            return;
+        }
 
-                emit EntryReady(MakeGameListEntry(physical_name, name, icon, *loader, program_id,
-                                                  compatibility_list, patch),
-                                parent_dir);
+        const auto file_type = loader->GetFileType();
+        u64 program_id = 0;
+        if (loader->ReadProgramId(program_id) != Loader::ResultStatus::Success) {
+            return;
+        }
+
+        if (file_type == Loader::FileType::NCA) {
+            out.push_back({FileSys::TitleType::Application,
+                           FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()), program_id,
+                           file});
+        } else if (file_type == Loader::FileType::XCI || file_type == Loader::FileType::NSP) {
+            const auto nsp = file_type == Loader::FileType::NSP
+                                 ? std::make_shared<FileSys::NSP>(file)
+                                 : FileSys::XCI{file}.GetSecurePartitionNSP();
+            for (const auto& title : nsp->GetNCAs()) {
+                for (const auto& entry : title.second) {
+                    out.push_back({entry.first.first, entry.first.second, title.first,
+                                   entry.second->GetBaseFile()});
+                }
             }
-        } else if (is_dir && recursion > 0) {
-            watch_list.append(QString::fromStdString(physical_name));
-            ScanFileSystem(target, physical_name, recursion - 1, parent_dir);
         }
+    });
 
-        return true;
-    };
+    for (const auto& file_entries : entries) {
+        for (const auto& entry : file_entries) {
+            provider->AddEntry(entry.title_type, entry.record_type, entry.title_id, entry.file);
+        }
+    }
+}
 
-    FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+void GameListWorker::PopulateGameList(const std::vector<std::string>& paths,
+                                      GameListDir* parent_dir) {
+    // Entries are emitted from every thread as they're ready, the list is sorted once it's done
+    ParallelFor(paths.size(), stop_processing, [this, &paths, parent_dir](std::size_t i) {
+        const auto& path = paths[i];
+        // Extracted NCAs take their metadata from other files of their directory
+        const bool cacheable = UISettings::values.cache_game_list && !IsExtractedNCAMain(path);
+        const u64 size = FileUtil::GetSize(path);
+        const u64 modification_time = FileUtil::GetModificationTime(path);
+
+        std::unique_ptr<Loader::AppLoader> loader;
+        const auto open_loader = [this, &path, &loader] {
+            if (loader == nullptr) {
+                loader = Loader::GetLoader(vfs->OpenFile(path, FileSys::Mode::Read));
+            }
+            return loader.get();
+        };
+
+        GameMetadata metadata{size, modification_time};
+        const auto cached = cached_metadata.find(path);
+        if (cacheable && cached != cached_metadata.end() && cached->second.size == size &&
+            cached->second.modification_time == modification_time) {
+            metadata = cached->second;
+        } else {
+            if (open_loader() == nullptr) {
+                return;
+            }
+
+            metadata.file_type = loader->GetFileType();
+            metadata.program_id = 0;
+            loader->ReadProgramId(metadata.program_id);
+            loader->ReadIcon(metadata.icon);
+            metadata.name = " ";
+            loader->ReadTitle(metadata.name);
+        }
+
+        if ((metadata.file_type == Loader::FileType::Unknown ||
+             metadata.file_type == Loader::FileType::Error) &&
+            !UISettings::values.show_unknown) {
+            return;
+        }
+
+        const u64 program_id = metadata.program_id;
+        emit EntryReady(MakeGameListEntry(path, metadata.name, metadata.icon, metadata.file_type,
+                                          program_id, compatibility_list,
+                                          [&open_loader, program_id]() -> QString {
+                                              auto* const app_loader = open_loader();
+                                              if (app_loader == nullptr) {
+                                                  return {};
+                                              }
+                                              const FileSys::PatchManager patch{program_id};
+                                              return FormatPatchNameVersions(
+                                                  patch, *app_loader,
+                                                  app_loader->IsRomFSUpdatable());
+                                          }),
+                        parent_dir);
+
+        if (cacheable) {
+            std::lock_guard lock{scanned_metadata_mutex};
+            scanned_metadata.insert_or_assign(path, std::move(metadata));
+        }
+    });
+}
+
+void GameListWorker::LoadMetadataCache() {
+    cached_metadata.clear();
+    if (!UISettings::values.cache_game_list) {
+        return;
+    }
+
+    QFile file{QString::fromStdString(GetMetadataCachePath())};
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream{&file};
+    quint32 version{};
+    quint32 count{};
+    stream >> version >> count;
+    if (version != METADATA_CACHE_VERSION) {
+        return;
+    }
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        quint64 size{};
+        quint64 modification_time{};
+        quint64 program_id{};
+        quint32 file_type{};
+        QString name;
+        QByteArray icon;
+        stream >> path >> size >> modification_time >> program_id >> file_type >> name >> icon;
+        if (stream.status() != QDataStream::Ok) {
+            break;
+        }
+
+        cached_metadata.insert_or_assign(
+            path.toStdString(),
+            GameMetadata{size, modification_time, program_id,
+                         static_cast<Loader::FileType>(file_type), name.toStdString(),
+                         std::vector<u8>(icon.begin(), icon.end())});
+    }
+}
+
+void GameListWorker::SaveMetadataCache() const {
+    if (!UISettings::values.cache_game_list) {
+        return;
+    }
+
+    const auto path = GetMetadataCachePath();
+    FileUtil::CreateFullPath(path);
+
+    QFile file{QString::fromStdString(path)};
+    if (!file.open(QFile::WriteOnly)) {
+        LOG_ERROR(Frontend, "Failed to open the game list metadata cache for writing.");
+        return;
+    }
+
+    QDataStream stream{&file};
+    stream << METADATA_CACHE_VERSION << static_cast<quint32>(scanned_metadata.size());
+    for (const auto& [game_path, metadata] : scanned_metadata) {
+        stream << QString::fromStdString(game_path) << quint64{metadata.size}
+               << quint64{metadata.modification_time} << quint64{metadata.program_id}
+               << static_cast<quint32>(metadata.file_type) << QString::fromStdString(metadata.name)
+               << QByteArray(reinterpret_cast<const char*>(metadata.icon.data()),
+                             static_cast<int>(metadata.icon.size()));
+    }
 }
 
 void GameListWorker::run() {
     stop_processing = false;
+    LoadMetadataCache();
+    scanned_metadata.clear();
 
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == QStringLiteral("SDMC")) {
@@ -376,6 +578,11 @@ void GameListWorker::run() {
         }
     };
 
+    // A cancelled scan hasn't seen every file, the metadata of the rest must not be dropped
+    if (!stop_processing) {
+        SaveMetadataCache();
+    }
+
     emit Finished(watch_list);
 }
 
@@ -7,8 +7,10 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <QList>
 #include <QObject>
@@ -26,6 +28,10 @@ class NCA;
 class VfsFilesystem;
 } // namespace FileSys
 
+namespace Loader {
+enum class FileType;
+}
+
 /**
  * Asynchronous worker object for populating the game list.
  * Communicates with other threads through Qt's signal/slot system.
@@ -73,10 +79,37 @@ private:
     void ScanFileSystem(ScanTarget target, const std::string& dir_path, unsigned int recursion,
                         GameListDir* parent_dir);
 
+    /// Appends the game files found under dir_path to out and the directories to the watch list.
+    void CollectGameFiles(std::vector<std::string>& out, const std::string& dir_path,
+                          unsigned int recursion);
+
+    void FillManualContentProvider(const std::vector<std::string>& paths);
+    void PopulateGameList(const std::vector<std::string>& paths, GameListDir* parent_dir);
+
+    /// What the game list shows about a game file. It is kept between launches so that files
+    /// with the same size and modification time don't have to be opened again.
+    struct GameMetadata {
+        u64 size;
+        u64 modification_time;
+        u64 program_id;
+        Loader::FileType file_type;
+        std::string name;
+        std::vector<u8> icon;
+    };
+
+    void LoadMetadataCache();
+    void SaveMetadataCache() const;
+
     std::shared_ptr<FileSys::VfsFilesystem> vfs;
     FileSys::ManualContentProvider* provider;
     QStringList watch_list;
     const CompatibilityList& compatibility_list;
     QVector<UISettings::GameDir>& game_dirs;
     std::atomic_bool stop_processing;
+
+    /// Metadata cached by previous launches, keyed by the path of the file
+    std::unordered_map<std::string, GameMetadata> cached_metadata;
+    /// Metadata of the files found by this scan, replaces the cached metadata when it's done
+    std::unordered_map<std::string, GameMetadata> scanned_metadata;
+    std::mutex scanned_metadata_mutex;
 };
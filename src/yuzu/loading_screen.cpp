@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <unordered_map>
 #include <QBuffer>
 #include <QByteArray>
@@ -139,6 +140,7 @@ void LoadingScreen::Prepare(Loader::AppLoader& loader) {
     }
 
     slow_shader_compile_start = false;
+    stage_start = {};
     OnLoadProgress(VideoCore::LoadCallbackStage::Prepare, 0, 0);
 }
 
@@ -151,7 +153,15 @@ void LoadingScreen::OnLoadProgress(VideoCore::LoadCallbackStage stage, std::size
     using namespace std::chrono;
     const auto now = high_resolution_clock::now();
     // reset the timer if the stage changes
-    if (stage != previous_stage) {
+    if (stage != previous_stage || stage_start == high_resolution_clock::time_point{}) {
+        if (stage_start != high_resolution_clock::time_point{}) {
+            static constexpr std::array<const char*, 4> stage_names{"Prepare", "Decompile",
+                                                                    "Build", "Complete"};
+            LOG_INFO(Frontend, "Loading stage {} took {} ms",
+                     stage_names.at(static_cast<std::size_t>(previous_stage)),
+                     duration_cast<milliseconds>(now - stage_start).count());
+        }
+        stage_start = now;
         ui->progress_bar->setStyleSheet(QString::fromUtf8(progressbar_style[stage]));
         // Hide the progress bar during the prepare stage
         if (stage == VideoCore::LoadCallbackStage::Prepare) {
@@ -87,6 +87,9 @@ private:
     std::chrono::high_resolution_clock::time_point slow_shader_start;
     std::chrono::high_resolution_clock::time_point previous_time;
     std::size_t slow_shader_first_value = 0;
+
+    // When the current stage began, the time each stage takes is logged
+    std::chrono::high_resolution_clock::time_point stage_start;
 };
 
 Q_DECLARE_METATYPE(VideoCore::LoadCallbackStage);
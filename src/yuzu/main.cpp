@@ -94,6 +94,8 @@ static FileSys::VirtualFile VfsDirectoryCreateFileWrapper(const FileSys::Virtual
 #include "core/settings.h"
 #include "core/telemetry_session.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_profiler.h"
 #include "yuzu/about_dialog.h"
 #include "yuzu/bootmanager.h"
 #include "yuzu/compatdb.h"
@@ -102,6 +104,8 @@ static FileSys::VirtualFile VfsDirectoryCreateFileWrapper(const FileSys::Virtual
 #include "yuzu/configuration/configure_dialog.h"
 #include "yuzu/debugger/console.h"
 #include "yuzu/debugger/graphics/graphics_breakpoints.h"
+#include "yuzu/debugger/ipc_statistics.h"
+#include "yuzu/debugger/memory_usage.h"
 #include "yuzu/debugger/profiler.h"
 #include "yuzu/debugger/wait_tree.h"
 #include "yuzu/discord.h"
@@ -508,6 +512,16 @@ void GMainWindow::InitializeDebugWidgets() {
             &WaitTreeWidget::OnEmulationStarting);
     connect(this, &GMainWindow::EmulationStopping, waitTreeWidget,
             &WaitTreeWidget::OnEmulationStopping);
+
+    ipcStatisticsWidget = new IPCStatisticsWidget(this);
+    addDockWidget(Qt::RightDockWidgetArea, ipcStatisticsWidget);
+    ipcStatisticsWidget->hide();
+    debug_menu->addAction(ipcStatisticsWidget->toggleViewAction());
+
+    memoryUsageWidget = new MemoryUsageWidget(this);
+    addDockWidget(Qt::RightDockWidgetArea, memoryUsageWidget);
+    memoryUsageWidget->hide();
+    debug_menu->addAction(memoryUsageWidget->toggleViewAction());
 }
 
 void GMainWindow::InitializeRecentFileMenuActions() {
@@ -602,6 +616,7 @@ void GMainWindow::InitializeHotkeys() {
     // MSVC occurs and we make it a requirement (see:
     // https://developercommunity.visualstudio.com/content/problem/93922/constexprs-are-trying-to-be-captured-in-lambda-fun.html)
     static constexpr u16 SPEED_LIMIT_STEP = 5;
+    static constexpr u32 GPU_PROFILE_FRAMES = 10;
     connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Increase Speed Limit"), this),
             &QShortcut::activated, this, [&] {
                 if (Settings::values.frame_limit < 9999 - SPEED_LIMIT_STEP) {
@@ -622,6 +637,13 @@ void GMainWindow::InitializeHotkeys() {
                     OnLoadAmiibo();
                 }
             });
+    connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Capture GPU Profile"), this),
+            &QShortcut::activated, this, [&] {
+                if (emu_thread->IsRunning()) {
+                    Core::System::GetInstance().GPU().Profiler().RequestCapture(
+                        GPU_PROFILE_FRAMES);
+                }
+            });
     connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Capture Screenshot"), this),
             &QShortcut::activated, this, [&] {
                 if (emu_thread->IsRunning()) {
@@ -1451,9 +1473,9 @@ void GMainWindow::OnMenuLoadFolder() {
 
 void GMainWindow::OnMenuInstallToNAND() {
     const QString file_filter =
-        tr("Installable Switch File (*.nca *.nsp *.xci);;Nintendo Content Archive "
-           "(*.nca);;Nintendo Submissions Package (*.nsp);;NX Cartridge "
-           "Image (*.xci)");
+        tr("Installable Switch File (*.nca *.nsp *.xci *.nsz *.xcz);;Nintendo Content Archive "
+           "(*.nca);;Nintendo Submissions Package (*.nsp *.nsz);;NX Cartridge "
+           "Image (*.xci *.xcz)");
     QString filename = QFileDialog::getOpenFileName(this, tr("Install File"),
                                                     UISettings::values.roms_path, file_filter);
 
@@ -1461,35 +1483,20 @@ void GMainWindow::OnMenuInstallToNAND() {
         return;
     }
 
-    const auto qt_raw_copy = [this](const FileSys::VirtualFile& src,
-                                    const FileSys::VirtualFile& dest, std::size_t block_size) {
-        if (src == nullptr || dest == nullptr)
-            return false;
-        if (!dest->Resize(src->GetSize()))
-            return false;
-
-        std::array<u8, 0x1000> buffer{};
-        const int progress_maximum = static_cast<int>(src->GetSize() / buffer.size());
-
-        QProgressDialog progress(
-            tr("Installing file \"%1\"...").arg(QString::fromStdString(src->GetName())),
-            tr("Cancel"), 0, progress_maximum, this);
-        progress.setWindowModality(Qt::WindowModal);
-
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (progress.wasCanceled()) {
-                dest->Resize(0);
-                return false;
-            }
-
-            const int progress_value = static_cast<int>(i / buffer.size());
-            progress.setValue(progress_value);
-
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
+    // Created on the first progress report, so the dialog doesn't pop up over the other prompts
+    std::unique_ptr<QProgressDialog> progress;
+    const auto qt_progress = [this, &progress](const FileSys::VirtualFile& nca, std::size_t copied,
+                                               double throughput) {
+        if (progress == nullptr) {
+            progress = std::make_unique<QProgressDialog>(QString{}, tr("Cancel"), 0, 1000, this);
+            progress->setWindowModality(Qt::WindowModal);
         }
 
-        return true;
+        progress->setLabelText(tr("Installing file \"%1\"... (%2 MB/s)")
+                                   .arg(QString::fromStdString(nca->GetName()))
+                                   .arg(throughput / 0x100000, 0, 'f', 1));
+        progress->setValue(static_cast<int>(copied * 1000 / nca->GetSize()));
+        return !progress->wasCanceled();
     };
 
     const auto success = [this]() {
@@ -1515,10 +1522,13 @@ void GMainWindow::OnMenuInstallToNAND() {
                QMessageBox::Yes;
     };
 
-    if (filename.endsWith(QStringLiteral("xci"), Qt::CaseInsensitive) ||
-        filename.endsWith(QStringLiteral("nsp"), Qt::CaseInsensitive)) {
+    const bool is_nsp = filename.endsWith(QStringLiteral("nsp"), Qt::CaseInsensitive) ||
+                        filename.endsWith(QStringLiteral("nsz"), Qt::CaseInsensitive);
+    const bool is_xci = filename.endsWith(QStringLiteral("xci"), Qt::CaseInsensitive) ||
+                        filename.endsWith(QStringLiteral("xcz"), Qt::CaseInsensitive);
+    if (is_nsp || is_xci) {
         std::shared_ptr<FileSys::NSP> nsp;
-        if (filename.endsWith(QStringLiteral("nsp"), Qt::CaseInsensitive)) {
+        if (is_nsp) {
             nsp = std::make_shared<FileSys::NSP>(
                 vfs->OpenFile(filename.toStdString(), FileSys::Mode::Read));
             if (nsp->IsExtractedType())
@@ -1536,7 +1546,7 @@ void GMainWindow::OnMenuInstallToNAND() {
         const auto res = Core::System::GetInstance()
                              .GetFileSystemController()
                              .GetUserNANDContents()
-                             ->InstallEntry(*nsp, false, qt_raw_copy);
+                             ->InstallEntry(*nsp, false, qt_progress);
         if (res == FileSys::InstallResult::Success) {
             success();
         } else {
@@ -1545,7 +1555,7 @@ void GMainWindow::OnMenuInstallToNAND() {
                     const auto res2 = Core::System::GetInstance()
                                           .GetFileSystemController()
                                           .GetUserNANDContents()
-                                          ->InstallEntry(*nsp, true, qt_raw_copy);
+                                          ->InstallEntry(*nsp, true, qt_progress);
                     if (res2 == FileSys::InstallResult::Success) {
                         success();
                     } else {
@@ -1603,13 +1613,13 @@ void GMainWindow::OnMenuInstallToNAND() {
                       .GetFileSystemController()
                       .GetUserNANDContents()
                       ->InstallEntry(*nca, static_cast<FileSys::TitleType>(index), false,
-                                     qt_raw_copy);
+                                     qt_progress);
         } else {
             res = Core::System::GetInstance()
                       .GetFileSystemController()
                       .GetSystemNANDContents()
                       ->InstallEntry(*nca, static_cast<FileSys::TitleType>(index), false,
-                                     qt_raw_copy);
+                                     qt_progress);
         }
 
         if (res == FileSys::InstallResult::Success) {
@@ -1620,7 +1630,7 @@ void GMainWindow::OnMenuInstallToNAND() {
                                       .GetFileSystemController()
                                       .GetUserNANDContents()
                                       ->InstallEntry(*nca, static_cast<FileSys::TitleType>(index),
-                                                     true, qt_raw_copy);
+                                                     true, qt_progress);
                 if (res2 == FileSys::InstallResult::Success) {
                     success();
                 } else {
@@ -24,7 +24,9 @@ class GameList;
 class GImageInfo;
 class GraphicsBreakPointsWidget;
 class GRenderWindow;
+class IPCStatisticsWidget;
 class LoadingScreen;
+class MemoryUsageWidget;
 class MicroProfileDialog;
 class ProfilerWidget;
 class QLabel;
@@ -254,6 +256,8 @@ private:
     MicroProfileDialog* microProfileDialog;
     GraphicsBreakPointsWidget* graphicsBreakpointsWidget;
     WaitTreeWidget* waitTreeWidget;
+    IPCStatisticsWidget* ipcStatisticsWidget;
+    MemoryUsageWidget* memoryUsageWidget;
 
     QAction* actions_recent_files[max_recent_files_item];
 
@@ -310,6 +310,8 @@ void Config::ReadValues() {
     // Data Storage
     Settings::values.use_virtual_sd =
         sdl2_config->GetBoolean("Data Storage", "use_virtual_sd", true);
+    Settings::values.cache_decrypted_nca_sections =
+        sdl2_config->GetBoolean("Data Storage", "cache_decrypted_nca_sections", false);
     FileUtil::GetUserPath(FileUtil::UserPath::NANDDir,
                           sdl2_config->Get("Data Storage", "nand_directory",
                                            FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)));
@@ -364,6 +366,23 @@ void Config::ReadValues() {
 
     // Core
     Settings::values.use_multi_core = sdl2_config->GetBoolean("Core", "use_multi_core", false);
+    Settings::values.use_parallel_cpu =
+        sdl2_config->GetBoolean("Core", "use_parallel_cpu", false);
+    Settings::values.use_cpu_load_balancing =
+        sdl2_config->GetBoolean("Core", "use_cpu_load_balancing", false);
+    Settings::values.use_shared_jit_cache =
+        sdl2_config->GetBoolean("Core", "use_shared_jit_cache", false);
+    Settings::values.use_native_libc_functions =
+        sdl2_config->GetBoolean("Core", "use_native_libc_functions", false);
+    Settings::values.use_host_clock = sdl2_config->GetBoolean("Core", "use_host_clock", false);
+    Settings::values.cpu_thread_affinity =
+        static_cast<u64>(sdl2_config->GetInteger("Core", "cpu_thread_affinity", 0));
+    Settings::values.gpu_thread_affinity =
+        static_cast<u64>(sdl2_config->GetInteger("Core", "gpu_thread_affinity", 0));
+    Settings::values.audio_thread_affinity =
+        static_cast<u64>(sdl2_config->GetInteger("Core", "audio_thread_affinity", 0));
+    Settings::values.use_high_thread_priority =
+        sdl2_config->GetBoolean("Core", "use_high_thread_priority", false);
 
     // Renderer
     Settings::values.resolution_factor =
@@ -377,6 +396,20 @@ void Config::ReadValues() {
         sdl2_config->GetBoolean("Renderer", "use_accurate_gpu_emulation", false);
     Settings::values.use_asynchronous_gpu_emulation =
         sdl2_config->GetBoolean("Renderer", "use_asynchronous_gpu_emulation", false);
+    Settings::values.use_asynchronous_shaders =
+        sdl2_config->GetBoolean("Renderer", "use_asynchronous_shaders", false);
+    Settings::values.texture_cache_budget_mb =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "texture_cache_budget_mb", 0));
+    Settings::values.use_gpu_texture_swizzle =
+        sdl2_config->GetBoolean("Renderer", "use_gpu_texture_swizzle", false);
+    Settings::values.use_bindless_textures =
+        sdl2_config->GetBoolean("Renderer", "use_bindless_textures", false);
+    Settings::values.transcode_astc_textures =
+        sdl2_config->GetBoolean("Renderer", "transcode_astc_textures", false);
+    Settings::values.use_frame_smoothing =
+        sdl2_config->GetBoolean("Renderer", "use_frame_smoothing", false);
+    Settings::values.uncap_composition_rate =
+        sdl2_config->GetBoolean("Renderer", "uncap_composition_rate", false);
 
     Settings::values.bg_red = static_cast<float>(sdl2_config->GetReal("Renderer", "bg_red", 0.0));
     Settings::values.bg_green =
@@ -387,6 +420,8 @@ void Config::ReadValues() {
     Settings::values.sink_id = sdl2_config->Get("Audio", "output_engine", "auto");
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
+    Settings::values.use_linear_audio_resampling =
+        sdl2_config->GetBoolean("Audio", "use_linear_audio_resampling", false);
     Settings::values.audio_device_id = sdl2_config->Get("Audio", "output_device", "auto");
     Settings::values.volume = static_cast<float>(sdl2_config->GetReal("Audio", "volume", 1));
 
@@ -399,6 +434,14 @@ void Config::ReadValues() {
     // Debugging
     Settings::values.record_frame_times =
         sdl2_config->GetBoolean("Debugging", "record_frame_times", false);
+    Settings::values.record_input_latency =
+        sdl2_config->GetBoolean("Debugging", "record_input_latency", false);
+    Settings::values.profile_guest_code =
+        sdl2_config->GetBoolean("Debugging", "profile_guest_code", false);
+    Settings::values.record_session_telemetry =
+        sdl2_config->GetBoolean("Debugging", "record_session_telemetry", false);
+    Settings::values.record_ipc_statistics =
+        sdl2_config->GetBoolean("Debugging", "record_ipc_statistics", false);
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
     Settings::values.gdbstub_port =
         static_cast<u16>(sdl2_config->GetInteger("Debugging", "gdbstub_port", 24689));
@@ -218,9 +218,16 @@ int main(int argc, char** argv) {
 
     system.TelemetrySession().AddField(Telemetry::FieldType::App, "Frontend", "SDL");
 
-    emu_window->MakeCurrent();
+    // The window context belongs to the presentation thread, rendering uses the renderer's own
+    auto& render_context = system.Renderer().GetRenderContext();
+    render_context.MakeCurrent();
     system.Renderer().Rasterizer().LoadDiskResources();
 
+    if (Settings::values.use_asynchronous_gpu_emulation) {
+        // Release OpenGL context for the GPU thread
+        render_context.DoneCurrent();
+    }
+
     while (emu_window->IsOpen()) {
         system.RunLoop();
     }
@@ -0,0 +1,147 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <fmt/format.h>
+#include <json.hpp>
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/perf_stats.h"
+#include "yuzu_tester/benchmark.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace Benchmark {
+
+namespace {
+
+/// Wall time the title may go without presenting a frame before the run is considered stuck
+constexpr std::chrono::seconds STALL_TIMEOUT{60};
+
+u64 GetPeakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<u64>(usage.ru_maxrss);
+#else
+    // Linux reports it in kilobytes
+    return static_cast<u64>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+void StartProfiling() {
+#if MICROPROFILE_ENABLED
+    MicroProfileSetEnableAllGroups(true);
+    // Accumulate from the next flip on without ever clearing
+    MicroProfileSetAggregateFrames(0);
+#endif
+}
+
+/// Host time spent in each MicroProfile group during the run, in milliseconds.
+nlohmann::json GetProfileTotals() {
+    nlohmann::json totals = nlohmann::json::object();
+#if MICROPROFILE_ENABLED
+    std::lock_guard lock{MicroProfileGetMutex()};
+    const MicroProfile& profile = *MicroProfileGet();
+    const float cpu_to_ms = MicroProfileTickToMsMultiplier(MicroProfileTicksPerSecondCpu());
+    for (u32 group = 0; group < MICROPROFILE_MAX_GROUPS; ++group) {
+        const auto& info = profile.GroupInfo[group];
+        if (info.pName[0] == '\0' || info.Type != MicroProfileTokenTypeCpu) {
+            continue;
+        }
+        totals[info.pName] = cpu_to_ms * static_cast<float>(profile.AggregateGroup[group]);
+    }
+#endif
+    return totals;
+}
+
+} // Anonymous namespace
+
+int Run(Core::System& system, const Options& options) {
+    StartProfiling();
+    // Loading the disk caches shouldn't count towards the emulation speed
+    system.GetAndResetPerfStats();
+
+    const auto start = std::chrono::steady_clock::now();
+    auto last_frame_time = start;
+    u64 last_frame_count = 0;
+    while (last_frame_count < options.num_frames) {
+        system.RunLoop();
+
+        const auto now = std::chrono::steady_clock::now();
+        const u64 frame_count = system.GetPerfStats().GetSystemFrameCount();
+        if (frame_count != last_frame_count) {
+            last_frame_count = frame_count;
+            last_frame_time = now;
+        } else if (now - last_frame_time > STALL_TIMEOUT) {
+            LOG_CRITICAL(Frontend, "Benchmark stalled after {} frames", frame_count);
+            return -1;
+        }
+    }
+    const std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
+    auto& perf_stats = system.GetPerfStats();
+    const auto results = system.GetAndResetPerfStats();
+    const auto frametimes = perf_stats.GetFrametimeHistogram();
+    const auto pacing = perf_stats.GetFramePacingSummary();
+
+    nlohmann::json report;
+    report["title_id"] = fmt::format("{:016X}", system.CurrentProcess()->GetTitleID());
+    report["frames"] = last_frame_count;
+    report["wall_time_s"] = wall_time.count();
+    report["emulation_speed"] = results.emulation_speed * 100.0;
+    report["game_fps"] = results.game_fps;
+    report["frametime_ms"] = {
+        {"mean", perf_stats.GetMeanFrametime()},
+        {"p50", frametimes.p50},
+        {"p95", frametimes.p95},
+        {"p99", frametimes.p99},
+        {"max", frametimes.max},
+    };
+    report["frame_pacing_ms"] = {
+        {"p50", pacing.p50},
+        {"p95", pacing.p95},
+        {"p99", pacing.p99},
+        {"max", pacing.max},
+        {"samples", pacing.num_samples},
+    };
+    report["profile_ms"] = GetProfileTotals();
+    report["peak_rss_bytes"] = GetPeakResidentBytes();
+
+    if (options.output_path.empty()) {
+        std::cout << std::setw(4) << report << std::endl;
+        return 0;
+    }
+    std::ofstream file(options.output_path);
+    file << std::setw(4) << report << std::endl;
+    if (!file) {
+        LOG_CRITICAL(Frontend, "Failed to write the benchmark report to {}", options.output_path);
+        return -1;
+    }
+    return 0;
+}
+
+} // namespace Benchmark
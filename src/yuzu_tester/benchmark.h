@@ -0,0 +1,29 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+}
+
+namespace Benchmark {
+
+struct Options {
+    u32 num_frames;          ///< Frames measured, after the ones spent booting
+    std::string output_path; ///< File the JSON report is written to, stdout when empty
+};
+
+/**
+ * Runs the loaded title for a number of frames, as fast as it can go and without input, then
+ * reports its frametime percentiles, emulation speed, MicroProfile totals per group and peak
+ * memory usage as JSON.
+ * @returns the exit code of the tester, non-zero when the title stopped presenting frames
+ */
+int Run(Core::System& system, const Options& options);
+
+} // namespace Benchmark
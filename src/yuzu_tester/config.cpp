@@ -115,6 +115,23 @@ void Config::ReadValues() {
 
     // Core
     Settings::values.use_multi_core = sdl2_config->GetBoolean("Core", "use_multi_core", false);
+    Settings::values.use_parallel_cpu =
+        sdl2_config->GetBoolean("Core", "use_parallel_cpu", false);
+    Settings::values.use_cpu_load_balancing =
+        sdl2_config->GetBoolean("Core", "use_cpu_load_balancing", false);
+    Settings::values.use_shared_jit_cache =
+        sdl2_config->GetBoolean("Core", "use_shared_jit_cache", false);
+    Settings::values.use_native_libc_functions =
+        sdl2_config->GetBoolean("Core", "use_native_libc_functions", false);
+    Settings::values.use_host_clock = sdl2_config->GetBoolean("Core", "use_host_clock", false);
+    Settings::values.cpu_thread_affinity =
+        static_cast<u64>(sdl2_config->GetInteger("Core", "cpu_thread_affinity", 0));
+    Settings::values.gpu_thread_affinity =
+        static_cast<u64>(sdl2_config->GetInteger("Core", "gpu_thread_affinity", 0));
+    Settings::values.audio_thread_affinity =
+        static_cast<u64>(sdl2_config->GetInteger("Core", "audio_thread_affinity", 0));
+    Settings::values.use_high_thread_priority =
+        sdl2_config->GetBoolean("Core", "use_high_thread_priority", false);
 
     // Renderer
     Settings::values.resolution_factor =
@@ -127,6 +144,16 @@ void Config::ReadValues() {
         sdl2_config->GetBoolean("Renderer", "use_accurate_gpu_emulation", false);
     Settings::values.use_asynchronous_gpu_emulation =
         sdl2_config->GetBoolean("Renderer", "use_asynchronous_gpu_emulation", false);
+    Settings::values.use_asynchronous_shaders =
+        sdl2_config->GetBoolean("Renderer", "use_asynchronous_shaders", false);
+    Settings::values.texture_cache_budget_mb =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "texture_cache_budget_mb", 0));
+    Settings::values.use_gpu_texture_swizzle =
+        sdl2_config->GetBoolean("Renderer", "use_gpu_texture_swizzle", false);
+    Settings::values.use_bindless_textures =
+        sdl2_config->GetBoolean("Renderer", "use_bindless_textures", false);
+    Settings::values.transcode_astc_textures =
+        sdl2_config->GetBoolean("Renderer", "transcode_astc_textures", false);
 
     Settings::values.bg_red = static_cast<float>(sdl2_config->GetReal("Renderer", "bg_red", 0.0));
     Settings::values.bg_green =
@@ -12,6 +12,36 @@ const char* sdl2_config_file = R"(
 # 0 (default): Disabled, 1: Enabled
 use_multi_core=
 
+# Whether to let each CPU core run freely on its own thread instead of in lock-step with the others.
+# Requires use_multi_core. 0 (default): Disabled, 1: Enabled
+use_parallel_cpu=
+
+# Whether idle CPU cores take over ready threads waiting on busy cores, if their affinity allows it.
+# Requires use_multi_core. 0 (default): Disabled, 1: Enabled
+use_cpu_load_balancing=
+
+# Whether the CPU cores share one JIT and its translated code instead of translating it each.
+# Ignored with use_multi_core. 0 (default): Disabled, 1: Enabled
+use_shared_jit_cache=
+
+# Whether memcpy, memset, strlen and similar libc functions of the game run natively on the host.
+# 0 (default): Disabled, 1: Enabled
+use_native_libc_functions=
+
+# Whether the tick count seen by the game follows the host clock instead of the emulated cycles.
+# Requires an x64 CPU with an invariant TSC. 0 (default): Disabled, 1: Enabled
+use_host_clock=
+
+# Host cores the CPU, GPU and audio threads may run on, as a mask of core numbers (e.g. 0x0C for
+# cores 2 and 3). 0 (default): Let the OS decide
+cpu_thread_affinity=
+gpu_thread_affinity=
+audio_thread_affinity=
+
+# Whether to raise the priority of the CPU, GPU and audio threads. Real-time scheduling is used
+# for the audio thread where the OS permits it. 0 (default): Disabled, 1: Enabled
+use_high_thread_priority=
+
 [Renderer]
 # Whether to use software or hardware rendering.
 # 0: Software, 1 (default): Hardware
@@ -42,6 +72,26 @@ use_accurate_gpu_emulation =
 # 0 : Off (slow), 1 (default): On (fast)
 use_asynchronous_gpu_emulation =
 
+# Whether to build shaders on background threads, skipping draws until they are ready
+# 0 (default): Off, 1 : On
+use_asynchronous_shaders =
+
+# Memory in MiB the texture cache tries to stay under by releasing textures that weren't used for
+# a while. 0 (default): Unlimited
+texture_cache_budget_mb =
+
+# Whether to swizzle and unswizzle large textures with compute shaders instead of on the CPU
+# 0 (default): Off, 1 : On
+use_gpu_texture_swizzle =
+
+# Whether to pass textures to shaders as resident bindless handles instead of binding them to
+# texture units. Needs GL_ARB_bindless_texture. 0 (default): Off, 1 : On
+use_bindless_textures =
+
+# Whether to store ASTC textures as BC3 after decoding them, the result is cached on disk
+# 0 (default): Off, 1 : On
+transcode_astc_textures =
+
 # The clear color for the renderer. What shows up on the sides of the bottom screen.
 # Must be in range of 0.0-1.0. Defaults to 1.0 for all.
 bg_red =
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -29,6 +30,7 @@
 #include "core/settings.h"
 #include "core/telemetry_session.h"
 #include "video_core/renderer_base.h"
+#include "yuzu_tester/benchmark.h"
 #include "yuzu_tester/config.h"
 #include "yuzu_tester/emu_window/emu_window_sdl2_hide.h"
 #include "yuzu_tester/service/yuzutest.h"
@@ -62,7 +64,10 @@ static void PrintHelp(const char* argv0) {
                  "-v, --version         Output version information and exit\n"
                  "-d, --datastring      Pass following string as data to test service command #2\n"
                  "-l, --log             Log to console in addition to file (will log to file only "
-                 "by default)\n";
+                 "by default)\n"
+                 "-b, --benchmark=N     Run the title for N frames and report its performance as "
+                 "JSON\n"
+                 "-o, --output=FILE     Write the benchmark report to FILE instead of stdout\n";
 }
 
 static void PrintVersion() {
@@ -109,14 +114,18 @@ int main(int argc, char** argv) {
         {"version", no_argument, 0, 'v'},
         {"datastring", optional_argument, 0, 'd'},
         {"log", no_argument, 0, 'l'},
+        {"benchmark", required_argument, 0, 'b'},
+        {"output", required_argument, 0, 'o'},
         {0, 0, 0, 0},
     };
 
     bool console_log = false;
     std::string datastring;
+    bool benchmark = false;
+    Benchmark::Options benchmark_options{};
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "hvdl::", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "hvdl::b:o:", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'h':
@@ -132,6 +141,13 @@ int main(int argc, char** argv) {
             case 'l':
                 console_log = true;
                 break;
+            case 'b':
+                benchmark = true;
+                benchmark_options.num_frames = static_cast<u32>(std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'o':
+                benchmark_options.output_path = optarg;
+                break;
             }
         } else {
 #ifdef _WIN32
@@ -159,6 +175,13 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (benchmark && benchmark_options.num_frames == 0) {
+        LOG_CRITICAL(Frontend, "Invalid number of benchmark frames");
+        std::cout << "Invalid number of benchmark frames" << std::endl;
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
     Settings::values.use_gdbstub = false;
     Settings::Apply();
 
@@ -253,6 +276,15 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (benchmark) {
+        system.TelemetrySession().AddField(Telemetry::FieldType::App, "Frontend",
+                                           "SDLHideBenchmark");
+        system.Renderer().Rasterizer().LoadDiskResources();
+        return_value = Benchmark::Run(system, benchmark_options);
+        detached_tasks.WaitForAllTasks();
+        return return_value;
+    }
+
     Service::Yuzu::InstallInterfaces(system.ServiceManager(), datastring, callback);
 
     system.TelemetrySession().AddField(Telemetry::FieldType::App, "Frontend", "SDLHideTester");